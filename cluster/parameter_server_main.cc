@@ -0,0 +1,101 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+// This serves the weights hashed to it to the workers started with --ps_servers.
+
+#include "parameter_server.h"
+#include "vw_exception.h"
+
+#ifdef _WIN32
+int daemon(int a, int b) { return 0; }
+int getpid() { return (int)::GetCurrentProcessId(); }
+#endif
+
+#include <iostream>
+#include <fstream>
+
+using namespace VW;
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+void usage(const po::options_description& desc)
+{
+  std::cout << "usage: parameter_server [--port,-p number] [--model_shard file] [--nondaemon] [--help,-h] [pid_file]"
+            << std::endl;
+  std::cout << desc << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  int port = 26545;
+  bool nondaemon = false;
+  std::string model_shard;
+
+  po::variables_map vm;
+  po::options_description desc("Parameter Server");
+  desc.add_options()("nondaemon", po::bool_switch(&nondaemon), "Run parameter server in foreground")(
+      "help,h", "Print help message")("port,p", po::value<int>(&port), "Port number for parameter server to listen on")(
+      "model_shard", po::value<std::string>(&model_shard),
+      "File to start the weights of this server from if it exists, and to save them to when the workers are done");
+
+  std::string pid_file_name;
+  po::options_description hidden;
+  hidden.add_options()("pid_file", po::value<std::string>(&pid_file_name), "File to write PID value to.");
+
+  po::options_description all_options;
+  all_options.add(desc);
+  all_options.add(hidden);
+
+  po::positional_options_description pos;
+  pos.add("pid_file", -1);
+
+  try
+  {
+    po::store(po::command_line_parser(argc, argv).options(all_options).positional(pos).run(), vm);
+    po::notify(vm);
+  }
+  catch (std::exception& e)
+  {
+    std::cout << argv[0] << ": " << e.what() << std::endl << std::endl;
+    usage(desc);
+    return 1;
+  }
+
+  if (vm.count("help"))
+  {
+    usage(desc);
+    return 0;
+  }
+
+  try
+  {
+    if (!nondaemon)
+    {
+      if (daemon(1, 1)) { THROWERRNO("daemon: "); }
+    }
+
+    ParameterServer parameterServer(port);
+    if (!model_shard.empty()) parameterServer.UseModelFile(model_shard);
+
+    if (vm.count("pid_file"))
+    {
+      std::ofstream pid_file;
+      pid_file.open(pid_file_name);
+      if (!pid_file.is_open())
+      {
+        std::cerr << "error writing pid file" << std::endl;
+        return 1;
+      }
+      pid_file << getpid() << std::endl;
+      pid_file.close();
+    }
+
+    parameterServer.Run();
+  }
+  catch (VW::vw_exception& e)
+  {
+    std::cerr << "parameter server (" << e.Filename() << ":" << e.LineNumber() << "): " << e.what() << std::endl;
+  }
+}
@@ -731,12 +731,31 @@ uint64_t hashall(String^ s, uint64_t u)
 }
 
 /// <summary>
-/// Hashes the given value <paramref name="s"/>.
+/// Hashes the given value <paramref name="s"/> as --hash_function xxh3 does.
 /// </summary>
 /// <param name="s">String to be hashed.</param>
 /// <param name="u">Hash offset.</param>
 /// <returns>The resulting hash code.</returns>
-size_t hashstring(String^ s, size_t u)
+uint64_t hashall_xxh3(String^ s, int offset, int count, uint64_t u)
+{ auto keys = gcnew cli::array<unsigned char>(Encoding::UTF8->GetMaxByteCount(count));
+  int length = Encoding::UTF8->GetBytes(s, offset, count, keys, 0);
+  pin_ptr<unsigned char> data = &keys[0];
+
+  return ::hashall_xxh3(reinterpret_cast<const char*>(data), length, u);
+}
+
+uint64_t hashall_xxh3(String^ s, uint64_t u)
+{ return hashall_xxh3(s, 0, s->Length, u);
+}
+
+/// <summary>
+/// Hashes the given value <paramref name="s"/>, with XXH3 if <paramref name="xxh3"/> and else with murmur3.
+/// </summary>
+/// <param name="s">String to be hashed.</param>
+/// <param name="u">Hash offset.</param>
+/// <param name="xxh3">Whether to hash as --hash_function xxh3 does.</param>
+/// <returns>The resulting hash code.</returns>
+size_t hashstring_of(String^ s, size_t u, bool xxh3)
 { int offset = 0;
   int end = s->Length;
   if (end == 0)
@@ -752,12 +771,20 @@ size_t hashstring(String^ s, size_t u)
     if (c >= '0' && c <= '9')
       sInt = 10 * sInt + (c - '0');
     else
-      return hashall(s, offset, end - offset, u);
+      return xxh3 ? hashall_xxh3(s, offset, end - offset, u) : hashall(s, offset, end - offset, u);
   }
 
   return sInt + u;
 }
 
+size_t hashstring(String^ s, size_t u)
+{ return hashstring_of(s, u, false);
+}
+
+size_t hashstring_xxh3(String^ s, size_t u)
+{ return hashstring_of(s, u, true);
+}
+
 Func<String^, size_t, size_t>^ VowpalWabbit::GetHasher()
 { //feature manipulation
   std::string hash_function("strings");
@@ -765,10 +792,19 @@ Func<String^, size_t, size_t>^ VowpalWabbit::GetHasher()
   {
     hash_function = m_vw->options->get_typed_option<std::string>("hash").value();
   }
+  // models which do not record a --hash_function are murmur3
+  bool xxh3 = m_vw->options->was_supplied("hash_function") &&
+    m_vw->options->get_typed_option<std::string>("hash_function").value() == "xxh3";
 
-  if (hash_function == "strings")
+  if (hash_function == "strings" && xxh3)
+  { return gcnew Func<String^, size_t, size_t>(&hashstring_xxh3);
+  }
+  else if (hash_function == "strings")
   { return gcnew Func<String^, size_t, size_t>(&hashstring);
   }
+  else if (hash_function == "all" && xxh3)
+  { return gcnew Func<String^, size_t, size_t>(&hashall_xxh3);
+  }
   else if (hash_function == "all")
   { return gcnew Func<String^, size_t, size_t>(&hashall);
   }
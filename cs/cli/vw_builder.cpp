@@ -60,7 +60,7 @@ VowpalWabbitNamespaceBuilder^ VowpalWabbitExampleBuilder::AddNamespace(Byte feat
 { uint32_t index = featureGroup;
   example* ex = m_example->m_example;
 
-  return gcnew VowpalWabbitNamespaceBuilder(ex->feature_space.data() + index, featureGroup, m_example->m_example);
+  return gcnew VowpalWabbitNamespaceBuilder(&ex->feature_space[index], featureGroup, m_example->m_example);
 }
 
 VowpalWabbitNamespaceBuilder::VowpalWabbitNamespaceBuilder(features* features,
@@ -99,6 +99,35 @@ void VowpalWabbitNamespaceBuilder::AddFeaturesUnchecked(uint64_t weight_index_ba
   }
 }
 
+void VowpalWabbitNamespaceBuilder::AddFeatures(uint64_t* weight_indices, float* values, int count)
+{ if (count <= 0)
+    return;
+
+  PreAllocate(count);
+  for (int i = 0; i < count; i++)
+  { float x = values[i];
+    if (x != 0)
+    { m_features->values.push_back_unchecked(x);
+      m_features->indicies.push_back_unchecked(weight_indices[i]);
+    }
+  }
+}
+
+void VowpalWabbitNamespaceBuilder::AddFeatures(array<uint64_t>^ weight_indices, array<float>^ values)
+{ if (weight_indices == nullptr)
+    throw gcnew ArgumentNullException("weight_indices");
+  if (values == nullptr)
+    throw gcnew ArgumentNullException("values");
+  if (weight_indices->Length != values->Length)
+    throw gcnew ArgumentException("weight_indices and values must be of the same length");
+  if (values->Length == 0)
+    return;
+
+  pin_ptr<uint64_t> weight_indices0 = &weight_indices[0];
+  pin_ptr<float> values0 = &values[0];
+  AddFeatures(weight_indices0, values0, values->Length);
+}
+
 void VowpalWabbitNamespaceBuilder::AddFeature(uint64_t weight_index, float x)
 { // filter out 0-values
   if (x == 0)
@@ -66,6 +66,22 @@ public:
   /// <param name="end">The end pointer of the float array.</param>
   void AddFeaturesUnchecked(uint64_t weight_index_base, float* begin, float* end);
 
+  /// <summary>
+  /// Adds sparse features to the example in one call, such as from pinned spans.
+  /// </summary>
+  /// <param name="weight_indices">The weight index of each feature.</param>
+  /// <param name="values">The value of each feature.</param>
+  /// <param name="count">The number of features.</param>
+  /// <remarks>Features of value 0 are left out, as <see cref="AddFeature"/> does.</remarks>
+  void AddFeatures(uint64_t* weight_indices, float* values, int count);
+
+  /// <summary>
+  /// Adds sparse features to the example in one call, pinning the arrays instead of crossing into native code per feature.
+  /// </summary>
+  /// <param name="weight_indices">The weight index of each feature.</param>
+  /// <param name="values">The value of each feature, as many as there are indices.</param>
+  void AddFeatures(array<uint64_t>^ weight_indices, array<float>^ values);
+
   /// <summary>
   /// Pre-allocate features of <paramref name="size"/>.
   /// </summary>
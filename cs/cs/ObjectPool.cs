@@ -7,10 +7,9 @@
 // --------------------------------------------------------------------------------------------------------------------
 
 using System;
-using System.Collections.Generic;
+using System.Collections.Concurrent;
 using System.Diagnostics.CodeAnalysis;
 using System.Diagnostics.Contracts;
-using System.Threading;
 
 namespace VW
 {
@@ -19,33 +18,56 @@ namespace VW
     /// </summary>
     /// <typeparam name="TSource">The disposable context needed to create objects of <typeparamref name="TObject"/>.</typeparam>
     /// <typeparam name="TObject">The type of the objects to be created.</typeparam>
+    /// <remarks>
+    /// Getting and returning objects takes no lock: the objects of a version are kept in a <see cref="ConcurrentBag{T}"/>,
+    /// which keeps a list per thread, so a thread mostly gets back the object it returned last,
+    /// and threads predicting at once don't contend for the pool.
+    /// </remarks>
     public class ObjectPool<TSource, TObject> : IDisposable
         where TSource : class, IDisposable
         where TObject : class, IDisposable
     {
         /// <summary>
-        /// Lock resources
+        /// A version of the factory and the objects it created.
         /// </summary>
-        private readonly ReaderWriterLockSlim rwLockSlim;
+        private sealed class Generation
+        {
+            internal Generation(int version, ObjectFactory<TSource, TObject> factory)
+            {
+                this.Version = version;
+                this.Factory = factory;
+                this.Pool = new ConcurrentBag<PooledObject<TSource, TObject>>();
+            }
 
-        /// <summary>
-        /// Version of the factory function.
-        /// </summary>
-        private int version;
+            internal int Version { get; private set; }
+
+            internal ObjectFactory<TSource, TObject> Factory { get; private set; }
+
+            /// <remarks>
+            /// To maximize reuse of previously cached items within the pooled objects.
+            /// (e.g. cached action dependent features)
+            /// </remarks>
+            internal ConcurrentBag<PooledObject<TSource, TObject>> Pool { get; private set; }
+
+            internal void DisposeObjects()
+            {
+                PooledObject<TSource, TObject> item;
+                while (this.Pool.TryTake(out item))
+                {
+                    item.Value.Dispose();
+                }
+            }
+        }
 
         /// <summary>
-        /// Used to create new pooled objects.
+        /// Serializes updates of the factory.
         /// </summary>
-        private ObjectFactory<TSource, TObject> factory;
+        private readonly object updateLock = new object();
 
         /// <summary>
-        /// The actual pool.
+        /// The current version, null once disposed.
         /// </summary>
-        /// <remarks>
-        /// To maximize reuse of previously cached items within the pooled objects.
-        /// (e.g. cached action dependent features)
-        /// </remarks>
-        private Stack<PooledObject<TSource, TObject>> pool;
+        private volatile Generation current;
 
         /// <summary>
         /// Initializes a new ObjectPool.
@@ -56,9 +78,7 @@ namespace VW
         /// </param>
         public ObjectPool(ObjectFactory<TSource, TObject> factory = null)
         {
-            this.rwLockSlim = new ReaderWriterLockSlim();
-            this.pool = new Stack<PooledObject<TSource, TObject>>();
-            this.factory = factory;
+            this.current = new Generation(0, factory);
         }
 
         /// <summary>
@@ -67,38 +87,26 @@ namespace VW
         /// <param name="factory">The new object factory to be used.</param>
         public void UpdateFactory(ObjectFactory<TSource, TObject> factory)
         {
-            Stack<PooledObject<TSource, TObject>> oldPool;
-            ObjectFactory<TSource, TObject> oldFactory;
+            Generation old;
 
-            this.rwLockSlim.EnterWriteLock();
-            try
+            lock (this.updateLock)
             {
-                if (this.pool == null)
+                old = this.current;
+                if (old == null)
                 {
                     throw new ObjectDisposedException("ObjectPool already disposed");
                 }
 
-                this.version++;
-                oldFactory = this.factory;
-                this.factory = factory;
-                oldPool = this.pool;
-                this.pool = new Stack<PooledObject<TSource, TObject>>();
-            }
-            finally
-            {
-                this.rwLockSlim.ExitWriteLock();
+                this.current = new Generation(old.Version + 1, factory);
             }
 
             // dispose outdated items
-            foreach (var item in oldPool)
-            {
-                item.Value.Dispose();
-            }
+            old.DisposeObjects();
 
             // dispose factory
-            if (oldFactory != null)
+            if (old.Factory != null)
             {
-                oldFactory.Dispose();
+                old.Factory.Dispose();
             }
         }
 
@@ -109,53 +117,24 @@ namespace VW
         /// <remarks>This method is thread-safe.</remarks>
         public PooledObject<TSource, TObject> GetOrCreate()
         {
-            int localVersion;
-            ObjectFactory<TSource, TObject> localFactory;
-
-            this.rwLockSlim.EnterUpgradeableReadLock();
-            try
+            var generation = this.current;
+            if (generation == null)
             {
-                if (this.pool == null)
-                {
-                    throw new ObjectDisposedException("ObjectPool already disposed");
-                }
-
-                if (this.pool.Count == 0)
-                {
-                    // create a consistent copy
-                    localVersion = this.version;
-                    localFactory = this.factory;
-                }
-                else
-                {
-                    this.rwLockSlim.EnterWriteLock();
-                    try
-                    {
-                        if (this.pool == null)
-                        {
-                            throw new ObjectDisposedException("ObjectPool already disposed");
-                        }
-
-                        return this.pool.Pop();
-                    }
-                    finally
-                    {
-                        this.rwLockSlim.ExitWriteLock();
-                    }
-                }
+                throw new ObjectDisposedException("ObjectPool already disposed");
             }
-            finally
+
+            PooledObject<TSource, TObject> item;
+            if (generation.Pool.TryTake(out item))
             {
-                this.rwLockSlim.ExitUpgradeableReadLock();
+                return item;
             }
 
-            if (localFactory == null)
+            if (generation.Factory == null)
             {
                 throw new InvalidOperationException("Factory must be initialized before calling Get()");
             }
 
-            // invoke the factory outside of the lock
-            return new PooledObject<TSource, TObject>(this, localVersion, localFactory.Create());
+            return new PooledObject<TSource, TObject>(this, generation.Version, generation.Factory.Create());
         }
 
         /// <summary>
@@ -167,32 +146,19 @@ namespace VW
         {
             Contract.Ensures(pooledObject != null);
 
-            this.rwLockSlim.EnterUpgradeableReadLock();
-            try
+            var generation = this.current;
+            if (generation != null && generation.Version == pooledObject.Version)
             {
-                if (this.version == pooledObject.Version && this.pool != null)
+                // it's the same version, return to pool
+                generation.Pool.Add(pooledObject);
+
+                // unless the version was replaced meanwhile, and its objects disposed before this one was added
+                if (this.current != generation)
                 {
-                    this.rwLockSlim.EnterWriteLock();
-                    try
-                    {
-                        // double check
-                        if (this.version == pooledObject.Version && this.pool != null)
-                        {
-                            // it's the same version, return to pool
-                            this.pool.Push(pooledObject);
-
-                            return;
-                        }
-                    }
-                    finally
-                    {
-                        this.rwLockSlim.ExitWriteLock();
-                    }
+                    generation.DisposeObjects();
                 }
-            }
-            finally
-            {
-                this.rwLockSlim.ExitUpgradeableReadLock();
+
+                return;
             }
 
             // outdated
@@ -212,30 +178,24 @@ namespace VW
         {
             if (disposing)
             {
-                this.rwLockSlim.EnterWriteLock();
-                try
+                Generation old;
+                lock (this.updateLock)
+                {
+                    old = this.current;
+                    this.current = null;
+                }
+
+                if (old != null)
                 {
                     // Dispose pool items
-                    if (this.pool != null)
-                    {
-                        foreach (var item in this.pool)
-                        {
-                            item.Value.Dispose();
-                        }
-                        this.pool = null;
-                    }
+                    old.DisposeObjects();
 
                     // Dispose factory
-                    if (this.factory != null)
+                    if (old.Factory != null)
                     {
-                        this.factory.Dispose();
-                        this.factory = null;
+                        old.Factory.Dispose();
                     }
                 }
-                finally
-                {
-                    this.rwLockSlim.ExitWriteLock();
-                }
             }
         }
     }
@@ -93,6 +93,29 @@ namespace cs_unittest
             Assert.IsTrue(factory2.Disposed);
         }
 
+        [TestMethod]
+        [TestCategory("Vowpal Wabbit")]
+        public void ObjectPoolTestReturnedOnThread()
+        {
+            var factory = new Disposable();
+            using (var objectPool = new ObjectPool<Disposable, Disposable>(ObjectFactory.Create(factory, d => d.Create())))
+            {
+                var p1 = objectPool.GetOrCreate();
+                var value = p1.Value;
+                p1.Dispose();
+
+                // the thread gets back the object it returned, without creating another
+                using (var p2 = objectPool.GetOrCreate())
+                {
+                    Assert.AreSame(value, p2.Value);
+                }
+
+                Assert.AreEqual(1, factory.Children.Count);
+            }
+
+            factory.AssertChildrenDisposed();
+        }
+
         [TestMethod]
         [TestCategory("Vowpal Wabbit")]
         public void ThreadPoolNull()
@@ -49,5 +49,33 @@ namespace cs_unittest
                 }
             }
         }
+
+        [TestMethod]
+        [TestCategory("Vowpal Wabbit")]
+        public void TestWikiAddFeatures()
+        {
+            using (var vw = new VW.VowpalWabbit(""))
+            {
+                using (var exampleBuilder = new VW.VowpalWabbitExampleBuilder(vw))
+                {
+                    using (var ns = exampleBuilder.AddNamespace('f'))
+                    {
+                        var namespaceHash = vw.HashSpace("f");
+
+                        // the feature of value 0 is left out
+                        ns.AddFeatures(
+                            new[] { vw.HashFeature("13", namespaceHash), vw.HashFeature("24", namespaceHash), vw.HashFeature("42", namespaceHash), vw.HashFeature("69", namespaceHash) },
+                            new[] { 8.5609287e-02f, 3.4781646e-02f, 0f, 4.6296168e-02f });
+                    }
+
+                    exampleBuilder.ApplyLabel(new SimpleLabel() { Label = 1 });
+
+                    using (var example = exampleBuilder.CreateExample())
+                    {
+                        VowpalWabbitExampleValidator.Validate("1 |f 13:8.5609287e-02 24:3.4781646e-02 69:4.6296168e-02", example, VowpalWabbitLabelComparator.Simple);
+                    }
+                }
+            }
+        }
     }
 }
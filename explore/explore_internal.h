@@ -117,6 +117,31 @@ namespace exploration
     return generate_softmax(lambda, scores_first, scores_last, scores_category(), pmf_first, pmf_last, pmf_category());
   }
 
+  // Every pass is a loop over contiguous floats, and the exponentials are summed in the order of the actions so that
+  // the distributions equal those of the iterator version.
+  inline int generate_softmax(float lambda, const float* scores, float* pmf, size_t num_actions, size_t num_decisions)
+  {
+    if (num_actions == 0 || scores == nullptr || pmf == nullptr) return E_EXPLORATION_BAD_RANGE;
+
+    for (size_t decision = 0; decision < num_decisions; ++decision)
+    {
+      const float* s = scores + decision * num_actions;
+      float* d = pmf + decision * num_actions;
+      if (d != s) std::copy(s, s + num_actions, d);
+
+      float max_score = lambda > 0 ? *std::max_element(d, d + num_actions) : *std::min_element(d, d + num_actions);
+      for (size_t i = 0; i < num_actions; ++i) d[i] = std::exp(lambda * (d[i] - max_score));
+
+      float norm = 0.;
+      for (size_t i = 0; i < num_actions; ++i) norm += d[i];
+
+      // normalize
+      for (size_t i = 0; i < num_actions; ++i) d[i] /= norm;
+    }
+
+    return S_EXPLORATION_OK;
+  }
+
   template <typename InputIt, typename OutputIt>
   int generate_bag(InputIt top_actions_first, InputIt top_actions_last, std::input_iterator_tag /* top_actions_tag */,
       OutputIt pmf_first, OutputIt pmf_last, std::random_access_iterator_tag /* pmf_tag */)
@@ -308,6 +333,53 @@ namespace exploration
     return sample_after_normalizing(seed, pmf_first, pmf_last, chosen_index, pmf_category());
   }
 
+  // Warning: `seeds` must be sufficiently random for the PRNG to produce uniform random values. Using sequential seeds
+  // will result in a very biased distribution.
+  inline int sample_after_normalizing(
+      const uint64_t* seeds, float* pmf, size_t num_actions, size_t num_decisions, uint32_t* chosen_indices)
+  {
+    if (num_actions == 0 || pmf == nullptr) return E_EXPLORATION_BAD_RANGE;
+
+    for (size_t decision = 0; decision < num_decisions; ++decision)
+    {
+      float* d = pmf + decision * num_actions;
+      uint32_t& chosen_index = chosen_indices[decision];
+
+      float total = 0.f;
+      for (size_t i = 0; i < num_actions; ++i)
+      {
+        d[i] = std::max(d[i], 0.f);
+        total += d[i];
+      }
+
+      // assume the first is the best
+      if (total == 0)
+      {
+        chosen_index = 0;
+        *d = 1;
+        continue;
+      }
+
+      float draw = total * uniform_random_merand48(seeds[decision]);
+      if (draw > total)  // make very sure that draw can not be greater than total.
+        draw = total;
+
+      // The chosen index is found in the cumulative sums, which are rounded the same as in the iterator version.
+      float sum = 0.f;
+      uint32_t i = 0;
+      for (; i < num_actions; ++i)
+      {
+        sum += d[i];
+        if (sum > draw) break;
+      }
+      chosen_index = i < num_actions ? i : static_cast<uint32_t>(num_actions - 1);
+
+      for (size_t j = 0; j < num_actions; ++j) d[j] /= total;
+    }
+
+    return S_EXPLORATION_OK;
+  }
+
   //
   template <typename ActionIt>
   int swap_chosen(ActionIt action_first, ActionIt action_last, std::forward_iterator_tag /* action_category */,
@@ -1,732 +1,900 @@
-#include "jni_spark_vw.h"
-#include "vw_exception.h"
-#include "best_constant.h"
-#include "util.h"
-#include "options_serializer_boost_po.h"
-#include "learner.h"
-#include <algorithm>
-#include <exception>
-
-jobject getJavaPrediction(JNIEnv* env, vw* all, example* ex);
-
-// Guards
-StringGuard::StringGuard(JNIEnv* env, jstring source) : _env(env), _source(source), _cstr(nullptr)
-{
-  _cstr = _env->GetStringUTFChars(source, 0);
-}
-
-StringGuard::~StringGuard()
-{
-  if (_cstr)
-  {
-    _env->ReleaseStringUTFChars(_source, _cstr);
-    _env->DeleteLocalRef(_source);
-  }
-}
-
-const char* StringGuard::c_str() { return _cstr; }
-
-CriticalArrayGuard::CriticalArrayGuard(JNIEnv* env, jarray arr) : _env(env), _arr(arr), _arr0(nullptr)
-{
-  _arr0 = env->GetPrimitiveArrayCritical(arr, nullptr);
-}
-
-CriticalArrayGuard::~CriticalArrayGuard()
-{
-  if (_arr0)
-  {
-    _env->ReleasePrimitiveArrayCritical(_arr, _arr0, JNI_ABORT);
-  }
-}
-
-void* CriticalArrayGuard::data() { return _arr0; }
-
-// VW
-JNIEXPORT jlong JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_initialize(JNIEnv* env, jclass, jstring args)
-{
-  StringGuard g_args(env, args);
-
-  try
-  {
-    return reinterpret_cast<jlong>(VW::initialize(g_args.c_str()));
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return 0;
-  }
-}
-
-JNIEXPORT jlong JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_initializeFromModel(
-    JNIEnv* env, jclass, jstring args, jbyteArray model)
-{
-  StringGuard g_args(env, args);
-  CriticalArrayGuard modelGuard(env, model);
-
-  try
-  {
-    int size = env->GetArrayLength(model);
-    auto* model0 = reinterpret_cast<const char*>(modelGuard.data());
-
-    io_buf buffer;
-    buffer.add_file(VW::io::create_buffer_view(model0, size));
-
-    return reinterpret_cast<jlong>(VW::initialize(g_args.c_str(), &buffer));
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return 0;
-  }
-}
-
-void populateMultiEx(JNIEnv* env, jobjectArray examples, vw& all, multi_ex& ex_coll)
-{
-  bool fieldIdInitialized = false;
-
-  int length = env->GetArrayLength(examples);
-  if (length > 0)
-  {
-    jobject jex = env->GetObjectArrayElement(examples, 0);
-
-    jclass cls = env->GetObjectClass(jex);
-    jfieldID fieldId = env->GetFieldID(cls, "nativePointer", "J");
-
-    for (int i = 0; i < length; i++)
-    {
-      jex = env->GetObjectArrayElement(examples, i);
-
-      // JavaObject VowpalWabbitExampleWrapper -> example*
-      auto exWrapper = (VowpalWabbitExampleWrapper*)get_native_pointer(env, jex);
-      VW::setup_example(all, exWrapper->_example);
-
-      ex_coll.push_back(exWrapper->_example);
-    }
-  }
-}
-
-JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_learn(
-    JNIEnv* env, jobject vwObj, jobjectArray examples)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  multi_ex ex_coll;
-  try
-  {
-    populateMultiEx(env, examples, *all, ex_coll);
-
-    all->learn(ex_coll);
-
-    // as this is not a ring-based example it is not freed
-    as_multiline(all->l)->finish_example(*all, ex_coll);
-
-    // prediction is in the first example
-    return getJavaPrediction(env, all, ex_coll[0]);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return nullptr;
-  }
-}
-
-JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_predict(
-    JNIEnv* env, jobject vwObj, jobjectArray examples)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  multi_ex ex_coll;
-  try
-  {
-    populateMultiEx(env, examples, *all, ex_coll);
-
-    all->predict(ex_coll);
-
-    // as this is not a ring-based example it is not freed
-    as_multiline(all->l)->finish_example(*all, ex_coll);
-
-    // prediction is in the first example
-    return getJavaPrediction(env, all, ex_coll[0]);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return nullptr;
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_performRemainingPasses(JNIEnv* env, jobject vwObj)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  try
-  {
-    if (all->numpasses > 1)
-    {
-      all->do_reset_source = true;
-      VW::start_parser(*all);
-      VW::LEARNER::generic_driver(*all);
-      VW::end_parser(*all);
-    }
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT jbyteArray JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getModel(JNIEnv* env, jobject vwObj)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  try
-  {  // save in stl::vector
-    auto model_buffer = std::make_shared<std::vector<char>>();
-    io_buf buffer;
-    buffer.add_file(VW::io::create_vector_writer(model_buffer));
-    VW::save_predictor(*all, buffer);
-
-    // copy to Java
-    jbyteArray ret = env->NewByteArray(model_buffer->size());
-    CHECK_JNI_EXCEPTION(nullptr);
-
-    env->SetByteArrayRegion(ret, 0, model_buffer->size(), (const jbyte*)&model_buffer->data()[0]);
-    CHECK_JNI_EXCEPTION(nullptr);
-
-    return ret;
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return nullptr;
-  }
-}
-
-JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getArguments(JNIEnv* env, jobject vwObj)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  // serialize the command line
-  VW::config::options_serializer_boost_po serializer;
-  for (auto const& option : all->options->get_all_options())
-  {
-    if (all->options->was_supplied(option->m_name))
-    {
-      serializer.add(*option);
-    }
-  }
-
-  // move it to Java
-  // Note: don't keep serializer.str().c_str() around in some variable. it get's deleted after str() is de-allocated
-  jstring args = env->NewStringUTF(serializer.str().c_str());
-  CHECK_JNI_EXCEPTION(nullptr);
-
-  jclass clazz = env->FindClass("org/vowpalwabbit/spark/VowpalWabbitArguments");
-  CHECK_JNI_EXCEPTION(nullptr);
-
-  jmethodID ctor = env->GetMethodID(clazz, "<init>", "(IILjava/lang/String;DD)V");
-  CHECK_JNI_EXCEPTION(nullptr);
-
-  return env->NewObject(clazz, ctor, all->num_bits, all->hash_seed, args, all->eta, all->power_t);
-}
-
-JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getPerformanceStatistics(
-    JNIEnv* env, jobject vwObj)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  long numberOfExamplesPerPass;
-  double weightedExampleSum;
-  double weightedLabelSum;
-  double averageLoss;
-  float bestConstant;
-  float bestConstantLoss;
-  long totalNumberOfFeatures;
-
-  if (all->current_pass == 0)
-    numberOfExamplesPerPass = all->sd->example_number;
-  else
-    numberOfExamplesPerPass = all->sd->example_number / all->current_pass;
-
-  weightedExampleSum = all->sd->weighted_examples();
-  weightedLabelSum = all->sd->weighted_labels;
-
-  if (all->holdout_set_off)
-    if (all->sd->weighted_labeled_examples > 0)
-      averageLoss = all->sd->sum_loss / all->sd->weighted_labeled_examples;
-    else
-      averageLoss = 0;  // TODO should report NaN, but not clear how to do in platform independent manner
-  else if ((all->sd->holdout_best_loss == FLT_MAX) || (all->sd->holdout_best_loss == FLT_MAX * 0.5))
-    averageLoss = 0;  // TODO should report NaN, but not clear how to do in platform independent manner
-  else
-    averageLoss = all->sd->holdout_best_loss;
-
-  get_best_constant(*all, bestConstant, bestConstantLoss);
-  totalNumberOfFeatures = all->sd->total_features;
-
-  jclass clazz = env->FindClass("org/vowpalwabbit/spark/VowpalWabbitPerformanceStatistics");
-  CHECK_JNI_EXCEPTION(nullptr);
-
-  jmethodID ctor = env->GetMethodID(clazz, "<init>", "(JDDDFFJ)V");
-  CHECK_JNI_EXCEPTION(nullptr);
-
-  return env->NewObject(clazz, ctor, numberOfExamplesPerPass, weightedExampleSum, weightedLabelSum, averageLoss,
-      bestConstant, bestConstantLoss, totalNumberOfFeatures);
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_endPass(JNIEnv* env, jobject vwObj)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  try
-  {
-    // note: this code duplication seems bound for trouble
-    // from parse_dispatch_loop.h:26
-    // from learner.cc:41
-    reset_source(*all, all->num_bits);
-    all->do_reset_source = false;
-    all->passes_complete++;
-
-    all->current_pass++;
-    all->l->end_pass();
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_finish(JNIEnv* env, jobject vwObj)
-{
-  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
-
-  try
-  {
-    VW::sync_stats(*all);
-    VW::finish(*all);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT jint JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_hash(
-    JNIEnv* env, jclass, jbyteArray data, jint offset, jint len, jint seed)
-{
-  CriticalArrayGuard dataGuard(env, data);
-  const char* values0 = (const char*)dataGuard.data();
-
-  return (jint)uniform_hash(values0 + offset, len, seed);
-}
-
-// VW Example
-#define INIT_VARS                                                                                      \
-  auto exWrapper = reinterpret_cast<VowpalWabbitExampleWrapper*>(get_native_pointer(env, exampleObj)); \
-  vw* all = exWrapper->_all;                                                                           \
-  example* ex = exWrapper->_example;
-
-JNIEXPORT jlong JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_initialize(
-    JNIEnv* env, jclass, jlong vwPtr, jboolean isEmpty)
-{
-  auto* all = reinterpret_cast<vw*>(vwPtr);
-
-  try
-  {
-    example* ex = VW::alloc_examples(1);
-    ex->interactions = &all->interactions;
-
-    if (isEmpty)
-    {
-      char empty = '\0';
-      VW::read_line(*all, ex, &empty);
-    }
-    else
-      all->example_parser->lbl_parser.default_label(&ex->l);
-
-    return reinterpret_cast<jlong>(new VowpalWabbitExampleWrapper(all, ex));
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return 0;
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_finish(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  try
-  {
-    VW::dealloc_example(all->example_parser->lbl_parser.delete_label, *ex);
-    ::free_it(ex);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_clear(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  try
-  {
-    VW::empty_example(*all, *ex);
-    all->example_parser->lbl_parser.default_label(&ex->l);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-void addNamespaceIfNotExists(vw* all, example* ex, char ns)
-{
-  if (std::find(ex->indices.begin(), ex->indices.end(), ns) == ex->indices.end())
-  {
-    ex->indices.push_back(ns);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_addToNamespaceDense(
-    JNIEnv* env, jobject exampleObj, jchar ns, jint weight_index_base, jdoubleArray values)
-{
-  INIT_VARS
-
-  try
-  {
-    addNamespaceIfNotExists(all, ex, ns);
-
-    auto features = ex->feature_space.data() + ns;
-
-    CriticalArrayGuard valuesGuard(env, values);
-    double* values0 = (double*)valuesGuard.data();
-
-    int size = env->GetArrayLength(values);
-    int mask = (1 << all->num_bits) - 1;
-
-    // pre-allocate
-    features->values.resize(features->values.end() - features->values.begin() + size);
-    features->indicies.resize(features->indicies.end() - features->indicies.begin() + size);
-
-    double* values_itr = values0;
-    double* values_end = values0 + size;
-    for (; values_itr != values_end; ++values_itr, ++weight_index_base)
-    {
-      float x = *values_itr;
-      if (x != 0)
-      {
-        features->values.push_back_unchecked(x);
-        features->indicies.push_back_unchecked(weight_index_base & mask);
-      }
-    }
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_addToNamespaceSparse(
-    JNIEnv* env, jobject exampleObj, jchar ns, jintArray indices, jdoubleArray values)
-{
-  INIT_VARS
-
-  try
-  {
-    addNamespaceIfNotExists(all, ex, ns);
-
-    auto features = ex->feature_space.data() + ns;
-
-    CriticalArrayGuard indicesGuard(env, indices);
-    int* indices0 = (int*)indicesGuard.data();
-
-    CriticalArrayGuard valuesGuard(env, values);
-    double* values0 = (double*)valuesGuard.data();
-
-    int size = env->GetArrayLength(indices);
-    int mask = (1 << all->num_bits) - 1;
-
-    // pre-allocate
-    features->values.resize(features->values.end() - features->values.begin() + size);
-    features->indicies.resize(features->indicies.end() - features->indicies.begin() + size);
-
-    int* indices_itr = indices0;
-    int* indices_end = indices0 + size;
-    double* values_itr = values0;
-    for (; indices_itr != indices_end; ++indices_itr, ++values_itr)
-    {
-      float x = *values_itr;
-      if (x != 0)
-      {
-        features->values.push_back_unchecked(x);
-        features->indicies.push_back_unchecked(*indices_itr & mask);
-      }
-    }
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setLabel(
-    JNIEnv* env, jobject exampleObj, jfloat weight, jfloat label)
-{
-  INIT_VARS
-
-  try
-  {
-    label_data* ld = &ex->l.simple;
-    ld->label = label;
-    ld->weight = weight;
-
-    count_label(all->sd, ld->label);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setDefaultLabel(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  try
-  {
-    all->example_parser->lbl_parser.default_label(&ex->l);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setContextualBanditLabel(
-    JNIEnv* env, jobject exampleObj, jint action, jdouble cost, jdouble probability)
-{
-  INIT_VARS
-
-  try
-  {
-    CB::label* ld = &ex->l.cb;
-    CB::cb_class f;
-
-    f.action = (uint32_t)action;
-    f.cost = (float)cost;
-    f.probability = (float)probability;
-
-    ld->costs.push_back(f);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setSharedLabel(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  try
-  {
-    // https://github.com/VowpalWabbit/vowpal_wabbit/blob/master/vowpalwabbit/parse_example_json.h#L437
-    CB::label* ld = &ex->l.cb;
-    CB::cb_class f;
-
-    f.partial_prediction = 0.;
-    f.action = (uint32_t)uniform_hash("shared", 6 /*length of string*/, 0);
-    f.cost = FLT_MAX;
-    f.probability = -1.f;
-
-    ld->costs.push_back(f);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_getPrediction(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  return getJavaPrediction(env, all, ex);
-}
-
-JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_learn(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  try
-  {
-    VW::setup_example(*all, ex);
-
-    all->learn(*ex);
-
-    // as this is not a ring-based example it is not free'd
-    VW::LEARNER::as_singleline(all->l)->finish_example(*all, *ex);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-  }
-}
-
-JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_predict(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  try
-  {
-    VW::setup_example(*all, ex);
-
-    all->predict(*ex);
-
-    // as this is not a ring-based example it is not free'd
-    VW::LEARNER::as_singleline(all->l)->finish_example(*all, *ex);
-
-    return getJavaPrediction(env, all, ex);
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return nullptr;
-  }
-}
-
-JNIEXPORT jstring JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_toString(JNIEnv* env, jobject exampleObj)
-{
-  INIT_VARS
-
-  try
-  {
-    std::ostringstream ostr;
-
-    ostr << "VowpalWabbitExample(label=";
-    auto lp = all->example_parser->lbl_parser;
-
-    if (!memcmp(&lp, &simple_label_parser, sizeof(lp)))
-    {
-      label_data* ld = &ex->l.simple;
-      ostr << "simple " << ld->label << ":" << ld->weight << ":" << ld->initial;
-    }
-    else if (!memcmp(&lp, &CB::cb_label, sizeof(lp)))
-    {
-      CB::label* ld = &ex->l.cb;
-      ostr << "CB " << ld->costs.size();
-
-      if (ld->costs.size() > 0)
-      {
-        ostr << " ";
-
-        CB::cb_class& f = ld->costs[0];
-
-        // Ignore checking if f.action == uniform_hash("shared")
-        if (f.partial_prediction == 0 && f.cost == FLT_MAX && f.probability == -1.f)
-          ostr << "shared";
-        else
-          ostr << f.action << ":" << f.cost << ":" << f.probability;
-      }
-    }
-    else
-    {
-      ostr << "unsupported label";
-    }
-
-    ostr << ";";
-    for (auto& ns : ex->indices)
-    {
-      if (ns == 0)
-        ostr << "NULL:0,";
-      else
-      {
-        if ((ns >= 'a' && ns <= 'z') || (ns >= 'A' && ns <= 'Z'))
-          ostr << "'" << (char)ns << "':";
-
-        ostr << (int)ns << ",";
-      }
-
-      for (auto& f : ex->feature_space[ns])
-      {
-        auto idx = f.index();
-        ostr << (idx & all->weights.mask()) << "/" << idx << ":" << f.value() << ", ";
-      }
-    }
-
-    ostr << ")";
-
-    return env->NewStringUTF(ostr.str().c_str());
-  }
-  catch (...)
-  {
-    rethrow_cpp_exception_as_java_exception(env);
-    return nullptr;
-  }
-}
-
-// re-use prediction conversation methods
-jobject multilabel_predictor(example* vec, JNIEnv* env);
-jfloatArray scalars_predictor(example* vec, JNIEnv* env);
-jobject action_scores_prediction(example* vec, JNIEnv* env);
-jobject action_probs_prediction(example* vec, JNIEnv* env);
-
-jobject getJavaPrediction(JNIEnv* env, vw* all, example* ex)
-{
-  jclass predClass;
-  jmethodID ctr;
-  switch (all->l->pred_type)
-  {
-    case prediction_type_t::scalar:
-      predClass = env->FindClass("org/vowpalwabbit/spark/prediction/ScalarPrediction");
-      CHECK_JNI_EXCEPTION(nullptr);
-
-      ctr = env->GetMethodID(predClass, "<init>", "(FF)V");
-      CHECK_JNI_EXCEPTION(nullptr);
-
-      return env->NewObject(predClass, ctr, VW::get_prediction(ex), ex->confidence);
-
-    case prediction_type_t::prob:
-      predClass = env->FindClass("java/lang/Float");
-      CHECK_JNI_EXCEPTION(nullptr);
-
-      ctr = env->GetMethodID(predClass, "<init>", "(F)V");
-      CHECK_JNI_EXCEPTION(nullptr);
-
-      return env->NewObject(predClass, ctr, ex->pred.prob);
-
-    case prediction_type_t::multiclass:
-      predClass = env->FindClass("java/lang/Integer");
-      CHECK_JNI_EXCEPTION(nullptr);
-
-      ctr = env->GetMethodID(predClass, "<init>", "(I)V");
-      CHECK_JNI_EXCEPTION(nullptr);
-
-      return env->NewObject(predClass, ctr, ex->pred.multiclass);
-
-    case prediction_type_t::scalars:
-      return scalars_predictor(ex, env);
-
-    case prediction_type_t::action_probs:
-      return action_probs_prediction(ex, env);
-
-    case prediction_type_t::action_scores:
-      return action_scores_prediction(ex, env);
-
-    case prediction_type_t::multilabels:
-      return multilabel_predictor(ex, env);
-
-    default:
-    {
-      std::ostringstream ostr;
-      ostr << "prediction type '" << to_string(all->l->pred_type) << "' is not supported";
-
-      env->ThrowNew(env->FindClass("java/lang/UnsupportedOperationException"), ostr.str().c_str());
-      return nullptr;
-    }
-  }
-}
+#include "jni_spark_vw.h"
+#include "vw_exception.h"
+#include "best_constant.h"
+#include "util.h"
+#include "options_serializer_boost_po.h"
+#include "learner.h"
+#include <algorithm>
+#include <exception>
+
+jobject getJavaPrediction(JNIEnv* env, vw* all, example* ex);
+
+// Guards
+StringGuard::StringGuard(JNIEnv* env, jstring source) : _env(env), _source(source), _cstr(nullptr)
+{
+  _cstr = _env->GetStringUTFChars(source, 0);
+}
+
+StringGuard::~StringGuard()
+{
+  if (_cstr)
+  {
+    _env->ReleaseStringUTFChars(_source, _cstr);
+    _env->DeleteLocalRef(_source);
+  }
+}
+
+const char* StringGuard::c_str() { return _cstr; }
+
+CriticalArrayGuard::CriticalArrayGuard(JNIEnv* env, jarray arr) : _env(env), _arr(arr), _arr0(nullptr)
+{
+  _arr0 = env->GetPrimitiveArrayCritical(arr, nullptr);
+}
+
+CriticalArrayGuard::~CriticalArrayGuard()
+{
+  if (_arr0)
+  {
+    _env->ReleasePrimitiveArrayCritical(_arr, _arr0, JNI_ABORT);
+  }
+}
+
+void* CriticalArrayGuard::data() { return _arr0; }
+
+// VW
+JNIEXPORT jlong JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_initialize(JNIEnv* env, jclass, jstring args)
+{
+  StringGuard g_args(env, args);
+
+  try
+  {
+    return reinterpret_cast<jlong>(VW::initialize(g_args.c_str()));
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return 0;
+  }
+}
+
+JNIEXPORT jlong JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_initializeFromModel(
+    JNIEnv* env, jclass, jstring args, jbyteArray model)
+{
+  StringGuard g_args(env, args);
+  CriticalArrayGuard modelGuard(env, model);
+
+  try
+  {
+    int size = env->GetArrayLength(model);
+    auto* model0 = reinterpret_cast<const char*>(modelGuard.data());
+
+    io_buf buffer;
+    buffer.add_file(VW::io::create_buffer_view(model0, size));
+
+    return reinterpret_cast<jlong>(VW::initialize(g_args.c_str(), &buffer));
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return 0;
+  }
+}
+
+void populateMultiEx(JNIEnv* env, jobjectArray examples, vw& all, multi_ex& ex_coll)
+{
+  bool fieldIdInitialized = false;
+
+  int length = env->GetArrayLength(examples);
+  if (length > 0)
+  {
+    jobject jex = env->GetObjectArrayElement(examples, 0);
+
+    jclass cls = env->GetObjectClass(jex);
+    jfieldID fieldId = env->GetFieldID(cls, "nativePointer", "J");
+
+    for (int i = 0; i < length; i++)
+    {
+      jex = env->GetObjectArrayElement(examples, i);
+
+      // JavaObject VowpalWabbitExampleWrapper -> example*
+      auto exWrapper = (VowpalWabbitExampleWrapper*)get_native_pointer(env, jex);
+      VW::setup_example(all, exWrapper->_example);
+
+      ex_coll.push_back(exWrapper->_example);
+    }
+  }
+}
+
+JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_learn(
+    JNIEnv* env, jobject vwObj, jobjectArray examples)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  multi_ex ex_coll;
+  try
+  {
+    populateMultiEx(env, examples, *all, ex_coll);
+
+    all->learn(ex_coll);
+
+    // as this is not a ring-based example it is not freed
+    as_multiline(all->l)->finish_example(*all, ex_coll);
+
+    // prediction is in the first example
+    return getJavaPrediction(env, all, ex_coll[0]);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return nullptr;
+  }
+}
+
+JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_predict(
+    JNIEnv* env, jobject vwObj, jobjectArray examples)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  multi_ex ex_coll;
+  try
+  {
+    populateMultiEx(env, examples, *all, ex_coll);
+
+    all->predict(ex_coll);
+
+    // as this is not a ring-based example it is not freed
+    as_multiline(all->l)->finish_example(*all, ex_coll);
+
+    // prediction is in the first example
+    return getJavaPrediction(env, all, ex_coll[0]);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return nullptr;
+  }
+}
+
+// A direct java.nio.ByteBuffer of items of T in native byte order, of which the batch needs count.
+template <typename T>
+T* direct_buffer(JNIEnv* env, jobject buffer, size_t count, const char* name)
+{
+  if (buffer == nullptr) THROW(name << " must not be null");
+  T* data = static_cast<T*>(env->GetDirectBufferAddress(buffer));
+  if (data == nullptr) THROW(name << " must be a direct ByteBuffer");
+  jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (capacity < 0 || static_cast<size_t>(capacity) / sizeof(T) < count)
+    THROW(name << " holds less than the " << count << " items of the batch");
+  return data;
+}
+
+// The rows of a batch in compressed sparse row form: the features of row r in namespace ns are the indices and values
+// from offsets[r] to offsets[r + 1], as addToNamespaceSparse would add them.
+struct batch_rows
+{
+  size_t rows;
+  unsigned char ns;
+  const int* offsets;
+  const int* indices;
+  const float* values;
+
+  batch_rows(JNIEnv* env, jint num_rows, jchar ns_char, jobject indices_buffer, jobject values_buffer,
+      jobject offsets_buffer)
+  {
+    if (num_rows < 0) THROW("the number of rows must not be negative");
+    rows = static_cast<size_t>(num_rows);
+    ns = static_cast<unsigned char>(ns_char);
+    offsets = direct_buffer<int>(env, offsets_buffer, rows + 1, "offsets");
+    if (offsets[0] < 0) THROW("offsets must not be negative");
+    for (size_t r = 0; r < rows; r++)
+      if (offsets[r] > offsets[r + 1]) THROW("offsets must not decrease");
+    indices = direct_buffer<int>(env, indices_buffer, offsets[rows], "indices");
+    values = direct_buffer<float>(env, values_buffer, offsets[rows], "values");
+  }
+
+  // A pooled example of the features of row r, with the default label.
+  example& to_example(vw& all, size_t r) const
+  {
+    example& ec = VW::get_unused_example(&all);
+    all.example_parser->lbl_parser.default_label(&ec.l);
+    const uint64_t mask = (UINT64_ONE << all.num_bits) - 1;
+    features& fs = ec.feature_space[ns];
+    for (int k = offsets[r]; k < offsets[r + 1]; k++)
+      if (values[k] != 0) fs.push_back(values[k], indices[k] & mask);
+    if (fs.nonempty()) ec.indices.push_back(ns);
+    return ec;
+  }
+};
+
+void check_batchable(vw& all)
+{
+  if (all.l->is_multiline) THROW("learnBatch and predictBatch need a reduction of single line examples");
+  if (all.example_parser->lbl_parser.label_type != label_type_t::simple)
+    THROW("learnBatch and predictBatch need a reduction of simple labels");
+  if (all.l->pred_type != prediction_type_t::scalar && all.l->pred_type != prediction_type_t::prob)
+    THROW("learnBatch and predictBatch need a reduction of scalar predictions");
+}
+
+float scalar_prediction(vw& all, example& ec)
+{
+  return all.l->pred_type == prediction_type_t::prob ? ec.pred.prob : ec.pred.scalar;
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_learnBatch(JNIEnv* env, jobject vwObj,
+    jint numRows, jchar ns, jobject indices, jobject values, jobject offsets, jobject labels, jobject weights,
+    jobject predictions)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  try
+  {
+    check_batchable(*all);
+    batch_rows rows(env, numRows, ns, indices, values, offsets);
+    const float* labels0 = direct_buffer<float>(env, labels, rows.rows, "labels");
+    const float* weights0 = weights == nullptr ? nullptr : direct_buffer<float>(env, weights, rows.rows, "weights");
+    float* predictions0 =
+        predictions == nullptr ? nullptr : direct_buffer<float>(env, predictions, rows.rows, "predictions");
+
+    for (size_t r = 0; r < rows.rows; r++)
+    {
+      example& ec = rows.to_example(*all, r);
+      ec.l.simple.label = labels0[r];
+      if (weights0 != nullptr) ec.l.simple.weight = weights0[r];
+      count_label(all->sd, ec.l.simple.label);
+      VW::setup_example(*all, &ec);
+      all->example_parser->end_parsed_examples++;
+      all->learn(ec);
+      if (predictions0 != nullptr) predictions0[r] = scalar_prediction(*all, ec);
+      VW::LEARNER::as_singleline(all->l)->finish_example(*all, ec);
+    }
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_predictBatch(JNIEnv* env, jobject vwObj,
+    jint numRows, jchar ns, jobject indices, jobject values, jobject offsets, jobject predictions)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  try
+  {
+    check_batchable(*all);
+    batch_rows rows(env, numRows, ns, indices, values, offsets);
+    float* predictions0 = direct_buffer<float>(env, predictions, rows.rows, "predictions");
+
+    for (size_t r = 0; r < rows.rows; r++)
+    {
+      example& ec = rows.to_example(*all, r);
+      VW::setup_example(*all, &ec);
+      all->example_parser->end_parsed_examples++;
+      all->predict(ec);
+      predictions0[r] = scalar_prediction(*all, ec);
+      VW::LEARNER::as_singleline(all->l)->finish_example(*all, ec);
+    }
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_performRemainingPasses(JNIEnv* env, jobject vwObj)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  try
+  {
+    if (all->numpasses > 1)
+    {
+      all->do_reset_source = true;
+      VW::start_parser(*all);
+      VW::LEARNER::generic_driver(*all);
+      VW::end_parser(*all);
+    }
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT jbyteArray JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getModel(JNIEnv* env, jobject vwObj)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  try
+  {  // save in stl::vector
+    auto model_buffer = std::make_shared<std::vector<char>>();
+    io_buf buffer;
+    buffer.add_file(VW::io::create_vector_writer(model_buffer));
+    VW::save_predictor(*all, buffer);
+
+    // copy to Java
+    jbyteArray ret = env->NewByteArray(model_buffer->size());
+    CHECK_JNI_EXCEPTION(nullptr);
+
+    env->SetByteArrayRegion(ret, 0, model_buffer->size(), (const jbyte*)&model_buffer->data()[0]);
+    CHECK_JNI_EXCEPTION(nullptr);
+
+    return ret;
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return nullptr;
+  }
+}
+
+JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getArguments(JNIEnv* env, jobject vwObj)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  // serialize the command line
+  VW::config::options_serializer_boost_po serializer;
+  for (auto const& option : all->options->get_all_options())
+  {
+    if (all->options->was_supplied(option->m_name))
+    {
+      serializer.add(*option);
+    }
+  }
+
+  // move it to Java
+  // Note: don't keep serializer.str().c_str() around in some variable. it get's deleted after str() is de-allocated
+  jstring args = env->NewStringUTF(serializer.str().c_str());
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  jclass clazz = env->FindClass("org/vowpalwabbit/spark/VowpalWabbitArguments");
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  jmethodID ctor = env->GetMethodID(clazz, "<init>", "(IILjava/lang/String;DD)V");
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  return env->NewObject(clazz, ctor, all->num_bits, all->hash_seed, args, all->eta, all->power_t);
+}
+
+JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getPerformanceStatistics(
+    JNIEnv* env, jobject vwObj)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  long numberOfExamplesPerPass;
+  double weightedExampleSum;
+  double weightedLabelSum;
+  double averageLoss;
+  float bestConstant;
+  float bestConstantLoss;
+  long totalNumberOfFeatures;
+
+  if (all->current_pass == 0)
+    numberOfExamplesPerPass = all->sd->example_number;
+  else
+    numberOfExamplesPerPass = all->sd->example_number / all->current_pass;
+
+  weightedExampleSum = all->sd->weighted_examples();
+  weightedLabelSum = all->sd->weighted_labels;
+
+  if (all->holdout_set_off)
+    if (all->sd->weighted_labeled_examples > 0)
+      averageLoss = all->sd->sum_loss / all->sd->weighted_labeled_examples;
+    else
+      averageLoss = 0;  // TODO should report NaN, but not clear how to do in platform independent manner
+  else if ((all->sd->holdout_best_loss == FLT_MAX) || (all->sd->holdout_best_loss == FLT_MAX * 0.5))
+    averageLoss = 0;  // TODO should report NaN, but not clear how to do in platform independent manner
+  else
+    averageLoss = all->sd->holdout_best_loss;
+
+  get_best_constant(*all, bestConstant, bestConstantLoss);
+  totalNumberOfFeatures = all->sd->total_features;
+
+  jclass clazz = env->FindClass("org/vowpalwabbit/spark/VowpalWabbitPerformanceStatistics");
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  jmethodID ctor = env->GetMethodID(clazz, "<init>", "(JDDDFFJ)V");
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  return env->NewObject(clazz, ctor, numberOfExamplesPerPass, weightedExampleSum, weightedLabelSum, averageLoss,
+      bestConstant, bestConstantLoss, totalNumberOfFeatures);
+}
+
+JNIEXPORT jobjectArray JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getStageStatistics(
+    JNIEnv* env, jobject vwObj)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  std::vector<VW::stage_statistics> stages;
+  if (all->profiler != nullptr) stages = all->profiler->statistics();
+
+  jclass clazz = env->FindClass("org/vowpalwabbit/spark/VowpalWabbitStageStatistics");
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  jmethodID ctor = env->GetMethodID(clazz, "<init>", "(Ljava/lang/String;JJDD)V");
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  jobjectArray result = env->NewObjectArray(static_cast<jsize>(stages.size()), clazz, nullptr);
+  CHECK_JNI_EXCEPTION(nullptr);
+
+  for (size_t i = 0; i < stages.size(); i++)
+  {
+    jstring name = env->NewStringUTF(stages[i].name.c_str());
+    jobject stage = env->NewObject(clazz, ctor, name, static_cast<jlong>(stages[i].calls),
+        static_cast<jlong>(stages[i].samples), stages[i].seconds, stages[i].self_seconds);
+    CHECK_JNI_EXCEPTION(nullptr);
+    env->SetObjectArrayElement(result, static_cast<jsize>(i), stage);
+    env->DeleteLocalRef(stage);
+    env->DeleteLocalRef(name);
+  }
+
+  return result;
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_endPass(JNIEnv* env, jobject vwObj)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  try
+  {
+    // note: this code duplication seems bound for trouble
+    // from parse_dispatch_loop.h:26
+    // from learner.cc:41
+    reset_source(*all, all->num_bits);
+    all->do_reset_source = false;
+    all->passes_complete++;
+
+    all->current_pass++;
+    all->l->end_pass();
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_finish(JNIEnv* env, jobject vwObj)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+
+  try
+  {
+    VW::sync_stats(*all);
+    VW::finish(*all);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT jint JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_hash(
+    JNIEnv* env, jclass, jbyteArray data, jint offset, jint len, jint seed)
+{
+  CriticalArrayGuard dataGuard(env, data);
+  const char* values0 = (const char*)dataGuard.data();
+
+  return (jint)uniform_hash(values0 + offset, len, seed);
+}
+
+JNIEXPORT jint JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_hashFeature(
+    JNIEnv* env, jobject vwObj, jbyteArray data, jint offset, jint len, jint seed)
+{
+  auto* all = reinterpret_cast<vw*>(get_native_pointer(env, vwObj));
+  CriticalArrayGuard dataGuard(env, data);
+  const char* values0 = (const char*)dataGuard.data();
+
+  // the seeds are 32 bit hashes, which xxh3 is not to see sign extended
+  return (jint)all->example_parser->all_hasher(values0 + offset, len, static_cast<uint32_t>(seed));
+}
+
+// VW Example
+#define INIT_VARS                                                                                      \
+  auto exWrapper = reinterpret_cast<VowpalWabbitExampleWrapper*>(get_native_pointer(env, exampleObj)); \
+  vw* all = exWrapper->_all;                                                                           \
+  example* ex = exWrapper->_example;
+
+JNIEXPORT jlong JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_initialize(
+    JNIEnv* env, jclass, jlong vwPtr, jboolean isEmpty)
+{
+  auto* all = reinterpret_cast<vw*>(vwPtr);
+
+  try
+  {
+    example* ex = VW::alloc_examples(1);
+    ex->interactions = &all->interactions;
+
+    if (isEmpty)
+    {
+      char empty = '\0';
+      VW::read_line(*all, ex, &empty);
+    }
+    else
+      all->example_parser->lbl_parser.default_label(&ex->l);
+
+    return reinterpret_cast<jlong>(new VowpalWabbitExampleWrapper(all, ex));
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return 0;
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_finish(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  try
+  {
+    VW::dealloc_example(all->example_parser->lbl_parser.delete_label, *ex);
+    ::free_it(ex);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_clear(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  try
+  {
+    VW::empty_example(*all, *ex);
+    all->example_parser->lbl_parser.default_label(&ex->l);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+void addNamespaceIfNotExists(vw* all, example* ex, char ns)
+{
+  if (std::find(ex->indices.begin(), ex->indices.end(), ns) == ex->indices.end())
+  {
+    ex->indices.push_back(ns);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_addToNamespaceDense(
+    JNIEnv* env, jobject exampleObj, jchar ns, jint weight_index_base, jdoubleArray values)
+{
+  INIT_VARS
+
+  try
+  {
+    addNamespaceIfNotExists(all, ex, ns);
+
+    auto features = &ex->feature_space[ns];
+
+    CriticalArrayGuard valuesGuard(env, values);
+    double* values0 = (double*)valuesGuard.data();
+
+    int size = env->GetArrayLength(values);
+    int mask = (1 << all->num_bits) - 1;
+
+    // pre-allocate
+    features->values.resize(features->values.end() - features->values.begin() + size);
+    features->indicies.resize(features->indicies.end() - features->indicies.begin() + size);
+
+    double* values_itr = values0;
+    double* values_end = values0 + size;
+    for (; values_itr != values_end; ++values_itr, ++weight_index_base)
+    {
+      float x = *values_itr;
+      if (x != 0)
+      {
+        features->values.push_back_unchecked(x);
+        features->indicies.push_back_unchecked(weight_index_base & mask);
+      }
+    }
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_addToNamespaceSparse(
+    JNIEnv* env, jobject exampleObj, jchar ns, jintArray indices, jdoubleArray values)
+{
+  INIT_VARS
+
+  try
+  {
+    addNamespaceIfNotExists(all, ex, ns);
+
+    auto features = &ex->feature_space[ns];
+
+    CriticalArrayGuard indicesGuard(env, indices);
+    int* indices0 = (int*)indicesGuard.data();
+
+    CriticalArrayGuard valuesGuard(env, values);
+    double* values0 = (double*)valuesGuard.data();
+
+    int size = env->GetArrayLength(indices);
+    int mask = (1 << all->num_bits) - 1;
+
+    // pre-allocate
+    features->values.resize(features->values.end() - features->values.begin() + size);
+    features->indicies.resize(features->indicies.end() - features->indicies.begin() + size);
+
+    int* indices_itr = indices0;
+    int* indices_end = indices0 + size;
+    double* values_itr = values0;
+    for (; indices_itr != indices_end; ++indices_itr, ++values_itr)
+    {
+      float x = *values_itr;
+      if (x != 0)
+      {
+        features->values.push_back_unchecked(x);
+        features->indicies.push_back_unchecked(*indices_itr & mask);
+      }
+    }
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setLabel(
+    JNIEnv* env, jobject exampleObj, jfloat weight, jfloat label)
+{
+  INIT_VARS
+
+  try
+  {
+    label_data* ld = &ex->l.simple;
+    ld->label = label;
+    ld->weight = weight;
+
+    count_label(all->sd, ld->label);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setDefaultLabel(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  try
+  {
+    all->example_parser->lbl_parser.default_label(&ex->l);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setContextualBanditLabel(
+    JNIEnv* env, jobject exampleObj, jint action, jdouble cost, jdouble probability)
+{
+  INIT_VARS
+
+  try
+  {
+    CB::label* ld = &ex->l.cb;
+    CB::cb_class f;
+
+    f.action = (uint32_t)action;
+    f.cost = (float)cost;
+    f.probability = (float)probability;
+
+    ld->costs.push_back(f);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_setSharedLabel(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  try
+  {
+    // https://github.com/VowpalWabbit/vowpal_wabbit/blob/master/vowpalwabbit/parse_example_json.h#L437
+    CB::label* ld = &ex->l.cb;
+    CB::cb_class f;
+
+    f.partial_prediction = 0.;
+    f.action = (uint32_t)uniform_hash("shared", 6 /*length of string*/, 0);
+    f.cost = FLT_MAX;
+    f.probability = -1.f;
+
+    ld->costs.push_back(f);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_getPrediction(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  return getJavaPrediction(env, all, ex);
+}
+
+JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_learn(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  try
+  {
+    VW::setup_example(*all, ex);
+
+    all->learn(*ex);
+
+    // as this is not a ring-based example it is not free'd
+    VW::LEARNER::as_singleline(all->l)->finish_example(*all, *ex);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+  }
+}
+
+JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_predict(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  try
+  {
+    VW::setup_example(*all, ex);
+
+    all->predict(*ex);
+
+    // as this is not a ring-based example it is not free'd
+    VW::LEARNER::as_singleline(all->l)->finish_example(*all, *ex);
+
+    return getJavaPrediction(env, all, ex);
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return nullptr;
+  }
+}
+
+JNIEXPORT jstring JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitExample_toString(JNIEnv* env, jobject exampleObj)
+{
+  INIT_VARS
+
+  try
+  {
+    std::ostringstream ostr;
+
+    ostr << "VowpalWabbitExample(label=";
+    auto lp = all->example_parser->lbl_parser;
+
+    if (!memcmp(&lp, &simple_label_parser, sizeof(lp)))
+    {
+      label_data* ld = &ex->l.simple;
+      ostr << "simple " << ld->label << ":" << ld->weight << ":" << ld->initial;
+    }
+    else if (!memcmp(&lp, &CB::cb_label, sizeof(lp)))
+    {
+      CB::label* ld = &ex->l.cb;
+      ostr << "CB " << ld->costs.size();
+
+      if (ld->costs.size() > 0)
+      {
+        ostr << " ";
+
+        CB::cb_class& f = ld->costs[0];
+
+        // Ignore checking if f.action == uniform_hash("shared")
+        if (f.partial_prediction == 0 && f.cost == FLT_MAX && f.probability == -1.f)
+          ostr << "shared";
+        else
+          ostr << f.action << ":" << f.cost << ":" << f.probability;
+      }
+    }
+    else
+    {
+      ostr << "unsupported label";
+    }
+
+    ostr << ";";
+    for (auto& ns : ex->indices)
+    {
+      if (ns == 0)
+        ostr << "NULL:0,";
+      else
+      {
+        if ((ns >= 'a' && ns <= 'z') || (ns >= 'A' && ns <= 'Z'))
+          ostr << "'" << (char)ns << "':";
+
+        ostr << (int)ns << ",";
+      }
+
+      for (auto& f : ex->feature_space[ns])
+      {
+        auto idx = f.index();
+        ostr << (idx & all->weights.mask()) << "/" << idx << ":" << f.value() << ", ";
+      }
+    }
+
+    ostr << ")";
+
+    return env->NewStringUTF(ostr.str().c_str());
+  }
+  catch (...)
+  {
+    rethrow_cpp_exception_as_java_exception(env);
+    return nullptr;
+  }
+}
+
+// re-use prediction conversation methods
+jobject multilabel_predictor(example* vec, JNIEnv* env);
+jfloatArray scalars_predictor(example* vec, JNIEnv* env);
+jobject action_scores_prediction(example* vec, JNIEnv* env);
+jobject action_probs_prediction(example* vec, JNIEnv* env);
+
+jobject getJavaPrediction(JNIEnv* env, vw* all, example* ex)
+{
+  jclass predClass;
+  jmethodID ctr;
+  switch (all->l->pred_type)
+  {
+    case prediction_type_t::scalar:
+      predClass = env->FindClass("org/vowpalwabbit/spark/prediction/ScalarPrediction");
+      CHECK_JNI_EXCEPTION(nullptr);
+
+      ctr = env->GetMethodID(predClass, "<init>", "(FF)V");
+      CHECK_JNI_EXCEPTION(nullptr);
+
+      return env->NewObject(predClass, ctr, VW::get_prediction(ex), ex->confidence);
+
+    case prediction_type_t::prob:
+      predClass = env->FindClass("java/lang/Float");
+      CHECK_JNI_EXCEPTION(nullptr);
+
+      ctr = env->GetMethodID(predClass, "<init>", "(F)V");
+      CHECK_JNI_EXCEPTION(nullptr);
+
+      return env->NewObject(predClass, ctr, ex->pred.prob);
+
+    case prediction_type_t::multiclass:
+      predClass = env->FindClass("java/lang/Integer");
+      CHECK_JNI_EXCEPTION(nullptr);
+
+      ctr = env->GetMethodID(predClass, "<init>", "(I)V");
+      CHECK_JNI_EXCEPTION(nullptr);
+
+      return env->NewObject(predClass, ctr, ex->pred.multiclass);
+
+    case prediction_type_t::scalars:
+      return scalars_predictor(ex, env);
+
+    case prediction_type_t::action_probs:
+      return action_probs_prediction(ex, env);
+
+    case prediction_type_t::action_scores:
+      return action_scores_prediction(ex, env);
+
+    case prediction_type_t::multilabels:
+      return multilabel_predictor(ex, env);
+
+    default:
+    {
+      std::ostringstream ostr;
+      ostr << "prediction type '" << to_string(all->l->pred_type) << "' is not supported";
+
+      env->ThrowNew(env->FindClass("java/lang/UnsupportedOperationException"), ostr.str().c_str());
+      return nullptr;
+    }
+  }
+}
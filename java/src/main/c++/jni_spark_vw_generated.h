@@ -37,6 +37,22 @@ extern "C"
    */
   JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_predict(JNIEnv *, jobject, jobjectArray);
 
+  /*
+   * Class:     org_vowpalwabbit_spark_VowpalWabbitNative
+   * Method:    learnBatch
+   * Signature: (ICLjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)V
+   */
+  JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_learnBatch(
+      JNIEnv *, jobject, jint, jchar, jobject, jobject, jobject, jobject, jobject, jobject);
+
+  /*
+   * Class:     org_vowpalwabbit_spark_VowpalWabbitNative
+   * Method:    predictBatch
+   * Signature: (ICLjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)V
+   */
+  JNIEXPORT void JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_predictBatch(
+      JNIEnv *, jobject, jint, jchar, jobject, jobject, jobject, jobject);
+
   /*
    * Class:     org_vowpalwabbit_spark_VowpalWabbitNative
    * Method:    performRemainingPasses
@@ -65,6 +81,13 @@ extern "C"
    */
   JNIEXPORT jobject JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getPerformanceStatistics(JNIEnv *, jobject);
 
+  /*
+   * Class:     org_vowpalwabbit_spark_VowpalWabbitNative
+   * Method:    getStageStatistics
+   * Signature: ()[Lorg/vowpalwabbit/spark/VowpalWabbitStageStatistics;
+   */
+  JNIEXPORT jobjectArray JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_getStageStatistics(JNIEnv *, jobject);
+
   /*
    * Class:     org_vowpalwabbit_spark_VowpalWabbitNative
    * Method:    endPass
@@ -87,6 +110,14 @@ extern "C"
   JNIEXPORT jint JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_hash(
       JNIEnv *, jclass, jbyteArray, jint, jint, jint);
 
+  /*
+   * Class:     org_vowpalwabbit_spark_VowpalWabbitNative
+   * Method:    hashFeature
+   * Signature: ([BIII)I
+   */
+  JNIEXPORT jint JNICALL Java_org_vowpalwabbit_spark_VowpalWabbitNative_hashFeature(
+      JNIEnv *, jobject, jbyteArray, jint, jint, jint);
+
 #ifdef __cplusplus
 }
 #endif
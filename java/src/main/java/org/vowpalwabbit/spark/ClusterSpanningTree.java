@@ -1,34 +1,72 @@
-package org.vowpalwabbit.spark;
-
-import java.io.Closeable;
-
-/**
- * Wraps the spanning tree coordinator native code used to orchestrate multipe VW instances.
- * 
- * @author Markus Cozowicz
- */
-public class ClusterSpanningTree implements Closeable {
-    static {
-        Native.load();
-    }
-
-    private static native long create(int port, boolean quiet);
-    private native void delete();
-    public native void start(); 
-    public native void stop();
-    public native int getPort();
-
-    private long nativePointer;
-
-    public ClusterSpanningTree(int port, boolean quiet) {
-        this.nativePointer = create(port, quiet);
-    }
-
-    @Override
-    final public void close() {
-        if (this.nativePointer != 0) {
-            delete();
-            this.nativePointer = 0;
-        }
-    }
+package org.vowpalwabbit.spark;
+
+import java.io.Closeable;
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * Wraps the spanning tree coordinator native code used to orchestrate multipe VW instances.
+ * 
+ * @author Markus Cozowicz
+ */
+public class ClusterSpanningTree implements Closeable {
+    static {
+        Native.load();
+    }
+
+    private static native long create(int port, boolean quiet);
+    private native void delete();
+    public native void start(); 
+    public native void stop();
+    public native int getPort();
+
+    private long nativePointer;
+
+    public ClusterSpanningTree(int port, boolean quiet) {
+        this.nativePointer = create(port, quiet);
+    }
+
+    /**
+     * The cluster arguments of a task of a job whose tasks share the memory of
+     * the process they run in, such as the tasks of a Spark executor. The tasks
+     * of a process allreduce in shared memory first, and only the first of them
+     * connects to the spanning tree, so the processes are its nodes.
+     * 
+     * <p>
+     * The arguments are --total, --node, --local_total, --local_node,
+     * --span_total and --span_node, to be added to --span_server and --unique_id.
+     * </p>
+     * 
+     * @param processes the process each task of the job runs in, the address of
+     *                  its executor for instance.
+     * @param task      the task to return the arguments of.
+     * @return the arguments.
+     */
+    public static String hierarchicalArguments(String[] processes, int task) {
+        List<String> distinct = new ArrayList<>();
+        int localTotal = 0;
+        int localNode = 0;
+        for (int i = 0; i < processes.length; i++) {
+            if (!distinct.contains(processes[i]))
+                distinct.add(processes[i]);
+
+            if (processes[i].equals(processes[task])) {
+                if (i < task)
+                    localNode++;
+                localTotal++;
+            }
+        }
+
+        return " --total " + processes.length + " --node " + task + " --local_total " + localTotal + " --local_node "
+                + localNode + " --span_total " + distinct.size() + " --span_node "
+                + distinct.indexOf(processes[task]);
+    }
+
+    @Override
+    final public void close() {
+        if (this.nativePointer != 0) {
+            delete();
+            this.nativePointer = 0;
+        }
+    }
 }
\ No newline at end of file
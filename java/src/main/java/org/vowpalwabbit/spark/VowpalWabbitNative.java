@@ -1,149 +1,218 @@
-package org.vowpalwabbit.spark;
-
-import java.io.Closeable;
-
-/**
- * Main wrapper for VowpalWabbit native implementation.
- * 
- * @author Markus Cozowicz
- */
-public class VowpalWabbitNative implements Closeable {
-    static {
-        // load the native libraries
-        Native.load();
-    }
-
-    /**
-     * Initializes the native VW data structures.
-     * 
-     * @param args VW command line arguments.
-     * @return pointer to vw data structure defined in global_data.h.
-     */
-    private static native long initialize(String args);
-
-    /**
-     * Initializes the native VW data structures.
-     * 
-     * <p>
-     * Note: The {@code args} must be compatible with the command line arguments
-     * stored in {@code model}.
-     * </p>
-     * 
-     * @param args  VW command line arguments.
-     * @param model VW model to initialize this instance from.
-     * @return pointer to vw data structure defined in global_data.h.
-     */
-    private static native long initializeFromModel(String args, byte[] model);
-
-    /**
-     * Invoke multi-line learning.
-     * 
-     * @param examples the examples to learn from.
-     * @return the one-step ahead prediction.
-     */
-    public native Object learn(VowpalWabbitExample[] examples);
-
-    /**
-     * Invoke multi-line prediction.
-     * 
-     * @param examples the example to predict for.
-     * @return the prediction.
-     */
-    public native Object predict(VowpalWabbitExample[] examples);
-
-    /**
-     * Perform remaining passes.
-     */
-    public native void performRemainingPasses();
-
-    /**
-     * Returns a snapshot of the current model.
-     * 
-     * @return serialized VW model.
-     */
-    public native byte[] getModel();
-
-    /**
-     * Returns a subset of the current arguments VW received (e.g. numbits)
-     * 
-     * @return VW argument object.
-     */
-    public native VowpalWabbitArguments getArguments();
-
-    public native VowpalWabbitPerformanceStatistics getPerformanceStatistics();
-
-    /**
-     * Signals the end of the current pass over the data.
-     */
-    public native void endPass();
-
-    /**
-     * Free's the vw data structure.
-     */
-    private native void finish();
-
-    /**
-     * Invokes the native implementation of Murmur hash. Exposed through
-     * VowpalWabbitMurmur.
-     */
-    static native int hash(byte[] data, int offset, int len, int seed);
-
-    /**
-     * Pointer to vw data structure defined in global_data.h
-     */
-    private long nativePointer;
-
-    /**
-     * Initializes the native VW data structures.
-     * 
-     * @param args VW command line arguments.
-     */
-    public VowpalWabbitNative(String args) {
-        this.nativePointer = initialize(args);
-    }
-
-    /**
-     * Initializes the native VW data structures.
-     * 
-     * <p>
-     * Note: The {@code args} must be compatible with the command line arguments
-     * stored in {@code model}.
-     * </p>
-     * 
-     * @param args  VW command line arguments.
-     * @param model VW model to initialize this instance from.
-     */
-    public VowpalWabbitNative(String args, byte[] model) {
-        this.nativePointer = initializeFromModel(args, model);
-    }
-
-    /**
-     * Creates a new VW example associated with this this instance.
-     * 
-     * @return new {@code VowpalWabbitExample} object.
-     */
-    public VowpalWabbitExample createExample() {
-        return new VowpalWabbitExample(this.nativePointer, false);
-    }
-
-    /**
-     * Creates a new empty VW example associated with this this instance. This is
-     * used to mark the end of a multiline example.
-     * 
-     * @return new {@code VowpalWabbitExample} object.
-     */
-    public VowpalWabbitExample createEmptyExample() {
-        return new VowpalWabbitExample(this.nativePointer, true);
-    }
-
-    /**
-     * Frees the native resources.
-     */
-    @Override
-    final public void close() {
-        if (this.nativePointer != 0) {
-            finish();
-            this.nativePointer = 0;
-        }
-    }
+package org.vowpalwabbit.spark;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Main wrapper for VowpalWabbit native implementation.
+ * 
+ * @author Markus Cozowicz
+ */
+public class VowpalWabbitNative implements Closeable {
+    static {
+        // load the native libraries
+        Native.load();
+    }
+
+    /**
+     * Initializes the native VW data structures.
+     * 
+     * @param args VW command line arguments.
+     * @return pointer to vw data structure defined in global_data.h.
+     */
+    private static native long initialize(String args);
+
+    /**
+     * Initializes the native VW data structures.
+     * 
+     * <p>
+     * Note: The {@code args} must be compatible with the command line arguments
+     * stored in {@code model}.
+     * </p>
+     * 
+     * @param args  VW command line arguments.
+     * @param model VW model to initialize this instance from.
+     * @return pointer to vw data structure defined in global_data.h.
+     */
+    private static native long initializeFromModel(String args, byte[] model);
+
+    /**
+     * Invoke multi-line learning.
+     * 
+     * @param examples the examples to learn from.
+     * @return the one-step ahead prediction.
+     */
+    public native Object learn(VowpalWabbitExample[] examples);
+
+    /**
+     * Invoke multi-line prediction.
+     * 
+     * @param examples the example to predict for.
+     * @return the prediction.
+     */
+    public native Object predict(VowpalWabbitExample[] examples);
+
+    /**
+     * Learns from a batch of rows in a single native call, each row as if it
+     * were an example of its own, in order.
+     * 
+     * <p>
+     * The features of row {@code r} are the {@code indices} and {@code values}
+     * from {@code offsets[r]} to {@code offsets[r + 1]}, which are added to
+     * namespace {@code ns} as {@link VowpalWabbitExample#addToNamespaceSparse}
+     * adds them. All buffers must be direct and in native byte order, as
+     * {@link #allocateBatchBuffer} allocates them: {@code offsets} holds
+     * {@code numRows + 1} ints, {@code indices} ints and {@code values} floats,
+     * and {@code labels}, {@code weights} and {@code predictions} a float per
+     * row. Only single line reductions of simple labels and scalar predictions
+     * are supported.
+     * </p>
+     * 
+     * @param numRows     the number of rows of the batch.
+     * @param ns          the namespace of the features.
+     * @param indices     the hashed feature indices.
+     * @param values      the feature values.
+     * @param offsets     where the features of each row start, and the end.
+     * @param labels      the label of each row.
+     * @param weights     the importance weight of each row, or null for 1.
+     * @param predictions receives the one-step ahead prediction of each row, or
+     *                    null.
+     */
+    public native void learnBatch(int numRows, char ns, ByteBuffer indices, ByteBuffer values, ByteBuffer offsets,
+            ByteBuffer labels, ByteBuffer weights, ByteBuffer predictions);
+
+    /**
+     * Predicts a batch of rows in a single native call. The rows are passed as
+     * to {@link #learnBatch}.
+     * 
+     * @param numRows     the number of rows of the batch.
+     * @param ns          the namespace of the features.
+     * @param indices     the hashed feature indices.
+     * @param values      the feature values.
+     * @param offsets     where the features of each row start, and the end.
+     * @param predictions receives the prediction of each row.
+     */
+    public native void predictBatch(int numRows, char ns, ByteBuffer indices, ByteBuffer values, ByteBuffer offsets,
+            ByteBuffer predictions);
+
+    /**
+     * Allocates a direct buffer of ints or floats in native byte order, as
+     * {@link #learnBatch} and {@link #predictBatch} take them.
+     * 
+     * @param count the number of 4 byte items.
+     * @return the buffer.
+     */
+    public static ByteBuffer allocateBatchBuffer(int count) {
+        return ByteBuffer.allocateDirect(count * 4).order(ByteOrder.nativeOrder());
+    }
+
+    /**
+     * Perform remaining passes.
+     */
+    public native void performRemainingPasses();
+
+    /**
+     * Returns a snapshot of the current model.
+     * 
+     * @return serialized VW model.
+     */
+    public native byte[] getModel();
+
+    /**
+     * Returns a subset of the current arguments VW received (e.g. numbits)
+     * 
+     * @return VW argument object.
+     */
+    public native VowpalWabbitArguments getArguments();
+
+    public native VowpalWabbitPerformanceStatistics getPerformanceStatistics();
+
+    /**
+     * Returns the time spent in each stage of the run so far.
+     * 
+     * @return the stages, none unless --stage_timing was passed.
+     */
+    public native VowpalWabbitStageStatistics[] getStageStatistics();
+
+    /**
+     * Signals the end of the current pass over the data.
+     */
+    public native void endPass();
+
+    /**
+     * Free's the vw data structure.
+     */
+    private native void finish();
+
+    /**
+     * Invokes the native implementation of Murmur hash. Exposed through
+     * VowpalWabbitMurmur.
+     */
+    static native int hash(byte[] data, int offset, int len, int seed);
+
+    /**
+     * Hashes as the features of this model are hashed, with the --hash_function recorded in it, which is murmur3 as
+     * in hash unless the model was trained with --hash_function xxh3.
+     */
+    public native int hashFeature(byte[] data, int offset, int len, int seed);
+
+    /**
+     * Pointer to vw data structure defined in global_data.h
+     */
+    private long nativePointer;
+
+    /**
+     * Initializes the native VW data structures.
+     * 
+     * @param args VW command line arguments.
+     */
+    public VowpalWabbitNative(String args) {
+        this.nativePointer = initialize(args);
+    }
+
+    /**
+     * Initializes the native VW data structures.
+     * 
+     * <p>
+     * Note: The {@code args} must be compatible with the command line arguments
+     * stored in {@code model}.
+     * </p>
+     * 
+     * @param args  VW command line arguments.
+     * @param model VW model to initialize this instance from.
+     */
+    public VowpalWabbitNative(String args, byte[] model) {
+        this.nativePointer = initializeFromModel(args, model);
+    }
+
+    /**
+     * Creates a new VW example associated with this this instance.
+     * 
+     * @return new {@code VowpalWabbitExample} object.
+     */
+    public VowpalWabbitExample createExample() {
+        return new VowpalWabbitExample(this.nativePointer, false);
+    }
+
+    /**
+     * Creates a new empty VW example associated with this this instance. This is
+     * used to mark the end of a multiline example.
+     * 
+     * @return new {@code VowpalWabbitExample} object.
+     */
+    public VowpalWabbitExample createEmptyExample() {
+        return new VowpalWabbitExample(this.nativePointer, true);
+    }
+
+    /**
+     * Frees the native resources.
+     */
+    @Override
+    final public void close() {
+        if (this.nativePointer != 0) {
+            finish();
+            this.nativePointer = 0;
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+package org.vowpalwabbit.spark;
+
+/**
+ * Holds the time spent in a stage of the run (e.g. parse or the learn of a
+ * reduction), as sampled with --stage_timing.
+ */
+public class VowpalWabbitStageStatistics implements java.io.Serializable {
+	private static final long serialVersionUID = 1L;
+
+	private String name;
+
+	private long calls;
+
+	private long samples;
+
+	private double seconds;
+
+	private double selfSeconds;
+
+	public VowpalWabbitStageStatistics(String name, long calls, long samples, double seconds, double selfSeconds) {
+		this.name = name;
+		this.calls = calls;
+		this.samples = samples;
+		this.seconds = seconds;
+		this.selfSeconds = selfSeconds;
+	}
+
+	/**
+	 * @return the name of the stage, the learn and predict of a reduction
+	 *         followed by its name
+	 */
+	public String getName() {
+		return name;
+	}
+
+	/**
+	 * @return the number of calls of the stage
+	 */
+	public long getCalls() {
+		return calls;
+	}
+
+	/**
+	 * @return the number of calls which were timed
+	 */
+	public long getSamples() {
+		return samples;
+	}
+
+	/**
+	 * @return the estimated seconds spent in all calls, including the
+	 *         reductions below for learn and predict
+	 */
+	public double getSeconds() {
+		return seconds;
+	}
+
+	/**
+	 * @return the estimated seconds spent in all calls, less those spent in the
+	 *         stages they called, e.g. the reductions below
+	 */
+	public double getSelfSeconds() {
+		return selfSeconds;
+	}
+}
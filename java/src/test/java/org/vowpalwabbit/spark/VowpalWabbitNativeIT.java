@@ -1,233 +1,363 @@
-package org.vowpalwabbit.spark;
-
-import org.junit.Test;
-import static org.junit.Assert.*;
-import java.io.*;
-import java.nio.file.*;
-import java.nio.charset.Charset;
-import java.nio.charset.StandardCharsets;
-import java.util.*;
-import org.vowpalwabbit.spark.prediction.*;
-
-/**
- * command line invocation
- * 
- * mvn verify -Dtest=foo
- * -Dit.test=org.vowpalwabbit.spark.VowpalWabbitNativeIT#testAudit
- * -DfailIfNoTests=false -Dmaven.javadoc.skip=true
- * 
- * @author Markus Cozowicz
- */
-public class VowpalWabbitNativeIT {
-    @Test
-    public void testHashing() throws Exception {
-        String w1 = "ஜெய்";
-
-        byte[] sarr = ("a" + w1).getBytes(StandardCharsets.UTF_8);
-
-        int h1 = VowpalWabbitMurmur.hash(sarr, 0, sarr.length, -1801964169);
-        int h1n = VowpalWabbitMurmur.hashNative(sarr, 0, sarr.length, -1801964169);
-
-        assertEquals(h1, h1n);
-    }
-
-    @Test
-    public void testWrappedVsCommandLine() throws Exception {
-        String vwBinary = Files.readAllLines(Paths.get(getClass().getResource("/vw-bin.txt").getPath())).get(0);
-
-        // need to use confidence_after_training as otherwise the numbers don't match
-        // up...
-        Runtime.getRuntime().exec(vwBinary
-                + " --quiet --confidence --confidence_after_training -f target/testSimple1-ref.model -d src/test/resources/test.txt -p target/testSimple1-ref.pred")
-                .waitFor();
-
-        byte[] modelRef = Files.readAllBytes(Paths.get("target/testSimple1-ref.model"));
-        List<String> predsRef = Files.readAllLines(Paths.get("target/testSimple1-ref.pred"), Charset.defaultCharset());
-
-        byte[] model;
-        VowpalWabbitNative vw = null;
-        VowpalWabbitExample ex = null;
-        FileOutputStream out = null;
-
-        try {
-            vw = new VowpalWabbitNative("--quiet --confidence --confidence_after_training");
-            ex = vw.createExample();
-
-            for (int i = 0; i < 10; i++) {
-                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
-                ex.setLabel(i % 2);
-
-                ex.learn();
-
-                ScalarPrediction pred = (ScalarPrediction) ex.getPrediction();
-
-                String[] scalarAndConfidenceRef = predsRef.get(i).split(" ");
-
-                // compare predictions and confidence
-                assertEquals(Float.parseFloat(scalarAndConfidenceRef[0]), pred.getValue(), 1e-4);
-                assertEquals(Float.parseFloat(scalarAndConfidenceRef[1]), pred.getConfidence(), 1e-4);
-
-                ex.clear();
-            }
-
-            vw.endPass();
-
-            model = vw.getModel();
-            out = new FileOutputStream("target/testSimple1.model");
-            out.write(model);
-
-        } finally {
-            if (out != null)
-                out.close();
-
-            if (ex != null)
-                ex.close();
-
-            if (vw != null)
-                vw.close();
-        }
-
-        // compare model
-        assertArrayEquals(model, modelRef);
-    }
-
-    @Test
-    public void testPrediction() throws Exception {
-        byte[] model;
-        float learnPrediction = 0f;
-        VowpalWabbitNative vw = null;
-        VowpalWabbitExample ex = null;
-
-        try {
-            vw = new VowpalWabbitNative("--quiet");
-            ex = vw.createExample();
-            for (int i = 0; i < 10; i++) {
-                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
-                ex.setLabel(i % 2);
-
-                ex.learn();
-                ex.clear();
-            }
-
-            vw.endPass();
-
-            ex.close();
-
-            model = vw.getModel();
-
-            ex = vw.createExample();
-            ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
-
-            ex.predict();
-
-            ScalarPrediction pred = (ScalarPrediction) ex.getPrediction();
-            learnPrediction = pred.getValue();
-
-            assertTrue(learnPrediction > 0);
-
-            vw.close();
-
-            // test the model
-            vw = new VowpalWabbitNative("--quiet", model);
-            VowpalWabbitArguments args = vw.getArguments();
-
-            assertEquals(18, args.getNumBits());
-            assertEquals(0, args.getHashSeed());
-
-            ex = vw.createExample();
-            ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
-
-            pred = (ScalarPrediction) ex.predict();
-
-            assertEquals(learnPrediction, pred.getValue(), 1e-4);
-        } finally {
-            if (ex != null)
-                ex.close();
-
-            if (vw != null)
-                vw.close();
-        }
-    }
-
-    @Test
-    public void testBFGS() throws Exception {
-        File tempFile = File.createTempFile("vowpalwabbit", ".cache");
-        tempFile.deleteOnExit();
-        String cachePath = tempFile.getAbsolutePath();
-        VowpalWabbitNative vw = null;
-        VowpalWabbitExample ex = null;
-
-        try {
-            vw = new VowpalWabbitNative(
-                    "--loss_function=logistic -l 3.1 --power_t 0.2 --bfgs --passes 2 -k --cache_file=" + cachePath);
-            // make sure getArguments works
-            assertTrue(vw.getArguments().getArgs().contains("--bfgs"));
-
-            ex = vw.createExample();
-
-            for (int i = 0; i < 10; i++) {
-                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
-                ex.setLabel((i % 2) * 2 - 1);
-
-                ex.learn();
-                ex.clear();
-            }
-
-            vw.endPass();
-            vw.performRemainingPasses();
-
-            // validate arguments
-            VowpalWabbitArguments args = vw.getArguments();
-
-            assertEquals(3.1, args.getLearningRate(), 0.001);
-            assertEquals(0.2, args.getPowerT(), 0.001);
-
-            VowpalWabbitPerformanceStatistics stats = vw.getPerformanceStatistics();
-
-            assertEquals(4, stats.getNumberOfExamplesPerPass());
-            assertEquals(9.0, stats.getWeightedExampleSum(), 0.0001);
-            assertEquals(-1.0, stats.getWeightedLabelSum(), 0.0001);
-            assertEquals(0.6931, stats.getAverageLoss(), 0.0001);
-            assertEquals(-0.223144, stats.getBestConstant(), 0.0001);
-            assertEquals(0.6869, stats.getBestConstantLoss(), 0.0001);
-            assertEquals(36, stats.getTotalNumberOfFeatures());
-
-        } finally {
-            if (ex != null)
-                ex.close();
-
-            if (vw != null)
-                vw.close();
-        }
-    }
-
-    @Test
-    public void testAudit() throws Exception {
-        VowpalWabbitNative vw = null;
-        VowpalWabbitExample ex = null;
-
-        try {
-            // exepct no crash, can't directly validate as it writes to stdout
-            vw = new VowpalWabbitNative("--loss_function=logistic --link=logistic -a");
-
-            ex = vw.createExample();
-
-            for (int i = 0; i < 2; i++) {
-                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
-                ex.setLabel((i % 2) * 2 - 1);
-
-                ex.learn();
-                ex.clear();
-            }
-
-            vw.endPass();
-
-        } finally {
-            if (ex != null)
-                ex.close();
-
-            if (vw != null)
-                vw.close();
-        }
-    }
+package org.vowpalwabbit.spark;
+
+import org.junit.Test;
+import static org.junit.Assert.*;
+import java.io.*;
+import java.nio.file.*;
+import java.nio.charset.Charset;
+import java.nio.charset.StandardCharsets;
+import java.nio.ByteBuffer;
+import java.util.*;
+import org.vowpalwabbit.spark.prediction.*;
+
+/**
+ * command line invocation
+ * 
+ * mvn verify -Dtest=foo
+ * -Dit.test=org.vowpalwabbit.spark.VowpalWabbitNativeIT#testAudit
+ * -DfailIfNoTests=false -Dmaven.javadoc.skip=true
+ * 
+ * @author Markus Cozowicz
+ */
+public class VowpalWabbitNativeIT {
+    @Test
+    public void testHashing() throws Exception {
+        String w1 = "ஜெய்";
+
+        byte[] sarr = ("a" + w1).getBytes(StandardCharsets.UTF_8);
+
+        int h1 = VowpalWabbitMurmur.hash(sarr, 0, sarr.length, -1801964169);
+        int h1n = VowpalWabbitMurmur.hashNative(sarr, 0, sarr.length, -1801964169);
+
+        assertEquals(h1, h1n);
+    }
+
+    @Test
+    public void testWrappedVsCommandLine() throws Exception {
+        String vwBinary = Files.readAllLines(Paths.get(getClass().getResource("/vw-bin.txt").getPath())).get(0);
+
+        // need to use confidence_after_training as otherwise the numbers don't match
+        // up...
+        Runtime.getRuntime().exec(vwBinary
+                + " --quiet --confidence --confidence_after_training -f target/testSimple1-ref.model -d src/test/resources/test.txt -p target/testSimple1-ref.pred")
+                .waitFor();
+
+        byte[] modelRef = Files.readAllBytes(Paths.get("target/testSimple1-ref.model"));
+        List<String> predsRef = Files.readAllLines(Paths.get("target/testSimple1-ref.pred"), Charset.defaultCharset());
+
+        byte[] model;
+        VowpalWabbitNative vw = null;
+        VowpalWabbitExample ex = null;
+        FileOutputStream out = null;
+
+        try {
+            vw = new VowpalWabbitNative("--quiet --confidence --confidence_after_training");
+            ex = vw.createExample();
+
+            for (int i = 0; i < 10; i++) {
+                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
+                ex.setLabel(i % 2);
+
+                ex.learn();
+
+                ScalarPrediction pred = (ScalarPrediction) ex.getPrediction();
+
+                String[] scalarAndConfidenceRef = predsRef.get(i).split(" ");
+
+                // compare predictions and confidence
+                assertEquals(Float.parseFloat(scalarAndConfidenceRef[0]), pred.getValue(), 1e-4);
+                assertEquals(Float.parseFloat(scalarAndConfidenceRef[1]), pred.getConfidence(), 1e-4);
+
+                ex.clear();
+            }
+
+            vw.endPass();
+
+            model = vw.getModel();
+            out = new FileOutputStream("target/testSimple1.model");
+            out.write(model);
+
+        } finally {
+            if (out != null)
+                out.close();
+
+            if (ex != null)
+                ex.close();
+
+            if (vw != null)
+                vw.close();
+        }
+
+        // compare model
+        assertArrayEquals(model, modelRef);
+    }
+
+    @Test
+    public void testPrediction() throws Exception {
+        byte[] model;
+        float learnPrediction = 0f;
+        VowpalWabbitNative vw = null;
+        VowpalWabbitExample ex = null;
+
+        try {
+            vw = new VowpalWabbitNative("--quiet");
+            ex = vw.createExample();
+            for (int i = 0; i < 10; i++) {
+                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
+                ex.setLabel(i % 2);
+
+                ex.learn();
+                ex.clear();
+            }
+
+            vw.endPass();
+
+            ex.close();
+
+            model = vw.getModel();
+
+            ex = vw.createExample();
+            ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
+
+            ex.predict();
+
+            ScalarPrediction pred = (ScalarPrediction) ex.getPrediction();
+            learnPrediction = pred.getValue();
+
+            assertTrue(learnPrediction > 0);
+
+            vw.close();
+
+            // test the model
+            vw = new VowpalWabbitNative("--quiet", model);
+            VowpalWabbitArguments args = vw.getArguments();
+
+            assertEquals(18, args.getNumBits());
+            assertEquals(0, args.getHashSeed());
+
+            ex = vw.createExample();
+            ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
+
+            pred = (ScalarPrediction) ex.predict();
+
+            assertEquals(learnPrediction, pred.getValue(), 1e-4);
+        } finally {
+            if (ex != null)
+                ex.close();
+
+            if (vw != null)
+                vw.close();
+        }
+    }
+
+    @Test
+    public void testStageStatistics() throws Exception {
+        VowpalWabbitNative vw = null;
+        VowpalWabbitExample ex = null;
+
+        try {
+            vw = new VowpalWabbitNative("--quiet");
+            assertEquals(0, vw.getStageStatistics().length);
+            vw.close();
+
+            vw = new VowpalWabbitNative("--quiet --stage_timing");
+            ex = vw.createExample();
+            for (int i = 0; i < 100; i++) {
+                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
+                ex.setLabel(i % 2);
+
+                ex.learn();
+                ex.clear();
+            }
+
+            VowpalWabbitStageStatistics gd = null;
+            for (VowpalWabbitStageStatistics stage : vw.getStageStatistics())
+                if (stage.getName().equals("learn gd"))
+                    gd = stage;
+
+            assertTrue(gd != null);
+            assertEquals(100, gd.getCalls());
+            // one call in 64 is timed
+            assertEquals(2, gd.getSamples());
+            assertTrue(gd.getSeconds() > 0);
+            assertTrue(gd.getSelfSeconds() <= gd.getSeconds());
+        } finally {
+            if (ex != null)
+                ex.close();
+
+            if (vw != null)
+                vw.close();
+        }
+    }
+
+    @Test
+    public void testBFGS() throws Exception {
+        File tempFile = File.createTempFile("vowpalwabbit", ".cache");
+        tempFile.deleteOnExit();
+        String cachePath = tempFile.getAbsolutePath();
+        VowpalWabbitNative vw = null;
+        VowpalWabbitExample ex = null;
+
+        try {
+            vw = new VowpalWabbitNative(
+                    "--loss_function=logistic -l 3.1 --power_t 0.2 --bfgs --passes 2 -k --cache_file=" + cachePath);
+            // make sure getArguments works
+            assertTrue(vw.getArguments().getArgs().contains("--bfgs"));
+
+            ex = vw.createExample();
+
+            for (int i = 0; i < 10; i++) {
+                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
+                ex.setLabel((i % 2) * 2 - 1);
+
+                ex.learn();
+                ex.clear();
+            }
+
+            vw.endPass();
+            vw.performRemainingPasses();
+
+            // validate arguments
+            VowpalWabbitArguments args = vw.getArguments();
+
+            assertEquals(3.1, args.getLearningRate(), 0.001);
+            assertEquals(0.2, args.getPowerT(), 0.001);
+
+            VowpalWabbitPerformanceStatistics stats = vw.getPerformanceStatistics();
+
+            assertEquals(4, stats.getNumberOfExamplesPerPass());
+            assertEquals(9.0, stats.getWeightedExampleSum(), 0.0001);
+            assertEquals(-1.0, stats.getWeightedLabelSum(), 0.0001);
+            assertEquals(0.6931, stats.getAverageLoss(), 0.0001);
+            assertEquals(-0.223144, stats.getBestConstant(), 0.0001);
+            assertEquals(0.6869, stats.getBestConstantLoss(), 0.0001);
+            assertEquals(36, stats.getTotalNumberOfFeatures());
+
+        } finally {
+            if (ex != null)
+                ex.close();
+
+            if (vw != null)
+                vw.close();
+        }
+    }
+
+    @Test
+    public void testBatchMatchesExamples() throws Exception {
+        int numRows = 20;
+        int[][] rowIndices = new int[numRows][];
+        float[][] rowValues = new float[numRows][];
+        int numFeatures = 0;
+        for (int r = 0; r < numRows; r++) {
+            rowIndices[r] = new int[] { r % 3, 3 + r % 5, 100 + r };
+            rowValues[r] = new float[] { 1f, 0.5f, r / 10f };
+            numFeatures += rowIndices[r].length;
+        }
+
+        ByteBuffer indices = VowpalWabbitNative.allocateBatchBuffer(numFeatures);
+        ByteBuffer values = VowpalWabbitNative.allocateBatchBuffer(numFeatures);
+        ByteBuffer offsets = VowpalWabbitNative.allocateBatchBuffer(numRows + 1);
+        ByteBuffer labels = VowpalWabbitNative.allocateBatchBuffer(numRows);
+        ByteBuffer learnPredictions = VowpalWabbitNative.allocateBatchBuffer(numRows);
+        ByteBuffer predictions = VowpalWabbitNative.allocateBatchBuffer(numRows);
+        int offset = 0;
+        for (int r = 0; r < numRows; r++) {
+            offsets.putInt(r * 4, offset);
+            for (int k = 0; k < rowIndices[r].length; k++, offset++) {
+                indices.putInt(offset * 4, rowIndices[r][k]);
+                values.putFloat(offset * 4, rowValues[r][k]);
+            }
+            labels.putFloat(r * 4, r % 2);
+        }
+        offsets.putInt(numRows * 4, offset);
+
+        VowpalWabbitNative vw = null;
+        VowpalWabbitNative vwBatch = null;
+        VowpalWabbitExample ex = null;
+
+        try {
+            vw = new VowpalWabbitNative("--quiet");
+            vwBatch = new VowpalWabbitNative("--quiet");
+            ex = vw.createExample();
+
+            vwBatch.learnBatch(numRows, 'a', indices, values, offsets, labels, null, learnPredictions);
+            vwBatch.predictBatch(numRows, 'a', indices, values, offsets, predictions);
+
+            float[] expectedLearnPredictions = new float[numRows];
+            for (int r = 0; r < numRows; r++) {
+                double[] doubleValues = new double[rowValues[r].length];
+                for (int k = 0; k < doubleValues.length; k++)
+                    doubleValues[k] = rowValues[r][k];
+                ex.addToNamespaceSparse('a', rowIndices[r], doubleValues);
+                ex.setLabel(1f, r % 2);
+                ex.learn();
+                expectedLearnPredictions[r] = ((ScalarPrediction) ex.getPrediction()).getValue();
+                ex.clear();
+            }
+
+            for (int r = 0; r < numRows; r++) {
+                assertEquals(expectedLearnPredictions[r], learnPredictions.getFloat(r * 4), 1e-5);
+
+                double[] doubleValues = new double[rowValues[r].length];
+                for (int k = 0; k < doubleValues.length; k++)
+                    doubleValues[k] = rowValues[r][k];
+                ex.addToNamespaceSparse('a', rowIndices[r], doubleValues);
+                float expected = ((ScalarPrediction) ex.predict()).getValue();
+                ex.clear();
+
+                assertEquals(expected, predictions.getFloat(r * 4), 1e-5);
+            }
+        } finally {
+            if (ex != null)
+                ex.close();
+
+            if (vwBatch != null)
+                vwBatch.close();
+
+            if (vw != null)
+                vw.close();
+        }
+    }
+
+    @Test
+    public void testHierarchicalArguments() throws Exception {
+        String[] processes = new String[] { "b", "a", "b", "b" };
+
+        assertEquals(" --total 4 --node 0 --local_total 3 --local_node 0 --span_total 2 --span_node 0",
+                ClusterSpanningTree.hierarchicalArguments(processes, 0));
+        assertEquals(" --total 4 --node 1 --local_total 1 --local_node 0 --span_total 2 --span_node 1",
+                ClusterSpanningTree.hierarchicalArguments(processes, 1));
+        assertEquals(" --total 4 --node 3 --local_total 3 --local_node 2 --span_total 2 --span_node 0",
+                ClusterSpanningTree.hierarchicalArguments(processes, 3));
+    }
+
+    @Test
+    public void testAudit() throws Exception {
+        VowpalWabbitNative vw = null;
+        VowpalWabbitExample ex = null;
+
+        try {
+            // exepct no crash, can't directly validate as it writes to stdout
+            vw = new VowpalWabbitNative("--loss_function=logistic --link=logistic -a");
+
+            ex = vw.createExample();
+
+            for (int i = 0; i < 2; i++) {
+                ex.addToNamespaceDense('a', VowpalWabbitMurmur.hash("a", 0), new double[] { 1.0, 2.0, 3.0 });
+                ex.setLabel((i % 2) * 2 - 1);
+
+                ex.learn();
+                ex.clear();
+            }
+
+            vw.endPass();
+
+        } finally {
+            if (ex != null)
+                ex.close();
+
+            if (vw != null)
+                vw.close();
+        }
+    }
 }
\ No newline at end of file
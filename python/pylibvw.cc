@@ -223,6 +223,8 @@ public:
 
   static void trace_listener_py(void* wrapper, const std::string& message)
   {
+    // vw may log from learn_batch and predict_batch, which run without the GIL
+    PyGILState_STATE gil = PyGILState_Ensure();
     try
     {
       auto inst = static_cast<py_log_wrapper*>(wrapper);
@@ -235,6 +237,7 @@ public:
       PyErr_Clear();
       std::cerr << "error using python logging. ignoring." << std::endl;
     }
+    PyGILState_Release(gil);
   }
 };
 
@@ -472,6 +475,319 @@ float my_predict(vw_ptr all, example_ptr ec)
 
 bool my_is_multiline(vw_ptr all) { return all->l->is_multiline; }
 
+// The one dimensional, contiguous memory of a Python object with the buffer protocol, such as a numpy array, read or
+// written in place for as long as this lives.
+class py_buffer
+{
+  Py_buffer _view;
+  char _kind;  // the struct format character of the items
+
+public:
+  py_buffer(py::object& obj, const char* name, bool writable = false)
+  {
+    if (PyObject_GetBuffer(obj.ptr(), &_view, PyBUF_ND | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0)) != 0)
+      py::throw_error_already_set();
+    _kind = _view.format == nullptr ? 'B' : _view.format[strlen(_view.format) - 1];
+    if (_view.ndim > 1)
+    {
+      PyBuffer_Release(&_view);
+      THROW(name << " must be one dimensional");
+    }
+  }
+
+  py_buffer(const py_buffer&) = delete;
+  py_buffer& operator=(const py_buffer&) = delete;
+  ~py_buffer() { PyBuffer_Release(&_view); }
+
+  size_t size() const { return _view.itemsize == 0 ? 0 : _view.len / _view.itemsize; }
+
+  bool is_float32() const { return _kind == 'f' && _view.itemsize == sizeof(float); }
+
+  bool is_integer() const
+  {
+    return strchr("hHiIlLqQnN", _kind) != nullptr && (_view.itemsize == 4 || _view.itemsize == 8);
+  }
+
+  float* floats() const { return static_cast<float*>(_view.buf); }
+
+  // the item i of integers of either size, as vw takes them
+  uint64_t integer(size_t i) const
+  {
+    if (_view.itemsize == 4)
+      return islower(_kind) ? static_cast<uint64_t>(static_cast<const int32_t*>(_view.buf)[i])
+                            : static_cast<const uint32_t*>(_view.buf)[i];
+    return static_cast<const uint64_t*>(_view.buf)[i];
+  }
+};
+
+// The GIL is released for as long as this lives, so that other Python threads run while vw learns or predicts.
+class gil_release
+{
+  PyThreadState* _state;
+
+public:
+  gil_release() : _state(PyEval_SaveThread()) {}
+  gil_release(const gil_release&) = delete;
+  gil_release& operator=(const gil_release&) = delete;
+  ~gil_release() { PyEval_RestoreThread(_state); }
+};
+
+// A matrix in compressed sparse row format, as scipy.sparse.csr_matrix has it: the features of row r are the
+// indices and values from indptr[r] to indptr[r + 1].
+struct csr_rows
+{
+  py_buffer indices;
+  py_buffer values;
+  py_buffer indptr;
+
+  csr_rows(py::object& indices_obj, py::object& values_obj, py::object& indptr_obj)
+      : indices(indices_obj, "indices"), values(values_obj, "values"), indptr(indptr_obj, "indptr")
+  {
+    if (!indices.is_integer() || !indptr.is_integer()) THROW("indices and indptr must be arrays of integers");
+    if (!values.is_float32()) THROW("values must be an array of float32");
+    if (indices.size() != values.size()) THROW("indices and values must be of the same size");
+    if (indptr.size() == 0) THROW("indptr must have one more item than there are rows");
+    for (size_t r = 0; r < rows(); r++)
+      if (indptr.integer(r) > indptr.integer(r + 1)) THROW("indptr must not decrease");
+    if (indptr.integer(rows()) > indices.size()) THROW("indptr goes past the end of indices");
+  }
+
+  size_t rows() const { return indptr.size() - 1; }
+
+  // A pooled example of the features of row r, in the default namespace, where column j is the feature vw parses from
+  // "| j:value". The label is left to be set before VW::setup_example.
+  example& to_example(vw& all, size_t r) const
+  {
+    example& ec = VW::get_unused_example(&all);
+    all.example_parser->lbl_parser.default_label(&ec.l);
+    const uint64_t begin = indptr.integer(r);
+    const uint64_t end = indptr.integer(r + 1);
+    if (begin < end)
+    {
+      ec.indices.push_back(default_namespace);
+      features& fs = ec.feature_space[default_namespace];
+      for (uint64_t k = begin; k < end; k++)
+        fs.push_back(values.floats()[k], (indices.integer(k) + all.hash_seed) & all.parse_mask);
+    }
+    return ec;
+  }
+};
+
+void check_batchable(vw& all)
+{
+  if (all.l->is_multiline) THROW("learn_batch and predict_batch need a reduction of single line examples");
+  if (all.example_parser->lbl_parser.label_type != label_type_t::simple)
+    THROW("learn_batch and predict_batch need a reduction of simple labels");
+  if (all.l->pred_type != prediction_type_t::scalar && all.l->pred_type != prediction_type_t::prob)
+    THROW("learn_batch and predict_batch need a reduction of scalar predictions");
+}
+
+float scalar_prediction(vw& all, example& ec)
+{
+  return all.l->pred_type == prediction_type_t::prob ? ec.pred.prob : ec.pred.scalar;
+}
+
+// Learns from each row as if it were an example of its own, in order, and writes what was predicted for it before
+// the update to predictions, if it is not None. The GIL is released while vw learns.
+void my_learn_batch(
+    vw_ptr all, py::object indices, py::object values, py::object indptr, py::object labels, py::object predictions)
+{
+  check_batchable(*all);
+  csr_rows rows(indices, values, indptr);
+  py_buffer label_buffer(labels, "labels");
+  if (!label_buffer.is_float32() || label_buffer.size() != rows.rows())
+    THROW("labels must be an array of float32 with one label per row");
+  std::unique_ptr<py_buffer> prediction_buffer;
+  if (!predictions.is_none())
+  {
+    prediction_buffer.reset(new py_buffer(predictions, "predictions", true));
+    if (!prediction_buffer->is_float32() || prediction_buffer->size() != rows.rows())
+      THROW("predictions must be an array of float32 with one prediction per row");
+  }
+
+  gil_release unlocked;
+  for (size_t r = 0; r < rows.rows(); r++)
+  {
+    example& ec = rows.to_example(*all, r);
+    ec.l.simple.label = label_buffer.floats()[r];
+    VW::setup_example(*all, &ec);
+    all->example_parser->end_parsed_examples++;
+    all->learn(ec);
+    if (prediction_buffer) prediction_buffer->floats()[r] = scalar_prediction(*all, ec);
+    as_singleline(all->l)->finish_example(*all, ec);
+  }
+}
+
+// Predicts each row into predictions, which has a float32 per row. The GIL is released while vw predicts.
+void my_predict_batch(vw_ptr all, py::object indices, py::object values, py::object indptr, py::object predictions)
+{
+  check_batchable(*all);
+  csr_rows rows(indices, values, indptr);
+  py_buffer prediction_buffer(predictions, "predictions", true);
+  if (!prediction_buffer.is_float32() || prediction_buffer.size() != rows.rows())
+    THROW("predictions must be an array of float32 with one prediction per row");
+
+  gil_release unlocked;
+  for (size_t r = 0; r < rows.rows(); r++)
+  {
+    example& ec = rows.to_example(*all, r);
+    VW::setup_example(*all, &ec);
+    all->example_parser->end_parsed_examples++;
+    all->predict(ec);
+    prediction_buffer.floats()[r] = scalar_prediction(*all, ec);
+    as_singleline(all->l)->finish_example(*all, ec);
+  }
+}
+
+// Reads the bytes objects a Python iterator yields, taking the GIL for each of them. An error of the iterator ends
+// the input, and is kept for background_learning::wait to raise, as the parse thread cannot throw.
+class py_chunk_reader : public VW::io::reader
+{
+  py::object _chunks;
+  std::shared_ptr<std::string> _error;
+  std::string _chunk;
+  size_t _offset = 0;
+  bool _exhausted = false;
+
+  bool next_chunk()
+  {
+    PyGILState_STATE gil = PyGILState_Ensure();
+    PyObject* item = PyIter_Next(_chunks.ptr());
+    if (item != nullptr)
+    {
+      char* data;
+      Py_ssize_t size;
+      if (PyBytes_AsStringAndSize(item, &data, &size) == 0) _chunk.assign(data, size);
+      Py_DECREF(item);
+    }
+    if (PyErr_Occurred())
+    {
+      PyObject *type, *value, *traceback;
+      PyErr_Fetch(&type, &value, &traceback);
+      PyObject* message = value != nullptr ? PyObject_Str(value) : nullptr;
+      *_error = message != nullptr ? py::extract<std::string>(message)() : "error in the iterator of chunks";
+      Py_XDECREF(message);
+      Py_XDECREF(type);
+      Py_XDECREF(value);
+      Py_XDECREF(traceback);
+      item = nullptr;
+    }
+    PyGILState_Release(gil);
+
+    _offset = 0;
+    _exhausted = item == nullptr;
+    return !_exhausted;
+  }
+
+public:
+  py_chunk_reader(py::object chunks, std::shared_ptr<std::string> error)
+      : reader(false), _chunks(chunks), _error(std::move(error))
+  {
+  }
+
+  ~py_chunk_reader()
+  {
+    // the parser may drop its input from a thread without the GIL
+    PyGILState_STATE gil = PyGILState_Ensure();
+    _chunks = py::object();
+    PyGILState_Release(gil);
+  }
+
+  ssize_t read(char* buffer, size_t num_bytes) override
+  {
+    while (_offset == _chunk.size())
+      if (_exhausted || !next_chunk()) return 0;
+    const size_t count = std::min(num_bytes, _chunk.size() - _offset);
+    memcpy(buffer, _chunk.data() + _offset, count);
+    _offset += count;
+    return count;
+  }
+};
+
+// Parses and learns from the input of vw on threads of its own, as run_parser does, while Python goes on. vw must
+// not be used otherwise until wait returns, and its parser runs only once, as with run_parser.
+class background_learning
+{
+  vw_ptr _all;
+  std::shared_ptr<std::string> _input_error;
+  std::exception_ptr _error;
+  std::atomic<bool> _done;
+  std::thread _thread;
+
+  void run()
+  {
+    try
+    {
+      VW::start_parser(*_all);
+      VW::LEARNER::generic_driver(*_all);
+    }
+    catch (...)
+    {
+      _error = std::current_exception();
+      set_done(*_all);
+    }
+    if (_all->parse_thread.joinable()) VW::end_parser(*_all);
+    _done = true;
+  }
+
+public:
+  background_learning(vw_ptr all, std::unique_ptr<VW::io::reader> input, std::shared_ptr<std::string> input_error)
+      : _all(all), _input_error(std::move(input_error)), _done(false)
+  {
+    _all->example_parser->input->add_file(std::move(input));
+    _thread = std::thread(&background_learning::run, this);
+  }
+
+  background_learning(const background_learning&) = delete;
+  background_learning& operator=(const background_learning&) = delete;
+
+  ~background_learning()
+  {
+    if (_thread.joinable())
+    {
+      gil_release unlocked;
+      _thread.join();
+    }
+  }
+
+  bool done() const { return _done; }
+
+  // Waits without the GIL for vw to learn from all of its input, then raises what went wrong, if anything did.
+  void wait()
+  {
+    if (_thread.joinable())
+    {
+      gil_release unlocked;
+      _thread.join();
+    }
+    if (_error) std::rethrow_exception(_error);
+    if (!_input_error->empty()) THROW("reading the input failed: " << *_input_error);
+  }
+};
+
+typedef boost::shared_ptr<background_learning> background_learning_ptr;
+
+void check_background_learnable(vw& all)
+{
+  if (all.example_parser->done) THROW("the parser of this vw has run already");
+  if (all.example_parser->input->num_files() > 0) THROW("this vw reads from a file or cache already");
+}
+
+background_learning_ptr my_learn_file_in_background(vw_ptr all, std::string path)
+{
+  check_background_learnable(*all);
+  auto input = open_input_file_reader(*all, path, all->example_parser->compressed);
+  return background_learning_ptr(new background_learning(all, std::move(input), std::make_shared<std::string>()));
+}
+
+background_learning_ptr my_learn_chunks_in_background(vw_ptr all, py::object chunks)
+{
+  check_background_learnable(*all);
+  auto error = std::make_shared<std::string>();
+  std::unique_ptr<VW::io::reader> input(new py_chunk_reader(chunks, error));
+  return background_learning_ptr(new background_learning(all, std::move(input), error));
+}
+
 template <bool learn>
 void predict_or_learn(vw_ptr& all, py::list& ec)
 {
@@ -1098,6 +1414,11 @@ BOOST_PYTHON_MODULE(pylibvw)
   // while disabling the C++ signatures
   py::docstring_options local_docstring_options(true, true, false);
 
+#if PY_VERSION_HEX < 0x03070000
+  // the GIL is released by the batch and background functions, and taken by threads of vw
+  PyEval_InitThreads();
+#endif
+
   // define the vw class
   py::class_<vw, vw_ptr, boost::noncopyable>(
       "vw", "the basic VW object that holds with weight vector, parser, etc.", py::no_init)
@@ -1139,6 +1460,15 @@ BOOST_PYTHON_MODULE(pylibvw)
       .def("predict_multi", &my_predict_multi_ex, "given a list of pyvw examples, predict on that example")
       .def("_parse", &my_parse, "Parse a string into a collection of VW examples")
       .def("_is_multiline", &my_is_multiline, "true if the base reduction is multiline")
+      .def("_learn_file_in_background", &my_learn_file_in_background,
+          "parse and learn from a data file on threads of their own, without the GIL")
+      .def("_learn_chunks_in_background", &my_learn_chunks_in_background,
+          "parse and learn from the bytes an iterator yields on threads of their own, taking the GIL only to get them")
+      .def("_learn_batch", &my_learn_batch,
+          "learn from the rows of a CSR matrix of float32 values, with a float32 label per row, writing the "
+          "predictions before each update to a float32 array unless it is None")
+      .def("_predict_batch", &my_predict_batch,
+          "predict the rows of a CSR matrix of float32 values into a float32 array of a prediction per row")
 
       .def_readonly("lDefault", lDEFAULT,
           "Default label type (whatever vw was initialized with) -- used as input to the example() initializer")
@@ -1291,6 +1621,12 @@ BOOST_PYTHON_MODULE(pylibvw)
       .def("set_tag", &my_set_tag, "change the tag of this prediction")
       .def("predict", &Search::predictor::predict, "make a prediction");
 
+  py::class_<background_learning, background_learning_ptr, boost::noncopyable>("background_learning",
+      "vw learning from a file or an iterator of chunks while Python goes on, see vw.learn_in_background", py::no_init)
+      .def("done", &background_learning::done, "true once vw has learned from all of its input")
+      .def("wait", &background_learning::wait,
+          "wait for vw to learn from all of its input, and raise the error that stopped it, if any");
+
   py::class_<py_log_wrapper, py_log_wrapper_ptr>(
       "vw_log", "do not use, see pyvw.vw.init(enable_logging..)", py::init<py::object>());
 
@@ -429,3 +429,69 @@ def test_dsjson():
     assert len(pred) == len(expected)
     for a,b in zip(pred, expected):
         assert isclose(a, b)
+
+
+def test_learn_predict_batch():
+    import numpy as np
+    from scipy.sparse import csr_matrix
+
+    matrix = csr_matrix(np.array([[1.0, 0.0, 2.0], [0.0, 0.5, 0.0], [0.0, 0.0, 0.0], [3.0, 1.0, 0.0]]))
+    labels = np.array([1.0, -1.0, 0.5, 2.0])
+    lines = ["| 0:1 2:2", "| 1:0.5", "|", "| 0:3 1:1"]
+
+    batched = vw(quiet=True, b=BIT_SIZE)
+    one_by_one = vw(quiet=True, b=BIT_SIZE)
+    predictions = batched.learn_batch(matrix, labels=labels, return_predictions=True)
+    for i, line in enumerate(lines):
+        assert isclose(predictions[i], one_by_one.predict(line), abs_tol=1e-6)
+        one_by_one.learn("{} {}".format(labels[i], line))
+
+    # the arrays of the matrix, as scipy keeps them, are read in place
+    predictions = batched.predict_batch(matrix.indices, matrix.data.astype(np.float32), matrix.indptr)
+    assert predictions.dtype == np.float32
+    assert len(predictions) == len(lines)
+    for prediction, line in zip(predictions, lines):
+        assert isclose(prediction, one_by_one.predict(line), abs_tol=1e-6)
+
+    check_error_raises(RuntimeError, lambda: batched.learn_batch(matrix, labels=labels[:2]))
+    check_error_raises(RuntimeError, lambda: batched.predict_batch(matrix.indices, matrix.data, [0, 3, 1]))
+    check_error_raises(TypeError, lambda: batched.predict_batch(matrix.indices, matrix.data))
+
+    multiclass = vw(quiet=True, oaa=3)
+    check_error_raises(RuntimeError, lambda: multiclass.predict_batch(matrix))
+
+
+def test_learn_in_background():
+    data_file = os.path.join(
+        os.path.dirname(os.path.realpath(__file__)), "resources", "train.dat"
+    )
+    with open(data_file) as f:
+        lines = f.read().splitlines()
+
+    one_by_one = vw(quiet=True, oaa=3)
+    for line in lines:
+        one_by_one.learn(line)
+
+    from_file = vw(quiet=True, oaa=3)
+    learning = from_file.learn_in_background(data_file)
+    learning.wait()
+    assert learning.done()
+
+    # chunks need not end at the end of a line
+    text = "\n".join(lines) + "\n"
+    from_chunks = vw(quiet=True, oaa=3)
+    from_chunks.learn_in_background(text[i : i + 7] for i in range(0, len(text), 7)).wait()
+
+    for line in lines:
+        ex = line[line.index("|"):]
+        assert from_file.predict(ex) == one_by_one.predict(ex)
+        assert from_chunks.predict(ex) == one_by_one.predict(ex)
+
+    check_error_raises(RuntimeError, lambda: from_file.learn_in_background(data_file))
+
+    def failing_chunks():
+        yield b"1 | a\n"
+        raise ValueError("no more data")
+
+    failing = vw(quiet=True)
+    check_error_raises(RuntimeError, lambda: failing.learn_in_background(failing_chunks()).wait())
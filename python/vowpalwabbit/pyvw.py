@@ -265,6 +265,27 @@ def get_all_vw_options():
     temp.finish()
     return config
 
+def _csr_arrays(indices, values, indptr):
+    """The indices, values and indptr of a CSR matrix as learn_batch and
+    predict_batch take them, which copies only what is not contiguous or not
+    of a type vw reads"""
+    import numpy as np
+
+    if values is None and indptr is None:
+        matrix = indices.tocsr()
+        indices, values, indptr = matrix.indices, matrix.data, matrix.indptr
+    elif values is None or indptr is None:
+        raise TypeError("expecting a CSR matrix, or its indices, values and indptr")
+
+    def integers(a):
+        a = np.asarray(a)
+        if a.dtype not in (np.int32, np.uint32, np.int64, np.uint64):
+            a = a.astype(np.int64)
+        return np.ascontiguousarray(a)
+
+    return integers(indices), np.ascontiguousarray(values, dtype=np.float32), integers(indptr)
+
+
 class log_forward:
     def __init__(self):
         self.messages = []
@@ -597,6 +618,106 @@ class vw(pylibvw.vw):
 
         return prediction
 
+    def learn_batch(self, indices, values=None, indptr=None, labels=None, return_predictions=False):
+        """Perform an online update on each row of a sparse matrix, in order
+
+        The rows are read in place, and vw learns from them without holding
+        the GIL. The feature of column j is the one vw parses from "| j:value".
+        Only reductions of simple labels and scalar predictions are supported.
+
+        Parameters
+        ----------
+
+        indices : scipy.sparse.csr_matrix or array of integers
+            the matrix, or the column of each value as the indices of a CSR
+            matrix are
+        values : array, optional
+            the values of the matrix when indices is not one
+        indptr : array of integers, optional
+            where the values of each row start, and one past the last row,
+            when indices is not a matrix
+        labels : array
+            the label of each row
+        return_predictions : bool, by default is False
+            if True, return what was predicted for each row before its update
+
+        Returns
+        -------
+
+        predictions : numpy.ndarray of float32 if return_predictions is True
+        """
+        import numpy as np
+
+        indices, values, indptr = _csr_arrays(indices, values, indptr)
+        labels = np.ascontiguousarray(labels, dtype=np.float32)
+        predictions = np.empty(len(indptr) - 1, dtype=np.float32) if return_predictions else None
+        pylibvw.vw._learn_batch(self, indices, values, indptr, labels, predictions)
+        return predictions
+
+    def predict_batch(self, indices, values=None, indptr=None):
+        """Make a prediction on each row of a sparse matrix
+
+        The rows are read in place, and vw predicts them without holding the
+        GIL. The feature of column j is the one vw parses from "| j:value".
+        Only reductions of simple labels and scalar predictions are supported.
+
+        Parameters
+        ----------
+
+        indices : scipy.sparse.csr_matrix or array of integers
+            the matrix, or the column of each value as the indices of a CSR
+            matrix are
+        values : array, optional
+            the values of the matrix when indices is not one
+        indptr : array of integers, optional
+            where the values of each row start, and one past the last row,
+            when indices is not a matrix
+
+        Returns
+        -------
+
+        predictions : numpy.ndarray of float32 with the prediction of each row
+        """
+        import numpy as np
+
+        indices, values, indptr = _csr_arrays(indices, values, indptr)
+        predictions = np.empty(len(indptr) - 1, dtype=np.float32)
+        pylibvw.vw._predict_batch(self, indices, values, indptr, predictions)
+        return predictions
+
+    def learn_in_background(self, source):
+        """Parse and learn from a data file, or from chunks of its bytes, on
+        threads of vw's own, and return at once
+
+        vw parses and learns without the GIL, as fast as the parser threads
+        and options such as --parse_threads let it, while Python goes on. It
+        takes the GIL only to get the next chunk from an iterator. This vw
+        must not be used otherwise until the handle returned is waited for,
+        and it learns from one source only, as with run_parser.
+
+        Parameters
+        ----------
+
+        source : str or iterable of bytes/str
+            the path of a data file in any input format of vw, or chunks of
+            its contents, which need not end at the end of a line
+
+        Returns
+        -------
+
+        background_learning : handle with done(), true once vw has learned
+            from all of the input, and wait(), which blocks until then and
+            raises the error that stopped vw, if any
+        """
+        if isinstance(source, str):
+            return pylibvw.vw._learn_file_in_background(self, source)
+
+        def encoded(chunks):
+            for chunk in chunks:
+                yield chunk.encode("utf-8") if isinstance(chunk, str) else chunk
+
+        return pylibvw.vw._learn_chunks_in_background(self, encoded(source))
+
     def save(self, filename):
         """save model to disk"""
         pylibvw.vw.save(self, filename)
@@ -0,0 +1,111 @@
+#include "benchmark_counters.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#  include <cstring>
+#  include <linux/perf_event.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+std::atomic<uint64_t> allocation_count(0);
+
+void* allocate(std::size_t size)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+enum class event
+{
+  instructions,
+  cache_misses
+};
+
+#ifdef __linux__
+// A counter of the user space events of this thread, -1 when the kernel, or the machine, does not have it.
+int open_counter(event e)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = e == event::instructions ? PERF_COUNT_HW_INSTRUCTIONS : PERF_COUNT_HW_CACHE_MISSES;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+bool read_counter(int fd, uint64_t& value) { return fd >= 0 && read(fd, &value, sizeof(value)) == sizeof(value); }
+
+void close_counter(int fd)
+{
+  if (fd >= 0) close(fd);
+}
+#else
+int open_counter(event) { return -1; }
+bool read_counter(int, uint64_t&) { return false; }
+void close_counter(int) {}
+#endif
+}  // namespace
+
+// Every allocation of the benchmarks is counted, the cost of that being the same from run to run.
+void* operator new(std::size_t size)
+{
+  void* p = allocate(size);
+#ifdef VW_NOEXCEPT
+  if (p == nullptr) std::abort();
+#else
+  if (p == nullptr) throw std::bad_alloc();
+#endif
+  return p;
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace benchmark_counters
+{
+uint64_t allocations() { return allocation_count.load(std::memory_order_relaxed); }
+
+counters::counters()
+    : _instructions(open_counter(event::instructions))
+    , _cache_misses(open_counter(event::cache_misses))
+    , _allocs(allocations())
+{
+}
+
+counters::~counters()
+{
+  close_counter(_instructions);
+  close_counter(_cache_misses);
+}
+
+void counters::report(benchmark::State& state, int64_t items_per_iteration)
+{
+  uint64_t instructions = 0;
+  uint64_t cache_misses = 0;
+  const bool has_instructions = read_counter(_instructions, instructions);
+  const bool has_cache_misses = read_counter(_cache_misses, cache_misses);
+  const uint64_t allocs = allocations() - _allocs;
+
+  const auto per_item = [items_per_iteration](uint64_t count) {
+    return benchmark::Counter(
+        static_cast<double>(count) / items_per_iteration, benchmark::Counter::kAvgIterations);
+  };
+  if (has_instructions) state.counters["instructions"] = per_item(instructions);
+  if (has_cache_misses) state.counters["cache_misses"] = per_item(cache_misses);
+  state.counters["allocs"] = per_item(allocs);
+}
+}  // namespace benchmark_counters
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+// Counters of the work a benchmark does which, unlike its time, do not depend on the frequency of the CPU: the
+// instructions retired and the last level cache misses, where the kernel gives perf counters, and the allocations
+// made with operator new. They are counted from construction to report, which are placed around the timed loop so
+// that the setup and teardown of the benchmark are not counted, and written out per item, as compare_baselines.py
+// compares them.
+namespace benchmark_counters
+{
+class counters
+{
+public:
+  counters();
+  counters(const counters&) = delete;
+  counters& operator=(const counters&) = delete;
+  ~counters();
+
+  // Stops counting and adds instructions, cache_misses and allocs to the counters of the state, per item of the
+  // items_per_iteration each iteration processed. The perf counters are left out when the kernel does not have them.
+  void report(benchmark::State& state, int64_t items_per_iteration = 1);
+
+private:
+  int _instructions;
+  int _cache_misses;
+  uint64_t _allocs;
+};
+
+// The count of the allocations made with operator new, by all threads, since the start of the process.
+uint64_t allocations();
+}  // namespace benchmark_counters
@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+
+#include "vw.h"
+
+// A decision among a shared context and num_actions actions, labeled on the first action when learn_cost is given.
+static multi_ex make_decision(vw& all, size_t num_actions, size_t seed, const char* learn_cost)
+{
+  multi_ex examples;
+  std::ostringstream shared;
+  shared << "shared |s user" << seed % 7 << " time" << seed % 3 << " day" << seed % 5;
+  examples.push_back(VW::read_example(all, shared.str()));
+  for (size_t a = 0; a < num_actions; a++)
+  {
+    std::ostringstream action;
+    if (a == 0 && learn_cost != nullptr) action << "0:" << learn_cost << ":0.5 ";
+    action << "|a item" << a << " category" << a % 10 << " price:" << (a % 13) * 0.1;
+    examples.push_back(VW::read_example(all, action.str()));
+  }
+  return examples;
+}
+
+// Predictions of the reductions which bound the costs of every action by its sensitivity.
+static void benchmark_cb_explore_adf_predict(benchmark::State& state, std::string command_line)
+{
+  const auto num_actions = static_cast<size_t>(state.range(0));
+  auto vw = VW::initialize(command_line, nullptr, false, nullptr, nullptr);
+  for (size_t i = 0; i < 20; i++)
+  {
+    multi_ex examples = make_decision(*vw, num_actions, i, i % 2 == 0 ? "0.0" : "1.0");
+    vw->learn(examples);
+    vw->finish_example(examples);
+  }
+
+  multi_ex examples = make_decision(*vw, num_actions, 0, nullptr);
+  for (auto _ : state)
+  {
+    vw->predict(examples);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * num_actions);
+
+  vw->finish_example(examples);
+  VW::finish(*vw, true);
+}
+
+BENCHMARK_CAPTURE(benchmark_cb_explore_adf_predict, regcb, "--quiet --no_stdin --cb_explore_adf --regcb -q sa")
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(2048);
+BENCHMARK_CAPTURE(benchmark_cb_explore_adf_predict, regcbopt, "--quiet --no_stdin --cb_explore_adf --regcbopt -q sa")
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(2048);
+BENCHMARK_CAPTURE(
+    benchmark_cb_explore_adf_predict, squarecb_elim, "--quiet --no_stdin --cb_explore_adf --squarecb --elim -q sa")
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(2048);
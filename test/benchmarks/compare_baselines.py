@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Compares the counters of a run of the benchmarks with the baselines kept in-tree.
+
+The counters are those of benchmark_counters.h, which do not depend on the frequency of the CPU, so that a change
+of them is a change of the code rather than of the machine. The delta of every counter of every benchmark is
+printed, and the exit code is 1 when one of them grew by more than its threshold.
+
+    compare_baselines.py vw-benchmarks.json baselines/vw-benchmarks.json
+    compare_baselines.py --update vw-benchmarks.json baselines/vw-benchmarks.json
+"""
+
+import argparse
+import json
+import os
+import sys
+
+# The growth, relative and absolute, a counter can have before it is a regression. Both have to be exceeded, the
+# absolute one keeping counters near 0 from failing on noise. Cache misses depend on what else runs on the machine
+# and are let vary the most.
+THRESHOLDS = {
+    "instructions": (0.02, 0.0),
+    "cache_misses": (0.25, 1.0),
+    "allocs": (0.05, 0.5),
+}
+
+
+def read_counters(results_file):
+    """The counters of each benchmark in a --benchmark_out_format=json file, the median of the repetitions when
+    the benchmarks were repeated."""
+    with open(results_file) as f:
+        results = json.load(f)
+
+    iterations = {}
+    medians = {}
+    for run in results["benchmarks"]:
+        counters = {name: run[name] for name in THRESHOLDS if name in run}
+        if not counters:
+            continue
+        if run.get("run_type") == "aggregate":
+            if run.get("aggregate_name") == "median":
+                medians[run["run_name"]] = counters
+        else:
+            iterations.setdefault(run.get("run_name", run["name"]), counters)
+    iterations.update(medians)
+    return iterations
+
+
+def read_baselines(baselines_file):
+    if not os.path.exists(baselines_file):
+        return {}
+    with open(baselines_file) as f:
+        return json.load(f)["benchmarks"]
+
+
+def write_baselines(baselines_file, counters):
+    rounded = {name: {counter: round(value, 2) for counter, value in c.items()} for name, c in counters.items()}
+    with open(baselines_file, "w") as f:
+        json.dump({"benchmarks": rounded}, f, indent=2, sort_keys=True)
+        f.write("\n")
+
+
+def is_regression(counter, baseline, current):
+    relative, absolute = THRESHOLDS[counter]
+    growth = current - baseline
+    return growth > absolute and growth > relative * abs(baseline)
+
+
+def compare(baselines, counters, out):
+    """Prints the delta of each counter and returns the names of the benchmarks which regressed."""
+    regressions = []
+    width = max([len(name) for name in counters] + [len("benchmark")])
+    out.write("{:<{w}}  {:<12}  {:>14}  {:>14}  {:>8}\n".format(
+        "benchmark", "counter", "baseline", "current", "delta", w=width))
+    for name in sorted(counters):
+        baseline = baselines.get(name, {})
+        for counter in sorted(counters[name]):
+            current = counters[name][counter]
+            if counter not in baseline:
+                out.write("{:<{w}}  {:<12}  {:>14}  {:>14.2f}  {:>8}\n".format(
+                    name, counter, "-", current, "new", w=width))
+                continue
+            delta = (current - baseline[counter]) / baseline[counter] * 100 if baseline[counter] else 0.0
+            regressed = is_regression(counter, baseline[counter], current)
+            if regressed and name not in regressions:
+                regressions.append(name)
+            out.write("{:<{w}}  {:<12}  {:>14.2f}  {:>14.2f}  {:>+7.1f}%{}\n".format(
+                name, counter, baseline[counter], current, delta, "  REGRESSION" if regressed else "", w=width))
+    for name in sorted(set(baselines) - set(counters)):
+        out.write("{:<{w}}  not run\n".format(name, w=width))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("results", help="the --benchmark_out of a run, in json")
+    parser.add_argument("baselines", help="the baselines file to compare with")
+    parser.add_argument("--update", action="store_true", help="replace the baselines with the counters of the run")
+    args = parser.parse_args()
+
+    counters = read_counters(args.results)
+    if args.update:
+        write_baselines(args.baselines, counters)
+        print("wrote the baselines of {} benchmarks to {}".format(len(counters), args.baselines))
+        return 0
+
+    baselines = read_baselines(args.baselines)
+    if not baselines:
+        print("no baselines in {}, they are made with --update".format(args.baselines))
+    regressions = compare(baselines, counters, sys.stdout)
+    if regressions:
+        print("\n{} benchmarks regressed: {}".format(len(regressions), ", ".join(regressions)))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "feature_group.h"
+
+// Sorts the features of a namespace of --sort_features, or of the flat examples memory_tree and kernel_svm build, with
+// hashes masked to 18 bits.
+static void benchmark_feature_sort(benchmark::State& state)
+{
+  const size_t size = static_cast<size_t>(state.range(0));
+  std::mt19937_64 rng(3);
+  std::vector<uint64_t> hashes(size);
+  for (auto& hash : hashes) hash = rng();
+
+  features fs;
+  const uint64_t parse_mask = (uint64_t(1) << 18) - 1;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    fs.clear();
+    for (uint64_t hash : hashes) fs.push_back(1.f, hash);
+    state.ResumeTiming();
+    fs.sort(parse_mask);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(benchmark_feature_sort)->Arg(32)->Arg(256)->Arg(4096)->Arg(65536);
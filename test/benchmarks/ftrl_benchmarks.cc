@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "ftrl_simd.h"
+
+using ftrl_kernel = void (*)(float* const*, const float*, size_t, const VW::ftrl_parameters&);
+
+// The weights of the features of an example, scattered over a model as hashing leaves them.
+struct scattered_weights
+{
+  explicit scattered_weights(size_t features) : model(size_t(1) << 20), x(features)
+  {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> value(0.f, 1.f);
+    std::uniform_int_distribution<size_t> index(0, (model.size() >> 3) - 1);
+    for (size_t i = 0; i < features; i++)
+    {
+      float* w = &model[index(rng) << 3];
+      // The weights given at once must be distinct.
+      while (std::find(weights.begin(), weights.end(), w) != weights.end()) w = &model[index(rng) << 3];
+      weights.push_back(w);
+      x[i] = value(rng);
+    }
+  }
+
+  std::vector<float> model;
+  std::vector<float*> weights;
+  std::vector<float> x;
+};
+
+// The weights of an example given to kernel VW::FTRL_BATCH at a time, as ftrl.cc does, or one at a time as the scalar
+// code did.
+static void benchmark_ftrl_kernel(benchmark::State& state, ftrl_kernel kernel, bool batched)
+{
+  scattered_weights example(static_cast<size_t>(state.range(0)));
+  VW::ftrl_parameters p = {0.1f, 0.005f, 0.1f, 0.f, 0.f};
+  const size_t step = batched ? VW::FTRL_BATCH : 1;
+  for (auto _ : state)
+  {
+    for (size_t i = 0; i < example.weights.size(); i += step)
+      kernel(&example.weights[i], &example.x[i], std::min(step, example.weights.size() - i), p);
+    benchmark::ClobberMemory();
+    // Alternating gradients keep the states from growing without bound over the iterations.
+    p.update = -p.update;
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_CAPTURE(benchmark_ftrl_kernel, proximal_one_at_a_time, VW::ftrl_proximal_update, false)->Arg(80)->Arg(1024);
+BENCHMARK_CAPTURE(benchmark_ftrl_kernel, proximal_batched, VW::ftrl_proximal_update, true)->Arg(80)->Arg(1024);
+BENCHMARK_CAPTURE(benchmark_ftrl_kernel, coin_betting_one_at_a_time, VW::coin_betting_update, false)
+    ->Arg(80)
+    ->Arg(1024);
+BENCHMARK_CAPTURE(benchmark_ftrl_kernel, coin_betting_batched, VW::coin_betting_update, true)->Arg(80)->Arg(1024);
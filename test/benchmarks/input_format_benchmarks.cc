@@ -13,6 +13,9 @@
 #include "cache.h"
 #include "parser.h"
 #include "io/io_adapter.h"
+#include "parser/flatbuffer/parse_example_flatbuffer.h"
+#include "benchmark_counters.h"
+#include "synthetic_data.h"
 #include "vw.h"
 
 auto get_x_numerical_fts = [](int feature_size) {
@@ -71,12 +74,14 @@ static void bench_text(benchmark::State& state, ExtraArgs&&... extra_args)
   auto vw = VW::initialize("--cb 2 --quiet");
   auto examples = v_init<example*>();
   examples.push_back(&VW::get_unused_example(vw));
+  benchmark_counters::counters counters;
   for (auto _ : state)
   {
     VW::read_line(*vw, examples[0], es);
     VW::empty_example(*vw, *examples[0]);
     benchmark::ClobberMemory();
   }
+  counters.report(state);
   examples.delete_v();
 }
 
@@ -118,6 +123,7 @@ static void bench_cache_io_buf(benchmark::State& state, ExtraArgs&&... extra_arg
   io_buf reader_view_of_buffer;
   vw->example_parser->input = &reader_view_of_buffer;
 
+  benchmark_counters::counters counters;
   for (auto _ : state)
   {
     reader_view_of_buffer.add_file(VW::io::create_buffer_view(buffer->data(), buffer->size()));
@@ -125,6 +131,7 @@ static void bench_cache_io_buf(benchmark::State& state, ExtraArgs&&... extra_arg
     VW::empty_example(*vw, *examples[0]);
     benchmark::ClobberMemory();
   }
+  counters.report(state);
   examples.delete_v();
 }
 
@@ -166,6 +173,7 @@ static void bench_text_io_buf(benchmark::State& state, ExtraArgs&&... extra_args
   io_buf reader_view_of_buffer;
   vw->example_parser->input = &reader_view_of_buffer;
 
+  benchmark_counters::counters counters;
   for (auto _ : state)
   {
     reader_view_of_buffer.add_file(VW::io::create_buffer_view(example_string.data(), example_string.size()));
@@ -173,6 +181,7 @@ static void bench_text_io_buf(benchmark::State& state, ExtraArgs&&... extra_args
     VW::empty_example(*vw, *examples[0]);
     benchmark::ClobberMemory();
   }
+  counters.report(state);
   examples.delete_v();
 }
 
@@ -208,11 +217,13 @@ static void benchmark_learn_simple(benchmark::State& state, std::string example_
   auto* example = VW::read_example(*vw, example_string);
   VW::setup_example(*vw, example);
 
+  benchmark_counters::counters counters;
   for (auto _ : state)
   {
     vw->learn(*example);
     benchmark::ClobberMemory();
   }
+  counters.report(state);
   vw->finish_example(*example);
 }
 
@@ -258,6 +269,92 @@ static void benchmark_ccb_adf_learn(benchmark::State& state, std::string feature
   vw->finish_example(examples);
 }
 
+// Parses 64 --dsjson decisions of num_actions actions through the reader, as the parse thread does.
+static void bench_dsjson_io_buf(benchmark::State& state)
+{
+  const auto num_actions = static_cast<size_t>(state.range(0));
+  std::mt19937 rng(7);
+  std::string lines;
+  for (size_t i = 0; i < 64; i++) { lines += benchmark_data::dsjson_decision(rng, num_actions, i) + "\n"; }
+
+  auto vw = VW::initialize("--cb_explore_adf --dsjson --chain_hash --quiet --no_stdin");
+  io_buf reader_view_of_buffer;
+  vw->example_parser->input = &reader_view_of_buffer;
+
+  auto examples = v_init<example*>();
+  benchmark_counters::counters counters;
+  for (auto _ : state)
+  {
+    reader_view_of_buffer.add_file(VW::io::create_buffer_view(lines.data(), lines.size()));
+    examples.push_back(&VW::get_unused_example(vw));
+    while (vw->example_parser->reader(vw, examples) > 0)
+    {
+      VW::return_multiple_example(*vw, examples);
+      examples.push_back(&VW::get_unused_example(vw));
+    }
+    VW::return_multiple_example(*vw, examples);
+    benchmark::ClobberMemory();
+  }
+  counters.report(state, 64);
+  state.SetBytesProcessed(state.iterations() * lines.size());
+  examples.delete_v();
+}
+
+enum class flatbuffer_features
+{
+  named,   // hashed as they are parsed
+  hashed,  // one table per feature
+  columns  // the hashes and values of a namespace in two vectors
+};
+
+// Parses a flatbuffer example of num_features features.
+static void bench_flatbuffer(benchmark::State& state, flatbuffer_features kind)
+{
+  namespace fb = VW::parsers::flatbuffer;
+  const auto num_features = static_cast<size_t>(state.range(0));
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<flatbuffers::Offset<fb::Namespace>> namespaces;
+  if (kind == flatbuffer_features::columns)
+  {
+    std::vector<uint64_t> hashes;
+    std::vector<float> values;
+    for (size_t i = 0; i < num_features; i++)
+    {
+      hashes.push_back(i * 2654435761u);
+      values.push_back(4.36352f);
+    }
+    namespaces.push_back(fb::CreateNamespaceDirect(builder, nullptr, ' ', nullptr, &hashes, &values));
+  }
+  else
+  {
+    const bool named = kind == flatbuffer_features::named;
+    std::vector<flatbuffers::Offset<fb::Feature>> fts;
+    for (size_t i = 0; i < num_features; i++)
+    {
+      fts.push_back(named ? fb::CreateFeatureDirect(builder, ("bigfeaturename" + std::to_string(i)).c_str(), 10.f)
+                          : fb::CreateFeatureDirect(builder, nullptr, 4.36352f, i * 2654435761u));
+    }
+    namespaces.push_back(fb::CreateNamespaceDirect(builder, named ? "default" : nullptr, ' ', &fts));
+  }
+  auto label = fb::CreateSimpleLabel(builder, 1.f, 0.5f).Union();
+  auto example = fb::CreateExampleDirect(builder, &namespaces, fb::Label_SimpleLabel, label);
+  builder.FinishSizePrefixed(fb::CreateExampleRoot(builder, fb::ExampleType_Example, example.Union()));
+
+  auto vw = VW::initialize("--flatbuffer --quiet --no_stdin", nullptr, false, nullptr, nullptr);
+  auto examples = v_init<example*>();
+  examples.push_back(&VW::get_unused_example(vw));
+  benchmark_counters::counters counters;
+  for (auto _ : state)
+  {
+    vw->flat_converter->parse_examples(vw, examples, builder.GetBufferPointer());
+    VW::empty_example(*vw, *examples[0]);
+    benchmark::ClobberMemory();
+  }
+  counters.report(state);
+  state.SetItemsProcessed(state.iterations() * num_features);
+  examples.delete_v();
+}
+
 BENCHMARK_CAPTURE(bench_text, 120_string_fts, get_x_string_fts(120));
 BENCHMARK_CAPTURE(bench_cache_io_buf, 120_string_fts, get_x_string_fts(120));
 BENCHMARK_CAPTURE(bench_text_io_buf, 120_string_fts, get_x_string_fts(120));
@@ -276,3 +373,8 @@ BENCHMARK_CAPTURE(benchmark_ccb_adf_learn, many_features, "a b c d e f g h i j k
 
 BENCHMARK(benchmark_example_reuse);
 BENCHMARK(benchmark_cb_adf_learn);
+
+BENCHMARK(bench_dsjson_io_buf)->Arg(10)->Arg(100);
+BENCHMARK_CAPTURE(bench_flatbuffer, named_fts, flatbuffer_features::named)->Arg(120);
+BENCHMARK_CAPTURE(bench_flatbuffer, hashed_fts, flatbuffer_features::hashed)->Arg(120);
+BENCHMARK_CAPTURE(bench_flatbuffer, column_fts, flatbuffer_features::columns)->Arg(120);
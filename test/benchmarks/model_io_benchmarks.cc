@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "io/io_adapter.h"
+#include "io_buf.h"
+#include "vw.h"
+
+namespace
+{
+// The model of an instance with every one of its 2^bits weights set, as a large trained model has them.
+std::string command_line(int64_t bits) { return "--quiet --no_stdin --random_weights -b " + std::to_string(bits); }
+
+std::shared_ptr<std::vector<char>> save(vw& all)
+{
+  auto model = std::make_shared<std::vector<char>>();
+  io_buf buffer;
+  buffer.add_file(VW::io::create_vector_writer(model));
+  VW::save_predictor(all, buffer);
+  return model;
+}
+}  // namespace
+
+static void benchmark_model_save(benchmark::State& state)
+{
+  auto vw = VW::initialize(command_line(state.range(0)), nullptr, false, nullptr, nullptr);
+  size_t bytes = 0;
+  for (auto _ : state)
+  {
+    auto model = save(*vw);
+    bytes = model->size();
+    benchmark::DoNotOptimize(model->data());
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+  VW::finish(*vw, true);
+}
+
+// Starting an instance from a model in memory, as a server reloading its model does.
+static void benchmark_model_load(benchmark::State& state)
+{
+  auto vw = VW::initialize(command_line(state.range(0)), nullptr, false, nullptr, nullptr);
+  auto model = save(*vw);
+  VW::finish(*vw, true);
+
+  for (auto _ : state)
+  {
+    io_buf buffer;
+    buffer.add_file(VW::io::create_buffer_view(model->data(), model->size()));
+    auto loaded = VW::initialize("--quiet --no_stdin", &buffer, false, nullptr, nullptr);
+    VW::finish(*loaded, true);
+  }
+  state.SetBytesProcessed(state.iterations() * model->size());
+}
+
+BENCHMARK(benchmark_model_save)->Arg(18)->Arg(22)->Arg(24)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_model_load)->Arg(18)->Arg(22)->Arg(24)->Unit(benchmark::kMillisecond);
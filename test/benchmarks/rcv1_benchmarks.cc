@@ -1,7 +1,11 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <sstream>
 #include <string>
 
+#include "dense_batch.h"
+#include "gd.h"
 #include "io/io_adapter.h"
 #include "vw.h"
 
@@ -276,3 +280,52 @@ static void benchmark_rcv1_dataset(benchmark::State& state, std::string command_
 
 BENCHMARK_CAPTURE(benchmark_rcv1_dataset, simple, "--quiet");
 BENCHMARK_CAPTURE(benchmark_rcv1_dataset, quadratic, "--quiet -q ::");
+
+// Weights larger than the cache, as prefetched by default and without it.
+BENCHMARK_CAPTURE(benchmark_rcv1_dataset, large_model, "--quiet -b 24");
+BENCHMARK_CAPTURE(benchmark_rcv1_dataset, large_model_no_prefetch, "--quiet -b 24 --prefetch_weights 0");
+BENCHMARK_CAPTURE(benchmark_rcv1_dataset, large_model_quadratic, "--quiet -b 24 -q ::");
+BENCHMARK_CAPTURE(
+    benchmark_rcv1_dataset, large_model_quadratic_no_prefetch, "--quiet -b 24 -q :: --prefetch_weights 0");
+
+// The optimizers of ftrl.cc, which update their weights with the kernels of ftrl_simd.h.
+BENCHMARK_CAPTURE(benchmark_rcv1_dataset, ftrl, "--quiet --ftrl");
+BENCHMARK_CAPTURE(benchmark_rcv1_dataset, coin, "--quiet --coin");
+BENCHMARK_CAPTURE(benchmark_rcv1_dataset, ftrl_quadratic, "--quiet --ftrl -q ::");
+
+// Predicting the examples of rcv1 one at a time through the learner, or batched through a dense backend.
+static void benchmark_rcv1_predict(benchmark::State& state, std::string command_line, bool batched)
+{
+  auto vw = VW::initialize(command_line, nullptr, false, nullptr, nullptr);
+  multi_ex examples;
+  std::istringstream lines(RCV1_DATA);
+  std::string line;
+  while (std::getline(lines, line))
+    if (!line.empty()) examples.push_back(VW::read_example(*vw, line));
+
+  auto backend = VW::make_dense_backend(*vw, "cpu");
+  VW::flat_batch batch;
+  multi_ex chunk;
+  const size_t batch_size = 64;
+  for (auto _ : state)
+  {
+    if (!batched)
+      for (example* ex : examples) vw->predict(*ex);
+    else
+      for (size_t i = 0; i < examples.size(); i += batch_size)
+      {
+        chunk.assign(examples.begin() + i, examples.begin() + std::min(i + batch_size, examples.size()));
+        GD::predict_batch(*vw, chunk, *backend, batch);
+      }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * examples.size());
+
+  for (example* ex : examples) vw->finish_example(*ex);
+  VW::finish(*vw, true);
+}
+
+BENCHMARK_CAPTURE(benchmark_rcv1_predict, one_at_a_time, "--quiet --no_stdin", false);
+BENCHMARK_CAPTURE(benchmark_rcv1_predict, batched, "--quiet --no_stdin", true);
+BENCHMARK_CAPTURE(benchmark_rcv1_predict, quadratic_one_at_a_time, "--quiet --no_stdin -q ::", false);
+BENCHMARK_CAPTURE(benchmark_rcv1_predict, quadratic_batched, "--quiet --no_stdin -q ::", true);
@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_counters.h"
+#include "synthetic_data.h"
+#include "vw.h"
+
+namespace
+{
+constexpr size_t NUM_EXAMPLES = 256;
+constexpr size_t NUM_DECISIONS = 16;
+
+multi_ex read_lines(vw& all, const std::vector<std::string>& lines)
+{
+  multi_ex examples;
+  for (const auto& line : lines) { examples.push_back(VW::read_example(all, line)); }
+  return examples;
+}
+}  // namespace
+
+// Learns single line examples in turn, parsed beforehand so that only learning is timed.
+static void benchmark_learn_examples(benchmark::State& state, std::string command_line, std::vector<std::string> lines)
+{
+  auto vw = VW::initialize(command_line, nullptr, false, nullptr, nullptr);
+  multi_ex examples = read_lines(*vw, lines);
+  size_t next = 0;
+  benchmark_counters::counters counters;
+  for (auto _ : state)
+  {
+    vw->learn(*examples[next]);
+    next = (next + 1) % examples.size();
+    benchmark::ClobberMemory();
+  }
+  counters.report(state);
+  state.SetItemsProcessed(state.iterations());
+
+  for (auto* example : examples) { vw->finish_example(*example); }
+  VW::finish(*vw, true);
+}
+
+// Learns, or predicts, NUM_DECISIONS --cb_explore_adf decisions of num_actions actions in turn.
+static void benchmark_cb_explore_adf(benchmark::State& state, std::string command_line, bool learn)
+{
+  const auto num_actions = static_cast<size_t>(state.range(0));
+  auto vw = VW::initialize(command_line, nullptr, false, nullptr, nullptr);
+  std::mt19937 rng(7);
+  std::vector<multi_ex> decisions;
+  for (size_t i = 0; i < NUM_DECISIONS; i++)
+  { decisions.push_back(read_lines(*vw, benchmark_data::cb_decision(rng, num_actions, learn))); }
+
+  size_t next = 0;
+  benchmark_counters::counters counters;
+  for (auto _ : state)
+  {
+    if (learn) { vw->learn(decisions[next]); }
+    else
+    {
+      vw->predict(decisions[next]);
+    }
+    next = (next + 1) % decisions.size();
+    benchmark::ClobberMemory();
+  }
+  counters.report(state, num_actions);
+  state.SetItemsProcessed(state.iterations() * num_actions);
+
+  for (auto& decision : decisions) { vw->finish_example(decision); }
+  VW::finish(*vw, true);
+}
+
+// Learns NUM_DECISIONS --ccb_explore_adf decisions of num_actions actions and num_slots slots in turn.
+static void benchmark_ccb_explore_adf(benchmark::State& state, std::string command_line)
+{
+  const auto num_actions = static_cast<size_t>(state.range(0));
+  const auto num_slots = static_cast<size_t>(state.range(1));
+  auto vw = VW::initialize(command_line, nullptr, false, nullptr, nullptr);
+  std::mt19937 rng(7);
+  std::vector<multi_ex> decisions;
+  for (size_t i = 0; i < NUM_DECISIONS; i++)
+  { decisions.push_back(read_lines(*vw, benchmark_data::ccb_decision(rng, num_actions, num_slots, true))); }
+
+  size_t next = 0;
+  benchmark_counters::counters counters;
+  for (auto _ : state)
+  {
+    vw->learn(decisions[next]);
+    next = (next + 1) % decisions.size();
+    benchmark::ClobberMemory();
+  }
+  counters.report(state, num_slots);
+  state.SetItemsProcessed(state.iterations() * num_slots);
+
+  for (auto& decision : decisions) { vw->finish_example(decision); }
+  VW::finish(*vw, true);
+}
+
+// gd on three namespaces of 10 features each, without and with interactions among them.
+BENCHMARK_CAPTURE(benchmark_learn_examples, gd_linear, "--quiet --no_stdin",
+    benchmark_data::regression_examples(NUM_EXAMPLES, 3, 10));
+BENCHMARK_CAPTURE(benchmark_learn_examples, gd_quadratic, "--quiet --no_stdin -q ab -q ac -q bc",
+    benchmark_data::regression_examples(NUM_EXAMPLES, 3, 10));
+BENCHMARK_CAPTURE(benchmark_learn_examples, gd_cubic, "--quiet --no_stdin --cubic abc",
+    benchmark_data::regression_examples(NUM_EXAMPLES, 3, 10));
+
+// Multiclass reductions, whose cost grows with the number of classes.
+BENCHMARK_CAPTURE(benchmark_learn_examples, oaa_10, "--quiet --no_stdin --oaa 10",
+    benchmark_data::multiclass_examples(NUM_EXAMPLES, 10));
+BENCHMARK_CAPTURE(benchmark_learn_examples, oaa_100, "--quiet --no_stdin --oaa 100",
+    benchmark_data::multiclass_examples(NUM_EXAMPLES, 100));
+BENCHMARK_CAPTURE(benchmark_learn_examples, oaa_1000, "--quiet --no_stdin --oaa 1000",
+    benchmark_data::multiclass_examples(NUM_EXAMPLES, 1000));
+BENCHMARK_CAPTURE(benchmark_learn_examples, csoaa_10, "--quiet --no_stdin --csoaa 10",
+    benchmark_data::cost_sensitive_examples(NUM_EXAMPLES, 10));
+BENCHMARK_CAPTURE(benchmark_learn_examples, csoaa_100, "--quiet --no_stdin --csoaa 100",
+    benchmark_data::cost_sensitive_examples(NUM_EXAMPLES, 100));
+BENCHMARK_CAPTURE(benchmark_learn_examples, csoaa_1000, "--quiet --no_stdin --csoaa 1000",
+    benchmark_data::cost_sensitive_examples(NUM_EXAMPLES, 1000));
+
+BENCHMARK_CAPTURE(
+    benchmark_cb_explore_adf, epsilon_learn, "--quiet --no_stdin --cb_explore_adf --epsilon 0.1 -q sa", true)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+BENCHMARK_CAPTURE(
+    benchmark_cb_explore_adf, epsilon_predict, "--quiet --no_stdin --cb_explore_adf --epsilon 0.1 -q sa", false)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+BENCHMARK_CAPTURE(benchmark_cb_explore_adf, softmax_predict,
+    "--quiet --no_stdin --cb_explore_adf --softmax --lambda 1 -q sa", false)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+
+BENCHMARK_CAPTURE(benchmark_ccb_explore_adf, learn, "--quiet --no_stdin --ccb_explore_adf --epsilon 0.1 -q UA")
+    ->Args({10, 2})
+    ->Args({10, 4})
+    ->Args({100, 8});
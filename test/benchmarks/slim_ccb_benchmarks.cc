@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "example_predict_builder.h"
+#include "slim_model.h"
+#include "vw_slim_predict.h"
+
+using namespace vw_slim;
+using namespace slim_model;
+
+namespace
+{
+struct decision
+{
+  decision(size_t num_actions, size_t num_slots) : actions(num_actions), slots(num_slots)
+  {
+    example_predict_builder user(&shared, (char*)"s");
+    for (uint64_t i = 0; i < 20; i++) user.push_feature(i * 7, 1.f);
+    for (size_t a = 0; a < num_actions; a++)
+    {
+      example_predict_builder item(&actions[a], (char*)"a");
+      for (uint64_t i = 0; i < 5; i++) item.push_feature(a * 13 + i, 0.5f);
+    }
+    for (size_t s = 0; s < num_slots; s++)
+    {
+      example_predict_builder position(&slots[s], (char*)"p");
+      position.push_feature(s, 1.f);
+    }
+  }
+
+  example_predict shared;
+  std::vector<example_predict> actions;
+  std::vector<example_predict> slots;
+};
+
+const char* OPTIONS = "--cb_explore_adf --epsilon 0.1 --cb_adf --csoaa_ldf multiline --csoaa_rank -q sa -q pa";
+
+// The interactions --ccb_explore_adf adds to those of OPTIONS with the slot ids, in namespace 140, less those of the
+// empty namespace 139 of slots without features of the default namespace.
+const char* SLOT_ID_INTERACTIONS = " --interactions as\x8c --interactions ap\x8c --interactions a\x8c --interactions s\x8c";
+}  // namespace
+
+// All slots of a decision at once, which scores the shared features once per decision and each slot once.
+static void benchmark_slim_predict_ccb(benchmark::State& state)
+{
+  const auto num_actions = static_cast<size_t>(state.range(0));
+  const auto num_slots = static_cast<size_t>(state.range(1));
+  std::vector<char> model = make_model(std::string(OPTIONS) + " --ccb_explore_adf");
+  vw_predict<dense_parameters> vw;
+  if (vw.load(model.data(), model.size()) != S_VW_PREDICT_OK) state.SkipWithError("the model does not load");
+
+  decision d(num_actions, num_slots);
+  std::vector<std::vector<float>> pdfs;
+  std::vector<std::vector<int>> rankings;
+  for (auto _ : state)
+  {
+    vw.predict_ccb("event", d.shared, d.actions.data(), num_actions, d.slots.data(), num_slots, pdfs, rankings);
+    benchmark::DoNotOptimize(rankings.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_slots);
+}
+
+// The same decision as one cb prediction per slot, the slot and its id added to the shared features and the actions
+// the slots before it chose left out, which is all vw_slim could do before predict_ccb.
+static void benchmark_slim_predict_cb_per_slot(benchmark::State& state)
+{
+  const auto num_actions = static_cast<size_t>(state.range(0));
+  const auto num_slots = static_cast<size_t>(state.range(1));
+  std::vector<char> model = make_model(std::string(OPTIONS) + SLOT_ID_INTERACTIONS);
+  vw_predict<dense_parameters> vw;
+  if (vw.load(model.data(), model.size()) != S_VW_PREDICT_OK) state.SkipWithError("the model does not load");
+
+  decision d(num_actions, num_slots);
+  std::vector<float> pdf;
+  std::vector<int> ranking;
+  for (auto _ : state)
+  {
+    std::vector<example_predict*> remaining;
+    for (auto& action : d.actions) remaining.push_back(&action);
+    for (size_t s = 0; s < num_slots; s++)
+    {
+      example_predict shared;
+      copy_namespace(d.shared, 's', shared);
+      copy_namespace(d.slots[s], 'p', shared);
+      shared.indices.push_back(ccb_id_namespace);
+      shared.feature_space[ccb_id_namespace].push_back(1.f, ccb_slot_id(s, NUM_BITS));
+
+      std::vector<example_predict> actions(remaining.size());
+      for (size_t k = 0; k < remaining.size(); k++) copy_namespace(*remaining[k], 'a', actions[k]);
+      vw.predict("event", shared, actions.data(), actions.size(), pdf, ranking);
+      remaining.erase(remaining.begin() + ranking[0]);
+    }
+    benchmark::DoNotOptimize(ranking.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_slots);
+}
+
+BENCHMARK(benchmark_slim_predict_ccb)->Args({8, 2})->Args({32, 4})->Args({128, 8});
+BENCHMARK(benchmark_slim_predict_cb_per_slot)->Args({8, 2})->Args({32, 4})->Args({128, 8});
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model_parser.h"
+#include "vw_slim_predict.h"
+
+// The models and examples the vw_slim benchmarks share.
+namespace slim_model
+{
+constexpr uint32_t NUM_BITS = 18;
+
+template <typename T>
+void append(std::vector<char>& model, T value)
+{
+  const char* bytes = (const char*)&value;
+  model.insert(model.end(), bytes, bytes + sizeof(T));
+}
+
+inline void append_string(std::vector<char>& model, const std::string& s)
+{
+  append(model, static_cast<uint32_t>(s.size() + 1));
+  model.insert(model.end(), s.c_str(), s.c_str() + s.size() + 1);
+}
+
+// A model as vw 8.9.0 would have written it with the options, with a weight for every index.
+inline std::vector<char> make_model(const std::string& options)
+{
+  std::vector<char> model;
+  append_string(model, "8.9.0");
+  append_string(model, "");
+  append(model, 'm');
+  append(model, 0.f);  // min_label
+  append(model, 1.f);  // max_label
+  append(model, NUM_BITS);
+  append(model, static_cast<uint32_t>(0));  // lda
+  append(model, static_cast<uint32_t>(0));  // ngram_len
+  append(model, static_cast<uint32_t>(0));  // skips_len
+  append_string(model, options);
+
+  // the check sum of the header, as vw_predict::load reads it
+  vw_slim::model_parser mp(model.data(), model.size());
+  std::string s;
+  uint32_t ignored;
+  mp.read_string<false>("version", s);
+  mp.read_string<true>("model_id", s);
+  mp.skip(sizeof(char));   // "model character"
+  mp.skip(sizeof(float));  // "min_label"
+  mp.skip(sizeof(float));  // "max_label"
+  mp.read("num_bits", ignored);
+  mp.skip(sizeof(uint32_t));  // "lda"
+  mp.read("ngram_len", ignored);
+  mp.read("skips_len", ignored);
+  mp.read_string<true>("file_options", s);
+  append(model, static_cast<uint32_t>(sizeof(uint32_t)));
+  append(model, mp.checksum());
+
+  if (options.find("--ccb_explore_adf") != std::string::npos) append(model, true);  // has seen multi slot example
+  if (options.find("--cb_adf") != std::string::npos)
+  {
+    append(model, static_cast<uint64_t>(0));  // event_sum
+    append(model, static_cast<uint64_t>(0));  // action_sum
+  }
+  append(model, false);  // resume
+  for (uint32_t i = 0; i < (1u << NUM_BITS); i++)
+  {
+    append(model, i);
+    append(model, static_cast<float>(i % 97) / 97.f - 0.5f);
+  }
+  return model;
+}
+
+inline void copy_namespace(example_predict& from, namespace_index ns, example_predict& to)
+{
+  to.indices.push_back(ns);
+  for (auto f : from.feature_space[ns]) to.feature_space[ns].push_back(f.value(), f.index());
+}
+}  // namespace slim_model
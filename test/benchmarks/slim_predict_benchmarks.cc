@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_counters.h"
+#include "example_predict_builder.h"
+#include "slim_model.h"
+#include "vw_slim_predict.h"
+
+using namespace vw_slim;
+using namespace slim_model;
+
+namespace
+{
+constexpr size_t NUM_EXAMPLES = 64;
+constexpr size_t FEATURES_PER_NAMESPACE = 10;
+
+// Examples of two namespaces, a and b, of FEATURES_PER_NAMESPACE hashed features each.
+struct examples
+{
+  examples() : rows(NUM_EXAMPLES)
+  {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint64_t> index(0, (1 << NUM_BITS) - 1);
+    for (auto& row : rows)
+    {
+      for (const char* ns : {"a", "b"})
+      {
+        example_predict_builder builder(&row, const_cast<char*>(ns));
+        for (size_t i = 0; i < FEATURES_PER_NAMESPACE; i++) builder.push_feature(index(rng), 1.f);
+      }
+    }
+
+    // the same examples as a batch, in the order predict_batch takes them
+    row_offsets.push_back(0);
+    for (auto& row : rows)
+    {
+      for (auto ns : row.indices)
+        for (auto f : row.feature_space[ns])
+        {
+          namespaces.push_back(ns);
+          indices.push_back(f.index());
+          values.push_back(f.value());
+        }
+      row_offsets.push_back(indices.size());
+    }
+  }
+
+  example_batch batch() const
+  {
+    return {rows.size(), row_offsets.data(), namespaces.data(), indices.data(), values.data()};
+  }
+
+  std::vector<example_predict> rows;
+  std::vector<size_t> row_offsets;
+  std::vector<namespace_index> namespaces;
+  std::vector<feature_index> indices;
+  std::vector<feature_value> values;
+};
+}  // namespace
+
+// Scores of a regression model, of the examples one at a time or as a batch.
+static void benchmark_slim_predict_regression(benchmark::State& state, std::string options, bool batched)
+{
+  std::vector<char> model = make_model(options);
+  vw_predict<dense_parameters> vw;
+  if (vw.load(model.data(), model.size()) != S_VW_PREDICT_OK) state.SkipWithError("the model does not load");
+
+  examples data;
+  const example_batch batch = data.batch();
+  batch_context context;
+  std::vector<float> scores(NUM_EXAMPLES);
+  benchmark_counters::counters counters;
+  for (auto _ : state)
+  {
+    if (batched)
+      vw.predict_batch(context, batch, scores.data());
+    else
+      for (size_t i = 0; i < NUM_EXAMPLES; i++) vw.predict(data.rows[i], scores[i]);
+    benchmark::DoNotOptimize(scores.data());
+  }
+  counters.report(state, NUM_EXAMPLES);
+  state.SetItemsProcessed(state.iterations() * NUM_EXAMPLES);
+}
+
+BENCHMARK_CAPTURE(benchmark_slim_predict_regression, linear_one_at_a_time, "", false);
+BENCHMARK_CAPTURE(benchmark_slim_predict_regression, linear_batched, "", true);
+BENCHMARK_CAPTURE(benchmark_slim_predict_regression, quadratic_one_at_a_time, "--quadratic ab", false);
+BENCHMARK_CAPTURE(benchmark_slim_predict_regression, quadratic_batched, "--quadratic ab", true);
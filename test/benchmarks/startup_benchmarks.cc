@@ -0,0 +1,21 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "vw.h"
+
+// The cost of starting and finishing an instance, which dominates short prediction jobs.
+static void benchmark_startup(benchmark::State& state, std::string command_line)
+{
+  for (auto _ : state)
+  {
+    auto vw = VW::initialize(command_line, nullptr, false, nullptr, nullptr);
+    VW::finish(*vw, true);
+  }
+}
+
+BENCHMARK_CAPTURE(benchmark_startup, default, "--quiet --no_stdin");
+BENCHMARK_CAPTURE(benchmark_startup, large_model, "--quiet --no_stdin -b 24");
+BENCHMARK_CAPTURE(benchmark_startup, multiclass, "--quiet --no_stdin --oaa 10");
+BENCHMARK_CAPTURE(benchmark_startup, cb_explore_adf, "--quiet --no_stdin --cb_explore_adf --epsilon 0.1");
+BENCHMARK_CAPTURE(benchmark_startup, all_options_listed, "--quiet --no_stdin --dry_run");
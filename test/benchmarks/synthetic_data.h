@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Generators of the synthetic examples of the benchmarks, as lines of vw's text and JSON formats. The same seed gives
+// the same examples, so that the runs of a benchmark can be compared.
+namespace benchmark_data
+{
+// Features of a namespace drawn from a vocabulary of vocabulary_size names, half of them with values.
+inline void append_features(
+    std::ostringstream& line, std::mt19937& rng, const std::string& prefix, size_t num_features, size_t vocabulary_size)
+{
+  std::uniform_int_distribution<size_t> word(0, vocabulary_size - 1);
+  std::uniform_real_distribution<float> value(0.f, 1.f);
+  for (size_t i = 0; i < num_features; i++)
+  {
+    line << ' ' << prefix << word(rng);
+    if (i % 2 == 1) line << ':' << value(rng);
+  }
+}
+
+// An example labeled with label, whose namespaces are named a, b, c and so on.
+inline std::string text_example(std::mt19937& rng, const std::string& label, size_t num_namespaces, size_t num_features)
+{
+  std::ostringstream line;
+  line << label;
+  for (size_t ns = 0; ns < num_namespaces; ns++)
+  {
+    const char name = static_cast<char>('a' + ns);
+    line << " |" << name;
+    append_features(line, rng, std::string(1, name), num_features, 1000);
+  }
+  return line.str();
+}
+
+// Regression examples with labels drawn from a standard normal.
+inline std::vector<std::string> regression_examples(
+    size_t count, size_t num_namespaces, size_t num_features, unsigned int seed = 7)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> label(0.f, 1.f);
+  std::vector<std::string> examples;
+  for (size_t i = 0; i < count; i++)
+    examples.push_back(text_example(rng, std::to_string(label(rng)), num_namespaces, num_features));
+  return examples;
+}
+
+// Multiclass examples of classes 1 to num_classes.
+inline std::vector<std::string> multiclass_examples(size_t count, size_t num_classes, unsigned int seed = 7)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<size_t> label(1, num_classes);
+  std::vector<std::string> examples;
+  for (size_t i = 0; i < count; i++) examples.push_back(text_example(rng, std::to_string(label(rng)), 2, 10));
+  return examples;
+}
+
+// Cost sensitive examples over all num_classes classes, the costs of the classes near the best one being lower.
+inline std::vector<std::string> cost_sensitive_examples(size_t count, size_t num_classes, unsigned int seed = 7)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<size_t> best(1, num_classes);
+  std::vector<std::string> examples;
+  for (size_t i = 0; i < count; i++)
+  {
+    const size_t b = best(rng);
+    std::ostringstream label;
+    for (size_t c = 1; c <= num_classes; c++)
+      label << (c > 1 ? " " : "") << c << ':' << (c > b ? c - b : b - c) / static_cast<float>(num_classes);
+    examples.push_back(text_example(rng, label.str(), 2, 10));
+  }
+  return examples;
+}
+
+// The lines of a --cb_explore_adf decision: a shared context and num_actions actions, of which one is labeled if
+// labeled is set.
+inline std::vector<std::string> cb_decision(std::mt19937& rng, size_t num_actions, bool labeled)
+{
+  std::uniform_int_distribution<size_t> chosen(0, num_actions - 1);
+  std::uniform_int_distribution<int> cost(0, 1);
+  const size_t labeled_action = chosen(rng);
+
+  std::vector<std::string> lines;
+  std::ostringstream shared;
+  shared << "shared |s";
+  append_features(shared, rng, "user", 8, 100);
+  lines.push_back(shared.str());
+  for (size_t a = 0; a < num_actions; a++)
+  {
+    std::ostringstream action;
+    if (labeled && a == labeled_action) action << a << ':' << cost(rng) << ':' << 1.f / num_actions << ' ';
+    action << "|a item" << a;
+    append_features(action, rng, "tag", 4, 200);
+    lines.push_back(action.str());
+  }
+  return lines;
+}
+
+// The lines of a --ccb_explore_adf decision: a shared context, num_actions actions and num_slots slots, all labeled
+// if labeled is set.
+inline std::vector<std::string> ccb_decision(std::mt19937& rng, size_t num_actions, size_t num_slots, bool labeled)
+{
+  std::uniform_int_distribution<int> cost(0, 1);
+  std::vector<std::string> lines;
+  std::ostringstream shared;
+  shared << "ccb shared |User";
+  append_features(shared, rng, "user", 8, 100);
+  lines.push_back(shared.str());
+  for (size_t a = 0; a < num_actions; a++)
+  {
+    std::ostringstream action;
+    action << "ccb action |Action item" << a;
+    append_features(action, rng, "tag", 4, 200);
+    lines.push_back(action.str());
+  }
+  for (size_t s = 0; s < num_slots; s++)
+  {
+    std::ostringstream slot;
+    slot << "ccb slot ";
+    if (labeled) slot << s << ':' << cost(rng) << ':' << 1.f / (num_actions - s) << ' ';
+    slot << "|Slot position" << s;
+    lines.push_back(slot.str());
+  }
+  return lines;
+}
+
+// A --dsjson line of a cb decision among num_actions actions, as the decision service logs them.
+inline std::string dsjson_decision(std::mt19937& rng, size_t num_actions, size_t event)
+{
+  std::uniform_int_distribution<size_t> chosen(0, num_actions - 1);
+  std::uniform_int_distribution<int> cost(0, 1);
+  std::uniform_int_distribution<int> word(0, 199);
+  const size_t labeled_action = chosen(rng);
+
+  std::ostringstream line;
+  line << "{\"_label_cost\":" << -cost(rng) << ",\"_label_probability\":" << 1.f / num_actions
+       << ",\"_label_Action\":" << labeled_action + 1 << ",\"_labelIndex\":" << labeled_action
+       << ",\"o\":[{\"v\":1.0,\"EventId\":\"event" << event << "\",\"ActionTaken\":false}],\"Timestamp\":"
+       << "\"2020-01-01T00:00:00.0000000Z\",\"Version\":\"1\",\"EventId\":\"event" << event << "\",\"a\":[";
+  // the action taken first, then the others
+  line << labeled_action + 1;
+  for (size_t a = 0; a < num_actions; a++)
+    if (a != labeled_action) line << ',' << a + 1;
+  line << "],\"c\":{\"User\":{\"id\":\"user" << word(rng) << "\",\"time\":\"t" << word(rng) % 24
+       << "\"},\"_multi\":[";
+  for (size_t a = 0; a < num_actions; a++)
+  {
+    line << (a > 0 ? "," : "") << "{\"Action\":{\"item\":\"item" << a << "\",\"tag\":\"tag" << word(rng)
+         << "\"},\"Price\":{\"value\":" << word(rng) / 10.f << "}}";
+  }
+  line << "]},\"p\":[";
+  for (size_t a = 0; a < num_actions; a++) line << (a > 0 ? "," : "") << 1.f / num_actions;
+  line << "],\"VWState\":{\"m\":\"model\"}}";
+  return line.str();
+}
+}  // namespace benchmark_data
@@ -12,6 +12,7 @@ TRAINSET=$NAME.train
 PREDREF=$NAME.predref
 PREDOUT=$NAME.predict
 NETCAT_STATUS=$NAME.netcat-status
+METRICS=$NAME.metrics
 PORT=54248
 
 while [ $# -gt 0 ]
@@ -23,6 +24,12 @@ do
         --json)
             JSON="$1 --chain_hash"
             ;;
+        --event_loop)
+            EventLoop="--daemon_event_loop"
+            ;;
+        --metrics)
+            Metrics=true
+            ;;
         --port)
             PORT="$2"
             shift 
@@ -66,8 +73,14 @@ else
     exit 1
 fi
 
+# The metrics are served on the port after the daemon's
+if [ -n "$Metrics" ]; then
+    METRICS_PORT=$((PORT + 1))
+    MetricsArg="--metrics_port $METRICS_PORT"
+fi
+
 # A command (+pattern) that is unlikely to match anything but our own test
-DaemonCmd="$VW -t -i $MODEL --daemon $Foreground --num_children 1 --quiet --port $PORT $JSON"
+DaemonCmd="$VW -t -i $MODEL --daemon $Foreground $EventLoop --num_children 1 --quiet --port $PORT $JSON $MetricsArg"
 # libtool may wrap vw with '.libs/lt-vw' so we need to be flexible
 # on the exact process pattern we try to kill.
 DaemonPat=`echo $DaemonCmd | sed 's/^[^ ]*vw /.*vw /'`
@@ -99,7 +112,7 @@ start_daemon() {
 }
 
 cleanup() {
-    /bin/rm -f $MODEL $TRAINSET $PREDREF $PREDOUT $NETCAT_STATUS
+    /bin/rm -f $MODEL $TRAINSET $PREDREF $PREDOUT $NETCAT_STATUS $METRICS
     stop_daemon
 }
 
@@ -171,6 +184,20 @@ $NETCAT $DELAY_OPT localhost $PORT < $TRAINSET > $PREDOUT
 
 $PKILL -9 $NETCAT
 
+# Both examples are counted once their predictions are back
+if [ -n "$Metrics" ]; then
+    sleep 0.1
+    printf 'GET /metrics HTTP/1.0\r\n\r\n' | $NETCAT $DELAY_OPT localhost $METRICS_PORT > $METRICS
+    for Metric in '^vw_examples_total 2' '^vw_request_latency_seconds_count [1-9]' '^vw_memory_bytes{subsystem="weights"} [1-9]'
+    do
+        if ! grep -q "$Metric" $METRICS; then
+            echo "$NAME FAILED: no $Metric in the metrics, see $METRICS"
+            stop_daemon
+            exit 1
+        fi
+    done
+fi
+
 # We should ignore small (< $Epsilon) floating-point differences (fuzzy compare)
 diff <(cut -c-5 $PREDREF) <(cut -c-5 $PREDOUT)
 case $? in
@@ -0,0 +1,69 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <sstream>
+#include <string>
+
+#include "allocation_profiler.h"
+#include "v_array.h"
+
+namespace
+{
+VW::allocation_statistics count_of(VW::allocation_site site, VW::allocation_mechanism mechanism)
+{
+  for (const auto& count : VW::allocation_counts())
+    if (count.site == site && count.mechanism == mechanism) return count;
+  return {site, mechanism, 0, 0};
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(allocation_report_is_per_example)
+{
+  auto& counter = VW::allocation_counter_of(VW::allocation_site::output, VW::allocation_mechanism::calloc_or_throw);
+  const auto before = count_of(VW::allocation_site::output, VW::allocation_mechanism::calloc_or_throw);
+  counter.allocations += 3;
+  counter.bytes += 300;
+
+  const auto after = count_of(VW::allocation_site::output, VW::allocation_mechanism::calloc_or_throw);
+  BOOST_CHECK_EQUAL(after.allocations - before.allocations, 3);
+  BOOST_CHECK_EQUAL(after.bytes - before.bytes, 300);
+
+  std::ostringstream report;
+  VW::report_allocations(report, 2);
+  const std::string text = report.str();
+  BOOST_CHECK(text.find("allocations of 2 examples:") == 0);
+  std::ostringstream row;
+  row << "output     calloc_or_throw  ";
+  BOOST_CHECK(text.find(row.str()) != std::string::npos);
+  BOOST_CHECK_EQUAL(std::string(VW::to_string(VW::allocation_mechanism::new_)), "new");
+}
+
+#ifdef VW_PROFILE_ALLOCATIONS
+BOOST_AUTO_TEST_CASE(allocations_are_counted_for_the_site_of_the_scope)
+{
+  const auto before = count_of(VW::allocation_site::parser, VW::allocation_mechanism::v_array);
+  {
+    VW_ALLOCATION_SITE(parser);
+    v_array<int> values = v_init<int>();
+    values.resize(10);
+    values.delete_v();
+  }
+  const auto after = count_of(VW::allocation_site::parser, VW::allocation_mechanism::v_array);
+  BOOST_CHECK_EQUAL(after.allocations - before.allocations, 1);
+  BOOST_CHECK_EQUAL(after.bytes - before.bytes, 10 * sizeof(int));
+  BOOST_CHECK(VW::current_allocation_site() == VW::allocation_site::other);
+
+  const auto new_before = count_of(VW::allocation_site::reduction, VW::allocation_mechanism::object_pool);
+  {
+    VW_ALLOCATION_SITE(reduction);
+    VW_ALLOCATION_MECHANISM(object_pool);
+    delete new int(1);
+  }
+  const auto new_after = count_of(VW::allocation_site::reduction, VW::allocation_mechanism::object_pool);
+  BOOST_CHECK_EQUAL(new_after.allocations - new_before.allocations, 1);
+}
+#endif
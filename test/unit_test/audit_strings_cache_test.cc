@@ -0,0 +1,56 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "audit_strings_cache.h"
+#include "feature_group.h"
+
+#include <string>
+
+BOOST_AUTO_TEST_CASE(audit_strings_cache_shares_the_strings_of_repeated_names)
+{
+  VW::audit_strings_cache cache;
+
+  const auto price = cache.get("item", "price");
+  BOOST_CHECK_EQUAL(price->first, "item");
+  BOOST_CHECK_EQUAL(price->second, "price");
+  BOOST_CHECK(cache.get("item", "price") == price);
+
+  // The separator keeps a namespace and a name from running into each other.
+  BOOST_CHECK(cache.get("ite", "mprice") != price);
+  BOOST_CHECK(cache.get("user", "price") != price);
+  BOOST_CHECK_EQUAL(cache.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(audit_strings_cache_empties_when_full)
+{
+  VW::audit_strings_cache cache;
+  const auto first = cache.get("n", "0");
+  for (size_t i = 1; i <= VW::audit_strings_cache::MAX_ENTRIES; i++) cache.get("n", std::to_string(i));
+
+  // The strings handed out before stay as they were.
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  BOOST_CHECK_EQUAL(first->second, "0");
+  BOOST_CHECK(cache.get("n", "0") != first);
+}
+
+BOOST_AUTO_TEST_CASE(sorting_features_leaves_shared_audit_strings_alone)
+{
+  VW::audit_strings_cache cache;
+  features sorted;
+  features other;
+  sorted.push_back(1.f, 2);
+  sorted.space_names.push_back(cache.get("n", "b"));
+  sorted.push_back(1.f, 1);
+  sorted.space_names.push_back(cache.get("n", "a"));
+  other.push_back(1.f, 2);
+  other.space_names.push_back(cache.get("n", "b"));
+
+  sorted.sort(~uint64_t(0));
+  BOOST_CHECK_EQUAL(sorted.space_names[0]->second, "a");
+  BOOST_CHECK_EQUAL(sorted.space_names[1]->second, "b");
+  BOOST_CHECK_EQUAL(other.space_names[0]->second, "b");
+}
@@ -0,0 +1,416 @@
+#ifndef STATIC_LINK_VW
+#  define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "cache.h"
+#include "parser.h"
+#include "vw.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+const std::vector<std::string> cache_test_examples = {
+    "1 |f a b c", "-1 |f a:0.5 d", "1 |g x y |f b", "-1 |f c:2 e", "1 |f a"};
+
+// Caches the examples as a format 2 cache body.
+std::shared_ptr<std::vector<char>> write_cache_blocks(vw& all, const std::vector<std::string>& lines,
+    size_t examples_per_block, bool background = false, bool dedup = false)
+{
+  auto buffer = std::make_shared<std::vector<char>>();
+  io_buf output;
+  output.add_file(VW::io::create_vector_writer(buffer));
+  VW::cache_block_writer writer(output, 0, examples_per_block, background, dedup);
+  for (const auto& line : lines)
+  {
+    auto* ex = VW::read_example(all, line);
+    all.example_parser->lbl_parser.cache_label(&ex->l, writer.block());
+    writer.cache_features(ex, all.parse_mask);
+    writer.example_written();
+    VW::finish_example(all, *ex);
+  }
+  writer.finish();
+  output.flush();
+  return buffer;
+}
+
+// Caches the test examples as a format 2 cache body with two examples per block.
+std::shared_ptr<std::vector<char>> write_blocked_cache(vw& all, std::vector<VW::cache_block_info>& expected_index)
+{
+  auto buffer = write_cache_blocks(all, cache_test_examples, 2);
+
+  // Three blocks of 2, 2 and 1 examples.
+  expected_index.clear();
+  uint64_t offset = 0;
+  for (uint32_t num_examples : {2, 2, 1})
+  {
+    expected_index.push_back({offset, num_examples, 0});
+    uint64_t payload_size;
+    memcpy(&payload_size, buffer->data() + offset + 8, sizeof(payload_size));
+    offset += VW::CACHE_BLOCK_HEADER_SIZE + payload_size;
+  }
+  return buffer;
+}
+
+std::vector<float> read_cached_labels(vw& all)
+{
+  all.example_parser->input->current = 0;
+  all.example_parser->cache_format = 2;
+  all.example_parser->cache_examples_left_in_block = 0;
+
+  std::vector<float> labels;
+  auto examples = v_init<example*>();
+  examples.push_back(&VW::get_unused_example(&all));
+  while (read_cached_features(&all, examples))
+  {
+    labels.push_back(examples[0]->l.simple.label);
+    VW::empty_example(all, *examples[0]);
+  }
+  VW::finish_example(all, *examples[0]);
+  examples.delete_v();
+  return labels;
+}
+
+std::vector<float> read_blocked_cache(vw& all, const std::vector<char>& buffer)
+{
+  all.example_parser->input->add_file(VW::io::create_buffer_view(buffer.data(), buffer.size()));
+  auto labels = read_cached_labels(all);
+  all.example_parser->input->close_files();
+  all.example_parser->input->reset_buffer();
+  return labels;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(cache_format_2_round_trip)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  std::vector<VW::cache_block_info> expected_index;
+  auto buffer = write_blocked_cache(all, expected_index);
+
+  const std::vector<float> expected = {1.f, -1.f, 1.f, -1.f, 1.f};
+  auto labels = read_blocked_cache(all, *buffer);
+  BOOST_CHECK_EQUAL_COLLECTIONS(labels.begin(), labels.end(), expected.begin(), expected.end());
+
+  // The index at the end of the file locates every block.
+  const std::string file_name = "cache_format_2_round_trip.cache";
+  {
+    std::ofstream file(file_name, std::ios::binary);
+    file.write(buffer->data(), buffer->size());
+  }
+  std::vector<VW::cache_block_info> index;
+  BOOST_CHECK(VW::read_cache_index(file_name, index));
+  BOOST_REQUIRE_EQUAL(index.size(), expected_index.size());
+  for (size_t i = 0; i < index.size(); i++)
+  {
+    BOOST_CHECK_EQUAL(index[i].offset, expected_index[i].offset);
+    BOOST_CHECK_EQUAL(index[i].num_examples, expected_index[i].num_examples);
+  }
+
+  // A truncated file has no index.
+  {
+    std::ofstream file(file_name, std::ios::binary);
+    file.write(buffer->data(), buffer->size() - 1);
+  }
+  BOOST_CHECK(!VW::read_cache_index(file_name, index));
+  std::remove(file_name.c_str());
+
+  // Caches held in memory are indexed alike.
+  BOOST_CHECK(VW::read_cache_index(buffer->data(), buffer->size(), index));
+  BOOST_REQUIRE_EQUAL(index.size(), expected_index.size());
+  for (size_t i = 0; i < index.size(); i++) BOOST_CHECK_EQUAL(index[i].offset, expected_index[i].offset);
+  BOOST_CHECK(!VW::read_cache_index(buffer->data(), buffer->size() - 1, index));
+
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(cache_format_2_background_writer_writes_the_same_cache)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  std::vector<std::string> lines;
+  for (int i = 0; i < 40; i++) lines.push_back(cache_test_examples[i % cache_test_examples.size()]);
+
+  // More blocks than may wait for the thread.
+  auto expected = write_cache_blocks(all, lines, 3);
+  auto buffer = write_cache_blocks(all, lines, 3, true);
+  BOOST_CHECK(*buffer == *expected);
+
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(cache_format_2_skips_corrupted_blocks)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  std::vector<VW::cache_block_info> index;
+  auto buffer = write_blocked_cache(all, index);
+
+  // Damaging the payload of the second block fails its checksum.
+  auto damaged_payload = *buffer;
+  damaged_payload[index[1].offset + VW::CACHE_BLOCK_HEADER_SIZE + 2] ^= 0x5a;
+  auto labels = read_blocked_cache(all, damaged_payload);
+  std::vector<float> expected = {1.f, -1.f, 1.f};
+  BOOST_CHECK_EQUAL_COLLECTIONS(labels.begin(), labels.end(), expected.begin(), expected.end());
+
+  // Damaging the header of the first block loses the block boundary, reading resumes at the next block.
+  auto damaged_header = *buffer;
+  damaged_header[index[0].offset] ^= 0x5a;
+  labels = read_blocked_cache(all, damaged_header);
+  expected = {1.f, -1.f, 1.f};
+  BOOST_CHECK_EQUAL_COLLECTIONS(labels.begin(), labels.end(), expected.begin(), expected.end());
+
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(cache_features_round_trip)
+{
+  // Large, unsorted and repeated indices exercise both the word at a time and the byte at a time varint decoding.
+  auto& all = *VW::initialize("--quiet -b 31", nullptr, false, nullptr, nullptr);
+  const std::vector<std::string> lines = {"1 |f 2147483000 7 2147483000:-1 12:0.25 3000000 |g a b:-2.5 c",
+      "-1 |f 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17", "1 |g 2000000000:3 1"};
+
+  auto buffer = std::make_shared<std::vector<char>>();
+  io_buf output;
+  output.add_file(VW::io::create_vector_writer(buffer));
+  VW::cache_block_writer writer(output, 0, 2);
+  std::vector<std::vector<feature_index>> expected_indices;
+  std::vector<std::vector<feature_value>> expected_values;
+  for (const auto& line : lines)
+  {
+    auto* ex = VW::read_example(all, line);
+    for (namespace_index ns : ex->indices)
+    {
+      const features& fs = ex->feature_space[ns];
+      expected_indices.emplace_back();
+      for (feature_index i : fs.indicies) expected_indices.back().push_back(i & all.parse_mask);
+      expected_values.emplace_back(fs.values.begin(), fs.values.end());
+    }
+    all.example_parser->lbl_parser.cache_label(&ex->l, writer.block());
+    cache_features(writer.block(), ex, all.parse_mask);
+    writer.example_written();
+    VW::finish_example(all, *ex);
+  }
+  writer.finish();
+  output.flush();
+
+  all.example_parser->input->add_file(VW::io::create_buffer_view(buffer->data(), buffer->size()));
+  all.example_parser->input->current = 0;
+  all.example_parser->cache_format = 2;
+  all.example_parser->cache_examples_left_in_block = 0;
+
+  size_t group = 0;
+  auto examples = v_init<example*>();
+  examples.push_back(&VW::get_unused_example(&all));
+  while (read_cached_features(&all, examples))
+  {
+    for (namespace_index ns : examples[0]->indices)
+    {
+      const features& fs = examples[0]->feature_space[ns];
+      BOOST_REQUIRE_LT(group, expected_indices.size());
+      BOOST_CHECK_EQUAL_COLLECTIONS(fs.indicies.begin(), fs.indicies.end(), expected_indices[group].begin(),
+          expected_indices[group].end());
+      BOOST_CHECK_EQUAL_COLLECTIONS(
+          fs.values.begin(), fs.values.end(), expected_values[group].begin(), expected_values[group].end());
+      group++;
+    }
+    VW::empty_example(all, *examples[0]);
+  }
+  BOOST_CHECK_EQUAL(group, expected_indices.size());
+  VW::finish_example(all, *examples[0]);
+  examples.delete_v();
+  all.example_parser->input->close_files();
+  all.example_parser->input->reset_buffer();
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(cache_shuffle_reads_every_example_once)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  std::vector<std::string> lines;
+  std::vector<float> expected;
+  for (int i = 0; i < 40; i++)
+  {
+    lines.push_back(std::to_string(i) + " |f a b");
+    expected.push_back(static_cast<float>(i));
+  }
+  auto buffer = write_cache_blocks(all, lines, 4);
+  const std::string file_name = "cache_shuffle_reads_every_example_once.cache";
+  {
+    std::ofstream file(file_name, std::ios::binary);
+    file.write(buffer->data(), buffer->size());
+  }
+
+  io_buf* input = all.example_parser->input;
+  input->add_file(VW::io::open_file_reader(file_name));
+  all.example_parser->cache_shuffler.reset(new VW::cache_shuffler(7));
+  std::vector<std::vector<float>> passes;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    input->reset_file(input->input_files[0].get());
+    all.example_parser->cache_shuffler->start_pass({file_name}, all.trace_message);
+    passes.push_back(read_cached_labels(all));
+  }
+  input->close_files();
+  input->reset_buffer();
+  all.example_parser->cache_shuffler.reset();
+  std::remove(file_name.c_str());
+
+  for (auto& labels : passes)
+  {
+    BOOST_CHECK(labels != expected);
+    std::sort(labels.begin(), labels.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(labels.begin(), labels.end(), expected.begin(), expected.end());
+  }
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(cache_shuffle_reads_every_example_of_a_memory_cache_once)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  std::vector<std::string> lines;
+  std::vector<float> expected;
+  for (int i = 0; i < 40; i++)
+  {
+    lines.push_back(std::to_string(i) + " |f a b");
+    expected.push_back(static_cast<float>(i));
+  }
+  auto buffer = write_cache_blocks(all, lines, 4);
+
+  io_buf* input = all.example_parser->input;
+  input->add_file(VW::io::create_buffer_view(buffer->data(), buffer->size()));
+  all.example_parser->cache_shuffler.reset(new VW::cache_shuffler(7));
+  input->reset_file(input->input_files[0].get());
+  all.example_parser->cache_shuffler->start_pass(buffer->data(), buffer->size());
+  auto labels = read_cached_labels(all);
+  input->close_files();
+  input->reset_buffer();
+  all.example_parser->cache_shuffler.reset();
+
+  BOOST_CHECK(labels != expected);
+  std::sort(labels.begin(), labels.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(labels.begin(), labels.end(), expected.begin(), expected.end());
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(daemon_reader_reads_cache_blocks)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+
+  // A binary daemon request is the marker byte followed by blocks, a client flushes its writer after each request.
+  auto request = std::make_shared<std::vector<char>>();
+  {
+    io_buf output;
+    output.add_file(VW::io::create_vector_writer(request));
+    output.bin_write_fixed(&VW::DAEMON_BLOCKS_MARKER, 1);
+    VW::cache_block_writer writer(output, 0, 1024);
+    for (size_t i = 0; i < cache_test_examples.size(); i++)
+    {
+      auto* ex = VW::read_example(all, cache_test_examples[i]);
+      all.example_parser->lbl_parser.cache_label(&ex->l, writer.block());
+      cache_features(writer.block(), ex, all.parse_mask);
+      writer.example_written();
+      VW::finish_example(all, *ex);
+      // Two requests, of 2 and 3 examples.
+      if (i == 1) writer.flush();
+    }
+    writer.flush();
+  }
+
+  all.example_parser->input->add_file(VW::io::create_buffer_view(request->data(), request->size()));
+  set_daemon_reader(all);
+  BOOST_CHECK_EQUAL(all.example_parser->cache_format, 2);
+  BOOST_CHECK(all.example_parser->reader == read_cached_features);
+
+  const std::vector<float> expected = {1.f, -1.f, 1.f, -1.f, 1.f};
+  auto labels = read_cached_labels(all);
+  BOOST_CHECK_EQUAL_COLLECTIONS(labels.begin(), labels.end(), expected.begin(), expected.end());
+  all.example_parser->input->close_files();
+  all.example_parser->input->reset_buffer();
+
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(instances_learn_from_a_shared_memory_cache)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+
+  // Laid out as the --in_memory cache, a header followed by the blocks and their index.
+  auto cache = std::make_shared<std::vector<char>>();
+  {
+    io_buf output;
+    output.add_file(VW::io::create_vector_writer(cache));
+    VW::cache_block_writer writer(output, write_cache_header(all, output, 2), 2);
+    for (const auto& line : cache_test_examples)
+    {
+      auto* ex = VW::read_example(all, line);
+      all.example_parser->lbl_parser.cache_label(&ex->l, writer.block());
+      cache_features(writer.block(), ex, all.parse_mask);
+      writer.example_written();
+      VW::finish_example(all, *ex);
+    }
+    writer.finish();
+    output.flush();
+  }
+
+  auto& shared = *VW::initialize_with_memory_cache("--quiet --no_stdin --passes 2", cache);
+  BOOST_CHECK(shared.example_parser->reader == read_cached_features);
+  BOOST_CHECK(shared.example_parser->resettable);
+  const std::vector<float> expected = {1.f, -1.f, 1.f, -1.f, 1.f};
+  auto labels = read_cached_labels(shared);
+  BOOST_CHECK_EQUAL_COLLECTIONS(labels.begin(), labels.end(), expected.begin(), expected.end());
+  VW::finish(shared);
+
+  // The cache has the 18 bits of all.
+  BOOST_CHECK_THROW(VW::initialize_with_memory_cache("--quiet --no_stdin -b 20", cache), VW::vw_exception);
+
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(cache_dedup_refers_to_repeated_namespaces)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < 12; i++)
+  {
+    lines.push_back(std::to_string(i % 2 == 0 ? 1 : -1) + " |u user" + std::to_string(i) + " |a product" +
+        std::to_string(i % 3) + " color:0.25 size:3 brand price:7.5");
+  }
+  auto plain = write_cache_blocks(all, lines, 5);
+  auto dedup = write_cache_blocks(all, lines, 5, false, true);
+  BOOST_CHECK_LT(dedup->size(), plain->size());
+
+  // The examples read back are the same, with the namespaces they refer to decoded once per block.
+  auto read_features = [&all](const std::vector<char>& buffer) {
+    all.example_parser->input->add_file(VW::io::create_buffer_view(buffer.data(), buffer.size()));
+    all.example_parser->input->current = 0;
+    all.example_parser->cache_format = 2;
+    all.example_parser->cache_examples_left_in_block = 0;
+    std::vector<std::vector<std::pair<uint64_t, float>>> features;
+    auto examples = v_init<example*>();
+    examples.push_back(&VW::get_unused_example(&all));
+    while (read_cached_features(&all, examples))
+    {
+      features.emplace_back();
+      for (features& fs : *examples[0])
+        for (auto f = fs.begin(); f != fs.end(); ++f) features.back().emplace_back(f.index(), f.value());
+      VW::empty_example(all, *examples[0]);
+    }
+    VW::finish_example(all, *examples[0]);
+    examples.delete_v();
+    all.example_parser->input->close_files();
+    all.example_parser->input->reset_buffer();
+    return features;
+  };
+  const auto expected = read_features(*plain);
+  const auto actual = read_features(*dedup);
+  BOOST_REQUIRE_EQUAL(actual.size(), lines.size());
+  BOOST_CHECK(actual == expected);
+
+  VW::finish(all);
+}
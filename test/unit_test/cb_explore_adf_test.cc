@@ -1,17 +1,118 @@
-
-#ifndef STATIC_LINK_VW
-#define BOOST_TEST_DYN_LINK
-#endif
-
-#include <boost/test/unit_test.hpp>
-
-#include "vw.h"
-
-BOOST_AUTO_TEST_CASE(cb_explore_adf_should_throw_empty_multi_example) {
-  auto vw = VW::initialize("--cb_explore_adf --quiet", nullptr, false, nullptr, nullptr);
-  multi_ex example_collection;
-
-  // An empty example collection is invalid and so should throw.
-  BOOST_REQUIRE_THROW(vw->learn(example_collection), VW::vw_exception);
-  VW::finish(*vw);
-}
+
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "vw.h"
+
+BOOST_AUTO_TEST_CASE(cb_explore_adf_should_throw_empty_multi_example) {
+  auto vw = VW::initialize("--cb_explore_adf --quiet", nullptr, false, nullptr, nullptr);
+  multi_ex example_collection;
+
+  // An empty example collection is invalid and so should throw.
+  BOOST_REQUIRE_THROW(vw->learn(example_collection), VW::vw_exception);
+  VW::finish(*vw);
+}
+
+BOOST_AUTO_TEST_CASE(csoaa_rank_top_k_ranks_the_best_actions_first) {
+  const std::vector<std::string> args = {"", " --csoaa_rank_top_k 3", " --csoaa_rank_top_k 3 --csoaa_rank_top_k_bound"};
+  std::vector<std::vector<ACTION_SCORE::action_score>> rankings;
+  for (const auto& arg : args)
+  {
+    auto& vw = *VW::initialize("--cb_adf -q sa --quiet" + arg, nullptr, false, nullptr, nullptr);
+    for (int pass = 0; pass < 2; pass++)
+    {
+      for (size_t i = 0; i < 10; i++)
+      {
+        multi_ex examples;
+        examples.push_back(VW::read_example(vw, "shared |s u" + std::to_string(i % 2)));
+        for (size_t action = 0; action < 20; action++)
+        {
+          const std::string label = pass == 0 && action == i ? "0:" + std::to_string(action % 3) + ":0.5 " : "";
+          examples.push_back(VW::read_example(
+              vw, label + "|a x" + std::to_string(action) + ":" + std::to_string(1 + action % 4) + " y"));
+        }
+        if (pass == 0)
+          vw.learn(examples);
+        else
+        {
+          vw.predict(examples);
+          const auto& a_s = examples[0]->pred.a_s;
+          rankings.emplace_back(a_s.begin(), a_s.begin() + 3);
+        }
+        vw.finish_example(examples);
+      }
+    }
+    VW::finish(vw);
+  }
+
+  const size_t decisions = rankings.size() / args.size();
+  for (size_t i = 0; i < decisions; i++)
+    for (size_t run = 1; run < args.size(); run++)
+      for (size_t k = 0; k < 3; k++)
+      {
+        BOOST_CHECK_EQUAL(rankings[run * decisions + i][k].action, rankings[i][k].action);
+        BOOST_CHECK_EQUAL(rankings[run * decisions + i][k].score, rankings[i][k].score);
+      }
+}
+
+BOOST_AUTO_TEST_CASE(multi_sensitivity_matches_sensitivity_of_each_label) {
+  for (const std::string arg : {"", " --normalized", " --adaptive", " --sgd"})
+  {
+    auto& vw = *VW::initialize("--quiet" + arg, nullptr, false, nullptr, nullptr);
+    for (size_t i = 0; i < 10; i++)
+    {
+      const std::string line =
+          std::to_string(i % 3) + " |f a:" + std::to_string(1 + i % 4) + " b c" + std::to_string(i % 2);
+      auto* ex = VW::read_example(vw, line);
+      vw.learn(*ex);
+      vw.finish_example(*ex);
+    }
+
+    auto* ex = VW::read_example(vw, std::string("|f a:3 b c0 d"));
+    vw.predict(*ex);
+    const float labels[3] = {-1.f, 2.f, 0.5f};
+    float sensitivities[3];
+    vw.l->multi_sensitivity(*ex, labels, 3, sensitivities);
+    for (size_t c = 0; c < 3; c++)
+    {
+      ex->l.simple.label = labels[c];
+      BOOST_CHECK_EQUAL(sensitivities[c], vw.l->sensitivity(*ex));
+    }
+    vw.finish_example(*ex);
+    VW::finish(vw);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(predict_with_sensitivity_matches_predict_then_sensitivity) {
+  for (const std::string arg : {"", " --adax", " --adax --normalized", " --sgd"})
+  {
+    auto& vw = *VW::initialize("--quiet" + arg, nullptr, false, nullptr, nullptr);
+    for (size_t i = 0; i < 10; i++)
+    {
+      const std::string line =
+          std::to_string(i % 3) + " |f a:" + std::to_string(1 + i % 4) + " b c" + std::to_string(i % 2);
+      auto* ex = VW::read_example(vw, line);
+      vw.learn(*ex);
+      vw.finish_example(*ex);
+    }
+
+    for (const std::string line : {"2 |f a:3 b c0 d", "|f a:2 c1"})
+    {
+      auto* ex = VW::read_example(vw, line);
+      const float sensitivity = vw.l->predict_with_sensitivity(*ex);
+      const float prediction = ex->pred.scalar;
+
+      vw.predict(*ex);
+      BOOST_CHECK_CLOSE(ex->pred.scalar, prediction, 1e-4);
+      const float label = ex->l.simple.label;
+      if (label == FLT_MAX) ex->l.simple.label = ex->pred.scalar > 0 ? -1.f : 1.f;
+      BOOST_CHECK_CLOSE(vw.l->sensitivity(*ex), sensitivity, 1e-4);
+      ex->l.simple.label = label;
+      vw.finish_example(*ex);
+    }
+    VW::finish(vw);
+  }
+}
@@ -195,3 +195,24 @@ BOOST_AUTO_TEST_CASE(ccb_invalid_example_checks)
   vw.finish_example(examples);
   VW::finish(vw);
 }
+
+BOOST_AUTO_TEST_CASE(ccb_restores_interactions_after_all_slots)
+{
+  auto& vw = *VW::initialize("--ccb_explore_adf --quiet -q UA");
+  multi_ex examples;
+  examples.push_back(VW::read_example(vw, std::string("ccb shared |User f")));
+  examples.push_back(VW::read_example(vw, std::string("ccb action |Action a")));
+  examples.push_back(VW::read_example(vw, std::string("ccb action |Action b")));
+  examples.push_back(VW::read_example(vw, std::string("ccb action |Action c")));
+  examples.push_back(VW::read_example(vw, std::string("ccb slot 0:1:0.5 |Slot x |Position y")));
+  examples.push_back(VW::read_example(vw, std::string("ccb slot 1:0:0.5 |Slot z")));
+
+  vw.learn(examples);
+
+  BOOST_CHECK_EQUAL(examples[0]->pred.decision_scores.size(), 2);
+  for (size_t i = 0; i < 4; i++) BOOST_CHECK(examples[i]->interactions == &vw.interactions);
+  BOOST_CHECK_EQUAL(examples[0]->feature_space[ccb_id_namespace].size(), 0);
+
+  vw.finish_example(examples);
+  VW::finish(vw);
+}
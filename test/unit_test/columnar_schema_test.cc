@@ -0,0 +1,48 @@
+#ifndef STATIC_LINK_VW
+#  define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <sstream>
+
+#include "parser/columnar/parse_example_columnar.h"
+#include "vw_exception.h"
+
+using namespace VW::parsers::columnar;
+
+BOOST_AUTO_TEST_CASE(columnar_schema_read)
+{
+  std::stringstream in(
+      "# columns of the clicks table\n"
+      "clicked label\n"
+      "\n"
+      "age\tnumeric user  # years\n"
+      "country categorical user\n"
+      "price numeric\n"
+      "id tag\n");
+  const auto schema = read_schema(in);
+
+  BOOST_REQUIRE_EQUAL(schema.size(), 5);
+  BOOST_CHECK_EQUAL(schema[0].column, "clicked");
+  BOOST_CHECK(schema[0].role == column_role::label);
+  BOOST_CHECK_EQUAL(schema[1].column, "age");
+  BOOST_CHECK(schema[1].role == column_role::numeric);
+  BOOST_CHECK_EQUAL(schema[1].ns, "user");
+  BOOST_CHECK(schema[2].role == column_role::categorical);
+  BOOST_CHECK_EQUAL(schema[2].ns, "user");
+  BOOST_CHECK_EQUAL(schema[3].ns, " ");
+  BOOST_CHECK(schema[4].role == column_role::tag);
+}
+
+BOOST_AUTO_TEST_CASE(columnar_schema_read_rejects_malformed_lines)
+{
+  const char* schemas[] = {"", "# nothing\n", "age\n", "age numeric user extra\n", "age number\n",
+      "id tag ns\n", "a label\nb label\n"};
+  for (const auto* schema : schemas)
+  {
+    std::stringstream in(schema);
+    BOOST_CHECK_THROW(read_schema(in), VW::vw_exception);
+  }
+}
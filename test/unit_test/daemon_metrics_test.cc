@@ -0,0 +1,56 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <string>
+
+#include "daemon_metrics.h"
+#include "vw.h"
+
+namespace
+{
+bool has_line(const std::string& metrics, const std::string& line)
+{
+  return metrics.find("\n" + line + "\n") != std::string::npos;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(daemon_metrics_render_the_examples_and_memory)
+{
+  auto& vw = *VW::initialize("--quiet -b 10 --sgd");
+  {
+    VW::daemon_metrics metrics(vw, 0);
+    BOOST_CHECK_NE(metrics.port(), 0);
+
+    const std::string text = metrics.render();
+    BOOST_CHECK(has_line(text, "# TYPE vw_examples_total counter"));
+    BOOST_CHECK(has_line(text, "vw_examples_total 0"));
+    BOOST_CHECK(has_line(text, "vw_ready_parsed_examples 0"));
+    BOOST_CHECK(has_line(text, "vw_request_latency_seconds{quantile=\"0.5\"} NaN"));
+    BOOST_CHECK(has_line(text, "vw_request_latency_seconds_count 0"));
+    BOOST_CHECK(has_line(text, "vw_memory_bytes{subsystem=\"weights\"} " + std::to_string(4 << 10)));
+    BOOST_CHECK(has_line(text, "vw_memory_bytes{subsystem=\"hash_cache\"} 0"));
+    // without --reload_model there are no reloads to count
+    BOOST_CHECK(text.find("vw_model_reloads_total") == std::string::npos);
+  }
+  VW::finish(vw);
+}
+
+BOOST_AUTO_TEST_CASE(daemon_metrics_latency_quantiles_are_of_the_last_requests)
+{
+  auto& vw = *VW::initialize("--quiet");
+  {
+    VW::daemon_metrics metrics(vw, 0);
+    // 2000 requests of 1 to 2000 milliseconds, of which the last 1024 are from 977 milliseconds on
+    for (int i = 1; i <= 2000; i++) metrics.request_finished(std::chrono::milliseconds(i));
+
+    const std::string text = metrics.render();
+    BOOST_CHECK(has_line(text, "vw_request_latency_seconds{quantile=\"0.5\"} 1.488"));
+    BOOST_CHECK(has_line(text, "vw_request_latency_seconds{quantile=\"0.99\"} 1.989"));
+    BOOST_CHECK(has_line(text, "vw_request_latency_seconds_count 2000"));
+  }
+  VW::finish(vw);
+}
@@ -0,0 +1,69 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "dense_batch.h"
+#include "gd.h"
+#include "test_common.h"
+#include "vw.h"
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(predict_batch_matches_predict)
+{
+  auto& vw = *VW::initialize("--quiet -q ab");
+  for (size_t i = 0; i < 50; i++)
+  {
+    auto& ex = *VW::read_example(vw, std::to_string(i % 2) + " |a x" + std::to_string(i % 5) + ":0.5 y |b z:2");
+    vw.learn(ex);
+    vw.finish_example(ex);
+  }
+
+  multi_ex examples;
+  std::vector<float> expected;
+  for (size_t i = 0; i < 5; i++)
+  {
+    examples.push_back(VW::read_example(vw, "|a x" + std::to_string(i) + ":0.5 y |b z:2 w"));
+    vw.predict(*examples.back());
+    expected.push_back(examples.back()->pred.scalar);
+  }
+
+  auto backend = VW::make_dense_backend(vw, "cpu");
+  VW::flat_batch batch;
+  GD::predict_batch(vw, examples, *backend, batch);
+  BOOST_CHECK_EQUAL(batch.size(), examples.size());
+  for (size_t i = 0; i < examples.size(); i++) BOOST_CHECK_CLOSE(examples[i]->pred.scalar, expected[i], FLOAT_TOL);
+
+  for (example* ex : examples) vw.finish_example(*ex);
+  VW::finish(vw);
+}
+
+BOOST_AUTO_TEST_CASE(dense_backend_update_adds_to_the_weights)
+{
+  auto& vw = *VW::initialize("--quiet --noconstant");
+  auto& ex = *VW::read_example(vw, std::string("|a x:2 y:3"));
+  auto backend = VW::make_dense_backend(vw, "cpu");
+  VW::flat_batch batch;
+  batch.add(vw, ex);
+  const float update = 0.5f;
+  backend->update(batch, &update);
+
+  float prediction;
+  backend->predict(batch, 2.f, &prediction);
+  // x and y have weights 1 and 1.5.
+  BOOST_CHECK_CLOSE(prediction, 2.f * (2.f * 1.f + 3.f * 1.5f), FLOAT_TOL);
+
+  vw.finish_example(ex);
+  VW::finish(vw);
+}
+
+BOOST_AUTO_TEST_CASE(make_dense_backend_rejects_unknown_backends)
+{
+  auto& vw = *VW::initialize("--quiet");
+  BOOST_CHECK_THROW(VW::make_dense_backend(vw, "tpu"), VW::vw_exception);
+  VW::finish(vw);
+}
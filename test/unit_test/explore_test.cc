@@ -177,3 +177,57 @@ BOOST_AUTO_TEST_CASE(swap_test)
   const std::vector<float> expected_pdf_2 = { 0.266666667f,	0.133333333f,	0.2f,	0.066666667f,	0.333333333f };
   check_collections_with_float_tolerance(pdf, expected_pdf_2, .0001f);
 }
+
+BOOST_AUTO_TEST_CASE(batched_softmax_matches_softmax)
+{
+  const size_t num_actions = 5;
+  const std::vector<float> scores = {0.1f, -2.f, 3.5f, 0.f, 1.f, 7.f, 7.f, -1.f, 2.f, 0.25f};
+  std::vector<float> expected(scores.size());
+  for (size_t d = 0; d < 2; d++)
+  {
+    exploration::generate_softmax(1.5f, scores.begin() + d * num_actions, scores.begin() + (d + 1) * num_actions,
+        expected.begin() + d * num_actions, expected.begin() + (d + 1) * num_actions);
+  }
+
+  std::vector<float> pmf(scores.size());
+  BOOST_CHECK_EQUAL(exploration::generate_softmax(1.5f, scores.data(), pmf.data(), num_actions, 2), S_EXPLORATION_OK);
+  BOOST_CHECK_EQUAL_COLLECTIONS(pmf.begin(), pmf.end(), expected.begin(), expected.end());
+
+  // In place.
+  pmf = scores;
+  exploration::generate_softmax(1.5f, pmf.data(), pmf.data(), num_actions, 2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(pmf.begin(), pmf.end(), expected.begin(), expected.end());
+
+  BOOST_CHECK_EQUAL(exploration::generate_softmax(1.5f, scores.data(), pmf.data(), 0, 2), E_EXPLORATION_BAD_RANGE);
+}
+
+BOOST_AUTO_TEST_CASE(batched_sampling_matches_sample_after_normalizing)
+{
+  const size_t num_actions = 4;
+  const size_t num_decisions = 50;
+  std::vector<float> pmf;
+  std::vector<uint64_t> seeds;
+  uint64_t state = 7791;
+  for (size_t d = 0; d < num_decisions; d++)
+  {
+    seeds.push_back(state);
+    exploration::uniform_random_merand48_advance(state);
+    for (size_t a = 0; a < num_actions; a++)
+      pmf.push_back(d % 7 == 0 ? 0.f : exploration::uniform_random_merand48_advance(state) - 0.2f);
+  }
+
+  auto expected_pmf = pmf;
+  std::vector<uint32_t> expected(num_decisions);
+  for (size_t d = 0; d < num_decisions; d++)
+  {
+    exploration::sample_after_normalizing(seeds[d], expected_pmf.begin() + d * num_actions,
+        expected_pmf.begin() + (d + 1) * num_actions, expected[d]);
+  }
+
+  std::vector<uint32_t> chosen(num_decisions);
+  BOOST_CHECK_EQUAL(
+      exploration::sample_after_normalizing(seeds.data(), pmf.data(), num_actions, num_decisions, chosen.data()),
+      S_EXPLORATION_OK);
+  BOOST_CHECK_EQUAL_COLLECTIONS(chosen.begin(), chosen.end(), expected.begin(), expected.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(pmf.begin(), pmf.end(), expected_pmf.begin(), expected_pmf.end());
+}
@@ -0,0 +1,79 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "feature_hash_cache.h"
+#include "parse_example.h"
+#include "vw.h"
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(feature_hash_cache_matches_hasher)
+{
+  auto hasher = getHasher("strings");
+  VW::feature_hash_cache cache(64);
+
+  const std::string long_name(VW::feature_hash_cache::MAX_NAME_SIZE + 1, 'x');
+  const std::vector<std::string> names = {"a", "price", "12", long_name, "price", "a", long_name};
+  for (const auto& name : names)
+  {
+    for (uint64_t seed : {0, 7, 1234567})
+    { BOOST_CHECK_EQUAL(cache.hash(hasher, 'n', name, seed), hasher(name.data(), name.size(), seed)); }
+  }
+
+  // The second occurrences of "price" and "a" are hits for every seed, names longer than MAX_NAME_SIZE are not cached.
+  BOOST_CHECK_EQUAL(cache.hits(), 6);
+  BOOST_CHECK_EQUAL(cache.misses(), 15);
+}
+
+BOOST_AUTO_TEST_CASE(feature_hash_cache_evicts_when_full)
+{
+  auto hasher = getHasher("all");
+  VW::feature_hash_cache cache(1);
+
+  // Many more names than slots, every lookup must still return the right hash.
+  for (int round = 0; round < 2; round++)
+  {
+    for (int i = 0; i < 1000; i++)
+    {
+      const std::string name = "f" + std::to_string(i);
+      BOOST_CHECK_EQUAL(cache.hash(hasher, ' ', name, 0), hasher(name.data(), name.size(), 0));
+    }
+  }
+  BOOST_CHECK_EQUAL(cache.hits() + cache.misses(), 2000);
+}
+
+BOOST_AUTO_TEST_CASE(feature_hash_cache_keeps_text_features)
+{
+  auto* plain = VW::initialize("--quiet");
+  auto* cached = VW::initialize("--quiet --hash_cache_size 8");
+
+  const std::string lines[] = {"1 |a x y:2 z |b x w:0.5", "0 |a x z |b w:0.5 v", "1 |a x y:2 |b x"};
+  for (const auto& line : lines)
+  {
+    auto* plain_ex = VW::read_example(*plain, line);
+    auto* cached_ex = VW::read_example(*cached, line);
+    BOOST_REQUIRE_EQUAL(plain_ex->indices.size(), cached_ex->indices.size());
+    for (auto ns : plain_ex->indices)
+    {
+      const auto& expected = plain_ex->feature_space[ns];
+      const auto& actual = cached_ex->feature_space[ns];
+      BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+      for (size_t i = 0; i < expected.size(); i++)
+      {
+        BOOST_CHECK_EQUAL(expected.indicies[i], actual.indicies[i]);
+        BOOST_CHECK_EQUAL(expected.values[i], actual.values[i]);
+      }
+    }
+    VW::finish_example(*plain, *plain_ex);
+    VW::finish_example(*cached, *cached_ex);
+  }
+  BOOST_CHECK_GT(cached->example_parser->hash_cache->hits(), 0);
+
+  VW::finish(*plain);
+  VW::finish(*cached);
+}
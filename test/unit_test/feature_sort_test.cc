@@ -0,0 +1,99 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "feature_group.h"
+#include "unique_sort.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// Sizes below and above the one where features::sort turns to radix sorting, with few distinct indices so that many
+// features share theirs, order the features as sorting by index and then by value does.
+BOOST_AUTO_TEST_CASE(feature_sort_orders_by_index_then_value)
+{
+  std::mt19937 rng(5);
+  const uint64_t parse_mask = (uint64_t(1) << 18) - 1;
+  for (size_t size : {1, 2, 50, 511, 512, 513, 1000, 5000})
+  {
+    for (uint64_t distinct : {uint64_t(3), parse_mask})
+    {
+      std::uniform_int_distribution<uint64_t> index(0, distinct);
+      std::uniform_int_distribution<int> value(-4, 4);
+      features fs;
+      std::vector<std::pair<uint64_t, float>> expected;
+      for (size_t i = 0; i < size; i++)
+      {
+        // The bits above the mask are dropped by the sort.
+        const uint64_t hash = index(rng) + (uint64_t(i) << 40);
+        const float v = static_cast<float>(value(rng));
+        fs.push_back(v, hash);
+        expected.emplace_back(hash & parse_mask, v);
+      }
+      std::sort(expected.begin(), expected.end());
+
+      BOOST_REQUIRE(fs.sort(parse_mask));
+      BOOST_REQUIRE_EQUAL(fs.size(), size);
+      for (size_t i = 0; i < size; i++)
+      {
+        BOOST_CHECK_EQUAL(fs.indicies[i], expected[i].first);
+        BOOST_CHECK_EQUAL(fs.values[i], expected[i].second);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(feature_sort_moves_the_audit_strings_with_their_features)
+{
+  features fs;
+  for (size_t i = 0; i < 300; i++)
+  {
+    const uint64_t index = (i * 7919) % 300;
+    fs.push_back(1.f, index);
+    fs.space_names.push_back(audit_strings_ptr(new audit_strings("n", std::to_string(index))));
+  }
+
+  fs.sort(~uint64_t(0));
+  for (size_t i = 0; i < fs.size(); i++)
+  {
+    BOOST_CHECK_EQUAL(fs.indicies[i], i);
+    BOOST_CHECK_EQUAL(fs.space_names[i]->second, std::to_string(i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(limit_features_keeps_what_sorting_the_whole_namespace_does)
+{
+  std::mt19937 rng(9);
+  const uint64_t parse_mask = (uint64_t(1) << 18) - 1;
+  for (size_t limit : {1, 10, 100})
+  {
+    for (uint64_t distinct : {uint64_t(40), parse_mask})
+    {
+      std::uniform_int_distribution<uint64_t> index(0, distinct);
+      features limited;
+      features sorted;
+      for (size_t i = 0; i < 500; i++)
+      {
+        const uint64_t hash = index(rng);
+        const float v = static_cast<float>(i % 3);
+        limited.push_back(v, hash);
+        sorted.push_back(v, hash);
+      }
+
+      limit_features(limited, parse_mask, limit);
+      sorted.sort(parse_mask);
+      unique_features(sorted, static_cast<int>(limit));
+      BOOST_REQUIRE_EQUAL(limited.size(), sorted.size());
+      for (size_t i = 0; i < sorted.size(); i++)
+      {
+        BOOST_CHECK_EQUAL(limited.indicies[i], sorted.indicies[i]);
+        BOOST_CHECK_EQUAL(limited.values[i], sorted.values[i]);
+      }
+    }
+  }
+}
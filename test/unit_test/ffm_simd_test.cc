@@ -0,0 +1,75 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <random>
+#include <vector>
+
+#include "ffm_simd.h"
+#include "test_common.h"
+
+namespace
+{
+// The vector kernels fuse their multiply adds, which rounds a little differently than the definitions.
+constexpr float FMA_TOL = 0.01f;
+
+// The latent vectors of count features, each in a stride of its own as --ffm stores them, and their feature values.
+// They are positive so that the sums do not cancel, which would make the rounding stand out.
+struct latent_vectors
+{
+  latent_vectors(size_t count, size_t k, std::mt19937& rng) : stride(k + 3), floats(count * stride), x(count)
+  {
+    std::uniform_real_distribution<float> value(0.1f, 1.f);
+    for (auto& f : floats) f = value(rng);
+    for (auto& v : x) v = 2.f * value(rng);
+  }
+
+  std::vector<float*> vectors()
+  {
+    std::vector<float*> pointers;
+    for (size_t i = 0; i < x.size(); i++) pointers.push_back(&floats[i * stride + 1]);
+    return pointers;
+  }
+
+  size_t stride;
+  std::vector<float> floats;
+  std::vector<float> x;
+};
+}  // namespace
+
+// Every length of vectors, below and above the width of the vector kernels, finds what the definitions do.
+BOOST_AUTO_TEST_CASE(ffm_kernels_match_their_definitions)
+{
+  std::mt19937 rng(17);
+  for (size_t k = 1; k <= 20; k++)
+  {
+    for (size_t count = 0; count <= 5; count++)
+    {
+      latent_vectors batched(count, k, rng);
+      latent_vectors expected = batched;
+      const std::vector<float*> vectors = batched.vectors();
+      const std::vector<float*> expected_vectors = expected.vectors();
+
+      std::vector<float> sum(k, 0.5f);
+      std::vector<float> expected_sum(k, 0.5f);
+      VW::ffm_accumulate(sum.data(), vectors.data(), batched.x.data(), count, k);
+      for (size_t i = 0; i < count; i++)
+        for (size_t j = 0; j < k; j++) expected_sum[j] += batched.x[i] * expected_vectors[i][j];
+      check_collections_with_float_tolerance(sum, expected_sum, FMA_TOL);
+
+      float expected_dot = 0.f;
+      for (size_t j = 0; j < k; j++) expected_dot += sum[j] * expected_sum[j];
+      BOOST_CHECK_CLOSE(VW::ffm_dot(sum.data(), expected_sum.data(), k), expected_dot, FMA_TOL);
+
+      VW::ffm_update(vectors.data(), batched.x.data(), count, sum.data(), k, 0.25f, 0.01f);
+      for (size_t i = 0; i < count; i++)
+        for (size_t j = 0; j < k; j++)
+          expected_vectors[i][j] += 0.25f * expected.x[i] * sum[j] - 0.01f * expected_vectors[i][j];
+      // The floats around the vectors are left as they were.
+      check_collections_with_float_tolerance(batched.floats, expected.floats, FMA_TOL);
+    }
+  }
+}
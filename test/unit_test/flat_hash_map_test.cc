@@ -0,0 +1,59 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "flat_hash_map.h"
+
+BOOST_AUTO_TEST_CASE(flat_hash_map_matches_unordered_map)
+{
+  VW::flat_hash_map<double> map;
+  std::unordered_map<uint64_t, double> expected;
+  // Strided indices, with the low bits 0, and keys of both halves of the range.
+  for (uint64_t i = 0; i < 5000; i++)
+  {
+    const uint64_t key = (i % 3 == 0) ? (i << 2) : UINT64_MAX - i * 7;
+    map[key] += (double)i;
+    expected[key] += (double)i;
+  }
+
+  BOOST_CHECK_EQUAL(map.size(), expected.size());
+  for (const auto& entry : expected)
+  {
+    const double* value = map.find(entry.first);
+    BOOST_REQUIRE(value != nullptr);
+    BOOST_CHECK_EQUAL(*value, entry.second);
+  }
+  BOOST_CHECK(map.find(1) == nullptr);
+
+  size_t visited = 0;
+  for (auto& entry : map)
+  {
+    BOOST_CHECK_EQUAL(entry.value, expected[entry.key]);
+    visited++;
+  }
+  BOOST_CHECK_EQUAL(visited, expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(flat_hash_map_try_emplace_keeps_existing_values)
+{
+  VW::flat_hash_map<int> map(100);
+  auto inserted = map.try_emplace(42, 1);
+  BOOST_CHECK(inserted.second);
+  BOOST_CHECK_EQUAL(*inserted.first, 1);
+
+  auto existing = map.try_emplace(42, 2);
+  BOOST_CHECK(!existing.second);
+  BOOST_CHECK_EQUAL(*existing.first, 1);
+  BOOST_CHECK_EQUAL(map.size(), 1);
+
+  map.clear();
+  BOOST_CHECK(map.empty());
+  BOOST_CHECK(map.find(42) == nullptr);
+  BOOST_CHECK(map.begin() == map.end());
+}
@@ -130,4 +130,59 @@ BOOST_AUTO_TEST_CASE(test_flatbuffer_collection)
   VW::finish_example(*all, *examples[0]);
   examples.delete_v();
   VW::finish(*all);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(test_flatbuffer_feature_columns)
+{
+  auto all = VW::initialize("--no_stdin --quiet --flatbuffer", nullptr, false, nullptr, nullptr);
+
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<flatbuffers::Offset<VW::parsers::flatbuffer::Feature>> fts;
+  fts.push_back(VW::parsers::flatbuffer::CreateFeatureDirect(builder, nullptr, 2.f, 7));
+  std::vector<uint64_t> hashes = {11, 13, 17};
+  std::vector<float> values = {0.5f, 1.5f, -3.f};
+  std::vector<flatbuffers::Offset<VW::parsers::flatbuffer::Namespace>> namespaces;
+  namespaces.push_back(
+      VW::parsers::flatbuffer::CreateNamespaceDirect(builder, nullptr, constant_namespace, &fts, &hashes, &values));
+  auto label = get_label(builder, VW::parsers::flatbuffer::Label_SimpleLabel);
+  auto ex = VW::parsers::flatbuffer::CreateExampleDirect(
+      builder, &namespaces, VW::parsers::flatbuffer::Label_SimpleLabel, label);
+  builder.FinishSizePrefixed(CreateExampleRoot(builder, VW::parsers::flatbuffer::ExampleType_Example, ex.Union()));
+
+  auto examples = v_init<example*>();
+  examples.push_back(&VW::get_unused_example(all));
+  all->flat_converter->parse_examples(all, examples, builder.GetBufferPointer());
+
+  // Features from the Feature tables come first, followed by the columns.
+  const auto& fs = examples[0]->feature_space[constant_namespace];
+  BOOST_REQUIRE_EQUAL(fs.size(), 4);
+  BOOST_CHECK_EQUAL(fs.indicies[0], 7);
+  BOOST_CHECK_CLOSE(fs.values[0], 2.f, FLOAT_TOL);
+  for (size_t i = 0; i < hashes.size(); i++)
+  {
+    BOOST_CHECK_EQUAL(fs.indicies[i + 1], hashes[i]);
+    BOOST_CHECK_CLOSE(fs.values[i + 1], values[i], FLOAT_TOL);
+  }
+  BOOST_CHECK_CLOSE(fs.sum_feat_sq, 4.f + 0.25f + 2.25f + 9.f, FLOAT_TOL);
+
+  VW::finish_example(*all, *examples[0]);
+  examples.delete_v();
+  VW::finish(*all);
+}
+
+BOOST_AUTO_TEST_CASE(test_flatbuffer_object_larger_than_limit)
+{
+  auto all = VW::initialize("--no_stdin --quiet --flatbuffer --flatbuffer_limit 1", nullptr, false, nullptr, nullptr);
+
+  // A size prefix of 2MB, as found in corrupt input, must not be buffered.
+  std::vector<char> input(sizeof(flatbuffers::uoffset_t), 0);
+  flatbuffers::WriteScalar<flatbuffers::uoffset_t>(input.data(), 2 * 1024 * 1024);
+  all->example_parser->input->add_file(VW::io::create_buffer_view(input.data(), input.size()));
+
+  auto examples = v_init<example*>();
+  examples.push_back(&VW::get_unused_example(all));
+  BOOST_CHECK_THROW(all->flat_converter->parse_examples(all, examples), VW::vw_exception);
+
+  VW::finish_example(*all, *examples[0]);
+  examples.delete_v();
+  VW::finish(*all);
+}
@@ -0,0 +1,99 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ftrl_simd.h"
+#include "test_common.h"
+
+namespace
+{
+constexpr size_t STATE_SIZE = 8;  // the stride of --ftrl and --coin
+
+// The states of count weights, with the non-negative entries kept non-negative, and their feature values.
+struct weight_states
+{
+  weight_states(size_t count, std::mt19937& rng) : states(count * STATE_SIZE), x(count)
+  {
+    std::uniform_real_distribution<float> value(-1.f, 1.f);
+    for (auto& s : states) s = value(rng);
+    for (size_t i = 0; i < count; i++)
+    {
+      for (size_t slot : {2, 3, 5}) states[i * STATE_SIZE + slot] = std::fabs(states[i * STATE_SIZE + slot]);
+      // Some weights have not seen a feature or a gradient yet.
+      if (i % 7 == 3) states[i * STATE_SIZE + 3] = 0.f;
+      if (i % 11 == 5) states[i * STATE_SIZE + 5] = 0.f;
+    }
+    for (auto& v : x) v = 2.f * value(rng);
+  }
+
+  std::vector<float*> weights()
+  {
+    std::vector<float*> pointers;
+    for (size_t i = 0; i < x.size(); i++) pointers.push_back(&states[i * STATE_SIZE]);
+    return pointers;
+  }
+
+  std::vector<float> states;
+  std::vector<float> x;
+};
+
+using kernel = void (*)(float* const*, const float*, size_t, const VW::ftrl_parameters&);
+
+// Updating the weights at once finds what updating them one at a time does.
+void check_batched_update(kernel update, const VW::ftrl_parameters& p)
+{
+  std::mt19937 rng(17);
+  for (size_t count = 0; count <= 40; count++)
+  {
+    weight_states batched(count, rng);
+    weight_states one_at_a_time = batched;
+    update(batched.weights().data(), batched.x.data(), count, p);
+    auto weights = one_at_a_time.weights();
+    for (size_t i = 0; i < count; i++) update(&weights[i], &one_at_a_time.x[i], 1, p);
+    check_collections_with_float_tolerance(batched.states, one_at_a_time.states);
+  }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(ftrl_proximal_update_batched_matches_one_at_a_time)
+{
+  check_batched_update(VW::ftrl_proximal_update, {0.7f, 0.005f, 0.1f, 0.f, 0.01f});
+  check_batched_update(VW::ftrl_proximal_update, {-1.3f, 0.5f, 1.f, 0.2f, 0.f});
+}
+
+BOOST_AUTO_TEST_CASE(coin_betting_update_batched_matches_one_at_a_time)
+{
+  check_batched_update(VW::coin_betting_update, {0.7f, 4.f, 1.f, 0.f, 0.f});
+  check_batched_update(VW::coin_betting_update, {-0.3f, 4.f, 0.5f, 0.f, 0.f});
+}
+
+BOOST_AUTO_TEST_CASE(coin_betting_predict_batched_matches_one_at_a_time)
+{
+  const VW::ftrl_parameters p = {0.f, 4.f, 1.f, 0.f, 0.f};
+  std::mt19937 rng(17);
+  for (size_t count = 0; count <= 40; count++)
+  {
+    weight_states states(count, rng);
+    const std::vector<float> before = states.states;
+    auto weights = states.weights();
+
+    float predict = 0.f;
+    float norm = 0.f;
+    VW::coin_betting_predict(weights.data(), states.x.data(), count, p, predict, norm);
+    float expected_predict = 0.f;
+    float expected_norm = 0.f;
+    for (size_t i = 0; i < count; i++)
+      VW::coin_betting_predict(&weights[i], &states.x[i], 1, p, expected_predict, expected_norm);
+
+    BOOST_CHECK_SMALL(predict - expected_predict, FLOAT_TOL * (1.f + std::fabs(expected_predict)));
+    BOOST_CHECK_SMALL(norm - expected_norm, FLOAT_TOL * (1.f + expected_norm));
+    check_collections_with_float_tolerance(states.states, before);
+  }
+}
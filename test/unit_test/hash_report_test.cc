@@ -0,0 +1,36 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cmath>
+
+#include "hash_report.h"
+
+BOOST_AUTO_TEST_CASE(hyperloglog_estimates_distinct_hashes)
+{
+  VW::hyperloglog few;
+  BOOST_CHECK_EQUAL(few.estimate(), 0.);
+  for (uint64_t i = 0; i < 100; i++) few.add(VW::hyperloglog::mix(i % 10));
+  BOOST_CHECK_CLOSE(few.estimate(), 10., 5.);
+
+  VW::hyperloglog first;
+  VW::hyperloglog second;
+  for (uint64_t i = 0; i < 1000000; i++) (i < 600000 ? first : second).add(VW::hyperloglog::mix(i));
+  BOOST_CHECK_CLOSE(first.estimate(), 600000., 5.);
+  first.merge(second);
+  BOOST_CHECK_CLOSE(first.estimate(), 1000000., 5.);
+}
+
+BOOST_AUTO_TEST_CASE(expected_collision_rate_of_uniform_hashes)
+{
+  BOOST_CHECK_EQUAL(VW::expected_collision_rate(1., 18), 0.);
+  // two features share one of two weights half of the time
+  BOOST_CHECK_CLOSE(VW::expected_collision_rate(2., 1), 0.5, 1e-6);
+  // as many features as weights, each other feature misses a weight with probability 1 - 1 / 2^18
+  const double weights = 1 << 18;
+  BOOST_CHECK_CLOSE(VW::expected_collision_rate(weights, 18), 1. - std::pow(1. - 1. / weights, weights - 1.), 1e-6);
+  BOOST_CHECK_LT(VW::expected_collision_rate(1000., 24), 0.0001);
+}
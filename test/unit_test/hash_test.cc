@@ -0,0 +1,64 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <string>
+
+#include "hashstring.h"
+#include "parse_primitives.h"
+#include "vw.h"
+#include "xxh3.h"
+
+BOOST_AUTO_TEST_CASE(xxh3_hash_matches_xxhash)
+{
+  // XXH3_64bits_withSeed of xxHash 0.8 of the first len characters of "abc...zabc..." at the seeds 0 and 0x1234567
+  struct reference
+  {
+    size_t len;
+    uint64_t unseeded;
+    uint64_t seeded;
+  };
+  const reference references[] = {{0, 0x2d06800538d394c2ULL, 0xe6379fb5299efaa9ULL},
+      {3, 0x78af5f94892f3950ULL, 0x05e70d55b22b7249ULL}, {8, 0x6f45a76842a96483ULL, 0xd4081e49b40d3893ULL},
+      {16, 0x3d3ccac9af14d8a8ULL, 0xc110618ed6958df0ULL}, {100, 0x7f2b83f8e57a6e24ULL, 0xc533b8f9d38a935eULL},
+      {200, 0xe12dae8ffe57bbc9ULL, 0x34b08a0ad5b950e0ULL}, {300, 0x7f720c1f731c9648ULL, 0x6461e4cb0aac91e8ULL}};
+
+  std::string input;
+  for (int i = 0; i < 300; i++) input += static_cast<char>('a' + i % 26);
+  for (const auto& r : references)
+  {
+    BOOST_CHECK_EQUAL(xxh3_hash(input.data(), r.len, 0), r.unseeded);
+    BOOST_CHECK_EQUAL(xxh3_hash(input.data(), r.len, 0x1234567), r.seeded);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(hashers_of_hash_function)
+{
+  BOOST_CHECK(getHasher("strings") == hashstring);
+  BOOST_CHECK(getHasher("all", "murmur3") == hashall);
+  BOOST_CHECK(getHasher("strings", "xxh3") == hashstring_xxh3);
+  BOOST_CHECK(getHasher("all", "xxh3") == hashall_xxh3);
+  BOOST_CHECK_THROW(getHasher("strings", "md5"), VW::vw_exception);
+
+  // numbers are their own hash with either function, names are hashed to 32 bits
+  BOOST_CHECK_EQUAL(hashstring_xxh3(" 12 ", 4, 100), 112);
+  BOOST_CHECK_EQUAL(hashstring_xxh3("price", 5, 7), xxh3_hash("price", 5, 7) & 0xFFFFFFFF);
+  BOOST_CHECK_EQUAL(hashall_xxh3("12", 2, 7), xxh3_hash("12", 2, 7) & 0xFFFFFFFF);
+}
+
+BOOST_AUTO_TEST_CASE(hash_function_of_the_model_hashes_the_features)
+{
+  auto* murmur3 = VW::initialize("--quiet");
+  auto* xxh3 = VW::initialize("--quiet --hash_function xxh3");
+
+  BOOST_CHECK_EQUAL(VW::hash_space(*murmur3, "a"), hashstring("a", 1, 0));
+  BOOST_CHECK_EQUAL(VW::hash_space(*xxh3, "a"), hashstring_xxh3("a", 1, 0));
+  const uint64_t ns = VW::hash_space(*xxh3, "a");
+  BOOST_CHECK_EQUAL(VW::hash_feature(*xxh3, "price", ns), hashstring_xxh3("price", 5, ns) & xxh3->parse_mask);
+
+  VW::finish(*murmur3);
+  VW::finish(*xxh3);
+}
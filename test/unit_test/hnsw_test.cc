@@ -0,0 +1,128 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "hnsw.h"
+#include "io_buf.h"
+#include "io/io_adapter.h"
+#include "rand48.h"
+#include "vw_exception.h"
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+const size_t dim = 8;
+
+std::vector<float> random_vectors(size_t count, uint64_t seed)
+{
+  std::vector<float> vectors(count * dim);
+  for (auto& x : vectors) x = merand48(seed) - 0.5f;
+  return vectors;
+}
+
+// The ids of the k vectors with the largest inner products with query.
+std::vector<uint32_t> exact_search(const std::vector<float>& vectors, const float* query, size_t k)
+{
+  std::vector<float> scores(vectors.size() / dim);
+  for (size_t i = 0; i < scores.size(); i++)
+    scores[i] = std::inner_product(query, query + dim, vectors.data() + i * dim, 0.f);
+  std::vector<uint32_t> ids(scores.size());
+  std::iota(ids.begin(), ids.end(), 0);
+  std::partial_sort(
+      ids.begin(), ids.begin() + k, ids.end(), [&scores](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+  ids.resize(k);
+  return ids;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(hnsw_search_finds_the_largest_inner_products)
+{
+  const auto vectors = random_vectors(2000, 1);
+  VW::hnsw_index index(dim);
+  for (size_t i = 0; i < vectors.size() / dim; i++) BOOST_CHECK_EQUAL(index.add(vectors.data() + i * dim), i);
+  BOOST_CHECK_EQUAL(index.size(), 2000);
+
+  const size_t k = 10;
+  const auto queries = random_vectors(50, 2);
+  size_t found = 0;
+  std::vector<uint32_t> ids;
+  for (size_t q = 0; q < queries.size() / dim; q++)
+  {
+    const float* query = queries.data() + q * dim;
+    index.search(query, k, 64, ids);
+    BOOST_CHECK_EQUAL(ids.size(), k);
+    auto expected = exact_search(vectors, query, k);
+    std::sort(expected.begin(), expected.end());
+    for (uint32_t id : ids) found += std::binary_search(expected.begin(), expected.end(), id) ? 1 : 0;
+  }
+  BOOST_CHECK_GE(found, 0.9 * k * queries.size() / dim);
+}
+
+BOOST_AUTO_TEST_CASE(hnsw_update_moves_a_vector)
+{
+  const auto vectors = random_vectors(200, 3);
+  VW::hnsw_index index(dim);
+  for (size_t i = 0; i < vectors.size() / dim; i++) index.add(vectors.data() + i * dim);
+
+  std::vector<float> query(dim, 1.f);
+  std::vector<float> best(dim, 10.f);
+  index.update(17, best.data());
+  std::vector<uint32_t> ids;
+  index.search(query.data(), 1, 32, ids);
+  BOOST_CHECK_EQUAL(ids.size(), 1);
+  BOOST_CHECK_EQUAL(ids[0], 17);
+}
+
+BOOST_AUTO_TEST_CASE(hnsw_save_load_round_trips_the_index)
+{
+  const auto vectors = random_vectors(500, 4);
+  VW::hnsw_index index(dim, 8, 32, 5);
+  for (size_t i = 0; i < vectors.size() / dim; i++) index.add(vectors.data() + i * dim);
+
+  auto buffer = std::make_shared<std::vector<char>>();
+  io_buf output;
+  output.add_file(VW::io::create_vector_writer(buffer));
+  index.save_load(output, false, false);
+  output.flush();
+
+  io_buf input;
+  input.add_file(VW::io::create_buffer_view(buffer->data(), buffer->size()));
+  VW::hnsw_index loaded(dim);
+  loaded.save_load(input, true, false);
+  BOOST_CHECK_EQUAL(loaded.size(), index.size());
+
+  const auto queries = random_vectors(20, 6);
+  std::vector<uint32_t> expected;
+  std::vector<uint32_t> ids;
+  for (size_t q = 0; q < queries.size() / dim; q++)
+  {
+    index.search(queries.data() + q * dim, 5, 16, expected);
+    loaded.search(queries.data() + q * dim, 5, 16, ids);
+    BOOST_CHECK_EQUAL_COLLECTIONS(ids.begin(), ids.end(), expected.begin(), expected.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(hnsw_save_load_rejects_other_dimensions)
+{
+  const auto vectors = random_vectors(10, 7);
+  VW::hnsw_index index(dim);
+  for (size_t i = 0; i < vectors.size() / dim; i++) index.add(vectors.data() + i * dim);
+
+  auto buffer = std::make_shared<std::vector<char>>();
+  io_buf output;
+  output.add_file(VW::io::create_vector_writer(buffer));
+  index.save_load(output, false, false);
+  output.flush();
+
+  io_buf input;
+  input.add_file(VW::io::create_buffer_view(buffer->data(), buffer->size()));
+  VW::hnsw_index loaded(dim + 1);
+  BOOST_CHECK_THROW(loaded.save_load(input, true, false), VW::vw_exception);
+}
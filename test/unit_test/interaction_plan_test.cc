@@ -0,0 +1,48 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <vector>
+
+#include "example_predict.h"
+#include "interaction_plan.h"
+
+using interaction_list = std::vector<std::vector<namespace_index>>;
+
+BOOST_AUTO_TEST_CASE(interaction_plan_visits_interactions_of_nonempty_namespaces)
+{
+  const interaction_list interactions = {{'a', 'b'}, {'a', 'c'}, {'b', 'c'}, {'a', 'a', 'b'}, {'c', 'c'}};
+  INTERACTIONS::interaction_plan plan(interactions);
+
+  example_predict ec;
+  ec.feature_space['a'].push_back(1.f, 1);
+  ec.feature_space['b'].push_back(1.f, 2);
+  ec.feature_space['c'];  // allocated, but without features
+
+  const interaction_list expected = {{'a', 'b'}, {'a', 'a', 'b'}};
+  BOOST_CHECK(plan.active(interactions, ec) == expected);
+  BOOST_CHECK(&plan.active(interactions, ec) == &plan.active(interactions, ec));
+  BOOST_CHECK_EQUAL(plan.planned_sets(), 1);
+
+  ec.feature_space['c'].push_back(1.f, 3);
+  BOOST_CHECK(plan.active(interactions, ec) == interactions);
+  BOOST_CHECK_EQUAL(plan.planned_sets(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(interaction_plan_returns_other_lists_whole)
+{
+  interaction_list interactions = {{'a', 'b'}, {'c', 'd'}};
+  INTERACTIONS::interaction_plan plan(interactions);
+  example_predict ec;
+  ec.feature_space['a'].push_back(1.f, 1);
+  ec.feature_space['b'].push_back(1.f, 2);
+
+  const interaction_list other = interactions;
+  BOOST_CHECK_EQUAL(&plan.active(other, ec), &other);
+  interactions.push_back({'a', 'a'});
+  BOOST_CHECK_EQUAL(&plan.active(interactions, ec), &interactions);
+  BOOST_CHECK_EQUAL(plan.planned_sets(), 0);
+}
@@ -7,8 +7,12 @@
 
 #include <memory>
 #include <array>
+#include <cstdio>
+#include <string>
 
 #include "io/io_adapter.h"
+#include "io_buf.h"
+#include "vw_exception.h"
 
 BOOST_AUTO_TEST_CASE(io_adapter_vector_writer)
 {
@@ -58,3 +62,139 @@ BOOST_AUTO_TEST_CASE(io_adapter_buffer_view)
     BOOST_CHECK_EQUAL(std::strncmp(read_buffer3, "test another", 13), 0);
   }
 }
+
+BOOST_AUTO_TEST_CASE(io_adapter_mapped_file_reader)
+{
+  const std::string file_name = "io_adapter_mapped_file_reader.txt";
+  {
+    auto writer = VW::io::open_file_writer(file_name);
+    writer->write("line one\nline two\npartial", 25);
+  }
+
+  {
+    io_buf buffer;
+    buffer.add_file(VW::io::open_mapped_file_reader(file_name));
+    // The unterminated last line of the mapped file continues into the next file just as when reading.
+    const std::string next = " line\nlast\n";
+    buffer.add_file(VW::io::create_buffer_view(next.data(), next.size()));
+
+    char* line;
+    BOOST_CHECK_EQUAL(buffer.readto(line, '\n'), 9);
+    BOOST_CHECK_EQUAL(std::string(line, 9), "line one\n");
+    BOOST_CHECK_EQUAL(buffer.readto(line, '\n'), 9);
+    BOOST_CHECK_EQUAL(std::string(line, 9), "line two\n");
+    BOOST_CHECK_EQUAL(buffer.readto(line, '\n'), 13);
+    BOOST_CHECK_EQUAL(std::string(line, 13), "partial line\n");
+    BOOST_CHECK_EQUAL(buffer.readto(line, '\n'), 5);
+    BOOST_CHECK_EQUAL(std::string(line, 5), "last\n");
+    BOOST_CHECK_EQUAL(buffer.readto(line, '\n'), 0);
+
+    buffer.current = 0;
+    buffer.reset_file(buffer.input_files[0].get());
+    BOOST_CHECK_EQUAL(buffer.buf_read(line, 4), 4);
+    BOOST_CHECK_EQUAL(std::string(line, 4), "line");
+  }
+
+  std::remove(file_name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(io_adapter_read_ahead_reader)
+{
+  const std::string contents = "read ahead of the consumer";
+  // Buffers smaller than the contents make the I/O thread wait for the consumer.
+  auto reader = VW::io::create_read_ahead_reader(VW::io::create_buffer_view(contents.data(), contents.size()), 2, 4);
+  BOOST_CHECK_EQUAL(reader->is_resettable(), true);
+
+  for (int pass = 0; pass < 2; pass++)
+  {
+    std::string result;
+    char read_buffer[3];
+    ssize_t num_read;
+    while ((num_read = reader->read(read_buffer, sizeof(read_buffer))) > 0) { result.append(read_buffer, num_read); }
+    BOOST_CHECK_EQUAL(result, contents);
+    reader->reset();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(io_adapter_parallel_compressed_round_trip)
+{
+  const std::string file_name = "io_adapter_parallel_compressed_round_trip.gz";
+  // Large enough to span several blocks.
+  std::string contents;
+  for (int i = 0; contents.size() < 300000; i++) { contents += "line " + std::to_string(i * 7919 % 1000) + "\n"; }
+
+  {
+    auto writer = VW::io::open_parallel_compressed_file_writer(file_name, 3);
+    writer->write(contents.data(), 1000);
+    writer->flush();
+    writer->write(contents.data() + 1000, contents.size() - 1000);
+  }
+
+  // The regular gzip reader understands the block compressed output.
+  {
+    auto reader = VW::io::open_compressed_file_reader(file_name);
+    std::string result;
+    char read_buffer[4096];
+    ssize_t num_read;
+    while ((num_read = reader->read(read_buffer, sizeof(read_buffer))) > 0) { result.append(read_buffer, num_read); }
+    BOOST_CHECK_EQUAL(result, contents);
+  }
+
+  auto reader = VW::io::open_parallel_compressed_file_reader(file_name, 3);
+  for (int pass = 0; pass < 2; pass++)
+  {
+    std::string result;
+    char read_buffer[4096];
+    ssize_t num_read;
+    while ((num_read = reader->read(read_buffer, sizeof(read_buffer))) > 0) { result.append(read_buffer, num_read); }
+    BOOST_CHECK_EQUAL(result, contents);
+    reader->reset();
+  }
+
+  std::remove(file_name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(io_adapter_compression_format_round_trip)
+{
+  const std::string file_name = "io_adapter_compression_format_round_trip.bin";
+  std::string contents;
+  for (int i = 0; contents.size() < 300000; i++) { contents += "line " + std::to_string(i * 7919 % 1000) + "\n"; }
+
+  BOOST_CHECK_THROW(VW::io::parse_compression_format("brotli"), VW::vw_exception);
+  BOOST_CHECK(VW::io::detect_compression_format("does_not_exist.bin") == VW::io::compression_format::none);
+
+  for (const auto* name : {"none", "gzip", "zstd", "lz4"})
+  {
+    // zstd and lz4 are optional dependencies, formats which were not built in cannot be selected.
+    VW::io::compression_format format;
+    try
+    {
+      format = VW::io::parse_compression_format(name);
+    }
+    catch (const VW::vw_exception&)
+    {
+      continue;
+    }
+
+    {
+      auto writer = VW::io::open_compressed_file_writer(file_name, format);
+      writer->write(contents.data(), 1000);
+      writer->flush();
+      writer->write(contents.data() + 1000, contents.size() - 1000);
+    }
+    BOOST_CHECK(VW::io::detect_compression_format(file_name) == format);
+
+    auto reader = VW::io::open_compressed_file_reader(file_name, format);
+    for (int pass = 0; pass < 2; pass++)
+    {
+      std::string result;
+      char read_buffer[4096];
+      ssize_t num_read;
+      while ((num_read = reader->read(read_buffer, sizeof(read_buffer))) > 0) { result.append(read_buffer, num_read); }
+      BOOST_CHECK_EQUAL(result, contents);
+      reader->reset();
+    }
+  }
+
+  std::remove(file_name.c_str());
+}
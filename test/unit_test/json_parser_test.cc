@@ -404,3 +404,68 @@ BOOST_AUTO_TEST_CASE(parse_json_text_does_not_change_input)
   VW::finish_example(*ccb_vw, vec);
   VW::finish(*ccb_vw);
 }
+
+BOOST_AUTO_TEST_CASE(parse_json_reuses_parser_after_error)
+{
+  std::string json_text = R"({"_label": 1, "a": {"x": 1, "y": "z", "w": true}, "b": {"x": 2.5}})";
+
+  auto* reference_vw = VW::initialize("--json --no_stdin --quiet", nullptr, false, nullptr, nullptr);
+  auto* vw = VW::initialize("--json --no_stdin --quiet", nullptr, false, nullptr, nullptr);
+
+  // A line which fails in the middle of a namespace must not leave anything behind for the next one.
+  v_array<example*> bad_examples = v_init<example*>();
+  bad_examples.push_back(&VW::get_unused_example(vw));
+  std::string bad_text = R"({"_label": 1, "a": {"x": 1, "_labelIndex": "oops"}})";
+  BOOST_CHECK_THROW(VW::read_line_json<true>(*vw, bad_examples, &bad_text[0],
+                        reinterpret_cast<VW::example_factory_t>(&VW::get_unused_example), vw),
+      VW::vw_exception);
+  multi_ex bad_vec(bad_examples.begin(), bad_examples.end());
+  bad_examples.delete_v();
+  VW::finish_example(*vw, bad_vec);
+
+  for (int i = 0; i < 2; i++)
+  {
+    // Parsing is destructive, so every parse gets its own copy.
+    auto expected = parse_json(*reference_vw, std::string(json_text));
+    auto actual = parse_json(*vw, std::string(json_text));
+    BOOST_REQUIRE_EQUAL(expected.size(), 1);
+    BOOST_REQUIRE_EQUAL(actual.size(), 1);
+    BOOST_CHECK_CLOSE(actual[0]->l.simple.label, 1.f, FLOAT_TOL);
+    BOOST_REQUIRE_EQUAL(expected[0]->indices.size(), actual[0]->indices.size());
+    for (size_t j = 0; j < expected[0]->indices.size(); j++)
+    {
+      auto ns = expected[0]->indices[j];
+      BOOST_CHECK_EQUAL(ns, actual[0]->indices[j]);
+      const auto& expected_fs = expected[0]->feature_space[ns];
+      const auto& actual_fs = actual[0]->feature_space[ns];
+      BOOST_REQUIRE_EQUAL(expected_fs.size(), actual_fs.size());
+      for (size_t k = 0; k < expected_fs.size(); k++)
+      {
+        BOOST_CHECK_EQUAL(expected_fs.indicies[k], actual_fs.indicies[k]);
+        BOOST_CHECK_CLOSE(expected_fs.values[k], actual_fs.values[k], FLOAT_TOL);
+      }
+    }
+    VW::finish_example(*reference_vw, expected);
+    VW::finish_example(*vw, actual);
+  }
+
+  VW::finish(*reference_vw);
+  VW::finish(*vw);
+}
+
+BOOST_AUTO_TEST_CASE(parse_json_skips_ignored_namespaces)
+{
+  auto* vw = VW::initialize("--json --no_stdin --quiet --ignore a", nullptr, false, nullptr, nullptr);
+
+  // ac holds a namespace of its own, so it is parsed and its features of a are left to setup_example.
+  auto examples = parse_json(*vw,
+      R"({"_label": 1, "a": {"x": 1, "y": "z"}, "ab": [1, 2], "b": {"x": 2.5}, "ac": {"n": {"y": 1}, "z": 1}})");
+
+  BOOST_REQUIRE_EQUAL(examples.size(), 1);
+  BOOST_CHECK_CLOSE(examples[0]->l.simple.label, 1.f, FLOAT_TOL);
+  BOOST_CHECK_EQUAL(examples[0]->feature_space['a'].size(), 1);
+  BOOST_CHECK_EQUAL(examples[0]->feature_space['b'].size(), 1);
+  BOOST_CHECK_EQUAL(examples[0]->feature_space['n'].size(), 1);
+  VW::finish_example(*vw, examples);
+  VW::finish(*vw);
+}
@@ -0,0 +1,63 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "lda_simd.h"
+#include "test_common.h"
+
+namespace
+{
+constexpr float THRESHOLD = 1e-6f;
+// The vectors approximate the logarithm and the digamma a little differently than the scalar approximations.
+constexpr float APPROX_TOL = 0.01f;
+
+// Every count of topics, starting from every alignment, agrees with the fast approximations.
+template <typename transform, typename reference>
+void check_against_fast_approx(transform simd, reference scalar)
+{
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<float> value(0.01f, 30.f);
+  for (size_t count = 0; count <= 40; count++)
+    for (size_t offset = 0; offset < 4; offset++)
+    {
+      std::vector<float> gamma(offset + count);
+      std::vector<float> norm(offset + count);
+      for (auto& g : gamma) g = value(rng);
+      for (auto& n : norm) n = 0.1f * value(rng);
+      std::vector<float> expected(gamma.begin() + offset, gamma.end());
+      scalar(expected, std::vector<float>(norm.begin() + offset, norm.end()));
+
+      simd(gamma.data() + offset, norm.data() + offset, count);
+      check_collections_with_float_tolerance(
+          std::vector<float>(gamma.begin() + offset, gamma.end()), expected, APPROX_TOL);
+    }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(lda_expdigammify_matches_fast_approx)
+{
+  check_against_fast_approx(
+      [](float* gamma, const float*, size_t count) { VW::lda_expdigammify(gamma, count, THRESHOLD); },
+      [](std::vector<float>& gamma, const std::vector<float>&) {
+        const float sum = ldamath::fastdigamma(std::accumulate(gamma.begin(), gamma.end(), 0.f));
+        for (auto& g : gamma) g = std::fmax(THRESHOLD, ldamath::fastexp(ldamath::fastdigamma(g) - sum));
+      });
+}
+
+BOOST_AUTO_TEST_CASE(lda_expdigammify_2_matches_fast_approx)
+{
+  check_against_fast_approx(
+      [](float* gamma, const float* norm, size_t count) { VW::lda_expdigammify_2(gamma, norm, count, THRESHOLD); },
+      [](std::vector<float>& gamma, const std::vector<float>& norm) {
+        for (size_t i = 0; i < gamma.size(); i++)
+          gamma[i] = std::fmax(THRESHOLD, ldamath::fastexp(ldamath::fastdigamma(gamma[i]) - norm[i]));
+      });
+}
@@ -0,0 +1,87 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "merge_models.h"
+#include "vw.h"
+#include "vw_exception.h"
+
+namespace
+{
+void train_model(const std::string& options, const std::string& file, const std::vector<std::string>& examples)
+{
+  auto* all = VW::initialize(options + " --quiet -f " + file);
+  for (const auto& line : examples)
+  {
+    auto* ec = VW::read_example(*all, line);
+    all->learn(*ec);
+    VW::finish_example(*all, *ec);
+  }
+  VW::finish(*all);
+}
+
+float weight_of(vw& all, const std::string& feature, uint32_t offset)
+{
+  const auto index = VW::hash_feature(all, feature, VW::hash_space(all, " "));
+  return VW::get_weight(all, (uint32_t)index, offset);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(merge_models_averages_models_equally_without_counts)
+{
+  train_model("--sgd --noconstant", "merge_equally_a.model", {"1 | x:1", "1 | x:1"});
+  train_model("--sgd --noconstant", "merge_equally_b.model", {"0.5 | x:1 y:1"});
+  auto* a = VW::initialize("--quiet -i merge_equally_a.model");
+  auto* b = VW::initialize("--quiet -i merge_equally_b.model");
+
+  auto* merged = VW::merge_models({"merge_equally_a.model", "merge_equally_b.model"}, 2);
+  for (const std::string feature : {"x", "y"})
+    BOOST_CHECK_CLOSE(
+        weight_of(*merged, feature, 0), (weight_of(*a, feature, 0) + weight_of(*b, feature, 0)) / 2.f, 1e-4);
+  BOOST_CHECK(!merged->save_resume);
+
+  VW::finish(*merged);
+  VW::finish(*a);
+  VW::finish(*b);
+  std::remove("merge_equally_a.model");
+  std::remove("merge_equally_b.model");
+}
+
+BOOST_AUTO_TEST_CASE(merge_models_weights_resumable_models_by_their_gradients)
+{
+  train_model("--save_resume", "merge_resume_a.model", {"1 | x:1"});
+  train_model("--save_resume", "merge_resume_b.model", {"0 | x:2", "0 | x:2", "0 | x:2"});
+  auto* a = VW::initialize("--quiet --preserve_performance_counters -i merge_resume_a.model");
+  auto* b = VW::initialize("--quiet --preserve_performance_counters -i merge_resume_b.model");
+
+  auto* merged = VW::merge_models({"merge_resume_a.model", "merge_resume_b.model"});
+  const float ga = weight_of(*a, "x", 1);
+  const float gb = weight_of(*b, "x", 1);
+  BOOST_CHECK_CLOSE(weight_of(*merged, "x", 1), ga + gb, 1e-4);
+  BOOST_CHECK_CLOSE(
+      weight_of(*merged, "x", 0), (ga * weight_of(*a, "x", 0) + gb * weight_of(*b, "x", 0)) / (ga + gb), 1e-3);
+  BOOST_CHECK_EQUAL(merged->sd->weighted_labeled_examples, 4.);
+  BOOST_CHECK(merged->save_resume);
+
+  VW::finish(*merged);
+  VW::finish(*a);
+  VW::finish(*b);
+  std::remove("merge_resume_a.model");
+  std::remove("merge_resume_b.model");
+}
+
+BOOST_AUTO_TEST_CASE(merge_models_rejects_models_with_other_options)
+{
+  train_model("-b 18", "merge_bits_18.model", {"1 | x:1"});
+  train_model("-b 20", "merge_bits_20.model", {"1 | x:1"});
+  BOOST_CHECK_THROW(VW::merge_models({"merge_bits_18.model", "merge_bits_20.model"}), VW::vw_exception);
+  std::remove("merge_bits_18.model");
+  std::remove("merge_bits_20.model");
+}
@@ -0,0 +1,45 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "vw.h"
+#include "vw_exception.h"
+
+BOOST_AUTO_TEST_CASE(model_host_routes_examples_by_key)
+{
+  VW::model_host host(2);
+  host.add_model("learns", "--quiet --sgd --noconstant --learning_rate 0.1");
+  host.add_model("predicts", "--quiet --sgd --noconstant --learning_rate 0.1");
+  BOOST_CHECK_EQUAL(host.size(), 2);
+
+  std::vector<VW::routed_example> batch(2);
+  for (auto& routed : batch)
+  {
+    routed.key = "learns";
+    routed.examples.push_back(host.read_example("1 | a:1"));
+  }
+  host.learn(batch);
+  for (auto& routed : batch) host.finish_example(routed.key, routed.examples);
+
+  auto* learnt = host.read_example("| a:1");
+  host.predict("learns", *learnt);
+  BOOST_CHECK_GT(learnt->pred.scalar, 0.f);
+  host.finish_example("learns", *learnt);
+
+  auto* untouched = host.read_example("| a:1");
+  host.predict("predicts", *untouched);
+  BOOST_CHECK_EQUAL(untouched->pred.scalar, 0.f);
+  host.finish_example("predicts", *untouched);
+}
+
+BOOST_AUTO_TEST_CASE(model_host_rejects_incompatible_models)
+{
+  VW::model_host host;
+  host.add_model("first", "--quiet -b 18");
+  BOOST_CHECK_THROW(host.add_model("first", "--quiet -b 18"), VW::vw_exception);
+  BOOST_CHECK_THROW(host.add_model("other_bits", "--quiet -b 20"), VW::vw_exception);
+  BOOST_CHECK_THROW(host.model("missing"), VW::vw_exception);
+}
@@ -0,0 +1,78 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "multi_policy_eval.h"
+#include "vw.h"
+#include "vw_exception.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+// An event of three actions where the logged one, chosen with probability 0.5, cost cost.
+multi_ex make_event(vw& parser, size_t logged, float cost)
+{
+  multi_ex event;
+  event.push_back(VW::read_example(parser, std::string("shared |s user")));
+  for (size_t action = 0; action < 3; action++)
+  {
+    const std::string label = action == logged ? "0:" + std::to_string(cost) + ":0.5 " : "";
+    event.push_back(VW::read_example(parser, label + "|a item" + std::to_string(action)));
+  }
+  return event;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(multi_policy_evaluator_estimates_each_candidate)
+{
+  auto& parser = *VW::initialize("--cb_explore_adf --quiet", nullptr, false, nullptr, nullptr);
+  auto& uniform = *VW::initialize("--cb_explore_adf --epsilon 1 --quiet", nullptr, false, nullptr, nullptr);
+  auto& greedy = *VW::initialize("--cb_explore_adf --epsilon 0 -q sa --quiet", nullptr, false, nullptr, nullptr);
+  VW::multi_policy_evaluator evaluator(parser, {&uniform, &greedy});
+
+  const float costs[] = {1.f, 0.f, 0.5f, 1.f};
+  float expected_ips = 0.f;
+  for (size_t i = 0; i < 4; i++)
+  {
+    multi_ex event = make_event(parser, i % 3, costs[i]);
+    evaluator.add(event);
+    expected_ips += costs[i] * (1.f / 3.f) / 0.5f;
+    // The label, and the interactions of the parser, are left as they were.
+    BOOST_CHECK_EQUAL(event[1 + i % 3]->l.cb.costs.size(), 1);
+    for (example* ec : event) BOOST_CHECK(ec->interactions == &parser.interactions);
+    parser.finish_example(event);
+  }
+  // An event without a logged action counts for none.
+  multi_ex unlabeled = make_event(parser, 3, 0.f);
+  evaluator.add(unlabeled);
+  parser.finish_example(unlabeled);
+
+  const auto estimates = evaluator.estimates(0);
+  BOOST_CHECK_EQUAL(estimates.events, 4);
+  BOOST_CHECK_CLOSE(estimates.ips, expected_ips / 4, 1e-3);
+  // Without a reward model the doubly robust estimates are the inverse propensity ones.
+  BOOST_CHECK_CLOSE(estimates.dr, estimates.ips, 1e-3);
+  BOOST_CHECK_GE(estimates.dro, 0.);
+  BOOST_CHECK_EQUAL(evaluator.estimates(1).events, 4);
+
+  VW::finish(greedy);
+  VW::finish(uniform);
+  VW::finish(parser);
+}
+
+BOOST_AUTO_TEST_CASE(multi_policy_evaluator_rejects_candidates_hashing_otherwise)
+{
+  auto& parser = *VW::initialize("--cb_explore_adf --quiet", nullptr, false, nullptr, nullptr);
+  auto& other_seed = *VW::initialize("--cb_explore_adf --hash_seed 5 --quiet", nullptr, false, nullptr, nullptr);
+  auto& single_line = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  BOOST_CHECK_THROW(VW::multi_policy_evaluator(parser, {&other_seed}), VW::vw_exception);
+  BOOST_CHECK_THROW(VW::multi_policy_evaluator(parser, {&single_line}), VW::vw_exception);
+  VW::finish(single_line);
+  VW::finish(other_seed);
+  VW::finish(parser);
+}
@@ -7,6 +7,7 @@
 
 #include "options.h"
 
+#include <set>
 #include <vector>
 #include <string>
 #include <memory>
@@ -149,6 +150,28 @@ BOOST_AUTO_TEST_CASE(name_extraction_multi_necessary)
   BOOST_REQUIRE_THROW(name_extractor.add_and_parse(ag), VW::vw_exception);
 }
 
+BOOST_AUTO_TEST_CASE(name_extraction_collects_option_names)
+{
+  char loc;
+  option_group_definition ag("g1");
+  ag(make_option("im_necessary", loc).necessary());
+  ag(make_option("opt2", loc).short_name("o"));
+
+  auto name_extractor = options_name_extractor();
+  name_extractor.add_parse_and_check_necessary(ag);
+
+  std::set<std::string> expected = {"im_necessary", "opt2", "o"};
+  BOOST_CHECK(name_extractor.option_names == expected);
+
+  name_extractor.option_names.clear();
+  option_group_definition ag2("g2");
+  ag2(make_option("other", loc).necessary());
+  name_extractor.add_parse_and_check_necessary(ag2);
+
+  expected = {"other"};
+  BOOST_CHECK(name_extractor.option_names == expected);
+}
+
 BOOST_AUTO_TEST_CASE(name_extraction_should_throw)
 {
   char loc;
@@ -0,0 +1,72 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "global_data.h"
+#include "io/io_adapter.h"
+#include "output_thread.h"
+
+namespace
+{
+std::string text_of(const std::shared_ptr<std::vector<char>>& buffer)
+{
+  return std::string(buffer->begin(), buffer->end());
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(output_thread_writes_in_order)
+{
+  auto buffer = std::make_shared<std::vector<char>>();
+  auto thread = std::make_shared<VW::output_thread>(2, print_result_by_ref, print_raw_text_by_ref);
+  auto sink = VW::output_thread::wrap(thread, VW::io::create_vector_writer(buffer));
+
+  v_array<char> tag = v_init<char>();
+  push_many(tag, "t", 1);
+  v_array<char> no_tag = v_init<char>();
+  for (int i = 0; i < 5; i++)
+  {
+    VW::print_result_on_output_thread(sink.get(), static_cast<float>(i), 0.f, tag);
+    sink->write(";", 1);
+    VW::print_text_on_output_thread(sink.get(), "x", no_tag);
+  }
+  sink->flush();
+  BOOST_CHECK_EQUAL(text_of(buffer), "0 t\n;x\n1 t\n;x\n2 t\n;x\n3 t\n;x\n4 t\n;x\n");
+  tag.delete_v();
+  no_tag.delete_v();
+}
+
+BOOST_AUTO_TEST_CASE(output_thread_binary_predictions_and_concurrent_writers)
+{
+  auto buffer = std::make_shared<std::vector<char>>();
+  {
+    auto thread = std::make_shared<VW::output_thread>(4, binary_print_result_by_ref, print_raw_text_by_ref);
+    auto sink = VW::output_thread::wrap(thread, VW::io::create_vector_writer(buffer));
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++)
+      writers.emplace_back([&sink] {
+        v_array<char> tag = v_init<char>();
+        for (int i = 0; i < 1000; i++) VW::print_result_on_output_thread(sink.get(), 1.5f, 2.f, tag);
+        tag.delete_v();
+      });
+    for (auto& w : writers) w.join();
+  }  // destroying the sink waits for the thread to write what was queued for it
+
+  BOOST_REQUIRE_EQUAL(buffer->size(), 4000 * 2 * sizeof(float));
+  auto reader = VW::io::create_buffer_view(buffer->data(), buffer->size());
+  for (int i = 0; i < 4000; i++)
+  {
+    float result;
+    float weight;
+    get_prediction(reader.get(), result, weight);
+    BOOST_CHECK_EQUAL(result, 1.5f);
+    BOOST_CHECK_EQUAL(weight, 2.f);
+  }
+}
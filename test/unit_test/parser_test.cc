@@ -5,7 +5,15 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_tools.hpp>
 
+#include "constant.h"
 #include "parse_args.h"
+#include "parse_primitives.h"
+#include "vw.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
 
 BOOST_AUTO_TEST_CASE(spoof_hex_encoded_namespace_test)
 {
@@ -15,3 +23,53 @@ BOOST_AUTO_TEST_CASE(spoof_hex_encoded_namespace_test)
   BOOST_CHECK_EQUAL(spoof_hex_encoded_namespaces("\\xab"), "\xab");
   BOOST_CHECK_EQUAL(spoof_hex_encoded_namespaces("\\x01 unrelated \\x56"), "\x01 unrelated \x56");
 }
+
+BOOST_AUTO_TEST_CASE(parse_float_short_decimals)
+{
+  const std::vector<std::pair<std::string, float>> cases = {{"4.36352", 4.36352f}, {"-0.25", -0.25f}, {"7", 7.f},
+      {".5", 0.5f}, {"1e-2", 0.01f}, {"123456789", 123456789.f}, {"0.5|", 0.5f}};
+  for (const auto& c : cases)
+  {
+    size_t end_idx = 0;
+    const float value = parseFloat(c.first.c_str(), end_idx, c.first.c_str() + c.first.size());
+    BOOST_CHECK_CLOSE(value, c.second, 1e-4);
+    BOOST_CHECK_EQUAL(end_idx, c.first.find('|') == std::string::npos ? c.first.size() : c.first.find('|'));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parse_text_example_longer_than_a_scan_block)
+{
+  auto& all = *VW::initialize("--quiet", nullptr, false, nullptr, nullptr);
+  std::string line = "1 |a";
+  for (int i = 1; i <= 50; i++) line += " feature" + std::to_string(i) + ":" + std::to_string(i);
+  line += " |bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb:2 x y\tz";
+
+  auto* ex = VW::read_example(all, line);
+  const auto& a = ex->feature_space['a'];
+  BOOST_REQUIRE_EQUAL(a.size(), 50);
+  for (size_t i = 0; i < a.size(); i++) BOOST_CHECK_EQUAL(a.values[i], static_cast<float>(i + 1));
+  const auto& b = ex->feature_space['b'];
+  BOOST_REQUIRE_EQUAL(b.size(), 3);
+  for (float v : b.values) BOOST_CHECK_EQUAL(v, 2.f);
+  VW::finish_example(all, *ex);
+  VW::finish(all);
+}
+
+BOOST_AUTO_TEST_CASE(parse_text_example_skips_ignored_namespaces)
+{
+  auto& all = *VW::initialize("--quiet --ignore a --spelling b --ignore b", nullptr, false, nullptr, nullptr);
+  BOOST_CHECK(all.parse_ignore['a']);
+  BOOST_CHECK(!all.parse_ignore['b']);
+
+  auto* ex = VW::read_example(all, "1 |a x y |b Word |ab w:3 |c:2 q |aa");
+  BOOST_CHECK_EQUAL(std::count(ex->indices.begin(), ex->indices.end(), 'a'), 0);
+  BOOST_CHECK_EQUAL(ex->feature_space['a'].size(), 0);
+  BOOST_CHECK_EQUAL(ex->feature_space['b'].size(), 0);
+  // The features of b are dropped after their spelling features are made of them.
+  BOOST_CHECK_EQUAL(ex->feature_space[spelling_namespace].size(), 1);
+  const auto& c = ex->feature_space['c'];
+  BOOST_REQUIRE_EQUAL(c.size(), 1);
+  BOOST_CHECK_EQUAL(c.values[0], 2.f);
+  VW::finish_example(all, *ex);
+  VW::finish(all);
+}
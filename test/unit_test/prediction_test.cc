@@ -5,6 +5,10 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_tools.hpp>
 
+#include "cpu_features.h"
+#include "gd.h"
+#include "interactions_simd.h"
+#include "prediction_cache.h"
 #include "vw.h"
 
 // Test case validating this issue: https://github.com/VowpalWabbit/vowpal_wabbit/issues/2166
@@ -44,3 +48,275 @@ BOOST_AUTO_TEST_CASE(predict_modifying_state)
 
   BOOST_CHECK_EQUAL(prediction_one, prediction_two);
 }
+
+BOOST_AUTO_TEST_CASE(interaction_dot_product_matches_scalar)
+{
+  const uint64_t mask = (1 << 12) - 1;
+  std::vector<float> weights(mask + 1);
+  for (size_t i = 0; i < weights.size(); i++) weights[i] = 0.001f * i - 1.f;
+
+  std::vector<float> values;
+  std::vector<uint64_t> indices;
+  // Long enough for the 16 and 8 wide loops and the features left after them.
+  for (size_t count = 0; count < 40; count++)
+  {
+    const float ft_value = 0.5f;
+    const uint64_t halfhash = 0x9e3779b97f4a7c15u * count;
+    const uint64_t offset = 3;
+    float expected = 0.f;
+    for (size_t i = 0; i < count; i++)
+      expected += weights[((indices[i] ^ halfhash) + offset) & mask] * (ft_value * values[i]);
+
+    const float sum = INTERACTIONS::interaction_dot_product(
+        values.data(), indices.data(), count, ft_value, halfhash, offset, weights.data(), mask);
+    BOOST_CHECK_SMALL(sum - expected, 1e-3f);
+
+    values.push_back(1.f + 0.25f * count);
+    indices.push_back(count * 0x5bd1e995u);
+  }
+}
+
+namespace
+{
+struct weighted_sum
+{
+  dense_parameters* weights;
+  float sum;
+};
+
+void add_weighted_feature(weighted_sum& dat, float x, uint64_t index) { dat.sum += (*dat.weights)[index] * x; }
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(inline_predict_of_many_linear_features_matches_the_feature_loop)
+{
+  auto& vw = *VW::initialize("--quiet --noconstant -b 10");
+  dense_parameters& weights = vw.weights.dense_weights;
+  for (uint64_t i = 0; i <= weights.mask(); i++) weights.first()[i] = 0.01f * (i % 97) - 0.4f;
+
+  // more features than SIMD_MIN_FEATURES in one namespace, fewer in the other
+  std::string line = "|a";
+  for (int i = 0; i < 21; i++) line += " f" + std::to_string(i) + ":" + std::to_string(0.5f + i);
+  line += " |b x:2 y:-1";
+  auto& ex = *VW::read_example(vw, line);
+
+  weighted_sum expected{&weights, 0.f};
+  for (features& fs : ex) GD::foreach_feature<weighted_sum, add_weighted_feature>(weights, fs, expected);
+  const float prediction = GD::inline_predict(weights, vw.ignore_some_linear, vw.ignore_linear,
+      vw.interactions, vw.permutations, ex);
+  BOOST_CHECK_SMALL(prediction - expected.sum, 1e-3f);
+  vw.finish_example(ex);
+  VW::finish(vw);
+}
+
+BOOST_AUTO_TEST_CASE(kernel_variants_name_every_set_of_kernels)
+{
+  const std::string variants = VW::kernel_variants();
+  for (const char* kernels : {"interactions:", "ffm:", "ftrl:", "lda:", "cache:"})
+    BOOST_CHECK(variants.find(kernels) != std::string::npos);
+  BOOST_CHECK(variants.find(INTERACTIONS::interaction_kernel_variant()) != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(fused_learn_matches_learn)
+{
+  std::vector<float> predictions[2];
+  const char* args[2] = {"--quiet -q ab --cubic abb", "--quiet -q ab --cubic abb --fused_learn"};
+  for (size_t run = 0; run < 2; run++)
+  {
+    auto& vw = *VW::initialize(args[run]);
+    for (size_t i = 0; i < 20; i++)
+    {
+      auto& ex = *VW::read_example(vw, std::to_string(i % 3) + std::string(" |a x:1 y:0.5 |b z:2 w:-1"));
+      vw.learn(ex);
+      predictions[run].push_back(ex.pred.scalar);
+      vw.finish_example(ex);
+    }
+    VW::finish(vw);
+  }
+  for (size_t i = 0; i < predictions[0].size(); i++) BOOST_CHECK_CLOSE(predictions[0][i], predictions[1][i], 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(fused_learn_matches_learn_with_offsets)
+{
+  std::vector<uint32_t> predictions[2];
+  const char* args[2] = {"--quiet --oaa 3 -q ab", "--quiet --oaa 3 -q ab --fused_learn"};
+  for (size_t run = 0; run < 2; run++)
+  {
+    auto& vw = *VW::initialize(args[run]);
+    for (size_t i = 0; i < 30; i++)
+    {
+      auto& ex = *VW::read_example(vw, std::to_string(i % 3 + 1) + " |a x" + std::to_string(i % 3) + " |b z w");
+      vw.learn(ex);
+      predictions[run].push_back(ex.pred.multiclass);
+      vw.finish_example(ex);
+    }
+    VW::finish(vw);
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(
+      predictions[0].begin(), predictions[0].end(), predictions[1].begin(), predictions[1].end());
+}
+
+BOOST_AUTO_TEST_CASE(multiupdate_matches_update)
+{
+  const uint32_t models[3] = {0, 2, 1};
+  const float labels[3] = {1.f, -1.f, 1.f};
+  std::vector<float> predictions[2];
+  for (size_t run = 0; run < 2; run++)
+  {
+    auto& vw = *VW::initialize("--quiet -q ab");
+    auto& base = *VW::LEARNER::as_singleline(vw.l);
+    for (size_t i = 0; i < 10; i++)
+    {
+      auto& ex = *VW::read_example(vw, std::string("1 |a x:1 y:0.5 |b z:2 w:-1"));
+      polyprediction pred[3];
+      for (size_t c = 0; c < 3; c++)
+      {
+        base.predict(ex, models[c]);
+        pred[c].scalar = ex.pred.scalar;
+      }
+      if (run == 0)
+        for (size_t c = 0; c < 3; c++)
+        {
+          ex.l.simple.label = labels[c];
+          ex.pred.scalar = pred[c].scalar;
+          base.update(ex, models[c]);
+        }
+      else
+        base.multiupdate(ex, 3, models, labels, pred);
+      for (size_t c = 0; c < 3; c++) predictions[run].push_back(pred[c].scalar);
+      vw.finish_example(ex);
+    }
+    VW::finish(vw);
+  }
+  for (size_t i = 0; i < predictions[0].size(); i++) BOOST_CHECK_CLOSE(predictions[0][i], predictions[1][i], 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(lazy_regularization_matches_l2)
+{
+  std::vector<float> predictions[2];
+  const char* args[2] = {"--quiet --l2 0.01 -q ab", "--quiet --l2 0.01 -q ab --lazy_regularization"};
+  for (size_t run = 0; run < 2; run++)
+  {
+    auto& vw = *VW::initialize(args[run]);
+    for (size_t i = 0; i < 20; i++)
+    {
+      auto& ex = *VW::read_example(vw, std::to_string(i % 3) + " |a x" + std::to_string(i % 4) + ":1 y:0.5 |b z:2");
+      vw.learn(ex);
+      predictions[run].push_back(ex.pred.scalar);
+      vw.finish_example(ex);
+    }
+    VW::finish(vw);
+  }
+  for (size_t i = 0; i < predictions[0].size(); i++) BOOST_CHECK_CLOSE(predictions[0][i], predictions[1][i], 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(minibatch_sgd_predicts_from_the_weights_before_the_minibatch)
+{
+  auto& vw = *VW::initialize("--quiet --minibatch_sgd 4");
+  std::vector<float> predictions;
+  for (size_t i = 0; i < 8; i++)
+  {
+    auto& ex = *VW::read_example(vw, "1 |a x:1 y:0.5");
+    vw.learn(ex);
+    predictions.push_back(ex.pred.scalar);
+    vw.finish_example(ex);
+  }
+  VW::finish(vw);
+  for (size_t i = 1; i < 4; i++)
+  {
+    BOOST_CHECK_EQUAL(predictions[i], predictions[0]);
+    BOOST_CHECK_EQUAL(predictions[4 + i], predictions[4]);
+  }
+  BOOST_CHECK_GT(predictions[4], predictions[0]);
+}
+
+BOOST_AUTO_TEST_CASE(factor_shared_features_matches_merged_features)
+{
+  std::vector<float> scores[2];
+  for (int run = 0; run < 2; run++)
+  {
+    auto& vw = *VW::initialize(std::string("--quiet --cb_adf -q sa") + (run == 1 ? " --factor_shared_features" : ""));
+    for (size_t i = 0; i < 30; i++)
+    {
+      // The shared example and the actions both have features in namespace a.
+      multi_ex examples;
+      examples.push_back(VW::read_example(vw, "shared |s u" + std::to_string(i % 3) + " v:0.5 |a w"));
+      for (size_t action = 0; action < 3; action++)
+      {
+        const std::string label = action == i % 3 ? "0:" + std::to_string(action % 2) + ":0.5 " : "";
+        examples.push_back(VW::read_example(vw, label + "|a x" + std::to_string(action) + ":2 y"));
+      }
+      vw.learn(examples);
+      for (const auto& a_s : examples[0]->pred.a_s) scores[run].push_back(a_s.score);
+      vw.finish_example(examples);
+    }
+    VW::finish(vw);
+  }
+  BOOST_REQUIRE_EQUAL(scores[0].size(), scores[1].size());
+  for (size_t i = 0; i < scores[0].size(); i++) BOOST_CHECK_CLOSE(scores[0][i], scores[1][i], 1e-3f);
+}
+BOOST_AUTO_TEST_CASE(predict_cache_returns_the_predictions_of_the_current_model)
+{
+  auto& vw = *VW::initialize("--quiet -t --noconstant --min_prediction -10 --max_prediction 10 --predict_cache 2");
+  BOOST_REQUIRE(vw.prediction_cache != nullptr);
+  const auto predict = [&vw](const std::string& line) {
+    auto& ex = *VW::read_example(vw, line);
+    vw.predict(ex);
+    const float prediction = ex.pred.scalar;
+    vw.finish_example(ex);
+    return prediction;
+  };
+
+  vw.weights.dense_weights[VW::hash_feature(vw, "a", VW::hash_space(vw, "")) << vw.weights.stride_shift()] = 1.f;
+  BOOST_CHECK_EQUAL(predict("| a:2"), 2.f);
+  BOOST_CHECK_EQUAL(predict("1 | a:2"), 2.f);
+  BOOST_CHECK_EQUAL(predict("| a:3"), 3.f);
+  BOOST_CHECK_EQUAL(vw.prediction_cache->hits(), 1);
+  BOOST_CHECK_EQUAL(vw.prediction_cache->misses(), 2);
+
+  // the least recently used of the two is evicted by a third example
+  predict("| b");
+  predict("| a:3");
+  predict("| a:2");
+  BOOST_CHECK_EQUAL(vw.prediction_cache->hits(), 2);
+
+  // a new model drops the cached predictions
+  vw.weights.dense_weights[VW::hash_feature(vw, "a", VW::hash_space(vw, "")) << vw.weights.stride_shift()] = 2.f;
+  ++vw.model_version;
+  BOOST_CHECK_EQUAL(predict("| a:2"), 4.f);
+  BOOST_CHECK_EQUAL(vw.prediction_cache->hits(), 2);
+  VW::finish(vw);
+}
+
+BOOST_AUTO_TEST_CASE(predict_cache_needs_testing_single_line_examples)
+{
+  BOOST_CHECK_THROW(VW::initialize("--quiet --predict_cache 10"), VW::vw_exception);
+  BOOST_CHECK_THROW(VW::initialize("--quiet -t --predict_cache 10 --cb_explore_adf"), VW::vw_exception);
+}
+
+BOOST_AUTO_TEST_CASE(wap_ldf_learns_the_difference_of_a_pair)
+{
+  // The pair of actions is learnt as the features of the cheaper one less those of the other, labelled -1.
+  for (const std::string arg : {"", " --fused_learn"})
+  {
+    auto& ldf = *VW::initialize("--wap_ldf m --noconstant --quiet" + arg);
+    multi_ex examples;
+    examples.push_back(VW::read_example(ldf, std::string("1:0 |f a:2 c")));
+    examples.push_back(VW::read_example(ldf, std::string("2:1 |f b c:0.5")));
+    ldf.learn(examples);
+    ldf.finish_example(examples);
+
+    auto& difference = *VW::initialize("--noconstant --quiet" + arg);
+    auto& ec = *VW::read_example(difference, std::string("-1 |f a:2 c b:-1 c:-0.5"));
+    difference.learn(ec);
+    difference.finish_example(ec);
+
+    const uint64_t ns = VW::hash_space(ldf, "f");
+    for (const std::string feature : {"a", "b", "c"})
+    {
+      const auto index = static_cast<uint32_t>(VW::hash_feature(ldf, feature, ns));
+      BOOST_CHECK_CLOSE(VW::get_weight(ldf, index, 0), VW::get_weight(difference, index, 0), 1e-4);
+    }
+    VW::finish(ldf);
+    VW::finish(difference);
+  }
+}
@@ -0,0 +1,100 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include "queue.h"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+void check_fifo(VW::queue_type type)
+{
+  std::vector<int> values = {1, 2, 3, 4, 5};
+  VW::ptr_queue<int> queue{4, type};
+
+  queue.push(&values[0]);
+  BOOST_CHECK_EQUAL(queue.size(), 1);
+  std::vector<int*> batch = {&values[1], &values[2], &values[3]};
+  queue.push_many(batch.data(), batch.size());
+  BOOST_CHECK_EQUAL(queue.size(), 4);
+
+  BOOST_CHECK_EQUAL(queue.pop(), &values[0]);
+  int* out[8];
+  BOOST_CHECK_EQUAL(queue.pop_many(out, 2), 2);
+  BOOST_CHECK_EQUAL(out[0], &values[1]);
+  BOOST_CHECK_EQUAL(out[1], &values[2]);
+
+  // Items pushed before set_done are still handed out, after which pop reports completion.
+  queue.push(&values[4]);
+  queue.set_done();
+  BOOST_CHECK_EQUAL(queue.pop_many(out, 8), 2);
+  BOOST_CHECK_EQUAL(out[0], &values[3]);
+  BOOST_CHECK_EQUAL(out[1], &values[4]);
+  BOOST_CHECK(queue.pop() == nullptr);
+  BOOST_CHECK_EQUAL(queue.pop_many(out, 8), 0);
+}
+
+// Producers push more items than the queue holds so both the full and the empty wait paths are exercised.
+void check_threaded(VW::queue_type type, size_t num_producers, size_t num_consumers)
+{
+  const size_t items_per_producer = 10000;
+  std::vector<int> values(num_producers * items_per_producer, 0);
+  VW::ptr_queue<int> queue{16, type};
+
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < num_producers; p++)
+  {
+    producers.emplace_back([&, p] {
+      for (size_t i = 0; i < items_per_producer; i++) { queue.push(&values[p * items_per_producer + i]); }
+    });
+  }
+
+  std::vector<std::vector<int*>> received(num_consumers);
+  std::vector<std::thread> consumers;
+  for (size_t c = 0; c < num_consumers; c++)
+  {
+    consumers.emplace_back([&, c] {
+      int* batch[7];
+      size_t num;
+      while ((num = queue.pop_many(batch, 7)) > 0) { received[c].insert(received[c].end(), batch, batch + num); }
+    });
+  }
+
+  for (auto& producer : producers) { producer.join(); }
+  queue.set_done();
+  for (auto& consumer : consumers) { consumer.join(); }
+
+  for (auto& items : received)
+  {
+    for (auto* item : items) { (*item)++; }
+  }
+  for (auto value : values) { BOOST_CHECK_EQUAL(value, 1); }
+
+  // With a single producer and consumer the order must be preserved.
+  if (num_producers == 1 && num_consumers == 1)
+  {
+    for (size_t i = 0; i < values.size(); i++) { BOOST_CHECK_EQUAL(received[0][i], &values[i]); }
+  }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(ptr_queue_fifo)
+{
+  check_fifo(VW::queue_type::mutex);
+  check_fifo(VW::queue_type::spsc);
+  check_fifo(VW::queue_type::mpmc);
+}
+
+BOOST_AUTO_TEST_CASE(ptr_queue_threaded)
+{
+  check_threaded(VW::queue_type::mutex, 1, 1);
+  check_threaded(VW::queue_type::spsc, 1, 1);
+  check_threaded(VW::queue_type::mpmc, 1, 1);
+  check_threaded(VW::queue_type::mutex, 4, 3);
+  check_threaded(VW::queue_type::mpmc, 4, 3);
+}
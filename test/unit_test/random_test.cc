@@ -3,6 +3,10 @@
 #include <boost/test/unit_test.hpp>
 #include <explore_internal.h>
 
+#include "philox.h"
+
+#include <vector>
+
 BOOST_AUTO_TEST_CASE(reproduce_max_boundary_issue)
 {
   uint64_t seed = 58587211;
@@ -18,3 +22,48 @@ BOOST_AUTO_TEST_CASE(reproduce_max_boundary_issue)
   float chosen_value = interval_size * (random_draw + 31) + range_min;
   BOOST_CHECK_CLOSE(chosen_value, range_max, 0.000000001f);
 }
+
+BOOST_AUTO_TEST_CASE(philox4x32_known_answers)
+{
+  // The known answers of philox4x32_10 of Random123.
+  const uint32_t zero_counter[4] = {0, 0, 0, 0};
+  const uint32_t zero_key[2] = {0, 0};
+  const uint32_t ones_counter[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+  const uint32_t ones_key[2] = {0xffffffff, 0xffffffff};
+  const uint32_t pi_counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+  const uint32_t pi_key[2] = {0xa4093822, 0x299f31d0};
+  const uint32_t expected[3][4] = {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+      {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}, {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+
+  uint32_t out[4];
+  VW::philox4x32(zero_counter, zero_key, out);
+  BOOST_CHECK_EQUAL_COLLECTIONS(out, out + 4, expected[0], expected[0] + 4);
+  VW::philox4x32(ones_counter, ones_key, out);
+  BOOST_CHECK_EQUAL_COLLECTIONS(out, out + 4, expected[1], expected[1] + 4);
+  VW::philox4x32(pi_counter, pi_key, out);
+  BOOST_CHECK_EQUAL_COLLECTIONS(out, out + 4, expected[2], expected[2] + 4);
+}
+
+BOOST_AUTO_TEST_CASE(random_stream_fill_matches_next)
+{
+  VW::random_stream drawn_one_at_a_time(42, VW::random_stream::BOOTSTRAP, 7);
+  VW::random_stream filled(42, VW::random_stream::BOOTSTRAP, 7);
+
+  std::vector<float> expected;
+  for (size_t i = 0; i < 14; i++) expected.push_back(drawn_one_at_a_time.next());
+  for (float u : expected)
+  {
+    BOOST_CHECK_GE(u, 0.f);
+    BOOST_CHECK_LT(u, 1.f);
+  }
+
+  // A fill starting in the middle of a block.
+  std::vector<float> actual(14);
+  actual[0] = filled.next();
+  filled.fill(actual.data() + 1, 13);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+  // The stream of another example differs.
+  VW::random_stream other_example(42, VW::random_stream::BOOTSTRAP, 8);
+  BOOST_CHECK_NE(other_example.next(), expected[0]);
+}
@@ -0,0 +1,101 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "example.h"
+#include "request_tracer.h"
+
+BOOST_AUTO_TEST_CASE(hdr_histogram_quantiles_are_within_the_bucket_width)
+{
+  VW::hdr_histogram histogram;
+  BOOST_CHECK_EQUAL(histogram.value_at_quantile(0.5), 0);
+
+  // 1 to 100000, the small values counted exactly and the others in buckets of at most 1 in 64
+  for (uint64_t value = 1; value <= 100000; value++) histogram.record(value);
+  BOOST_CHECK_EQUAL(histogram.count(), 100000);
+  BOOST_CHECK_EQUAL(histogram.max(), 100000);
+  BOOST_CHECK_EQUAL(histogram.value_at_quantile(0.001), 100);
+  for (double quantile : {0.5, 0.9, 0.99, 0.999})
+  {
+    const double expected = quantile * 100000;
+    const auto value = static_cast<double>(histogram.value_at_quantile(quantile));
+    BOOST_CHECK_GE(value, expected);
+    BOOST_CHECK_LE(value, expected * (1. + 1. / 64));
+  }
+  BOOST_CHECK_EQUAL(histogram.value_at_quantile(1.), 100000);
+
+  histogram.record(UINT64_MAX);
+  BOOST_CHECK_EQUAL(histogram.value_at_quantile(1.), UINT64_MAX);
+}
+
+BOOST_AUTO_TEST_CASE(request_tracer_traces_examples_in_the_order_they_are_finished)
+{
+  const std::string file = "request_tracer_test.json";
+  {
+    VW::request_tracer tracer(file, 2);
+    example first;
+    example second;
+    example third;
+    for (char c : std::string("first")) first.tag.push_back(c);
+    for (char c : std::string("say \"hi\"")) third.tag.push_back(c);
+
+    v_array<example*> examples;
+    examples.push_back(&first);
+    examples.push_back(&second);
+    const auto received = std::chrono::steady_clock::now();
+    tracer.parsed(examples, 0, received);
+    tracer.queued(2);
+    examples.clear();
+    examples.push_back(&third);
+    tracer.parsed(examples, 2, received);
+
+    tracer.predicted(0);
+    tracer.written(0);
+    tracer.written(1);
+    // not queued, the third was published as the input ended
+    tracer.written(2);
+    examples.delete_v();
+
+    const auto histograms = tracer.histograms();
+    BOOST_CHECK_EQUAL(histograms[VW::request_tracer::total].count(), 3);
+    // the third took no time to dispatch
+    BOOST_CHECK_EQUAL(histograms[VW::request_tracer::dispatch].value_at_quantile(0.), 0);
+
+    // only the last two are kept, the oldest first
+    const auto traces = tracer.traces();
+    BOOST_REQUIRE_EQUAL(traces.size(), 2);
+    BOOST_CHECK_EQUAL(traces[0].example, 1);
+    BOOST_CHECK_EQUAL(traces[1].tag, "say \"hi\"");
+    for (const auto& trace : traces)
+    {
+      BOOST_CHECK(trace.received <= trace.parsed);
+      BOOST_CHECK(trace.parsed <= trace.queued);
+      BOOST_CHECK(trace.queued <= trace.started);
+      BOOST_CHECK(trace.started <= trace.predicted);
+      BOOST_CHECK(trace.predicted <= trace.written);
+    }
+    BOOST_CHECK(traces[1].started >= traces[0].written);
+
+    std::ostringstream report;
+    tracer.report(report);
+    BOOST_CHECK(report.str().find("request phases of 3 examples") == 0);
+    tracer.write_trace();
+  }
+
+  std::ifstream in(file);
+  const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  BOOST_CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+  BOOST_CHECK(json.find("{\"name\":\"example 1\",\"cat\":\"request\",\"ph\":\"b\",\"id\":1,") != std::string::npos);
+  BOOST_CHECK(json.find("{\"name\":\"say \\\"hi\\\"\",\"cat\":\"request\",\"ph\":\"e\",\"id\":2,") != std::string::npos);
+  BOOST_CHECK(json.find("{\"name\":\"queue\",") != std::string::npos);
+  BOOST_CHECK(json.find("\"first\"") == std::string::npos);
+  std::remove(file.c_str());
+}
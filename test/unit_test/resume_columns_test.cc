@@ -0,0 +1,51 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "vw.h"
+
+namespace
+{
+void train_model(const std::string& options, const std::string& file)
+{
+  auto* all = VW::initialize(options + " --save_resume --quiet -f " + file);
+  for (const std::string line : {"1 | a:1 b:2", "0 | b:1 c:0.5", "1 | a:0.5 d:1", "0 | c:1 d:2"})
+  {
+    auto* ec = VW::read_example(*all, line);
+    all->learn(*ec);
+    VW::finish_example(*all, *ec);
+  }
+  VW::finish(*all);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(resume_columns_hold_the_state_of_rows)
+{
+  train_model("", "resume_rows.model");
+  train_model("--write_resume_columns", "resume_columns.model");
+
+  for (const std::string mode : {"--save_resume", "-t"})
+  {
+    auto* rows = VW::initialize("--quiet " + mode + " -i resume_rows.model");
+    auto* columns = VW::initialize("--quiet " + mode + " -i resume_columns.model");
+    // Predicting, only the weights of the columns are read.
+    const uint32_t slots = mode == "-t" ? 1 : 3;
+    for (const std::string feature : {"a", "b", "c", "d", "e"})
+    {
+      const auto index = (uint32_t)VW::hash_feature(*rows, feature, VW::hash_space(*rows, " "));
+      for (uint32_t slot = 0; slot < slots; slot++)
+        BOOST_CHECK_EQUAL(VW::get_weight(*rows, index, slot), VW::get_weight(*columns, index, slot));
+    }
+    VW::finish(*rows);
+    VW::finish(*columns);
+  }
+  std::remove("resume_rows.model");
+  std::remove("resume_columns.model");
+}
@@ -103,3 +103,101 @@ BOOST_AUTO_TEST_CASE(slates_reduction_mock_test)
   test_base_learner->finish();
   free_it(test_base_learner);
 }
+
+BOOST_AUTO_TEST_CASE(slates_reduction_reuses_the_storage_of_slots)
+{
+  auto& vw = *VW::initialize("--slates --quiet");
+  std::vector<std::vector<std::string>> decisions = {
+      {"slates shared 0.5", "slates action 0", "slates action 0", "slates action 1", "slates slot 1:0.5",
+          "slates slot 0:0.9"},
+      {"slates shared", "slates action 0", "slates action 1", "slates action 1", "slates slot", "slates slot"}};
+  std::vector<std::vector<uint32_t>> included_actions[2] = {{{0, 1}, {2}}, {{0}, {1, 2}}};
+
+  size_t decision = 0;
+  auto mock_learn_or_pred = [&decision, &included_actions](multi_ex& examples) {
+    for (size_t slot = 0; slot < 2; slot++)
+    {
+      const auto& label = examples[4 + slot]->l.conditional_contextual_bandit;
+      check_collections_exact(label.explicit_included_actions, included_actions[decision][slot]);
+      BOOST_CHECK_EQUAL(label.outcome == nullptr, decision == 1);
+      auto a_s = v_init<ACTION_SCORE::action_score>();
+      for (uint32_t action : included_actions[decision][slot]) { a_s.push_back({action, 1.f}); }
+      examples[0]->pred.decision_scores.push_back(a_s);
+    }
+    if (decision == 0)
+    {
+      check_collections_with_float_tolerance(examples[4]->l.conditional_contextual_bandit.outcome->probabilities,
+          std::vector<ACTION_SCORE::action_score>{{1, 0.5f}});
+      check_collections_with_float_tolerance(examples[5]->l.conditional_contextual_bandit.outcome->probabilities,
+          std::vector<ACTION_SCORE::action_score>{{2, 0.9f}});
+    }
+  };
+  auto test_base_learner = VW::LEARNER::as_multiline(make_test_learner(mock_learn_or_pred, mock_learn_or_pred));
+  VW::slates::slates_data slate_reduction;
+  for (decision = 0; decision < decisions.size(); decision++)
+  {
+    multi_ex examples;
+    for (const auto& line : decisions[decision]) { examples.push_back(VW::read_example(vw, line + " | f")); }
+    slate_reduction.learn(*test_base_learner, examples);
+    BOOST_CHECK_EQUAL(examples[0]->pred.decision_scores.size(), 2);
+    BOOST_CHECK_EQUAL(examples[0]->pred.decision_scores[0][0].action, 0);
+    BOOST_CHECK_EQUAL(examples[0]->pred.decision_scores[1][0].action, 0);
+    vw.finish_example(examples);
+  }
+
+  VW::finish(vw);
+  test_base_learner->finish();
+  free_it(test_base_learner);
+}
+
+BOOST_AUTO_TEST_CASE(slates_reduction_hands_the_arrays_of_finished_predictions_back_to_the_base)
+{
+  auto& vw = *VW::initialize("--slates --quiet");
+  std::vector<const ACTION_SCORE::action_score*> storage;
+  size_t call = 0;
+  auto mock_learn_or_pred = [&call, &storage](multi_ex& examples) {
+    auto& decision_scores = examples[0]->pred.decision_scores;
+    if (call == 0) { BOOST_CHECK(decision_scores.empty()); }
+    else
+    {
+      // The arrays of the first prediction come back as spares, emptied.
+      BOOST_CHECK_EQUAL(decision_scores.size(), 2);
+      for (size_t slot = 0; slot < decision_scores.size(); slot++)
+      {
+        BOOST_CHECK(decision_scores[slot].empty());
+        BOOST_CHECK_EQUAL(decision_scores[slot].begin(), storage[slot]);
+      }
+      for (auto& a_s : decision_scores) { a_s.delete_v(); }
+      decision_scores.clear();
+    }
+    for (uint32_t slot = 0; slot < 2; slot++)
+    {
+      auto a_s = v_init<ACTION_SCORE::action_score>();
+      a_s.push_back({slot, 1.f});
+      decision_scores.push_back(a_s);
+      storage.push_back(a_s.begin());
+    }
+  };
+  auto test_base_learner = VW::LEARNER::as_multiline(make_test_learner(mock_learn_or_pred, mock_learn_or_pred));
+  VW::slates::slates_data slate_reduction;
+  for (call = 0; call < 2; call++)
+  {
+    multi_ex examples;
+    for (const auto& line : {"slates shared", "slates action 0", "slates action 1", "slates slot", "slates slot"})
+    { examples.push_back(VW::read_example(vw, std::string(line) + " | f")); }
+    slate_reduction.predict(*test_base_learner, examples);
+    BOOST_CHECK_EQUAL(examples[0]->pred.decision_scores.size(), 2);
+    if (call == 0)
+    {
+      // As finishing the examples with the reduction does.
+      slate_reduction.reuse(examples[0]->pred.decision_scores);
+      VW::finish_example(vw, examples);
+    }
+    else
+      vw.finish_example(examples);
+  }
+
+  VW::finish(vw);
+  test_base_learner->finish();
+  free_it(test_base_learner);
+}
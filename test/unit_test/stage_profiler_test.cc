@@ -0,0 +1,76 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <string>
+
+#include "vw.h"
+
+namespace
+{
+const VW::stage_statistics* find_stage(const std::vector<VW::stage_statistics>& stages, const std::string& name)
+{
+  for (const auto& stage : stages)
+    if (stage.name == name) return &stage;
+  return nullptr;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(stage_timing_is_off_by_default)
+{
+  auto& vw = *VW::initialize("--quiet");
+  BOOST_CHECK(vw.profiler == nullptr);
+  BOOST_CHECK(vw.l->profile == nullptr);
+  BOOST_CHECK(vw.example_parser->input->fill_profile == nullptr);
+  VW::finish(vw);
+}
+
+// Every call of a stage is counted, one in 64 timed.
+BOOST_AUTO_TEST_CASE(stage_timing_counts_the_calls_of_each_stage)
+{
+  auto& vw = *VW::initialize("--quiet --stage_timing");
+  for (int i = 0; i < 128; i++)
+  {
+    auto& ec = *VW::read_example(vw, std::string(i % 2 == 0 ? "1 | a b c" : "-1 | b c d"));
+    vw.learn(ec);
+    vw.finish_example(ec);
+  }
+
+  const auto stages = vw.profiler->statistics();
+  for (const char* name : {"setup_example", "learn gd", "learn scorer", "finish_example"})
+  {
+    const auto* stage = find_stage(stages, name);
+    BOOST_REQUIRE_MESSAGE(stage != nullptr, name);
+    BOOST_CHECK_EQUAL(stage->calls, 128);
+    BOOST_CHECK_EQUAL(stage->samples, 2);
+    BOOST_CHECK_GE(stage->seconds, 0.);
+  }
+  // the same examples are sampled, and the learn of the scorer includes that of gd below it
+  BOOST_CHECK_GE(find_stage(stages, "learn scorer")->seconds, find_stage(stages, "learn gd")->seconds);
+  VW::finish(vw);
+}
+
+// A sampled call times the calls it makes as well, so that what the reductions below it take can be taken off its own.
+BOOST_AUTO_TEST_CASE(stage_timing_takes_the_reductions_below_off_the_self_time)
+{
+  auto& vw = *VW::initialize("--quiet --stage_timing");
+  for (int i = 0; i < 10; i++)
+  {
+    auto& ec = *VW::read_example(vw, std::string("1 | a b c"));
+    vw.learn(ec);
+    vw.finish_example(ec);
+  }
+
+  const auto stages = vw.profiler->statistics();
+  const auto* scorer = find_stage(stages, "learn scorer");
+  const auto* gd = find_stage(stages, "learn gd");
+  BOOST_REQUIRE(scorer != nullptr && gd != nullptr);
+  BOOST_CHECK_EQUAL(scorer->samples, 1);
+  BOOST_CHECK_EQUAL(gd->samples, 1);
+  BOOST_CHECK_CLOSE(scorer->seconds, scorer->self_seconds + gd->seconds, 1e-6);
+  BOOST_CHECK_LE(gd->self_seconds, gd->seconds);
+  VW::finish(vw);
+}
@@ -0,0 +1,75 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "io/io_adapter.h"
+#include "text_format.h"
+
+namespace
+{
+std::string general(float value)
+{
+  char text[VW::MAX_FLOAT_CHARS];
+  return std::string(text, VW::format_general(text, value));
+}
+
+std::string fixed(float value, int precision)
+{
+  char text[VW::MAX_FLOAT_CHARS];
+  return std::string(text, VW::format_fixed(text, value, precision));
+}
+
+void check_as_streams_write(float value)
+{
+  std::stringstream general_stream;
+  general_stream << value;
+  BOOST_CHECK_EQUAL(general(value), general_stream.str());
+  for (int precision : {0, 1, 6, 9})
+  {
+    std::stringstream fixed_stream;
+    fixed_stream << std::fixed << std::setprecision(precision) << value;
+    BOOST_CHECK_EQUAL(fixed(value, precision), fixed_stream.str());
+  }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(floats_are_formatted_as_streams_write_them)
+{
+  for (float value : {0.f, -0.f, 1.f, -1.f, 0.5f, 2.5f, 0.1f, 1e-4f, 1e-5f, 9.999995e-5f, 123456.5f, 999999.5f, 1e6f,
+           1234567.f, 1e30f, -3.4e38f, std::numeric_limits<float>::denorm_min(),
+           std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()})
+    check_as_streams_write(value);
+
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> mantissas(-10.f, 10.f);
+  for (int i = 0; i < 10000; i++) check_as_streams_write(std::ldexp(mantissas(random), i % 60 - 40));
+}
+
+BOOST_AUTO_TEST_CASE(text_line_formats_predictions)
+{
+  v_array<char> tag = v_init<char>();
+  push_many(tag, "t1", 2);
+
+  auto buffer = std::make_shared<std::vector<char>>();
+  auto writer = VW::io::create_vector_writer(buffer);
+  auto& line = VW::thread_text_line();
+  line.add_uint(3).add(':').add_general(0.25f).add(',').add_uint(1).add(':').add_fixed(0.75f, 2).add_tag(tag).add('\n');
+  line.write_to(writer.get());
+
+  BOOST_CHECK_EQUAL(std::string(buffer->begin(), buffer->end()), "3:0.25,1:0.75 t1\n");
+  BOOST_CHECK(line.str().empty());
+  tag.delete_v();
+}
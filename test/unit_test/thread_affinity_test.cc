@@ -0,0 +1,35 @@
+#ifndef STATIC_LINK_VW
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "thread_affinity.h"
+#include "vw_exception.h"
+
+BOOST_AUTO_TEST_CASE(parse_cpu_list_expands_ranges)
+{
+  const std::vector<uint32_t> expected = {0, 1, 2, 3, 8, 10, 11};
+  const auto cpus = VW::parse_cpu_list("10-11,0-3,8,2");
+  BOOST_CHECK_EQUAL_COLLECTIONS(cpus.begin(), cpus.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(parse_cpu_list_rejects_malformed_lists)
+{
+  for (const std::string list : {"", "a", "1-", "3-1", "1,,2", "node", "node-1"})
+    BOOST_CHECK_THROW(VW::parse_cpu_list(list), VW::vw_exception);
+}
+
+BOOST_AUTO_TEST_CASE(start_pinned_thread_runs_with_its_arguments)
+{
+  std::string result;
+  auto thread = VW::start_pinned_thread(
+      VW::thread_role::worker, [](std::string& out, int value) { out = std::to_string(value); }, std::ref(result), 7);
+  thread.join();
+  BOOST_CHECK_EQUAL(result, "7");
+}
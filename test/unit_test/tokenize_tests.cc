@@ -143,3 +143,28 @@ BOOST_AUTO_TEST_CASE(basic_tokenize_to_argv) {
   for (int i = 0; i < argc; i++) free(argv[i]);
   free(argv);
 }
+
+BOOST_AUTO_TEST_CASE(next_token_scans_the_tokens_of_tokenize) {
+  std::string str = "::this:is:::a:string:";
+  VW::string_view rest = str;
+  VW::string_view token;
+  std::vector<VW::string_view> container;
+  while (next_token(':', rest, token)) { container.push_back(token); }
+
+  auto const expected_values = {"this", "is", "a", "string"};
+  BOOST_CHECK_EQUAL_COLLECTIONS(
+    container.begin(), container.end(),
+    expected_values.begin(), expected_values.end());
+  BOOST_CHECK(!next_token(':', rest, token));
+}
+
+BOOST_AUTO_TEST_CASE(tokenize_into_stops_past_max_tokens) {
+  VW::string_view tokens[3];
+  BOOST_CHECK_EQUAL(tokenize_into(':', "", tokens, 3), 0);
+  BOOST_CHECK_EQUAL(tokenize_into(':', "1:0.5", tokens, 3), 2);
+  BOOST_CHECK_EQUAL(tokens[0], "1");
+  BOOST_CHECK_EQUAL(tokens[1], "0.5");
+  BOOST_CHECK_EQUAL(tokenize_into(':', "1::0.5:0.2", tokens, 3), 3);
+  BOOST_CHECK_EQUAL(tokens[2], "0.2");
+  BOOST_CHECK_EQUAL(tokenize_into(':', "1:0.5:0.2:3:4", tokens, 3), 4);
+}
@@ -74,6 +74,69 @@ BOOST_AUTO_TEST_CASE(vw_dll_parsed_and_constructed_example_parity)
   VW_Finish(handle2);
 }
 
+BOOST_AUTO_TEST_CASE(vw_dll_batch_matches_parsed_examples)
+{
+  const char* lines[] = {"1 |s the man |t un homme", "0 |s the woman", "1 |t une femme |s woman"};
+  VW_HANDLE handle1 = VW_InitializeA("-q st --quiet");
+  VW_HANDLE handle2 = VW_InitializeA("-q st --quiet");
+
+  std::vector<float> expected_predictions;
+  for (const char* line : lines)
+  {
+    VW_EXAMPLE example_parsed = VW_ReadExampleA(handle1, line);
+    expected_predictions.push_back(VW_Learn(handle1, example_parsed));
+    VW_FinishExample(handle1, example_parsed);
+  }
+
+  // the same examples as flat arrays, the constant feature left to vw
+  const std::vector<std::vector<std::pair<std::string, std::vector<std::string>>>> examples = {
+      {{"s", {"the", "man"}}, {"t", {"un", "homme"}}},
+      {{"s", {"the", "woman"}}},
+      {{"t", {"une", "femme"}}, {"s", {"woman"}}}};
+  std::vector<size_t> example_offsets = {0};
+  std::vector<unsigned char> namespaces;
+  std::vector<size_t> feature_offsets = {0};
+  std::vector<size_t> feature_indices;
+  std::vector<float> feature_values;
+  for (const auto& ex : examples)
+  {
+    for (const auto& ns : ex)
+    {
+      namespaces.push_back(ns.first[0]);
+      const size_t ns_hash = VW_HashSpaceA(handle2, ns.first.c_str());
+      for (const auto& f : ns.second)
+      {
+        feature_indices.push_back(VW_HashFeatureA(handle2, f.c_str(), ns_hash));
+        feature_values.push_back(1.f);
+      }
+      feature_offsets.push_back(feature_indices.size());
+    }
+    example_offsets.push_back(namespaces.size());
+  }
+  const std::vector<float> labels = {1.f, 0.f, 1.f};
+
+  std::vector<float> predictions(3);
+  VW_LearnBatch(handle2, 3, example_offsets.data(), namespaces.data(), feature_offsets.data(), feature_indices.data(),
+      feature_values.data(), labels.data(), nullptr, predictions.data());
+  check_collections_with_float_tolerance(predictions, expected_predictions, FLOAT_TOL);
+
+  auto vw1 = static_cast<vw*>(handle1);
+  auto vw2 = static_cast<vw*>(handle2);
+  check_weights_equal(vw1->weights.dense_weights, vw2->weights.dense_weights);
+
+  VW_PredictBatch(handle2, 3, example_offsets.data(), namespaces.data(), feature_offsets.data(), feature_indices.data(),
+      feature_values.data(), predictions.data());
+  for (size_t i = 0; i < 3; i++)
+  {
+    VW_EXAMPLE example_parsed = VW_ReadExampleA(handle1, lines[i]);
+    BOOST_CHECK_CLOSE(predictions[i], VW_Predict(handle1, example_parsed), FLOAT_TOL);
+    VW_FinishExample(handle1, example_parsed);
+  }
+
+  VW_Finish(handle1);
+  VW_Finish(handle2);
+}
+
 #ifndef __APPLE__
 BOOST_AUTO_TEST_CASE(vw_dll_parse_escaped)
 {
@@ -7,9 +7,15 @@
 
 #include "array_parameters.h"
 #include "array_parameters_dense.h"
+#include "array_parameters_compact.h"
+#include "shared_weights.h"
 
 #include "test_common.h"
 
+#include <cmath>
+#include <thread>
+#include <vector>
+
 constexpr auto LENGTH = 16;
 constexpr auto STRIDE_SHIFT = 2;
 
@@ -26,3 +32,187 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(test_default_function_weight_initialization_stride
   }
 }
 
+
+BOOST_AUTO_TEST_CASE(shared_weights_follow_published_generations)
+{
+  dense_parameters trained(LENGTH, STRIDE_SHIFT);
+  trained.set_default([](weight* weights, uint64_t index) { weights[0] = 1.f * index; });
+  auto publisher = VW::shared_weights::publisher("vw_unit_test_shared_weights", trained.mask() + 1);
+  publisher->publish(trained);
+
+  dense_parameters attached(LENGTH, STRIDE_SHIFT);
+  auto reader = VW::shared_weights::attach("vw_unit_test_shared_weights", attached);
+  BOOST_CHECK(attached.external());
+  BOOST_CHECK_EQUAL(reader->generation(), publisher->generation());
+  BOOST_CHECK_CLOSE(attached.strided_index(3), 3.f * trained.stride(), FLOAT_TOL);
+  BOOST_CHECK(!reader->follow(attached));
+
+  trained.strided_index(3) = -1.f;
+  BOOST_CHECK_CLOSE(attached.strided_index(3), 3.f * trained.stride(), FLOAT_TOL);
+  publisher->publish(trained);
+  publisher->publish(trained);
+  BOOST_CHECK(reader->follow(attached));
+  BOOST_CHECK_EQUAL(reader->generation(), publisher->generation());
+  BOOST_CHECK_CLOSE(attached.strided_index(3), -1.f, FLOAT_TOL);
+}
+
+BOOST_AUTO_TEST_CASE(shared_weights_attach_checks_size)
+{
+  dense_parameters trained(LENGTH, STRIDE_SHIFT);
+  auto publisher = VW::shared_weights::publisher("vw_unit_test_shared_weights_size", trained.mask() + 1);
+  publisher->publish(trained);
+
+  dense_parameters other(2 * LENGTH, STRIDE_SHIFT);
+  BOOST_CHECK_THROW(VW::shared_weights::attach("vw_unit_test_shared_weights_size", other), VW::vw_exception);
+}
+
+BOOST_AUTO_TEST_CASE(dense_weights_swap)
+{
+  dense_parameters current(LENGTH, STRIDE_SHIFT);
+  dense_parameters reloaded(LENGTH, STRIDE_SHIFT);
+  reloaded.set_default([](weight* weights, uint64_t index) { weights[0] = 1.f * index; });
+
+  current.swap_weights(reloaded);
+  BOOST_CHECK_CLOSE(current.strided_index(3), 3.f * current.stride(), FLOAT_TOL);
+  BOOST_CHECK_CLOSE(reloaded.strided_index(3), 0.f, FLOAT_TOL);
+}
+
+BOOST_AUTO_TEST_CASE(dense_weights_in_planes)
+{
+  dense_parameters w(LENGTH, 0, VW::weight_allocation(), 2);
+  BOOST_CHECK_EQUAL(w.mask() + 1, LENGTH);
+  BOOST_CHECK_EQUAL(w.slot_distance(), LENGTH);
+  BOOST_CHECK_EQUAL(w.slots(), 4);
+
+  // The weights are contiguous, each slot of their state is a plane of its own.
+  (&w[3])[2 * w.slot_distance()] = 1.f;
+  BOOST_CHECK_CLOSE(w.first()[2 * LENGTH + 3], 1.f, FLOAT_TOL);
+  w.set_zero(2);
+  BOOST_CHECK_CLOSE(w.first()[2 * LENGTH + 3], 0.f, FLOAT_TOL);
+
+  dense_parameters interleaved(LENGTH, STRIDE_SHIFT);
+  BOOST_CHECK_EQUAL(interleaved.slot_distance(), 1);
+  BOOST_CHECK_EQUAL(interleaved.slots(), interleaved.stride());
+}
+
+BOOST_AUTO_TEST_CASE(dense_weights_prefetch_by_size)
+{
+  dense_parameters small(LENGTH, STRIDE_SHIFT);
+  BOOST_CHECK_EQUAL(small.prefetch_distance(), 0);
+
+  dense_parameters large(VW::PREFETCH_MIN_BYTES / sizeof(weight), 0);
+  BOOST_CHECK_EQUAL(large.prefetch_distance(), VW::DEFAULT_PREFETCH_DISTANCE);
+  large.prefetch_distance(0);
+  BOOST_CHECK_EQUAL(large.prefetch_distance(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(dense_weights_allocation_falls_back)
+{
+  VW::weight_allocation requested;
+  requested.pages = VW::parse_huge_pages("1gb");
+  requested.numa = VW::parse_numa_policy("interleave");
+  dense_parameters w(LENGTH, STRIDE_SHIFT, requested);
+
+  // Whatever took effect, the weights start zeroed and are usable.
+  BOOST_CHECK_CLOSE(w.strided_index(3), 0.f, FLOAT_TOL);
+  w.set_default([](weight* weights, uint64_t index) { weights[0] = 1.f * index; });
+  BOOST_CHECK_CLOSE(w.strided_index(3), 3.f * w.stride(), FLOAT_TOL);
+  BOOST_CHECK(!VW::to_string(w.allocation()).empty());
+
+  BOOST_CHECK_THROW(VW::parse_huge_pages("4kb"), VW::vw_exception);
+  BOOST_CHECK_THROW(VW::parse_numa_policy("remote"), VW::vw_exception);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_weights_stay_in_place_while_growing)
+{
+  sparse_parameters w(1 << 16, STRIDE_SHIFT);
+  w.set_default([](weight* weights, uint64_t index) { weights[0] = 1.f * index; });
+  weight& first = w.strided_index(1);
+  for (size_t i = 0; i < 10000; i++) { (&w.strided_index(i * 7))[1] = 2.f * i; }
+
+  BOOST_CHECK_EQUAL(&first, &w.strided_index(1));
+  BOOST_CHECK_CLOSE(first, 1.f * w.stride(), FLOAT_TOL);
+  BOOST_CHECK_EQUAL(w.size(), 10001);
+  size_t visited = 0;
+  for (auto iter = w.begin(); iter != w.end(); ++iter, visited++)
+  { BOOST_CHECK_CLOSE(*iter, 1.f * iter.index(), FLOAT_TOL); }
+  BOOST_CHECK_EQUAL(visited, w.size());
+}
+
+BOOST_AUTO_TEST_CASE(sparse_weights_added_from_several_threads)
+{
+  sparse_parameters w(1 << 16, STRIDE_SHIFT);
+  w.set_default([](weight* weights, uint64_t index) { weights[0] = 1.f * index; });
+
+  // Every thread adds the same weights, each must be added once and be seen at the same place by all.
+  constexpr size_t num_threads = 4;
+  constexpr size_t num_weights = 20000;
+  std::vector<std::vector<weight*>> seen(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++)
+  {
+    threads.emplace_back([&w, &seen, t] {
+      for (size_t i = 0; i < num_weights; i++) seen[t].push_back(&w.strided_index((i * 13 + t * 101) % num_weights));
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  BOOST_CHECK_EQUAL(w.size(), num_weights);
+  for (size_t t = 1; t < num_threads; t++)
+  {
+    for (size_t i = 0; i < num_weights; i++)
+    { BOOST_CHECK_EQUAL(seen[t][i], &w.strided_index((i * 13 + t * 101) % num_weights)); }
+  }
+  for (auto iter = w.begin(); iter != w.end(); ++iter) { BOOST_CHECK_CLOSE(*iter, 1.f * iter.index(), FLOAT_TOL); }
+}
+
+BOOST_AUTO_TEST_CASE(sparse_weights_evict_the_least_used_past_their_limit)
+{
+  sparse_parameters w(1 << 20, STRIDE_SHIFT);
+  w.set_limit(1000);
+  BOOST_CHECK_EQUAL(w.evict_if_over_limit(), 0);
+
+  // 200 weights used every round, and 100 new ones used once
+  for (size_t round = 0; round < 50; round++)
+  {
+    for (size_t i = 0; i < 200; i++) w.strided_index(i) += 1.f;
+    for (size_t i = 0; i < 100; i++) w.strided_index(100000 + round * 100 + i) = 0.001f * i;
+    w.evict_if_over_limit();
+    BOOST_CHECK_LE(w.size(), 1000);
+  }
+  BOOST_CHECK_EQUAL(w.evicted(), 200 + 50 * 100 - w.size());
+  BOOST_CHECK_GT(w.evictions(), 0);
+  size_t used = 0;
+  for (auto iter = w.begin(); iter != w.end(); ++iter)
+  {
+    if (iter.index() >= (200 << STRIDE_SHIFT)) continue;
+    BOOST_CHECK_CLOSE(*iter, 50.f, FLOAT_TOL);
+    used++;
+  }
+  BOOST_CHECK_EQUAL(used, 200);
+
+  // the blocks of evicted weights are reused as new ones, zeroed
+  for (size_t i = 0; i < 5000; i++) BOOST_CHECK_EQUAL((&w.strided_index(900000 + i))[1], 0.f);
+}
+
+BOOST_AUTO_TEST_CASE(compact_weights_round_to_nearest)
+{
+  // 1 + 2^-11 lies halfway between two halves and rounds to the even one, 1 + 2^-10 is exact
+  BOOST_CHECK_EQUAL(VW::float16::from_float(1.00048828125f), 0x3c00);
+  BOOST_CHECK_EQUAL(VW::float16::to_float(VW::float16::from_float(1.0009765625f)), 1.0009765625f);
+  BOOST_CHECK_EQUAL(VW::float16::to_float(VW::float16::from_float(-0.5f)), -0.5f);
+  BOOST_CHECK_EQUAL(VW::float16::from_float(1e6f), 0x7c00);
+  BOOST_CHECK_EQUAL(VW::float16::to_float(VW::float16::from_float(5.9604645e-8f)), 5.9604645e-8f);  // smallest half
+  BOOST_CHECK(std::isnan(VW::float16::to_float(VW::float16::from_float(std::nanf("")))));
+
+  BOOST_CHECK_EQUAL(VW::bfloat16::to_float(VW::bfloat16::from_float(3.f)), 3.f);
+  // 1 + 2^-8 is halfway and rounds down to even, 1 + 3 * 2^-8 rounds up
+  BOOST_CHECK_EQUAL(VW::bfloat16::to_float(VW::bfloat16::from_float(1.00390625f)), 1.f);
+  BOOST_CHECK_EQUAL(VW::bfloat16::to_float(VW::bfloat16::from_float(1.01171875f)), 1.015625f);
+  BOOST_CHECK(std::isnan(VW::bfloat16::to_float(VW::bfloat16::from_float(std::nanf("")))));
+
+  dense_parameters_bf16 w(LENGTH, STRIDE_SHIFT);
+  w.strided_index(3) = 0.1f;
+  BOOST_CHECK_CLOSE(static_cast<float>(w[3 << STRIDE_SHIFT]), 0.1f, 0.5);
+  BOOST_CHECK_EQUAL(static_cast<const dense_parameters_bf16&>(w)[0], 0.f);
+}
@@ -0,0 +1,60 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+// Merges models trained apart with the same options into one, see VW::merge_models:
+//
+//   vw-merge [--threads <n>] -o <merged model> <model> <model>...
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "merge_models.h"
+#include "vw.h"
+
+namespace
+{
+int usage()
+{
+  std::cerr << "usage: vw-merge [--threads <n>] -o <merged model> <model> <model>..." << std::endl
+            << "  --threads <n>  threads folding the dense weights, 0 for one per core (default 1)" << std::endl;
+  return 1;
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  std::string output;
+  size_t threads = 1;
+  std::vector<std::string> models;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    if ((arg == "-o" || arg == "--output") && i + 1 < argc)
+      output = argv[++i];
+    else if (arg == "--threads" && i + 1 < argc)
+      threads = std::strtoul(argv[++i], nullptr, 10);
+    else if (!arg.empty() && arg[0] == '-')
+      return usage();
+    else
+      models.push_back(arg);
+  }
+  if (output.empty() || models.size() < 2) return usage();
+
+  try
+  {
+    vw* merged = VW::merge_models(models, threads);
+    VW::save_predictor(*merged, output);
+    VW::finish(*merged);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "vw-merge: " << e.what() << std::endl;
+    return 1;
+  }
+  std::cerr << "merged " << models.size() << " models into " << output << std::endl;
+  return 0;
+}
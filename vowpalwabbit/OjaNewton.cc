@@ -8,6 +8,7 @@
 #include "reductions.h"
 #include <cmath>
 #include <memory>
+#include <vector>
 
 using namespace VW::LEARNER;
 using namespace VW::config;
@@ -27,6 +28,13 @@ struct oja_n_update_data
   float prediction;
 };
 
+// A feature of the example being learned, with its value once normalized when --normalize is on.
+struct oja_n_feature
+{
+  float* w;
+  float x;
+};
+
 struct OjaNewton
 {
   vw* all;
@@ -51,6 +59,9 @@ struct OjaNewton
   float* weight_buffer;
   struct oja_n_update_data data;
 
+  // The features of the example being learned, gathered once rather than by every pass over them.
+  std::vector<oja_n_feature> features;
+
   float learning_rate_cnt;
   bool normalize;
   bool random_init;
@@ -207,10 +218,16 @@ struct OjaNewton
 
   void update_b()
   {
+    // zv and vv are free once update_A is done, they hold the factors of A[i][j] which do not depend on j.
+    for (int i = 1; i <= m; i++)
+    {
+      zv[i] = ev[i] * data.AZx[i];
+      vv[i] = alpha * (alpha + ev[i]);
+    }
     for (int j = 1; j <= m; j++)
     {
       float temp = 0;
-      for (int i = j; i <= m; i++) { temp += ev[i] * data.AZx[i] * A[i][j] / (alpha * (alpha + ev[i])); }
+      for (int i = j; i <= m; i++) { temp += zv[i] * A[i][j] / vv[i]; }
       b[j] += temp * data.g;
     }
   }
@@ -398,16 +415,67 @@ void update_normalization(oja_n_update_data& data, float x, float& wref)
   w[NORM2] += x * x * data.g * data.g;
 }
 
-void learn(OjaNewton& ON, base_learner& base, example& ec)
+void gather_feature(OjaNewton& ON, float x, float& wref) { ON.features.push_back({&wref, x}); }
+
+// The passes of learn over the example being learned, on its gathered features. Once normalized their values are
+// those the callbacks above compute.
+void compute_Zx_and_norm(OjaNewton& ON)
 {
-  // predict
-  predict(ON, base, ec);
+  oja_n_update_data& data = ON.data;
+  const int m = ON.m;
+  for (const oja_n_feature& f : ON.features)
+  {
+    for (int i = 1; i <= m; i++) { data.Zx[i] += f.w[i] * f.x * ON.D[i]; }
+    data.norm2_x += f.x * f.x;
+  }
+}
+
+void update_Z_and_wbar(OjaNewton& ON)
+{
+  oja_n_update_data& data = ON.data;
+  const int m = ON.m;
+  for (const oja_n_feature& f : ON.features)
+  {
+    float s = data.sketch_cnt * f.x;
+    for (int i = 1; i <= m; i++) { f.w[i] += data.delta[i] * s / ON.D[i]; }
+    f.w[0] -= s * data.bdelta;
+  }
+}
 
+void update_wbar_and_Zx(OjaNewton& ON)
+{
   oja_n_update_data& data = ON.data;
+  const int m = ON.m;
+  for (const oja_n_feature& f : ON.features)
+  {
+    float g = data.g * f.x;
+    for (int i = 1; i <= m; i++) { data.Zx[i] += f.w[i] * f.x * ON.D[i]; }
+    f.w[0] -= g / ON.alpha;
+  }
+}
+
+void learn(OjaNewton& ON, base_learner&, example& ec)
+{
+  ON.features.clear();
+  GD::foreach_feature<OjaNewton, gather_feature>(*ON.all, ec, ON);
+
+  // predict
+  oja_n_update_data& data = ON.data;
+  data.prediction = 0;
+  for (const oja_n_feature& f : ON.features) make_pred(data, f.x, *f.w);
+  ec.partial_prediction = (float)data.prediction;
+  ec.pred.scalar = GD::finalize_prediction(ON.all->sd, ON.all->logger, ec.partial_prediction);
+
   data.g = ON.all->loss->first_derivative(ON.all->sd, ec.pred.scalar, ec.l.simple.label) * ec.l.simple.weight;
   data.g /= 2;  // for half square loss
 
-  if (ON.normalize) GD::foreach_feature<oja_n_update_data, update_normalization>(*ON.all, ec, data);
+  if (ON.normalize)
+  {
+    for (const oja_n_feature& f : ON.features) update_normalization(data, f.x, *f.w);
+    // The passes below see the norms updated and no others until the next example.
+    const int m = ON.m;
+    for (oja_n_feature& f : ON.features) f.x /= std::sqrt(f.w[NORM2]);
+  }
 
   ON.buffer[ON.cnt] = &ec;
   ON.weight_buffer[ON.cnt++] = data.g / 2;
@@ -421,7 +489,10 @@ void learn(OjaNewton& ON, base_learner& base, example& ec)
 
       data.norm2_x = 0;
       memset(data.Zx, 0, sizeof(float) * (ON.m + 1));
-      GD::foreach_feature<oja_n_update_data, compute_Zx_and_norm>(*ON.all, ex, data);
+      if (&ex == &ec)
+        compute_Zx_and_norm(ON);
+      else
+        GD::foreach_feature<oja_n_update_data, compute_Zx_and_norm>(*ON.all, ex, data);
       ON.compute_AZx();
 
       ON.update_eigenvalues();
@@ -429,7 +500,10 @@ void learn(OjaNewton& ON, base_learner& base, example& ec)
 
       ON.update_K();
 
-      GD::foreach_feature<oja_n_update_data, update_Z_and_wbar>(*ON.all, ex, data);
+      if (&ex == &ec)
+        update_Z_and_wbar(ON);
+      else
+        GD::foreach_feature<oja_n_update_data, update_Z_and_wbar>(*ON.all, ex, data);
     }
 
     ON.update_A();
@@ -437,7 +511,7 @@ void learn(OjaNewton& ON, base_learner& base, example& ec)
   }
 
   memset(data.Zx, 0, sizeof(float) * (ON.m + 1));
-  GD::foreach_feature<oja_n_update_data, update_wbar_and_Zx>(*ON.all, ec, data);
+  update_wbar_and_Zx(ON);
   ON.compute_AZx();
 
   ON.update_b();
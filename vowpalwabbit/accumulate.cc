@@ -10,33 +10,97 @@ Alekh Agarwal and John Langford, with help Olivier Chapelle.
 #include <iostream>
 #include <cmath>
 #include <cstdint>
+#include <algorithm>
+#include <future>
+#include <vector>
 #include "global_data.h"
 #include "vw_allreduce.h"
 
 void add_float(float& c1, const float& c2) { c1 += c2; }
 
-void accumulate(vw& all, parameters& weights, size_t offset)
+void or_bits(uint64_t& c1, const uint64_t& c2) { c1 |= c2; }
+
+// Sums the values over all nodes like all_reduce, sending only the values nonzero on some node: the zeros add nothing.
+// The nodes first agree on which values those are with a bitmap, 32 times smaller than the values, so that models
+// whose weights are mostly untouched, such as with a large -b, are synchronized at a fraction of the traffic. Threads
+// share memory, for them the values are reduced in place.
+void all_reduce_nonzero(vw& all, float* values, uint64_t length)
 {
-  uint64_t length = UINT64_ONE << all.num_bits;  // This is size of gradient
-  float* local_grad = new float[length];
+  if (all.all_reduce_type == AllReduceType::Thread)
+  {
+    all_reduce<float, add_float>(all, values, length);
+    return;
+  }
 
-  if (weights.sparse)
-    for (uint64_t i = 0; i < length; i++)
-      local_grad[i] = (&(weights.sparse_weights[i << weights.sparse_weights.stride_shift()]))[offset];
+  std::vector<uint64_t> nonzero((length + 63) / 64, 0);
+  for (uint64_t i = 0; i < length; i++)
+    if (values[i] != 0.f) nonzero[i >> 6] |= UINT64_ONE << (i & 63);
+  all_reduce<uint64_t, or_bits>(all, nonzero.data(), nonzero.size());
+
+  std::vector<float> packed;
+  for (uint64_t i = 0; i < length; i++)
+    if (nonzero[i >> 6] & (UINT64_ONE << (i & 63))) packed.push_back(values[i]);
+  // The bitmaps agree, so either every node sends or none does.
+  if (packed.empty()) return;
+  all_reduce<float, add_float>(all, packed.data(), packed.size());
+
+  size_t next = 0;
+  for (uint64_t i = 0; i < length; i++)
+    if (nonzero[i >> 6] & (UINT64_ONE << (i & 63))) values[i] = packed[next++];
+}
+
+// Over sockets, the values of this many weights are sent at a time, while the next ones are copied out of the weights
+// and the previous ones copied back.
+constexpr uint64_t ACCUMULATE_CHUNK = UINT64_ONE << 20;
+
+// Sums the value in slot offset of each of the length weights over all nodes, and divides it by divisor. Copying the
+// values of large models, strided through the weights, takes about as long as sending them, so over sockets they are
+// reduced in chunks on another thread as they are copied.
+template <class T>
+void accumulate_slot(vw& all, T& weights, size_t offset, uint64_t length, float divisor)
+{
+  const uint64_t slot = offset * weights.slot_distance();
+  const uint32_t stride_shift = weights.stride_shift();
+  float* values = new float[length];
+  auto gather = [&](uint64_t begin, uint64_t end) {
+    for (uint64_t i = begin; i < end; i++) values[i] = (&(weights[i << stride_shift]))[slot];
+  };
+  auto scatter = [&](uint64_t begin, uint64_t end) {
+    for (uint64_t i = begin; i < end; i++) (&(weights[i << stride_shift]))[slot] = values[i] / divisor;
+  };
+
+  if (all.all_reduce_type == AllReduceType::Thread || length <= ACCUMULATE_CHUNK)
+  {
+    gather(0, length);
+    all_reduce_nonzero(all, values, length);
+    scatter(0, length);
+  }
   else
-    for (uint64_t i = 0; i < length; i++)
-      local_grad[i] = (&(weights.dense_weights[i << weights.dense_weights.stride_shift()]))[offset];
+  {
+    gather(0, ACCUMULATE_CHUNK);
+    for (uint64_t begin = 0; begin < length; begin += ACCUMULATE_CHUNK)
+    {
+      const uint64_t end = std::min(begin + ACCUMULATE_CHUNK, length);
+      auto reduced = std::async(std::launch::async, [&all, values, begin, end] {
+        all_reduce_nonzero(all, values + begin, end - begin);
+      });
+      if (begin > 0) scatter(begin - ACCUMULATE_CHUNK, begin);
+      if (end < length) gather(end, std::min(end + ACCUMULATE_CHUNK, length));
+      reduced.get();
+    }
+    scatter(length - 1 - (length - 1) % ACCUMULATE_CHUNK, length);
+  }
 
-  all_reduce<float, add_float>(all, local_grad, length);  // TODO: modify to not use first()
+  delete[] values;
+}
 
+void accumulate(vw& all, parameters& weights, size_t offset)
+{
+  uint64_t length = UINT64_ONE << all.num_bits;  // This is size of gradient
   if (weights.sparse)
-    for (uint64_t i = 0; i < length; i++)
-      (&(weights.sparse_weights[i << weights.sparse_weights.stride_shift()]))[offset] = local_grad[i];
+    accumulate_slot(all, weights.sparse_weights, offset, length, 1.f);
   else
-    for (uint64_t i = 0; i < length; i++)
-      (&(weights.dense_weights[i << weights.dense_weights.stride_shift()]))[offset] = local_grad[i];
-
-  delete[] local_grad;
+    accumulate_slot(all, weights.dense_weights, offset, length, 1.f);
 }
 
 float accumulate_scalar(vw& all, float local_sum)
@@ -48,27 +112,12 @@ float accumulate_scalar(vw& all, float local_sum)
 
 void accumulate_avg(vw& all, parameters& weights, size_t offset)
 {
-  uint32_t length = 1 << all.num_bits;  // This is size of gradient
+  uint64_t length = UINT64_ONE << all.num_bits;  // This is size of gradient
   float numnodes = (float)all.all_reduce->total;
-  float* local_grad = new float[length];
-
-  if (weights.sparse)
-    for (uint64_t i = 0; i < length; i++)
-      local_grad[i] = (&(weights.sparse_weights[i << weights.sparse_weights.stride_shift()]))[offset];
-  else
-    for (uint64_t i = 0; i < length; i++)
-      local_grad[i] = (&(weights.dense_weights[i << weights.dense_weights.stride_shift()]))[offset];
-
-  all_reduce<float, add_float>(all, local_grad, length);  // TODO: modify to not use first()
-
   if (weights.sparse)
-    for (uint64_t i = 0; i < length; i++)
-      (&(weights.sparse_weights[i << weights.sparse_weights.stride_shift()]))[offset] = local_grad[i] / numnodes;
+    accumulate_slot(all, weights.sparse_weights, offset, length, numnodes);
   else
-    for (uint64_t i = 0; i < length; i++)
-      (&(weights.dense_weights[i << weights.dense_weights.stride_shift()]))[offset] = local_grad[i] / numnodes;
-
-  delete[] local_grad;
+    accumulate_slot(all, weights.dense_weights, offset, length, numnodes);
 }
 
 float max_elem(float* arr, int length)
@@ -90,16 +139,17 @@ float min_elem(float* arr, int length)
 template <class T>
 void do_weighting(vw& all, uint64_t length, float* local_weights, T& weights)
 {
+  const uint64_t distance = weights.slot_distance();
   for (uint64_t i = 0; i < length; i++)
   {
     float* weight = &weights[i << weights.stride_shift()];
     if (local_weights[i] > 0)
     {
-      float ratio = weight[1] / local_weights[i];
+      float ratio = weight[distance] / local_weights[i];
       local_weights[i] = weight[0] * ratio;
       weight[0] *= ratio;
-      weight[1] *= ratio;                                               // A crude max
-      if (all.normalized_idx > 0) weight[all.normalized_idx] *= ratio;  // A crude max
+      weight[distance] *= ratio;                                                   // A crude max
+      if (all.normalized_idx > 0) weight[all.normalized_idx * distance] *= ratio;  // A crude max
     }
     else
     {
@@ -118,6 +168,7 @@ void accumulate_weighted_avg(vw& all, parameters& weights)
   }
 
   uint32_t length = 1 << all.num_bits;  // This is the number of parameters
+  uint64_t distance = weights.slot_distance();
   float* local_weights = new float[length];
 
   if (weights.sparse)
@@ -125,10 +176,10 @@ void accumulate_weighted_avg(vw& all, parameters& weights)
       local_weights[i] = (&(weights.sparse_weights[i << weights.sparse_weights.stride_shift()]))[1];
   else
     for (uint64_t i = 0; i < length; i++)
-      local_weights[i] = (&(weights.dense_weights[i << weights.dense_weights.stride_shift()]))[1];
+      local_weights[i] = (&(weights.dense_weights[i << weights.dense_weights.stride_shift()]))[distance];
 
   // First compute weights for averaging
-  all_reduce<float, add_float>(all, local_weights, length);
+  all_reduce_nonzero(all, local_weights, length);
 
   if (weights.sparse)
     do_weighting(all, length, local_weights, weights.sparse_weights);
@@ -138,7 +189,6 @@ void accumulate_weighted_avg(vw& all, parameters& weights)
   if (weights.sparse)
     std::cout << "sparse parameters not supported with parallel computation!" << std::endl;
   else
-    all_reduce<float, add_float>(
-        all, weights.dense_weights.first(), ((size_t)length) * (1ull << weights.stride_shift()));
+    all_reduce_nonzero(all, weights.dense_weights.first(), ((size_t)length) * (1ull << weights.stride_shift()));
   delete[] local_weights;
 }
@@ -7,6 +7,7 @@
 #include "v_array.h"
 #include "io_buf.h"
 #include "global_data.h"
+#include "text_format.h"
 
 namespace ACTION_SCORE
 {
@@ -14,19 +15,14 @@ void print_action_score(VW::io::writer* f, const v_array<action_score>& a_s, con
 {
   if (f == nullptr) { return; }
 
-  std::stringstream ss;
-
+  auto& line = VW::thread_text_line();
   for (size_t i = 0; i < a_s.size(); i++)
   {
-    if (i > 0) ss << ',';
-    ss << a_s[i].action << ':' << a_s[i].score;
+    if (i > 0) line.add(',');
+    line.add_uint(a_s[i].action).add(':').add_general(a_s[i].score);
   }
-  print_tag_by_ref(ss, tag);
-  ss << '\n';
-  const auto ss_str = ss.str();
-  ssize_t len = ss_str.size();
-  ssize_t t = f->write(ss_str.c_str(), (unsigned int)len);
-  if (t != len) std::cerr << "write error: " << VW::strerror_to_string(errno) << std::endl;
+  line.add_tag(tag).add('\n');
+  line.write_to(f);
 }
 
 void delete_action_scores(void* v)
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "io/io_adapter.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iterator>
 #include "v_array.h"
 
@@ -78,6 +80,19 @@ inline int score_comp(const void* p1, const void* p2)
 
 inline int reverse_order(const void* p1, const void* p2) { return score_comp(p2, p1); }
 
+// Sorts a_s by score_comp. With top_k below its size only the top_k lowest scores are sorted to its front, by partial
+// selection, and the others follow in an unspecified order.
+inline void sort_action_scores(action_scores& a_s, size_t top_k = 0)
+{
+  if (top_k == 0 || top_k >= a_s.size())
+  {
+    qsort((void*)a_s.begin(), a_s.size(), sizeof(action_score), score_comp);
+    return;
+  }
+  std::partial_sort(a_s.begin(), a_s.begin() + top_k, a_s.end(),
+      [](const action_score& s1, const action_score& s2) { return score_comp(&s1, &s2) < 0; });
+}
+
 void print_action_score(VW::io::writer* f, const v_array<action_score>& a_s, const v_array<char>&);
 
 void delete_action_scores(void* v);
@@ -47,16 +47,15 @@ float query_decision(active& a, float ec_revert_weight, float k)
 template <bool is_learn>
 void predict_or_learn_simulation(active& a, single_learner& base, example& ec)
 {
-  base.predict(ec);
-
   if (is_learn)
   {
     vw& all = *a.all;
 
+    const float sensitivity = base.predict_with_sensitivity(ec);
     float k = (float)all.sd->t;
     float threshold = 0.f;
 
-    ec.confidence = fabsf(ec.pred.scalar - threshold) / base.sensitivity(ec);
+    ec.confidence = fabsf(ec.pred.scalar - threshold) / sensitivity;
     float importance = query_decision(a, ec.confidence, k);
 
     if (importance > 0)
@@ -71,12 +70,83 @@ void predict_or_learn_simulation(active& a, single_learner& base, example& ec)
       ec.weight = 0.f;
     }
   }
+  else
+    base.predict(ec);
+}
+
+active::~active()
+{
+  for (auto& query : pending)
+  {
+    VW::dealloc_example(nullptr, *query.second);
+    free(query.second);
+  }
+}
+
+bool has_own_features(const example& ec)
+{
+  for (namespace_index i : ec.indices)
+    if (i != constant_namespace && ec.feature_space[i].size() > 0) return true;
+  return false;
+}
+
+void add_pending_query(active& a, example& ec)
+{
+  std::string tag(ec.tag.begin(), ec.tag.size());
+  auto found = a.pending_by_tag.find(tag);
+  if (found != a.pending_by_tag.end())
+  {
+    a.pending.splice(a.pending.end(), a.pending, found->second);
+    VW::copy_example_data(false, found->second->second, &ec);
+    return;
+  }
+
+  example* copy;
+  if (a.pending.size() < a.max_pending)
+    copy = VW::alloc_examples(1);
+  else
+  {
+    // The oldest query is given up on, its example reused.
+    copy = a.pending.front().second;
+    a.pending_by_tag.erase(a.pending.front().first);
+    a.pending.pop_front();
+  }
+  VW::copy_example_data(false, copy, &ec);
+  a.pending.emplace_back(tag, copy);
+  a.pending_by_tag[tag] = std::prev(a.pending.end());
+}
+
+// A labeled example of a pending tag and no features of its own is the answer to that query, it gets the features of
+// the queried example. Returns false when it answers a query given up on, or answered already.
+bool take_pending_query(active& a, example& ec)
+{
+  if (has_own_features(ec)) return true;
+
+  auto found = a.pending_by_tag.find(std::string(ec.tag.begin(), ec.tag.size()));
+  if (found == a.pending_by_tag.end()) return false;
+
+  example* query = found->second->second;
+  const float weight = ec.weight;
+  const uint64_t example_counter = ec.example_counter;
+  VW::copy_example_data(false, &ec, query);
+  ec.weight = weight;
+  ec.example_counter = example_counter;
+
+  VW::dealloc_example(nullptr, *query);
+  free(query);
+  a.pending.erase(found->second);
+  a.pending_by_tag.erase(found);
+  return true;
 }
 
 template <bool is_learn>
 void predict_or_learn_active(active& a, single_learner& base, example& ec)
 {
-  if (is_learn)
+  // A late answer, of no example any more, is not learned from.
+  bool learn = is_learn;
+  if (a.max_pending > 0 && is_learn && ec.l.simple.label != FLT_MAX) learn = take_pending_query(a, ec);
+
+  if (learn)
     base.learn(ec);
   else
     base.predict(ec);
@@ -114,6 +184,7 @@ void output_and_account_example(vw& all, active& a, example& ec)
 
   float ai = -1;
   if (ld.label == FLT_MAX) ai = query_decision(a, ec.confidence, (float)all.sd->weighted_unlabeled_examples);
+  if (ai > 0 && a.max_pending > 0 && ec.tag.size() > 0) add_pending_query(a, ec);
 
   all.print_by_ref(all.raw_prediction.get(), ec.partial_prediction, -1, ec.tag);
   for (auto& i : all.final_prediction_sink) { active_print_result(i.get(), ec.pred.scalar, ai, ec.tag); }
@@ -138,7 +209,11 @@ base_learner* active_setup(options_i& options, vw& all)
       .add(make_option("simulation", simulation).help("active learning simulation mode"))
       .add(make_option("mellowness", data->active_c0)
                .default_value(8.f)
-               .help("active learning mellowness parameter c_0. Default 8"));
+               .help("active learning mellowness parameter c_0. Default 8"))
+      .add(make_option("pending_queries", data->max_pending)
+               .default_value(0)
+               .help("keep the features of this many queried examples with a tag, so that a label can come back as "
+                     "an example of that tag and no features"));
 
   if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
 
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <list>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include "reductions_fwd.h"
 
 struct rand_state;
@@ -14,6 +17,14 @@ struct active
   float active_c0;
   vw* all;  // statistics, loss
   std::shared_ptr<rand_state> _random_state;
+
+  // With --pending_queries, the features of the last queried examples, keyed by their tags, so that their labels can
+  // come back later as examples of a tag and no features, in any order. The oldest are dropped past max_pending.
+  size_t max_pending;
+  std::list<std::pair<std::string, example*>> pending;
+  std::unordered_map<std::string, std::list<std::pair<std::string, example*>>::iterator> pending_by_tag;
+
+  ~active();
 };
 
 VW::LEARNER::base_learner* active_setup(VW::config::options_i& options, vw& all);
@@ -9,6 +9,7 @@
 #include <cstring>
 #include <cerrno>
 #include <cstdlib>
+#include <deque>
 #ifdef _WIN32
 #  define NOMINMAX
 #  include <WinSock2.h>
@@ -72,6 +73,28 @@ int recvall(int s, char* buf, int n)
   return total;
 }
 
+void send_label(int s, const std::string& line)
+{
+  int ret = send(s, line.c_str(), line.size(), 0);
+  if (ret < 0)
+  {
+    const char* msg = "Could not send labeled data!";
+    cerr << msg << endl;
+    throw std::runtime_error(msg);
+  }
+  char buf[256];
+  ret = recvall(s, buf, 256);
+  if (ret < 0)
+  {
+    const char* msg = "Could not receive predictions!";
+    cerr << msg << endl;
+    throw std::runtime_error(msg);
+  }
+}
+
+// usage: active_interactor [host [port [delay]]]
+// With a delay, the label of a query is sent back once delay more examples have been sent, as an example of its tag
+// and no features, which a daemon started with --pending_queries of delay or more learns from. The examples need a tag.
 int main(int argc, char* argv[])
 {
   char buf[256];
@@ -86,6 +109,9 @@ int main(int argc, char* argv[])
   if (argc > 1) { host = argv[1]; }
   if (argc > 2) { port = atoi(argv[2]); }
   if (port <= 1024 || port == (unsigned short)(~0u)) { port = 26542; }
+  size_t delay = 0;
+  if (argc > 3) { delay = atoi(argv[3]); }
+  std::deque<std::string> labels;
 
   s = open_socket(host, port);
   size_t id = 0;
@@ -126,26 +152,23 @@ int main(int argc, char* argv[])
     if (itok == nullptr || itok[0] == '\0') { continue; }
 
     queries += 1;
+    if (delay > 0)
+    {
+      labels.push_back(line.substr(0, sp + 1 - cstr) + itok + " '" + tag + " |\n");
+      if (labels.size() > delay)
+      {
+        send_label(s, labels.front());
+        labels.pop_front();
+      }
+      continue;
+    }
+
     std::string imp = std::string(itok) + " " + tag + " |";
     pos = line.find_first_of('|');
     line.replace(pos, 1, imp);
-    cstr = line.c_str();
-    len = line.size();
-    ret = send(s, cstr, len, 0);
-    if (ret < 0)
-    {
-      const char* msg = "Could not send labeled data!";
-      cerr << msg << endl;
-      throw std::runtime_error(msg);
-    }
-    ret = recvall(s, buf, 256);
-    if (ret < 0)
-    {
-      const char* msg = "Could not receive predictions!";
-      cerr << msg << endl;
-      throw std::runtime_error(msg);
-    }
+    send_label(s, line);
   }
+  for (const std::string& label : labels) send_label(s, label);
   close(s);
   std::cout << "Went through the data by doing " << queries << " queries" << endl;
   return 0;
@@ -0,0 +1,113 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "allocation_profiler.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+namespace VW
+{
+const char* to_string(allocation_site site)
+{
+  switch (site)
+  {
+    case allocation_site::other:
+      return "other";
+    case allocation_site::parser:
+      return "parser";
+    case allocation_site::reduction:
+      return "reduction";
+    case allocation_site::output:
+      return "output";
+    default:
+      return "unknown";
+  }
+}
+
+const char* to_string(allocation_mechanism mechanism)
+{
+  switch (mechanism)
+  {
+    case allocation_mechanism::calloc_or_throw:
+      return "calloc_or_throw";
+    case allocation_mechanism::v_array:
+      return "v_array";
+    case allocation_mechanism::object_pool:
+      return "object_pool";
+    case allocation_mechanism::new_:
+      return "new";
+    default:
+      return "unknown";
+  }
+}
+
+std::vector<allocation_statistics> allocation_counts()
+{
+  std::vector<allocation_statistics> counts;
+  for (size_t s = 0; s < static_cast<size_t>(allocation_site::count); s++)
+    for (size_t m = 0; m < static_cast<size_t>(allocation_mechanism::count); m++)
+    {
+      const auto site = static_cast<allocation_site>(s);
+      const auto mechanism = static_cast<allocation_mechanism>(m);
+      const auto& counter = allocation_counter_of(site, mechanism);
+      const uint64_t allocations = counter.allocations.load(std::memory_order_relaxed);
+      if (allocations > 0)
+        counts.push_back({site, mechanism, allocations, counter.bytes.load(std::memory_order_relaxed)});
+    }
+  return counts;
+}
+
+void report_allocations(std::ostream& out, uint64_t examples)
+{
+  const auto counts = allocation_counts();
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  const double per_example = examples > 0 ? 1. / examples : 0.;
+
+  out << "allocations of " << examples << " examples:" << std::endl;
+  out << std::left << std::setw(11) << "site" << std::setw(17) << "mechanism" << std::right << std::setw(12)
+      << "allocations" << std::setw(16) << "bytes" << std::setw(14) << "allocs/ex" << std::setw(14) << "bytes/ex"
+      << std::endl;
+  out << std::fixed << std::setprecision(2);
+  for (const auto& count : counts)
+  {
+    out << std::left << std::setw(11) << to_string(count.site) << std::setw(17) << to_string(count.mechanism)
+        << std::right << std::setw(12) << count.allocations << std::setw(16) << count.bytes << std::setw(14)
+        << count.allocations * per_example << std::setw(14) << count.bytes * per_example << std::endl;
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+}  // namespace VW
+
+#ifdef VW_PROFILE_ALLOCATIONS
+// What is allocated with new, the std::vector of labels and the containers of the reductions among it, is counted as
+// the mechanism of the thread, object_pool when a pool is growing and new otherwise.
+namespace
+{
+void* counted_malloc(std::size_t size)
+{
+  VW::count_allocation(VW::current_new_mechanism(), size);
+  return std::malloc(size == 0 ? 1 : size);
+}
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+  void* p = counted_malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
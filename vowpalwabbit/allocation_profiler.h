@@ -0,0 +1,140 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// The allocations of a run by where they were made from and how, counted in builds configured with
+// -DPROFILE_ALLOCATIONS=On, which defines VW_PROFILE_ALLOCATIONS, and reported per example at the end of the run.
+// The hooks are in this header so that v_array, calloc_or_throw and object_pool count what they allocate in any
+// library which includes them. Without VW_PROFILE_ALLOCATIONS nothing counts and the macros are empty.
+namespace VW
+{
+// What the thread was doing when it allocated.
+enum class allocation_site : uint8_t
+{
+  other,      // setting up, loading and saving models, and anything not below
+  parser,     // reading, parsing and setting up examples
+  reduction,  // learn and predict of the reductions
+  output,     // finish_example, which writes the predictions and updates the progress
+  count
+};
+
+// How it allocated.
+enum class allocation_mechanism : uint8_t
+{
+  calloc_or_throw,
+  v_array,      // v_array::resize
+  object_pool,  // the chunks of the example pools, with what the examples allocate as they are made
+  new_,         // operator new, e.g. std::vector in labels
+  count
+};
+
+const char* to_string(allocation_site site);
+const char* to_string(allocation_mechanism mechanism);
+
+struct allocation_counter
+{
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> bytes{0};
+};
+
+// The counter of each site and mechanism, for the whole process.
+inline allocation_counter& allocation_counter_of(allocation_site site, allocation_mechanism mechanism)
+{
+  static allocation_counter counters[static_cast<size_t>(allocation_site::count)]
+                                    [static_cast<size_t>(allocation_mechanism::count)];
+  return counters[static_cast<size_t>(site)][static_cast<size_t>(mechanism)];
+}
+
+struct allocation_statistics
+{
+  allocation_site site;
+  allocation_mechanism mechanism;
+  uint64_t allocations;
+  uint64_t bytes;
+};
+
+// The counters which counted anything, by site then mechanism.
+std::vector<allocation_statistics> allocation_counts();
+// The counters per example of the examples processed, by site then mechanism.
+void report_allocations(std::ostream& out, uint64_t examples);
+}  // namespace VW
+
+// The hooks use thread_local, which the managed code of the C# bindings cannot, and so are only there when counting.
+#ifdef VW_PROFILE_ALLOCATIONS
+namespace VW
+{
+// The site the current thread allocates for.
+inline allocation_site& current_allocation_site()
+{
+  static thread_local allocation_site site = allocation_site::other;
+  return site;
+}
+
+// What operator new is counted as on the current thread, new_ unless an object pool is growing.
+inline allocation_mechanism& current_new_mechanism()
+{
+  static thread_local allocation_mechanism mechanism = allocation_mechanism::new_;
+  return mechanism;
+}
+
+inline void count_allocation(allocation_mechanism mechanism, size_t bytes)
+{
+  auto& counter = allocation_counter_of(current_allocation_site(), mechanism);
+  counter.allocations.fetch_add(1, std::memory_order_relaxed);
+  counter.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// Attributes the allocations of the thread to a site for the life of the scope.
+class allocation_site_scope
+{
+  allocation_site _previous;
+
+public:
+  explicit allocation_site_scope(allocation_site site) : _previous(current_allocation_site())
+  {
+    current_allocation_site() = site;
+  }
+  ~allocation_site_scope() { current_allocation_site() = _previous; }
+
+  allocation_site_scope(const allocation_site_scope&) = delete;
+  allocation_site_scope& operator=(const allocation_site_scope&) = delete;
+};
+
+// Counts operator new as another mechanism for the life of the scope.
+class allocation_mechanism_scope
+{
+  allocation_mechanism _previous;
+
+public:
+  explicit allocation_mechanism_scope(allocation_mechanism mechanism) : _previous(current_new_mechanism())
+  {
+    current_new_mechanism() = mechanism;
+  }
+  ~allocation_mechanism_scope() { current_new_mechanism() = _previous; }
+
+  allocation_mechanism_scope(const allocation_mechanism_scope&) = delete;
+  allocation_mechanism_scope& operator=(const allocation_mechanism_scope&) = delete;
+};
+}  // namespace VW
+
+#  define VW_ALLOCATION_CONCAT_(a, b) a##b
+#  define VW_ALLOCATION_CONCAT(a, b) VW_ALLOCATION_CONCAT_(a, b)
+#  define VW_ALLOCATION_SITE(site) \
+    VW::allocation_site_scope VW_ALLOCATION_CONCAT(allocation_site_, __LINE__)(VW::allocation_site::site)
+#  define VW_ALLOCATION_MECHANISM(mechanism)                                    \
+    VW::allocation_mechanism_scope VW_ALLOCATION_CONCAT(allocation_mechanism_, \
+        __LINE__)(VW::allocation_mechanism::mechanism)
+#  define VW_COUNT_ALLOCATION(mechanism, bytes) VW::count_allocation(VW::allocation_mechanism::mechanism, bytes)
+#else
+#  define VW_ALLOCATION_SITE(site)
+#  define VW_ALLOCATION_MECHANISM(mechanism)
+#  define VW_COUNT_ALLOCATION(mechanism, bytes)
+#endif
@@ -7,6 +7,8 @@
 
 #include <string>
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #ifdef _WIN32
 #  define NOMINMAX
@@ -24,10 +26,6 @@ namespace std
 // forward declare promise as C++/CLI doesn't allow usage in header files
 template <typename T>
 class promise;
-
-class condition_variable;
-
-class mutex;
 }  // namespace std
 #else
 #  include <sys/socket.h>
@@ -43,6 +41,7 @@ typedef int socket_t;
 #  define CLOSESOCK close
 #  include <future>
 #endif
+#include "allreduce_transport.h"
 #include "vw_exception.h"
 #include "vwvis.h"
 #include <cassert>
@@ -54,13 +53,19 @@ struct node_socks
   std::string current_master;
   socket_t parent;
   socket_t children[2];
+  // The neighbours of the node in the ring, connected the first time a payload goes around it
+  socket_t ring_next = static_cast<socket_t>(-1);
+  socket_t ring_prev = static_cast<socket_t>(-1);
+  const VW::allreduce_transport* transport = nullptr;  // that the sockets were opened with
   ~node_socks()
   {
     if (current_master != "")
     {
-      if (parent != -1) CLOSESOCK(this->parent);
-      if (children[0] != -1) CLOSESOCK(this->children[0]);
-      if (children[1] != -1) CLOSESOCK(this->children[1]);
+      if (parent != -1) transport->close(this->parent);
+      if (children[0] != -1) transport->close(this->children[0]);
+      if (children[1] != -1) transport->close(this->children[1]);
+      if (ring_next != -1) transport->close(this->ring_next);
+      if (ring_prev != -1) transport->close(this->ring_prev);
     }
   }
   node_socks() { current_master = ""; }
@@ -93,21 +98,18 @@ struct Data
   size_t length;
 };
 
+struct spin_barrier;
+
 class AllReduceSync
 {
 private:
-  std::mutex* m_mutex;
-  std::condition_variable* m_cv;
+  // A sense-reversing barrier the threads spin on, which is defined with the atomics it needs in allreduce_threads.cc
+  // as C++/CLI doesn't allow them in header files.
+  spin_barrier* m_barrier;
 
   // total number of threads we wait for
   size_t m_total;
 
-  // number of threads reached the barrier
-  uint32_t m_count;
-
-  // current wait-barrier-run required to protect against spurious wakeups of m_cv->wait(...)
-  bool m_run;
-
 public:
   AllReduceSync(const size_t total);
 
@@ -116,6 +118,7 @@ public:
   void waitForSynchronization();
 
   void** buffers;
+  size_t* numa_nodes;  // of each thread at its first allreduce
 };
 
 class AllReduceThreads : public AllReduce
@@ -124,6 +127,37 @@ private:
   AllReduceSync* m_sync;
   bool m_syncOwner;
 
+  // The threads on the NUMA node of this one, in order, and the first thread of every NUMA node, found at the first
+  // allreduce.
+  std::vector<size_t> m_group;
+  std::vector<size_t> m_leaders;
+  size_t m_rank;  // of this thread in m_group
+
+  void find_groups();
+
+  // The part of n elements the rank-th of count threads works on.
+  static void slice(size_t rank, size_t count, size_t n, size_t& begin, size_t& end)
+  {
+    size_t blockSize = n / count;
+    if (blockSize == 0)
+    {
+      if (rank < n)
+      {
+        begin = rank;
+        end = rank + 1;
+      }
+      else
+      {  // more threads than bytes --> don't do any work
+        begin = end = 0;
+      }
+    }
+    else
+    {
+      begin = rank * blockSize;
+      end = rank == count - 1 ? n : (rank + 1) * blockSize;
+    }
+  }
+
 public:
   AllReduceThreads(AllReduceThreads* root, const size_t ptotal, const size_t pnode, bool quiet = false);
 
@@ -136,40 +170,62 @@ public:
   {  // register buffer
     T** buffers = (T**)m_sync->buffers;
     buffers[node] = buffer;
-    m_sync->waitForSynchronization();
+    if (m_leaders.empty())
+      find_groups();
+    else
+      m_sync->waitForSynchronization();
 
-    size_t blockSize = n / total;
     size_t index;
     size_t end;
 
-    if (blockSize == 0)
+    if (m_leaders.size() == 1 || m_leaders.size() == total)
     {
-      if (node < n)
-      {
-        index = node;
-        end = node + 1;
-      }
-      else
-      {  // more threads than bytes --> don't do any work
-        index = end = 0;
+      slice(node, total, n, index, end);
+      for (; index < end; index++)
+      {  // Perform transposed AllReduce to help data locallity
+        T& first = buffers[0][index];
+
+        for (size_t i = 1; i < total; i++) f(first, buffers[i][index]);
+
+        // Broadcast back
+        for (size_t i = 1; i < total; i++) buffers[i][index] = first;
       }
-    }
-    else
-    {
-      index = node * blockSize;
-      end = node == total - 1 ? n : (node + 1) * blockSize;
-    }
 
-    for (; index < end; index++)
-    {  // Perform transposed AllReduce to help data locallity
-      T& first = buffers[0][index];
+      m_sync->waitForSynchronization();
+      return;
+    }
 
-      for (size_t i = 1; i < total; i++) f(first, buffers[i][index]);
+    // Across several NUMA nodes, the threads of each node first add up the buffers of their node into the buffer of
+    // its first thread, so only one buffer per node is read from the other nodes.
+    T* leader = buffers[m_group[0]];
+    slice(m_rank, m_group.size(), n, index, end);
+    for (size_t i = index; i < end; i++)
+      for (size_t k = 1; k < m_group.size(); k++) f(leader[i], buffers[m_group[k]][i]);
+    m_sync->waitForSynchronization();
 
-      // Broadcast back
-      for (size_t i = 1; i < total; i++) buffers[i][index] = first;
+    slice(node, total, n, index, end);
+    for (; index < end; index++)
+    {
+      T& first = buffers[m_leaders[0]][index];
+      for (size_t g = 1; g < m_leaders.size(); g++) f(first, buffers[m_leaders[g]][index]);
+      for (size_t g = 1; g < m_leaders.size(); g++) buffers[m_leaders[g]][index] = first;
     }
+    m_sync->waitForSynchronization();
+
+    slice(m_rank, m_group.size(), n, index, end);
+    for (size_t k = 1; k < m_group.size(); k++) std::copy(leader + index, leader + end, buffers[m_group[k]] + index);
+    m_sync->waitForSynchronization();
+  }
 
+  // Copies the buffer of the first thread into those of the others.
+  template <class T>
+  void broadcast(T* buffer, const size_t n)
+  {
+    T** buffers = (T**)m_sync->buffers;
+    buffers[node] = buffer;
+    m_sync->waitForSynchronization();
+    if (node != 0) std::copy(buffers[0], buffers[0] + n, buffer);
+    // the first thread must not change its buffer before the others read it
     m_sync->waitForSynchronization();
   }
 };
@@ -180,9 +236,21 @@ private:
   node_socks socks;
   std::string span_server;
   int port;
-  size_t unique_id;  // unique id for each node in the network, id == 0 means extra io.
+  size_t unique_id;   // unique id for each node in the network, id == 0 means extra io.
+  size_t ring_bytes;  // payloads of at least this many bytes go around the ring, 0 if none do
+  uint32_t local_ip;  // as seen when connecting to the span server, in network order
+  const VW::allreduce_transport* net;  // between the nodes, the span server is reached over TCP
+  float timeout;                       // seconds to wait for another node before giving up on it, 0 waits forever
 
   void all_reduce_init();
+  void ring_init();
+  socket_t listen_on(short unsigned int& netport, int backlog);
+
+  static void or_address(uint64_t& c1, const uint64_t& c2) { c1 |= c2; }
+
+  // Waits until one of the sockets in readable or writable is ready. A node that went silent for timeout seconds is
+  // taken to be lost, so the job fails with it instead of every other node hanging.
+  void wait_for(socket_t max_fd, fd_set* readable, fd_set* writable, const char* waiting_on);
 
   template <class T>
   void pass_up(char* buffer, size_t left_read_pos, size_t right_read_pos, size_t& parent_sent_pos)
@@ -192,7 +260,7 @@ private:
 
     if (my_bufsize > 0)
     {  // going to pass up this chunk of data to the parent
-      int write_size = send(socks.parent, buffer + parent_sent_pos, (int)my_bufsize, 0);
+      int write_size = net->send(socks.parent, buffer + parent_sent_pos, (int)my_bufsize);
       if (write_size < 0)
         THROW("Write to parent failed " << my_bufsize << " " << write_size << " " << parent_sent_pos << " "
                                         << left_read_pos << " " << right_read_pos);
@@ -228,7 +296,7 @@ private:
 
       if (child_read_pos[0] < n || child_read_pos[1] < n)
       {
-        if (max_fd > 0 && select((int)max_fd, &fds, nullptr, nullptr, nullptr) == -1) THROWERRNO("select");
+        if (max_fd > 0) wait_for(max_fd, &fds, nullptr, "children");
 
         for (int i = 0; i < 2; i++)
         {
@@ -239,8 +307,9 @@ private:
                   << FD_ISSET(socks.children[0], &fds) << " " << FD_ISSET(socks.children[1], &fds));
 
             size_t count = std::min(ar_buf_size, n - child_read_pos[i]);
-            int read_size = recv(socks.children[i], &child_read_buf[i][child_unprocessed[i]], (int)count, 0);
+            int read_size = net->recv(socks.children[i], &child_read_buf[i][child_unprocessed[i]], (int)count);
             if (read_size == -1) THROWERRNO("recv from child");
+            if (read_size == 0) THROW("child " << i << " closed the connection, the node may have failed");
 
             addbufs<T, f>((T*)buffer + child_read_pos[i] / sizeof(T), (T*)child_read_buf[i],
                 (child_read_pos[i] + read_size) / sizeof(T) - child_read_pos[i] / sizeof(T));
@@ -268,13 +337,56 @@ private:
   void pass_down(char* buffer, const size_t parent_read_pos, size_t& children_sent_pos);
   void broadcast(char* buffer, const size_t n);
 
-  socket_t sock_connect(const uint32_t ip, const int port);
-  socket_t getsock();
+  // Sends out_bytes to the next node in the ring while receiving in_bytes from the previous one.
+  void ring_exchange(const char* out, size_t out_bytes, char* in, size_t in_bytes);
+
+  // Reduce-scatter then allgather around the ring: each step every node sends one total-th of the payload to the next
+  // node, so the traffic of any node is about twice the payload whatever the number of nodes, where the root of the
+  // tree receives and sends it twice per child and every node waits for the deepest leaf.
+  template <class T, void (*f)(T&, const T&)>
+  void ring_all_reduce(T* buffer, const size_t n)
+  {
+    if (socks.ring_next == -1) ring_init();
+
+    auto chunk_begin = [&](size_t chunk) { return chunk * n / total; };
+    auto chunk_size = [&](size_t chunk) { return chunk_begin(chunk + 1) - chunk_begin(chunk); };
+    std::vector<T> incoming(n / total + 1);
+
+    // After these steps, the node holds the sum of chunk node + 1 over all nodes.
+    for (size_t step = 0; step + 1 < total; step++)
+    {
+      const size_t sent = (node + total - step) % total;
+      const size_t received = (node + 2 * total - step - 1) % total;
+      ring_exchange((const char*)(buffer + chunk_begin(sent)), chunk_size(sent) * sizeof(T), (char*)incoming.data(),
+          chunk_size(received) * sizeof(T));
+      addbufs<T, f>(buffer + chunk_begin(received), incoming.data(), chunk_size(received));
+    }
+
+    // Which are passed around until every node holds all of them.
+    for (size_t step = 0; step + 1 < total; step++)
+    {
+      const size_t sent = (node + 1 + total - step) % total;
+      const size_t received = (node + total - step) % total;
+      ring_exchange((const char*)(buffer + chunk_begin(sent)), chunk_size(sent) * sizeof(T),
+          (char*)(buffer + chunk_begin(received)), chunk_size(received) * sizeof(T));
+    }
+  }
+
+  socket_t sock_connect(const uint32_t ip, const int port, const VW::allreduce_transport& transport);
+  socket_t getsock(const VW::allreduce_transport& transport);
 
 public:
   AllReduceSockets(std::string pspan_server, const int pport, const size_t punique_id, size_t ptotal,
-      const size_t pnode, bool pquiet)
-      : AllReduce(ptotal, pnode, pquiet), span_server(pspan_server), port(pport), unique_id(punique_id)
+      const size_t pnode, bool pquiet, size_t pring_bytes = 0,
+      const VW::allreduce_transport& ptransport = VW::tcp_transport(), float ptimeout = 0.f)
+      : AllReduce(ptotal, pnode, pquiet)
+      , span_server(pspan_server)
+      , port(pport)
+      , unique_id(punique_id)
+      , ring_bytes(pring_bytes)
+      , local_ip(0)
+      , net(&ptransport)
+      , timeout(ptimeout)
   {
   }
 
@@ -284,7 +396,42 @@ public:
   void all_reduce(T* buffer, const size_t n)
   {
     if (span_server != socks.current_master) all_reduce_init();
+    if (ring_bytes > 0 && total > 1 && n * sizeof(T) >= ring_bytes)
+    {
+      ring_all_reduce<T, f>(buffer, n);
+      return;
+    }
     reduce<T, f>((char*)buffer, n * sizeof(T));
     broadcast((char*)buffer, n * sizeof(T));
   }
 };
+
+// Allreduce over the nodes of a job of which several run in one process, a Spark executor running several tasks for
+// instance. The nodes of a process first reduce in shared memory, then the first of them reduces with the first nodes
+// of the other processes over sockets, and hands the result back to the others, so that each process sends the payload
+// once instead of once per node.
+class AllReduceHierarchical : public AllReduce
+{
+private:
+  std::shared_ptr<AllReduceThreads> m_root;  // the memory the nodes of the process share, as long as one of them lives
+  AllReduceThreads m_local;
+  std::unique_ptr<AllReduceSockets> m_remote;  // of the first node of the process only
+
+public:
+  // The job has ptotal nodes, pnode is the number of this one. The process runs plocal_total of them, this one is its
+  // plocal_node-th, and the process is the pspan_node-th of the pspan_total processes of the spanning tree.
+  AllReduceHierarchical(const std::string& pspan_server, const int pport, const size_t punique_id, size_t ptotal,
+      const size_t pnode, const size_t plocal_total, const size_t plocal_node, const size_t pspan_total,
+      const size_t pspan_node, bool pquiet, size_t pring_bytes = 0,
+      const VW::allreduce_transport& ptransport = VW::tcp_transport(), float ptimeout = 0.f);
+
+  virtual ~AllReduceHierarchical() = default;
+
+  template <class T, void (*f)(T&, const T&)>
+  void all_reduce(T* buffer, const size_t n)
+  {
+    m_local.all_reduce<T, f>(buffer, n);
+    if (m_remote) m_remote->all_reduce<T, f>(buffer, n);
+    m_local.broadcast(buffer, n);
+  }
+};
@@ -0,0 +1,63 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+/*
+This implements the allreduce function over threads then sockets.
+*/
+#include "allreduce.h"
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+// The nodes of a process of a job are those of the same node of the spanning tree.
+std::string job_key(const std::string& span_server, int port, size_t unique_id, size_t span_node)
+{
+  std::stringstream job;
+  job << span_server << ':' << port << '/' << unique_id << '/' << span_node;
+  return job.str();
+}
+
+// The shared memory of the nodes of a process of a job, made by the first of them to start.
+std::shared_ptr<AllReduceThreads> process_root(const std::string& job, size_t local_total, bool quiet)
+{
+  static std::mutex roots_lock;
+  static std::map<std::string, std::weak_ptr<AllReduceThreads>> roots;
+
+  std::lock_guard<std::mutex> lock(roots_lock);
+  std::shared_ptr<AllReduceThreads> root = roots[job].lock();
+  if (root == nullptr)
+  {
+    root = std::make_shared<AllReduceThreads>(local_total, 0, quiet);
+    roots[job] = root;
+  }
+  else if (root->total != local_total)
+    THROW("the nodes of job " << job << " in this process disagree on --local_total: " << root->total << " and "
+                              << local_total);
+
+  // forget the jobs that are done
+  for (auto it = roots.begin(); it != roots.end();)
+  {
+    if (it->second.expired())
+      it = roots.erase(it);
+    else
+      ++it;
+  }
+  return root;
+}
+}  // namespace
+
+AllReduceHierarchical::AllReduceHierarchical(const std::string& pspan_server, const int pport,
+    const size_t punique_id, size_t ptotal, const size_t pnode, const size_t plocal_total, const size_t plocal_node,
+    const size_t pspan_total, const size_t pspan_node, bool pquiet, size_t pring_bytes,
+    const VW::allreduce_transport& ptransport, float ptimeout)
+    : AllReduce(ptotal, pnode, pquiet)
+    , m_root(process_root(job_key(pspan_server, pport, punique_id, pspan_node), plocal_total, pquiet))
+    , m_local(m_root.get(), plocal_total, plocal_node, pquiet)
+{
+  if (plocal_node == 0)
+    m_remote.reset(new AllReduceSockets(pspan_server, pport, punique_id, pspan_total, pspan_node, pquiet, pring_bytes,
+        ptransport, ptimeout));
+}
@@ -33,9 +33,9 @@ using std::cerr;
 using std::endl;
 
 // port is already in network order
-socket_t AllReduceSockets::sock_connect(const uint32_t ip, const int port)
+socket_t AllReduceSockets::sock_connect(const uint32_t ip, const int port, const VW::allreduce_transport& transport)
 {
-  socket_t sock = socket(PF_INET, SOCK_STREAM, 0);
+  socket_t sock = transport.open();
   if (sock == -1) THROWERRNO("socket");
 
   sockaddr_in far_end;
@@ -59,7 +59,7 @@ socket_t AllReduceSockets::sock_connect(const uint32_t ip, const int port)
 
   size_t count = 0;
   int ret;
-  while ((ret = connect(sock, (sockaddr*)&far_end, sizeof(far_end))) == -1 && count < 100)
+  while ((ret = transport.connect(sock, (sockaddr*)&far_end, sizeof(far_end))) == -1 && count < 100)
   {
     count++;
     std::stringstream msg;
@@ -78,21 +78,16 @@ socket_t AllReduceSockets::sock_connect(const uint32_t ip, const int port)
   return sock;
 }
 
-socket_t AllReduceSockets::getsock()
+socket_t AllReduceSockets::getsock(const VW::allreduce_transport& transport)
 {
-  socket_t sock = socket(PF_INET, SOCK_STREAM, 0);
-#ifdef _WIN32
-  if (sock == INVALID_SOCKET)
-#else
-  if (sock < 0)
-#endif
-    THROWERRNO("socket");
+  socket_t sock = transport.open();
+  if (sock == -1) THROWERRNO("socket");
 
     // SO_REUSEADDR will allow port rebinding on Windows, causing multiple instances
     // of VW on the same machine to potentially contact the wrong tree node.
 #ifndef _WIN32
   int on = 1;
-  if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (char*)&on, sizeof(on)) < 0)
+  if (transport.set_option(sock, SOL_SOCKET, SO_REUSEADDR, (char*)&on, sizeof(on)) < 0)
   {
     if (!quiet) cerr << "setsockopt SO_REUSEADDR: " << VW::strerror_to_string(errno) << endl;
   }
@@ -100,7 +95,7 @@ socket_t AllReduceSockets::getsock()
 
   // Enable TCP Keep Alive to prevent socket leaks
   int enableTKA = 1;
-  if (setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (char*)&enableTKA, sizeof(enableTKA)) < 0)
+  if (transport.set_option(sock, SOL_SOCKET, SO_KEEPALIVE, (char*)&enableTKA, sizeof(enableTKA)) < 0)
   {
     if (!quiet) cerr << "setsockopt SO_KEEPALIVE: " << VW::strerror_to_string(errno) << endl;
   }
@@ -108,6 +103,49 @@ socket_t AllReduceSockets::getsock()
   return sock;
 }
 
+// Binds sock to the first free port from netport on, and listens on it.
+socket_t AllReduceSockets::listen_on(short unsigned int& netport, int backlog)
+{
+  socket_t sock = getsock(*net);
+  sockaddr_in address;
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = netport;
+
+  bool listening = false;
+  while (!listening)
+  {
+    if (net->bind(sock, (sockaddr*)&address, sizeof(address)) < 0)
+    {
+#ifdef _WIN32
+      if (WSAGetLastError() == WSAEADDRINUSE)
+#else
+      if (errno == EADDRINUSE)
+#endif
+      {
+        netport = htons(ntohs(netport) + 1);
+        address.sin_port = netport;
+      }
+      else
+        THROWERRNO("bind");
+    }
+    else
+    {
+      if (net->listen(sock, backlog) < 0)
+      {
+        if (!quiet) cerr << "listen: " << VW::strerror_to_string(errno) << endl;
+        net->close(sock);
+        sock = getsock(*net);
+      }
+      else
+      {
+        listening = true;
+      }
+    }
+  }
+  return sock;
+}
+
 void AllReduceSockets::all_reduce_init()
 {
 #ifdef _WIN32
@@ -122,9 +160,27 @@ void AllReduceSockets::all_reduce_init()
 
   socks.current_master = span_server;
 
+  // Without an RDMA device every node falls back to TCP alike.
+  socket_t probe = net->open();
+  if (probe == -1 && net != &VW::tcp_transport())
+  {
+    if (!quiet) cerr << "warning: " << net->name << " is not available, using tcp between the nodes" << endl;
+    net = &VW::tcp_transport();
+  }
+  else if (probe != -1)
+    net->close(probe);
+  socks.transport = net;
+
   uint32_t master_ip = *((uint32_t*)master->h_addr);
 
-  socket_t master_sock = sock_connect(master_ip, htons((u_short)port));
+  socket_t master_sock = sock_connect(master_ip, htons((u_short)port), VW::tcp_transport());
+  {
+    // The address the other nodes reach this one at, for the ring.
+    sockaddr_in local_address;
+    socklen_t size = sizeof(local_address);
+    if (getsockname(master_sock, (sockaddr*)&local_address, &size) < 0) THROWERRNO("getsockname");
+    local_ip = local_address.sin_addr.s_addr;
+  }
   if (send(master_sock, (const char*)&unique_id, sizeof(unique_id), 0) < (int)sizeof(unique_id))
   { THROW("write unique_id=" << unique_id << " to span server failed"); }
   else
@@ -164,46 +220,7 @@ void AllReduceSockets::all_reduce_init()
 
   auto sock = static_cast<socket_t>(-1);
   short unsigned int netport = htons(26544);
-  if (kid_count > 0)
-  {
-    sock = getsock();
-    sockaddr_in address;
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = htonl(INADDR_ANY);
-    address.sin_port = netport;
-
-    bool listening = false;
-    while (!listening)
-    {
-      if (::bind(sock, (sockaddr*)&address, sizeof(address)) < 0)
-      {
-#ifdef _WIN32
-        if (WSAGetLastError() == WSAEADDRINUSE)
-#else
-        if (errno == EADDRINUSE)
-#endif
-        {
-          netport = htons(ntohs(netport) + 1);
-          address.sin_port = netport;
-        }
-        else
-          THROWERRNO("bind");
-      }
-      else
-      {
-        if (listen(sock, kid_count) < 0)
-        {
-          if (!quiet) cerr << "listen: " << VW::strerror_to_string(errno) << endl;
-          CLOSESOCK(sock);
-          sock = getsock();
-        }
-        else
-        {
-          listening = true;
-        }
-      }
-    }
-  }
+  if (kid_count > 0) { sock = listen_on(netport, kid_count); }
 
   if (send(master_sock, (const char*)&netport, sizeof(netport), 0) < (int)sizeof(netport))
     THROW("write netport failed!");
@@ -232,7 +249,7 @@ void AllReduceSockets::all_reduce_init()
 
   CLOSESOCK(master_sock);
 
-  if (parent_ip != (uint32_t)-1) { socks.parent = sock_connect(parent_ip, parent_port); }
+  if (parent_ip != (uint32_t)-1) { socks.parent = sock_connect(parent_ip, parent_port, *net); }
   else
     socks.parent = static_cast<socket_t>(-1);
 
@@ -240,15 +257,15 @@ void AllReduceSockets::all_reduce_init()
   socks.children[1] = static_cast<socket_t>(-1);
   for (int i = 0; i < kid_count; i++)
   {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(sock, &fds);
+    wait_for(sock + 1, &fds, nullptr, "children connecting");
+
     sockaddr_in child_address;
     socklen_t size = sizeof(child_address);
-    socket_t f = accept(sock, (sockaddr*)&child_address, &size);
-#ifdef _WIN32
-    if (f == INVALID_SOCKET)
-#else
-    if (f < 0)
-#endif
-      THROWERRNO("accept");
+    socket_t f = net->accept(sock, (sockaddr*)&child_address, &size);
+    if (f == -1) THROWERRNO("accept");
 
     // char hostname[NI_MAXHOST];
     // char servInfo[NI_MAXSERV];
@@ -257,7 +274,17 @@ void AllReduceSockets::all_reduce_init()
     socks.children[i] = f;
   }
 
-  if (kid_count > 0) CLOSESOCK(sock);
+  if (kid_count > 0) net->close(sock);
+}
+
+void AllReduceSockets::wait_for(socket_t max_fd, fd_set* readable, fd_set* writable, const char* waiting_on)
+{
+  timeval deadline;
+  deadline.tv_sec = static_cast<long>(timeout);
+  deadline.tv_usec = static_cast<long>((timeout - deadline.tv_sec) * 1e6);
+  int ready = net->select((int)max_fd, readable, writable, timeout > 0.f ? &deadline : nullptr);
+  if (ready == -1) THROWERRNO("select");
+  if (ready == 0) THROW("nothing from " << waiting_on << " for " << timeout << " seconds, a node may have failed");
 }
 
 void AllReduceSockets::pass_down(char* buffer, const size_t parent_read_pos, size_t& children_sent_pos)
@@ -268,10 +295,10 @@ void AllReduceSockets::pass_down(char* buffer, const size_t parent_read_pos, siz
   {
     // going to pass up this chunk of data to the children
     if (socks.children[0] != -1 &&
-        send(socks.children[0], buffer + children_sent_pos, (int)my_bufsize, 0) < (int)my_bufsize)
+        net->send(socks.children[0], buffer + children_sent_pos, (int)my_bufsize) < (int)my_bufsize)
     { THROW("Write to left child failed"); }
     if (socks.children[1] != -1 &&
-        send(socks.children[1], buffer + children_sent_pos, (int)my_bufsize, 0) < (int)my_bufsize)
+        net->send(socks.children[1], buffer + children_sent_pos, (int)my_bufsize) < (int)my_bufsize)
     { THROW("Write to right child failed"); }
 
     children_sent_pos += my_bufsize;
@@ -298,10 +325,90 @@ void AllReduceSockets::broadcast(char* buffer, const size_t n)
       // there is data to be read from the parent
       if (parent_read_pos == n) THROW("I think parent has no data to send but he thinks he has");
 
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(socks.parent, &fds);
+      wait_for(socks.parent + 1, &fds, nullptr, "parent");
+
       size_t count = std::min(ar_buf_size, n - parent_read_pos);
-      int read_size = recv(socks.parent, buffer + parent_read_pos, (int)count, 0);
+      int read_size = net->recv(socks.parent, buffer + parent_read_pos, (int)count);
       if (read_size == -1) { THROW("recv from parent: " << VW::strerror_to_string(errno)); }
+      if (read_size == 0) THROW("parent closed the connection, the node may have failed");
       parent_read_pos += read_size;
     }
   }
 }
+
+namespace
+{
+bool would_block()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+}  // namespace
+
+void AllReduceSockets::ring_init()
+{
+  // Every node listens for the previous one and learns where the next one listens through the tree.
+  short unsigned int netport = htons(26544);
+  socket_t listener = listen_on(netport, 1);
+
+  std::vector<uint64_t> addresses(total, 0);
+  addresses[node] = (static_cast<uint64_t>(local_ip) << 16) | netport;
+  reduce<uint64_t, or_address>((char*)addresses.data(), total * sizeof(uint64_t));
+  broadcast((char*)addresses.data(), total * sizeof(uint64_t));
+
+  // The connection is queued by listen, so every node can connect before any accepts.
+  const uint64_t next = addresses[(node + 1) % total];
+  socks.ring_next = sock_connect(static_cast<uint32_t>(next >> 16), static_cast<int>(next & 0xffff), *net);
+
+  fd_set fds;
+  FD_ZERO(&fds);
+  FD_SET(listener, &fds);
+  wait_for(listener + 1, &fds, nullptr, "previous node in ring connecting");
+
+  sockaddr_in prev_address;
+  socklen_t size = sizeof(prev_address);
+  socks.ring_prev = net->accept(listener, (sockaddr*)&prev_address, &size);
+  if (socks.ring_prev == -1) THROWERRNO("accept");
+  net->close(listener);
+
+  // Every node sends while it receives, blocking on either could leave the whole ring waiting.
+  if (net->set_nonblocking(socks.ring_next) < 0 || net->set_nonblocking(socks.ring_prev) < 0)
+    THROWERRNO("set_nonblocking");
+}
+
+void AllReduceSockets::ring_exchange(const char* out, size_t out_bytes, char* in, size_t in_bytes)
+{
+  size_t sent = 0;
+  size_t received = 0;
+  socket_t max_fd = std::max(socks.ring_next, socks.ring_prev) + 1;
+  while (sent < out_bytes || received < in_bytes)
+  {
+    fd_set readable;
+    fd_set writable;
+    FD_ZERO(&readable);
+    FD_ZERO(&writable);
+    if (received < in_bytes) FD_SET(socks.ring_prev, &readable);
+    if (sent < out_bytes) FD_SET(socks.ring_next, &writable);
+    wait_for(max_fd, &readable, &writable, "neighbours in ring");
+
+    if (FD_ISSET(socks.ring_next, &writable))
+    {
+      int write_size = net->send(socks.ring_next, out + sent, (int)std::min(ar_buf_size, out_bytes - sent));
+      if (write_size < 0 && !would_block()) THROWERRNO("send to next node in ring");
+      if (write_size > 0) sent += write_size;
+    }
+    if (FD_ISSET(socks.ring_prev, &readable))
+    {
+      int read_size = net->recv(socks.ring_prev, in + received, (int)std::min(ar_buf_size, in_bytes - received));
+      if (read_size == 0) THROW("previous node in ring closed the connection");
+      if (read_size < 0 && !would_block()) THROWERRNO("recv from previous node in ring");
+      if (read_size > 0) received += read_size;
+    }
+  }
+}
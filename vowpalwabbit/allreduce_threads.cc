@@ -6,56 +6,74 @@
 This implements the allreduce function using threads.
 */
 #include "allreduce.h"
+#include <atomic>
+#include <thread>
 #include <future>
+#ifdef __linux__
+#  include <sys/syscall.h>
+#endif
 
-AllReduceSync::AllReduceSync(const size_t total) : m_total(total), m_count(0), m_run(true)
+struct spin_barrier
 {
-  m_mutex = new std::mutex;
-  m_cv = new std::condition_variable;
+  std::atomic<size_t> count{0};
+  std::atomic<bool> sense{false};
+};
+
+namespace
+{
+// The NUMA node the calling thread runs on, 0 where it can't be told.
+size_t current_numa_node()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0;
+  unsigned numa_node = 0;
+  if (syscall(SYS_getcpu, &cpu, &numa_node, nullptr) == 0) return numa_node;
+#endif
+  return 0;
+}
+}  // namespace
+
+AllReduceSync::AllReduceSync(const size_t total) : m_total(total)
+{
+  m_barrier = new spin_barrier;
   buffers = new void*[total];
+  numa_nodes = new size_t[total];
 }
 
 AllReduceSync::~AllReduceSync()
 {
-  delete m_mutex;
-  delete m_cv;
+  delete m_barrier;
   delete[] buffers;
+  delete[] numa_nodes;
 }
 
 void AllReduceSync::waitForSynchronization()
 {
-  std::unique_lock<std::mutex> l(*m_mutex);
-  m_count++;
-
-  if (m_count >= m_total)
+  // The sense can't flip before this thread arrives, so the one read now is that of this run.
+  const bool current_run = m_barrier->sense.load(std::memory_order_acquire);
+  if (m_barrier->count.fetch_add(1, std::memory_order_acq_rel) + 1 == m_total)
   {
-    assert(m_count == m_total);
-
-    m_cv->notify_all();
-
-    // order of m_count before or after notify_all doesn't matter
-    // since the lock is still hold at this point in time.
-    m_count = 0;
-
-    // flip for the next run
-    m_run = !m_run;
+    m_barrier->count.store(0, std::memory_order_relaxed);
+    // flip for the next run, which releases the others
+    m_barrier->sense.store(!current_run, std::memory_order_release);
+    return;
   }
-  else
+
+  // The reductions between barriers are short, so spinning avoids the sleep and wake up of a condition variable,
+  // yielding after a while in case there are more threads than cores.
+  for (uint32_t spins = 0; m_barrier->sense.load(std::memory_order_acquire) == current_run; spins++)
   {
-    bool current_run = m_run;
-    // this predicate cannot depend on m_count, as somebody can race ahead and m_count++
-    // FYI just wait can spuriously wake-up
-    m_cv->wait(l, [this, current_run] { return m_run != current_run; });
+    if (spins >= 1024) std::this_thread::yield();
   }
 }
 
 AllReduceThreads::AllReduceThreads(AllReduceThreads* root, const size_t ptotal, const size_t pnode, bool pquiet)
-    : AllReduce(ptotal, pnode, pquiet), m_sync(root->m_sync), m_syncOwner(false)
+    : AllReduce(ptotal, pnode, pquiet), m_sync(root->m_sync), m_syncOwner(false), m_rank(0)
 {
 }
 
 AllReduceThreads::AllReduceThreads(const size_t ptotal, const size_t pnode, bool pquiet)
-    : AllReduce(ptotal, pnode, pquiet), m_sync(new AllReduceSync(ptotal)), m_syncOwner(true)
+    : AllReduce(ptotal, pnode, pquiet), m_sync(new AllReduceSync(ptotal)), m_syncOwner(true), m_rank(0)
 {
 }
 
@@ -63,3 +81,25 @@ AllReduceThreads::~AllReduceThreads()
 {
   if (m_syncOwner) { delete m_sync; }
 }
+
+void AllReduceThreads::find_groups()
+{
+  m_sync->numa_nodes[node] = current_numa_node();
+  m_sync->waitForSynchronization();
+
+  std::vector<size_t> seen;
+  for (size_t i = 0; i < total; i++)
+  {
+    const size_t numa_node = m_sync->numa_nodes[i];
+    if (std::find(seen.begin(), seen.end(), numa_node) == seen.end())
+    {
+      seen.push_back(numa_node);
+      m_leaders.push_back(i);
+    }
+    if (numa_node == m_sync->numa_nodes[node])
+    {
+      if (i == node) m_rank = m_group.size();
+      m_group.push_back(i);
+    }
+  }
+}
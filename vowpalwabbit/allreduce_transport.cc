@@ -0,0 +1,151 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "allreduce_transport.h"
+#include "vw_exception.h"
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+#ifdef VW_USE_RSOCKETS
+#  include <rdma/rsocket.h>
+#endif
+
+namespace
+{
+socket_t tcp_open()
+{
+  socket_t sock = socket(PF_INET, SOCK_STREAM, 0);
+#ifdef _WIN32
+  return sock == INVALID_SOCKET ? static_cast<socket_t>(-1) : sock;
+#else
+  return sock;
+#endif
+}
+
+int tcp_set_option(socket_t sock, int level, int option, const char* value, socklen_t length)
+{
+  return setsockopt(sock, level, option, value, length);
+}
+
+int tcp_bind(socket_t sock, const sockaddr* address, socklen_t length) { return ::bind(sock, address, length); }
+
+int tcp_listen(socket_t sock, int backlog) { return listen(sock, backlog); }
+
+socket_t tcp_accept(socket_t sock, sockaddr* address, socklen_t* length)
+{
+  socket_t accepted = accept(sock, address, length);
+#ifdef _WIN32
+  return accepted == INVALID_SOCKET ? static_cast<socket_t>(-1) : accepted;
+#else
+  return accepted;
+#endif
+}
+
+int tcp_connect(socket_t sock, const sockaddr* address, socklen_t length) { return connect(sock, address, length); }
+
+int tcp_send(socket_t sock, const char* buffer, int length) { return (int)send(sock, buffer, length, 0); }
+
+int tcp_recv(socket_t sock, char* buffer, int length) { return (int)recv(sock, buffer, length, 0); }
+
+int tcp_select(int count, fd_set* readable, fd_set* writable, timeval* timeout)
+{
+  return select(count, readable, writable, nullptr, timeout);
+}
+
+int tcp_local_address(socket_t sock, sockaddr* address, socklen_t* length) { return getsockname(sock, address, length); }
+
+int tcp_set_nonblocking(socket_t sock)
+{
+#ifdef _WIN32
+  u_long on = 1;
+  return ioctlsocket(sock, FIONBIO, &on);
+#else
+  int flags = fcntl(sock, F_GETFL, 0);
+  return flags < 0 ? flags : fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+#endif
+}
+
+int tcp_close(socket_t sock)
+{
+#ifdef _WIN32
+  return closesocket(sock);
+#else
+  return close(sock);
+#endif
+}
+
+#ifdef VW_USE_RSOCKETS
+socket_t rdma_open() { return rsocket(PF_INET, SOCK_STREAM, 0); }
+
+int rdma_set_option(socket_t sock, int level, int option, const char* value, socklen_t length)
+{
+  return rsetsockopt(sock, level, option, value, length);
+}
+
+int rdma_bind(socket_t sock, const sockaddr* address, socklen_t length) { return rbind(sock, address, length); }
+
+int rdma_listen(socket_t sock, int backlog) { return rlisten(sock, backlog); }
+
+socket_t rdma_accept(socket_t sock, sockaddr* address, socklen_t* length) { return raccept(sock, address, length); }
+
+int rdma_connect(socket_t sock, const sockaddr* address, socklen_t length) { return rconnect(sock, address, length); }
+
+int rdma_send(socket_t sock, const char* buffer, int length) { return (int)rsend(sock, buffer, length, 0); }
+
+int rdma_recv(socket_t sock, char* buffer, int length) { return (int)rrecv(sock, buffer, length, 0); }
+
+int rdma_select(int count, fd_set* readable, fd_set* writable, timeval* timeout)
+{
+  return rselect(count, readable, writable, nullptr, timeout);
+}
+
+int rdma_local_address(socket_t sock, sockaddr* address, socklen_t* length)
+{
+  return rgetsockname(sock, address, length);
+}
+
+int rdma_set_nonblocking(socket_t sock)
+{
+  int flags = rfcntl(sock, F_GETFL, 0);
+  return flags < 0 ? flags : rfcntl(sock, F_SETFL, flags | O_NONBLOCK);
+}
+
+int rdma_close(socket_t sock) { return rclose(sock); }
+#endif
+}  // namespace
+
+namespace VW
+{
+const allreduce_transport& tcp_transport()
+{
+  static const allreduce_transport transport = {"tcp", tcp_open, tcp_set_option, tcp_bind, tcp_listen, tcp_accept,
+      tcp_connect, tcp_send, tcp_recv, tcp_select, tcp_local_address, tcp_set_nonblocking, tcp_close};
+  return transport;
+}
+
+const allreduce_transport* rdma_transport()
+{
+#ifdef VW_USE_RSOCKETS
+  static const allreduce_transport transport = {"rdma", rdma_open, rdma_set_option, rdma_bind, rdma_listen,
+      rdma_accept, rdma_connect, rdma_send, rdma_recv, rdma_select, rdma_local_address, rdma_set_nonblocking,
+      rdma_close};
+  return &transport;
+#else
+  return nullptr;
+#endif
+}
+
+const allreduce_transport& parse_allreduce_transport(const std::string& name)
+{
+  if (name == "tcp") return tcp_transport();
+  if (name == "rdma")
+  {
+    if (rdma_transport() == nullptr) THROW("--node_transport rdma requires a build with USE_RSOCKETS");
+    return *rdma_transport();
+  }
+  THROW("unknown --node_transport " << name << ", expected tcp or rdma");
+}
+}  // namespace VW
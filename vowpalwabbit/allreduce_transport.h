@@ -0,0 +1,52 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <WinSock2.h>
+#  include <WS2tcpip.h>
+typedef int socklen_t;
+typedef SOCKET socket_t;
+#else
+#  include <sys/select.h>
+#  include <sys/socket.h>
+typedef int socket_t;
+#endif
+
+#include <string>
+
+namespace VW
+{
+// The socket calls AllReduceSockets makes between nodes, either plain TCP or, when built with USE_RSOCKETS, the
+// rsockets of librdmacm, which keep the semantics of stream sockets over RDMA. The span server is always reached
+// over TCP.
+struct allreduce_transport
+{
+  const char* name;
+  socket_t (*open)();  // a stream socket, -1 if it could not be created
+  int (*set_option)(socket_t sock, int level, int option, const char* value, socklen_t length);
+  int (*bind)(socket_t sock, const sockaddr* address, socklen_t length);
+  int (*listen)(socket_t sock, int backlog);
+  socket_t (*accept)(socket_t sock, sockaddr* address, socklen_t* length);
+  int (*connect)(socket_t sock, const sockaddr* address, socklen_t length);
+  int (*send)(socket_t sock, const char* buffer, int length);
+  int (*recv)(socket_t sock, char* buffer, int length);
+  int (*select)(int count, fd_set* readable, fd_set* writable, timeval* timeout);  // 0 once timeout passed
+  int (*local_address)(socket_t sock, sockaddr* address, socklen_t* length);
+  int (*set_nonblocking)(socket_t sock);
+  int (*close)(socket_t sock);
+};
+
+const allreduce_transport& tcp_transport();
+
+// nullptr when built without USE_RSOCKETS.
+const allreduce_transport* rdma_transport();
+
+// The transport of --node_transport, tcp or rdma.
+const allreduce_transport& parse_allreduce_transport(const std::string& name);
+}  // namespace VW
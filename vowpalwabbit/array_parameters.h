@@ -4,9 +4,26 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <unordered_map>
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <vector>
+
+// Mutex cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <mutex>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <mutex>
+#endif
 
 #ifndef _WIN32
 #  define NOMINMAX
@@ -23,15 +40,79 @@
 #include "vw_exception.h"
 
 class sparse_parameters;
-typedef std::unordered_map<uint64_t, weight*> weight_map;
+
+// A slot of the open addressing tables of sparse_parameters. The block is published after the index, and stays
+// nullptr while the slot is empty.
+struct sparse_slot
+{
+  uint64_t index;
+  std::atomic<weight*> block;
+};
+
+// A power of 2 of slots, at most half used.
+struct sparse_table
+{
+  explicit sparse_table(uint32_t log_slots, bool counted = false)
+      : slots(new sparse_slot[static_cast<size_t>(1) << log_slots]())
+      , uses(counted ? new std::atomic<uint8_t>[static_cast<size_t>(1) << log_slots]() : nullptr)
+      , log_slots(log_slots)
+  {
+  }
+
+  size_t capacity() const { return static_cast<size_t>(1) << log_slots; }
+
+  std::unique_ptr<sparse_slot[]> slots;
+  // Saturating counts of the lookups of the slots, halved at each eviction, while the number of weights is limited.
+  std::unique_ptr<std::atomic<uint8_t>[]> uses;
+  uint32_t log_slots;
+  size_t size = 0;
+};
+
+// One of the independently locked parts of sparse_parameters.
+struct sparse_shard
+{
+  std::atomic<sparse_table*> table{nullptr};
+  // The current table is the last one. Tables it replaced are kept, threads may still be probing them.
+  std::vector<std::unique_ptr<sparse_table>> tables;
+  std::vector<weight*> chunks;  // owned, unless the sparse_parameters is seeded
+  std::vector<weight*> free_blocks;  // evicted blocks of the chunks, reused before new ones are carved out
+  weight* chunk_next = nullptr;  // next free block of the last chunk
+  size_t chunk_blocks_left = 0;
+  std::mutex insert_lock;
+};
 
 template <typename T>
 class sparse_iterator
 {
 private:
-  weight_map::iterator _iter;
+  sparse_shard* _shard;
+  sparse_shard* _shards_end;
+  sparse_slot* _current;
+  sparse_slot* _end;
   uint32_t _stride;
 
+  void skip_empty()
+  {
+    while (true)
+    {
+      while (_current != _end && _current->block.load(std::memory_order_relaxed) == nullptr) ++_current;
+      if (_current != _end) return;
+      if (++_shard == _shards_end)
+      {
+        _current = _end = nullptr;
+        return;
+      }
+      set_table();
+    }
+  }
+
+  void set_table()
+  {
+    sparse_table* table = _shard->table.load(std::memory_order_acquire);
+    _current = table == nullptr ? nullptr : table->slots.get();
+    _end = table == nullptr ? nullptr : table->slots.get() + table->capacity();
+  }
+
 public:
   typedef std::forward_iterator_tag iterator_category;
   typedef T value_type;
@@ -39,51 +120,182 @@ public:
   typedef T* pointer;
   typedef T& reference;
 
-  sparse_iterator(weight_map::iterator& iter, uint32_t stride) : _iter(iter), _stride(stride) {}
+  sparse_iterator(sparse_shard* shard, sparse_shard* shards_end, uint32_t stride)
+      : _shard(shard), _shards_end(shards_end), _current(nullptr), _end(nullptr), _stride(stride)
+  {
+    if (_shard != _shards_end)
+    {
+      set_table();
+      skip_empty();
+    }
+  }
 
   sparse_iterator& operator=(const sparse_iterator& other) = default;
   sparse_iterator(const sparse_iterator& other) = default;
   sparse_iterator& operator=(sparse_iterator&& other) noexcept = default;
   sparse_iterator(sparse_iterator&& other) noexcept = default;
 
-  uint64_t index() { return _iter->first; }
+  uint64_t index() { return _current->index; }
 
-  T& operator*() { return *(_iter->second); }
+  T& operator*() { return *(_current->block.load(std::memory_order_relaxed)); }
 
   sparse_iterator& operator++()
   {
-    _iter++;
+    ++_current;
+    skip_empty();
     return *this;
   }
 
-  bool operator==(const sparse_iterator& rhs) const { return _iter == rhs._iter; }
-  bool operator!=(const sparse_iterator& rhs) const { return _iter != rhs._iter; }
+  bool operator==(const sparse_iterator& rhs) const { return _shard == rhs._shard && _current == rhs._current; }
+  bool operator!=(const sparse_iterator& rhs) const { return !(*this == rhs); }
 };
 
+// Weights of the indices which were used, in blocks of stride() weights. Indices are spread over shards, each an open
+// addressing table probed linearly, which holds the index and the block of a weight side by side. Blocks are carved
+// out of large chunks instead of being allocated one by one. Chunks never move, so references to weights stay valid
+// while the tables grow, as they do with dense weights.
+//
+// Several threads may look up and add weights at the same time, as with dense weights the values themselves are not
+// synchronized. Lookups take no lock: a grown table is published once it is complete and the tables it replaced are
+// only freed with the weights. Missing weights are added under the lock of their shard, which checks again whether
+// another thread added them meanwhile. Iteration, set_zero and shallow_copy require that no weights are being added.
+//
+// The number of weights can be limited with set_limit, see --sparse_weights_limit. Lookups then count the uses of the
+// weights, and evict_if_over_limit evicts the least used ones, the smallest in magnitude first among those used as
+// often, once there are more than the limit. Evicting requires that no weights are being looked up, and invalidates
+// the references to weights.
 class sparse_parameters
 {
 private:
-  // This must be mutable because the const operator[] must be able to intialize default weights to return.
-  mutable weight_map _map;
+  static constexpr uint32_t SHARD_BITS = 6;
+  static constexpr size_t NUM_SHARDS = static_cast<size_t>(1) << SHARD_BITS;
+
+  // The shards must be mutable because the const operator[] must be able to intialize default weights to return.
+  std::unique_ptr<sparse_shard[]> _shards;
   uint64_t _weight_mask;  // (stride*(1 << num_bits) -1)
   uint32_t _stride_shift;
   bool _seeded;  // whether the instance is sharing model state with others
   bool _delete;
   std::function<void(weight*, uint64_t)> _default_func;
+  size_t _max_weights = 0;  // no limit when 0
+  std::atomic<uint64_t> _evicted{0};
+  std::atomic<uint64_t> _evictions{0};
 
-  // It is marked const so it can be used from both const and non const operator[]
-  // The map itself is mutable to facilitate this
-  inline weight* get_or_default_and_get(size_t i) const
+  // Fibonacci hashing spreads the strided indices, whose low bits are mostly 0, over the shards and slots.
+  static inline uint64_t hash(uint64_t index) { return index * 0x9E3779B97F4A7C15ULL; }
+  static inline size_t slot_of(uint64_t hash, const sparse_table& table)
   {
-    uint64_t index = i & _weight_mask;
-    weight_map::iterator iter = _map.find(index);
-    if (iter == _map.end())
+    return static_cast<size_t>((hash << SHARD_BITS) >> (64 - table.log_slots));
+  }
+
+  static weight* find(const sparse_table* table, uint64_t index, uint64_t hash)
+  {
+    if (table == nullptr) return nullptr;
+    const size_t slot_mask = table->capacity() - 1;
+    for (size_t s = slot_of(hash, *table);; s = (s + 1) & slot_mask)
     {
-      _map.insert(std::make_pair(index, calloc_mergable_or_throw<weight>(stride())));
-      iter = _map.find(index);
-      if (_default_func != nullptr) { _default_func(iter->second, index); }
+      weight* block = table->slots[s].block.load(std::memory_order_acquire);
+      if (block == nullptr) return nullptr;
+      if (table->slots[s].index == index)
+      {
+        if (table->uses != nullptr)
+        {
+          // Threads may lose each other's counts, which only matter roughly.
+          const uint8_t uses = table->uses[s].load(std::memory_order_relaxed);
+          if (uses != UINT8_MAX) table->uses[s].store(uses + 1, std::memory_order_relaxed);
+        }
+        return block;
+      }
     }
-    return iter->second;
+  }
+
+  static size_t place(sparse_table& table, uint64_t index, uint64_t hash, weight* block)
+  {
+    const size_t slot_mask = table.capacity() - 1;
+    size_t s = slot_of(hash, table);
+    while (table.slots[s].block.load(std::memory_order_relaxed) != nullptr) s = (s + 1) & slot_mask;
+    table.slots[s].index = index;
+    table.slots[s].block.store(block, std::memory_order_release);
+    table.size++;
+    return s;
+  }
+
+  // Returns the table of the shard with room for one more weight. Called with the insert lock held.
+  sparse_table& table_with_room(sparse_shard& shard) const
+  {
+    sparse_table* table = shard.table.load(std::memory_order_relaxed);
+    if (table != nullptr && 2 * (table->size + 1) <= table->capacity()) return *table;
+
+    std::unique_ptr<sparse_table> grown(
+        new sparse_table(table == nullptr ? 4 : table->log_slots + 1, _max_weights > 0));
+    if (table != nullptr)
+    {
+      for (size_t s = 0; s < table->capacity(); s++)
+      {
+        weight* block = table->slots[s].block.load(std::memory_order_relaxed);
+        if (block == nullptr) continue;
+        const size_t to = place(*grown, table->slots[s].index, hash(table->slots[s].index), block);
+        if (grown->uses != nullptr && table->uses != nullptr)
+          grown->uses[to].store(table->uses[s].load(std::memory_order_relaxed), std::memory_order_relaxed);
+      }
+    }
+    shard.table.store(grown.get(), std::memory_order_release);
+    shard.tables.push_back(std::move(grown));
+    return *shard.tables.back();
+  }
+
+  weight* new_block(sparse_shard& shard) const
+  {
+    if (!shard.free_blocks.empty())
+    {
+      weight* block = shard.free_blocks.back();
+      shard.free_blocks.pop_back();
+      std::fill(block, block + stride(), 0.f);
+      return block;
+    }
+    if (shard.chunk_blocks_left == 0)
+    {
+      // Chunks grow with the shard, from 16 to 4096 blocks.
+      const size_t shard_size = shard.tables.empty() ? 0 : shard.tables.back()->size;
+      shard.chunk_blocks_left = std::min<size_t>(std::max<size_t>(shard_size, 16), 1 << 12);
+      shard.chunk_next = calloc_mergable_or_throw<weight>(shard.chunk_blocks_left << _stride_shift);
+      shard.chunks.push_back(shard.chunk_next);
+    }
+    weight* block = shard.chunk_next;
+    shard.chunk_next += stride();
+    shard.chunk_blocks_left--;
+    return block;
+  }
+
+  void free_chunks()
+  {
+    for (size_t i = 0; i < NUM_SHARDS; i++)
+    {
+      for (auto* chunk : _shards[i].chunks) free(chunk);
+      _shards[i].chunks.clear();
+      _shards[i].free_blocks.clear();
+      _shards[i].chunk_next = nullptr;
+      _shards[i].chunk_blocks_left = 0;
+    }
+  }
+
+  // It is marked const so it can be used from both const and non const operator[]
+  // The shards are owned through a pointer so that they can be modified from here
+  inline weight* get_or_default_and_get(size_t i) const
+  {
+    const uint64_t index = i & _weight_mask;
+    const uint64_t h = hash(index);
+    sparse_shard& shard = _shards[h >> (64 - SHARD_BITS)];
+    weight* block = find(shard.table.load(std::memory_order_acquire), index, h);
+    if (block != nullptr) return block;
+
+    std::lock_guard<std::mutex> lock(shard.insert_lock);
+    block = find(shard.table.load(std::memory_order_relaxed), index, h);
+    if (block != nullptr) return block;
+    block = new_block(shard);
+    if (_default_func != nullptr) { _default_func(block, index); }
+    place(table_with_room(shard), index, h, block);
+    return block;
   }
 
 public:
@@ -91,7 +303,7 @@ public:
   typedef sparse_iterator<const weight> const_iterator;
 
   sparse_parameters(size_t length, uint32_t stride_shift = 0)
-      : _map()
+      : _shards(new sparse_shard[NUM_SHARDS])
       , _weight_mask((length << stride_shift) - 1)
       , _stride_shift(stride_shift)
       , _seeded(false)
@@ -101,11 +313,16 @@ public:
   }
 
   sparse_parameters()
-      : _map(), _weight_mask(0), _stride_shift(0), _seeded(false), _delete(false), _default_func(nullptr)
+      : _shards(new sparse_shard[NUM_SHARDS])
+      , _weight_mask(0)
+      , _stride_shift(0)
+      , _seeded(false)
+      , _delete(false)
+      , _default_func(nullptr)
   {
   }
 
-  bool not_null() { return (_weight_mask > 0 && !_map.empty()); }
+  bool not_null() { return (_weight_mask > 0 && size() > 0); }
 
   sparse_parameters(const sparse_parameters& other) = delete;
   sparse_parameters& operator=(const sparse_parameters& other) = delete;
@@ -115,27 +332,14 @@ public:
   weight* first() { THROW_OR_RETURN("Allreduce currently not supported in sparse", nullptr); }
 
   // iterator with stride
-  iterator begin()
-  {
-    weight_map::iterator i = _map.begin();
-    return iterator(i, stride());
-  }
-  iterator end()
-  {
-    weight_map::iterator i = _map.end();
-    return iterator(i, stride());
-  }
+  iterator begin() { return iterator(_shards.get(), _shards.get() + NUM_SHARDS, stride()); }
+  iterator end() { return iterator(_shards.get() + NUM_SHARDS, _shards.get() + NUM_SHARDS, stride()); }
 
   // const iterator
-  const_iterator cbegin()
-  {
-    weight_map::iterator i = _map.begin();
-    return const_iterator(i, stride());
-  }
+  const_iterator cbegin() { return const_iterator(_shards.get(), _shards.get() + NUM_SHARDS, stride()); }
   const_iterator cend()
   {
-    weight_map::iterator i = _map.begin();
-    return const_iterator(i, stride());
+    return const_iterator(_shards.get() + NUM_SHARDS, _shards.get() + NUM_SHARDS, stride());
   }
 
   inline weight& operator[](size_t i) { return *(get_or_default_and_get(i)); }
@@ -144,18 +348,40 @@ public:
 
   inline weight& strided_index(size_t index) { return operator[](index << _stride_shift); }
 
+  // Number of indices with weights.
+  size_t size() const
+  {
+    size_t weights = 0;
+    for (size_t i = 0; i < NUM_SHARDS; i++)
+    {
+      sparse_table* table = _shards[i].table.load(std::memory_order_acquire);
+      if (table != nullptr) weights += table->size;
+    }
+    return weights;
+  }
+
   void shallow_copy(const sparse_parameters& input)
   {
     // TODO: this is level-1 copy (weight* are stilled shared)
-    if (!_seeded)
+    if (!_seeded) free_chunks();
+    for (size_t i = 0; i < NUM_SHARDS; i++)
     {
-      for (auto& iter : _map)
+      sparse_shard& shard = _shards[i];
+      shard.table.store(nullptr);
+      shard.tables.clear();
+      const sparse_table* table = input._shards[i].table.load(std::memory_order_acquire);
+      if (table == nullptr) continue;
+
+      std::unique_ptr<sparse_table> copy(new sparse_table(table->log_slots));
+      for (size_t s = 0; s < table->capacity(); s++)
       {
-        auto* weight_ptr = iter.second;
-        free(weight_ptr);
+        copy->slots[s].index = table->slots[s].index;
+        copy->slots[s].block.store(table->slots[s].block.load(std::memory_order_relaxed), std::memory_order_relaxed);
       }
+      copy->size = table->size;
+      shard.table.store(copy.get(), std::memory_order_release);
+      shard.tables.push_back(std::move(copy));
     }
-    _map = input._map;
     _weight_mask = input._weight_mask;
     _stride_shift = input._stride_shift;
     _seeded = true;
@@ -169,9 +395,120 @@ public:
 
   void set_zero(size_t offset)
   {
-    for (auto& iter : _map) { (&(*(iter.second)))[offset] = 0; }
+    for (iterator iter = begin(); iter != end(); ++iter) (&(*iter))[offset] = 0;
+  }
+
+  // Limits the number of weights to max_weights, or lifts the limit with 0, see evict_if_over_limit. Requires that no
+  // weights are being looked up.
+  void set_limit(size_t max_weights)
+  {
+    _max_weights = max_weights;
+    for (size_t i = 0; i < NUM_SHARDS; i++)
+    {
+      sparse_table* table = _shards[i].table.load(std::memory_order_relaxed);
+      if (table == nullptr) continue;
+      if (max_weights == 0)
+        table->uses.reset();
+      else if (table->uses == nullptr)
+        table->uses.reset(new std::atomic<uint8_t>[table->capacity()]());
+    }
+  }
+
+  size_t limit() const { return _max_weights; }
+
+  // Once there are more weights than the limit, evicts the least used ones down to 7/8 of it, so that evicting is
+  // rare, and halves the use counts of the others, so that the weights which go out of use are evicted in turn. The
+  // weights used as often as the last ones evicted are evicted the smallest in magnitude first. Returns the number of
+  // weights evicted. Requires that no weights are being looked up or added, and does nothing to seeded instances.
+  size_t evict_if_over_limit()
+  {
+    if (_max_weights == 0 || _seeded) return 0;
+    const size_t weights = size();
+    if (weights <= _max_weights) return 0;
+    const size_t to_evict = weights - (_max_weights - _max_weights / 8);
+
+    // The weights used less than threshold times are evicted, and the ties_to_evict smallest of those used threshold
+    // times.
+    size_t counts[UINT8_MAX + 1] = {};
+    for (size_t i = 0; i < NUM_SHARDS; i++)
+    {
+      const sparse_table* table = _shards[i].table.load(std::memory_order_relaxed);
+      if (table == nullptr) continue;
+      for (size_t s = 0; s < table->capacity(); s++)
+        if (table->slots[s].block.load(std::memory_order_relaxed) != nullptr)
+          counts[table->uses[s].load(std::memory_order_relaxed)]++;
+    }
+    size_t threshold = 0;
+    size_t below = 0;
+    while (below + counts[threshold] < to_evict) below += counts[threshold++];
+    size_t ties_to_evict = to_evict - below;
+
+    std::vector<float> tie_magnitudes;
+    tie_magnitudes.reserve(counts[threshold]);
+    for (size_t i = 0; i < NUM_SHARDS; i++)
+    {
+      const sparse_table* table = _shards[i].table.load(std::memory_order_relaxed);
+      if (table == nullptr) continue;
+      for (size_t s = 0; s < table->capacity(); s++)
+      {
+        const weight* block = table->slots[s].block.load(std::memory_order_relaxed);
+        if (block != nullptr && table->uses[s].load(std::memory_order_relaxed) == threshold)
+          tie_magnitudes.push_back(std::fabs(block[0]));
+      }
+    }
+    std::nth_element(tie_magnitudes.begin(), tie_magnitudes.begin() + (ties_to_evict - 1), tie_magnitudes.end());
+    const float cutoff = tie_magnitudes[ties_to_evict - 1];
+    // Those of the cutoff magnitude are evicted as they come once the smaller ones are.
+    size_t cutoff_to_evict = ties_to_evict -
+        std::count_if(tie_magnitudes.begin(), tie_magnitudes.end(), [cutoff](float m) { return m < cutoff; });
+
+    for (size_t i = 0; i < NUM_SHARDS; i++)
+    {
+      sparse_shard& shard = _shards[i];
+      const sparse_table* table = shard.table.load(std::memory_order_relaxed);
+      if (table == nullptr) continue;
+      // Linear probing does not allow removing slots in place, the weights kept are placed in a table of their own.
+      std::unique_ptr<sparse_table> kept(new sparse_table(table->log_slots, true));
+      for (size_t s = 0; s < table->capacity(); s++)
+      {
+        weight* block = table->slots[s].block.load(std::memory_order_relaxed);
+        if (block == nullptr) continue;
+        const uint8_t uses = table->uses[s].load(std::memory_order_relaxed);
+        bool evict = uses < threshold;
+        if (uses == threshold)
+        {
+          const float magnitude = std::fabs(block[0]);
+          if (magnitude < cutoff)
+            evict = true;
+          else if (magnitude == cutoff && cutoff_to_evict > 0)
+          {
+            evict = true;
+            cutoff_to_evict--;
+          }
+        }
+        if (evict)
+        {
+          shard.free_blocks.push_back(block);
+          continue;
+        }
+        const uint64_t index = table->slots[s].index;
+        kept->uses[place(*kept, index, hash(index), block)].store(uses / 2, std::memory_order_relaxed);
+      }
+      shard.table.store(kept.get(), std::memory_order_release);
+      // Nothing is probing the tables replaced, they can go.
+      shard.tables.clear();
+      shard.tables.push_back(std::move(kept));
+    }
+
+    _evicted += to_evict;
+    _evictions++;
+    return to_evict;
   }
 
+  // Weights evicted, and the times they were, so far. Any thread may read them.
+  uint64_t evicted() const { return _evicted.load(std::memory_order_relaxed); }
+  uint64_t evictions() const { return _evictions.load(std::memory_order_relaxed); }
+
   uint64_t mask() const { return _weight_mask; }
 
   uint64_t seeded() const { return _seeded; }
@@ -182,6 +519,11 @@ public:
 
   void stride_shift(uint32_t stride_shift) { _stride_shift = stride_shift; }
 
+  // Sparse weights always interleave their state, see dense_parameters::slot_distance.
+  uint64_t slot_distance() const { return 1; }
+
+  uint32_t slots() const { return stride(); }
+
 #ifndef _WIN32
   void share(size_t /* length */) { THROW_OR_RETURN("Operation not supported on Windows"); }
 #endif
@@ -190,12 +532,7 @@ public:
   {
     if (!_delete && !_seeded)  // don't free weight vector if it is shared with another instance
     {
-      for (auto& iter : _map)
-      {
-        auto* weight_ptr = iter.second;
-        free(weight_ptr);
-      }
-      _map.clear();
+      free_chunks();
       _delete = true;
     }
   }
@@ -253,6 +590,14 @@ public:
       return dense_weights.mask();
   }
 
+  inline uint64_t slot_distance() const
+  {
+    if (sparse)
+      return sparse_weights.slot_distance();
+    else
+      return dense_weights.slot_distance();
+  }
+
   inline uint64_t seeded() const
   {
     if (sparse)
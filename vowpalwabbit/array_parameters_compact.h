@@ -0,0 +1,162 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "memory.h"
+
+// Dense weights stored in 16 bits each, which halves the memory and bandwidth of a loaded model. Weights are widened
+// to float when read, so predictions accumulate in full precision, and rounded to the nearest 16 bit value when
+// written. Meant for prediction only models, such as the ones loaded by vw slim: a reference to a stored weight is a
+// proxy rather than a float&, which the learning reductions cannot update in place.
+
+namespace VW
+{
+namespace details
+{
+inline uint32_t float_bits(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline float bits_float(uint32_t bits)
+{
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}  // namespace details
+
+// IEEE 754 half precision: 5 bit exponent, 10 bit mantissa. Values beyond 65504 become infinite.
+struct float16
+{
+  static uint16_t from_float(float value)
+  {
+    uint32_t bits = details::float_bits(value);
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    bits &= 0x7fffffff;
+
+    // NaN stays NaN, with its mantissa forced non zero.
+    if (bits > 0x7f800000) return sign | 0x7e00;
+    // Too large for half precision, including infinity.
+    if (bits >= 0x477ff000) return sign | 0x7c00;
+    // Subnormal halves and zero: adding 0.5 shifts the mantissa into place, rounded to nearest even.
+    if (bits < 0x38800000)
+    {
+      const float shifted = details::bits_float(bits) + 0.5f;
+      return sign | static_cast<uint16_t>(details::float_bits(shifted) - 0x3f000000);
+    }
+    // Normal halves: rebias the exponent and round the dropped 13 bits to nearest even.
+    const uint32_t odd = (bits >> 13) & 1;
+    bits += 0xc8000fff + odd;
+    return sign | static_cast<uint16_t>(bits >> 13);
+  }
+
+  static float to_float(uint16_t half)
+  {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1f;
+    const uint32_t mantissa = half & 0x3ff;
+
+    if (exponent == 0x1f) return details::bits_float(sign | 0x7f800000 | (mantissa << 13));
+    if (exponent == 0)
+    {
+      // Subnormal halves are mantissa * 2^-24.
+      const float magnitude = static_cast<float>(mantissa) * details::bits_float(0x33800000);
+      return details::bits_float(sign | details::float_bits(magnitude));
+    }
+    return details::bits_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+  }
+};
+
+// bfloat16: the upper half of a float, with the full exponent range and a 7 bit mantissa.
+struct bfloat16
+{
+  static uint16_t from_float(float value)
+  {
+    const uint32_t bits = details::float_bits(value);
+    if ((bits & 0x7fffffff) > 0x7f800000) return static_cast<uint16_t>((bits >> 16) | 0x40);
+    // Round to nearest even.
+    const uint32_t rounding = 0x7fff + ((bits >> 16) & 1);
+    return static_cast<uint16_t>((bits + rounding) >> 16);
+  }
+
+  static float to_float(uint16_t value) { return details::bits_float(static_cast<uint32_t>(value) << 16); }
+};
+}  // namespace VW
+
+template <typename Format>
+class compact_dense_parameters
+{
+private:
+  uint16_t* _begin;
+  uint64_t _weight_mask;  // (stride*(1 << num_bits) -1)
+  uint32_t _stride_shift;
+
+public:
+  // Stands in for weight& on writes, converting the assigned float to the stored format.
+  class reference
+  {
+  private:
+    uint16_t& _value;
+
+  public:
+    explicit reference(uint16_t& value) : _value(value) {}
+
+    reference& operator=(float value)
+    {
+      _value = Format::from_float(value);
+      return *this;
+    }
+
+    operator float() const { return Format::to_float(_value); }
+  };
+
+  compact_dense_parameters(size_t length, uint32_t stride_shift = 0)
+      : _begin(calloc_or_throw<uint16_t>(length << stride_shift))
+      , _weight_mask((length << stride_shift) - 1)
+      , _stride_shift(stride_shift)
+  {
+  }
+
+  compact_dense_parameters() : _begin(nullptr), _weight_mask(0), _stride_shift(0) {}
+
+  compact_dense_parameters(const compact_dense_parameters& other) = delete;
+  compact_dense_parameters& operator=(const compact_dense_parameters& other) = delete;
+  compact_dense_parameters& operator=(compact_dense_parameters&&) noexcept = delete;
+  compact_dense_parameters(compact_dense_parameters&&) noexcept = delete;
+
+  bool not_null() { return (_weight_mask > 0 && _begin != nullptr); }
+
+  // Returned by value, a const float& taken of it, as in foreach_feature, lives as long as the reference.
+  inline float operator[](size_t i) const { return Format::to_float(_begin[i & _weight_mask]); }
+  inline reference operator[](size_t i) { return reference(_begin[i & _weight_mask]); }
+
+  inline reference strided_index(size_t index) { return operator[](index << _stride_shift); }
+
+  uint64_t mask() const { return _weight_mask; }
+
+  uint32_t stride() const { return 1 << _stride_shift; }
+
+  uint32_t stride_shift() const { return _stride_shift; }
+
+  void stride_shift(uint32_t stride_shift) { _stride_shift = stride_shift; }
+
+  ~compact_dense_parameters()
+  {
+    if (_begin != nullptr)
+    {
+      free(_begin);
+      _begin = nullptr;
+    }
+  }
+};
+
+typedef compact_dense_parameters<VW::float16> dense_parameters_fp16;
+typedef compact_dense_parameters<VW::bfloat16> dense_parameters_bf16;
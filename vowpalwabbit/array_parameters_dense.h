@@ -5,10 +5,33 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <utility>
+#ifndef _WIN32
+#  include <sys/mman.h>
+#endif
+#if !defined(__GNUC__) && (defined(_M_X64) || defined(_M_IX86))
+#  include <xmmintrin.h>
+#endif
 #include "memory.h"
+#include "weight_allocator.h"
 
 typedef float weight;
 
+namespace VW
+{
+// Weights beyond this size are not expected to stay in the cache, see dense_parameters::prefetch_distance.
+constexpr size_t PREFETCH_MIN_BYTES = size_t(1) << 24;
+// Features ahead of the one being used whose weights are prefetched, which covers the latency of a memory access well
+// enough at the rate features are used.
+constexpr uint32_t DEFAULT_PREFETCH_DISTANCE = 8;
+
+inline uint32_t default_prefetch_distance(size_t weight_count)
+{
+  return weight_count * sizeof(float) >= PREFETCH_MIN_BYTES ? DEFAULT_PREFETCH_DISTANCE : 0;
+}
+}  // namespace VW
+
 template <typename T>
 class dense_iterator
 {
@@ -46,7 +69,17 @@ private:
   weight* _begin;
   uint64_t _weight_mask;  // (stride*(1 << num_bits) -1)
   uint32_t _stride_shift;
+  uint32_t _planes_shift = 0;  // log2 of the number of planes holding the state of each weight, 0 if interleaved
+  uint32_t _prefetch_distance = 0;  // see prefetch_distance()
   bool _seeded;  // whether the instance is sharing model state with others
+  bool _external = false;  // whether the weights live in memory owned elsewhere, see use_external_memory
+  size_t _mapped_bytes = 0;  // size of the mapping holding the weights, 0 if they were allocated with malloc
+  VW::weight_allocation _allocation;  // what took effect, see allocation()
+
+  void free_owned()
+  {
+    if (!_seeded && !_external) VW::free_weights(_begin, _mapped_bytes);
+  }
 
 public:
   typedef dense_iterator<weight> iterator;
@@ -55,10 +88,27 @@ public:
       : _begin(calloc_mergable_or_throw<weight>(length << stride_shift))
       , _weight_mask((length << stride_shift) - 1)
       , _stride_shift(stride_shift)
+      , _prefetch_distance(VW::default_prefetch_distance(length << stride_shift))
       , _seeded(false)
   {
   }
 
+  // Allocates the weights with huge pages or NUMA placement, as far as they are available. With planes_shift > 0 the
+  // state of the weights is laid out in 1 << planes_shift planes, see slot_distance().
+  dense_parameters(
+      size_t length, uint32_t stride_shift, const VW::weight_allocation& allocation, uint32_t planes_shift = 0)
+      : _weight_mask((length << stride_shift) - 1)
+      , _stride_shift(stride_shift)
+      , _planes_shift(planes_shift)
+      , _prefetch_distance(VW::default_prefetch_distance(length << stride_shift))
+      , _seeded(false)
+  {
+    auto allocated = VW::allocate_weights((length << stride_shift) << planes_shift, allocation);
+    _begin = allocated.data;
+    _mapped_bytes = allocated.mapped_bytes;
+    _allocation = allocated.allocation;
+  }
+
   dense_parameters() : _begin(nullptr), _weight_mask(0), _stride_shift(0), _seeded(false) {}
 
   bool not_null() { return (_weight_mask > 0 && _begin != nullptr); }
@@ -83,17 +133,65 @@ public:
   inline const weight& operator[](size_t i) const { return _begin[i & _weight_mask]; }
   inline weight& operator[](size_t i) { return _begin[i & _weight_mask]; }
 
+  // Hints that operator[](i) is about to be used, so that its cache line is on the way by then.
+  inline void prefetch(size_t i) const
+  {
+#if defined(__GNUC__)
+    __builtin_prefetch(_begin + (i & _weight_mask));
+#elif defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch(reinterpret_cast<const char*>(_begin + (i & _weight_mask)), _MM_HINT_T0);
+#else
+    (void)i;
+#endif
+  }
+
   void shallow_copy(const dense_parameters& input)
   {
-    if (!_seeded) free(_begin);
+    free_owned();
     _begin = input._begin;
     _weight_mask = input._weight_mask;
     _stride_shift = input._stride_shift;
+    _planes_shift = input._planes_shift;
+    _prefetch_distance = input._prefetch_distance;
     _seeded = true;
   }
 
   inline weight& strided_index(size_t index) { return operator[](index << _stride_shift); }
 
+  // Uses the mask() + 1 weights at data, which are owned elsewhere, such as by a shared memory segment.
+  void use_external_memory(weight* data)
+  {
+    free_owned();
+    _begin = data;
+    _external = true;
+  }
+
+  bool external() const { return _external; }
+
+  // Takes ownership of the mask() + 1 weights at data, which are a mapping of mapped_bytes such as of a model file.
+  void use_mapped_memory(weight* data, size_t mapped_bytes)
+  {
+    free_owned();
+    _begin = data;
+    _external = false;
+    _seeded = false;
+    _mapped_bytes = mapped_bytes;
+  }
+
+  // Exchanges the weights of two instances of the same size, such as when a reloaded model replaces this one.
+  void swap_weights(dense_parameters& other)
+  {
+    std::swap(_begin, other._begin);
+    std::swap(_planes_shift, other._planes_shift);
+    std::swap(_seeded, other._seeded);
+    std::swap(_external, other._external);
+    std::swap(_mapped_bytes, other._mapped_bytes);
+    std::swap(_allocation, other._allocation);
+  }
+
+  // How the weights were allocated, as far as the requested huge pages and NUMA placement took effect.
+  const VW::weight_allocation& allocation() const { return _allocation; }
+
   template <typename Lambda>
   void set_default(Lambda&& default_func)
   {
@@ -107,7 +205,8 @@ public:
 
   void set_zero(size_t offset)
   {
-    for (iterator iter = begin(); iter != end(); ++iter) (&(*iter))[offset] = 0;
+    const uint64_t distance = slot_distance();
+    for (iterator iter = begin(); iter != end(); ++iter) (&(*iter))[offset * distance] = 0;
   }
 
   uint64_t mask() const { return _weight_mask; }
@@ -120,26 +219,47 @@ public:
 
   void stride_shift(uint32_t stride_shift) { _stride_shift = stride_shift; }
 
+  uint32_t planes_shift() const { return _planes_shift; }
+
+  // Takes effect when the weights are allocated, along with stride_shift.
+  void planes_shift(uint32_t planes_shift) { _planes_shift = planes_shift; }
+
+  // Slot k of the state of a weight, such as its adaptive sum, is at (&w)[k * slot_distance()]. Interleaved, the slots
+  // follow the weight. In planes, the weights are contiguous and each slot is an array of its own, so predicting only
+  // reads the first plane.
+  uint64_t slot_distance() const { return _planes_shift == 0 ? 1 : _weight_mask + 1; }
+
+  // The number of slots of state per weight, including the weight.
+  uint32_t slots() const { return _planes_shift == 0 ? stride() : 1 << _planes_shift; }
+
+  // How many features ahead the weights are prefetched while iterating over them, 0 if they are not. Defaults to
+  // VW::DEFAULT_PREFETCH_DISTANCE for weights too large to stay in the cache, see --prefetch_weights.
+  uint32_t prefetch_distance() const { return _prefetch_distance; }
+
+  void prefetch_distance(uint32_t distance) { _prefetch_distance = distance; }
+
 #ifndef _WIN32
 #  ifndef DISABLE_SHARED_WEIGHTS
   void share(size_t length)
   {
-    float* shared_weights = (float*)mmap(
-        0, (length << _stride_shift) * sizeof(float), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
-    size_t float_count = length << _stride_shift;
+    size_t float_count = (length << _stride_shift) << _planes_shift;
+    float* shared_weights =
+        (float*)mmap(0, float_count * sizeof(float), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
     weight* dest = shared_weights;
     memcpy(dest, _begin, float_count * sizeof(float));
-    free(_begin);
+    free_owned();
     _begin = dest;
+    _mapped_bytes = float_count * sizeof(float);
   }
 #  endif
 #endif
 
   ~dense_parameters()
   {
-    if (_begin != nullptr && !_seeded)  // don't free weight vector if it is shared with another instance
+    // don't free weight vector if it is shared with another instance or owned elsewhere
+    if (_begin != nullptr)
     {
-      free(_begin);
+      free_owned();
       _begin = nullptr;
     }
   }
@@ -0,0 +1,89 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include "memory.h"
+
+// Models written with --save_quantized store each non zero weight as an int8 and one float scale for every block of
+// QUANTIZED_BLOCK_SIZE consecutive weight indices:
+//
+//   uint32 block count
+//   per block: uint64 block (index >> QUANTIZED_BLOCK_SHIFT), float scale, uint16 weight count,
+//              per weight: uint8 offset within the block, int8 value
+//
+// A weight is value * scale, where the scale maps the largest magnitude in its block to 127.
+
+namespace VW
+{
+constexpr uint32_t QUANTIZED_BLOCK_SHIFT = 8;
+constexpr uint32_t QUANTIZED_BLOCK_SIZE = 1 << QUANTIZED_BLOCK_SHIFT;
+
+inline float quantization_scale(float max_magnitude) { return max_magnitude / 127.f; }
+
+inline int8_t quantize(float value, float scale)
+{
+  const long rounded = std::lround(value / scale);
+  return static_cast<int8_t>(rounded > 127 ? 127 : (rounded < -127 ? -127 : rounded));
+}
+
+inline float dequantize(int8_t value, float scale) { return value * scale; }
+}  // namespace VW
+
+// Dense weights of a quantized model kept quantized in memory, a quarter of the size of dense_parameters. Weights are
+// dequantized as they are read, so predictions accumulate in float. Prediction only: there is no weight& to update.
+class quantized_parameters
+{
+private:
+  int8_t* _values;
+  float* _scales;  // one per block
+  uint64_t _weight_mask;  // (stride*(1 << num_bits) -1)
+  uint32_t _stride_shift;
+
+public:
+  quantized_parameters(size_t length, uint32_t stride_shift = 0)
+      : _values(calloc_or_throw<int8_t>(length << stride_shift))
+      , _scales(calloc_or_throw<float>(((length << stride_shift) + VW::QUANTIZED_BLOCK_SIZE - 1) >>
+            VW::QUANTIZED_BLOCK_SHIFT))
+      , _weight_mask((length << stride_shift) - 1)
+      , _stride_shift(stride_shift)
+  {
+  }
+
+  quantized_parameters() : _values(nullptr), _scales(nullptr), _weight_mask(0), _stride_shift(0) {}
+
+  quantized_parameters(const quantized_parameters& other) = delete;
+  quantized_parameters& operator=(const quantized_parameters& other) = delete;
+  quantized_parameters& operator=(quantized_parameters&&) noexcept = delete;
+  quantized_parameters(quantized_parameters&&) noexcept = delete;
+
+  bool not_null() { return (_weight_mask > 0 && _values != nullptr); }
+
+  inline float operator[](size_t i) const
+  {
+    i &= _weight_mask;
+    return VW::dequantize(_values[i], _scales[i >> VW::QUANTIZED_BLOCK_SHIFT]);
+  }
+
+  void set_scale(uint64_t block, float scale) { _scales[block & (_weight_mask >> VW::QUANTIZED_BLOCK_SHIFT)] = scale; }
+
+  void set(size_t i, int8_t value) { _values[i & _weight_mask] = value; }
+
+  uint64_t mask() const { return _weight_mask; }
+
+  uint32_t stride() const { return 1 << _stride_shift; }
+
+  uint32_t stride_shift() const { return _stride_shift; }
+
+  void stride_shift(uint32_t stride_shift) { _stride_shift = stride_shift; }
+
+  ~quantized_parameters()
+  {
+    free(_values);
+    free(_scales);
+  }
+};
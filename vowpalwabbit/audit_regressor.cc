@@ -48,7 +48,9 @@ inline void audit_regressor_interaction(audit_regressor_data& dat, const audit_s
 inline void audit_regressor_feature(audit_regressor_data& dat, const float, const uint64_t ft_idx)
 {
   parameters& weights = dat.all->weights;
-  if (weights[ft_idx] != 0)
+  // Looked up once: with sparse weights every lookup probes a table.
+  weight& w = weights[ft_idx];
+  if (w != 0)
     ++dat.values_audited;
   else
     return;
@@ -57,7 +59,7 @@ inline void audit_regressor_feature(audit_regressor_data& dat, const float, cons
   for (std::vector<std::string>::const_iterator s = dat.ns_pre->begin(); s != dat.ns_pre->end(); ++s) ns_pre += *s;
 
   std::ostringstream tempstream;
-  tempstream << ':' << ((ft_idx & weights.mask()) >> weights.stride_shift()) << ':' << weights[ft_idx];
+  tempstream << ':' << ((ft_idx & weights.mask()) >> weights.stride_shift()) << ':' << w;
 
   std::string temp = ns_pre + tempstream.str() + '\n';
   if (dat.total_class_cnt > 1)  // add class prefix for multiclass problems
@@ -65,7 +67,7 @@ inline void audit_regressor_feature(audit_regressor_data& dat, const float, cons
 
   dat.out_file->bin_write_fixed(temp.c_str(), (uint32_t)temp.size());
 
-  weights[ft_idx] = 0.;  // mark value audited
+  w = 0.;  // mark value audited
 }
 
 void audit_regressor_lda(audit_regressor_data& rd, VW::LEARNER::single_learner& /* base */, example& ec)
@@ -0,0 +1,28 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "audit_strings_cache.h"
+
+#include <memory>
+
+namespace VW
+{
+constexpr size_t audit_strings_cache::MAX_ENTRIES;
+
+audit_strings_ptr audit_strings_cache::get(VW::string_view ns, VW::string_view name)
+{
+  // The namespace and the name are separated by a byte neither of them holds.
+  _key.assign(ns.begin(), ns.size());
+  _key.push_back('\0');
+  _key.append(name.begin(), name.size());
+
+  auto it = _entries.find(_key);
+  if (it != _entries.end()) return it->second;
+
+  if (_entries.size() >= MAX_ENTRIES) _entries.clear();
+  auto strings = std::make_shared<audit_strings>(ns.to_string(), name.to_string());
+  _entries.emplace(_key, strings);
+  return strings;
+}
+}  // namespace VW
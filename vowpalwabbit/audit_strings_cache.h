@@ -0,0 +1,31 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "feature_group.h"
+#include "vw_string_view.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace VW
+{
+// Interns the audit strings of the parsers, so that a feature whose namespace and name were seen before shares their
+// strings instead of allocating two strings and a shared pointer of its own. Features never change the strings they
+// share. The table is emptied when it reaches MAX_ENTRIES names, the examples keep the strings they were given.
+class audit_strings_cache
+{
+public:
+  static constexpr size_t MAX_ENTRIES = 1 << 16;
+
+  audit_strings_ptr get(VW::string_view ns, VW::string_view name);
+
+  size_t size() const { return _entries.size(); }
+
+private:
+  std::unordered_map<std::string, audit_strings_ptr> _entries;
+  std::string _key;  // reused so that looking up a name does not allocate
+};
+}  // namespace VW
@@ -183,6 +183,30 @@ float sensitivity(baseline& data, base_learner& base, example& ec)
   return baseline_sens + sens;
 }
 
+// Predicts as predict_or_learn<false> does, finding the sensitivity of the residual along with the prediction of ec.
+float predict_with_sensitivity(baseline& data, base_learner& base, example& ec)
+{
+  single_learner& residual = *as_singleline(&base);
+  if (data.check_enabled && !BASELINE::baseline_enabled(&ec)) return residual.predict_with_sensitivity(ec);
+
+  if (!data.global_only) THROW("sensitivity for baseline without --global_only not implemented");
+
+  if (!data.global_initialized)
+  {
+    init_global(data);
+    data.global_initialized = true;
+  }
+  VW::copy_example_metadata(/*audit=*/false, data.ec, &ec);
+  residual.predict(*data.ec);
+  ec.l.simple.initial = data.ec->pred.scalar;
+  const float sens = residual.predict_with_sensitivity(ec);
+
+  // the baseline term has its global constant alone, at the prediction of ec
+  data.ec->l.simple.label = sensitivity_label(ec);
+  data.ec->pred.scalar = ec.pred.scalar;
+  return base.sensitivity(*data.ec) + sens;
+}
+
 base_learner* baseline_setup(options_i& options, vw& all)
 {
   auto data = scoped_calloc_or_throw<baseline>();
@@ -219,6 +243,7 @@ base_learner* baseline_setup(options_i& options, vw& all)
   learner<baseline, example>& l = init_learner(data, base, predict_or_learn<true>, predict_or_learn<false>);
 
   l.set_sensitivity(sensitivity);
+  l.set_predict_with_sensitivity(predict_with_sensitivity);
 
   return make_base(l);
 }
@@ -20,8 +20,12 @@ Implementation by Miro Dudik.
 #include "reductions.h"
 #include "gd.h"
 #include "vw_exception.h"
+#include "thread_affinity.h"
+#include <array>
 #include <exception>
 #include <chrono>
+#include <thread>
+#include <vector>
 
 using namespace VW::LEARNER;
 using namespace VW::config;
@@ -59,6 +63,11 @@ class curv_exception : public std::exception
 
 constexpr float max_precond_ratio = 10000.f;
 
+// Sums of a pass over the weights, see over_weight_ranges().
+using pass_sums = std::array<double, 4>;
+// Dense weights are not split into ranges of fewer than this many, which would not be worth a thread.
+constexpr uint64_t MIN_RANGE_WEIGHTS = 1 << 14;
+
 struct bfgs
 {
   vw* all;  // prediction, regressor
@@ -103,6 +112,9 @@ struct bfgs
   bool gradient_pass;
   bool preconditioner_pass;
 
+  size_t threads;  // set by --bfgs_threads
+  std::vector<pass_sums> range_sums;
+
   ~bfgs()
   {
     predictions.delete_v();
@@ -118,6 +130,48 @@ constexpr const char* curv_message =
     "It is also possible that you have reached numerical accuracy\n"
     "and further decrease in the objective cannot be reliably detected.\n";
 
+// The passes over every weight split dense weights into consecutive ranges, one for each of the --bfgs_threads threads,
+// the first of which is passed over by the calling thread. Each range adds to sums of its own, which are returned in the
+// order of the ranges. Sparse weights are passed over in one range.
+template <typename F>
+const std::vector<pass_sums>& over_weight_ranges(bfgs& b, sparse_parameters& weights, F pass)
+{
+  b.range_sums.assign(1, pass_sums{});
+  pass(weights.begin(), weights.end(), b.range_sums[0]);
+  return b.range_sums;
+}
+
+template <typename F>
+const std::vector<pass_sums>& over_weight_ranges(bfgs& b, dense_parameters& weights, F pass)
+{
+  const uint64_t length = (weights.mask() >> weights.stride_shift()) + 1;
+  const size_t threads = (size_t)std::max<uint64_t>(1, std::min<uint64_t>(b.threads, length / MIN_RANGE_WEIGHTS));
+  b.range_sums.assign(threads, pass_sums{});
+  auto pass_range = [&](size_t t) {
+    weight* first = weights.first();
+    const uint64_t from = length * t / threads;
+    const uint64_t to = length * (t + 1) / threads;
+    pass(dense_parameters::iterator(first + (from << weights.stride_shift()), first, weights.stride()),
+        dense_parameters::iterator(first + (to << weights.stride_shift()), first, weights.stride()), b.range_sums[t]);
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++)
+    workers.push_back(VW::start_pinned_thread(VW::thread_role::worker, pass_range, t));
+  pass_range(0);
+  for (auto& worker : workers) worker.join();
+  return b.range_sums;
+}
+
+// The sums of a pass over every weight, which are those of one thread passing over them in order with --bfgs_threads 1.
+template <typename T, typename F>
+pass_sums over_weights(bfgs& b, T& weights, F pass)
+{
+  pass_sums total{};
+  for (const auto& sums : over_weight_ranges(b, weights, pass))
+    for (size_t k = 0; k < total.size(); k++) total[k] += sums[k];
+  return total;
+}
+
 void zero_derivative(vw& all) { all.weights.set_zero(W_GT); }
 
 void zero_preconditioner(vw& all) { all.weights.set_zero(W_COND); }
@@ -185,18 +239,18 @@ float dot_with_direction(vw& all, example& ec)
 template <class T>
 double regularizer_direction_magnitude(vw& /* all */, bfgs& b, double regularizer, T& weights)
 {
-  double ret = 0.;
-  if (b.regularizers == nullptr)
-    for (typename T::iterator iter = weights.begin(); iter != weights.end(); ++iter)
-      ret += regularizer * (&(*iter))[W_DIR] * (&(*iter))[W_DIR];
+  return over_weights(b, weights, [&](typename T::iterator begin, typename T::iterator end, pass_sums& sums) {
+    if (b.regularizers == nullptr)
+      for (typename T::iterator iter = begin; iter != end; ++iter)
+        sums[0] += regularizer * (&(*iter))[W_DIR] * (&(*iter))[W_DIR];
 
-  else
-  {
-    for (typename T::iterator iter = weights.begin(); iter != weights.end(); ++iter)
-      ret += ((double)b.regularizers[2 * (iter.index() >> weights.stride_shift())]) * (&(*iter))[W_DIR] *
-          (&(*iter))[W_DIR];
-  }
-  return ret;
+    else
+    {
+      for (typename T::iterator iter = begin; iter != end; ++iter)
+        sums[0] += ((double)b.regularizers[2 * (iter.index() >> weights.stride_shift())]) * (&(*iter))[W_DIR] *
+            (&(*iter))[W_DIR];
+    }
+  })[0];
 }
 
 double regularizer_direction_magnitude(vw& all, bfgs& b, float regularizer)
@@ -213,42 +267,46 @@ double regularizer_direction_magnitude(vw& all, bfgs& b, float regularizer)
 }
 
 template <class T>
-float direction_magnitude(vw& /* all */, T& weights)
+float direction_magnitude(vw& /* all */, bfgs& b, T& weights)
 {
   // compute direction magnitude
-  double ret = 0.;
-  for (typename T::iterator iter = weights.begin(); iter != weights.end(); ++iter)
-    ret += ((double)(&(*iter))[W_DIR]) * (&(*iter))[W_DIR];
-
-  return (float)ret;
+  return (float)over_weights(b, weights, [](typename T::iterator begin, typename T::iterator end, pass_sums& sums) {
+    for (typename T::iterator iter = begin; iter != end; ++iter)
+      sums[0] += ((double)(&(*iter))[W_DIR]) * (&(*iter))[W_DIR];
+  })[0];
 }
 
-float direction_magnitude(vw& all)
+float direction_magnitude(vw& all, bfgs& b)
 {
   // compute direction magnitude
   if (all.weights.sparse)
-    return direction_magnitude(all, all.weights.sparse_weights);
+    return direction_magnitude(all, b, all.weights.sparse_weights);
   else
-    return direction_magnitude(all, all.weights.dense_weights);
+    return direction_magnitude(all, b, all.weights.dense_weights);
 }
 
 template <class T>
 void bfgs_iter_start(vw& all, bfgs& b, float* mem, int& lastj, double importance_weight_sum, int& origin, T& weights)
 {
-  double g1_Hg1 = 0.;
-  double g1_g1 = 0.;
-
   origin = 0;
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    float* mem1 = mem + (w.index() >> weights.stride_shift()) * b.mem_stride;
-    if (b.m > 0) mem1[(MEM_XT + origin) % b.mem_stride] = (&(*w))[W_XT];
-    mem1[(MEM_GT + origin) % b.mem_stride] = (&(*w))[W_GT];
-    g1_Hg1 += ((double)(&(*w))[W_GT]) * ((&(*w))[W_GT]) * ((&(*w))[W_COND]);
-    g1_g1 += ((double)((&(*w))[W_GT])) * ((&(*w))[W_GT]);
-    (&(*w))[W_DIR] = -(&(*w))[W_COND] * ((&(*w))[W_GT]);
-    ((&(*w))[W_GT]) = 0;
-  }
+  // The slots of mem are the same for every weight, they are found once for each pass.
+  const int mem_xt = (MEM_XT + origin) % b.mem_stride;
+  const int mem_gt = (MEM_GT + origin) % b.mem_stride;
+  const pass_sums totals =
+      over_weights(b, weights, [&](typename T::iterator begin, typename T::iterator end, pass_sums& sums) {
+        for (typename T::iterator w = begin; w != end; ++w)
+        {
+          float* mem1 = mem + (w.index() >> weights.stride_shift()) * b.mem_stride;
+          if (b.m > 0) mem1[mem_xt] = (&(*w))[W_XT];
+          mem1[mem_gt] = (&(*w))[W_GT];
+          sums[0] += ((double)(&(*w))[W_GT]) * ((&(*w))[W_GT]) * ((&(*w))[W_COND]);
+          sums[1] += ((double)((&(*w))[W_GT])) * ((&(*w))[W_GT]);
+          (&(*w))[W_DIR] = -(&(*w))[W_COND] * ((&(*w))[W_GT]);
+          ((&(*w))[W_GT]) = 0;
+        }
+      });
+  const double g1_Hg1 = totals[0];
+  const double g1_g1 = totals[1];
   lastj = 0;
   if (!all.logger.quiet)
     fprintf(stderr, "%-10.5f\t%-10.5f\t%-10s\t%-10s\t%-10s\t", g1_g1 / (importance_weight_sum * importance_weight_sum),
@@ -266,36 +324,41 @@ void bfgs_iter_start(vw& all, bfgs& b, float* mem, int& lastj, double importance
 template <class T>
 void bfgs_iter_middle(vw& all, bfgs& b, float* mem, double* rho, double* alpha, int& lastj, int& origin, T& weights)
 {
-  float* mem0 = mem;
+  using iterator = typename T::iterator;
+  // The slots of mem are the same for every weight, they are found once for each pass.
+  auto slot = [&b, &origin](int offset) { return (offset + origin) % b.mem_stride; };
+  auto mem_of = [mem, &b, &weights](iterator& w) { return mem + (w.index() >> weights.stride_shift()) * b.mem_stride; };
+
   // implement conjugate gradient
   if (b.m == 0)
   {
-    double g_Hy = 0.;
-    double g_Hg = 0.;
-    double y = 0.;
-
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      mem = mem0 + (w.index() >> weights.stride_shift()) * b.mem_stride;
-      y = (&(*w))[W_GT] - mem[(MEM_GT + origin) % b.mem_stride];
-      g_Hy += ((double)(&(*w))[W_GT]) * ((&(*w))[W_COND]) * y;
-      g_Hg +=
-          ((double)mem[(MEM_GT + origin) % b.mem_stride]) * ((&(*w))[W_COND]) * mem[(MEM_GT + origin) % b.mem_stride];
-    }
+    const int mem_gt = slot(MEM_GT);
+    const pass_sums totals = over_weights(b, weights, [&](iterator begin, iterator end, pass_sums& sums) {
+      for (iterator w = begin; w != end; ++w)
+      {
+        float* mem1 = mem_of(w);
+        double y = (&(*w))[W_GT] - mem1[mem_gt];
+        sums[0] += ((double)(&(*w))[W_GT]) * ((&(*w))[W_COND]) * y;
+        sums[1] += ((double)mem1[mem_gt]) * ((&(*w))[W_COND]) * mem1[mem_gt];
+      }
+    });
+    const double g_Hy = totals[0];
+    const double g_Hg = totals[1];
 
     float beta = (float)(g_Hy / g_Hg);
 
     if (beta < 0.f || std::isnan(beta)) beta = 0.f;
 
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      mem = mem0 + (w.index() >> weights.stride_shift()) * b.mem_stride;
-      mem[(MEM_GT + origin) % b.mem_stride] = (&(*w))[W_GT];
+    over_weights(b, weights, [&](iterator begin, iterator end, pass_sums&) {
+      for (iterator w = begin; w != end; ++w)
+      {
+        mem_of(w)[mem_gt] = (&(*w))[W_GT];
 
-      (&(*w))[W_DIR] *= beta;
-      (&(*w))[W_DIR] -= ((&(*w))[W_COND]) * ((&(*w))[W_GT]);
-      (&(*w))[W_GT] = 0;
-    }
+        (&(*w))[W_DIR] *= beta;
+        (&(*w))[W_DIR] -= ((&(*w))[W_COND]) * ((&(*w))[W_GT]);
+        (&(*w))[W_GT] = 0;
+      }
+    });
     if (!all.logger.quiet) fprintf(stderr, "%f\t", beta);
     return;
   }
@@ -305,21 +368,25 @@ void bfgs_iter_middle(vw& all, bfgs& b, float* mem, double* rho, double* alpha,
   }
 
   // implement bfgs
-  double y_s = 0.;
-  double y_Hy = 0.;
-  double s_q = 0.;
-
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    float* mem1 = mem + (w.index() >> weights.stride_shift()) * b.mem_stride;
-    mem1[(MEM_YT + origin) % b.mem_stride] = (&(*w))[W_GT] - mem1[(MEM_GT + origin) % b.mem_stride];
-    mem1[(MEM_ST + origin) % b.mem_stride] = (&(*w))[W_XT] - mem1[(MEM_XT + origin) % b.mem_stride];
-    (&(*w))[W_DIR] = (&(*w))[W_GT];
-    y_s += ((double)mem1[(MEM_YT + origin) % b.mem_stride]) * mem1[(MEM_ST + origin) % b.mem_stride];
-    y_Hy +=
-        ((double)mem1[(MEM_YT + origin) % b.mem_stride]) * mem1[(MEM_YT + origin) % b.mem_stride] * ((&(*w))[W_COND]);
-    s_q += ((double)mem1[(MEM_ST + origin) % b.mem_stride]) * ((&(*w))[W_GT]);
-  }
+  const int mem_yt = slot(MEM_YT);
+  const int mem_st = slot(MEM_ST);
+  const int mem_gt = slot(MEM_GT);
+  const int mem_xt = slot(MEM_XT);
+  const pass_sums totals = over_weights(b, weights, [&](iterator begin, iterator end, pass_sums& sums) {
+    for (iterator w = begin; w != end; ++w)
+    {
+      float* mem1 = mem_of(w);
+      mem1[mem_yt] = (&(*w))[W_GT] - mem1[mem_gt];
+      mem1[mem_st] = (&(*w))[W_XT] - mem1[mem_xt];
+      (&(*w))[W_DIR] = (&(*w))[W_GT];
+      sums[0] += ((double)mem1[mem_yt]) * mem1[mem_st];
+      sums[1] += ((double)mem1[mem_yt]) * mem1[mem_yt] * ((&(*w))[W_COND]);
+      sums[2] += ((double)mem1[mem_st]) * ((&(*w))[W_GT]);
+    }
+  });
+  const double y_s = totals[0];
+  const double y_Hy = totals[1];
+  double s_q = totals[2];
 
   if (y_s <= 0. || y_Hy <= 0.) throw curv_ex;
   rho[0] = 1 / y_s;
@@ -329,46 +396,55 @@ void bfgs_iter_middle(vw& all, bfgs& b, float* mem, double* rho, double* alpha,
   for (int j = 0; j < lastj; j++)
   {
     alpha[j] = rho[j] * s_q;
-    s_q = 0.;
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      mem = mem0 + (w.index() >> weights.stride_shift()) * b.mem_stride;
-      (&(*w))[W_DIR] -= (float)alpha[j] * mem[(2 * j + MEM_YT + origin) % b.mem_stride];
-      s_q += ((double)mem[(2 * j + 2 + MEM_ST + origin) % b.mem_stride]) * ((&(*w))[W_DIR]);
-    }
+    const float alpha_j = (float)alpha[j];
+    const int mem_yt_j = slot(2 * j + MEM_YT);
+    const int mem_st_j = slot(2 * j + 2 + MEM_ST);
+    s_q = over_weights(b, weights, [&](iterator begin, iterator end, pass_sums& sums) {
+      for (iterator w = begin; w != end; ++w)
+      {
+        float* mem1 = mem_of(w);
+        (&(*w))[W_DIR] -= alpha_j * mem1[mem_yt_j];
+        sums[0] += ((double)mem1[mem_st_j]) * ((&(*w))[W_DIR]);
+      }
+    })[0];
   }
 
   alpha[lastj] = rho[lastj] * s_q;
-  double y_r = 0.;
-
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    mem = mem0 + (w.index() >> weights.stride_shift()) * b.mem_stride;
-    (&(*w))[W_DIR] -= (float)alpha[lastj] * mem[(2 * lastj + MEM_YT + origin) % b.mem_stride];
-    (&(*w))[W_DIR] *= gamma * ((&(*w))[W_COND]);
-    y_r += ((double)mem[(2 * lastj + MEM_YT + origin) % b.mem_stride]) * ((&(*w))[W_DIR]);
-  }
+  const float alpha_last = (float)alpha[lastj];
+  const int mem_yt_last = slot(2 * lastj + MEM_YT);
+  double y_r = over_weights(b, weights, [&](iterator begin, iterator end, pass_sums& sums) {
+    for (iterator w = begin; w != end; ++w)
+    {
+      float* mem1 = mem_of(w);
+      (&(*w))[W_DIR] -= alpha_last * mem1[mem_yt_last];
+      (&(*w))[W_DIR] *= gamma * ((&(*w))[W_COND]);
+      sums[0] += ((double)mem1[mem_yt_last]) * ((&(*w))[W_DIR]);
+    }
+  })[0];
 
   double coef_j;
 
   for (int j = lastj; j > 0; j--)
   {
     coef_j = alpha[j] - rho[j] * y_r;
-    y_r = 0.;
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      mem = mem0 + (w.index() >> weights.stride_shift()) * b.mem_stride;
-      (&(*w))[W_DIR] += (float)coef_j * mem[(2 * j + MEM_ST + origin) % b.mem_stride];
-      y_r += ((double)mem[(2 * j - 2 + MEM_YT + origin) % b.mem_stride]) * ((&(*w))[W_DIR]);
-    }
+    const float coef = (float)coef_j;
+    const int mem_st_j = slot(2 * j + MEM_ST);
+    const int mem_yt_j = slot(2 * j - 2 + MEM_YT);
+    y_r = over_weights(b, weights, [&](iterator begin, iterator end, pass_sums& sums) {
+      for (iterator w = begin; w != end; ++w)
+      {
+        float* mem1 = mem_of(w);
+        (&(*w))[W_DIR] += coef * mem1[mem_st_j];
+        sums[0] += ((double)mem1[mem_yt_j]) * ((&(*w))[W_DIR]);
+      }
+    })[0];
   }
 
   coef_j = alpha[0] - rho[0] * y_r;
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    mem = mem0 + (w.index() >> weights.stride_shift()) * b.mem_stride;
-    (&(*w))[W_DIR] = -(&(*w))[W_DIR] - (float)coef_j * mem[(MEM_ST + origin) % b.mem_stride];
-  }
+  const float coef_0 = (float)coef_j;
+  over_weights(b, weights, [&](iterator begin, iterator end, pass_sums&) {
+    for (iterator w = begin; w != end; ++w) (&(*w))[W_DIR] = -(&(*w))[W_DIR] - coef_0 * mem_of(w)[mem_st];
+  });
 
   /*********************
   ** shift
@@ -377,13 +453,17 @@ void bfgs_iter_middle(vw& all, bfgs& b, float* mem, double* rho, double* alpha,
   lastj = (lastj < b.m - 1) ? lastj + 1 : b.m - 1;
   origin = (origin + b.mem_stride - 2) % b.mem_stride;
 
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    mem = mem0 + (w.index() >> weights.stride_shift()) * b.mem_stride;
-    mem[(MEM_GT + origin) % b.mem_stride] = (&(*w))[W_GT];
-    mem[(MEM_XT + origin) % b.mem_stride] = (&(*w))[W_XT];
-    (&(*w))[W_GT] = 0;
-  }
+  const int shifted_gt = slot(MEM_GT);
+  const int shifted_xt = slot(MEM_XT);
+  over_weights(b, weights, [&](iterator begin, iterator end, pass_sums&) {
+    for (iterator w = begin; w != end; ++w)
+    {
+      float* mem1 = mem_of(w);
+      mem1[shifted_gt] = (&(*w))[W_GT];
+      mem1[shifted_xt] = (&(*w))[W_XT];
+      (&(*w))[W_GT] = 0;
+    }
+  });
   for (int j = lastj; j > 0; j--) rho[j] = rho[j - 1];
 }
 
@@ -399,19 +479,22 @@ template <class T>
 double wolfe_eval(vw& all, bfgs& b, float* mem, double loss_sum, double previous_loss_sum, double step_size,
     double importance_weight_sum, int& origin, double& wolfe1, T& weights)
 {
-  double g0_d = 0.;
-  double g1_d = 0.;
-  double g1_Hg1 = 0.;
-  double g1_g1 = 0.;
-
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    float* mem1 = mem + (w.index() >> weights.stride_shift()) * b.mem_stride;
-    g0_d += ((double)mem1[(MEM_GT + origin) % b.mem_stride]) * ((&(*w))[W_DIR]);
-    g1_d += ((double)(&(*w))[W_GT]) * (&(*w))[W_DIR];
-    g1_Hg1 += ((double)(&(*w))[W_GT]) * (&(*w))[W_GT] * ((&(*w))[W_COND]);
-    g1_g1 += ((double)(&(*w))[W_GT]) * (&(*w))[W_GT];
-  }
+  const int mem_gt = (MEM_GT + origin) % b.mem_stride;
+  const pass_sums totals =
+      over_weights(b, weights, [&](typename T::iterator begin, typename T::iterator end, pass_sums& sums) {
+        for (typename T::iterator w = begin; w != end; ++w)
+        {
+          float* mem1 = mem + (w.index() >> weights.stride_shift()) * b.mem_stride;
+          sums[0] += ((double)mem1[mem_gt]) * ((&(*w))[W_DIR]);
+          sums[1] += ((double)(&(*w))[W_GT]) * (&(*w))[W_DIR];
+          sums[2] += ((double)(&(*w))[W_GT]) * (&(*w))[W_GT] * ((&(*w))[W_COND]);
+          sums[3] += ((double)(&(*w))[W_GT]) * (&(*w))[W_GT];
+        }
+      });
+  const double g0_d = totals[0];
+  const double g1_d = totals[1];
+  const double g1_Hg1 = totals[2];
+  const double g1_g1 = totals[3];
 
   wolfe1 = (loss_sum - previous_loss_sum) / (step_size * g0_d);
   double wolfe2 = g1_d / g0_d;
@@ -438,22 +521,22 @@ template <class T>
 double add_regularization(vw& all, bfgs& b, float regularization, T& weights)
 {
   // compute the derivative difference
-  double ret = 0.;
-
-  if (b.regularizers == nullptr)
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      (&(*w))[W_GT] += regularization * (*w);
-      ret += 0.5 * regularization * (*w) * (*w);
-    }
-  else
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      uint64_t i = w.index() >> weights.stride_shift();
-      weight delta_weight = *w - b.regularizers[2 * i + 1];
-      (&(*w))[W_GT] += b.regularizers[2 * i] * delta_weight;
-      ret += 0.5 * b.regularizers[2 * i] * delta_weight * delta_weight;
-    }
+  double ret = over_weights(b, weights, [&](typename T::iterator begin, typename T::iterator end, pass_sums& sums) {
+    if (b.regularizers == nullptr)
+      for (typename T::iterator w = begin; w != end; ++w)
+      {
+        (&(*w))[W_GT] += regularization * (*w);
+        sums[0] += 0.5 * regularization * (*w) * (*w);
+      }
+    else
+      for (typename T::iterator w = begin; w != end; ++w)
+      {
+        uint64_t i = w.index() >> weights.stride_shift();
+        weight delta_weight = *w - b.regularizers[2 * i + 1];
+        (&(*w))[W_GT] += b.regularizers[2 * i] * delta_weight;
+        sums[0] += 0.5 * b.regularizers[2 * i] * delta_weight * delta_weight;
+      }
+  })[0];
 
   // if we're not regularizing the intercept term, then subtract it off from the result above
   // when accessing weights[constant], always use weights.strided_index(constant)
@@ -487,29 +570,37 @@ double add_regularization(vw& all, bfgs& b, float regularization)
 template <class T>
 void finalize_preconditioner(vw& /* all */, bfgs& b, float regularization, T& weights)
 {
+  using iterator = typename T::iterator;
+  // The largest hessian of each range is its first sum.
   float max_hessian = 0.f;
-
-  if (b.regularizers == nullptr)
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      (&(*w))[W_COND] += regularization;
-      if ((&(*w))[W_COND] > max_hessian) max_hessian = (&(*w))[W_COND];
-      if ((&(*w))[W_COND] > 0) (&(*w))[W_COND] = 1.f / (&(*w))[W_COND];
-    }
-  else
-    for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-    {
-      (&(*w))[W_COND] += b.regularizers[2 * (w.index() >> weights.stride_shift())];
-      if ((&(*w))[W_COND] > max_hessian) max_hessian = (&(*w))[W_COND];
-      if ((&(*w))[W_COND] > 0) (&(*w))[W_COND] = 1.f / (&(*w))[W_COND];
-    }
+  for (const auto& sums : over_weight_ranges(b, weights, [&](iterator begin, iterator end, pass_sums& sums) {
+         float range_max = 0.f;
+         if (b.regularizers == nullptr)
+           for (iterator w = begin; w != end; ++w)
+           {
+             (&(*w))[W_COND] += regularization;
+             if ((&(*w))[W_COND] > range_max) range_max = (&(*w))[W_COND];
+             if ((&(*w))[W_COND] > 0) (&(*w))[W_COND] = 1.f / (&(*w))[W_COND];
+           }
+         else
+           for (iterator w = begin; w != end; ++w)
+           {
+             (&(*w))[W_COND] += b.regularizers[2 * (w.index() >> weights.stride_shift())];
+             if ((&(*w))[W_COND] > range_max) range_max = (&(*w))[W_COND];
+             if ((&(*w))[W_COND] > 0) (&(*w))[W_COND] = 1.f / (&(*w))[W_COND];
+           }
+         sums[0] = range_max;
+       }))
+    if ((float)sums[0] > max_hessian) max_hessian = (float)sums[0];
 
   float max_precond = (max_hessian == 0.f) ? 0.f : max_precond_ratio / max_hessian;
 
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    if (std::isinf(*w) || *w > max_precond) (&(*w))[W_COND] = max_precond;
-  }
+  over_weights(b, weights, [&](iterator begin, iterator end, pass_sums&) {
+    for (iterator w = begin; w != end; ++w)
+    {
+      if (std::isinf(*w) || *w > max_precond) (&(*w))[W_COND] = max_precond;
+    }
+  });
 }
 void finalize_preconditioner(vw& all, bfgs& b, float regularization)
 {
@@ -586,13 +677,14 @@ void zero_state(vw& all)
 template <class T>
 double derivative_in_direction(vw& /* all */, bfgs& b, float* mem, int& origin, T& weights)
 {
-  double ret = 0.;
-  for (typename T::iterator w = weights.begin(); w != weights.end(); ++w)
-  {
-    float* mem1 = mem + (w.index() >> weights.stride_shift()) * b.mem_stride;
-    ret += ((double)mem1[(MEM_GT + origin) % b.mem_stride]) * (&(*w))[W_DIR];
-  }
-  return ret;
+  const int mem_gt = (MEM_GT + origin) % b.mem_stride;
+  return over_weights(b, weights, [&](typename T::iterator begin, typename T::iterator end, pass_sums& sums) {
+    for (typename T::iterator w = begin; w != end; ++w)
+    {
+      float* mem1 = mem + (w.index() >> weights.stride_shift()) * b.mem_stride;
+      sums[0] += ((double)mem1[mem_gt]) * (&(*w))[W_DIR];
+    }
+  })[0];
 }
 
 double derivative_in_direction(vw& all, bfgs& b, float* mem, int& origin)
@@ -604,18 +696,19 @@ double derivative_in_direction(vw& all, bfgs& b, float* mem, int& origin)
 }
 
 template <class T>
-void update_weight(vw& /* all */, float step_size, T& w)
+void update_weight(vw& /* all */, bfgs& b, float step_size, T& w)
 {
-  for (typename T::iterator iter = w.begin(); iter != w.end(); ++iter)
-    (&(*iter))[W_XT] += step_size * (&(*iter))[W_DIR];
+  over_weights(b, w, [step_size](typename T::iterator begin, typename T::iterator end, pass_sums&) {
+    for (typename T::iterator iter = begin; iter != end; ++iter) (&(*iter))[W_XT] += step_size * (&(*iter))[W_DIR];
+  });
 }
 
-void update_weight(vw& all, float step_size)
+void update_weight(vw& all, bfgs& b, float step_size)
 {
   if (all.weights.sparse)
-    update_weight(all, step_size, all.weights.sparse_weights);
+    update_weight(all, b, step_size, all.weights.sparse_weights);
   else
-    update_weight(all, step_size, all.weights.dense_weights);
+    update_weight(all, b, step_size, all.weights.dense_weights);
 }
 
 int process_pass(vw& all, bfgs& b)
@@ -657,13 +750,13 @@ int process_pass(vw& all, bfgs& b)
     else
     {
       b.step_size = 0.5;
-      float d_mag = direction_magnitude(all);
+      float d_mag = direction_magnitude(all, b);
       b.t_end_global = std::chrono::system_clock::now();
       b.net_time = static_cast<double>(
           std::chrono::duration_cast<std::chrono::milliseconds>(b.t_end_global - b.t_start_global).count());
       if (!all.logger.quiet) fprintf(stderr, "%-10s\t%-10.5f\t%-.5f\n", "", d_mag, b.step_size);
       b.predictions.clear();
-      update_weight(all, b.step_size);
+      update_weight(all, b, b.step_size);
     }
   }
   else
@@ -721,7 +814,7 @@ int process_pass(vw& all, bfgs& b)
       float ratio = (b.step_size == 0.f) ? 0.f : (float)new_step / (float)b.step_size;
       if (!all.logger.quiet) fprintf(stderr, "%-10s\t%-10s\t(revise x %.1f)\t%-.5f\n", "", "", ratio, new_step);
       b.predictions.clear();
-      update_weight(all, (float)(-b.step_size + new_step));
+      update_weight(all, b, (float)(-b.step_size + new_step));
       b.step_size = (float)new_step;
       zero_derivative(all);
       b.loss_sum = 0.;
@@ -765,13 +858,13 @@ int process_pass(vw& all, bfgs& b)
       }
       else
       {
-        float d_mag = direction_magnitude(all);
+        float d_mag = direction_magnitude(all, b);
         b.t_end_global = std::chrono::system_clock::now();
         b.net_time = static_cast<double>(
             std::chrono::duration_cast<std::chrono::milliseconds>(b.t_end_global - b.t_start_global).count());
         if (!all.logger.quiet) fprintf(stderr, "%-10s\t%-10.5f\t%-.5f\n", "", d_mag, b.step_size);
         b.predictions.clear();
-        update_weight(all, b.step_size);
+        update_weight(all, b, b.step_size);
       }
     }
   }
@@ -803,10 +896,10 @@ int process_pass(vw& all, bfgs& b)
     else
       b.step_size = -dd / (float)b.curvature;
 
-    float d_mag = direction_magnitude(all);
+    float d_mag = direction_magnitude(all, b);
 
     b.predictions.clear();
-    update_weight(all, b.step_size);
+    update_weight(all, b, b.step_size);
     b.t_end_global = std::chrono::system_clock::now();
     b.net_time = static_cast<double>(
         std::chrono::duration_cast<std::chrono::milliseconds>(b.t_end_global - b.t_start_global).count());
@@ -1069,6 +1162,10 @@ base_learner* bfgs_setup(options_i& options, vw& all)
   bfgs_inner_options.add(make_option("mem", b->m).default_value(15).help("memory in bfgs"));
   bfgs_inner_options.add(
       make_option("termination", b->rel_threshold).default_value(0.001f).help("Termination threshold"));
+  bfgs_inner_options.add(make_option("bfgs_threads", b->threads)
+                             .default_value(1)
+                             .help("Threads passing over the dense weights between passes over the examples, 0 for one "
+                                   "per core"));
 
   if (!options.add_parse_and_check_necessary(bfgs_outer_options))
     if (!options.add_parse_and_check_necessary(bfgs_inner_options)) return nullptr;
@@ -1090,6 +1187,7 @@ base_learner* bfgs_setup(options_i& options, vw& all)
   }
 
   if (b->m == 0) all.hessian_on = true;
+  if (b->threads == 0) b->threads = std::max(1u, std::thread::hardware_concurrency());
 
   if (!all.logger.quiet)
   {
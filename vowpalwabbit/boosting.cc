@@ -62,8 +62,18 @@ struct boosting
   std::vector<float> alpha;
   std::vector<float> v;
   int t;
+  polyprediction* pred;  // of every weak learner, when predicted together
+
+  ~boosting() { free(pred); }
 };
 
+// The weak learners do not share weights, so learning one leaves the predictions of the others as they were, and all
+// of them are predicted in one walk over the features before any of them learns.
+void predict_all(boosting& o, VW::LEARNER::single_learner& base, example& ec)
+{
+  base.multipredict(ec, 0, o.N, o.pred, true);
+}
+
 //---------------------------------------------------
 // Online Boost-by-Majority (BBM)
 // --------------------------------------------------
@@ -78,6 +88,7 @@ void predict_or_learn(boosting& o, VW::LEARNER::single_learner& base, example& e
   float u = ec.weight;
 
   if (is_learn) o.t++;
+  predict_all(o, base, ec);
 
   for (int i = 0; i < o.N; i++)
   {
@@ -105,20 +116,16 @@ void predict_or_learn(boosting& o, VW::LEARNER::single_learner& base, example& e
       // update ec.weight, weight for learner i (starting from 0)
       ec.weight = u * w;
 
-      base.predict(ec, i);
-
-      // ec.pred.scalar is now the i-th learner prediction on this example
-      s += ld.label * ec.pred.scalar;
+      // o.pred[i].scalar is the i-th learner prediction on this example
+      s += ld.label * o.pred[i].scalar;
 
-      final_prediction += ec.pred.scalar;
+      final_prediction += o.pred[i].scalar;
 
-      base.learn(ec, i);
+      // a learner whose binomial weight is zero has nothing to learn
+      if (ec.weight > 0) base.learn(ec, i);
     }
     else
-    {
-      base.predict(ec, i);
-      final_prediction += ec.pred.scalar;
-    }
+      final_prediction += o.pred[i].scalar;
   }
 
   ec.weight = u;
@@ -146,6 +153,7 @@ void predict_or_learn_logistic(boosting& o, VW::LEARNER::single_learner& base, e
 
   if (is_learn) o.t++;
   float eta = 4.f / sqrtf((float)o.t);
+  predict_all(o, base, ec);
 
   for (int i = 0; i < o.N; i++)
   {
@@ -155,28 +163,24 @@ void predict_or_learn_logistic(boosting& o, VW::LEARNER::single_learner& base, e
 
       ec.weight = u * w;
 
-      base.predict(ec, i);
       float z;
-      z = ld.label * ec.pred.scalar;
+      z = ld.label * o.pred[i].scalar;
 
       s += z * o.alpha[i];
 
-      // if ld.label * ec.pred.scalar < 0, learner i made a mistake
+      // if ld.label * o.pred[i].scalar < 0, learner i made a mistake
 
-      final_prediction += ec.pred.scalar * o.alpha[i];
+      final_prediction += o.pred[i].scalar * o.alpha[i];
 
       // update alpha
       o.alpha[i] += eta * z / (1 + correctedExp(s));
       if (o.alpha[i] > 2.) o.alpha[i] = 2;
       if (o.alpha[i] < -2.) o.alpha[i] = -2;
 
-      base.learn(ec, i);
+      if (ec.weight > 0) base.learn(ec, i);
     }
     else
-    {
-      base.predict(ec, i);
-      final_prediction += ec.pred.scalar * o.alpha[i];
-    }
+      final_prediction += o.pred[i].scalar * o.alpha[i];
   }
 
   ec.weight = u;
@@ -204,6 +208,8 @@ void predict_or_learn_adaptive(boosting& o, VW::LEARNER::single_learner& base, e
   float eta = 4.f / (float)sqrtf((float)o.t);
 
   float stopping_point = o._random_state->get_and_update_random();
+  // a prediction stops at a learner drawn at random, so only training needs them all
+  if (is_learn) predict_all(o, base, ec);
 
   for (int i = 0; i < o.N; i++)
   {
@@ -213,16 +219,15 @@ void predict_or_learn_adaptive(boosting& o, VW::LEARNER::single_learner& base, e
 
       ec.weight = u * w;
 
-      base.predict(ec, i);
       float z;
 
-      z = ld.label * ec.pred.scalar;
+      z = ld.label * o.pred[i].scalar;
 
       s += z * o.alpha[i];
 
-      if (v_partial_sum <= stopping_point) { final_prediction += ec.pred.scalar * o.alpha[i]; }
+      if (v_partial_sum <= stopping_point) { final_prediction += o.pred[i].scalar * o.alpha[i]; }
 
-      partial_prediction += ec.pred.scalar * o.alpha[i];
+      partial_prediction += o.pred[i].scalar * o.alpha[i];
 
       v_partial_sum += o.v[i];
 
@@ -235,7 +240,7 @@ void predict_or_learn_adaptive(boosting& o, VW::LEARNER::single_learner& base, e
       if (o.alpha[i] > 2.) o.alpha[i] = 2;
       if (o.alpha[i] < -2.) o.alpha[i] = -2;
 
-      base.learn(ec, i);
+      if (ec.weight > 0) base.learn(ec, i);
     }
     else
     {
@@ -393,6 +398,7 @@ VW::LEARNER::base_learner* boosting_setup(options_i& options, vw& all)
   data->_random_state = all.get_random_state();
   data->alpha = std::vector<float>(data->N, 0);
   data->v = std::vector<float>(data->N, 1);
+  data->pred = calloc_or_throw<polyprediction>(data->N);
 
   learner<boosting, example>* l;
   if (data->alg == "BBM")
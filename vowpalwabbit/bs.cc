@@ -11,6 +11,7 @@
 
 #include "reductions.h"
 #include "rand48.h"
+#include "philox.h"
 #include "vw.h"
 #include "bs.h"
 #include "vw_exception.h"
@@ -27,6 +28,10 @@ struct bs
   std::vector<double> pred_vec;
   vw* all;  // for raw prediction and loss
   std::shared_ptr<rand_state> _random_state;
+  std::vector<float> uniforms;  // of the example, drawn from its own stream with --random_generator philox
+  polyprediction* pred;  // of every bag, when predicted together
+
+  ~bs() { free(pred); }
 };
 
 void bs_predict_mean(vw& all, example& ec, std::vector<double>& pred_vec)
@@ -172,21 +177,40 @@ void predict_or_learn(bs& d, single_learner& base, example& ec)
   std::stringstream outputStringStream;
   d.pred_vec.clear();
 
-  for (size_t i = 1; i <= d.B; i++)
+  // With philox the weights of an example are a function of the seed and its index alone, so they are drawn at once.
+  const bool counter_based = all.counter_based_random;
+  if (counter_based)
+    VW::random_stream(all.random_seed, VW::random_stream::BOOTSTRAP, ec.example_counter).fill(d.uniforms.data(), d.B);
+
+  if (!is_learn && !shouldOutput)
   {
-    ec.weight = weight_temp * (float)BS::weight_gen(d._random_state);
+    // The bags are independent, so that they are predicted in a single walk over the features. The weights are still
+    // drawn to leave the random state as sequential predictions would.
+    if (!counter_based)
+      for (size_t i = 1; i <= d.B; i++) BS::weight_gen(d._random_state);
+    base.multipredict(ec, 0, d.B, d.pred, true);
+    for (size_t i = 0; i < d.B; i++) d.pred_vec.push_back(d.pred[i].scalar);
+  }
+  else
+  {
+    for (size_t i = 1; i <= d.B; i++)
+    {
+      const uint32_t bag_weight =
+          counter_based ? BS::poisson_weight(d.uniforms[i - 1]) : BS::weight_gen(d._random_state);
+      ec.weight = weight_temp * (float)bag_weight;
 
-    if (is_learn)
-      base.learn(ec, i - 1);
-    else
-      base.predict(ec, i - 1);
+      if (is_learn)
+        base.learn(ec, i - 1);
+      else
+        base.predict(ec, i - 1);
 
-    d.pred_vec.push_back(ec.pred.scalar);
+      d.pred_vec.push_back(ec.pred.scalar);
 
-    if (shouldOutput)
-    {
-      if (i > 1) outputStringStream << ' ';
-      outputStringStream << i << ':' << ec.partial_prediction;
+      if (shouldOutput)
+      {
+        if (i > 1) outputStringStream << ' ';
+        outputStringStream << i << ':' << ec.partial_prediction;
+      }
     }
   }
 
@@ -243,8 +267,10 @@ base_learner* bs_setup(options_i& options, vw& all)
     data->bs_type = BS_TYPE_MEAN;
 
   data->pred_vec.reserve(data->B);
+  data->uniforms.resize(data->B);
   data->all = &all;
   data->_random_state = all.get_random_state();
+  data->pred = calloc_or_throw<polyprediction>(data->B);
 
   learner<bs, example>& l = init_learner(
       data, as_singleline(setup_base(options, all)), predict_or_learn<true>, predict_or_learn<false>, data->B);
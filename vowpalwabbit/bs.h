@@ -14,9 +14,8 @@ VW::LEARNER::base_learner* bs_setup(VW::config::options_i& options, vw& all);
 
 namespace BS
 {
-inline uint32_t weight_gen(std::shared_ptr<rand_state>& state)  // sampling from Poisson with rate 1
+inline uint32_t poisson_weight(float temp)  // the Poisson with rate 1 at the uniform temp
 {
-  float temp = state->get_and_update_random();
   if (temp <= 0.3678794411714423215955) return 0;
   if (temp <= 0.735758882342884643191) return 1;
   if (temp <= 0.919698602928605803989) return 2;
@@ -39,4 +38,9 @@ inline uint32_t weight_gen(std::shared_ptr<rand_state>& state)  // sampling from
   if (temp <= 0.9999999999999999998412) return 19;
   return 20;
 }
+
+inline uint32_t weight_gen(std::shared_ptr<rand_state>& state)  // sampling from Poisson with rate 1
+{
+  return poisson_weight(state->get_and_update_random());
+}
 }  // namespace BS
@@ -3,9 +3,28 @@
 // license as described in the file LICENSE.
 
 #include "cache.h"
+#include "cpu_features.h"
 #include "unique_sort.h"
 #include "global_data.h"
 #include "vw.h"
+#include "hash.h"
+#include "rand48.h"
+#include "thread_affinity.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// The pext decoder is compiled for BMI2 whatever the flags of the build, and picked at run time, see cpu_features.h.
+#if !defined(VW_NO_INLINE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#  define VW_CACHE_BMI2
+#  include <immintrin.h>
+#elif !defined(VW_NO_INLINE_SIMD) && defined(__BMI2__)
+#  include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
 
 constexpr size_t int_size = 11;
 constexpr size_t char_size = 2;
@@ -35,6 +54,139 @@ inline char* run_len_encode(char* p, uint64_t i)
 
 inline int64_t ZigZagDecode(uint64_t n) { return (n >> 1) ^ -static_cast<int64_t>(n & 1); }
 
+inline int lowest_set_bit(uint64_t n)
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, n);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(n);
+#endif
+}
+
+// Squeezes the continuation bits out of the 8 groups of 7 bits of word.
+inline uint64_t squeeze_groups(uint64_t word)
+{
+#if !defined(VW_NO_INLINE_SIMD) && defined(__BMI2__)
+  return _pext_u64(word, 0x7f7f7f7f7f7f7f7fULL);
+#else
+  // Doubling the width of the packed groups at each step.
+  word = ((word & 0x7f007f007f007f00ULL) >> 1) | (word & 0x007f007f007f007fULL);
+  word = ((word & 0x3fff00003fff0000ULL) >> 2) | (word & 0x00003fff00003fffULL);
+  return ((word & 0x0fffffff00000000ULL) >> 4) | (word & 0x000000000fffffffULL);
+#endif
+}
+
+#ifdef VW_CACHE_BMI2
+__attribute__((target("bmi2"))) inline uint64_t pext_groups(uint64_t word)
+{
+  return _pext_u64(word, 0x7f7f7f7f7f7f7f7fULL);
+}
+#endif
+
+// Decodes a run length encoded int from a single 8 byte load, p must be followed by at least 8 readable bytes. Ints
+// which take more than 8 bytes are left to run_len_decode, in which case nullptr is returned.
+template <uint64_t (*squeeze)(uint64_t)>
+inline const char* run_len_decode_word(const char* p, uint64_t& i)
+{
+  uint64_t word;
+  memcpy(&word, p, sizeof(word));
+  const uint64_t terminators = ~word & 0x8080808080808080ULL;
+  if (terminators == 0) return nullptr;
+
+  const int last_bit = lowest_set_bit(terminators);
+  if (last_bit < 63) word &= (uint64_t(1) << (last_bit + 1)) - 1;
+  i = squeeze(word);
+  return p + (last_bit + 1) / 8;
+}
+
+// Decodes the storage bytes of one namespace, see output_features for the encoding. The features are appended in one
+// go, returns false if they are not in increasing index order.
+template <uint64_t (*squeeze)(uint64_t)>
+inline bool decode_features(const char* c, const char* end, features& ours)
+{
+  // Every feature takes at least one byte, so this bounds the number of features.
+  ours.reserve(static_cast<size_t>(end - c));
+  feature_value* values = ours.values.end();
+  feature_index* indices = ours.indicies.end();
+
+  bool sorted = true;
+  float sum_feat_sq = 0.f;
+  uint64_t last = 0;
+  while (c < end)
+  {
+    uint64_t i = 0;
+    const char* next =
+        (end - c >= static_cast<ptrdiff_t>(sizeof(uint64_t))) ? run_len_decode_word<squeeze>(c, i) : nullptr;
+    if (next == nullptr)
+    {
+      i = 0;
+      next = run_len_decode(const_cast<char*>(c), i);
+    }
+    c = next;
+
+    feature_value v = 1.f;
+    if (i & neg_1)
+      v = -1.;
+    else if (i & general)
+    {
+      memcpy(&v, c, sizeof(v));
+      c += sizeof(v);
+    }
+    const int64_t s_diff = ZigZagDecode(i >> 2);
+    if (s_diff < 0) sorted = false;
+    last += s_diff;
+    *values++ = v;
+    *indices++ = last;
+    sum_feat_sq += v * v;
+  }
+
+  ours.values.end() = values;
+  ours.indicies.end() = indices;
+  ours.sum_feat_sq += sum_feat_sq;
+  return sorted;
+}
+
+bool shift_decode_features(const char* c, const char* end, features& ours)
+{
+  return decode_features<squeeze_groups>(c, end, ours);
+}
+
+#ifdef VW_CACHE_BMI2
+// flatten inlines the decoder into this function, so that pext_groups is inlined in turn.
+__attribute__((target("bmi2"), flatten)) bool pext_decode_features(const char* c, const char* end, features& ours)
+{
+  return decode_features<pext_groups>(c, end, ours);
+}
+#endif
+
+using decode_features_fn = bool (*)(const char*, const char*, features&);
+
+struct features_decoder
+{
+  decode_features_fn decode;
+  const char* variant;
+};
+
+features_decoder select_decoder()
+{
+#if defined(VW_CACHE_BMI2) && !defined(__BMI2__)
+  if (VW::detected_cpu_features().fast_pext) return {pext_decode_features, "bmi2"};
+#endif
+#if !defined(VW_NO_INLINE_SIMD) && defined(__BMI2__)
+  return {shift_decode_features, "bmi2"};
+#else
+  return {shift_decode_features, "scalar"};
+#endif
+}
+
+const features_decoder& selected_decoder()
+{
+  static const features_decoder decoder = select_decoder();
+  return decoder;
+}
+
 size_t read_cached_tag(io_buf& cache, example* ae)
 {
   char* c;
@@ -50,14 +202,172 @@ size_t read_cached_tag(io_buf& cache, example* ae)
   return tag_size + sizeof(tag_size);
 }
 
-struct one_float
+template <typename T>
+T read_value(const char* p)
 {
-  float f;
+  T value;
+  memcpy(&value, p, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void write_value(io_buf& output, T value)
+{
+  output.bin_write_fixed(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Blocks larger than this are assumed to be corrupted rather than buffered whole.
+constexpr uint64_t max_cache_block_payload = uint64_t(1) << 31;
+
+void skip_bytes(io_buf& input, uint64_t num_bytes)
+{
+  char* c;
+  while (num_bytes > 0)
+  {
+    const size_t chunk = static_cast<size_t>(std::min<uint64_t>(num_bytes, 1 << 16));
+    if (input.buf_read(c, chunk) < chunk) return;
+    num_bytes -= chunk;
+  }
+}
+
+// Bytes of the block payload the input is positioned at.
+struct cache_block_payload
+{
+  char* begin = nullptr;
+  char* end = nullptr;
+  bool dedup = false;  // its examples may refer to namespaces stored earlier in it, see CACHE_DEDUP_BLOCK_MAGIC
+};
+
+enum class cache_block_status
+{
+  ok,
+  skipped,
+  truncated
+};
+
+// Reads the payload of a block whose header was just read and checks it against the header. On success the input is
+// positioned at the payload, which is returned in block.
+cache_block_status read_cache_block_payload(io_buf& input, uint32_t num_examples, uint64_t payload_size,
+    uint32_t checksum, cache_block_payload& block, std::ostream& trace)
+{
+  char* payload;
+  if (input.buf_read(payload, payload_size) < payload_size)
+  {
+    trace << "truncated cache block! wanted: " << payload_size << " bytes" << std::endl;
+    return cache_block_status::truncated;
+  }
+  if (static_cast<uint32_t>(uniform_hash(payload, payload_size, 0)) != checksum)
+  {
+    trace << "warning: cache block checksum mismatch, skipping " << num_examples << " examples" << std::endl;
+    return cache_block_status::skipped;
+  }
+  if (num_examples == 0) return cache_block_status::skipped;
+
+  input.set(payload);
+  block.begin = payload;
+  block.end = payload + payload_size;
+  return cache_block_status::ok;
+}
+
+// Positions the input at the payload of the next intact block of a format 2 cache and returns the number of examples
+// in it, or 0 once the input is exhausted. Corrupted data is skipped up to the next block which passes its checksum.
+size_t next_cache_block(io_buf& input, cache_block_payload& block, std::ostream& trace)
+{
+  char* c;
+  bool resyncing = false;
+  while (input.buf_read(c, VW::CACHE_BLOCK_HEADER_SIZE) == VW::CACHE_BLOCK_HEADER_SIZE)
+  {
+    const auto magic = read_value<uint32_t>(c);
+    if (magic == VW::CACHE_INDEX_MAGIC)
+    {
+      // The index closes a cache file. Further input can only be the blocks of the next cache file.
+      const auto num_blocks = read_value<uint64_t>(c + sizeof(uint32_t));
+      input.set(c + sizeof(uint32_t) + sizeof(uint64_t));
+      skip_bytes(input, num_blocks * VW::CACHE_INDEX_ENTRY_SIZE + VW::CACHE_TRAILER_SIZE);
+      resyncing = false;
+      continue;
+    }
+
+    const auto num_examples = read_value<uint32_t>(c + 4);
+    const auto payload_size = read_value<uint64_t>(c + 8);
+    const auto checksum = read_value<uint32_t>(c + 16);
+    const bool dedup = magic == VW::CACHE_DEDUP_BLOCK_MAGIC;
+    if ((magic != VW::CACHE_BLOCK_MAGIC && !dedup) || payload_size > max_cache_block_payload)
+    {
+      // Block boundaries were lost, scan forward for the next block header.
+      if (!resyncing) trace << "warning: corrupted cache data, skipping to the next block" << std::endl;
+      resyncing = true;
+      input.set(c + 1);
+      continue;
+    }
+    resyncing = false;
+
+    switch (read_cache_block_payload(input, num_examples, payload_size, checksum, block, trace))
+    {
+      case cache_block_status::ok:
+        block.dedup = dedup;
+        return num_examples;
+      case cache_block_status::skipped:
+        break;
+      case cache_block_status::truncated:
+        return 0;
+    }
+  }
+  return 0;
+}
+
+// Positions the input at the payload of the block which starts at the current position, as found in the block
+// index. Returns the number of examples in the block, or 0 if it is corrupted.
+size_t read_indexed_cache_block(io_buf& input, cache_block_payload& block, std::ostream& trace)
+{
+  char* c;
+  if (input.buf_read(c, VW::CACHE_BLOCK_HEADER_SIZE) < VW::CACHE_BLOCK_HEADER_SIZE) return 0;
+  const auto magic = read_value<uint32_t>(c);
+  const auto num_examples = read_value<uint32_t>(c + 4);
+  const auto payload_size = read_value<uint64_t>(c + 8);
+  const auto checksum = read_value<uint32_t>(c + 16);
+  const bool dedup = magic == VW::CACHE_DEDUP_BLOCK_MAGIC;
+  if ((magic != VW::CACHE_BLOCK_MAGIC && !dedup) || payload_size > max_cache_block_payload)
+  {
+    trace << "warning: corrupted cache block header, skipping the block" << std::endl;
+    return 0;
+  }
+  if (read_cache_block_payload(input, num_examples, payload_size, checksum, block, trace) != cache_block_status::ok)
+    return 0;
+  block.dedup = dedup;
+  return num_examples;
+}
+
+// Finds the end of the cached example which starts at position, within a block ending at payload_end, and moves
+// position there. Returns false if the example does not fit into the block.
+bool skip_cached_example(vw& all, example& ae, char*& position, char* payload_end)
+{
+  io_buf& input = *all.example_parser->input;
+  input.set(position);
+  if (all.example_parser->lbl_parser.read_cached_label(all.example_parser->_shared_data, &ae.l, input) == 0)
+    return false;
+
+  // The rest is skipped using the sizes stored along with it.
+  char* c;
+  if (input.buf_read(c, sizeof(size_t)) < sizeof(size_t) || c + sizeof(size_t) > payload_end) return false;
+  const auto tag_size = read_value<size_t>(c);
+  c += sizeof(size_t);
+  if (static_cast<size_t>(payload_end - c) < tag_size + sizeof(unsigned char)) return false;
+  c += tag_size;
+  unsigned char num_indices = *reinterpret_cast<unsigned char*>(c);
+  c += sizeof(num_indices);
+  for (; num_indices > 0; num_indices--)
+  {
+    if (static_cast<size_t>(payload_end - c) < sizeof(unsigned char) + sizeof(size_t)) return false;
+    const auto storage = read_value<size_t>(c + sizeof(unsigned char));
+    c += sizeof(unsigned char) + sizeof(size_t);
+    if (storage & VW::CACHE_NAMESPACE_REFERENCE) continue;
+    if (static_cast<size_t>(payload_end - c) < storage) return false;
+    c += storage;
+  }
+  position = c;
+  return true;
 }
-#ifndef _WIN32
-__attribute__((packed))
-#endif
-;
 
 int read_cached_features(vw* all, v_array<example*>& examples)
 {
@@ -65,23 +375,49 @@ int read_cached_features(vw* all, v_array<example*>& examples)
   ae->sorted = all->example_parser->sorted_cache;
   io_buf* input = all->example_parser->input;
 
-  size_t total = all->example_parser->lbl_parser.read_cached_label(all->example_parser->_shared_data, &ae->l, *input);
+  if (all->example_parser->cache_format == 2)
+  {
+    auto& shuffler = all->example_parser->cache_shuffler;
+    if (all->example_parser->cache_examples_left_in_block == 0)
+    {
+      if (shuffler != nullptr)
+        all->example_parser->cache_examples_left_in_block = shuffler->next_block(*all, *ae);
+      else
+      {
+        cache_block_payload block;
+        all->example_parser->cache_examples_left_in_block = next_cache_block(*input, block, all->trace_message);
+        all->example_parser->cache_dictionary.start_block(block.dedup ? block.begin : nullptr, block.end);
+      }
+    }
+    if (all->example_parser->cache_examples_left_in_block == 0) return 0;
+    all->example_parser->cache_examples_left_in_block--;
+    if (shuffler != nullptr) shuffler->next_example(*input);
+  }
+
+  return (int)VW::read_cached_example(all->example_parser->lbl_parser, all->example_parser->_shared_data, *input, ae,
+      all->trace_message, &all->example_parser->cache_dictionary);
+}
+
+size_t VW::read_cached_example(label_parser& lp, shared_data* sd, io_buf& input, example* ae, std::ostream& trace,
+    cache_dictionary* dictionary)
+{
+  size_t total = lp.read_cached_label(sd, &ae->l, input);
   if (total == 0) return 0;
-  if (read_cached_tag(*input, ae) == 0) return 0;
+  if (read_cached_tag(input, ae) == 0) return 0;
   char* c;
   unsigned char num_indices = 0;
-  if (input->buf_read(c, sizeof(num_indices)) < sizeof(num_indices)) return 0;
+  if (input.buf_read(c, sizeof(num_indices)) < sizeof(num_indices)) return 0;
   num_indices = *(unsigned char*)c;
   c += sizeof(num_indices);
 
-  all->example_parser->input->set(c);
+  input.set(c);
   for (; num_indices > 0; num_indices--)
   {
     size_t temp;
     unsigned char index = 0;
-    if ((temp = input->buf_read(c, sizeof(index) + sizeof(size_t))) < sizeof(index) + sizeof(size_t))
+    if ((temp = input.buf_read(c, sizeof(index) + sizeof(size_t))) < sizeof(index) + sizeof(size_t))
     {
-      all->trace_message << "truncated example! " << temp << " " << char_size + sizeof(size_t) << std::endl;
+      trace << "truncated example! " << temp << " " << char_size + sizeof(size_t) << std::endl;
       return 0;
     }
 
@@ -91,41 +427,30 @@ int read_cached_features(vw* all, v_array<example*>& examples)
     features& ours = ae->feature_space[index];
     size_t storage = *(size_t*)c;
     c += sizeof(size_t);
-    all->example_parser->input->set(c);
+    input.set(c);
+    if (storage & CACHE_NAMESPACE_REFERENCE)
+    {
+      bool sorted = true;
+      if (dictionary == nullptr || !dictionary->append(storage & ~CACHE_NAMESPACE_REFERENCE, ours, sorted))
+      {
+        trace << "cached example refers to features outside of its block!" << std::endl;
+        return 0;
+      }
+      if (!sorted) ae->sorted = false;
+      continue;
+    }
     total += storage;
-    if (input->buf_read(c, storage) < storage)
+    if (input.buf_read(c, storage) < storage)
     {
-      all->trace_message << "truncated example! wanted: " << storage << " bytes" << std::endl;
+      trace << "truncated example! wanted: " << storage << " bytes" << std::endl;
       return 0;
     }
 
-    char* end = c + storage;
-
-    uint64_t last = 0;
-
-    for (; c != end;)
-    {
-      feature_index i = 0;
-      c = run_len_decode(c, i);
-      feature_value v = 1.f;
-      if (i & neg_1)
-        v = -1.;
-      else if (i & general)
-      {
-        v = ((one_float*)c)->f;
-        c += sizeof(float);
-      }
-      uint64_t diff = i >> 2;
-      int64_t s_diff = ZigZagDecode(diff);
-      if (s_diff < 0) ae->sorted = false;
-      i = last + s_diff;
-      last = i;
-      ours.push_back(v, i);
-    }
-    all->example_parser->input->set(c);
+    if (!selected_decoder().decode(c, c + storage, ours)) ae->sorted = false;
+    input.set(c + storage);
   }
 
-  return (int)total;
+  return total;
 }
 
 inline uint64_t ZigZagEncode(int64_t n)
@@ -143,7 +468,8 @@ void output_byte(io_buf& cache, unsigned char s)
   cache.set(c);
 }
 
-void output_features(io_buf& cache, unsigned char index, features& fs, uint64_t mask)
+// Writes the features of fs as output_features does and returns where their size is stored, just before them.
+char* encode_features(io_buf& cache, unsigned char index, features& fs, uint64_t mask)
 {
   char* c;
   size_t storage = fs.size() * int_size;
@@ -179,6 +505,12 @@ void output_features(io_buf& cache, unsigned char index, features& fs, uint64_t
 
   cache.set(c);
   *(size_t*)storage_size_loc = c - storage_size_loc - sizeof(size_t);
+  return storage_size_loc;
+}
+
+void output_features(io_buf& cache, unsigned char index, features& fs, uint64_t mask)
+{
+  encode_features(cache, index, fs, mask);
 }
 
 void cache_tag(io_buf& cache, v_array<char> tag)
@@ -200,8 +532,376 @@ void cache_features(io_buf& cache, example* ae, uint64_t mask)
   for (namespace_index ns : ae->indices) output_features(cache, ns, ae->feature_space[ns], mask);
 }
 
+const char* VW::cache_decoder_variant() { return selected_decoder().variant; }
+
+void VW::cache_dictionary::start_block(const char* payload, const char* end)
+{
+  _payload = payload;
+  _end = end;
+  _entries.clear();
+}
+
+bool VW::cache_dictionary::append(uint64_t offset, features& ours, bool& sorted)
+{
+  auto found = _entries.find(offset);
+  if (found == _entries.end())
+  {
+    if (_payload == nullptr || offset > static_cast<uint64_t>(_end - _payload) ||
+        static_cast<size_t>(_end - _payload - offset) < sizeof(size_t))
+      return false;
+    const char* c = _payload + offset;
+    const auto storage = read_value<size_t>(c);
+    c += sizeof(size_t);
+    if ((storage & CACHE_NAMESPACE_REFERENCE) || static_cast<size_t>(_end - c) < storage) return false;
+    found = _entries.emplace(offset, entry()).first;
+    found->second.sorted = selected_decoder().decode(c, c + storage, found->second.fs);
+  }
+  ours.concat(found->second.fs);
+  if (!found->second.sorted) sorted = false;
+  return true;
+}
+
 uint32_t VW::convert(size_t number)
 {
   if (number > UINT32_MAX) { THROW("size_t value is out of bounds of uint32_t.") }
   return static_cast<uint32_t>(number);
 }
+
+// Full blocks which may wait for the background writer, so that the cache does not pile up in memory when writing it
+// is slower than parsing.
+constexpr size_t max_pending_cache_blocks = 4;
+
+VW::cache_block_writer::cache_block_writer(
+    io_buf& output, uint64_t offset, size_t examples_per_block, bool background, bool dedup)
+    : _output(output)
+    , _payload(std::make_shared<std::vector<char>>())
+    , _offset(offset)
+    , _examples_per_block(examples_per_block)
+    , _dedup(dedup)
+{
+  _block.add_file(VW::io::create_vector_writer(_payload));
+  if (background) { _writer = std::thread(&cache_block_writer::writer_loop, this); }
+}
+
+VW::cache_block_writer::~cache_block_writer() { stop_writer(); }
+
+void VW::cache_block_writer::cache_features(example* ae, uint64_t mask)
+{
+  if (!_dedup)
+  {
+    ::cache_features(_block, ae, mask);
+    return;
+  }
+
+  cache_tag(_block, ae->tag);
+  output_byte(_block, (unsigned char)ae->indices.size());
+  for (namespace_index ns : ae->indices)
+  {
+    char* storage_size_loc = encode_features(_block, ns, ae->feature_space[ns], mask);
+    const auto storage = read_value<size_t>(storage_size_loc);
+    if (storage == 0) continue;
+
+    // The features were just written, so they are still buffered whole in _block.
+    const uint64_t offset = _payload->size() + _block.unflushed_bytes_count() - storage - sizeof(size_t);
+    _key.assign(storage_size_loc + sizeof(size_t), storage);
+    const auto found = _dictionary.find(_key);
+    if (found == _dictionary.end())
+    {
+      _dictionary.emplace(_key, offset);
+      continue;
+    }
+
+    const size_t reference = CACHE_NAMESPACE_REFERENCE | static_cast<size_t>(found->second);
+    memcpy(storage_size_loc, &reference, sizeof(reference));
+    _block.set(storage_size_loc + sizeof(size_t));
+  }
+}
+
+void VW::cache_block_writer::example_written()
+{
+  _num_examples++;
+  if (_num_examples >= _examples_per_block ||
+      _payload->size() + _block.unflushed_bytes_count() >= max_cache_block_payload / 2)
+  { write_block(); }
+}
+
+void VW::cache_block_writer::write_block()
+{
+  _block.flush();
+  _dictionary.clear();
+  if (!_writer.joinable())
+  {
+    write_payload(*_payload, _num_examples);
+    _payload->clear();
+  }
+  else
+  {
+    std::unique_lock<std::mutex> lock(_lock);
+    _changed.wait(lock, [this] { return _pending.size() < max_pending_cache_blocks || _exc_ptr; });
+    if (_exc_ptr) { std::rethrow_exception(_exc_ptr); }
+    // The block goes to the thread and the vector writer of _block carries on into a spare buffer.
+    std::vector<char> payload;
+    if (!_spare.empty())
+    {
+      payload.swap(_spare.back());
+      _spare.pop_back();
+    }
+    payload.swap(*_payload);
+    _pending.emplace_back(std::move(payload), _num_examples);
+    lock.unlock();
+    _changed.notify_all();
+  }
+  _num_examples = 0;
+}
+
+void VW::cache_block_writer::write_payload(const std::vector<char>& payload, uint32_t num_examples)
+{
+  const auto checksum = static_cast<uint32_t>(uniform_hash(payload.data(), payload.size(), 0));
+
+  write_value(_output, _dedup ? CACHE_DEDUP_BLOCK_MAGIC : CACHE_BLOCK_MAGIC);
+  write_value(_output, num_examples);
+  write_value(_output, static_cast<uint64_t>(payload.size()));
+  write_value(_output, checksum);
+  _output.bin_write_fixed(payload.data(), payload.size());
+
+  _index.push_back({_offset, num_examples, checksum});
+  _offset += CACHE_BLOCK_HEADER_SIZE + payload.size();
+}
+
+void VW::cache_block_writer::writer_loop()
+{
+  VW::pin_current_thread(VW::thread_role::io);
+  std::unique_lock<std::mutex> lock(_lock);
+  while (true)
+  {
+    _changed.wait(lock, [this] { return !_pending.empty() || _done; });
+    if (_pending.empty()) { return; }
+    auto block = std::move(_pending.front());
+    _pending.pop_front();
+    _writing = true;
+    lock.unlock();
+
+    std::exception_ptr exc_ptr;
+    try
+    {
+      write_payload(block.first, block.second);
+    }
+    catch (...)
+    {
+      exc_ptr = std::current_exception();
+    }
+    block.first.clear();
+
+    lock.lock();
+    if (exc_ptr && !_exc_ptr) { _exc_ptr = exc_ptr; }
+    // a cache with a block missing is no use, the blocks after a failed one are dropped
+    if (_exc_ptr) { _pending.clear(); }
+    _spare.push_back(std::move(block.first));
+    _writing = false;
+    _changed.notify_all();
+  }
+}
+
+void VW::cache_block_writer::stop_writer()
+{
+  if (!_writer.joinable()) { return; }
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _done = true;
+  }
+  _changed.notify_all();
+  _writer.join();
+}
+
+void VW::cache_block_writer::flush()
+{
+  if (_num_examples > 0) write_block();
+  if (_writer.joinable())
+  {
+    std::unique_lock<std::mutex> lock(_lock);
+    _changed.wait(lock, [this] { return (_pending.empty() && !_writing) || _exc_ptr; });
+    if (_exc_ptr) { std::rethrow_exception(_exc_ptr); }
+  }
+  _output.flush();
+}
+
+void VW::cache_block_writer::finish()
+{
+  if (_num_examples > 0) write_block();
+  stop_writer();
+  if (_exc_ptr) { std::rethrow_exception(_exc_ptr); }
+
+  write_value(_output, CACHE_INDEX_MAGIC);
+  write_value(_output, static_cast<uint64_t>(_index.size()));
+  for (const auto& block : _index)
+  {
+    write_value(_output, block.offset);
+    write_value(_output, block.num_examples);
+    write_value(_output, block.checksum);
+  }
+  write_value(_output, _offset);
+  write_value(_output, VW::CACHE_TRAILER_MAGIC);
+}
+
+namespace
+{
+// read_at(offset, length, destination) copies length bytes of the cache at offset to destination, false if it cannot.
+template <typename read_at_fn>
+bool read_cache_index(uint64_t cache_size, read_at_fn read_at, std::vector<VW::cache_block_info>& index)
+{
+  if (cache_size < VW::CACHE_TRAILER_SIZE + sizeof(uint32_t) + sizeof(uint64_t)) return false;
+
+  char trailer[VW::CACHE_TRAILER_SIZE];
+  if (!read_at(cache_size - VW::CACHE_TRAILER_SIZE, sizeof(trailer), trailer)) return false;
+  const auto index_offset = read_value<uint64_t>(trailer);
+  if (read_value<uint32_t>(trailer + sizeof(uint64_t)) != VW::CACHE_TRAILER_MAGIC) return false;
+
+  char header[sizeof(uint32_t) + sizeof(uint64_t)];
+  if (index_offset > cache_size - VW::CACHE_TRAILER_SIZE - sizeof(header)) return false;
+  if (!read_at(index_offset, sizeof(header), header)) return false;
+  const auto num_blocks = read_value<uint64_t>(header + sizeof(uint32_t));
+  if (read_value<uint32_t>(header) != VW::CACHE_INDEX_MAGIC ||
+      index_offset + sizeof(header) + num_blocks * VW::CACHE_INDEX_ENTRY_SIZE + VW::CACHE_TRAILER_SIZE != cache_size)
+  { return false; }
+
+  std::vector<char> entries(num_blocks * VW::CACHE_INDEX_ENTRY_SIZE);
+  if (!read_at(index_offset + sizeof(header), entries.size(), entries.data())) return false;
+  index.reserve(num_blocks);
+  for (size_t i = 0; i < num_blocks; i++)
+  {
+    const char* entry = entries.data() + i * VW::CACHE_INDEX_ENTRY_SIZE;
+    index.push_back({read_value<uint64_t>(entry), read_value<uint32_t>(entry + 8), read_value<uint32_t>(entry + 12)});
+  }
+  return true;
+}
+}  // namespace
+
+bool VW::read_cache_index(const std::string& file_path, std::vector<cache_block_info>& index)
+{
+  index.clear();
+  if (VW::io::detect_compression_format(file_path) != VW::io::compression_format::none) return false;
+
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file.seekg(0, std::ios::end)) return false;
+  const auto file_size = static_cast<uint64_t>(file.tellg());
+  return ::read_cache_index(file_size,
+      [&file](uint64_t offset, size_t length, char* destination) {
+        return static_cast<bool>(file.seekg(offset) && file.read(destination, length));
+      },
+      index);
+}
+
+bool VW::read_cache_index(const char* cache, size_t size, std::vector<cache_block_info>& index)
+{
+  index.clear();
+  return ::read_cache_index(size,
+      [cache](uint64_t offset, size_t length, char* destination) {
+        std::memcpy(destination, cache + offset, length);
+        return true;
+      },
+      index);
+}
+
+size_t VW::cache_shuffler::draw(size_t n)
+{
+  // merand48 is below 1, min guards against it being rounded up.
+  return std::min(static_cast<size_t>(merand48(_random_state) * n), n - 1);
+}
+
+void VW::cache_shuffler::start_pass(const std::vector<std::string>& file_names, std::ostream& trace)
+{
+  const uint64_t pass = begin_pass();
+  if (_in_file_order) return;
+
+  std::vector<cache_block_info> index;
+  for (size_t file = 0; file < file_names.size(); file++)
+  {
+    if (!read_cache_index(file_names[file], index))
+    {
+      if (pass == 0)
+      {
+        trace << "warning: " << file_names[file]
+              << " has no block index, cache blocks are read in order and only the examples within each block are "
+                 "shuffled"
+              << std::endl;
+      }
+      _blocks.clear();
+      _in_file_order = true;
+      return;
+    }
+    for (const auto& block : index) _blocks.push_back({file, block.offset});
+  }
+  shuffle_blocks();
+}
+
+void VW::cache_shuffler::start_pass(const char* cache, size_t size)
+{
+  begin_pass();
+  std::vector<cache_block_info> index;
+  if (!read_cache_index(cache, size, index)) THROW("the examples kept in memory have no block index");
+  for (const auto& block : index) _blocks.push_back({0, block.offset});
+  shuffle_blocks();
+}
+
+uint64_t VW::cache_shuffler::begin_pass()
+{
+  const uint64_t pass = _passes++;
+  _random_state = uniform_hash(&pass, sizeof(pass), _seed);
+  _blocks.clear();
+  _next_block = 0;
+  _examples.clear();
+  _next_example = 0;
+  _block_end = nullptr;
+  return pass;
+}
+
+void VW::cache_shuffler::shuffle_blocks()
+{
+  for (size_t i = _blocks.size(); i > 1; i--) std::swap(_blocks[i - 1], _blocks[draw(i)]);
+}
+
+size_t VW::cache_shuffler::next_block(vw& all, example& ae)
+{
+  io_buf& input = *all.example_parser->input;
+  // Blocks read in file order follow the previous one.
+  if (_block_end != nullptr) input.set(_block_end);
+
+  size_t num_examples = 0;
+  cache_block_payload block;
+  while (num_examples == 0)
+  {
+    if (_in_file_order)
+    {
+      num_examples = next_cache_block(input, block, all.trace_message);
+      if (num_examples == 0) return 0;
+      break;
+    }
+
+    if (_next_block == _blocks.size()) return 0;
+    const auto& location = _blocks[_next_block++];
+    if (!input.seek_file(location.file, location.offset))
+    {
+      // All cache files are opened alike, so this is found out before anything was read out of order.
+      if (_next_block > 1) THROW("cache file cannot seek to the block at offset " << location.offset);
+      all.trace_message << "warning: cache files cannot seek, cache blocks are read in order and only the examples "
+                           "within each block are shuffled"
+                        << std::endl;
+      _in_file_order = true;
+      continue;
+    }
+    num_examples = read_indexed_cache_block(input, block, all.trace_message);
+  }
+  all.example_parser->cache_dictionary.start_block(block.dedup ? block.begin : nullptr, block.end);
+
+  _examples.clear();
+  _next_example = 0;
+  char* position = block.begin;
+  for (size_t i = 0; i < num_examples; i++)
+  {
+    _examples.push_back(position);
+    if (!skip_cached_example(all, ae, position, block.end)) THROW("cache block does not hold the examples it counts");
+  }
+  _block_end = block.end;
+  for (size_t i = _examples.size(); i > 1; i--) std::swap(_examples[i - 1], _examples[draw(i)]);
+  return num_examples;
+}
@@ -6,6 +6,33 @@
 #include "v_array.h"
 #include "io_buf.h"
 #include "example.h"
+#include "label_parser.h"
+
+#include <deque>
+#include <exception>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Mutex, CV and thread cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a
+// managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <mutex>
+#  include <condition_variable>
+#  include <thread>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <mutex>
+#  include <condition_variable>
+#  include <thread>
+#endif
+
+struct shared_data;
 
 char* run_len_decode(char* p, size_t& i);
 char* run_len_encode(char* p, size_t i);
@@ -19,4 +46,180 @@ void output_features(io_buf& cache, unsigned char index, features& fs, uint64_t
 namespace VW
 {
 uint32_t convert(size_t number);
+
+// bmi2 or scalar, whichever decodes the features of cached examples, see cpu_features.h.
+const char* cache_decoder_variant();
+
+class cache_dictionary;
+
+// Reads the cached example at the head of input into ae, whose features must be cleared beforehand. Returns the number
+// of bytes of its label and features, 0 when it is truncated. read_cached_features reads the examples of the parser with
+// it, the experience replay buffers their encoded examples. The namespaces an example of a --cache_dedup block refers
+// to are looked up in dictionary, which must be given for such blocks.
+size_t read_cached_example(label_parser& lp, shared_data* sd, io_buf& input, example* ae, std::ostream& trace,
+    cache_dictionary* dictionary = nullptr);
+
+// Byte following the version string in a cache file header, it selects the layout of the rest of the file.
+constexpr char CACHE_FORMAT_1_MARKER = 'c';  // examples back to back
+constexpr char CACHE_FORMAT_2_MARKER = 'b';  // examples grouped into checksummed blocks, followed by a block index
+
+// Format 2 caches consist of blocks of examples. Each block starts with a header of
+//   uint32_t CACHE_BLOCK_MAGIC, uint32_t num_examples, uint64_t payload_size, uint32_t payload_checksum
+// followed by the payload, which holds the examples in format 1 encoding. The last block is followed by the index
+//   uint32_t CACHE_INDEX_MAGIC, uint64_t num_blocks, num_blocks * (uint64_t offset, uint32_t num_examples,
+//   uint32_t payload_checksum), uint64_t index_offset, uint32_t CACHE_TRAILER_MAGIC
+// where offsets are counted from the start of the file, so that uncompressed caches can be read out of order.
+constexpr uint32_t CACHE_BLOCK_MAGIC = 0x4b4c4243;    // "CBLK"
+constexpr uint32_t CACHE_INDEX_MAGIC = 0x58444943;    // "CIDX"
+constexpr uint32_t CACHE_TRAILER_MAGIC = 0x444e4543;  // "CEND"
+// Blocks written with --cache_dedup start with this magic instead. A namespace whose features were stored earlier in
+// the block is stored as its index followed by the size_t CACHE_NAMESPACE_REFERENCE | offset, where offset is that of
+// the size_t which precedes the features stored earlier, counted from the start of the payload. No bytes follow it.
+constexpr uint32_t CACHE_DEDUP_BLOCK_MAGIC = 0x4b424443;  // "CDBK"
+constexpr size_t CACHE_NAMESPACE_REFERENCE = ~(~size_t(0) >> 1);
+constexpr size_t CACHE_BLOCK_HEADER_SIZE = 20;
+constexpr size_t CACHE_INDEX_ENTRY_SIZE = 16;
+constexpr size_t CACHE_TRAILER_SIZE = 12;
+
+// First byte sent by binary daemon mode clients, anything else is read as text or JSON. Clients either send format 1
+// examples back to back or format 2 blocks, without index, so that requests of many examples are framed and
+// checksummed and read whole. The server answers every example with a global_prediction in either case.
+constexpr char DAEMON_EXAMPLES_MARKER = 0;
+constexpr char DAEMON_BLOCKS_MARKER = 1;
+
+struct cache_block_info
+{
+  uint64_t offset;  // of the block header
+  uint32_t num_examples;
+  uint32_t checksum;
+};
+
+// Collects cached examples into blocks and writes them, and finally the block index, to the cache output.
+class cache_block_writer
+{
+public:
+  // offset is the number of header bytes already written to output. With background a thread of the writer checksums
+  // the full blocks and writes them to output, which compresses them, so that the caller only pays for encoding the
+  // examples. Errors of the thread are thrown by the next call.
+  // With dedup the namespaces whose features were stored earlier in the block refer to them, see
+  // CACHE_DEDUP_BLOCK_MAGIC.
+  cache_block_writer(
+      io_buf& output, uint64_t offset, size_t examples_per_block, bool background = false, bool dedup = false);
+  ~cache_block_writer();
+
+  cache_block_writer(const cache_block_writer&) = delete;
+  cache_block_writer& operator=(const cache_block_writer&) = delete;
+
+  // Examples are cached into this buffer, the features with cache_features, followed by a call to example_written.
+  io_buf& block() { return _block; }
+  void cache_features(example* ae, uint64_t mask);
+  void example_written();
+
+  // Writes the examples collected so far as a block, daemon mode clients call it to send a request.
+  void flush();
+
+  // Writes the last partially filled block and the index. The writer must not be used afterwards.
+  void finish();
+
+private:
+  void write_block();
+  void write_payload(const std::vector<char>& payload, uint32_t num_examples);
+  void writer_loop();
+  void stop_writer();
+
+  io_buf& _output;
+  io_buf _block;
+  std::shared_ptr<std::vector<char>> _payload;
+  std::vector<cache_block_info> _index;
+  uint64_t _offset;
+  size_t _examples_per_block;
+  uint32_t _num_examples = 0;
+  bool _dedup;
+  std::unordered_map<std::string, uint64_t> _dictionary;  // offsets of the features stored in the block, by their bytes
+  std::string _key;  // scratch space for looking up _dictionary
+
+  // With background, the blocks waiting for the thread and the payload buffers it is done with.
+  std::thread _writer;
+  std::mutex _lock;
+  std::condition_variable _changed;
+  std::deque<std::pair<std::vector<char>, uint32_t>> _pending;
+  std::vector<std::vector<char>> _spare;
+  bool _writing = false;  // the thread is writing a block it took from _pending
+  bool _done = false;
+  std::exception_ptr _exc_ptr;
+};
+
+// The namespaces the examples of a --cache_dedup block refer to, decoded the first time one refers to them.
+class cache_dictionary
+{
+public:
+  // Starts a block whose payload is buffered whole from payload to end, or a block without references with nullptr.
+  void start_block(const char* payload, const char* end);
+
+  // Appends the features stored at offset of the payload to ours and clears sorted when they are out of order. Returns
+  // false if there are no features at offset.
+  bool append(uint64_t offset, features& ours, bool& sorted);
+
+private:
+  struct entry
+  {
+    features fs;
+    bool sorted;
+  };
+
+  const char* _payload = nullptr;
+  const char* _end = nullptr;
+  std::unordered_map<uint64_t, entry> _entries;
+};
+
+// Reads the block index of a format 2 cache file. Returns false if there is none to read, which is the case for
+// format 1 and compressed caches as well as for caches which were not completely written.
+bool read_cache_index(const std::string& file_path, std::vector<cache_block_info>& index);
+
+// Reads the block index of a format 2 cache held in memory, such as the one written with --in_memory.
+bool read_cache_index(const char* cache, size_t size, std::vector<cache_block_info>& index);
+
+// Shuffles the examples read from format 2 caches, see --cache_shuffle. Every pass reads the blocks in a random order
+// drawn from the block index and the examples of each block in a random order. Blocks are still read whole, so a pass
+// costs about as much as reading the cache in order.
+class cache_shuffler
+{
+public:
+  explicit cache_shuffler(uint64_t seed) : _seed(seed) {}
+
+  // Draws the order of the next pass over the cache files, which must be the input files in the same order. Blocks of
+  // caches without an index, such as compressed caches, are read in file order.
+  void start_pass(const std::vector<std::string>& file_names, std::ostream& trace);
+
+  // Draws the order of the next pass over a format 2 cache held in memory, which must be the only input file.
+  void start_pass(const char* cache, size_t size);
+
+  // Reads the next block of the pass and returns the number of examples in it, or 0 at the end of the pass. ae is
+  // used as scratch space to find the examples of the block.
+  size_t next_block(vw& all, example& ae);
+
+  // Positions the input at the next example of the current block.
+  void next_example(io_buf& input) { input.set(_examples[_next_example++]); }
+
+private:
+  struct block_location
+  {
+    size_t file;
+    uint64_t offset;
+  };
+
+  uint64_t begin_pass();  // returns the number of passes started before
+  void shuffle_blocks();
+  size_t draw(size_t n);
+
+  uint64_t _seed;
+  uint64_t _passes = 0;
+  uint64_t _random_state = 0;
+  bool _in_file_order = false;  // once the caches turned out to have no index or to be unable to seek
+  std::vector<block_location> _blocks;
+  size_t _next_block = 0;
+  std::vector<char*> _examples;  // of the current block, in the order they are read
+  size_t _next_example = 0;
+  char* _block_end = nullptr;
+};
 }
@@ -8,6 +8,8 @@
 #include "api_status.h"
 #include "debug_log.h"
 
+#include <cstdio>
+
 // Aliases
 using std::endl;
 using VW::cb_continuous::continuous_label;
@@ -107,9 +109,10 @@ void finish_example(vw& all, cats& data, example& ec)
 void reduction_output::output_predictions(std::vector<std::unique_ptr<VW::io::writer>>& predict_file_descriptors,
     const continuous_actions::probability_density_function_value& prediction)
 {
-  // output to the prediction to all files
-  const std::string str = to_string(prediction, true);
-  for (auto& f : predict_file_descriptors) f->write(str.c_str(), str.size());
+  // output to the prediction to all files, formatted as to_string does without allocating for every example
+  char str[64];
+  const int size = snprintf(str, sizeof(str), "%g,%g\n", prediction.action, prediction.pdf_value);
+  for (auto& f : predict_file_descriptors) f->write(str, static_cast<size_t>(size));
 }
 
 // "average loss" "since last" "example counter" "example weight"
@@ -156,32 +156,32 @@ uint32_t cats_tree::predict(LEARNER::single_learner& base, example& ec)
   if (_binary_tree.leaf_node_count() == 0) return 0;
   CB::label saved_label = std::move(ec.l.cb);
   ec.l.simple.label = std::numeric_limits<float>::max();  // says it is a test example
-  auto cur_node = nodes[0];
+  const tree_node* cur_node = &nodes[0];
 
-  while (!(cur_node.is_leaf))
+  while (!(cur_node->is_leaf))
   {
-    if (cur_node.right_only) { cur_node = nodes[cur_node.right_id]; }
-    else if (cur_node.left_only)
+    if (cur_node->right_only) { cur_node = &nodes[cur_node->right_id]; }
+    else if (cur_node->left_only)
     {
-      cur_node = nodes[cur_node.left_id];
+      cur_node = &nodes[cur_node->left_id];
     }
     else
     {
       ec.partial_prediction = 0.f;
       ec.pred.scalar = 0.f;
       ec.l.simple.initial = 0.f;  // needed for gd.predict()
-      base.predict(ec, cur_node.id);
+      base.predict(ec, cur_node->id);
       VW_DBG(ec) << "tree_c: predict() after base.predict() " << scalar_pred_to_string(ec)
-                 << ", nodeid = " << cur_node.id << std::endl;
-      if (ec.pred.scalar < 0) { cur_node = nodes[cur_node.left_id]; }
+                 << ", nodeid = " << cur_node->id << std::endl;
+      if (ec.pred.scalar < 0) { cur_node = &nodes[cur_node->left_id]; }
       else
       {
-        cur_node = nodes[cur_node.right_id];
+        cur_node = &nodes[cur_node->right_id];
       }
     }
   }
   ec.l.cb = saved_label;
-  return (cur_node.id - _binary_tree.internal_node_count() + 1);  // 1 to k
+  return (cur_node->id - _binary_tree.internal_node_count() + 1);  // 1 to k
 }
 
 void cats_tree::init_node_costs(v_array<cb_class>& ac)
@@ -17,50 +17,51 @@ using namespace VW::LEARNER;
 
 namespace CB
 {
-void parse_label(parser* p, shared_data*, CB::label& ld, std::vector<VW::string_view>& words, reduction_features&)
+// <action>[:<cost>[:<probability>]], or shared
+cb_class parse_class(VW::string_view word)
 {
-  ld.weight = 1.0;
-
-  for (auto const& word : words)
-  {
-    cb_class f;
-    tokenize(':', word, p->parse_name);
+  VW::string_view fields[3];
+  const size_t num_fields = tokenize_into(':', word, fields, 3);
 
-    if (p->parse_name.empty() || p->parse_name.size() > 3) { THROW("malformed cost specification: " << word); }
+  if (num_fields == 0 || num_fields > 3) { THROW("malformed cost specification: " << word); }
 
-    f.partial_prediction = 0.;
-    f.action = (uint32_t)hashstring(p->parse_name[0].begin(), p->parse_name[0].length(), 0);
-    f.cost = FLT_MAX;
+  cb_class f;
+  f.partial_prediction = 0.;
+  f.action = (uint32_t)hashstring(fields[0].begin(), fields[0].length(), 0);
+  f.cost = FLT_MAX;
 
-    if (p->parse_name.size() > 1) f.cost = float_of_string(p->parse_name[1]);
+  if (num_fields > 1) f.cost = float_of_string(fields[1]);
 
-    if (std::isnan(f.cost)) THROW("error NaN cost (" << p->parse_name[1] << " for action: " << p->parse_name[0]);
+  if (std::isnan(f.cost)) THROW("error NaN cost (" << fields[1] << " for action: " << fields[0]);
 
-    f.probability = .0;
-    if (p->parse_name.size() > 2) f.probability = float_of_string(p->parse_name[2]);
-
-    if (std::isnan(f.probability))
-      THROW("error NaN probability (" << p->parse_name[2] << " for action: " << p->parse_name[0]);
+  f.probability = .0;
+  if (num_fields > 2) f.probability = float_of_string(fields[2]);
 
-    if (f.probability > 1.0)
-    {
-      std::cerr << "invalid probability > 1 specified for an action, resetting to 1." << std::endl;
-      f.probability = 1.0;
-    }
-    if (f.probability < 0.0)
-    {
-      std::cerr << "invalid probability < 0 specified for an action, resetting to 0." << std::endl;
-      f.probability = .0;
-    }
-    if (p->parse_name[0] == "shared")
-    {
-      if (p->parse_name.size() == 1) { f.probability = -1.f; }
-      else
-        std::cerr << "shared feature vectors should not have costs" << std::endl;
-    }
+  if (std::isnan(f.probability)) THROW("error NaN probability (" << fields[2] << " for action: " << fields[0]);
 
-    ld.costs.push_back(f);
+  if (f.probability > 1.0)
+  {
+    std::cerr << "invalid probability > 1 specified for an action, resetting to 1." << std::endl;
+    f.probability = 1.0;
+  }
+  if (f.probability < 0.0)
+  {
+    std::cerr << "invalid probability < 0 specified for an action, resetting to 0." << std::endl;
+    f.probability = .0;
   }
+  if (fields[0] == "shared")
+  {
+    if (num_fields == 1) { f.probability = -1.f; }
+    else
+      std::cerr << "shared feature vectors should not have costs" << std::endl;
+  }
+  return f;
+}
+
+void parse_label(parser*, shared_data*, CB::label& ld, std::vector<VW::string_view>& words, reduction_features&)
+{
+  ld.weight = 1.0;
+  for (auto const& word : words) ld.costs.push_back(parse_class(word));
 }
 
 // clang-format off
@@ -176,18 +177,15 @@ void copy_label(CB_EVAL::label& dst, CB_EVAL::label& src)
   dst.action = src.action;
 }
 
-void parse_label(parser* p, shared_data* sd, CB_EVAL::label& ld, std::vector<VW::string_view>& words,
-    reduction_features& red_features)
+void parse_label(parser*, shared_data*, CB_EVAL::label& ld, std::vector<VW::string_view>& words, reduction_features&)
 {
   if (words.size() < 2) THROW("Evaluation can not happen without an action and an exploration");
 
   ld.action = (uint32_t)hashstring(words[0].begin(), words[0].length(), 0);
 
-  // Removing the first element of a vector is not efficient at all, every element must be copied/moved.
-  const auto stashed_first_token = std::move(words[0]);
-  words.erase(words.begin());
-  CB::parse_label(p, sd, ld.event, words, red_features);
-  words.insert(words.begin(), std::move(stashed_first_token));
+  // The words after the action are the label of the event, parsed in place rather than moved down the vector.
+  ld.event.weight = 1.0;
+  for (size_t i = 1; i < words.size(); i++) ld.event.costs.push_back(CB::parse_class(words[i]));
 }
 
 // clang-format off
@@ -0,0 +1,287 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "cb_candidates.h"
+
+#include "hnsw.h"
+#include "parse_args.h"  // for spoof_hex_encoded_namespaces
+#include "reductions.h"
+#include "vw_exception.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+using namespace VW::LEARNER;
+using namespace VW::config;
+
+namespace VW
+{
+namespace cb_candidates
+{
+constexpr uint32_t not_present = UINT32_MAX;
+
+// Actions are put in the catalog the first time they are seen. An action is embedded by the weights of its features in
+// the action namespace, its linear weights and, with --lrq of the shared and action namespaces, its latent weights,
+// so that the inner product of the embedding with the query of a decision is minus the part of the score of the
+// action which depends on the action. The query is made from the latent weights of the shared features.
+struct cb_candidates
+{
+  vw* all;
+  uint32_t k;
+  uint32_t ef;
+  uint32_t refresh;
+  unsigned char shared_ns;
+  unsigned char action_ns;
+  size_t rank;
+  float scale;
+  uint64_t ft_offset;
+
+  std::unordered_map<uint64_t, uint32_t> ids;  // of the hashes of the features of the actions
+  std::vector<uint64_t> hashes;
+  std::vector<std::vector<feature>> features;
+  hnsw_index index;
+  size_t next_refresh;
+
+  std::vector<float> embedding;
+  std::vector<float> query;
+  std::vector<uint32_t> action_ids;   // of the actions of the decision
+  std::vector<uint32_t> position_of;  // in the decision, of every action of the catalog
+  std::vector<uint32_t> found;
+  std::vector<uint32_t> positions;  // in the decision, of the candidates
+  multi_ex candidates;
+};
+
+uint64_t hash_features(const features& fs)
+{
+  const uint64_t h = uniform_hash(fs.indicies.begin(), fs.indicies.size() * sizeof(feature_index), 0);
+  return uniform_hash(fs.values.begin(), fs.values.size() * sizeof(feature_value), h);
+}
+
+void embed(cb_candidates& data, const std::vector<feature>& fs)
+{
+  vw& all = *data.all;
+  const uint32_t stride_shift = all.weights.stride_shift();
+  std::fill(data.embedding.begin(), data.embedding.end(), 0.f);
+  for (const auto& f : fs)
+  {
+    const uint64_t index = f.weight_index + data.ft_offset;
+    data.embedding[0] += f.x * all.weights[index];
+    for (size_t n = 1; n <= data.rank; n++)
+      data.embedding[n] += f.x * all.weights[index + (static_cast<uint64_t>(n) << stride_shift)];
+  }
+}
+
+void make_query(cb_candidates& data, features& fs)
+{
+  vw& all = *data.all;
+  const uint32_t stride_shift = all.weights.stride_shift();
+  std::fill(data.query.begin(), data.query.end(), 0.f);
+  // Lower scores are better.
+  data.query[0] = -1.f;
+  for (auto& f : fs)
+  {
+    const uint64_t index = f.index() + data.ft_offset;
+    for (size_t n = 1; n <= data.rank; n++)
+      data.query[n] -= data.scale * f.value() * all.weights[index + (static_cast<uint64_t>(n) << stride_shift)];
+  }
+}
+
+uint32_t find_or_add(cb_candidates& data, example& ec)
+{
+  features& fs = ec.feature_space[data.action_ns];
+  const uint64_t hash = hash_features(fs);
+  const auto it = data.ids.find(hash);
+  if (it != data.ids.end()) return it->second;
+
+  std::vector<feature> action_features;
+  action_features.reserve(fs.size());
+  for (auto& f : fs) action_features.emplace_back(f.value(), f.index());
+  embed(data, action_features);
+  const uint32_t id = data.index.add(data.embedding.data());
+  data.ids.emplace(hash, id);
+  data.hashes.push_back(hash);
+  data.features.push_back(std::move(action_features));
+  data.position_of.push_back(not_present);
+  return id;
+}
+
+void update(cb_candidates& data, uint32_t id)
+{
+  embed(data, data.features[id]);
+  data.index.update(id, data.embedding.data());
+}
+
+void select_candidates(cb_candidates& data, multi_ex& ec_seq)
+{
+  data.action_ids.clear();
+  for (example* ec : ec_seq) data.action_ids.push_back(find_or_add(data, *ec));
+  for (uint32_t i = 0; i < data.action_ids.size(); i++)
+  {
+    auto& position = data.position_of[data.action_ids[i]];
+    if (position == not_present) position = i;
+  }
+
+  make_query(data, ec_seq[0]->feature_space[data.shared_ns]);
+  data.index.search(data.query.data(), std::max(data.ef, data.k), data.ef, data.found);
+  data.positions.clear();
+  for (uint32_t id : data.found)
+  {
+    if (data.positions.size() == data.k) break;
+    auto& position = data.position_of[id];
+    if (position == not_present) continue;
+    data.positions.push_back(position);
+    position = not_present;
+  }
+  // The search missed some of the actions of the decision, score the first ones.
+  for (uint32_t i = 0; i < data.action_ids.size() && data.positions.size() < data.k; i++)
+  {
+    auto& position = data.position_of[data.action_ids[i]];
+    if (position != i) continue;
+    data.positions.push_back(position);
+    position = not_present;
+  }
+  for (uint32_t id : data.action_ids) data.position_of[id] = not_present;
+  std::sort(data.positions.begin(), data.positions.end());
+
+  data.candidates.clear();
+  for (uint32_t position : data.positions) data.candidates.push_back(ec_seq[position]);
+}
+
+void predict(cb_candidates& data, multi_learner& base, multi_ex& ec_seq)
+{
+  if (ec_seq.size() <= data.k)
+  {
+    base.predict(ec_seq);
+    return;
+  }
+
+  data.ft_offset = ec_seq[0]->ft_offset;
+  for (size_t i = 0; i < data.refresh && i < data.index.size(); i++)
+  {
+    update(data, static_cast<uint32_t>(data.next_refresh % data.index.size()));
+    data.next_refresh++;
+  }
+
+  select_candidates(data, ec_seq);
+  base.predict(data.candidates);
+  if (data.candidates[0] != ec_seq[0]) std::swap(data.candidates[0]->pred.a_s, ec_seq[0]->pred.a_s);
+  for (auto& a_s : ec_seq[0]->pred.a_s) a_s.action = data.positions[a_s.action];
+}
+
+// Learning goes through every action it is given, which with --cb_type mtr is only the logged action, and refreshes
+// the embeddings of the known ones.
+void learn(cb_candidates& data, multi_learner& base, multi_ex& ec_seq)
+{
+  base.learn(ec_seq);
+
+  data.ft_offset = ec_seq[0]->ft_offset;
+  for (example* ec : ec_seq)
+  {
+    const auto it = data.ids.find(hash_features(ec->feature_space[data.action_ns]));
+    if (it != data.ids.end()) update(data, it->second);
+  }
+}
+
+void save_load(cb_candidates& data, io_buf& model_file, bool read, bool text)
+{
+  if (model_file.num_files() == 0) return;
+
+  std::stringstream msg;
+  uint64_t actions = data.hashes.size();
+  msg << "cb_candidates actions " << actions << "\n";
+  bin_text_read_write_fixed(model_file, reinterpret_cast<char*>(&actions), sizeof(actions), "", read, msg, text);
+  if (!text)
+  {
+    if (read)
+    {
+      data.hashes.resize(actions);
+      data.features.resize(actions);
+    }
+    bin_text_read_write_fixed(model_file, reinterpret_cast<char*>(data.hashes.data()),
+        actions * sizeof(data.hashes[0]), "", read, msg, text);
+    for (auto& fs : data.features)
+    {
+      uint64_t size = fs.size();
+      bin_text_read_write_fixed(model_file, reinterpret_cast<char*>(&size), sizeof(size), "", read, msg, text);
+      if (read) fs.resize(size);
+      bin_text_read_write_fixed(
+          model_file, reinterpret_cast<char*>(fs.data()), size * sizeof(feature), "", read, msg, text);
+    }
+  }
+  data.index.save_load(model_file, read, text);
+
+  if (read)
+  {
+    if (data.index.size() != actions)
+    { THROW("cb_candidates: the model holds " << actions << " actions and an index of " << data.index.size()); }
+    data.ids.clear();
+    for (uint32_t id = 0; id < actions; id++) data.ids.emplace(data.hashes[id], id);
+    data.position_of.assign(actions, not_present);
+  }
+}
+
+size_t lrq_rank(options_i& options, unsigned char shared_ns, unsigned char action_ns)
+{
+  if (!options.was_supplied("lrq")) return 0;
+  for (const auto& lrq : options.get_typed_option<std::vector<std::string>>("lrq").value())
+  {
+    const std::string pair = spoof_hex_encoded_namespaces(lrq);
+    if (pair.size() < 3) continue;
+    if ((pair[0] == shared_ns && pair[1] == action_ns) || (pair[0] == action_ns && pair[1] == shared_ns))
+      return std::stoul(pair.substr(2));
+  }
+  return 0;
+}
+
+base_learner* setup(options_i& options, vw& all)
+{
+  auto data = scoped_calloc_or_throw<cb_candidates>();
+  std::string namespaces;
+  option_group_definition new_options("Contextual Bandit Candidates with ADF");
+  new_options
+      .add(make_option("cb_candidates", data->k)
+               .keep()
+               .necessary()
+               .help("score only k actions of every decision, found by a nearest neighbor search over embeddings of "
+                     "the actions made from their weights"))
+      .add(make_option("cb_candidates_namespaces", namespaces)
+               .keep()
+               .help("the shared and action namespaces, like ua. Actions are told apart by their features in the "
+                     "action namespace, and embedded by their linear weights and the latent weights of --lrq ua<rank>"))
+      .add(make_option("cb_candidates_ef", data->ef)
+               .default_value(64)
+               .help("number of nearest actions which the search keeps, among which the k best of the decision are "
+                     "scored"))
+      .add(make_option("cb_candidates_refresh", data->refresh)
+               .default_value(16)
+               .help("number of embeddings refreshed from the current weights at every decision, in turn"));
+
+  if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
+
+  namespaces = spoof_hex_encoded_namespaces(namespaces);
+  if (namespaces.size() != 2)
+    THROW("cb_candidates needs the shared and action namespaces, like --cb_candidates_namespaces ua");
+  if (data->k == 0) THROW("cb_candidates must score at least one action");
+  data->shared_ns = static_cast<unsigned char>(namespaces[0]);
+  data->action_ns = static_cast<unsigned char>(namespaces[1]);
+
+  auto* base = as_multiline(setup_base(options, all));
+  if (base->pred_type != prediction_type_t::action_scores)
+    THROW("cb_candidates needs a reduction which ranks the actions, like --cb_adf or --csoaa_ldf with --csoaa_rank");
+
+  data->all = &all;
+  data->rank = lrq_rank(options, data->shared_ns, data->action_ns);
+  data->scale = options.was_supplied("lrqdropout") ? 0.5f : 1.f;
+  data->index = hnsw_index(1 + data->rank, 16, 64, all.random_seed);
+  data->embedding.resize(data->index.dim());
+  data->query.resize(data->index.dim());
+
+  auto& l = init_learner(data, base, learn, predict, 1);
+  l.set_save_load(save_load);
+  return make_base(l);
+}
+
+}  // namespace cb_candidates
+}  // namespace VW
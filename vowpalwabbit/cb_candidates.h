@@ -0,0 +1,16 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "reductions_fwd.h"
+
+namespace VW
+{
+namespace cb_candidates
+{
+VW::LEARNER::base_learner* setup(VW::config::options_i& options, vw& all);
+
+}  // namespace cb_candidates
+}  // namespace VW
@@ -33,14 +33,15 @@ private:
   bool _greedify;
   bool _first_only;
   std::shared_ptr<rand_state> _random_state;
+  size_t _top_k;  // of the actions sorted to the front, see --csoaa_rank_top_k
 
   v_array<ACTION_SCORE::action_score> _action_probs;
   std::vector<float> _scores;
   std::vector<float> _top_actions;
 
 public:
-  cb_explore_adf_bag(
-      float epsilon, size_t bag_size, bool greedify, bool first_only, std::shared_ptr<rand_state> random_state);
+  cb_explore_adf_bag(float epsilon, size_t bag_size, bool greedify, bool first_only,
+      std::shared_ptr<rand_state> random_state, size_t top_k);
   ~cb_explore_adf_bag();
 
   // Should be called through cb_explore_adf_base for pre/post-processing
@@ -52,9 +53,14 @@ private:
   void predict_or_learn_impl(VW::LEARNER::multi_learner& base, multi_ex& examples);
 };
 
-cb_explore_adf_bag::cb_explore_adf_bag(
-    float epsilon, size_t bag_size, bool greedify, bool first_only, std::shared_ptr<rand_state> random_state)
-    : _epsilon(epsilon), _bag_size(bag_size), _greedify(greedify), _first_only(first_only), _random_state(random_state)
+cb_explore_adf_bag::cb_explore_adf_bag(float epsilon, size_t bag_size, bool greedify, bool first_only,
+    std::shared_ptr<rand_state> random_state, size_t top_k)
+    : _epsilon(epsilon)
+    , _bag_size(bag_size)
+    , _greedify(greedify)
+    , _first_only(first_only)
+    , _random_state(random_state)
+    , _top_k(top_k)
 {
 }
 
@@ -108,7 +114,7 @@ void cb_explore_adf_bag::predict_or_learn_impl(VW::LEARNER::multi_learner& base,
 
   exploration::enforce_minimum_probability(_epsilon, true, begin_scores(_action_probs), end_scores(_action_probs));
 
-  sort_action_probs(_action_probs, _scores);
+  sort_action_probs(_action_probs, _scores, _top_k);
 
   for (size_t i = 0; i < num_actions; i++) preds[i] = _action_probs[i];
 }
@@ -146,7 +152,8 @@ VW::LEARNER::base_learner* setup(VW::config::options_i& options, vw& all)
   all.example_parser->lbl_parser = CB::cb_label;
 
   using explore_type = cb_explore_adf_base<cb_explore_adf_bag>;
-  auto data = scoped_calloc_or_throw<explore_type>(epsilon, bag_size, greedify, first_only, all.get_random_state());
+  auto data = scoped_calloc_or_throw<explore_type>(
+      epsilon, bag_size, greedify, first_only, all.get_random_state(), rank_top_k(options));
 
   VW::LEARNER::learner<explore_type, multi_ex>& l = VW::LEARNER::init_learner(
       data, base, explore_type::learn, explore_type::predict, problem_multiplier, prediction_type_t::action_probs);
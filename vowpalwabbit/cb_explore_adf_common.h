@@ -18,31 +18,44 @@
 #include "cb_adf.h"          // used for function call in predict/learn
 #include "example.h"         // used in predict
 #include "gen_cs_example.h"  // required for GEN_CS::cb_to_cs_adf
+#include "options.h"         // used in rank_top_k
 #include "reductions_fwd.h"
+#include "text_format.h"     // used in output_example
 
 namespace VW
 {
 namespace cb_explore_adf
 {
 // Free functions
-inline void sort_action_probs(v_array<ACTION_SCORE::action_score>& probs, const std::vector<float>& scores)
+// With top_k below the number of actions only the top_k most probable actions are sorted to the front, see
+// --csoaa_rank_top_k.
+inline void sort_action_probs(
+    v_array<ACTION_SCORE::action_score>& probs, const std::vector<float>& scores, size_t top_k = 0)
 {
   // We want to preserve the score order in the returned action_probs if possible.  To do this,
   // sort top_actions and action_probs by the order induced in scores.
-  std::sort(probs.begin(), probs.end(),
-      [&scores](const ACTION_SCORE::action_score& as1, const ACTION_SCORE::action_score& as2) {
-        if (as1.score > as2.score)
-          return true;
-        else if (as1.score < as2.score)
-          return false;
-        // equal probabilities
-        if (scores[as1.action] < scores[as2.action])
-          return true;
-        else if (scores[as1.action] > scores[as2.action])
-          return false;
-        // equal probabilities and equal cost estimates
-        return as1.action < as2.action;
-      });
+  const auto order = [&scores](const ACTION_SCORE::action_score& as1, const ACTION_SCORE::action_score& as2) {
+    if (as1.score > as2.score)
+      return true;
+    else if (as1.score < as2.score)
+      return false;
+    // equal probabilities
+    if (scores[as1.action] < scores[as2.action])
+      return true;
+    else if (scores[as1.action] > scores[as2.action])
+      return false;
+    // equal probabilities and equal cost estimates
+    return as1.action < as2.action;
+  };
+  if (top_k == 0 || top_k >= probs.size())
+    std::sort(probs.begin(), probs.end(), order);
+  else
+    std::partial_sort(probs.begin(), probs.begin() + top_k, probs.end(), order);
+}
+// The value of --csoaa_rank_top_k, once the cost sensitive learner below is set up.
+inline size_t rank_top_k(VW::config::options_i& options)
+{
+  return options.was_supplied("csoaa_rank_top_k") ? options.get_typed_option<uint32_t>("csoaa_rank_top_k").value() : 0;
 }
 inline size_t fill_tied(v_array<ACTION_SCORE::action_score>& preds)
 {
@@ -66,6 +79,8 @@ private:
   // used in output_example
   CB::label _action_label;
   CB::label _empty_label;
+  // used in output_example, kept so that the raw predictions are formatted without allocating
+  VW::text_line _raw_prediction;
   ExploreType explore;
 
 public:
@@ -158,16 +173,15 @@ void cb_explore_adf_base<ExploreType>::output_example(vw& all, multi_ex& ec_seq)
 
   if (all.raw_prediction != nullptr)
   {
-    std::string outputString;
-    std::stringstream outputStringStream(outputString);
     const auto& costs = ec.l.cb.costs;
 
+    _raw_prediction.clear();
     for (size_t i = 0; i < costs.size(); i++)
     {
-      if (i > 0) outputStringStream << ' ';
-      outputStringStream << costs[i].action << ':' << costs[i].partial_prediction;
+      if (i > 0) _raw_prediction.add(' ');
+      _raw_prediction.add_uint(costs[i].action).add(':').add_general(costs[i].partial_prediction);
     }
-    all.print_text_by_ref(all.raw_prediction.get(), outputStringStream.str(), ec.tag);
+    all.print_text_by_ref(all.raw_prediction.get(), _raw_prediction.str(), ec.tag);
   }
 
   CB::print_update(all, !labeled_example, ec, &ec_seq, true);
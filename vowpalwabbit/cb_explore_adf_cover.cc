@@ -15,6 +15,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <cfloat>
 #include <cmath>
 
 // All exploration algorithms return a vector of id, probability tuples, sorted in order of scores. The probabilities
@@ -42,6 +43,7 @@ private:
 
   VW::version_struct _model_file_version;
 
+  size_t _top_k;  // of the actions sorted to the front, see --csoaa_rank_top_k
   v_array<ACTION_SCORE::action_score> _action_probs;
   std::vector<float> _scores;
   COST_SENSITIVE::label _cs_labels;
@@ -49,10 +51,18 @@ private:
   v_array<COST_SENSITIVE::label> _prepped_cs_labels;
   v_array<CB::label> _cb_labels;
 
+  // With _fused the policies past the first are predicted and learned through the scorer, see setup.
+  vw* _all;
+  bool _fused;
+  std::vector<polyprediction> _policy_preds;  // of an action under each of those policies
+  std::vector<float> _policy_scores;          // of action j under policy i at [(i - 1) * num_actions + j]
+  std::vector<float> _policy_costs;           // the pseudo cost of action j for policy i at [j * num_policies + i - 1]
+  std::vector<uint32_t> _policy_models;       // 0 to num_policies - 1, for multiupdate, num_policies = cover_size - 1
+
 public:
   cb_explore_adf_cover(size_t cover_size, float psi, bool nounif, float epsilon, bool epsilon_decay, bool first_only,
       VW::LEARNER::multi_learner* cs_ldf_learner, VW::LEARNER::single_learner* scorer, size_t cb_type,
-      VW::version_struct model_file_version);
+      VW::version_struct model_file_version, size_t top_k, vw* all, bool fused);
   ~cb_explore_adf_cover();
 
   // Should be called through cb_explore_adf_base for pre/post-processing
@@ -63,11 +73,14 @@ public:
 private:
   template <bool is_learn>
   void predict_or_learn_impl(VW::LEARNER::multi_learner& base, multi_ex& examples);
+  void score_policies(multi_ex& examples);
+  void rank_policy(v_array<ACTION_SCORE::action_score>& preds, size_t i);
+  void learn_policies(multi_ex& examples);
 };
 
 cb_explore_adf_cover::cb_explore_adf_cover(size_t cover_size, float psi, bool nounif, float epsilon, bool epsilon_decay,
     bool first_only, VW::LEARNER::multi_learner* cs_ldf_learner, VW::LEARNER::single_learner* scorer, size_t cb_type,
-    VW::version_struct model_file_version)
+    VW::version_struct model_file_version, size_t top_k, vw* all, bool fused)
     : _cover_size(cover_size)
     , _psi(psi)
     , _nounif(nounif)
@@ -76,11 +89,80 @@ cb_explore_adf_cover::cb_explore_adf_cover(size_t cover_size, float psi, bool no
     , _first_only(first_only)
     , _cs_ldf_learner(cs_ldf_learner)
     , _model_file_version(model_file_version)
+    , _top_k(top_k)
+    , _all(all)
+    , _fused(fused)
 {
   _gen_cs.cb_type = cb_type;
   _gen_cs.scorer = scorer;
 }
 
+// Predicts the policies past the first on every action as csoaa_ldf would, in one multipredict per action.
+void cb_explore_adf_cover::score_policies(multi_ex& examples)
+{
+  const size_t num_policies = _cover_size - 1;
+  const uint64_t offset = examples[0]->ft_offset;
+  _policy_preds.resize(num_policies);
+  _policy_scores.resize(num_policies * examples.size());
+  for (size_t j = 0; j < examples.size(); j++)
+  {
+    example& ec = *examples[j];
+    const label_data saved_label = ec.l.simple;
+    const uint64_t saved_offset = ec.ft_offset;
+    auto restore_guard = VW::scope_exit([&ec, &saved_label, saved_offset] {
+      ec.l.simple = saved_label;
+      ec.ft_offset = saved_offset;
+    });
+
+    ec.l.simple = {FLT_MAX, 1.f, 0.f};
+    ec.ft_offset = offset;
+    // Policy i is at offset i + 1, as call_cs_ldf puts it.
+    _gen_cs.scorer->multipredict(ec, 2, num_policies, _policy_preds.data(), false);
+    for (size_t i = 0; i < num_policies; i++) _policy_scores[i * examples.size() + j] = _policy_preds[i].scalar;
+  }
+}
+
+// The actions sorted by their scores under policy i, as csoaa_ldf ranks them.
+void cb_explore_adf_cover::rank_policy(v_array<ACTION_SCORE::action_score>& preds, size_t i)
+{
+  const size_t num_actions = preds.size();
+  const float* scores = _policy_scores.data() + (i - 1) * num_actions;
+  preds.clear();
+  for (uint32_t j = 0; j < num_actions; j++) preds.push_back({j, scores[j]});
+  sort_action_scores(preds, _top_k);
+}
+
+// Learns the policies past the first from their pseudo costs, an action at a time as csoaa_ldf learns each of them,
+// with one multipredict and one multiupdate per action. The policies have weights of their own, so that only the
+// order of the updates to the state of the learning rates differs from learning them one after the other.
+void cb_explore_adf_cover::learn_policies(multi_ex& examples)
+{
+  const size_t num_policies = _cover_size - 1;
+  const uint64_t offset = examples[0]->ft_offset;
+  _policy_models.resize(num_policies);
+  for (size_t i = 0; i < num_policies; i++) _policy_models[i] = static_cast<uint32_t>(i);
+  for (size_t j = 0; j < examples.size(); j++)
+  {
+    example& ec = *examples[j];
+    if (ec.weight <= 0) continue;  // the scorer only predicts those
+    const float* costs = _policy_costs.data() + j * num_policies;
+    const label_data saved_label = ec.l.simple;
+    const uint64_t saved_offset = ec.ft_offset;
+    auto restore_guard = VW::scope_exit([&ec, &saved_label, saved_offset] {
+      ec.l.simple = saved_label;
+      ec.ft_offset = saved_offset;
+    });
+
+    // The scorer widens the range of the labels before it predicts.
+    for (size_t i = 0; i < num_policies; i++) _all->set_minmax(_all->sd, costs[i]);
+    ec.l.simple = {FLT_MAX, 1.f, 0.f};
+    ec.ft_offset = offset;
+    _gen_cs.scorer->multipredict(ec, 2, num_policies, _policy_preds.data(), true);
+    ec.ft_offset = offset + 2 * _gen_cs.scorer->increment;
+    _gen_cs.scorer->multiupdate(ec, num_policies, _policy_models.data(), costs, _policy_preds.data());
+  }
+}
+
 template <bool is_learn>
 void cb_explore_adf_cover::predict_or_learn_impl(VW::LEARNER::multi_learner& base, multi_ex& examples)
 {
@@ -126,6 +208,12 @@ void cb_explore_adf_cover::predict_or_learn_impl(VW::LEARNER::multi_learner& bas
   else
     _action_probs[preds[0].action].score += additive_probability;
 
+  if (_fused && _cover_size > 1)
+  {
+    score_policies(examples);
+    if (is_learn) _policy_costs.resize(num_actions * (_cover_size - 1));
+  }
+
   float norm = min_prob * num_actions + (additive_probability - min_prob);
   for (size_t i = 1; i < _cover_size; i++)
   {
@@ -142,14 +230,19 @@ void cb_explore_adf_cover::predict_or_learn_impl(VW::LEARNER::multi_learner& bas
       {
         float pseudo_cost =
             _cs_labels.costs[j].x - _psi * min_prob / ((std::max)(_action_probs[j].score, min_prob) / norm);
-        _cs_labels_2.costs.push_back({pseudo_cost, j, 0., 0.});
+        if (_fused)
+          _policy_costs[j * (_cover_size - 1) + i - 1] = pseudo_cost;
+        else
+          _cs_labels_2.costs.push_back({pseudo_cost, j, 0., 0.});
       }
-      GEN_CS::call_cs_ldf<true>(
-          *(_cs_ldf_learner), examples, _cb_labels, _cs_labels_2, _prepped_cs_labels, examples[0]->ft_offset, i + 1);
+      if (!_fused)
+        GEN_CS::call_cs_ldf<true>(*(_cs_ldf_learner), examples, _cb_labels, _cs_labels_2, _prepped_cs_labels,
+            examples[0]->ft_offset, i + 1);
     }
-    else
+    else if (!_fused)
       GEN_CS::call_cs_ldf<false>(
           *(_cs_ldf_learner), examples, _cb_labels, _cs_labels, _prepped_cs_labels, examples[0]->ft_offset, i + 1);
+    if (_fused) rank_policy(preds, i);
 
     for (uint32_t j = 0; j < num_actions; j++) _scores[j] += preds[j].score;
     if (!_first_only)
@@ -176,10 +269,12 @@ void cb_explore_adf_cover::predict_or_learn_impl(VW::LEARNER::multi_learner& bas
     }
   }
 
+  if (is_learn && _fused && _cover_size > 1) learn_policies(examples);
+
   exploration::enforce_minimum_probability(
       min_prob * num_actions, !_nounif, begin_scores(_action_probs), end_scores(_action_probs));
 
-  sort_action_probs(_action_probs, _scores);
+  sort_action_probs(_action_probs, _scores, _top_k);
   for (size_t i = 0; i < num_actions; i++) preds[i] = _action_probs[i];
 
   if (is_learn) ++_counter;
@@ -277,6 +372,19 @@ VW::LEARNER::base_learner* setup(config::options_i& options, vw& all)
   VW::LEARNER::multi_learner* base = VW::LEARNER::as_multiline(setup_base(options, all));
   all.example_parser->lbl_parser = CB::cb_label;
 
+  // The policies past the first are learned by csoaa_ldf, which regresses the cost of each action through the scorer.
+  // When the scorer is right below it and nothing about csoaa_ldf changes that, they are predicted and learned
+  // through the scorer directly, all of them in one pass over the features of an action.
+  const auto& reductions = all.enabled_reductions;
+  const auto csoaa_ldf = std::find(reductions.begin(), reductions.end(), "csoaa_ldf");
+  const bool fused = csoaa_ldf != reductions.begin() && csoaa_ldf != reductions.end() && *(csoaa_ldf - 1) == "scorer" &&
+      !options.was_supplied("wap_ldf") && !options.was_supplied("ldf_override") &&
+      !options.was_supplied("csoaa_rank_top_k_bound") &&
+      (options.get_typed_option<std::string>("csoaa_ldf").value() == "multiline" ||
+          options.get_typed_option<std::string>("csoaa_ldf").value() == "m") &&
+      options.get_typed_option<std::string>("link").value() == "identity" &&
+      all.cost_sensitive->increment == all.scorer->increment;
+
   bool epsilon_decay;
   if (options.was_supplied("epsilon"))
   {
@@ -291,7 +399,7 @@ VW::LEARNER::base_learner* setup(config::options_i& options, vw& all)
 
   using explore_type = cb_explore_adf_base<cb_explore_adf_cover>;
   auto data = scoped_calloc_or_throw<explore_type>(cover_size, psi, nounif, epsilon, epsilon_decay, first_only,
-      as_multiline(all.cost_sensitive), all.scorer, cb_type_enum, all.model_file_ver);
+      as_multiline(all.cost_sensitive), all.scorer, cb_type_enum, all.model_file_ver, rank_top_k(options), &all, fused);
 
   VW::LEARNER::learner<explore_type, multi_ex>& l = init_learner(
       data, base, explore_type::learn, explore_type::predict, problem_multiplier, prediction_type_t::action_probs);
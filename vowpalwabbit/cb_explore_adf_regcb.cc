@@ -113,12 +113,15 @@ void cb_explore_adf_regcb::get_cost_ranges(
 
   const float cmin = _min_cb_cost;
   const float cmax = _max_cb_cost;
+  const float labels[2] = {cmin - 1, cmax + 1};
+  float sensitivities[2];
 
   for (size_t a = 0; a < num_actions; ++a)
   {
     example* ec = examples[a];
-    ec->l.simple.label = cmin - 1;
-    float sens = base.sensitivity(*ec);
+    // The sensitivities of both labels come from a single pass over the features of the action.
+    base.multi_sensitivity(*ec, labels, min_only ? 1 : 2, sensitivities);
+    float sens = sensitivities[0];
     float w = 0;  // importance weight
 
     if (ec->pred.scalar < cmin || std::isnan(sens) || std::isinf(sens))
@@ -132,8 +135,7 @@ void cb_explore_adf_regcb::get_cost_ranges(
 
     if (!min_only)
     {
-      ec->l.simple.label = cmax + 1;
-      sens = base.sensitivity(*ec);
+      sens = sensitivities[1];
       if (ec->pred.scalar > cmax || std::isnan(sens) || std::isinf(sens)) { _max_costs[a] = cmax; }
       else
       {
@@ -25,6 +25,7 @@ struct cb_explore_adf_softmax
 private:
   float _epsilon;
   float _lambda;
+  std::vector<float> _pmf;
 
 public:
   cb_explore_adf_softmax(float epsilon, float lambda);
@@ -47,10 +48,15 @@ void cb_explore_adf_softmax::predict_or_learn_impl(VW::LEARNER::multi_learner& b
   VW::LEARNER::multiline_learn_or_predict<is_learn>(base, examples, examples[0]->ft_offset);
 
   v_array<ACTION_SCORE::action_score>& preds = examples[0]->pred.a_s;
-  exploration::generate_softmax(
-      -_lambda, begin_scores(preds), end_scores(preds), begin_scores(preds), end_scores(preds));
+  if (preds.empty()) return;
 
-  exploration::enforce_minimum_probability(_epsilon, true, begin_scores(preds), end_scores(preds));
+  // The distribution is generated over contiguous scores.
+  _pmf.clear();
+  for (const auto& a_s : preds) _pmf.push_back(a_s.score);
+  exploration::generate_softmax(-_lambda, _pmf.data(), _pmf.data(), _pmf.size(), 1);
+
+  exploration::enforce_minimum_probability(_epsilon, true, _pmf.begin(), _pmf.end());
+  for (size_t i = 0; i < preds.size(); i++) preds[i].score = _pmf[i];
 }
 
 VW::LEARNER::base_learner* setup(VW::config::options_i& options, vw& all)
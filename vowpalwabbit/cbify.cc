@@ -682,7 +682,8 @@ base_learner* cbify_setup(options_i& options, vw& all)
 
   data->regression_data.num_actions = num_actions;
   data->use_adf = options.was_supplied("cb_explore_adf");
-  data->app_seed = uniform_hash("vw", 2, 0);
+  // --random_seed gives the simulations of a --sweep_args each their own exploration
+  data->app_seed = uniform_hash("vw", 2, 0) + all.random_seed;
   data->a_s = v_init<action_score>();
   data->all = &all;
 
@@ -805,7 +806,8 @@ base_learner* cbifyldf_setup(options_i& options, vw& all)
 
   if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
 
-  data->app_seed = uniform_hash("vw", 2, 0);
+  // --random_seed gives the simulations of a --sweep_args each their own exploration
+  data->app_seed = uniform_hash("vw", 2, 0) + all.random_seed;
   data->all = &all;
   data->use_adf = true;
 
@@ -218,42 +218,37 @@ ACTION_SCORE::action_score convert_to_score(
 }
 
 //<action>:<cost>:<probability>,<action>:<probability>,<action>:<probability>,…
-CCB::conditional_contextual_bandit_outcome* parse_outcome(VW::string_view& outcome)
+CCB::conditional_contextual_bandit_outcome* parse_outcome(VW::string_view outcome)
 {
   auto& ccb_outcome = *(new CCB::conditional_contextual_bandit_outcome());
 
-  std::vector<VW::string_view> split_commas;
-  tokenize(',', outcome, split_commas);
-
-  std::vector<VW::string_view> split_colons;
-  tokenize(':', split_commas[0], split_colons);
-
-  if (split_colons.size() != 3) THROW("Malformed ccb label");
+  VW::string_view pair;
+  VW::string_view fields[3];
+  next_token(',', outcome, pair);
+  if (tokenize_into(':', pair, fields, 3) != 3) THROW("Malformed ccb label");
 
   ccb_outcome.probabilities = v_init<ACTION_SCORE::action_score>();
-  ccb_outcome.probabilities.push_back(convert_to_score(split_colons[0], split_colons[2]));
-
-  ccb_outcome.cost = float_of_string(split_colons[1]);
-  if (std::isnan(ccb_outcome.cost)) THROW("error NaN cost: " << split_colons[1]);
+  ccb_outcome.probabilities.push_back(convert_to_score(fields[0], fields[2]));
 
-  split_colons.clear();
+  ccb_outcome.cost = float_of_string(fields[1]);
+  if (std::isnan(ccb_outcome.cost)) THROW("error NaN cost: " << fields[1]);
 
-  for (size_t i = 1; i < split_commas.size(); i++)
+  while (next_token(',', outcome, pair))
   {
-    tokenize(':', split_commas[i], split_colons);
-    if (split_colons.size() != 2) THROW("Must be action probability pairs");
-    ccb_outcome.probabilities.push_back(convert_to_score(split_colons[0], split_colons[1]));
+    if (tokenize_into(':', pair, fields, 2) != 2) THROW("Must be action probability pairs");
+    ccb_outcome.probabilities.push_back(convert_to_score(fields[0], fields[1]));
   }
 
   return &ccb_outcome;
 }
 
-void parse_explicit_inclusions(CCB::label& ld, const std::vector<VW::string_view>& split_inclusions)
+void parse_explicit_inclusions(CCB::label& ld, VW::string_view inclusions)
 {
-  for (const auto& inclusion : split_inclusions) { ld.explicit_included_actions.push_back(int_of_string(inclusion)); }
+  VW::string_view inclusion;
+  while (next_token(',', inclusions, inclusion)) { ld.explicit_included_actions.push_back(int_of_string(inclusion)); }
 }
 
-void parse_label(parser* p, shared_data*, label& ld, std::vector<VW::string_view>& words, ::reduction_features&)
+void parse_label(parser*, shared_data*, label& ld, std::vector<VW::string_view>& words, ::reduction_features&)
 {
   ld.weight = 1.0;
 
@@ -288,8 +283,7 @@ void parse_label(parser* p, shared_data*, label& ld, std::vector<VW::string_view
       }
       else
       {
-        tokenize(',', words[i], p->parse_name);
-        parse_explicit_inclusions(ld, p->parse_name);
+        parse_explicit_inclusions(ld, words[i]);
       }
     }
 
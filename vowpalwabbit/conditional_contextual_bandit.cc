@@ -44,6 +44,9 @@ struct ccb
   std::vector<bool> exclude_list, include_list;
   std::vector<std::vector<namespace_index>> generated_interactions;
   std::vector<std::vector<namespace_index>>* original_interactions;
+  // The namespaces of the shared example the generated interactions were calculated for, if they are still valid.
+  std::vector<namespace_index> interaction_namespaces;
+  bool interactions_valid;
   std::vector<CCB::label> stored_labels;
   size_t action_with_label;
 
@@ -297,6 +300,29 @@ void calculate_and_insert_interactions(example* shared, const std::vector<exampl
   }
 }
 
+// The interactions only depend on the namespaces of the actions and of the shared example, and so are calculated once
+// for the slots of a decision unless removing the features of a slot left one of its namespaces behind in shared.
+void update_interactions(ccb& data)
+{
+  const auto& indices = data.shared->indices;
+  if (data.interactions_valid && data.interaction_namespaces.size() == indices.size() &&
+      std::equal(indices.begin(), indices.end(), data.interaction_namespaces.begin()))
+  { return; }
+
+  data.generated_interactions.clear();
+  std::copy(data.original_interactions->begin(), data.original_interactions->end(),
+      std::back_inserter(data.generated_interactions));
+  calculate_and_insert_interactions(data.shared, data.actions, data.generated_interactions);
+  data.interaction_namespaces.assign(indices.begin(), indices.end());
+  data.interactions_valid = true;
+}
+
+void set_interactions(ccb& data, std::vector<std::vector<namespace_index>>* interactions)
+{
+  data.shared->interactions = interactions;
+  for (auto* ex : data.actions) { ex->interactions = interactions; }
+}
+
 // build a cb example from the ccb example
 template <bool is_learn>
 void build_cb_example(multi_ex& cb_ex, example* slot, ccb& data)
@@ -308,34 +334,12 @@ void build_cb_example(multi_ex& cb_ex, example* slot, ccb& data)
   inject_slot_features(data.shared, slot);
   cb_ex.push_back(data.shared);
 
-  // Retrieve the list of actions explicitly available for the slot (if the list is empty, then all actions are
-  // possible)
-  auto& explicit_includes = slot->l.conditional_contextual_bandit.explicit_included_actions;
-  if (!explicit_includes.empty())
-  {
-    // First time seeing this, initialize the vector with falses so we can start setting each included action.
-    if (data.include_list.empty()) { data.include_list.assign(data.actions.size(), false); }
-
-    for (uint32_t included_action_id : explicit_includes) { data.include_list[included_action_id] = true; }
-  }
-
-  // set the available actions in the cb multi-example
-  uint32_t index = 0;
+  // Select an action, unless chosen by previous slots, and save its original index in the root multi-example.
   data.origin_index.clear();
-  data.origin_index.resize(data.actions.size(), 0);
-  for (size_t i = 0; i < data.actions.size(); i++)
-  {
-    // Filter actions that are not explicitly included. If the list is empty though, everything is included.
-    if (!data.include_list.empty() && !data.include_list[i]) { continue; }
-
-    // Filter actions chosen by previous slots
-    if (data.exclude_list[i]) { continue; }
-
-    // Select the action
+  auto select_action = [&data, &cb_ex, slot, slot_has_label](uint32_t i) {
+    if (data.exclude_list[i]) { return; }
     cb_ex.push_back(data.actions[i]);
-
-    // Save the original index from the root multi-example
-    data.origin_index[index++] = (uint32_t)i;
+    data.origin_index.push_back(i);
 
     // Remember the index of the chosen action
     if (is_learn)
@@ -343,10 +347,44 @@ void build_cb_example(multi_ex& cb_ex, example* slot, ccb& data)
       if (slot_has_label && i == slot->l.conditional_contextual_bandit.outcome->probabilities[0].action)
       {
         // This is used to remove the label later.
-        data.action_with_label = (uint32_t)i;
+        data.action_with_label = i;
+        const auto index = static_cast<uint32_t>(data.origin_index.size());
         attach_label_to_example(index, data.actions[i], slot->l.conditional_contextual_bandit.outcome, data);
       }
     }
+  };
+
+  // Retrieve the list of actions explicitly available for the slot (if the list is empty, then all actions are
+  // possible)
+  const auto& explicit_includes = slot->l.conditional_contextual_bandit.explicit_included_actions;
+  const auto unordered = std::adjacent_find(
+      explicit_includes.begin(), explicit_includes.end(), [](uint32_t a, uint32_t b) { return a >= b; });
+  if (!explicit_includes.empty() && unordered == explicit_includes.end())
+  {
+    // Increasing lists, such as those of slates which give every slot actions of its own, are selected from directly
+    // rather than by going through all the actions.
+    for (uint32_t included_action_id : explicit_includes)
+    {
+      if (included_action_id >= data.actions.size()) { break; }
+      select_action(included_action_id);
+    }
+  }
+  else
+  {
+    if (!explicit_includes.empty())
+    {
+      // First time seeing this, initialize the vector with falses so we can start setting each included action.
+      if (data.include_list.empty()) { data.include_list.assign(data.actions.size(), false); }
+
+      for (uint32_t included_action_id : explicit_includes) { data.include_list[included_action_id] = true; }
+    }
+
+    for (uint32_t i = 0; i < data.actions.size(); i++)
+    {
+      // Filter actions that are not explicitly included. If the list is empty though, everything is included.
+      if (!data.include_list.empty() && !data.include_list[i]) { continue; }
+      select_action(i);
+    }
   }
 
   // Must provide a prediction that cb can write into, this will be saved into the decision scores object later.
@@ -417,22 +455,20 @@ void learn_or_predict(ccb& data, multi_learner& base, multi_ex& examples)
     // Reset exclusion list for this example.
     data.exclude_list.assign(data.actions.size(), false);
 
+    // Arrays already in the prediction are spares, left by the reduction above to predict the slots into.
+    for (auto& a_s : examples[0]->pred.decision_scores) { return_v_array(a_s, data.action_score_pool); }
+    examples[0]->pred.decision_scores.clear();
     auto decision_scores = examples[0]->pred.decision_scores;
 
+    // Namespace crossing for slot features.
+    data.interactions_valid = false;
+    if (should_augment_with_slot_info) { set_interactions(data, &data.generated_interactions); }
+
     // for each slot, re-build the cb example and call cb_explore_adf
     size_t slot_id = 0;
     for (example* slot : data.slots)
     {
-      if (should_augment_with_slot_info)
-      {
-        // Namespace crossing for slot features.
-        data.generated_interactions.clear();
-        std::copy(data.original_interactions->begin(), data.original_interactions->end(),
-            std::back_inserter(data.generated_interactions));
-        calculate_and_insert_interactions(data.shared, data.actions, data.generated_interactions);
-        data.shared->interactions = &data.generated_interactions;
-        for (auto* ex : data.actions) { ex->interactions = &data.generated_interactions; }
-      }
+      if (should_augment_with_slot_info) { update_interactions(data); }
 
       data.include_list.clear();
       build_cb_example<is_learn>(data.cb_ex, slot, data);
@@ -459,11 +495,6 @@ void learn_or_predict(ccb& data, multi_learner& base, multi_ex& examples)
         decision_scores.push_back(data.action_score_pool.get_object());
       }
 
-      if (should_augment_with_slot_info)
-      {
-        data.shared->interactions = data.original_interactions;
-        for (auto* ex : data.actions) { ex->interactions = data.original_interactions; }
-      }
       remove_slot_features(data.shared, slot);
 
       if (should_augment_with_slot_info)
@@ -480,11 +511,14 @@ void learn_or_predict(ccb& data, multi_learner& base, multi_ex& examples)
       slot_id++;
       data.cb_ex.clear();
     }
+    if (should_augment_with_slot_info) { set_interactions(data, data.original_interactions); }
+
     // Save the predictions
     examples[0]->pred.decision_scores = decision_scores;
   }
   catch (std::exception& e)
   {
+    if (should_augment_with_slot_info) { set_interactions(data, data.original_interactions); }
     data.all->trace_message << "CCB got exception from base reductions: " << e.what() << std::endl;
     throw;
   }
@@ -22,21 +22,30 @@ void predict_or_learn_with_confidence(confidence& /* c */, single_learner& base,
   float sensitivity = 0.f;
 
   float existing_label = ec.l.simple.label;
-  if (existing_label == FLT_MAX)
+  if (existing_label == FLT_MAX && !is_confidence_after_training)
   {
-    base.predict(ec);
-    float opposite_label = 1.f;
-    if (ec.pred.scalar > 0) opposite_label = -1.f;
-    ec.l.simple.label = opposite_label;
+    // at the label opposite to the prediction, found along with it
+    sensitivity = base.predict_with_sensitivity(ec);
+    if (is_learn) base.learn(ec);
   }
-
-  if (!is_confidence_after_training) sensitivity = base.sensitivity(ec);
-
-  ec.l.simple.label = existing_label;
-  if (is_learn)
-    base.learn(ec);
   else
-    base.predict(ec);
+  {
+    if (existing_label == FLT_MAX)
+    {
+      base.predict(ec);
+      float opposite_label = 1.f;
+      if (ec.pred.scalar > 0) opposite_label = -1.f;
+      ec.l.simple.label = opposite_label;
+    }
+
+    if (!is_confidence_after_training) sensitivity = base.sensitivity(ec);
+
+    ec.l.simple.label = existing_label;
+    if (is_learn)
+      base.learn(ec);
+    else
+      base.predict(ec);
+  }
 
   if (is_confidence_after_training) sensitivity = base.sensitivity(ec);
 
@@ -12,11 +12,15 @@
 
 namespace COST_SENSITIVE
 {
-void name_value(VW::string_view& s, std::vector<VW::string_view>& name, float& v)
+constexpr size_t MAX_NAMES = 3;
+
+// Splits s into its name and values, and v into the first value. Returns the number of them, MAX_NAMES + 1 when there
+// are more than MAX_NAMES.
+size_t name_value(const VW::string_view& s, VW::string_view (&name)[MAX_NAMES], float& v)
 {
-  tokenize(':', s, name);
+  const size_t num_names = tokenize_into(':', s, name, MAX_NAMES);
 
-  switch (name.size())
+  switch (num_names)
   {
     case 0:
     case 1:
@@ -29,6 +33,7 @@ void name_value(VW::string_view& s, std::vector<VW::string_view>& name, float& v
     default:
       std::cerr << "example with a wierd name.  What is '" << s << "'?\n";
   }
+  return num_names;
 }
 
 char* bufread_label(label& ld, char* c, io_buf& cache)
@@ -98,27 +103,28 @@ void delete_label(label& ld) { ld.costs.delete_v(); }
 
 void copy_label(label& dst, label& src) { copy_array(dst.costs, src.costs); }
 
-void parse_label(parser* p, shared_data* sd, label& ld, std::vector<VW::string_view>& words, reduction_features&)
+void parse_label(parser*, shared_data* sd, label& ld, std::vector<VW::string_view>& words, reduction_features&)
 {
   ld.costs.clear();
+  VW::string_view name[MAX_NAMES];
 
   // handle shared and label first
   if (words.size() == 1)
   {
     float fx;
-    name_value(words[0], p->parse_name, fx);
-    bool eq_shared = p->parse_name[0] == "***shared***";
-    bool eq_label = p->parse_name[0] == "***label***";
+    const size_t num_names = name_value(words[0], name, fx);
+    bool eq_shared = name[0] == "***shared***";
+    bool eq_label = name[0] == "***label***";
     if (!sd->ldict)
     {
-      eq_shared |= p->parse_name[0] == "shared";
-      eq_label |= p->parse_name[0] == "label";
+      eq_shared |= name[0] == "shared";
+      eq_label |= name[0] == "label";
     }
     if (eq_shared || eq_label)
     {
       if (eq_shared)
       {
-        if (p->parse_name.size() != 1)
+        if (num_names != 1)
           std::cerr << "shared feature vectors should not have costs on: " << words[0] << std::endl;
         else
         {
@@ -128,11 +134,11 @@ void parse_label(parser* p, shared_data* sd, label& ld, std::vector<VW::string_v
       }
       if (eq_label)
       {
-        if (p->parse_name.size() != 2)
+        if (num_names != 2)
           std::cerr << "label feature vectors should have exactly one cost on: " << words[0] << std::endl;
         else
         {
-          wclass f = {float_of_string(p->parse_name[1]), 0, 0., 0.};
+          wclass f = {float_of_string(name[1]), 0, 0., 0.};
           ld.costs.push_back(f);
         }
       }
@@ -144,19 +150,19 @@ void parse_label(parser* p, shared_data* sd, label& ld, std::vector<VW::string_v
   for (unsigned int i = 0; i < words.size(); i++)
   {
     wclass f = {0., 0, 0., 0.};
-    name_value(words[i], p->parse_name, f.x);
+    const size_t num_names = name_value(words[i], name, f.x);
 
-    if (p->parse_name.size() == 0) THROW(" invalid cost: specification -- no names on: " << words[i]);
+    if (num_names == 0) THROW(" invalid cost: specification -- no names on: " << words[i]);
 
-    if (p->parse_name.size() == 1 || p->parse_name.size() == 2 || p->parse_name.size() == 3)
+    if (num_names == 1 || num_names == 2 || num_names == 3)
     {
-      f.class_index = sd->ldict ? (uint32_t)sd->ldict->get(p->parse_name[0])
-                                : (uint32_t)hashstring(p->parse_name[0].begin(), p->parse_name[0].length(), 0);
-      if (p->parse_name.size() == 1 && f.x >= 0)  // test examples are specified just by un-valued class #s
+      f.class_index = sd->ldict ? (uint32_t)sd->ldict->get(name[0])
+                                : (uint32_t)hashstring(name[0].begin(), name[0].length(), 0);
+      if (num_names == 1 && f.x >= 0)  // test examples are specified just by un-valued class #s
         f.x = FLT_MAX;
     }
     else
-      THROW("malformed cost specification on '" << (p->parse_name[0]) << "'");
+      THROW("malformed cost specification on '" << (name[0]) << "'");
 
     ld.costs.push_back(f);
   }
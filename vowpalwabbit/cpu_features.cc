@@ -0,0 +1,45 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "cpu_features.h"
+
+#include "cache.h"
+#include "ffm_simd.h"
+#include "ftrl_simd.h"
+#include "interactions_simd.h"
+#include "lda_simd.h"
+
+namespace
+{
+VW::cpu_features detect()
+{
+  VW::cpu_features features;
+#if !defined(VW_NO_INLINE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+  // The CPU features may not be known yet when called from a static initializer.
+  __builtin_cpu_init();
+  features.avx2 = __builtin_cpu_supports("avx2");
+  features.fma = __builtin_cpu_supports("fma");
+  features.avx512f = __builtin_cpu_supports("avx512f");
+  features.bmi2 = __builtin_cpu_supports("bmi2");
+  // Zen 3 is the first AMD CPU with both a fast pext and VAES.
+  features.fast_pext = features.bmi2 && (!__builtin_cpu_is("amd") || __builtin_cpu_supports("vaes"));
+#endif
+  return features;
+}
+}  // namespace
+
+namespace VW
+{
+const cpu_features& detected_cpu_features()
+{
+  static const cpu_features features = detect();
+  return features;
+}
+
+std::string kernel_variants()
+{
+  return std::string("interactions:") + INTERACTIONS::interaction_kernel_variant() + " ffm:" + ffm_kernel_variant() +
+      " ftrl:" + ftrl_kernel_variant() + " lda:" + lda_kernel_variant() + " cache:" + cache_decoder_variant();
+}
+}  // namespace VW
@@ -0,0 +1,29 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <string>
+
+namespace VW
+{
+// The x86 extensions the kernels of the *_simd.cc files and of the cache decoder are compiled for whatever the flags
+// of the build. Each set of kernels picks its variant from these at its first use, so that one binary runs the widest
+// variant each host supports. NEON is part of every AArch64 CPU and is picked at build time.
+struct cpu_features
+{
+  bool avx2 = false;
+  bool fma = false;
+  bool avx512f = false;
+  bool bmi2 = false;
+  bool fast_pext = false;  // bmi2 with a pext which beats the shifts it replaces, unlike the microcoded one of AMD CPUs
+                           // before Zen 3
+};
+
+// Detected once, may be called from static initializers.
+const cpu_features& detected_cpu_features();
+
+// The variant picked for each set of kernels, such as "interactions:avx512 lda:avx2 cache:bmi2", for --kernel_variants.
+std::string kernel_variants();
+}  // namespace VW
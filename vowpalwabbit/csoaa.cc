@@ -159,12 +159,23 @@ struct ldf
   action_scores a_s;
   uint64_t ft_offset;
 
+  // With --csoaa_rank_top_k, and with --csoaa_rank_top_k_bound the state of predict_top_k.
+  uint32_t rank_top_k;
+  bool rank_top_k_bound;
+  float weight_norm;
+  size_t decisions_since_weight_norm;
+  double weight_norm_t;    // all.sd->t once the norm of the weights was computed
+  double last_decision_t;  // all.sd->t at the previous multiline example
+  action_scores score_bounds;
+  std::vector<float> top_k_scores;  // a max heap
+
   v_array<action_scores> stored_preds;
 
   ~ldf()
   {
     a_s.delete_v();
     stored_preds.delete_v();
+    score_bounds.delete_v();
   }
 };
 
@@ -254,10 +265,15 @@ void make_single_prediction(ldf& data, single_learner& base, example& ec)
   simple_lbl.label = FLT_MAX;
   uint64_t old_offset = ec.ft_offset;
 
+  // Label features are appended after any shared features of their namespace, which gd then cannot factor out.
+  shared_linear_terms* shared_terms = ec.shared_terms;
+  if (shared_terms != nullptr && shared_terms->shared->feature_space[static_cast<unsigned char>('l')].nonempty())
+  { ec.shared_terms = nullptr; }
   LabelDict::add_example_namespace_from_memory(data.label_features, ec, ld.costs[0].class_index);
 
-  auto restore_guard = VW::scope_exit([&data, &ld, old_offset, &ec] {
+  auto restore_guard = VW::scope_exit([&data, &ld, old_offset, shared_terms, &ec] {
     ec.ft_offset = old_offset;
+    ec.shared_terms = shared_terms;
     ld.costs[0].partial_prediction = ec.partial_prediction;
     LabelDict::del_example_namespace_from_memory(data.label_features, ec, ld.costs[0].class_index);
     ec.l.cs = ld;
@@ -268,6 +284,90 @@ void make_single_prediction(ldf& data, single_learner& base, example& ec)
   base.predict(ec);  // make a prediction
 }
 
+// The norm of the weights is computed again after this many multiline examples while learning changes them, and
+// once learning stops.
+constexpr size_t WEIGHT_NORM_INTERVAL = 256;
+
+// The l2 norm of the weights of linear models, the first slot of the weights of every feature.
+float weight_norm(vw& all)
+{
+  double sum = 0.;
+  if (all.weights.sparse)
+    for (const weight& w : all.weights.sparse_weights) sum += static_cast<double>(w) * w;
+  else
+    for (const weight& w : all.weights.dense_weights) sum += static_cast<double>(w) * w;
+  return static_cast<float>(std::sqrt(sum) * std::fabs(all.sd->contraction));
+}
+
+// An upper bound of the l2 norm of the features of ec along with its interactions, the norm of an interaction being at
+// most the product of the norms of its namespaces.
+float feature_norm(example& ec)
+{
+  float sum = 0.f;
+  for (features& fs : ec) sum += fs.sum_feat_sq;
+  for (const auto& interaction : *ec.interactions)
+  {
+    float product = 1.f;
+    for (namespace_index ns : interaction) product *= ec.feature_space[ns].sum_feat_sq;
+    sum += product;
+  }
+  return std::sqrt(sum);
+}
+
+// Predicts the actions from the one with the largest features to the one with the smallest, until the lowest score
+// the next one can have, minus the norm of its features times the norm of the weights, cannot be among the
+// rank_top_k lowest scores so far. The actions which are not predicted are scored with that bound. The bound holds for
+// linear models but for hash collisions, and only approximately while learning as the norm of the weights is not
+// computed for every multiline example, see WEIGHT_NORM_INTERVAL.
+void predict_top_k(ldf& data, single_learner& base, multi_ex& ec_seq)
+{
+  const double t = data.all->sd->t;
+  const bool learning = t != data.last_decision_t;
+  data.last_decision_t = t;
+  if (t != data.weight_norm_t && (!learning || ++data.decisions_since_weight_norm % WEIGHT_NORM_INTERVAL == 0))
+  {
+    data.weight_norm = weight_norm(*data.all);
+    data.weight_norm_t = t;
+  }
+
+  const auto K = static_cast<uint32_t>(ec_seq.size());
+  data.score_bounds.clear();
+  for (uint32_t k = 0; k < K; k++)
+  {
+    data.stored_preds.push_back(ec_seq[k]->pred.a_s);
+    data.score_bounds.push_back({k, -data.weight_norm * feature_norm(*ec_seq[k])});
+  }
+  sort_action_scores(data.score_bounds);
+
+  auto& top_k = data.top_k_scores;
+  top_k.clear();
+  for (const auto& bound : data.score_bounds)
+  {
+    example& ec = *ec_seq[bound.action];
+    if (top_k.size() == data.rank_top_k && bound.score > top_k.front())
+    {
+      ec.partial_prediction = bound.score;
+      ec.l.cs.costs[0].partial_prediction = bound.score;
+      data.a_s.push_back(bound);
+      continue;
+    }
+
+    make_single_prediction(data, base, ec);
+    data.a_s.push_back({bound.action, ec.partial_prediction});
+    if (top_k.size() < data.rank_top_k)
+    {
+      top_k.push_back(ec.partial_prediction);
+      std::push_heap(top_k.begin(), top_k.end());
+    }
+    else if (ec.partial_prediction < top_k.front())
+    {
+      std::pop_heap(top_k.begin(), top_k.end());
+      top_k.back() = ec.partial_prediction;
+      std::push_heap(top_k.begin(), top_k.end());
+    }
+  }
+}
+
 bool test_ldf_sequence(ldf& data, multi_ex& ec_seq)
 {
   bool isTest;
@@ -335,19 +435,24 @@ void do_actual_learning_wap(ldf& data, single_learner& base, multi_ex& ec_seq)
       simple_lbl.label = (costs1[0].x < costs2[0].x) ? -1.0f : 1.0f;
       ec1->weight = value_diff;
       ec1->partial_prediction = 0.;
-      subtract_example(*data.all, ec1, ec2);
+      // Base learners which learn the difference of the pair directly spare making it, see learn_difference.
+      const bool subtracted = !base.learns_difference();
+      if (subtracted) subtract_example(*data.all, ec1, ec2);
       ec1->ft_offset = data.ft_offset;
 
       // Guard inner example state restore against throws
-      auto restore_guard_inner = VW::scope_exit([&data, old_offset, old_weight, &costs2, &ec2, &ec1] {
+      auto restore_guard_inner = VW::scope_exit([&data, old_offset, old_weight, subtracted, &costs2, &ec2, &ec1] {
         ec1->ft_offset = old_offset;
         ec1->weight = old_weight;
-        unsubtract_example(ec1);
+        if (subtracted) unsubtract_example(ec1);
 
         LabelDict::del_example_namespace_from_memory(data.label_features, *ec2, costs2[0].class_index);
       });
 
-      base.learn(*ec1);
+      if (subtracted)
+        base.learn(*ec1);
+      else
+        base.learn_difference(*ec1, *ec2);
     }
     // TODO: What about partial_prediction? See do_actual_learning_oaa.
   }
@@ -492,18 +597,22 @@ void do_actual_learning(ldf& data, single_learner& base, multi_ex& ec_seq_all)
   {
     data.a_s.clear();
     data.stored_preds.clear();
-    for (uint32_t k = 0; k < K; k++)
-    {
-      example* ec = ec_seq[k];
-      data.stored_preds.push_back(ec->pred.a_s);
-      make_single_prediction(data, base, *ec);
-      action_score s;
-      s.score = ec->partial_prediction;
-      s.action = k;
-      data.a_s.push_back(s);
-    }
+    // Label features are added to the actions as they are predicted, after their bound would be computed.
+    if (data.rank_top_k_bound && data.rank_top_k < K && data.label_features.empty())
+      predict_top_k(data, base, ec_seq);
+    else
+      for (uint32_t k = 0; k < K; k++)
+      {
+        example* ec = ec_seq[k];
+        data.stored_preds.push_back(ec->pred.a_s);
+        make_single_prediction(data, base, *ec);
+        action_score s;
+        s.score = ec->partial_prediction;
+        s.action = k;
+        data.a_s.push_back(s);
+      }
 
-    qsort((void*)data.a_s.begin(), data.a_s.size(), sizeof(action_score), score_comp);
+    sort_action_scores(data.a_s, data.rank_top_k);
   }
   else
   {
@@ -796,6 +905,14 @@ base_learner* csldf_setup(options_i& options, vw& all)
       make_option("ldf_override", ldf_override)
           .help("Override singleline or multiline from csoaa_ldf or wap_ldf, eg if stored in file"));
   csldf_outer_options.add(make_option("csoaa_rank", ld->rank).keep().help("Return actions sorted by score order"));
+  csldf_outer_options.add(make_option("csoaa_rank_top_k", ld->rank_top_k)
+                              .default_value(0)
+                              .help("with --csoaa_rank, only sort the <k> lowest scores to the front, by partial "
+                                    "selection. The other actions follow in no particular order"));
+  csldf_outer_options.add(make_option("csoaa_rank_top_k_bound", ld->rank_top_k_bound)
+                              .help("with --csoaa_rank_top_k, do not predict the actions whose score is bounded "
+                                    "out of the top k by the norm of their features times the norm of the weights, "
+                                    "which is approximate while learning. Assumes a linear model"));
   csldf_outer_options.add(
       make_option("probabilities", ld->is_probabilities).keep().help("predict probabilites of all classes"));
 
@@ -813,6 +930,7 @@ base_learner* csldf_setup(options_i& options, vw& all)
 
   ld->all = &all;
   ld->first_pass = true;
+  ld->weight_norm_t = -1.;
 
   std::string ldf_arg;
 
@@ -824,6 +942,7 @@ base_learner* csldf_setup(options_i& options, vw& all)
     ld->is_wap = true;
   }
   if (options.was_supplied("ldf_override")) ldf_arg = ldf_override;
+  if (ld->rank_top_k_bound && ld->rank_top_k == 0) THROW("csoaa_rank_top_k_bound requires csoaa_rank_top_k");
   if (ld->rank) all.delete_prediction = delete_action_scores;
 
   all.example_parser->lbl_parser = COST_SENSITIVE::cs_label;
@@ -0,0 +1,240 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "daemon_metrics.h"
+
+#ifdef _WIN32
+#  define NOMINMAX
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+using socklen_t = int;
+#else
+#  include <sys/select.h>
+#  include <sys/socket.h>
+#  include <netinet/in.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+
+#include "global_data.h"
+#include "model_reloader.h"
+#include "parser.h"
+#include "vw_exception.h"
+
+namespace
+{
+void close_socket(int fd)
+{
+#ifdef _WIN32
+  closesocket(fd);
+#else
+  close(fd);
+#endif
+}
+
+// Waits up to timeout_ms for the socket to be readable.
+bool wait_readable(int fd, int timeout_ms)
+{
+  fd_set readable;
+  FD_ZERO(&readable);
+  FD_SET(fd, &readable);
+  timeval timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_usec = (timeout_ms % 1000) * 1000;
+  return select(fd + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+void header(std::ostream& out, const char* name, const char* type, const char* help)
+{
+  out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+uint64_t weight_bytes(vw& all)
+{
+  if (all.weights.sparse)
+    return static_cast<uint64_t>(all.weights.sparse_weights.size()) * all.weights.sparse_weights.stride() *
+        sizeof(weight);
+  return (all.weights.dense_weights.mask() + 1) * sizeof(weight);
+}
+}  // namespace
+
+namespace VW
+{
+constexpr size_t daemon_metrics::LATENCY_WINDOW;
+
+daemon_metrics::daemon_metrics(vw& all, uint16_t port)
+    : _all(all), _socket(static_cast<int>(socket(PF_INET, SOCK_STREAM, 0))), _last_scrape(std::chrono::steady_clock::now())
+{
+  if (_socket < 0) THROWERRNO("socket");
+
+  int on = 1;
+  setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char*>(&on), sizeof(on));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (::bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(_socket, SOMAXCONN) < 0)
+  {
+    const int error = errno;
+    close_socket(_socket);
+    errno = error;
+    THROWERRNO("--metrics_port " << port);
+  }
+
+  socklen_t address_size = sizeof(address);
+  getsockname(_socket, reinterpret_cast<sockaddr*>(&address), &address_size);
+  _port = ntohs(address.sin_port);
+
+  _latencies.reserve(LATENCY_WINDOW);
+  _server = std::thread(&daemon_metrics::serve, this);
+}
+
+daemon_metrics::~daemon_metrics()
+{
+  stop();
+  close_socket(_socket);
+}
+
+void daemon_metrics::stop()
+{
+  _stopping = true;
+  if (_server.joinable()) _server.join();
+}
+
+void daemon_metrics::request_finished(std::chrono::steady_clock::duration latency)
+{
+  const double seconds = std::chrono::duration<double>(latency).count();
+  std::lock_guard<std::mutex> lock(_lock);
+  if (_latencies.size() < LATENCY_WINDOW)
+    _latencies.push_back(seconds);
+  else
+    _latencies[_next_latency] = seconds;
+  _next_latency = (_next_latency + 1) % LATENCY_WINDOW;
+  _requests++;
+  _latency_sum += seconds;
+}
+
+void daemon_metrics::serve()
+{
+  // The timeout bounds how long stop() waits.
+  while (!_stopping)
+  {
+    if (!wait_readable(_socket, 100)) continue;
+    const auto fd = static_cast<int>(accept(_socket, nullptr, nullptr));
+    if (fd < 0) continue;
+    answer(fd);
+    close_socket(fd);
+  }
+}
+
+// Reads the request up to the end of its headers, a client which does not send them within a second is dropped.
+void daemon_metrics::answer(int fd)
+{
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos)
+  {
+    if (request.size() > 16 * sizeof(buffer) || !wait_readable(fd, 1000)) return;
+    const auto received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) return;
+    request.append(buffer, static_cast<size_t>(received));
+  }
+
+  std::string status = "200 OK";
+  std::string body;
+  if (request.compare(0, 4, "GET ") == 0)
+    body = render();
+  else
+    status = "405 Method Not Allowed";
+
+  std::ostringstream response;
+  response << "HTTP/1.1 " << status << "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " << body.size()
+           << "\r\nConnection: close\r\n\r\n"
+           << body;
+  const std::string bytes = response.str();
+  size_t sent = 0;
+  while (sent < bytes.size())
+  {
+    const auto result = send(fd, bytes.data() + sent, static_cast<int>(bytes.size() - sent), 0);
+    if (result <= 0) return;
+    sent += static_cast<size_t>(result);
+  }
+}
+
+std::string daemon_metrics::render()
+{
+  auto& parser = *_all.example_parser;
+  const uint64_t examples = parser.finished_examples;
+  const auto now = std::chrono::steady_clock::now();
+  const double since_last_scrape = std::chrono::duration<double>(now - _last_scrape).count();
+  const double examples_per_second =
+      since_last_scrape > 0. ? static_cast<double>(examples - _last_examples) / since_last_scrape : 0.;
+  _last_scrape = now;
+  _last_examples = examples;
+
+  std::vector<double> latencies;
+  uint64_t requests;
+  double latency_sum;
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    latencies = _latencies;
+    requests = _requests;
+    latency_sum = _latency_sum;
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  const size_t pool_size = parser.example_pool.size();
+  const size_t pool_available = parser.example_pool.available();
+
+  std::ostringstream out;
+  header(out, "vw_examples_total", "counter", "Examples finished since the daemon started.");
+  out << "vw_examples_total " << examples << "\n";
+  header(out, "vw_examples_per_second", "gauge", "Examples finished per second since the previous scrape.");
+  out << "vw_examples_per_second " << examples_per_second << "\n";
+  header(out, "vw_ready_parsed_examples", "gauge", "Parsed examples waiting for the learner.");
+  out << "vw_ready_parsed_examples " << parser.ready_parsed_examples.size() << "\n";
+  header(out, "vw_example_pool_examples", "gauge", "Examples of the example pool, in use or free.");
+  out << "vw_example_pool_examples{state=\"in_use\"} " << pool_size - std::min(pool_size, pool_available) << "\n";
+  out << "vw_example_pool_examples{state=\"free\"} " << pool_available << "\n";
+
+  header(out, "vw_request_latency_seconds", "summary",
+      "Seconds from when a request starts to be parsed to when its last example is finished, the quantiles are of the "
+      "last 1024 requests.");
+  for (double quantile : {0.5, 0.99})
+  {
+    out << "vw_request_latency_seconds{quantile=\"" << quantile << "\"} ";
+    if (latencies.empty())
+      out << "NaN\n";
+    else
+      out << latencies[static_cast<size_t>(quantile * (latencies.size() - 1))] << "\n";
+  }
+  out << "vw_request_latency_seconds_sum " << latency_sum << "\n";
+  out << "vw_request_latency_seconds_count " << requests << "\n";
+
+  if (_all.model_reloader != nullptr)
+  {
+    header(out, "vw_model_reloads_total", "counter", "Models reloaded with --reload_model, and those which failed to.");
+    out << "vw_model_reloads_total{result=\"succeeded\"} " << _all.model_reloader->reloads() << "\n";
+    out << "vw_model_reloads_total{result=\"failed\"} " << _all.model_reloader->failed_reloads() << "\n";
+  }
+
+  if (_all.weights.sparse && _all.weights.sparse_weights.limit() > 0)
+  {
+    header(out, "vw_sparse_weights_evicted_total", "counter", "Sparse weights evicted by --sparse_weights_limit.");
+    out << "vw_sparse_weights_evicted_total " << _all.weights.sparse_weights.evicted() << "\n";
+  }
+
+  header(out, "vw_memory_bytes", "gauge",
+      "Bytes held by subsystem, the example pool not counting the features of its examples.");
+  out << "vw_memory_bytes{subsystem=\"weights\"} " << weight_bytes(_all) << "\n";
+  out << "vw_memory_bytes{subsystem=\"example_pool\"} " << pool_size * sizeof(example) << "\n";
+  out << "vw_memory_bytes{subsystem=\"hash_cache\"} "
+      << (parser.hash_cache != nullptr ? parser.hash_cache->bytes() : 0) << "\n";
+  return out.str();
+}
+}  // namespace VW
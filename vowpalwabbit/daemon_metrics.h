@@ -0,0 +1,79 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Mutex and thread cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a
+// managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <mutex>
+#  include <thread>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <mutex>
+#  include <thread>
+#endif
+
+struct vw;
+
+namespace VW
+{
+// Serves the metrics of a --daemon_event_loop daemon over HTTP on --metrics_port, in the Prometheus text format, from
+// a thread of its own: the examples finished and how many per second since the last scrape, the parsed examples
+// waiting for the learner, the examples of the pool in use, the latency of the last requests, the models reloaded and
+// the memory held by the weights, the example pool and the hash cache. Every GET is answered with the metrics,
+// whatever its path.
+class daemon_metrics
+{
+public:
+  // Listens on port, any free port if it is 0.
+  daemon_metrics(vw& all, uint16_t port);
+  ~daemon_metrics();
+
+  daemon_metrics(const daemon_metrics&) = delete;
+  daemon_metrics& operator=(const daemon_metrics&) = delete;
+
+  uint16_t port() const { return _port; }
+
+  // Stops serving, the metrics must not be served once the instance starts to be finished.
+  void stop();
+
+  // Adds the time from when a request started to be parsed to when its last example was finished.
+  void request_finished(std::chrono::steady_clock::duration latency);
+
+  // The metrics as they are served.
+  std::string render();
+
+private:
+  static constexpr size_t LATENCY_WINDOW = 1024;  // requests the latency quantiles are of
+
+  void serve();
+  void answer(int fd);
+
+  vw& _all;
+  int _socket;
+  uint16_t _port;
+  std::atomic<bool> _stopping{false};
+  std::thread _server;
+
+  std::mutex _lock;
+  std::vector<double> _latencies;  // seconds of the last LATENCY_WINDOW requests, a ring from _next_latency
+  size_t _next_latency = 0;
+  uint64_t _requests = 0;
+  double _latency_sum = 0.;
+
+  // Only touched by the server thread.
+  std::chrono::steady_clock::time_point _last_scrape;
+  uint64_t _last_examples = 0;
+};
+}  // namespace VW
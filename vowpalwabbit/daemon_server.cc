@@ -0,0 +1,739 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "daemon_server.h"
+
+#ifdef _WIN32
+#  define NOMINMAX
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+using socklen_t = int;
+#else
+#  include <sys/socket.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <unistd.h>
+#  ifdef __linux__
+#    include <sys/epoll.h>
+#  endif
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include "cache.h"
+#include "daemon_metrics.h"
+#include "global_data.h"
+#include "learner.h"
+#include "parser.h"
+#include "request_tracer.h"
+#include "vw.h"
+#include "vw_exception.h"
+
+// The largest cache block payload accepted from a client, as for cache files.
+constexpr uint64_t max_daemon_block_payload = uint64_t(1) << 31;
+
+namespace
+{
+volatile std::sig_atomic_t stop_requested = 0;
+
+void handle_stop(int) { stop_requested = 1; }
+
+void set_non_blocking(int fd)
+{
+#ifdef _WIN32
+  u_long on = 1;
+  ioctlsocket(fd, FIONBIO, &on);
+#else
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#endif
+}
+
+bool would_block()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+void close_socket(int fd)
+{
+#ifdef _WIN32
+  closesocket(fd);
+#else
+  close(fd);
+#endif
+}
+
+// Sends what the socket takes without blocking. Returns the number of bytes sent, or -1 if the connection failed.
+int64_t send_some(int fd, const char* data, size_t size)
+{
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;  // a client which went away must not kill the server with SIGPIPE
+#else
+  const int flags = 0;
+#endif
+  const auto sent = send(fd, data, static_cast<int>(std::min<size_t>(size, 1 << 30)), flags);
+  if (sent >= 0) return sent;
+  return would_block() ? 0 : -1;
+}
+
+uint32_t read_uint32(const char* p)
+{
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint64_t read_uint64(const char* p)
+{
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+struct poll_event
+{
+  uint64_t id;
+  bool readable;
+  bool writable;
+};
+}  // namespace
+
+namespace VW
+{
+struct daemon_connection
+{
+  enum class protocol
+  {
+    unknown,
+    text,
+    blocks
+  };
+
+  daemon_connection(int fd_, uint64_t id_) : fd(fd_), id(id_) {}
+  ~daemon_connection() { close_socket(fd); }
+
+  daemon_connection(const daemon_connection&) = delete;
+  daemon_connection& operator=(const daemon_connection&) = delete;
+
+  // Sends as much of the queued output as the socket takes. Returns true once nothing is left to send.
+  bool flush_output()
+  {
+    std::lock_guard<std::mutex> lock(output_lock);
+    while (!output.empty() && !send_failed)
+    {
+      const auto sent = send_some(fd, output.data(), output.size());
+      if (sent < 0) send_failed = true;
+      if (sent <= 0) break;
+      output.erase(output.begin(), output.begin() + sent);
+    }
+    if (send_failed) output.clear();
+    return output.empty();
+  }
+
+  const int fd;
+  const uint64_t id;
+
+  // Only touched by the parse thread.
+  protocol input_protocol = protocol::unknown;
+  std::vector<char> input;   // received and not parsed yet
+  size_t scanned = 0;        // bytes of input searched for the ends of requests
+  size_t line_start = 0;     // of the text line scanned last
+  size_t requests_end = 0;   // input up to here consists of complete requests
+  bool queued = false;       // waiting in the ready queue or being parsed
+  bool done_sending = false;  // the client closed its side, or sent something which cannot be read
+  bool polling = true;
+  bool polling_writable = false;
+  uint64_t examples_end = 0;  // number of examples parsed up to its last request, set once it is done sending
+  std::chrono::steady_clock::time_point received;  // when its first complete request was, with --trace_requests
+
+  std::mutex output_lock;
+  std::vector<char> output;  // predictions the socket did not take yet
+  bool send_failed = false;
+};
+
+// Waits for sockets with epoll on Linux and with poll elsewhere.
+class daemon_poller
+{
+public:
+  daemon_poller()
+  {
+#ifdef __linux__
+    _epoll = epoll_create1(0);
+    if (_epoll < 0) THROWERRNO("epoll_create1");
+#endif
+  }
+
+  ~daemon_poller()
+  {
+#ifdef __linux__
+    close(_epoll);
+#endif
+  }
+
+  daemon_poller(const daemon_poller&) = delete;
+  daemon_poller& operator=(const daemon_poller&) = delete;
+
+  void add(int fd, uint64_t id)
+  {
+#ifdef __linux__
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) < 0) THROWERRNO("epoll_ctl");
+#else
+    _positions[fd] = _fds.size();
+    pollfd entry{};
+    entry.fd = fd;
+    entry.events = POLLIN;
+    _fds.push_back(entry);
+    _ids.push_back(id);
+#endif
+  }
+
+  void set_writable(int fd, uint64_t id, bool writable)
+  {
+#ifdef __linux__
+    epoll_event event{};
+    event.events = writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.u64 = id;
+    epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, &event);
+#else
+    (void)id;
+    _fds[_positions[fd]].events = writable ? POLLIN | POLLOUT : POLLIN;
+#endif
+  }
+
+  void remove(int fd)
+  {
+#ifdef __linux__
+    epoll_event event{};
+    epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, &event);
+#else
+    const auto it = _positions.find(fd);
+    if (it == _positions.end()) return;
+    const size_t position = it->second;
+    _positions.erase(it);
+    if (position + 1 != _fds.size())
+    {
+      _fds[position] = _fds.back();
+      _ids[position] = _ids.back();
+      _positions[_fds[position].fd] = position;
+    }
+    _fds.pop_back();
+    _ids.pop_back();
+#endif
+  }
+
+  // Appends the sockets which are ready to events, waiting up to timeout_ms for one.
+  void wait(int timeout_ms, std::vector<poll_event>& events)
+  {
+#ifdef __linux__
+    epoll_event ready[256];
+    const int count = epoll_wait(_epoll, ready, 256, timeout_ms);
+    for (int i = 0; i < count; i++)
+    {
+      // Errors and hang ups are found by the next receive or send.
+      const bool failed = (ready[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+      events.push_back({ready[i].data.u64, failed || (ready[i].events & EPOLLIN) != 0,
+          failed || (ready[i].events & EPOLLOUT) != 0});
+    }
+#else
+#  ifdef _WIN32
+    const int count = WSAPoll(_fds.data(), static_cast<ULONG>(_fds.size()), timeout_ms);
+#  else
+    const int count = poll(_fds.data(), _fds.size(), timeout_ms);
+#  endif
+    if (count <= 0) return;
+    for (size_t i = 0; i < _fds.size(); i++)
+    {
+      const auto revents = _fds[i].revents;
+      if (revents == 0) continue;
+      const bool failed = (revents & (POLLERR | POLLHUP)) != 0;
+      events.push_back({_ids[i], failed || (revents & POLLIN) != 0, failed || (revents & POLLOUT) != 0});
+    }
+#endif
+  }
+
+private:
+#ifdef __linux__
+  int _epoll;
+#else
+#  ifdef _WIN32
+  using pollfd = WSAPOLLFD;
+#  endif
+  std::vector<pollfd> _fds;
+  std::vector<uint64_t> _ids;
+  std::unordered_map<int, size_t> _positions;  // of the sockets in _fds
+#endif
+};
+
+namespace
+{
+constexpr uint64_t listen_id = 0;
+
+class daemon_prediction_writer : public io::writer
+{
+public:
+  explicit daemon_prediction_writer(daemon_server& server) : _server(server) {}
+
+  ssize_t write(const char* buffer, size_t num_bytes) override
+  {
+    _server.example_predicted();
+    auto connection = _server.connection_of_finishing_example();
+    if (connection == nullptr) return num_bytes;
+
+    bool queued;
+    {
+      std::lock_guard<std::mutex> lock(connection->output_lock);
+      if (connection->send_failed) return num_bytes;
+      const bool was_empty = connection->output.empty();
+      size_t sent = 0;
+      if (was_empty)
+      {
+        const auto result = send_some(connection->fd, buffer, num_bytes);
+        if (result < 0)
+        {
+          connection->send_failed = true;
+          return num_bytes;
+        }
+        sent = static_cast<size_t>(result);
+      }
+      connection->output.insert(connection->output.end(), buffer + sent, buffer + num_bytes);
+      queued = was_empty && !connection->output.empty();
+    }
+    if (queued) _server.send_later(connection);
+    return num_bytes;
+  }
+
+  bool sends_binary()
+  {
+    auto connection = _server.connection_of_finishing_example();
+    return connection != nullptr && connection->input_protocol == daemon_connection::protocol::blocks;
+  }
+
+private:
+  daemon_server& _server;
+};
+}  // namespace
+
+daemon_server::daemon_server(vw& all, int listen_socket, bool json)
+    : _all(all)
+    , _listen_socket(listen_socket)
+    , _poller(new daemon_poller())
+    , _text_reader(all.example_parser->reader)
+    , _multiline_text(all.l->is_multiline && !json)
+    , _receive_buffer(1 << 16)
+{
+  set_non_blocking(_listen_socket);
+  _poller->add(_listen_socket, listen_id);
+  _all.example_parser->sorted_cache = true;
+
+  // SIGTERM ends the input, so that the model is finished and saved as after reading a file.
+  stop_requested = 0;
+  std::signal(SIGTERM, handle_stop);
+}
+
+daemon_server::~daemon_server()
+{
+  if (_current != nullptr) finish_request();
+  for (auto& connection : _connections) connection.second->flush_output();
+  std::signal(SIGTERM, SIG_DFL);
+}
+
+std::unique_ptr<io::writer> daemon_server::create_prediction_writer()
+{
+  return std::unique_ptr<io::writer>(new daemon_prediction_writer(*this));
+}
+
+int daemon_server::read_examples(v_array<example*>& examples)
+{
+  // The examples returned last were dispatched since, without a batch to wait in they were published.
+  if (_tracer != nullptr && _all.example_parser->dispatch_batch.empty()) _tracer->queued(_examples_parsed);
+  while (stop_requested == 0)
+  {
+    if (_current != nullptr)
+    {
+      const int result = _current_reader(&_all, examples);
+      if (result > 0)
+      {
+        // The examples are appended to the dispatch batch after this returns.
+        if (_all.example_parser->dispatch_batch.empty()) _batch_started = std::chrono::steady_clock::now();
+        if (_tracer != nullptr) _tracer->parsed(examples, _examples_parsed, _request_received);
+        _examples_parsed += examples.size();
+        return result;
+      }
+      finish_request();
+      continue;
+    }
+
+    int timeout_ms = 100;
+    publish_late_batch(timeout_ms);
+    if (!_ready.empty())
+    {
+      start_request(std::move(_ready.front()));
+      _ready.pop_front();
+    }
+    else
+    {
+      wait_for_requests(timeout_ms);
+    }
+  }
+  if (_current != nullptr) finish_request();
+  // Once the input ends the instance is finished, which the metrics must not be read from.
+  if (_metrics != nullptr) _metrics->stop();
+  return 0;
+}
+
+// Publishes the dispatch batch once it has waited --dispatch_latency, otherwise lowers timeout_ms to the time left.
+void daemon_server::publish_late_batch(int& timeout_ms)
+{
+  auto& parser = *_all.example_parser;
+  if (parser.dispatch_batch.empty()) return;
+  const auto waited = std::chrono::steady_clock::now() - _batch_started;
+  const auto latency = std::chrono::microseconds(parser.dispatch_latency);
+  if (waited >= latency)
+  {
+    flush_dispatch_batch(parser);
+    if (_tracer != nullptr) _tracer->queued(_examples_parsed);
+    return;
+  }
+  // Less than a millisecond left is waited out by polling without a timeout.
+  const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(latency - waited).count();
+  timeout_ms = std::min(timeout_ms, static_cast<int>(left));
+}
+
+void daemon_server::wait_for_requests(int timeout_ms)
+{
+  std::vector<std::weak_ptr<daemon_connection>> unsent;
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    unsent.swap(_unsent);
+  }
+  for (auto& weak_connection : unsent)
+  {
+    auto connection = weak_connection.lock();
+    if (connection == nullptr || !connection->polling || connection->polling_writable) continue;
+    if (connection->flush_output()) continue;
+    connection->polling_writable = true;
+    _poller->set_writable(connection->fd, connection->id, true);
+  }
+  close_finished_connections();
+
+  // Closing connections are checked on without events, the timeout also bounds how long SIGTERM goes unnoticed.
+  std::vector<poll_event> events;
+  _poller->wait(_closing.empty() ? timeout_ms : std::min(timeout_ms, 10), events);
+  for (const auto& event : events)
+  {
+    if (event.id == listen_id)
+    {
+      accept_connections();
+      continue;
+    }
+    const auto it = _connections.find(event.id);
+    if (it == _connections.end()) continue;
+    auto connection = it->second;
+    if (event.writable && connection->polling_writable && connection->flush_output())
+    {
+      connection->polling_writable = false;
+      _poller->set_writable(connection->fd, connection->id, false);
+    }
+    if (event.readable) receive(connection);
+  }
+}
+
+void daemon_server::accept_connections()
+{
+  while (true)
+  {
+    sockaddr_in client_address;
+    socklen_t size = sizeof(client_address);
+    const auto fd = static_cast<int>(accept(_listen_socket, reinterpret_cast<sockaddr*>(&client_address), &size));
+    if (fd < 0) return;
+
+    set_non_blocking(fd);
+    // Disable Nagle delay algorithm due to daemon mode's interactive workload
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&one), sizeof(one));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, reinterpret_cast<char*>(&one), sizeof(one));
+#endif
+
+    auto connection = std::make_shared<daemon_connection>(fd, _next_id++);
+    _poller->add(fd, connection->id);
+    _connections.emplace(connection->id, std::move(connection));
+  }
+}
+
+void daemon_server::receive(const std::shared_ptr<daemon_connection>& connection)
+{
+  // One read per event, connections which have more are reported again.
+  auto& c = *connection;
+  const auto received = recv(c.fd, _receive_buffer.data(), static_cast<int>(_receive_buffer.size()), 0);
+  if (received > 0) { c.input.insert(c.input.end(), _receive_buffer.data(), _receive_buffer.data() + received); }
+  else if (received == 0 || !would_block())
+  {
+    c.done_sending = true;
+  }
+
+  const bool had_requests = c.requests_end > 0;
+  find_requests(c);
+  if (_tracer != nullptr && !had_requests && c.requests_end > 0) c.received = std::chrono::steady_clock::now();
+  if (c.requests_end > 0 && !c.queued)
+  {
+    c.queued = true;
+    _ready.push_back(connection);
+  }
+  if (c.done_sending && !c.queued) close_when_done(connection);
+}
+
+void daemon_server::find_requests(daemon_connection& c)
+{
+  if (c.input_protocol == daemon_connection::protocol::unknown && !c.input.empty())
+  {
+    if (c.input[0] == DAEMON_BLOCKS_MARKER)
+    {
+      c.input_protocol = daemon_connection::protocol::blocks;
+      c.input.erase(c.input.begin());
+    }
+    else if (c.input[0] == DAEMON_EXAMPLES_MARKER)
+    {
+      // Without blocks the end of a request is only found by parsing it.
+      _all.trace_message << "daemon connection dropped: --daemon_event_loop reads binary examples only in cache blocks"
+                         << std::endl;
+      c.input.clear();
+      c.done_sending = true;
+      return;
+    }
+    else
+    {
+      c.input_protocol = daemon_connection::protocol::text;
+    }
+  }
+
+  if (c.input_protocol == daemon_connection::protocol::text)
+  {
+    // The last line of a client is complete once it closes its side, a last multi line example as well.
+    if (c.done_sending && c.requests_end < c.input.size())
+    {
+      if (c.input.back() != '\n') c.input.push_back('\n');
+      if (_multiline_text) c.input.push_back('\n');
+    }
+
+    const char* data = c.input.data();
+    while (c.scanned < c.input.size())
+    {
+      const auto* newline = static_cast<const char*>(memchr(data + c.scanned, '\n', c.input.size() - c.scanned));
+      if (newline == nullptr)
+      {
+        c.scanned = c.input.size();
+        break;
+      }
+      const size_t end = newline - data;
+      const bool empty_line = end == c.line_start || (end == c.line_start + 1 && data[c.line_start] == '\r');
+      if (!_multiline_text || empty_line) c.requests_end = end + 1;
+      c.line_start = c.scanned = end + 1;
+    }
+  }
+  else if (c.input_protocol == daemon_connection::protocol::blocks)
+  {
+    while (c.input.size() - c.requests_end >= sizeof(uint32_t) + sizeof(uint64_t))
+    {
+      const size_t available = c.input.size() - c.requests_end;
+      const char* header = c.input.data() + c.requests_end;
+      const auto magic = read_uint32(header);
+      uint64_t size = 0;  // of the block or index, 0 if it cannot be read
+      if (magic == CACHE_BLOCK_MAGIC || magic == CACHE_DEDUP_BLOCK_MAGIC)
+      {
+        if (available < CACHE_BLOCK_HEADER_SIZE) break;
+        const auto payload_size = read_uint64(header + 8);
+        if (payload_size <= max_daemon_block_payload) size = CACHE_BLOCK_HEADER_SIZE + payload_size;
+      }
+      else if (magic == CACHE_INDEX_MAGIC)
+      {
+        // Clients may finish their block writer, the index is skipped along with the blocks.
+        const auto num_blocks = read_uint64(header + sizeof(uint32_t));
+        if (num_blocks <= max_daemon_block_payload / CACHE_INDEX_ENTRY_SIZE)
+        {
+          size = sizeof(uint32_t) + sizeof(uint64_t) + num_blocks * CACHE_INDEX_ENTRY_SIZE + CACHE_TRAILER_SIZE;
+        }
+      }
+
+      if (size == 0)
+      {
+        _all.trace_message << "daemon connection dropped: corrupted cache block" << std::endl;
+        c.input.resize(c.requests_end);
+        c.done_sending = true;
+        break;
+      }
+      if (available < size) break;
+      c.requests_end += size;
+    }
+
+    if (c.done_sending && c.requests_end < c.input.size())
+    {
+      _all.trace_message << "daemon connection closed within a cache block, dropping "
+                         << c.input.size() - c.requests_end << " bytes" << std::endl;
+      c.input.resize(c.requests_end);
+    }
+  }
+}
+
+void daemon_server::start_request(std::shared_ptr<daemon_connection> connection)
+{
+  auto& parser = *_all.example_parser;
+  parser.input->close_files();
+  parser.input->reset_buffer();
+  parser.input->add_file(io::create_buffer_view(connection->input.data(), connection->requests_end));
+  parser.input->current = 0;
+  if (connection->input_protocol == daemon_connection::protocol::blocks)
+  {
+    parser.cache_format = 2;
+    parser.cache_examples_left_in_block = 0;
+    _current_reader = read_cached_features;
+  }
+  else
+  {
+    _current_reader = _text_reader;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _requests.push_back({_examples_parsed, connection});
+    if (_metrics != nullptr) _timed_requests.push_back({UINT64_MAX, std::chrono::steady_clock::now()});
+  }
+  drop_finished_requests();
+  _request_received = connection->received;
+  _current = std::move(connection);
+}
+
+void daemon_server::finish_request()
+{
+  _all.example_parser->input->close_files();
+  _all.example_parser->input->reset_buffer();
+  if (_metrics != nullptr)
+  {
+    // A request without examples, or whose examples were all finished already, is done.
+    std::lock_guard<std::mutex> lock(_lock);
+    _timed_requests.back().end_example = _examples_parsed;
+    time_finished_requests(_all.example_parser->finished_examples);
+  }
+
+  auto& c = *_current;
+  c.input.erase(c.input.begin(), c.input.begin() + c.requests_end);
+  c.scanned -= std::min(c.scanned, c.requests_end);
+  c.line_start -= std::min(c.line_start, c.requests_end);
+  c.requests_end = 0;
+  c.queued = false;
+  if (c.done_sending) close_when_done(_current);
+  _current.reset();
+}
+
+void daemon_server::close_when_done(const std::shared_ptr<daemon_connection>& connection)
+{
+  if (!connection->polling) return;
+  connection->polling = false;
+  connection->examples_end = _examples_parsed;
+  _poller->remove(connection->fd);
+  _closing.push_back(connection);
+}
+
+void daemon_server::close_finished_connections()
+{
+  const uint64_t finished = _all.example_parser->finished_examples;
+  auto done = [&](const std::shared_ptr<daemon_connection>& connection) {
+    if (finished < connection->examples_end || !connection->flush_output()) return false;
+    _connections.erase(connection->id);
+    return true;
+  };
+  _closing.erase(std::remove_if(_closing.begin(), _closing.end(), done), _closing.end());
+}
+
+void daemon_server::drop_finished_requests()
+{
+  const uint64_t finished = _all.example_parser->finished_examples;
+  std::lock_guard<std::mutex> lock(_lock);
+  while (_requests.size() > 1 && _requests[1].first_example <= finished) _requests.pop_front();
+}
+
+std::shared_ptr<daemon_connection> daemon_server::connection_of_finishing_example()
+{
+  drop_finished_requests();
+  const uint64_t finishing = _all.example_parser->finished_examples;
+  std::lock_guard<std::mutex> lock(_lock);
+  if (_requests.empty() || _requests.front().first_example > finishing) return nullptr;
+  return _requests.front().connection.lock();
+}
+
+void daemon_server::send_later(const std::shared_ptr<daemon_connection>& connection)
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  _unsent.push_back(connection);
+}
+
+uint16_t daemon_server::serve_metrics(uint16_t port)
+{
+  _metrics.reset(new daemon_metrics(_all, port));
+  return _metrics->port();
+}
+
+void daemon_server::trace_requests(const std::string& file, size_t capacity)
+{
+  _tracer.reset(new request_tracer(file, capacity));
+}
+
+void daemon_server::report_requests(std::ostream& out)
+{
+  if (_tracer == nullptr) return;
+  _tracer->report(out);
+  _tracer->write_trace();
+}
+
+void daemon_server::example_predicted()
+{
+  if (_tracer != nullptr) _tracer->predicted(_all.example_parser->finished_examples);
+}
+
+void daemon_server::example_finished()
+{
+  if (_tracer != nullptr) _tracer->written(_all.example_parser->finished_examples - 1);
+  if (_metrics == nullptr) return;
+  const uint64_t finished = _all.example_parser->finished_examples;
+  std::lock_guard<std::mutex> lock(_lock);
+  time_finished_requests(finished);
+}
+
+// Called with _lock held.
+void daemon_server::time_finished_requests(uint64_t finished)
+{
+  const auto now = std::chrono::steady_clock::now();
+  while (!_timed_requests.empty() && _timed_requests.front().end_example <= finished)
+  {
+    _metrics->request_finished(now - _timed_requests.front().started);
+    _timed_requests.pop_front();
+  }
+}
+
+int read_daemon_examples(vw* all, v_array<example*>& examples)
+{
+  return all->example_parser->daemon_server->read_examples(examples);
+}
+
+void daemon_print_result_by_ref(io::writer* f, float res, float weight, const v_array<char>& tag)
+{
+  auto* writer = dynamic_cast<daemon_prediction_writer*>(f);
+  if (writer != nullptr && writer->sends_binary()) { binary_print_result_by_ref(f, res, weight, tag); }
+  else
+  {
+    print_result_by_ref(f, res, weight, tag);
+  }
+}
+}  // namespace VW
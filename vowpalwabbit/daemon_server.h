@@ -0,0 +1,144 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Mutex cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <mutex>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <mutex>
+#endif
+
+#include "v_array.h"
+#include "io/io_adapter.h"
+
+struct vw;
+struct example;
+
+namespace VW
+{
+struct daemon_connection;
+class daemon_poller;
+class daemon_metrics;
+class request_tracer;
+
+// Serves every daemon mode connection from the parse thread with one event loop, see --daemon_event_loop. Bytes are
+// read from whichever connections have them and a connection's input is parsed once it holds complete requests:
+// lines of text or JSON, where the examples of multi line reductions end with an empty line, or format 2 cache
+// blocks when the connection starts with DAEMON_BLOCKS_MARKER. Requests of different connections are never
+// interleaved, and the predictions of a request are sent back to the connection it came from without blocking the
+// learner. With --dispatch_batch_size, examples are published to the learner once a batch is full, or once no request
+// is waiting and the batch has waited --dispatch_latency, so batches grow under load without delaying idle clients.
+class daemon_server
+{
+public:
+  // Accepts connections on listen_socket, which must be listening already. Text and JSON requests are parsed with the
+  // reader set on all.example_parser, json tells whether it reads JSON lines.
+  daemon_server(vw& all, int listen_socket, bool json);
+  ~daemon_server();
+
+  daemon_server(const daemon_server&) = delete;
+  daemon_server& operator=(const daemon_server&) = delete;
+
+  // Parses the next examples of a complete request, waiting for one to arrive. Returns 0 once SIGTERM was received.
+  int read_examples(v_array<example*>& examples);
+
+  // Writer for final_prediction_sink, it sends what is written to the connection of the example being finished. This
+  // relies on predictions being written before an example is finished and on examples being finished in the order
+  // they were parsed.
+  std::unique_ptr<io::writer> create_prediction_writer();
+
+  // Returns the connection of the example being finished, nullptr if it has been closed. Called by the learner.
+  std::shared_ptr<daemon_connection> connection_of_finishing_example();
+
+  // Queues predictions which could not be sent right away, the event loop sends them once the socket is writable.
+  void send_later(const std::shared_ptr<daemon_connection>& connection);
+
+  // Serves the metrics of the daemon on port until the input ends, see --metrics_port. Returns the port bound.
+  uint16_t serve_metrics(uint16_t port);
+
+  // Traces the examples of the requests until the input ends, see --trace_requests.
+  void trace_requests(const std::string& file, size_t capacity);
+
+  // Prints the quantiles of the phases of the requests traced and writes their traces. Called once the learner is
+  // done.
+  void report_requests(std::ostream& out);
+
+  // Traces when the prediction of the example being finished is written. Called by the learner.
+  void example_predicted();
+
+  // Counts the requests whose last example was finished, for their latency. Called by the learner after finishing an
+  // example.
+  void example_finished();
+
+private:
+  struct request
+  {
+    uint64_t first_example;
+    std::weak_ptr<daemon_connection> connection;
+  };
+
+  struct timed_request
+  {
+    uint64_t end_example;  // number of examples parsed up to its end, UINT64_MAX while it is parsed
+    std::chrono::steady_clock::time_point started;
+  };
+
+  void publish_late_batch(int& timeout_ms);
+  void wait_for_requests(int timeout_ms);
+  void accept_connections();
+  void receive(const std::shared_ptr<daemon_connection>& connection);
+  void find_requests(daemon_connection& connection);
+  void start_request(std::shared_ptr<daemon_connection> connection);
+  void finish_request();
+  void close_when_done(const std::shared_ptr<daemon_connection>& connection);
+  void close_finished_connections();
+  void drop_finished_requests();
+  void time_finished_requests(uint64_t finished);
+
+  vw& _all;
+  int _listen_socket;
+  std::unique_ptr<daemon_poller> _poller;
+  int (*_text_reader)(vw*, v_array<example*>&);
+  bool _multiline_text;  // text requests end with an empty line instead of with every line
+
+  uint64_t _next_id = 1;
+  std::unordered_map<uint64_t, std::shared_ptr<daemon_connection>> _connections;
+  std::deque<std::shared_ptr<daemon_connection>> _ready;      // with complete requests, in arrival order
+  std::vector<std::shared_ptr<daemon_connection>> _closing;  // done sending, waiting for their predictions
+  std::shared_ptr<daemon_connection> _current;               // whose requests are being parsed
+  int (*_current_reader)(vw*, v_array<example*>&) = nullptr;
+  uint64_t _examples_parsed = 0;
+  std::chrono::steady_clock::time_point _batch_started;  // when the first example of the dispatch batch was parsed
+  std::vector<char> _receive_buffer;
+  std::unique_ptr<daemon_metrics> _metrics;
+  std::unique_ptr<request_tracer> _tracer;
+  std::chrono::steady_clock::time_point _request_received;  // of the requests being parsed, with --trace_requests
+
+  // Shared with the learner thread.
+  std::mutex _lock;
+  std::deque<request> _requests;  // in parse order, finished ones are dropped
+  std::vector<std::weak_ptr<daemon_connection>> _unsent;
+  std::deque<timed_request> _timed_requests;  // with --metrics_port, the requests whose examples are not all finished
+};
+
+int read_daemon_examples(vw* all, v_array<example*>& examples);
+
+// Prints binary global_predictions to connections which send cache blocks and text to all others.
+void daemon_print_result_by_ref(io::writer* f, float res, float weight, const v_array<char>& tag);
+}  // namespace VW
@@ -0,0 +1,77 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "dense_batch.h"
+
+#include "gd.h"
+#include "global_data.h"
+#include "vw_exception.h"
+
+namespace
+{
+inline void gather_flat(VW::flat_batch& batch, float x, uint64_t index)
+{
+  batch.indices.push_back(index);
+  batch.values.push_back(x);
+}
+
+class cpu_dense_backend : public VW::dense_backend
+{
+public:
+  explicit cpu_dense_backend(dense_parameters& weights) : _weights(weights) {}
+
+  void predict(const VW::flat_batch& batch, float scale, float* predictions) override
+  {
+    const uint64_t mask = _weights.mask();
+    const weight* w = _weights.first();
+    for (size_t e = 0; e < batch.size(); e++)
+    {
+      float dot = 0.f;
+      for (size_t f = batch.offsets[e]; f < batch.offsets[e + 1]; f++)
+        dot += batch.values[f] * w[batch.indices[f] & mask];
+      predictions[e] = (batch.initial[e] + dot) * scale;
+    }
+  }
+
+  void update(const VW::flat_batch& batch, const float* updates) override
+  {
+    const uint64_t mask = _weights.mask();
+    weight* w = _weights.first();
+    for (size_t e = 0; e < batch.size(); e++)
+    {
+      if (updates[e] == 0.f) continue;
+      for (size_t f = batch.offsets[e]; f < batch.offsets[e + 1]; f++)
+        w[batch.indices[f] & mask] += updates[e] * batch.values[f];
+    }
+  }
+
+private:
+  dense_parameters& _weights;
+};
+}  // namespace
+
+namespace VW
+{
+void flat_batch::clear()
+{
+  indices.clear();
+  values.clear();
+  offsets.resize(1);
+  initial.clear();
+}
+
+void flat_batch::add(vw& all, example& ec)
+{
+  GD::foreach_feature<flat_batch, uint64_t, gather_flat>(all, ec, *this);
+  offsets.push_back(indices.size());
+  initial.push_back(ec.l.simple.initial);
+}
+
+std::unique_ptr<dense_backend> make_dense_backend(vw& all, const std::string& name)
+{
+  if (all.weights.sparse) THROW("batched dense prediction needs dense weights");
+  if (name == "cpu") return std::unique_ptr<dense_backend>(new cpu_dense_backend(all.weights.dense_weights));
+  THROW("unknown dense backend " << name << ", this build has: cpu");
+}
+}  // namespace VW
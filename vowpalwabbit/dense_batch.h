@@ -0,0 +1,53 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "example.h"
+
+struct vw;
+
+namespace VW
+{
+// The features and interactions of a batch of examples as flat arrays of weight indices and values, those of example e
+// being [offsets[e], offsets[e + 1]). The indices are before the mask of the weights, at the ft_offset of the examples.
+struct flat_batch
+{
+  std::vector<uint64_t> indices;
+  std::vector<float> values;
+  std::vector<size_t> offsets = {0};
+  std::vector<float> initial;  // the prediction of each example before its features, see label_data::initial
+
+  size_t size() const { return initial.size(); }
+  void clear();
+  // Appends the features of ec along with the interactions of all.
+  void add(vw& all, example& ec);
+};
+
+// Predicts and updates the linear model of flat batches from dense weights. It is where backends which keep the
+// weights on a device plug in: such a backend copies the weights of the model when made, and back to it on pull.
+class dense_backend
+{
+public:
+  virtual ~dense_backend() = default;
+
+  // Sets predictions[e] to initial[e] plus the dot product of example e with the weights, times scale.
+  virtual void predict(const flat_batch& batch, float scale, float* predictions) = 0;
+  // Adds updates[e] times the value of each feature of example e to its weight.
+  virtual void update(const flat_batch& batch, const float* updates) = 0;
+  // Writes the weights of the backend to the model, if it keeps them elsewhere.
+  virtual void pull() {}
+};
+
+// The backend called name. "cpu" computes from the weights of the model in place, and is what other backends fall back
+// to where they are not built.
+// \throw VW::vw_exception if name is not a backend or the weights of all are sparse
+std::unique_ptr<dense_backend> make_dense_backend(vw& all, const std::string& name);
+}  // namespace VW
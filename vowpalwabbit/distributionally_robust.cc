@@ -56,6 +56,7 @@ ChiSquared::Duals ChiSquared::recompute_duals()
   if (n <= 0)
   {
     duals = {true, 0, 0, 0, 0};
+    lower_bound = rmin;
 
     return duals;
   }
@@ -150,13 +151,18 @@ ChiSquared::Duals ChiSquared::recompute_duals()
     }
   }
 
-  if (candidates.empty()) { duals = {true, 0, 0, 0, n}; }
+  if (candidates.empty())
+  {
+    duals = {true, 0, 0, 0, n};
+    lower_bound = rmin;
+  }
   else
   {
     auto it = std::min_element(candidates.begin(), candidates.end(),
         [](const ScoredDual& x, const ScoredDual& y) { return std::get<0>(x) < std::get<0>(y); });
 
     duals = std::get<1>(*it);
+    lower_bound = std::get<0>(*it);
   }
 
   return duals;
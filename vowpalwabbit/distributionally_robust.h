@@ -47,6 +47,7 @@ private:
 
   bool duals_stale;
   Duals duals;
+  double lower_bound;  // of the duals
 
 public:
   // alpha: confidence level
@@ -67,6 +68,7 @@ public:
       , sumwsqrsq(0)
       , delta(chisq_onedof_isf(alpha))
       , duals_stale(true)
+      , lower_bound(_rmin)
   {
   }
 
@@ -110,6 +112,14 @@ public:
     return duals.qfunc(w, r);
   }
 
+  // The lower confidence bound on the average reward of the updates, at level alpha.
+  double lb()
+  {
+    if (duals_stale) { recompute_duals(); }
+
+    return lower_bound;
+  }
+
   Duals recompute_duals();
   static double chisq_onedof_isf(double alpha);
   const double& effn() { return n; }
@@ -60,6 +60,9 @@ example::example(example&& other) noexcept
     , total_sum_feat_sq(other.total_sum_feat_sq)
     , confidence(other.confidence)
     , passthrough(other.passthrough)
+    , expanded_features(std::move(other.expanded_features))
+    , expansion_key(other.expansion_key)
+    , shared_terms(other.shared_terms)
     , test_only(other.test_only)
     , end_pass(other.end_pass)
     , sorted(other.sorted)
@@ -78,6 +81,8 @@ example::example(example&& other) noexcept
   other.total_sum_feat_sq = 0.f;
   other.confidence = 0.f;
   other.passthrough = nullptr;
+  other.expansion_key = 0;
+  other.shared_terms = nullptr;
   other.test_only = false;
   other.end_pass = false;
   other.sorted = false;
@@ -100,6 +105,9 @@ example& example::operator=(example&& other) noexcept
   total_sum_feat_sq = other.total_sum_feat_sq;
   confidence = other.confidence;
   passthrough = other.passthrough;
+  expanded_features = std::move(other.expanded_features);
+  expansion_key = other.expansion_key;
+  shared_terms = other.shared_terms;
   test_only = other.test_only;
   end_pass = other.end_pass;
   sorted = other.sorted;
@@ -124,6 +132,8 @@ example& example::operator=(example&& other) noexcept
   other.total_sum_feat_sq = 0.f;
   other.confidence = 0.f;
   other.passthrough = nullptr;
+  other.expansion_key = 0;
+  other.shared_terms = nullptr;
   other.test_only = false;
   other.end_pass = false;
   other.sorted = false;
@@ -198,10 +208,14 @@ void copy_example_metadata(bool /* audit */, example* dst, example* src)
 
   dst->partial_prediction = src->partial_prediction;
   if (src->passthrough == nullptr)
+  {
+    delete dst->passthrough;
     dst->passthrough = nullptr;
+  }
   else
   {
-    dst->passthrough = new features;
+    // A destination copied to before keeps the storage of its passthrough features.
+    if (dst->passthrough == nullptr) dst->passthrough = new features;
     dst->passthrough->deep_copy_from(*src->passthrough);
   }
   dst->loss = src->loss;
@@ -217,7 +231,9 @@ void copy_example_data(bool audit, example* dst, example* src)
   // std::cerr << "copy_example_data dst = " << dst << std::endl;
   copy_example_metadata(audit, dst, src);
 
-  // copy feature data
+  // copy feature data, the namespaces of an earlier copy which src does not have are emptied so that interactions,
+  // which look namespaces up directly, do not find their features
+  for (namespace_index c : dst->indices) dst->feature_space[c].clear();
   copy_array(dst->indices, src->indices);
   for (namespace_index c : src->indices) dst->feature_space[c].deep_copy_from(src->feature_space[c]);
   // copy_array(dst->atomics[i], src->atomics[i]);
@@ -286,7 +302,7 @@ void return_features(feature* f) { free_it(f); }
 
 struct full_features_and_source
 {
-  features fs;
+  features& fs;
   uint32_t stride_shift;
   uint64_t mask;
 };
@@ -296,9 +312,9 @@ void vec_ffs_store(full_features_and_source& p, float fx, uint64_t fi)
   p.fs.push_back(fx, (uint64_t)(fi >> p.stride_shift) & p.mask);
 }
 
-flat_example* flatten_example(vw& all, example* ec)
+// Fills fec, whose features are pushed to after those it already has.
+void fill_flat_example(vw& all, example* ec, flat_example& fec)
 {
-  flat_example& fec = calloc_or_throw<flat_example>();
   fec.l = ec->l;
   fec.l.simple.weight = ec->weight;
 
@@ -313,16 +329,20 @@ flat_example* flatten_example(vw& all, example* ec)
   fec.ft_offset = ec->ft_offset;
   fec.num_features = ec->num_features;
 
-  full_features_and_source ffs;
-  ffs.stride_shift = all.weights.stride_shift();
+  uint64_t mask;
   if (all.weights.not_null())  // TODO:temporary fix. all.weights is not initialized at this point in some cases.
-    ffs.mask = (uint64_t)all.weights.mask() >> all.weights.stride_shift();
+    mask = (uint64_t)all.weights.mask() >> all.weights.stride_shift();
   else
-    ffs.mask = (uint64_t)LONG_MAX >> all.weights.stride_shift();
+    mask = (uint64_t)LONG_MAX >> all.weights.stride_shift();
+  full_features_and_source ffs{fec.fs, all.weights.stride_shift(), mask};
   GD::foreach_feature<full_features_and_source, uint64_t, vec_ffs_store>(all, *ec, ffs);
+}
 
-  std::swap(fec.fs, ffs.fs);
-
+flat_example* flatten_example(vw& all, example* ec)
+{
+  flat_example& fec = calloc_or_throw<flat_example>();
+  new (&fec.fs) features();
+  fill_flat_example(all, ec, fec);
   return &fec;
 }
 
@@ -334,6 +354,15 @@ flat_example* flatten_sort_example(vw& all, example* ec)
   return fec;
 }
 
+void flatten_sort_example(vw& all, example* ec, flat_example& fec)
+{
+  if (fec.tag_len > 0) free(fec.tag);
+  fec.fs.clear();
+  fill_flat_example(all, ec, fec);
+  fec.fs.sort(all.parse_mask);
+  fec.total_sum_feat_sq = collision_cleanup(fec.fs);
+}
+
 void free_flatten_example(flat_example* fec)
 {
   // note: The label memory should be freed by by freeing the original example.
@@ -61,6 +61,18 @@ struct polyprediction
   VW::continuous_actions::probability_density_function_value pdf_value;  // probability density value for a given action
 };
 
+struct example;
+
+// The features which shared_feature_merger appends to every action of a multi_ex with --factor_shared_features. Their
+// linear terms are the same for every action, so gd predicts them once and keeps them here until it learns again.
+struct shared_linear_terms
+{
+  example* shared = nullptr;  // whose features, other than the constant, are the last ones of their namespace
+  uint64_t ft_offset = 0;     // of the prediction
+  float prediction = 0.f;
+  bool predicted = false;
+};
+
 VW_WARNING_STATE_PUSH
 VW_WARNING_DISABLE_DEPRECATED_USAGE
 struct example : public example_predict  // core example datatype.
@@ -98,6 +110,14 @@ struct example : public example_predict  // core example datatype.
   features* passthrough =
       nullptr;  // if a higher-up reduction wants access to internal state of lower-down reductions, they go here
 
+  // The features and interactions gathered by gd with --fused_learn, with indices relative to ft_offset so that each
+  // model a reduction learns from the example uses them. Valid while expansion_key identifies the features.
+  features expanded_features;
+  uint64_t expansion_key = 0;
+
+  // Set on actions while the features of the shared example are appended to them, see shared_linear_terms.
+  shared_linear_terms* shared_terms = nullptr;
+
   bool test_only = false;
   bool end_pass = false;  // special example indicating end of pass.
   bool sorted = false;    // Are the features sorted or not?
@@ -129,6 +149,8 @@ struct flat_example
 
 flat_example* flatten_example(vw& all, example* ec);
 flat_example* flatten_sort_example(vw& all, example* ec);
+// Flattens and sorts ec into fec, a flat example of an earlier call, reusing the storage of its features.
+void flatten_sort_example(vw& all, example* ec, flat_example& fec);
 void free_flatten_example(flat_example* fec);
 
 inline int example_is_newline(example const& ec)
@@ -4,12 +4,44 @@
 
 #include "example_predict.h"
 
-example_predict::iterator::iterator(features* feature_space, namespace_index* index)
+namespaced_features::namespaced_features() { _groups.fill(nullptr); }
+
+namespaced_features::namespaced_features(namespaced_features&& other) noexcept
+    : _groups(other._groups), _storage(std::move(other._storage))
+{
+  other._groups.fill(nullptr);
+  other._storage.clear();
+}
+
+namespaced_features& namespaced_features::operator=(namespaced_features&& other) noexcept
+{
+  _groups = other._groups;
+  _storage = std::move(other._storage);
+  other._groups.fill(nullptr);
+  other._storage.clear();
+  return *this;
+}
+
+const features& namespaced_features::operator[](namespace_index ns) const
+{
+  static const features empty_group;
+  const features* group = _groups[ns];
+  return group != nullptr ? *group : empty_group;
+}
+
+features& namespaced_features::allocate(namespace_index ns)
+{
+  _storage.emplace_back(new features());
+  _groups[ns] = _storage.back().get();
+  return *_groups[ns];
+}
+
+example_predict::iterator::iterator(namespaced_features* feature_space, namespace_index* index)
     : _feature_space(feature_space), _index(index)
 {
 }
 
-features& example_predict::iterator::operator*() { return _feature_space[*_index]; }
+features& example_predict::iterator::operator*() { return (*_feature_space)[*_index]; }
 
 example_predict::iterator& example_predict::iterator::operator++()
 {
@@ -62,8 +94,8 @@ example_predict& example_predict::operator=(example_predict&& other) noexcept
   return *this;
 }
 
-example_predict::iterator example_predict::begin() { return {feature_space.data(), indices.begin()}; }
-example_predict::iterator example_predict::end() { return {feature_space.data(), indices.end()}; }
+example_predict::iterator example_predict::begin() { return {&feature_space, indices.begin()}; }
+example_predict::iterator example_predict::end() { return {&feature_space, indices.end()}; }
 
 VW_WARNING_STATE_PUSH
 VW_WARNING_DISABLE_DEPRECATED_USAGE
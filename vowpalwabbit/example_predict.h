@@ -13,16 +13,71 @@ typedef unsigned char namespace_index;
 
 #include <vector>
 #include <array>
+#include <memory>
+
+// The feature groups of an example by namespace. A group is allocated the first time its namespace is used, so an
+// example carries a group for each namespace it has seen rather than one for every namespace. A group keeps its
+// address and its storage for as long as the example lives, through the reuse of the example.
+class namespaced_features
+{
+public:
+  // Visits the groups allocated so far in the order of their namespaces, the others are empty.
+  class iterator
+  {
+    features* const* _group;
+    features* const* _end;
+
+    void skip_unallocated()
+    {
+      while (_group != _end && *_group == nullptr) ++_group;
+    }
+
+  public:
+    iterator(features* const* group, features* const* end) : _group(group), _end(end) { skip_unallocated(); }
+    features& operator*() const { return **_group; }
+    iterator& operator++()
+    {
+      ++_group;
+      skip_unallocated();
+      return *this;
+    }
+    bool operator==(const iterator& rhs) const { return _group == rhs._group; }
+    bool operator!=(const iterator& rhs) const { return _group != rhs._group; }
+  };
+
+  namespaced_features();
+  namespaced_features(const namespaced_features&) = delete;
+  namespaced_features& operator=(const namespaced_features&) = delete;
+  namespaced_features(namespaced_features&& other) noexcept;
+  namespaced_features& operator=(namespaced_features&& other) noexcept;
+
+  features& operator[](namespace_index ns)
+  {
+    features* group = _groups[ns];
+    return group != nullptr ? *group : allocate(ns);
+  }
+  // An empty group for a namespace not used yet.
+  const features& operator[](namespace_index ns) const;
+
+  iterator begin() const { return {_groups.data(), _groups.data() + NUM_NAMESPACES}; }
+  iterator end() const { return {_groups.data() + NUM_NAMESPACES, _groups.data() + NUM_NAMESPACES}; }
+
+private:
+  features& allocate(namespace_index ns);
+
+  std::array<features*, NUM_NAMESPACES> _groups;
+  std::vector<std::unique_ptr<features>> _storage;
+};
 
 struct example_predict
 {
   class iterator
   {
-    features* _feature_space;
+    namespaced_features* _feature_space;
     v_array<namespace_index>::iterator _index;
 
   public:
-    iterator(features* feature_space, namespace_index* index);
+    iterator(namespaced_features* feature_space, namespace_index* index);
     features& operator*();
     iterator& operator++();
     namespace_index index();
@@ -43,8 +98,8 @@ struct example_predict
   iterator end();
 
   v_array<namespace_index> indices;
-  std::array<features, NUM_NAMESPACES> feature_space;  // Groups of feature values.
-  uint64_t ft_offset;                                  // An offset for all feature values.
+  namespaced_features feature_space;  // Groups of feature values.
+  uint64_t ft_offset;                 // An offset for all feature values.
 
   // Interactions are specified by this vector of vectors of unsigned characters, where each vector is an interaction
   // and each char is a namespace.
@@ -7,34 +7,97 @@
 #include "vw.h"
 #include "parse_args.h"
 #include "rand48.h"
+#include "cache.h"
+#include "io/io_adapter.h"
 #include <memory>
+#include <vector>
 
 namespace ExpReplay
 {
+// What a buffered example keeps of its example, ahead of its label and features encoded as cached examples are.
+struct replayed_metadata
+{
+  size_t example_counter;
+  uint64_t ft_offset;
+  size_t num_features;
+  float total_sum_feat_sq;
+  float weight;
+  bool test_only;
+  bool sorted;
+};
+
 template <label_parser& lp>
 struct expreplay
 {
   vw* all;
   std::shared_ptr<rand_state> _random_state;
-  size_t N;             // how big is the buffer?
-  example* buf;         // the deep copies of examples (N of them)
-  bool* filled;         // which of buf[] is filled
+  size_t N;  // how big is the buffer?
+  // The buffered examples (N of them) encoded as cached examples, empty until filled, so that each costs the bytes of its
+  // features rather than a whole example. They are decoded into replayed to be learnt from.
+  std::vector<std::vector<char>> buf;
+  example* replayed;
+  std::shared_ptr<std::vector<char>> encoded;  // written by encoder
+  io_buf encoder;
+  io_buf decoder;
   size_t replay_count;  // each time er.learn() is called, how many times do we call base.learn()? default=1 (in which
                         // case we're just permuting)
   VW::LEARNER::single_learner* base;
 
   ~expreplay()
   {
-    for (size_t n = 0; n < N; n++)
+    if (replayed != nullptr)
     {
-      lp.delete_label(&buf[n].l);
-      VW::dealloc_example(NULL, buf[n], NULL);  // TODO: need to free label
+      lp.delete_label(&replayed->l);
+      VW::dealloc_example(nullptr, *replayed, nullptr);
+      free(replayed);
     }
-    free(buf);
-    free(filled);
   }
 };
 
+template <label_parser& lp>
+void store(expreplay<lp>& er, size_t n, example& ec)
+{
+  const replayed_metadata metadata = {
+      ec.example_counter, ec.ft_offset, ec.num_features, ec.total_sum_feat_sq, ec.weight, ec.test_only, ec.sorted};
+  er.encoded->clear();
+  er.encoder.bin_write_fixed(reinterpret_cast<const char*>(&metadata), sizeof(metadata));
+  lp.cache_label(&ec.l, er.encoder);
+  cache_features(er.encoder, &ec, static_cast<uint64_t>(-1));  // the indices are kept as they are
+  er.encoder.flush();
+
+  // An entry is reallocated when it would otherwise keep much more than it holds.
+  auto& entry = er.buf[n];
+  if (entry.capacity() > 2 * er.encoded->size()) std::vector<char>().swap(entry);
+  entry.assign(er.encoded->begin(), er.encoded->end());
+}
+
+template <label_parser& lp>
+example& replay(expreplay<lp>& er, size_t n)
+{
+  example& ec = *er.replayed;
+  for (namespace_index ns : ec.indices) ec.feature_space[ns].clear();
+  ec.indices.clear();
+
+  const auto& entry = er.buf[n];
+  er.decoder.close_files();
+  er.decoder.add_file(VW::io::create_buffer_view(entry.data(), entry.size()));
+  er.decoder.current = 0;
+  er.decoder.reset_buffer();
+  replayed_metadata metadata;
+  er.decoder.bin_read_fixed(reinterpret_cast<char*>(&metadata), sizeof(metadata), "");
+  if (VW::read_cached_example(lp, er.all->sd, er.decoder, &ec, er.all->trace_message) == 0)
+    THROW("corrupt experience replay entry");
+
+  ec.example_counter = metadata.example_counter;
+  ec.ft_offset = metadata.ft_offset;
+  ec.num_features = metadata.num_features;
+  ec.total_sum_feat_sq = metadata.total_sum_feat_sq;
+  ec.weight = metadata.weight;
+  ec.test_only = metadata.test_only;
+  ec.sorted = metadata.sorted;
+  return ec;
+}
+
 template <bool is_learn, label_parser& lp>
 void predict_or_learn(expreplay<lp>& er, VW::LEARNER::single_learner& base, example& ec)
 {  // regardless of what happens, we must predict
@@ -46,18 +109,13 @@ void predict_or_learn(expreplay<lp>& er, VW::LEARNER::single_learner& base, exam
   for (size_t replay = 1; replay < er.replay_count; replay++)
   {
     size_t n = (size_t)(er._random_state->get_and_update_random() * (float)er.N);
-    if (er.filled[n]) base.learn(er.buf[n]);
+    if (!er.buf[n].empty()) base.learn(ExpReplay::replay(er, n));
   }
 
   size_t n = (size_t)(er._random_state->get_and_update_random() * (float)er.N);
-  if (er.filled[n]) base.learn(er.buf[n]);
-
-  er.filled[n] = true;
-  VW::copy_example_data(er.all->audit, &er.buf[n], &ec);  // don't copy the label
-  if (lp.copy_label)
-    lp.copy_label(&er.buf[n].l, &ec.l);
-  else
-    er.buf[n].l = ec.l;
+  if (!er.buf[n].empty()) base.learn(ExpReplay::replay(er, n));
+
+  store(er, n, ec);
 }
 
 template <label_parser& lp>
@@ -72,10 +130,10 @@ void end_pass(expreplay<lp>& er)
 {  // we need to go through and learn on everyone who remains
   // also need to clean up remaining examples
   for (size_t n = 0; n < er.N; n++)
-    if (er.filled[n])
+    if (!er.buf[n].empty())
     {  // TODO: if er.replay_count > 1 do we need to play these more?
-      er.base->learn(er.buf[n]);
-      er.filled[n] = false;
+      er.base->learn(replay(er, n));
+      er.buf[n].clear();
     }
 }
 
@@ -103,14 +161,15 @@ VW::LEARNER::base_learner* expreplay_setup(VW::config::options_i& options, vw& a
 
   er->all = &all;
   er->_random_state = all.get_random_state();
-  er->buf = VW::alloc_examples(er->N);
-  er->buf->interactions = &all.interactions;
+  er->buf.resize(er->N);
+  er->replayed = VW::alloc_examples(1);
+  er->replayed->interactions = &all.interactions;
   VW_WARNING_STATE_PUSH
   VW_WARNING_DISABLE_CPP_17_LANG_EXT
-  if VW_STD17_CONSTEXPR (er_level == 'c')
-    for (size_t n = 0; n < er->N; n++) er->buf[n].l.cs.costs = v_init<COST_SENSITIVE::wclass>();
+  if VW_STD17_CONSTEXPR (er_level == 'c') er->replayed->l.cs.costs = v_init<COST_SENSITIVE::wclass>();
   VW_WARNING_STATE_POP
-  er->filled = calloc_or_throw<bool>(er->N);
+  er->encoded = std::make_shared<std::vector<char>>();
+  er->encoder.add_file(VW::io::create_vector_writer(er->encoded));
 
   if (!all.logger.quiet)
     std::cerr << "experience replay level=" << er_level << ", buffer=" << er->N << ", replay count=" << er->replay_count
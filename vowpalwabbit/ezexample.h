@@ -17,6 +17,14 @@ public:
   vw_namespace(const char c) : namespace_letter(c) {}
 };
 
+// A feature of a namespace, hashed once by ezexample::feature so that it is added to any number of examples without
+// hashing its name again.
+struct ezfeature
+{
+  char ns;
+  fid index;
+};
+
 class ezexample
 {
 private:
@@ -322,6 +330,11 @@ public:
   inline fid addf(char ns, std::string fstr, float val) { return addf(ns, hash(ns, fstr), val); }
   inline fid addf(char ns, std::string fstr) { return addf(ns, hash(ns, fstr), 1.0); }
 
+  // the prehashed feature fstr of the namespace ns, for addf and operator()
+  inline ezfeature feature(char ns, std::string fstr) { return {ns, hash(ns, fstr)}; }
+  inline fid addf(const ezfeature& f, float val) { return addf(f.ns, f.index, val); }
+  inline fid addf(const ezfeature& f) { return addf(f.ns, f.index, 1.0); }
+
   inline ezexample& operator()(const vw_namespace& n)
   {
     addns(n.namespace_letter);
@@ -359,6 +372,17 @@ public:
     return *this;
   }
 
+  inline ezexample& operator()(const ezfeature& f)
+  {
+    addf(f, 1.0);
+    return *this;
+  }
+  inline ezexample& operator()(const ezfeature& f, float val)
+  {
+    addf(f, val);
+    return *this;
+  }
+
   inline ezexample& operator()(char ns, fid fint)
   {
     addf(ns, fint, 1.0);
@@ -0,0 +1,148 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "feature_cost.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gd.h"
+#include "reductions.h"
+
+using namespace VW::config;
+
+namespace
+{
+constexpr size_t NO_GROUP = std::numeric_limits<size_t>::max();
+
+// A namespace, or an interaction, and what its features cost.
+struct feature_cost_group
+{
+  std::string name;
+  uint64_t features = 0;
+  double magnitude = 0.;  // the sum of |w * x| of its features
+};
+
+size_t add_group(std::vector<feature_cost_group>& groups, const std::string& name);
+
+struct feature_cost
+{
+  feature_cost() { namespace_groups.fill(NO_GROUP); }
+
+  void start_namespace(namespace_index ns)
+  {
+    if (namespace_groups[ns] == NO_GROUP)
+      namespace_groups[ns] = add_group(groups, INTERACTIONS::namespace_name(ns));
+    group = namespace_groups[ns];
+  }
+
+  const std::vector<std::vector<namespace_index>>& start_interaction(const std::vector<namespace_index>& terms)
+  {
+    auto found = interaction_groups.find(terms);
+    if (found == interaction_groups.end())
+      found = interaction_groups.emplace(terms, add_group(groups, INTERACTIONS::interaction_name(terms))).first;
+    group = found->second;
+    interaction[0] = terms;
+    return interaction;
+  }
+
+  vw* all = nullptr;
+  uint64_t examples = 0;
+
+  std::vector<feature_cost_group> groups;
+  std::array<size_t, NUM_NAMESPACES> namespace_groups;
+  std::map<std::vector<namespace_index>, size_t> interaction_groups;
+  size_t group = 0;  // of the features being visited
+
+  std::vector<std::vector<namespace_index>> interaction{1};  // the one being visited
+};
+
+size_t add_group(std::vector<feature_cost_group>& groups, const std::string& name)
+{
+  groups.emplace_back();
+  groups.back().name = name;
+  return groups.size() - 1;
+}
+
+void count_feature(feature_cost& c, float x, uint64_t index)
+{
+  feature_cost_group& group = c.groups[c.group];
+  group.features++;
+  group.magnitude += std::fabs(x * c.all->weights[index]);
+}
+
+template <bool is_learn>
+void predict_or_learn(feature_cost& c, VW::LEARNER::single_learner& base, example& ec)
+{
+  c.examples++;
+  GD::foreach_feature_by_group<feature_cost, count_feature>(*c.all, ec, c);
+  if (is_learn)
+    base.learn(ec);
+  else
+    base.predict(ec);
+}
+
+void finish(feature_cost& c)
+{
+  if (c.examples == 0) return;
+  auto& out = c.all->trace_message;
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+
+  uint64_t features = 0;
+  double magnitude = 0.;
+  for (const auto& group : c.groups)
+  {
+    features += group.features;
+    magnitude += group.magnitude;
+  }
+  std::vector<const feature_cost_group*> by_cost;
+  for (const auto& group : c.groups) by_cost.push_back(&group);
+  std::stable_sort(by_cost.begin(), by_cost.end(),
+      [](const feature_cost_group* a, const feature_cost_group* b) { return a->features > b->features; });
+
+  out << "feature cost of the " << c.examples << " examples:" << std::endl;
+  out << std::left << std::setw(24) << "features of" << std::right << std::setw(14) << "features" << std::setw(12)
+      << "per example" << std::setw(8) << "work" << std::setw(10) << "|w*x|" << std::endl;
+  out << std::fixed;
+  for (const auto* group : by_cost)
+  {
+    out << std::left << std::setw(24) << group->name << std::right << std::setw(14) << group->features
+        << std::setw(12) << std::setprecision(1) << static_cast<double>(group->features) / c.examples << std::setw(7)
+        << std::setprecision(1) << (features > 0 ? 100. * group->features / features : 0.) << '%' << std::setw(9)
+        << (magnitude > 0. ? 100. * group->magnitude / magnitude : 0.) << '%' << std::endl;
+  }
+  out << std::left << std::setw(24) << "all" << std::right << std::setw(14) << features << std::setw(12)
+      << std::setprecision(1) << static_cast<double>(features) / c.examples << std::endl;
+
+  out.flags(flags);
+  out.precision(precision);
+}
+}  // namespace
+
+VW::LEARNER::base_learner* feature_cost_setup(options_i& options, vw& all)
+{
+  bool cost = false;
+  option_group_definition new_options("Feature Cost");
+  new_options.add(make_option("feature_cost", cost)
+                      .necessary()
+                      .help("Count the features of each namespace and interaction as they are learned from and "
+                            "predicted with, and report at the end the share of the work and of |w*x| of each"));
+
+  if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
+
+  auto c = scoped_calloc_or_throw<feature_cost>();
+  c->all = &all;
+
+  VW::LEARNER::learner<feature_cost, example>& ret = VW::LEARNER::init_learner(
+      c, as_singleline(setup_base(options, all)), predict_or_learn<true>, predict_or_learn<false>);
+  ret.set_finish(finish);
+  return VW::LEARNER::make_base(ret);
+}
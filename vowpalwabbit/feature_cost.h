@@ -0,0 +1,12 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "reductions_fwd.h"
+
+// --feature_cost counts the features gd is given for each namespace and each interaction, as foreach_feature and
+// generate_interactions make them, and reports at the end the share of the dot products each accounts for and the
+// share of |w * x| it contributes, so that expensive interactions of little weight can be pruned.
+VW::LEARNER::base_learner* feature_cost_setup(VW::config::options_i& options, vw& all);
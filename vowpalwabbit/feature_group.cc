@@ -6,6 +6,7 @@
 
 #include "v_array.h"
 
+#include <array>
 #include <vector>
 #include <algorithm>
 #include <utility>
@@ -14,7 +15,7 @@ struct feature_slice  // a helper struct for functions using the set {v,i,space_
 {
   feature_value x;
   feature_index weight_index;
-  audit_strings space_name;
+  audit_strings_ptr space_name;
 };
 
 features::features()
@@ -103,6 +104,101 @@ void features::push_back(feature_value v, feature_index i)
   sum_feat_sq += v * v;
 }
 
+namespace
+{
+template <typename T>
+void reserve_at_least(v_array<T>& array, size_t size)
+{
+  const size_t capacity = static_cast<size_t>(array.end_array - array.begin());
+  if (capacity < size) array.resize(std::max(size, 2 * capacity));
+}
+}  // namespace
+
+void features::reserve(size_t count)
+{
+  reserve_at_least(values, values.size() + count);
+  reserve_at_least(indicies, indicies.size() + count);
+}
+
+void features::concat(const features& other)
+{
+  if (other.values.empty()) { return; }
+  push_many(values, other.values.begin(), other.values.size());
+  push_many(indicies, other.indicies.begin(), other.indicies.size());
+  if (!other.space_names.empty())
+    space_names.insert(space_names.end(), other.space_names.begin(), other.space_names.end());
+  sum_feat_sq += other.sum_feat_sq;
+}
+
+namespace
+{
+// Below this many features the passes of the radix sort cost more than comparison sorting does.
+constexpr size_t RADIX_SORT_MIN_SIZE = 512;
+
+// The order of features::sort, by index and then by value.
+template <typename T>
+bool feature_less(const T& first, const T& second)
+{
+  return (first.weight_index < second.weight_index) ||
+      ((first.weight_index == second.weight_index) && (first.x < second.x));
+}
+
+// A least significant digit first radix sort on the indices, a byte per pass. The histograms of all bytes are counted
+// in one read of the slice, and bytes which are the same for every feature, such as those above the bits of the
+// model, take no pass. The passes are stable, so the features of an index only need sorting by value afterwards.
+template <typename T>
+void radix_sort(std::vector<T>& slice)
+{
+  constexpr size_t BYTES = sizeof(uint64_t);
+  const size_t n = slice.size();
+
+  uint64_t all_bits = 0;
+  for (const T& f : slice) all_bits |= f.weight_index;
+  size_t bytes = 0;
+  while (bytes < BYTES && (all_bits >> (8 * bytes)) != 0) bytes++;
+
+  std::vector<std::array<size_t, 256>> counts(bytes);
+  for (auto& count : counts) count.fill(0);
+  for (const T& f : slice)
+    for (size_t b = 0; b < bytes; b++) counts[b][(f.weight_index >> (8 * b)) & 0xff]++;
+
+  std::vector<T> scratch(n);
+  for (size_t b = 0; b < bytes; b++)
+  {
+    auto& count = counts[b];
+    const unsigned shift = static_cast<unsigned>(8 * b);
+    if (count[(slice[0].weight_index >> shift) & 0xff] == n) continue;
+
+    size_t offset = 0;
+    for (size_t& c : count)
+    {
+      const size_t size = c;
+      c = offset;
+      offset += size;
+    }
+    for (T& f : slice) scratch[count[(f.weight_index >> shift) & 0xff]++] = std::move(f);
+    slice.swap(scratch);
+  }
+
+  for (size_t begin = 0; begin < n;)
+  {
+    size_t end = begin + 1;
+    while (end < n && slice[end].weight_index == slice[begin].weight_index) end++;
+    if (end - begin > 1) std::sort(slice.begin() + begin, slice.begin() + end, feature_less<T>);
+    begin = end;
+  }
+}
+
+template <typename T>
+void sort_slice(std::vector<T>& slice)
+{
+  if (slice.size() < RADIX_SORT_MIN_SIZE)
+    std::sort(slice.begin(), slice.end(), feature_less<T>);
+  else
+    radix_sort(slice);
+}
+}  // namespace
+
 bool features::sort(uint64_t parse_mask)
 {
   if (indicies.empty()) { return false; }
@@ -112,18 +208,15 @@ bool features::sort(uint64_t parse_mask)
     std::vector<feature_slice> slice;
     slice.reserve(indicies.size());
     for (size_t i = 0; i < indicies.size(); i++)
-    { slice.push_back({values[i], indicies[i] & parse_mask, *space_names[i]}); }
-    // The comparator should return true if the first element is less than the second.
-    std::sort(slice.begin(), slice.end(), [](const feature_slice& first, const feature_slice& second) {
-      return (first.weight_index < second.weight_index) ||
-          ((first.weight_index == second.weight_index) && (first.x < second.x));
-    });
+    { slice.push_back({values[i], indicies[i] & parse_mask, space_names[i]}); }
+    sort_slice(slice);
 
     for (size_t i = 0; i < slice.size(); i++)
     {
       values[i] = slice[i].x;
       indicies[i] = slice[i].weight_index;
-      *space_names[i] = slice[i].space_name;
+      // The strings may be shared with other features, the pointers are moved instead.
+      space_names[i] = std::move(slice[i].space_name);
     }
   }
   else
@@ -132,11 +225,7 @@ bool features::sort(uint64_t parse_mask)
     slice.reserve(indicies.size());
 
     for (size_t i = 0; i < indicies.size(); i++) { slice.emplace_back(values[i], indicies[i] & parse_mask); }
-    // The comparator should return true if the first element is less than the second.
-    std::sort(slice.begin(), slice.end(), [](const feature& first, const feature& second) {
-      return (first.weight_index < second.weight_index) ||
-          ((first.weight_index == second.weight_index) && (first.x < second.x));
-    });
+    sort_slice(slice);
     for (size_t i = 0; i < slice.size(); i++)
     {
       values[i] = slice[i].x;
@@ -79,6 +79,9 @@ public:
 
   inline features_value_iterator& operator*() { return *this; }
 
+  /// \return the number of features from rhs to this
+  inline std::ptrdiff_t operator-(const features_value_iterator& rhs) const { return _begin - rhs._begin; }
+
   bool operator==(const features_value_iterator& rhs) { return _begin == rhs._begin; }
   bool operator!=(const features_value_iterator& rhs) { return _begin != rhs._begin; }
 
@@ -202,6 +205,8 @@ struct features
   using iterator_value = features_value_iterator;
   using iterator_all = features_value_index_audit_iterator;
 
+  // Each group has its own arrays: reductions push to, truncate, swap and move the group of one namespace without
+  // touching the others, and a pooled example keeps their storage from one use to the next.
   v_array<feature_value> values;               // Always needed.
   v_array<feature_index> indicies;             // Optional for sparse data.
   std::vector<audit_strings_ptr> space_names;  // Optional for audit mode.
@@ -253,6 +258,11 @@ struct features
   void truncate_to(const features_value_iterator& pos);
   void truncate_to(size_t i);
   void push_back(feature_value v, feature_index i);
+  // Makes room for count more features at once, for parsers which know or can bound how many they are about to push.
+  // The storage at least doubles when it grows, as it does a feature at a time.
+  void reserve(size_t count);
+  // Appends the features of other, with their audit strings if it has any.
+  void concat(const features& other);
   bool sort(uint64_t parse_mask);
   void deep_copy_from(const features& src);
 };
@@ -0,0 +1,19 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "feature_hash_cache.h"
+
+namespace VW
+{
+constexpr size_t feature_hash_cache::MAX_NAME_SIZE;
+constexpr size_t feature_hash_cache::MAX_PROBES;
+
+feature_hash_cache::feature_hash_cache(size_t entries_per_namespace) : _entries_per_namespace(entries_per_namespace)
+{
+  // Keep the tables at most half full so that probe sequences stay short.
+  size_t num_slots = 16;
+  while (num_slots < 2 * entries_per_namespace) num_slots *= 2;
+  _mask = num_slots - 1;
+}
+}  // namespace VW
@@ -0,0 +1,119 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "parse_primitives.h"
+#include "vw_string_view.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace VW
+{
+// Remembers the hashes of feature and namespace names so that names which repeat from example to example are not
+// hashed again. Every namespace has its own bounded open addressing table, keyed by the hash seed and the name. Names
+// longer than MAX_NAME_SIZE are always hashed.
+class feature_hash_cache
+{
+public:
+  static constexpr size_t MAX_NAME_SIZE = 24;
+
+  // Holds at least entries_per_namespace names per namespace, tables are allocated when a namespace is first seen.
+  explicit feature_hash_cache(size_t entries_per_namespace);
+
+  // Returns hasher(name.begin(), name.size(), seed). The namespace only selects the table.
+  uint64_t hash(hash_func_t hasher, unsigned char ns, VW::string_view name, uint64_t seed)
+  {
+    if (name.size() > MAX_NAME_SIZE)
+    {
+      ++_misses;
+      return hasher(name.begin(), name.size(), seed);
+    }
+
+    entry key;
+    memcpy(key.name, name.begin(), name.size());
+    key.size = static_cast<uint32_t>(name.size()) + 1;
+    key.seed = seed;
+    auto& table = _tables[ns];
+    if (table.empty())
+    {
+      table.resize(_mask + 1);
+      _bytes += table.size() * sizeof(entry);
+    }
+
+    size_t slot = key.slot();
+    for (size_t probe = 0; probe < MAX_PROBES; probe++)
+    {
+      const entry& e = table[(slot + probe) & _mask];
+      if (e.same_name(key))
+      {
+        ++_hits;
+        return e.hash;
+      }
+      if (e.size == 0)
+      {
+        slot = (slot + probe) & _mask;
+        break;
+      }
+    }
+
+    // Either an empty slot was found, or all probed slots are taken and the first one makes room.
+    ++_misses;
+    key.hash = hasher(name.begin(), name.size(), seed);
+    table[slot & _mask] = key;
+    return key.hash;
+  }
+
+  uint64_t hits() const { return _hits; }
+  uint64_t misses() const { return _misses; }
+  size_t entries_per_namespace() const { return _entries_per_namespace; }
+  // Of the tables allocated so far, any thread may read it.
+  size_t bytes() const { return _bytes; }
+
+  // Adds the counters of a cache which was used in another thread.
+  void add_counts(const feature_hash_cache& other)
+  {
+    _hits += other._hits;
+    _misses += other._misses;
+  }
+
+private:
+  static constexpr size_t MAX_PROBES = 8;
+
+  struct entry
+  {
+    char name[MAX_NAME_SIZE] = {};
+    uint32_t size = 0;  // of the name plus one, 0 for empty slots
+    uint64_t seed = 0;
+    uint64_t hash = 0;
+
+    bool same_name(const entry& other) const
+    {
+      return size == other.size && seed == other.seed && memcmp(name, other.name, MAX_NAME_SIZE) == 0;
+    }
+
+    // Much cheaper than the feature hash, it only has to spread the names over the table.
+    size_t slot() const
+    {
+      constexpr uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+      uint64_t words[MAX_NAME_SIZE / sizeof(uint64_t)];
+      memcpy(words, name, sizeof(words));
+      uint64_t h = (seed ^ size) * multiplier;
+      for (uint64_t word : words) h = (h ^ word) * multiplier;
+      return static_cast<size_t>(h ^ (h >> 32));
+    }
+  };
+
+  size_t _entries_per_namespace;
+  size_t _mask;
+  std::array<std::vector<entry>, 256> _tables;
+  uint64_t _hits = 0;
+  uint64_t _misses = 0;
+  std::atomic<size_t> _bytes{0};
+};
+}  // namespace VW
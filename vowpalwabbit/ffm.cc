@@ -0,0 +1,293 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include <cfloat>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "ffm.h"
+#include "ffm_simd.h"
+#include "gd.h"
+#include "rand48.h"
+#include "reductions.h"
+#include "vw_exception.h"
+#include "parse_args.h"  // for spoof_hex_encoded_namespaces
+
+using namespace VW::LEARNER;
+using namespace VW::config;
+
+/*
+ * A field-aware factorization machine. Each namespace of fields is a field, and a feature has a linear weight and,
+ * for each field, a latent vector of k floats, all of them next to each other in its stride:
+ *
+ *   [linear weight][vector for field 0][vector for field 1]...
+ *
+ * A pair of fields a < b adds to the prediction the sum over the features i of a and j of b of
+ * x_i * x_j * <v_i,b , v_j,a>, which is the dot product of sum_i x_i * v_i,b and sum_j x_j * v_j,a. Summing the vectors
+ * of each namespace first costs O(k * (|a| + |b|)) instead of O(k * |a| * |b|).
+ */
+struct ffm
+{
+  vw* all;
+  std::string fields;           // the namespaces whose features interact, one field each
+  uint32_t k;                   // the length of the latent vectors
+  std::vector<float> sums;      // for each pair of fields, its two sums of vectors of k floats, left then right
+  std::vector<float*> vectors;  // scratch, the vectors of the features of a namespace for a field
+  size_t no_win_counter;
+  uint64_t early_stop_thres;
+};
+
+inline uint64_t vector_offset(const ffm& d, size_t field) { return 1 + field * d.k; }
+
+template <class T>
+void gather_vectors(ffm& d, T& weights, features& fs, uint64_t ft_offset, size_t field)
+{
+  d.vectors.clear();
+  for (size_t i = 0; i < fs.size(); i++)
+    d.vectors.push_back(&weights[fs.indicies[i] + ft_offset] + vector_offset(d, field));
+}
+
+template <class T>
+float ffm_predict(ffm& d, example& ec, T& weights)
+{
+  vw& all = *d.all;
+  label_data& ld = ec.l.simple;
+
+  float prediction = ld.initial;
+  for (features& fs : ec) GD::foreach_feature<float, GD::vec_add, T>(weights, fs, prediction, ec.ft_offset);
+
+  const size_t num_fields = d.fields.size();
+  d.sums.assign(num_fields * (num_fields - 1) * d.k, 0.f);
+  float* sum = d.sums.data();
+  for (size_t a = 0; a < num_fields; a++)
+  {
+    for (size_t b = a + 1; b < num_fields; b++, sum += 2 * d.k)
+    {
+      features& left = ec.feature_space[(unsigned char)d.fields[a]];
+      features& right = ec.feature_space[(unsigned char)d.fields[b]];
+      if (left.size() == 0 || right.size() == 0) continue;
+
+      gather_vectors(d, weights, left, ec.ft_offset, b);
+      VW::ffm_accumulate(sum, d.vectors.data(), left.values.begin(), left.size(), d.k);
+      gather_vectors(d, weights, right, ec.ft_offset, a);
+      VW::ffm_accumulate(sum + d.k, d.vectors.data(), right.values.begin(), right.size(), d.k);
+      prediction += VW::ffm_dot(sum, sum + d.k, d.k);
+    }
+  }
+
+  ec.partial_prediction = prediction;
+
+  all.set_minmax(all.sd, ld.label);
+
+  ec.pred.scalar = GD::finalize_prediction(all.sd, all.logger, ec.partial_prediction);
+
+  if (ld.label != FLT_MAX) ec.loss = all.loss->getLoss(all.sd, ec.pred.scalar, ld.label) * ec.weight;
+
+  return ec.pred.scalar;
+}
+
+float ffm_predict(ffm& d, example& ec)
+{
+  vw& all = *d.all;
+  if (all.weights.sparse)
+    return ffm_predict(d, ec, all.weights.sparse_weights);
+  else
+    return ffm_predict(d, ec, all.weights.dense_weights);
+}
+
+template <class T>
+void ffm_train(ffm& d, example& ec, T& weights)
+{
+  vw& all = *d.all;
+  label_data& ld = ec.l.simple;
+
+  // update = eta_t*(y-y_hat) where eta_t = eta/t^p * importance weight
+  float eta_t = all.eta / powf((float)all.sd->t + ec.weight, (float)all.power_t) * ec.weight;
+  float update = all.loss->getUpdate(ec.pred.scalar, ld.label, eta_t, 1.);
+
+  float regularization = eta_t * all.l2_lambda;
+
+  // linear update
+  for (features& fs : ec)
+  {
+    for (size_t i = 0; i < fs.size(); i++)
+    {
+      weight& w = weights[fs.indicies[i] + ec.ft_offset];
+      w += update * fs.values[i] - regularization * w;
+    }
+  }
+
+  // the gradient of a pair for a vector of one side is x times the sum of the other side
+  const size_t num_fields = d.fields.size();
+  const float* sum = d.sums.data();
+  for (size_t a = 0; a < num_fields; a++)
+  {
+    for (size_t b = a + 1; b < num_fields; b++, sum += 2 * d.k)
+    {
+      features& left = ec.feature_space[(unsigned char)d.fields[a]];
+      features& right = ec.feature_space[(unsigned char)d.fields[b]];
+      if (left.size() == 0 || right.size() == 0) continue;
+
+      gather_vectors(d, weights, left, ec.ft_offset, b);
+      VW::ffm_update(d.vectors.data(), left.values.begin(), left.size(), sum + d.k, d.k, update, regularization);
+      gather_vectors(d, weights, right, ec.ft_offset, a);
+      VW::ffm_update(d.vectors.data(), right.values.begin(), right.size(), sum, d.k, update, regularization);
+    }
+  }
+}
+
+void ffm_train(ffm& d, example& ec)
+{
+  if (d.all->weights.sparse)
+    ffm_train(d, ec, d.all->weights.sparse_weights);
+  else
+    ffm_train(d, ec, d.all->weights.dense_weights);
+}
+
+// The linear weight starts as --initial_weight sets it, the vectors at random in [0, 1/sqrt(k)).
+void initialize_weights(weight* weights, uint64_t index, uint32_t stride, float initial_weight, float scale)
+{
+  uint64_t seed = index;
+  weights[0] = initial_weight;
+  for (uint32_t i = 1; i < stride; i++) weights[i] = scale * merand48(seed);
+}
+
+void save_load(ffm& d, io_buf& model_file, bool read, bool text)
+{
+  vw& all = *d.all;
+  uint64_t length = (uint64_t)1 << all.num_bits;
+  if (read)
+  {
+    initialize_regressor(all);
+    uint32_t stride = all.weights.stride();
+    float initial_weight = all.initial_weight;
+    float scale = 1.f / std::sqrt((float)d.k);
+    auto weight_initializer = [stride, initial_weight, scale](weight* weights, uint64_t index) {
+      initialize_weights(weights, index, stride, initial_weight, scale);
+    };
+    all.weights.set_default(weight_initializer);
+  }
+
+  if (model_file.num_files() > 0)
+  {
+    uint64_t i = 0;
+    size_t brw = 1;
+    do
+    {
+      brw = 0;
+      size_t K = d.fields.size() * d.k + 1;
+      std::stringstream msg;
+      msg << i << " ";
+      brw += bin_text_read_write_fixed(model_file, (char*)&i, sizeof(i), "", read, msg, text);
+      if (brw != 0)
+      {
+        weight* w_i = &(all.weights.strided_index(i));
+        for (uint64_t k = 0; k < K; k++)
+        {
+          weight* v = w_i + k;
+          msg << v << " ";
+          brw += bin_text_read_write_fixed(model_file, (char*)v, sizeof(*v), "", read, msg, text);
+        }
+      }
+      if (text)
+      {
+        msg << "\n";
+        brw += bin_text_read_write_fixed(model_file, nullptr, 0, "", read, msg, text);
+      }
+
+      if (!read) ++i;
+    } while ((!read && i < length) || (read && brw > 0));
+  }
+}
+
+void end_pass(ffm& d)
+{
+  vw* all = d.all;
+
+  all->eta *= all->eta_decay_rate;
+  if (all->save_per_pass) save_predictor(*all, all->final_regressor_name, all->current_pass);
+
+  if (!all->holdout_set_off)
+  {
+    if (summarize_holdout_set(*all, d.no_win_counter)) finalize_regressor(*all, all->final_regressor_name);
+    if ((d.early_stop_thres == d.no_win_counter) &&
+        ((all->check_holdout_every_n_passes <= 1) || ((all->current_pass % all->check_holdout_every_n_passes) == 0)))
+      set_done(*all);
+  }
+}
+
+void predict(ffm& d, single_learner&, example& ec) { ffm_predict(d, ec); }
+
+void learn(ffm& d, single_learner&, example& ec)
+{
+  vw& all = *d.all;
+
+  ffm_predict(d, ec);
+  if (all.training && ec.l.simple.label != FLT_MAX) ffm_train(d, ec);
+}
+
+base_learner* ffm_setup(options_i& options, vw& all)
+{
+  auto data = scoped_calloc_or_throw<ffm>();
+
+  std::string ffm_fields;
+  option_group_definition new_options("Field-aware Factorization Machine");
+  new_options.add(make_option("ffm", ffm_fields)
+                      .keep()
+                      .necessary()
+                      .help("use a field-aware factorization machine over the namespaces of arg, one field each, "
+                            "followed by the length of the latent vectors, as in --ffm abc4"));
+
+  if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
+
+  if (options.was_supplied("adaptive")) THROW("adaptive is not implemented for --ffm");
+  if (options.was_supplied("normalized")) THROW("normalized is not implemented for --ffm");
+  if (options.was_supplied("bfgs") || options.was_supplied("conjugate_gradient"))
+    THROW("bfgs is not implemented for --ffm");
+
+  std::string fields = spoof_hex_encoded_namespaces(ffm_fields);
+  size_t last_index = fields.find_last_not_of("0123456789");
+  if (last_index == std::string::npos || last_index + 1 == fields.size())
+    THROW("--ffm needs namespaces followed by the length of the latent vectors, as in --ffm abc4");
+  data->fields = fields.substr(0, last_index + 1);
+  data->k = atoi(fields.substr(last_index + 1).c_str());
+  if (data->k == 0) THROW("--ffm needs latent vectors of one float at least");
+  if (data->fields.size() < 2) THROW("--ffm needs two namespaces at least");
+
+  bool seen[256] = {false};
+  for (char field : data->fields)
+  {
+    if (seen[(unsigned char)field]) THROW("--ffm lists the namespace " << field << " twice");
+    seen[(unsigned char)field] = true;
+  }
+
+  data->all = &all;
+  data->no_win_counter = 0;
+
+  // store the linear weight and a vector per field per index, round up to power of two
+  uint32_t stride_shift = 0;
+  while ((UINT64_ONE << stride_shift) < data->fields.size() * data->k + 1) stride_shift++;
+  all.weights.stride_shift(stride_shift);
+
+  if (!all.holdout_set_off)
+  {
+    all.sd->holdout_best_loss = FLT_MAX;
+    data->early_stop_thres = options.get_typed_option<size_t>("early_terminate").value();
+  }
+
+  // default initial_t to 1 instead of 0
+  if (!options.was_supplied("initial_t"))
+  {
+    all.sd->t = 1.f;
+    all.initial_t = 1.f;
+  }
+  all.eta *= powf((float)(all.sd->t), all.power_t);
+
+  learner<ffm, example>& l = init_learner(data, learn, predict, (UINT64_ONE << all.weights.stride_shift()));
+  l.set_save_load(save_load);
+  l.set_end_pass(end_pass);
+
+  return make_base(l);
+}
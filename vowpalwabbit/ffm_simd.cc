@@ -0,0 +1,140 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "ffm_simd.h"
+
+#include "cpu_features.h"
+
+// The kernels are compiled for their instruction sets whatever the flags of the build, and picked at run time. Only
+// GCC and Clang can target an instruction set per function.
+#if !defined(VW_NO_INLINE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#  define VW_FFM_SIMD
+#  include <immintrin.h>
+#endif
+
+namespace
+{
+using accumulate_fn = void (*)(float*, const float* const*, const float*, size_t, size_t);
+using update_fn = void (*)(float* const*, const float*, size_t, const float*, size_t, float, float);
+using dot_fn = float (*)(const float*, const float*, size_t);
+
+struct kernels
+{
+  accumulate_fn accumulate;
+  update_fn update;
+  dot_fn dot;
+  const char* variant;
+};
+
+// The columns from begin on, which the vector kernels leave to these.
+void scalar_accumulate(float* sum, const float* const* vectors, const float* x, size_t count, size_t begin, size_t k)
+{
+  for (size_t i = 0; i < count; i++)
+    for (size_t j = begin; j < k; j++) sum[j] += x[i] * vectors[i][j];
+}
+
+void scalar_accumulate(float* sum, const float* const* vectors, const float* x, size_t count, size_t k)
+{
+  scalar_accumulate(sum, vectors, x, count, 0, k);
+}
+
+inline void scalar_update(float* vector, float ux, const float* direction, size_t begin, size_t k, float regularization)
+{
+  for (size_t j = begin; j < k; j++) vector[j] += ux * direction[j] - regularization * vector[j];
+}
+
+void scalar_update(float* const* vectors, const float* x, size_t count, const float* direction, size_t k, float update,
+    float regularization)
+{
+  for (size_t i = 0; i < count; i++) scalar_update(vectors[i], update * x[i], direction, 0, k, regularization);
+}
+
+float scalar_dot(const float* a, const float* b, size_t k)
+{
+  float sum = 0.f;
+  for (size_t j = 0; j < k; j++) sum += a[j] * b[j];
+  return sum;
+}
+
+#ifdef VW_FFM_SIMD
+__attribute__((target("avx2,fma"))) void avx2_accumulate(
+    float* sum, const float* const* vectors, const float* x, size_t count, size_t k)
+{
+  size_t j = 0;
+  for (; j + 8 <= k; j += 8)
+  {
+    __m256 s = _mm256_loadu_ps(sum + j);
+    for (size_t i = 0; i < count; i++) s = _mm256_fmadd_ps(_mm256_set1_ps(x[i]), _mm256_loadu_ps(vectors[i] + j), s);
+    _mm256_storeu_ps(sum + j, s);
+  }
+  scalar_accumulate(sum, vectors, x, count, j, k);
+}
+
+__attribute__((target("avx2,fma"))) void avx2_update(float* const* vectors, const float* x, size_t count,
+    const float* direction, size_t k, float update, float regularization)
+{
+  const __m256 regularizations = _mm256_set1_ps(regularization);
+  for (size_t i = 0; i < count; i++)
+  {
+    float* vector = vectors[i];
+    const float ux = update * x[i];
+    const __m256 uxs = _mm256_set1_ps(ux);
+    size_t j = 0;
+    for (; j + 8 <= k; j += 8)
+    {
+      const __m256 v = _mm256_loadu_ps(vector + j);
+      const __m256 stepped = _mm256_fmadd_ps(uxs, _mm256_loadu_ps(direction + j), v);
+      _mm256_storeu_ps(vector + j, _mm256_fnmadd_ps(regularizations, v, stepped));
+    }
+    scalar_update(vector, ux, direction, j, k, regularization);
+  }
+}
+
+__attribute__((target("avx2,fma"))) float avx2_dot(const float* a, const float* b, size_t k)
+{
+  __m256 s = _mm256_setzero_ps();
+  size_t j = 0;
+  for (; j + 8 <= k; j += 8) s = _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j), s);
+
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum) + scalar_dot(a + j, b + j, k - j);
+}
+#endif
+
+kernels select_kernels()
+{
+#ifdef VW_FFM_SIMD
+  const VW::cpu_features& cpu = VW::detected_cpu_features();
+  if (cpu.avx2 && cpu.fma) return {avx2_accumulate, avx2_update, avx2_dot, "avx2"};
+#endif
+  return {scalar_accumulate, scalar_update, scalar_dot, "scalar"};
+}
+
+// Selected the first time they are needed, which may be from a static initializer of its own.
+const kernels& selected()
+{
+  static const kernels selection = select_kernels();
+  return selection;
+}
+}  // namespace
+
+namespace VW
+{
+void ffm_accumulate(float* sum, const float* const* vectors, const float* x, size_t count, size_t k)
+{
+  selected().accumulate(sum, vectors, x, count, k);
+}
+
+void ffm_update(float* const* vectors, const float* x, size_t count, const float* direction, size_t k, float update,
+    float regularization)
+{
+  selected().update(vectors, x, count, direction, k, update, regularization);
+}
+
+float ffm_dot(const float* a, const float* b, size_t k) { return selected().dot(a, b, k); }
+
+const char* ffm_kernel_variant() { return selected().variant; }
+}  // namespace VW
@@ -0,0 +1,27 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+
+namespace VW
+{
+// The kernels of --ffm over latent vectors of k floats. They compute 8 floats of a vector at a time with AVX2 and fused
+// multiply adds, as the CPU supports, and one at a time otherwise, so a k below 8 gains nothing from them.
+
+// sum[j] += x[i] * vectors[i][j] for each of the count vectors.
+void ffm_accumulate(float* sum, const float* const* vectors, const float* x, size_t count, size_t k);
+
+// vectors[i][j] += update * x[i] * direction[j] - regularization * vectors[i][j] for each of the count vectors, one
+// after the other.
+void ffm_update(float* const* vectors, const float* x, size_t count, const float* direction, size_t k, float update,
+    float regularization);
+
+// The sum of a[j] * b[j].
+float ffm_dot(const float* a, const float* b, size_t k);
+
+// avx2 or scalar, whichever the functions above run.
+const char* ffm_kernel_variant();
+}  // namespace VW
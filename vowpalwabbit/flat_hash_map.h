@@ -0,0 +1,130 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace VW
+{
+// A map of uint64_t keys, such as feature indices, held in one array: an open addressing table probed linearly, which
+// holds each key and its value side by side, as the shards of sparse_parameters do. It is meant for the state that
+// reductions keep per feature and look up for every feature of every example, where std::unordered_map allocates every
+// entry and follows a pointer on every lookup. The table is at most half full. Growing it moves the values, so that
+// pointers and references to them only hold until the next insertion.
+template <typename V>
+class flat_hash_map
+{
+public:
+  struct slot
+  {
+    uint64_t key;
+    V value;
+    bool used;
+  };
+
+  // Iterates over the entries in the order of their slots.
+  class iterator
+  {
+  public:
+    iterator(slot* current, slot* end) : _current(current), _end(end) { skip_unused(); }
+    slot& operator*() const { return *_current; }
+    slot* operator->() const { return _current; }
+    iterator& operator++()
+    {
+      ++_current;
+      skip_unused();
+      return *this;
+    }
+    bool operator==(const iterator& rhs) const { return _current == rhs._current; }
+    bool operator!=(const iterator& rhs) const { return _current != rhs._current; }
+
+  private:
+    void skip_unused()
+    {
+      while (_current != _end && !_current->used) ++_current;
+    }
+    slot* _current;
+    slot* _end;
+  };
+
+  explicit flat_hash_map(size_t expected_size = 0) { reserve(expected_size); }
+
+  size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+
+  iterator begin() { return iterator(_slots.data(), _slots.data() + _slots.size()); }
+  iterator end() { return iterator(_slots.data() + _slots.size(), _slots.data() + _slots.size()); }
+
+  // Makes room for expected_size entries, so that they are inserted without growing the table.
+  void reserve(size_t expected_size)
+  {
+    uint32_t log_capacity = _log_capacity == 0 ? MIN_LOG_CAPACITY : _log_capacity;
+    while ((static_cast<size_t>(1) << log_capacity) < 2 * expected_size) log_capacity++;
+    if (log_capacity != _log_capacity) rehash(log_capacity);
+  }
+
+  // The value of key, or nullptr when key is missing.
+  V* find(uint64_t key)
+  {
+    if (_size == 0) return nullptr;
+    for (size_t s = slot_of(key);; s = (s + 1) & _mask)
+    {
+      slot& candidate = _slots[s];
+      if (!candidate.used) return nullptr;
+      if (candidate.key == key) return &candidate.value;
+    }
+  }
+
+  // The value of key, which is value when key was missing. second is whether key was inserted.
+  std::pair<V*, bool> try_emplace(uint64_t key, const V& value)
+  {
+    if (2 * (_size + 1) > _slots.size()) rehash(_log_capacity + 1);
+    size_t s = slot_of(key);
+    for (; _slots[s].used; s = (s + 1) & _mask)
+      if (_slots[s].key == key) return std::make_pair(&_slots[s].value, false);
+    _slots[s].key = key;
+    _slots[s].value = value;
+    _slots[s].used = true;
+    _size++;
+    return std::make_pair(&_slots[s].value, true);
+  }
+
+  V& operator[](uint64_t key) { return *try_emplace(key, V()).first; }
+
+  void clear()
+  {
+    for (auto& s : _slots) s.used = false;
+    _size = 0;
+  }
+
+private:
+  static constexpr uint32_t MIN_LOG_CAPACITY = 4;
+
+  // Fibonacci hashing spreads the strided indices, whose low bits are mostly 0, over the slots.
+  size_t slot_of(uint64_t key) const
+  {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> (64 - _log_capacity));
+  }
+
+  void rehash(uint32_t log_capacity)
+  {
+    std::vector<slot> old(static_cast<size_t>(1) << log_capacity, slot{0, V(), false});
+    old.swap(_slots);
+    _log_capacity = log_capacity;
+    _mask = _slots.size() - 1;
+    _size = 0;
+    for (auto& s : old)
+      if (s.used) try_emplace(s.key, s.value);
+  }
+
+  std::vector<slot> _slots;
+  uint32_t _log_capacity = 0;
+  size_t _mask = 0;
+  size_t _size = 0;
+};
+}  // namespace VW
@@ -4,6 +4,7 @@
 #include <string>
 #include "correctedMath.h"
 #include "gd.h"
+#include "ftrl_simd.h"
 
 using namespace VW::LEARNER;
 using namespace VW::config;
@@ -24,6 +25,10 @@ struct ftrl_update_data
   float l2_lambda;
   float predict;
   float normalized_squared_norm_x;
+  // The weights of the features gathered so far, given to the kernels of ftrl_simd.h a batch at a time.
+  float* batch_weights[VW::FTRL_BATCH];
+  float batch_x[VW::FTRL_BATCH];
+  size_t batch_size;
 };
 
 struct ftrl
@@ -114,28 +119,6 @@ void multipredict(
   }
 }
 
-void inner_update_proximal(ftrl_update_data& d, float x, float& wref)
-{
-  float* w = &wref;
-  float gradient = d.update * x;
-  float ng2 = w[W_G2] + gradient * gradient;
-  float sqrt_ng2 = sqrtf(ng2);
-  float sqrt_wW_G2 = sqrtf(w[W_G2]);
-  float sigma = (sqrt_ng2 - sqrt_wW_G2) / d.ftrl_alpha;
-  w[W_ZT] += gradient - sigma * w[W_XT];
-  w[W_G2] = ng2;
-  sqrt_wW_G2 = sqrt_ng2;
-  float flag = sign(w[W_ZT]);
-  float fabs_zt = w[W_ZT] * flag;
-  if (fabs_zt <= d.l1_lambda)
-    w[W_XT] = 0.;
-  else
-  {
-    float step = 1 / (d.l2_lambda + (d.ftrl_beta + sqrt_wW_G2) / d.ftrl_alpha);
-    w[W_XT] = step * flag * (d.l1_lambda - fabs_zt);
-  }
-}
-
 void inner_update_pistol_state_and_predict(ftrl_update_data& d, float x, float& wref)
 {
   float* w = &wref;
@@ -159,6 +142,35 @@ void inner_update_pistol_post(ftrl_update_data& d, float x, float& wref)
   w[W_G2] += fabs(gradient);
 }
 
+VW::ftrl_parameters parameters_of(const ftrl_update_data& d)
+{
+  return {d.update, d.ftrl_alpha, d.ftrl_beta, d.l1_lambda, d.l2_lambda};
+}
+
+using ftrl_kernel = void (*)(float* const*, const float*, size_t, const VW::ftrl_parameters&);
+
+template <ftrl_kernel kernel>
+void flush_batch(ftrl_update_data& d)
+{
+  kernel(d.batch_weights, d.batch_x, d.batch_size, parameters_of(d));
+  d.batch_size = 0;
+}
+
+// The weights of a batch must be distinct, a weight already in the batch has it updated first.
+template <ftrl_kernel kernel>
+void batch_update(ftrl_update_data& d, float x, float& w)
+{
+  for (size_t i = 0; i < d.batch_size; i++)
+    if (d.batch_weights[i] == &w)
+    {
+      flush_batch<kernel>(d);
+      break;
+    }
+  d.batch_weights[d.batch_size] = &w;
+  d.batch_x[d.batch_size++] = x;
+  if (d.batch_size == VW::FTRL_BATCH) flush_batch<kernel>(d);
+}
+
 // Coin betting vectors
 // W_XT 0  current parameter
 // W_ZT 1  sum negative gradients
@@ -166,44 +178,19 @@ void inner_update_pistol_post(ftrl_update_data& d, float x, float& wref)
 // W_MX 3  maximum absolute value
 // W_WE 4  Wealth
 // W_MG 5  Maximum Lipschitz constant
-void inner_coin_betting_predict(ftrl_update_data& d, float x, float& wref)
+void flush_coin_betting_predict(ftrl_update_data& d)
 {
-  float* w = &wref;
-  float w_mx = w[W_MX];
-  float w_xt = 0.0;
-
-  float fabs_x = fabs(x);
-  if (fabs_x > w_mx) { w_mx = fabs_x; }
-
-  // COCOB update without sigmoid
-  if (w[W_MG] * w_mx > 0) w_xt = ((d.ftrl_alpha + w[W_WE]) / (w[W_MG] * w_mx * (w[W_MG] * w_mx + w[W_G2]))) * w[W_ZT];
-
-  d.predict += w_xt * x;
-  if (w_mx > 0) d.normalized_squared_norm_x += x * x / (w_mx * w_mx);
+  VW::coin_betting_predict(
+      d.batch_weights, d.batch_x, d.batch_size, parameters_of(d), d.predict, d.normalized_squared_norm_x);
+  d.batch_size = 0;
 }
 
-void inner_coin_betting_update_after_prediction(ftrl_update_data& d, float x, float& wref)
+// Predicting leaves the weights as they are, so a batch may have one twice.
+void batch_coin_betting_predict(ftrl_update_data& d, float x, float& w)
 {
-  float* w = &wref;
-  float fabs_x = fabs(x);
-  float gradient = d.update * x;
-
-  if (fabs_x > w[W_MX]) { w[W_MX] = fabs_x; }
-
-  float fabs_gradient = fabs(d.update);
-  if (fabs_gradient > w[W_MG]) w[W_MG] = fabs_gradient > d.ftrl_beta ? fabs_gradient : d.ftrl_beta;
-
-  // COCOB update without sigmoid.
-  // If a new Lipschitz constant and/or magnitude of x is found, the w is
-  // recalculated and used in the update of the wealth below.
-  if (w[W_MG] * w[W_MX] > 0)
-    w[W_XT] = ((d.ftrl_alpha + w[W_WE]) / (w[W_MG] * w[W_MX] * (w[W_MG] * w[W_MX] + w[W_G2]))) * w[W_ZT];
-  else
-    w[W_XT] = 0;
-
-  w[W_ZT] += -gradient;
-  w[W_G2] += fabs(gradient);
-  w[W_WE] += (-gradient * w[W_XT]);
+  d.batch_weights[d.batch_size] = &w;
+  d.batch_x[d.batch_size++] = x;
+  if (d.batch_size == VW::FTRL_BATCH) flush_coin_betting_predict(d);
 }
 
 void coin_betting_predict(ftrl& b, single_learner&, example& ec)
@@ -211,7 +198,8 @@ void coin_betting_predict(ftrl& b, single_learner&, example& ec)
   b.data.predict = 0;
   b.data.normalized_squared_norm_x = 0;
 
-  GD::foreach_feature<ftrl_update_data, inner_coin_betting_predict>(*b.all, ec, b.data);
+  GD::foreach_feature<ftrl_update_data, batch_coin_betting_predict>(*b.all, ec, b.data);
+  flush_coin_betting_predict(b.data);
 
   b.all->normalized_sum_norm_x += ((double)ec.weight) * b.data.normalized_squared_norm_x;
   b.total_weight += ec.weight;
@@ -234,7 +222,8 @@ void update_after_prediction_proximal(ftrl& b, example& ec)
 {
   b.data.update = b.all->loss->first_derivative(b.all->sd, ec.pred.scalar, ec.l.simple.label) * ec.weight;
 
-  GD::foreach_feature<ftrl_update_data, inner_update_proximal>(*b.all, ec, b.data);
+  GD::foreach_feature<ftrl_update_data, batch_update<VW::ftrl_proximal_update>>(*b.all, ec, b.data);
+  flush_batch<VW::ftrl_proximal_update>(b.data);
 }
 
 void update_after_prediction_pistol(ftrl& b, example& ec)
@@ -247,7 +236,8 @@ void update_after_prediction_pistol(ftrl& b, example& ec)
 void coin_betting_update_after_prediction(ftrl& b, example& ec)
 {
   b.data.update = b.all->loss->first_derivative(b.all->sd, ec.pred.scalar, ec.l.simple.label) * ec.weight;
-  GD::foreach_feature<ftrl_update_data, inner_coin_betting_update_after_prediction>(*b.all, ec, b.data);
+  GD::foreach_feature<ftrl_update_data, batch_update<VW::coin_betting_update>>(*b.all, ec, b.data);
+  flush_batch<VW::coin_betting_update>(b.data);
 }
 
 template <bool audit>
@@ -0,0 +1,549 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "ftrl_simd.h"
+
+#include "cpu_features.h"
+
+#include <cmath>
+
+// The x86 kernels are compiled for their instruction sets whatever the flags of the build, and picked at run time, see
+// interactions_simd.cc. NEON is part of every AArch64 CPU.
+#if !defined(VW_NO_INLINE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#  define VW_FTRL_AVX
+#  include <immintrin.h>
+#elif !defined(VW_NO_INLINE_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#  define VW_FTRL_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace
+{
+// The slots of the state of a weight, as in ftrl.cc.
+constexpr size_t XT = 0;  // current parameter
+constexpr size_t ZT = 1;  // accumulated z(t), or the sum of the negative gradients
+constexpr size_t G2 = 2;  // accumulated gradient information
+constexpr size_t MX = 3;  // maximum absolute value
+constexpr size_t WE = 4;  // wealth
+constexpr size_t MG = 5;  // maximum gradient
+
+inline float sign(float w) { return w < 0.f ? -1.f : 1.f; }
+
+void scalar_proximal_update(float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    float* w = weights[i];
+    float gradient = p.update * x[i];
+    float ng2 = w[G2] + gradient * gradient;
+    float sqrt_ng2 = sqrtf(ng2);
+    float sqrt_wW_G2 = sqrtf(w[G2]);
+    float sigma = (sqrt_ng2 - sqrt_wW_G2) / p.alpha;
+    w[ZT] += gradient - sigma * w[XT];
+    w[G2] = ng2;
+    float flag = sign(w[ZT]);
+    float fabs_zt = w[ZT] * flag;
+    if (fabs_zt <= p.l1_lambda)
+      w[XT] = 0.;
+    else
+    {
+      float step = 1 / (p.l2_lambda + (p.beta + sqrt_ng2) / p.alpha);
+      w[XT] = step * flag * (p.l1_lambda - fabs_zt);
+    }
+  }
+}
+
+// The largest gradient seen by a weight, if the gradient of the example is larger, see coin_betting_update.
+inline float max_gradient(const VW::ftrl_parameters& p)
+{
+  const float fabs_gradient = fabsf(p.update);
+  return fabs_gradient > p.beta ? fabs_gradient : p.beta;
+}
+
+void scalar_coin_betting_update(float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  const float fabs_gradient = fabsf(p.update);
+  for (size_t i = 0; i < count; i++)
+  {
+    float* w = weights[i];
+    float fabs_x = fabsf(x[i]);
+    float gradient = p.update * x[i];
+
+    if (fabs_x > w[MX]) { w[MX] = fabs_x; }
+    if (fabs_gradient > w[MG]) w[MG] = max_gradient(p);
+
+    // COCOB update without sigmoid.
+    // If a new Lipschitz constant and/or magnitude of x is found, the w is
+    // recalculated and used in the update of the wealth below.
+    if (w[MG] * w[MX] > 0)
+      w[XT] = ((p.alpha + w[WE]) / (w[MG] * w[MX] * (w[MG] * w[MX] + w[G2]))) * w[ZT];
+    else
+      w[XT] = 0;
+
+    w[ZT] += -gradient;
+    w[G2] += fabsf(gradient);
+    w[WE] += (-gradient * w[XT]);
+  }
+}
+
+void scalar_coin_betting_predict(float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p,
+    float& predict, float& normalized_squared_norm_x)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    const float* w = weights[i];
+    float w_mx = w[MX];
+    float w_xt = 0.0;
+
+    float fabs_x = fabsf(x[i]);
+    if (fabs_x > w_mx) { w_mx = fabs_x; }
+
+    // COCOB update without sigmoid
+    if (w[MG] * w_mx > 0) w_xt = ((p.alpha + w[WE]) / (w[MG] * w_mx * (w[MG] * w_mx + w[G2]))) * w[ZT];
+
+    predict += w_xt * x[i];
+    if (w_mx > 0) normalized_squared_norm_x += x[i] * x[i] / (w_mx * w_mx);
+  }
+}
+
+// Moves slot of the state of lanes weights to and from an array of lanes, which the vector kernels load and store.
+template <size_t lanes>
+inline void gather_slot(float* const* weights, size_t slot, float* values)
+{
+  for (size_t k = 0; k < lanes; k++) values[k] = weights[k][slot];
+}
+
+template <size_t lanes>
+inline void scatter_slot(float* const* weights, size_t slot, const float* values)
+{
+  for (size_t k = 0; k < lanes; k++) weights[k][slot] = values[k];
+}
+
+// The vector kernels keep the order of the operations of the scalar ones, without fused multiply adds, so that they
+// compute the same weights.
+#ifdef VW_FTRL_AVX
+__attribute__((target("avx2"))) inline __m256 load_slot(float* const* weights, size_t slot)
+{
+  alignas(32) float values[8];
+  gather_slot<8>(weights, slot, values);
+  return _mm256_load_ps(values);
+}
+
+__attribute__((target("avx2"))) inline void store_slot(float* const* weights, size_t slot, __m256 v)
+{
+  alignas(32) float values[8];
+  _mm256_store_ps(values, v);
+  scatter_slot<8>(weights, slot, values);
+}
+
+__attribute__((target("avx2"))) inline float horizontal_sum(__m256 v)
+{
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2"))) void avx2_proximal_update(
+    float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  const __m256 update = _mm256_set1_ps(p.update);
+  const __m256 alpha = _mm256_set1_ps(p.alpha);
+  const __m256 beta = _mm256_set1_ps(p.beta);
+  const __m256 l1 = _mm256_set1_ps(p.l1_lambda);
+  const __m256 l2 = _mm256_set1_ps(p.l2_lambda);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 minus_one = _mm256_set1_ps(-1.f);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 xt = load_slot(weights + i, XT);
+    const __m256 g2 = load_slot(weights + i, G2);
+    const __m256 gradient = _mm256_mul_ps(update, _mm256_loadu_ps(x + i));
+    const __m256 ng2 = _mm256_add_ps(g2, _mm256_mul_ps(gradient, gradient));
+    const __m256 sqrt_ng2 = _mm256_sqrt_ps(ng2);
+    const __m256 sigma = _mm256_div_ps(_mm256_sub_ps(sqrt_ng2, _mm256_sqrt_ps(g2)), alpha);
+    const __m256 zt =
+        _mm256_add_ps(load_slot(weights + i, ZT), _mm256_sub_ps(gradient, _mm256_mul_ps(sigma, xt)));
+    const __m256 flag = _mm256_blendv_ps(one, minus_one, _mm256_cmp_ps(zt, zero, _CMP_LT_OQ));
+    const __m256 fabs_zt = _mm256_mul_ps(zt, flag);
+    const __m256 step = _mm256_div_ps(one, _mm256_add_ps(l2, _mm256_div_ps(_mm256_add_ps(beta, sqrt_ng2), alpha)));
+    const __m256 moved = _mm256_mul_ps(_mm256_mul_ps(step, flag), _mm256_sub_ps(l1, fabs_zt));
+    store_slot(weights + i, ZT, zt);
+    store_slot(weights + i, G2, ng2);
+    store_slot(weights + i, XT, _mm256_blendv_ps(moved, zero, _mm256_cmp_ps(fabs_zt, l1, _CMP_LE_OQ)));
+  }
+  scalar_proximal_update(weights + i, x + i, count - i, p);
+}
+
+__attribute__((target("avx2"))) void avx2_coin_betting_update(
+    float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  const __m256 update = _mm256_set1_ps(p.update);
+  const __m256 alpha = _mm256_set1_ps(p.alpha);
+  const __m256 fabs_gradient = _mm256_set1_ps(fabsf(p.update));
+  const __m256 largest_gradient = _mm256_set1_ps(max_gradient(p));
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 sign_bit = _mm256_set1_ps(-0.f);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 xi = _mm256_loadu_ps(x + i);
+    const __m256 fabs_x = _mm256_andnot_ps(sign_bit, xi);
+    const __m256 gradient = _mm256_mul_ps(update, xi);
+    __m256 mx = load_slot(weights + i, MX);
+    mx = _mm256_blendv_ps(mx, fabs_x, _mm256_cmp_ps(fabs_x, mx, _CMP_GT_OQ));
+    __m256 mg = load_slot(weights + i, MG);
+    mg = _mm256_blendv_ps(mg, largest_gradient, _mm256_cmp_ps(fabs_gradient, mg, _CMP_GT_OQ));
+    const __m256 g2 = load_slot(weights + i, G2);
+    const __m256 we = load_slot(weights + i, WE);
+    const __m256 zt = load_slot(weights + i, ZT);
+
+    const __m256 scale = _mm256_mul_ps(mg, mx);
+    const __m256 bet = _mm256_mul_ps(
+        _mm256_div_ps(_mm256_add_ps(alpha, we), _mm256_mul_ps(scale, _mm256_add_ps(scale, g2))), zt);
+    const __m256 xt = _mm256_blendv_ps(zero, bet, _mm256_cmp_ps(scale, zero, _CMP_GT_OQ));
+
+    store_slot(weights + i, MX, mx);
+    store_slot(weights + i, MG, mg);
+    store_slot(weights + i, XT, xt);
+    const __m256 negative_gradient = _mm256_xor_ps(gradient, sign_bit);
+    store_slot(weights + i, ZT, _mm256_add_ps(zt, negative_gradient));
+    store_slot(weights + i, G2, _mm256_add_ps(g2, _mm256_andnot_ps(sign_bit, gradient)));
+    store_slot(weights + i, WE, _mm256_add_ps(we, _mm256_mul_ps(negative_gradient, xt)));
+  }
+  scalar_coin_betting_update(weights + i, x + i, count - i, p);
+}
+
+__attribute__((target("avx2"))) void avx2_coin_betting_predict(float* const* weights, const float* x, size_t count,
+    const VW::ftrl_parameters& p, float& predict, float& normalized_squared_norm_x)
+{
+  const __m256 alpha = _mm256_set1_ps(p.alpha);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 sign_bit = _mm256_set1_ps(-0.f);
+  __m256 predict_sum = zero;
+  __m256 norm_sum = zero;
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 xi = _mm256_loadu_ps(x + i);
+    const __m256 fabs_x = _mm256_andnot_ps(sign_bit, xi);
+    __m256 mx = load_slot(weights + i, MX);
+    mx = _mm256_blendv_ps(mx, fabs_x, _mm256_cmp_ps(fabs_x, mx, _CMP_GT_OQ));
+    const __m256 mg = load_slot(weights + i, MG);
+    const __m256 scale = _mm256_mul_ps(mg, mx);
+    const __m256 bet = _mm256_mul_ps(_mm256_div_ps(_mm256_add_ps(alpha, load_slot(weights + i, WE)),
+                                         _mm256_mul_ps(scale, _mm256_add_ps(scale, load_slot(weights + i, G2)))),
+        load_slot(weights + i, ZT));
+    const __m256 xt = _mm256_blendv_ps(zero, bet, _mm256_cmp_ps(scale, zero, _CMP_GT_OQ));
+    predict_sum = _mm256_add_ps(predict_sum, _mm256_mul_ps(xt, xi));
+    const __m256 norm = _mm256_div_ps(_mm256_mul_ps(xi, xi), _mm256_mul_ps(mx, mx));
+    norm_sum = _mm256_add_ps(norm_sum, _mm256_blendv_ps(zero, norm, _mm256_cmp_ps(mx, zero, _CMP_GT_OQ)));
+  }
+  predict += horizontal_sum(predict_sum);
+  normalized_squared_norm_x += horizontal_sum(norm_sum);
+  scalar_coin_betting_predict(weights + i, x + i, count - i, p, predict, normalized_squared_norm_x);
+}
+
+__attribute__((target("avx512f,avx2"))) inline __m512 load_slot16(float* const* weights, size_t slot)
+{
+  alignas(64) float values[16];
+  gather_slot<16>(weights, slot, values);
+  return _mm512_load_ps(values);
+}
+
+__attribute__((target("avx512f,avx2"))) inline void store_slot16(float* const* weights, size_t slot, __m512 v)
+{
+  alignas(64) float values[16];
+  _mm512_store_ps(values, v);
+  scatter_slot<16>(weights, slot, values);
+}
+
+__attribute__((target("avx512f,avx2"))) inline float horizontal_sum16(__m512 v)
+{
+  alignas(64) float values[16];
+  _mm512_store_ps(values, v);
+  return horizontal_sum(_mm256_add_ps(_mm256_load_ps(values), _mm256_load_ps(values + 8)));
+}
+
+// The masked forms of the intrinsics are used where the others start from an undefined vector, which GCC warns of.
+__attribute__((target("avx512f,avx2"))) void avx512_proximal_update(
+    float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  const __m512 update = _mm512_set1_ps(p.update);
+  const __m512 alpha = _mm512_set1_ps(p.alpha);
+  const __m512 beta = _mm512_set1_ps(p.beta);
+  const __m512 l1 = _mm512_set1_ps(p.l1_lambda);
+  const __m512 l2 = _mm512_set1_ps(p.l2_lambda);
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 one = _mm512_set1_ps(1.f);
+  const __m512 minus_one = _mm512_set1_ps(-1.f);
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m512 xt = load_slot16(weights + i, XT);
+    const __m512 g2 = load_slot16(weights + i, G2);
+    const __m512 gradient = _mm512_mul_ps(update, _mm512_loadu_ps(x + i));
+    const __m512 ng2 = _mm512_add_ps(g2, _mm512_mul_ps(gradient, gradient));
+    const __m512 sqrt_ng2 = _mm512_maskz_sqrt_ps(0xffff, ng2);
+    const __m512 sigma = _mm512_div_ps(_mm512_sub_ps(sqrt_ng2, _mm512_maskz_sqrt_ps(0xffff, g2)), alpha);
+    const __m512 zt =
+        _mm512_add_ps(load_slot16(weights + i, ZT), _mm512_sub_ps(gradient, _mm512_mul_ps(sigma, xt)));
+    const __m512 flag = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(zt, zero, _CMP_LT_OQ), one, minus_one);
+    const __m512 fabs_zt = _mm512_mul_ps(zt, flag);
+    const __m512 step = _mm512_div_ps(one, _mm512_add_ps(l2, _mm512_div_ps(_mm512_add_ps(beta, sqrt_ng2), alpha)));
+    const __m512 moved = _mm512_mul_ps(_mm512_mul_ps(step, flag), _mm512_sub_ps(l1, fabs_zt));
+    store_slot16(weights + i, ZT, zt);
+    store_slot16(weights + i, G2, ng2);
+    store_slot16(weights + i, XT, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(fabs_zt, l1, _CMP_LE_OQ), moved, zero));
+  }
+  if (i + 8 <= count) return avx2_proximal_update(weights + i, x + i, count - i, p);
+  scalar_proximal_update(weights + i, x + i, count - i, p);
+}
+
+__attribute__((target("avx512f,avx2"))) void avx512_coin_betting_update(
+    float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  const __m512 update = _mm512_set1_ps(p.update);
+  const __m512 alpha = _mm512_set1_ps(p.alpha);
+  const __m512 fabs_gradient = _mm512_set1_ps(fabsf(p.update));
+  const __m512 largest_gradient = _mm512_set1_ps(max_gradient(p));
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 minus_one = _mm512_set1_ps(-1.f);
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m512 xi = _mm512_loadu_ps(x + i);
+    const __m512 fabs_x = _mm512_abs_ps(xi);
+    const __m512 gradient = _mm512_mul_ps(update, xi);
+    __m512 mx = load_slot16(weights + i, MX);
+    mx = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(fabs_x, mx, _CMP_GT_OQ), mx, fabs_x);
+    __m512 mg = load_slot16(weights + i, MG);
+    mg = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(fabs_gradient, mg, _CMP_GT_OQ), mg, largest_gradient);
+    const __m512 g2 = load_slot16(weights + i, G2);
+    const __m512 we = load_slot16(weights + i, WE);
+    const __m512 zt = load_slot16(weights + i, ZT);
+
+    const __m512 scale = _mm512_mul_ps(mg, mx);
+    const __m512 bet = _mm512_mul_ps(
+        _mm512_div_ps(_mm512_add_ps(alpha, we), _mm512_mul_ps(scale, _mm512_add_ps(scale, g2))), zt);
+    const __m512 xt = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(scale, zero, _CMP_GT_OQ), zero, bet);
+
+    store_slot16(weights + i, MX, mx);
+    store_slot16(weights + i, MG, mg);
+    store_slot16(weights + i, XT, xt);
+    // AVX-512F has no xor of floats, multiplying by -1 negates as exactly.
+    const __m512 negative_gradient = _mm512_mul_ps(gradient, minus_one);
+    store_slot16(weights + i, ZT, _mm512_add_ps(zt, negative_gradient));
+    store_slot16(weights + i, G2, _mm512_add_ps(g2, _mm512_abs_ps(gradient)));
+    store_slot16(weights + i, WE, _mm512_add_ps(we, _mm512_mul_ps(negative_gradient, xt)));
+  }
+  if (i + 8 <= count) return avx2_coin_betting_update(weights + i, x + i, count - i, p);
+  scalar_coin_betting_update(weights + i, x + i, count - i, p);
+}
+
+__attribute__((target("avx512f,avx2"))) void avx512_coin_betting_predict(float* const* weights, const float* x,
+    size_t count, const VW::ftrl_parameters& p, float& predict, float& normalized_squared_norm_x)
+{
+  const __m512 alpha = _mm512_set1_ps(p.alpha);
+  const __m512 zero = _mm512_setzero_ps();
+  __m512 predict_sum = zero;
+  __m512 norm_sum = zero;
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m512 xi = _mm512_loadu_ps(x + i);
+    const __m512 fabs_x = _mm512_abs_ps(xi);
+    __m512 mx = load_slot16(weights + i, MX);
+    mx = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(fabs_x, mx, _CMP_GT_OQ), mx, fabs_x);
+    const __m512 mg = load_slot16(weights + i, MG);
+    const __m512 scale = _mm512_mul_ps(mg, mx);
+    const __m512 bet = _mm512_mul_ps(_mm512_div_ps(_mm512_add_ps(alpha, load_slot16(weights + i, WE)),
+                                         _mm512_mul_ps(scale, _mm512_add_ps(scale, load_slot16(weights + i, G2)))),
+        load_slot16(weights + i, ZT));
+    const __m512 xt = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(scale, zero, _CMP_GT_OQ), zero, bet);
+    predict_sum = _mm512_add_ps(predict_sum, _mm512_mul_ps(xt, xi));
+    const __m512 norm = _mm512_div_ps(_mm512_mul_ps(xi, xi), _mm512_mul_ps(mx, mx));
+    norm_sum = _mm512_add_ps(norm_sum, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(mx, zero, _CMP_GT_OQ), zero, norm));
+  }
+  predict += horizontal_sum16(predict_sum);
+  normalized_squared_norm_x += horizontal_sum16(norm_sum);
+  if (i + 8 <= count)
+    return avx2_coin_betting_predict(weights + i, x + i, count - i, p, predict, normalized_squared_norm_x);
+  scalar_coin_betting_predict(weights + i, x + i, count - i, p, predict, normalized_squared_norm_x);
+}
+#endif
+
+#ifdef VW_FTRL_NEON
+inline float32x4_t load_slot(float* const* weights, size_t slot)
+{
+  float values[4];
+  gather_slot<4>(weights, slot, values);
+  return vld1q_f32(values);
+}
+
+inline void store_slot(float* const* weights, size_t slot, float32x4_t v)
+{
+  float values[4];
+  vst1q_f32(values, v);
+  scatter_slot<4>(weights, slot, values);
+}
+
+void neon_proximal_update(float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  const float32x4_t update = vdupq_n_f32(p.update);
+  const float32x4_t alpha = vdupq_n_f32(p.alpha);
+  const float32x4_t beta = vdupq_n_f32(p.beta);
+  const float32x4_t l1 = vdupq_n_f32(p.l1_lambda);
+  const float32x4_t l2 = vdupq_n_f32(p.l2_lambda);
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  const float32x4_t one = vdupq_n_f32(1.f);
+  const float32x4_t minus_one = vdupq_n_f32(-1.f);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const float32x4_t xt = load_slot(weights + i, XT);
+    const float32x4_t g2 = load_slot(weights + i, G2);
+    const float32x4_t gradient = vmulq_f32(update, vld1q_f32(x + i));
+    const float32x4_t ng2 = vaddq_f32(g2, vmulq_f32(gradient, gradient));
+    const float32x4_t sqrt_ng2 = vsqrtq_f32(ng2);
+    const float32x4_t sigma = vdivq_f32(vsubq_f32(sqrt_ng2, vsqrtq_f32(g2)), alpha);
+    const float32x4_t zt = vaddq_f32(load_slot(weights + i, ZT), vsubq_f32(gradient, vmulq_f32(sigma, xt)));
+    const float32x4_t flag = vbslq_f32(vcltq_f32(zt, zero), minus_one, one);
+    const float32x4_t fabs_zt = vmulq_f32(zt, flag);
+    const float32x4_t step = vdivq_f32(one, vaddq_f32(l2, vdivq_f32(vaddq_f32(beta, sqrt_ng2), alpha)));
+    const float32x4_t moved = vmulq_f32(vmulq_f32(step, flag), vsubq_f32(l1, fabs_zt));
+    store_slot(weights + i, ZT, zt);
+    store_slot(weights + i, G2, ng2);
+    store_slot(weights + i, XT, vbslq_f32(vcleq_f32(fabs_zt, l1), zero, moved));
+  }
+  scalar_proximal_update(weights + i, x + i, count - i, p);
+}
+
+void neon_coin_betting_update(float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p)
+{
+  const float32x4_t update = vdupq_n_f32(p.update);
+  const float32x4_t alpha = vdupq_n_f32(p.alpha);
+  const float32x4_t fabs_gradient = vdupq_n_f32(fabsf(p.update));
+  const float32x4_t largest_gradient = vdupq_n_f32(max_gradient(p));
+  const float32x4_t zero = vdupq_n_f32(0.f);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const float32x4_t xi = vld1q_f32(x + i);
+    const float32x4_t fabs_x = vabsq_f32(xi);
+    const float32x4_t gradient = vmulq_f32(update, xi);
+    float32x4_t mx = load_slot(weights + i, MX);
+    mx = vbslq_f32(vcgtq_f32(fabs_x, mx), fabs_x, mx);
+    float32x4_t mg = load_slot(weights + i, MG);
+    mg = vbslq_f32(vcgtq_f32(fabs_gradient, mg), largest_gradient, mg);
+    const float32x4_t g2 = load_slot(weights + i, G2);
+    const float32x4_t we = load_slot(weights + i, WE);
+    const float32x4_t zt = load_slot(weights + i, ZT);
+
+    const float32x4_t scale = vmulq_f32(mg, mx);
+    const float32x4_t bet = vmulq_f32(vdivq_f32(vaddq_f32(alpha, we), vmulq_f32(scale, vaddq_f32(scale, g2))), zt);
+    const float32x4_t xt = vbslq_f32(vcgtq_f32(scale, zero), bet, zero);
+
+    store_slot(weights + i, MX, mx);
+    store_slot(weights + i, MG, mg);
+    store_slot(weights + i, XT, xt);
+    const float32x4_t negative_gradient = vnegq_f32(gradient);
+    store_slot(weights + i, ZT, vaddq_f32(zt, negative_gradient));
+    store_slot(weights + i, G2, vaddq_f32(g2, vabsq_f32(gradient)));
+    store_slot(weights + i, WE, vaddq_f32(we, vmulq_f32(negative_gradient, xt)));
+  }
+  scalar_coin_betting_update(weights + i, x + i, count - i, p);
+}
+
+void neon_coin_betting_predict(float* const* weights, const float* x, size_t count, const VW::ftrl_parameters& p,
+    float& predict, float& normalized_squared_norm_x)
+{
+  const float32x4_t alpha = vdupq_n_f32(p.alpha);
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  float32x4_t predict_sum = zero;
+  float32x4_t norm_sum = zero;
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const float32x4_t xi = vld1q_f32(x + i);
+    float32x4_t mx = load_slot(weights + i, MX);
+    mx = vbslq_f32(vcgtq_f32(vabsq_f32(xi), mx), vabsq_f32(xi), mx);
+    const float32x4_t scale = vmulq_f32(load_slot(weights + i, MG), mx);
+    const float32x4_t bet = vmulq_f32(vdivq_f32(vaddq_f32(alpha, load_slot(weights + i, WE)),
+                                          vmulq_f32(scale, vaddq_f32(scale, load_slot(weights + i, G2)))),
+        load_slot(weights + i, ZT));
+    const float32x4_t xt = vbslq_f32(vcgtq_f32(scale, zero), bet, zero);
+    predict_sum = vaddq_f32(predict_sum, vmulq_f32(xt, xi));
+    const float32x4_t norm = vdivq_f32(vmulq_f32(xi, xi), vmulq_f32(mx, mx));
+    norm_sum = vaddq_f32(norm_sum, vbslq_f32(vcgtq_f32(mx, zero), norm, zero));
+  }
+  predict += vaddvq_f32(predict_sum);
+  normalized_squared_norm_x += vaddvq_f32(norm_sum);
+  scalar_coin_betting_predict(weights + i, x + i, count - i, p, predict, normalized_squared_norm_x);
+}
+#endif
+
+using update_fn = void (*)(float* const*, const float*, size_t, const VW::ftrl_parameters&);
+using predict_fn = void (*)(float* const*, const float*, size_t, const VW::ftrl_parameters&, float&, float&);
+
+struct kernels
+{
+  update_fn proximal_update;
+  update_fn coin_betting_update;
+  predict_fn coin_betting_predict;
+  const char* variant;
+};
+
+kernels select_kernels()
+{
+#ifdef VW_FTRL_AVX
+  const VW::cpu_features& cpu = VW::detected_cpu_features();
+  if (cpu.avx512f) return {avx512_proximal_update, avx512_coin_betting_update, avx512_coin_betting_predict, "avx512"};
+  if (cpu.avx2) return {avx2_proximal_update, avx2_coin_betting_update, avx2_coin_betting_predict, "avx2"};
+#endif
+#ifdef VW_FTRL_NEON
+  return {neon_proximal_update, neon_coin_betting_update, neon_coin_betting_predict, "neon"};
+#else
+  return {scalar_proximal_update, scalar_coin_betting_update, scalar_coin_betting_predict, "scalar"};
+#endif
+}
+
+const kernels& selected()
+{
+  static const kernels selection = select_kernels();
+  return selection;
+}
+}  // namespace
+
+namespace VW
+{
+void ftrl_proximal_update(float* const* weights, const float* x, size_t count, const ftrl_parameters& p)
+{
+  selected().proximal_update(weights, x, count, p);
+}
+
+void coin_betting_update(float* const* weights, const float* x, size_t count, const ftrl_parameters& p)
+{
+  selected().coin_betting_update(weights, x, count, p);
+}
+
+void coin_betting_predict(float* const* weights, const float* x, size_t count, const ftrl_parameters& p,
+    float& predict, float& normalized_squared_norm_x)
+{
+  selected().coin_betting_predict(weights, x, count, p, predict, normalized_squared_norm_x);
+}
+
+const char* ftrl_kernel_variant() { return selected().variant; }
+}  // namespace VW
@@ -0,0 +1,40 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+
+namespace VW
+{
+// The most weights the kernels below are given at once, as many as fit an AVX-512 register.
+constexpr size_t FTRL_BATCH = 16;
+
+struct ftrl_parameters
+{
+  float update;  // the gradient of the loss, times the importance weight
+  float alpha;
+  float beta;
+  float l1_lambda;
+  float l2_lambda;
+};
+
+// Each kernel does to the state of count weights, weights[i] being the state of the weight of feature value x[i], what
+// ftrl does to the weight of one feature. The weights are computed 16 at a time with AVX-512, 8 at a time with AVX2 or
+// 4 at a time with NEON, as the CPU supports, and one at a time otherwise. The weights must be distinct.
+
+// The update of --ftrl once the prediction is known.
+void ftrl_proximal_update(float* const* weights, const float* x, size_t count, const ftrl_parameters& p);
+
+// The update of --coin once the prediction is known.
+void coin_betting_update(float* const* weights, const float* x, size_t count, const ftrl_parameters& p);
+
+// Adds the prediction of --coin from the weights to predict and the squared norm of x normalized by its largest
+// magnitudes to normalized_squared_norm_x. p.update is not used.
+void coin_betting_predict(float* const* weights, const float* x, size_t count, const ftrl_parameters& p,
+    float& predict, float& normalized_squared_norm_x);
+
+// avx512, avx2, neon or scalar, whichever the functions above run.
+const char* ftrl_kernel_variant();
+}  // namespace VW
@@ -3,7 +3,11 @@
 // license as described in the file LICENSE.
 #include "crossplat_compat.h"
 
+#include <algorithm>
+#include <array>
 #include <cfloat>
+#include <functional>
+#include <thread>
 
 #if !defined(VW_NO_INLINE_SIMD)
 #  if !defined(__SSE2__) && (defined(_M_AMD64) || defined(_M_X64))
@@ -19,8 +23,11 @@
 
 #include "gd.h"
 #include "accumulate.h"
+#include "parameter_server_client.h"
 #include "reductions.h"
 #include "vw.h"
+#include "array_parameters_quantized.h"
+#include "thread_affinity.h"
 
 #define VERSION_SAVE_RESUME_FIX "7.10.1"
 #define VERSION_PASS_UINT64 "8.3.3"
@@ -32,6 +39,13 @@ using namespace VW::config;
 // 4. Factor various state out of vw&
 namespace GD
 {
+// An update of a weight held back until the end of its minibatch, see --minibatch_sgd.
+struct minibatch_update
+{
+  weight* w;
+  float update;
+};
+
 struct gd
 {
   //  double normalized_sum_norm_x;
@@ -47,15 +61,34 @@ struct gd
   void (*learn)(gd&, base_learner&, example&);
   void (*update)(gd&, base_learner&, example&);
   float (*sensitivity)(gd&, base_learner&, example&);
+  void (*multi_sensitivity)(gd&, base_learner&, example&, const float*, size_t, float*);
+  float (*predict_with_sensitivity)(gd&, base_learner&, example&);
   void (*multipredict)(gd&, base_learner&, example&, size_t, size_t, polyprediction*, bool);
+  void (*multiupdate)(
+      gd&, base_learner&, example&, size_t, size_t, const uint32_t*, const float*, const polyprediction*);
+  void (*learn_difference)(gd&, base_learner&, example&, example&);
+  std::vector<float> multi_updates;  // of each model of multiupdate
   bool adaptive_input;
   bool normalized_input;
   bool adax;
+  bool quantized_model;  // the weights of the model read are quantized, see --save_quantized
+  bool weight_runs_model;  // the weights of the model read are in runs, see --write_weight_runs
+  bool weight_image_model;  // the weights of the model read are one array, see --write_weight_image
+  bool resume_columns_model;  // the state of the resumable model read is in columns, see --write_resume_columns
+  bool planar;  // the state of the weights is laid out in planes, see --planar_weights
+  bool fused;  // learn from the features and interactions gathered once per example, see --fused_learn
+  bool fused_active;  // whether the passes over the features of the example being learnt walk its expanded_features
+  example* subtrahend;  // of learn_difference, whose features the passes follow those of the example with, negated
+  bool lazy;  // regularize each weight when it is next used, see --lazy_regularization
+  uint64_t lazy_slot;  // with lazy, the first of the two slots of state holding when a weight was last regularized
+  size_t minibatch;  // the examples whose updates are applied at once, 1 to apply each as it is learnt
+  size_t minibatch_examples;  // learnt since the updates were last applied
+  std::vector<minibatch_update> minibatch_updates;  // held back, in the order they were made
 
   vw* all;  // parallel, features, parameters
 };
 
-void sync_weights(vw& all);
+void sync_weights(gd& g);
 
 inline float quake_InvSqrt(float x)
 {
@@ -96,18 +129,104 @@ static inline float InvSqrt(float x)
 
   return x;
 }
+// The state of a weight, slot 0 being the weight itself. Interleaved, the slots follow the weight, planar they are
+// slot_distance apart, see dense_parameters::slot_distance.
+template <bool planar>
+struct weight_slots
+{
+  weight* w;
+  uint64_t distance;
+
+  weight& operator[](size_t slot) const { return planar ? w[slot * distance] : w[slot]; }
+};
+
+// With --lazy_regularization, slots slot and slot + 1 of a weight hold the gravity and contraction of the model when
+// the l1 and l2 regularization were last applied to it, both 0 if they were not since sync_weights. Regularizing a
+// weight when it is used makes the cost of the regularization that of the features of the example, where otherwise the
+// weights are scaled as a whole and synced in a pass over all of them once the scale runs low.
+struct lazy_state
+{
+  uint64_t slot;  // 0 if not lazy
+  float gravity;
+  float contraction;
+};
+
+inline lazy_state lazy_state_of(gd& g)
+{
+  return {g.lazy_slot, (float)g.all->sd->gravity, (float)g.all->sd->contraction};
+}
+
+// The weight with the regularization since it was last applied to w.
+template <bool planar>
+inline float lazy_weight(const weight_slots<planar>& w, const lazy_state& lazy)
+{
+  const float contraction = w[lazy.slot + 1] == 0.f ? 1.f : w[lazy.slot + 1];
+  return trunc_weight(w[0], lazy.gravity - w[lazy.slot]) * (lazy.contraction / contraction);
+}
+
+template <bool planar>
+inline void lazy_sync(const weight_slots<planar>& w, const lazy_state& lazy)
+{
+  w[0] = lazy_weight(w, lazy);
+  w[lazy.slot] = lazy.gravity;
+  w[lazy.slot + 1] = lazy.contraction;
+}
+
+struct update_data
+{
+  float update;
+  uint64_t slot_distance;
+  lazy_state lazy;
+  std::vector<minibatch_update>* minibatch;  // nullptr to update the weights as the features are walked
+};
+
+inline std::vector<minibatch_update>* minibatch_of(gd& g) { return g.minibatch > 1 ? &g.minibatch_updates : nullptr; }
+
 VW_WARNING_STATE_PUSH
 VW_WARNING_DISABLE_CPP_17_LANG_EXT
-template <bool sqrt_rate, bool feature_mask_off, size_t adaptive, size_t normalized, size_t spare>
-inline void update_feature(float& update, float x, float& fw)
+template <bool sqrt_rate, bool feature_mask_off, bool planar, size_t adaptive, size_t normalized, size_t spare>
+inline void update_feature(update_data& d, float x, float& fw)
 {
-  weight* w = &fw;
+  weight_slots<planar> w = {&fw, d.slot_distance};
   bool modify = x < FLT_MAX && x > -FLT_MAX && (feature_mask_off || fw != 0.);
   if (modify)
   {
     if VW_STD17_CONSTEXPR (spare != 0) { x *= w[spare]; }
-    w[0] += update * x;
+    if (d.minibatch != nullptr)
+      d.minibatch->push_back({&fw, d.update * x});
+    else
+    {
+      if (d.lazy.slot != 0) { lazy_sync(w, d.lazy); }
+      w[0] += d.update * x;
+    }
+  }
+}
+
+// Applies the updates held back since the last minibatch, summing those of a weight so that it is written once. A
+// weight learnt from many examples of the minibatch is then written once rather than by each of them.
+void apply_minibatch(gd& g)
+{
+  auto& updates = g.minibatch_updates;
+  g.minibatch_examples = 0;
+  if (updates.empty()) return;
+  // In order of the weights, which also walks the dense ones through memory in order.
+  std::stable_sort(updates.begin(), updates.end(),
+      [](const minibatch_update& a, const minibatch_update& b) { return std::less<weight*>()(a.w, b.w); });
+  const lazy_state lazy = lazy_state_of(g);
+  const uint64_t distance = g.all->weights.slot_distance();
+  for (size_t i = 0; i < updates.size();)
+  {
+    weight* fw = updates[i].w;
+    float sum = 0.f;
+    for (; i < updates.size() && updates[i].w == fw; i++) sum += updates[i].update;
+    if (lazy.slot != 0)
+    {
+      const weight_slots<true> w = {fw, distance};
+      lazy_sync(w, lazy);
+    }
+    *fw += sum;
   }
+  updates.clear();
 }
 
 // this deals with few nonzero features vs. all nonzero features issues.
@@ -130,17 +249,57 @@ float average_update(float total_weight, float normalized_sum_norm_x, float neg_
   return 1.f;
 }
 
-template <bool sqrt_rate, bool feature_mask_off, size_t adaptive, size_t normalized, size_t spare>
+template <class R, void (*T)(R&, float, float&)>
+inline void negated_feature(R& dat, float x, float& fw)
+{
+  T(dat, -x, fw);
+}
+
+// Walks the features of ec as foreach_feature does, or those the fused learn gathered when it is learning from ec. When
+// learn_difference learns from ec less a subtrahend, its features follow at the offset of ec, negated.
+template <class R, void (*T)(R&, float, float&)>
+inline void walk_features(gd& g, example& ec, R& dat)
+{
+  vw& all = *g.all;
+  if (!g.fused_active)
+    foreach_feature<R, T>(all, ec, dat);
+  else if (all.weights.sparse)
+    foreach_feature<R, T, sparse_parameters>(all.weights.sparse_weights, ec.expanded_features, dat, ec.ft_offset);
+  else
+    foreach_feature<R, T, dense_parameters>(all.weights.dense_weights, ec.expanded_features, dat, ec.ft_offset);
+  if (g.subtrahend == nullptr) return;
+
+  example& subtrahend = *g.subtrahend;
+  if (!g.fused_active)
+  {
+    const uint64_t offset = subtrahend.ft_offset;
+    subtrahend.ft_offset = ec.ft_offset;
+    foreach_feature<R, negated_feature<R, T> >(all, subtrahend, dat);
+    subtrahend.ft_offset = offset;
+  }
+  else if (all.weights.sparse)
+    foreach_feature<R, T, sparse_parameters>(
+        all.weights.sparse_weights, subtrahend.expanded_features, dat, ec.ft_offset, -1.f);
+  else
+    foreach_feature<R, T, dense_parameters>(
+        all.weights.dense_weights, subtrahend.expanded_features, dat, ec.ft_offset, -1.f);
+}
+
+template <bool sqrt_rate, bool feature_mask_off, bool planar, size_t adaptive, size_t normalized, size_t spare>
 void train(gd& g, example& ec, float update)
 {
   if VW_STD17_CONSTEXPR (normalized != 0) { update *= g.update_multiplier; }
-  foreach_feature<float, update_feature<sqrt_rate, feature_mask_off, adaptive, normalized, spare> >(*g.all, ec, update);
+  update_data d = {update, g.all->weights.slot_distance(), lazy_state_of(g), minibatch_of(g)};
+  walk_features<update_data, update_feature<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare> >(
+      g, ec, d);
 }
 
 void end_pass(gd& g)
 {
   vw& all = *g.all;
-  if (all.save_resume)
+  apply_minibatch(g);
+  // Lazy regularization is not part of the state saved, so the weights are synced instead.
+  if (all.save_resume && !g.lazy)
   {
     // TODO work out a better system to update state that will be saved in the model.
     if (all.sd->gravity != 0.)
@@ -155,7 +314,7 @@ void end_pass(gd& g)
     }
   }
   else
-    sync_weights(all);
+    sync_weights(g);
   if (all.all_reduce != nullptr)
   {
     if (all.weights.adaptive)
@@ -163,6 +322,7 @@ void end_pass(gd& g)
     else
       accumulate_avg(all, all.weights, 0);
   }
+  if (all.parameter_server != nullptr) all.parameter_server->sync(all, true);
   all.eta *= all.eta_decay_rate;
   if (all.save_per_pass) save_predictor(all, all.final_regressor_name, all.current_pass);
 
@@ -234,7 +394,7 @@ inline void audit_feature(audit_results& dat, const float ft_weight, const uint6
                << trunc_weight(weights[index], (float)dat.all.sd->gravity) * (float)dat.all.sd->contraction;
 
     if (weights.adaptive)  // adaptive
-      tempstream << '@' << (&weights[index])[1];
+      tempstream << '@' << (&weights[index])[weights.slot_distance()];
 
     string_value sv = {weights[index] * ft_weight, ns_pre + tempstream.str()};
     dat.results.push_back(sv);
@@ -353,12 +513,49 @@ inline void vec_add_print(float& p, const float fx, float& fw)
   std::cerr << " + " << fw << "*" << fx;
 }
 
+// Predicts the linear terms of the shared features once for every action of a multi_ex, see shared_linear_terms. The
+// features of each action are followed in their namespace by those of the shared example, other than the constant.
+template <class W>
+float factored_predict(vw& all, W& weights, example& ec, shared_linear_terms& terms)
+{
+  const uint64_t offset = ec.ft_offset;
+  example& shared = *terms.shared;
+  if (!terms.predicted || terms.ft_offset != offset)
+  {
+    terms.prediction = 0.f;
+    for (auto i = shared.begin(); i != shared.end(); ++i)
+    {
+      if (i.index() == constant_namespace || (all.ignore_some_linear && all.ignore_linear[i.index()])) continue;
+      foreach_feature<float, vec_add, W>(weights, *i, terms.prediction, offset);
+    }
+    terms.ft_offset = offset;
+    terms.predicted = true;
+  }
+
+  float prediction = ec.l.simple.initial + terms.prediction;
+  for (auto i = ec.begin(); i != ec.end(); ++i)
+  {
+    if (all.ignore_some_linear && all.ignore_linear[i.index()]) continue;
+    features& fs = *i;
+    auto end = fs.end();
+    if (i.index() != constant_namespace) end = fs.begin() + (fs.size() - shared.feature_space[i.index()].size());
+    for (auto f = fs.begin(); f != end; ++f) prediction += weights[f.index() + offset] * f.value();
+  }
+  generate_interactions<float, const float&, vec_add, W>(
+      INTERACTIONS::active_interactions(all, *ec.interactions, ec), all.permutations, ec, prediction, weights);
+  return prediction;
+}
+
 template <bool l1, bool audit>
 void predict(gd& g, base_learner&, example& ec)
 {
   vw& all = *g.all;
   if (l1)
     ec.partial_prediction = trunc_predict(all, ec, all.sd->gravity);
+  else if (ec.shared_terms != nullptr)
+    ec.partial_prediction = all.weights.sparse
+        ? factored_predict(all, all.weights.sparse_weights, ec, *ec.shared_terms)
+        : factored_predict(all, all.weights.dense_weights, ec, *ec.shared_terms);
   else
     ec.partial_prediction = inline_predict(all, ec);
 
@@ -367,6 +564,31 @@ void predict(gd& g, base_learner&, example& ec)
   if (audit) print_audit_features(all, ec);
 }
 
+struct lazy_predict_data
+{
+  float prediction;
+  uint64_t slot_distance;
+  lazy_state lazy;
+};
+
+inline void vec_add_lazy(lazy_predict_data& p, const float fx, const float& fw)
+{
+  const weight_slots<true> w = {const_cast<weight*>(&fw), p.slot_distance};
+  p.prediction += lazy_weight(w, p.lazy) * fx;
+}
+
+// Predicts from the weights with the regularization which is yet to be applied to them, see lazy_state.
+template <bool audit>
+void lazy_predict(gd& g, base_learner&, example& ec)
+{
+  vw& all = *g.all;
+  lazy_predict_data p = {ec.l.simple.initial, all.weights.slot_distance(), lazy_state_of(g)};
+  foreach_feature<lazy_predict_data, vec_add_lazy>(all, ec, p);
+  ec.partial_prediction = p.prediction;
+  ec.pred.scalar = finalize_prediction(all.sd, all.logger, ec.partial_prediction);
+  if (audit) print_audit_features(all, ec);
+}
+
 template <class T>
 inline void vec_add_trunc_multipredict(multipredict_info<T>& mp, const float fx, uint64_t fi)
 {
@@ -420,10 +642,9 @@ struct power_data
   float neg_norm_power;
 };
 
-template <bool sqrt_rate, size_t adaptive, size_t normalized>
-inline float compute_rate_decay(power_data& s, float& fw)
+template <bool sqrt_rate, bool planar, size_t adaptive, size_t normalized>
+inline float compute_rate_decay(power_data& s, const weight_slots<planar>& w)
 {
-  weight* w = &fw;
   float rate_decay = 1.f;
   if (adaptive)
   {
@@ -455,19 +676,21 @@ struct norm_data
   float norm_x;
   power_data pd;
   float extra_state[4];
+  uint64_t slot_distance;
 };
 
 constexpr float x_min = 1.084202e-19f;
 constexpr float x2_min = x_min * x_min;
 constexpr float x2_max = FLT_MAX;
 
-template <bool sqrt_rate, bool feature_mask_off, size_t adaptive, size_t normalized, size_t spare, bool stateless>
+template <bool sqrt_rate, bool feature_mask_off, bool planar, size_t adaptive, size_t normalized, size_t spare,
+    bool stateless>
 inline void pred_per_update_feature(norm_data& nd, float x, float& fw)
 {
   bool modify = feature_mask_off || fw != 0.;
   if (modify)
   {
-    weight* w = &fw;
+    weight_slots<planar> w = {&fw, nd.slot_distance};
     float x2 = x * x;
     if (x2 < x2_min)
     {
@@ -479,7 +702,7 @@ inline void pred_per_update_feature(norm_data& nd, float x, float& fw)
       nd.extra_state[0] = w[0];
       nd.extra_state[adaptive] = w[adaptive];
       nd.extra_state[normalized] = w[normalized];
-      w = nd.extra_state;
+      w = {nd.extra_state, 1};
     }
     if (adaptive) w[adaptive] += nd.grad_squared * x2;
     if VW_STD17_CONSTEXPR (normalized != 0)
@@ -511,14 +734,14 @@ inline void pred_per_update_feature(norm_data& nd, float x, float& fw)
       }
       nd.norm_x += norm_x2;
     }
-    w[spare] = compute_rate_decay<sqrt_rate, adaptive, normalized>(nd.pd, w[0]);
+    w[spare] = compute_rate_decay<sqrt_rate, planar, adaptive, normalized>(nd.pd, w);
     nd.pred_per_update += x2 * w[spare];
   }
 }
 
 bool global_print_features = false;
-template <bool sqrt_rate, bool feature_mask_off, bool adax, size_t adaptive, size_t normalized, size_t spare,
-    bool stateless>
+template <bool sqrt_rate, bool feature_mask_off, bool adax, bool planar, size_t adaptive, size_t normalized,
+    size_t spare, bool stateless>
 float get_pred_per_update(gd& g, example& ec)
 {
   // We must traverse the features in _precisely_ the same order as during training.
@@ -530,9 +753,10 @@ float get_pred_per_update(gd& g, example& ec)
 
   if (grad_squared == 0 && !stateless) return 1.;
 
-  norm_data nd = {grad_squared, 0., 0., {g.neg_power_t, g.neg_norm_power}, {0}};
-  foreach_feature<norm_data,
-      pred_per_update_feature<sqrt_rate, feature_mask_off, adaptive, normalized, spare, stateless> >(all, ec, nd);
+  norm_data nd = {grad_squared, 0., 0., {g.neg_power_t, g.neg_norm_power}, {0}, all.weights.slot_distance()};
+  walk_features<norm_data,
+      pred_per_update_feature<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare, stateless> >(
+      g, ec, nd);
   if VW_STD17_CONSTEXPR (normalized != 0)
   {
     if (!stateless)
@@ -553,12 +777,58 @@ float get_pred_per_update(gd& g, example& ec)
   return nd.pred_per_update;
 }
 
-template <bool sqrt_rate, bool feature_mask_off, bool adax, size_t adaptive, size_t normalized, size_t spare,
-    bool stateless>
+// The pred_per_update of a pair of labels, in a single pass over the features. The normalizers do not depend on the
+// label, so that both labels share norm_x and the update multiplier.
+struct paired_norm_data
+{
+  norm_data first;
+  norm_data second;
+};
+
+template <bool sqrt_rate, bool feature_mask_off, bool planar, size_t adaptive, size_t normalized, size_t spare>
+inline void paired_pred_per_update_feature(paired_norm_data& nd, float x, float& fw)
+{
+  pred_per_update_feature<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare, true>(nd.first, x, fw);
+  pred_per_update_feature<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare, true>(nd.second, x, fw);
+}
+
+template <bool sqrt_rate, bool feature_mask_off, bool adax, bool planar, size_t adaptive, size_t normalized,
+    size_t spare>
+void get_paired_pred_per_update(gd& g, example& ec, float first_label, float second_label, float* pred_per_update)
+{
+  vw& all = *g.all;
+  float first_grad_squared = ec.weight;
+  float second_grad_squared = ec.weight;
+  if (!adax)
+  {
+    first_grad_squared *= all.loss->getSquareGrad(ec.pred.scalar, first_label);
+    second_grad_squared *= all.loss->getSquareGrad(ec.pred.scalar, second_label);
+  }
+
+  paired_norm_data nd = {
+      {first_grad_squared, 0., 0., {g.neg_power_t, g.neg_norm_power}, {0}, all.weights.slot_distance()},
+      {second_grad_squared, 0., 0., {g.neg_power_t, g.neg_norm_power}, {0}, all.weights.slot_distance()}};
+  walk_features<paired_norm_data,
+      paired_pred_per_update_feature<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare> >(g, ec, nd);
+  if VW_STD17_CONSTEXPR (normalized != 0)
+  {
+    float nsnx = ((float)g.all->normalized_sum_norm_x) + ec.weight * nd.first.norm_x;
+    float tw = (float)g.total_weight + ec.weight;
+    g.update_multiplier = average_update<sqrt_rate, adaptive, normalized>(tw, nsnx, g.neg_norm_power);
+    nd.first.pred_per_update *= g.update_multiplier;
+    nd.second.pred_per_update *= g.update_multiplier;
+  }
+  pred_per_update[0] = nd.first.pred_per_update;
+  pred_per_update[1] = nd.second.pred_per_update;
+}
+
+template <bool sqrt_rate, bool feature_mask_off, bool adax, bool planar, size_t adaptive, size_t normalized,
+    size_t spare, bool stateless>
 float sensitivity(gd& g, example& ec)
 {
   if VW_STD17_CONSTEXPR (adaptive || normalized)
-    return get_pred_per_update<sqrt_rate, feature_mask_off, adax, adaptive, normalized, spare, stateless>(g, ec);
+    return get_pred_per_update<sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare, stateless>(
+        g, ec);
   else
   {
     _UNUSED(g);
@@ -580,15 +850,97 @@ float get_scale(gd& g, example& /* ec */, float weight)
   return update_scale;
 }
 
-template <bool sqrt_rate, bool feature_mask_off, bool adax, size_t adaptive, size_t normalized, size_t spare>
+template <bool sqrt_rate, bool feature_mask_off, bool adax, bool planar, size_t adaptive, size_t normalized,
+    size_t spare>
 float sensitivity(gd& g, base_learner& /* base */, example& ec)
 {
   return get_scale<adaptive>(g, ec, 1.) *
-      sensitivity<sqrt_rate, feature_mask_off, adax, adaptive, normalized, spare, true>(g, ec);
+      sensitivity<sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare, true>(g, ec);
+}
+
+// Same as sensitivity for each label, walking the features once for every pair of labels.
+template <bool sqrt_rate, bool feature_mask_off, bool adax, bool planar, size_t adaptive, size_t normalized,
+    size_t spare>
+void multi_sensitivity(
+    gd& g, base_learner& /* base */, example& ec, const float* labels, size_t count, float* sensitivities)
+{
+  const float scale = get_scale<adaptive>(g, ec, 1.);
+  if VW_STD17_CONSTEXPR (adaptive || normalized)
+  {
+    const float label = ec.l.simple.label;
+    size_t c = 0;
+    for (; c + 1 < count; c += 2)
+    {
+      get_paired_pred_per_update<sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare>(
+          g, ec, labels[c], labels[c + 1], sensitivities + c);
+      sensitivities[c] *= scale;
+      sensitivities[c + 1] *= scale;
+    }
+    if (c < count)
+    {
+      ec.l.simple.label = labels[c];
+      sensitivities[c] =
+          scale * get_pred_per_update<sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare, true>(
+                      g, ec);
+      ec.l.simple.label = label;
+    }
+  }
+  else
+    std::fill(sensitivities, sensitivities + count, scale * ec.total_sum_feat_sq);
+}
+
+// The prediction gathered along the walk which finds the pred_per_update. Only the updates scaled by --adax alone have a
+// pred_per_update which does not depend on the prediction, the others walk the features again once it is known.
+struct predict_norm_data
+{
+  float prediction;
+  norm_data nd;
+};
+
+template <bool sqrt_rate, bool feature_mask_off, bool planar, size_t adaptive, size_t normalized, size_t spare>
+inline void predict_pred_per_update_feature(predict_norm_data& d, float x, float& fw)
+{
+  d.prediction += fw * x;
+  pred_per_update_feature<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare, true>(d.nd, x, fw);
+}
+
+template <bool sqrt_rate, bool feature_mask_off, bool adax, bool planar, size_t adaptive, size_t normalized,
+    size_t spare>
+float predict_with_sensitivity(gd& g, base_learner& base, example& ec)
+{
+  vw& all = *g.all;
+  if VW_STD17_CONSTEXPR (adax && (adaptive || normalized))
+  {
+    if (g.predict == predict<false, false>)
+    {
+      predict_norm_data d = {ec.l.simple.initial,
+          {ec.weight, 0., 0., {g.neg_power_t, g.neg_norm_power}, {0}, all.weights.slot_distance()}};
+      walk_features<predict_norm_data,
+          predict_pred_per_update_feature<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare> >(
+          g, ec, d);
+      ec.partial_prediction = d.prediction * (float)all.sd->contraction;
+      ec.pred.scalar = finalize_prediction(all.sd, all.logger, ec.partial_prediction);
+      if VW_STD17_CONSTEXPR (normalized != 0)
+      {
+        float nsnx = ((float)all.normalized_sum_norm_x) + ec.weight * d.nd.norm_x;
+        float tw = (float)g.total_weight + ec.weight;
+        g.update_multiplier = average_update<sqrt_rate, adaptive, normalized>(tw, nsnx, g.neg_norm_power);
+        d.nd.pred_per_update *= g.update_multiplier;
+      }
+      return get_scale<adaptive>(g, ec, 1.) * d.nd.pred_per_update;
+    }
+  }
+
+  g.predict(g, base, ec);
+  const float label = ec.l.simple.label;
+  ec.l.simple.label = sensitivity_label(ec);
+  const float ret = sensitivity<sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare>(g, base, ec);
+  ec.l.simple.label = label;
+  return ret;
 }
 
-template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, size_t adaptive,
-    size_t normalized, size_t spare>
+template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, bool planar,
+    size_t adaptive, size_t normalized, size_t spare>
 float compute_update(gd& g, example& ec)
 {
   // invariant: not a test label, importance weight > 0
@@ -599,7 +951,8 @@ float compute_update(gd& g, example& ec)
   ec.updated_prediction = ec.pred.scalar;
   if (all.loss->getLoss(all.sd, ec.pred.scalar, ld.label) > 0.)
   {
-    float pred_per_update = sensitivity<sqrt_rate, feature_mask_off, adax, adaptive, normalized, spare, false>(g, ec);
+    float pred_per_update =
+        sensitivity<sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare, false>(g, ec);
     float update_scale = get_scale<adaptive>(g, ec, ec.weight);
     if (invariant)
       update = all.loss->getUpdate(ec.pred.scalar, ld.label, update_scale, pred_per_update);
@@ -613,7 +966,8 @@ float compute_update(gd& g, example& ec)
       double dev1 = all.loss->first_derivative(all.sd, ec.pred.scalar, ld.label);
       double eta_bar = (fabs(dev1) > 1e-8) ? (-update / dev1) : 0.0;
       if (fabs(dev1) > 1e-8) all.sd->contraction *= (1. - all.l2_lambda * eta_bar);
-      update /= (float)all.sd->contraction;
+      // Lazily regularized weights are scaled when the update is applied to them.
+      if (!g.lazy) update /= (float)all.sd->contraction;
       all.sd->gravity += eta_bar * all.l1_lambda;
     }
   }
@@ -629,38 +983,313 @@ float compute_update(gd& g, example& ec)
   return update;
 }
 
-template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, size_t adaptive,
-    size_t normalized, size_t spare>
+template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, bool planar,
+    size_t adaptive, size_t normalized, size_t spare>
 void update(gd& g, base_learner&, example& ec)
 {
   // invariant: not a test label, importance weight > 0
   float update;
-  if ((update = compute_update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, adaptive, normalized, spare>(
-           g, ec)) != 0.)
-    train<sqrt_rate, feature_mask_off, adaptive, normalized, spare>(g, ec, update);
+  if ((update = compute_update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized,
+           spare>(g, ec)) != 0.)
+    train<sqrt_rate, feature_mask_off, planar, adaptive, normalized, spare>(g, ec, update);
+  if (g.minibatch > 1 && ++g.minibatch_examples == g.minibatch) apply_minibatch(g);
+  if (ec.shared_terms != nullptr) ec.shared_terms->predicted = false;
+
+  // updating weights now to avoid numerical instability
+  if (g.all->sd->contraction < (g.lazy ? 1e-30 : 1e-9) || g.all->sd->gravity > 1e3) sync_weights(g);
+}
+
+inline void gather_feature(features& fs, float x, uint64_t index) { fs.push_back(x, index); }
+
+inline uint64_t mix_expansion_key(uint64_t key, uint64_t word) { return (key ^ word) * 0x100000001b3; }
+
+// Identifies the features of ec along with its interactions, so that the expanded features are gathered again once a
+// reduction adds, removes or changes some. It reads each feature once, where gathering generates every interaction.
+uint64_t expansion_key(example& ec)
+{
+  uint64_t key = mix_expansion_key(0xcbf29ce484222325, reinterpret_cast<uint64_t>(ec.interactions));
+  key = mix_expansion_key(key, ec.interactions->size());
+  for (features& fs : ec)
+  {
+    key = mix_expansion_key(key, fs.size());
+    for (auto f = fs.begin(); f != fs.end(); ++f)
+    {
+      uint32_t value;
+      memcpy(&value, &f.value(), sizeof(value));
+      key = mix_expansion_key(mix_expansion_key(key, f.index()), value);
+    }
+  }
+  return key == 0 ? 1 : key;
+}
+
+// Gathers the features and interactions of ec into its expanded_features, unless they are there already, such as when
+// a reduction learns several models from ec at other offsets. The indices are relative to ft_offset.
+void expand_features(vw& all, example& ec)
+{
+  const uint64_t key = expansion_key(ec);
+  if (ec.expansion_key == key) return;
+  const uint64_t offset = ec.ft_offset;
+  ec.ft_offset = 0;
+  ec.expanded_features.clear();
+  foreach_feature<features, uint64_t, gather_feature>(all, ec, ec.expanded_features);
+  ec.ft_offset = offset;
+  ec.expansion_key = key;
+}
+
+template <class W>
+struct multi_update_data
+{
+  W& weights;
+  size_t count;
+  uint64_t step;
+  const uint32_t* models;
+  const float* updates;
+  uint64_t slot_distance;
+  lazy_state lazy;
+  std::vector<minibatch_update>* minibatch;
+};
+
+// Applies the update of each model to its weight of the feature, as update_feature does for one model.
+template <class W, bool feature_mask_off, bool planar, size_t spare>
+inline void multi_update_feature(multi_update_data<W>& d, float x, uint64_t index)
+{
+  if (!(x < FLT_MAX && x > -FLT_MAX)) return;
+  for (size_t c = 0; c < d.count; c++)
+  {
+    if (d.updates[c] == 0.f) continue;
+    weight_slots<planar> w = {&d.weights[index + d.models[c] * d.step], d.slot_distance};
+    if (!feature_mask_off && w[0] == 0.f) continue;
+    const float update = d.updates[c] * (spare != 0 ? x * w[spare] : x);
+    if (d.minibatch != nullptr)
+      d.minibatch->push_back({&w[0], update});
+    else
+    {
+      if (d.lazy.slot != 0) { lazy_sync(w, d.lazy); }
+      w[0] += update;
+    }
+  }
+}
+
+template <class W, bool feature_mask_off, bool planar, size_t spare>
+void multi_train(gd& g, example& ec, W& weights, size_t count, size_t step, const uint32_t* models)
+{
+  multi_update_data<W> d = {weights, count, step, models, g.multi_updates.data(), weights.slot_distance(),
+      lazy_state_of(g), minibatch_of(g)};
+  if (!g.fused_active)
+    foreach_feature<multi_update_data<W>, uint64_t, multi_update_feature<W, feature_mask_off, planar, spare> >(
+        *g.all, ec, d);
+  else
+    foreach_feature<multi_update_data<W>, multi_update_feature<W, feature_mask_off, planar, spare>, W>(
+        weights, ec.expanded_features, d, ec.ft_offset);
+}
+
+// Updates several models of ec as update does each, computing the update of every model first and then applying them
+// all in one pass over the features, where update passes over them once per model. The models only share the state
+// of the learning rates, such as for --normalized, which is updated model after model as update would.
+template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, bool planar,
+    size_t adaptive, size_t normalized, size_t spare>
+void multiupdate(gd& g, base_learner&, example& ec, size_t count, size_t step, const uint32_t* models,
+    const float* labels, const polyprediction* pred)
+{
+  vw& all = *g.all;
+  if (g.fused)
+  {
+    expand_features(all, ec);
+    g.fused_active = true;
+  }
+  const uint64_t offset = ec.ft_offset;
+  bool any = false;
+  g.multi_updates.resize(count);
+  for (size_t c = 0; c < count; c++)
+  {
+    ec.ft_offset = offset + models[c] * step;
+    ec.l.simple.label = labels[c];
+    ec.pred.scalar = pred[c].scalar;
+    float update =
+        compute_update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare>(
+            g, ec);
+    if VW_STD17_CONSTEXPR (normalized != 0) { update *= g.update_multiplier; }
+    g.multi_updates[c] = update;
+    any |= update != 0.f;
+  }
+  ec.ft_offset = offset;
+
+  if (any)
+  {
+    if (all.weights.sparse)
+      multi_train<sparse_parameters, feature_mask_off, planar, spare>(
+          g, ec, all.weights.sparse_weights, count, step, models);
+    else
+      multi_train<dense_parameters, feature_mask_off, planar, spare>(
+          g, ec, all.weights.dense_weights, count, step, models);
+  }
+  g.fused_active = false;
+  if (g.minibatch > 1 && ++g.minibatch_examples == g.minibatch) apply_minibatch(g);
+  if (ec.shared_terms != nullptr) ec.shared_terms->predicted = false;
 
-  if (g.all->sd->contraction < 1e-9 || g.all->sd->gravity > 1e3)  // updating weights now to avoid numerical instability
-    sync_weights(*g.all);
+  // updating weights now to avoid numerical instability
+  if (all.sd->contraction < (g.lazy ? 1e-30 : 1e-9) || all.sd->gravity > 1e3) sync_weights(g);
 }
 
-template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, size_t adaptive,
-    size_t normalized, size_t spare>
+// Predicts as predict<false, false> does, from the expanded features of ec.
+void fused_predict(gd& g, base_learner&, example& ec)
+{
+  vw& all = *g.all;
+  expand_features(all, ec);
+  float prediction = ec.l.simple.initial;
+  if (all.weights.sparse)
+    foreach_feature<float, vec_add, sparse_parameters>(
+        all.weights.sparse_weights, ec.expanded_features, prediction, ec.ft_offset);
+  else
+    foreach_feature<float, vec_add, dense_parameters>(
+        all.weights.dense_weights, ec.expanded_features, prediction, ec.ft_offset);
+  ec.partial_prediction = prediction * (float)all.sd->contraction;
+  ec.pred.scalar = finalize_prediction(all.sd, all.logger, ec.partial_prediction);
+}
+
+// The prediction of the negated features of the subtrahend of learn_difference, and the sum of their squares.
+struct subtrahend_data
+{
+  float prediction;
+  float sum_feat_sq;
+};
+
+inline void vec_subtract(subtrahend_data& d, const float fx, const float& fw)
+{
+  d.prediction -= fw * fx;
+  d.sum_feat_sq += fx * fx;
+}
+
+// Learns from ec less the features of subtrahend as learn does from an example made of the features of ec followed by
+// those of subtrahend negated, in two passes over the features of each rather than gathering them, for the pairs of
+// actions of --wap_ldf. Only without l1, audit and lazy regularization, which predict otherwise.
+template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, bool planar,
+    size_t adaptive, size_t normalized, size_t spare>
+void learn_difference(gd& g, base_learner& base, example& ec, example& subtrahend)
+{
+  // invariant: not a test label, importance weight > 0
+  vw& all = *g.all;
+  float prediction;
+  subtrahend_data d = {0.f, 0.f};
+  if (g.fused)
+  {
+    expand_features(all, ec);
+    expand_features(all, subtrahend);
+    prediction = ec.l.simple.initial;
+    if (all.weights.sparse)
+    {
+      foreach_feature<float, vec_add, sparse_parameters>(
+          all.weights.sparse_weights, ec.expanded_features, prediction, ec.ft_offset);
+      foreach_feature<subtrahend_data, vec_subtract, sparse_parameters>(
+          all.weights.sparse_weights, subtrahend.expanded_features, d, ec.ft_offset);
+    }
+    else
+    {
+      foreach_feature<float, vec_add, dense_parameters>(
+          all.weights.dense_weights, ec.expanded_features, prediction, ec.ft_offset);
+      foreach_feature<subtrahend_data, vec_subtract, dense_parameters>(
+          all.weights.dense_weights, subtrahend.expanded_features, d, ec.ft_offset);
+    }
+  }
+  else
+  {
+    prediction = inline_predict(all, ec);
+    const uint64_t offset = subtrahend.ft_offset;
+    subtrahend.ft_offset = ec.ft_offset;
+    foreach_feature<subtrahend_data, vec_subtract>(all, subtrahend, d);
+    subtrahend.ft_offset = offset;
+  }
+  ec.partial_prediction = (prediction + d.prediction) * (float)all.sd->contraction;
+  ec.pred.scalar = finalize_prediction(all.sd, all.logger, ec.partial_prediction);
+
+  // The sensitivity without adaptive or normalized updates is the sum of the squares of all the features.
+  const float total_sum_feat_sq = ec.total_sum_feat_sq;
+  ec.total_sum_feat_sq += d.sum_feat_sq;
+  g.subtrahend = &subtrahend;
+  g.fused_active = g.fused;
+  update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare>(g, base, ec);
+  g.subtrahend = nullptr;
+  g.fused_active = false;
+  ec.total_sum_feat_sq = total_sum_feat_sq;
+}
+
+void predict_batch(vw& all, multi_ex& examples, VW::dense_backend& backend, VW::flat_batch& batch)
+{
+  if (all.reg_mode % 2)
+  {
+    for (example* ec : examples)
+    {
+      ec->partial_prediction = trunc_predict(all, *ec, all.sd->gravity) * (float)all.sd->contraction;
+      ec->pred.scalar = finalize_prediction(all.sd, all.logger, ec->partial_prediction);
+    }
+    return;
+  }
+  batch.clear();
+  for (example* ec : examples) batch.add(all, *ec);
+  std::vector<float> predictions(batch.size());
+  backend.predict(batch, (float)all.sd->contraction, predictions.data());
+  for (size_t e = 0; e < examples.size(); e++)
+  {
+    examples[e]->partial_prediction = predictions[e];
+    examples[e]->pred.scalar = finalize_prediction(all.sd, all.logger, predictions[e]);
+  }
+}
+
+// Predicts, then updates, from the features and interactions of ec gathered once rather than generated by each of the
+// passes over them.
+template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, bool planar,
+    size_t adaptive, size_t normalized, size_t spare>
+void fused_learn(gd& g, base_learner& base, example& ec)
+{
+  fused_predict(g, base, ec);
+  g.fused_active = true;
+  update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare>(g, base, ec);
+  g.fused_active = false;
+}
+
+template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, bool planar,
+    size_t adaptive, size_t normalized, size_t spare>
 void learn(gd& g, base_learner& base, example& ec)
 {
   // invariant: not a test label, importance weight > 0
   assert(ec.l.simple.label != FLT_MAX);
   assert(ec.weight > 0.);
-  g.predict(g, base, ec);
-  update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, adaptive, normalized, spare>(g, base, ec);
+  if (g.fused)
+    fused_learn<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare>(
+        g, base, ec);
+  // Without l1 or audit, which is most often, the prediction is called directly, so that it can be inlined.
+  else if (g.predict == predict<false, false>)
+    predict<false, false>(g, base, ec);
+  else
+    g.predict(g, base, ec);
+  update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, planar, adaptive, normalized, spare>(g, base, ec);
 }
 
-void sync_weights(vw& all)
+void sync_weights(gd& g)
 {
+  vw& all = *g.all;
+  // The updates held back were scaled by the regularization as it is now.
+  apply_minibatch(g);
   // todo, fix length dependence
   if (all.sd->gravity == 0. && all.sd->contraction == 1.)  // to avoid unnecessary weight synchronization
     return;
 
-  if (all.weights.sparse)
+  if (g.lazy)
+  {
+    const lazy_state lazy = lazy_state_of(g);
+    const uint64_t distance = all.weights.slot_distance();
+    auto sync = [&](weight& fw) {
+      const weight_slots<true> w = {&fw, distance};
+      w[0] = lazy_weight(w, lazy);
+      w[lazy.slot] = 0.f;
+      w[lazy.slot + 1] = 0.f;
+    };
+    if (all.weights.sparse)
+      for (weight& w : all.weights.sparse_weights) sync(w);
+    else
+      for (weight& w : all.weights.dense_weights) sync(w);
+  }
+  else if (all.weights.sparse)
     for (weight& w : all.weights.sparse_weights)
       w = trunc_weight(w, (float)all.sd->gravity) * (float)all.sd->contraction;
   else
@@ -689,6 +1318,89 @@ size_t write_index(io_buf& model_file, std::stringstream& msg, bool text, uint32
   return brw;
 }
 
+// Whether --prune_weights or --prune_adaptive drop a weight, given its adaptive sum of squared gradients or a negative
+// one if it is not known. Dropped weights are left out of the models written and skipped in those read, so that they
+// keep their initial value and sparse weights are not even allocated.
+inline bool pruned(const vw& all, float value, float adaptive)
+{
+  return fabsf(value) < all.prune_weights || (adaptive >= 0.f && adaptive < all.prune_adaptive);
+}
+
+// The adaptive sum of the weight w while learning with adaptive updates, see pruned. Models without --save_resume do
+// not hold them, so once such a model is loaded they are not known.
+template <class T>
+inline float adaptive_sum(const vw& all, T& weights, weight& w)
+{
+  return all.training && all.weights.adaptive ? (&w)[weights.slot_distance()] : -1.f;
+}
+
+// Appends the index and value of a non zero weight as save_load_regressor reads them.
+inline void append_weight(std::vector<char>& out, uint32_t num_bits, uint64_t i, float value)
+{
+  const size_t index_bytes = num_bits < 31 ? sizeof(uint32_t) : sizeof(uint64_t);
+  const size_t end = out.size();
+  out.resize(end + index_bytes + sizeof(value));
+  if (num_bits < 31)
+  {
+    const uint32_t old_i = (uint32_t)i;
+    memcpy(out.data() + end, &old_i, sizeof(old_i));
+  }
+  else
+    memcpy(out.data() + end, &i, sizeof(i));
+  memcpy(out.data() + end + index_bytes, &value, sizeof(value));
+}
+
+void write_regressor_binary(vw& all, io_buf& model_file, sparse_parameters& weights)
+{
+  std::vector<char> out;
+  for (auto v = weights.begin(); v != weights.end(); ++v)
+    if (*v != 0. && !pruned(all, *v, adaptive_sum(all, weights, *v)))
+    {
+      out.clear();
+      append_weight(out, all.num_bits, v.index() >> weights.stride_shift(), *v);
+      model_file.bin_write_fixed(out.data(), out.size());
+    }
+}
+
+// Dense weights are written a round at a time, in which each of the --save_threads threads appends the non zero
+// weights of a consecutive range to a buffer of its own. The buffers are written in order, so the model is the same as
+// written by one thread.
+constexpr uint64_t SAVE_THREAD_WEIGHTS = 1 << 22;  // per thread and round, which buffers at most 48MB
+constexpr size_t SAVE_WRITE_BYTES = 1 << 16;  // written at once, io_buf grows its buffer to hold a whole write
+
+void write_regressor_binary(vw& all, io_buf& model_file, dense_parameters& weights)
+{
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  size_t threads = all.save_threads != 0 ? all.save_threads : std::max(1u, std::thread::hardware_concurrency());
+  threads = (size_t)std::max<uint64_t>(1, std::min<uint64_t>(threads, length / SAVE_THREAD_WEIGHTS));
+
+  std::vector<std::vector<char>> buffers(threads);
+  auto append_range = [&](uint64_t from, uint64_t to, std::vector<char>& out) {
+    out.clear();
+    for (uint64_t i = from; i < to; i++)
+    {
+      weight& value = weights.strided_index(i);
+      if (value != 0.f && !pruned(all, value, adaptive_sum(all, weights, value)))
+        append_weight(out, all.num_bits, i, value);
+    }
+  };
+  for (uint64_t round = 0; round < length; round += threads * SAVE_THREAD_WEIGHTS)
+  {
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++)
+    {
+      const uint64_t from = std::min(length, round + t * SAVE_THREAD_WEIGHTS);
+      workers.push_back(VW::start_pinned_thread(VW::thread_role::worker, append_range, from,
+          std::min(length, from + SAVE_THREAD_WEIGHTS), std::ref(buffers[t])));
+    }
+    append_range(round, std::min(length, round + SAVE_THREAD_WEIGHTS), buffers[0]);
+    for (auto& worker : workers) worker.join();
+    for (auto& buffer : buffers)
+      for (size_t done = 0; done < buffer.size(); done += SAVE_WRITE_BYTES)
+        model_file.bin_write_fixed(buffer.data() + done, std::min(SAVE_WRITE_BYTES, buffer.size() - done));
+  }
+}
+
 template <class T>
 void save_load_regressor(vw& all, io_buf& model_file, bool read, bool text, T& weights)
 {
@@ -737,13 +1449,16 @@ void save_load_regressor(vw& all, io_buf& model_file, bool read, bool text, T& w
         if (i >= length)
           THROW("Model content is corrupted, weight vector index " << i << " must be less than total vector length "
                                                                    << length);
-        weight* v = &weights.strided_index(i);
-        brw += model_file.bin_read_fixed((char*)&(*v), sizeof(*v), "");
+        weight value;
+        brw += model_file.bin_read_fixed((char*)&value, sizeof(value), "");
+        if (!pruned(all, value, -1.f)) weights.strided_index(i) = value;
       }
     } while (brw > 0);
-  else  // write
+  else if (!text)
+    write_regressor_binary(all, model_file, weights);
+  else  // write text
     for (typename T::iterator v = weights.begin(); v != weights.end(); ++v)
-      if (*v != 0.)
+      if (*v != 0. && !pruned(all, *v, adaptive_sum(all, weights, *v)))
       {
         i = v.index() >> weights.stride_shift();
         std::stringstream msg;
@@ -762,11 +1477,536 @@ void save_load_regressor(vw& all, io_buf& model_file, bool read, bool text)
     save_load_regressor(all, model_file, read, text, all.weights.dense_weights);
 }
 
+// See array_parameters_quantized.h for the format. Quantized models are always binary.
+template <class T>
+void write_quantized_regressor(io_buf& model_file, T& weights)
+{
+  // Sparse weights are not iterated in index order.
+  std::vector<std::pair<uint64_t, float>> nonzero;
+  for (typename T::iterator v = weights.begin(); v != weights.end(); ++v)
+    if (*v != 0.f) nonzero.emplace_back(v.index() >> weights.stride_shift(), *v);
+  std::sort(nonzero.begin(), nonzero.end());
+
+  struct block
+  {
+    uint64_t index;
+    float scale;
+    std::vector<std::pair<uint8_t, int8_t>> values;
+  };
+  std::vector<block> blocks;
+  for (size_t first = 0; first < nonzero.size();)
+  {
+    const uint64_t index = nonzero[first].first >> VW::QUANTIZED_BLOCK_SHIFT;
+    size_t last = first;
+    float max_magnitude = 0.f;
+    for (; last < nonzero.size() && (nonzero[last].first >> VW::QUANTIZED_BLOCK_SHIFT) == index; last++)
+      max_magnitude = std::max(max_magnitude, std::fabs(nonzero[last].second));
+
+    block b{index, VW::quantization_scale(max_magnitude), {}};
+    for (; first < last; first++)
+    {
+      const int8_t value = VW::quantize(nonzero[first].second, b.scale);
+      if (value != 0)
+        b.values.emplace_back(static_cast<uint8_t>(nonzero[first].first & (VW::QUANTIZED_BLOCK_SIZE - 1)), value);
+    }
+    if (!b.values.empty()) blocks.push_back(std::move(b));
+  }
+
+  std::stringstream msg;
+  uint32_t block_count = static_cast<uint32_t>(blocks.size());
+  bin_text_write_fixed(model_file, (char*)&block_count, sizeof(block_count), msg, false);
+  for (auto& b : blocks)
+  {
+    uint16_t count = static_cast<uint16_t>(b.values.size());
+    bin_text_write_fixed(model_file, (char*)&b.index, sizeof(b.index), msg, false);
+    bin_text_write_fixed(model_file, (char*)&b.scale, sizeof(b.scale), msg, false);
+    bin_text_write_fixed(model_file, (char*)&count, sizeof(count), msg, false);
+    for (auto& value : b.values)
+    {
+      bin_text_write_fixed(model_file, (char*)&value.first, sizeof(value.first), msg, false);
+      bin_text_write_fixed(model_file, (char*)&value.second, sizeof(value.second), msg, false);
+    }
+  }
+}
+
+// Dequantizes the weights into full precision ones.
+template <class T>
+void read_quantized_regressor(vw& all, io_buf& model_file, T& weights)
+{
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  uint32_t block_count;
+  if (model_file.bin_read_fixed((char*)&block_count, sizeof(block_count), "") < sizeof(block_count))
+    THROW("Model content is corrupted, the quantized weights are missing");
+
+  for (uint32_t i = 0; i < block_count; i++)
+  {
+    uint64_t index;
+    float scale;
+    uint16_t count;
+    size_t brw = model_file.bin_read_fixed((char*)&index, sizeof(index), "");
+    brw += model_file.bin_read_fixed((char*)&scale, sizeof(scale), "");
+    brw += model_file.bin_read_fixed((char*)&count, sizeof(count), "");
+    if (brw < sizeof(index) + sizeof(scale) + sizeof(count)) THROW("Model content is corrupted, a block is truncated");
+    if ((index << VW::QUANTIZED_BLOCK_SHIFT) >= length)
+      THROW("Model content is corrupted, weight block " << index << " lies beyond the total vector length " << length);
+
+    for (uint16_t j = 0; j < count; j++)
+    {
+      uint8_t offset;
+      int8_t value;
+      brw = model_file.bin_read_fixed((char*)&offset, sizeof(offset), "");
+      brw += model_file.bin_read_fixed((char*)&value, sizeof(value), "");
+      if (brw < sizeof(offset) + sizeof(value)) THROW("Model content is corrupted, a block is truncated");
+      weights.strided_index((index << VW::QUANTIZED_BLOCK_SHIFT) + offset) = VW::dequantize(value, scale);
+    }
+  }
+}
+
+void save_load_quantized_regressor(vw& all, io_buf& model_file, bool read)
+{
+  if (read)
+  {
+    if (all.weights.sparse)
+      read_quantized_regressor(all, model_file, all.weights.sparse_weights);
+    else
+      read_quantized_regressor(all, model_file, all.weights.dense_weights);
+  }
+  else if (all.weights.sparse)
+    write_quantized_regressor(model_file, all.weights.sparse_weights);
+  else
+    write_quantized_regressor(model_file, all.weights.dense_weights);
+}
+
+// Models written with --write_weight_runs store their non zero weights as runs of consecutive indices, short gaps of
+// zeros included, so whole runs are copied at once when read:
+//
+//   per run: uint64 index of its first weight, uint32 weight count, count floats
+//
+// in increasing index order, up to the end of the model.
+constexpr uint64_t WEIGHT_RUN_GAP = 3;  // zeros kept in a run rather than starting a new one, which costs 12 bytes
+constexpr uint32_t WEIGHT_RUN_MAX = 1 << 24;
+constexpr size_t WEIGHT_RUN_CHUNK = 1 << 16;  // bytes read or written at once, io_buf reads at most its buffer
+
+class weight_run_writer
+{
+public:
+  explicit weight_run_writer(io_buf& model_file) : _model_file(model_file) {}
+
+  // Weights must be added in increasing index order.
+  void add(uint64_t index, float value)
+  {
+    if (!_run.empty() && (index - (_first + _run.size()) > WEIGHT_RUN_GAP || _run.size() >= WEIGHT_RUN_MAX)) flush();
+    if (_run.empty()) _first = index;
+    _run.resize(index - _first, 0.f);
+    _run.push_back(value);
+  }
+
+  void flush()
+  {
+    if (_run.empty()) return;
+    std::stringstream msg;
+    uint32_t count = static_cast<uint32_t>(_run.size());
+    bin_text_write_fixed(_model_file, (char*)&_first, sizeof(_first), msg, false);
+    bin_text_write_fixed(_model_file, (char*)&count, sizeof(count), msg, false);
+    const char* data = (const char*)_run.data();
+    for (size_t left = count * sizeof(float); left > 0;)
+    {
+      const size_t bytes = std::min(left, WEIGHT_RUN_CHUNK);
+      bin_text_write_fixed(_model_file, (char*)data, bytes, msg, false);
+      data += bytes;
+      left -= bytes;
+    }
+    _run.clear();
+  }
+
+private:
+  io_buf& _model_file;
+  uint64_t _first = 0;
+  std::vector<float> _run;
+};
+
+void write_weight_runs(vw& all, io_buf& model_file, dense_parameters& weights)
+{
+  weight_run_writer writer(model_file);
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  for (uint64_t i = 0; i < length; i++)
+  {
+    const float value = weights.strided_index(i);
+    if (value != 0.f) writer.add(i, value);
+  }
+  writer.flush();
+}
+
+void write_weight_runs(vw&, io_buf& model_file, sparse_parameters& weights)
+{
+  // Sparse weights are not iterated in index order.
+  std::vector<std::pair<uint64_t, float>> nonzero;
+  for (auto v = weights.begin(); v != weights.end(); ++v)
+    if (*v != 0.f) nonzero.emplace_back(v.index() >> weights.stride_shift(), *v);
+  std::sort(nonzero.begin(), nonzero.end());
+
+  weight_run_writer writer(model_file);
+  for (auto& weight : nonzero) writer.add(weight.first, weight.second);
+  writer.flush();
+}
+
+void read_run_bytes(io_buf& model_file, char* data, size_t bytes)
+{
+  while (bytes > 0)
+  {
+    const size_t chunk = std::min(bytes, WEIGHT_RUN_CHUNK);
+    if (model_file.bin_read_fixed(data, chunk, "") < chunk) THROW("Model content is corrupted, a run is truncated");
+    data += chunk;
+    bytes -= chunk;
+  }
+}
+
+// Dense weights without a stride are read in place, others through a buffer.
+template <class T>
+void read_weight_run(io_buf& model_file, T& weights, uint64_t first, uint32_t count, std::vector<float>& buffer)
+{
+  buffer.resize(count);
+  read_run_bytes(model_file, (char*)buffer.data(), count * sizeof(float));
+  for (uint32_t k = 0; k < count; k++) weights.strided_index(first + k) = buffer[k];
+}
+
+void read_weight_run(
+    io_buf& model_file, dense_parameters& weights, uint64_t first, uint32_t count, std::vector<float>& buffer)
+{
+  if (weights.stride_shift() != 0)
+  {
+    read_weight_run<dense_parameters>(model_file, weights, first, count, buffer);
+    return;
+  }
+  read_run_bytes(model_file, (char*)(weights.first() + first), count * sizeof(float));
+}
+
+template <class T>
+void read_weight_runs(vw& all, io_buf& model_file, T& weights)
+{
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  std::vector<float> buffer;
+  uint64_t first;
+  while (model_file.bin_read_fixed((char*)&first, sizeof(first), "") > 0)
+  {
+    uint32_t count;
+    if (model_file.bin_read_fixed((char*)&count, sizeof(count), "") < sizeof(count))
+      THROW("Model content is corrupted, a run is truncated");
+    if (first >= length || count > length - first)
+      THROW("Model content is corrupted, a run of " << count << " weights from " << first
+                                                     << " lies beyond the total vector length " << length);
+    read_weight_run(model_file, weights, first, count, buffer);
+  }
+}
+
+void save_load_weight_runs(vw& all, io_buf& model_file, bool read)
+{
+  if (read)
+  {
+    if (all.weights.sparse)
+      read_weight_runs(all, model_file, all.weights.sparse_weights);
+    else
+      read_weight_runs(all, model_file, all.weights.dense_weights);
+  }
+  else if (all.weights.sparse)
+    write_weight_runs(all, model_file, all.weights.sparse_weights);
+  else
+    write_weight_runs(all, model_file, all.weights.dense_weights);
+}
+
+// Models written with --write_weight_image hold the dense weights as one array, at an aligned offset of the file, so
+// that predicting maps them from the model file rather than reading them:
+//
+//   uint64 weight count, uint64 offset of the array in the file, uint32 count of zero bytes up to it, count floats
+//
+// The mapping is copy on write, processes predicting with the same model share its pages and those never used stay
+// on disk. Sparse weights are written as usual.
+constexpr uint64_t WEIGHT_IMAGE_ALIGNMENT = 1 << 16;  // a multiple of the page sizes in use
+
+void write_weight_image(vw& all, io_buf& model_file, dense_parameters& weights)
+{
+  std::stringstream msg;
+  uint64_t length = (uint64_t)1 << all.num_bits;
+  uint64_t offset = model_file.written_bytes_count() + sizeof(length) + sizeof(offset) + sizeof(uint32_t);
+  uint32_t padding = (uint32_t)((WEIGHT_IMAGE_ALIGNMENT - offset % WEIGHT_IMAGE_ALIGNMENT) % WEIGHT_IMAGE_ALIGNMENT);
+  offset += padding;
+  bin_text_write_fixed(model_file, (char*)&length, sizeof(length), msg, false);
+  bin_text_write_fixed(model_file, (char*)&offset, sizeof(offset), msg, false);
+  bin_text_write_fixed(model_file, (char*)&padding, sizeof(padding), msg, false);
+  std::vector<char> zeros(padding, 0);
+  bin_text_write_fixed(model_file, zeros.data(), padding, msg, false);
+
+  std::vector<float> buffer(std::min<uint64_t>(length, WEIGHT_RUN_CHUNK / sizeof(float)));
+  for (uint64_t i = 0; i < length; i += buffer.size())
+  {
+    const size_t count = (size_t)std::min<uint64_t>(buffer.size(), length - i);
+    for (size_t k = 0; k < count; k++) buffer[k] = weights.strided_index(i + k);
+    bin_text_write_fixed(model_file, (char*)buffer.data(), count * sizeof(float), msg, false);
+  }
+}
+
+template <class T>
+void read_weight_image_bytes(io_buf& model_file, T& weights, uint64_t length)
+{
+  std::vector<float> buffer(std::min<uint64_t>(length, WEIGHT_RUN_CHUNK / sizeof(float)));
+  for (uint64_t i = 0; i < length; i += buffer.size())
+  {
+    const size_t count = (size_t)std::min<uint64_t>(buffer.size(), length - i);
+    read_run_bytes(model_file, (char*)buffer.data(), count * sizeof(float));
+    for (size_t k = 0; k < count; k++) weights.strided_index(i + k) = buffer[k];
+  }
+}
+
+void read_weight_image_bytes(io_buf& model_file, dense_parameters& weights, uint64_t length)
+{
+  if (weights.stride_shift() != 0)
+  {
+    read_weight_image_bytes<dense_parameters>(model_file, weights, length);
+    return;
+  }
+  read_run_bytes(model_file, (char*)weights.first(), length * sizeof(float));
+}
+
+// Predicting, dense weights without a stride are mapped from the model file when it is a regular file read as is.
+bool map_weight_image(vw& all, io_buf& model_file, dense_parameters& weights, uint64_t length, uint64_t offset)
+{
+  if (all.training || weights.stride_shift() != 0 || weights.planes_shift() != 0 ||
+      model_file.current >= model_file.num_input_files())
+    return false;
+  const size_t bytes = length * sizeof(float);
+  char* mapped = model_file.input_files[model_file.current]->map(offset, bytes);
+  if (mapped == nullptr) return false;
+  weights.use_mapped_memory((weight*)mapped, bytes);
+  model_file.seek_file(model_file.current, offset + bytes);
+  if (!all.logger.quiet) all.trace_message << "weights mapped from the model file" << std::endl;
+  return true;
+}
+
+bool map_weight_image(vw&, io_buf&, sparse_parameters&, uint64_t, uint64_t) { return false; }
+
+template <class T>
+void read_weight_image(vw& all, io_buf& model_file, T& weights)
+{
+  uint64_t length;
+  uint64_t offset;
+  uint32_t padding;
+  if (model_file.bin_read_fixed((char*)&length, sizeof(length), "") < sizeof(length) ||
+      model_file.bin_read_fixed((char*)&offset, sizeof(offset), "") < sizeof(offset) ||
+      model_file.bin_read_fixed((char*)&padding, sizeof(padding), "") < sizeof(padding))
+    THROW("Model content is corrupted, the weight image is truncated");
+  if (length != (uint64_t)1 << all.num_bits)
+    THROW("Model content is corrupted, the weight image holds " << length << " weights rather than the total vector length "
+                                                                << ((uint64_t)1 << all.num_bits));
+  if (map_weight_image(all, model_file, weights, length, offset)) return;
+
+  std::vector<char> zeros(padding);
+  read_run_bytes(model_file, zeros.data(), padding);
+  read_weight_image_bytes(model_file, weights, length);
+}
+
+void save_load_weight_image(vw& all, io_buf& model_file, bool read)
+{
+  if (!read)
+    write_weight_image(all, model_file, all.weights.dense_weights);
+  else if (all.weights.sparse)
+    read_weight_image(all, model_file, all.weights.sparse_weights);
+  else
+    read_weight_image(all, model_file, all.weights.dense_weights);
+}
+
+// Resumable models written with --write_resume_columns hold the state of the weights in blocks of consecutive rows,
+// each block holding the weights of its rows, then their adaptive sums, then their normalizers, column after column:
+//
+//   uint32 column count, then per block: uint64 index of its first row, uint32 row count, uint64 offset of the end of
+//   the block in the file, count floats per column
+//
+// in increasing index order, up to the end of the model. Rows of zeros are kept within a block as they are within
+// weight runs. Predicting reads the weights alone, seeking past the rest of the state of large blocks where the model
+// file allows it, and columns of like values compress better than rows with --compressed.
+constexpr uint32_t RESUME_BLOCK_ROWS = 1 << 16;
+constexpr size_t RESUME_SEEK_BYTES = 1 << 20;  // of state skipped, below which it is read rather than sought past
+
+void write_run_bytes(io_buf& model_file, const char* data, size_t bytes)
+{
+  std::stringstream msg;
+  while (bytes > 0)
+  {
+    const size_t chunk = std::min(bytes, WEIGHT_RUN_CHUNK);
+    bin_text_write_fixed(model_file, (char*)data, chunk, msg, false);
+    data += chunk;
+    bytes -= chunk;
+  }
+}
+
+class resume_block_writer
+{
+public:
+  resume_block_writer(io_buf& model_file, uint32_t columns) : _model_file(model_file), _columns(columns) {}
+
+  // Rows must be added in increasing index order.
+  void add(uint64_t index, const weight* row)
+  {
+    if (_rows > 0 && (index - (_first + _rows) > WEIGHT_RUN_GAP || _rows >= RESUME_BLOCK_ROWS)) flush();
+    if (_rows == 0) _first = index;
+    for (; _first + _rows < index; _rows++)
+      for (uint32_t c = 0; c < _columns; c++) _block[c].push_back(0.f);
+    for (uint32_t c = 0; c < _columns; c++) _block[c].push_back(row[c]);
+    _rows++;
+  }
+
+  void flush()
+  {
+    if (_rows == 0) return;
+    std::stringstream msg;
+    uint32_t count = _rows;
+    uint64_t end = _model_file.written_bytes_count() + sizeof(_first) + sizeof(count) + sizeof(end) +
+        (uint64_t)_columns * count * sizeof(float);
+    bin_text_write_fixed(_model_file, (char*)&_first, sizeof(_first), msg, false);
+    bin_text_write_fixed(_model_file, (char*)&count, sizeof(count), msg, false);
+    bin_text_write_fixed(_model_file, (char*)&end, sizeof(end), msg, false);
+    for (uint32_t c = 0; c < _columns; c++)
+    {
+      write_run_bytes(_model_file, (const char*)_block[c].data(), count * sizeof(float));
+      _block[c].clear();
+    }
+    _rows = 0;
+  }
+
+private:
+  io_buf& _model_file;
+  const uint32_t _columns;
+  uint64_t _first = 0;
+  uint32_t _rows = 0;
+  std::vector<float> _block[3];
+};
+
+// The number of columns of state of the weights, as save_load_online_state writes it.
+uint32_t resume_columns(const vw& all) { return 1 + (all.weights.adaptive ? 1 : 0) + (all.weights.normalized ? 1 : 0); }
+
+// Gathers the state of the weight w in the order it is written, from its planes if need be, into row. Returns whether
+// it is worth writing.
+template <class T>
+bool resume_row(vw& all, T& weights, weight& w, uint32_t columns, weight row[3])
+{
+  const uint64_t distance = weights.slot_distance();
+  bool nonzero = false;
+  for (uint32_t c = 0; c < columns; c++)
+  {
+    row[c] = (&w)[c * distance];
+    nonzero = nonzero || row[c] != 0.f;
+  }
+  return nonzero && !pruned(all, row[0], all.weights.adaptive ? row[1] : -1.f);
+}
+
+void write_resume_columns(vw& all, io_buf& model_file, dense_parameters& weights)
+{
+  uint32_t columns = resume_columns(all);
+  std::stringstream msg;
+  bin_text_write_fixed(model_file, (char*)&columns, sizeof(columns), msg, false);
+  resume_block_writer writer(model_file, columns);
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  weight row[3];
+  for (uint64_t i = 0; i < length; i++)
+    if (resume_row(all, weights, weights.strided_index(i), columns, row)) writer.add(i, row);
+  writer.flush();
+}
+
+void write_resume_columns(vw& all, io_buf& model_file, sparse_parameters& weights)
+{
+  uint32_t columns = resume_columns(all);
+  std::stringstream msg;
+  bin_text_write_fixed(model_file, (char*)&columns, sizeof(columns), msg, false);
+  // Sparse weights are not iterated in index order.
+  std::vector<std::pair<uint64_t, std::array<weight, 3>>> rows;
+  std::array<weight, 3> row;
+  for (auto v = weights.begin(); v != weights.end(); ++v)
+    if (resume_row(all, weights, *v, columns, row.data())) rows.emplace_back(v.index() >> weights.stride_shift(), row);
+  std::sort(rows.begin(), rows.end(),
+      [](const std::pair<uint64_t, std::array<weight, 3>>& a, const std::pair<uint64_t, std::array<weight, 3>>& b) {
+        return a.first < b.first;
+      });
+
+  resume_block_writer writer(model_file, columns);
+  for (auto& r : rows) writer.add(r.first, r.second.data());
+  writer.flush();
+}
+
+// Skips bytes of the model which end at end in the file, seeking past them when they are many and the file allows it.
+void skip_run_bytes(io_buf& model_file, uint64_t end, size_t bytes, std::vector<float>& buffer)
+{
+  if (bytes >= RESUME_SEEK_BYTES && model_file.current < model_file.num_input_files() &&
+      model_file.seek_file(model_file.current, end))
+    return;
+  buffer.resize(WEIGHT_RUN_CHUNK / sizeof(float));
+  for (size_t chunk; bytes > 0; bytes -= chunk)
+  {
+    chunk = std::min(bytes, WEIGHT_RUN_CHUNK);
+    read_run_bytes(model_file, (char*)buffer.data(), chunk);
+  }
+}
+
+template <class T>
+void read_resume_columns(vw& all, io_buf& model_file, gd& g, T& weights)
+{
+  const uint32_t expected = 1 + (g.adaptive_input ? 1 : 0) + (g.normalized_input ? 1 : 0);
+  uint32_t columns;
+  if (model_file.bin_read_fixed((char*)&columns, sizeof(columns), "") < sizeof(columns))
+    THROW("Model content is corrupted, the state of its weights is truncated");
+  if (columns != expected)
+    THROW("Model content is corrupted, the state of its weights has " << columns << " columns rather than "
+                                                                      << expected);
+  // Predicting needs the weights alone, unless the model is saved again with its state.
+  const bool weights_only = !all.training && !all.save_resume;
+  const uint32_t read_columns = weights_only ? 1 : columns;
+
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  const uint64_t distance = weights.slot_distance();
+  std::vector<float> block;
+  std::vector<float> skipped;
+  uint64_t first;
+  while (model_file.bin_read_fixed((char*)&first, sizeof(first), "") > 0)
+  {
+    uint32_t count;
+    uint64_t end;
+    if (model_file.bin_read_fixed((char*)&count, sizeof(count), "") < sizeof(count) ||
+        model_file.bin_read_fixed((char*)&end, sizeof(end), "") < sizeof(end))
+      THROW("Model content is corrupted, a block of state is truncated");
+    if (first >= length || count > length - first)
+      THROW("Model content is corrupted, a block of " << count << " weights from " << first
+                                                       << " lies beyond the total vector length " << length);
+    block.resize((size_t)read_columns * count);
+    read_run_bytes(model_file, (char*)block.data(), block.size() * sizeof(float));
+    if (weights_only) skip_run_bytes(model_file, end, (size_t)(columns - 1) * count * sizeof(float), skipped);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+      const float value = block[k];
+      // Rows of zeros keep their initial state, as the rows left out of models written row by row do.
+      bool nonzero = value != 0.f;
+      for (uint32_t c = 1; c < read_columns; c++) nonzero = nonzero || block[(size_t)c * count + k] != 0.f;
+      if (!nonzero || pruned(all, value, read_columns > 1 && g.adaptive_input ? block[count + k] : -1.f)) continue;
+      weight* v = &weights.strided_index(first + k);
+      if (weights_only)
+        *v = value;
+      else
+        for (size_t j = 0; j < weights.slots(); j++) v[j * distance] = j < columns ? block[j * count + k] : 0.f;
+    }
+  }
+}
+
 template <class T>
 void save_load_online_state(
     vw& all, io_buf& model_file, bool read, bool text, gd* g, std::stringstream& msg, uint32_t ftrl_size, T& weights)
 {
   uint64_t length = (uint64_t)1 << all.num_bits;
+  if (g != nullptr && ftrl_size == 0 && !text && (read ? g->resume_columns_model : all.write_resume_columns))
+  {
+    if (read)
+      read_resume_columns(all, model_file, *g, weights);
+    else
+      write_resume_columns(all, model_file, weights);
+    return;
+  }
 
   uint64_t i = 0;
   uint32_t old_i = 0;
@@ -796,15 +2036,22 @@ void save_load_online_state(
           brw += model_file.bin_read_fixed((char*)buff, sizeof(buff[0]) * 2, "");
         else  // adaptive and normalized
           brw += model_file.bin_read_fixed((char*)buff, sizeof(buff[0]) * 3, "");
-        uint32_t stride = 1 << weights.stride_shift();
+        if (pruned(all, buff[0], ftrl_size == 0 && g != nullptr && g->adaptive_input ? buff[1] : -1.f)) continue;
+        const uint64_t distance = weights.slot_distance();
         weight* v = &weights.strided_index(i);
-        for (size_t j = 0; j < stride; j++) v[j] = buff[j];
+        for (size_t j = 0; j < weights.slots(); j++) v[j * distance] = buff[j];
       }
     } while (brw > 0);
   else  // write binary or text
     for (typename T::iterator v = weights.begin(); v != weights.end(); ++v)
     {
       i = v.index() >> weights.stride_shift();
+      // The state of the weight in the order it is written, gathered from its planes if need be.
+      const uint64_t distance = weights.slot_distance();
+      weight state[3] = {*v, 0, 0};
+      if (g != nullptr && ftrl_size == 0)
+        for (size_t j = 1; j < 3 && j < weights.slots(); j++) state[j] = (&(*v))[j * distance];
+      if (pruned(all, *v, ftrl_size == 0 && g != nullptr && all.weights.adaptive ? state[1] : -1.f)) continue;
 
       if (ftrl_size == 3)
       {
@@ -841,27 +2088,27 @@ void save_load_online_state(
         {
           brw = write_index(model_file, msg, text, all.num_bits, i);
           msg << ":" << *v << "\n";
-          brw += bin_text_write_fixed(model_file, (char*)&(*v), sizeof(*v), msg, text);
+          brw += bin_text_write_fixed(model_file, (char*)state, sizeof(*v), msg, text);
         }
       }
       else if ((all.weights.adaptive && !all.weights.normalized) || (!all.weights.adaptive && all.weights.normalized))
       {
         // either adaptive or normalized
-        if (*v != 0. || (&(*v))[1] != 0.)
+        if (state[0] != 0. || state[1] != 0.)
         {
           brw = write_index(model_file, msg, text, all.num_bits, i);
-          msg << ":" << *v << " " << (&(*v))[1] << "\n";
-          brw += bin_text_write_fixed(model_file, (char*)&(*v), 2 * sizeof(*v), msg, text);
+          msg << ":" << state[0] << " " << state[1] << "\n";
+          brw += bin_text_write_fixed(model_file, (char*)state, 2 * sizeof(*v), msg, text);
         }
       }
       else
       {
         // adaptive and normalized
-        if (*v != 0. || (&(*v))[1] != 0. || (&(*v))[2] != 0.)
+        if (state[0] != 0. || state[1] != 0. || state[2] != 0.)
         {
           brw = write_index(model_file, msg, text, all.num_bits, i);
-          msg << ":" << *v << " " << (&(*v))[1] << " " << (&(*v))[2] << "\n";
-          brw += bin_text_write_fixed(model_file, (char*)&(*v), 3 * sizeof(*v), msg, text);
+          msg << ":" << state[0] << " " << state[1] << " " << state[2] << "\n";
+          brw += bin_text_write_fixed(model_file, (char*)state, 3 * sizeof(*v), msg, text);
         }
       }
     }
@@ -970,6 +2217,9 @@ void save_load_online_state(
 void save_load(gd& g, io_buf& model_file, bool read, bool text)
 {
   vw& all = *g.all;
+  if (!read) apply_minibatch(g);
+  // The regularization yet to be applied to each weight is not saved.
+  if (!read && g.lazy) sync_weights(g);
   if (read)
   {
     initialize_regressor(all);
@@ -978,9 +2228,10 @@ void save_load(gd& g, io_buf& model_file, bool read, bool text)
     {
       float init_weight = all.initial_weight;
       float init_t = all.initial_t;
-      auto initial_gd_weight_initializer = [init_weight, init_t](weight* weights, uint64_t /*index*/) {
+      uint64_t distance = all.weights.slot_distance();
+      auto initial_gd_weight_initializer = [init_weight, init_t, distance](weight* weights, uint64_t /*index*/) {
         weights[0] = init_weight;
-        weights[1] = init_t;
+        weights[distance] = init_t;
       };
 
       all.weights.set_default(initial_gd_weight_initializer);
@@ -997,7 +2248,8 @@ void save_load(gd& g, io_buf& model_file, bool read, bool text)
 
   if (model_file.num_files() > 0)
   {
-    bool resume = all.save_resume;
+    // Quantized models hold the weights only.
+    bool resume = all.save_resume && !all.save_quantized;
     std::stringstream msg;
     msg << ":" << resume << "\n";
     bin_text_read_write_fixed(model_file, (char*)&resume, sizeof(resume), "", read, msg, text);
@@ -1011,12 +2263,51 @@ void save_load(gd& g, io_buf& model_file, bool read, bool text)
             << std::endl;
       save_load_online_state(all, model_file, read, text, g.total_weight, &g);
     }
+    else if (read ? g.quantized_model : all.save_quantized)
+      save_load_quantized_regressor(all, model_file, read);
+    else if (read ? g.weight_runs_model : all.write_weight_runs && !text)
+      save_load_weight_runs(all, model_file, read);
+    else if (read ? g.weight_image_model : all.write_weight_image && !text && !all.weights.sparse)
+      save_load_weight_image(all, model_file, read);
     else
       save_load_regressor(all, model_file, read, text);
   }
   if (!all.training)  // If the regressor was saved as --save_resume, then when testing we want to materialize the
                       // weights.
-    sync_weights(all);
+    sync_weights(g);
+}
+
+template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, bool adax, uint64_t adaptive,
+    uint64_t normalized, uint64_t spare, uint64_t next>
+uint64_t set_learn(gd& g)
+{
+  if (g.planar)
+  {
+    g.learn = learn<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, true, adaptive, normalized, spare>;
+    g.update = update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, true, adaptive, normalized, spare>;
+    g.multiupdate =
+        multiupdate<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, true, adaptive, normalized, spare>;
+    g.sensitivity = sensitivity<sqrt_rate, feature_mask_off, adax, true, adaptive, normalized, spare>;
+    g.multi_sensitivity = multi_sensitivity<sqrt_rate, feature_mask_off, adax, true, adaptive, normalized, spare>;
+    g.predict_with_sensitivity =
+        predict_with_sensitivity<sqrt_rate, feature_mask_off, adax, true, adaptive, normalized, spare>;
+    g.learn_difference =
+        learn_difference<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, true, adaptive, normalized, spare>;
+  }
+  else
+  {
+    g.learn = learn<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, false, adaptive, normalized, spare>;
+    g.update = update<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, false, adaptive, normalized, spare>;
+    g.multiupdate =
+        multiupdate<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, false, adaptive, normalized, spare>;
+    g.sensitivity = sensitivity<sqrt_rate, feature_mask_off, adax, false, adaptive, normalized, spare>;
+    g.multi_sensitivity = multi_sensitivity<sqrt_rate, feature_mask_off, adax, false, adaptive, normalized, spare>;
+    g.predict_with_sensitivity =
+        predict_with_sensitivity<sqrt_rate, feature_mask_off, adax, false, adaptive, normalized, spare>;
+    g.learn_difference =
+        learn_difference<sparse_l2, invariant, sqrt_rate, feature_mask_off, adax, false, adaptive, normalized, spare>;
+  }
+  return next;
 }
 
 template <bool sparse_l2, bool invariant, bool sqrt_rate, bool feature_mask_off, uint64_t adaptive, uint64_t normalized,
@@ -1025,19 +2316,9 @@ uint64_t set_learn(vw& all, gd& g)
 {
   all.normalized_idx = normalized;
   if (g.adax)
-  {
-    g.learn = learn<sparse_l2, invariant, sqrt_rate, feature_mask_off, true, adaptive, normalized, spare>;
-    g.update = update<sparse_l2, invariant, sqrt_rate, feature_mask_off, true, adaptive, normalized, spare>;
-    g.sensitivity = sensitivity<sqrt_rate, feature_mask_off, true, adaptive, normalized, spare>;
-    return next;
-  }
+    return set_learn<sparse_l2, invariant, sqrt_rate, feature_mask_off, true, adaptive, normalized, spare, next>(g);
   else
-  {
-    g.learn = learn<sparse_l2, invariant, sqrt_rate, feature_mask_off, false, adaptive, normalized, spare>;
-    g.update = update<sparse_l2, invariant, sqrt_rate, feature_mask_off, false, adaptive, normalized, spare>;
-    g.sensitivity = sensitivity<sqrt_rate, feature_mask_off, false, adaptive, normalized, spare>;
-    return next;
-  }
+    return set_learn<sparse_l2, invariant, sqrt_rate, feature_mask_off, false, adaptive, normalized, spare, next>(g);
 }
 
 template <bool sparse_l2, bool invariant, bool sqrt_rate, uint64_t adaptive, uint64_t normalized, uint64_t spare,
@@ -1120,7 +2401,29 @@ base_learner* setup(options_i& options, vw& all)
       .add(make_option("l2_state", all.sd->contraction)
                .keep(all.save_resume)
                .default_value(1.)
-               .help("use per feature normalized updates"));
+               .help("use per feature normalized updates"))
+      .add(make_option("quantized", g->quantized_model)
+               .help("the weights of the model read are quantized, as written by --save_quantized"))
+      .add(make_option("weight_runs", g->weight_runs_model)
+               .help("the weights of the model read are in runs, as written by --write_weight_runs"))
+      .add(make_option("weight_image", g->weight_image_model)
+               .help("the weights of the model read are one array, as written by --write_weight_image"))
+      .add(make_option("resume_columns", g->resume_columns_model)
+               .help("the state of the resumable model read is in columns, as written by --write_resume_columns"))
+      .add(make_option("planar_weights", g->planar)
+               .help("keep the adaptive and normalized state of the weights apart from them, in planes of their own"))
+      .add(make_option("fused_learn", g->fused)
+               .help("generate the features and interactions of an example once, rather than for the prediction, the "
+                     "normalization and the update each, and for each model a reduction learns from it. Not used "
+                     "with l1 or audit"))
+      .add(make_option("lazy_regularization", g->lazy)
+               .help("apply the l1 and l2 regularization to each weight when it is next used, rather than by scaling "
+                     "all of them and syncing them in a pass over the model once the scale runs low"))
+      .add(make_option("minibatch_sgd", g->minibatch)
+               .default_value(1)
+               .help("apply the updates of arg examples at once, summing those of a weight so that it is written "
+                     "once per minibatch rather than once per example. The examples of a minibatch predict from the "
+                     "weights before it"));
   options.add_and_parse(new_options);
 
   g->all = &all;
@@ -1186,12 +2489,29 @@ base_learner* setup(options_i& options, vw& all)
 
   if (g->adax && !all.weights.adaptive) THROW("Cannot use adax without adaptive");
 
+  if (g->lazy && all.reg_mode == 0) THROW("--lazy_regularization requires --l1 or --l2");
+  g->lazy = g->lazy && all.training;
+  if (g->minibatch == 0) THROW("--minibatch_sgd must be at least 1");
+
+  if (g->planar)
+  {
+    if (all.weights.sparse) THROW("--planar_weights requires dense weights");
+    // stagewise_poly reads the normalized state interleaved with the weights.
+    if (options.was_supplied("stage_poly")) THROW("--planar_weights cannot be used with --stage_poly");
+  }
+
   if (pow((double)all.eta_decay_rate, (double)all.numpasses) < 0.0001)
     all.trace_message << "Warning: the learning rate for the last pass is multiplied by: "
                       << pow((double)all.eta_decay_rate, (double)all.numpasses)
                       << " adjust --decay_learning_rate larger to avoid this." << std::endl;
 
-  if (all.reg_mode % 2)
+  if (g->lazy)
+  {
+    // The regularization yet to be applied varies by weight, so the models of multipredict are predicted in turn.
+    g->predict = (all.audit || all.hash_inv) ? lazy_predict<true> : lazy_predict<false>;
+    g->multipredict = nullptr;
+  }
+  else if (all.reg_mode % 2)
     if (all.audit || all.hash_inv)
     {
       g->predict = predict<true, true>;
@@ -1212,6 +2532,10 @@ base_learner* setup(options_i& options, vw& all)
     g->predict = predict<false, false>;
     g->multipredict = multipredict<false, false>;
   }
+  // cats_tree predicts from the same features with the model of every level of its tree, and plt learns from them the
+  // models of every node on the paths to the labels, so that they are gathered once.
+  if (options.was_supplied("cats_tree") || options.was_supplied("plt")) g->fused = true;
+  g->fused = g->fused && g->predict == predict<false, false>;
 
   uint64_t stride;
   if (all.power_t == 0.5)
@@ -1219,13 +2543,31 @@ base_learner* setup(options_i& options, vw& all)
   else
     stride = set_learn<false>(all, feature_mask_off, *g.get());
 
-  all.weights.stride_shift((uint32_t)ceil_log_2(stride - 1));
+  if (g->lazy)
+  {
+    g->lazy_slot = stride;
+    stride += 2;
+  }
+
+  if (g->planar)
+  {
+    // The weights keep a stride of 1, the rest of their state moves to the planes after them.
+    all.weights.stride_shift(0);
+    all.weights.dense_weights.planes_shift((uint32_t)ceil_log_2(stride - 1));
+  }
+  else
+    all.weights.stride_shift((uint32_t)ceil_log_2(stride - 1));
 
   gd* bare = g.get();
-  learner<gd, example>& ret = init_learner(g, g->learn, bare->predict, ((uint64_t)1 << all.weights.stride_shift()));
+  learner<gd, example>& ret = init_learner(
+      g, g->learn, bare->fused ? fused_predict : bare->predict, ((uint64_t)1 << all.weights.stride_shift()));
   ret.set_sensitivity(bare->sensitivity);
+  ret.set_multi_sensitivity(bare->multi_sensitivity);
+  ret.set_predict_with_sensitivity(bare->predict_with_sensitivity);
   ret.set_multipredict(bare->multipredict);
   ret.set_update(bare->update);
+  ret.set_multiupdate(bare->multiupdate);
+  if (bare->predict == predict<false, false>) ret.set_learn_difference(bare->learn_difference);
   ret.set_save_load(save_load);
   ret.set_end_pass(end_pass);
   return make_base(ret);
@@ -9,6 +9,7 @@
 #include "interactions.h"
 #include "array_parameters.h"
 #include "gd_predict.h"
+#include "dense_batch.h"
 
 namespace GD
 {
@@ -23,6 +24,11 @@ void save_load_regressor(vw& all, io_buf& model_file, bool read, bool text);
 void save_load_online_state(vw& all, io_buf& model_file, bool read, bool text, double& total_weight,
     GD::gd* g = nullptr, uint32_t ftrl_size = 0);
 
+// Sets the partial_prediction and pred.scalar of each of examples as the prediction of gd does, from the features of
+// all of them gathered into batch and predicted at once by backend. With l1, the examples are predicted one by one.
+// The regularization --lazy_regularization is yet to apply to some weights is not.
+void predict_batch(vw& all, multi_ex& examples, VW::dense_backend& backend, VW::flat_batch& batch);
+
 template <class T>
 struct multipredict_info
 {
@@ -72,9 +78,9 @@ inline void foreach_feature(vw& all, example& ec, R& dat)
 {
   return all.weights.sparse
       ? foreach_feature<R, S, T, sparse_parameters>(all.weights.sparse_weights, all.ignore_some_linear,
-            all.ignore_linear, *ec.interactions, all.permutations, ec, dat)
+            all.ignore_linear, INTERACTIONS::active_interactions(all, *ec.interactions, ec), all.permutations, ec, dat)
       : foreach_feature<R, S, T, dense_parameters>(all.weights.dense_weights, all.ignore_some_linear, all.ignore_linear,
-            *ec.interactions, all.permutations, ec, dat);
+            INTERACTIONS::active_interactions(all, *ec.interactions, ec), all.permutations, ec, dat);
 }
 
 // iterate through all namespaces and quadratic&cubic features, callback function T(some_data_R, feature_value_x,
@@ -91,12 +97,38 @@ inline void foreach_feature(vw& all, example& ec, R& dat)
   foreach_feature<R, const float&, T>(all, ec, dat);
 }
 
+template <class R, void (*T)(R&, float, uint64_t), class W>
+inline void foreach_feature_by_group(vw& all, W& weights, example& ec, R& dat)
+{
+  for (example_predict::iterator i = ec.begin(); i != ec.end(); ++i)
+  {
+    if (all.ignore_some_linear && all.ignore_linear[i.index()]) continue;
+    dat.start_namespace(i.index());
+    foreach_feature<R, T, W>(weights, *i, dat, ec.ft_offset);
+  }
+  for (const auto& interaction : INTERACTIONS::active_interactions(all, *ec.interactions, ec))
+    generate_interactions<R, uint64_t, T, W>(dat.start_interaction(interaction), all.permutations, ec, dat, weights);
+}
+
+// iterate through the features as foreach_feature does, a namespace or an interaction at a time, callback function
+// T(some_data_R, feature_value_x, feature_index). dat.start_namespace(ns) is called before the features of a namespace
+// and dat.start_interaction(interaction) before those of an interaction, returning it as a list of that one.
+template <class R, void (*T)(R&, float, uint64_t)>
+inline void foreach_feature_by_group(vw& all, example& ec, R& dat)
+{
+  if (all.weights.sparse)
+    foreach_feature_by_group<R, T, sparse_parameters>(all, all.weights.sparse_weights, ec, dat);
+  else
+    foreach_feature_by_group<R, T, dense_parameters>(all, all.weights.dense_weights, ec, dat);
+}
+
 inline float inline_predict(vw& all, example& ec)
 {
+  const auto& interactions = INTERACTIONS::active_interactions(all, *ec.interactions, ec);
   return all.weights.sparse ? inline_predict<sparse_parameters>(all.weights.sparse_weights, all.ignore_some_linear,
-                                  all.ignore_linear, *ec.interactions, all.permutations, ec, ec.l.simple.initial)
+                                  all.ignore_linear, interactions, all.permutations, ec, ec.l.simple.initial)
                             : inline_predict<dense_parameters>(all.weights.dense_weights, all.ignore_some_linear,
-                                  all.ignore_linear, *ec.interactions, all.permutations, ec, ec.l.simple.initial);
+                                  all.ignore_linear, interactions, all.permutations, ec, ec.l.simple.initial);
 }
 
 inline float sign(float w)
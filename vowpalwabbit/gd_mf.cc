@@ -4,6 +4,7 @@
 #include <fstream>
 #include <cfloat>
 #include <cstdio>
+#include <vector>
 #ifdef _WIN32
 #  define NOMINMAX
 #  include <winsock2.h>
@@ -24,6 +25,9 @@ struct gdmf
 {
   vw* all;  // regressor, printing
   v_array<float> scalars;
+  std::vector<float> left_dots;   // x_l * l^k, for each k
+  std::vector<float> right_dots;  // x_r * r^k, for each k
+  std::vector<float> updates;     // scratch of mf_train, for each k
   uint32_t rank;
   size_t no_win_counter;
   uint64_t early_stop_thres;
@@ -82,13 +86,17 @@ void mf_print_audit_features(gdmf& d, example& ec, size_t offset)
   mf_print_offset_features(d, ec, offset);
 }
 
-struct pred_offset
+// dots[k - 1] += x * w^{first + k} for every k in 1..rank, in one pass over the features of fs.
+template <class T>
+void offset_dots(T& weights, features& fs, uint64_t first, uint32_t rank, float* dots)
 {
-  float p;
-  uint64_t offset;
-};
-
-void offset_add(pred_offset& res, const float fx, float& fw) { res.p += (&fw)[res.offset] * fx; }
+  for (size_t i = 0; i < fs.size(); i++)
+  {
+    const float* w = &weights[fs.indicies[i]] + first;
+    const float x = fs.values[i];
+    for (uint32_t k = 1; k <= rank; k++) dots[k - 1] += w[k] * x;
+  }
+}
 
 template <class T>
 float mf_predict(gdmf& d, example& ec, T& weights)
@@ -126,25 +134,20 @@ float mf_predict(gdmf& d, example& ec, T& weights)
 
     if (ec.feature_space[(int)i[0]].size() > 0 && ec.feature_space[(int)i[1]].size() > 0)
     {
-      for (uint64_t k = 1; k <= d.rank; k++)
+      // x_l * l^k, l^k is from index+1 to index+d.rank
+      d.left_dots.assign(d.rank, 0.f);
+      offset_dots(weights, ec.feature_space[(int)i[0]], 0, d.rank, d.left_dots.data());
+      // x_r * r^k, r^k is from index+d.rank+1 to index+2*d.rank
+      d.right_dots.assign(d.rank, 0.f);
+      offset_dots(weights, ec.feature_space[(int)i[1]], d.rank, d.rank, d.right_dots.data());
+
+      for (uint32_t k = 0; k < d.rank; k++)
       {
-        // x_l * l^k
-        // l^k is from index+1 to index+d.rank
-        // float x_dot_l = sd_offset_add(weights, ec.atomics[(int)(*i)[0]].begin(), ec.atomics[(int)(*i)[0]].end(), k);
-        pred_offset x_dot_l = {0., k};
-        GD::foreach_feature<pred_offset, offset_add, T>(weights, ec.feature_space[(int)i[0]], x_dot_l);
-        // x_r * r^k
-        // r^k is from index+d.rank+1 to index+2*d.rank
-        // float x_dot_r = sd_offset_add(weights, ec.atomics[(int)(*i)[1]].begin(), ec.atomics[(int)(*i)[1]].end(),
-        // k+d.rank);
-        pred_offset x_dot_r = {0., k + d.rank};
-        GD::foreach_feature<pred_offset, offset_add, T>(weights, ec.feature_space[(int)i[1]], x_dot_r);
-
-        prediction += x_dot_l.p * x_dot_r.p;
+        prediction += d.left_dots[k] * d.right_dots[k];
 
         // store prediction from interaction terms
-        d.scalars.push_back(x_dot_l.p);
-        d.scalars.push_back(x_dot_r.p);
+        d.scalars.push_back(d.left_dots[k]);
+        d.scalars.push_back(d.right_dots[k]);
       }
     }
   }
@@ -180,6 +183,19 @@ void sd_offset_update(T& weights, features& fs, uint64_t offset, float update, f
     (&weights[fs.indicies[i]])[offset] += update * fs.values[i] - regularization * (&weights[fs.indicies[i]])[offset];
 }
 
+// w^{first + k} += updates[k - 1] * x - regularization * w^{first + k} for every k in 1..rank, in one pass over fs.
+template <class T>
+void sd_offset_update(
+    T& weights, features& fs, uint64_t first, uint32_t rank, const float* updates, float regularization)
+{
+  for (size_t i = 0; i < fs.size(); i++)
+  {
+    float* w = &weights[fs.indicies[i]] + first;
+    const float x = fs.values[i];
+    for (uint32_t k = 1; k <= rank; k++) w[k] += updates[k - 1] * x - regularization * w[k];
+  }
+}
+
 template <class T>
 void mf_train(gdmf& d, example& ec, T& weights)
 {
@@ -203,22 +219,13 @@ void mf_train(gdmf& d, example& ec, T& weights)
 
     if (ec.feature_space[(int)i[0]].size() > 0 && ec.feature_space[(int)i[1]].size() > 0)
     {
-      // update l^k weights
-      for (size_t k = 1; k <= d.rank; k++)
-      {
-        // r^k \cdot x_r
-        float r_dot_x = d.scalars[2 * k];
-        // l^k <- l^k + update * (r^k \cdot x_r) * x_l
-        sd_offset_update<T>(weights, ec.feature_space[(int)i[0]], k, update * r_dot_x, regularization);
-      }
-      // update r^k weights
-      for (size_t k = 1; k <= d.rank; k++)
-      {
-        // l^k \cdot x_l
-        float l_dot_x = d.scalars[2 * k - 1];
-        // r^k <- r^k + update * (l^k \cdot x_l) * x_r
-        sd_offset_update<T>(weights, ec.feature_space[(int)i[1]], k + d.rank, update * l_dot_x, regularization);
-      }
+      // l^k <- l^k + update * (r^k \cdot x_r) * x_l
+      d.updates.resize(d.rank);
+      for (size_t k = 1; k <= d.rank; k++) d.updates[k - 1] = update * d.scalars[2 * k];
+      sd_offset_update<T>(weights, ec.feature_space[(int)i[0]], 0, d.rank, d.updates.data(), regularization);
+      // r^k <- r^k + update * (l^k \cdot x_l) * x_r
+      for (size_t k = 1; k <= d.rank; k++) d.updates[k - 1] = update * d.scalars[2 * k - 1];
+      sd_offset_update<T>(weights, ec.feature_space[(int)i[1]], d.rank, d.rank, d.updates.data(), regularization);
     }
   }
 }
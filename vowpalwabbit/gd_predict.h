@@ -19,14 +19,30 @@ void foreach_feature(W& /*weights*/, features& fs, R& dat, uint64_t offset = 0,
 template <class R, void (*T)(R&, const float, float&), class W>
 inline void foreach_feature(W& weights, features& fs, R& dat, uint64_t offset = 0, float mult = 1.)
 {
-  for (features::iterator& f : fs) T(dat, mult * f.value(), weights[(f.index() + offset)]);
+  features::iterator f = fs.begin();
+  const std::ptrdiff_t ahead = INTERACTIONS::prefetch_distance(weights);
+  for (std::ptrdiff_t prefetched = (ahead > 0) ? (fs.end() - f) - ahead : 0; prefetched > 0; --prefetched, ++f)
+  {
+    INTERACTIONS::prefetch_weight(weights, (f + ahead).index() + offset);
+    T(dat, mult * f.value(), weights[(f.index() + offset)]);
+  }
+  for (; f != fs.end(); ++f) T(dat, mult * f.value(), weights[(f.index() + offset)]);
 }
 
 // iterate through one namespace (or its part), callback function T(some_data_R, feature_value_x, feature_weight)
 template <class R, void (*T)(R&, const float, const float&), class W>
 inline void foreach_feature(const W& weights, features& fs, R& dat, uint64_t offset = 0, float mult = 1.)
 {
-  for (features::iterator& f : fs)
+  if (INTERACTIONS::dot_product_kernel<R, const float&, T>::add_linear(dat, fs, offset, weights, mult)) return;
+  features::iterator f = fs.begin();
+  const std::ptrdiff_t ahead = INTERACTIONS::prefetch_distance(weights);
+  for (std::ptrdiff_t prefetched = (ahead > 0) ? (fs.end() - f) - ahead : 0; prefetched > 0; --prefetched, ++f)
+  {
+    INTERACTIONS::prefetch_weight(weights, (f + ahead).index() + offset);
+    const weight& w = weights[(f.index() + offset)];
+    T(dat, mult * f.value(), w);
+  }
+  for (; f != fs.end(); ++f)
   {
     const weight& w = weights[(f.index() + offset)];
     T(dat, mult * f.value(), w);
@@ -40,7 +56,7 @@ inline void dummy_func(R&, const audit_strings*)
 
 template <class R, class S, void (*T)(R&, float, S), class W>  // nullptr func can't be used as template param in old
                                                                // compilers
-inline void generate_interactions(std::vector<std::vector<namespace_index>>& interactions, bool permutations,
+inline void generate_interactions(const std::vector<std::vector<namespace_index>>& interactions, bool permutations,
     example_predict& ec, R& dat,
     W& weights)  // default value removed to eliminate
                  // ambiguity in old complers
@@ -51,8 +67,8 @@ inline void generate_interactions(std::vector<std::vector<namespace_index>>& int
 // iterate through all namespaces and quadratic&cubic features, callback function T(some_data_R, feature_value_x, S)
 // where S is EITHER float& feature_weight OR uint64_t feature_index
 template <class R, class S, void (*T)(R&, float, S), class W>
-inline void foreach_feature(W& weights, bool ignore_some_linear, std::array<bool, NUM_NAMESPACES>& ignore_linear,
-    std::vector<std::vector<namespace_index>>& interactions, bool permutations, example_predict& ec, R& dat)
+inline void foreach_feature(W& weights, bool ignore_some_linear, const std::array<bool, NUM_NAMESPACES>& ignore_linear,
+    const std::vector<std::vector<namespace_index>>& interactions, bool permutations, example_predict& ec, R& dat)
 {
   uint64_t offset = ec.ft_offset;
   if (ignore_some_linear)
@@ -71,10 +87,34 @@ inline void foreach_feature(W& weights, bool ignore_some_linear, std::array<bool
 }
 
 inline void vec_add(float& p, const float fx, const float& fw) { p += fw * fx; }
+}  // namespace GD
+
+namespace INTERACTIONS
+{
+template <>
+struct dot_product_kernel<float, const float&, GD::vec_add>
+{
+  template <class W>
+  static bool add(float& dat, features::iterator_all& begin, features::iterator_all& end, const uint64_t offset,
+      W& weights, feature_value ft_value, feature_index halfhash)
+  {
+    return add_dot_product(dat, begin, end, offset, weights, ft_value, halfhash);
+  }
+
+  template <class W>
+  static bool add_linear(float& dat, features& fs, const uint64_t offset, W& weights, float mult)
+  {
+    return add_linear_dot_product(dat, fs, offset, weights, mult);
+  }
+};
+}  // namespace INTERACTIONS
+
+namespace GD
+{
 
 template <class W>
-inline float inline_predict(W& weights, bool ignore_some_linear, std::array<bool, NUM_NAMESPACES>& ignore_linear,
-    std::vector<std::vector<namespace_index>>& interactions, bool permutations, example_predict& ec,
+inline float inline_predict(W& weights, bool ignore_some_linear, const std::array<bool, NUM_NAMESPACES>& ignore_linear,
+    const std::vector<std::vector<namespace_index>>& interactions, bool permutations, example_predict& ec,
     float initial = 0.f)
 {
   foreach_feature<float, const float&, vec_add, W>(
@@ -12,10 +12,17 @@
 
 #include "global_data.h"
 #include "gd.h"
+#include "interaction_plan.h"
+#include "model_reloader.h"
+#include "output_thread.h"
+#include "parameter_server_client.h"
+#include "prediction_cache.h"
+#include "text_format.h"
 #include "vw_exception.h"
 #include "future_compat.h"
 #include "vw_allreduce.h"
 #include "named_labels.h"
+#include "parser/columnar/parse_example_columnar.h"
 #include "parser/flatbuffer/parse_example_flatbuffer.h"
 
 struct global_prediction
@@ -48,7 +55,7 @@ size_t really_read(VW::io::reader* sock, void* in, size_t count)
 void get_prediction(VW::io::reader* f, float& res, float& weight)
 {
   global_prediction p;
-  really_read(f, &p, sizeof(p));
+  if (really_read(f, &p, sizeof(p)) < sizeof(p)) THROW("the connection was closed before the prediction was sent");
   res = p.p;
   weight = p.weight;
 }
@@ -94,42 +101,22 @@ void print_result_by_ref(VW::io::writer* f, float res, float, const v_array<char
 {
   if (f != nullptr)
   {
-    std::stringstream ss;
-    auto saved_precision = ss.precision();
-    if (floorf(res) == res) ss << std::setprecision(0);
-    ss << std::fixed << res << std::setprecision(saved_precision);
-    print_tag_by_ref(ss, tag);
-    ss << '\n';
-    ssize_t len = ss.str().size();
-    ssize_t t = f->write(ss.str().c_str(), (unsigned int)len);
-    if (t != len) { std::cerr << "write error: " << VW::strerror_to_string(errno) << std::endl; }
+    // Integers without decimals, others with the 6 of std::fixed.
+    auto& line = VW::thread_text_line();
+    line.add_fixed(res, floorf(res) == res ? 0 : 6).add_tag(tag).add('\n');
+    line.write_to(f);
   }
 }
 
-void print_raw_text(VW::io::writer* f, std::string s, v_array<char> tag)
-{
-  if (f == nullptr) return;
-
-  std::stringstream ss;
-  ss << s;
-  print_tag_by_ref(ss, tag);
-  ss << '\n';
-  ssize_t len = ss.str().size();
-  ssize_t t = f->write(ss.str().c_str(), (unsigned int)len);
-  if (t != len) { std::cerr << "write error: " << VW::strerror_to_string(errno) << std::endl; }
-}
+void print_raw_text(VW::io::writer* f, std::string s, v_array<char> tag) { print_raw_text_by_ref(f, s, tag); }
 
 void print_raw_text_by_ref(VW::io::writer* f, const std::string& s, const v_array<char>& tag)
 {
   if (f == nullptr) return;
 
-  std::stringstream ss;
-  ss << s;
-  print_tag_by_ref(ss, tag);
-  ss << '\n';
-  ssize_t len = ss.str().size();
-  ssize_t t = f->write(ss.str().c_str(), (unsigned int)len);
-  if (t != len) { std::cerr << "write error: " << VW::strerror_to_string(errno) << std::endl; }
+  auto& line = VW::thread_text_line();
+  line.add(s).add_tag(tag).add('\n');
+  line.write_to(f);
 }
 
 void set_mm(shared_data* sd, float label)
@@ -140,12 +127,45 @@ void set_mm(shared_data* sd, float label)
 
 void noop_mm(shared_data*, float) {}
 
+// Moves weights attached with --attach_weights to the last published ones, swaps in a model reloaded with
+// --reload_model, exchanges weights with the parameter servers of --ps_servers, or evicts sparse weights past
+// --sparse_weights_limit, between two examples. Any of these moves on the model_version.
+void update_weights(vw& all)
+{
+  bool changed = false;
+  if (all.attached_weights != nullptr) changed |= all.attached_weights->follow(all.weights.dense_weights);
+  if (all.model_reloader != nullptr)
+  {
+    const uint64_t reloads = all.model_reloader->reloads();
+    all.model_reloader->swap_if_loaded();
+    changed |= all.model_reloader->reloads() != reloads;
+  }
+  if (all.parameter_server != nullptr) changed |= all.parameter_server->between_examples(all);
+  if (all.weights.sparse) changed |= all.weights.sparse_weights.evict_if_over_limit() > 0;
+  if (changed) ++all.model_version;
+}
+
+// Predicts ec from the --predict_cache when it holds it.
+void predict_through_cache(vw& all, example& ec)
+{
+  VW::prediction_cache* cache = all.prediction_cache.get();
+  if (cache == nullptr)
+  {
+    VW::LEARNER::as_singleline(all.l)->predict(ec);
+    return;
+  }
+  if (cache->lookup(all, ec)) return;
+  VW::LEARNER::as_singleline(all.l)->predict(ec);
+  cache->insert(all, ec);
+}
+
 void vw::learn(example& ec)
 {
   if (l->is_multiline) THROW("This reduction does not support single-line examples.");
+  update_weights(*this);
 
   if (ec.test_only || !training)
-    VW::LEARNER::as_singleline(l)->predict(ec);
+    predict_through_cache(*this, ec);
   else
     VW::LEARNER::as_singleline(l)->learn(ec);
 }
@@ -153,6 +173,7 @@ void vw::learn(example& ec)
 void vw::learn(multi_ex& ec)
 {
   if (!l->is_multiline) THROW("This reduction does not support multi-line example.");
+  update_weights(*this);
 
   if (!training)
     VW::LEARNER::as_multiline(l)->predict(ec);
@@ -163,16 +184,18 @@ void vw::learn(multi_ex& ec)
 void vw::predict(example& ec)
 {
   if (l->is_multiline) THROW("This reduction does not support single-line examples.");
+  update_weights(*this);
 
   // be called directly in library mode, test_only must be explicitly set here. If the example has a label but is passed
   // to predict it would otherwise be incorrectly labelled as test_only = false.
   ec.test_only = true;
-  VW::LEARNER::as_singleline(l)->predict(ec);
+  predict_through_cache(*this, ec);
 }
 
 void vw::predict(multi_ex& ec)
 {
   if (!l->is_multiline) THROW("This reduction does not support multi-line example.");
+  update_weights(*this);
 
   // be called directly in library mode, test_only must be explicitly set here. If the example has a label but is passed
   // to predict it would otherwise be incorrectly labelled as test_only = false.
@@ -288,8 +311,11 @@ vw::vw() : options(nullptr, nullptr)
   print_text = print_raw_text;
   print_by_ref = print_result_by_ref;
   print_text_by_ref = print_raw_text_by_ref;
+  binary_predictions = false;
+  output_queue_size = 0;
   lda = 0;
   random_seed = 0;
+  counter_based_random = false;
   random_weights = false;
   normal_weights = false;
   tnormal_weights = false;
@@ -328,10 +354,14 @@ vw::vw() : options(nullptr, nullptr)
   passes_complete = 0;
 
   save_per_pass = false;
+  save_in_background = false;
+  rehash_bits = 0;
+  background_save_pid = 0;
 
   stdin_off = false;
   do_reset_source = false;
   holdout_set_off = true;
+  holdout_thread = false;
   holdout_after = 0;
   check_holdout_every_n_passes = 1;
   early_terminate = false;
@@ -340,6 +370,16 @@ vw::vw() : options(nullptr, nullptr)
 
   hash_inv = false;
   print_invert = false;
+  save_quantized = false;
+  write_weight_runs = false;
+  write_weight_image = false;
+  save_threads = 0;
+  prune_weights = 0.f;
+  prune_adaptive = 0.f;
+  weight_prefetch_distance = -1;
+  lazy_weights = false;
+  learner_threads = 1;
+  full_hashes = false;
 
   // Set by the '--progress <arg>' option and affect sd->dump_interval
   progress_add = false;  // default is multiplicative progress dumps
@@ -0,0 +1,297 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "hash_report.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gd.h"
+#include "reductions.h"
+
+using namespace VW::config;
+
+namespace VW
+{
+void hyperloglog::add(uint64_t hash)
+{
+  const size_t index = hash & (REGISTERS - 1);
+  const uint64_t rest = hash >> PRECISION;
+  uint8_t rank;
+  if (rest == 0)
+    rank = 64 - PRECISION + 1;
+  else
+  {
+#ifdef _MSC_VER
+    unsigned long lowest;
+    _BitScanForward64(&lowest, rest);
+    rank = static_cast<uint8_t>(lowest + 1);
+#else
+    rank = static_cast<uint8_t>(__builtin_ctzll(rest) + 1);
+#endif
+  }
+  if (rank > _registers[index]) _registers[index] = rank;
+}
+
+void hyperloglog::merge(const hyperloglog& other)
+{
+  for (size_t i = 0; i < REGISTERS; i++)
+    if (other._registers[i] > _registers[i]) _registers[i] = other._registers[i];
+}
+
+double hyperloglog::estimate() const
+{
+  const double m = static_cast<double>(REGISTERS);
+  double sum = 0.;
+  size_t zeros = 0;
+  for (uint8_t r : _registers)
+  {
+    sum += std::ldexp(1., -r);
+    if (r == 0) zeros++;
+  }
+  const double estimate = 0.7213 / (1. + 1.079 / m) * m * m / sum;
+  // linear counting where there are too few hashes for the registers to be all set
+  if (estimate <= 2.5 * m && zeros > 0) return m * std::log(m / zeros);
+  return estimate;
+}
+
+uint64_t hyperloglog::mix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+double expected_collision_rate(double distinct, uint32_t bits)
+{
+  if (distinct <= 1.) return 0.;
+  // each of the other features misses the weight of a feature with probability 1 - 1 / 2^bits
+  return -std::expm1((distinct - 1.) * std::log1p(-std::ldexp(1., -static_cast<int>(bits))));
+}
+}  // namespace VW
+
+namespace
+{
+// The features hashed to about 2^12 of the weights are kept, to count those which share them.
+constexpr uint32_t SAMPLED_WEIGHT_BITS = 12;
+// The fraction of the features expected to collide under which a -b is suggested.
+constexpr double SAFE_COLLISION_RATE = 0.01;
+constexpr size_t NO_GROUP = std::numeric_limits<size_t>::max();
+
+// A namespace, or an interaction, and the features of it gd was given.
+struct hash_report_group
+{
+  std::string name;
+  uint64_t features = 0;
+  VW::hyperloglog distinct;
+};
+
+struct sampled_feature
+{
+  uint64_t feature;
+  size_t group;
+};
+
+size_t add_group(std::vector<hash_report_group>& groups, const std::string& name);
+
+struct hash_report
+{
+  hash_report() { namespace_groups.fill(NO_GROUP); }
+
+  void start_namespace(namespace_index ns)
+  {
+    if (namespace_groups[ns] == NO_GROUP) namespace_groups[ns] = add_group(groups, INTERACTIONS::namespace_name(ns));
+    group = namespace_groups[ns];
+  }
+
+  const std::vector<std::vector<namespace_index>>& start_interaction(const std::vector<namespace_index>& terms)
+  {
+    auto found = interaction_groups.find(terms);
+    if (found == interaction_groups.end())
+      found = interaction_groups.emplace(terms, add_group(groups, INTERACTIONS::interaction_name(terms))).first;
+    group = found->second;
+    interaction[0] = terms;
+    return interaction;
+  }
+
+  vw* all = nullptr;
+  uint32_t bits = 0;
+  uint32_t stride_shift = 0;
+  uint64_t weight_mask = 0;
+  uint64_t sample_mask = 0;
+  uint64_t examples = 0;
+
+  std::vector<hash_report_group> groups;
+  std::array<size_t, NUM_NAMESPACES> namespace_groups;
+  std::map<std::vector<namespace_index>, size_t> interaction_groups;
+  size_t group = 0;  // of the features being visited
+
+  std::vector<uint64_t> touched;  // a bit per weight
+  std::unordered_map<uint64_t, std::vector<sampled_feature>> sampled;  // the distinct features of the sampled weights
+  std::vector<std::vector<namespace_index>> interaction{1};           // the one being visited
+};
+
+size_t add_group(std::vector<hash_report_group>& groups, const std::string& name)
+{
+  groups.emplace_back();
+  groups.back().name = name;
+  return groups.size() - 1;
+}
+
+void count_feature(hash_report& r, float, uint64_t index)
+{
+  const uint64_t feature = index >> r.stride_shift;
+  const uint64_t weight = (index & r.weight_mask) >> r.stride_shift;
+  hash_report_group& group = r.groups[r.group];
+  group.features++;
+  group.distinct.add(VW::hyperloglog::mix(feature));
+  r.touched[weight >> 6] |= static_cast<uint64_t>(1) << (weight & 63);
+
+  if ((VW::hyperloglog::mix(weight) & r.sample_mask) != 0) return;
+  auto& features = r.sampled[weight];
+  for (const auto& f : features)
+    if (f.feature == feature) return;
+  features.push_back({feature, r.group});
+}
+
+// The weights are only there once the model is loaded, after the reductions are set up.
+void start(hash_report& r)
+{
+  r.bits = r.all->num_bits;
+  r.stride_shift = r.all->weights.stride_shift();
+  r.weight_mask = r.all->weights.mask();
+  r.sample_mask = r.bits > SAMPLED_WEIGHT_BITS ? (static_cast<uint64_t>(1) << (r.bits - SAMPLED_WEIGHT_BITS)) - 1 : 0;
+  r.touched.resize(((static_cast<uint64_t>(1) << r.bits) + 63) / 64);
+}
+
+template <bool is_learn>
+void predict_or_learn(hash_report& r, VW::LEARNER::single_learner& base, example& ec)
+{
+  if (is_learn)
+  {
+    if (r.touched.empty()) start(r);
+    r.examples++;
+    GD::foreach_feature_by_group<hash_report, count_feature>(*r.all, ec, r);
+    base.learn(ec);
+  }
+  else
+    base.predict(ec);
+}
+
+// The fraction of the sampled features of a group, or of all of them for NO_GROUP, which share their weight.
+bool sampled_collision_rate(const hash_report& r, size_t group, double& rate)
+{
+  uint64_t features = 0;
+  uint64_t colliding = 0;
+  for (const auto& weight : r.sampled)
+    for (const auto& f : weight.second)
+      if (group == NO_GROUP || f.group == group)
+      {
+        features++;
+        if (weight.second.size() > 1) colliding++;
+      }
+  if (features == 0) return false;
+  rate = static_cast<double>(colliding) / features;
+  return true;
+}
+
+void print_rate(std::ostream& out, bool known, double rate)
+{
+  if (known)
+    out << std::setw(10) << std::setprecision(2) << rate * 100. << '%';
+  else
+    out << std::setw(11) << '-';
+}
+
+void finish(hash_report& r)
+{
+  if (r.touched.empty()) return;
+  auto& out = r.all->trace_message;
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << std::fixed;
+
+  VW::hyperloglog all_features;
+  for (const auto& group : r.groups) all_features.merge(group.distinct);
+  const double distinct = all_features.estimate();
+  uint64_t touched = 0;
+  for (uint64_t word : r.touched)
+    for (; word != 0; word &= word - 1) touched++;
+  const uint64_t weights = static_cast<uint64_t>(1) << r.bits;
+
+  out << "hash report of the " << r.examples << " examples learned from, -b " << r.bits << ":" << std::endl;
+  out << std::left << std::setw(24) << "features of" << std::right << std::setw(14) << "features" << std::setw(14)
+      << "distinct" << std::setw(11) << "colliding" << std::endl;
+  double rate = 0.;
+  for (size_t g = 0; g < r.groups.size(); g++)
+  {
+    const auto& group = r.groups[g];
+    out << std::left << std::setw(24) << group.name << std::right << std::setw(14) << group.features << std::setw(14)
+        << std::setprecision(0) << group.distinct.estimate();
+    const bool known = sampled_collision_rate(r, g, rate);
+    print_rate(out, known, rate);
+    out << std::endl;
+  }
+  out << std::left << std::setw(24) << "all" << std::right << std::setw(14) << "" << std::setw(14)
+      << std::setprecision(0) << distinct;
+  const bool known = sampled_collision_rate(r, NO_GROUP, rate);
+  print_rate(out, known, rate);
+  out << std::endl;
+  out << "weights touched: " << touched << " of " << weights << " (" << std::setprecision(2)
+      << 100. * touched / weights << "%)" << std::endl;
+
+  out << "expected to collide at other -b:" << std::endl;
+  out << std::setw(4) << "-b" << std::setw(14) << "weights" << std::setw(12) << "megabytes" << std::setw(11)
+      << "colliding" << std::endl;
+  const double bytes_per_weight = static_cast<double>(sizeof(float) << r.stride_shift);
+  const uint32_t lowest = r.bits > 6 ? r.bits - 6 : 1;
+  const uint32_t highest = std::min<uint32_t>(r.bits + 6, 32);
+  for (uint32_t bits = lowest; bits <= highest; bits++)
+  {
+    out << std::setw(4) << bits << std::setw(14) << (static_cast<uint64_t>(1) << bits) << std::setw(12)
+        << std::setprecision(1) << std::ldexp(bytes_per_weight, static_cast<int>(bits)) / (1 << 20);
+    print_rate(out, true, VW::expected_collision_rate(distinct, bits));
+    out << std::endl;
+  }
+  uint32_t safe = 1;
+  while (safe < 64 && VW::expected_collision_rate(distinct, safe) >= SAFE_COLLISION_RATE) safe++;
+  out << "the smallest -b at which under " << std::setprecision(0) << SAFE_COLLISION_RATE * 100.
+      << "% of the features are expected to collide: " << safe << std::endl;
+
+  out.flags(flags);
+  out.precision(precision);
+}
+}  // namespace
+
+VW::LEARNER::base_learner* hash_report_setup(options_i& options, vw& all)
+{
+  bool report = false;
+  option_group_definition new_options("Hash Report");
+  new_options.add(make_option("hash_report", report)
+                      .necessary()
+                      .help("Count the distinct features of each namespace and interaction as they are learned from, "
+                            "and report at the end how many share a weight, how many weights were touched and the "
+                            "collisions expected at other -b"));
+
+  if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
+
+  auto r = scoped_calloc_or_throw<hash_report>();
+  r->all = &all;
+  // the features keep the whole of their hashes, and the weights mask them
+  all.full_hashes = true;
+
+  VW::LEARNER::learner<hash_report, example>& ret = VW::LEARNER::init_learner(
+      r, as_singleline(setup_base(options, all)), predict_or_learn<true>, predict_or_learn<false>);
+  ret.set_finish(finish);
+  return VW::LEARNER::make_base(ret);
+}
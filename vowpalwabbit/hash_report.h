@@ -0,0 +1,44 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "reductions_fwd.h"
+
+// --hash_report counts the distinct features of each namespace and interaction as gd visits them with
+// GD::foreach_feature, and estimates how many of them share a weight with another feature at the -b of the run, how
+// many weights were touched and which -b would keep collisions rare.
+VW::LEARNER::base_learner* hash_report_setup(VW::config::options_i& options, vw& all);
+
+namespace VW
+{
+// An estimate of the number of distinct 64 bit hashes added to it, within about 1.6% of it.
+class hyperloglog
+{
+public:
+  static constexpr uint32_t PRECISION = 12;
+  static constexpr size_t REGISTERS = size_t(1) << PRECISION;
+
+  hyperloglog() { _registers.fill(0); }
+
+  // The hash is to be well mixed, as mix(x) is.
+  void add(uint64_t hash);
+  // The registers of this and other, as if the hashes added to other had been added to this.
+  void merge(const hyperloglog& other);
+  double estimate() const;
+
+  static uint64_t mix(uint64_t x);
+
+private:
+  std::array<uint8_t, REGISTERS> _registers;
+};
+
+// The expected fraction of distinct features which share their weight with another one, when distinct features are
+// hashed to the 2^bits weights of -b bits.
+double expected_collision_rate(double distinct, uint32_t bits);
+}  // namespace VW
@@ -6,10 +6,16 @@
 #include <cstdint>  // defines size_t
 #include "future_compat.h"
 #include "hash.h"
+#include "xxh3.h"
 
-VW_STD14_CONSTEXPR inline uint64_t hashall(const char* s, size_t len, uint64_t h) { return uniform_hash(s, len, h); }
-
-VW_STD14_CONSTEXPR inline uint64_t hashstring(const char* s, size_t len, uint64_t h)
+namespace VW
+{
+namespace details
+{
+// The hash of a feature name, the number it is if it is digits only, else hash of it with the surrounding whitespace
+// trimmed.
+template <uint64_t (*hash)(const void*, size_t, uint64_t)>
+VW_STD14_CONSTEXPR inline uint64_t hashstring_with(const char* s, size_t len, uint64_t h)
 {
   const char* front = s;
   while (len > 0 && front[0] <= 0x20 && (int)(front[0]) >= 0)
@@ -25,7 +31,30 @@ VW_STD14_CONSTEXPR inline uint64_t hashstring(const char* s, size_t len, uint64_
     if (*p >= '0' && *p <= '9')
       ret = 10 * ret + *(p++) - '0';
     else
-      return uniform_hash(front, len, h);
+      return hash(front, len, h);
 
   return ret + h;
 }
+
+// XXH3 cut to the 32 bits of murmur3 hashes, which the features, the bindings and the models are made for.
+inline uint64_t xxh3_hash32(const void* key, size_t len, uint64_t seed)
+{
+  return xxh3_hash(key, len, seed) & 0xFFFFFFFF;
+}
+}  // namespace details
+}  // namespace VW
+
+VW_STD14_CONSTEXPR inline uint64_t hashall(const char* s, size_t len, uint64_t h) { return uniform_hash(s, len, h); }
+
+VW_STD14_CONSTEXPR inline uint64_t hashstring(const char* s, size_t len, uint64_t h)
+{
+  return VW::details::hashstring_with<uniform_hash>(s, len, h);
+}
+
+// hashall and hashstring of --hash_function xxh3, which is faster than murmur3 on the short names of most features.
+inline uint64_t hashall_xxh3(const char* s, size_t len, uint64_t h) { return VW::details::xxh3_hash32(s, len, h); }
+
+inline uint64_t hashstring_xxh3(const char* s, size_t len, uint64_t h)
+{
+  return VW::details::hashstring_with<VW::details::xxh3_hash32>(s, len, h);
+}
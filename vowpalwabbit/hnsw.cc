@@ -0,0 +1,215 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "hnsw.h"
+
+#include "io_buf.h"
+#include "rand48.h"
+#include "vw_exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <sstream>
+
+VW::hnsw_index::hnsw_index(size_t dim, size_t max_links, size_t ef_construction, uint64_t seed)
+    : _dim(dim)
+    , _max_links(std::max<size_t>(max_links, 2))
+    , _ef_construction(std::max(ef_construction, _max_links))
+    , _random_state(seed)
+    , _level_multiplier(1. / std::log(static_cast<double>(_max_links)))
+{
+}
+
+float VW::hnsw_index::similarity(const float* query, uint32_t id) const
+{
+  const float* v = vector(id);
+  float dot = 0.f;
+  for (size_t i = 0; i < _dim; i++) dot += query[i] * v[i];
+  return dot;
+}
+
+size_t VW::hnsw_index::draw_level()
+{
+  // merand48 is in [0, 1), so that 1 - merand48 is never 0.
+  return static_cast<size_t>(-std::log(1. - merand48(_random_state)) * _level_multiplier);
+}
+
+void VW::hnsw_index::search_level(
+    const float* query, std::vector<scored_node>& entries, size_t ef, size_t level) const
+{
+  if (++_search == 0)
+  {
+    std::fill(_visited.begin(), _visited.end(), 0);
+    _search = 1;
+  }
+
+  std::priority_queue<scored_node> candidates;
+  std::priority_queue<scored_node, std::vector<scored_node>, std::greater<scored_node>> best;
+  for (const auto& entry : entries)
+  {
+    _visited[entry.second] = _search;
+    candidates.push(entry);
+    best.push(entry);
+  }
+  while (best.size() > ef) best.pop();
+
+  while (!candidates.empty())
+  {
+    const scored_node candidate = candidates.top();
+    if (best.size() >= ef && candidate.first < best.top().first) break;
+    candidates.pop();
+    for (uint32_t neighbor : _links[candidate.second][level])
+    {
+      if (_visited[neighbor] == _search) continue;
+      _visited[neighbor] = _search;
+      const float s = similarity(query, neighbor);
+      if (best.size() < ef || s > best.top().first)
+      {
+        candidates.push({s, neighbor});
+        best.push({s, neighbor});
+        if (best.size() > ef) best.pop();
+      }
+    }
+  }
+
+  entries.resize(best.size());
+  for (size_t i = entries.size(); i > 0; i--)
+  {
+    entries[i - 1] = best.top();
+    best.pop();
+  }
+}
+
+void VW::hnsw_index::connect(uint32_t from, uint32_t to, size_t level)
+{
+  auto& links = _links[from][level];
+  links.push_back(to);
+  if (links.size() <= max_links(level)) return;
+
+  // Keep the links to the nodes most similar to from.
+  const float* v = vector(from);
+  std::vector<scored_node> scored;
+  scored.reserve(links.size());
+  for (uint32_t id : links) scored.push_back({similarity(v, id), id});
+  std::partial_sort(scored.begin(), scored.begin() + max_links(level), scored.end(), std::greater<scored_node>());
+  links.resize(max_links(level));
+  for (size_t i = 0; i < links.size(); i++) links[i] = scored[i].second;
+}
+
+uint32_t VW::hnsw_index::add(const float* v)
+{
+  const auto id = static_cast<uint32_t>(size());
+  const size_t level = draw_level();
+  _vectors.insert(_vectors.end(), v, v + _dim);
+  _links.emplace_back(level + 1);
+  _visited.push_back(0);
+  if (id == 0)
+  {
+    _entry = id;
+    _max_level = level;
+    return id;
+  }
+
+  std::vector<scored_node> entries = {{similarity(v, _entry), _entry}};
+  for (size_t l = _max_level; l > level; l--) search_level(v, entries, 1, l);
+  for (size_t l = std::min(level, _max_level) + 1; l-- > 0;)
+  {
+    search_level(v, entries, _ef_construction, l);
+    auto& links = _links[id][l];
+    for (size_t i = 0; i < entries.size() && links.size() < max_links(l); i++) links.push_back(entries[i].second);
+    for (uint32_t neighbor : links) connect(neighbor, id, l);
+  }
+  if (level > _max_level)
+  {
+    _max_level = level;
+    _entry = id;
+  }
+  return id;
+}
+
+void VW::hnsw_index::update(uint32_t id, const float* v)
+{
+  std::copy(v, v + _dim, _vectors.begin() + static_cast<size_t>(id) * _dim);
+}
+
+void VW::hnsw_index::search(const float* query, size_t k, size_t ef, std::vector<uint32_t>& ids) const
+{
+  ids.clear();
+  if (size() == 0 || k == 0) return;
+
+  std::vector<scored_node> entries = {{similarity(query, _entry), _entry}};
+  for (size_t l = _max_level; l > 0; l--) search_level(query, entries, 1, l);
+  search_level(query, entries, std::max(ef, k), 0);
+  for (size_t i = 0; i < entries.size() && i < k; i++) ids.push_back(entries[i].second);
+}
+
+namespace
+{
+template <typename T>
+void read_write(io_buf& model_file, T& value, bool read)
+{
+  std::stringstream msg;
+  bin_text_read_write_fixed_validated(model_file, reinterpret_cast<char*>(&value), sizeof(value), "", read, msg, false);
+}
+
+template <typename T>
+void read_write(io_buf& model_file, std::vector<T>& values, bool read)
+{
+  uint64_t size = values.size();
+  read_write(model_file, size, read);
+  if (read) values.resize(size);
+  std::stringstream msg;
+  bin_text_read_write_fixed_validated(
+      model_file, reinterpret_cast<char*>(values.data()), size * sizeof(T), "", read, msg, false);
+}
+}  // namespace
+
+void VW::hnsw_index::save_load(io_buf& model_file, bool read, bool text)
+{
+  if (text)
+  {
+    // Readable models only describe the graph.
+    std::stringstream msg;
+    msg << "hnsw vectors = " << size() << " dim = " << _dim << "\n";
+    bin_text_write_fixed(model_file, nullptr, 0, msg, true);
+    return;
+  }
+
+  uint64_t dim = _dim;
+  uint64_t max_links = _max_links;
+  uint64_t ef_construction = _ef_construction;
+  uint64_t random_state = _random_state;
+  uint32_t entry = _entry;
+  uint64_t max_level = _max_level;
+  uint64_t num_nodes = size();
+  read_write(model_file, dim, read);
+  read_write(model_file, max_links, read);
+  read_write(model_file, ef_construction, read);
+  read_write(model_file, random_state, read);
+  read_write(model_file, entry, read);
+  read_write(model_file, max_level, read);
+  read_write(model_file, num_nodes, read);
+  if (read)
+  {
+    if (dim != _dim) THROW("hnsw index of vectors of " << dim << " floats, expected " << _dim);
+    *this = hnsw_index(dim, max_links, ef_construction, random_state);
+    _entry = entry;
+    _max_level = max_level;
+    _links.resize(num_nodes);
+    _visited.assign(num_nodes, 0);
+  }
+
+  read_write(model_file, _vectors, read);
+  if (_vectors.size() != num_nodes * dim)
+  { THROW("hnsw index holds " << _vectors.size() << " floats, expected " << num_nodes * dim); }
+  for (auto& node : _links)
+  {
+    uint64_t levels = node.size();
+    read_write(model_file, levels, read);
+    if (read) node.resize(levels);
+    for (auto& links : node) read_write(model_file, links, read);
+  }
+}
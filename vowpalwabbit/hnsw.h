@@ -0,0 +1,66 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class io_buf;
+
+namespace VW
+{
+// A hierarchical navigable small world graph (Malkov and Yashunin, 2018) over vectors of dim floats, searched for the
+// vectors with the largest inner products with a query. Vectors are added one at a time and can be updated in place,
+// which keeps the links found when they were added, so that the graph degrades gracefully as the vectors drift.
+class hnsw_index
+{
+public:
+  // Nodes keep up to max_links links on every level but the lowest one, where they keep twice as many, chosen among
+  // the ef_construction nodes found closest as they are added.
+  explicit hnsw_index(size_t dim = 0, size_t max_links = 16, size_t ef_construction = 64, uint64_t seed = 0);
+
+  size_t dim() const { return _dim; }
+  size_t size() const { return _links.size(); }
+  const float* vector(uint32_t id) const { return _vectors.data() + static_cast<size_t>(id) * _dim; }
+
+  // Adds a vector and returns its id, the number of vectors added before it.
+  uint32_t add(const float* v);
+
+  void update(uint32_t id, const float* v);
+
+  // Finds up to k of the vectors with the largest inner products with query, best first, among the max(ef, k)
+  // candidates which the search of the lowest level keeps.
+  void search(const float* query, size_t k, size_t ef, std::vector<uint32_t>& ids) const;
+
+  void save_load(io_buf& model_file, bool read, bool text);
+
+private:
+  using scored_node = std::pair<float, uint32_t>;
+
+  float similarity(const float* query, uint32_t id) const;
+  size_t max_links(size_t level) const { return level == 0 ? 2 * _max_links : _max_links; }
+  size_t draw_level();
+  void connect(uint32_t from, uint32_t to, size_t level);
+
+  // Replaces entries, the nodes to start from, with the up to ef best nodes found on level, best first.
+  void search_level(const float* query, std::vector<scored_node>& entries, size_t ef, size_t level) const;
+
+  size_t _dim;
+  size_t _max_links;
+  size_t _ef_construction;
+  uint64_t _random_state;
+  double _level_multiplier;
+
+  std::vector<float> _vectors;
+  std::vector<std::vector<std::vector<uint32_t>>> _links;  // of every node, on each of its levels
+  uint32_t _entry = 0;                                     // the node of the highest level
+  size_t _max_level = 0;
+
+  mutable std::vector<uint32_t> _visited;  // the search which last visited each node
+  mutable uint32_t _search = 0;
+};
+}  // namespace VW
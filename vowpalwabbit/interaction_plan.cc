@@ -0,0 +1,51 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "interaction_plan.h"
+
+namespace INTERACTIONS
+{
+interaction_plan::interaction_plan(const std::vector<std::vector<namespace_index>>& interactions)
+    : _interactions(&interactions), _size(interactions.size())
+{
+  namespace_set used;
+  _required.reserve(interactions.size());
+  for (const auto& interaction : interactions)
+  {
+    namespace_set required;
+    for (namespace_index ns : interaction) required.set(ns);
+    _required.push_back(required);
+    used |= required;
+  }
+  for (size_t ns = 0; ns < NUM_NAMESPACES; ns++)
+    if (used.test(ns)) _namespaces.push_back(static_cast<namespace_index>(ns));
+}
+
+const std::vector<std::vector<namespace_index>>& interaction_plan::active(
+    const std::vector<std::vector<namespace_index>>& interactions, const example_predict& ec)
+{
+  if (&interactions != _interactions || interactions.size() != _size) return interactions;
+
+  const namespaced_features& feature_space = ec.feature_space;
+  namespace_set nonempty;
+  for (namespace_index ns : _namespaces)
+    if (feature_space[ns].nonempty()) nonempty.set(ns);
+
+  std::lock_guard<std::mutex> lock(_lock);
+  auto found = _active.find(nonempty);
+  if (found != _active.end()) return found->second;
+  if (_active.size() >= MAX_PLANNED_SETS) return interactions;
+
+  std::vector<std::vector<namespace_index>> active;
+  for (size_t i = 0; i < _required.size(); i++)
+    if ((_required[i] & ~nonempty).none()) active.push_back(interactions[i]);
+  return _active.emplace(nonempty, std::move(active)).first->second;
+}
+
+size_t interaction_plan::planned_sets()
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  return _active.size();
+}
+}  // namespace INTERACTIONS
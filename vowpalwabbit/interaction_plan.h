@@ -0,0 +1,65 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Mutex cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <mutex>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <mutex>
+#endif
+
+#include "constant.h"
+#include "example_predict.h"
+
+namespace INTERACTIONS
+{
+// Interaction lists this long, such as those wildcards expand to, are given a plan.
+constexpr size_t MIN_PLANNED_INTERACTIONS = 32;
+
+// Of many interactions, most usually have a namespace without features in any one example, which generate_interactions
+// and eval_count_of_generated_ft would check and skip. The plan of an interaction list keeps, for each set of
+// namespaces with features seen in examples, the interactions of the list all of whose namespaces are in the set, so
+// that an example only visits the interactions which generate features for it.
+class interaction_plan
+{
+public:
+  // Distinct sets of namespaces past this many are not kept, their examples visit every interaction.
+  static constexpr size_t MAX_PLANNED_SETS = 1024;
+
+  explicit interaction_plan(const std::vector<std::vector<namespace_index>>& interactions);
+
+  interaction_plan(const interaction_plan&) = delete;
+  interaction_plan& operator=(const interaction_plan&) = delete;
+
+  // The interactions which generate features for ec, in the order of the list. Lists other than the one the plan was
+  // made for, or that list once its length changed, are returned whole.
+  const std::vector<std::vector<namespace_index>>& active(
+      const std::vector<std::vector<namespace_index>>& interactions, const example_predict& ec);
+
+  size_t planned_sets();
+
+private:
+  using namespace_set = std::bitset<NUM_NAMESPACES>;
+
+  const std::vector<std::vector<namespace_index>>* _interactions;
+  size_t _size;
+  std::vector<namespace_index> _namespaces;  // each namespace of any of the interactions, once
+  std::vector<namespace_set> _required;      // the namespaces of each interaction
+
+  std::mutex _lock;
+  // The entries are never removed, so the lists handed out stay valid for the life of the plan.
+  std::unordered_map<namespace_set, std::vector<std::vector<namespace_index>>> _active;
+};
+}  // namespace INTERACTIONS
@@ -4,6 +4,8 @@
 
 #include "interactions.h"
 
+#include "constant.h"
+#include "interaction_plan.h"
 #include "vw_exception.h"
 #include <algorithm>
 
@@ -169,6 +171,31 @@ void sort_and_filter_duplicate_interactions(
   vec = res;
 }
 
+std::string namespace_name(namespace_index ns)
+{
+  if (ns == constant_namespace) return "constant";
+  if (ns == ' ') return "default";
+  if (is_printable_namespace(ns)) return std::string(1, static_cast<char>(ns));
+  return std::to_string(static_cast<int>(ns));
+}
+
+std::string interaction_name(const std::vector<namespace_index>& interaction)
+{
+  std::string name;
+  for (namespace_index ns : interaction)
+  {
+    if (!name.empty()) name += '*';
+    name += namespace_name(ns);
+  }
+  return name;
+}
+
+const std::vector<std::vector<namespace_index>>& planned_interactions(
+    vw& all, const std::vector<std::vector<namespace_index>>& interactions, const example_predict& ec)
+{
+  return all.interaction_plan->active(interactions, ec);
+}
+
 /*
  *  Estimation of generated features properties
  */
@@ -227,11 +254,12 @@ void eval_count_of_generated_ft(vw& all, example& ec, size_t& new_features_cnt,
   new_features_value = 0.;
 
   v_array<float> results = v_init<float>();
+  const auto& interactions = active_interactions(all, *ec.interactions, ec);
 
   if (all.permutations)
   {
     // just multiply precomputed values for all namespaces
-    for (const auto& inter : *ec.interactions)
+    for (const auto& inter : interactions)
     {
       size_t num_features_in_inter = 1;
       float sum_feat_sq_in_inter = 1.;
@@ -258,7 +286,7 @@ void eval_count_of_generated_ft(vw& all, example& ec, size_t& new_features_cnt,
     generate_interactions<eval_gen_data, uint64_t, ft_cnt>(all, ec, dat);
 #endif
 
-    for (auto& inter : *ec.interactions)
+    for (auto& inter : interactions)
     {
       size_t num_features_in_inter = 1;
       float sum_feat_sq_in_inter = 1.;
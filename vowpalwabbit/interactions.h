@@ -38,10 +38,26 @@ std::vector<std::vector<namespace_index>> expand_interactions(
 void sort_and_filter_duplicate_interactions(
     std::vector<std::vector<namespace_index>>& vec, bool filter_duplicates, size_t& removed_cnt, size_t& sorted_cnt);
 
+// the name of a namespace as reports print it: its character when printable, or its index
+std::string namespace_name(namespace_index ns);
+// the names of the namespaces of an interaction joined by '*'
+std::string interaction_name(const std::vector<namespace_index>& interaction);
+
 /*
  *  Feature combinations generation
  */
 
+// the interactions of interactions, the list of all or of ec, which generate features for ec: those of the
+// interaction_plan when the list has one
+const std::vector<std::vector<namespace_index>>& planned_interactions(
+    vw& all, const std::vector<std::vector<namespace_index>>& interactions, const example_predict& ec);
+
+inline const std::vector<std::vector<namespace_index>>& active_interactions(
+    vw& all, const std::vector<std::vector<namespace_index>>& interactions, const example_predict& ec)
+{
+  return all.interaction_plan == nullptr ? interactions : planned_interactions(all, interactions, ec);
+}
+
 // function estimates how many new features will be generated for example and ther sum(value^2).
 void eval_count_of_generated_ft(vw& all, example& ec, size_t& new_features_cnt, float& new_features_value);
 
@@ -50,10 +66,10 @@ inline void generate_interactions(vw& all, example_predict& ec, R& dat)
 {
   if (all.weights.sparse)
     generate_interactions<R, S, T, audit, audit_func, sparse_parameters>(
-        *ec.interactions, all.permutations, ec, dat, all.weights.sparse_weights);
+        active_interactions(all, *ec.interactions, ec), all.permutations, ec, dat, all.weights.sparse_weights);
   else
     generate_interactions<R, S, T, audit, audit_func, dense_parameters>(
-        *ec.interactions, all.permutations, ec, dat, all.weights.dense_weights);
+        active_interactions(all, *ec.interactions, ec), all.permutations, ec, dat, all.weights.dense_weights);
 }
 
 // this code is for C++98/03 complience as I unable to pass null function-pointer as template argument in g++-4.6
@@ -62,10 +78,10 @@ inline void generate_interactions(vw& all, example_predict& ec, R& dat)
 {
   if (all.weights.sparse)
     generate_interactions<R, S, T, sparse_parameters>(
-        all.interactions, all.permutations, ec, dat, all.weights.sparse_weights);
+        active_interactions(all, all.interactions, ec), all.permutations, ec, dat, all.weights.sparse_weights);
   else
     generate_interactions<R, S, T, dense_parameters>(
-        all.interactions, all.permutations, ec, dat, all.weights.dense_weights);
+        active_interactions(all, all.interactions, ec), all.permutations, ec, dat, all.weights.dense_weights);
 }
 
 // C(n,k) = n!/(k!(n-k)!)
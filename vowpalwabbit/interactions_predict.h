@@ -4,8 +4,10 @@
 #pragma once
 
 #include <cstdint>
+#include "array_parameters_dense.h"
 #include "constant.h"
 #include "feature_group.h"
+#include "interactions_simd.h"
 #include <vector>
 #include <string>
 
@@ -45,6 +47,23 @@ inline void call_T(R& dat, W& /*weights*/, const float ft_value, const uint64_t
   T(dat, ft_value, ft_idx);
 }
 
+// Software prefetching of the weights of features further along, see dense_parameters::prefetch_distance. Other
+// weights, such as sparse ones which are found by hashing, are not prefetched.
+template <class W>
+inline std::ptrdiff_t prefetch_distance(const W& /*weights*/)
+{
+  return 0;
+}
+
+inline std::ptrdiff_t prefetch_distance(const dense_parameters& weights) { return weights.prefetch_distance(); }
+
+template <class W>
+inline void prefetch_weight(const W& /*weights*/, const uint64_t /*ft_idx*/)
+{
+}
+
+inline void prefetch_weight(const dense_parameters& weights, const uint64_t ft_idx) { weights.prefetch(ft_idx); }
+
 // state data used in non-recursive feature generation algorithm
 // contains N feature_gen_data records (where N is length of interaction)
 struct feature_gen_data
@@ -62,9 +81,64 @@ struct feature_gen_data
 // The inline function below may be adjusted to change the way
 // synthetic (interaction) features' values are calculated, e.g.,
 // fabs(value1-value2) or even value1>value2?1.0:-1.0
-// Beware - its result must be non-zero.
+// Beware - its result must be non-zero, and interaction_dot_product must compute it alike.
 inline float INTERACTION_VALUE(float value1, float value2) { return value1 * value2; }
 
+// Computes what a kernel T adds for one feature paired with [begin, end) at once, returning false to leave it to T
+// feature by feature. Specialized for the T which sum value * weight into a float, such as GD::vec_add, which dense
+// weights then compute with interaction_dot_product.
+template <class R, class S, void (*T)(R&, float, S)>
+struct dot_product_kernel
+{
+  template <class W>
+  static bool add(R& /*dat*/, features::iterator_all& /*begin*/, features::iterator_all& /*end*/,
+      const uint64_t /*offset*/, W& /*weights*/, feature_value /*ft_value*/, feature_index /*halfhash*/)
+  {
+    return false;
+  }
+
+  // The same for the linear features of fs, with ft_value mult and no halfhash.
+  template <class W>
+  static bool add_linear(R& /*dat*/, features& /*fs*/, const uint64_t /*offset*/, W& /*weights*/, float /*mult*/)
+  {
+    return false;
+  }
+};
+
+template <class W>
+inline bool add_dot_product(float& /*dat*/, features::iterator_all& /*begin*/, features::iterator_all& /*end*/,
+    const uint64_t /*offset*/, const W& /*weights*/, feature_value /*ft_value*/, feature_index /*halfhash*/)
+{
+  return false;
+}
+
+inline bool add_dot_product(float& dat, features::iterator_all& begin, features::iterator_all& end,
+    const uint64_t offset, const dense_parameters& weights, feature_value ft_value, feature_index halfhash)
+{
+  const std::ptrdiff_t count = end - begin;
+  if (count < SIMD_MIN_FEATURES) return false;
+  dat += interaction_dot_product(
+      &begin.value(), &begin.index(), count, ft_value, halfhash, offset, &weights[0], weights.mask());
+  return true;
+}
+
+template <class W>
+inline bool add_linear_dot_product(
+    float& /*dat*/, features& /*fs*/, const uint64_t /*offset*/, const W& /*weights*/, float /*mult*/)
+{
+  return false;
+}
+
+inline bool add_linear_dot_product(
+    float& dat, features& fs, const uint64_t offset, const dense_parameters& weights, float mult)
+{
+  const std::ptrdiff_t count = fs.size();
+  if (count < SIMD_MIN_FEATURES) return false;
+  dat += interaction_dot_product(fs.values.begin(), fs.indicies.begin(), count, mult, 0, offset, &weights[0],
+      weights.mask());
+  return true;
+}
+
 // uncomment line below to disable usage of inner 'for' loops for pair and triple interactions
 // end switch to usage of non-recursive feature generation algorithm for interactions of any length
 
@@ -85,6 +159,14 @@ inline void inner_kernel(R& dat, features::iterator_all& begin, features::iterat
   }
   else
   {
+    if (dot_product_kernel<R, S, T>::add(dat, begin, end, offset, weights, ft_value, halfhash)) return;
+
+    const std::ptrdiff_t ahead = prefetch_distance(weights);
+    for (std::ptrdiff_t prefetched = (ahead > 0) ? (end - begin) - ahead : 0; prefetched > 0; --prefetched, ++begin)
+    {
+      prefetch_weight(weights, ((static_cast<features::iterator&>(begin) + ahead).index() ^ halfhash) + offset);
+      call_T<R, T>(dat, weights, INTERACTION_VALUE(ft_value, begin.value()), (begin.index() ^ halfhash) + offset);
+    }
     for (; begin != end; ++begin)
       call_T<R, T>(dat, weights, INTERACTION_VALUE(ft_value, begin.value()), (begin.index() ^ halfhash) + offset);
   }
@@ -95,11 +177,11 @@ inline void inner_kernel(R& dat, features::iterator_all& begin, features::iterat
 // it must be in header file to avoid compilation problems
 template <class R, class S, void (*T)(R&, float, S), bool audit, void (*audit_func)(R&, const audit_strings*),
     class W>  // nullptr func can't be used as template param in old compilers
-inline void generate_interactions(std::vector<std::vector<namespace_index>>& interactions, bool permutations,
+inline void generate_interactions(const std::vector<std::vector<namespace_index>>& interactions, bool permutations,
     example_predict& ec, R& dat,
     W& weights)  // default value removed to eliminate ambiguity in old complers
 {
-  features* features_data = ec.feature_space.data();
+  namespaced_features& features_data = ec.feature_space;
 
   // often used values
   const uint64_t offset = ec.ft_offset;
@@ -0,0 +1,137 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "interactions_simd.h"
+
+#include "cpu_features.h"
+
+// The kernels are compiled for their instruction sets whatever the flags of the build, and picked at run time. Only
+// GCC and Clang can target an instruction set per function.
+#if !defined(VW_NO_INLINE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#  define VW_INTERACTIONS_SIMD
+#  include <immintrin.h>
+#endif
+
+namespace
+{
+// Must match INTERACTIONS::INTERACTION_VALUE, which is a product.
+float scalar_dot_product(const float* values, const uint64_t* indices, size_t count, float ft_value,
+    uint64_t halfhash, uint64_t offset, const float* weights, uint64_t mask)
+{
+  float sum = 0.f;
+  for (size_t i = 0; i < count; i++) sum += weights[((indices[i] ^ halfhash) + offset) & mask] * (ft_value * values[i]);
+  return sum;
+}
+
+#ifdef VW_INTERACTIONS_SIMD
+__attribute__((target("avx2,fma"))) inline float horizontal_sum(__m256 v)
+{
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma"))) inline __m256i hash_indices(
+    const uint64_t* indices, __m256i halfhash, __m256i offset, __m256i mask)
+{
+  const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices));
+  return _mm256_and_si256(_mm256_add_epi64(_mm256_xor_si256(index, halfhash), offset), mask);
+}
+
+__attribute__((target("avx2,fma"))) float avx2_dot_product(const float* values, const uint64_t* indices, size_t count,
+    float ft_value, uint64_t halfhash, uint64_t offset, const float* weights, uint64_t mask)
+{
+  const __m256i halfhashes = _mm256_set1_epi64x(static_cast<long long>(halfhash));
+  const __m256i offsets = _mm256_set1_epi64x(static_cast<long long>(offset));
+  const __m256i masks = _mm256_set1_epi64x(static_cast<long long>(mask));
+  const __m256 ft_values = _mm256_set1_ps(ft_value);
+  __m256 sum = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    // A gather takes 4 64 bit indices.
+    const __m128 low = _mm256_i64gather_ps(weights, hash_indices(indices + i, halfhashes, offsets, masks), 4);
+    const __m128 high = _mm256_i64gather_ps(weights, hash_indices(indices + i + 4, halfhashes, offsets, masks), 4);
+    const __m256 w = _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+    const __m256 x = _mm256_mul_ps(ft_values, _mm256_loadu_ps(values + i));
+    sum = _mm256_fmadd_ps(w, x, sum);
+  }
+  return horizontal_sum(sum) +
+      scalar_dot_product(values + i, indices + i, count - i, ft_value, halfhash, offset, weights, mask);
+}
+
+__attribute__((target("avx512f,avx2,fma"))) inline __m512i hash_indices(
+    const uint64_t* indices, __m512i halfhash, __m512i offset, __m512i mask)
+{
+  const __m512i index = _mm512_loadu_si512(indices);
+  return _mm512_and_si512(_mm512_add_epi64(_mm512_xor_si512(index, halfhash), offset), mask);
+}
+
+__attribute__((target("avx512f,avx2,fma"))) float avx512_dot_product(const float* values, const uint64_t* indices,
+    size_t count, float ft_value, uint64_t halfhash, uint64_t offset, const float* weights, uint64_t mask)
+{
+  const __m512i halfhashes = _mm512_set1_epi64(static_cast<long long>(halfhash));
+  const __m512i offsets = _mm512_set1_epi64(static_cast<long long>(offset));
+  const __m512i masks = _mm512_set1_epi64(static_cast<long long>(mask));
+  const __m256 ft_values = _mm256_set1_ps(ft_value);
+  __m256 low_sum = _mm256_setzero_ps();
+  __m256 high_sum = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    // A gather takes 8 64 bit indices. All lanes are gathered, the masked form only starts them from zero.
+    const __m256 low = _mm512_mask_i64gather_ps(
+        _mm256_setzero_ps(), 0xff, hash_indices(indices + i, halfhashes, offsets, masks), weights, 4);
+    const __m256 high = _mm512_mask_i64gather_ps(
+        _mm256_setzero_ps(), 0xff, hash_indices(indices + i + 8, halfhashes, offsets, masks), weights, 4);
+    low_sum = _mm256_fmadd_ps(low, _mm256_mul_ps(ft_values, _mm256_loadu_ps(values + i)), low_sum);
+    high_sum = _mm256_fmadd_ps(high, _mm256_mul_ps(ft_values, _mm256_loadu_ps(values + i + 8)), high_sum);
+  }
+  const float sum = horizontal_sum(_mm256_add_ps(low_sum, high_sum));
+  if (i + 8 <= count)
+    return sum + avx2_dot_product(values + i, indices + i, count - i, ft_value, halfhash, offset, weights, mask);
+  return sum + scalar_dot_product(values + i, indices + i, count - i, ft_value, halfhash, offset, weights, mask);
+}
+#endif
+
+using kernel_fn = float (*)(const float*, const uint64_t*, size_t, float, uint64_t, uint64_t, const float*,
+    uint64_t);
+
+struct kernel
+{
+  kernel_fn dot_product;
+  const char* variant;
+};
+
+kernel select_kernel()
+{
+#ifdef VW_INTERACTIONS_SIMD
+  const VW::cpu_features& cpu = VW::detected_cpu_features();
+  if (cpu.avx512f) return {avx512_dot_product, "avx512"};
+  if (cpu.avx2 && cpu.fma) return {avx2_dot_product, "avx2"};
+#endif
+  return {scalar_dot_product, "scalar"};
+}
+
+// Selected the first time it is needed, which may be from a static initializer of its own.
+const kernel& selected()
+{
+  static const kernel selection = select_kernel();
+  return selection;
+}
+}  // namespace
+
+namespace INTERACTIONS
+{
+float interaction_dot_product(const float* values, const uint64_t* indices, size_t count, float ft_value,
+    uint64_t halfhash, uint64_t offset, const float* weights, uint64_t mask)
+{
+  return selected().dot_product(values, indices, count, ft_value, halfhash, offset, weights, mask);
+}
+
+const char* interaction_kernel_variant() { return selected().variant; }
+}  // namespace INTERACTIONS
@@ -0,0 +1,24 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace INTERACTIONS
+{
+// Fewer features than this are not worth the call, the scalar loop handles them.
+constexpr std::ptrdiff_t SIMD_MIN_FEATURES = 8;
+
+/// \return the sum over the count features of
+///   INTERACTION_VALUE(ft_value, values[i]) * weights[((indices[i] ^ halfhash) + offset) & mask]
+/// which is what pairing one feature with a namespace adds to a prediction. The indices are hashed and the weights
+/// gathered 16 at a time with AVX-512 or 8 at a time with AVX2, as the CPU supports, and one at a time otherwise.
+float interaction_dot_product(const float* values, const uint64_t* indices, size_t count, float ft_value,
+    uint64_t halfhash, uint64_t offset, const float* weights, uint64_t mask);
+
+// avx512, avx2 or scalar, whichever interaction_dot_product runs.
+const char* interaction_kernel_variant();
+}  // namespace INTERACTIONS
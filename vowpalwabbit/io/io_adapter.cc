@@ -7,6 +7,7 @@
 #  include <io.h>
 #else
 #  include <sys/socket.h>
+#  include <sys/mman.h>
 #  include <unistd.h>
 #endif
 
@@ -21,6 +22,27 @@
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "../queue.h"
+#include "../thread_affinity.h"
+
+#ifdef VW_USE_ZSTD
+#  include <zstd.h>
+#endif
+#ifdef VW_USE_LZ4
+#  include <lz4frame.h>
+#endif
+#ifdef VW_USE_KAFKA
+#  include <map>
+#  include <set>
+#  include <librdkafka/rdkafka.h>
+#endif
 
 #include <zlib.h>
 #if (ZLIB_VERNUM < 0x1252)
@@ -72,12 +94,36 @@ struct file_adapter : public writer, public reader
   ssize_t read(char* buffer, size_t num_bytes) override;
   ssize_t write(const char* buffer, size_t num_bytes) override;
   void reset() override;
+  bool seek(uint64_t offset) override;
+  char* map(uint64_t offset, size_t length) override;
 
 private:
   int _file_descriptor;
   file_mode _mode;
 };
 
+#ifndef _WIN32
+struct mmap_file_adapter : public reader
+{
+  mmap_file_adapter(char* data, size_t len);
+  ~mmap_file_adapter();
+  ssize_t read(char* buffer, size_t num_bytes) override;
+  size_t take_view(char*& data) override;
+  void reset() override;
+  bool seek(uint64_t offset) override;
+
+private:
+  // Views are handed out a window at a time so that the following window can be prefetched.
+  static constexpr size_t WINDOW_SIZE = 1 << 24;
+
+  void prefetch(size_t offset);
+
+  char* _data;
+  size_t _len;
+  size_t _offset;
+};
+#endif
+
 struct gzip_file_adapter : public writer, public reader
 {
   gzip_file_adapter(const char* filename, file_mode mode);
@@ -93,6 +139,54 @@ private:
   file_mode _mode;
 };
 
+#ifdef VW_USE_ZSTD
+struct zstd_file_adapter : public writer, public reader
+{
+  zstd_file_adapter(const char* filename, file_mode mode);
+  ~zstd_file_adapter();
+  ssize_t read(char* buffer, size_t num_bytes) override;
+  ssize_t write(const char* buffer, size_t num_bytes) override;
+  void flush() override;
+  void reset() override;
+
+private:
+  // Feeds input to the compressor and writes out everything it produces.
+  void compress(ZSTD_inBuffer& input, ZSTD_EndDirective directive);
+
+  file_adapter _file;
+  file_mode _mode;
+  ZSTD_CCtx* _cctx = nullptr;
+  ZSTD_DCtx* _dctx = nullptr;
+  std::vector<char> _buffer;  // compressed bytes on their way from or to the file
+  ZSTD_inBuffer _input = {nullptr, 0, 0};
+};
+#endif
+
+#ifdef VW_USE_LZ4
+struct lz4_file_adapter : public writer, public reader
+{
+  lz4_file_adapter(const char* filename, file_mode mode);
+  ~lz4_file_adapter();
+  ssize_t read(char* buffer, size_t num_bytes) override;
+  ssize_t write(const char* buffer, size_t num_bytes) override;
+  void flush() override;
+  void reset() override;
+
+private:
+  static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+  void write_buffer(size_t num_bytes);
+
+  file_adapter _file;
+  file_mode _mode;
+  LZ4F_cctx* _cctx = nullptr;
+  LZ4F_dctx* _dctx = nullptr;
+  std::vector<char> _buffer;  // compressed bytes on their way from or to the file
+  size_t _input_pos = 0;
+  size_t _input_size = 0;
+};
+#endif
+
 struct gzip_stdio_adapter : public writer, public reader
 {
   gzip_stdio_adapter();
@@ -105,6 +199,241 @@ private:
   gzFile _gz_stdout;
 };
 
+struct read_ahead_reader : public reader
+{
+  read_ahead_reader(std::unique_ptr<reader>&& inner, size_t num_buffers, size_t buffer_size);
+  ~read_ahead_reader();
+  ssize_t read(char* buffer, size_t num_bytes) override;
+  void reset() override;
+
+private:
+  void start();
+  void stop();
+  void io_loop();
+
+  std::unique_ptr<reader> _inner;
+  // Ring of buffers, [_read_index, _read_index + _num_filled) hold data which has not been handed out yet.
+  std::vector<std::vector<char>> _buffers;
+  std::vector<size_t> _lengths;
+  size_t _read_index = 0;
+  size_t _read_offset = 0;
+  size_t _num_filled = 0;
+  bool _end_of_input = false;
+  bool _stop = false;
+  std::exception_ptr _exc_ptr;
+
+  std::mutex _lock;
+  std::condition_variable _filled;
+  std::condition_variable _drained;
+  std::thread _io_thread;
+};
+
+namespace
+{
+// BGZF is gzip made of independent members of at most 64KB, each recording its own size in an extra field. That allows
+// members to be found without inflating their predecessors and so to be processed in parallel.
+constexpr size_t BGZF_HEADER_SIZE = 18;
+constexpr size_t BGZF_FOOTER_SIZE = 8;
+constexpr size_t BGZF_MAX_BLOCK_SIZE = 1 << 16;
+// Leaves room for the deflate overhead on incompressible data.
+constexpr size_t BGZF_MAX_PAYLOAD_SIZE = 0xff00;
+constexpr unsigned char BGZF_EOF_BLOCK[28] = {0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00,
+    0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+struct block_job
+{
+  std::vector<char> input;
+  std::vector<char> output;
+  std::exception_ptr exc_ptr;
+  bool done = false;
+};
+
+// Applies a transform to blocks on a fixed set of threads. Jobs finish in any order, callers wait for each one in
+// turn.
+class block_pipeline
+{
+public:
+  block_pipeline(size_t num_threads, std::function<void(block_job&)> transform);
+  ~block_pipeline();
+
+  void submit(block_job* job);
+  void wait_for(block_job* job);
+  bool is_done(block_job* job);
+
+private:
+  void worker_loop();
+
+  std::function<void(block_job&)> _transform;
+  VW::ptr_queue<block_job> _pending;
+  std::vector<std::thread> _workers;
+  std::mutex _done_lock;
+  std::condition_variable _done_cv;
+};
+
+// Jobs in flight for a pipeline, in submission order, plus a free list so their buffers are reused.
+struct block_jobs
+{
+  block_jobs(size_t max_in_flight) : max_in_flight(max_in_flight) {}
+
+  block_job* get_free()
+  {
+    if (free_jobs.empty())
+    {
+      all_jobs.emplace_back(new block_job);
+      return all_jobs.back().get();
+    }
+    auto* job = free_jobs.back();
+    free_jobs.pop_back();
+    return job;
+  }
+
+  void recycle(block_job* job)
+  {
+    job->input.clear();
+    job->output.clear();
+    job->exc_ptr = nullptr;
+    job->done = false;
+    free_jobs.push_back(job);
+  }
+
+  const size_t max_in_flight;
+  std::deque<block_job*> in_flight;
+  std::vector<block_job*> free_jobs;
+  std::vector<std::unique_ptr<block_job>> all_jobs;
+};
+
+uint16_t read_le16(const char* p)
+{
+  return static_cast<uint16_t>(static_cast<unsigned char>(p[0]) | (static_cast<unsigned char>(p[1]) << 8));
+}
+
+uint32_t read_le32(const char* p) { return read_le16(p) | (static_cast<uint32_t>(read_le16(p + 2)) << 16); }
+
+void write_le16(char* p, uint16_t value)
+{
+  p[0] = static_cast<char>(value & 0xff);
+  p[1] = static_cast<char>(value >> 8);
+}
+
+void write_le32(char* p, uint32_t value)
+{
+  write_le16(p, static_cast<uint16_t>(value & 0xffff));
+  write_le16(p + 2, static_cast<uint16_t>(value >> 16));
+}
+
+bool is_bgzf_header(const char* header)
+{
+  return static_cast<unsigned char>(header[0]) == 0x1f && static_cast<unsigned char>(header[1]) == 0x8b &&
+      header[2] == 8 && (header[3] & 4) != 0 && read_le16(header + 10) == 6 && header[12] == 'B' &&
+      header[13] == 'C' && read_le16(header + 14) == 2;
+}
+
+// Reads until num_bytes have been read or the reader is exhausted.
+size_t read_fully(reader& file, char* buffer, size_t num_bytes)
+{
+  size_t total = 0;
+  while (total < num_bytes)
+  {
+    ssize_t num_read = file.read(buffer + total, num_bytes - total);
+    if (num_read <= 0) { break; }
+    total += num_read;
+  }
+  return total;
+}
+
+void inflate_bgzf_block(block_job& job)
+{
+  const char* block = job.input.data();
+  const size_t block_size = job.input.size();
+  const uint32_t expected_crc = read_le32(block + block_size - BGZF_FOOTER_SIZE);
+  const uint32_t payload_size = read_le32(block + block_size - 4);
+  job.output.resize(payload_size);
+  if (payload_size == 0) { return; }
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) { THROW("BGZF: failed to initialize inflate"); }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block + BGZF_HEADER_SIZE));
+  stream.avail_in = static_cast<uInt>(block_size - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE);
+  stream.next_out = reinterpret_cast<Bytef*>(job.output.data());
+  stream.avail_out = payload_size;
+  const int status = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+
+  if (status != Z_STREAM_END || stream.total_out != payload_size) { THROW("BGZF: corrupt block"); }
+  if (crc32(0, reinterpret_cast<const Bytef*>(job.output.data()), payload_size) != expected_crc)
+  { THROW("BGZF: checksum mismatch"); }
+}
+
+void deflate_bgzf_block(block_job& job)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  { THROW("BGZF: failed to initialize deflate"); }
+
+  const auto payload_size = static_cast<uLong>(job.input.size());
+  job.output.resize(BGZF_HEADER_SIZE + deflateBound(&stream, payload_size) + BGZF_FOOTER_SIZE);
+  stream.next_in = reinterpret_cast<Bytef*>(job.input.data());
+  stream.avail_in = static_cast<uInt>(payload_size);
+  stream.next_out = reinterpret_cast<Bytef*>(job.output.data() + BGZF_HEADER_SIZE);
+  stream.avail_out = static_cast<uInt>(job.output.size() - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE);
+  const int status = deflate(&stream, Z_FINISH);
+  deflateEnd(&stream);
+  if (status != Z_STREAM_END) { THROW("BGZF: failed to compress block"); }
+
+  const size_t block_size = BGZF_HEADER_SIZE + stream.total_out + BGZF_FOOTER_SIZE;
+  if (block_size > BGZF_MAX_BLOCK_SIZE) { THROW("BGZF: compressed block too large"); }
+  job.output.resize(block_size);
+
+  char* block = job.output.data();
+  memcpy(block, BGZF_EOF_BLOCK, BGZF_HEADER_SIZE - 2);
+  write_le16(block + 16, static_cast<uint16_t>(block_size - 1));
+  write_le32(block + block_size - BGZF_FOOTER_SIZE,
+      static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(job.input.data()), payload_size)));
+  write_le32(block + block_size - 4, static_cast<uint32_t>(payload_size));
+}
+}  // namespace
+
+struct bgzf_reader : public reader
+{
+  bgzf_reader(std::unique_ptr<reader>&& file, size_t num_threads);
+  ~bgzf_reader();
+  ssize_t read(char* buffer, size_t num_bytes) override;
+  void reset() override;
+
+private:
+  // Reads the next compressed block into block. Returns false at the end of the file.
+  bool read_block(std::vector<char>& block);
+  void drain();
+
+  std::unique_ptr<reader> _file;
+  block_jobs _jobs;
+  block_pipeline _pipeline;
+  block_job* _current = nullptr;
+  size_t _offset = 0;
+  bool _end_of_file = false;
+};
+
+struct bgzf_writer : public writer
+{
+  bgzf_writer(std::unique_ptr<writer>&& file, size_t num_threads);
+  ~bgzf_writer();
+  ssize_t write(const char* buffer, size_t num_bytes) override;
+  /// Writes out the blocks which have been compressed so far. The partially filled block is kept, it is written when
+  /// the writer is destroyed.
+  void flush() override;
+
+private:
+  void submit_current();
+  void write_completed(bool wait);
+
+  std::unique_ptr<writer> _file;
+  block_jobs _jobs;
+  block_pipeline _pipeline;
+  block_job* _current;
+};
+
 struct vector_writer : public writer
 {
   vector_writer(std::shared_ptr<std::vector<char>>& buffer);
@@ -115,12 +444,29 @@ private:
   std::shared_ptr<std::vector<char>> _buffer;
 };
 
+struct buffered_writer : public writer
+{
+  buffered_writer(std::unique_ptr<writer>&& inner, size_t buffer_size);
+  ~buffered_writer();
+  ssize_t write(const char* buffer, size_t num_bytes) override;
+  void flush() override;
+
+private:
+  // Writes out the buffered bytes and empties the buffer. Returns whether all of them were written.
+  bool write_buffer();
+
+  std::unique_ptr<writer> _inner;
+  std::vector<char> _buffer;
+  size_t _size = 0;
+};
+
 struct buffer_view : public reader
 {
   buffer_view(const char* data, size_t len);
   ~buffer_view() = default;
   ssize_t read(char* buffer, size_t num_bytes) override;
   void reset() override;
+  bool seek(uint64_t offset) override;
 
 private:
   const char* _data;
@@ -128,6 +474,53 @@ private:
   size_t _len;
 };
 
+#ifdef VW_USE_KAFKA
+// The consumer of a Kafka topic, shared by its reader and the commits of its checkpoints, which outlive the reader.
+class kafka_consumer
+{
+public:
+  explicit kafka_consumer(const kafka_options& options);
+  ~kafka_consumer();
+
+  rd_kafka_message_t* poll(int timeout_ms) { return rd_kafka_consumer_poll(_handle, timeout_ms); }
+  // Whether every partition assigned to this consumer is in partitions.
+  bool assigned_within(const std::set<int32_t>& partitions);
+
+  // Queues the offsets, the next record of each partition, of a checkpoint whose save command was read.
+  void checkpoint(const std::map<int32_t, int64_t>& next_offsets);
+  // Commits the offsets of the oldest queued checkpoint.
+  void commit_checkpoint();
+
+private:
+  std::string _topic;
+  rd_kafka_t* _handle = nullptr;
+  std::mutex _lock;
+  std::deque<std::map<int32_t, int64_t>> _checkpoints;
+};
+
+struct kafka_reader : public reader
+{
+  kafka_reader(std::shared_ptr<kafka_consumer> consumer, const kafka_options& options);
+  ssize_t read(char* buffer, size_t num_bytes) override;
+
+private:
+  // Queues the contents of a record, or notes that a partition was read to its end, and returns whether the input
+  // ended.
+  bool take(rd_kafka_message_t& message);
+  void add_checkpoint();
+
+  std::shared_ptr<kafka_consumer> _consumer;
+  uint64_t _checkpoint_records;
+  bool _stop_at_end;
+  std::vector<char> _pending;  // bytes of records taken which were not read yet
+  size_t _pending_offset = 0;
+  std::map<int32_t, int64_t> _next_offsets;
+  std::set<int32_t> _partitions_at_end;
+  uint64_t _records_since_checkpoint = 0;
+  bool _ended = false;
+};
+#endif
+
 namespace VW
 {
 namespace io
@@ -137,11 +530,54 @@ std::unique_ptr<writer> open_file_writer(const std::string& file_path)
   return std::unique_ptr<writer>(new file_adapter(file_path.c_str(), file_mode::write));
 }
 
+std::unique_ptr<writer> open_buffered_file_writer(const std::string& file_path, size_t buffer_size)
+{
+  auto file = open_file_writer(file_path);
+#ifdef _WIN32
+  _UNUSED(buffer_size);
+  return file;
+#else
+  struct stat file_stat;
+  struct stat stdout_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) { return file; }
+  // -p /dev/stdout redirected to a file must stay in order with what else is written to stdout.
+  if (fstat(STDOUT_FILENO, &stdout_stat) == 0 && stdout_stat.st_dev == file_stat.st_dev &&
+      stdout_stat.st_ino == file_stat.st_ino)
+  { return file; }
+  return std::unique_ptr<writer>(new buffered_writer(std::move(file), buffer_size));
+#endif
+}
+
 std::unique_ptr<reader> open_file_reader(const std::string& file_path)
 {
   return std::unique_ptr<reader>(new file_adapter(file_path.c_str(), file_mode::read));
 }
 
+std::unique_ptr<reader> open_mapped_file_reader(const std::string& file_path)
+{
+#ifdef _WIN32
+  return open_file_reader(file_path);
+#else
+  int file_descriptor = open(file_path.c_str(), O_RDONLY | O_LARGEFILE);
+  if (file_descriptor == -1) { THROWERRNO("can't open: " << file_path); }
+
+  struct stat file_stat;
+  if (fstat(file_descriptor, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0)
+  {
+    const auto len = static_cast<size_t>(file_stat.st_size);
+    // A private writable mapping lets parsers modify the buffer in place like they can with read, without ever
+    // touching the file.
+    void* data = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_descriptor, 0);
+    if (data != MAP_FAILED)
+    {
+      ::close(file_descriptor);
+      return std::unique_ptr<reader>(new mmap_file_adapter(static_cast<char*>(data), len));
+    }
+  }
+  return std::unique_ptr<reader>(new file_adapter(file_descriptor, file_mode::read));
+#endif
+}
+
 std::unique_ptr<writer> open_compressed_file_writer(const std::string& file_path)
 {
   return std::unique_ptr<writer>(new gzip_file_adapter(file_path.c_str(), file_mode::write));
@@ -152,6 +588,109 @@ std::unique_ptr<reader> open_compressed_file_reader(const std::string& file_path
   return std::unique_ptr<reader>(new gzip_file_adapter(file_path.c_str(), file_mode::read));
 }
 
+std::unique_ptr<reader> open_parallel_compressed_file_reader(const std::string& file_path, size_t num_threads)
+{
+  auto file = open_file_reader(file_path);
+  char header[BGZF_HEADER_SIZE];
+  if (read_fully(*file, header, BGZF_HEADER_SIZE) != BGZF_HEADER_SIZE || !is_bgzf_header(header))
+  { return open_compressed_file_reader(file_path); }
+  file->reset();
+  return std::unique_ptr<reader>(new bgzf_reader(std::move(file), num_threads));
+}
+
+std::unique_ptr<writer> open_parallel_compressed_file_writer(const std::string& file_path, size_t num_threads)
+{
+  return std::unique_ptr<writer>(new bgzf_writer(open_file_writer(file_path), num_threads));
+}
+
+compression_format parse_compression_format(const std::string& name)
+{
+  if (name == "none") { return compression_format::none; }
+  if (name == "gzip") { return compression_format::gzip; }
+  if (name == "zstd")
+  {
+#ifdef VW_USE_ZSTD
+    return compression_format::zstd;
+#else
+    THROW("zstd compression is not available, rebuild with USE_ZSTD");
+#endif
+  }
+  if (name == "lz4")
+  {
+#ifdef VW_USE_LZ4
+    return compression_format::lz4;
+#else
+    THROW("lz4 compression is not available, rebuild with USE_LZ4");
+#endif
+  }
+  THROW("unknown compression format '" << name << "', expected none, gzip, zstd or lz4");
+}
+
+compression_format detect_compression_format(const std::string& file_path)
+{
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0 || (file_stat.st_mode & S_IFMT) != S_IFREG)
+  { return compression_format::none; }
+
+  std::ifstream file(file_path, std::ios::binary);
+  char magic[4] = {0};
+  file.read(magic, sizeof(magic));
+  const auto num_read = file.gcount();
+  if (num_read >= 2 && static_cast<unsigned char>(magic[0]) == 0x1f && static_cast<unsigned char>(magic[1]) == 0x8b)
+  { return compression_format::gzip; }
+  if (num_read == 4 && read_le32(magic) == 0xfd2fb528) { return compression_format::zstd; }
+  if (num_read == 4 && read_le32(magic) == 0x184d2204) { return compression_format::lz4; }
+  return compression_format::none;
+}
+
+std::unique_ptr<reader> open_compressed_file_reader(const std::string& file_path, compression_format format)
+{
+  switch (format)
+  {
+    case compression_format::none:
+      return open_file_reader(file_path);
+    case compression_format::gzip:
+      return open_compressed_file_reader(file_path);
+    case compression_format::zstd:
+#ifdef VW_USE_ZSTD
+      return std::unique_ptr<reader>(new zstd_file_adapter(file_path.c_str(), file_mode::read));
+#else
+      THROW("cannot read zstd compressed '" << file_path << "', rebuild with USE_ZSTD");
+#endif
+    case compression_format::lz4:
+#ifdef VW_USE_LZ4
+      return std::unique_ptr<reader>(new lz4_file_adapter(file_path.c_str(), file_mode::read));
+#else
+      THROW("cannot read lz4 compressed '" << file_path << "', rebuild with USE_LZ4");
+#endif
+  }
+  THROW("unknown compression format");
+}
+
+std::unique_ptr<writer> open_compressed_file_writer(const std::string& file_path, compression_format format)
+{
+  switch (format)
+  {
+    case compression_format::none:
+      return open_file_writer(file_path);
+    case compression_format::gzip:
+      return open_compressed_file_writer(file_path);
+    case compression_format::zstd:
+#ifdef VW_USE_ZSTD
+      return std::unique_ptr<writer>(new zstd_file_adapter(file_path.c_str(), file_mode::write));
+#else
+      THROW("cannot write zstd compressed '" << file_path << "', rebuild with USE_ZSTD");
+#endif
+    case compression_format::lz4:
+#ifdef VW_USE_LZ4
+      return std::unique_ptr<writer>(new lz4_file_adapter(file_path.c_str(), file_mode::write));
+#else
+      THROW("cannot write lz4 compressed '" << file_path << "', rebuild with USE_LZ4");
+#endif
+  }
+  THROW("unknown compression format");
+}
+
 std::unique_ptr<reader> open_compressed_stdin() { return std::unique_ptr<reader>(new gzip_stdio_adapter()); }
 
 std::unique_ptr<writer> open_compressed_stdout() { return std::unique_ptr<writer>(new gzip_stdio_adapter()); }
@@ -167,6 +706,25 @@ std::unique_ptr<writer> create_vector_writer(std::shared_ptr<std::vector<char>>&
   return std::unique_ptr<writer>(new vector_writer(buffer));
 }
 
+std::unique_ptr<reader> create_read_ahead_reader(
+    std::unique_ptr<reader>&& inner, size_t num_buffers, size_t buffer_size)
+{
+  return std::unique_ptr<reader>(new read_ahead_reader(std::move(inner), num_buffers, buffer_size));
+}
+
+std::unique_ptr<reader> open_kafka_reader(const kafka_options& options, std::function<void()>& commit_checkpoint)
+{
+#ifdef VW_USE_KAFKA
+  auto consumer = std::make_shared<kafka_consumer>(options);
+  commit_checkpoint = [consumer] { consumer->commit_checkpoint(); };
+  return std::unique_ptr<reader>(new kafka_reader(consumer, options));
+#else
+  _UNUSED(options);
+  _UNUSED(commit_checkpoint);
+  THROW("reading Kafka topics is not available, rebuild with USE_KAFKA");
+#endif
+}
+
 std::unique_ptr<reader> create_buffer_view(const char* data, size_t len)
 {
   return std::unique_ptr<reader>(new buffer_view(data, len));
@@ -296,6 +854,34 @@ void file_adapter::reset()
 #endif
 }
 
+bool file_adapter::seek(uint64_t offset)
+{
+  assert(_mode == file_mode::read);
+#ifdef _WIN32
+  return ::_lseeki64(_file_descriptor, static_cast<__int64>(offset), SEEK_SET) != -1;
+#else
+  return ::lseek(_file_descriptor, static_cast<off_t>(offset), SEEK_SET) != -1;
+#endif
+}
+
+char* file_adapter::map(uint64_t offset, size_t length)
+{
+#ifdef __linux__
+  struct stat status;
+  if (_mode != file_mode::read || length == 0 || offset % static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) != 0 ||
+      fstat(_file_descriptor, &status) != 0 || !S_ISREG(status.st_mode) ||
+      static_cast<uint64_t>(status.st_size) < offset + length)
+    return nullptr;
+  // Private, so that pages written to are copied and the file stays as it is.
+  void* data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, _file_descriptor, static_cast<off_t>(offset));
+  return data == MAP_FAILED ? nullptr : static_cast<char*>(data);
+#else
+  (void)offset;
+  (void)length;
+  return nullptr;
+#endif
+}
+
 file_adapter::~file_adapter()
 {
 #ifdef _WIN32
@@ -305,6 +891,63 @@ file_adapter::~file_adapter()
 #endif
 }
 
+//
+// mmap_file_adapter
+//
+
+#ifndef _WIN32
+constexpr size_t mmap_file_adapter::WINDOW_SIZE;
+
+mmap_file_adapter::mmap_file_adapter(char* data, size_t len)
+    : reader(true /*is_resettable*/), _data(data), _len(len), _offset(0)
+{
+  madvise(_data, _len, MADV_SEQUENTIAL);
+  prefetch(0);
+}
+
+mmap_file_adapter::~mmap_file_adapter() { munmap(_data, _len); }
+
+ssize_t mmap_file_adapter::read(char* buffer, size_t num_bytes)
+{
+  num_bytes = std::min(num_bytes, _len - _offset);
+  std::memcpy(buffer, _data + _offset, num_bytes);
+  _offset += num_bytes;
+  return num_bytes;
+}
+
+size_t mmap_file_adapter::take_view(char*& data)
+{
+  const size_t num_bytes = std::min(WINDOW_SIZE, _len - _offset);
+  data = _data + _offset;
+  _offset += num_bytes;
+  prefetch(_offset);
+  return num_bytes;
+}
+
+void mmap_file_adapter::reset()
+{
+  _offset = 0;
+  prefetch(0);
+}
+
+bool mmap_file_adapter::seek(uint64_t offset)
+{
+  if (offset > _len) { return false; }
+  _offset = static_cast<size_t>(offset);
+  prefetch(_offset);
+  return true;
+}
+
+void mmap_file_adapter::prefetch(size_t offset)
+{
+  if (offset >= _len) { return; }
+  // madvise requires a page aligned address.
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t aligned_offset = offset - offset % page_size;
+  madvise(_data + aligned_offset, std::min(WINDOW_SIZE, _len - aligned_offset), MADV_WILLNEED);
+}
+#endif
+
 //
 // gzip_file_adapter
 //
@@ -313,7 +956,7 @@ gzip_file_adapter::gzip_file_adapter(const char* filename, file_mode mode) : rea
 {
   auto file_mode_arg = _mode == file_mode::read ? "rb" : "wb";
   _gz_file = gzopen(filename, file_mode_arg);
-  // TODO test for failure
+  if (_gz_file == nullptr) { THROWERRNO("can't open: " << filename); }
 }
 
 gzip_file_adapter::gzip_file_adapter(int file_descriptor, file_mode mode) : reader(true /*is_resettable*/), _mode(mode)
@@ -342,6 +985,191 @@ ssize_t gzip_file_adapter::write(const char* buffer, size_t num_bytes)
 
 void gzip_file_adapter::reset() { gzseek(_gz_file, 0, SEEK_SET); }
 
+//
+// zstd_file_adapter
+//
+
+#ifdef VW_USE_ZSTD
+zstd_file_adapter::zstd_file_adapter(const char* filename, file_mode mode)
+    : reader(true /*is_resettable*/), _file(filename, mode), _mode(mode)
+{
+  if (_mode == file_mode::read)
+  {
+    _dctx = ZSTD_createDCtx();
+    _buffer.resize(ZSTD_DStreamInSize());
+  }
+  else
+  {
+    _cctx = ZSTD_createCCtx();
+    _buffer.resize(ZSTD_CStreamOutSize());
+  }
+  if (_dctx == nullptr && _cctx == nullptr) { THROW("zstd: failed to create context"); }
+}
+
+zstd_file_adapter::~zstd_file_adapter()
+{
+  if (_cctx != nullptr)
+  {
+    try
+    {
+      ZSTD_inBuffer input = {nullptr, 0, 0};
+      compress(input, ZSTD_e_end);
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "error, failed to finish compressed file: " << e.what() << std::endl;
+    }
+    ZSTD_freeCCtx(_cctx);
+  }
+  if (_dctx != nullptr) { ZSTD_freeDCtx(_dctx); }
+}
+
+ssize_t zstd_file_adapter::read(char* buffer, size_t num_bytes)
+{
+  assert(_mode == file_mode::read);
+  ZSTD_outBuffer output = {buffer, num_bytes, 0};
+  while (output.pos == 0 && num_bytes > 0)
+  {
+    if (_input.pos == _input.size)
+    {
+      ssize_t num_read = _file.read(_buffer.data(), _buffer.size());
+      if (num_read <= 0) { return 0; }
+      _input = {_buffer.data(), static_cast<size_t>(num_read), 0};
+    }
+    const size_t ret = ZSTD_decompressStream(_dctx, &output, &_input);
+    if (ZSTD_isError(ret)) { THROW("zstd: " << ZSTD_getErrorName(ret)); }
+  }
+  return output.pos;
+}
+
+ssize_t zstd_file_adapter::write(const char* buffer, size_t num_bytes)
+{
+  assert(_mode == file_mode::write);
+  ZSTD_inBuffer input = {buffer, num_bytes, 0};
+  compress(input, ZSTD_e_continue);
+  return num_bytes;
+}
+
+void zstd_file_adapter::flush()
+{
+  ZSTD_inBuffer input = {nullptr, 0, 0};
+  compress(input, ZSTD_e_flush);
+}
+
+void zstd_file_adapter::reset()
+{
+  _file.reset();
+  ZSTD_DCtx_reset(_dctx, ZSTD_reset_session_only);
+  _input = {nullptr, 0, 0};
+}
+
+void zstd_file_adapter::compress(ZSTD_inBuffer& input, ZSTD_EndDirective directive)
+{
+  bool finished = false;
+  while (!finished)
+  {
+    ZSTD_outBuffer output = {_buffer.data(), _buffer.size(), 0};
+    const size_t remaining = ZSTD_compressStream2(_cctx, &output, &input, directive);
+    if (ZSTD_isError(remaining)) { THROW("zstd: " << ZSTD_getErrorName(remaining)); }
+    if (output.pos > 0 && _file.write(_buffer.data(), output.pos) != static_cast<ssize_t>(output.pos))
+    { THROW("zstd: failed to write compressed data"); }
+    finished = directive == ZSTD_e_continue ? input.pos == input.size : remaining == 0;
+  }
+}
+#endif
+
+//
+// lz4_file_adapter
+//
+
+#ifdef VW_USE_LZ4
+constexpr size_t lz4_file_adapter::CHUNK_SIZE;
+
+lz4_file_adapter::lz4_file_adapter(const char* filename, file_mode mode)
+    : reader(true /*is_resettable*/), _file(filename, mode), _mode(mode)
+{
+  if (_mode == file_mode::read)
+  {
+    if (LZ4F_isError(LZ4F_createDecompressionContext(&_dctx, LZ4F_VERSION))) { THROW("lz4: failed to create context"); }
+    _buffer.resize(CHUNK_SIZE);
+  }
+  else
+  {
+    if (LZ4F_isError(LZ4F_createCompressionContext(&_cctx, LZ4F_VERSION))) { THROW("lz4: failed to create context"); }
+    _buffer.resize(LZ4F_HEADER_SIZE_MAX + LZ4F_compressBound(CHUNK_SIZE, nullptr));
+    write_buffer(LZ4F_compressBegin(_cctx, _buffer.data(), _buffer.size(), nullptr));
+  }
+}
+
+lz4_file_adapter::~lz4_file_adapter()
+{
+  if (_cctx != nullptr)
+  {
+    try
+    {
+      write_buffer(LZ4F_compressEnd(_cctx, _buffer.data(), _buffer.size(), nullptr));
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "error, failed to finish compressed file: " << e.what() << std::endl;
+    }
+    LZ4F_freeCompressionContext(_cctx);
+  }
+  if (_dctx != nullptr) { LZ4F_freeDecompressionContext(_dctx); }
+}
+
+ssize_t lz4_file_adapter::read(char* buffer, size_t num_bytes)
+{
+  assert(_mode == file_mode::read);
+  while (num_bytes > 0)
+  {
+    if (_input_pos == _input_size)
+    {
+      ssize_t num_read = _file.read(_buffer.data(), _buffer.size());
+      if (num_read <= 0) { return 0; }
+      _input_pos = 0;
+      _input_size = static_cast<size_t>(num_read);
+    }
+    size_t num_decompressed = num_bytes;
+    size_t num_consumed = _input_size - _input_pos;
+    const size_t ret =
+        LZ4F_decompress(_dctx, buffer, &num_decompressed, _buffer.data() + _input_pos, &num_consumed, nullptr);
+    if (LZ4F_isError(ret)) { THROW("lz4: " << LZ4F_getErrorName(ret)); }
+    _input_pos += num_consumed;
+    if (num_decompressed > 0) { return num_decompressed; }
+  }
+  return 0;
+}
+
+ssize_t lz4_file_adapter::write(const char* buffer, size_t num_bytes)
+{
+  assert(_mode == file_mode::write);
+  for (size_t offset = 0; offset < num_bytes; offset += CHUNK_SIZE)
+  {
+    const size_t num = std::min(CHUNK_SIZE, num_bytes - offset);
+    write_buffer(LZ4F_compressUpdate(_cctx, _buffer.data(), _buffer.size(), buffer + offset, num, nullptr));
+  }
+  return num_bytes;
+}
+
+void lz4_file_adapter::flush() { write_buffer(LZ4F_flush(_cctx, _buffer.data(), _buffer.size(), nullptr)); }
+
+void lz4_file_adapter::reset()
+{
+  _file.reset();
+  LZ4F_resetDecompressionContext(_dctx);
+  _input_pos = 0;
+  _input_size = 0;
+}
+
+void lz4_file_adapter::write_buffer(size_t num_bytes)
+{
+  if (LZ4F_isError(num_bytes)) { THROW("lz4: " << LZ4F_getErrorName(num_bytes)); }
+  if (num_bytes > 0 && _file.write(_buffer.data(), num_bytes) != static_cast<ssize_t>(num_bytes))
+  { THROW("lz4: failed to write compressed data"); }
+}
+#endif
+
 //
 // gzip_stdio_adapter
 //
@@ -375,6 +1203,345 @@ ssize_t gzip_stdio_adapter::write(const char* buffer, size_t num_bytes)
   return (num_written > 0) ? (size_t)num_written : 0;
 }
 
+//
+// read_ahead_reader
+//
+
+read_ahead_reader::read_ahead_reader(std::unique_ptr<reader>&& inner, size_t num_buffers, size_t buffer_size)
+    : reader(inner->is_resettable())
+    , _inner(std::move(inner))
+    , _buffers(std::max<size_t>(num_buffers, 1), std::vector<char>(buffer_size))
+    , _lengths(_buffers.size(), 0)
+{
+  start();
+}
+
+read_ahead_reader::~read_ahead_reader() { stop(); }
+
+ssize_t read_ahead_reader::read(char* buffer, size_t num_bytes)
+{
+  {
+    std::unique_lock<std::mutex> lock(_lock);
+    _filled.wait(lock, [this] { return _num_filled > 0 || _end_of_input; });
+    if (_num_filled == 0)
+    {
+      if (_exc_ptr) { std::rethrow_exception(_exc_ptr); }
+      return 0;
+    }
+  }
+
+  // The I/O thread never touches a filled buffer, so it can be copied from without holding the lock.
+  const auto& current = _buffers[_read_index];
+  num_bytes = std::min(num_bytes, _lengths[_read_index] - _read_offset);
+  std::memcpy(buffer, current.data() + _read_offset, num_bytes);
+  _read_offset += num_bytes;
+
+  if (_read_offset == _lengths[_read_index])
+  {
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _read_index = (_read_index + 1) % _buffers.size();
+      _read_offset = 0;
+      _num_filled--;
+    }
+    _drained.notify_one();
+  }
+  return num_bytes;
+}
+
+void read_ahead_reader::reset()
+{
+  stop();
+  _inner->reset();
+  start();
+}
+
+void read_ahead_reader::start()
+{
+  _read_index = 0;
+  _read_offset = 0;
+  _num_filled = 0;
+  _end_of_input = false;
+  _stop = false;
+  _exc_ptr = nullptr;
+  _io_thread = std::thread(&read_ahead_reader::io_loop, this);
+}
+
+void read_ahead_reader::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _stop = true;
+  }
+  _drained.notify_one();
+  _io_thread.join();
+}
+
+void read_ahead_reader::io_loop()
+{
+  VW::pin_current_thread(VW::thread_role::io);
+  size_t write_index = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_lock);
+      _drained.wait(lock, [this] { return _num_filled < _buffers.size() || _stop; });
+      if (_stop) { return; }
+    }
+
+    ssize_t num_read = 0;
+    try
+    {
+      num_read = _inner->read(_buffers[write_index].data(), _buffers[write_index].size());
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _exc_ptr = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      if (num_read <= 0) { _end_of_input = true; }
+      else
+      {
+        _lengths[write_index] = static_cast<size_t>(num_read);
+        _num_filled++;
+      }
+    }
+    _filled.notify_one();
+    if (num_read <= 0) { return; }
+    write_index = (write_index + 1) % _buffers.size();
+  }
+}
+
+//
+// block_pipeline
+//
+
+block_pipeline::block_pipeline(size_t num_threads, std::function<void(block_job&)> transform)
+    : _transform(std::move(transform)), _pending(2 * num_threads)
+{
+  _workers.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; i++) { _workers.emplace_back(&block_pipeline::worker_loop, this); }
+}
+
+block_pipeline::~block_pipeline()
+{
+  _pending.set_done();
+  for (auto& worker : _workers) { worker.join(); }
+}
+
+void block_pipeline::submit(block_job* job) { _pending.push(job); }
+
+void block_pipeline::wait_for(block_job* job)
+{
+  std::unique_lock<std::mutex> lock(_done_lock);
+  _done_cv.wait(lock, [job] { return job->done; });
+}
+
+bool block_pipeline::is_done(block_job* job)
+{
+  std::lock_guard<std::mutex> lock(_done_lock);
+  return job->done;
+}
+
+void block_pipeline::worker_loop()
+{
+  VW::pin_current_thread(VW::thread_role::io);
+  while (auto* job = _pending.pop())
+  {
+    try
+    {
+      _transform(*job);
+    }
+    catch (...)
+    {
+      job->exc_ptr = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_done_lock);
+      job->done = true;
+    }
+    _done_cv.notify_all();
+  }
+}
+
+//
+// bgzf_reader
+//
+
+bgzf_reader::bgzf_reader(std::unique_ptr<reader>&& file, size_t num_threads)
+    : reader(file->is_resettable())
+    , _file(std::move(file))
+    , _jobs(2 * std::max<size_t>(num_threads, 1))
+    , _pipeline(std::max<size_t>(num_threads, 1), inflate_bgzf_block)
+{
+}
+
+bgzf_reader::~bgzf_reader() { drain(); }
+
+ssize_t bgzf_reader::read(char* buffer, size_t num_bytes)
+{
+  while (_current == nullptr || _offset == _current->output.size())
+  {
+    if (_current != nullptr)
+    {
+      _jobs.recycle(_current);
+      _current = nullptr;
+    }
+
+    while (!_end_of_file && _jobs.in_flight.size() < _jobs.max_in_flight)
+    {
+      auto* job = _jobs.get_free();
+      if (!read_block(job->input))
+      {
+        _jobs.recycle(job);
+        _end_of_file = true;
+        break;
+      }
+      _pipeline.submit(job);
+      _jobs.in_flight.push_back(job);
+    }
+    if (_jobs.in_flight.empty()) { return 0; }
+
+    _current = _jobs.in_flight.front();
+    _jobs.in_flight.pop_front();
+    _offset = 0;
+    _pipeline.wait_for(_current);
+    if (_current->exc_ptr) { std::rethrow_exception(_current->exc_ptr); }
+  }
+
+  num_bytes = std::min(num_bytes, _current->output.size() - _offset);
+  memcpy(buffer, _current->output.data() + _offset, num_bytes);
+  _offset += num_bytes;
+  return num_bytes;
+}
+
+void bgzf_reader::reset()
+{
+  drain();
+  _file->reset();
+  _end_of_file = false;
+}
+
+bool bgzf_reader::read_block(std::vector<char>& block)
+{
+  block.resize(BGZF_HEADER_SIZE);
+  const size_t header_size = read_fully(*_file, block.data(), BGZF_HEADER_SIZE);
+  if (header_size == 0) { return false; }
+  if (header_size != BGZF_HEADER_SIZE || !is_bgzf_header(block.data()))
+  { THROW("BGZF: truncated or non BGZF block in compressed input"); }
+
+  const size_t block_size = read_le16(block.data() + 16) + 1;
+  if (block_size < BGZF_HEADER_SIZE + BGZF_FOOTER_SIZE) { THROW("BGZF: invalid block size"); }
+  block.resize(block_size);
+  const size_t remaining = block_size - BGZF_HEADER_SIZE;
+  if (read_fully(*_file, block.data() + BGZF_HEADER_SIZE, remaining) != remaining)
+  { THROW("BGZF: truncated block in compressed input"); }
+  return true;
+}
+
+void bgzf_reader::drain()
+{
+  for (auto* job : _jobs.in_flight)
+  {
+    _pipeline.wait_for(job);
+    _jobs.recycle(job);
+  }
+  _jobs.in_flight.clear();
+  if (_current != nullptr)
+  {
+    _jobs.recycle(_current);
+    _current = nullptr;
+  }
+}
+
+//
+// bgzf_writer
+//
+
+bgzf_writer::bgzf_writer(std::unique_ptr<writer>&& file, size_t num_threads)
+    : _file(std::move(file))
+    , _jobs(2 * std::max<size_t>(num_threads, 1))
+    , _pipeline(std::max<size_t>(num_threads, 1), deflate_bgzf_block)
+    , _current(_jobs.get_free())
+{
+}
+
+bgzf_writer::~bgzf_writer()
+{
+  try
+  {
+    if (!_current->input.empty()) { submit_current(); }
+    write_completed(true);
+    _file->write(reinterpret_cast<const char*>(BGZF_EOF_BLOCK), sizeof(BGZF_EOF_BLOCK));
+    _file->flush();
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error, failed to finish compressed file: " << e.what() << std::endl;
+  }
+}
+
+ssize_t bgzf_writer::write(const char* buffer, size_t num_bytes)
+{
+  size_t remaining = num_bytes;
+  while (remaining > 0)
+  {
+    const size_t num = std::min(remaining, BGZF_MAX_PAYLOAD_SIZE - _current->input.size());
+    _current->input.insert(_current->input.end(), buffer, buffer + num);
+    buffer += num;
+    remaining -= num;
+    if (_current->input.size() == BGZF_MAX_PAYLOAD_SIZE) { submit_current(); }
+  }
+  return num_bytes;
+}
+
+void bgzf_writer::flush()
+{
+  write_completed(false);
+  _file->flush();
+}
+
+void bgzf_writer::submit_current()
+{
+  _pipeline.submit(_current);
+  _jobs.in_flight.push_back(_current);
+  _current = _jobs.get_free();
+  if (_jobs.in_flight.size() >= _jobs.max_in_flight)
+  {
+    // Wait for the oldest block so that memory stays bounded.
+    _pipeline.wait_for(_jobs.in_flight.front());
+    write_completed(false);
+  }
+}
+
+void bgzf_writer::write_completed(bool wait)
+{
+  while (!_jobs.in_flight.empty())
+  {
+    auto* job = _jobs.in_flight.front();
+    if (wait) { _pipeline.wait_for(job); }
+    else if (!_pipeline.is_done(job))
+    {
+      break;
+    }
+
+    _jobs.in_flight.pop_front();
+    if (job->exc_ptr)
+    {
+      auto exc_ptr = job->exc_ptr;
+      _jobs.recycle(job);
+      std::rethrow_exception(exc_ptr);
+    }
+    if (_file->write(job->output.data(), job->output.size()) != static_cast<ssize_t>(job->output.size()))
+    { THROW("BGZF: failed to write compressed block"); }
+    _jobs.recycle(job);
+  }
+}
+
 //
 // vector_writer
 //
@@ -388,6 +1555,53 @@ ssize_t vector_writer::write(const char* buffer, size_t num_bytes)
   return num_bytes;
 }
 
+//
+// buffered_writer
+//
+
+buffered_writer::buffered_writer(std::unique_ptr<writer>&& inner, size_t buffer_size)
+    : _inner(std::move(inner)), _buffer(std::max<size_t>(buffer_size, 1))
+{
+}
+
+buffered_writer::~buffered_writer()
+{
+  if (!write_buffer()) { std::cerr << "write error: " << VW::strerror_to_string(errno) << std::endl; }
+}
+
+ssize_t buffered_writer::write(const char* buffer, size_t num_bytes)
+{
+  if (num_bytes > _buffer.size() - _size)
+  {
+    if (!write_buffer()) { return -1; }
+    // Writes as large as the buffer gain nothing from being copied to it.
+    if (num_bytes >= _buffer.size()) { return _inner->write(buffer, num_bytes); }
+  }
+  std::memcpy(_buffer.data() + _size, buffer, num_bytes);
+  _size += num_bytes;
+  return num_bytes;
+}
+
+void buffered_writer::flush()
+{
+  if (!write_buffer()) { THROWERRNO("failed to write buffered output"); }
+  _inner->flush();
+}
+
+bool buffered_writer::write_buffer()
+{
+  size_t done = 0;
+  while (done < _size)
+  {
+    const ssize_t written = _inner->write(_buffer.data() + done, _size - done);
+    if (written <= 0) { break; }
+    done += written;
+  }
+  const bool complete = done == _size;
+  _size = 0;
+  return complete;
+}
+
 //
 // buffer_view
 //
@@ -405,3 +1619,179 @@ ssize_t buffer_view::read(char* buffer, size_t num_bytes)
   return num_bytes;
 }
 void buffer_view::reset() { _read_head = _data; }
+
+bool buffer_view::seek(uint64_t offset)
+{
+  if (offset > _len) return false;
+  _read_head = _data + offset;
+  return true;
+}
+
+#ifdef VW_USE_KAFKA
+//
+// kafka_reader
+//
+
+namespace
+{
+constexpr int KAFKA_POLL_TIMEOUT_MS = 100;
+constexpr char KAFKA_SAVE_COMMAND[] = "save|\n";
+
+void set_kafka_option(rd_kafka_conf_t* conf, const char* name, const std::string& value)
+{
+  char error[512];
+  if (rd_kafka_conf_set(conf, name, value.c_str(), error, sizeof(error)) != RD_KAFKA_CONF_OK)
+  {
+    rd_kafka_conf_destroy(conf);
+    THROW("can't set the Kafka option " << name << ": " << error);
+  }
+}
+}  // namespace
+
+kafka_consumer::kafka_consumer(const kafka_options& options) : _topic(options.topic)
+{
+  rd_kafka_conf_t* conf = rd_kafka_conf_new();
+  set_kafka_option(conf, "bootstrap.servers", options.brokers);
+  set_kafka_option(conf, "group.id", options.group);
+  set_kafka_option(conf, "enable.auto.commit", "false");
+  set_kafka_option(conf, "auto.offset.reset", "earliest");
+  set_kafka_option(conf, "enable.partition.eof", options.stop_at_end ? "true" : "false");
+
+  char error[512];
+  // The handle owns the configuration once created.
+  _handle = rd_kafka_new(RD_KAFKA_CONSUMER, conf, error, sizeof(error));
+  if (_handle == nullptr)
+  {
+    rd_kafka_conf_destroy(conf);
+    THROW("can't create the Kafka consumer: " << error);
+  }
+  rd_kafka_poll_set_consumer(_handle);
+
+  rd_kafka_topic_partition_list_t* topics = rd_kafka_topic_partition_list_new(1);
+  rd_kafka_topic_partition_list_add(topics, _topic.c_str(), RD_KAFKA_PARTITION_UA);
+  const rd_kafka_resp_err_t err = rd_kafka_subscribe(_handle, topics);
+  rd_kafka_topic_partition_list_destroy(topics);
+  if (err != RD_KAFKA_RESP_ERR_NO_ERROR)
+  {
+    rd_kafka_destroy(_handle);
+    THROW("can't subscribe to the Kafka topic " << _topic << ": " << rd_kafka_err2str(err));
+  }
+}
+
+kafka_consumer::~kafka_consumer()
+{
+  rd_kafka_consumer_close(_handle);
+  rd_kafka_destroy(_handle);
+}
+
+bool kafka_consumer::assigned_within(const std::set<int32_t>& partitions)
+{
+  rd_kafka_topic_partition_list_t* assignment = nullptr;
+  if (rd_kafka_assignment(_handle, &assignment) != RD_KAFKA_RESP_ERR_NO_ERROR) return false;
+  bool within = assignment->cnt > 0;
+  for (int i = 0; i < assignment->cnt; i++)
+    if (partitions.count(assignment->elems[i].partition) == 0) within = false;
+  rd_kafka_topic_partition_list_destroy(assignment);
+  return within;
+}
+
+void kafka_consumer::checkpoint(const std::map<int32_t, int64_t>& next_offsets)
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  _checkpoints.push_back(next_offsets);
+}
+
+void kafka_consumer::commit_checkpoint()
+{
+  std::map<int32_t, int64_t> next_offsets;
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_checkpoints.empty()) return;
+    next_offsets.swap(_checkpoints.front());
+    _checkpoints.pop_front();
+  }
+  if (next_offsets.empty()) return;
+
+  rd_kafka_topic_partition_list_t* offsets = rd_kafka_topic_partition_list_new(static_cast<int>(next_offsets.size()));
+  for (const auto& next : next_offsets)
+    rd_kafka_topic_partition_list_add(offsets, _topic.c_str(), next.first)->offset = next.second;
+  const rd_kafka_resp_err_t err = rd_kafka_commit(_handle, offsets, 0 /* synchronously */);
+  rd_kafka_topic_partition_list_destroy(offsets);
+  // The records are read again after a restart, which only costs time.
+  if (err != RD_KAFKA_RESP_ERR_NO_ERROR)
+    std::cerr << "warning: committing the offsets of the Kafka topic " << _topic << " failed: " << rd_kafka_err2str(err)
+              << std::endl;
+}
+
+kafka_reader::kafka_reader(std::shared_ptr<kafka_consumer> consumer, const kafka_options& options)
+    : reader(false /*is_resettable*/)
+    , _consumer(std::move(consumer))
+    , _checkpoint_records(options.checkpoint_records)
+    , _stop_at_end(options.stop_at_end)
+{
+}
+
+void kafka_reader::add_checkpoint()
+{
+  _pending.insert(_pending.end(), KAFKA_SAVE_COMMAND, KAFKA_SAVE_COMMAND + sizeof(KAFKA_SAVE_COMMAND) - 1);
+  _consumer->checkpoint(_next_offsets);
+  _records_since_checkpoint = 0;
+}
+
+bool kafka_reader::take(rd_kafka_message_t& message)
+{
+  if (message.err == RD_KAFKA_RESP_ERR__PARTITION_EOF)
+  {
+    _partitions_at_end.insert(message.partition);
+    return _stop_at_end && _consumer->assigned_within(_partitions_at_end);
+  }
+  if (message.err != RD_KAFKA_RESP_ERR_NO_ERROR)
+  {
+    std::cerr << "warning: reading the Kafka topic failed: " << rd_kafka_message_errstr(&message) << std::endl;
+    return false;
+  }
+
+  _partitions_at_end.erase(message.partition);
+  const char* payload = static_cast<const char*>(message.payload);
+  _pending.insert(_pending.end(), payload, payload + message.len);
+  if (message.len == 0 || payload[message.len - 1] != '\n') _pending.push_back('\n');
+  _next_offsets[message.partition] = message.offset + 1;
+  if (++_records_since_checkpoint == _checkpoint_records) add_checkpoint();
+  return false;
+}
+
+ssize_t kafka_reader::read(char* buffer, size_t num_bytes)
+{
+  size_t filled = 0;
+  while (filled < num_bytes)
+  {
+    if (_pending_offset < _pending.size())
+    {
+      const size_t count = std::min(num_bytes - filled, _pending.size() - _pending_offset);
+      std::memcpy(buffer + filled, _pending.data() + _pending_offset, count);
+      filled += count;
+      _pending_offset += count;
+      continue;
+    }
+    _pending.clear();
+    _pending_offset = 0;
+    if (_ended) break;
+
+    // Waits for the first record of a read only, the records already fetched fill the rest of it.
+    rd_kafka_message_t* message = _consumer->poll(filled == 0 ? KAFKA_POLL_TIMEOUT_MS : 0);
+    if (message == nullptr)
+    {
+      if (filled > 0) break;
+      continue;
+    }
+    const bool ended = take(*message);
+    rd_kafka_message_destroy(message);
+    if (ended)
+    {
+      if (_records_since_checkpoint > 0) add_checkpoint();
+      _ended = true;
+    }
+  }
+  return filled;
+}
+#endif
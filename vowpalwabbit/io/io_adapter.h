@@ -2,6 +2,8 @@
 
 #include "../vw_exception.h"
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <memory>
 #include <vector>
@@ -45,6 +47,25 @@ struct reader
   /// \throw VW::vw_exception if reader does not support resetting.
   virtual void reset() { THROW("Reset not supported for this io_adapter"); }
 
+  /// Readers whose contents are already in memory can hand them out directly instead of copying them in read. Views
+  /// returned by consecutive calls are contiguous in memory and stay valid until the reader is reset or destroyed.
+  /// The memory may be written to, this never modifies the underlying source.
+  /// \param data set to the beginning of the view
+  /// \returns the number of bytes in the view, 0 if the reader is exhausted or does not support views
+  virtual size_t take_view(char*& /* data */) { return 0; }
+
+  /// Continues reading at the given offset from the start of the source. Readers which cannot do so, such as those of
+  /// compressed files and pipes, return false and keep their position.
+  /// \param offset the number of bytes from the start of the source
+  /// \returns true if the reader moved to offset, otherwise false
+  virtual bool seek(uint64_t /* offset */) { return false; }
+
+  /// Maps length bytes of the source from offset in memory, copy on write so that writing to them never modifies the
+  /// source. The mapping outlives the reader and is released with munmap. Only regular files read as is can be mapped,
+  /// on Linux, and offset must be a multiple of the page size.
+  /// \returns the mapped bytes, nullptr if they cannot be mapped
+  virtual char* map(uint64_t /* offset */, size_t /* length */) { return nullptr; }
+
   /// \returns true if this reader can be reset, otherwise false
   bool is_resettable() const { return _is_resettable; }
 
@@ -89,15 +110,55 @@ private:
   std::shared_ptr<details::socket_closer> _closer;
 };
 
+enum class compression_format
+{
+  none,
+  gzip,
+  zstd,  // requires building with USE_ZSTD
+  lz4    // LZ4 frame format, requires building with USE_LZ4
+};
+
+/// \param name one of none, gzip, zstd or lz4
+/// \throw VW::vw_exception if the name is unknown or the format is not available in this build
+compression_format parse_compression_format(const std::string& name);
+
+/// Identifies the format of a regular file by its leading magic bytes. Anything else, including files which cannot be
+/// opened and pipes which must not be consumed, is reported as compression_format::none.
+compression_format detect_compression_format(const std::string& file_path);
+
 std::unique_ptr<writer> open_file_writer(const std::string& file_path);
+/// Opens file_path for writing and, when it is a regular file other than stdout, gathers what is written in a buffer
+/// of buffer_size bytes which is written to the file when it fills up, on flush and when the writer is destroyed.
+/// Others, such as pipes, which may be read from while vw runs, are written to as is.
+std::unique_ptr<writer> open_buffered_file_writer(const std::string& file_path, size_t buffer_size = 1 << 16);
 std::unique_ptr<reader> open_file_reader(const std::string& file_path);
 std::unique_ptr<writer> open_compressed_file_writer(const std::string& file_path);
 std::unique_ptr<reader> open_compressed_file_reader(const std::string& file_path);
+/// Opens a reader for file_path stored in the given format, compression_format::none reads the file as is.
+std::unique_ptr<reader> open_compressed_file_reader(const std::string& file_path, compression_format format);
+/// Opens a writer for file_path in the given format, compression_format::none writes the file as is.
+std::unique_ptr<writer> open_compressed_file_writer(const std::string& file_path, compression_format format);
+/// Memory maps the file so that io_buf can parse it in place, see reader::take_view. Files which cannot be mapped,
+/// such as pipes, are read by a regular file reader instead.
+std::unique_ptr<reader> open_mapped_file_reader(const std::string& file_path);
+/// Reads BGZF files, gzip made of independent blocks such as written by open_parallel_compressed_file_writer or
+/// bgzip, by inflating num_threads blocks at a time. Other files are read by open_compressed_file_reader.
+std::unique_ptr<reader> open_parallel_compressed_file_reader(const std::string& file_path, size_t num_threads);
+/// Writes a BGZF file, deflating blocks on num_threads threads. The result can be read by any gzip reader.
+std::unique_ptr<writer> open_parallel_compressed_file_writer(const std::string& file_path, size_t num_threads);
 std::unique_ptr<reader> open_compressed_stdin();
 std::unique_ptr<writer> open_compressed_stdout();
 std::unique_ptr<reader> open_stdin();
 std::unique_ptr<writer> open_stdout();
 
+/// Reads from inner on a separate I/O thread, keeping up to num_buffers buffers of buffer_size bytes filled ahead of
+/// the caller so that waiting on the device overlaps with parsing.
+/// \param inner reader to read ahead from, ownership is taken
+/// \param num_buffers number of buffers to keep in flight, must be at least 1
+/// \param buffer_size size of each buffer in bytes
+std::unique_ptr<reader> create_read_ahead_reader(
+    std::unique_ptr<reader>&& inner, size_t num_buffers, size_t buffer_size = 1 << 20);
+
 /// \param fd the file descriptor of the socket. Will take ownership of the resource.
 /// \returns socket object which allows creation of readers or writers from this socket
 std::unique_ptr<socket> wrap_socket_descriptor(int fd);
@@ -114,5 +175,26 @@ std::unique_ptr<writer> create_vector_writer(std::shared_ptr<std::vector<char>>&
 /// \param len length of buffer
 std::unique_ptr<reader> create_buffer_view(const char* data, size_t len);
 
+struct kafka_options
+{
+  std::string brokers;  // bootstrap servers, host:port[,host:port...]
+  std::string topic;
+  std::string group = "vw";  // the consumer group, whose offsets are committed
+  uint64_t checkpoint_records = 100000;  // records between checkpoints, 0 for none
+  bool stop_at_end = false;  // end the input once every assigned partition is read to its end
+};
+
+/// Consumes the records of a Kafka topic straight into the reader's buffer, taking the records at hand in one read.
+/// A newline is added after records that do not end with one, so that records are lines of text examples. Each record
+/// must hold whole examples, including the empty line that ends a multiline example.
+///
+/// Offsets are only committed at checkpoints. A save command line, "save|", follows every checkpoint_records records,
+/// and at the end with stop_at_end. commit_checkpoint is set to a function which commits the offsets of the records
+/// before the oldest pending save command. It is to be called once that command saved the model. So the records a
+/// saved model learned from are not read again, and after a restart the others are: training is at least once.
+/// commit_checkpoint may be called from any thread and outlive the reader.
+/// 	hrow VW::vw_exception if vw was built without USE_KAFKA or the consumer cannot be created
+std::unique_ptr<reader> open_kafka_reader(const kafka_options& options, std::function<void()>& commit_checkpoint);
+
 }  // namespace io
 }  // namespace VW
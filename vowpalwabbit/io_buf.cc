@@ -3,15 +3,54 @@
 // license as described in the file LICENSE.
 #include "io_buf.h"
 
+bool io_buf::try_take_view()
+{
+  // Only possible when nothing is buffered, otherwise the buffered bytes would have to precede the view.
+  if (head != space.end() || current >= input_files.size()) return false;
+
+  char* data;
+  size_t len = input_files[current]->take_view(data);
+  if (len == 0) return false;
+  head = data;
+  view_end = data + len;
+  return true;
+}
+
+bool io_buf::extend_view()
+{
+  char* data;
+  size_t len = input_files[current]->take_view(data);
+  if (len == 0) return false;
+  assert(data == view_end);
+  view_end += len;
+  return true;
+}
+
+void io_buf::release_view()
+{
+  size_t left = view_end - head;
+  space.end() = space.begin();
+  if (left > static_cast<size_t>(space.end_array - space.begin())) space.resize(left);
+  memcpy(space.begin(), head, left);
+  head = space.begin();
+  space.end() = space.begin() + left;
+  view_end = nullptr;
+}
+
 size_t io_buf::buf_read(char*& pointer, size_t n)
 {
   // return a pointer to the next n bytes.  n must be smaller than the maximum size.
-  if (head + n <= space.end())
+  if (head + n <= read_end())
   {
     pointer = head;
     head += n;
     return n;
   }
+  else if (view_end != nullptr)  // out of bytes in the view, so extend it or continue in space.
+  {
+    if (!extend_view()) release_view();
+    return buf_read(pointer, n);
+  }
   else  // out of bytes, so refill.
   {
     if (head != space.begin())  // There exists room to shift.
@@ -23,8 +62,8 @@ size_t io_buf::buf_read(char*& pointer, size_t n)
       space.end() = space.begin() + left;
     }
     if (current < input_files.size() &&
-        fill(input_files[current].get()) > 0)  // read more bytes from current file if present
-      return buf_read(pointer, n);             // more bytes are read.
+        (try_take_view() || fill(input_files[current].get()) > 0))  // read more bytes from current file if present
+      return buf_read(pointer, n);                                   // more bytes are read.
     else if (++current < input_files.size())
       return buf_read(pointer, n);  // No more bytes, so go to next file and try again.
     else
@@ -37,12 +76,13 @@ size_t io_buf::buf_read(char*& pointer, size_t n)
   }
 }
 
-bool io_buf::isbinary()
+bool io_buf::read_marker(char marker)
 {
-  if (space.end() == head)
-    if (fill(input_files[current].get()) <= 0) return false;
+  if (view_end != nullptr && head == view_end && !extend_view()) release_view();
+  if (read_end() == head)
+    if (!try_take_view() && fill(input_files[current].get()) <= 0) return false;
 
-  bool ret = (*head == 0);
+  bool ret = (*head == marker);
   if (ret) head++;
 
   return ret;
@@ -50,6 +90,21 @@ bool io_buf::isbinary()
 
 size_t io_buf::readto(char*& pointer, char terminal)
 {
+  if (view_end != nullptr)
+  {
+    pointer = static_cast<char*>(memchr(head, terminal, view_end - head));
+    if (pointer != nullptr)
+    {
+      size_t n = pointer - head + 1;
+      pointer = head;
+      head += n;
+      return n;
+    }
+    // The terminal is in the next part of the view or the line continues into the next file.
+    if (!extend_view()) release_view();
+    return readto(pointer, terminal);
+  }
+
   // Return a pointer to the bytes before the terminal.  Must be less than the buffer size.
   pointer = head;
   while (pointer < space.end() && *pointer != terminal) pointer++;
@@ -70,7 +125,8 @@ size_t io_buf::readto(char*& pointer, char terminal)
       space.end() = space.begin() + left;
       pointer = space.end();
     }
-    if (current < input_files.size() && fill(input_files[current].get()) > 0)  // more bytes are read.
+    if (current < input_files.size() &&
+        (try_take_view() || fill(input_files[current].get()) > 0))  // more bytes are read.
       return readto(pointer, terminal);
     else if (++current < input_files.size())  // no more bytes, so go to next file.
       return readto(pointer, terminal);
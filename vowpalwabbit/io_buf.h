@@ -13,6 +13,7 @@
 #include "v_array.h"
 #include "hash.h"
 #include "vw_exception.h"
+#include "stage_profiler.h"
 #include "io/io_adapter.h"
 
 /* The i/o buffer can be conceptualized as an array below:
@@ -33,6 +34,10 @@
 ** The interval [space.head, space.end] may be shifted down to space.begin
 ** if the requested number of bytes to be read is larger than the interval size.
 ** This is done to avoid reallocating arrays as much as possible.
+**
+** When the current input file can hand out its contents directly (see VW::io::reader::take_view) and nothing is
+** buffered, head points into that view instead and view_end marks its end. Bytes left over at the end of such a
+** file are copied into space so that they join the next file exactly as they would when reading.
 */
 
 class io_buf
@@ -45,11 +50,20 @@ class io_buf
 
   v_array<char> space;  // space.begin = beginning of loaded values.  space.end = end of read or written values from/to
                         // the buffer.
+  char* view_end = nullptr;  // end of the view of the current input file head points into, nullptr when using space
+  uint64_t _flushed_bytes = 0;  // written to the output file so far
+
+  // End of the bytes which are available to read.
+  char* read_end() { return view_end != nullptr ? view_end : space.end(); }
+  bool try_take_view();
+  bool extend_view();
+  void release_view();
 
 public:
   std::vector<std::unique_ptr<VW::io::reader>> input_files;
   std::vector<std::unique_ptr<VW::io::writer>> output_files;
   size_t current;  // file descriptor currently being used.
+  VW::stage_counter* fill_profile = nullptr;  // times fill with --stage_timing
 
   io_buf(io_buf& other) = delete;
   io_buf& operator=(io_buf& other) = delete;
@@ -88,6 +102,7 @@ public:
   {
     space.end() = space.begin();
     head = space.begin();
+    view_end = nullptr;
   }
 
   void reset_file(VW::io::reader* f)
@@ -96,6 +111,16 @@ public:
     reset_buffer();
   }
 
+  // Drops what is buffered and continues reading the input file with the given index at offset. Returns false and
+  // leaves the buffer as is if that file cannot seek.
+  bool seek_file(size_t file, uint64_t offset)
+  {
+    if (!input_files[file]->seek(offset)) return false;
+    current = file;
+    reset_buffer();
+    return true;
+  }
+
   io_buf() : _verify_hash{false}, _hash{0}, current{0}
   {
     space = v_init<char>();
@@ -116,6 +141,7 @@ public:
 
   ssize_t fill(VW::io::reader* f)
   {
+    VW::stage_timer timer(fill_profile);
     // if the loaded values have reached the allocated space
     if (space.end_array - space.end() == 0)
     {  // reallocate to twice as much space
@@ -154,12 +180,16 @@ public:
   //   - Read mode: The offset of the position that has been read up to so far.
   size_t unflushed_bytes_count() { return head - space.begin(); }
 
+  // Write mode: the offset in the output file of the next byte written.
+  uint64_t written_bytes_count() { return _flushed_bytes + unflushed_bytes_count(); }
+
   void flush()
   {
     if (!output_files.empty())
     {
       if (write_file(output_files[0].get(), space.begin(), unflushed_bytes_count()) != (int)(unflushed_bytes_count()))
       { std::cerr << "error, failed to write example\n"; }
+      _flushed_bytes += unflushed_bytes_count();
       head = space.begin();
       output_files[0]->flush();
     }
@@ -169,6 +199,8 @@ public:
   {
     if (!input_files.empty())
     {
+      // The view head points into is owned by the file.
+      if (view_end != nullptr && current + 1 == input_files.size()) { reset_buffer(); }
       input_files.pop_back();
       return true;
     }
@@ -176,6 +208,7 @@ public:
     if (!output_files.empty())
     {
       output_files.pop_back();
+      _flushed_bytes = 0;
       return true;
     }
 
@@ -226,7 +259,9 @@ public:
     return len;
   }
 
-  bool isbinary();
+  bool isbinary() { return read_marker(0); }
+  // Consumes the next byte of input if it is marker.
+  bool read_marker(char marker);
   size_t readto(char*& pointer, char terminal);
   size_t copy_to(void* dst, size_t max_size);
   void replace_buffer(char* buf, size_t capacity);
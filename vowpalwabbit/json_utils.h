@@ -18,6 +18,7 @@ struct Namespace
   features* ftrs;
   size_t feature_count;
   const char* name;
+  parser* example_parser;  // whose hash cache the names go through, each parse thread has its own
 
   void AddFeature(feature_value v, feature_index i, const char* feature_name)
   {
@@ -27,37 +28,50 @@ struct Namespace
     ftrs->push_back(v, i);
     feature_count++;
 
-    if (audit) ftrs->space_names.push_back(audit_strings_ptr(new audit_strings(name, feature_name)));
+    if (audit) ftrs->space_names.push_back(example_parser->audit_strings.get(name, feature_name));
+  }
+
+  uint64_t hash_name(VW::string_view str, uint64_t seed)
+  {
+    auto* p = example_parser;
+    if (p->hash_cache != nullptr) return p->hash_cache->hash(p->hasher, feature_group, str, seed);
+    return p->hasher(str.begin(), str.size(), seed);
   }
 
   void AddFeature(vw* all, const char* str)
   {
-    ftrs->push_back(1., VW::hash_feature_cstr(*all, const_cast<char*>(str), namespace_hash));
+    ftrs->push_back(1., hash_name(str, namespace_hash) & all->parse_mask);
     feature_count++;
 
-    if (audit) ftrs->space_names.push_back(audit_strings_ptr(new audit_strings(name, str)));
+    if (audit) ftrs->space_names.push_back(example_parser->audit_strings.get(name, str));
   }
 
   void AddFeature(vw* all, const char* key, const char* value)
   {
-    ftrs->push_back(1., VW::chain_hash(*all, key, value, namespace_hash));
+    // chain hash is hash(feature_value, hash(feature_name, namespace_hash)) & parse_mask
+    ftrs->push_back(1., hash_name(value, hash_name(key, namespace_hash)) & all->parse_mask);
     feature_count++;
 
-    std::stringstream ss;
-    ss << key << "^" << value;
-    if (audit) ftrs->space_names.push_back(audit_strings_ptr(new audit_strings(name, ss.str())));
+    if (audit)
+    {
+      std::string chained(key);
+      chained += '^';
+      chained += value;
+      ftrs->space_names.push_back(example_parser->audit_strings.get(name, chained));
+    }
   }
 };
 
 template <bool audit>
-void push_ns(example* ex, const char* ns, std::vector<Namespace<audit>>& namespaces, vw& all)
+void push_ns(example* ex, const char* ns, std::vector<Namespace<audit>>& namespaces, vw& all, parser& p)
 {
   Namespace<audit> n;
   n.feature_group = ns[0];
-  n.namespace_hash = VW::hash_space_cstr(all, ns);
-  n.ftrs = ex->feature_space.data() + ns[0];
+  n.ftrs = &ex->feature_space[ns[0]];
   n.feature_count = 0;
   n.name = ns;
+  n.example_parser = &p;
+  n.namespace_hash = n.hash_name(ns, all.hash_seed);
   namespaces.push_back(std::move(n));
 }
 
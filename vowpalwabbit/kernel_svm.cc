@@ -1,6 +1,7 @@
 // Copyright (c) by respective owners including Yahoo!, Microsoft, and
 // individual contributors. All rights reserved. Released under a BSD (revised)
 // license as described in the file LICENSE.
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <cfloat>
@@ -93,7 +94,7 @@ struct svm_params
   size_t reprocess;
 
   svm_model* model;
-  size_t maxcache;
+  size_t maxcache;  // number of kernel values cached over all the support vectors
   // size_t curcache;
 
   svm_example** pool;
@@ -229,17 +230,24 @@ static int make_hot_sv(svm_params& params, size_t svi)
   return alloc;
 }
 
+// make_hot_sv moves the support vectors it uses to the front, so that the rows of the least recently used ones are
+// the ones past the budget.
 static int trim_cache(svm_params& params)
 {
-  int sz = (int)params.maxcache;
+  size_t budget = params.maxcache;
   svm_model* model = params.model;
   size_t n = model->num_support;
   int alloc = 0;
   for (size_t i = 0; i < n; i++)
   {
     svm_example* e = model->support_vec[i];
-    sz -= (int)e->krow.size();
-    if (sz < 0) alloc += e->clear_kernels();
+    if (e->krow.size() <= budget)
+      budget -= e->krow.size();
+    else
+    {
+      budget = 0;
+      alloc += e->clear_kernels();
+    }
   }
   return alloc;
 }
@@ -361,35 +369,33 @@ void save_load(svm_params& params, io_buf& model_file, bool read, bool text)
   save_load_svm_model(params, model_file, read, text);
 }
 
+// The features of both examples are sorted by index, without duplicates. The shorter one is walked, and the longer
+// one searched for each of its indices by galloping ahead of the last match, so that a short example costs
+// O(short * log(long / short)) against a long support vector rather than a merge over both. The products are summed
+// in increasing order of index, as a merge would.
 float linear_kernel(const flat_example* fec1, const flat_example* fec2)
 {
-  float dotprod = 0;
-
-  features& fs_1 = (features&)fec1->fs;
-  features& fs_2 = (features&)fec2->fs;
-  if (fs_2.indicies.size() == 0) return 0.f;
+  const features* shorter = &fec1->fs;
+  const features* longer = &fec2->fs;
+  if (shorter->size() > longer->size()) std::swap(shorter, longer);
 
-  int numint = 0;
-  for (size_t idx1 = 0, idx2 = 0; idx1 < fs_1.size() && idx2 < fs_2.size(); idx1++)
+  float dotprod = 0;
+  const feature_index* begin = longer->indicies.cbegin();
+  const feature_index* end = longer->indicies.cend();
+  const feature_index* pos = begin;
+  for (size_t i = 0; i < shorter->size() && pos != end; i++)
   {
-    uint64_t ec1pos = fs_1.indicies[idx1];
-    uint64_t ec2pos = fs_2.indicies[idx2];
-    // params.all->opts_n_args.trace_message<<ec1pos<<" "<<ec2pos<<" "<<idx1<<" "<<idx2<<" "<<f->x<<" "<<ec2f->x<< endl;
-    if (ec1pos < ec2pos) continue;
-
-    while (ec1pos > ec2pos && ++idx2 < fs_2.size()) ec2pos = fs_2.indicies[idx2];
+    const feature_index index = shorter->indicies[i];
+    size_t bound = 1;
+    while (bound < static_cast<size_t>(end - pos) && pos[bound] < index) bound *= 2;
+    pos = std::lower_bound(pos + bound / 2, pos + std::min(bound + 1, static_cast<size_t>(end - pos)), index);
 
-    if (ec1pos == ec2pos)
+    if (pos != end && *pos == index)
     {
-      // params.all->opts_n_args.trace_message<<ec1pos<<" "<<ec2pos<<" "<<idx1<<" "<<idx2<<" "<<f->x<<"
-      // "<<ec2f->x<< endl;
-      numint++;
-      dotprod += fs_1.values[idx1] * fs_2.values[idx2];
-      ++idx2;
+      dotprod += shorter->values[i] * longer->values[pos - begin];
+      ++pos;
     }
   }
-  // params.all->opts_n_args.trace_message<< endl;
-  // params.all->opts_n_args.trace_message<<"numint = "<<numint<<" dotprod = "<<dotprod<< endl;
   return dotprod;
 }
 
@@ -458,28 +464,25 @@ void predict(svm_params& params, single_learner&, example& ec)
   }
 }
 
-size_t suboptimality(svm_model* model, double* subopt)
+// The position of the most suboptimal support vector, and its suboptimality in max_val.
+size_t suboptimality(svm_model* model, double& max_val)
 {
   size_t max_pos = 0;
-  // std::cerr<<"Subopt ";
-  double max_val = 0;
+  max_val = 0;
   for (size_t i = 0; i < model->num_support; i++)
   {
     float tmp = model->alpha[i] * model->support_vec[i]->ex.l.simple.label;
 
+    double subopt = 0;
     if ((tmp < model->support_vec[i]->ex.l.simple.weight && model->delta[i] < 0) || (tmp > 0 && model->delta[i] > 0))
-      subopt[i] = fabs(model->delta[i]);
-    else
-      subopt[i] = 0;
+      subopt = fabs(model->delta[i]);
 
-    if (subopt[i] > max_val)
+    if (subopt > max_val)
     {
-      max_val = subopt[i];
+      max_val = subopt;
       max_pos = i;
     }
-    // std::cerr<<subopt[i]<<" ";
   }
-  // std::cerr<< endl;
   return max_pos;
 }
 
@@ -747,7 +750,6 @@ void train(svm_params& params)
         bool overshoot = update(params, model_pos);
         // std::cout<<model_pos<<":alpha = "<<model->alpha[model_pos]<< endl;
 
-        double* subopt = calloc_or_throw<double>(model->num_support);
         for (size_t j = 0; j < params.reprocess; j++)
         {
           if (model->num_support == 0) break;
@@ -756,8 +758,9 @@ void train(svm_params& params)
           if (params._random_state->get_and_update_random() < 0.5) randi = 0;
           if (randi)
           {
-            size_t max_pos = suboptimality(model, subopt);
-            if (subopt[max_pos] > 0)
+            double max_subopt;
+            size_t max_pos = suboptimality(model, max_subopt);
+            if (max_subopt > 0)
             {
               if (!overshoot && max_pos == (size_t)model_pos && max_pos > 0 && j == 0)
                 params.all->trace_message << "Shouldn't reprocess right after process!!!" << endl;
@@ -775,7 +778,6 @@ void train(svm_params& params)
         }
         // std::cout<< endl;
         // td::cout<<params.model->support_vec[0]->example_counter<< endl;
-        free(subopt);
       }
     }
   }
@@ -831,6 +833,7 @@ VW::LEARNER::base_learner* kernel_svm_setup(options_i& options, vw& all)
   std::string kernel_type;
   float bandwidth = 1.f;
   int degree = 2;
+  size_t cache_mb = 4096;
 
   bool ksvm = false;
 
@@ -848,7 +851,10 @@ VW::LEARNER::base_learner* kernel_svm_setup(options_i& options, vw& all)
                .default_value("linear")
                .help("type of kernel (rbf or linear (default))"))
       .add(make_option("bandwidth", bandwidth).keep().default_value(1.f).help("bandwidth of rbf kernel"))
-      .add(make_option("degree", degree).keep().default_value(2).help("degree of poly kernel"));
+      .add(make_option("degree", degree).keep().default_value(2).help("degree of poly kernel"))
+      .add(make_option("cache_mb", cache_mb)
+               .default_value(4096)
+               .help("megabytes of kernel values to cache, dropping those of the least recently used support vectors"));
 
   if (!options.add_parse_and_check_necessary(new_options)) { return nullptr; }
 
@@ -858,7 +864,7 @@ VW::LEARNER::base_learner* kernel_svm_setup(options_i& options, vw& all)
 
   params->model = &calloc_or_throw<svm_model>();
   params->model->num_support = 0;
-  params->maxcache = 1024 * 1024 * 1024;
+  params->maxcache = cache_mb * 1024 * 1024 / sizeof(float);
   params->loss_sum = 0.;
   params->all = &all;
   params->_random_state = all.get_random_state();
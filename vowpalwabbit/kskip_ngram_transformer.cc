@@ -4,42 +4,9 @@
 
 #include "kskip_ngram_transformer.h"
 
+#include <algorithm>
 #include <memory>
 
-void add_grams(
-    size_t ngram, size_t skip_gram, features& fs, size_t initial_length, std::vector<size_t>& gram_mask, size_t skips)
-{
-  if (ngram == 0 && gram_mask.back() < initial_length)
-  {
-    size_t last = initial_length - gram_mask.back();
-    for (size_t i = 0; i < last; i++)
-    {
-      uint64_t new_index = fs.indicies[i];
-      for (size_t n = 1; n < gram_mask.size(); n++)
-      { new_index = new_index * quadratic_constant + fs.indicies[i + gram_mask[n]]; }
-
-      fs.push_back(1., new_index);
-      if (!fs.space_names.empty())
-      {
-        std::string feature_name(fs.space_names[i].get()->second);
-        for (size_t n = 1; n < gram_mask.size(); n++)
-        {
-          feature_name += std::string("^");
-          feature_name += std::string(fs.space_names[i + gram_mask[n]].get()->second);
-        }
-        fs.space_names.push_back(std::make_shared<audit_strings>(fs.space_names[i].get()->first, feature_name));
-      }
-    }
-  }
-  if (ngram > 0)
-  {
-    gram_mask.push_back(gram_mask.back() + 1 + skips);
-    add_grams(ngram - 1, skip_gram, fs, initial_length, gram_mask, 0);
-    gram_mask.pop_back();
-  }
-  if (skip_gram > 0 && ngram > 0) { add_grams(ngram, skip_gram - 1, fs, initial_length, gram_mask, skips + 1); }
-}
-
 void compile_gram(const std::vector<std::string>& grams, std::array<uint32_t, NUM_NAMESPACES>& dest,
     const std::string& descriptor, bool quiet)
 {
@@ -65,17 +32,101 @@ void compile_gram(const std::vector<std::string>& grams, std::array<uint32_t, NU
   }
 }
 
+namespace
+{
+// The number of k-skip-(n+1)-grams of length features, with at most skips features skipped: of the C(s + n - 1, n - 1)
+// ways to skip s features, each spans n + 1 + s features and starts at any of the first length - n - s.
+size_t count_grams(size_t length, size_t n, size_t skips)
+{
+  size_t count = 0;
+  size_t ways = 1;
+  for (size_t s = 0; s <= skips && n + s < length; s++)
+  {
+    count += ways * (length - n - s);
+    ways = ways * (s + n) / (s + 1);
+  }
+  return count;
+}
+}  // namespace
+
 void VW::kskip_ngram_transformer::generate_grams(example* ex)
 {
   for (namespace_index index : ex->indices)
   {
-    size_t length = ex->feature_space[index].size();
-    for (size_t n = 1; n < ngram_definition[index]; n++)
+    features& fs = ex->feature_space[index];
+    const size_t length = fs.size();
+    if (ngram_definition[index] < 2 || length < 2) continue;
+
+    size_t count = 0;
+    for (size_t n = 1; n < ngram_definition[index]; n++) count += count_grams(length, n, skip_definition[index]);
+    fs.reserve(count);
+    if (!fs.space_names.empty()) fs.space_names.reserve(fs.space_names.size() + count);
+    if (gram_values.size() < length) gram_values.resize(length, 1.f);
+
+    for (size_t n = 1; n < ngram_definition[index]; n++) add_grams(fs, length, n, skip_definition[index]);
+  }
+}
+
+void VW::kskip_ngram_transformer::add_grams(features& fs, size_t length, size_t n, size_t skips)
+{
+  // Row 0 of gram_hashes is a copy of the indices, which pushing the grams may move.
+  gram_hashes.resize((n + 1) * length);
+  std::copy(fs.indicies.begin(), fs.indicies.begin() + length, gram_hashes.begin());
+  gram_offsets.resize(n + 1);
+  for (size_t d = 0; d <= n; d++) gram_offsets[d] = d;
+  size_t skipped = 0;
+  size_t first_changed = 1;
+
+  while (true)
+  {
+    for (size_t d = first_changed; d <= n && gram_offsets[d] < length; d++)
+    {
+      const uint64_t* previous = &gram_hashes[(d - 1) * length];
+      const uint64_t* next = &gram_hashes[gram_offsets[d]];
+      uint64_t* row = &gram_hashes[d * length];
+      const size_t end = length - gram_offsets[d];
+      for (size_t i = 0; i < end; i++) row[i] = previous[i] * quadratic_constant + next[i];
+    }
+    if (gram_offsets[n] < length) push_grams(fs, length, n);
+
+    // The next gaps: skip one more feature before the last one if there are skips left, otherwise stop skipping
+    // before the last feature which follows a gap and skip one more before the feature preceding it.
+    if (skipped < skips)
+    {
+      gram_offsets[n]++;
+      skipped++;
+      first_changed = n;
+      continue;
+    }
+    size_t d = n;
+    while (d > 0 && gram_offsets[d] == gram_offsets[d - 1] + 1) d--;
+    if (d <= 1) return;
+    const size_t gap = gram_offsets[d] - gram_offsets[d - 1] - 1;
+    for (size_t t = d; t <= n; t++) gram_offsets[t] -= gap - 1;
+    gram_offsets[d - 1]++;
+    skipped -= gap - 1;
+    first_changed = d - 1;
+  }
+}
+
+void VW::kskip_ngram_transformer::push_grams(features& fs, size_t length, size_t n)
+{
+  const size_t count = length - gram_offsets[n];
+  push_many(fs.indicies, &gram_hashes[n * length], count);
+  push_many(fs.values, gram_values.data(), count);
+  // one at a time, as pushing the features would round it
+  for (size_t i = 0; i < count; i++) fs.sum_feat_sq += 1.f;
+
+  if (fs.space_names.empty()) return;
+  for (size_t i = 0; i < count; i++)
+  {
+    std::string feature_name(fs.space_names[i].get()->second);
+    for (size_t d = 1; d <= n; d++)
     {
-      gram_mask.clear();
-      gram_mask.push_back(0);
-      add_grams(n, skip_definition[index], ex->feature_space[index], length, gram_mask, 0);
+      feature_name += std::string("^");
+      feature_name += std::string(fs.space_names[i + gram_offsets[d]].get()->second);
     }
+    fs.space_names.push_back(std::make_shared<audit_strings>(fs.space_names[i].get()->first, feature_name));
   }
 }
 
@@ -27,6 +27,8 @@ struct kskip_ngram_transformer
    * The k-skip-n-grams are appended to the feature vector.
    * Hash is evaluated using the principle h(a, b) = h(a)*X + h(b), where X is a random no.
    * 32 random nos. are maintained in an array and are used in the hashing.
+   * The grams of a namespace are generated an n at a time, ordered by the features they skip and then by the feature
+   * they start at, with the hashes of the grams of all features computed a row at a time into a reserved buffer.
    */
   void generate_grams(example* ex);
 
@@ -41,7 +43,14 @@ struct kskip_ngram_transformer
 private:
   kskip_ngram_transformer(std::vector<std::string> grams, std::vector<std::string> skips);
 
-  std::vector<size_t> gram_mask;
+  // Appends the grams of n + 1 of the first length features of fs, skipping at most skips of them.
+  void add_grams(features& fs, size_t length, size_t n, size_t skips);
+  void push_grams(features& fs, size_t length, size_t n);
+
+  // Scratch space reused from one example to the next.
+  std::vector<size_t> gram_offsets;        // of each feature of the grams from the first
+  std::vector<uint64_t> gram_hashes;       // row d hashes the first d + 1 features of the grams from each feature
+  std::vector<feature_value> gram_values;  // the value of every gram, 1
   std::array<uint32_t, NUM_NAMESPACES> ngram_definition;
   std::array<uint32_t, NUM_NAMESPACES> skip_definition;
   std::vector<std::string> initial_ngram_definitions;
@@ -36,13 +36,8 @@ void add_example_namespace(example& ec, namespace_index ns, features& fs)
 
   if (!has_ns) ec.indices.push_back((size_t)ns);
 
-  bool audit = fs.space_names.size() > 0;
-  features& add_fs = ec.feature_space[(size_t)ns];
-  for (size_t i = 0; i < fs.size(); ++i)
-  {
-    add_fs.push_back(fs.values[i], fs.indicies[i]);
-    if (audit) add_fs.space_names.push_back(fs.space_names[i]);
-  }
+  // Copied at once, shared features are added to every action of a multi_ex.
+  ec.feature_space[(size_t)ns].concat(fs);
   ec.total_sum_feat_sq += fs.sum_feat_sq;
 
   ec.num_features += fs.size();
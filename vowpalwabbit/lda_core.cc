@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <thread>
 #include "correctedMath.h"
 #include "vw_versions.h"
 #include "vw.h"
@@ -24,15 +25,13 @@
 #include "reductions.h"
 #include "array_parameters.h"
 #include "vw_exception.h"
+#include "lda_simd.h"
+#include "thread_affinity.h"
 
 #include <boost/version.hpp>
 #include <boost/math/special_functions/digamma.hpp>
 #include <boost/math/special_functions/gamma.hpp>
 
-#if BOOST_VERSION >= 105600
-#  include <boost/align/is_aligned.hpp>
-#endif
-
 using namespace VW::config;
 
 enum lda_math_mode
@@ -50,6 +49,14 @@ public:
   bool operator<(const index_feature b) const { return f.weight_index < b.f.weight_index; }
 };
 
+// The buffers of the E-step of a document, one for each thread of --lda_threads.
+struct lda_estep
+{
+  std::vector<float> new_gamma;
+  std::vector<float> old_gamma;
+  std::vector<float> Elogtheta;
+};
+
 struct lda
 {
   size_t topics;
@@ -58,11 +65,13 @@ struct lda
   float lda_D;
   float lda_epsilon;
   size_t minibatch;
+  size_t threads;  // set by --lda_threads, 0 for one per core
   lda_math_mode mmode;
 
   size_t finish_example_count;
 
-  v_array<float> Elogtheta;
+  std::vector<lda_estep> esteps;
+  std::vector<float> scores;  // of the documents of the minibatch
   v_array<float> decay_levels;
   v_array<float> total_new;
   v_array<example *> examples;
@@ -92,7 +101,6 @@ struct lda
 
   ~lda()
   {
-    Elogtheta.delete_v();
     decay_levels.delete_v();
     total_new.delete_v();
     examples.delete_v();
@@ -103,283 +111,8 @@ struct lda
   }
 };
 
-// #define VW_NO_INLINE_SIMD
-
-namespace
-{
-inline bool is_aligned16(void *ptr)
-{
-#if BOOST_VERSION >= 105600
-  return boost::alignment::is_aligned(16, ptr);
-#else
-  return ((reinterpret_cast<uintptr_t>(ptr) & 0x0f) == 0);
-#endif
-}
-}  // namespace
-
 namespace ldamath
 {
-inline float fastlog2(float x)
-{
-  uint32_t mx;
-  memcpy(&mx, &x, sizeof(uint32_t));
-  mx = (mx & 0x007FFFFF) | (0x7e << 23);
-
-  float mx_f;
-  memcpy(&mx_f, &mx, sizeof(float));
-
-  uint32_t vx;
-  memcpy(&vx, &x, sizeof(uint32_t));
-
-  float y = static_cast<float>(vx);
-  y *= 1.0f / (float)(1 << 23);
-
-  return y - 124.22544637f - 1.498030302f * mx_f - 1.72587999f / (0.3520887068f + mx_f);
-}
-
-inline float fastlog(float x) { return 0.69314718f * fastlog2(x); }
-
-inline float fastpow2(float p)
-{
-  float offset = (p < 0) * 1.0f;
-  float clipp = (p < -126.0) ? -126.0f : p;
-  int w = (int)clipp;
-  float z = clipp - w + offset;
-  uint32_t approx = (uint32_t)((1 << 23) * (clipp + 121.2740838f + 27.7280233f / (4.84252568f - z) - 1.49012907f * z));
-
-  float v;
-  memcpy(&v, &approx, sizeof(uint32_t));
-  return v;
-}
-
-inline float fastexp(float p) { return fastpow2(1.442695040f * p); }
-
-inline float fastpow(float x, float p) { return fastpow2(p * fastlog2(x)); }
-
-inline float fastlgamma(float x)
-{
-  float logterm = fastlog(x * (1.0f + x) * (2.0f + x));
-  float xp3 = 3.0f + x;
-
-  return -2.081061466f - x + 0.0833333f / xp3 - logterm + (2.5f + x) * fastlog(xp3);
-}
-
-inline float fastdigamma(float x)
-{
-  float twopx = 2.0f + x;
-  float logterm = fastlog(twopx);
-
-  return -(1.0f + 2.0f * x) / (x * (1.0f + x)) - (13.0f + 6.0f * x) / (12.0f * twopx * twopx) + logterm;
-}
-
-#if !defined(VW_NO_INLINE_SIMD)
-
-#  if defined(__SSE2__) || defined(__SSE3__) || defined(__SSE4_1__)
-
-// Include headers for the various SSE versions:
-#    if defined(__SSE2__)
-#      include <emmintrin.h>
-#    endif
-#    if defined(__SSE3__)
-#      include <tmmintrin.h>
-#    endif
-#    if defined(__SSE4_1__)
-#      include <smmintrin.h>
-#    endif
-
-#    define HAVE_SIMD_MATHMODE
-
-typedef __m128 v4sf;
-typedef __m128i v4si;
-
-inline v4sf v4si_to_v4sf(v4si x) { return _mm_cvtepi32_ps(x); }
-
-inline v4si v4sf_to_v4si(v4sf x) { return _mm_cvttps_epi32(x); }
-
-// Extract v[idx]
-template <const int idx>
-float v4sf_index(const v4sf x)
-{
-#    if defined(__SSE4_1__)
-  float ret;
-  uint32_t val;
-
-  val = _mm_extract_ps(x, idx);
-  // Portably convert uint32_t bit pattern to float. Optimizers will generally
-  // make this disappear.
-  memcpy(&ret, &val, sizeof(uint32_t));
-  return ret;
-#    else
-  return _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(idx, idx, idx, idx)));
-#    endif
-}
-
-// Specialization for the 0'th element
-template <>
-float v4sf_index<0>(const v4sf x)
-{
-  return _mm_cvtss_f32(x);
-}
-
-inline v4sf v4sfl(const float x) { return _mm_set1_ps(x); }
-
-inline v4si v4sil(const uint32_t x) { return _mm_set1_epi32(x); }
-
-#    ifdef _WIN32
-
-inline __m128 operator+(const __m128 a, const __m128 b) { return _mm_add_ps(a, b); }
-
-inline __m128 operator-(const __m128 a, const __m128 b) { return _mm_sub_ps(a, b); }
-
-inline __m128 operator*(const __m128 a, const __m128 b) { return _mm_mul_ps(a, b); }
-
-inline __m128 operator/(const __m128 a, const __m128 b) { return _mm_div_ps(a, b); }
-
-#    endif
-
-inline v4sf vfastpow2(const v4sf p)
-{
-  v4sf ltzero = _mm_cmplt_ps(p, v4sfl(0.0f));
-  v4sf offset = _mm_and_ps(ltzero, v4sfl(1.0f));
-  v4sf lt126 = _mm_cmplt_ps(p, v4sfl(-126.0f));
-  v4sf clipp = _mm_andnot_ps(lt126, p) + _mm_and_ps(lt126, v4sfl(-126.0f));
-  v4si w = v4sf_to_v4si(clipp);
-  v4sf z = clipp - v4si_to_v4sf(w) + offset;
-
-  const v4sf c_121_2740838 = v4sfl(121.2740838f);
-  const v4sf c_27_7280233 = v4sfl(27.7280233f);
-  const v4sf c_4_84252568 = v4sfl(4.84252568f);
-  const v4sf c_1_49012907 = v4sfl(1.49012907f);
-
-  v4sf v = v4sfl(1 << 23) * (clipp + c_121_2740838 + c_27_7280233 / (c_4_84252568 - z) - c_1_49012907 * z);
-
-  return _mm_castsi128_ps(v4sf_to_v4si(v));
-}
-
-inline v4sf vfastexp(const v4sf p)
-{
-  const v4sf c_invlog_2 = v4sfl(1.442695040f);
-
-  return vfastpow2(c_invlog_2 * p);
-}
-
-inline v4sf vfastlog2(v4sf x)
-{
-  v4si vx_i = _mm_castps_si128(x);
-  v4sf mx_f = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(vx_i, v4sil(0x007FFFFF)), v4sil(0x3f000000)));
-  v4sf y = v4si_to_v4sf(vx_i) * v4sfl(1.1920928955078125e-7f);
-
-  const v4sf c_124_22551499 = v4sfl(124.22551499f);
-  const v4sf c_1_498030302 = v4sfl(1.498030302f);
-  const v4sf c_1_725877999 = v4sfl(1.72587999f);
-  const v4sf c_0_3520087068 = v4sfl(0.3520887068f);
-
-  return y - c_124_22551499 - c_1_498030302 * mx_f - c_1_725877999 / (c_0_3520087068 + mx_f);
-}
-
-inline v4sf vfastlog(v4sf x)
-{
-  const v4sf c_0_69314718 = v4sfl(0.69314718f);
-
-  return c_0_69314718 * vfastlog2(x);
-}
-
-inline v4sf vfastdigamma(v4sf x)
-{
-  v4sf twopx = v4sfl(2.0f) + x;
-  v4sf logterm = vfastlog(twopx);
-
-  return (v4sfl(-48.0f) + x * (v4sfl(-157.0f) + x * (v4sfl(-127.0f) - v4sfl(30.0f) * x))) /
-      (v4sfl(12.0f) * x * (v4sfl(1.0f) + x) * twopx * twopx) +
-      logterm;
-}
-
-void vexpdigammify(vw &all, float *gamma, const float underflow_threshold)
-{
-  float extra_sum = 0.0f;
-  v4sf sum = v4sfl(0.0f);
-  float *fp;
-  const float *fpend = gamma + all.lda;
-
-  // Iterate through the initial part of the array that isn't 128-bit SIMD
-  // aligned.
-  for (fp = gamma; fp < fpend && !is_aligned16(fp); ++fp)
-  {
-    extra_sum += *fp;
-    *fp = fastdigamma(*fp);
-  }
-
-  // Rip through the aligned portion...
-  for (; is_aligned16(fp) && fp + 4 < fpend; fp += 4)
-  {
-    v4sf arg = _mm_load_ps(fp);
-    sum = sum + arg;
-    arg = vfastdigamma(arg);
-    _mm_store_ps(fp, arg);
-  }
-
-  for (; fp < fpend; ++fp)
-  {
-    extra_sum += *fp;
-    *fp = fastdigamma(*fp);
-  }
-
-#    if defined(__SSE3__) || defined(__SSE4_1__)
-  // Do two horizontal adds on sum, extract the total from the 0 element:
-  sum = _mm_hadd_ps(sum, sum);
-  sum = _mm_hadd_ps(sum, sum);
-  extra_sum += v4sf_index<0>(sum);
-#    else
-  extra_sum += v4sf_index<0>(sum) + v4sf_index<1>(sum) + v4sf_index<2>(sum) + v4sf_index<3>(sum);
-#    endif
-
-  extra_sum = fastdigamma(extra_sum);
-  sum = v4sfl(extra_sum);
-
-  for (fp = gamma; fp < fpend && !is_aligned16(fp); ++fp) { *fp = fmax(underflow_threshold, fastexp(*fp - extra_sum)); }
-
-  for (; is_aligned16(fp) && fp + 4 < fpend; fp += 4)
-  {
-    v4sf arg = _mm_load_ps(fp);
-    arg = arg - sum;
-    arg = vfastexp(arg);
-    arg = _mm_max_ps(v4sfl(underflow_threshold), arg);
-    _mm_store_ps(fp, arg);
-  }
-
-  for (; fp < fpend; ++fp) { *fp = fmax(underflow_threshold, fastexp(*fp - extra_sum)); }
-}
-
-void vexpdigammify_2(vw &all, float *gamma, const float *norm, const float underflow_threshold)
-{
-  float *fp = gamma;
-  const float *np;
-  const float *fpend = gamma + all.lda;
-
-  for (np = norm; fp < fpend && !is_aligned16(fp); ++fp, ++np)
-    *fp = fmax(underflow_threshold, fastexp(fastdigamma(*fp) - *np));
-
-  for (; is_aligned16(fp) && fp + 4 < fpend; fp += 4, np += 4)
-  {
-    v4sf arg = _mm_load_ps(fp);
-    arg = vfastdigamma(arg);
-    v4sf vnorm = _mm_loadu_ps(np);
-    arg = arg - vnorm;
-    arg = vfastexp(arg);
-    arg = _mm_max_ps(v4sfl(underflow_threshold), arg);
-    _mm_store_ps(fp, arg);
-  }
-
-  for (; fp < fpend; ++fp, ++np) *fp = fmax(underflow_threshold, fastexp(fastdigamma(*fp) - *np));
-}
-
-#  else
-// PLACEHOLDER for future ARM NEON code
-// Also remember to define HAVE_SIMD_MATHMODE
-#  endif
-
-#endif  // !VW_NO_INLINE_SIMD
-
 // Templates for common code shared between the three math modes (SIMD, fast approximations
 // and accurate).
 //
@@ -499,12 +232,7 @@ inline void expdigammify(vw &all, T *gamma, T threshold, T initial)
 template <>
 inline void expdigammify<float, USE_SIMD>(vw &all, float *gamma, float threshold, float)
 {
-#if defined(HAVE_SIMD_MATHMODE)
-  vexpdigammify(all, gamma, threshold);
-#else
-  // Do something sensible if SIMD math isn't available:
-  expdigammify<float, USE_FAST_APPROX>(all, gamma, threshold, 0.0);
-#endif
+  VW::lda_expdigammify(gamma, all.lda, threshold);
 }
 
 template <typename T, const lda_math_mode mtype>
@@ -516,12 +244,7 @@ inline void expdigammify_2(vw &all, float *gamma, T *norm, const T threshold)
 template <>
 inline void expdigammify_2<float, USE_SIMD>(vw &all, float *gamma, float *norm, const float threshold)
 {
-#if defined(HAVE_SIMD_MATHMODE)
-  vexpdigammify_2(all, gamma, norm, threshold);
-#else
-  // Do something sensible if SIMD math isn't available:
-  expdigammify_2<float, USE_FAST_APPROX>(all, gamma, norm, threshold);
-#endif
+  VW::lda_expdigammify_2(gamma, norm, all.lda, threshold);
 }
 
 }  // namespace ldamath
@@ -642,7 +365,7 @@ static inline float average_diff(vw &all, float *oldgamma, float *newgamma)
 }
 
 // Returns E_q[log p(\theta)] - E_q[log q(\theta)].
-float theta_kl(lda &l, v_array<float> &Elogtheta, float *gamma)
+float theta_kl(lda &l, std::vector<float> &Elogtheta, float *gamma)
 {
   float gammasum = 0;
   Elogtheta.clear();
@@ -670,29 +393,18 @@ static inline float find_cw(lda &l, float *u_for_w, float *v)
   return 1.0f / std::inner_product(u_for_w, u_for_w + l.topics, v, 0.0f);
 }
 
-namespace
-{
-// Effectively, these are static and not visible outside the compilation unit.
-v_array<float> new_gamma = v_init<float>();
-v_array<float> old_gamma = v_init<float>();
-}  // namespace
-
 // Returns an estimate of the part of the variational bound that
 // doesn't have to do with beta for the entire corpus for the current
 // setting of lambda based on the document passed in. The value is
 // divided by the total number of words in the document This can be
 // used as a (possibly very noisy) estimate of held-out likelihood.
-float lda_loop(lda &l, v_array<float> &Elogtheta, float *v, example *ec, float)
+float lda_loop(lda &l, lda_estep &estep, float *v, example *ec)
 {
   parameters &weights = l.all->weights;
-  new_gamma.clear();
-  old_gamma.clear();
-
-  for (size_t i = 0; i < l.topics; i++)
-  {
-    new_gamma.push_back(1.f);
-    old_gamma.push_back(0.f);
-  }
+  std::vector<float> &new_gamma = estep.new_gamma;
+  std::vector<float> &old_gamma = estep.old_gamma;
+  new_gamma.assign(l.topics, 1.f);
+  old_gamma.assign(l.topics, 0.f);
   size_t num_words = 0;
   for (features &fs : *ec) num_words += fs.size();
 
@@ -701,11 +413,11 @@ float lda_loop(lda &l, v_array<float> &Elogtheta, float *v, example *ec, float)
   float doc_length = 0;
   do
   {
-    memcpy(v, new_gamma.begin(), sizeof(float) * l.topics);
+    memcpy(v, new_gamma.data(), sizeof(float) * l.topics);
     l.expdigammify(*l.all, v);
 
-    memcpy(old_gamma.begin(), new_gamma.begin(), sizeof(float) * l.topics);
-    memset(new_gamma.begin(), 0, sizeof(float) * l.topics);
+    memcpy(old_gamma.data(), new_gamma.data(), sizeof(float) * l.topics);
+    memset(new_gamma.data(), 0, sizeof(float) * l.topics);
 
     score = 0;
     size_t word_count = 0;
@@ -725,14 +437,14 @@ float lda_loop(lda &l, v_array<float> &Elogtheta, float *v, example *ec, float)
       }
     }
     for (size_t k = 0; k < l.topics; k++) new_gamma[k] = new_gamma[k] * v[k] + l.lda_alpha;
-  } while (average_diff(*l.all, old_gamma.begin(), new_gamma.begin()) > l.lda_epsilon);
+  } while (average_diff(*l.all, old_gamma.data(), new_gamma.data()) > l.lda_epsilon);
 
   ec->pred.scalars.clear();
   ec->pred.scalars.resize(l.topics);
-  memcpy(ec->pred.scalars.begin(), new_gamma.begin(), l.topics * sizeof(float));
+  memcpy(ec->pred.scalars.begin(), new_gamma.data(), l.topics * sizeof(float));
   ec->pred.scalars.end() = ec->pred.scalars.begin() + l.topics;
 
-  score += theta_kl(l, Elogtheta, new_gamma.begin());
+  score += theta_kl(l, estep.Elogtheta, new_gamma.data());
 
   return score / doc_length;
 }
@@ -834,6 +546,29 @@ void return_example(vw &all, example &ec)
   VW::finish_example(all, ec);
 }
 
+// The E-steps of the documents of a minibatch only read the weights, they are computed by --lda_threads threads, each
+// taking every threads-th document. The weights of sparse parameters are inserted as they are read, those are computed
+// by one thread.
+void estep_batch(lda &l)
+{
+  const size_t batch_size = l.examples.size();
+  size_t threads = l.threads != 0 ? l.threads : std::max(1u, std::thread::hardware_concurrency());
+  if (l.all->weights.sparse) threads = 1;
+  threads = std::max<size_t>(1, std::min(threads, batch_size));
+  if (l.esteps.size() < threads) l.esteps.resize(threads);
+  l.scores.resize(batch_size);
+
+  auto estep_documents = [&l, batch_size, threads](size_t first) {
+    for (size_t d = first; d < batch_size; d += threads)
+      l.scores[d] = lda_loop(l, l.esteps[first], &(l.v[d * l.all->lda]), l.examples[d]);
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++)
+    workers.push_back(VW::start_pinned_thread(VW::thread_role::worker, estep_documents, t));
+  estep_documents(0);
+  for (auto &worker : workers) worker.join();
+}
+
 void learn_batch(lda &l)
 {
   parameters &weights = l.all->weights;
@@ -920,9 +655,10 @@ void learn_batch(lda &l)
     l.expdigammify_2(*l.all, u_for_w, l.digammas.begin());
   }
 
+  estep_batch(l);
   for (size_t d = 0; d < batch_size; d++)
   {
-    float score = lda_loop(l, l.Elogtheta, &(l.v[d * l.all->lda]), l.examples[d], l.all->power_t);
+    const float score = l.scores[d];
     if (l.all->audit) GD::print_audit_features(*l.all, *l.examples[d]);
     // If the doc is empty, give it loss of 0.
     if (l.doc_lengths[d] > 0)
@@ -1307,6 +1043,9 @@ VW::LEARNER::base_learner *lda_setup(options_i &options, vw &all)
       .add(make_option("lda_D", ld->lda_D).default_value(10000.0f).help("Number of documents"))
       .add(make_option("lda_epsilon", ld->lda_epsilon).default_value(0.001f).help("Loop convergence threshold"))
       .add(make_option("minibatch", ld->minibatch).default_value(1).help("Minibatch size, for LDA"))
+      .add(make_option("lda_threads", ld->threads)
+               .default_value(1)
+               .help("Threads computing the documents of a minibatch, 0 for one per core"))
       .add(make_option("math-mode", math_mode).default_value(USE_SIMD).help("Math mode: simd, accuracy, fast-approx"))
       .add(make_option("metrics", ld->compute_coherence_metrics).help("Compute metrics"));
 
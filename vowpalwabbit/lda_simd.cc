@@ -0,0 +1,468 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "lda_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "cpu_features.h"
+
+// The AVX kernels are compiled for their instruction sets whatever the flags of the build, and picked at run time, see
+// ftrl_simd.cc. SSE2 is part of every x86-64 CPU and NEON of every AArch64 one.
+#if !defined(VW_NO_INLINE_SIMD) && defined(__SSE2__)
+#  define VW_LDA_SSE
+#  include <emmintrin.h>
+#  if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#    define VW_LDA_AVX
+#    include <immintrin.h>
+#  endif
+#elif !defined(VW_NO_INLINE_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#  define VW_LDA_NEON
+#  include <arm_neon.h>
+#endif
+
+using namespace ldamath;
+
+namespace
+{
+// Each kernel computes count elements, a multiple of 4, with the same operations in the same order whatever the width
+// of its vectors, and without fused multiply adds, so that they compute the same values. digammify adds the groups of 4
+// elements in turn to sums[0..3], before computing their digammas, as the 4 wide kernels do.
+using digammify_fn = void (*)(float* gamma, size_t count, float* sums);
+using expify_fn = void (*)(float* gamma, size_t count, float shift, float threshold);
+using expdigammify_2_fn = void (*)(float* gamma, const float* norm, size_t count, float threshold);
+
+struct kernels
+{
+  digammify_fn digammify;  // gamma[k] = digamma(gamma[k])
+  expify_fn expify;        // gamma[k] = max(threshold, exp(gamma[k] - shift))
+  expdigammify_2_fn expdigammify_2;
+  const char* variant;
+};
+
+#ifdef VW_LDA_SSE
+inline __m128 sse_fastpow2(__m128 p)
+{
+  const __m128 ltzero = _mm_cmplt_ps(p, _mm_set1_ps(0.0f));
+  const __m128 offset = _mm_and_ps(ltzero, _mm_set1_ps(1.0f));
+  const __m128 lt126 = _mm_cmplt_ps(p, _mm_set1_ps(-126.0f));
+  const __m128 clipp = _mm_add_ps(_mm_andnot_ps(lt126, p), _mm_and_ps(lt126, _mm_set1_ps(-126.0f)));
+  const __m128 z = _mm_add_ps(_mm_sub_ps(clipp, _mm_cvtepi32_ps(_mm_cvttps_epi32(clipp))), offset);
+
+  const __m128 v = _mm_mul_ps(_mm_set1_ps(1 << 23),
+      _mm_sub_ps(_mm_add_ps(_mm_add_ps(clipp, _mm_set1_ps(121.2740838f)),
+                     _mm_div_ps(_mm_set1_ps(27.7280233f), _mm_sub_ps(_mm_set1_ps(4.84252568f), z))),
+          _mm_mul_ps(_mm_set1_ps(1.49012907f), z)));
+  return _mm_castsi128_ps(_mm_cvttps_epi32(v));
+}
+
+inline __m128 sse_fastexp(__m128 p) { return sse_fastpow2(_mm_mul_ps(_mm_set1_ps(1.442695040f), p)); }
+
+inline __m128 sse_fastlog(__m128 x)
+{
+  const __m128i vx_i = _mm_castps_si128(x);
+  const __m128 mx_f =
+      _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(vx_i, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3f000000)));
+  const __m128 y = _mm_mul_ps(_mm_cvtepi32_ps(vx_i), _mm_set1_ps(1.1920928955078125e-7f));
+
+  const __m128 log2 = _mm_sub_ps(
+      _mm_sub_ps(_mm_sub_ps(y, _mm_set1_ps(124.22551499f)), _mm_mul_ps(_mm_set1_ps(1.498030302f), mx_f)),
+      _mm_div_ps(_mm_set1_ps(1.72587999f), _mm_add_ps(_mm_set1_ps(0.3520887068f), mx_f)));
+  return _mm_mul_ps(_mm_set1_ps(0.69314718f), log2);
+}
+
+inline __m128 sse_fastdigamma(__m128 x)
+{
+  const __m128 twopx = _mm_add_ps(_mm_set1_ps(2.0f), x);
+  const __m128 numerator = _mm_add_ps(_mm_set1_ps(-48.0f),
+      _mm_mul_ps(x,
+          _mm_add_ps(_mm_set1_ps(-157.0f),
+              _mm_mul_ps(x, _mm_sub_ps(_mm_set1_ps(-127.0f), _mm_mul_ps(_mm_set1_ps(30.0f), x))))));
+  const __m128 denominator = _mm_mul_ps(
+      _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(12.0f), x), _mm_add_ps(_mm_set1_ps(1.0f), x)), twopx), twopx);
+  return _mm_add_ps(_mm_div_ps(numerator, denominator), sse_fastlog(twopx));
+}
+
+void sse_digammify(float* gamma, size_t count, float* sums)
+{
+  __m128 sum = _mm_loadu_ps(sums);
+  for (size_t i = 0; i < count; i += 4)
+  {
+    const __m128 arg = _mm_loadu_ps(gamma + i);
+    sum = _mm_add_ps(sum, arg);
+    _mm_storeu_ps(gamma + i, sse_fastdigamma(arg));
+  }
+  _mm_storeu_ps(sums, sum);
+}
+
+void sse_expify(float* gamma, size_t count, float shift, float threshold)
+{
+  for (size_t i = 0; i < count; i += 4)
+  {
+    const __m128 arg = sse_fastexp(_mm_sub_ps(_mm_loadu_ps(gamma + i), _mm_set1_ps(shift)));
+    _mm_storeu_ps(gamma + i, _mm_max_ps(_mm_set1_ps(threshold), arg));
+  }
+}
+
+void sse_expdigammify_2(float* gamma, const float* norm, size_t count, float threshold)
+{
+  for (size_t i = 0; i < count; i += 4)
+  {
+    const __m128 arg = sse_fastexp(_mm_sub_ps(sse_fastdigamma(_mm_loadu_ps(gamma + i)), _mm_loadu_ps(norm + i)));
+    _mm_storeu_ps(gamma + i, _mm_max_ps(_mm_set1_ps(threshold), arg));
+  }
+}
+#endif
+
+#ifdef VW_LDA_AVX
+__attribute__((target("avx2"))) inline __m256 avx2_fastpow2(__m256 p)
+{
+  const __m256 ltzero = _mm256_cmp_ps(p, _mm256_set1_ps(0.0f), _CMP_LT_OS);
+  const __m256 offset = _mm256_and_ps(ltzero, _mm256_set1_ps(1.0f));
+  const __m256 lt126 = _mm256_cmp_ps(p, _mm256_set1_ps(-126.0f), _CMP_LT_OS);
+  const __m256 clipp = _mm256_add_ps(_mm256_andnot_ps(lt126, p), _mm256_and_ps(lt126, _mm256_set1_ps(-126.0f)));
+  const __m256 z = _mm256_add_ps(_mm256_sub_ps(clipp, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(clipp))), offset);
+
+  const __m256 v = _mm256_mul_ps(_mm256_set1_ps(1 << 23),
+      _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(clipp, _mm256_set1_ps(121.2740838f)),
+                        _mm256_div_ps(_mm256_set1_ps(27.7280233f), _mm256_sub_ps(_mm256_set1_ps(4.84252568f), z))),
+          _mm256_mul_ps(_mm256_set1_ps(1.49012907f), z)));
+  return _mm256_castsi256_ps(_mm256_cvttps_epi32(v));
+}
+
+__attribute__((target("avx2"))) inline __m256 avx2_fastexp(__m256 p)
+{
+  return avx2_fastpow2(_mm256_mul_ps(_mm256_set1_ps(1.442695040f), p));
+}
+
+__attribute__((target("avx2"))) inline __m256 avx2_fastlog(__m256 x)
+{
+  const __m256i vx_i = _mm256_castps_si256(x);
+  const __m256 mx_f = _mm256_castsi256_ps(
+      _mm256_or_si256(_mm256_and_si256(vx_i, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3f000000)));
+  const __m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(vx_i), _mm256_set1_ps(1.1920928955078125e-7f));
+
+  const __m256 log2 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(y, _mm256_set1_ps(124.22551499f)),
+                                        _mm256_mul_ps(_mm256_set1_ps(1.498030302f), mx_f)),
+      _mm256_div_ps(_mm256_set1_ps(1.72587999f), _mm256_add_ps(_mm256_set1_ps(0.3520887068f), mx_f)));
+  return _mm256_mul_ps(_mm256_set1_ps(0.69314718f), log2);
+}
+
+__attribute__((target("avx2"))) inline __m256 avx2_fastdigamma(__m256 x)
+{
+  const __m256 twopx = _mm256_add_ps(_mm256_set1_ps(2.0f), x);
+  const __m256 numerator = _mm256_add_ps(_mm256_set1_ps(-48.0f),
+      _mm256_mul_ps(x,
+          _mm256_add_ps(_mm256_set1_ps(-157.0f),
+              _mm256_mul_ps(x, _mm256_sub_ps(_mm256_set1_ps(-127.0f), _mm256_mul_ps(_mm256_set1_ps(30.0f), x))))));
+  const __m256 denominator = _mm256_mul_ps(
+      _mm256_mul_ps(
+          _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(12.0f), x), _mm256_add_ps(_mm256_set1_ps(1.0f), x)), twopx),
+      twopx);
+  return _mm256_add_ps(_mm256_div_ps(numerator, denominator), avx2_fastlog(twopx));
+}
+
+__attribute__((target("avx2"))) void avx2_digammify(float* gamma, size_t count, float* sums)
+{
+  __m128 sum = _mm_loadu_ps(sums);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 arg = _mm256_loadu_ps(gamma + i);
+    sum = _mm_add_ps(_mm_add_ps(sum, _mm256_castps256_ps128(arg)), _mm256_extractf128_ps(arg, 1));
+    _mm256_storeu_ps(gamma + i, avx2_fastdigamma(arg));
+  }
+  _mm_storeu_ps(sums, sum);
+  sse_digammify(gamma + i, count - i, sums);
+}
+
+__attribute__((target("avx2"))) void avx2_expify(float* gamma, size_t count, float shift, float threshold)
+{
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 arg = avx2_fastexp(_mm256_sub_ps(_mm256_loadu_ps(gamma + i), _mm256_set1_ps(shift)));
+    _mm256_storeu_ps(gamma + i, _mm256_max_ps(_mm256_set1_ps(threshold), arg));
+  }
+  sse_expify(gamma + i, count - i, shift, threshold);
+}
+
+__attribute__((target("avx2"))) void avx2_expdigammify_2(float* gamma, const float* norm, size_t count, float threshold)
+{
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 arg =
+        avx2_fastexp(_mm256_sub_ps(avx2_fastdigamma(_mm256_loadu_ps(gamma + i)), _mm256_loadu_ps(norm + i)));
+    _mm256_storeu_ps(gamma + i, _mm256_max_ps(_mm256_set1_ps(threshold), arg));
+  }
+  sse_expdigammify_2(gamma + i, norm + i, count - i, threshold);
+}
+
+// The masks of AVX-512 select +0 where those of SSE and AVX2 are anded, so that the clipping adds the same zeros.
+__attribute__((target("avx512f,avx2"))) inline __m512 avx512_fastpow2(__m512 p)
+{
+  const __m512 zero = _mm512_setzero_ps();
+  const __mmask16 ltzero = _mm512_cmp_ps_mask(p, zero, _CMP_LT_OS);
+  const __m512 offset = _mm512_mask_blend_ps(ltzero, zero, _mm512_set1_ps(1.0f));
+  const __mmask16 lt126 = _mm512_cmp_ps_mask(p, _mm512_set1_ps(-126.0f), _CMP_LT_OS);
+  const __m512 clipp = _mm512_add_ps(_mm512_maskz_mov_ps(static_cast<__mmask16>(~lt126), p),
+      _mm512_maskz_mov_ps(lt126, _mm512_set1_ps(-126.0f)));
+  const __m512 z = _mm512_add_ps(_mm512_sub_ps(clipp, _mm512_cvtepi32_ps(_mm512_cvttps_epi32(clipp))), offset);
+
+  const __m512 v = _mm512_mul_ps(_mm512_set1_ps(1 << 23),
+      _mm512_sub_ps(_mm512_add_ps(_mm512_add_ps(clipp, _mm512_set1_ps(121.2740838f)),
+                        _mm512_div_ps(_mm512_set1_ps(27.7280233f), _mm512_sub_ps(_mm512_set1_ps(4.84252568f), z))),
+          _mm512_mul_ps(_mm512_set1_ps(1.49012907f), z)));
+  return _mm512_castsi512_ps(_mm512_cvttps_epi32(v));
+}
+
+__attribute__((target("avx512f,avx2"))) inline __m512 avx512_fastexp(__m512 p)
+{
+  return avx512_fastpow2(_mm512_mul_ps(_mm512_set1_ps(1.442695040f), p));
+}
+
+__attribute__((target("avx512f,avx2"))) inline __m512 avx512_fastlog(__m512 x)
+{
+  const __m512i vx_i = _mm512_castps_si512(x);
+  const __m512 mx_f = _mm512_castsi512_ps(
+      _mm512_or_si512(_mm512_and_si512(vx_i, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3f000000)));
+  const __m512 y = _mm512_mul_ps(_mm512_cvtepi32_ps(vx_i), _mm512_set1_ps(1.1920928955078125e-7f));
+
+  const __m512 log2 = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(y, _mm512_set1_ps(124.22551499f)),
+                                        _mm512_mul_ps(_mm512_set1_ps(1.498030302f), mx_f)),
+      _mm512_div_ps(_mm512_set1_ps(1.72587999f), _mm512_add_ps(_mm512_set1_ps(0.3520887068f), mx_f)));
+  return _mm512_mul_ps(_mm512_set1_ps(0.69314718f), log2);
+}
+
+__attribute__((target("avx512f,avx2"))) inline __m512 avx512_fastdigamma(__m512 x)
+{
+  const __m512 twopx = _mm512_add_ps(_mm512_set1_ps(2.0f), x);
+  const __m512 numerator = _mm512_add_ps(_mm512_set1_ps(-48.0f),
+      _mm512_mul_ps(x,
+          _mm512_add_ps(_mm512_set1_ps(-157.0f),
+              _mm512_mul_ps(x, _mm512_sub_ps(_mm512_set1_ps(-127.0f), _mm512_mul_ps(_mm512_set1_ps(30.0f), x))))));
+  const __m512 denominator = _mm512_mul_ps(
+      _mm512_mul_ps(
+          _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(12.0f), x), _mm512_add_ps(_mm512_set1_ps(1.0f), x)), twopx),
+      twopx);
+  return _mm512_add_ps(_mm512_div_ps(numerator, denominator), avx512_fastlog(twopx));
+}
+
+__attribute__((target("avx512f,avx2"))) void avx512_digammify(float* gamma, size_t count, float* sums)
+{
+  __m128 sum = _mm_loadu_ps(sums);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m512 arg = _mm512_loadu_ps(gamma + i);
+    sum = _mm_add_ps(sum, _mm512_extractf32x4_ps(arg, 0));
+    sum = _mm_add_ps(sum, _mm512_extractf32x4_ps(arg, 1));
+    sum = _mm_add_ps(sum, _mm512_extractf32x4_ps(arg, 2));
+    sum = _mm_add_ps(sum, _mm512_extractf32x4_ps(arg, 3));
+    _mm512_storeu_ps(gamma + i, avx512_fastdigamma(arg));
+  }
+  _mm_storeu_ps(sums, sum);
+  avx2_digammify(gamma + i, count - i, sums);
+}
+
+__attribute__((target("avx512f,avx2"))) void avx512_expify(float* gamma, size_t count, float shift, float threshold)
+{
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m512 arg = avx512_fastexp(_mm512_sub_ps(_mm512_loadu_ps(gamma + i), _mm512_set1_ps(shift)));
+    _mm512_storeu_ps(gamma + i, _mm512_max_ps(_mm512_set1_ps(threshold), arg));
+  }
+  avx2_expify(gamma + i, count - i, shift, threshold);
+}
+
+__attribute__((target("avx512f,avx2"))) void avx512_expdigammify_2(
+    float* gamma, const float* norm, size_t count, float threshold)
+{
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m512 arg =
+        avx512_fastexp(_mm512_sub_ps(avx512_fastdigamma(_mm512_loadu_ps(gamma + i)), _mm512_loadu_ps(norm + i)));
+    _mm512_storeu_ps(gamma + i, _mm512_max_ps(_mm512_set1_ps(threshold), arg));
+  }
+  avx2_expdigammify_2(gamma + i, norm + i, count - i, threshold);
+}
+#endif
+
+#ifdef VW_LDA_NEON
+inline float32x4_t neon_fastpow2(float32x4_t p)
+{
+  const uint32x4_t ltzero = vcltq_f32(p, vdupq_n_f32(0.0f));
+  const float32x4_t offset = vreinterpretq_f32_u32(vandq_u32(ltzero, vreinterpretq_u32_f32(vdupq_n_f32(1.0f))));
+  const uint32x4_t lt126 = vcltq_f32(p, vdupq_n_f32(-126.0f));
+  const float32x4_t clipp = vaddq_f32(vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(p), lt126)),
+      vreinterpretq_f32_u32(vandq_u32(lt126, vreinterpretq_u32_f32(vdupq_n_f32(-126.0f)))));
+  const float32x4_t z = vaddq_f32(vsubq_f32(clipp, vcvtq_f32_s32(vcvtq_s32_f32(clipp))), offset);
+
+  const float32x4_t v = vmulq_f32(vdupq_n_f32(1 << 23),
+      vsubq_f32(vaddq_f32(vaddq_f32(clipp, vdupq_n_f32(121.2740838f)),
+                    vdivq_f32(vdupq_n_f32(27.7280233f), vsubq_f32(vdupq_n_f32(4.84252568f), z))),
+          vmulq_f32(vdupq_n_f32(1.49012907f), z)));
+  return vreinterpretq_f32_s32(vcvtq_s32_f32(v));
+}
+
+inline float32x4_t neon_fastexp(float32x4_t p) { return neon_fastpow2(vmulq_f32(vdupq_n_f32(1.442695040f), p)); }
+
+inline float32x4_t neon_fastlog(float32x4_t x)
+{
+  const int32x4_t vx_i = vreinterpretq_s32_f32(x);
+  const float32x4_t mx_f =
+      vreinterpretq_f32_s32(vorrq_s32(vandq_s32(vx_i, vdupq_n_s32(0x007FFFFF)), vdupq_n_s32(0x3f000000)));
+  const float32x4_t y = vmulq_f32(vcvtq_f32_s32(vx_i), vdupq_n_f32(1.1920928955078125e-7f));
+
+  const float32x4_t log2 =
+      vsubq_f32(vsubq_f32(vsubq_f32(y, vdupq_n_f32(124.22551499f)), vmulq_f32(vdupq_n_f32(1.498030302f), mx_f)),
+          vdivq_f32(vdupq_n_f32(1.72587999f), vaddq_f32(vdupq_n_f32(0.3520887068f), mx_f)));
+  return vmulq_f32(vdupq_n_f32(0.69314718f), log2);
+}
+
+inline float32x4_t neon_fastdigamma(float32x4_t x)
+{
+  const float32x4_t twopx = vaddq_f32(vdupq_n_f32(2.0f), x);
+  const float32x4_t numerator = vaddq_f32(vdupq_n_f32(-48.0f),
+      vmulq_f32(x,
+          vaddq_f32(vdupq_n_f32(-157.0f),
+              vmulq_f32(x, vsubq_f32(vdupq_n_f32(-127.0f), vmulq_f32(vdupq_n_f32(30.0f), x))))));
+  const float32x4_t denominator = vmulq_f32(
+      vmulq_f32(vmulq_f32(vmulq_f32(vdupq_n_f32(12.0f), x), vaddq_f32(vdupq_n_f32(1.0f), x)), twopx), twopx);
+  return vaddq_f32(vdivq_f32(numerator, denominator), neon_fastlog(twopx));
+}
+
+void neon_digammify(float* gamma, size_t count, float* sums)
+{
+  float32x4_t sum = vld1q_f32(sums);
+  for (size_t i = 0; i < count; i += 4)
+  {
+    const float32x4_t arg = vld1q_f32(gamma + i);
+    sum = vaddq_f32(sum, arg);
+    vst1q_f32(gamma + i, neon_fastdigamma(arg));
+  }
+  vst1q_f32(sums, sum);
+}
+
+void neon_expify(float* gamma, size_t count, float shift, float threshold)
+{
+  for (size_t i = 0; i < count; i += 4)
+  {
+    const float32x4_t arg = neon_fastexp(vsubq_f32(vld1q_f32(gamma + i), vdupq_n_f32(shift)));
+    vst1q_f32(gamma + i, vmaxq_f32(vdupq_n_f32(threshold), arg));
+  }
+}
+
+void neon_expdigammify_2(float* gamma, const float* norm, size_t count, float threshold)
+{
+  for (size_t i = 0; i < count; i += 4)
+  {
+    const float32x4_t arg = neon_fastexp(vsubq_f32(neon_fastdigamma(vld1q_f32(gamma + i)), vld1q_f32(norm + i)));
+    vst1q_f32(gamma + i, vmaxq_f32(vdupq_n_f32(threshold), arg));
+  }
+}
+#endif
+
+#if defined(VW_LDA_SSE) || defined(VW_LDA_NEON)
+kernels select_kernels()
+{
+#  ifdef VW_LDA_AVX
+  const VW::cpu_features& cpu = VW::detected_cpu_features();
+  if (cpu.avx512f) return {avx512_digammify, avx512_expify, avx512_expdigammify_2, "avx512"};
+  if (cpu.avx2) return {avx2_digammify, avx2_expify, avx2_expdigammify_2, "avx2"};
+#  endif
+#  ifdef VW_LDA_NEON
+  return {neon_digammify, neon_expify, neon_expdigammify_2, "neon"};
+#  else
+  return {sse_digammify, sse_expify, sse_expdigammify_2, "sse2"};
+#  endif
+}
+
+const kernels& selected()
+{
+  static const kernels selection = select_kernels();
+  return selection;
+}
+
+// The elements [begin, end) of gamma computed in vectors: from the first one aligned on 16 bytes, by groups of 4,
+// leaving at least one element after them.
+void vector_range(const float* gamma, size_t count, size_t& begin, size_t& end)
+{
+  begin = 0;
+  while (begin < count && (reinterpret_cast<uintptr_t>(gamma + begin) & 0x0f) != 0) ++begin;
+  end = begin == count ? begin : begin + (count - begin - 1) / 4 * 4;
+}
+#endif
+}  // namespace
+
+namespace VW
+{
+void lda_expdigammify(float* gamma, size_t count, float threshold)
+{
+#if defined(VW_LDA_SSE) || defined(VW_LDA_NEON)
+  size_t begin;
+  size_t end;
+  vector_range(gamma, count, begin, end);
+
+  float extra_sum = 0.0f;
+  for (size_t i = 0; i < begin; ++i)
+  {
+    extra_sum += gamma[i];
+    gamma[i] = fastdigamma(gamma[i]);
+  }
+  float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  selected().digammify(gamma + begin, end - begin, sums);
+  for (size_t i = end; i < count; ++i)
+  {
+    extra_sum += gamma[i];
+    gamma[i] = fastdigamma(gamma[i]);
+  }
+#  ifdef __SSE3__
+  // As the horizontal adds of SSE3 order them.
+  extra_sum += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#  else
+  extra_sum += sums[0] + sums[1] + sums[2] + sums[3];
+#  endif
+  extra_sum = fastdigamma(extra_sum);
+
+  for (size_t i = 0; i < begin; ++i) gamma[i] = fmax(threshold, fastexp(gamma[i] - extra_sum));
+  selected().expify(gamma + begin, end - begin, extra_sum, threshold);
+  for (size_t i = end; i < count; ++i) gamma[i] = fmax(threshold, fastexp(gamma[i] - extra_sum));
+#else
+  const float sum = fastdigamma(std::accumulate(gamma, gamma + count, 0.0f));
+  std::transform(gamma, gamma + count, gamma,
+      [sum, threshold](float g) { return fmax(threshold, fastexp(fastdigamma(g) - sum)); });
+#endif
+}
+
+void lda_expdigammify_2(float* gamma, const float* norm, size_t count, float threshold)
+{
+#if defined(VW_LDA_SSE) || defined(VW_LDA_NEON)
+  size_t begin;
+  size_t end;
+  vector_range(gamma, count, begin, end);
+
+  for (size_t i = 0; i < begin; ++i) gamma[i] = fmax(threshold, fastexp(fastdigamma(gamma[i]) - norm[i]));
+  selected().expdigammify_2(gamma + begin, norm + begin, end - begin, threshold);
+  for (size_t i = end; i < count; ++i) gamma[i] = fmax(threshold, fastexp(fastdigamma(gamma[i]) - norm[i]));
+#else
+  std::transform(gamma, gamma + count, norm, gamma,
+      [threshold](float g, float n) { return fmax(threshold, fastexp(fastdigamma(g) - n)); });
+#endif
+}
+
+const char* lda_kernel_variant()
+{
+#if defined(VW_LDA_SSE) || defined(VW_LDA_NEON)
+  return selected().variant;
+#else
+  return "scalar";
+#endif
+}
+}  // namespace VW
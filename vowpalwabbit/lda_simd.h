@@ -0,0 +1,84 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ldamath
+{
+// The fast approximations of --lda, for its fast-approx math mode and for the elements its simd math mode does not
+// compute in vectors.
+inline float fastlog2(float x)
+{
+  uint32_t mx;
+  memcpy(&mx, &x, sizeof(uint32_t));
+  mx = (mx & 0x007FFFFF) | (0x7e << 23);
+
+  float mx_f;
+  memcpy(&mx_f, &mx, sizeof(float));
+
+  uint32_t vx;
+  memcpy(&vx, &x, sizeof(uint32_t));
+
+  float y = static_cast<float>(vx);
+  y *= 1.0f / (float)(1 << 23);
+
+  return y - 124.22544637f - 1.498030302f * mx_f - 1.72587999f / (0.3520887068f + mx_f);
+}
+
+inline float fastlog(float x) { return 0.69314718f * fastlog2(x); }
+
+inline float fastpow2(float p)
+{
+  float offset = (p < 0) * 1.0f;
+  float clipp = (p < -126.0) ? -126.0f : p;
+  int w = (int)clipp;
+  float z = clipp - w + offset;
+  uint32_t approx = (uint32_t)((1 << 23) * (clipp + 121.2740838f + 27.7280233f / (4.84252568f - z) - 1.49012907f * z));
+
+  float v;
+  memcpy(&v, &approx, sizeof(uint32_t));
+  return v;
+}
+
+inline float fastexp(float p) { return fastpow2(1.442695040f * p); }
+
+inline float fastpow(float x, float p) { return fastpow2(p * fastlog2(x)); }
+
+inline float fastlgamma(float x)
+{
+  float logterm = fastlog(x * (1.0f + x) * (2.0f + x));
+  float xp3 = 3.0f + x;
+
+  return -2.081061466f - x + 0.0833333f / xp3 - logterm + (2.5f + x) * fastlog(xp3);
+}
+
+inline float fastdigamma(float x)
+{
+  float twopx = 2.0f + x;
+  float logterm = fastlog(twopx);
+
+  return -(1.0f + 2.0f * x) / (x * (1.0f + x)) - (13.0f + 6.0f * x) / (12.0f * twopx * twopx) + logterm;
+}
+}  // namespace ldamath
+
+namespace VW
+{
+// The simd math mode of --lda. The elements of gamma from the first one aligned on 16 bytes are computed in vectors,
+// by groups of 4 but for the last one, the others by the fast approximations above. The vectors are 16 wide with
+// AVX-512, 8 wide with AVX2 and 4 wide with SSE2 or NEON, as the CPU supports, and compute the same values whatever
+// their width. Without any of them the fast approximations compute every element.
+
+// gamma[k] = max(threshold, exp(digamma(gamma[k]) - digamma(the sum of the count elements of gamma)))
+void lda_expdigammify(float* gamma, size_t count, float threshold);
+
+// gamma[k] = max(threshold, exp(digamma(gamma[k]) - norm[k]))
+void lda_expdigammify_2(float* gamma, const float* norm, size_t count, float threshold);
+
+// avx512, avx2, sse2, neon or scalar, whichever the functions above run.
+const char* lda_kernel_variant();
+}  // namespace VW
@@ -7,6 +7,16 @@
 #include "vw.h"
 #include "parse_regressor.h"
 #include "parse_dispatch_loop.h"
+#include "model_reloader.h"
+#include "thread_affinity.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #define CASE(type) \
   case type:       \
@@ -63,6 +73,21 @@ void save(example& ec, vw& all)
 
   if (!all.logger.quiet) all.trace_message << "saving regressor to " << final_regressor_name << std::endl;
   save_predictor(all, final_regressor_name, 0);
+  if (all.commit_checkpoint) all.commit_checkpoint();
+
+  VW::finish_example(all, ec);
+}
+
+void reload(example& ec, vw& all)
+{
+  // reload model command, with --reload_model
+  std::string model_file;
+  if ((ec.tag).size() >= 8 && (ec.tag)[6] == '_') model_file = std::string(ec.tag.begin() + 7, (ec.tag).size() - 7);
+
+  if (all.model_reloader != nullptr)
+    all.model_reloader->request(model_file);
+  else
+    all.trace_message << "warning: ignoring reload command, the model is reloaded with --reload_model" << std::endl;
 
   VW::finish_example(all, ec);
 }
@@ -86,6 +111,11 @@ bool inline is_save_cmd(example* ec)
   return (ec->tag.size() >= 4) && (0 == strncmp((const char*)ec->tag.begin(), "save", 4));
 }
 
+bool inline is_reload_cmd(example* ec)
+{
+  return (ec->tag.size() >= 6) && (0 == strncmp((const char*)ec->tag.begin(), "reload", 6));
+}
+
 void drain_examples(vw& all)
 {
   if (all.early_terminate)
@@ -150,6 +180,8 @@ public:
       _context.template process<example, end_pass>(*ec);
     else if (is_save_cmd(ec))
       _context.template process<example, save>(*ec);
+    else if (is_reload_cmd(ec))
+      _context.template process<example, reload>(*ec);
     else
       _context.template process<example, learn_ex>(*ec);
   }
@@ -183,6 +215,8 @@ private:
       _context.template process<example, end_pass>(*ec);
     else if (is_save_cmd(ec))
       _context.template process<example, save>(*ec);
+    else if (is_reload_cmd(ec))
+      _context.template process<example, reload>(*ec);
     else
       return complete_multi_ex(ec);
     return false;
@@ -215,12 +249,34 @@ private:
 class ready_examples_queue
 {
 public:
-  ready_examples_queue(vw& master) : _master(master) {}
+  ready_examples_queue(vw& master)
+      : _master(master), _batch(std::max<size_t>(master.example_parser->dispatch_batch_size, 1))
+  {
+  }
 
-  example* pop() { return !_master.early_terminate ? VW::get_example(_master.example_parser) : nullptr; }
+  // Takes examples off the parser queue a batch at a time and hands them out one by one.
+  example* pop()
+  {
+    if (_master.early_terminate)
+    {
+      // Examples already taken off the queue are not seen by drain_examples, so they are finished here.
+      for (; _index < _count; _index++) { VW::finish_example(_master, *_batch[_index]); }
+      return nullptr;
+    }
+    if (_index == _count)
+    {
+      _index = 0;
+      _count = _master.example_parser->ready_parsed_examples.pop_many(_batch.data(), _batch.size());
+      if (_count == 0) { return nullptr; }
+    }
+    return _batch[_index++];
+  }
 
 private:
   vw& _master;
+  std::vector<example*> _batch;
+  size_t _index{0};
+  size_t _count{0};
 };
 
 class custom_examples_queue
@@ -261,8 +317,345 @@ void generic_driver(ready_examples_queue& examples, context_type& context)
   drain_examples(context.get_master());
 }
 
+// Examples are finished in the order they were parsed, whichever learner thread learned from them, see --threads.
+class example_turns
+{
+public:
+  // Waits until the example that took this ticket is next, false if the learning was aborted.
+  bool wait(uint64_t ticket)
+  {
+    std::unique_lock<std::mutex> lock(_lock);
+    _turn.wait(lock, [&] { return _next == ticket || _aborted; });
+    return !_aborted;
+  }
+
+  void done()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      ++_next;
+    }
+    _turn.notify_all();
+  }
+
+  void abort()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _aborted = true;
+    }
+    _turn.notify_all();
+  }
+
+private:
+  std::mutex _lock;
+  std::condition_variable _turn;
+  uint64_t _next{0};
+  bool _aborted{false};
+};
+
+struct threaded_examples
+{
+  threaded_examples(vw& master) : examples(master) {}
+
+  std::mutex pop_lock;
+  ready_examples_queue examples;
+  uint64_t next_ticket{0};
+  example_turns turns;
+};
+
+inline bool is_command(example* ec)
+{
+  return ec->indices.size() <= 1 && (ec->end_pass || is_save_cmd(ec) || is_reload_cmd(ec));
+}
+
+// Commands are run once everything before them is finished, and before anything after them is taken, so this is called
+// with the pop lock held. False if the learning was aborted.
+bool run_command(threaded_examples& shared, multi_instance_context& everyone, example& ec)
+{
+  vw& master = everyone.get_master();
+  if (!shared.turns.wait(shared.next_ticket++)) { return false; }
+  if (ec.end_pass)
+    everyone.process<example, end_pass>(ec);
+  else if (is_save_cmd(&ec))
+    save(ec, master);
+  else
+    reload(ec, master);
+  shared.turns.done();
+  return true;
+}
+
+// Learns with one of the instances from the examples the threads take in turn. The weights are shared and updated
+// without locking, as the shared data is, which finishing the examples in order keeps consistent.
+void learn_in_thread(threaded_examples& shared, vw& learner, const std::vector<vw*>& all)
+{
+  vw& master = *all.front();
+  multi_instance_context everyone(all);
+  while (true)
+  {
+    example* ec;
+    uint64_t ticket;
+    {
+      std::lock_guard<std::mutex> lock(shared.pop_lock);
+      if ((ec = shared.examples.pop()) == nullptr) { return; }
+
+      if (is_command(ec))
+      {
+        if (!run_command(shared, everyone, *ec)) { return; }
+        continue;
+      }
+      ticket = shared.next_ticket++;
+    }
+
+    learner.learn(*ec);
+    if (!shared.turns.wait(ticket)) { return; }
+    as_singleline(master.l)->finish_example(master, *ec);
+    shared.turns.done();
+  }
+}
+
+// Predicts with one of the instances from the whole multi_ex the threads take in turn. Without learning, each multi_ex
+// is predicted independently of the others. It is finished by the reductions of the instance that predicted it, which
+// keep what its output needs, into the sinks and the shared data of master.
+void predict_multi_ex_in_thread(threaded_examples& shared, vw& learner, const std::vector<vw*>& all)
+{
+  vw& master = *all.front();
+  multi_instance_context everyone(all);
+  multi_ex ec_seq;
+  while (true)
+  {
+    uint64_t ticket;
+    {
+      std::lock_guard<std::mutex> lock(shared.pop_lock);
+      bool complete = false;
+      example* ec = nullptr;
+      while (!complete && (ec = shared.examples.pop()) != nullptr)
+      {
+        if (is_command(ec))
+        {
+          if (!run_command(shared, everyone, *ec)) { return; }
+        }
+        else if (example_is_newline_not_header(*ec, master) && master.example_parser->lbl_parser.test_label(&ec->l))
+        {
+          VW::finish_example(master, *ec);
+          complete = true;
+        }
+        else
+          ec_seq.push_back(ec);
+      }
+      if (ec_seq.empty())
+      {
+        if (complete) { continue; }
+        return;
+      }
+      ticket = shared.next_ticket++;
+    }
+
+    learner.learn(ec_seq);
+    if (!shared.turns.wait(ticket)) { return; }
+    as_multiline(learner.l)->finish_example(master, ec_seq);
+    shared.turns.done();
+    ec_seq.clear();
+  }
+}
+
+void threaded_driver(vw& master)
+{
+  if (master.l->is_multiline && master.training)
+    THROW("--threads learns only from single examples, multiline examples are predicted in parallel with -t");
+  if (master.audit || master.hash_inv) THROW("--threads can't be used with --audit or --invert_hash");
+
+  std::vector<vw*> all{&master};
+  for (size_t i = 1; i < master.learner_threads; i++) all.push_back(VW::seed_vw_learner(master));
+
+  threaded_examples shared(master);
+  std::exception_ptr failure;
+  std::mutex failure_lock;
+  std::vector<std::thread> threads;
+  for (vw* learner : all)
+  {
+    threads.emplace_back([&, learner] {
+      VW::pin_current_thread(VW::thread_role::learner);
+      try
+      {
+        if (master.l->is_multiline)
+          predict_multi_ex_in_thread(shared, *learner, all);
+        else
+          learn_in_thread(shared, *learner, all);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(failure_lock);
+        if (!failure) failure = std::current_exception();
+        shared.turns.abort();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (size_t i = 1; i < all.size(); i++)
+  {
+    all[i]->l->end_examples();
+    VW::finish(*all[i]);
+  }
+  if (failure) std::rethrow_exception(failure);
+  drain_examples(master);
+}
+
+// The holdout examples the learning thread hands to the thread predicting them, with their tickets, see holdout_driver.
+class holdout_queue
+{
+public:
+  // False if the evaluation was aborted.
+  bool push(example* ec, uint64_t ticket)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_lock);
+      _changed.wait(lock, [&] { return _examples.size() < capacity || _aborted; });
+      if (_aborted) { return false; }
+      _examples.emplace_back(ec, ticket);
+    }
+    _changed.notify_all();
+    return true;
+  }
+
+  // False once the queue is closed and empty, or the evaluation was aborted.
+  bool pop(example*& ec, uint64_t& ticket)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_lock);
+      _changed.wait(lock, [&] { return !_examples.empty() || _closed || _aborted; });
+      if (_examples.empty() || _aborted) { return false; }
+      ec = _examples.front().first;
+      ticket = _examples.front().second;
+      _examples.pop_front();
+    }
+    _changed.notify_all();
+    return true;
+  }
+
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _closed = true;
+    }
+    _changed.notify_all();
+  }
+
+  void abort()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _aborted = true;
+    }
+    _changed.notify_all();
+  }
+
+private:
+  static constexpr size_t capacity = 256;
+
+  std::mutex _lock;
+  std::condition_variable _changed;
+  std::deque<std::pair<example*, uint64_t>> _examples;
+  bool _closed{false};
+  bool _aborted{false};
+};
+
+// Learns from the training examples on this thread while an instance sharing the weights of master predicts the holdout
+// examples on another, see --holdout_thread. The weights are read without locking, so that a holdout example may be
+// predicted with some of the updates of the examples after it. The examples are finished in the order they were parsed,
+// which keeps the holdout loss of the shared data and the early termination as they are.
+void holdout_driver(vw& master)
+{
+  if (master.l->is_multiline) THROW("--holdout_thread predicts only single examples");
+  if (master.learner_threads > 1) THROW("--holdout_thread can't be used with --threads");
+  if (master.audit || master.hash_inv) THROW("--holdout_thread can't be used with --audit or --invert_hash");
+  if (master.weights.sparse)
+    THROW("--holdout_thread can't be used with --sparse_weights, they can't be looked up while they are added to");
+  if (master.model_reloader != nullptr)
+    THROW("--holdout_thread can't be used with --reload_model, the weights are replaced while they are predicted with");
+
+  vw* evaluator = VW::seed_vw_learner(master);
+  // The commands are run by master alone, the evaluator only predicts.
+  multi_instance_context commands(std::vector<vw*>{&master});
+  threaded_examples shared(master);
+  holdout_queue holdout;
+  std::exception_ptr evaluation_failure;
+  std::thread evaluation([&] {
+    VW::pin_current_thread(VW::thread_role::learner);
+    try
+    {
+      example* ec;
+      uint64_t ticket;
+      while (holdout.pop(ec, ticket))
+      {
+        as_singleline(evaluator->l)->predict(*ec);
+        if (!shared.turns.wait(ticket)) { return; }
+        as_singleline(master.l)->finish_example(master, *ec);
+        shared.turns.done();
+      }
+    }
+    catch (...)
+    {
+      evaluation_failure = std::current_exception();
+      shared.turns.abort();
+      holdout.abort();
+    }
+  });
+
+  std::exception_ptr failure;
+  try
+  {
+    example* ec;
+    while ((ec = shared.examples.pop()) != nullptr)
+    {
+      if (is_command(ec))
+      {
+        if (!run_command(shared, commands, *ec)) { break; }
+        continue;
+      }
+      const uint64_t ticket = shared.next_ticket++;
+      if (ec->test_only)
+      {
+        if (!holdout.push(ec, ticket)) { break; }
+        continue;
+      }
+      master.learn(*ec);
+      if (!shared.turns.wait(ticket)) { break; }
+      as_singleline(master.l)->finish_example(master, *ec);
+      shared.turns.done();
+    }
+  }
+  catch (...)
+  {
+    failure = std::current_exception();
+    shared.turns.abort();
+    holdout.abort();
+  }
+  holdout.close();
+  evaluation.join();
+
+  evaluator->l->end_examples();
+  VW::finish(*evaluator);
+  if (failure) std::rethrow_exception(failure);
+  if (evaluation_failure) std::rethrow_exception(evaluation_failure);
+  drain_examples(master);
+}
+
 void generic_driver(vw& all)
 {
+  if (all.holdout_thread && all.training && !all.holdout_set_off)
+  {
+    holdout_driver(all);
+    return;
+  }
+  if (all.learner_threads > 1)
+  {
+    threaded_driver(all);
+    return;
+  }
+
   single_instance_context context(all);
   ready_examples_queue examples(all);
   generic_driver(examples, context);
@@ -291,6 +684,8 @@ void generic_driver_onethread(vw& all)
 
 void generic_driver_onethread(vw& all)
 {
+  if (all.learner_threads > 1) THROW("--threads learns from the parse thread, it can't be used with --onethread");
+  if (all.holdout_thread) THROW("--holdout_thread predicts beside the learn thread, it can't be used with --onethread");
   if (all.l->is_multiline)
     generic_driver_onethread<multi_example_handler<single_instance_context>>(all);
   else
@@ -298,6 +693,11 @@ void generic_driver_onethread(vw& all)
 }
 
 float recur_sensitivity(void*, base_learner& base, example& ec) { return base.sensitivity(ec); }
+void recur_multi_sensitivity(
+    void*, base_learner& base, example& ec, const float* labels, size_t count, float* sensitivities)
+{
+  base.multi_sensitivity(ec, labels, count, sensitivities);
+}
 
 }  // namespace LEARNER
 }  // namespace VW
@@ -15,6 +15,7 @@
 #include "example.h"
 #include <memory>
 #include "scope_exit.h"
+#include "stage_profiler.h"
 
 enum class prediction_type_t
 {
@@ -76,6 +77,9 @@ struct learn_data
   using fn = void (*)(void* data, base_learner& base, void* ex);
   using multi_fn = void (*)(void* data, base_learner& base, void* ex, size_t count, size_t step, polyprediction* pred,
       bool finalize_predictions);
+  using multi_update_fn = void (*)(void* data, base_learner& base, void* ex, size_t count, size_t step,
+      const uint32_t* models, const float* labels, const polyprediction* pred);
+  using difference_fn = void (*)(void* data, base_learner& base, void* ex, void* subtrahend);
 
   void* data;
   base_learner* base;
@@ -83,13 +87,19 @@ struct learn_data
   fn predict_f;
   fn update_f;
   multi_fn multipredict_f;
+  multi_update_fn multiupdate_f;
+  difference_fn learn_difference_f;
 };
 
 struct sensitivity_data
 {
   using fn = float (*)(void* data, base_learner& base, example& ex);
+  using multi_fn = void (*)(
+      void* data, base_learner& base, example& ex, const float* labels, size_t count, float* sensitivities);
   void* data;
   fn sensitivity_f;
+  multi_fn multi_sensitivity_f;
+  fn predict_sensitivity_f;
 };
 
 struct save_load_data
@@ -120,6 +130,15 @@ inline float noop_sensitivity(void*, base_learner&, example&)
   return 0.;
 }
 float recur_sensitivity(void*, base_learner&, example&);
+void recur_multi_sensitivity(void*, base_learner&, example&, const float*, size_t, float*);
+
+// The label predict_with_sensitivity finds the sensitivity of ec at: its own, or the binary label opposite to its
+// prediction when it has none.
+inline float sensitivity_label(const example& ec)
+{
+  if (ec.l.simple.label != FLT_MAX) return ec.l.simple.label;
+  return ec.pred.scalar > 0 ? -1.f : 1.f;
+}
 
 inline void increment_offset(example& ex, const size_t increment, const size_t i)
 {
@@ -194,6 +213,9 @@ public:
   size_t increment;
   bool is_multiline;  // Is this a single-line or multi-line reduction?
 
+  // Where what this learner does is timed with --stage_timing, nullptr otherwise.
+  VW::reduction_counters* profile;
+
   using end_fptr_type = void (*)(vw&, void*, void*);
   using finish_fptr_type = void (*)(void*);
 
@@ -209,6 +231,8 @@ public:
   {
     assert((is_multiline && std::is_same<multi_ex, E>::value) ||
         (!is_multiline && std::is_same<example, E>::value));  // sanity check under debug compile
+    VW::stage_timer timer(profile != nullptr ? &profile->learn : nullptr);
+    VW_ALLOCATION_SITE(reduction);
     increment_offset(ec, increment, i);
     learn_fd.learn_f(learn_fd.data, *learn_fd.base, (void*)&ec);
     decrement_offset(ec, increment, i);
@@ -227,6 +251,8 @@ public:
   {
     assert((is_multiline && std::is_same<multi_ex, E>::value) ||
         (!is_multiline && std::is_same<example, E>::value));  // sanity check under debug compile
+    VW::stage_timer timer(profile != nullptr ? &profile->predict : nullptr);
+    VW_ALLOCATION_SITE(reduction);
     increment_offset(ec, increment, i);
     learn_fd.predict_f(learn_fd.data, *learn_fd.base, (void*)&ec);
     decrement_offset(ec, increment, i);
@@ -236,6 +262,8 @@ public:
   {
     assert((is_multiline && std::is_same<multi_ex, E>::value) ||
         (!is_multiline && std::is_same<example, E>::value));  // sanity check under debug compile
+    VW::stage_timer timer(profile != nullptr ? &profile->multipredict : nullptr);
+    VW_ALLOCATION_SITE(reduction);
     if (learn_fd.multipredict_f == NULL)
     {
       increment_offset(ec, increment, lo);
@@ -289,6 +317,8 @@ public:
   {
     assert((is_multiline && std::is_same<multi_ex, E>::value) ||
         (!is_multiline && std::is_same<example, E>::value));  // sanity check under debug compile
+    VW::stage_timer timer(profile != nullptr ? &profile->update : nullptr);
+    VW_ALLOCATION_SITE(reduction);
     increment_offset(ec, increment, i);
     learn_fd.update_f(learn_fd.data, *learn_fd.base, (void*)&ec);
     decrement_offset(ec, increment, i);
@@ -302,6 +332,57 @@ public:
     VW_WARNING_STATE_POP
   }
 
+  // Updates the count models listed in models, model models[c] from the label labels[c] and its prediction pred[c], as
+  // calling update on each of them in turn would. Base learners which support it update them in one pass over the
+  // features. The label of ec is changed.
+  inline void multiupdate(
+      E& ec, size_t count, const uint32_t* models, const float* labels, const polyprediction* pred)
+  {
+    assert((is_multiline && std::is_same<multi_ex, E>::value) ||
+        (!is_multiline && std::is_same<example, E>::value));  // sanity check under debug compile
+    if (learn_fd.multiupdate_f == nullptr)
+      for (size_t c = 0; c < count; c++)
+      {
+        ec.l.simple.label = labels[c];
+        ec.pred.scalar = pred[c].scalar;
+        update(ec, models[c]);
+      }
+    else
+      learn_fd.multiupdate_f(learn_fd.data, *learn_fd.base, (void*)&ec, count, increment, models, labels, pred);
+  }
+  template <class L>
+  inline void set_multiupdate(
+      void (*u)(T&, L&, E&, size_t, size_t, const uint32_t*, const float*, const polyprediction*))
+  {
+    VW_WARNING_STATE_PUSH
+    VW_WARNING_DISABLE_CAST_FUNC_TYPE
+    learn_fd.multiupdate_f = (learn_data::multi_update_fn)u;
+    VW_WARNING_STATE_POP
+  }
+
+  // Learns from ec less the features of subtrahend, with the label, weight and offset of ec, as learning from an
+  // example made of the features of ec followed by those of subtrahend negated would, without making it. Returns
+  // false, having done nothing, when the learner does not support it, so that the caller makes that example. Not
+  // autorecursive.
+  inline bool learn_difference(E& ec, E& subtrahend, size_t i = 0)
+  {
+    if (learn_fd.learn_difference_f == nullptr) return false;
+    VW::stage_timer timer(profile != nullptr ? &profile->learn : nullptr);
+    increment_offset(ec, increment, i);
+    learn_fd.learn_difference_f(learn_fd.data, *learn_fd.base, (void*)&ec, (void*)&subtrahend);
+    decrement_offset(ec, increment, i);
+    return true;
+  }
+  inline bool learns_difference() const { return learn_fd.learn_difference_f != nullptr; }
+  template <class L>
+  inline void set_learn_difference(void (*u)(T&, L&, E&, E&))
+  {
+    VW_WARNING_STATE_PUSH
+    VW_WARNING_DISABLE_CAST_FUNC_TYPE
+    learn_fd.learn_difference_f = (learn_data::difference_fn)u;
+    VW_WARNING_STATE_POP
+  }
+
   // used for active learning and confidence to determine how easily predictions are changed
   inline void set_sensitivity(float (*u)(T& data, base_learner& base, example&))
   {
@@ -310,6 +391,8 @@ public:
     VW_WARNING_DISABLE_CAST_FUNC_TYPE
     sensitivity_fd.sensitivity_f = (sensitivity_data::fn)u;
     VW_WARNING_STATE_POP
+    // The sensitivities for several labels are then found one label at a time, unless set_multi_sensitivity follows.
+    sensitivity_fd.multi_sensitivity_f = nullptr;
   }
   inline float sensitivity(example& ec, size_t i = 0)
   {
@@ -319,6 +402,65 @@ public:
     return ret;
   }
 
+  // the sensitivities of ec when its simple label is each of count labels, in a single pass over its features when the
+  // learner supports it. The label of ec is left unchanged.
+  inline void set_multi_sensitivity(
+      void (*u)(T& data, base_learner& base, example&, const float* labels, size_t count, float* sensitivities))
+  {
+    VW_WARNING_STATE_PUSH
+    VW_WARNING_DISABLE_CAST_FUNC_TYPE
+    sensitivity_fd.multi_sensitivity_f = (sensitivity_data::multi_fn)u;
+    VW_WARNING_STATE_POP
+  }
+  inline void multi_sensitivity(example& ec, const float* labels, size_t count, float* sensitivities, size_t i = 0)
+  {
+    increment_offset(ec, increment, i);
+    if (sensitivity_fd.multi_sensitivity_f == nullptr)
+    {
+      const float label = ec.l.simple.label;
+      for (size_t c = 0; c < count; c++)
+      {
+        ec.l.simple.label = labels[c];
+        sensitivities[c] = sensitivity_fd.sensitivity_f(sensitivity_fd.data, *learn_fd.base, ec);
+      }
+      ec.l.simple.label = label;
+    }
+    else
+      sensitivity_fd.multi_sensitivity_f(sensitivity_fd.data, *learn_fd.base, ec, labels, count, sensitivities);
+    decrement_offset(ec, increment, i);
+  }
+
+  // predicts ec and returns its sensitivity at that prediction, as predict followed by sensitivity does, in a single
+  // pass over the features when the learner supports it. An example without a label has the sensitivity of the binary
+  // label opposite to its prediction, which the prediction is the least confident of. Not autorecursive, since every
+  // reduction predicts on the way down.
+  inline void set_predict_with_sensitivity(float (*u)(T& data, base_learner& base, example&))
+  {
+    sensitivity_fd.data = learn_fd.data;
+    VW_WARNING_STATE_PUSH
+    VW_WARNING_DISABLE_CAST_FUNC_TYPE
+    sensitivity_fd.predict_sensitivity_f = (sensitivity_data::fn)u;
+    VW_WARNING_STATE_POP
+  }
+  inline float predict_with_sensitivity(example& ec, size_t i = 0)
+  {
+    VW::stage_timer timer(profile != nullptr ? &profile->predict : nullptr);
+    increment_offset(ec, increment, i);
+    float ret;
+    if (sensitivity_fd.predict_sensitivity_f == nullptr)
+    {
+      learn_fd.predict_f(learn_fd.data, *learn_fd.base, (void*)&ec);
+      const float label = ec.l.simple.label;
+      ec.l.simple.label = sensitivity_label(ec);
+      ret = sensitivity_fd.sensitivity_f(sensitivity_fd.data, *learn_fd.base, ec);
+      ec.l.simple.label = label;
+    }
+    else
+      ret = sensitivity_fd.predict_sensitivity_f(sensitivity_fd.data, *learn_fd.base, ec);
+    decrement_offset(ec, increment, i);
+    return ret;
+  }
+
   // called anytime saving or loading needs to happen. Autorecursive.
   inline void save_load(io_buf& io, const bool read, const bool text)
   {
@@ -396,6 +538,8 @@ public:
   // called after learn example for each example.  Explicitly not recursive.
   inline void finish_example(vw& all, E& ec)
   {
+    VW::stage_timer timer(profile != nullptr ? &profile->finish_example : nullptr);
+    VW_ALLOCATION_SITE(output);
     finish_example_fd.finish_example_f(all, finish_example_fd.data, (void*)&ec);
   }
   // called after learn example for each example.  Explicitly not recursive.
@@ -422,9 +566,12 @@ public:
       // save_load then calling save_load on this object will essentially result in forwarding the
       // call the next reduction that actually implements it.
       ret = *(learner<T, E>*)(base);
+      ret.profile = nullptr;  // the timings of the base stay its own
 
       ret.learn_fd.base = make_base(*base);
       ret.sensitivity_fd.sensitivity_f = (sensitivity_data::fn)recur_sensitivity;
+      ret.sensitivity_fd.multi_sensitivity_f = (sensitivity_data::multi_fn)recur_multi_sensitivity;
+      ret.sensitivity_fd.predict_sensitivity_f = nullptr;
       ret.finisher_fd.data = dat;
       ret.finisher_fd.base = make_base(*base);
       ret.finisher_fd.func = (func_data::fn)noop;
@@ -442,6 +589,8 @@ public:
       ret.finisher_fd.data = dat;
       ret.finisher_fd.func = (func_data::fn)noop;
       ret.sensitivity_fd.sensitivity_f = (sensitivity_data::fn)noop_sensitivity;
+      ret.sensitivity_fd.multi_sensitivity_f = nullptr;
+      ret.sensitivity_fd.predict_sensitivity_f = nullptr;
       ret.finish_example_fd.data = dat;
       VW_WARNING_STATE_PUSH
       VW_WARNING_DISABLE_CAST_FUNC_TYPE
@@ -462,6 +611,8 @@ public:
     ret.learn_fd.predict_f = (learn_data::fn)predict;
     VW_WARNING_STATE_POP
     ret.learn_fd.multipredict_f = nullptr;
+    ret.learn_fd.multiupdate_f = nullptr;
+    ret.learn_fd.learn_difference_f = nullptr;
     ret.pred_type = pred_type;
     ret.is_multiline = std::is_same<multi_ex, E>::value;
 
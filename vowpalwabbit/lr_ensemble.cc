@@ -0,0 +1,243 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "lr_ensemble.h"
+
+#include <cfloat>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gd.h"
+#include "parse_primitives.h"
+#include "vw_exception.h"
+
+using namespace VW::LEARNER;
+using namespace VW::config;
+
+namespace
+{
+// The state of a weight for all of the members has to fit a stride of 16 floats.
+constexpr size_t max_members = 8;
+
+struct member
+{
+  float eta;
+  float power_t;
+  double sum_loss;  // of the predictions made before learning from the examples
+};
+
+// The state of a weight is the weight and the sum of its squared gradients of each member, in slots 2k and 2k + 1.
+struct ensemble_data
+{
+  size_t num_members;
+  uint64_t distance;  // between the slots of a weight
+  float predictions[max_members];
+  float gradients[max_members];
+  float etas[max_members];
+  float power_t[max_members];
+};
+
+struct lr_ensemble
+{
+  vw* all;
+  std::vector<member> members;
+  ensemble_data data;
+  size_t best;  // member which predicts, the one with the lowest loss so far
+};
+
+inline void predict_members(ensemble_data& d, float x, float& fw)
+{
+  float* w = &fw;
+  for (size_t k = 0; k < d.num_members; k++) d.predictions[k] += w[2 * k * d.distance] * x;
+}
+
+inline void update_members(ensemble_data& d, float x, float& fw)
+{
+  float* w = &fw;
+  for (size_t k = 0; k < d.num_members; k++)
+  {
+    const float g = d.gradients[k] * x;
+    if (g == 0.f) continue;
+    float& g2 = w[(2 * k + 1) * d.distance];
+    g2 += g * g;
+    const float rate = d.power_t[k] == 0.5f ? 1.f / std::sqrt(g2) : std::pow(g2, -d.power_t[k]);
+    w[2 * k * d.distance] -= d.etas[k] * g * rate;
+  }
+}
+
+// Predicts with every member in one walk over the features and their interactions.
+void predict_all(lr_ensemble& e, example& ec)
+{
+  auto& d = e.data;
+  d.distance = e.all->weights.slot_distance();
+  for (size_t k = 0; k < d.num_members; k++) d.predictions[k] = ec.l.simple.initial;
+  GD::foreach_feature<ensemble_data, predict_members>(*e.all, ec, d);
+}
+
+void predict(lr_ensemble& e, single_learner&, example& ec)
+{
+  predict_all(e, ec);
+  ec.partial_prediction = e.data.predictions[e.best];
+  ec.pred.scalar = GD::finalize_prediction(e.all->sd, e.all->logger, ec.partial_prediction);
+}
+
+void learn(lr_ensemble& e, single_learner& base, example& ec)
+{
+  predict(e, base, ec);
+  const float label = ec.l.simple.label;
+  if (label == FLT_MAX) return;
+
+  vw& all = *e.all;
+  auto& d = e.data;
+  for (size_t k = 0; k < d.num_members; k++)
+  {
+    const float prediction = GD::finalize_prediction(all.sd, all.logger, d.predictions[k]);
+    e.members[k].sum_loss += all.loss->getLoss(all.sd, prediction, label) * ec.weight;
+    d.gradients[k] = all.loss->first_derivative(all.sd, prediction, label) * ec.weight;
+  }
+  if (!ec.test_only) GD::foreach_feature<ensemble_data, update_members>(all, ec, d);
+
+  for (size_t k = 0; k < d.num_members; k++)
+    if (e.members[k].sum_loss < e.members[e.best].sum_loss) e.best = k;
+}
+
+template <class T>
+void save_load_weights(lr_ensemble& e, io_buf& model_file, bool read, bool text, T& weights)
+{
+  const size_t state_size = 2 * e.members.size();
+  const uint64_t distance = weights.slot_distance();
+  const uint64_t length = static_cast<uint64_t>(1) << e.all->num_bits;
+  float state[2 * max_members];
+  uint64_t i;
+  if (read)
+  {
+    while (model_file.bin_read_fixed(reinterpret_cast<char*>(&i), sizeof(i), "") > 0)
+    {
+      if (i >= length)
+        THROW("Model content is corrupted, weight vector index " << i << " must be less than total vector length "
+                                                                 << length);
+      if (model_file.bin_read_fixed(reinterpret_cast<char*>(state), sizeof(state[0]) * state_size, "") <
+          sizeof(state[0]) * state_size)
+        THROW("Model content is corrupted, the state of weight " << i << " is cut short");
+      float* w = &weights.strided_index(i);
+      for (size_t j = 0; j < state_size; j++) w[j * distance] = state[j];
+    }
+    return;
+  }
+
+  std::stringstream msg;
+  for (auto v = weights.begin(); v != weights.end(); ++v)
+  {
+    const float* w = &(*v);
+    bool learned = false;
+    for (size_t j = 0; j < state_size; j++)
+    {
+      state[j] = w[j * distance];
+      learned |= state[j] != 0.f;
+    }
+    if (!learned) continue;
+
+    i = v.index() >> weights.stride_shift();
+    msg << i;
+    bin_text_write_fixed(model_file, reinterpret_cast<char*>(&i), sizeof(i), msg, text);
+    for (size_t j = 0; j < state_size; j++) msg << (j == 0 ? ":" : " ") << state[j];
+    msg << "\n";
+    bin_text_write_fixed(model_file, reinterpret_cast<char*>(state), sizeof(state[0]) * state_size, msg, text);
+  }
+}
+
+void save_load(lr_ensemble& e, io_buf& model_file, bool read, bool text)
+{
+  vw& all = *e.all;
+  if (read) initialize_regressor(all);
+  if (model_file.num_files() == 0) return;
+
+  // The losses so far keep the best member predicting after the model is loaded.
+  std::stringstream msg;
+  for (auto& m : e.members)
+  {
+    msg << "member loss " << m.sum_loss << "\n";
+    bin_text_read_write_fixed(
+        model_file, reinterpret_cast<char*>(&m.sum_loss), sizeof(m.sum_loss), "", read, msg, text);
+  }
+  if (read)
+    for (size_t k = 0; k < e.members.size(); k++)
+      if (e.members[k].sum_loss < e.members[e.best].sum_loss) e.best = k;
+
+  if (all.weights.sparse)
+    save_load_weights(e, model_file, read, text, all.weights.sparse_weights);
+  else
+    save_load_weights(e, model_file, read, text, all.weights.dense_weights);
+}
+
+void finish(lr_ensemble& e)
+{
+  vw& all = *e.all;
+  if (all.logger.quiet) return;
+  const double examples = all.sd->weighted_labeled_examples;
+  for (size_t k = 0; k < e.members.size(); k++)
+  {
+    all.trace_message << "lr_ensemble member " << k << ": -l " << e.members[k].eta << " --power_t "
+                      << e.members[k].power_t << ", average loss = ";
+    if (examples > 0)
+      all.trace_message << e.members[k].sum_loss / examples;
+    else
+      all.trace_message << "n.a.";
+    all.trace_message << (k == e.best ? " (predicting)" : "") << std::endl;
+  }
+}
+}  // namespace
+
+base_learner* lr_ensemble_setup(options_i& options, vw& all)
+{
+  auto e = scoped_calloc_or_throw<lr_ensemble>();
+  std::string members;
+
+  option_group_definition new_options("Learning rate ensemble");
+  new_options.add(make_option("lr_ensemble", members)
+                      .keep()
+                      .help("learn with up to 8 adaptive gradient descent members at once from one walk over the "
+                            "features per example, given as a comma separated list of <l>[:<power_t>]. The member "
+                            "with the lowest progressive loss so far predicts"));
+  options.add_and_parse(new_options);
+
+  if (!options.was_supplied("lr_ensemble")) { return nullptr; }
+
+  std::vector<VW::string_view> entries;
+  tokenize(',', members, entries);
+  if (entries.empty() || entries.size() > max_members)
+    THROW("--lr_ensemble takes from 1 to " << max_members << " members, got " << entries.size());
+  for (const auto& entry : entries)
+  {
+    std::vector<VW::string_view> fields;
+    tokenize(':', entry, fields);
+    if (fields.empty() || fields.size() > 2) THROW("--lr_ensemble members are <l>[:<power_t>], got " << entry);
+    const float eta = float_of_string(fields[0]);
+    const float power_t = fields.size() == 2 ? float_of_string(fields[1]) : all.power_t;
+    if (eta <= 0.f || power_t < 0.f) THROW("--lr_ensemble needs a positive l and power_t of at least 0, got " << entry);
+    e->members.push_back({eta, power_t, 0.});
+  }
+
+  e->all = &all;
+  e->best = 0;
+  auto& d = e->data;
+  d.num_members = e->members.size();
+  for (size_t k = 0; k < d.num_members; k++)
+  {
+    d.etas[k] = e->members[k].eta;
+    d.power_t[k] = e->members[k].power_t;
+  }
+
+  // a weight and its sum of squared gradients per member, interleaved like the state of gd
+  uint32_t stride_shift = 0;
+  while ((static_cast<size_t>(1) << stride_shift) < 2 * d.num_members) stride_shift++;
+  all.weights.stride_shift(stride_shift);
+
+  learner<lr_ensemble, example>& l = init_learner(e, learn, predict, UINT64_ONE << all.weights.stride_shift());
+  l.set_save_load(save_load);
+  l.set_finish(finish);
+  return make_base(l);
+}
@@ -3,6 +3,7 @@
 // license as described in the file LICENSE.
 #include <cstring>
 #include <cfloat>
+#include <vector>
 #include "reductions.h"
 #include "rand48.h"
 #include "vw_exception.h"
@@ -18,6 +19,8 @@ struct LRQstate
   size_t orig_size[256];
   std::set<std::string> lrpairs;
   bool dropout;
+  bool collapse;              // sum each factor over the left features before crossing it with the right ones
+  std::vector<float> latent;  // with collapse, the k factors of the left features
   uint64_t seed;
   uint64_t initial_seed;
 };
@@ -48,6 +51,44 @@ void reset_seed(LRQstate& lrq)
   if (lrq.all->bfgs) lrq.seed = lrq.initial_seed;
 }
 
+// The weight of the n-th factor of a left feature.
+template <bool is_learn>
+float left_weight(LRQstate& lrq, example& ec, uint64_t lwindex)
+{
+  weight* lw = &lrq.all->weights[lwindex];
+
+  // perturb away from saddle point at (0, 0)
+  if (is_learn)
+  {
+    if (!example_is_test(ec) && *lw == 0)
+    {
+      *lw = cheesyrand(lwindex);  // not sure if lw needs a weight mask?
+    }
+  }
+  return *lw;
+}
+
+void push_right_feature(vw& all, unsigned char right, features& right_fs, unsigned int rfn, unsigned int n, float x,
+    uint64_t rwindex)
+{
+  right_fs.push_back(x, rwindex);
+
+  if (all.audit || all.hash_inv)
+  {
+    std::stringstream new_feature_buffer;
+    new_feature_buffer << right << '^' << right_fs.space_names[rfn].get()->second << '^' << n;
+
+#ifdef _WIN32
+    char* new_space = _strdup("lrq");
+    char* new_feature = _strdup(new_feature_buffer.str().c_str());
+#else
+    char* new_space = strdup("lrq");
+    char* new_feature = strdup(new_feature_buffer.str().c_str());
+#endif
+    right_fs.space_names.push_back(audit_strings_ptr(new audit_strings(new_space, new_feature)));
+  }
+}
+
 template <bool is_learn>
 void predict_or_learn(LRQstate& lrq, single_learner& base, example& ec)
 {
@@ -85,6 +126,36 @@ void predict_or_learn(LRQstate& lrq, single_learner& base, example& ec)
       unsigned int k = atoi(i.c_str() + 2);
 
       features& left_fs = ec.feature_space[left];
+      features& right_fs = ec.feature_space[right];
+      if (lrq.collapse)
+      {
+        // One feature per right feature and factor, its value summed over the left features.
+        lrq.latent.assign(k, 0.f);
+        for (unsigned int lfn = 0; lfn < lrq.orig_size[left]; ++lfn)
+        {
+          float lfx = left_fs.values[lfn];
+          uint64_t lindex = left_fs.indicies[lfn] + ec.ft_offset;
+          for (unsigned int n = 1; n <= k; ++n)
+          {
+            if (!do_dropout || cheesyrbit(lrq.seed))
+              lrq.latent[n - 1] += left_weight<is_learn>(lrq, ec, lindex + ((uint64_t)n << stride_shift)) * lfx;
+          }
+        }
+
+        for (unsigned int n = 1; n <= k; ++n)
+        {
+          float lx = scale * lrq.latent[n - 1];
+          if (lx == 0.f) continue;
+          for (unsigned int rfn = 0; rfn < lrq.orig_size[right]; ++rfn)
+          {
+            // NB: ec.ft_offset added by base learner
+            push_right_feature(all, right, right_fs, rfn, n, lx * right_fs.values[rfn],
+                right_fs.indicies[rfn] + ((uint64_t)n << stride_shift));
+          }
+        }
+        continue;
+      }
+
       for (unsigned int lfn = 0; lfn < lrq.orig_size[left]; ++lfn)
       {
         float lfx = left_fs.values[lfn];
@@ -93,42 +164,13 @@ void predict_or_learn(LRQstate& lrq, single_learner& base, example& ec)
         {
           if (!do_dropout || cheesyrbit(lrq.seed))
           {
-            uint64_t lwindex = (lindex + ((uint64_t)n << stride_shift));
-            weight* lw = &lrq.all->weights[lwindex];
+            float lx = scale * left_weight<is_learn>(lrq, ec, lindex + ((uint64_t)n << stride_shift)) * lfx;
 
-            // perturb away from saddle point at (0, 0)
-            if (is_learn)
-            {
-              if (!example_is_test(ec) && *lw == 0)
-              {
-                *lw = cheesyrand(lwindex);  // not sure if lw needs a weight mask?
-              }
-            }
-
-            features& right_fs = ec.feature_space[right];
             for (unsigned int rfn = 0; rfn < lrq.orig_size[right]; ++rfn)
             {
               // NB: ec.ft_offset added by base learner
-              float rfx = right_fs.values[rfn];
-              uint64_t rindex = right_fs.indicies[rfn];
-              uint64_t rwindex = (rindex + ((uint64_t)n << stride_shift));
-
-              right_fs.push_back(scale * *lw * lfx * rfx, rwindex);
-
-              if (all.audit || all.hash_inv)
-              {
-                std::stringstream new_feature_buffer;
-                new_feature_buffer << right << '^' << right_fs.space_names[rfn].get()->second << '^' << n;
-
-#ifdef _WIN32
-                char* new_space = _strdup("lrq");
-                char* new_feature = _strdup(new_feature_buffer.str().c_str());
-#else
-                char* new_space = strdup("lrq");
-                char* new_feature = strdup(new_feature_buffer.str().c_str());
-#endif
-                right_fs.space_names.push_back(audit_strings_ptr(new audit_strings(new_space, new_feature)));
-              }
+              push_right_feature(all, right, right_fs, rfn, n, lx * right_fs.values[rfn],
+                  right_fs.indicies[rfn] + ((uint64_t)n << stride_shift));
             }
           }
         }
@@ -168,7 +210,11 @@ base_learner* lrq_setup(options_i& options, vw& all)
   std::vector<std::string> lrq_names;
   option_group_definition new_options("Low Rank Quadratics");
   new_options.add(make_option("lrq", lrq_names).keep().necessary().help("use low rank quadratic features"))
-      .add(make_option("lrqdropout", lrq->dropout).keep().help("use dropout training for low rank quadratic features"));
+      .add(make_option("lrqdropout", lrq->dropout).keep().help("use dropout training for low rank quadratic features"))
+      .add(make_option("lrq_collapse", lrq->collapse)
+               .keep()
+               .help("sum each factor over the left features before crossing it with the right ones, one feature per "
+                     "right feature and factor instead of one per left feature too"));
 
   if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
 
@@ -185,6 +231,7 @@ base_learner* lrq_setup(options_i& options, vw& all)
   {
     all.trace_message << "creating low rank quadratic features for pairs: ";
     if (lrq->dropout) all.trace_message << "(using dropout) ";
+    if (lrq->collapse) all.trace_message << "(collapsing the left features) ";
   }
 
   for (std::string const& i : lrq->lrpairs)
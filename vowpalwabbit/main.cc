@@ -13,9 +13,14 @@
 #include "parse_args.h"
 #include "parse_regressor.h"
 #include "accumulate.h"
+#include "allreduce.h"
 #include "best_constant.h"
 #include "vw_exception.h"
+#include <atomic>
+#include <cfloat>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 #include "vw.h"
 #include "options.h"
@@ -45,6 +50,136 @@ vw* setup(options_i& options)
   return all;
 }
 
+// Learns with every instance on its own thread, each parsing its own data. The instances average their weights in
+// memory at the end of each pass through AllReduceThreads, as --span_server nodes do over the network.
+void drive_shards(std::vector<vw*>& alls)
+{
+  AllReduceThreads* root = nullptr;
+  for (size_t i = 0; i < alls.size(); i++)
+  {
+    vw& shard = *alls[i];
+    if (shard.all_reduce != nullptr) THROW("--shard_args can't be used with --span_server");
+    shard.all_reduce = root == nullptr ? new AllReduceThreads(alls.size(), i, shard.logger.quiet)
+                                       : new AllReduceThreads(root, alls.size(), i, shard.logger.quiet);
+    shard.all_reduce_type = AllReduceType::Thread;
+    if (root == nullptr) root = (AllReduceThreads*)shard.all_reduce;
+  }
+
+  std::vector<std::exception_ptr> errors(alls.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < alls.size(); i++)
+  {
+    threads.emplace_back([&alls, &errors, i] {
+      try
+      {
+        VW::start_parser(*alls[i]);
+        VW::LEARNER::generic_driver(*alls[i]);
+        VW::end_parser(*alls[i]);
+        VW::sync_stats(*alls[i]);
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (auto& error : errors)
+    if (error) std::rethrow_exception(error);
+}
+
+// The average loss which the summary of all reports, on the holdout set when there is one.
+std::string sweep_loss(vw& all)
+{
+  std::stringstream loss;
+  loss.precision(6);
+  loss << std::fixed;
+  if (all.holdout_set_off)
+    if (all.sd->weighted_labeled_examples > 0)
+      loss << all.sd->sum_loss / all.sd->weighted_labeled_examples;
+    else
+      loss << "n.a.";
+  else if ((all.sd->holdout_best_loss == FLT_MAX) || (all.sd->holdout_best_loss == FLT_MAX * 0.5))
+    loss << "undefined";
+  else
+    loss << all.sd->holdout_best_loss << " h";
+  return loss.str();
+}
+
+// Learns with the configuration of each line of the file from the data the first one parses. The first configuration
+// keeps the examples of its first pass in memory, the others learn from there at once, a thread per core, so the data
+// is parsed a single time. They may differ in their learning options but must see the same features. Prints the
+// average loss of every configuration, the progressive cost of the actions explored with --cbify or --warm_cb.
+void sweep(const char* file_name)
+{
+  std::fstream arg_file(file_name);
+  if (!arg_file) { THROW("Could not open file: " << file_name); }
+
+  std::vector<std::string> configurations;
+  std::string line;
+  while (std::getline(arg_file, line))
+    if (!line.empty()) configurations.push_back(line);
+  if (configurations.empty()) THROW("no configurations in " << file_name);
+  std::vector<std::string> losses(configurations.size());
+
+  std::shared_ptr<std::vector<char>> examples;
+  {
+    vw& first = *VW::initialize(configurations[0] + " --in_memory --quiet");
+    VW::start_parser(first);
+    VW::LEARNER::generic_driver(first);
+    VW::end_parser(first);
+    if (first.example_parser->exc_ptr) { std::rethrow_exception(first.example_parser->exc_ptr); }
+    examples = first.example_parser->memory_cache;
+    losses[0] = sweep_loss(first);
+    VW::finish(first);
+  }
+  if (examples == nullptr) THROW("the first configuration of --sweep_args must read its data, not a cache file");
+
+  // Initializing and finishing instances is not reentrant, learning with them is.
+  std::mutex instances_lock;
+  std::atomic<size_t> next_configuration(1);
+  std::exception_ptr failure;
+  const size_t num_threads =
+      std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), configurations.size() - 1);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++)
+  {
+    threads.emplace_back([&] {
+      try
+      {
+        size_t i;
+        while ((i = next_configuration++) < configurations.size())
+        {
+          vw* all;
+          {
+            std::lock_guard<std::mutex> lock(instances_lock);
+            all = VW::initialize_with_memory_cache(configurations[i] + " --quiet --no_stdin", examples);
+          }
+          VW::start_parser(*all);
+          VW::LEARNER::generic_driver(*all);
+          VW::end_parser(*all);
+          if (all->example_parser->exc_ptr) { std::rethrow_exception(all->example_parser->exc_ptr); }
+
+          std::lock_guard<std::mutex> lock(instances_lock);
+          losses[i] = sweep_loss(*all);
+          VW::finish(*all);
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(instances_lock);
+        if (!failure) failure = std::current_exception();
+        next_configuration = configurations.size();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  if (failure) std::rethrow_exception(failure);
+
+  for (size_t i = 0; i < configurations.size(); i++)
+    std::cout << "average loss = " << losses[i] << "\t" << configurations[i] << std::endl;
+}
+
 int main(int argc, char* argv[])
 {
   bool should_use_onethread = false;
@@ -56,7 +191,38 @@ int main(int argc, char* argv[])
     // support multiple vw instances for training of the same datafile for the same instance
     std::vector<std::unique_ptr<options_boost_po>> arguments;
     std::vector<vw*> alls;
-    if (argc == 3 && !std::strcmp(argv[1], "--args"))
+    if (argc == 3 && !std::strcmp(argv[1], "--sweep_args"))
+    {
+      sweep(argv[2]);
+      return 0;
+    }
+    const bool shards = argc == 3 && !std::strcmp(argv[1], "--shard_args");
+    if (shards)
+    {
+      // Each line is the arguments of one shard, usually the same learner over different data.
+      std::fstream arg_file(argv[2]);
+      if (!arg_file) { THROW("Could not open file: " << argv[2]); }
+
+      std::string line;
+      while (std::getline(arg_file, line))
+      {
+        if (line.empty()) continue;
+        std::stringstream sstr;
+        sstr << line << " --no_stdin";  // the shards can't share stdin
+        // The first shard reports the progress and the totals over all of them.
+        if (!alls.empty() && line.find("--quiet") == std::string::npos) sstr << " --quiet";
+
+        int l_argc;
+        char** l_argv = VW::to_argv(sstr.str(), l_argc);
+
+        std::unique_ptr<options_boost_po> ptr(new options_boost_po(l_argc, l_argv));
+        ptr->add_and_parse(driver_config);
+        alls.push_back(setup(*ptr));
+        arguments.push_back(std::move(ptr));
+      }
+      if (alls.empty()) THROW("no shards in " << argv[2]);
+    }
+    else if (argc == 3 && !std::strcmp(argv[1], "--args"))
     {
       std::fstream arg_file(argv[2]);
       if (!arg_file) { THROW("Could not open file: " << argv[2]); }
@@ -99,7 +265,12 @@ int main(int argc, char* argv[])
       return 0;
     }
 
-    if (should_use_onethread)
+    if (shards)
+    {
+      if (should_use_onethread) THROW("--onethread doesn't make sense with --shard_args");
+      drive_shards(alls);
+    }
+    else if (should_use_onethread)
     {
       if (alls.size() == 1)
         VW::LEARNER::generic_driver_onethread(all);
@@ -120,7 +291,7 @@ int main(int argc, char* argv[])
     {
       if (v->example_parser->exc_ptr) { std::rethrow_exception(v->example_parser->exc_ptr); }
 
-      VW::sync_stats(*v);
+      if (!shards) VW::sync_stats(*v);
       VW::finish(*v);
     }
   }
@@ -2,9 +2,10 @@
 // individual contributors. All rights reserved. Released under a BSD (revised)
 // license as described in the file LICENSE.
 
-#include <unordered_map>
+#include <algorithm>
 #include "reductions.h"
 #include "correctedMath.h"
+#include "flat_hash_map.h"
 
 using namespace VW::config;
 
@@ -20,6 +21,16 @@ struct expert
 typedef std::pair<double, double> marginal;
 typedef std::pair<expert, expert> expert_pair;
 
+// The marginal of an id feature, and with --compete the weights of the marginal and feature based predictors.
+struct marginal_state
+{
+  marginal m;
+  expert_pair experts;
+};
+
+// The entries reserved up front, at most one per weight.
+constexpr uint64_t MAX_RESERVED_MARGINALS = 1 << 14;
+
 struct data
 {
   float initial_numerator;
@@ -29,7 +40,7 @@ struct data
   bool unweighted_marginals;
   bool id_features[256];
   features temp[256];  // temporary storage when reducing.
-  std::unordered_map<uint64_t, marginal> marginals;
+  VW::flat_hash_map<marginal_state> marginals;  // by id feature index
 
   // bookkeeping variables for experts
   bool compete;
@@ -38,8 +49,6 @@ struct data
   float net_weight;          // normalizer for expert weights
   float net_feature_weight;  // the net weight on the feature-based expert
   float alg_loss;            // temporary storage for the loss of the current marginal-based predictor
-  std::unordered_map<uint64_t, expert_pair>
-      expert_state;  // pair of weights on marginal and feature based predictors, one per marginal feature
 
   vw* all;
 };
@@ -88,25 +97,20 @@ void make_marginal(data& sm, example& ec)
           continue;
         }
         uint64_t key = second_index + ec.ft_offset;
-        if (sm.marginals.find(key) == sm.marginals.end())  // need to initialize things.
-        {
-          sm.marginals.insert(std::make_pair(key, std::make_pair(sm.initial_numerator, sm.initial_denominator)));
-          if (sm.compete)
-          {
-            expert e = {0, 0, 1.};
-            sm.expert_state.insert(std::make_pair(key, std::make_pair(e, e)));
-          }
-        }
-        float marginal_pred = (float)(sm.marginals[key].first / sm.marginals[key].second);
+        const expert e = {0, 0, 1.};
+        const marginal_state initial = {std::make_pair(sm.initial_numerator, sm.initial_denominator),
+            std::make_pair(e, e)};
+        const marginal_state& state = *sm.marginals.try_emplace(key, initial).first;
+        float marginal_pred = (float)(state.m.first / state.m.second);
         f.push_back(marginal_pred, first_index);
         if (!sm.temp[n].space_names.empty()) f.space_names.push_back(sm.temp[n].space_names[2 * (f.size() - 1)]);
 
         if (sm.compete)  // compute the prediction from the marginals using the weights
         {
-          float weight = sm.expert_state[key].first.weight;
+          float weight = state.experts.first.weight;
           sm.average_pred += weight * marginal_pred;
           sm.net_weight += weight;
-          sm.net_feature_weight += sm.expert_state[key].second.weight;
+          sm.net_feature_weight += state.experts.second.weight;
           if (is_learn) sm.alg_loss += weight * all.loss->getLoss(all.sd, marginal_pred, label);
         }
       }
@@ -167,11 +171,12 @@ void update_marginal(data& sm, example& ec)
 
         uint64_t second_index = j.index() & mask;
         uint64_t key = second_index + ec.ft_offset;
-        marginal& m = sm.marginals[key];
+        marginal_state& state = sm.marginals[key];
+        marginal& m = state.m;
 
         if (sm.compete)  // now update weights, before updating marginals
         {
-          expert_pair& e = sm.expert_state[key];
+          expert_pair& e = state.experts;
           float regret1 = sm.alg_loss - all.loss->getLoss(all.sd, (float)(m.first / m.second), label);
           float regret2 = sm.alg_loss - all.loss->getLoss(all.sd, sm.feature_pred, label);
 
@@ -254,26 +259,26 @@ void save_load(data& sm, io_buf& io, bool read, bool text)
     uint64_t index;
     if (!read)
     {
-      index = iter->first >> stride_shift;
+      index = iter->key >> stride_shift;
       msg << index << ":";
     }
     bin_text_read_write_fixed(io, (char*)&index, sizeof(index), "", read, msg, text);
     double numerator;
     if (!read)
     {
-      numerator = iter->second.first;
+      numerator = iter->value.m.first;
       msg << numerator << ":";
     }
     bin_text_read_write_fixed(io, (char*)&numerator, sizeof(numerator), "", read, msg, text);
     double denominator;
     if (!read)
     {
-      denominator = iter->second.second;
+      denominator = iter->value.m.second;
       msg << denominator << "\n";
     }
     bin_text_read_write_fixed(io, (char*)&denominator, sizeof(denominator), "", read, msg, text);
     if (read)
-      sm.marginals.insert(std::make_pair(index << stride_shift, std::make_pair(numerator, denominator)));
+      sm.marginals[index << stride_shift].m = std::make_pair(numerator, denominator);
     else
       ++iter;
   }
@@ -282,18 +287,18 @@ void save_load(data& sm, io_buf& io, bool read, bool text)
   {
     if (!read)
     {
-      total_size = (uint64_t)sm.expert_state.size();
+      total_size = (uint64_t)sm.marginals.size();
       msg << "expert_state size = " << total_size << "\n";
     }
     bin_text_read_write_fixed_validated(io, (char*)&total_size, sizeof(total_size), "", read, msg, text);
 
-    auto exp_iter = sm.expert_state.begin();
+    auto exp_iter = sm.marginals.begin();
     for (size_t i = 0; i < total_size; ++i)
     {
       uint64_t index;
       if (!read)
       {
-        index = exp_iter->first >> stride_shift;
+        index = exp_iter->key >> stride_shift;
         msg << index << ":";
       }
       bin_text_read_write_fixed(io, (char*)&index, sizeof(index), "", read, msg, text);
@@ -305,12 +310,12 @@ void save_load(data& sm, io_buf& io, bool read, bool text)
       float w2 = 0;
       if (!read)
       {
-        r1 = exp_iter->second.first.regret;
-        c1 = exp_iter->second.first.abs_regret;
-        w1 = exp_iter->second.first.weight;
-        r2 = exp_iter->second.second.regret;
-        c2 = exp_iter->second.second.abs_regret;
-        w2 = exp_iter->second.second.weight;
+        r1 = exp_iter->value.experts.first.regret;
+        c1 = exp_iter->value.experts.first.abs_regret;
+        w1 = exp_iter->value.experts.first.weight;
+        r2 = exp_iter->value.experts.second.regret;
+        c2 = exp_iter->value.experts.second.abs_regret;
+        w2 = exp_iter->value.experts.second.weight;
         msg << r1 << ":";
       }
       bin_text_read_write_fixed(io, (char*)&r1, sizeof(r1), "", read, msg, text);
@@ -329,7 +334,7 @@ void save_load(data& sm, io_buf& io, bool read, bool text)
       {
         expert e1 = {r1, c1, w1};
         expert e2 = {r2, c2, w2};
-        sm.expert_state.insert(std::make_pair(index << stride_shift, std::make_pair(e1, e2)));
+        sm.marginals[index << stride_shift].experts = std::make_pair(e1, e2);
       }
       else
         ++exp_iter;
@@ -363,6 +368,7 @@ VW::LEARNER::base_learner* marginal_setup(options_i& options, vw& all)
   if (!options.add_parse_and_check_necessary(marginal_options)) { return nullptr; }
 
   d->all = &all;
+  d->marginals.reserve((size_t)std::min(UINT64_ONE << all.num_bits, MAX_RESERVED_MARGINALS));
 
   for (size_t u = 0; u < 256; u++)
     if (marginal.find((char)u) != std::string::npos) d->id_features[u] = true;
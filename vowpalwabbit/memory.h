@@ -8,6 +8,7 @@
 #include <iostream>
 #include <memory>
 #include "vw_exception.h"
+#include "allocation_profiler.h"
 
 // unistd.h is needed for ::sysconf on linux toolchains
 #if defined(__linux__)
@@ -27,6 +28,7 @@ T* calloc_or_throw(size_t nmemb)
     fputs(msg, stderr);
     THROW_OR_RETURN(msg, nullptr);
   }
+  VW_COUNT_ALLOCATION(calloc_or_throw, nmemb * sizeof(T));
   return (T*)data;
 }
 
@@ -99,6 +101,7 @@ T* calloc_mergable_or_throw(size_t nmemb)
     THROW_OR_RETURN(msg, nullptr);
   }
   memset(data, 0, length);
+  VW_COUNT_ALLOCATION(calloc_or_throw, length);
   // mark weight vector as KSM sharable
   // it allows to save memory if you run multiple instances of the same model
   // see more https://www.kernel.org/doc/Documentation/vm/ksm.txt
@@ -91,18 +91,31 @@ void diag_kronecker_prod_fs_test(
   }
 }
 
-int cmpfunc(const void* a, const void* b) { return *(char*)a - *(char*)b; }
+inline bool namespace_less(namespace_index a, namespace_index b) { return (char)a < (char)b; }
+
+// The namespaces are ordered as chars, as they always were, and only once: a stored example keeps them ordered.
+inline void sort_namespaces(example& ec)
+{
+  if (!std::is_sorted(ec.indices.begin(), ec.indices.end(), namespace_less))
+    std::sort(ec.indices.begin(), ec.indices.end(), namespace_less);
+}
 
 void diag_kronecker_product_test(example& ec1, example& ec2, example& ec, bool oas = false)
 {
-  // copy_example_data(&ec, &ec1, oas); //no_feat false, oas: true
-  VW::dealloc_example(nullptr, ec, nullptr);  // clear ec
+  // ec is cleared rather than deallocated, so that its features reuse their memory from one product to the next
+  for (namespace_index c : ec.indices) ec.feature_space[c].clear();
+  ec.indices.clear();
+  if (ec.passthrough)
+  {
+    delete ec.passthrough;
+    ec.passthrough = nullptr;
+  }
   copy_example_data(&ec, &ec1, oas);
 
-  ec.total_sum_feat_sq = 0.0;  // sort namespaces.  pass indices array into sort...template (leave this to the end)
+  ec.total_sum_feat_sq = 0.0;
 
-  qsort(ec1.indices.begin(), ec1.indices.size(), sizeof(namespace_index), cmpfunc);
-  qsort(ec2.indices.begin(), ec2.indices.size(), sizeof(namespace_index), cmpfunc);
+  sort_namespaces(ec1);
+  sort_namespaces(ec2);
 
   size_t idx1 = 0;
   size_t idx2 = 0;
@@ -175,7 +188,8 @@ struct memory_tree
 
   std::vector<node> nodes;  // array of nodes.
   // v_array<node> nodes;         // array of nodes.
-  v_array<example*> examples;  // array of example points
+  v_array<example*> examples;                // array of example points
+  std::vector<flat_example*> flat_examples;  // of the examples, flattened and sorted when they are first compared
 
   size_t max_leaf_examples;
   size_t max_nodes;
@@ -213,6 +227,7 @@ struct memory_tree
   float hamming_loss;
 
   example* kprod_ec;
+  flat_example* query_fec = nullptr;  // the example being compared to the memories, flattened into the last one's storage
 
   memory_tree()
   {
@@ -235,6 +250,8 @@ struct memory_tree
     // nodes.delete_v();
     for (auto ex : examples) free_example(ex);
     examples.delete_v();
+    for (auto fec : flat_examples) free_flatten_example(fec);
+    free_flatten_example(query_fec);
     if (kprod_ec) free_example(kprod_ec);
   }
 };
@@ -264,19 +281,34 @@ float linear_kernel(const flat_example* fec1, const flat_example* fec2)
   return dotprod;
 }
 
-float normalized_linear_prod(memory_tree& b, example* ec1, example* ec2)
+float normalized_linear_prod(const flat_example* fec1, const flat_example* fec2)
 {
-  flat_example* fec1 = flatten_sort_example(*b.all, ec1);
-  flat_example* fec2 = flatten_sort_example(*b.all, ec2);
   float norm_sqrt = std::pow(fec1->total_sum_feat_sq * fec2->total_sum_feat_sq, 0.5f);
   float linear_prod = linear_kernel(fec1, fec2);
-  // fec1->fs.delete_v();
-  // fec2->fs.delete_v();
-  free_flatten_example(fec1);
-  free_flatten_example(fec2);
   return linear_prod / norm_sqrt;
 }
 
+flat_example* flat_memory(memory_tree& b, uint32_t loc)
+{
+  if (b.flat_examples.size() <= loc) b.flat_examples.resize(b.examples.size(), nullptr);
+  if (b.flat_examples[loc] == nullptr) b.flat_examples[loc] = flatten_sort_example(*b.all, b.examples[loc]);
+  return b.flat_examples[loc];
+}
+
+flat_example* flat_query(memory_tree& b, example* ec)
+{
+  if (b.query_fec == nullptr)
+    b.query_fec = flatten_sort_example(*b.all, ec);
+  else
+    flatten_sort_example(*b.all, ec, *b.query_fec);
+  return b.query_fec;
+}
+
+float normalized_linear_prod(memory_tree& b, example* ec, uint32_t loc)
+{
+  return normalized_linear_prod(flat_query(b, ec), flat_memory(b, loc));
+}
+
 void init_tree(memory_tree& b)
 {
   // srand48(4000);
@@ -609,6 +641,7 @@ int64_t pick_nearest(memory_tree& b, single_learner& base, const uint64_t cn, ex
   {
     float max_score = -FLT_MAX;
     int64_t max_pos = -1;
+    flat_example* fec = flat_query(b, &ec);
     for (size_t i = 0; i < b.nodes[cn].examples_index.size(); i++)
     {
       float score = 0.f;
@@ -618,14 +651,14 @@ int64_t pick_nearest(memory_tree& b, single_learner& base, const uint64_t cn, ex
       //(which is for unsupervised training for memory tree)
       if (b.learn_at_leaf == true && b.current_pass >= 1)
       {
-        float tmp_s = normalized_linear_prod(b, &ec, b.examples[loc]);
+        float tmp_s = normalized_linear_prod(fec, flat_memory(b, loc));
         diag_kronecker_product_test(ec, *b.examples[loc], *b.kprod_ec, b.oas);
         b.kprod_ec->l.simple = {FLT_MAX, 0., tmp_s};
         base.predict(*b.kprod_ec, b.max_routers);
         score = b.kprod_ec->partial_prediction;
       }
       else
-        score = normalized_linear_prod(b, &ec, b.examples[loc]);
+        score = normalized_linear_prod(fec, flat_memory(b, loc));
 
       if (score > max_score)
       {
@@ -779,7 +812,7 @@ float return_reward_from_node(memory_tree& b, single_learner& base, uint64_t cn,
 
   if (b.learn_at_leaf == true && closest_ec != -1)
   {
-    float score = normalized_linear_prod(b, &ec, b.examples[closest_ec]);
+    float score = normalized_linear_prod(b, &ec, (uint32_t)closest_ec);
     diag_kronecker_product_test(ec, *b.examples[closest_ec], *b.kprod_ec, b.oas);
     b.kprod_ec->l.simple = {reward, 1.f, -score};
     b.kprod_ec->weight = weight;
@@ -805,7 +838,7 @@ void learn_at_leaf_random(
   if (ec_id != -1)
   {
     if (b.examples[ec_id]->l.multi.label == ec.l.multi.label) reward = 1.f;
-    float score = normalized_linear_prod(b, &ec, b.examples[ec_id]);
+    float score = normalized_linear_prod(b, &ec, (uint32_t)ec_id);
     diag_kronecker_product_test(ec, *b.examples[ec_id], *b.kprod_ec, b.oas);
     b.kprod_ec->l.simple = {reward, 1.f, -score};
     b.kprod_ec->weight = weight;  //* b.nodes[leaf_id].examples_index.size();
@@ -1187,6 +1220,8 @@ void save_load_memory_tree(memory_tree& b, io_buf& model_file, bool read, bool t
     if (read)
     {
       b.examples.clear();
+      for (auto fec : b.flat_examples) free_flatten_example(fec);
+      b.flat_examples.clear();
       for (uint32_t i = 0; i < n_examples; i++)
       {
         example* new_ec = &calloc_or_throw<example>();
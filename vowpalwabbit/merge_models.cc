@@ -0,0 +1,202 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "merge_models.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "global_data.h"
+#include "thread_affinity.h"
+#include "vw.h"
+#include "vw_exception.h"
+
+namespace
+{
+// The fewest weights a thread folds, below which threads cost more than they save.
+constexpr uint64_t MIN_RANGE_WEIGHTS = 1 << 16;
+
+// How the weights of a model are weighted in the merge.
+struct merge_rule
+{
+  bool by_adaptive;  // by the sums of squared gradients of the weights, else by model_weight
+  uint64_t distance;
+  size_t normalized_idx;  // 0 when the weights have no normalizer
+  float model_weight;
+};
+
+vw* load_model(const std::string& file)
+{
+  // Training, so that the example counts and losses of --save_resume models are kept.
+  std::vector<std::string> args = {"vw", "-i", file, "--quiet", "--no_stdin", "--preserve_performance_counters"};
+  std::vector<char*> argv;
+  for (auto& arg : args) argv.push_back(&arg[0]);
+  return VW::initialize(static_cast<int>(argv.size()), argv.data());
+}
+
+bool saved_counts(const vw& model) { return model.sd->weighted_labeled_examples > 0.; }
+
+void check_compatible(vw& merged, vw& model, const std::string& first, const std::string& file)
+{
+  if (model.num_bits != merged.num_bits)
+    THROW("the model " << file << " has " << model.num_bits << " bits rather than the " << merged.num_bits << " of "
+                       << first);
+  if (model.weights.sparse != merged.weights.sparse || model.weights.stride_shift() != merged.weights.stride_shift() ||
+      model.weights.slot_distance() != merged.weights.slot_distance() ||
+      model.weights.adaptive != merged.weights.adaptive || model.weights.normalized != merged.weights.normalized)
+    THROW("the weights of the model " << file << " are laid out unlike those of " << first);
+  if (model.enabled_reductions != merged.enabled_reductions)
+    THROW("the model " << file << " has other reductions than " << first);
+  const char* difference = VW::are_features_compatible(merged, model);
+  if (difference != nullptr) THROW("the model " << file << " differs from " << first << " by " << difference);
+  if (saved_counts(model) != saved_counts(merged))
+    THROW("either both or neither of " << first << " and " << file << " must be saved with --save_resume");
+}
+
+// Turns the weights of the first model into the weighted sums the others are folded into.
+inline void start_sum(weight* w, const merge_rule& rule)
+{
+  w[0] *= rule.by_adaptive ? w[rule.distance] : rule.model_weight;
+}
+
+inline void fold(weight* merged, const weight* model, const merge_rule& rule)
+{
+  if (rule.by_adaptive)
+  {
+    merged[0] += model[rule.distance] * model[0];
+    merged[rule.distance] += model[rule.distance];
+  }
+  else
+    merged[0] += rule.model_weight * model[0];
+  if (rule.normalized_idx > 0)
+  {
+    weight& normalizer = merged[rule.normalized_idx * rule.distance];
+    normalizer = std::max(normalizer, model[rule.normalized_idx * rule.distance]);
+  }
+}
+
+inline void finish_sum(weight* w, const merge_rule& rule, float total_weight)
+{
+  if (rule.by_adaptive)
+    w[0] = w[rule.distance] > 0.f ? w[0] / w[rule.distance] : 0.f;
+  else
+    w[0] /= total_weight;
+}
+
+// Calls f on consecutive ranges of the dense weights, one per thread, the first on the calling thread.
+template <typename F>
+void over_weight_ranges(uint64_t length, size_t threads, F f)
+{
+  threads = (size_t)std::max<uint64_t>(1, std::min<uint64_t>(threads, length / MIN_RANGE_WEIGHTS));
+  auto range = [&](size_t t) { f(length * t / threads, length * (t + 1) / threads); };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++) workers.push_back(VW::start_pinned_thread(VW::thread_role::worker, range, t));
+  range(0);
+  for (auto& worker : workers) worker.join();
+}
+
+template <typename F>
+void over_merged_weights(vw& merged, size_t threads, F f)
+{
+  if (merged.weights.sparse)
+  {
+    sparse_parameters& weights = merged.weights.sparse_weights;
+    for (auto it = weights.begin(); it != weights.end(); ++it) f(&(*it));
+  }
+  else
+  {
+    dense_parameters& weights = merged.weights.dense_weights;
+    over_weight_ranges((uint64_t)1 << merged.num_bits, threads, [&](uint64_t from, uint64_t to) {
+      for (uint64_t i = from; i < to; i++) f(&weights.strided_index(i));
+    });
+  }
+}
+
+void fold_model(vw& merged, vw& model, const merge_rule& rule, size_t threads)
+{
+  if (merged.weights.sparse)
+  {
+    // The merged weights are allocated as the model's are first seen, on one thread.
+    sparse_parameters& weights = model.weights.sparse_weights;
+    for (auto it = weights.begin(); it != weights.end(); ++it)
+      fold(&merged.weights.sparse_weights[it.index()], &(*it), rule);
+    return;
+  }
+  dense_parameters& to = merged.weights.dense_weights;
+  dense_parameters& from = model.weights.dense_weights;
+  over_weight_ranges((uint64_t)1 << merged.num_bits, threads, [&](uint64_t begin, uint64_t end) {
+    for (uint64_t i = begin; i < end; i++) fold(&to.strided_index(i), &from.strided_index(i), rule);
+  });
+}
+
+void fold_shared_data(vw& merged, const vw& model)
+{
+  shared_data& to = *merged.sd;
+  const shared_data& from = *model.sd;
+  to.t += from.t;
+  to.example_number += from.example_number;
+  to.total_features += from.total_features;
+  to.weighted_labeled_examples += from.weighted_labeled_examples;
+  to.old_weighted_labeled_examples += from.old_weighted_labeled_examples;
+  to.weighted_unlabeled_examples += from.weighted_unlabeled_examples;
+  to.weighted_labels += from.weighted_labels;
+  to.sum_loss += from.sum_loss;
+  to.sum_loss_since_last_dump += from.sum_loss_since_last_dump;
+  to.min_label = std::min(to.min_label, from.min_label);
+  to.max_label = std::max(to.max_label, from.max_label);
+  merged.normalized_sum_norm_x += model.normalized_sum_norm_x;
+}
+}  // namespace
+
+namespace VW
+{
+vw* merge_models(const std::vector<std::string>& files, size_t threads)
+{
+  if (files.empty()) THROW("there are no models to merge");
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  vw* merged = load_model(files[0]);
+  try
+  {
+    const bool counts = saved_counts(*merged);
+    merge_rule rule;
+    rule.by_adaptive = counts && merged->weights.adaptive;
+    rule.distance = merged->weights.slot_distance();
+    rule.normalized_idx = merged->weights.normalized ? merged->normalized_idx : 0;
+    rule.model_weight = counts ? (float)merged->sd->weighted_labeled_examples : 1.f;
+    float total_weight = rule.model_weight;
+    over_merged_weights(*merged, threads, [&](weight* w) { start_sum(w, rule); });
+
+    for (size_t k = 1; k < files.size(); k++)
+    {
+      vw* model = load_model(files[k]);
+      try
+      {
+        check_compatible(*merged, *model, files[0], files[k]);
+        rule.model_weight = counts ? (float)model->sd->weighted_labeled_examples : 1.f;
+        total_weight += rule.model_weight;
+        fold_model(*merged, *model, rule, threads);
+        fold_shared_data(*merged, *model);
+      }
+      catch (...)
+      {
+        VW::finish(*model);
+        throw;
+      }
+      VW::finish(*model);
+    }
+
+    over_merged_weights(*merged, threads, [&](weight* w) { finish_sum(w, rule, total_weight); });
+    // The sums of squared gradients and the counts only mean something to models saved with them.
+    merged->save_resume = counts;
+  }
+  catch (...)
+  {
+    VW::finish(*merged);
+    throw;
+  }
+  return merged;
+}
+}  // namespace VW
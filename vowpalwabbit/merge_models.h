@@ -0,0 +1,29 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct vw;
+
+namespace VW
+{
+// Merges models trained apart, say one per region, into one model as if it had learned from all of their examples.
+// The models must have been saved with the same options. Each weight is the average of its values in the models,
+// weighted by the sums of squared gradients of the weight when the models were saved with --save_resume and use
+// adaptive updates, as accumulate_weighted_avg does across a cluster, and else by the weighted labeled examples of the
+// models, equally when those were not saved. The sums of squared gradients and the example counts and losses are
+// summed, the normalizers and label bounds are the largest of the models. The state of the reductions other than the
+// weights is that of the first model.
+//
+// The models are loaded one after the other and folded into the first, so that at most two are held at once whatever
+// their number. The dense weights of a model are folded in consecutive ranges, one per thread.
+//
+// Returns the merged model, which is saved with save_predictor and released with finish. Throws when a model differs
+// from the first in its number of bits, reductions or features.
+vw* merge_models(const std::vector<std::string>& files, size_t threads = 1);
+}  // namespace VW
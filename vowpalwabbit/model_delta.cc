@@ -0,0 +1,209 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "model_delta.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "global_data.h"
+#include "vw.h"
+#include "vw_exception.h"
+
+namespace
+{
+constexpr char DELTA_MAGIC[8] = {'v', 'w', 'd', 'e', 'l', 't', 'a', '1'};
+constexpr size_t DELTA_CHUNK = 1 << 16;  // bytes read or written at once, io_buf reads at most its buffer
+
+void append_varint(std::vector<char>& out, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+class delta_records
+{
+public:
+  // Weights must be added in increasing index order.
+  void add(uint64_t index, float value)
+  {
+    append_varint(bytes, index - _last);
+    const size_t end = bytes.size();
+    bytes.resize(end + sizeof(value));
+    memcpy(bytes.data() + end, &value, sizeof(value));
+    _last = index;
+    count++;
+  }
+
+  std::vector<char> bytes;
+  uint64_t count = 0;
+
+private:
+  uint64_t _last = 0;
+};
+
+// The non zero weights in increasing index order.
+std::vector<std::pair<uint64_t, float>> nonzero_weights(parameters& weights, uint64_t length)
+{
+  std::vector<std::pair<uint64_t, float>> nonzero;
+  if (weights.sparse)
+  {
+    sparse_parameters& sparse = weights.sparse_weights;
+    for (auto it = sparse.begin(); it != sparse.end(); ++it)
+      if (*it != 0.f) nonzero.emplace_back(it.index() >> sparse.stride_shift(), *it);
+    std::sort(nonzero.begin(), nonzero.end());
+  }
+  else
+    for (uint64_t i = 0; i < length; i++)
+    {
+      const float value = weights.dense_weights.strided_index(i);
+      if (value != 0.f) nonzero.emplace_back(i, value);
+    }
+  return nonzero;
+}
+
+void changed_weights(parameters& weights, parameters& base, uint64_t length, delta_records& records)
+{
+  if (!weights.sparse && !base.sparse)
+  {
+    for (uint64_t i = 0; i < length; i++)
+    {
+      const float value = weights.dense_weights.strided_index(i);
+      if (value != base.dense_weights.strided_index(i)) records.add(i, value);
+    }
+    return;
+  }
+
+  // Weights which are zero in one of the models only differ by being absent from the other.
+  const auto changed = nonzero_weights(weights, length);
+  const auto original = nonzero_weights(base, length);
+  auto c = changed.begin();
+  auto o = original.begin();
+  while (c != changed.end() || o != original.end())
+  {
+    if (o == original.end() || (c != changed.end() && c->first < o->first))
+      records.add(c->first, (c++)->second);
+    else if (c == changed.end() || o->first < c->first)
+      records.add((o++)->first, 0.f);
+    else
+    {
+      if (c->second != o->second) records.add(c->first, c->second);
+      ++c;
+      ++o;
+    }
+  }
+}
+
+vw* initialize_base(const std::string& base_model)
+{
+  std::vector<std::string> args = {"vw", "-i", base_model, "-t", "--quiet", "--no_stdin"};
+  std::vector<char*> argv;
+  for (auto& arg : args) argv.push_back(&arg[0]);
+  return VW::initialize(static_cast<int>(argv.size()), argv.data());
+}
+
+void read_delta_bytes(io_buf& delta, char* data, size_t bytes, const std::string& file)
+{
+  if (delta.bin_read_fixed(data, bytes, "") < bytes) THROW("the model delta " << file << " is truncated");
+}
+}  // namespace
+
+namespace VW
+{
+void write_model_delta(vw& all, const std::string& base_model, const std::string& file)
+{
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  delta_records records;
+  vw* base = initialize_base(base_model);
+  try
+  {
+    if (base->num_bits != all.num_bits)
+      THROW("the base model " << base_model << " has " << base->num_bits << " bits rather than " << all.num_bits);
+    changed_weights(all.weights, base->weights, length, records);
+  }
+  catch (...)
+  {
+    VW::finish(*base);
+    throw;
+  }
+  VW::finish(*base);
+
+  // Written aside and renamed like models, so that a reader never sees part of a delta.
+  const std::string temporary = file + ".writing";
+  {
+    const auto format =
+        all.model_compression == io::compression_format::none ? io::compression_format::gzip : all.model_compression;
+    io_buf delta;
+    delta.add_file(io::open_compressed_file_writer(temporary, format));
+    uint32_t num_bits = all.num_bits;
+    delta.bin_write_fixed(DELTA_MAGIC, sizeof(DELTA_MAGIC));
+    delta.bin_write_fixed((const char*)&num_bits, sizeof(num_bits));
+    delta.bin_write_fixed((const char*)&records.count, sizeof(records.count));
+    for (size_t done = 0; done < records.bytes.size(); done += DELTA_CHUNK)
+      delta.bin_write_fixed(records.bytes.data() + done, std::min(DELTA_CHUNK, records.bytes.size() - done));
+    delta.flush();
+    delta.close_file();
+  }
+  remove(file.c_str());
+  if (rename(temporary.c_str(), file.c_str()) != 0) THROWERRNO("rename to " << file);
+  if (!all.logger.quiet)
+    all.trace_message << "wrote " << records.count << " weights differing from " << base_model << " to " << file
+                      << std::endl;
+}
+
+void apply_model_delta(vw& all, const std::string& file)
+{
+  io_buf delta;
+  delta.add_file(io::open_compressed_file_reader(file, io::detect_compression_format(file)));
+  char magic[sizeof(DELTA_MAGIC)];
+  uint32_t num_bits;
+  uint64_t count;
+  read_delta_bytes(delta, magic, sizeof(magic), file);
+  if (memcmp(magic, DELTA_MAGIC, sizeof(magic)) != 0) THROW(file << " is not a model delta");
+  read_delta_bytes(delta, (char*)&num_bits, sizeof(num_bits), file);
+  read_delta_bytes(delta, (char*)&count, sizeof(count), file);
+  if (num_bits != all.num_bits)
+    THROW("the model delta " << file << " has " << num_bits << " bits rather than " << all.num_bits);
+
+  std::vector<char> bytes;
+  for (size_t read = DELTA_CHUNK; read == DELTA_CHUNK;)
+  {
+    const size_t end = bytes.size();
+    bytes.resize(end + DELTA_CHUNK);
+    read = delta.bin_read_fixed(bytes.data() + end, DELTA_CHUNK, "");
+    bytes.resize(end + read);
+  }
+  delta.close_file();
+
+  const uint64_t length = (uint64_t)1 << all.num_bits;
+  const char* p = bytes.data();
+  const char* end = p + bytes.size();
+  uint64_t index = 0;
+  for (uint64_t k = 0; k < count; k++)
+  {
+    uint64_t gap = 0;
+    for (uint32_t shift = 0;; shift += 7)
+    {
+      if (p == end || shift > 63) THROW("the model delta " << file << " is corrupted");
+      const uint8_t byte = static_cast<uint8_t>(*p++);
+      gap |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    index += gap;
+    float value;
+    if (index >= length || end - p < (ptrdiff_t)sizeof(value)) THROW("the model delta " << file << " is corrupted");
+    memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    all.weights.strided_index(index) = value;
+  }
+  if (!all.logger.quiet) all.trace_message << "applied " << count << " weights from " << file << std::endl;
+}
+}  // namespace VW
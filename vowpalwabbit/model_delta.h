@@ -0,0 +1,27 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <string>
+
+struct vw;
+
+namespace VW
+{
+// Deltas hold the weights of a model which differ from those of a base model, see --save_delta and --apply_delta, so
+// that a model changing a few weights at a time is shipped as the changes only. They hold the weights alone, a delta
+// goes on a base loaded with the same options. The format is compressed:
+//
+//   "vwdelta1", uint32 number of bits, uint64 count of weights,
+//   per weight: its index less the one before as a LEB128 varint, its float value
+//
+// in increasing index order, the first one less 0. Compressed with --model_compression, or gzip if none.
+
+// Writes the weights of all which differ from those of the model in base_model to file.
+void write_model_delta(vw& all, const std::string& base_model, const std::string& file);
+
+// Sets the weights held by the delta in file.
+void apply_model_delta(vw& all, const std::string& file);
+}  // namespace VW
@@ -0,0 +1,212 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "model_host.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "queue.h"
+#include "vw.h"
+#include "vw_exception.h"
+
+namespace
+{
+// The examples of a batch which go to one model, in the order of the batch.
+struct model_group
+{
+  vw* model;
+  std::vector<multi_ex*> examples;
+  bool learn;
+
+  void run()
+  {
+    for (multi_ex* examples_of_one : examples)
+    {
+      if (model->l->is_multiline)
+      {
+        if (learn) { model->learn(*examples_of_one); }
+        else
+        {
+          model->predict(*examples_of_one);
+        }
+      }
+      else
+      {
+        for (example* ec : *examples_of_one)
+        {
+          if (learn) { model->learn(*ec); }
+          else
+          {
+            model->predict(*ec);
+          }
+        }
+      }
+    }
+  }
+};
+}  // namespace
+
+namespace VW
+{
+class model_host::workers
+{
+public:
+  explicit workers(size_t threads) : _pending(1024)
+  {
+    _threads.reserve(threads);
+    for (size_t i = 0; i < threads; i++) { _threads.emplace_back(&workers::loop, this); }
+  }
+
+  ~workers()
+  {
+    _pending.set_done();
+    for (auto& thread : _threads) { thread.join(); }
+  }
+
+  // Runs every group on the workers and returns once all are done.
+  void run(std::vector<model_group>& groups)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _remaining = groups.size();
+      _exception = nullptr;
+    }
+    for (auto& group : groups) { _pending.push(&group); }
+    std::unique_lock<std::mutex> lock(_lock);
+    _done.wait(lock, [this] { return _remaining == 0; });
+    if (_exception) { std::rethrow_exception(_exception); }
+  }
+
+private:
+  void loop()
+  {
+    while (auto* group = _pending.pop())
+    {
+      std::exception_ptr exception;
+      try
+      {
+        group->run();
+      }
+      catch (...)
+      {
+        exception = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(_lock);
+      if (exception && !_exception) { _exception = exception; }
+      if (--_remaining == 0) { _done.notify_all(); }
+    }
+  }
+
+  VW::ptr_queue<model_group> _pending;
+  std::vector<std::thread> _threads;
+  std::mutex _lock;
+  std::condition_variable _done;
+  size_t _remaining = 0;
+  std::exception_ptr _exception;
+};
+
+model_host::model_host(size_t threads)
+    : _threads(threads == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : threads)
+{
+}
+
+model_host::~model_host()
+{
+  _workers.reset();
+  // The first model goes last, the examples of the others came from its pool.
+  for (auto it = _models.rbegin(); it != _models.rend(); ++it) { VW::finish(**it); }
+}
+
+void model_host::add_model(const std::string& key, const std::string& args)
+{
+  if (has_model(key)) THROW("a model is already hosted under the key " << key);
+  // The first model allocates the examples of all of them.
+  const bool parses = _models.empty();
+  vw* model = VW::initialize(parses || args.find("--ring_size") != std::string::npos ? args : args + " --ring_size 1");
+  if (!parses)
+  {
+    const char* difference = VW::are_features_compatible(parser_model(), *model);
+    if (difference != nullptr)
+    {
+      VW::finish(*model);
+      THROW("the model " << key << " differs from the first hosted model by " << difference
+                         << ", so it cannot use the examples it parses");
+    }
+  }
+  _models.push_back(model);
+  _by_key[key] = model;
+}
+
+bool model_host::has_model(const std::string& key) const { return _by_key.count(key) > 0; }
+
+vw& model_host::model(const std::string& key)
+{
+  auto it = _by_key.find(key);
+  if (it == _by_key.end()) THROW("no model is hosted under the key " << key);
+  return *it->second;
+}
+
+vw& model_host::parser_model()
+{
+  if (_models.empty()) THROW("no model is hosted yet");
+  return *_models.front();
+}
+
+example* model_host::read_example(const std::string& line) { return VW::read_example(parser_model(), line); }
+
+void model_host::learn(const std::string& key, example& ec) { model(key).learn(ec); }
+void model_host::learn(const std::string& key, multi_ex& examples) { model(key).learn(examples); }
+void model_host::predict(const std::string& key, example& ec) { model(key).predict(ec); }
+void model_host::predict(const std::string& key, multi_ex& examples) { model(key).predict(examples); }
+
+void model_host::learn(std::vector<routed_example>& batch) { run(batch, true); }
+void model_host::predict(std::vector<routed_example>& batch) { run(batch, false); }
+
+void model_host::run(std::vector<routed_example>& batch, bool learn)
+{
+  std::vector<model_group> groups;
+  std::map<vw*, size_t> group_of;
+  for (auto& routed : batch)
+  {
+    vw* target = &model(routed.key);
+    auto it = group_of.find(target);
+    if (it == group_of.end())
+    {
+      it = group_of.emplace(target, groups.size()).first;
+      groups.push_back(model_group{target, {}, learn});
+    }
+    groups[it->second].examples.push_back(&routed.examples);
+  }
+  if (groups.empty()) { return; }
+
+  if (groups.size() == 1 || _threads == 1)
+  {
+    for (auto& group : groups) { group.run(); }
+    return;
+  }
+  if (_workers == nullptr) { _workers.reset(new workers(_threads)); }
+  _workers->run(groups);
+}
+
+void model_host::finish_example(const std::string& key, example& ec)
+{
+  vw& target = model(key);
+  target.finish_example(ec);
+  // The model only returns the examples which came from its own pool.
+  if (&target != &parser_model()) { VW::finish_example(parser_model(), ec); }
+}
+
+void model_host::finish_example(const std::string& key, multi_ex& examples)
+{
+  vw& target = model(key);
+  // Finishing may empty the examples, they are returned to the pool after.
+  multi_ex finished = examples;
+  target.finish_example(examples);
+  if (&target != &parser_model()) { VW::finish_example(parser_model(), finished); }
+}
+}  // namespace VW
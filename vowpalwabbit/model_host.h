@@ -0,0 +1,84 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "example.h"
+
+struct vw;
+
+namespace VW
+{
+// An example, or the examples of a multi line one, along with the key of the model it goes to.
+struct routed_example
+{
+  std::string key;
+  multi_ex examples;  // a single example for models of single line examples
+};
+
+// Serves many models in one process, such as a contextual bandit model per tenant, routing each example to a model by
+// its key. The models share what an instance of their own would hold apart:
+//
+// - examples are parsed once, by the first model, and come from its pool. The other models only keep a pool of one
+//   example unless given --ring_size. So that any model can use them, every model must be feature compatible with the
+//   first one, see VW::are_features_compatible, which also has them share its hash cache.
+// - batches of examples are learnt on a set of worker threads, the examples of a model in order on one of them.
+//
+// The host is used from one thread at a time. The models belong to it and are finished with it.
+class model_host
+{
+public:
+  // threads are the workers of batches, 0 for one per core.
+  explicit model_host(size_t threads = 0);
+  ~model_host();
+
+  model_host(const model_host&) = delete;
+  model_host& operator=(const model_host&) = delete;
+
+  // Loads the model of key from the command line args, such as "--cb_explore_adf -i tenant.model --quiet".
+  // \throw VW::vw_exception if key is taken or the model is not feature compatible with the first one
+  void add_model(const std::string& key, const std::string& args);
+
+  bool has_model(const std::string& key) const;
+  // \throw VW::vw_exception if no model has key
+  vw& model(const std::string& key);
+  size_t size() const { return _models.size(); }
+
+  // Parses a line of an example from the shared pool. The lines of a multi line example are read one at a time.
+  // \throw VW::vw_exception if no model was added yet
+  example* read_example(const std::string& line);
+
+  void learn(const std::string& key, example& ec);
+  void learn(const std::string& key, multi_ex& examples);
+  void predict(const std::string& key, example& ec);
+  void predict(const std::string& key, multi_ex& examples);
+
+  // Learns from or predicts each example of batch with its model, on the workers, and returns once all are done.
+  // Nothing is finished, see finish_example.
+  // \throw the first exception one of the models threw
+  void learn(std::vector<routed_example>& batch);
+  void predict(std::vector<routed_example>& batch);
+
+  // Has the model of key report on the examples, then returns them to the shared pool.
+  void finish_example(const std::string& key, example& ec);
+  void finish_example(const std::string& key, multi_ex& examples);
+
+private:
+  class workers;
+
+  vw& parser_model();
+  void run(std::vector<routed_example>& batch, bool learn);
+
+  std::vector<vw*> _models;  // in the order they were added, the first one parses
+  std::map<std::string, vw*> _by_key;
+  std::unique_ptr<workers> _workers;
+  size_t _threads;
+};
+}  // namespace VW
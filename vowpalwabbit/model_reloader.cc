@@ -0,0 +1,171 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "model_reloader.h"
+
+#include <csignal>
+#include <sstream>
+#include <vector>
+
+#include "global_data.h"
+#include "options_serializer_boost_po.h"
+#include "vw.h"
+#include "vw_exception.h"
+
+namespace
+{
+volatile std::sig_atomic_t reload_requested = 0;
+
+#ifndef _WIN32
+void handle_reload(int) { reload_requested = 1; }
+#endif
+
+// The options saved in the model file, which determine how its weights are laid out.
+std::string kept_options(vw& all)
+{
+  VW::config::options_serializer_boost_po serializer;
+  for (auto& option : all.options->get_all_options())
+  {
+    if (option->m_keep && all.options->was_supplied(option->m_name)) { serializer.add(*option); }
+  }
+  return serializer.str();
+}
+
+vw* initialize_for_reload(const std::string& model_file)
+{
+  std::vector<std::string> args = {"vw", "-i", model_file, "-t", "--quiet", "--no_stdin"};
+  std::vector<char*> argv;
+  for (auto& arg : args) argv.push_back(&arg[0]);
+  return VW::initialize(static_cast<int>(argv.size()), argv.data());
+}
+
+// Failing to free an instance is not worth stopping the daemon for.
+void finish_quietly(vw& loaded)
+{
+  try
+  {
+    VW::finish(loaded);
+  }
+  catch (const std::exception&)
+  {
+  }
+}
+}  // namespace
+
+namespace VW
+{
+model_reloader::model_reloader(vw& all, const std::string& model_file)
+    : _all(all)
+    , _model_file(model_file)
+    , _kept_options(kept_options(all))
+    , _num_weights(all.weights.dense_weights.mask() + 1)
+    , _state(state::idle)
+{
+  if (all.weights.sparse) THROW("--reload_model requires dense weights");
+  if (all.weights.dense_weights.external())
+    THROW("--reload_model cannot replace weights attached with --attach_weights");
+
+  reload_requested = 0;
+#ifndef _WIN32
+  std::signal(SIGHUP, handle_reload);
+#endif
+}
+
+model_reloader::~model_reloader()
+{
+#ifndef _WIN32
+  std::signal(SIGHUP, SIG_DFL);
+#endif
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _stopping = true;
+  }
+  _swapped.notify_all();
+  if (_loader.joinable()) _loader.join();
+}
+
+void model_reloader::request(const std::string& model_file)
+{
+  if (_state != state::idle)
+  {
+    if (!_all.logger.quiet) _all.trace_message << "a model is already being reloaded" << std::endl;
+    return;
+  }
+
+  if (_loader.joinable()) _loader.join();
+  _state = state::loading;
+  _loader = std::thread(&model_reloader::load, this, model_file.empty() ? _model_file : model_file);
+}
+
+void model_reloader::swap_if_loaded()
+{
+  if (reload_requested)
+  {
+    reload_requested = 0;
+    request();
+  }
+  if (_state != state::loaded) return;
+
+  std::unique_lock<std::mutex> lock(_lock);
+  if (_loaded == nullptr)
+  {
+    _all.trace_message << "cannot reload the model from " << _loaded_file << ": " << _error << std::endl;
+    ++_failed_reloads;
+    _state = state::idle;
+    return;
+  }
+
+  _all.weights.dense_weights.swap_weights(_loaded->weights.dense_weights);
+  _all.sd->min_label = _loaded->sd->min_label;
+  _all.sd->max_label = _loaded->sd->max_label;
+  if (!_all.logger.quiet) _all.trace_message << "reloaded the model from " << _loaded_file << std::endl;
+  ++_reloads;
+
+  _state = state::retiring;
+  lock.unlock();
+  _swapped.notify_all();
+}
+
+void model_reloader::load(std::string model_file)
+{
+  vw* loaded = nullptr;
+  std::string error;
+  try
+  {
+    loaded = initialize_for_reload(model_file);
+    std::stringstream mismatch;
+    if (loaded->weights.sparse || loaded->weights.dense_weights.mask() + 1 != _num_weights)
+    { mismatch << "the number of weights differs, use the same -b and reductions"; }
+    else if (kept_options(*loaded) != _kept_options)
+    {
+      mismatch << "it was trained with options '" << kept_options(*loaded) << "' instead of '" << _kept_options
+               << "'";
+    }
+    error = mismatch.str();
+  }
+  catch (const std::exception& e)
+  {
+    error = e.what();
+  }
+  if (!error.empty() && loaded != nullptr)
+  {
+    finish_quietly(*loaded);
+    loaded = nullptr;
+  }
+
+  std::unique_lock<std::mutex> lock(_lock);
+  _loaded = loaded;
+  _loaded_file = model_file;
+  _error = error;
+  _state = state::loaded;
+  if (loaded == nullptr) return;
+
+  // Once swapped, the loaded instance holds the old weights, which are freed with it.
+  _swapped.wait(lock, [this] { return _state == state::retiring || _stopping; });
+  _loaded = nullptr;
+  lock.unlock();
+  finish_quietly(*loaded);
+  _state = state::idle;
+}
+}  // namespace VW
@@ -0,0 +1,83 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Mutex and thread cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a
+// managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#endif
+
+struct vw;
+
+namespace VW
+{
+// Replaces the weights of a running daemon with those of a model file, see --reload_model. A reload is requested with
+// SIGHUP or with an example tagged reload, or reload_<file> to read another file. The model is loaded into a second
+// instance on a background thread and checked against the running one: same kept options, such as the reductions and
+// interactions, and same number of weights. The learner then swaps the weights in between two examples, so that
+// predictions in progress finish on the old model, and the background thread frees the old weights afterwards.
+// State which reductions keep outside of the weights is not reloaded.
+class model_reloader
+{
+public:
+  model_reloader(vw& all, const std::string& model_file);
+  ~model_reloader();
+
+  model_reloader(const model_reloader&) = delete;
+  model_reloader& operator=(const model_reloader&) = delete;
+
+  // Starts loading model_file, or the file given to --reload_model if it is empty, unless a load is in progress.
+  void request(const std::string& model_file = "");
+
+  // Swaps in a loaded model, and starts loading one if SIGHUP was received. Called by the learner between examples.
+  void swap_if_loaded();
+
+  // Models swapped in, and models which could not be, so far. Any thread may read them.
+  uint64_t reloads() const { return _reloads; }
+  uint64_t failed_reloads() const { return _failed_reloads; }
+
+private:
+  enum class state
+  {
+    idle,
+    loading,
+    loaded,    // waiting for the learner to swap, or to report why it could not be loaded
+    retiring,  // the old weights are being freed
+  };
+
+  void load(std::string model_file);
+
+  vw& _all;
+  std::string _model_file;
+  std::string _kept_options;  // of the running instance, which reloaded models must match
+  uint64_t _num_weights;
+
+  std::thread _loader;
+  std::mutex _lock;
+  std::condition_variable _swapped;
+  std::atomic<state> _state;
+  bool _stopping = false;
+  vw* _loaded = nullptr;
+  std::string _loaded_file;
+  std::string _error;
+  std::atomic<uint64_t> _reloads{0};
+  std::atomic<uint64_t> _failed_reloads{0};
+};
+}  // namespace VW
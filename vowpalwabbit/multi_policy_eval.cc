@@ -0,0 +1,133 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "multi_policy_eval.h"
+
+#include "cb.h"
+#include "global_data.h"
+#include "learner.h"
+#include "vw_exception.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+void check_model(vw& parser, vw& model, const char* role)
+{
+  if (!model.l->is_multiline) THROW("multi_policy_evaluator: the " << role << " does not predict multi-line examples");
+  if (model.wpp != parser.wpp || model.weights.stride_shift() != parser.weights.stride_shift() ||
+      model.hash_seed != parser.hash_seed)
+  {
+    THROW("multi_policy_evaluator: the " << role
+                                         << " indexes features unlike the parser, it needs the same hash seed and "
+                                            "the same reductions");
+  }
+}
+
+bool is_logged(const example& ec)
+{
+  const auto& costs = ec.l.cb.costs;
+  return costs.size() == 1 && costs[0].cost != FLT_MAX && costs[0].probability > 0;
+}
+}  // namespace
+
+VW::multi_policy_evaluator::multi_policy_evaluator(
+    vw& parser, const std::vector<vw*>& candidates, vw* reward_model, double alpha, double tau)
+    : _parser(parser)
+    , _candidates(candidates)
+    , _reward_model(reward_model)
+    , _ips(candidates.size(), 0.)
+    , _dr(candidates.size(), 0.)
+    , _dro(candidates.size(), VW::distributionally_robust::ChiSquared(alpha, tau))
+{
+  for (vw* candidate : _candidates)
+  {
+    check_model(parser, *candidate, "candidate");
+    if (candidate->l->pred_type != prediction_type_t::action_probs &&
+        candidate->l->pred_type != prediction_type_t::action_scores)
+      THROW("multi_policy_evaluator: a candidate predicts neither action probabilities nor action scores");
+  }
+  if (_reward_model != nullptr)
+  {
+    check_model(parser, *_reward_model, "reward model");
+    if (_reward_model->l->pred_type != prediction_type_t::action_scores)
+      THROW("multi_policy_evaluator: the reward model must predict the cost of each action, as --cb_adf does");
+  }
+  if (!_dro.empty() && !_dro[0].isValid()) THROW("multi_policy_evaluator: invalid alpha or tau");
+}
+
+void VW::multi_policy_evaluator::predict(vw& model, multi_ex& event, std::vector<float>& probabilities)
+{
+  // Examples which keep the interactions of the parser look the same to every model, along with their expansion.
+  auto* interactions = model.interactions == _parser.interactions ? &_parser.interactions : &model.interactions;
+  for (example* ec : event) ec->interactions = interactions;
+  model.predict(event);
+  for (example* ec : event) ec->interactions = &_parser.interactions;
+
+  const auto& a_s = event[0]->pred.a_s;
+  probabilities.assign(_actions.size(), 0.f);
+  if (model.l->pred_type == prediction_type_t::action_probs)
+  {
+    for (const auto& action_score : a_s) probabilities[action_score.action] = action_score.score;
+  }
+  else if (!a_s.empty())
+    probabilities[a_s[0].action] = 1.f;
+}
+
+void VW::multi_policy_evaluator::add(multi_ex& event)
+{
+  _actions.clear();
+  example* logged = nullptr;
+  uint32_t logged_action = 0;
+  for (example* ec : event)
+  {
+    if (CB::ec_is_example_header(*ec)) continue;
+    if (logged == nullptr && is_logged(*ec))
+    {
+      logged = ec;
+      logged_action = static_cast<uint32_t>(_actions.size());
+    }
+    _actions.push_back(ec);
+  }
+  if (logged == nullptr) return;
+
+  // The models predict the event without its label, as explore_eval does.
+  const CB::label label = logged->l.cb;
+  const CB::cb_class known_cost = label.costs[0];
+  logged->l.cb.costs = v_init<CB::cb_class>();
+
+  _costs.assign(_actions.size(), 0.f);
+  if (_reward_model != nullptr)
+  {
+    predict(*_reward_model, event, _probabilities);
+    for (const auto& action_score : event[0]->pred.a_s) _costs[action_score.action] = action_score.score;
+  }
+
+  for (size_t c = 0; c < _candidates.size(); c++)
+  {
+    predict(*_candidates[c], event, _probabilities);
+    const double w = _probabilities[logged_action] / known_cost.probability;
+    double direct = 0.;
+    for (size_t a = 0; a < _actions.size(); a++) direct += _probabilities[a] * _costs[a];
+
+    _ips[c] += w * known_cost.cost;
+    _dr[c] += direct + w * (known_cost.cost - _costs[logged_action]);
+    _dro[c].update(w, -known_cost.cost);
+  }
+  _events++;
+
+  logged->l.cb = label;
+}
+
+VW::policy_estimates VW::multi_policy_evaluator::estimates(size_t candidate)
+{
+  policy_estimates estimates;
+  estimates.events = _events;
+  if (_events == 0) return estimates;
+  estimates.ips = _ips[candidate] / _events;
+  estimates.dr = _dr[candidate] / _events;
+  estimates.dro = -_dro[candidate].lb();
+  return estimates;
+}
@@ -0,0 +1,63 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "distributionally_robust.h"
+#include "example.h"
+
+struct vw;
+
+namespace VW
+{
+// The estimates of the average cost of a candidate policy over the events logged by another one.
+struct policy_estimates
+{
+  size_t events = 0;
+  double ips = 0.;  // inverse propensity score
+  double dr = 0.;   // doubly robust, from the costs predicted by the reward model, or ips without one
+  double dro = 0.;  // upper confidence bound of the chi squared distributionally robust estimate, as --cb_dro has
+};
+
+// Evaluates several candidate models side by side over contextual bandit events which are parsed once, by the
+// instance which reads the log. The candidates only predict, and must index features as it does: with the same hash
+// seed and number of weights per feature. Their interactions may differ. Candidates whose interactions are the ones of
+// the parser share the expansion of the features of an event with --fused_learn, as they then see the same example.
+class multi_policy_evaluator
+{
+public:
+  // The reward model, if any, is a --cb_adf model predicting the cost of every action, for the doubly robust estimates.
+  // alpha and tau are those of --cb_dro.
+  // \throw VW::vw_exception if a model does not predict from multi-line examples as parser indexes them
+  multi_policy_evaluator(vw& parser, const std::vector<vw*>& candidates, vw* reward_model = nullptr,
+      double alpha = 0.05, double tau = 1.);
+
+  // Scores the actions of an event with every candidate and adds to their estimates. Events without a logged action,
+  // one with a cost and a probability, are skipped.
+  void add(multi_ex& event);
+
+  size_t size() const { return _candidates.size(); }
+  policy_estimates estimates(size_t candidate);
+
+private:
+  // The probability which the candidate gives to each action of the event, from its prediction.
+  void predict(vw& model, multi_ex& event, std::vector<float>& probabilities);
+
+  vw& _parser;
+  std::vector<vw*> _candidates;
+  vw* _reward_model;
+
+  std::vector<double> _ips;
+  std::vector<double> _dr;
+  std::vector<VW::distributionally_robust::ChiSquared> _dro;
+  size_t _events = 0;
+
+  std::vector<float> _probabilities;
+  std::vector<float> _costs;  // predicted by the reward model
+  multi_ex _actions;          // of the event, without its shared example
+};
+}  // namespace VW
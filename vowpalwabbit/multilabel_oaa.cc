@@ -11,6 +11,16 @@ using namespace VW::config;
 struct multi_oaa
 {
   size_t k;
+  polyprediction* pred;  // for multipredict
+  uint32_t* models;      // for multiupdate, the labels updated
+  float* labels;         // for multiupdate, whether each label is in the example
+
+  ~multi_oaa()
+  {
+    free(pred);
+    free(models);
+    free(labels);
+  }
 };
 
 template <bool is_learn>
@@ -21,25 +31,25 @@ void predict_or_learn(multi_oaa& o, VW::LEARNER::single_learner& base, example&
   preds.label_v.clear();
 
   ec.l.simple = {FLT_MAX, 1.f, 0.f};
+  base.multipredict(ec, 0, o.k, o.pred, true);
   uint32_t multilabel_index = 0;
   for (uint32_t i = 0; i < o.k; i++)
   {
     if (is_learn)
     {
-      ec.l.simple.label = -1.f;
+      o.models[i] = i;
+      o.labels[i] = -1.f;
       if (multilabels.label_v.size() > multilabel_index && multilabels.label_v[multilabel_index] == i)
       {
-        ec.l.simple.label = 1.f;
+        o.labels[i] = 1.f;
         multilabel_index++;
       }
-      base.learn(ec, i);
     }
-    else
-      base.predict(ec, i);
-    if (ec.pred.scalar > 0.) preds.label_v.push_back(i);
+    if (o.pred[i].scalar > 0.) preds.label_v.push_back(i);
   }
   if (is_learn)
   {
+    base.multiupdate(ec, o.k, o.models, o.labels, o.pred);
     if (multilabel_index < multilabels.label_v.size())
     {
       std::cout << "label " << multilabels.label_v[multilabel_index] << " is not in {0," << o.k - 1
@@ -65,6 +75,9 @@ VW::LEARNER::base_learner* multilabel_oaa_setup(options_i& options, vw& all)
 
   if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
 
+  data->pred = calloc_or_throw<polyprediction>(data->k);
+  data->models = calloc_or_throw<uint32_t>(data->k);
+  data->labels = calloc_or_throw<float>(data->k);
   VW::LEARNER::learner<multi_oaa, example>& l = VW::LEARNER::init_learner(data, as_singleline(setup_base(options, all)),
       predict_or_learn<true>, predict_or_learn<false>, data->k, prediction_type_t::multilabels);
   l.set_finish_example(finish_example);
@@ -10,6 +10,9 @@
 
 namespace VW
 {
+// Interns the names of --named_labels as the ids 1 to K. The names are views into the one list string, so neither
+// parsing a label nor printing a prediction allocates, and the maps never change after construction, so the parse
+// threads read them without locks.
 class named_labels
 {
 private:
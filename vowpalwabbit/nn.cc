@@ -6,6 +6,9 @@
 #include <cstdio>
 #include <sstream>
 #include <memory>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "reductions.h"
 #include "rand48.h"
@@ -36,11 +39,17 @@ struct nn
   bool finished_setup;
   bool multitask;
 
-  float* hidden_units;
+  float* hidden_units;  // the output of each hidden unit, before dropout
   bool* dropped_out;
 
   polyprediction* hidden_units_pred;
   polyprediction* hiddenbias_pred;
+  polyprediction* outputweight_pred;
+
+  // The hidden units backpropagated to at once, see multiupdate.
+  uint32_t* update_units;
+  float* update_labels;
+  polyprediction* update_pred;
 
   vw* all;  // many things
   std::shared_ptr<rand_state> _random_state;
@@ -51,6 +60,10 @@ struct nn
     free(dropped_out);
     free(hidden_units_pred);
     free(hiddenbias_pred);
+    free(outputweight_pred);
+    free(update_units);
+    free(update_labels);
+    free(update_pred);
     VW::dealloc_example(nullptr, output_layer);
     VW::dealloc_example(nullptr, hiddenbias);
     VW::dealloc_example(nullptr, outputweight);
@@ -78,6 +91,32 @@ static inline float fastexp(float p) { return fastpow2(1.442695040f * p); }
 
 static inline float fasttanh(float p) { return -1.0f + 2.0f / (1.0f + fastexp(-2.0f * p)); }
 
+// Sets out[i] to fasttanh(in[i].scalar), four at a time with SSE2, computing what fasttanh does in the same order.
+void fasttanh(const polyprediction* in, float* out, size_t count)
+{
+  for (size_t i = 0; i < count; i++) out[i] = in[i].scalar;
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= count; i += 4)
+  {
+    // fastexp(-2p) is fastpow2(1.442695040f * -2p).
+    const __m128 p = _mm_mul_ps(_mm_set1_ps(1.442695040f), _mm_mul_ps(_mm_set1_ps(-2.0f), _mm_loadu_ps(out + i)));
+    const __m128 negative = _mm_cmplt_ps(p, _mm_setzero_ps());
+    const __m128 offset = _mm_and_ps(negative, one);
+    const __m128 clipp = _mm_max_ps(p, _mm_set1_ps(-126.0f));
+    const __m128 z = _mm_add_ps(_mm_sub_ps(clipp, _mm_cvtepi32_ps(_mm_cvttps_epi32(clipp))), offset);
+    const __m128 exponent = _mm_sub_ps(
+        _mm_add_ps(_mm_add_ps(clipp, _mm_set1_ps(121.2740575f)),
+            _mm_div_ps(_mm_set1_ps(27.7280233f), _mm_sub_ps(_mm_set1_ps(4.84252568f), z))),
+        _mm_mul_ps(_mm_set1_ps(1.49012907f), z));
+    const __m128 e = _mm_castsi128_ps(_mm_cvttps_epi32(_mm_mul_ps(_mm_set1_ps((float)(1 << 23)), exponent)));
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_set1_ps(-1.0f), _mm_div_ps(_mm_set1_ps(2.0f), _mm_add_ps(one, e))));
+  }
+#endif
+  for (; i < count; i++) out[i] = fasttanh(out[i]);
+}
+
 void finish_setup(nn& n, vw& all)
 {
   // TODO: output_layer audit
@@ -233,24 +272,30 @@ void predict_or_learn_multi(nn& n, single_learner& base, example& ec)
     save_max_label = n.all->sd->max_label;
     n.all->sd->max_label = 1;
 
+    if (!converse) fasttanh(hidden_units, n.hidden_units, n.k);
+    // The weights of the output layer are those of the units at the model after theirs.
+    features& out_fs = n.output_layer.feature_space[nn_output_namespace];
+    features& weight_fs = n.outputweight.feature_space[nn_output_namespace];
+    weight_fs.indicies[0] = out_fs.indicies[0];
+    base.multipredict(n.outputweight, n.k, n.k, n.outputweight_pred, true);
+
     for (unsigned int i = 0; i < n.k; ++i)
     {
-      float sigmah = (dropped_out[i]) ? 0.0f : dropscale * fasttanh(hidden_units[i].scalar);
-      features& out_fs = n.output_layer.feature_space[nn_output_namespace];
+      float sigmah = (dropped_out[i]) ? 0.0f : dropscale * n.hidden_units[i];
       out_fs.values[i] = sigmah;
 
       n.output_layer.total_sum_feat_sq += sigmah * sigmah;
       out_fs.sum_feat_sq += sigmah * sigmah;
 
-      n.outputweight.feature_space[nn_output_namespace].indicies[0] = out_fs.indicies[i];
-      base.predict(n.outputweight, n.k);
-      float wf = n.outputweight.pred.scalar;
+      float wf = n.outputweight_pred[i].scalar;
 
       // avoid saddle point at 0
       if (wf == 0)
       {
         float sqrtk = std::sqrt((float)n.k);
         n.outputweight.l.simple.label = (float)(n._random_state->get_and_update_random() - 0.5) / sqrtk;
+        weight_fs.indicies[0] = out_fs.indicies[i];
+        n.outputweight.pred = n.outputweight_pred[i];
         base.update(n.outputweight, n.k);
         n.outputweight.l.simple.label = FLT_MAX;
       }
@@ -332,23 +377,32 @@ void predict_or_learn_multi(nn& n, single_learner& base, example& ec)
 
           if (n.multitask) ec.ft_offset = 0;
 
+          // The output layer just learnt, so its weights are predicted again.
+          weight_fs.indicies[0] = out_fs.indicies[0];
+          base.multipredict(n.outputweight, n.k, n.k, n.outputweight_pred, true);
+
+          // The units are updated in one pass over the features of ec, rather than one pass per unit.
+          size_t count = 0;
           for (unsigned int i = 0; i < n.k; ++i)
           {
             if (!dropped_out[i])
             {
-              float sigmah = n.output_layer.feature_space[nn_output_namespace].values[i] / dropscale;
+              float sigmah = out_fs.values[i] / dropscale;
               float sigmahprime = dropscale * (1.0f - sigmah * sigmah);
-              n.outputweight.feature_space[nn_output_namespace].indicies[0] =
-                  n.output_layer.feature_space[nn_output_namespace].indicies[i];
-              base.predict(n.outputweight, n.k);
-              float nu = n.outputweight.pred.scalar;
+              float nu = n.outputweight_pred[i].scalar;
               float gradhw = 0.5f * nu * gradient * sigmahprime;
 
-              ec.l.simple.label = GD::finalize_prediction(n.all->sd, n.all->logger, hidden_units[i].scalar - gradhw);
-              ec.pred.scalar = hidden_units[i].scalar;
-              if (ec.l.simple.label != hidden_units[i].scalar) base.update(ec, i);
+              float label = GD::finalize_prediction(n.all->sd, n.all->logger, hidden_units[i].scalar - gradhw);
+              if (label != hidden_units[i].scalar)
+              {
+                n.update_units[count] = i;
+                n.update_labels[count] = label;
+                n.update_pred[count] = hidden_units[i];
+                count++;
+              }
             }
           }
+          if (count > 0) base.multiupdate(ec, count, n.update_units, n.update_labels, n.update_pred);
 
           loss_function_swap_guard_learn_block.do_swap();
           n.all->set_minmax = save_set_minmax;
@@ -455,6 +509,10 @@ base_learner* nn_setup(options_i& options, vw& all)
   n->dropped_out = calloc_or_throw<bool>(n->k);
   n->hidden_units_pred = calloc_or_throw<polyprediction>(n->k);
   n->hiddenbias_pred = calloc_or_throw<polyprediction>(n->k);
+  n->outputweight_pred = calloc_or_throw<polyprediction>(n->k);
+  n->update_units = calloc_or_throw<uint32_t>(n->k);
+  n->update_labels = calloc_or_throw<float>(n->k);
+  n->update_pred = calloc_or_throw<polyprediction>(n->k);
 
   auto base = as_singleline(setup_base(options, all));
   n->increment = base->increment;  // Indexing of output layer is odd.
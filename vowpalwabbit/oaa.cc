@@ -17,6 +17,8 @@ struct oaa
   uint64_t k;
   vw* all;                    // for raw
   polyprediction* pred;       // for multipredict
+  uint32_t* models;           // for multiupdate, the classes updated
+  float* labels;              // for multiupdate, the label of each class updated
   uint64_t num_subsample;     // for randomized subsampling, how many negatives to draw?
   uint32_t* subsample_order;  // for randomized subsampling, in what order should we touch classes
   size_t subsample_id;        // for randomized subsampling, where do we live in the list
@@ -24,6 +26,8 @@ struct oaa
   ~oaa()
   {
     free(pred);
+    free(models);
+    free(labels);
     free(subsample_order);
   }
 };
@@ -50,15 +54,20 @@ void learn_randomized(oaa& o, VW::LEARNER::single_learner& base, example& ec)
     uint32_t l = o.subsample_order[p];
     p = (p + 1) % o.k;
     if (l == ld.label - 1) continue;
-    base.learn(ec, l);
+    base.predict(ec, l);
     if (ec.partial_prediction > best_partial_prediction)
     {
       best_partial_prediction = ec.partial_prediction;
       prediction = l + 1;
     }
+    o.models[count] = l;
+    o.labels[count] = -1.f;
+    o.pred[count].scalar = ec.pred.scalar;
     count++;
   }
   o.subsample_id = p;
+  // The negatives are learnt from together, in one pass over the features.
+  base.multiupdate(ec, count, o.models, o.labels, o.pred);
 
   ec.pred.multiclass = (uint32_t)prediction;
   ec.l.multi = ld;
@@ -89,10 +98,10 @@ void predict_or_learn(oaa& o, VW::LEARNER::single_learner& base, example& ec)
   {
     for (uint32_t i = 1; i <= o.k; i++)
     {
-      ec.l.simple = {(mc_label_data.label == i) ? 1.f : -1.f, 0.f, 0.f};
-      ec.pred.scalar = o.pred[i - 1].scalar;
-      base.update(ec, i - 1);
+      o.models[i - 1] = i - 1;
+      o.labels[i - 1] = (mc_label_data.label == i) ? 1.f : -1.f;
     }
+    base.multiupdate(ec, o.k, o.models, o.labels, o.pred);
   }
 
   if (print_all)
@@ -207,6 +216,8 @@ VW::LEARNER::base_learner* oaa_setup(options_i& options, vw& all)
 
   data->all = &all;
   data->pred = calloc_or_throw<polyprediction>(data->k);
+  data->models = calloc_or_throw<uint32_t>(data->k);
+  data->labels = calloc_or_throw<float>(data->k);
   data->subsample_order = nullptr;
   data->subsample_id = 0;
   if (data->num_subsample > 0)
@@ -8,6 +8,8 @@
 #include <queue>
 #include <stack>
 
+#include "allocation_profiler.h"
+
 // Mutex and CV cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a managed
 // project.
 #ifdef _M_CEE
@@ -74,6 +76,9 @@ struct no_lock_object_pool
 
   bool empty() const { return m_pool.empty(); }
 
+  // Number of objects in the pool, which size() counts along with those handed out.
+  size_t available() const { return m_pool.size(); }
+
   size_t size() const
   {
     size_t size = 0;
@@ -103,6 +108,7 @@ private:
   void new_chunk(size_t size)
   {
     if (size == 0) { return; }
+    VW_ALLOCATION_MECHANISM(object_pool);
 
     m_chunks.push_back(std::unique_ptr<T[]>(new T[size]));
     auto& chunk = m_chunks.back();
@@ -190,6 +196,12 @@ struct object_pool
     return inner_pool.size();
   }
 
+  size_t available() const
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    return inner_pool.available();
+  }
+
   bool is_from_pool(T* obj) const
   {
     std::unique_lock<std::mutex> lock(m_lock);
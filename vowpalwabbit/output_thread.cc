@@ -0,0 +1,203 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "output_thread.h"
+
+#include <algorithm>
+
+#include "global_data.h"
+#include "thread_affinity.h"
+
+namespace
+{
+struct queued_writer : public VW::io::writer
+{
+  queued_writer(const std::shared_ptr<VW::output_thread>& thread, std::unique_ptr<VW::io::writer>&& sink)
+      : thread(thread), sink(std::move(sink))
+  {
+  }
+
+  ~queued_writer()
+  {
+    try
+    {
+      thread->flush();
+    }
+    catch (...)
+    {
+      // the error was reported when the write failed, and destructors must not throw
+    }
+  }
+
+  ssize_t write(const char* buffer, size_t num_bytes) override
+  {
+    thread->write(sink.get(), buffer, num_bytes);
+    return static_cast<ssize_t>(num_bytes);
+  }
+
+  void flush() override
+  {
+    thread->flush();
+    sink->flush();
+  }
+
+  std::shared_ptr<VW::output_thread> thread;
+  std::unique_ptr<VW::io::writer> sink;
+};
+}  // namespace
+
+namespace VW
+{
+output_thread::output_thread(size_t queue_size, print_result_func print_result, print_text_func print_text)
+    : _print_result(print_result), _print_text(print_text), _records(std::max<size_t>(queue_size, 1))
+{
+  _thread = std::thread(&output_thread::output_loop, this);
+}
+
+output_thread::~output_thread()
+{
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _stop = true;
+  }
+  _queued.notify_one();
+  _thread.join();
+  for (auto& r : _records) r.tag.delete_v();
+}
+
+std::unique_ptr<io::writer> output_thread::wrap(
+    const std::shared_ptr<output_thread>& thread, std::unique_ptr<io::writer>&& sink)
+{
+  if (sink == nullptr) return nullptr;
+  return std::unique_ptr<io::writer>(new queued_writer(thread, std::move(sink)));
+}
+
+output_thread::record& output_thread::claim(std::unique_lock<std::mutex>& lock)
+{
+  _written.wait(lock, [this] { return _num_queued < _records.size(); });
+  return _records[(_read_index + _num_queued) % _records.size()];
+}
+
+void output_thread::queue(std::unique_lock<std::mutex>& lock)
+{
+  _num_queued++;
+  lock.unlock();
+  _queued.notify_one();
+}
+
+void output_thread::print_result(io::writer* sink, float result, float weight, const v_array<char>& tag)
+{
+  std::unique_lock<std::mutex> lock(_lock);
+  record& r = claim(lock);
+  r.kind = record_kind::result;
+  r.sink = sink;
+  r.result = result;
+  r.weight = weight;
+  copy_array(r.tag, tag);
+  queue(lock);
+}
+
+void output_thread::print_text(io::writer* sink, const std::string& text, const v_array<char>& tag)
+{
+  std::unique_lock<std::mutex> lock(_lock);
+  record& r = claim(lock);
+  r.kind = record_kind::text;
+  r.sink = sink;
+  r.text = text;
+  copy_array(r.tag, tag);
+  queue(lock);
+}
+
+void output_thread::write(io::writer* sink, const char* buffer, size_t num_bytes)
+{
+  std::unique_lock<std::mutex> lock(_lock);
+  record& r = claim(lock);
+  r.kind = record_kind::bytes;
+  r.sink = sink;
+  r.text.assign(buffer, num_bytes);
+  queue(lock);
+}
+
+void output_thread::flush()
+{
+  std::unique_lock<std::mutex> lock(_lock);
+  _written.wait(lock, [this] { return _num_queued == 0; });
+  if (_exc_ptr)
+  {
+    auto exc_ptr = _exc_ptr;
+    _exc_ptr = nullptr;
+    std::rethrow_exception(exc_ptr);
+  }
+}
+
+void output_thread::output_loop()
+{
+  pin_current_thread(thread_role::output);
+  while (true)
+  {
+    size_t first;
+    size_t count;
+    {
+      std::unique_lock<std::mutex> lock(_lock);
+      _queued.wait(lock, [this] { return _num_queued > 0 || _stop; });
+      if (_num_queued == 0) return;
+      first = _read_index;
+      count = _num_queued;
+    }
+
+    // The queued records are not claimed again until they are released below, so they are read without the lock.
+    for (size_t i = 0; i < count; i++)
+    {
+      const record& r = _records[(first + i) % _records.size()];
+      try
+      {
+        switch (r.kind)
+        {
+          case record_kind::result:
+            _print_result(r.sink, r.result, r.weight, r.tag);
+            break;
+          case record_kind::text:
+            _print_text(r.sink, r.text, r.tag);
+            break;
+          case record_kind::bytes:
+            r.sink->write(r.text.data(), r.text.size());
+            break;
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_exc_ptr) _exc_ptr = std::current_exception();
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _read_index = (_read_index + count) % _records.size();
+      _num_queued -= count;
+    }
+    _written.notify_all();
+  }
+}
+
+void print_result_on_output_thread(io::writer* sink, float result, float weight, const v_array<char>& tag)
+{
+  if (sink == nullptr) return;
+  auto* queued = dynamic_cast<queued_writer*>(sink);
+  if (queued != nullptr)
+    queued->thread->print_result(queued->sink.get(), result, weight, tag);
+  else
+    print_result_by_ref(sink, result, weight, tag);
+}
+
+void print_text_on_output_thread(io::writer* sink, const std::string& text, const v_array<char>& tag)
+{
+  if (sink == nullptr) return;
+  auto* queued = dynamic_cast<queued_writer*>(sink);
+  if (queued != nullptr)
+    queued->thread->print_text(queued->sink.get(), text, tag);
+  else
+    print_raw_text_by_ref(sink, text, tag);
+}
+}  // namespace VW
@@ -0,0 +1,109 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+// Mutex, CV and thread cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a
+// managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#endif
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "io/io_adapter.h"
+#include "v_array.h"
+
+namespace VW
+{
+// Formats and writes the predictions of --output_thread on a thread of its own. The sinks of the predictions are
+// replaced by writers made by wrap(), which queue what is written to them, and vw::print_by_ref and
+// vw::print_text_by_ref by print_result_on_output_thread and print_text_on_output_thread, which queue the prediction
+// itself for the thread to format with the printers they replaced. Everything goes through one bounded queue, so that
+// the predictions and what reductions write to the sinks themselves come out in order, and the learner only waits when
+// the queue is full.
+class output_thread
+{
+public:
+  using print_result_func = void (*)(io::writer*, float, float, const v_array<char>&);
+  using print_text_func = void (*)(io::writer*, const std::string&, const v_array<char>&);
+
+  /// \param queue_size number of predictions and writes which can wait to be written, must be at least 1
+  /// \param print_result the printer to format scalar predictions with
+  /// \param print_text the printer to format text predictions with
+  output_thread(size_t queue_size, print_result_func print_result, print_text_func print_text);
+  ~output_thread();
+
+  output_thread(const output_thread&) = delete;
+  output_thread& operator=(const output_thread&) = delete;
+
+  /// A writer which passes what is written to it, and the predictions printed to it, to sink on the output thread.
+  /// Destroying it waits for what was queued for sink to be written.
+  static std::unique_ptr<io::writer> wrap(
+      const std::shared_ptr<output_thread>& thread, std::unique_ptr<io::writer>&& sink);
+
+  void print_result(io::writer* sink, float result, float weight, const v_array<char>& tag);
+  void print_text(io::writer* sink, const std::string& text, const v_array<char>& tag);
+  void write(io::writer* sink, const char* buffer, size_t num_bytes);
+
+  /// Waits for everything queued so far to be written, and rethrows what writing it threw.
+  void flush();
+
+private:
+  enum class record_kind
+  {
+    result,
+    text,
+    bytes
+  };
+
+  struct record
+  {
+    record_kind kind = record_kind::bytes;
+    io::writer* sink = nullptr;
+    float result = 0.f;
+    float weight = 0.f;
+    std::string text;  // of text predictions and writes
+    v_array<char> tag = v_init<char>();
+  };
+
+  // Waits for a free record. It is filled and queued under the lock, which keeps apart the writes of threads which
+  // finish examples concurrently.
+  record& claim(std::unique_lock<std::mutex>& lock);
+  void queue(std::unique_lock<std::mutex>& lock);
+  void output_loop();
+
+  print_result_func _print_result;
+  print_text_func _print_text;
+
+  // Ring of records, [_read_index, _read_index + _num_queued) wait to be written or are being written.
+  std::vector<record> _records;
+  size_t _read_index = 0;
+  size_t _num_queued = 0;
+  bool _stop = false;
+  std::exception_ptr _exc_ptr;
+
+  std::mutex _lock;
+  std::condition_variable _queued;
+  std::condition_variable _written;
+  std::thread _thread;
+};
+
+// The printers of vw with --output_thread. Sinks not made by output_thread::wrap are printed to as text right away.
+void print_result_on_output_thread(io::writer* sink, float result, float weight, const v_array<char>& tag);
+void print_text_on_output_thread(io::writer* sink, const std::string& text, const v_array<char>& tag);
+}  // namespace VW
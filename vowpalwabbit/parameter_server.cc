@@ -0,0 +1,251 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "parameter_server.h"
+#include "vw_exception.h"
+
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <future>
+
+namespace
+{
+// A shard file is the magic, then uint64 count, count uint64 weight indices and count float weights.
+constexpr char SHARD_MAGIC[8] = {'v', 'w', 'p', 's', 'h', 'r', 'd', '1'};
+}  // namespace
+
+namespace VW
+{
+void send_all(socket_t sock, const char* buffer, size_t bytes)
+{
+  while (bytes > 0)
+  {
+    int sent = send(sock, buffer, (int)std::min<size_t>(bytes, 1 << 20), 0);
+    if (sent < 0) THROWERRNO("send: ");
+    buffer += sent;
+    bytes -= sent;
+  }
+}
+
+void recv_all(socket_t sock, char* buffer, size_t bytes)
+{
+  while (bytes > 0)
+  {
+    int received = recv(sock, buffer, (int)std::min<size_t>(bytes, 1 << 20), 0);
+    if (received < 0) THROWERRNO("recv: ");
+    if (received == 0) THROW("connection closed with " << bytes << " bytes left to read");
+    buffer += received;
+    bytes -= received;
+  }
+}
+
+ParameterServer::ParameterServer(uint16_t port, bool quiet)
+    : m_stop(false), m_port(port), m_quiet(quiet), m_future(nullptr), m_workers(0)
+{
+#ifdef _WIN32
+  WSAData wsaData;
+  int lastError = WSAStartup(MAKEWORD(2, 2), &wsaData);
+  if (lastError != 0) THROWERRNO("WSAStartup() returned error:" << lastError);
+#endif
+
+  char addr_buf[INET_ADDRSTRLEN];
+
+  sock = socket(PF_INET, SOCK_STREAM, 0);
+#ifdef _WIN32
+  if (sock == INVALID_SOCKET)
+#else
+  if (sock < 0)
+#endif
+    THROWERRNO("socket: ");
+
+  int on = 1;
+  if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (char*)&on, sizeof(on)) < 0) THROWERRNO("setsockopt SO_REUSEADDR: ");
+
+  sockaddr_in address;
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+  address.sin_port = htons(port);
+  if (::bind(sock, (sockaddr*)&address, sizeof(address)) < 0)
+    THROWERRNO("bind failed for " << inet_ntop(AF_INET, &address.sin_addr, addr_buf, INET_ADDRSTRLEN));
+
+  sockaddr_in bound_addr;
+  memset(&bound_addr, 0, sizeof(bound_addr));
+  socklen_t len = sizeof(bound_addr);
+  if (::getsockname(sock, (sockaddr*)&bound_addr, &len) < 0)
+    THROWERRNO("getsockname: " << inet_ntop(AF_INET, &bound_addr.sin_addr, addr_buf, INET_ADDRSTRLEN));
+
+  // which port did we bind too (if m_port is 0 this will give us the actual port)
+  m_port = ntohs(bound_addr.sin_port);
+}
+
+ParameterServer::~ParameterServer()
+{
+  Stop();
+  delete m_future;
+}
+
+short unsigned int ParameterServer::BoundPort() { return m_port; }
+
+void ParameterServer::UseModelFile(const std::string& file)
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_model_file = file;
+
+  std::ifstream in(file, std::ios::binary);
+  if (!in) return;
+  char magic[sizeof(SHARD_MAGIC)];
+  uint64_t count = 0;
+  in.read(magic, sizeof(magic));
+  in.read((char*)&count, sizeof(count));
+  if (!in || memcmp(magic, SHARD_MAGIC, sizeof(magic)) != 0) THROW(file << " is not a parameter server shard");
+
+  std::vector<uint64_t> indices(count);
+  std::vector<float> values(count);
+  in.read((char*)indices.data(), count * sizeof(uint64_t));
+  in.read((char*)values.data(), count * sizeof(float));
+  if (!in) THROW(file << " is truncated");
+  m_weights.clear();
+  m_weights.reserve(count);
+  for (size_t i = 0; i < count; i++) m_weights[indices[i]] = values[i];
+  if (!m_quiet) std::cerr << "parameter server: read " << count << " weights from " << file << std::endl;
+}
+
+void ParameterServer::save_locked()
+{
+  if (m_model_file.empty()) return;
+
+  std::vector<uint64_t> indices;
+  std::vector<float> values;
+  indices.reserve(m_weights.size());
+  values.reserve(m_weights.size());
+  for (const auto& weight : m_weights)
+  {
+    indices.push_back(weight.first);
+    values.push_back(weight.second);
+  }
+  const uint64_t count = indices.size();
+
+  // Written aside and renamed, so a server killed meanwhile leaves the previous shard whole.
+  const std::string temporary = m_model_file + ".writing";
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(SHARD_MAGIC, sizeof(SHARD_MAGIC));
+    out.write((const char*)&count, sizeof(count));
+    out.write((const char*)indices.data(), count * sizeof(uint64_t));
+    out.write((const char*)values.data(), count * sizeof(float));
+    if (!out) THROW("could not write " << temporary);
+  }
+  remove(m_model_file.c_str());
+  if (rename(temporary.c_str(), m_model_file.c_str()) != 0) THROWERRNO("rename to " << m_model_file);
+  if (!m_quiet) std::cerr << "parameter server: wrote " << count << " weights to " << m_model_file << std::endl;
+}
+
+void ParameterServer::Start()
+{
+  if (m_future == nullptr) { m_future = new std::future<void>; }
+
+  *m_future = std::async(std::launch::async, &ParameterServer::Run, this);
+}
+
+void ParameterServer::Stop()
+{
+  if (m_stop) return;
+  m_stop = true;
+#ifndef _WIN32
+  // just close won't unblock the accept
+  shutdown(sock, SHUT_RD);
+#endif
+  CLOSESOCK(sock);
+
+  // wait for run to stop, which waits for the workers to disconnect
+  if (m_future != nullptr && m_future->valid()) { m_future->get(); }
+}
+
+void ParameterServer::serve(socket_t client)
+{
+  std::vector<uint64_t> indices;
+  std::vector<float> values;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_workers++;
+  }
+  try
+  {
+    while (true)
+    {
+      uint64_t count;
+      // The worker is done when it closes the connection between requests.
+      int received = recv(client, (char*)&count, sizeof(count), 0);
+      if (received <= 0) break;
+      if (received < (int)sizeof(count)) recv_all(client, (char*)&count + received, sizeof(count) - received);
+
+      indices.resize(count);
+      values.resize(count);
+      recv_all(client, (char*)indices.data(), count * sizeof(uint64_t));
+      recv_all(client, (char*)values.data(), count * sizeof(float));
+      {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (size_t i = 0; i < count; i++) values[i] = m_weights[indices[i]] += values[i];
+      }
+      send_all(client, (const char*)values.data(), count * sizeof(float));
+    }
+  }
+  catch (VW::vw_exception& e)
+  {
+    if (!m_quiet) std::cerr << "parameter server: " << e.what() << std::endl;
+  }
+  CLOSESOCK(client);
+
+  std::lock_guard<std::mutex> lock(m_lock);
+  try
+  {
+    if (--m_workers == 0) save_locked();
+  }
+  catch (VW::vw_exception& e)
+  {
+    if (!m_quiet) std::cerr << "parameter server: " << e.what() << std::endl;
+  }
+}
+
+void ParameterServer::Run()
+{
+  if (listen(sock, 1024) < 0) THROWERRNO("listen: ");
+  while (!m_stop)
+  {
+    sockaddr_in client_address;
+    socklen_t size = sizeof(client_address);
+    socket_t f = accept(sock, (sockaddr*)&client_address, &size);
+#ifdef _WIN32
+    if (f == INVALID_SOCKET)
+#else
+    if (f < 0)
+#endif
+      break;
+
+    if (!m_quiet)
+    {
+      char dotted_quad[INET_ADDRSTRLEN];
+      if (nullptr != inet_ntop(AF_INET, &(client_address.sin_addr), dotted_quad, INET_ADDRSTRLEN))
+        std::cerr << "parameter server: worker connected from " << dotted_quad << std::endl;
+    }
+    m_connections.emplace_back(&ParameterServer::serve, this, f);
+  }
+
+  for (auto& connection : m_connections) connection.join();
+  m_connections.clear();
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    save_locked();
+  }
+
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
+}  // namespace VW
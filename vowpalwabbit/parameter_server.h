@@ -0,0 +1,66 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "spanning_tree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A parameter server holds the weights of the indices hashed to it, and workers exchange with it asynchronously,
+// without waiting for one another as allreduce does. A request is
+//
+//   uint64 count, count uint64 weight indices, count float deltas
+//
+// each delta is added to its weight, and the reply is the count resulting weights, as floats.
+//
+// Together the servers hold the whole model, which no worker has to: with --sparse_weights a worker only keeps the
+// weights of the features it saw. Each server can keep its shard of the model in a file of its own, so the shards are
+// written and read in parallel.
+
+namespace VW
+{
+// Sends or receives exactly bytes, throwing if the connection fails or closes.
+void send_all(socket_t sock, const char* buffer, size_t bytes);
+void recv_all(socket_t sock, char* buffer, size_t bytes);
+
+class ParameterServer
+{
+private:
+  bool m_stop;
+  socket_t sock;
+  uint16_t m_port;
+  bool m_quiet;
+
+  std::future<void>* m_future;
+
+  std::mutex m_lock;  // guards m_weights and m_workers
+  std::unordered_map<uint64_t, float> m_weights;
+  std::vector<std::thread> m_connections;
+  size_t m_workers;          // connected
+  std::string m_model_file;  // the shard is saved to once the last worker disconnects, empty if none
+
+  void serve(socket_t client);
+  void save_locked();
+
+public:
+  ParameterServer(short unsigned int port = 26545, bool quiet = false);
+  ~ParameterServer();
+
+  short unsigned int BoundPort();
+
+  // Reads the shard of file if it exists and saves the shard to it whenever the workers are all gone and when stopped.
+  void UseModelFile(const std::string& file);
+
+  void Start();
+  void Run();
+  void Stop();
+};
+}  // namespace VW
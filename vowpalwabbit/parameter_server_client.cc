@@ -0,0 +1,125 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "parameter_server_client.h"
+#include "global_data.h"
+#include "vw_exception.h"
+
+#include <string.h>
+#include <iostream>
+
+namespace VW
+{
+parameter_server_client::parameter_server_client(
+    const std::vector<std::string>& servers, uint64_t sync_interval, bool quiet)
+    : _servers(servers), _sync_interval(sync_interval), _quiet(quiet)
+{
+  if (_servers.empty()) THROW("--ps_servers needs at least one host:port");
+  if (_sync_interval == 0) THROW("--ps_sync_interval must be at least 1");
+}
+
+parameter_server_client::~parameter_server_client()
+{
+  for (socket_t sock : _socks) CLOSESOCK(sock);
+}
+
+void parameter_server_client::connect_servers()
+{
+#ifdef _WIN32
+  WSAData wsaData;
+  int lastError = WSAStartup(MAKEWORD(2, 2), &wsaData);
+  if (lastError != 0) THROWERRNO("WSAStartup() returned error:" << lastError);
+#endif
+
+  for (const auto& server : _servers)
+  {
+    const size_t colon = server.rfind(':');
+    if (colon == std::string::npos) THROW("parameter server " << server << " is not host:port");
+    const std::string host = server.substr(0, colon);
+    const int port = std::stoi(server.substr(colon + 1));
+
+    struct hostent* entry = gethostbyname(host.c_str());
+    if (entry == nullptr) THROWERRNO("gethostbyname(" << host << ")");
+
+    socket_t sock = socket(PF_INET, SOCK_STREAM, 0);
+    if (sock == -1) THROWERRNO("socket");
+    sockaddr_in far_end;
+    far_end.sin_family = AF_INET;
+    far_end.sin_port = htons((u_short)port);
+    far_end.sin_addr = *(in_addr*)entry->h_addr;
+    memset(&far_end.sin_zero, '\0', 8);
+    if (connect(sock, (sockaddr*)&far_end, sizeof(far_end)) == -1)
+    {
+      CLOSESOCK(sock);
+      THROWERRNO("connect to parameter server " << server);
+    }
+    if (!_quiet) std::cerr << "connected to parameter server " << server << std::endl;
+    _socks.push_back(sock);
+  }
+  _indices.resize(_socks.size());
+  _values.resize(_socks.size());
+}
+
+bool parameter_server_client::between_examples(vw& all)
+{
+  if (++_examples < _sync_interval) return false;
+  _examples = 0;
+  sync(all, false);
+  return true;
+}
+
+void parameter_server_client::request(uint64_t index, float weight, float& synced, bool all_weights)
+{
+  const float delta = weight - synced;
+  if (delta == 0.f && !all_weights) return;
+  _indices[index % _socks.size()].push_back(index);
+  _values[index % _socks.size()].push_back(delta);
+}
+
+void parameter_server_client::sync(vw& all, bool all_weights)
+{
+  if (_socks.empty()) connect_servers();
+
+  const uint32_t stride_shift = all.weights.stride_shift();
+  const uint64_t shards = _socks.size();
+  for (auto& indices : _indices) indices.clear();
+  for (auto& values : _values) values.clear();
+  if (all.weights.sparse)
+  {
+    sparse_parameters& weights = all.weights.sparse_weights;
+    for (auto it = weights.begin(); it != weights.end(); ++it)
+    {
+      const uint64_t i = it.index() >> stride_shift;
+      request(i, *it, _synced_sparse[i], all_weights);
+    }
+  }
+  else
+  {
+    const uint64_t length = UINT64_ONE << all.num_bits;
+    if (_synced.size() != length) _synced.assign(length, 0.f);
+    dense_parameters& weights = all.weights.dense_weights;
+    for (uint64_t i = 0; i < length; i++) request(i, weights[i << stride_shift], _synced[i], all_weights);
+  }
+
+  // Each server reads a whole request before replying, so every request can be sent before any reply is read.
+  for (uint64_t shard = 0; shard < shards; shard++)
+  {
+    const uint64_t count = _indices[shard].size();
+    send_all(_socks[shard], (const char*)&count, sizeof(count));
+    send_all(_socks[shard], (const char*)_indices[shard].data(), count * sizeof(uint64_t));
+    send_all(_socks[shard], (const char*)_values[shard].data(), count * sizeof(float));
+  }
+  for (uint64_t shard = 0; shard < shards; shard++)
+  {
+    auto& indices = _indices[shard];
+    auto& values = _values[shard];
+    recv_all(_socks[shard], (char*)values.data(), values.size() * sizeof(float));
+    for (size_t k = 0; k < indices.size(); k++)
+    {
+      all.weights.strided_index(indices[k]) = values[k];
+      (all.weights.sparse ? _synced_sparse[indices[k]] : _synced[indices[k]]) = values[k];
+    }
+  }
+}
+}  // namespace VW
@@ -0,0 +1,58 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "parameter_server.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct vw;
+
+namespace VW
+{
+// Exchanges the weights of a worker with the parameter servers given by --ps_servers, see parameter_server.h. Every
+// --ps_sync_interval examples, the weights changed since the last exchange send their change to the server of their
+// index, and take the value that results, so they are at most that many examples behind the other workers. Weights
+// the worker has not changed are refreshed at the end of each pass, then every weight is exchanged. With sparse weights
+// only the weights the worker has are exchanged, so it never holds the whole model.
+class parameter_server_client
+{
+public:
+  // servers are host:port.
+  parameter_server_client(const std::vector<std::string>& servers, uint64_t sync_interval, bool quiet);
+  ~parameter_server_client();
+
+  parameter_server_client(const parameter_server_client&) = delete;
+  parameter_server_client& operator=(const parameter_server_client&) = delete;
+
+  // Called before each example, exchanges the changed weights once sync_interval examples were seen. Returns whether
+  // it did.
+  bool between_examples(vw& all);
+
+  // Exchanges the changed weights, or with all_weights every weight.
+  void sync(vw& all, bool all_weights);
+
+  uint64_t sync_interval() const { return _sync_interval; }
+
+private:
+  void connect_servers();
+  void request(uint64_t index, float weight, float& synced, bool all_weights);
+
+  std::vector<std::string> _servers;
+  std::vector<socket_t> _socks;
+  uint64_t _sync_interval;
+  uint64_t _examples = 0;
+  bool _quiet;
+  std::vector<float> _synced;  // the weights as of the last exchange
+  std::unordered_map<uint64_t, float> _synced_sparse;  // instead, with sparse weights
+
+  // Requests and replies of each server.
+  std::vector<std::vector<uint64_t>> _indices;
+  std::vector<std::vector<float>> _values;
+};
+}  // namespace VW
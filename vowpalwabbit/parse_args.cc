@@ -9,12 +9,22 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 
 #include "parse_regressor.h"
+#include "cpu_features.h"
+#include "parameter_server_client.h"
+#include "prediction_cache.h"
+#include "output_thread.h"
+#include "thread_affinity.h"
 #include "parser.h"
 #include "parse_primitives.h"
 #include "vw.h"
 #include "interactions.h"
+#include "interaction_plan.h"
 
 #include "sender.h"
 #include "nn.h"
@@ -30,6 +40,7 @@
 #include "csoaa.h"
 #include "cb_algs.h"
 #include "cb_adf.h"
+#include "cb_candidates.h"
 #include "cb_dro.h"
 #include "cb_explore.h"
 #include "cb_explore_adf_bag.h"
@@ -52,9 +63,13 @@
 #include "noop.h"
 #include "print.h"
 #include "gd_mf.h"
+#include "feature_cost.h"
+#include "hash_report.h"
+#include "ffm.h"
 #include "learner.h"
 #include "mf.h"
 #include "ftrl.h"
+#include "lr_ensemble.h"
 #include "svrg.h"
 #include "rand48.h"
 #include "binary.h"
@@ -102,6 +117,8 @@
 #include "sample_pdf.h"
 #include "named_labels.h"
 #include "kskip_ngram_transformer.h"
+#include "model_delta.h"
+#include "daemon_server.h"
 
 using std::cerr;
 using std::cout;
@@ -276,7 +293,7 @@ void parse_dictionary_argument(vw& all, const std::string& str)
     // clear up ec
     ec->tag.clear();
     ec->indices.clear();
-    for (size_t i = 0; i < 256; i++) { ec->feature_space[i].clear(); }
+    for (features& fs : ec->feature_space) { fs.clear(); }
   } while ((rc != EOF) && (nread > 0));
   free(buffer);
   VW::dealloc_example(all.example_parser->lbl_parser.delete_label, *ec);
@@ -347,6 +364,8 @@ void parse_diagnostics(options_i& options, vw& all)
   bool version_arg = false;
   bool help = false;
   bool skip_driver = false;
+  bool stage_timing = false;
+  bool kernel_variants = false;
   std::string progress_arg;
   option_group_definition diagnostic_group("Diagnostic options");
   diagnostic_group.add(make_option("version", version_arg).help("Version information"))
@@ -355,12 +374,20 @@ void parse_diagnostics(options_i& options, vw& all)
                .short_name("P")
                .help("Progress update frequency. int: additive, float: multiplicative"))
       .add(make_option("quiet", all.logger.quiet).help("Don't output disgnostics and progress updates"))
+      .add(make_option("stage_timing", stage_timing)
+               .help("Sample the time spent reading, parsing, learning and finishing examples and in allreduce, and "
+                     "report it at the end of the run"))
+      .add(make_option("kernel_variants", kernel_variants)
+               .help("Print the instruction set each set of SIMD kernels was picked for on this CPU"))
       .add(make_option("dry_run", skip_driver)
                .help("Parse arguments and print corresponding metadata. Will not execute driver."))
       .add(make_option("help", help).short_name("h").help("Look here: http://hunch.net/~vw/ and click on Tutorial."));
 
   options.add_and_parse(diagnostic_group);
 
+  if (stage_timing) all.profiler.reset(new VW::stage_profiler());
+  if (kernel_variants && !all.logger.quiet) all.trace_message << "kernel variants = " << VW::kernel_variants() << endl;
+
   // pass all.logger.quiet around
   if (all.all_reduce) all.all_reduce->quiet = all.logger.quiet;
 
@@ -419,6 +446,22 @@ input_options parse_source(vw& all, options_i& options)
                .help("in persistent daemon mode, do not run in the background"))
       .add(make_option("port", parsed_options.port).help("port to listen on; use 0 to pick unused port"))
       .add(make_option("num_children", all.num_children).help("number of children for persistent daemon mode"))
+      .add(make_option("daemon_event_loop", parsed_options.daemon_event_loop)
+               .help("in persistent daemon mode, serve all connections from one process with an event loop instead of "
+                     "forking children"))
+      .add(make_option("reload_model", parsed_options.reload_model)
+               .help("with --daemon_event_loop, reload the model from this file on SIGHUP or on an example tagged "
+                     "reload, without restarting"))
+      .add(make_option("metrics_port", parsed_options.metrics_port)
+               .help("with --daemon_event_loop, serve Prometheus metrics over HTTP on this port; use 0 to pick an "
+                     "unused port"))
+      .add(make_option("trace_requests", parsed_options.trace_requests)
+               .help("with --daemon_event_loop, time when each example was received, parsed, queued, predicted and "
+                     "answered, printing the quantiles of each phase and writing the last examples to this file as a "
+                     "Chrome trace once the input ends"))
+      .add(make_option("trace_requests_size", parsed_options.trace_requests_size)
+               .default_value(10000)
+               .help("number of the last examples written by --trace_requests"))
       .add(make_option("pid_file", parsed_options.pid_file).help("Write pid file in persistent daemon mode"))
       .add(make_option("port_file", parsed_options.port_file).help("Write port used in persistent daemon mode"))
       .add(make_option("cache", parsed_options.cache).short_name("c").help("Use a cache.  The default is <data>.cache"))
@@ -433,6 +476,38 @@ input_options parse_source(vw& all, options_i& options)
               .help(
                   "use gzip format whenever possible. If a cache file is being created, this option creates a "
                   "compressed cache file. A mixture of raw-text & compressed inputs are supported with autodetection."))
+      .add(make_option("mmap", parsed_options.mmap)
+               .help("memory map uncompressed data and cache files and parse them in place instead of copying them "
+                     "into a buffer"))
+      .add(make_option("read_ahead", parsed_options.read_ahead_buffers)
+               .default_value(0)
+               .help("number of 1MB buffers read ahead of the parser on a separate I/O thread for data and cache "
+                     "files. 0 reads synchronously"))
+      .add(make_option("compression_threads", parsed_options.compression_threads)
+               .default_value(1)
+               .help("number of threads used with --compressed to compress cache files and to decompress block "
+                     "compressed (BGZF) inputs"))
+      .add(make_option("cache_compression", parsed_options.cache_compression)
+               .help("compression used for cache files that are created: none, gzip, zstd or lz4. Defaults to gzip "
+                     "with --compressed and none otherwise. Existing caches are read in the format they were "
+                     "written in"))
+      .add(make_option("cache_format", parsed_options.cache_format)
+               .default_value(2)
+               .help("format of cache files that are created. 1 stores examples back to back, 2 groups them into "
+                     "checksummed blocks with an index so that damaged blocks are skipped"))
+      .add(make_option("cache_block_size", parsed_options.cache_block_size)
+               .default_value(1024)
+               .help("number of examples per block of format 2 cache files"))
+      .add(make_option("cache_dedup", parsed_options.cache_dedup)
+               .help("store the features of a namespace once per block of format 2 cache files and refer to them "
+                     "from the other examples of the block which have the same, such as the actions of contextual "
+                     "bandit logs. Applies to --in_memory as well"))
+      .add(make_option("cache_shuffle", parsed_options.cache_shuffle)
+               .help("read the blocks of format 2 cache files in a random order each pass, seeded by --random_seed, "
+                     "and the examples of each block in a random order"))
+      .add(make_option("in_memory", parsed_options.in_memory)
+               .help("keep the examples of the first pass in memory, encoded as in a format 2 cache, so that later "
+                     "passes neither read nor parse the input. Works with --cache_shuffle"))
       .add(make_option("no_stdin", all.stdin_off).help("do not default to reading from stdin"))
       .add(make_option("no_daemon", all.no_daemon)
                .help("Force a loaded daemon or active learning model to accept local input instead of starting in "
@@ -443,20 +518,46 @@ input_options parse_source(vw& all, options_i& options)
                      "A^B^C. Note: this will become the default in a future version, so enabling this option will "
                      "migrate you to the new behavior and silence the warning."))
       .add(make_option("flatbuffer", parsed_options.flatbuffer)
-               .help("data file will be interpreted as a flatbuffer file"));
+               .help("data file will be interpreted as a flatbuffer file"))
+      .add(make_option("flatbuffer_limit", parsed_options.flatbuffer_limit)
+               .default_value(1024)
+               .help("largest size prefixed object read from a flatbuffer file, in MB. Larger objects are reported as "
+                     "corrupt input instead of being buffered"))
+      .add(make_option("arrow", parsed_options.arrow)
+               .help("data file is an Arrow IPC file, whose rows are examples of the columns of --columnar_schema. "
+                     "Needs vw built with USE_ARROW"))
+      .add(make_option("parquet", parsed_options.parquet)
+               .help("data file is a Parquet file, whose rows are examples of the columns of --columnar_schema. "
+                     "Needs vw built with USE_ARROW"))
+      .add(make_option("columnar_schema", parsed_options.columnar_schema)
+               .help("file of the columns of --arrow and --parquet input, a line of <column> "
+                     "label|weight|tag|numeric|categorical [<namespace>] per column"))
+      .add(make_option("kafka_topic", parsed_options.kafka.topic)
+               .help("read text examples from the records of this Kafka topic instead of a data file. Offsets are "
+                     "committed once the model of -f is saved by the save commands inserted every "
+                     "--kafka_checkpoint records. Needs vw built with USE_KAFKA"))
+      .add(make_option("kafka_brokers", parsed_options.kafka.brokers)
+               .default_value("localhost:9092")
+               .help("bootstrap servers of --kafka_topic, host:port[,host:port...]"))
+      .add(make_option("kafka_group", parsed_options.kafka.group)
+               .default_value("vw")
+               .help("consumer group of --kafka_topic, whose offsets are committed"))
+      .add(make_option("kafka_checkpoint", parsed_options.kafka.checkpoint_records)
+               .default_value(100000)
+               .help("records of --kafka_topic between saves of the model and commits of their offsets, 0 for none"))
+      .add(make_option("kafka_stop_at_end", parsed_options.kafka.stop_at_end)
+               .help("end the input of --kafka_topic once every assigned partition is read to its end, saving the "
+                     "model and committing the offsets"));
 
   options.add_and_parse(input_options);
 
   // Check if the options provider has any positional args. Only really makes sense for command line, others just return
   // an empty list.
+  // An example set given with -d comes first, the further positional args are read after it as more data files.
   const auto positional_tokens = options.get_positional_tokens();
-  if (positional_tokens.size() == 1) { all.data_filename = positional_tokens[0]; }
-  else if (positional_tokens.size() > 1)
-  {
-    all.trace_message << "Warning: Multiple data files passed as positional parameters, only the first one will be "
-                         "read and the rest will be ignored."
-                      << endl;
-  }
+  auto first_extra = positional_tokens.begin();
+  if (all.data_filename.empty() && first_extra != positional_tokens.end()) { all.data_filename = *first_extra++; }
+  parsed_options.extra_data_files.assign(first_extra, positional_tokens.end());
 
   if (parsed_options.daemon || options.was_supplied("pid_file") || (options.was_supplied("port") && !all.active))
   {
@@ -465,6 +566,16 @@ input_options parse_source(vw& all, options_i& options)
     all.numpasses = (size_t)1e5;
   }
 
+  if (!parsed_options.reload_model.empty() && !(all.daemon && parsed_options.daemon_event_loop))
+    THROW("--reload_model requires --daemon_event_loop");
+  if (options.was_supplied("metrics_port"))
+  {
+    if (!(all.daemon && parsed_options.daemon_event_loop)) THROW("--metrics_port requires --daemon_event_loop");
+    if (parsed_options.metrics_port > UINT16_MAX) THROW("--metrics_port must be below 65536");
+  }
+  if (!parsed_options.trace_requests.empty() && !(all.daemon && parsed_options.daemon_event_loop))
+    THROW("--trace_requests requires --daemon_event_loop");
+
   // Add an implicit cache file based on the data filename.
   if (parsed_options.cache) { parsed_options.cache_files.push_back(all.data_filename + ".cache"); }
 
@@ -479,6 +590,13 @@ input_options parse_source(vw& all, options_i& options)
     all.trace_message << "Making holdout_set_off=true since output regularizer specified" << endl;
   }
 
+  if (!all.holdout_set_off && parsed_options.cache_shuffle)
+  {
+    all.holdout_set_off = true;
+    all.trace_message << "Making holdout_set_off=true since cache_shuffle moves examples in and out of the holdout set"
+                      << endl;
+  }
+
   return parsed_options;
 }
 
@@ -597,6 +715,8 @@ void parse_feature_tweaks(
     options_i& options, vw& all, bool interactions_settings_duplicated, std::vector<std::string>& dictionary_nses)
 {
   std::string hash_function("strings");
+  std::string hash_algorithm("murmur3");
+  size_t hash_cache_size = 0;
   uint32_t new_bits;
   std::vector<std::string> spelling_ns;
   std::vector<std::string> quadratics;
@@ -620,7 +740,16 @@ void parse_feature_tweaks(
   option_group_definition feature_options("Feature options");
   feature_options
       .add(make_option("hash", hash_function).keep().help("how to hash the features. Available options: strings, all"))
+      .add(make_option("hash_function", hash_algorithm)
+               .keep()
+               .default_value("murmur3")
+               .help("the hash of feature and namespace names, recorded in the model. Available options: murmur3, xxh3 "
+                     "(faster on short names)"))
       .add(make_option("hash_seed", all.hash_seed).keep().default_value(0).help("seed for hash function"))
+      .add(make_option("hash_cache_size", hash_cache_size)
+               .default_value(0)
+               .help("remember the hashes of up to this many feature names per namespace of text and JSON input, so "
+                     "that repeated names are not hashed again. 0 hashes every name"))
       .add(make_option("ignore", ignores).keep().help("ignore namespaces beginning with character <arg>"))
       .add(make_option("ignore_linear", ignore_linears)
                .keep()
@@ -670,7 +799,10 @@ void parse_feature_tweaks(
   options.add_and_parse(feature_options);
 
   // feature manipulation
-  all.example_parser->hasher = getHasher(hash_function);
+  all.example_parser->hasher = getHasher(hash_function, hash_algorithm);
+  all.example_parser->string_hasher = getHasher("strings", hash_algorithm);
+  all.example_parser->all_hasher = getHasher("all", hash_algorithm);
+  if (hash_cache_size > 0) { all.example_parser->hash_cache.reset(new VW::feature_hash_cache(hash_cache_size)); }
 
   if (options.was_supplied("spelling"))
   {
@@ -1006,6 +1138,18 @@ void parse_feature_tweaks(
   if (noconstant) all.add_constant = false;
 }
 
+// Once the dictionaries are loaded, see vw::parse_ignore.
+void compile_parse_ignore(vw& all)
+{
+  all.parse_ignore_some = false;
+  for (size_t i = 0; i < NUM_NAMESPACES; i++)
+  {
+    all.parse_ignore[i] = all.ignore_some && all.ignore[i] && all.affix_features[i] == 0 &&
+        !all.spelling_features[i] && all.namespace_dictionaries[i].empty();
+    all.parse_ignore_some |= all.parse_ignore[i];
+  }
+}
+
 void parse_example_tweaks(options_i& options, vw& all)
 {
   std::string named_labels;
@@ -1013,6 +1157,7 @@ void parse_example_tweaks(options_i& options, vw& all)
   float loss_parameter = 0.0;
   size_t early_terminate_passes;
   bool test_only = false;
+  size_t predict_cache_size = 0;
 
   option_group_definition example_options("Example options");
   example_options.add(make_option("testonly", test_only).short_name("t").help("Ignore label information and just test"))
@@ -1025,6 +1170,9 @@ void parse_example_tweaks(options_i& options, vw& all)
               .default_value(3)
               .help(
                   "Specify the number of passes tolerated when holdout loss doesn't decrease before early termination"))
+      .add(make_option("holdout_thread", all.holdout_thread)
+               .help("Predict the holdout examples on a thread of their own while the others are learnt from, with the "
+                     "weights as they are then"))
       .add(make_option("passes", all.numpasses).help("Number of Training Passes"))
       .add(make_option("initial_pass_length", all.pass_length).help("initial number of examples per pass"))
       .add(make_option("examples", all.max_examples).help("number of examples to parse"))
@@ -1046,7 +1194,10 @@ void parse_example_tweaks(options_i& options, vw& all)
       .add(make_option("named_labels", named_labels)
                .keep()
                .help("use names for labels (multiclass, etc.) rather than integers, argument specified all possible "
-                     "labels, comma-sep, eg \"--named_labels Noun,Verb,Adj,Punc\""));
+                     "labels, comma-sep, eg \"--named_labels Noun,Verb,Adj,Punc\""))
+      .add(make_option("predict_cache", predict_cache_size)
+               .help("Cache the predictions of up to arg examples, so that repeated examples of the same features are "
+                     "not predicted again until the model changes. Needs -t"));
   options.add_and_parse(example_options);
 
   if (test_only || all.eta == 0.)
@@ -1058,6 +1209,12 @@ void parse_example_tweaks(options_i& options, vw& all)
   else
     all.training = true;
 
+  if (predict_cache_size > 0)
+  {
+    if (all.training) THROW("--predict_cache needs -t, the predictions change as the model learns");
+    all.prediction_cache.reset(new VW::prediction_cache(predict_cache_size));
+  }
+
   if ((all.numpasses > 1 || all.holdout_after > 0) && !all.holdout_set_off)
     all.holdout_set_off = false;  // holdout is on unless explicitly off
   else
@@ -1099,14 +1256,28 @@ void parse_output_preds(options_i& options, vw& all)
 {
   std::string predictions;
   std::string raw_predictions;
+  std::string prediction_format;
 
   option_group_definition output_options("Output options");
   output_options.add(make_option("predictions", predictions).short_name("p").help("File to output predictions to"))
       .add(make_option("raw_predictions", raw_predictions)
                .short_name("r")
-               .help("File to output unnormalized predictions to"));
+               .help("File to output unnormalized predictions to"))
+      .add(make_option("prediction_format", prediction_format)
+               .default_value("text")
+               .help("text, or binary to write each scalar prediction as two 4 byte floats, the prediction then the "
+                     "weight, as daemons answer examples sent as cache. Predictions which are not scalars stay text"))
+      .add(make_option("output_queue", all.output_queue_size)
+               .default_value(0)
+               .help("number of predictions queued for a separate output thread to format and write to the "
+                     "prediction files. 0 writes them on the learner thread"));
   options.add_and_parse(output_options);
 
+  if (prediction_format == "binary")
+    all.binary_predictions = true;
+  else if (prediction_format != "text")
+    THROW("prediction_format must be text or binary, got " << prediction_format);
+
   if (options.was_supplied("predictions"))
   {
     if (!all.logger.quiet) all.trace_message << "predictions = " << predictions << endl;
@@ -1119,7 +1290,7 @@ void parse_output_preds(options_i& options, vw& all)
     {
       try
       {
-        all.final_prediction_sink.push_back(VW::io::open_file_writer(predictions));
+        all.final_prediction_sink.push_back(VW::io::open_buffered_file_writer(predictions));
       }
       catch (...)
       {
@@ -1147,6 +1318,7 @@ void parse_output_preds(options_i& options, vw& all)
 
 void parse_output_model(options_i& options, vw& all)
 {
+  std::string model_compression;
   option_group_definition output_model_options("Output model");
   output_model_options
       .add(make_option("final_regressor", all.final_regressor_name).short_name("f").help("Final regressor"))
@@ -1154,17 +1326,47 @@ void parse_output_model(options_i& options, vw& all)
                .help("Output human-readable final regressor with numeric features"))
       .add(make_option("invert_hash", all.inv_hash_regressor_name)
                .help("Output human-readable final regressor with feature names.  Computationally expensive."))
+      .add(make_option("save_quantized", all.quantized_regressor_name)
+               .help("Output final regressor with its non zero weights quantized to int8, for vw slim"))
+      .add(make_option("save_delta", all.delta_base_name)
+               .help("Output final regressor as its weights which differ from those of this model, see --apply_delta"))
+      .add(make_option("rehash_bits", all.rehash_bits)
+               .help("Fold the weights of the final regressor into 2^arg, summing those which collide, so that it "
+                     "predicts with -b arg such as in vw slim"))
+      .add(make_option("write_weight_runs", all.write_weight_runs)
+               .help("Write the weights of binary models as runs of consecutive weights, which load in bulk"))
+      .add(make_option("write_weight_image", all.write_weight_image)
+               .help("Write the dense weights of binary models as one aligned array, which predicting maps from the "
+                     "model file"))
+      .add(make_option("write_resume_columns", all.write_resume_columns)
+               .help("Write the state of the weights of binary --save_resume models in blocks of columns, which "
+                     "predicting reads the weights of alone"))
+      .add(make_option("save_threads", all.save_threads)
+               .default_value(0)
+               .help("Threads writing the dense weights of binary models, 0 for one per core"))
       .add(make_option("save_resume", all.save_resume)
                .help("save extra state so learning can be resumed later with new data"))
       .add(make_option("preserve_performance_counters", all.preserve_performance_counters)
                .help("reset performance counters when warmstarting"))
       .add(make_option("save_per_pass", all.save_per_pass).help("Save the model after every pass over data"))
+      .add(make_option("save_in_background", all.save_in_background)
+               .help("Save the models of --save_per_pass and save commands from a forked process while learning "
+                     "continues"))
       .add(make_option("output_feature_regularizer_binary", all.per_feature_regularizer_output)
                .help("Per feature regularization output file"))
       .add(make_option("output_feature_regularizer_text", all.per_feature_regularizer_text)
                .help("Per feature regularization output file, in text"))
-      .add(make_option("id", all.id).help("User supplied ID embedded into the final regressor"));
+      .add(make_option("id", all.id).help("User supplied ID embedded into the final regressor"))
+      .add(make_option("publish_weights", all.publish_weights_name)
+               .help("Publish the weights in shared memory under this name whenever the model is saved"))
+      .add(make_option("model_compression", model_compression)
+               .default_value("none")
+               .help("compression used for binary models that are written: none, gzip, zstd or lz4. Models are read "
+                     "in the format they were written in"));
   options.add_and_parse(output_model_options);
+  all.model_compression = VW::io::parse_compression_format(model_compression);
+  if (all.rehash_bits != 0 && all.save_resume)
+    THROW("--rehash_bits writes a model to predict with, it cannot be combined with --save_resume");
 
   if (all.final_regressor_name.compare("") && !all.logger.quiet)
     all.trace_message << "final_regressor = " << all.final_regressor_name << endl;
@@ -1199,14 +1401,47 @@ void load_input_model(vw& all, io_buf& io_temp)
     all.l->save_load(io_temp, true, false);
     io_temp.close_file();
   }
+
+  if (!all.model_deltas.empty() && all.initial_regressors.empty()) THROW("--apply_delta requires -i");
+  for (const auto& delta : all.model_deltas) VW::apply_model_delta(all, delta);
 }
 
+namespace
+{
+struct registered_reduction
+{
+  std::string name;
+  // The options of its setup, which is skipped when none of them is supplied. Empty for reductions always set up.
+  std::set<std::string> option_names;
+};
+
+// Registering a reduction sets it up against a vw of its own to learn its name and options, which only depend on the
+// setup function, so it is done once per process.
+std::mutex registration_lock;
+std::map<reduction_setup_fn, registered_reduction> registrations;
+
+// Reductions none of whose options are supplied would only register their options and return nullptr. Their setup is
+// skipped, sparing a parse of the command line each, unless all options are listed by --help or --dry_run.
+bool skip_setup(options_i& options, reduction_setup_fn setup_func)
+{
+  if (options.was_supplied("help") || options.was_supplied("h") || options.was_supplied("dry_run")) return false;
+  std::lock_guard<std::mutex> lock(registration_lock);
+  auto it = registrations.find(setup_func);
+  if (it == registrations.end() || it->second.option_names.empty()) return false;
+  for (const auto& name : it->second.option_names)
+    if (options.was_supplied(name)) return false;
+  return true;
+}
+}  // namespace
+
 VW::LEARNER::base_learner* setup_base(options_i& options, vw& all)
 {
   reduction_setup_fn setup_func = std::get<1>(all.reduction_stack.top());
   std::string setup_func_name = std::get<0>(all.reduction_stack.top());
   all.reduction_stack.pop();
 
+  if (skip_setup(options, setup_func)) return setup_base(options, all);
+
   // 'hacky' way of keeping track of the option group created by the setup_func about to be created
   options.tint(setup_func_name);
   auto base = setup_func(options, all);
@@ -1219,6 +1454,7 @@ VW::LEARNER::base_learner* setup_base(options_i& options, vw& all)
   else
   {
     all.enabled_reductions.push_back(setup_func_name);
+    if (all.profiler != nullptr) base->profile = &all.profiler->reduction(setup_func_name);
     return base;
   }
 }
@@ -1231,21 +1467,30 @@ void register_reductions(vw& all, std::vector<reduction_setup_fn>& reductions)
       {VW::cb_explore_adf::regcb::setup, "cb_explore_adf_regcb"},
       {VW::shared_feature_merger::shared_feature_merger_setup, "shared_feature_merger"}};
 
+  std::lock_guard<std::mutex> lock(registration_lock);
   auto name_extractor = options_name_extractor();
-  vw dummy_all;
+  std::unique_ptr<vw> dummy_all;
 
   for (auto setup_fn : reductions)
   {
-    if (allowlist.count(setup_fn)) { all.reduction_stack.push(std::make_tuple(allowlist[setup_fn], setup_fn)); }
-    else
+    auto registered = registrations.find(setup_fn);
+    if (registered == registrations.end())
     {
-      auto base = setup_fn(name_extractor, dummy_all);
-
-      if (base == nullptr)
-        all.reduction_stack.push(std::make_tuple(name_extractor.generated_name, setup_fn));
+      registered_reduction registration;
+      if (allowlist.count(setup_fn)) { registration.name = allowlist[setup_fn]; }
       else
-        THROW("fatal: under register_reduction() all setup functions must return nullptr");
+      {
+        if (dummy_all == nullptr) dummy_all.reset(new vw());
+        name_extractor.option_names.clear();
+        auto base = setup_fn(name_extractor, *dummy_all);
+
+        if (base != nullptr) THROW("fatal: under register_reduction() all setup functions must return nullptr");
+        registration.name = name_extractor.generated_name;
+        registration.option_names = name_extractor.option_names;
+      }
+      registered = registrations.emplace(setup_fn, std::move(registration)).first;
     }
+    all.reduction_stack.push(std::make_tuple(registered->second.name, setup_fn));
   }
 }
 
@@ -1257,9 +1502,11 @@ void parse_reductions(options_i& options, vw& all)
   reductions.push_back(GD::setup);
   reductions.push_back(kernel_svm_setup);
   reductions.push_back(ftrl_setup);
+  reductions.push_back(lr_ensemble_setup);
   reductions.push_back(svrg_setup);
   reductions.push_back(sender_setup);
   reductions.push_back(gd_mf_setup);
+  reductions.push_back(ffm_setup);
   reductions.push_back(print_setup);
   reductions.push_back(noop_setup);
   reductions.push_back(lda_setup);
@@ -1267,6 +1514,10 @@ void parse_reductions(options_i& options, vw& all)
   reductions.push_back(OjaNewton_setup);
   // reductions.push_back(VW_CNTK::setup);
 
+  // Analyses of what the base algorithm is given
+  reductions.push_back(hash_report_setup);
+  reductions.push_back(feature_cost_setup);
+
   // Score Users
   reductions.push_back(baseline_setup);
   reductions.push_back(ExpReplay::expreplay_setup<'b', simple_label_parser>);
@@ -1303,6 +1554,7 @@ void parse_reductions(options_i& options, vw& all)
   reductions.push_back(CSOAA::csoaa_setup);
   reductions.push_back(interact_setup);
   reductions.push_back(CSOAA::csldf_setup);
+  reductions.push_back(VW::cb_candidates::setup);
   reductions.push_back(cb_algs_setup);
   reductions.push_back(cb_adf_setup);
   reductions.push_back(mwt_setup);
@@ -1340,6 +1592,11 @@ void parse_reductions(options_i& options, vw& all)
 
   register_reductions(all, reductions);
   all.l = setup_base(options, all);
+  if (all.prediction_cache != nullptr && (all.l->is_multiline || !VW::prediction_cache::caches(all.l->pred_type)))
+    THROW("--predict_cache caches the predictions of single line examples of scalar, scalars, multiclass or prob "
+          "predictions, not of " << (all.l->is_multiline ? "multiline examples" : to_string(all.l->pred_type)));
+  // after the reductions, as --lda replaces the parser
+  if (all.profiler != nullptr) all.example_parser->input->fill_profile = &all.profiler->io_fill;
 }
 
 vw& parse_args(
@@ -1360,16 +1617,82 @@ vw& parse_args(
 
     bool strict_parse = false;
     int ring_size_tmp;
+    int parse_threads_tmp;
+    int dispatch_batch_size_tmp;
+    int dispatch_latency_tmp;
+    bool unordered_parse = false;
+    std::string concurrent_input;
+    std::string example_queue;
+    size_t pool_capacity;
     option_group_definition vw_args("VW options");
     vw_args.add(make_option("ring_size", ring_size_tmp).default_value(256).help("size of example ring"))
-        .add(make_option("strict_parse", strict_parse).help("throw on malformed examples"));
+        .add(make_option("strict_parse", strict_parse).help("throw on malformed examples"))
+        .add(make_option("parse_threads", parse_threads_tmp)
+                 .default_value(1)
+                 .help("number of threads used to parse text, JSON and DSJSON input"))
+        .add(make_option("unordered_parse", unordered_parse)
+                 .help("with --parse_threads, pass examples to the learner as soon as they are parsed instead of in "
+                       "input order. Multi line examples are only kept together for JSON and DSJSON input"))
+        .add(make_option("concurrent_input", concurrent_input)
+                 .help("with --parse_threads, read the data files of the first pass at once, handing the learner "
+                       "their examples by turns (round_robin) or as they are read (unordered)"))
+        .add(make_option("example_queue", example_queue)
+                 .default_value("mutex")
+                 .help("queue between parser and learner: mutex, spsc (lock-free, single producer and consumer) or "
+                       "mpmc (lock-free, multiple producers and consumers)"))
+        .add(make_option("dispatch_batch_size", dispatch_batch_size_tmp)
+                 .default_value(1)
+                 .help("number of parsed examples published to the learner at once, e.g. 64 to 1024 to amortize "
+                       "queue synchronization"))
+        .add(make_option("dispatch_latency", dispatch_latency_tmp)
+                 .default_value(0)
+                 .help("with --daemon_event_loop, microseconds a partially filled --dispatch_batch_size batch waits "
+                       "for more requests before it is published"))
+        .add(make_option("pool_capacity", pool_capacity)
+                 .default_value(0)
+                 .help("features a namespace of a pooled example keeps the storage of when it is reused, 0 for no "
+                       "limit. The storage kept by the pool is reported at the end"));
     all.options->add_and_parse(vw_args);
 
     if (ring_size_tmp <= 0) { THROW("ring_size should be positive"); }
     size_t ring_size = static_cast<size_t>(ring_size_tmp);
+    if (parse_threads_tmp <= 0) { THROW("parse_threads should be positive"); }
+    if (dispatch_batch_size_tmp <= 0) { THROW("dispatch_batch_size should be positive"); }
+    if (dispatch_latency_tmp < 0) { THROW("dispatch_latency should not be negative"); }
+
+    VW::input_interleave input_interleave = VW::input_interleave::sequential;
+    if (concurrent_input == "round_robin") { input_interleave = VW::input_interleave::round_robin; }
+    else if (concurrent_input == "unordered")
+    {
+      input_interleave = VW::input_interleave::unordered;
+    }
+    else if (!concurrent_input.empty())
+    {
+      THROW("concurrent_input must be one of round_robin or unordered");
+    }
+    if (input_interleave != VW::input_interleave::sequential && parse_threads_tmp == 1)
+    { THROW("--concurrent_input requires --parse_threads above 1"); }
+
+    VW::queue_type queue = VW::queue_type::mutex;
+    if (example_queue == "spsc") { queue = VW::queue_type::spsc; }
+    else if (example_queue == "mpmc")
+    {
+      queue = VW::queue_type::mpmc;
+    }
+    else if (example_queue != "mutex")
+    {
+      THROW("example_queue must be one of mutex, spsc or mpmc");
+    }
 
-    all.example_parser = new parser{ring_size, strict_parse};
+    all.example_parser = new parser{ring_size, strict_parse, queue};
     all.example_parser->_shared_data = all.sd;
+    all.example_parser->num_parse_threads = static_cast<size_t>(parse_threads_tmp);
+    all.example_parser->unordered_parse = unordered_parse;
+    all.example_parser->input_interleave = input_interleave;
+    all.example_parser->pool_capacity = pool_capacity;
+    all.example_parser->report_pool_memory = all.options->was_supplied("pool_capacity");
+    all.example_parser->dispatch_batch_size = static_cast<size_t>(dispatch_batch_size_tmp);
+    all.example_parser->dispatch_latency = static_cast<size_t>(dispatch_latency_tmp);
 
     option_group_definition update_args("Update options");
     update_args.add(make_option("learning_rate", all.eta).help("Set learning rate").short_name("l"))
@@ -1382,6 +1705,40 @@ vw& parse_args(
                        "given, also used for initial weights."));
     all.options->add_and_parse(update_args);
 
+    // The learner is pinned before the weights are allocated, so that --numa local places them on its node.
+    std::vector<std::pair<VW::thread_role, std::string>> cpus_of_roles = {{VW::thread_role::learner, ""},
+        {VW::thread_role::parser, ""}, {VW::thread_role::io, ""}, {VW::thread_role::output, ""},
+        {VW::thread_role::worker, ""}};
+    option_group_definition affinity_args("Thread affinity options");
+    affinity_args
+        .add(make_option("learner_cpus", cpus_of_roles[0].second)
+                 .help("Pin the thread which drives vw, whose NUMA node --numa local places the weights on, and the "
+                       "--threads learners to these CPUs, such as 0-7,16-23, or nodeN for those of NUMA node N"))
+        .add(make_option("parser_cpus", cpus_of_roles[1].second)
+                 .help("Pin the parse thread and the --parse_threads workers to these CPUs"))
+        .add(make_option("io_cpus", cpus_of_roles[2].second)
+                 .help("Pin the read ahead, compression and background cache writing threads to these CPUs"))
+        .add(make_option("output_cpus", cpus_of_roles[3].second)
+                 .help("Pin the thread writing the predictions of --output_queue to these CPUs"))
+        .add(make_option("worker_cpus", cpus_of_roles[4].second)
+                 .help("Pin the threads learners split their work over, such as those of --bfgs_threads, "
+                       "--svrg_threads and --save_threads, to these CPUs"));
+    all.options->add_and_parse(affinity_args);
+    for (const auto& role : cpus_of_roles)
+    {
+      if (role.second.empty()) continue;
+      if (!VW::thread_affinity_supported())
+      {
+        all.trace_message << "Warning: threads are only pinned to CPUs on Linux, the CPUs given are ignored" << endl;
+        break;
+      }
+      VW::set_thread_cpus(role.first, VW::parse_cpu_list(role.second));
+    }
+    VW::pin_current_thread(VW::thread_role::learner);
+
+    std::string huge_pages;
+    std::string numa;
+    uint32_t prefetch_distance;
     option_group_definition weight_args("Weight options");
     weight_args
         .add(make_option("initial_regressor", all.initial_regressors).help("Initial regressor(s)").short_name("i"))
@@ -1390,28 +1747,102 @@ vw& parse_args(
         .add(make_option("normal_weights", all.normal_weights).help("make initial weights normal"))
         .add(make_option("truncated_normal_weights", all.tnormal_weights).help("make initial weights truncated normal"))
         .add(make_option("sparse_weights", all.weights.sparse).help("Use a sparse datastructure for weights"))
+        .add(make_option("sparse_weights_limit", all.sparse_weights_limit)
+                 .help("Keep the sparse weights and their tables under about arg MiB, evicting the least used weights "
+                       "and the smallest of those used as often once they grow past it"))
         .add(make_option("input_feature_regularizer", all.per_feature_regularizer_input)
-                 .help("Per feature regularization input file"));
+                 .help("Per feature regularization input file"))
+        .add(make_option("apply_delta", all.model_deltas)
+                 .help("Update the weights of the initial regressor with model deltas written by --save_delta, in order"))
+        .add(make_option("prune_weights", all.prune_weights)
+                 .help("Drop the weights whose magnitude is below arg when loading and saving models"))
+        .add(make_option("prune_adaptive", all.prune_adaptive)
+                 .help("Drop the weights whose adaptive sum of squared gradients is below arg when loading and saving "
+                       "models. Only applies where the sums are known: to --save_resume models and while learning "
+                       "with adaptive updates"))
+        .add(make_option("attach_weights", all.attach_weights_name)
+                 .help("Use the weights published under this name, read only, and follow their updates. Requires -t"))
+        .add(make_option("huge_pages", huge_pages)
+                 .default_value("none")
+                 .help("Page size of dense weights: none, transparent, 2mb or 1gb. Reserved 2mb and 1gb pages fall "
+                       "back to smaller ones when none are left"))
+        .add(make_option("numa", numa)
+                 .default_value("none")
+                 .help("NUMA placement of dense weights: none, interleave over the nodes, or local to the learner"))
+        .add(make_option("lazy_weights", all.lazy_weights)
+                 .help("Set random or initial dense weights as their pages are first used rather than all at start up. "
+                       "Requires userfaultfd, and is not combined with --huge_pages or --numa"))
+        .add(make_option("prefetch_weights", prefetch_distance)
+                 .help("Prefetch dense weights this many features ahead of their use, 0 not to. When not given, weights "
+                       "too large for the cache are prefetched"));
     all.options->add_and_parse(weight_args);
+    all.requested_weight_allocation.pages = VW::parse_huge_pages(huge_pages);
+    all.requested_weight_allocation.numa = VW::parse_numa_policy(numa);
+    if (all.options->was_supplied("prefetch_weights")) all.weight_prefetch_distance = prefetch_distance;
+    if (all.sparse_weights_limit > 0 && !all.weights.sparse) THROW("--sparse_weights_limit requires --sparse_weights");
 
     std::string span_server_arg;
     int span_server_port_arg;
-    // bool threads_arg;
     size_t unique_id_arg;
     size_t total_arg;
     size_t node_arg;
+    size_t local_total_arg;
+    size_t local_node_arg;
+    size_t span_total_arg;
+    size_t span_node_arg;
+    size_t ring_bytes_arg;
+    std::string transport_arg;
+    float allreduce_timeout_arg;
+    std::string ps_servers_arg;
+    uint64_t ps_sync_interval_arg;
     option_group_definition parallelization_args("Parallelization options");
     parallelization_args
         .add(make_option("span_server", span_server_arg).help("Location of server for setting up spanning tree"))
-        //(make_option("threads", threads_arg).help("Enable multi-threading")) Unused option?
+        .add(make_option("threads", all.learner_threads)
+                 .default_value(1)
+                 .help("Number of threads learning from the parsed examples at once, updating the shared weights "
+                       "without locking, or predicting multiline examples with -t"))
         .add(make_option("unique_id", unique_id_arg).default_value(0).help("unique id used for cluster parallel jobs"))
         .add(
             make_option("total", total_arg).default_value(1).help("total number of nodes used in cluster parallel job"))
         .add(make_option("node", node_arg).default_value(0).help("node number in cluster parallel job"))
+        .add(make_option("local_total", local_total_arg)
+                 .default_value(1)
+                 .help("Number of nodes of the cluster parallel job in this process, on threads of their own, which "
+                       "allreduce in shared memory before the first of them allreduces with the other processes"))
+        .add(make_option("local_node", local_node_arg)
+                 .default_value(0)
+                 .help("Number of this node among the nodes of the job in this process"))
+        .add(make_option("span_total", span_total_arg)
+                 .help("Number of processes in the spanning tree with --local_total, which are its nodes"))
+        .add(make_option("span_node", span_node_arg)
+                 .help("Number of this process in the spanning tree with --local_total"))
         .add(make_option("span_server_port", span_server_port_arg)
                  .default_value(26543)
-                 .help("Port of the server for setting up spanning tree"));
+                 .help("Port of the server for setting up spanning tree"))
+        .add(make_option("ring_allreduce_bytes", ring_bytes_arg)
+                 .default_value(0)
+                 .help("Allreduce payloads of at least this many bytes around a ring of the nodes instead of up and "
+                       "down the spanning tree. 0 never does"))
+        .add(make_option("node_transport", transport_arg)
+                 .default_value("tcp")
+                 .help("Transport between the nodes of allreduce: tcp, or rdma in a build with USE_RSOCKETS. Falls "
+                       "back to tcp without an RDMA device"))
+        .add(make_option("allreduce_timeout", allreduce_timeout_arg)
+                 .default_value(0.f)
+                 .help("Seconds to wait for another node during allreduce before failing, so a lost node ends the job "
+                       "instead of hanging it. 0 waits forever"))
+        .add(make_option("ps_servers", ps_servers_arg)
+                 .help("Comma separated host:port of parameter servers to exchange weights with asynchronously, "
+                       "instead of allreduce, each holding the weights hashed to it"))
+        .add(make_option("ps_sync_interval", ps_sync_interval_arg)
+                 .default_value(1000)
+                 .help("Number of examples between exchanges of the changed weights with the parameter servers"));
     all.options->add_and_parse(parallelization_args);
+    if (all.learner_threads == 0) THROW("--threads must be at least 1");
+    if (all.sparse_weights_limit > 0 && all.learner_threads > 1)
+      THROW("--sparse_weights_limit can't be used with --threads, weights can't be evicted while they are looked up");
+    if (allreduce_timeout_arg < 0.f) THROW("--allreduce_timeout can't be negative");
 
     // total, unique_id and node must be specified together.
     if ((all.options->was_supplied("total") || all.options->was_supplied("node") ||
@@ -1420,11 +1851,39 @@ vw& parse_args(
             all.options->was_supplied("unique_id")))
     { THROW("you must specificy unique_id, total, and node if you specify any"); }
 
-    if (all.options->was_supplied("span_server"))
+    if (all.options->was_supplied("local_total") || all.options->was_supplied("local_node"))
+    {
+      if (!all.options->was_supplied("span_server") || !all.options->was_supplied("span_total") ||
+          !all.options->was_supplied("span_node") || !all.options->was_supplied("total"))
+        THROW("--local_total and --local_node need --span_server, --span_total, --span_node, --total, --node and "
+              "--unique_id");
+      if (local_node_arg >= local_total_arg) THROW("--local_node must be below --local_total");
+      if (span_node_arg >= span_total_arg) THROW("--span_node must be below --span_total");
+      if (node_arg >= total_arg) THROW("--node must be below --total");
+      all.all_reduce_type = AllReduceType::Hierarchical;
+      all.all_reduce = new AllReduceHierarchical(span_server_arg, span_server_port_arg, unique_id_arg, total_arg,
+          node_arg, local_total_arg, local_node_arg, span_total_arg, span_node_arg, all.logger.quiet, ring_bytes_arg,
+          VW::parse_allreduce_transport(transport_arg), allreduce_timeout_arg);
+    }
+    else if (all.options->was_supplied("span_server"))
     {
       all.all_reduce_type = AllReduceType::Socket;
-      all.all_reduce = new AllReduceSockets(
-          span_server_arg, span_server_port_arg, unique_id_arg, total_arg, node_arg, all.logger.quiet);
+      all.all_reduce = new AllReduceSockets(span_server_arg, span_server_port_arg, unique_id_arg, total_arg, node_arg,
+          all.logger.quiet, ring_bytes_arg, VW::parse_allreduce_transport(transport_arg), allreduce_timeout_arg);
+    }
+
+    if (all.options->was_supplied("ps_servers"))
+    {
+      if (all.options->was_supplied("span_server")) THROW("--ps_servers can't be used with --span_server");
+      if (all.weights.sparse && all.learner_threads > 1)
+        THROW("--ps_servers with --sparse_weights can't be used with --threads, sparse weights can't be iterated while "
+              "they are added to");
+      std::vector<std::string> servers;
+      std::stringstream list(ps_servers_arg);
+      for (std::string server; std::getline(list, server, ',');)
+        if (!server.empty()) servers.push_back(server);
+      all.parameter_server = std::make_shared<VW::parameter_server_client>(
+          servers, ps_sync_interval_arg, all.logger.quiet);
     }
 
     parse_diagnostics(*all.options.get(), all);
@@ -1561,9 +2020,18 @@ void parse_modules(
     options_i& options, vw& all, bool interactions_settings_duplicated, std::vector<std::string>& dictionary_nses)
 {
   option_group_definition rand_options("Randomization options");
-  rand_options.add(make_option("random_seed", all.random_seed).help("seed random number generator"));
+  std::string random_generator("rand48");
+  rand_options.add(make_option("random_seed", all.random_seed).help("seed random number generator"))
+      .add(make_option("random_generator", random_generator)
+               .help("generator of the bootstrap weights {rand48,philox}. With philox the numbers of an example are "
+                     "drawn from a stream of its own, counted from its index, so that they do not depend on the "
+                     "examples before it"));
   options.add_and_parse(rand_options);
   all.get_random_state()->set_random_state(all.random_seed);
+  if (random_generator == "philox")
+    all.counter_based_random = true;
+  else if (random_generator != "rand48")
+    THROW("--random_generator must be rand48 or philox, not " << random_generator);
 
   parse_feature_tweaks(options, all, interactions_settings_duplicated, dictionary_nses);  // feature tweaks
 
@@ -1575,6 +2043,22 @@ void parse_modules(
 
   parse_reductions(options, all);
 
+  if (!all.quantized_regressor_name.empty() &&
+      std::find(all.enabled_reductions.begin(), all.enabled_reductions.end(), "gd") == all.enabled_reductions.end())
+    THROW("--save_quantized requires the gd base learner");
+  if (all.write_weight_runs &&
+      std::find(all.enabled_reductions.begin(), all.enabled_reductions.end(), "gd") == all.enabled_reductions.end())
+    THROW("--write_weight_runs requires the gd base learner");
+  if (all.write_weight_image &&
+      std::find(all.enabled_reductions.begin(), all.enabled_reductions.end(), "gd") == all.enabled_reductions.end())
+    THROW("--write_weight_image requires the gd base learner");
+  if (all.write_resume_columns &&
+      std::find(all.enabled_reductions.begin(), all.enabled_reductions.end(), "gd") == all.enabled_reductions.end())
+    THROW("--write_resume_columns requires the gd base learner");
+  if ((all.prune_weights != 0.f || all.prune_adaptive != 0.f) &&
+      std::find(all.enabled_reductions.begin(), all.enabled_reductions.end(), "gd") == all.enabled_reductions.end())
+    THROW("--prune_weights and --prune_adaptive require the gd base learner");
+
   if (!all.logger.quiet)
   {
     all.trace_message << "Num weight bits = " << all.num_bits << endl;
@@ -1585,15 +2069,67 @@ void parse_modules(
   }
 }
 
+void parse_shared_weights(vw& all)
+{
+  if (all.attach_weights_name.empty() && all.publish_weights_name.empty()) return;
+  if (all.weights.sparse) THROW("--attach_weights and --publish_weights require dense weights");
+
+  if (!all.attach_weights_name.empty())
+  {
+    if (all.training) THROW("--attach_weights requires -t, attached weights are read only");
+    all.attached_weights = VW::shared_weights::attach(all.attach_weights_name, all.weights.dense_weights);
+    if (!all.logger.quiet)
+    {
+      all.trace_message << "attached to weights " << all.attach_weights_name << ", generation "
+                        << all.attached_weights->generation() << endl;
+    }
+  }
+  if (!all.publish_weights_name.empty())
+  {
+    all.published_weights =
+        VW::shared_weights::publisher(all.publish_weights_name, all.weights.dense_weights.mask() + 1);
+  }
+}
+
+// Daemons print to each connection as its examples finish, in the format it sent them in, and keep the printers of
+// enable_sources.
+void enable_prediction_output(vw& all)
+{
+  if (all.daemon)
+  {
+    if (all.output_queue_size > 0 || all.binary_predictions)
+      all.trace_message << "Warning: --output_queue and --prediction_format are ignored by daemons" << endl;
+    return;
+  }
+
+  if (all.binary_predictions) all.print_by_ref = binary_print_result_by_ref;
+  if (all.output_queue_size == 0) return;
+
+  all.output_thread =
+      std::make_shared<VW::output_thread>(all.output_queue_size, all.print_by_ref, all.print_text_by_ref);
+  for (auto& sink : all.final_prediction_sink) sink = VW::output_thread::wrap(all.output_thread, std::move(sink));
+  all.raw_prediction = VW::output_thread::wrap(all.output_thread, std::move(all.raw_prediction));
+  all.print_by_ref = VW::print_result_on_output_thread;
+  all.print_text_by_ref = VW::print_text_on_output_thread;
+}
+
 void parse_sources(options_i& options, vw& all, io_buf& model, bool skipModelLoad)
 {
   if (!skipModelLoad)
+  {
     load_input_model(all, model);
+    parse_shared_weights(all);
+  }
   else
     model.close_file();
 
   auto parsed_source_options = parse_source(all, options);
   enable_sources(all, all.logger.quiet, all.numpasses, parsed_source_options);
+  enable_prediction_output(all);
+
+  // the interactions are final once the model is loaded
+  if (all.interactions.size() >= INTERACTIONS::MIN_PLANNED_INTERACTIONS)
+    all.interaction_plan = VW::make_unique<INTERACTIONS::interaction_plan>(all.interactions);
 
   // force wpp to be a power of 2 to avoid 32-bit overflow
   uint32_t i = 0;
@@ -1714,8 +2250,16 @@ vw* initialize(
 
 vw* initialize(std::unique_ptr<options_i, options_deleter_type> options, io_buf* model, bool skipModelLoad,
     trace_message_t trace_listener, void* trace_context)
+{
+  return initialize(std::move(options), model, skipModelLoad, trace_listener, trace_context, nullptr);
+}
+
+vw* initialize(std::unique_ptr<options_i, options_deleter_type> options, io_buf* model, bool skipModelLoad,
+    trace_message_t trace_listener, void* trace_context, std::shared_ptr<std::vector<char>> memory_cache)
 {
   vw& all = parse_args(std::move(options), trace_listener, trace_context);
+  // read in place of the data by enable_sources
+  all.example_parser->memory_cache = std::move(memory_cache);
 
   try
   {
@@ -1740,6 +2284,7 @@ vw* initialize(std::unique_ptr<options_i, options_deleter_type> options, io_buf*
 
     // we must delay so parse_mask is fully defined.
     for (size_t id = 0; id < dictionary_nses.size(); id++) parse_dictionary_argument(all, dictionary_nses[id]);
+    compile_parse_ignore(all);
 
     all.options->check_unregistered();
 
@@ -1822,6 +2367,28 @@ vw* initialize(
   return initialize(std::move(options), model, skipModelLoad, trace_listener, trace_context);
 }
 
+vw* initialize_with_memory_cache(const std::string& args, std::shared_ptr<std::vector<char>> memory_cache)
+{
+  int argc = 0;
+  char** argv = to_argv(args, argc);
+  vw* ret = nullptr;
+
+  try
+  {
+    std::unique_ptr<options_i, options_deleter_type> options(
+        new config::options_boost_po(argc, argv), [](VW::config::options_i* ptr) { delete ptr; });
+    ret = initialize(std::move(options), nullptr, false, nullptr, nullptr, std::move(memory_cache));
+  }
+  catch (...)
+  {
+    free_args(argc, argv);
+    throw;
+  }
+
+  free_args(argc, argv);
+  return ret;
+}
+
 // Create a new VW instance while sharing the model with another instance
 // The extra arguments will be appended to those of the other VW instance
 vw* seed_vw_model(vw* vw_model, const std::string extra_args, trace_message_t trace_listener, void* trace_context)
@@ -1854,6 +2421,31 @@ vw* seed_vw_model(vw* vw_model, const std::string extra_args, trace_message_t tr
   return new_model;
 }
 
+vw* seed_vw_learner(vw& vw_model)
+{
+  // The sources and outputs are those of vw_model, which parses and finishes the examples.
+  const std::set<std::string> skipped_groups = {
+      "Input options", "Output options", "Output model", "Parallelization options"};
+  std::set<std::string> skipped_options = {"initial_regressor", "quiet"};
+  for (auto const& tinted_groups : vw_model.options->get_collection_of_options())
+    for (auto const& group : tinted_groups.second)
+      if (skipped_groups.count(group.m_name) > 0)
+        for (auto const& option : group.m_options) skipped_options.insert(option->m_name);
+
+  options_serializer_boost_po serializer;
+  for (auto const& option : vw_model.options->get_all_options())
+    if (vw_model.options->was_supplied(option->m_name) && skipped_options.count(option->m_name) == 0)
+      serializer.add(*option);
+
+  vw* new_model = VW::initialize(serializer.str() + " --no_stdin --quiet", nullptr, true /* skipModelLoad */);
+  free_it(new_model->sd);
+
+  new_model->weights.shallow_copy(vw_model.weights);
+  new_model->sd = vw_model.sd;
+  new_model->example_parser->_shared_data = new_model->sd;
+  return new_model;
+}
+
 void sync_stats(vw& all)
 {
   if (all.all_reduce != nullptr)
@@ -1875,6 +2467,9 @@ void sync_stats(vw& all)
 
 void finish(vw& all, bool delete_all)
 {
+  // the predictions still queued are written before the summary
+  if (all.output_thread != nullptr) all.output_thread->flush();
+
   // also update VowpalWabbit::PerformanceStatistics::get() (vowpalwabbit.cpp)
   if (!all.logger.quiet && !all.options->was_supplied("audit_regressor"))
   {
@@ -1922,8 +2517,36 @@ void finish(vw& all, bool delete_all)
 
     all.trace_message << endl << "total feature number = " << all.sd->total_features;
     if (all.sd->queries > 0) all.trace_message << endl << "total queries = " << all.sd->queries;
+    if (all.example_parser->hash_cache != nullptr)
+    {
+      const auto& cache = *all.example_parser->hash_cache;
+      const uint64_t lookups = cache.hits() + cache.misses();
+      all.trace_message << endl
+                        << "hash cache hit rate = " << (lookups > 0 ? 100. * cache.hits() / lookups : 0.) << "% of "
+                        << lookups << " lookups";
+    }
+    if (all.weights.sparse && all.weights.sparse_weights.limit() > 0)
+    {
+      all.trace_message << endl
+                        << "sparse weights evicted = " << all.weights.sparse_weights.evicted() << " in "
+                        << all.weights.sparse_weights.evictions() << " evictions";
+    }
+    if (all.prediction_cache != nullptr)
+    {
+      const auto& cache = *all.prediction_cache;
+      const uint64_t lookups = cache.hits() + cache.misses();
+      all.trace_message << endl
+                        << "prediction cache hit rate = " << (lookups > 0 ? 100. * cache.hits() / lookups : 0.)
+                        << "% of " << lookups << " lookups";
+    }
     all.trace_message << endl;
   }
+  if (all.example_parser->daemon_server != nullptr)
+    all.example_parser->daemon_server->report_requests(all.trace_message);
+  if (all.profiler != nullptr) all.profiler->report(all.trace_message, all.sd->example_number);
+#ifdef VW_PROFILE_ALLOCATIONS
+  VW::report_allocations(all.trace_message, all.sd->example_number);
+#endif
 
   // implement finally.
   // finalize_regressor can throw if it can't write the file.
@@ -1932,6 +2555,8 @@ void finish(vw& all, bool delete_all)
   bool finalize_regressor_exception_thrown = false;
   try
   {
+    // The saved model is the one on the parameter servers, as of the end of this worker.
+    if (all.parameter_server != nullptr && !all.early_terminate) all.parameter_server->sync(all, true);
     finalize_regressor(all, all.final_regressor_name);
   }
   catch (vw_exception& e)
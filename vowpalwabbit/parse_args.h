@@ -10,6 +10,11 @@ struct input_options
 {
   bool daemon;
   bool foreground;
+  bool daemon_event_loop = false;
+  std::string reload_model;
+  size_t metrics_port = 0;
+  std::string trace_requests;
+  size_t trace_requests_size = 10000;
   size_t port;
   std::string pid_file;
   std::string port_file;
@@ -20,8 +25,23 @@ struct input_options
   bool dsjson;
   bool kill_cache;
   bool compressed;
+  bool mmap = false;
+  size_t read_ahead_buffers = 0;
+  size_t compression_threads = 1;
+  std::string cache_compression;
+  size_t cache_format = 2;
+  size_t cache_block_size = 1024;
+  bool cache_dedup = false;
+  bool cache_shuffle = false;
+  bool in_memory = false;
   bool chain_hash_json;
   bool flatbuffer = false;
+  size_t flatbuffer_limit = 1024;  // largest flatbuffer object read, in MB
+  bool arrow = false;
+  bool parquet = false;
+  std::string columnar_schema;
+  VW::io::kafka_options kafka;
+  std::vector<std::string> extra_data_files;  // read after --data, from the further positional args
 };
 
 // trace listener + context need to be passed at initialization to capture all messages.
@@ -8,6 +8,13 @@
 
 using dispatch_fptr = std::function<void(vw&, const v_array<example*>&)>;
 
+inline int read_examples(vw& all, v_array<example*>& examples)
+{
+  VW::stage_timer timer(all.profiler != nullptr ? &all.profiler->parse : nullptr);
+  VW_ALLOCATION_SITE(parser);
+  return all.example_parser->reader(&all, examples);
+}
+
 inline void parse_dispatch(vw& all, dispatch_fptr dispatch)
 {
   v_array<example*> examples = v_init<example*>();
@@ -19,7 +26,7 @@ inline void parse_dispatch(vw& all, dispatch_fptr dispatch)
     {
       examples.push_back(&VW::get_unused_example(&all));  // need at least 1 example
       if (!all.do_reset_source && example_number != all.pass_length && all.max_examples > example_number &&
-          all.example_parser->reader(&all, examples) > 0)
+          read_examples(all, examples) > 0)
       {
         VW::setup_examples(all, examples);
         example_number += examples.size();
@@ -64,6 +71,7 @@ inline void parse_dispatch(vw& all, dispatch_fptr dispatch)
     // Stash the exception so it can be thrown on the main thread.
     all.example_parser->exc_ptr = std::current_exception();
   }
+  flush_dispatch_batch(*all.example_parser);
   lock_done(*all.example_parser);
   examples.delete_v();
 }
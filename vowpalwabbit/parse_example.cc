@@ -4,6 +4,26 @@
 
 #include <cmath>
 #include <cctype>
+#include <cstring>
+#include <algorithm>
+
+#if !defined(VW_NO_INLINE_SIMD)
+#  if !defined(__SSE2__) && (defined(_M_AMD64) || defined(_M_X64))
+#    define __SSE2__
+#  endif
+
+#  if defined(__ARM_NEON__) && defined(__aarch64__)
+#    include <arm_neon.h>
+#  elif defined(__AVX2__)
+#    include <immintrin.h>
+#  elif defined(__SSE2__)
+#    include <emmintrin.h>
+#  endif
+#endif
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
 #include "parse_example.h"
 #include "hash.h"
 #include "unique_sort.h"
@@ -12,9 +32,14 @@
 #include "vw_string_view.h"
 
 size_t read_features(vw* all, char*& line, size_t& num_chars)
+{
+  return read_features(*all->example_parser->input, line, num_chars);
+}
+
+size_t read_features(io_buf& input, char*& line, size_t& num_chars)
 {
   line = nullptr;
-  size_t num_chars_initial = all->example_parser->input->readto(line, '\n');
+  size_t num_chars_initial = input.readto(line, '\n');
   if (num_chars_initial < 1) return num_chars_initial;
   num_chars = num_chars_initial;
   if (line[0] == '\xef' && num_chars >= 3 && line[1] == '\xbb' && line[2] == '\xbf')
@@ -40,11 +65,133 @@ int read_features_string(vw* all, v_array<example*>& examples)
   return (int)num_chars_initial;
 }
 
+// Finds the characters which end feature and namespace names, ' ', '\t', ':', '|' and '\r', a 64 byte block of the
+// line at a time. The delimiters of the current block are kept as a bitmap, so that finding the end of a name does
+// not look at its characters again.
+class delimiter_scanner
+{
+public:
+  explicit delimiter_scanner(VW::string_view line) : _line(line) {}
+
+  // Index of the first delimiter at or after pos, or the size of the line if there is none.
+  size_t next(size_t pos)
+  {
+    while (pos < _line.size())
+    {
+      const size_t block = pos - pos % BLOCK_SIZE;
+      if (block != _block)
+      {
+        _block = block;
+        _delimiters = scan_block(_line.begin() + block, std::min(BLOCK_SIZE, _line.size() - block));
+      }
+      const uint64_t delimiters = _delimiters & (~uint64_t(0) << (pos - block));
+      if (delimiters != 0) return block + lowest_set_bit(delimiters);
+      pos = block + BLOCK_SIZE;
+    }
+    return _line.size();
+  }
+
+private:
+  static constexpr size_t BLOCK_SIZE = 64;
+
+  static int lowest_set_bit(uint64_t n)
+  {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, n);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(n);
+#endif
+  }
+
+  static bool is_delimiter(char c) { return c == ' ' || c == '\t' || c == ':' || c == '|' || c == '\r'; }
+
+  static uint64_t scan_block(const char* p, size_t len)
+  {
+    if (len < BLOCK_SIZE)
+    {
+      // Only the last block of a line is short. Bytes past the line must not be read, so it is padded with a byte
+      // which is no delimiter.
+      char padded[BLOCK_SIZE];
+      memcpy(padded, p, len);
+      memset(padded + len, 'a', BLOCK_SIZE - len);
+      return scan_full_block(padded);
+    }
+    return scan_full_block(p);
+  }
+
+#if !defined(VW_NO_INLINE_SIMD) && defined(__ARM_NEON__) && defined(__aarch64__)
+  static uint64_t scan_full_block(const char* p)
+  {
+    static const uint8_t bit_values[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vld1q_u8(bit_values);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; i += 16)
+    {
+      const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+      uint8x16_t eq = vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t')));
+      eq = vorrq_u8(eq, vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')), vceqq_u8(v, vdupq_n_u8('|'))));
+      eq = vandq_u8(vorrq_u8(eq, vceqq_u8(v, vdupq_n_u8('\r'))), bits);
+      const uint64_t low = vaddv_u8(vget_low_u8(eq));
+      const uint64_t high = vaddv_u8(vget_high_u8(eq));
+      mask |= (low | (high << 8)) << i;
+    }
+    return mask;
+  }
+#elif !defined(VW_NO_INLINE_SIMD) && defined(__AVX2__)
+  static uint64_t scan_full_block(const char* p)
+  {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; i += 32)
+    {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      __m256i eq = _mm256_or_si256(
+          _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+      eq = _mm256_or_si256(eq,
+          _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('|'))));
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+      mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(eq))) << i;
+    }
+    return mask;
+  }
+#elif !defined(VW_NO_INLINE_SIMD) && defined(__SSE2__)
+  static uint64_t scan_full_block(const char* p)
+  {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; i += 16)
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+      eq = _mm_or_si128(
+          eq, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8('|'))));
+      eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+      mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(eq))) << i;
+    }
+    return mask;
+  }
+#else
+  static uint64_t scan_full_block(const char* p)
+  {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; i++) mask |= static_cast<uint64_t>(is_delimiter(p[i])) << i;
+    return mask;
+  }
+#endif
+
+  VW::string_view _line;
+  size_t _block = SIZE_MAX;
+  uint64_t _delimiters = 0;
+};
+
+constexpr size_t delimiter_scanner::BLOCK_SIZE;
+
 template <bool audit>
 class TC_parser
 {
 public:
   VW::string_view _line;
+  delimiter_scanner _delimiters;
   size_t _read_idx;
   float _cur_channel_v;
   bool _new_index;
@@ -55,11 +202,14 @@ public:
   float _v;
   bool _redefine_some;
   std::array<unsigned char, NUM_NAMESPACES>* _redefine;
+  bool _parse_ignore_some;
+  std::array<bool, NUM_NAMESPACES>* _parse_ignore;
   parser* _p;
   example* _ae;
   std::array<uint64_t, NUM_NAMESPACES>* _affix_features;
   std::array<bool, NUM_NAMESPACES>* _spelling_features;
   v_array<char> _spelling;
+  std::string _audit_name;  // the name of a feature with a string value, reused from feature to feature
   uint32_t _hash_seed;
   uint64_t _parse_mask;
 
@@ -85,6 +235,12 @@ public:
     }
   }
 
+  inline uint64_t hash_name(VW::string_view name, uint64_t seed)
+  {
+    if (_p->hash_cache != nullptr) { return _p->hash_cache->hash(_p->hasher, _index, name, seed); }
+    return _p->hasher(name.begin(), name.length(), seed);
+  }
+
   inline VW::string_view stringFeatureValue(VW::string_view sv)
   {
     size_t start_idx = sv.find_first_not_of(" \t\r\n");
@@ -138,10 +294,7 @@ public:
   inline VW::string_view read_name()
   {
     size_t name_start = _read_idx;
-    while (!(_read_idx >= _line.size() || _line[_read_idx] == ' ' || _line[_read_idx] == ':' ||
-        _line[_read_idx] == '\t' || _line[_read_idx] == '|' || _line[_read_idx] == '\r'))
-      ++_read_idx;
-
+    _read_idx = _delimiters.next(_read_idx);
     return _line.substr(name_start, _read_idx - name_start);
   }
 
@@ -176,14 +329,12 @@ public:
       if (!string_feature_value.empty())
       {
         // chain hash is hash(feature_value, hash(feature_name, namespace_hash)) & parse_mask
-        word_hash = (_p->hasher(string_feature_value.begin(), string_feature_value.length(),
-                         _p->hasher(feature_name.begin(), feature_name.length(), _channel_hash)) &
-            _parse_mask);
+        word_hash = (hash_name(string_feature_value, hash_name(feature_name, _channel_hash)) & _parse_mask);
       }
       // Case where string:float
       else if (!feature_name.empty())
       {
-        word_hash = (_p->hasher(feature_name.begin(), feature_name.length(), _channel_hash) & _parse_mask);
+        word_hash = (hash_name(feature_name, _channel_hash) & _parse_mask);
       }
       // Case where :float
       else
@@ -199,13 +350,14 @@ public:
       {
         if (!string_feature_value.empty())
         {
-          std::stringstream ss;
-          ss << feature_name << "^" << string_feature_value;
-          fs.space_names.push_back(audit_strings_ptr(new audit_strings(_base.to_string(), ss.str())));
+          _audit_name.assign(feature_name.begin(), feature_name.size());
+          _audit_name.push_back('^');
+          _audit_name.append(string_feature_value.begin(), string_feature_value.size());
+          fs.space_names.push_back(_p->audit_strings.get(_base, _audit_name));
         }
         else
         {
-          fs.space_names.push_back(audit_strings_ptr(new audit_strings(_base.to_string(), feature_name.to_string())));
+          fs.space_names.push_back(_p->audit_strings.get(_base, feature_name));
         }
       }
 
@@ -269,7 +421,8 @@ public:
         }
 
         VW::string_view spelling_strview(_spelling.begin(), _spelling.size());
-        word_hash = hashstring(spelling_strview.begin(), spelling_strview.length(), (uint64_t)_channel_hash);
+        word_hash =
+            _p->string_hasher(spelling_strview.begin(), spelling_strview.length(), (uint64_t)_channel_hash);
         spell_fs.push_back(_v, word_hash);
         if (audit)
         {
@@ -362,13 +515,27 @@ public:
       if (_ae->feature_space[_index].size() == 0) _new_index = true;
       VW::string_view name = read_name();
       if (audit) { _base = name; }
-      _channel_hash = _p->hasher(name.begin(), name.length(), this->_hash_seed);
+      _channel_hash = hash_name(name, this->_hash_seed);
       nameSpaceInfoValue();
     }
   }
 
+  // Makes room at once for the features up to the next namespace, one at most per space or tab before it, so that a
+  // brand new example does not grow its storage a feature at a time. The spare storage of a reused example usually
+  // suffices and the separators are not counted then.
+  inline void reserveFeatures()
+  {
+    features& fs = _ae->feature_space[_index];
+    const size_t end = std::min(_line.find('|', _read_idx), _line.size());
+    const size_t spare = static_cast<size_t>(fs.values.end_array - fs.values.end());
+    if (spare >= (end - _read_idx + 1) / 2) return;
+    fs.reserve(std::count_if(
+        _line.begin() + _read_idx, _line.begin() + end, [](char c) { return c == ' ' || c == '\t'; }));
+  }
+
   inline void listFeatures()
   {
+    reserveFeatures();
     while ((_read_idx < _line.size()) && (_line[_read_idx] == ' ' || _line[_read_idx] == '\t'))
     {
       // listFeatures --> ' ' MaybeFeature ListFeatures
@@ -382,6 +549,14 @@ public:
     }
   }
 
+  // Skips the features of a namespace of vw::parse_ignore up to the next namespace, setup_example would drop them.
+  inline bool skipNameSpace(unsigned char index)
+  {
+    if (!_parse_ignore_some || !(*_parse_ignore)[index]) return false;
+    _read_idx = std::min(_line.find('|', _read_idx), _line.size());
+    return true;
+  }
+
   inline void nameSpace()
   {
     _cur_channel_v = 1.0;
@@ -393,6 +568,7 @@ public:
     {
       // NameSpace --> ListFeatures
       _index = (unsigned char)' ';
+      if (skipNameSpace(_index)) return;
       if (_ae->feature_space[_index].size() == 0) _new_index = true;
       if (audit)
       {
@@ -406,6 +582,8 @@ public:
     else if (_line[_read_idx] != ':')
     {
       // NameSpace --> NameSpaceInfo ListFeatures
+      unsigned char index = (unsigned char)(_line[_read_idx]);
+      if (skipNameSpace(_redefine_some ? (*_redefine)[index] : index)) return;
       nameSpaceInfo();
       listFeatures();
     }
@@ -432,15 +610,17 @@ public:
     }
   }
 
-  TC_parser(VW::string_view line, vw& all, example* ae) : _line(line)
+  TC_parser(VW::string_view line, vw& all, parser* p, example* ae) : _line(line), _delimiters(line)
   {
     _spelling = v_init<char>();
     if (!_line.empty())
     {
       this->_read_idx = 0;
-      this->_p = all.example_parser;
+      this->_p = p;
       this->_redefine_some = all.redefine_some;
       this->_redefine = &all.redefine;
+      this->_parse_ignore_some = all.parse_ignore_some && !all.example_parser->write_cache;
+      this->_parse_ignore = &all.parse_ignore;
       this->_ae = ae;
       this->_affix_features = &all.affix_features;
       this->_spelling_features = &all.spelling_features;
@@ -454,11 +634,16 @@ public:
 
 void substring_to_example(vw* all, example* ae, VW::string_view example)
 {
-  all->example_parser->lbl_parser.default_label(&ae->l);
+  substring_to_example(all, all->example_parser, ae, example);
+}
+
+void substring_to_example(vw* all, parser* p, example* ae, VW::string_view example)
+{
+  p->lbl_parser.default_label(&ae->l);
 
   size_t bar_idx = example.find('|');
 
-  all->example_parser->words.clear();
+  p->words.clear();
   if (bar_idx != 0)
   {
     VW::string_view label_space(example);
@@ -471,28 +656,27 @@ void substring_to_example(vw* all, example* ae, VW::string_view example)
     size_t tab_idx = label_space.find('\t');
     if (tab_idx != VW::string_view::npos) { label_space.remove_prefix(tab_idx + 1); }
 
-    tokenize(' ', label_space, all->example_parser->words);
-    if (all->example_parser->words.size() > 0 &&
-        (all->example_parser->words.back().end() == label_space.end() ||
-            all->example_parser->words.back().front() == '\''))  // The last field is a tag, so record and strip it off
+    tokenize(' ', label_space, p->words);
+    if (p->words.size() > 0 &&
+        (p->words.back().end() == label_space.end() ||
+            p->words.back().front() == '\''))  // The last field is a tag, so record and strip it off
     {
-      VW::string_view tag = all->example_parser->words.back();
-      all->example_parser->words.pop_back();
+      VW::string_view tag = p->words.back();
+      p->words.pop_back();
       if (tag.front() == '\'') tag.remove_prefix(1);
       push_many(ae->tag, tag.begin(), tag.size());
     }
   }
 
-  if (!all->example_parser->words.empty())
-    all->example_parser->lbl_parser.parse_label(all->example_parser, all->example_parser->_shared_data, &ae->l,
-        all->example_parser->words, ae->_reduction_features);
+  if (!p->words.empty())
+    p->lbl_parser.parse_label(p, p->_shared_data, &ae->l, p->words, ae->_reduction_features);
 
   if (bar_idx != VW::string_view::npos)
   {
     if (all->audit || all->hash_inv)
-      TC_parser<true> parser_line(example.substr(bar_idx), *all, ae);
+      TC_parser<true> parser_line(example.substr(bar_idx), *all, p, ae);
     else
-      TC_parser<false> parser_line(example.substr(bar_idx), *all, ae);
+      TC_parser<false> parser_line(example.substr(bar_idx), *all, p, ae);
   }
 }
 
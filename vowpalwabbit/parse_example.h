@@ -16,6 +16,8 @@ typedef enum
 } FeatureInputType;
 
 void substring_to_example(vw* all, example* ae, VW::string_view example);
+// Same as above but tokenizer, label parser and hasher state are taken from p instead of all->example_parser.
+void substring_to_example(vw* all, parser* p, example* ae, VW::string_view example);
 
 namespace VW
 {
@@ -28,3 +30,5 @@ void read_lines(vw* all, const char* line, size_t len,
 
 int read_features_string(vw* all, v_array<example*>& examples);
 size_t read_features(vw* all, char*& line, size_t& num_chars);
+// Reads the next line of input as read_features(all, ...) reads it from the input of all.
+size_t read_features(io_buf& input, char*& line, size_t& num_chars);
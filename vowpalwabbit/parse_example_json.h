@@ -719,6 +719,12 @@ public:
 
     array_hash = ctx.CurrentNamespace().namespace_hash;
 
+    // The numbers up to the closing bracket are the features, one more than the commas between them.
+    const char* begin = ctx.stream->src_;
+    const char* end = static_cast<const char*>(memchr(begin, ']', ctx.stream_end - begin));
+    if (end != nullptr && std::find(begin, end, '{') == end)
+      ctx.CurrentNamespace().ftrs->reserve(std::count(begin, end, ',') + 1);
+
     return this;
   }
 
@@ -770,7 +776,7 @@ struct IgnoreState : BaseState<audit>
 };
 
 template <bool audit>
-class DefaultState : public BaseState<audit>
+class DefaultState final : public BaseState<audit>
 {
 public:
   DefaultState() : BaseState<audit>("Default") {}
@@ -860,6 +866,54 @@ public:
     return &ctx.ignore_state;
   }
 
+  // Whether the object or array after the key of the given length holds nothing but the features of the namespace of
+  // the key: no object or array which is the value of a key, a namespace of its own, and no key starting with '_', a
+  // label, a tag or more examples. Ignore then skips it without losing anything setup_example would keep.
+  bool OnlyFeatures(Context<audit>& ctx, rapidjson::SizeType length)
+  {
+    const char* head = ctx.stream->src_ + length + 2;
+    if (head >= ctx.stream_end || *head != ':') return false;
+
+    int depth = 0;
+    char previous = *head++;  // the last character outside of strings which is no white space
+    for (; head < ctx.stream_end; head++)
+    {
+      switch (*head)
+      {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+          continue;
+        case '"':
+        {
+          if (depth == 0) return false;
+          const char* str = ++head;
+          while (head < ctx.stream_end && *head != '"') head += *head == '\\' ? 2 : 1;
+          const char* next = head + 1;
+          while (next < ctx.stream_end && (*next == ' ' || *next == '\t' || *next == '\n' || *next == '\r')) next++;
+          if (next >= ctx.stream_end || (*next == ':' && *str == '_')) return false;
+          break;
+        }
+        case '{':
+        case '[':
+          if (previous == ':' && depth > 0) return false;
+          depth++;
+          break;
+        case '}':
+        case ']':
+          if (--depth == 0) return true;
+          break;
+        case '\0':
+          return false;
+        default:
+          if (depth == 0) return false;
+      }
+      previous = *head;
+    }
+    return false;
+  }
+
   BaseState<audit>* Key(Context<audit>& ctx, const char* str, rapidjson::SizeType length, bool) override
   {
     ctx.key = str;
@@ -930,6 +984,9 @@ public:
       return Ignore(ctx, length);
     }
 
+    if (ctx.parse_ignore_some && ctx.all->parse_ignore[static_cast<unsigned char>(str[0])] && OnlyFeatures(ctx, length))
+      return Ignore(ctx, length);
+
     return this;
   }
 
@@ -1032,7 +1089,7 @@ public:
   BaseState<audit>* Float(Context<audit>& ctx, float f) override
   {
     auto& ns = ctx.CurrentNamespace();
-    ns.AddFeature(f, VW::hash_feature_cstr(*ctx.all, const_cast<char*>(ctx.key), ns.namespace_hash), ctx.key);
+    ns.AddFeature(f, ns.hash_name(ctx.key, ns.namespace_hash) & ctx.all->parse_mask, ctx.key);
 
     return this;
   }
@@ -1395,11 +1452,14 @@ private:
 
 public:
   vw* all;
+  parser* example_parser;  // provides the hash cache and is all->example_parser unless parsing on a worker thread
 
   // last "<key>": encountered
   const char* key;
   rapidjson::SizeType key_length;
 
+  bool parse_ignore_some;  // whether objects and arrays of vw::parse_ignore are skipped
+
   BaseState<audit>* current_state;
   BaseState<audit>* previous_state;
 
@@ -1447,13 +1507,27 @@ public:
     root_state = &default_state;
   }
 
-  void init(vw* pall)
+  // Contexts are reused from line to line, so this resets everything a previous line, possibly one which failed to
+  // parse, may have left behind. The vectors keep their capacity.
+  void init(vw* pall, parser* p)
   {
     all = pall;
+    example_parser = p;
+    parse_ignore_some = pall->parse_ignore_some && !pall->example_parser->write_cache;
     key = " ";
     key_length = 1;
+    current_state = root_state = &default_state;
     previous_state = nullptr;
+    namespace_path.clear();
+    return_path.clear();
+    error_ptr.reset();
+    label_index_state.index = -1;
+    label_object_state.actions.clear();
+    label_object_state.probs.clear();
+    label_object_state.inc.clear();
     label_object_state.init(pall);
+    array_float_state.has_seen_array_start = false;
+    array_uint_state.has_seen_array_start = false;
   }
 
   std::stringstream& error()
@@ -1473,11 +1547,11 @@ public:
   {
     Namespace<audit> n;
     n.feature_group = ns[0];
-    n.namespace_hash = VW::hash_space_cstr(*all, ns);
-    n.ftrs = ex->feature_space.data() + ns[0];
+    n.ftrs = &ex->feature_space[ns[0]];
     n.feature_count = 0;
-
     n.name = ns;
+    n.example_parser = example_parser;
+    n.namespace_hash = n.hash_name(ns, all->hash_seed);
 
     namespace_path.push_back(n);
     return_path.push_back(return_state);
@@ -1518,10 +1592,10 @@ struct VWReaderHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
 {
   Context<audit> ctx;
 
-  void init(vw* all, v_array<example*>* examples, rapidjson::InsituStringStream* stream, const char* stream_end,
-      VW::example_factory_t example_factory, void* example_factory_context)
+  void init(vw* all, parser* p, v_array<example*>* examples, rapidjson::InsituStringStream* stream,
+      const char* stream_end, VW::example_factory_t example_factory, void* example_factory_context)
   {
-    ctx.init(all);
+    ctx.init(all, p);
     ctx.examples = examples;
     ctx.ex = (*examples)[0];
     all->example_parser->lbl_parser.default_label(&ctx.ex->l);
@@ -1532,23 +1606,44 @@ struct VWReaderHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
     ctx.example_factory_context = example_factory_context;
   }
 
-  // virtual dispatch to current state
-  bool Bool(bool v) { return ctx.TransitionState(ctx.current_state->Bool(ctx, v)); }
-  bool Int(int v) { return ctx.TransitionState(ctx.current_state->Float(ctx, (float)v)); }
-  bool Uint(unsigned v) { return ctx.TransitionState(ctx.current_state->Uint(ctx, v)); }
-  bool Int64(int64_t v) { return ctx.TransitionState(ctx.current_state->Float(ctx, (float)v)); }
-  bool Uint64(uint64_t v) { return ctx.TransitionState(ctx.current_state->Float(ctx, (float)v)); }
-  bool Double(double v) { return ctx.TransitionState(ctx.current_state->Float(ctx, (float)v)); }
+  // Most events of a line are features, which the default state handles. Those are dispatched without the virtual call
+  // so that the default state's handlers can be inlined, all others go through the current state.
+  bool Bool(bool v)
+  {
+    if (in_default_state()) return ctx.TransitionState(ctx.default_state.DefaultState<audit>::Bool(ctx, v));
+    return ctx.TransitionState(ctx.current_state->Bool(ctx, v));
+  }
+  bool Int(int v) { return Float((float)v); }
+  bool Uint(unsigned v)
+  {
+    if (in_default_state()) return ctx.TransitionState(ctx.default_state.DefaultState<audit>::Float(ctx, (float)v));
+    return ctx.TransitionState(ctx.current_state->Uint(ctx, v));
+  }
+  bool Int64(int64_t v) { return Float((float)v); }
+  bool Uint64(uint64_t v) { return Float((float)v); }
+  bool Double(double v) { return Float((float)v); }
   bool String(const char* str, SizeType len, bool copy)
   {
+    if (in_default_state())
+    { return ctx.TransitionState(ctx.default_state.DefaultState<audit>::String(ctx, str, len, copy)); }
     return ctx.TransitionState(ctx.current_state->String(ctx, str, len, copy));
   }
-  bool StartObject() { return ctx.TransitionState(ctx.current_state->StartObject(ctx)); }
+  bool StartObject()
+  {
+    if (in_default_state()) return ctx.TransitionState(ctx.default_state.DefaultState<audit>::StartObject(ctx));
+    return ctx.TransitionState(ctx.current_state->StartObject(ctx));
+  }
   bool Key(const char* str, SizeType len, bool copy)
   {
+    if (in_default_state())
+    { return ctx.TransitionState(ctx.default_state.DefaultState<audit>::Key(ctx, str, len, copy)); }
     return ctx.TransitionState(ctx.current_state->Key(ctx, str, len, copy));
   }
-  bool EndObject(SizeType count) { return ctx.TransitionState(ctx.current_state->EndObject(ctx, count)); }
+  bool EndObject(SizeType count)
+  {
+    if (in_default_state()) return ctx.TransitionState(ctx.default_state.DefaultState<audit>::EndObject(ctx, count));
+    return ctx.TransitionState(ctx.current_state->EndObject(ctx, count));
+  }
   bool StartArray() { return ctx.TransitionState(ctx.current_state->StartArray(ctx)); }
   bool EndArray(SizeType count) { return ctx.TransitionState(ctx.current_state->EndArray(ctx, count)); }
   bool Null() { return ctx.TransitionState(ctx.current_state->Null(ctx)); }
@@ -1562,34 +1657,69 @@ struct VWReaderHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
   std::stringstream& error() { return ctx.error(); }
 
   BaseState<audit>* current_state() { return ctx.current_state; }
+
+private:
+  bool Float(float v)
+  {
+    if (in_default_state()) return ctx.TransitionState(ctx.default_state.DefaultState<audit>::Float(ctx, v));
+    return ctx.TransitionState(ctx.current_state->Float(ctx, v));
+  }
+
+  bool in_default_state() const { return ctx.current_state == &ctx.default_state; }
 };
 
+// Parses lines in place. One parser is kept per vw instance and reused for every line, so that the states, the
+// namespace stack and the line copy only allocate while they grow.
 template <bool audit>
 struct json_parser
 {
   rapidjson::Reader reader;
   VWReaderHandler<audit> handler;
+  std::vector<char> line_copy;
 };
 
+template <bool audit>
+std::shared_ptr<json_parser<audit>>& reused_json_parser_slot(parser& p);
+template <>
+inline std::shared_ptr<json_parser<true>>& reused_json_parser_slot<true>(parser& p)
+{
+  return p.audit_json_parser_state;
+}
+template <>
+inline std::shared_ptr<json_parser<false>>& reused_json_parser_slot<false>(parser& p)
+{
+  return p.json_parser_state;
+}
+
+template <bool audit>
+json_parser<audit>& reused_json_parser(parser& p)
+{
+  auto& slot = reused_json_parser_slot<audit>(p);
+  if (slot == nullptr) slot = std::make_shared<json_parser<audit>>();
+  return *slot;
+}
+
 namespace VW
 {
+// p takes the place of all.example_parser for the per thread parse state, so that worker threads can parse lines for
+// the same vw instance concurrently.
 template <bool audit>
-void read_line_json(
-    vw& all, v_array<example*>& examples, char* line, example_factory_t example_factory, void* ex_factory_context)
+void read_line_json(vw& all, parser& p, v_array<example*>& examples, char* line, example_factory_t example_factory,
+    void* ex_factory_context)
 {
   if (all.example_parser->lbl_parser.label_type == label_type_t::slates)
   {
-    parse_slates_example_json<audit>(all, examples, line, strlen(line), example_factory, ex_factory_context);
+    parse_slates_example_json<audit>(all, p, examples, line, strlen(line), example_factory, ex_factory_context);
     return;
   }
 
   // string line_copy(line);
   // destructive parsing
   InsituStringStream ss(line);
-  json_parser<audit> parser;
+  json_parser<audit>& parser = reused_json_parser<audit>(p);
 
   VWReaderHandler<audit>& handler = parser.handler;
-  handler.init(&all, &examples, &ss, line + strlen(line), example_factory, ex_factory_context);
+  handler.init(&all, &p, &examples, &ss, line + strlen(line), example_factory, ex_factory_context);
 
   ParseResult result =
       parser.reader.template Parse<kParseInsituFlag, InsituStringStream, VWReaderHandler<audit>>(ss, handler);
@@ -1605,6 +1735,13 @@ void read_line_json(
   // "Line: '"<< line_copy << "'");
 }
 
+template <bool audit>
+void read_line_json(
+    vw& all, v_array<example*>& examples, char* line, example_factory_t example_factory, void* ex_factory_context)
+{
+  read_line_json<audit>(all, *all.example_parser, examples, line, example_factory, ex_factory_context);
+}
+
 inline void apply_pdrop(vw& all, float pdrop, v_array<example*>& examples)
 {
   if (all.example_parser->lbl_parser.label_type == label_type_t::cb)
@@ -1622,28 +1759,27 @@ inline void apply_pdrop(vw& all, float pdrop, v_array<example*>& examples)
 }
 
 template <bool audit>
-void read_line_decision_service_json(vw& all, v_array<example*>& examples, char* line, size_t length, bool copy_line,
-    example_factory_t example_factory, void* ex_factory_context, DecisionServiceInteraction* data)
+void read_line_decision_service_json(vw& all, parser& p, v_array<example*>& examples, char* line, size_t length,
+    bool copy_line, example_factory_t example_factory, void* ex_factory_context, DecisionServiceInteraction* data)
 {
   if (all.example_parser->lbl_parser.label_type == label_type_t::slates)
   {
-    parse_slates_example_dsjson<audit>(all, examples, line, length, example_factory, ex_factory_context, data);
+    parse_slates_example_dsjson<audit>(all, p, examples, line, length, example_factory, ex_factory_context, data);
     apply_pdrop(all, data->probabilityOfDrop, examples);
     return;
   }
 
-  std::vector<char> line_vec;
+  json_parser<audit>& parser = reused_json_parser<audit>(p);
   if (copy_line)
   {
-    line_vec.insert(line_vec.end(), line, line + length);
-    line = &line_vec.front();
+    parser.line_copy.assign(line, line + length);
+    line = parser.line_copy.data();
   }
 
   InsituStringStream ss(line);
-  json_parser<audit> parser;
 
   VWReaderHandler<audit>& handler = parser.handler;
-  handler.init(&all, &examples, &ss, line + length, example_factory, ex_factory_context);
+  handler.init(&all, &p, &examples, &ss, line + length, example_factory, ex_factory_context);
   handler.ctx.SetStartStateToDecisionService(data);
 
   ParseResult result =
@@ -1660,11 +1796,21 @@ void read_line_decision_service_json(vw& all, v_array<example*>& examples, char*
                                    "Handler: "
                                 << handler.error().str()
                                 << "State: " << (current_state ? current_state->name : "null"));
-}  // namespace VW
+}
+
+template <bool audit>
+void read_line_decision_service_json(vw& all, v_array<example*>& examples, char* line, size_t length, bool copy_line,
+    example_factory_t example_factory, void* ex_factory_context, DecisionServiceInteraction* data)
+{
+  read_line_decision_service_json<audit>(
+      all, *all.example_parser, examples, line, length, copy_line, example_factory, ex_factory_context, data);
+}
 }  // namespace VW
 
+// Parses the line into examples, which must hold one unused example. Returns false if the line is to be skipped, in
+// which case examples holds one unused example again.
 template <bool audit>
-bool parse_line_json(vw* all, char* line, size_t num_chars, v_array<example*>& examples)
+bool parse_line_json(vw* all, parser& p, char* line, size_t num_chars, v_array<example*>& examples)
 {
   if (all->example_parser->decision_service_json)
   {
@@ -1672,7 +1818,7 @@ bool parse_line_json(vw* all, char* line, size_t num_chars, v_array<example*>& e
     if (line[0] != '{') { return false; }
 
     DecisionServiceInteraction interaction;
-    VW::template read_line_decision_service_json<audit>(*all, examples, line, num_chars, false,
+    VW::template read_line_decision_service_json<audit>(*all, p, examples, line, num_chars, false,
         reinterpret_cast<VW::example_factory_t>(&VW::get_unused_example), all, &interaction);
 
     // TODO: In refactoring the parser to be usable standalone, we need to ensure that we
@@ -1695,12 +1841,18 @@ bool parse_line_json(vw* all, char* line, size_t num_chars, v_array<example*>& e
   }
   else
     VW::template read_line_json<audit>(
-        *all, examples, line, reinterpret_cast<VW::example_factory_t>(&VW::get_unused_example), all);
+        *all, p, examples, line, reinterpret_cast<VW::example_factory_t>(&VW::get_unused_example), all);
 
   return true;
 }
 
-inline void append_empty_newline_example_for_driver(vw* all, v_array<example*>& examples)
+template <bool audit>
+bool parse_line_json(vw* all, char* line, size_t num_chars, v_array<example*>& examples)
+{
+  return parse_line_json<audit>(all, *all->example_parser, line, num_chars, examples);
+}
+
+inline void append_empty_newline_example_for_driver(vw* all, parser& p, v_array<example*>& examples)
 {
   // note: the json parser does single pass parsing and cannot determine if a shared example is needed.
   // since the communication between the parsing thread the main learner expects examples to be requested in order (as
@@ -1713,12 +1865,17 @@ inline void append_empty_newline_example_for_driver(vw* all, v_array<example*>&
     example& ae = VW::get_unused_example(all);
     static const char empty[] = "";
     VW::string_view example(empty);
-    substring_to_example(all, &ae, example);
+    substring_to_example(all, &p, &ae, example);
 
     examples.push_back(&ae);
   }
 }
 
+inline void append_empty_newline_example_for_driver(vw* all, v_array<example*>& examples)
+{
+  append_empty_newline_example_for_driver(all, *all->example_parser, examples);
+}
+
 // This is used by the python parser
 template <bool audit>
 void line_to_examples_json(vw* all, const char* line, size_t num_chars, v_array<example*>& examples)
@@ -11,12 +11,14 @@
 #include "hash.h"
 #include "vw_exception.h"
 
-hash_func_t getHasher(const std::string& s)
+hash_func_t getHasher(const std::string& s, const std::string& hash_function)
 {
+  if (hash_function != "murmur3" && hash_function != "xxh3") THROW("Unknown --hash_function: " << hash_function);
+  const bool xxh3 = hash_function == "xxh3";
   if (s == "strings")
-    return hashstring;
+    return xxh3 ? hashstring_xxh3 : hashstring;
   else if (s == "all")
-    return hashall;
+    return xxh3 ? hashall_xxh3 : hashall;
   else
     THROW("Unknown hash function: " << s);
 }
@@ -32,6 +32,45 @@ void tokenize(char delim, VW::string_view s, ContainerT& ret, bool allow_empty =
   if (!s.empty() || (last_space && allow_empty)) ret.emplace_back(s.substr(0));
 }
 
+// The next of the tokens tokenize would chop s up into, which is removed from s with the delimiter after it. Returns
+// false when s has no tokens left.
+inline bool next_token(char delim, VW::string_view& s, VW::string_view& token)
+{
+  while (!s.empty())
+  {
+    const size_t end_pos = s.find(delim);
+    if (end_pos == VW::string_view::npos)
+    {
+      token = s;
+      s = VW::string_view();
+      return true;
+    }
+    if (end_pos > 0)
+    {
+      token = s.substr(0, end_pos);
+      s.remove_prefix(end_pos + 1);
+      return true;
+    }
+    s.remove_prefix(1);
+  }
+  return false;
+}
+
+// chop up the string as tokenize does into the first max_tokens of tokens, for the labels which have a known number of
+// fields, and return the number of tokens. When there are more than max_tokens the rest is not scanned and
+// max_tokens + 1 is returned.
+inline size_t tokenize_into(char delim, VW::string_view s, VW::string_view* tokens, size_t max_tokens)
+{
+  size_t num_tokens = 0;
+  VW::string_view token;
+  while (next_token(delim, s, token))
+  {
+    if (num_tokens == max_tokens) return max_tokens + 1;
+    tokens[num_tokens++] = token;
+  }
+  return num_tokens;
+}
+
 // This function returns a vector of strings (not string_views) because we need to remove the escape characters
 std::vector<std::string> escaped_tokenize(char delim, VW::string_view s, bool allow_empty = false);
 
@@ -50,7 +89,38 @@ typedef example& (*example_factory_t)(void*);
 
 typedef uint64_t (*hash_func_t)(const char* s, size_t, uint64_t);
 
-hash_func_t getHasher(const std::string& s);
+// The hasher of --hash s, strings or all, with the hash function of --hash_function, murmur3 or xxh3.
+hash_func_t getHasher(const std::string& s, const std::string& hash_function = "murmur3");
+
+// Parses the short decimals which make up most feature values, [-]digits[.digits] with at most 7 digits in all so
+// that a float holds them exactly, followed by the end, a space, a tab or a newline. The result is the same as that
+// of parseFloat, anything else returns false and is left to it.
+inline bool parse_short_decimal(const char* p, const char* end, float& value, size_t& end_idx)
+{
+  const char* start = p;
+  const bool negative = p != end && *p == '-';
+  if (negative) p++;
+
+  uint32_t mantissa = 0;
+  const char* digits_start = p;
+  while (p != end && static_cast<unsigned char>(*p - '0') <= 9) mantissa = mantissa * 10 + (*p++ - '0');
+  ptrdiff_t num_digits = p - digits_start;
+  ptrdiff_t num_dec = 0;
+  if (p != end && *p == '.')
+  {
+    const char* fraction_start = ++p;
+    while (p != end && static_cast<unsigned char>(*p - '0') <= 9) mantissa = mantissa * 10 + (*p++ - '0');
+    num_dec = p - fraction_start;
+    num_digits += num_dec;
+  }
+  if (num_digits == 0 || num_digits > 7) return false;
+  if (p != end && *p != ' ' && *p != '\t' && *p != '\n') return false;
+
+  value = static_cast<float>(mantissa) * VW::fast_pow10(static_cast<int8_t>(-num_dec));
+  if (negative) value = -value;
+  end_idx = p - start;
+  return true;
+}
 
 // The following function is a home made strtof. The
 // differences are :
@@ -65,6 +135,8 @@ inline float parseFloat(const char* p, size_t& end_idx, const char* endLine = nu
   end_idx = 0;
 
   if (!p || !*p) { return 0; }
+  float value;
+  if (!endLine_is_null && parse_short_decimal(p, endLine, value, end_idx)) { return value; }
   int s = 1;
   while ((*p == ' ') && (endLine_is_null || p < endLine)) p++;
 
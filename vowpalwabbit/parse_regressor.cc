@@ -7,6 +7,7 @@
 #include "crossplat_compat.h"
 
 #ifndef _WIN32
+#  include <sys/wait.h>
 #  include <unistd.h>
 #endif
 
@@ -24,6 +25,7 @@
 #include "rand48.h"
 #include "global_data.h"
 #include "vw_exception.h"
+#include "model_delta.h"
 #include "vw_validate.h"
 #include "vw_versions.h"
 #include "options_serializer_boost_po.h"
@@ -56,6 +58,58 @@ double calculate_sd(vw& /* all */, T& weights)
   double sq_sum = inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
   return std::sqrt(sq_sum / my_size);
 }
+
+// Only dense weights can be laid out in planes, see --planar_weights.
+uint32_t planes_shift(const sparse_parameters&) { return 0; }
+uint32_t planes_shift(const dense_parameters& weights) { return weights.planes_shift(); }
+
+void allocate_regressor(vw& all, sparse_parameters& weights, size_t length, uint32_t stride_shift, uint32_t)
+{
+  new (&weights) sparse_parameters(length, stride_shift);
+  if (all.sparse_weights_limit > 0)
+  {
+    // A weight takes its block and, in tables at most half used, two slots and their use counts.
+    const size_t weight_bytes = (sizeof(weight) << stride_shift) + 2 * (sizeof(sparse_slot) + sizeof(uint8_t));
+    weights.set_limit(std::max<size_t>((all.sparse_weights_limit << 20) / weight_bytes, 1));
+  }
+}
+
+void allocate_regressor(
+    vw& all, dense_parameters& weights, size_t length, uint32_t stride_shift, uint32_t planes_shift)
+{
+  new (&weights) dense_parameters(length, stride_shift, all.requested_weight_allocation, planes_shift);
+  if (all.weight_prefetch_distance >= 0) weights.prefetch_distance(all.weight_prefetch_distance);
+  if (!all.requested_weight_allocation.is_default() && !all.logger.quiet)
+    all.trace_message << "weights allocated with " << VW::to_string(weights.allocation()) << std::endl;
+}
+
+template <typename Initializer>
+void set_initial_weights(vw&, sparse_parameters& weights, Initializer&& initializer)
+{
+  weights.set_default(initializer);
+}
+
+// With --lazy_weights, the weights are set as their pages are first touched rather than all at once. Their initial
+// values only depend on their index, so they are the same either way.
+template <typename Initializer>
+void set_initial_weights(vw& all, dense_parameters& weights, Initializer&& initializer)
+{
+  if (all.lazy_weights && all.requested_weight_allocation.is_default())
+  {
+    const uint64_t length = weights.mask() + 1;
+    auto allocated =
+        VW::allocate_lazy_weights(length << weights.planes_shift(), length, weights.stride(), initializer);
+    if (allocated.data != nullptr)
+    {
+      weights.use_mapped_memory(allocated.data, allocated.mapped_bytes);
+      return;
+    }
+    if (!all.logger.quiet)
+      all.trace_message << "initial weights cannot be set on demand here, they are set up front" << std::endl;
+  }
+  weights.set_default(initializer);
+}
+
 template <class T>
 void initialize_regressor(vw& all, T& weights)
 {
@@ -66,8 +120,9 @@ void initialize_regressor(vw& all, T& weights)
   try
   {
     uint32_t ss = weights.stride_shift();
+    uint32_t ps = planes_shift(weights);
     weights.~T();  // dealloc so that we can realloc, now with a known size
-    new (&weights) T(length, ss);
+    allocate_regressor(all, weights, length, ss, ps);
   }
   catch (const VW::vw_exception&)
   {
@@ -80,22 +135,23 @@ void initialize_regressor(vw& all, T& weights)
     auto initial_weight = all.initial_weight;
     auto initial_value_weight_initializer = [initial_weight](
                                                 weight* weights, uint64_t /*index*/) { weights[0] = initial_weight; };
-    weights.set_default(initial_value_weight_initializer);
+    set_initial_weights(all, weights, initial_value_weight_initializer);
   }
   else if (all.random_positive_weights)
   {
-    weights.set_default(&initialize_weights_as_random_positive);
+    set_initial_weights(all, weights, &initialize_weights_as_random_positive);
   }
   else if (all.random_weights)
   {
-    weights.set_default(&initialize_weights_as_random);
+    set_initial_weights(all, weights, &initialize_weights_as_random);
   }
   else if (all.normal_weights)
   {
-    weights.set_default(&initialize_weights_as_polar_normal);
+    set_initial_weights(all, weights, &initialize_weights_as_polar_normal);
   }
   else if (all.tnormal_weights)
   {
+    // Truncating needs the statistics of every weight, so they are set up front.
     weights.set_default(&initialize_weights_as_polar_normal);
     truncate(all, weights);
   }
@@ -411,6 +467,18 @@ void save_load_header(
 
         auto serialized_keep_options = serializer.str();
 
+        // Quantized weights are read back as such, see GD::save_load.
+        if (all.save_quantized) serialized_keep_options += " --quantized";
+        // So are weights in runs, which resumable models don't use.
+        else if (all.write_weight_runs && !all.save_resume && !text)
+          serialized_keep_options += " --weight_runs";
+        // And dense weights written as one array.
+        else if (all.write_weight_image && !all.save_resume && !text && !all.weights.sparse)
+          serialized_keep_options += " --weight_image";
+        // And the state of resumable models written in columns.
+        else if (all.write_resume_columns && all.save_resume && !text)
+          serialized_keep_options += " --resume_columns";
+
         // We need to save our current PRG state
         if (all.save_resume && all.get_random_state()->get_current_state() != 0)
         {
@@ -470,7 +538,8 @@ void dump_regressor(vw& all, std::string reg_name, bool as_text)
   if (reg_name == std::string("")) return;
   std::string start_name = reg_name + std::string(".writing");
   io_buf io_temp;
-  io_temp.add_file(VW::io::open_file_writer(start_name));
+  io_temp.add_file(as_text ? VW::io::open_file_writer(start_name)
+                           : VW::io::open_compressed_file_writer(start_name, all.model_compression));
 
   dump_regressor(all, io_temp, as_text);
 
@@ -481,20 +550,119 @@ void dump_regressor(vw& all, std::string reg_name, bool as_text)
         << start_name.c_str() << " to " << reg_name.c_str());
 }
 
+// Weights published with --publish_weights are published again whenever the model is saved.
+void publish_weights(vw& all)
+{
+  if (all.published_weights != nullptr) all.published_weights->publish(all.weights.dense_weights);
+}
+
+// With --save_in_background, waits until the model being saved by a forked process is written.
+void wait_for_background_save(vw& all)
+{
+#ifndef _WIN32
+  if (all.background_save_pid <= 0) return;
+  int status = 0;
+  const pid_t pid = waitpid(all.background_save_pid, &status, 0);
+  all.background_save_pid = 0;
+  if (pid < 0) THROWERRNO("waitpid for the background save");
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) THROW("the background save of the model failed");
+#else
+  (void)all;
+#endif
+}
+
+// The forked process sees the whole state of the learners as of the fork, the pages the learning process writes to
+// meanwhile are copied, so it writes the same model as saving right away would, resume state included. Only one save
+// runs at a time, and elsewhere than POSIX the model is saved right away.
+void dump_regressor_in_background(vw& all, const std::string& reg_name)
+{
+#ifndef _WIN32
+  wait_for_background_save(all);
+  // A forked child would read the weights not yet filled as zeros, see VW::filled_on_demand.
+  if (!all.weights.sparse && VW::filled_on_demand(all.weights.dense_weights.first()))
+  {
+    dump_regressor(all, reg_name, false);
+    return;
+  }
+  std::cout.flush();
+  std::cerr.flush();
+  const pid_t pid = fork();
+  if (pid < 0) THROWERRNO("fork for the background save");
+  if (pid == 0)
+  {
+    int status = 0;
+    try
+    {
+      dump_regressor(all, reg_name, false);
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "background save of " << reg_name << ": " << e.what() << std::endl;
+      status = 1;
+    }
+    // Leaves the state shared with the learning process, such as its buffered output, alone.
+    _exit(status);
+  }
+  all.background_save_pid = pid;
+#else
+  dump_regressor(all, reg_name, false);
+#endif
+}
+
 void save_predictor(vw& all, std::string reg_name, size_t current_pass)
 {
   std::stringstream filename;
   filename << reg_name;
   if (all.save_per_pass) filename << "." << current_pass;
-  dump_regressor(all, filename.str(), false);
+  if (all.save_in_background && !reg_name.empty())
+    dump_regressor_in_background(all, filename.str());
+  else
+    dump_regressor(all, filename.str(), false);
+  publish_weights(all);
+}
+
+// Folds the weights into 1 << bits of them, see --rehash_bits. Features use the weight of the low bits of their hash,
+// interactions included, so that a feature now uses the sum of the weights it shared the low bits with. Only the
+// weights themselves are kept.
+template <class T>
+void rehash_regressor(vw& all, T& weights, uint32_t bits)
+{
+  const uint64_t length = (uint64_t)1 << bits;
+  std::vector<float> folded(length, 0.f);
+  for (auto it = weights.begin(); it != weights.end(); ++it)
+    if (*it != 0.f) folded[(it.index() >> weights.stride_shift()) & (length - 1)] += *it;
+
+  const uint32_t ss = weights.stride_shift();
+  const uint32_t ps = planes_shift(weights);
+  weights.~T();
+  allocate_regressor(all, weights, length, ss, ps);
+  for (uint64_t i = 0; i < length; i++)
+    if (folded[i] != 0.f) weights.strided_index(i) = folded[i];
+}
+
+void rehash_regressor(vw& all, uint32_t bits)
+{
+  if (bits == 0 || bits >= all.num_bits)
+    THROW("--rehash_bits " << bits << " must be less than the " << all.num_bits << " bits of the model");
+  if (all.weights.sparse)
+    rehash_regressor(all, all.weights.sparse_weights, bits);
+  else
+    rehash_regressor(all, all.weights.dense_weights, bits);
+  if (!all.logger.quiet)
+    all.trace_message << "folded the weights from " << all.num_bits << " into " << bits << " bits" << std::endl;
+  all.num_bits = bits;
 }
 
 void finalize_regressor(vw& all, std::string reg_name)
 {
+  wait_for_background_save(all);
   if (!all.early_terminate)
   {
+    if (all.rehash_bits != 0) rehash_regressor(all, all.rehash_bits);
     if (all.per_feature_regularizer_output.length() > 0)
       dump_regressor(all, all.per_feature_regularizer_output, false);
+    else if (!all.delta_base_name.empty() && !reg_name.empty())
+      VW::write_model_delta(all, all.delta_base_name, reg_name);
     else
       dump_regressor(all, reg_name, false);
     if (all.per_feature_regularizer_text.length() > 0)
@@ -506,14 +674,27 @@ void finalize_regressor(vw& all, std::string reg_name)
       dump_regressor(all, all.inv_hash_regressor_name, true);
       all.print_invert = false;
     }
+    if (!all.quantized_regressor_name.empty())
+    {
+      all.save_quantized = true;
+      dump_regressor(all, all.quantized_regressor_name, false);
+      all.save_quantized = false;
+    }
+    publish_weights(all);
   }
 }
 
+// Models may have been written with --model_compression, the format is recovered from the file itself.
+std::unique_ptr<VW::io::reader> open_model_file_reader(const std::string& file_path)
+{
+  return VW::io::open_compressed_file_reader(file_path, VW::io::detect_compression_format(file_path));
+}
+
 void read_regressor_file(vw& all, std::vector<std::string> all_intial, io_buf& io_temp)
 {
   if (all_intial.size() > 0)
   {
-    io_temp.add_file(VW::io::open_file_reader(all_intial[0]));
+    io_temp.add_file(open_model_file_reader(all_intial[0]));
 
     if (!all.logger.quiet)
     {
@@ -541,7 +722,7 @@ void parse_mask_regressor_args(vw& all, std::string feature_mask, std::vector<st
 
     // all other cases, including from different file, or -i does not exist, need to read in the mask file
     io_buf io_temp_mask;
-    io_temp_mask.add_file(VW::io::open_file_reader(feature_mask));
+    io_temp_mask.add_file(open_model_file_reader(feature_mask));
 
     save_load_header(all, io_temp_mask, true, false, file_options, *all.options);
     all.l->save_load(io_temp_mask, true, false);
@@ -552,7 +733,7 @@ void parse_mask_regressor_args(vw& all, std::string feature_mask, std::vector<st
     {
       // Load original header again.
       io_buf io_temp;
-      io_temp.add_file(VW::io::open_file_reader(initial_regressors[0]));
+      io_temp.add_file(open_model_file_reader(initial_regressors[0]));
 
       save_load_header(all, io_temp, true, false, file_options, *all.options);
       io_temp.close_file();
@@ -37,7 +37,7 @@ inline float get_number(const rapidjson::Value& value)
 
 template <bool audit>
 void handle_features_value(const char* key_namespace, const Value& value, example* current_example,
-    std::vector<Namespace<audit>>& namespaces, vw& all)
+    std::vector<Namespace<audit>>& namespaces, vw& all, parser& p)
 {
   assert(key_namespace != nullptr);
   assert(std::strlen(key_namespace) != 0);
@@ -61,15 +61,15 @@ void handle_features_value(const char* key_namespace, const Value& value, exampl
       break;
     case rapidjson::kObjectType:
     {
-      push_ns(current_example, key_namespace, namespaces, all);
+      push_ns(current_example, key_namespace, namespaces, all, p);
       for (auto& object_value : value.GetObject())
-      { handle_features_value(object_value.name.GetString(), object_value.value, current_example, namespaces, all); }
+      { handle_features_value(object_value.name.GetString(), object_value.value, current_example, namespaces, all, p); }
       pop_ns(current_example, namespaces);
     }
     break;
     case rapidjson::kArrayType:
     {
-      push_ns(current_example, key_namespace, namespaces, all);
+      push_ns(current_example, key_namespace, namespaces, all, p);
       auto array_hash = namespaces.back().namespace_hash;
 
       for (auto& array_value : value.GetArray())
@@ -94,7 +94,7 @@ void handle_features_value(const char* key_namespace, const Value& value, exampl
           break;
           case rapidjson::kObjectType:
           {
-            handle_features_value(key_namespace, array_value, current_example, namespaces, all);
+            handle_features_value(key_namespace, array_value, current_example, namespaces, all, p);
           }
           break;
           default:
@@ -110,15 +110,15 @@ void handle_features_value(const char* key_namespace, const Value& value, exampl
       const char* str = value.GetString();
       // String escape
       const char* end = str + value.GetStringLength();
-      for (char* p = (char*)str; p != end; p++)
+      for (char* c = (char*)str; c != end; c++)
       {
-        switch (*p)
+        switch (*c)
         {
           case ' ':
           case '\t':
           case '|':
           case ':':
-            *p = '_';
+            *c = '_';
         }
       }
 
@@ -136,9 +136,8 @@ void handle_features_value(const char* key_namespace, const Value& value, exampl
     {
       assert(!namespaces.empty());
       float number = get_number(value);
-      namespaces.back().AddFeature(number,
-          VW::hash_feature_cstr(all, const_cast<char*>(key_namespace), namespaces.back().namespace_hash),
-          key_namespace);
+      auto& ns = namespaces.back();
+      ns.AddFeature(number, ns.hash_name(key_namespace, ns.namespace_hash) & all.parse_mask, key_namespace);
     }
     break;
     default:
@@ -147,11 +146,11 @@ void handle_features_value(const char* key_namespace, const Value& value, exampl
 }
 
 template <bool audit>
-void parse_context(const Value& context, vw& all, v_array<example*>& examples, VW::example_factory_t example_factory,
-    void* ex_factory_context, std::vector<example*>& slot_examples)
+void parse_context(const Value& context, vw& all, parser& p, v_array<example*>& examples,
+    VW::example_factory_t example_factory, void* ex_factory_context, std::vector<example*>& slot_examples)
 {
   std::vector<Namespace<audit>> namespaces;
-  handle_features_value(" ", context, examples[0], namespaces, all);
+  handle_features_value(" ", context, examples[0], namespaces, all, p);
   all.example_parser->lbl_parser.default_label(&examples[0]->l);
   examples[0]->l.slates.type = VW::slates::example_type::shared;
 
@@ -166,7 +165,7 @@ void parse_context(const Value& context, vw& all, v_array<example*>& examples, V
     examples.push_back(ex);
     auto slot_id = obj["_slot_id"].GetInt();
     ex->l.slates.slot_id = slot_id;
-    handle_features_value(" ", obj, ex, namespaces, all);
+    handle_features_value(" ", obj, ex, namespaces, all, p);
     assert(namespaces.size() == 0);
   }
 
@@ -178,13 +177,13 @@ void parse_context(const Value& context, vw& all, v_array<example*>& examples, V
     ex->l.slates.type = VW::slates::example_type::slot;
     examples.push_back(ex);
     slot_examples.push_back(ex);
-    handle_features_value(" ", slot_object, ex, namespaces, all);
+    handle_features_value(" ", slot_object, ex, namespaces, all, p);
     assert(namespaces.size() == 0);
   }
 }
 
 template <bool audit>
-void parse_slates_example_json(vw& all, v_array<example*>& examples, char* line, size_t /*length*/,
+void parse_slates_example_json(vw& all, parser& p, v_array<example*>& examples, char* line, size_t /*length*/,
     VW::example_factory_t example_factory, void* ex_factory_context)
 {
   Document document;
@@ -193,11 +192,11 @@ void parse_slates_example_json(vw& all, v_array<example*>& examples, char* line,
   // Build shared example
   const Value& context = document.GetObject();
   std::vector<example*> slot_examples;
-  parse_context<audit>(context, all, examples, example_factory, ex_factory_context, slot_examples);
+  parse_context<audit>(context, all, p, examples, example_factory, ex_factory_context, slot_examples);
 }
 
 template <bool audit>
-void parse_slates_example_dsjson(vw& all, v_array<example*>& examples, char* line, size_t /*length*/,
+void parse_slates_example_dsjson(vw& all, parser& p, v_array<example*>& examples, char* line, size_t /*length*/,
     VW::example_factory_t example_factory, void* ex_factory_context, DecisionServiceInteraction* data)
 {
   Document document;
@@ -206,7 +205,7 @@ void parse_slates_example_dsjson(vw& all, v_array<example*>& examples, char* lin
   // Build shared example
   const Value& context = document["c"].GetObject();
   std::vector<example*> slot_examples;
-  parse_context<audit>(context, all, examples, example_factory, ex_factory_context, slot_examples);
+  parse_context<audit>(context, all, p, examples, example_factory, ex_factory_context, slot_examples);
 
   if (document.HasMember("_label_cost"))
   {
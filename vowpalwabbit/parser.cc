@@ -54,8 +54,13 @@ int getpid() { return (int)::GetCurrentProcessId(); }
 #include "vw_exception.h"
 #include "parse_example_json.h"
 #include "parse_dispatch_loop.h"
+#include "parser_pool.h"
+#include "daemon_server.h"
+#include "model_reloader.h"
 #include "parse_args.h"
 #include "io/io_adapter.h"
+#include "thread_affinity.h"
+#include "parser/columnar/parse_example_columnar.h"
 #include "parser/flatbuffer/parse_example_flatbuffer.h"
 
 // OSX doesn't expects you to use IPPROTO_TCP instead of SOL_TCP
@@ -83,7 +88,7 @@ bool is_test_only(uint32_t counter, uint32_t period, uint32_t after, bool holdou
 
 void set_compressed(parser* /*par*/) {}
 
-uint32_t cache_numbits(io_buf* buf, VW::io::reader* filepointer)
+uint32_t cache_numbits(io_buf* buf, VW::io::reader* filepointer, size_t& cache_format)
 {
   size_t v_length;
   buf->read_file(filepointer, (char*)&v_length, sizeof(v_length));
@@ -103,7 +108,15 @@ uint32_t cache_numbits(io_buf* buf, VW::io::reader* filepointer)
   char temp;
   if (buf->read_file(filepointer, &temp, 1) < 1) THROW("failed to read");
 
-  if (temp != 'c') THROW("data file is not a cache file");
+  if (temp == VW::CACHE_FORMAT_1_MARKER) { cache_format = 1; }
+  else if (temp == VW::CACHE_FORMAT_2_MARKER)
+  {
+    cache_format = 2;
+  }
+  else
+  {
+    THROW("data file is not a cache file");
+  }
 
   uint32_t cache_numbits;
   if (buf->read_file(filepointer, &cache_numbits, sizeof(cache_numbits)) < (int)sizeof(cache_numbits)) { return true; }
@@ -113,6 +126,30 @@ uint32_t cache_numbits(io_buf* buf, VW::io::reader* filepointer)
 
 void set_cache_reader(vw& all) { all.example_parser->reader = read_cached_features; }
 
+std::unique_ptr<VW::io::reader> open_input_file_reader(vw& all, const std::string& file_path, bool compressed)
+{
+  auto format = VW::io::detect_compression_format(file_path);
+  // Pipes and other special files cannot be sniffed without consuming them, so --compressed is trusted for those.
+  if (format == VW::io::compression_format::none && compressed) { format = VW::io::compression_format::gzip; }
+
+  // Mapped files are prefetched by the kernel, reading ahead of them would only add a copy.
+  if (all.example_parser->mmap_input && format == VW::io::compression_format::none)
+  { return VW::io::open_mapped_file_reader(file_path); }
+
+  std::unique_ptr<VW::io::reader> reader;
+  if (format == VW::io::compression_format::gzip && all.example_parser->compression_threads > 1)
+  {
+    reader = VW::io::open_parallel_compressed_file_reader(file_path, all.example_parser->compression_threads);
+  }
+  else
+  {
+    reader = VW::io::open_compressed_file_reader(file_path, format);
+  }
+  if (all.example_parser->read_ahead_buffers > 0)
+  { reader = VW::io::create_read_ahead_reader(std::move(reader), all.example_parser->read_ahead_buffers); }
+  return reader;
+}
+
 void set_string_reader(vw& all)
 {
   all.example_parser->reader = read_features_string;
@@ -143,11 +180,15 @@ void set_json_reader(vw& all, bool dsjson = false)
   all.example_parser->decision_service_json = dsjson;
 }
 
-void set_daemon_reader(vw& all, bool json = false, bool dsjson = false)
+void set_daemon_reader(vw& all, bool json, bool dsjson)
 {
-  if (all.example_parser->input->isbinary())
+  io_buf& input = *all.example_parser->input;
+  const bool blocks = input.read_marker(VW::DAEMON_BLOCKS_MARKER);
+  if (blocks || input.read_marker(VW::DAEMON_EXAMPLES_MARKER))
   {
     all.example_parser->reader = read_cached_features;
+    all.example_parser->cache_format = blocks ? 2 : 1;
+    all.example_parser->cache_examples_left_in_block = 0;
     VW_WARNING_STATE_PUSH
     VW_WARNING_DISABLE_DEPRECATED_USAGE
     all.print = binary_print_result;
@@ -172,21 +213,37 @@ void reset_source(vw& all, size_t numbits)
   // If in write cache mode then close all of the input files then open the written cache as the new input.
   if (all.example_parser->write_cache)
   {
+    if (all.example_parser->cache_writer != nullptr)
+    {
+      all.example_parser->cache_writer->finish();
+      all.example_parser->cache_writer.reset();
+    }
     all.example_parser->output->flush();
     // Turn off write_cache as we are now reading it instead of writing!
     all.example_parser->write_cache = false;
     all.example_parser->output->close_file();
 
-    // This deletes the file from disk.
-    remove(all.example_parser->finalname.c_str());
-
-    // Rename the cache file to the final name.
-    if (0 != rename(all.example_parser->currentname.c_str(), all.example_parser->finalname.c_str()))
-      THROW("WARN: reset_source(vw& all, size_t numbits) cannot rename: " << all.example_parser->currentname << " to "
-                                                                          << all.example_parser->finalname);
-    input->close_files();
-    // Now open the written cache as the new input file.
-    input->add_file(VW::io::open_file_reader(all.example_parser->finalname));
+    const auto& memory_cache = all.example_parser->memory_cache;
+    if (memory_cache != nullptr)
+    {
+      input->close_files();
+      input->add_file(VW::io::create_buffer_view(memory_cache->data(), memory_cache->size()));
+      all.example_parser->cache_file_names.clear();
+    }
+    else
+    {
+      // This deletes the file from disk.
+      remove(all.example_parser->finalname.c_str());
+
+      // Rename the cache file to the final name.
+      if (0 != rename(all.example_parser->currentname.c_str(), all.example_parser->finalname.c_str()))
+        THROW("WARN: reset_source(vw& all, size_t numbits) cannot rename: " << all.example_parser->currentname << " to "
+                                                                            << all.example_parser->finalname);
+      input->close_files();
+      // Now open the written cache as the new input file.
+      input->add_file(open_input_file_reader(all, all.example_parser->finalname, all.example_parser->compressed));
+      all.example_parser->cache_file_names = {all.example_parser->finalname};
+    }
     set_cache_reader(all);
   }
 
@@ -225,10 +282,25 @@ void reset_source(vw& all, size_t numbits)
     }
     else
     {
+      all.example_parser->cache_examples_left_in_block = 0;
       for (auto& file : input->input_files)
       {
         input->reset_file(file.get());
-        if (cache_numbits(input, file.get()) < numbits) THROW("argh, a bug in caching of some sort!");
+        size_t cache_format;
+        if (cache_numbits(input, file.get(), cache_format) < numbits) THROW("argh, a bug in caching of some sort!");
+        if (&file == &input->input_files.front()) { all.example_parser->cache_format = cache_format; }
+        else if (cache_format != all.example_parser->cache_format)
+        {
+          THROW("cache files of different formats cannot be read together, recreate them with -k");
+        }
+      }
+      auto& shuffler = all.example_parser->cache_shuffler;
+      const auto& memory_cache = all.example_parser->memory_cache;
+      if (shuffler != nullptr && memory_cache != nullptr)
+      { shuffler->start_pass(memory_cache->data(), memory_cache->size()); }
+      else if (shuffler != nullptr && all.example_parser->cache_format == 2)
+      {
+        shuffler->start_pass(all.example_parser->cache_file_names, all.trace_message);
       }
     }
   }
@@ -236,6 +308,20 @@ void reset_source(vw& all, size_t numbits)
 
 void finalize_source(parser*) {}
 
+// Returns the size of the header.
+size_t write_cache_header(vw& all, io_buf& output, size_t format)
+{
+  size_t v_length = (uint64_t)VW::version.to_string().length() + 1;
+
+  output.bin_write_fixed(reinterpret_cast<const char*>(&v_length), sizeof(v_length));
+  output.bin_write_fixed(VW::version.to_string().c_str(), v_length);
+  const char marker = format == 2 ? VW::CACHE_FORMAT_2_MARKER : VW::CACHE_FORMAT_1_MARKER;
+  output.bin_write_fixed(&marker, sizeof(marker));
+  output.bin_write_fixed(reinterpret_cast<const char*>(&all.num_bits), sizeof(all.num_bits));
+  output.flush();
+  return sizeof(v_length) + v_length + sizeof(marker) + sizeof(all.num_bits);
+}
+
 void make_write_cache(vw& all, std::string& newname, bool quiet)
 {
   io_buf* output = all.example_parser->output;
@@ -248,7 +334,12 @@ void make_write_cache(vw& all, std::string& newname, bool quiet)
   all.example_parser->currentname = newname + std::string(".writing");
   try
   {
-    output->add_file(VW::io::open_file_writer(all.example_parser->currentname));
+    // Gzip caches are block compressed so that they can be written and read back in parallel.
+    const auto format = all.example_parser->cache_compression;
+    output->add_file(format == VW::io::compression_format::gzip
+            ? VW::io::open_parallel_compressed_file_writer(
+                  all.example_parser->currentname, all.example_parser->compression_threads)
+            : VW::io::open_compressed_file_writer(all.example_parser->currentname, format));
   }
   catch (const std::exception&)
   {
@@ -256,19 +347,58 @@ void make_write_cache(vw& all, std::string& newname, bool quiet)
     return;
   }
 
-  size_t v_length = (uint64_t)VW::version.to_string().length() + 1;
-
-  output->bin_write_fixed(reinterpret_cast<const char*>(&v_length), sizeof(v_length));
-  output->bin_write_fixed(VW::version.to_string().c_str(), v_length);
-  output->bin_write_fixed("c", 1);
-  output->bin_write_fixed(reinterpret_cast<const char*>(&all.num_bits), sizeof(all.num_bits));
-  output->flush();
+  const size_t header_size = write_cache_header(all, *output, all.example_parser->write_cache_format);
+  if (all.example_parser->write_cache_format == 2)
+  {
+    // The first pass writes and compresses the cache on a thread of its own so that it runs at parse speed.
+    all.example_parser->cache_writer.reset(
+        new VW::cache_block_writer(*output, header_size, all.example_parser->cache_block_size, true,
+            all.example_parser->cache_dedup));
+  }
 
   all.example_parser->finalname = newname;
   all.example_parser->write_cache = true;
   if (!quiet) all.trace_message << "creating cache_file = " << newname << endl;
 }
 
+// Caches the examples of the first pass in memory, reset_source reads them back from there.
+void make_memory_cache(vw& all, bool quiet)
+{
+  auto& memory_cache = all.example_parser->memory_cache;
+  memory_cache = std::make_shared<std::vector<char>>();
+  io_buf* output = all.example_parser->output;
+  output->add_file(VW::io::create_vector_writer(memory_cache));
+  const size_t header_size = write_cache_header(all, *output, 2);
+  all.example_parser->cache_writer.reset(new VW::cache_block_writer(
+      *output, header_size, all.example_parser->cache_block_size, false, all.example_parser->cache_dedup));
+  all.example_parser->write_cache = true;
+  if (!quiet) all.trace_message << "keeping examples in memory" << endl;
+}
+
+// Reads the format 2 cache which memory_cache was set to before the sources were enabled.
+void read_memory_cache(vw& all, bool quiet)
+{
+  const auto& memory_cache = all.example_parser->memory_cache;
+  io_buf* input = all.example_parser->input;
+  input->add_file(VW::io::create_buffer_view(memory_cache->data(), memory_cache->size()));
+  size_t cache_format;
+  const uint64_t numbits = cache_numbits(input, input->input_files.back().get(), cache_format);
+  if (numbits < all.num_bits) THROW("the examples held in memory are cached with less bit precision than required");
+  if (cache_format != 2) THROW("the examples held in memory must be a format 2 cache");
+
+  set_cache_reader(all);
+  all.example_parser->write_cache = false;
+  all.example_parser->cache_format = cache_format;
+  all.example_parser->cache_examples_left_in_block = 0;
+  all.example_parser->sorted_cache = numbits == all.num_bits;
+  all.example_parser->resettable = true;
+  // the weights mask the indices of the features as they are looked up, so they may keep all of their hashes
+  all.parse_mask = all.full_hashes ? ~(uint64_t)0 : ((uint64_t)1 << all.num_bits) - 1;
+  if (all.example_parser->cache_shuffler != nullptr)
+  { all.example_parser->cache_shuffler->start_pass(memory_cache->data(), memory_cache->size()); }
+  if (!quiet) all.trace_message << "using the examples held in memory" << endl;
+}
+
 void parse_cache(vw& all, std::vector<std::string> cache_files, bool kill_cache, bool quiet)
 {
   all.example_parser->write_cache = false;
@@ -278,7 +408,7 @@ void parse_cache(vw& all, std::vector<std::string> cache_files, bool kill_cache,
     bool cache_file_opened = false;
     if (!kill_cache) try
       {
-        all.example_parser->input->add_file(VW::io::open_file_reader(file));
+        all.example_parser->input->add_file(open_input_file_reader(all, file, all.example_parser->compressed));
         cache_file_opened = true;
       }
       catch (const std::exception&)
@@ -289,7 +419,9 @@ void parse_cache(vw& all, std::vector<std::string> cache_files, bool kill_cache,
       make_write_cache(all, file, quiet);
     else
     {
-      uint64_t c = cache_numbits(all.example_parser->input, all.example_parser->input->input_files.back().get());
+      size_t cache_format;
+      uint64_t c = cache_numbits(
+          all.example_parser->input, all.example_parser->input->input_files.back().get(), cache_format);
       if (c < all.num_bits)
       {
         if (!quiet)
@@ -302,6 +434,9 @@ void parse_cache(vw& all, std::vector<std::string> cache_files, bool kill_cache,
       {
         if (!quiet) all.trace_message << "using cache_file = " << file.c_str() << endl;
         set_cache_reader(all);
+        all.example_parser->cache_format = cache_format;
+        all.example_parser->cache_examples_left_in_block = 0;
+        all.example_parser->cache_file_names.push_back(file);
         if (c == all.num_bits)
           all.example_parser->sorted_cache = true;
         else
@@ -311,7 +446,12 @@ void parse_cache(vw& all, std::vector<std::string> cache_files, bool kill_cache,
     }
   }
 
-  all.parse_mask = ((uint64_t)1 << all.num_bits) - 1;
+  // the weights mask the indices of the features as they are looked up, so they may keep all of their hashes
+  all.parse_mask = all.full_hashes ? ~(uint64_t)0 : ((uint64_t)1 << all.num_bits) - 1;
+  // Caches which are written first are shuffled from the second pass on, see reset_source.
+  if (all.example_parser->cache_shuffler != nullptr && !all.example_parser->write_cache &&
+      all.example_parser->resettable && all.example_parser->cache_format == 2)
+  { all.example_parser->cache_shuffler->start_pass(all.example_parser->cache_file_names, all.trace_message); }
   if (cache_files.size() == 0)
   {
     if (!quiet) all.trace_message << "using no cache" << endl;
@@ -326,7 +466,50 @@ void parse_cache(vw& all, std::vector<std::string> cache_files, bool kill_cache,
 void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_options)
 {
   all.example_parser->input->current = 0;
-  parse_cache(all, input_options.cache_files, input_options.kill_cache, quiet);
+  all.example_parser->mmap_input = input_options.mmap;
+  all.example_parser->read_ahead_buffers = input_options.read_ahead_buffers;
+  all.example_parser->compressed = input_options.compressed;
+  all.example_parser->compression_threads = input_options.compression_threads;
+  if (input_options.cache_format != 1 && input_options.cache_format != 2)
+    THROW("cache_format must be 1 or 2, got " << input_options.cache_format);
+  if (input_options.cache_block_size == 0) THROW("cache_block_size must be positive");
+  if (input_options.cache_dedup && input_options.cache_format != 2)
+    THROW("cache_dedup stores the features of a namespace once per block, it needs cache_format 2");
+  all.example_parser->write_cache_format = input_options.cache_format;
+  all.example_parser->cache_block_size = input_options.cache_block_size;
+  all.example_parser->cache_dedup = input_options.cache_dedup;
+  if (input_options.cache_shuffle)
+  {
+    if (all.l->is_multiline) THROW("cache_shuffle cannot be used with reductions which learn from multiple examples");
+    all.example_parser->cache_shuffler.reset(new VW::cache_shuffler(all.random_seed));
+  }
+  if (!input_options.cache_compression.empty())
+  { all.example_parser->cache_compression = VW::io::parse_compression_format(input_options.cache_compression); }
+  else if (input_options.compressed)
+  {
+    all.example_parser->cache_compression = VW::io::compression_format::gzip;
+  }
+  if (all.example_parser->memory_cache != nullptr)
+  {
+    // the examples of another instance, see VW::initialize_with_memory_cache
+    read_memory_cache(all, quiet);
+  }
+  else
+  {
+    parse_cache(all, input_options.cache_files, input_options.kill_cache, quiet);
+    if (input_options.in_memory)
+    {
+      if (all.daemon || all.active) THROW("in_memory cannot be used in daemon mode");
+      if (!input_options.cache_files.empty())
+      {
+        if (!quiet) all.trace_message << "WARNING: in_memory is ignored in favor of the cache file" << endl;
+      }
+      else
+      {
+        make_memory_cache(all, quiet);
+      }
+    }
+  }
 
   // default text reader
   all.example_parser->text_reader = VW::read_lines;
@@ -367,7 +550,8 @@ void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_opt
     if (::bind(all.example_parser->bound_sock, (sockaddr*)&address, sizeof(address)) < 0) THROWERRNO("bind");
 
     // listen on socket
-    if (listen(all.example_parser->bound_sock, 1) < 0) THROWERRNO("listen");
+    const bool event_loop = all.daemon && !all.active && input_options.daemon_event_loop;
+    if (listen(all.example_parser->bound_sock, event_loop ? SOMAXCONN : 1) < 0) THROWERRNO("listen");
 
     // write port file
     if (all.options->was_supplied("port_file"))
@@ -386,6 +570,9 @@ void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_opt
     // background process (if foreground is not set)
     if (!input_options.foreground)
     {
+#ifdef _WIN32
+      if (event_loop) THROW("--daemon_event_loop requires --foreground on windows");
+#endif
       // FIXME switch to posix_spawn
       if (!all.active && daemon(1, 1)) THROWERRNO("daemon");
     }
@@ -411,14 +598,46 @@ void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_opt
 #endif
     }
 
+    if (event_loop)
+    {
+      if (input_options.json || input_options.dsjson) { set_json_reader(all, input_options.dsjson); }
+      else
+      {
+        set_string_reader(all);
+      }
+      all.chain_hash_json = input_options.chain_hash_json;
+      all.example_parser->daemon_server = std::make_shared<VW::daemon_server>(
+          all, all.example_parser->bound_sock, input_options.json || input_options.dsjson);
+      all.final_prediction_sink.push_back(all.example_parser->daemon_server->create_prediction_writer());
+      all.example_parser->reader = VW::read_daemon_examples;
+      all.print_by_ref = VW::daemon_print_result_by_ref;
+      if (!input_options.reload_model.empty())
+        all.model_reloader = std::make_shared<VW::model_reloader>(all, input_options.reload_model);
+      if (all.options->was_supplied("metrics_port"))
+      {
+        const auto metrics_port =
+            all.example_parser->daemon_server->serve_metrics(static_cast<uint16_t>(input_options.metrics_port));
+        if (!all.logger.quiet) all.trace_message << "serving metrics on port " << metrics_port << endl;
+      }
+      if (!input_options.trace_requests.empty())
+        all.example_parser->daemon_server->trace_requests(
+            input_options.trace_requests, input_options.trace_requests_size);
+      // Connections come and go within a single pass, which ends with SIGTERM.
+      all.example_parser->resettable = false;
+      if (passes > 1) THROW("--daemon_event_loop does not support multiple passes");
+      if (!all.logger.quiet) all.trace_message << "serving connections on port " << port << endl;
+      return;
+    }
+
     if (all.daemon && !all.active)
     {
 #ifdef _WIN32
-      THROW("not supported on windows");
+      THROW("not supported on windows, use --daemon_event_loop");
 #else
       fclose(stdin);
-      // weights will be shared across processes, accessible to children
-      all.weights.share(all.length());
+      // weights will be shared across processes, accessible to children. Attached weights already are, and every
+      // child follows their updates on its own.
+      if (all.attached_weights == nullptr) all.weights.share(all.length());
 
       // learning state to be shared across children
       shared_data* sd =
@@ -522,12 +741,27 @@ void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_opt
 
       auto should_use_compressed = input_options.compressed || ends_with(all.data_filename, ".gz");
 
+      if (!input_options.kafka.topic.empty())
+      {
+        if (temp != "" || !input_options.extra_data_files.empty()) THROW("--kafka_topic replaces the data files");
+        if (input_options.json || input_options.dsjson || input_options.flatbuffer || input_options.arrow ||
+            input_options.parquet)
+          THROW("--kafka_topic reads text examples, its save commands are text");
+        if (all.final_regressor_name.empty()) THROW("--kafka_topic commits its offsets once the model of -f is saved");
+        if (all.save_in_background) THROW("--kafka_topic must wait for the model to be saved to commit its offsets");
+      }
+
       try
       {
         std::unique_ptr<VW::io::reader> adapter;
-        if (temp != "")
+        if (!input_options.kafka.topic.empty())
+        {
+          if (!quiet) all.trace_message << "Reading Kafka topic = " << input_options.kafka.topic << endl;
+          adapter = VW::io::open_kafka_reader(input_options.kafka, all.commit_checkpoint);
+        }
+        else if (temp != "")
         {
-          adapter = should_use_compressed ? VW::io::open_compressed_file_reader(temp) : VW::io::open_file_reader(temp);
+          adapter = open_input_file_reader(all, temp, should_use_compressed);
         }
         else if (!all.stdin_off)
         {
@@ -540,6 +774,13 @@ void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_opt
         }
 
         if (adapter) { all.example_parser->input->add_file(std::move(adapter)); }
+        for (const auto& file : input_options.extra_data_files)
+        {
+          temp = file;
+          if (!quiet) all.trace_message << "Reading datafile = " << temp << endl;
+          all.example_parser->input->add_file(
+              open_input_file_reader(all, temp, input_options.compressed || ends_with(temp, ".gz")));
+        }
       }
       catch (std::exception const&)
       {
@@ -564,9 +805,25 @@ void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_opt
       }
       else if (input_options.flatbuffer)
       {
-        all.flat_converter = VW::make_unique<VW::parsers::flatbuffer::parser>();
+        all.flat_converter =
+            VW::make_unique<VW::parsers::flatbuffer::parser>(input_options.flatbuffer_limit * 1024 * 1024);
         all.example_parser->reader = VW::parsers::flatbuffer::flatbuffer_to_examples;
       }
+      else if (input_options.arrow || input_options.parquet)
+      {
+        if (input_options.arrow && input_options.parquet) THROW("--arrow and --parquet can't be used together");
+        // the columns are read from the file itself, which Parquet needs to seek in
+        if (temp.empty()) THROW("--arrow and --parquet read a data file, not stdin");
+        if (!input_options.extra_data_files.empty()) THROW("--arrow and --parquet read a single data file");
+        if (input_options.columnar_schema.empty()) THROW("--arrow and --parquet need a --columnar_schema");
+        std::ifstream schema_file(input_options.columnar_schema);
+        if (!schema_file) THROW("can't open --columnar_schema " << input_options.columnar_schema);
+        all.columnar_converter = VW::make_unique<VW::parsers::columnar::parser>(all, temp,
+            input_options.parquet ? VW::parsers::columnar::file_format::parquet
+                                  : VW::parsers::columnar::file_format::arrow,
+            VW::parsers::columnar::read_schema(schema_file));
+        all.example_parser->reader = VW::parsers::columnar::columnar_to_examples;
+      }
       else
       {
         set_string_reader(all);
@@ -607,11 +864,7 @@ void feature_limit(vw& all, example* ex)
 {
   for (namespace_index index : ex->indices)
     if (all.limit[index] < ex->feature_space[index].size())
-    {
-      features& fs = ex->feature_space[index];
-      fs.sort(all.parse_mask);
-      unique_features(fs, all.limit[index]);
-    }
+      limit_features(ex->feature_space[index], all.parse_mask, all.limit[index]);
 }
 
 namespace VW
@@ -635,12 +888,22 @@ void setup_examples(vw& all, v_array<example*>& examples)
 
 void setup_example(vw& all, example* ae)
 {
+  VW::stage_timer timer(all.profiler != nullptr ? &all.profiler->setup_example : nullptr);
+  VW_ALLOCATION_SITE(parser);
   if (all.example_parser->sort_features && ae->sorted == false) unique_sort_features(all.parse_mask, ae);
 
   if (all.example_parser->write_cache)
   {
-    all.example_parser->lbl_parser.cache_label(&ae->l, *(all.example_parser->output));
-    cache_features(*(all.example_parser->output), ae, all.parse_mask);
+    auto& cache_writer = all.example_parser->cache_writer;
+    io_buf& cache = cache_writer != nullptr ? cache_writer->block() : *all.example_parser->output;
+    all.example_parser->lbl_parser.cache_label(&ae->l, cache);
+    if (cache_writer != nullptr)
+    {
+      cache_writer->cache_features(ae, all.parse_mask);
+      cache_writer->example_written();
+    }
+    else
+      cache_features(cache, ae, all.parse_mask);
   }
 
   ae->partial_prediction = 0.;
@@ -819,6 +1082,31 @@ void empty_example(vw& /*all*/, example& ec)
   ec._reduction_features.clear();
 }
 
+// The bytes of the storage held by the feature groups of an example.
+size_t feature_storage_bytes(example& ec)
+{
+  size_t bytes = 0;
+  for (features& fs : ec.feature_space)
+  {
+    bytes += (fs.values.end_array - fs.values.begin()) * sizeof(feature_value);
+    bytes += (fs.indicies.end_array - fs.indicies.begin()) * sizeof(feature_index);
+    bytes += fs.space_names.capacity() * sizeof(audit_strings_ptr);
+  }
+  return bytes;
+}
+
+// Gives back the storage of the emptied feature groups beyond capacity features, which a few very large examples would
+// otherwise leave the pool holding for the rest of the run.
+void trim_feature_storage(example& ec, size_t capacity)
+{
+  for (features& fs : ec.feature_space)
+  {
+    if (static_cast<size_t>(fs.values.end_array - fs.values.begin()) > capacity) { fs.values.resize(capacity); }
+    if (static_cast<size_t>(fs.indicies.end_array - fs.indicies.begin()) > capacity) { fs.indicies.resize(capacity); }
+    if (fs.space_names.capacity() > capacity) { std::vector<audit_strings_ptr>().swap(fs.space_names); }
+  }
+}
+
 void clean_example(vw& all, example& ec, bool rewind)
 {
   if (rewind)
@@ -828,6 +1116,7 @@ void clean_example(vw& all, example& ec, bool rewind)
   }
 
   empty_example(all, ec);
+  if (all.example_parser->pool_capacity > 0) { trim_feature_storage(ec, all.example_parser->pool_capacity); }
   VW_WARNING_STATE_PUSH
   VW_WARNING_DISABLE_DEPRECATED_USAGE
   ec.in_use = false;
@@ -847,16 +1136,44 @@ void finish_example(vw& all, example& ec)
     ++all.example_parser->finished_examples;
     all.example_parser->output_done.notify_one();
   }
+  if (all.example_parser->daemon_server != nullptr) all.example_parser->daemon_server->example_finished();
 }
 }  // namespace VW
 
+void flush_dispatch_batch(parser& p)
+{
+  if (p.dispatch_batch.empty()) { return; }
+  p.ready_parsed_examples.push_many(p.dispatch_batch.data(), p.dispatch_batch.size());
+  p.dispatch_batch.clear();
+}
+
 void thread_dispatch(vw& all, const v_array<example*>& examples)
 {
-  all.example_parser->end_parsed_examples += examples.size();
-  for (auto example : examples) { all.example_parser->ready_parsed_examples.push(example); }
+  parser& p = *all.example_parser;
+  p.end_parsed_examples += examples.size();
+  if (p.dispatch_batch_size <= 1)
+  {
+    p.ready_parsed_examples.push_many(examples.begin(), examples.size());
+    return;
+  }
+
+  p.dispatch_batch.insert(p.dispatch_batch.end(), examples.begin(), examples.end());
+  // The learner must see the end of pass example without waiting for the next pass to fill the batch.
+  if (p.dispatch_batch.size() >= p.dispatch_batch_size || (!examples.empty() && examples.last()->end_pass))
+  { flush_dispatch_batch(p); }
+}
+
+void main_parse_loop(vw* all)
+{
+  VW::pin_current_thread(VW::thread_role::parser);
+  parse_dispatch(*all, thread_dispatch);
 }
 
-void main_parse_loop(vw* all) { parse_dispatch(*all, thread_dispatch); }
+void main_parse_loop_pooled(vw* all)
+{
+  VW::pin_current_thread(VW::thread_role::parser);
+  if (VW::parse_dispatch_pooled(*all, thread_dispatch)) { parse_dispatch(*all, thread_dispatch); }
+}
 
 namespace VW
 {
@@ -911,12 +1228,40 @@ void adjust_used_index(vw&)
 
 namespace VW
 {
-void start_parser(vw& all) { all.parse_thread = std::thread(main_parse_loop, &all); }
+void start_parser(vw& all)
+{
+  if (all.example_parser->dispatch_batch_size > 1 &&
+      ((all.daemon && all.example_parser->daemon_server == nullptr) || all.active))
+  {
+    // Clients expect a prediction per line, so examples must not wait in a partially filled batch. The event loop
+    // publishes partial batches itself, see --dispatch_latency.
+    all.trace_message << "Warning: --dispatch_batch_size is ignored in active mode and in daemon mode without "
+                         "--daemon_event_loop."
+                      << endl;
+    all.example_parser->dispatch_batch_size = 1;
+  }
+  all.example_parser->dispatch_batch.reserve(all.example_parser->dispatch_batch_size);
+
+  if (all.example_parser->num_parse_threads > 1)
+  {
+    if (VW::can_use_parser_pool(all))
+    {
+      all.parse_thread = std::thread(main_parse_loop_pooled, &all);
+      return;
+    }
+    all.trace_message << "Warning: --parse_threads is only supported for text and JSON input outside of daemon mode, "
+                         "using a single parse thread."
+                      << endl;
+  }
+  all.parse_thread = std::thread(main_parse_loop, &all);
+}
 }  // namespace VW
 
 void free_parser(vw& all)
 {
   // It is possible to exit early when the queue is not yet empty.
+  for (auto* current : all.example_parser->dispatch_batch) { VW::finish_example(all, *current); }
+  all.example_parser->dispatch_batch.clear();
 
   while (all.example_parser->ready_parsed_examples.size() > 0)
   {
@@ -930,12 +1275,19 @@ void free_parser(vw& all)
 
   std::vector<example*> drain_pool;
   drain_pool.reserve(all.example_parser->example_pool.size());
+  size_t pool_bytes = 0;
   while (!all.example_parser->example_pool.empty())
   {
     example* temp = all.example_parser->example_pool.get_object();
+    if (all.example_parser->report_pool_memory) { pool_bytes += VW::feature_storage_bytes(*temp); }
     temp->delete_unions(all.example_parser->lbl_parser.delete_label, all.delete_prediction);
     drain_pool.push_back(temp);
   }
+  if (all.example_parser->report_pool_memory && !all.logger.quiet)
+  {
+    all.trace_message << "example pool: " << drain_pool.size() << " examples keep " << pool_bytes
+                      << " bytes of feature storage" << endl;
+  }
   for (auto* example_ptr : drain_pool) { all.example_parser->example_pool.return_object(example_ptr); }
 }
 
@@ -3,6 +3,9 @@
 // license as described in the file LICENSE.
 #pragma once
 #include "io_buf.h"
+#include "cache.h"
+#include "audit_strings_cache.h"
+#include "feature_hash_cache.h"
 #include "parse_primitives.h"
 #include "example.h"
 #include "future_compat.h"
@@ -23,17 +26,32 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 #include "vw_string_view.h"
 #include "queue.h"
 #include "object_pool.h"
 
 struct vw;
 struct input_options;
+template <bool audit>
+struct json_parser;
+namespace VW
+{
+class daemon_server;
+
+// How the parser pool reads several data files, see --concurrent_input.
+enum class input_interleave
+{
+  sequential,   // one after another
+  round_robin,  // at once, handing the learner a chunk of lines of each file in turn
+  unordered     // at once, handing the learner the chunks in the order they were read
+};
+}
 struct parser
 {
-  parser(size_t ring_size, bool strict_parse_)
+  parser(size_t ring_size, bool strict_parse_, VW::queue_type queue = VW::queue_type::mutex)
       : example_pool{ring_size}
-      , ready_parsed_examples{ring_size}
+      , ready_parsed_examples{ring_size, queue}
       , ring_size{ring_size}
       , begin_parsed_examples(0)
       , end_parsed_examples(0)
@@ -76,6 +94,11 @@ struct parser
   shared_data* _shared_data = nullptr;
 
   hash_func_t hasher;
+  // hashstring and hashall of --hash_function whatever --hash is, for the spelling features and the bindings
+  hash_func_t string_hasher = hashstring;
+  hash_func_t all_hasher = hashall;
+  std::unique_ptr<VW::feature_hash_cache> hash_cache;  // remembers the hashes of repeated names, see --hash_cache_size
+  VW::audit_strings_cache audit_strings;               // shared by the features of repeated names in audit mode
   bool resettable;           // Whether or not the input can be reset.
   io_buf* output = nullptr;  // Where to output the cache.
   std::string currentname;
@@ -84,8 +107,31 @@ struct parser
   bool write_cache = false;
   bool sort_features = false;
   bool sorted_cache = false;
+  bool mmap_input = false;         // memory map uncompressed input and cache files instead of reading them
+  size_t read_ahead_buffers = 0;   // buffers filled ahead of the parser on an I/O thread, 0 reads synchronously
+  bool compressed = false;         // read files as gzip and write block compressed caches
+  size_t compression_threads = 1;  // threads deflating caches and inflating block compressed inputs
+  VW::io::compression_format cache_compression = VW::io::compression_format::none;  // format of cache files written
+
+  // Cache file layout, see cache.h. Binary daemon mode clients send format 1 or 2 as well.
+  size_t cache_format = 1;         // of the cache being read
+  size_t write_cache_format = 2;   // of caches which are created
+  size_t cache_block_size = 1024;  // examples per block of format 2 caches which are created
+  bool cache_dedup = false;        // store the features repeated within a block once, see --cache_dedup
+  size_t cache_examples_left_in_block = 0;
+  VW::cache_dictionary cache_dictionary;                 // of the format 2 cache block being read
+  std::unique_ptr<VW::cache_block_writer> cache_writer;  // set while a format 2 cache is written
+  std::vector<std::string> cache_file_names;            // of the input files while caches are read
+  std::unique_ptr<VW::cache_shuffler> cache_shuffler;    // set with --cache_shuffle
+  std::shared_ptr<std::vector<char>> memory_cache;       // format 2 cache of the first pass, set with --in_memory
+
+  // JSON parsers reused from line to line, shared_ptr because they are only declared here, see parse_example_json.h
+  std::shared_ptr<json_parser<false>> json_parser_state;
+  std::shared_ptr<json_parser<true>> audit_json_parser_state;
 
   const size_t ring_size;
+  size_t pool_capacity = 0;        // features a namespace of a pooled example keeps storage for, 0 keeps all
+  bool report_pool_memory = false;  // set with --pool_capacity
   std::atomic<uint64_t> begin_parsed_examples;  // The index of the beginning parsed example.
   std::atomic<uint64_t> end_parsed_examples;    // The index of the fully parsed example.
   std::atomic<uint64_t> finished_examples;      // The count of finished examples.
@@ -102,6 +148,7 @@ struct parser
   v_array<size_t> counts;  // partial examples received from sources
   size_t finished_count;   // the number of finished examples;
   int bound_sock = 0;
+  std::shared_ptr<VW::daemon_server> daemon_server;  // set with --daemon_event_loop, see daemon_server.h
 
   std::vector<VW::string_view> parse_name;
 
@@ -112,9 +159,23 @@ struct parser
 
   bool strict_parse;
   std::exception_ptr exc_ptr;
+
+  size_t num_parse_threads = 1;  // text parsing workers, more than one replaces the single parse loop with a pool
+  bool unordered_parse = false;  // hand examples parsed by the pool to the learner in completion order
+  VW::input_interleave input_interleave = VW::input_interleave::sequential;
+
+  size_t dispatch_batch_size = 1;        // number of examples published to ready_parsed_examples at once
+  size_t dispatch_latency = 0;  // microseconds a partial batch may wait for more input with --daemon_event_loop
+  std::vector<example*> dispatch_batch;  // examples parsed but not yet published, only touched by the parse thread
 };
 
 void enable_sources(vw& all, bool quiet, size_t passes, input_options& input_options);
+// Opens a data file as --data does, with the compression, mapping and read ahead the options of all ask for.
+std::unique_ptr<VW::io::reader> open_input_file_reader(vw& all, const std::string& file_path, bool compressed);
+// Writes the header of a cache file of the given format and returns its size.
+size_t write_cache_header(vw& all, io_buf& output, size_t format);
+// Selects the reader of a daemon mode connection from its first byte, see VW::DAEMON_BLOCKS_MARKER.
+void set_daemon_reader(vw& all, bool json = false, bool dsjson = false);
 
 VW_DEPRECATED("Function is no longer used")
 void adjust_used_index(vw& all);
@@ -122,6 +183,8 @@ void adjust_used_index(vw& all);
 // parser control
 void lock_done(parser& p);
 void set_done(vw& all);
+// publish any examples held back by dispatch_batch_size, must be called from the parse thread
+void flush_dispatch_batch(parser& p);
 
 // source control functions
 void reset_source(vw& all, size_t numbits);
@@ -0,0 +1,455 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "parse_example_columnar.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+#include "../../best_constant.h"
+#include "../../example.h"
+#include "../../global_data.h"
+#include "../../memory.h"
+#include "../../parse_primitives.h"
+#include "../../vw_exception.h"
+
+#ifdef VW_USE_ARROW
+#  include <arrow/api.h>
+#  include <arrow/io/file.h>
+#  include <arrow/ipc/reader.h>
+#  include <parquet/arrow/reader.h>
+#endif
+
+namespace VW
+{
+namespace parsers
+{
+namespace columnar
+{
+std::vector<column_spec> read_schema(std::istream& in)
+{
+  std::vector<column_spec> schema;
+  std::string line;
+  std::vector<VW::string_view> words;
+  bool has_role[3] = {false, false, false};  // of the label, weight and tag columns, which there is one of at most
+  while (std::getline(in, line))
+  {
+    const auto comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+    std::replace(line.begin(), line.end(), '\t', ' ');
+    tokenize(' ', line, words);
+    if (words.empty()) continue;
+    if (words.size() > 3 || words.size() < 2)
+      THROW("--columnar_schema lines are <column> <role> [<namespace>], not: " << line);
+
+    column_spec spec;
+    spec.column = std::string(words[0].begin(), words[0].size());
+    spec.ns = " ";
+    const auto& role = words[1];
+    if (role == "label")
+      spec.role = column_role::label;
+    else if (role == "weight")
+      spec.role = column_role::weight;
+    else if (role == "tag")
+      spec.role = column_role::tag;
+    else if (role == "numeric")
+      spec.role = column_role::numeric;
+    else if (role == "categorical")
+      spec.role = column_role::categorical;
+    else
+      THROW("unknown role '" << role << "' of column '" << spec.column
+                             << "' in --columnar_schema, the roles are label, weight, tag, numeric and categorical");
+
+    if (spec.role == column_role::numeric || spec.role == column_role::categorical)
+    {
+      if (words.size() == 3) spec.ns = std::string(words[2].begin(), words[2].size());
+    }
+    else
+    {
+      if (words.size() == 3)
+        THROW("only numeric and categorical columns have a namespace in --columnar_schema: " << line);
+      bool& seen = has_role[static_cast<int>(spec.role)];
+      if (seen) THROW("--columnar_schema has more than one " << role << " column");
+      seen = true;
+    }
+    schema.push_back(spec);
+  }
+  if (schema.empty()) THROW("--columnar_schema has no columns");
+  return schema;
+}
+
+int columnar_to_examples(vw* all, v_array<example*>& examples)
+{
+  return static_cast<int>(all->columnar_converter->parse_example(all, examples[0]));
+}
+
+#ifdef VW_USE_ARROW
+namespace
+{
+using numeric_reader = float (*)(const ::arrow::Array&, int64_t);
+using text_reader = VW::string_view (*)(const ::arrow::Array&, int64_t, std::string&);
+
+template <typename ArrayT>
+float numeric_value(const ::arrow::Array& values, int64_t row)
+{
+  return static_cast<float>(static_cast<const ArrayT&>(values).Value(row));
+}
+
+template <typename ArrayT>
+VW::string_view string_text(const ::arrow::Array& values, int64_t row, std::string&)
+{
+  const auto text = static_cast<const ArrayT&>(values).GetView(row);
+  return VW::string_view(text.data(), text.size());
+}
+
+template <typename ArrayT>
+VW::string_view integer_text(const ::arrow::Array& values, int64_t row, std::string& scratch)
+{
+  scratch = std::to_string(static_cast<const ArrayT&>(values).Value(row));
+  return scratch;
+}
+
+numeric_reader numeric_reader_of(::arrow::Type::type type)
+{
+  switch (type)
+  {
+    case ::arrow::Type::BOOL:
+      return numeric_value<::arrow::BooleanArray>;
+    case ::arrow::Type::INT8:
+      return numeric_value<::arrow::Int8Array>;
+    case ::arrow::Type::INT16:
+      return numeric_value<::arrow::Int16Array>;
+    case ::arrow::Type::INT32:
+      return numeric_value<::arrow::Int32Array>;
+    case ::arrow::Type::INT64:
+      return numeric_value<::arrow::Int64Array>;
+    case ::arrow::Type::UINT8:
+      return numeric_value<::arrow::UInt8Array>;
+    case ::arrow::Type::UINT16:
+      return numeric_value<::arrow::UInt16Array>;
+    case ::arrow::Type::UINT32:
+      return numeric_value<::arrow::UInt32Array>;
+    case ::arrow::Type::UINT64:
+      return numeric_value<::arrow::UInt64Array>;
+    case ::arrow::Type::FLOAT:
+      return numeric_value<::arrow::FloatArray>;
+    case ::arrow::Type::DOUBLE:
+      return numeric_value<::arrow::DoubleArray>;
+    default:
+      return nullptr;
+  }
+}
+
+text_reader text_reader_of(::arrow::Type::type type)
+{
+  switch (type)
+  {
+    case ::arrow::Type::STRING:
+      return string_text<::arrow::StringArray>;
+    case ::arrow::Type::LARGE_STRING:
+      return string_text<::arrow::LargeStringArray>;
+    case ::arrow::Type::INT8:
+      return integer_text<::arrow::Int8Array>;
+    case ::arrow::Type::INT16:
+      return integer_text<::arrow::Int16Array>;
+    case ::arrow::Type::INT32:
+      return integer_text<::arrow::Int32Array>;
+    case ::arrow::Type::INT64:
+      return integer_text<::arrow::Int64Array>;
+    case ::arrow::Type::UINT8:
+      return integer_text<::arrow::UInt8Array>;
+    case ::arrow::Type::UINT16:
+      return integer_text<::arrow::UInt16Array>;
+    case ::arrow::Type::UINT32:
+      return integer_text<::arrow::UInt32Array>;
+    case ::arrow::Type::UINT64:
+      return integer_text<::arrow::UInt64Array>;
+    default:
+      return nullptr;
+  }
+}
+
+// The examples of text files hash the default namespace to this, and the others as names.
+uint64_t namespace_hash(vw& all, const std::string& ns)
+{
+  if (ns == " ") return all.hash_seed == 0 ? 0 : uniform_hash("", 0, all.hash_seed);
+  return all.example_parser->hasher(ns.data(), ns.size(), all.hash_seed);
+}
+
+struct column
+{
+  column_spec spec;
+  namespace_index index = 0;
+  // the feature of a numeric column, and what the cells of a categorical one are hashed with
+  uint64_t column_hash = 0;
+
+  // bound to the current batch
+  std::shared_ptr<::arrow::Array> values;
+  numeric_reader numeric = nullptr;
+  text_reader text = nullptr;  // of the cells, or of the dictionary entries of dictionary encoded columns
+  const ::arrow::DictionaryArray* dictionary = nullptr;
+  std::vector<uint64_t> dictionary_hashes;
+};
+
+void check(const ::arrow::Status& status, const std::string& file)
+{
+  if (!status.ok()) THROW("can't read '" << file << "': " << status.ToString());
+}
+
+template <typename T>
+T value_of(::arrow::Result<T> result, const std::string& file)
+{
+  check(result.status(), file);
+  return std::move(result).ValueOrDie();
+}
+}  // namespace
+
+struct parser::batch_reader
+{
+  std::string file_name;
+  std::shared_ptr<::arrow::io::ReadableFile> file;
+  std::shared_ptr<::arrow::ipc::RecordBatchFileReader> arrow_reader;
+  int next_arrow_batch = 0;
+  std::unique_ptr<::parquet::arrow::FileReader> parquet_reader;
+  std::unique_ptr<::arrow::RecordBatchReader> parquet_batches;
+
+  std::shared_ptr<::arrow::RecordBatch> batch;
+  int64_t row = 0;
+  std::vector<column> columns;  // the label column first, so that the weight column overrides what it sets
+  std::vector<namespace_index> namespaces;
+  std::string scratch;  // of integer and numeric labels and of audit names
+
+  bool next_batch(vw& all)
+  {
+    do
+    {
+      if (arrow_reader != nullptr)
+      {
+        if (next_arrow_batch == arrow_reader->num_record_batches()) return false;
+        batch = value_of(arrow_reader->ReadRecordBatch(next_arrow_batch++), file_name);
+      }
+      else
+      {
+        check(parquet_batches->ReadNext(&batch), file_name);
+        if (batch == nullptr) return false;
+      }
+    } while (batch->num_rows() == 0);
+
+    row = 0;
+    for (auto& c : columns) bind(all, c);
+    return true;
+  }
+
+  void bind(vw& all, column& c)
+  {
+    const int field = batch->schema()->GetFieldIndex(c.spec.column);
+    if (field < 0) THROW("column '" << c.spec.column << "' of --columnar_schema is not in '" << file_name << "'");
+    c.values = batch->column(field);
+    c.dictionary = nullptr;
+
+    auto type = c.values->type_id();
+    const ::arrow::Array* text_values = c.values.get();
+    if (type == ::arrow::Type::DICTIONARY && c.spec.role == column_role::categorical)
+    {
+      c.dictionary = static_cast<const ::arrow::DictionaryArray*>(c.values.get());
+      text_values = c.dictionary->dictionary().get();
+      type = text_values->type_id();
+    }
+    c.numeric = numeric_reader_of(type);
+    c.text = text_reader_of(type);
+
+    const auto& type_name = c.values->type()->ToString();
+    switch (c.spec.role)
+    {
+      case column_role::label:
+        if (c.numeric == nullptr && c.text == nullptr)
+          THROW("label column '" << c.spec.column << "' is " << type_name << ", not a number or a string");
+        break;
+      case column_role::weight:
+      case column_role::numeric:
+        if (c.numeric == nullptr)
+          THROW("column '" << c.spec.column << "' is " << type_name << ", not a number");
+        break;
+      case column_role::tag:
+        if (type != ::arrow::Type::STRING && type != ::arrow::Type::LARGE_STRING)
+          THROW("tag column '" << c.spec.column << "' is " << type_name << ", not a string");
+        break;
+      case column_role::categorical:
+        if (c.text == nullptr)
+          THROW("categorical column '" << c.spec.column << "' is " << type_name << ", not a string or an integer");
+        break;
+    }
+
+    // the entries of a dictionary are hashed once for all the rows of the batch
+    if (c.dictionary != nullptr)
+    {
+      c.dictionary_hashes.resize(static_cast<size_t>(text_values->length()));
+      for (int64_t i = 0; i < text_values->length(); i++)
+      {
+        if (text_values->IsNull(i)) continue;
+        const auto text = c.text(*text_values, i, scratch);
+        c.dictionary_hashes[i] = all.example_parser->hasher(text.begin(), text.size(), c.column_hash);
+      }
+    }
+  }
+};
+
+parser::parser(vw& all, const std::string& file, file_format format, const std::vector<column_spec>& schema)
+    : _reader(VW::make_unique<batch_reader>())
+{
+  auto& r = *_reader;
+  r.file_name = file;
+  r.file = value_of(::arrow::io::ReadableFile::Open(file), file);
+
+  for (const auto& spec : schema)
+  {
+    if (spec.role == column_role::weight && all.example_parser->lbl_parser.label_type != label_type_t::simple)
+      THROW("a weight column of --columnar_schema needs simple labels, other labels are weighted by their label");
+
+    column c;
+    c.spec = spec;
+    c.index = static_cast<namespace_index>(spec.ns[0]);
+    c.column_hash = all.example_parser->hasher(spec.column.data(), spec.column.size(), namespace_hash(all, spec.ns));
+    r.columns.push_back(c);
+    if ((spec.role == column_role::numeric || spec.role == column_role::categorical) &&
+        std::find(r.namespaces.begin(), r.namespaces.end(), c.index) == r.namespaces.end())
+      r.namespaces.push_back(c.index);
+  }
+  std::stable_partition(
+      r.columns.begin(), r.columns.end(), [](const column& c) { return c.spec.role == column_role::label; });
+
+  if (format == file_format::arrow)
+  {
+    r.arrow_reader = value_of(::arrow::ipc::RecordBatchFileReader::Open(r.file), file);
+    return;
+  }
+
+  check(::parquet::arrow::OpenFile(r.file, ::arrow::default_memory_pool(), &r.parquet_reader), file);
+  // only the columns of the schema are decoded
+  const auto* parquet_schema = r.parquet_reader->parquet_reader()->metadata()->schema();
+  std::vector<int> column_indices;
+  for (const auto& c : r.columns)
+  {
+    const int index = parquet_schema->ColumnIndex(c.spec.column);
+    if (index < 0) THROW("column '" << c.spec.column << "' of --columnar_schema is not in '" << file << "'");
+    column_indices.push_back(index);
+  }
+  std::vector<int> row_groups(r.parquet_reader->num_row_groups());
+  std::iota(row_groups.begin(), row_groups.end(), 0);
+  check(r.parquet_reader->GetRecordBatchReader(row_groups, column_indices, &r.parquet_batches), file);
+}
+
+parser::~parser() = default;
+
+namespace
+{
+void add_feature(vw& all, example& ae, const column& c, float value, uint64_t hash, VW::string_view name)
+{
+  auto& fs = ae.feature_space[c.index];
+  fs.push_back(value, hash & all.parse_mask);
+  if (all.audit || all.hash_inv) fs.space_names.push_back(all.example_parser->audit_strings.get(c.spec.ns, name));
+}
+}  // namespace
+
+bool parser::parse_example(vw* all, example* ae)
+{
+  auto& r = *_reader;
+  if ((r.batch == nullptr || r.row == r.batch->num_rows()) && !r.next_batch(*all)) return false;
+  const int64_t row = r.row++;
+
+  auto& p = *all->example_parser;
+  p.lbl_parser.default_label(&ae->l);
+  for (const auto& c : r.columns)
+  {
+    const auto& values = *c.values;
+    if (values.IsNull(row)) continue;
+    switch (c.spec.role)
+    {
+      case column_role::label:
+        if (c.numeric != nullptr && p.lbl_parser.label_type == label_type_t::simple)
+        {
+          ae->l.simple.label = c.numeric(values, row);
+          count_label(all->sd, ae->l.simple.label);
+        }
+        else
+        {
+          VW::string_view label;
+          if (c.text != nullptr)
+            label = c.text(values, row, r.scratch);
+          else
+          {
+            char number[32];
+            const int length = snprintf(number, sizeof(number), "%.9g", c.numeric(values, row));
+            r.scratch.assign(number, static_cast<size_t>(length));
+            label = r.scratch;
+          }
+          tokenize(' ', label, p.words);
+          p.lbl_parser.parse_label(&p, all->sd, &ae->l, p.words, ae->_reduction_features);
+        }
+        break;
+      case column_role::weight:
+        ae->l.simple.weight = c.numeric(values, row);
+        break;
+      case column_role::tag:
+      {
+        const auto tag = c.text(values, row, r.scratch);
+        push_many(ae->tag, tag.begin(), tag.size());
+      }
+      break;
+      case column_role::numeric:
+      {
+        const float value = c.numeric(values, row);
+        // as in text examples, features of value 0 are left out
+        if (value != 0.f) add_feature(*all, *ae, c, value, c.column_hash, c.spec.column);
+      }
+      break;
+      case column_role::categorical:
+      {
+        uint64_t hash;
+        VW::string_view text;
+        if (c.dictionary != nullptr)
+        {
+          const int64_t entry = c.dictionary->GetValueIndex(row);
+          hash = c.dictionary_hashes[entry];
+          if (all->audit || all->hash_inv) text = c.text(*c.dictionary->dictionary(), entry, r.scratch);
+        }
+        else
+        {
+          text = c.text(values, row, r.scratch);
+          hash = p.hasher(text.begin(), text.size(), c.column_hash);
+        }
+        if (all->audit || all->hash_inv)
+        {
+          const std::string name = c.spec.column + "=" + std::string(text.begin(), text.size());
+          add_feature(*all, *ae, c, 1.f, hash, name);
+        }
+        else
+          add_feature(*all, *ae, c, 1.f, hash, VW::string_view());
+      }
+      break;
+    }
+  }
+
+  for (namespace_index index : r.namespaces)
+    if (ae->feature_space[index].nonempty()) ae->indices.push_back(index);
+  return true;
+}
+#else
+struct parser::batch_reader
+{
+};
+
+parser::parser(vw&, const std::string&, file_format, const std::vector<column_spec>&)
+{
+  THROW("--arrow and --parquet need vw to be built with USE_ARROW");
+}
+
+parser::~parser() = default;
+
+bool parser::parse_example(vw*, example*) { return false; }
+#endif
+}  // namespace columnar
+}  // namespace parsers
+}  // namespace VW
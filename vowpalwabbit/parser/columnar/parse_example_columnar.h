@@ -0,0 +1,77 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../v_array.h"
+
+struct vw;
+struct example;
+
+namespace VW
+{
+namespace parsers
+{
+namespace columnar
+{
+enum class column_role
+{
+  label,
+  weight,
+  tag,
+  numeric,
+  categorical
+};
+
+// A column the examples are made of.
+struct column_spec
+{
+  std::string column;
+  column_role role;
+  std::string ns;  // of numeric and categorical columns, " " when the schema gives none
+};
+
+// Reads a --columnar_schema, a line per column with '#' starting comments:
+//   <column> label|weight|tag|numeric|categorical [<namespace>]
+// Numeric columns are a feature named after the column with the value of the cell, categorical columns a feature of
+// value 1 chain hashed from the column and the cell as --chain_hash hashes JSON strings. Label cells are parsed as the
+// labels of text examples.
+std::vector<column_spec> read_schema(std::istream& in);
+
+enum class file_format
+{
+  arrow,
+  parquet
+};
+
+int columnar_to_examples(vw* all, v_array<example*>& examples);
+
+// Makes an example of each row of an Arrow IPC file or a Parquet file, decoding a record batch at a time. The columns
+// of a batch are bound and their names hashed once, and the features of dictionary encoded categorical columns once
+// per dictionary entry, so the rows only cost their values. Throws when vw was built without USE_ARROW.
+class parser
+{
+public:
+  parser(vw& all, const std::string& file, file_format format, const std::vector<column_spec>& schema);
+  ~parser();
+
+  parser(const parser&) = delete;
+  parser& operator=(const parser&) = delete;
+
+  // Fills ae with the next row, returns false past the last one.
+  bool parse_example(vw* all, example* ae);
+
+private:
+  struct batch_reader;
+  std::unique_ptr<batch_reader> _reader;
+};
+}  // namespace columnar
+}  // namespace parsers
+}  // namespace VW
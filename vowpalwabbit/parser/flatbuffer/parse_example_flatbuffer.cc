@@ -24,6 +24,8 @@ int flatbuffer_to_examples(vw* all, v_array<example*>& examples)
   return static_cast<int>(all->flat_converter->parse_examples(all, examples));
 }
 
+constexpr size_t parser::DEFAULT_MAX_OBJECT_SIZE;
+
 const VW::parsers::flatbuffer::ExampleRoot* parser::data() { return _data; }
 
 bool parser::parse(vw* all, uint8_t* buffer_pointer)
@@ -42,9 +44,16 @@ bool parser::parse(vw* all, uint8_t* buffer_pointer)
   if (len < sizeof(uint32_t)) { return false; }
 
   _object_size = flatbuffers::ReadScalar<flatbuffers::uoffset_t>(line);
+  if (_object_size > _max_object_size)
+  {
+    THROW("flatbuffer object of " << _object_size << " bytes exceeds --flatbuffer_limit of "
+                                  << _max_object_size << " bytes, the input is corrupt or the limit too low");
+  }
 
   // read one object, object size defined by the read prefix
-  all->example_parser->input->buf_read(line, _object_size);
+  len = all->example_parser->input->buf_read(line, _object_size);
+  if (len < _object_size)
+  { THROW("flatbuffer input ends within an object, " << len << " of " << _object_size << " bytes were read"); }
 
   _flatbuffer_pointer = reinterpret_cast<uint8_t*>(line);
   _data = VW::parsers::flatbuffer::GetExampleRoot(_flatbuffer_pointer);
@@ -176,8 +185,44 @@ void parser::parse_namespaces(vw* all, example* ae, const Namespace* ns)
 
   auto& fs = ae->feature_space[temp_index];
 
-  for (const auto& feature : *(ns->features()))
-  { parse_features(all, fs, feature, (all->audit || all->hash_inv) ? ns->name() : nullptr); }
+  if (flatbuffers::IsFieldPresent(ns, Namespace::VT_FEATURES))
+  {
+    fs.reserve(ns->features()->size());
+    for (const auto& feature : *(ns->features()))
+    { parse_features(all, fs, feature, (all->audit || all->hash_inv) ? ns->name() : nullptr); }
+  }
+  if (flatbuffers::IsFieldPresent(ns, Namespace::VT_FEATURE_HASHES)) { parse_feature_columns(fs, ns); }
+}
+
+// The columns are copied with one memcpy each. Pointing fs into the flatbuffer instead is not possible because
+// examples own their feature storage and reuse it for the next example.
+void parser::parse_feature_columns(features& fs, const Namespace* ns)
+{
+  const auto* hashes = ns->feature_hashes();
+  const auto* values = ns->feature_values();
+  if (values == nullptr || values->size() != hashes->size())
+  {
+    THROW("flatbuffer namespace has " << hashes->size() << " feature hashes but "
+                                      << (values == nullptr ? 0 : values->size()) << " feature values");
+  }
+
+  const size_t old_size = fs.size();
+  const size_t new_size = old_size + hashes->size();
+  fs.reserve(hashes->size());
+
+#if FLATBUFFERS_LITTLEENDIAN
+  memcpy(fs.values.begin() + old_size, values->data(), values->size() * sizeof(float));
+  memcpy(fs.indicies.begin() + old_size, hashes->data(), hashes->size() * sizeof(uint64_t));
+#else
+  for (flatbuffers::uoffset_t i = 0; i < hashes->size(); i++)
+  {
+    fs.values[old_size + i] = values->Get(i);
+    fs.indicies[old_size + i] = hashes->Get(i);
+  }
+#endif
+  fs.values.end() = fs.values.begin() + new_size;
+  fs.indicies.end() = fs.indicies.begin() + new_size;
+  for (size_t i = old_size; i < new_size; i++) { fs.sum_feat_sq += fs.values[i] * fs.values[i]; }
 }
 
 void parser::parse_features(vw* all, features& fs, const Feature* feature, const flatbuffers::String* ns)
@@ -187,7 +232,10 @@ void parser::parse_features(vw* all, features& fs, const Feature* feature, const
     uint64_t word_hash = all->example_parser->hasher(feature->name()->c_str(), feature->name()->size(), _c_hash);
     fs.push_back(feature->value(), word_hash);
     if ((all->audit || all->hash_inv) && ns != nullptr)
-    { fs.space_names.push_back(std::make_shared<audit_strings>(ns->c_str(), feature->name()->c_str())); }
+    {
+      fs.space_names.push_back(all->example_parser->audit_strings.get(
+          VW::string_view(ns->c_str(), ns->size()), VW::string_view(feature->name()->c_str(), feature->name()->size())));
+    }
   }
   else
   {
@@ -21,7 +21,11 @@ int flatbuffer_to_examples(vw* all, v_array<example*>& examples);
 class parser
 {
 public:
-  parser() = default;
+  // Size prefixed objects read from a file must not be larger than max_object_size bytes, a larger prefix is reported
+  // as corrupt input rather than buffered.
+  explicit parser(size_t max_object_size = DEFAULT_MAX_OBJECT_SIZE) : _max_object_size(max_object_size) {}
+  static constexpr size_t DEFAULT_MAX_OBJECT_SIZE = 1024 * 1024 * 1024;
+
   const VW::parsers::flatbuffer::ExampleRoot* data();
   bool parse_examples(vw* all, v_array<example*>& examples, uint8_t* buffer_pointer = nullptr);
 
@@ -29,6 +33,7 @@ private:
   const VW::parsers::flatbuffer::ExampleRoot* _data;
   uint8_t* _flatbuffer_pointer;
   flatbuffers::uoffset_t _object_size = 0;
+  size_t _max_object_size;
   bool _active_collection = false;
   uint32_t _example_index = 0;
   uint32_t _multi_ex_index = 0;
@@ -43,6 +48,7 @@ private:
   void parse_multi_example(vw* all, example* ae, const MultiExample* eg);
   void parse_namespaces(vw* all, example* ae, const Namespace* ns);
   void parse_features(vw* all, features& fs, const Feature* feature, const flatbuffers::String* ns);
+  void parse_feature_columns(features& fs, const Namespace* ns);
   void parse_flat_label(shared_data* sd, example* ae, const Example* eg);
 
   void parse_simple_label(shared_data* sd, polylabel* l, const SimpleLabel* label);
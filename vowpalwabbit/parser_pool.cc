@@ -0,0 +1,536 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "parser_pool.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "global_data.h"
+#include "parser.h"
+#include "parse_example.h"
+#include "parse_example_json.h"
+#include "thread_affinity.h"
+#include "vw.h"
+
+namespace
+{
+// Number of lines handed to a worker at a time.
+constexpr size_t lines_per_chunk = 64;
+
+// Reads up to max_lines lines from the input into chunk, and when to_example_end on to the empty line which ends a
+// multi line example. Returns false once the input has been exhausted.
+bool fill_chunk(io_buf& input, VW::parse_chunk& chunk, size_t max_lines, bool to_example_end = false)
+{
+  while (chunk.lines.size() < max_lines || (to_example_end && chunk.lines.back().second != 0))
+  {
+    char* line;
+    size_t num_chars;
+    size_t num_chars_initial = read_features(input, line, num_chars);
+    if (num_chars_initial < 1) { return false; }
+
+    const size_t offset = chunk.text.size();
+    chunk.text.insert(chunk.text.end(), line, line + num_chars);
+    chunk.text.push_back('\0');
+    chunk.lines.emplace_back(offset, num_chars);
+  }
+  return true;
+}
+
+void parse_text_lines(vw& all, parser& scratch, VW::parse_chunk& chunk)
+{
+  for (const auto& line : chunk.lines)
+  {
+    example& ex = VW::get_unused_example(&all);
+    chunk.examples.push_back(&ex);
+    substring_to_example(&all, &scratch, &ex, VW::string_view(chunk.text.data() + line.first, line.second));
+  }
+}
+
+// Every line is one event, which becomes one example or, for multi line learners, the examples of the event followed
+// by an empty one. event holds the unused example the next line is parsed into.
+template <bool audit>
+void parse_json_lines(vw& all, parser& scratch, VW::parse_chunk& chunk, v_array<example*>& event)
+{
+  for (const auto& line : chunk.lines)
+  {
+    if (event.empty()) { event.push_back(&VW::get_unused_example(&all)); }
+    if (!parse_line_json<audit>(&all, scratch, chunk.text.data() + line.first, line.second, event)) { continue; }
+    append_empty_newline_example_for_driver(&all, scratch, event);
+    for (auto* ex : event) { chunk.examples.push_back(ex); }
+    event.clear();
+  }
+}
+
+// Reads the data files of a pass at once for --concurrent_input. Each file is read by one of up to --parse_threads
+// threads into chunks of its own, which the pool parses, and next() hands the chunks out a chunk of each file in turn
+// for round_robin, the files which were read to the end dropping out of the turn, or in the order they were read.
+class concurrent_files
+{
+public:
+  concurrent_files(vw& all, VW::parser_pool& pool, bool round_robin) : _all(all), _pool(pool), _round_robin(round_robin)
+  {
+    auto& input = *all.example_parser->input;
+    const size_t num_threads = std::min(input.input_files.size(), all.example_parser->num_parse_threads);
+    // enough chunks to keep the pool busy when there are few files, and one to read ahead with while one is parsed
+    const size_t chunks_per_file = std::max<size_t>(2, 2 * all.example_parser->num_parse_threads / num_threads);
+    for (auto& reader : input.input_files)
+    {
+      _turn.push_back(_files.size());
+      _files.emplace_back(new input_file);
+      auto& file = *_files.back();
+      file.input.add_file(std::move(reader));  // unprofiled, --stage_timing counters are not shared between threads
+      for (size_t i = 0; i < chunks_per_file; i++)
+      {
+        file.chunks.emplace_back(new VW::parse_chunk);
+        file.free_chunks.push_back(file.chunks.back().get());
+      }
+    }
+    input.input_files.clear();
+    input.reset_buffer();
+
+    // a multi line text example must not be split between chunks, which the chunks of other files can come between
+    const bool to_example_end = all.l->is_multiline && all.example_parser->reader == read_features_string;
+    _readers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; i++)
+    { _readers.emplace_back(&concurrent_files::read_loop, this, i, num_threads, to_example_end); }
+  }
+
+  ~concurrent_files()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _stop = true;
+    }
+    _changed.notify_all();
+    for (auto& reader : _readers) { reader.join(); }
+
+    // Examples which were parsed but never handed off still belong to the pool, and the files go back to the input
+    // for reset_source.
+    for (auto& file : _files)
+    {
+      for (auto* chunk : file->read)
+      {
+        _pool.wait_for(chunk);
+        for (auto* ex : chunk->examples) { VW::finish_example(_all, *ex); }
+      }
+      _all.example_parser->input->add_file(std::move(file->input.input_files.front()));
+    }
+  }
+
+  concurrent_files(const concurrent_files&) = delete;
+  concurrent_files& operator=(const concurrent_files&) = delete;
+
+  // Blocks until the next chunk is parsed and returns it, or nullptr once every file was read to the end. Rethrows
+  // what reading a file threw.
+  VW::parse_chunk* next()
+  {
+    VW::parse_chunk* chunk = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(_lock);
+      while (chunk == nullptr)
+      {
+        if (_exc_ptr) { std::rethrow_exception(_exc_ptr); }
+        _handed_out = _round_robin ? next_turn() : next_read();
+        if (_handed_out == NO_FILE)
+        {
+          if (_num_exhausted == _files.size() && (_round_robin ? _turn.empty() : _read_order.empty())) return nullptr;
+          _changed.wait(lock);
+          continue;
+        }
+        chunk = _files[_handed_out]->read.front();
+        _files[_handed_out]->read.pop_front();
+      }
+    }
+    _pool.wait_for(chunk);
+    return chunk;
+  }
+
+  // Gives the chunk next() returned back to its file, after its examples were handed off.
+  void release(VW::parse_chunk* chunk)
+  {
+    chunk->reset();
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      _files[_handed_out]->free_chunks.push_back(chunk);
+    }
+    _changed.notify_all();
+  }
+
+private:
+  static constexpr size_t NO_FILE = static_cast<size_t>(-1);
+
+  struct input_file
+  {
+    io_buf input;
+    std::vector<std::unique_ptr<VW::parse_chunk>> chunks;
+    std::vector<VW::parse_chunk*> free_chunks;
+    std::deque<VW::parse_chunk*> read;  // submitted to the pool, in the order of the file
+    bool exhausted = false;             // no more chunks are read from it
+  };
+
+  // The file whose turn it is if its next chunk was read, otherwise NO_FILE.
+  size_t next_turn()
+  {
+    while (!_turn.empty())
+    {
+      const size_t file = _turn[_turn_index];
+      if (!_files[file]->read.empty())
+      {
+        _turn_index = (_turn_index + 1) % _turn.size();
+        return file;
+      }
+      if (!_files[file]->exhausted) return NO_FILE;
+      _turn.erase(_turn.begin() + _turn_index);
+      if (_turn_index == _turn.size()) _turn_index = 0;
+    }
+    return NO_FILE;
+  }
+
+  // The file of the chunk which was read first, NO_FILE if none is waiting.
+  size_t next_read()
+  {
+    if (_read_order.empty()) return NO_FILE;
+    const size_t file = _read_order.front();
+    _read_order.pop_front();
+    return file;
+  }
+
+  // Reads the files first, first + stride, ... taking them in turn as they have free chunks.
+  void read_loop(size_t first, size_t stride, bool to_example_end)
+  {
+    VW::pin_current_thread(VW::thread_role::parser);
+    std::vector<size_t> own;
+    for (size_t i = first; i < _files.size(); i += stride) { own.push_back(i); }
+    size_t next_own = 0;
+    try
+    {
+      while (true)
+      {
+        size_t index = NO_FILE;
+        bool reading = false;
+        VW::parse_chunk* chunk = nullptr;
+        {
+          std::unique_lock<std::mutex> lock(_lock);
+          _changed.wait(lock, [&] {
+            reading = false;
+            for (size_t k = 0; k < own.size() && index == NO_FILE; k++)
+            {
+              const size_t i = own[(next_own + k) % own.size()];
+              if (_files[i]->exhausted) { continue; }
+              reading = true;
+              if (!_files[i]->free_chunks.empty())
+              {
+                index = i;
+                next_own = (next_own + k + 1) % own.size();
+              }
+            }
+            return _stop || !reading || index != NO_FILE;
+          });
+          if (_stop || !reading) { return; }
+          chunk = _files[index]->free_chunks.back();
+          _files[index]->free_chunks.pop_back();
+        }
+
+        auto& file = *_files[index];
+        const bool more = fill_chunk(file.input, *chunk, lines_per_chunk, to_example_end);
+        const bool has_lines = !chunk->lines.empty();
+        if (has_lines) { _pool.submit(chunk); }
+        {
+          std::lock_guard<std::mutex> lock(_lock);
+          if (has_lines)
+          {
+            file.read.push_back(chunk);
+            _read_order.push_back(index);
+          }
+          else
+          {
+            file.free_chunks.push_back(chunk);
+          }
+          if (!more)
+          {
+            file.exhausted = true;
+            _num_exhausted++;
+          }
+        }
+        _changed.notify_all();
+      }
+    }
+    catch (...)
+    {
+      {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_exc_ptr) { _exc_ptr = std::current_exception(); }
+      }
+      _changed.notify_all();
+    }
+  }
+
+  vw& _all;
+  VW::parser_pool& _pool;
+  const bool _round_robin;
+
+  std::vector<std::unique_ptr<input_file>> _files;
+  std::vector<size_t> _turn;  // the files not yet read to the end, in turn
+  size_t _turn_index = 0;
+  std::deque<size_t> _read_order;  // the files of the chunks waiting to be handed out, in the order they were read
+  size_t _num_exhausted = 0;
+  size_t _handed_out = NO_FILE;  // the file of the chunk next() returned
+  bool _stop = false;
+  std::exception_ptr _exc_ptr;
+
+  std::mutex _lock;
+  std::condition_variable _changed;
+  std::vector<std::thread> _readers;
+};
+
+constexpr size_t concurrent_files::NO_FILE;
+
+// Whether the files of this pass are read at once, which takes more than one of them. The --examples and
+// --initial_pass_length limits are only exact when reading one file after another.
+bool reads_files_concurrently(vw& all)
+{
+  return all.example_parser->input_interleave != VW::input_interleave::sequential &&
+      all.example_parser->input->num_input_files() > 1 && all.max_examples == std::numeric_limits<size_t>::max() &&
+      all.pass_length == std::numeric_limits<size_t>::max();
+}
+}  // namespace
+
+namespace VW
+{
+parser_pool::parser_pool(vw& all, size_t num_threads) : _all(all), _pending(2 * num_threads)
+{
+  _workers.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; i++) { _workers.emplace_back(&parser_pool::worker_loop, this); }
+}
+
+parser_pool::~parser_pool()
+{
+  _pending.set_done();
+  for (auto& worker : _workers) { worker.join(); }
+}
+
+void parser_pool::submit(parse_chunk* chunk) { _pending.push(chunk); }
+
+void parser_pool::wait_for(parse_chunk* chunk)
+{
+  std::unique_lock<std::mutex> lock(_parsed_lock);
+  _parsed_cv.wait(lock, [chunk] { return chunk->parsed; });
+}
+
+parse_chunk* parser_pool::wait_for_any(std::deque<parse_chunk*>& in_flight)
+{
+  std::unique_lock<std::mutex> lock(_parsed_lock);
+  auto it = in_flight.end();
+  _parsed_cv.wait(lock, [&] {
+    it = std::find_if(in_flight.begin(), in_flight.end(), [](parse_chunk* chunk) { return chunk->parsed; });
+    return it != in_flight.end();
+  });
+  auto* chunk = *it;
+  in_flight.erase(it);
+  return chunk;
+}
+
+void parser_pool::worker_loop()
+{
+  VW::pin_current_thread(VW::thread_role::parser);
+  // The scratch parser holds no examples of its own, it only provides the per thread tokenizer state.
+  parser* shared = _all.example_parser;
+  parser scratch{0, shared->strict_parse};
+  scratch.hasher = shared->hasher;
+  scratch.string_hasher = shared->string_hasher;
+  scratch.all_hasher = shared->all_hasher;
+  if (shared->hash_cache != nullptr)
+  { scratch.hash_cache.reset(new VW::feature_hash_cache(shared->hash_cache->entries_per_namespace())); }
+  scratch.lbl_parser = shared->lbl_parser;
+  scratch._shared_data = shared->_shared_data;
+  v_array<example*> event = v_init<example*>();
+
+  while (auto* chunk = _pending.pop())
+  {
+    try
+    {
+      if (shared->reader == &read_features_json<true>) { parse_json_lines<true>(_all, scratch, *chunk, event); }
+      else if (shared->reader == &read_features_json<false>)
+      {
+        parse_json_lines<false>(_all, scratch, *chunk, event);
+      }
+      else
+      {
+        parse_text_lines(_all, scratch, *chunk);
+      }
+    }
+    catch (...)
+    {
+      // The examples of the event which failed are returned with the others of the chunk.
+      for (auto* ex : event) { chunk->examples.push_back(ex); }
+      event.clear();
+      chunk->exc_ptr = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_parsed_lock);
+      chunk->parsed = true;
+    }
+    _parsed_cv.notify_all();
+  }
+
+  for (auto* ex : event) { VW::finish_example(_all, *ex); }
+  event.delete_v();
+
+  if (scratch.hash_cache != nullptr)
+  {
+    std::lock_guard<std::mutex> lock(_parsed_lock);
+    shared->hash_cache->add_counts(*scratch.hash_cache);
+  }
+}
+
+bool can_use_parser_pool(vw& all)
+{
+  // Daemon and active mode clients expect a prediction per line, so lines must not be held back to fill a chunk.
+  auto* reader = all.example_parser->reader;
+  const bool line_oriented =
+      reader == read_features_string || reader == &read_features_json<true> || reader == &read_features_json<false>;
+  return line_oriented && !all.daemon && !all.active;
+}
+
+bool parse_dispatch_pooled(vw& all, const std::function<void(vw&, const v_array<example*>&)>& dispatch)
+{
+  parser& p = *all.example_parser;
+  const size_t max_in_flight = 2 * p.num_parse_threads;
+
+  std::vector<std::unique_ptr<parse_chunk>> chunks;
+  std::vector<parse_chunk*> free_chunks;
+  for (size_t i = 0; i < max_in_flight; i++)
+  {
+    chunks.emplace_back(new parse_chunk);
+    free_chunks.push_back(chunks.back().get());
+  }
+  std::deque<parse_chunk*> in_flight;
+
+  v_array<example*> examples = v_init<example*>();
+  size_t example_number = 0;  // for variable-size batch learning algorithms
+  bool continue_serially = false;
+
+  parser_pool pool(all, p.num_parse_threads);
+
+  auto next_parsed = [&]() {
+    if (p.unordered_parse) { return pool.wait_for_any(in_flight); }
+    auto* chunk = in_flight.front();
+    in_flight.pop_front();
+    pool.wait_for(chunk);
+    return chunk;
+  };
+
+  // Setting up examples touches the cache writer and holdout counters so it is done here, in hand-off order.
+  auto hand_off = [&](parse_chunk* chunk) {
+    if (chunk->exc_ptr) { std::rethrow_exception(chunk->exc_ptr); }
+    VW::setup_examples(all, chunk->examples);
+    dispatch(all, chunk->examples);
+    chunk->reset();
+  };
+  auto commit = [&](parse_chunk* chunk) {
+    free_chunks.push_back(chunk);
+    hand_off(chunk);
+  };
+
+  try
+  {
+    while (!p.done)
+    {
+      bool end_of_pass =
+          all.do_reset_source || example_number == all.pass_length || all.max_examples <= example_number;
+      if (!end_of_pass && example_number == 0 && reads_files_concurrently(all))
+      {
+        concurrent_files files(all, pool, p.input_interleave == VW::input_interleave::round_robin);
+        while (auto* chunk = files.next())
+        {
+          example_number += chunk->lines.size();
+          hand_off(chunk);
+          files.release(chunk);
+        }
+        end_of_pass = true;
+      }
+      if (!end_of_pass)
+      {
+        auto* chunk = free_chunks.back();
+        free_chunks.pop_back();
+        const size_t max_lines = std::min(
+            lines_per_chunk, std::min(all.pass_length - example_number, all.max_examples - example_number));
+        end_of_pass = !fill_chunk(*p.input, *chunk, max_lines);
+        example_number += chunk->lines.size();
+
+        if (chunk->lines.empty()) { free_chunks.push_back(chunk); }
+        else
+        {
+          in_flight.push_back(chunk);
+          pool.submit(chunk);
+        }
+        if (!end_of_pass && free_chunks.empty()) { commit(next_parsed()); }
+      }
+
+      if (end_of_pass)
+      {
+        // Everything read during this pass must reach the learner before the end of pass example.
+        while (!in_flight.empty()) { commit(next_parsed()); }
+
+        reset_source(all, all.num_bits);
+        all.do_reset_source = false;
+        all.passes_complete++;
+
+        // setup an end_pass example
+        examples.push_back(&VW::get_unused_example(&all));
+        all.example_parser->lbl_parser.default_label(&examples[0]->l);
+        examples[0]->end_pass = true;
+        all.example_parser->in_pass_counter = 0;
+
+        if (all.passes_complete == all.numpasses && example_number == all.pass_length)
+        {
+          all.passes_complete = 0;
+          all.pass_length = all.pass_length * 2 + 1;
+        }
+        dispatch(all, examples);  // must be called before lock_done or race condition exists.
+        if (all.passes_complete >= all.numpasses && all.max_examples >= example_number) lock_done(*all.example_parser);
+        example_number = 0;
+        examples.clear();
+
+        // reset_source swaps in the cache reader once the first pass has written the cache.
+        if (!p.done && !can_use_parser_pool(all))
+        {
+          continue_serially = true;
+          break;
+        }
+      }
+    }
+  }
+  catch (VW::vw_exception& e)
+  {
+    std::cerr << "vw example #" << example_number << "(" << e.Filename() << ":" << e.LineNumber() << "): " << e.what()
+              << std::endl;
+
+    // Stash the exception so it can be thrown on the main thread.
+    all.example_parser->exc_ptr = std::current_exception();
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "vw: example #" << example_number << e.what() << std::endl;
+
+    // Stash the exception so it can be thrown on the main thread.
+    all.example_parser->exc_ptr = std::current_exception();
+  }
+
+  // Examples which were parsed but never handed off still belong to the pool.
+  while (!in_flight.empty())
+  {
+    auto* chunk = next_parsed();
+    for (auto* ex : chunk->examples) { VW::finish_example(all, *ex); }
+  }
+
+  examples.delete_v();
+  if (continue_serially) { return true; }
+  flush_dispatch_batch(*all.example_parser);
+  lock_done(*all.example_parser);
+  return false;
+}
+}  // namespace VW
@@ -0,0 +1,98 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Mutex, CV and thread cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a
+// managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <mutex>
+#  include <condition_variable>
+#  include <thread>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <mutex>
+#  include <condition_variable>
+#  include <thread>
+#endif
+
+#include "v_array.h"
+#include "queue.h"
+
+struct vw;
+struct example;
+
+namespace VW
+{
+// A run of consecutive input lines. The reading thread fills text and lines, a worker fills examples. The examples of
+// a multi line JSON event are consecutive and never split across chunks.
+struct parse_chunk
+{
+  std::vector<char> text;                        // lines are null terminated so that JSON can be parsed in place
+  std::vector<std::pair<size_t, size_t>> lines;  // (offset, length) of each line in text
+  v_array<example*> examples = v_init<example*>();
+  std::exception_ptr exc_ptr;
+  bool parsed = false;
+
+  parse_chunk() = default;
+  ~parse_chunk() { examples.delete_v(); }
+  parse_chunk(const parse_chunk&) = delete;
+  parse_chunk& operator=(const parse_chunk&) = delete;
+
+  void reset()
+  {
+    text.clear();
+    lines.clear();
+    examples.clear();
+    exc_ptr = nullptr;
+    parsed = false;
+  }
+};
+
+// Fixed set of worker threads which turn text or JSON chunks into examples. Each worker owns a scratch parser so that
+// the tokenizer, JSON reader and hash cache state is never shared.
+class parser_pool
+{
+public:
+  parser_pool(vw& all, size_t num_threads);
+  ~parser_pool();
+
+  parser_pool(const parser_pool&) = delete;
+  parser_pool& operator=(const parser_pool&) = delete;
+
+  void submit(parse_chunk* chunk);
+
+  // Blocks until the given chunk has been parsed.
+  void wait_for(parse_chunk* chunk);
+
+  // Blocks until any chunk in in_flight has been parsed, removes it from in_flight and returns it.
+  parse_chunk* wait_for_any(std::deque<parse_chunk*>& in_flight);
+
+private:
+  void worker_loop();
+
+  vw& _all;
+  VW::ptr_queue<parse_chunk> _pending;
+  std::vector<std::thread> _workers;
+  std::mutex _parsed_lock;
+  std::condition_variable _parsed_cv;
+};
+
+// Whether the configured input can be parsed by a parser_pool. Only line oriented text and JSON input qualifies.
+bool can_use_parser_pool(vw& all);
+
+// Parse loop used in place of parse_dispatch when more than one parse thread was requested. Returns true if the input
+// stopped being pool compatible between passes, in which case the caller must continue with parse_dispatch.
+bool parse_dispatch_pooled(vw& all, const std::function<void(vw&, const v_array<example*>&)>& dispatch);
+}  // namespace VW
@@ -0,0 +1,105 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace VW
+{
+// Philox4x32-10 of Salmon et al., "Parallel random numbers: as easy as 1, 2, 3". It is counter based: the block of four
+// numbers at a counter is a function of the counter and the key alone, so that streams share no state and any of their
+// numbers is drawn directly, whichever thread draws it.
+inline void philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+{
+  constexpr uint64_t M0 = 0xD2511F53;
+  constexpr uint64_t M1 = 0xCD9E8D57;
+  constexpr uint32_t W0 = 0x9E3779B9;
+  constexpr uint32_t W1 = 0xBB67AE85;
+
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < 10; round++)
+  {
+    if (round > 0)
+    {
+      k0 += W0;
+      k1 += W1;
+    }
+    const uint64_t p0 = M0 * c0;
+    const uint64_t p1 = M1 * c2;
+    const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    c0 = n0;
+    c1 = static_cast<uint32_t>(p1);
+    c2 = n2;
+    c3 = static_cast<uint32_t>(p0);
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+// The float in [0, 1) of the 24 high bits of x, which a float holds exactly.
+inline float uniform_of_bits(uint32_t x) { return static_cast<float>(x >> 8) * (1.f / 16777216.f); }
+
+// A stream of uniform floats in [0, 1) drawn with philox4x32, see --random_generator. The stream of an example is keyed by
+// the seed and the purpose of its numbers, and counted from its index, so that its numbers are the same whichever thread
+// learns from it and in whatever order.
+class random_stream
+{
+public:
+  // Purposes, so that the numbers drawn for different ends are independent.
+  static constexpr uint32_t BOOTSTRAP = 1;
+
+  random_stream(uint64_t seed, uint32_t purpose, uint64_t example_index)
+      : _key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) ^ purpose}
+      , _example_index(example_index)
+  {
+  }
+
+  float next()
+  {
+    if (_left == 0)
+    {
+      draw_block(_position++, _block);
+      _left = 4;
+    }
+    return uniform_of_bits(_block[4 - _left--]);
+  }
+
+  // The next n numbers of the stream, a block of four at a time. The blocks are independent of each other, so that the
+  // loop over them vectorizes.
+  void fill(float* out, size_t n)
+  {
+    size_t i = 0;
+    for (; i < n && _left > 0; i++) out[i] = next();
+    const size_t blocks = (n - i) / 4;
+    for (size_t b = 0; b < blocks; b++)
+    {
+      uint32_t block[4];
+      draw_block(_position + b, block);
+      for (size_t j = 0; j < 4; j++) out[i + 4 * b + j] = uniform_of_bits(block[j]);
+    }
+    _position += blocks;
+    for (i += 4 * blocks; i < n; i++) out[i] = next();
+  }
+
+private:
+  void draw_block(uint64_t position, uint32_t block[4]) const
+  {
+    const uint32_t counter[4] = {static_cast<uint32_t>(position), static_cast<uint32_t>(position >> 32),
+        static_cast<uint32_t>(_example_index), static_cast<uint32_t>(_example_index >> 32)};
+    philox4x32(counter, _key, block);
+  }
+
+  uint32_t _key[2];
+  uint64_t _example_index;
+  uint64_t _position = 0;  // of the next block to draw
+  uint32_t _block[4];
+  size_t _left = 0;  // numbers of _block not handed out yet
+};
+}  // namespace VW
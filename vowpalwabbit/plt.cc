@@ -44,8 +44,11 @@ struct plt
   // for prediction
   float threshold;
   uint32_t top_k;
+  uint32_t beam_width;                 // of the level-wise search for top-k labels, or 0 for the exact search
   v_array<polyprediction> node_preds;  // for storing results of base.multipredict
   std::vector<node> node_queue;        // container for queue used for both types of predictions
+  std::vector<node> next_level;        // the children kept by the beam search
+  std::vector<node> top_leaves;        // the best leaves found by the beam search, as a min-heap
 
   // for measuring predictive performance
   std::unordered_set<uint32_t> true_labels;
@@ -105,12 +108,8 @@ void learn(plt& p, single_learner& base, example& ec)
       uint32_t tn = label + p.ti;
       if (tn < p.t)
       {
-        p.positive_nodes.insert(tn);
-        while (tn > 0)
-        {
-          tn = static_cast<uint32_t>(floor(static_cast<float>(tn - 1) / p.kary));
-          p.positive_nodes.insert(tn);
-        }
+        // the path stops at the first node which is on the path of another label already
+        while (p.positive_nodes.insert(tn).second && tn > 0) tn = (tn - 1) / p.kary;
       }
     }
     if (ec.l.multilabels.label_v.last() >= p.k)
@@ -153,6 +152,67 @@ inline float predict_node(uint32_t n, single_learner& base, example& ec)
   return 1.0f / (1.0f + exp(-ec.partial_prediction));
 }
 
+inline bool more_probable(const node& l, const node& r) { return l.p > r.p; }
+
+// Level-wise beam search for the top-k labels. The nodes of a level are kept ordered by number, so the children of a
+// run of consecutive nodes are consecutive too and are scored by one base.multipredict. The nodes no more probable
+// than the k-th best leaf found so far are pruned, as none of their leaves could be in the top-k.
+void predict_beam(plt& p, single_learner& base, example& ec, v_array<uint32_t>& labels)
+{
+  p.top_leaves.clear();
+  p.node_queue.push_back({0, predict_node(0, base, ec)});
+
+  while (!p.node_queue.empty())
+  {
+    p.next_level.clear();
+    for (size_t first = 0, last = 0; first < p.node_queue.size(); first = ++last)
+    {
+      while (last + 1 < p.node_queue.size() && p.node_queue[last + 1].n == p.node_queue[last].n + 1) ++last;
+
+      uint32_t n_child = p.kary * p.node_queue[first].n + 1;
+      const uint32_t count = static_cast<uint32_t>(last - first + 1) * p.kary;
+      ec.l.simple = {FLT_MAX, 1.f, 0.f};
+      base.multipredict(ec, n_child, count, p.node_preds.begin(), false);
+
+      for (uint32_t i = 0; i < count; ++i, ++n_child)
+      {
+        float cp_child = p.node_queue[first + i / p.kary].p * (1.f / (1.f + exp(-p.node_preds[i].scalar)));
+        if (p.top_leaves.size() == p.top_k && cp_child <= p.top_leaves.front().p) continue;
+        if (n_child < p.ti)
+          p.next_level.push_back({n_child, cp_child});
+        else
+        {
+          if (p.top_leaves.size() == p.top_k)
+          {
+            std::pop_heap(p.top_leaves.begin(), p.top_leaves.end(), more_probable);
+            p.top_leaves.pop_back();
+          }
+          p.top_leaves.push_back({n_child, cp_child});
+          std::push_heap(p.top_leaves.begin(), p.top_leaves.end(), more_probable);
+        }
+      }
+    }
+
+    if (p.top_leaves.size() == p.top_k)
+    {
+      const float bound = p.top_leaves.front().p;
+      p.next_level.erase(std::remove_if(p.next_level.begin(), p.next_level.end(),
+                             [bound](const node& n) { return n.p <= bound; }),
+          p.next_level.end());
+    }
+    if (p.next_level.size() > p.beam_width)
+    {
+      std::nth_element(p.next_level.begin(), p.next_level.begin() + p.beam_width, p.next_level.end(), more_probable);
+      p.next_level.resize(p.beam_width);
+    }
+    std::sort(p.next_level.begin(), p.next_level.end(), [](const node& l, const node& r) { return l.n < r.n; });
+    p.node_queue.swap(p.next_level);
+  }
+
+  std::sort(p.top_leaves.begin(), p.top_leaves.end(), more_probable);
+  for (const auto& leaf : p.top_leaves) labels.push_back(leaf.n - p.ti);
+}
+
 template <bool threshold>
 void predict(plt& p, single_learner& base, example& ec)
 {
@@ -217,6 +277,10 @@ void predict(plt& p, single_learner& base, example& ec)
     }
   }
 
+  // top-k prediction with a beam
+  else if (p.beam_width > 0)
+    predict_beam(p, base, ec, preds.label_v);
+
   // top-k prediction
   else
   {
@@ -249,17 +313,17 @@ void predict(plt& p, single_learner& base, example& ec)
         if (preds.label_v.size() >= p.top_k) break;
       }
     }
+  }
 
-    // calculate p@
-    if (p.true_labels.size() > 0)
+  // calculate p@
+  if (!threshold && p.true_labels.size() > 0)
+  {
+    for (size_t i = 0; i < p.top_k && i < preds.label_v.size(); ++i)
     {
-      for (size_t i = 0; i < p.top_k; ++i)
-      {
-        if (p.true_labels.count(preds.label_v[i])) ++p.tp_at[i];
-      }
-      ++p.ec_count;
-      p.true_count += static_cast<uint32_t>(p.true_labels.size());
+      if (p.true_labels.count(preds.label_v[i])) ++p.tp_at[i];
     }
+    ++p.ec_count;
+    p.true_count += static_cast<uint32_t>(p.true_labels.size());
   }
 
   p.node_queue.clear();
@@ -331,7 +395,10 @@ base_learner* plt_setup(options_i& options, vw& all)
                .help("predict labels with conditional marginal probability greater than <thr> threshold"))
       .add(make_option("top_k", tree->top_k)
                .default_value(0)
-               .help("predict top-<k> labels instead of labels above threshold"));
+               .help("predict top-<k> labels instead of labels above threshold"))
+      .add(make_option("beam_width", tree->beam_width)
+               .default_value(0)
+               .help("with --top_k, search the tree level by level keeping the <b> most probable nodes"));
 
   if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
 
@@ -362,7 +429,7 @@ base_learner* plt_setup(options_i& options, vw& all)
   // resize v_arrays
   tree->nodes_time.resize(tree->t);
   std::fill(tree->nodes_time.begin(), tree->nodes_time.end(), all.initial_t);
-  tree->node_preds.resize(tree->kary);
+  tree->node_preds.resize(tree->kary * std::max(tree->beam_width, 1u));
   if (tree->top_k > 0) tree->tp_at.resize(tree->top_k);
 
   learner<plt, example>* l;
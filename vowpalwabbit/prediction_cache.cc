@@ -0,0 +1,126 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "prediction_cache.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "global_data.h"
+#include "learner.h"
+#include "xxh3.h"
+
+namespace
+{
+uint64_t float_bits(float f)
+{
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+// Two unrelated seeds make the two halves of the key.
+constexpr uint64_t high_seed = 0x9e3779b97f4a7c15ULL;
+constexpr uint64_t low_seed = 0xc2b2ae3d27d4eb4fULL;
+}  // namespace
+
+namespace VW
+{
+prediction_cache::prediction_cache(size_t capacity) : _capacity(capacity) { _index.reserve(capacity); }
+
+bool prediction_cache::caches(prediction_type_t pred_type)
+{
+  return pred_type == prediction_type_t::scalar || pred_type == prediction_type_t::scalars ||
+      pred_type == prediction_type_t::multiclass || pred_type == prediction_type_t::prob;
+}
+
+prediction_cache::key prediction_cache::compute_key(vw& all, const example& ec)
+{
+  // What the reductions predict from when they do not learn: the hashed features, the offset they are looked up at
+  // and, for simple labels, the initial prediction.
+  _scratch.clear();
+  _scratch.push_back(ec.ft_offset);
+  if (all.example_parser->lbl_parser.label_type == label_type_t::simple)
+  { _scratch.push_back(float_bits(ec.l.simple.initial)); }
+  for (namespace_index ns : ec.indices)
+  {
+    const features& fs = ec.feature_space[ns];
+    _scratch.push_back((static_cast<uint64_t>(ns) << 32) | fs.size());
+    for (size_t i = 0; i < fs.size(); i++)
+    {
+      _scratch.push_back(fs.indicies[i]);
+      _scratch.push_back(float_bits(fs.values[i]));
+    }
+  }
+  const size_t size = _scratch.size() * sizeof(_scratch[0]);
+  return {xxh3_hash(_scratch.data(), size, high_seed), xxh3_hash(_scratch.data(), size, low_seed)};
+}
+
+bool prediction_cache::lookup(vw& all, example& ec)
+{
+  if (all.model_version != _model_version)
+  {
+    _entries.clear();
+    _index.clear();
+    _model_version = all.model_version;
+  }
+
+  _last_key = compute_key(all, ec);
+  auto found = _index.find(_last_key);
+  if (found == _index.end())
+  {
+    ++_misses;
+    return false;
+  }
+
+  ++_hits;
+  _entries.splice(_entries.begin(), _entries, found->second);
+  const entry& e = _entries.front();
+  ec.partial_prediction = e.partial_prediction;
+  switch (all.l->pred_type)
+  {
+    case prediction_type_t::scalar:
+      ec.pred.scalar = e.scalar;
+      break;
+    case prediction_type_t::prob:
+      ec.pred.prob = e.scalar;
+      break;
+    case prediction_type_t::multiclass:
+      ec.pred.multiclass = e.multiclass;
+      break;
+    case prediction_type_t::scalars:
+      ec.pred.scalars.clear();
+      for (float s : e.scalars) ec.pred.scalars.push_back(s);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void prediction_cache::insert(vw& all, const example& ec)
+{
+  if (_capacity == 0) return;
+  if (_entries.size() == _capacity)
+  {
+    // the least recently used entry makes room, and its storage is reused
+    _index.erase(_entries.back().k);
+    _entries.splice(_entries.begin(), _entries, std::prev(_entries.end()));
+  }
+  else
+  {
+    _entries.emplace_front();
+  }
+
+  entry& e = _entries.front();
+  e.k = _last_key;
+  e.partial_prediction = ec.partial_prediction;
+  const auto pred_type = all.l->pred_type;
+  e.scalar = pred_type == prediction_type_t::prob ? ec.pred.prob : ec.pred.scalar;
+  e.multiclass = ec.pred.multiclass;
+  e.scalars.clear();
+  if (pred_type == prediction_type_t::scalars) e.scalars.assign(ec.pred.scalars.begin(), ec.pred.scalars.end());
+  _index[_last_key] = _entries.begin();
+}
+}  // namespace VW
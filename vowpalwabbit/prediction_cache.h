@@ -0,0 +1,73 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+struct example;
+struct vw;
+enum class prediction_type_t;
+
+namespace VW
+{
+// Bounded least recently used cache of the predictions of single line examples, see --predict_cache. Entries are keyed
+// by a 128 bit hash of the hashed features of the example, and are dropped whenever the weights are replaced, see
+// vw::model_version, so that only predictions of the current model are returned. Only used without learning.
+class prediction_cache
+{
+public:
+  explicit prediction_cache(size_t capacity);
+
+  prediction_cache(const prediction_cache&) = delete;
+  prediction_cache& operator=(const prediction_cache&) = delete;
+
+  // Whether predictions of pred_type can be cached: scalar, scalars, multiclass and prob.
+  static bool caches(prediction_type_t pred_type);
+
+  // Sets the prediction of ec if the cache holds it for the current model and returns true. Otherwise the key of ec is
+  // kept for the insert which follows.
+  bool lookup(vw& all, example& ec);
+  // Caches the prediction of the example last looked up.
+  void insert(vw& all, const example& ec);
+
+  uint64_t hits() const { return _hits; }
+  uint64_t misses() const { return _misses; }
+
+private:
+  struct key
+  {
+    uint64_t high;
+    uint64_t low;
+    bool operator==(const key& other) const { return high == other.high && low == other.low; }
+  };
+  struct key_hash
+  {
+    size_t operator()(const key& k) const { return static_cast<size_t>(k.low); }
+  };
+  struct entry
+  {
+    key k;
+    float partial_prediction;
+    float scalar;  // or prob
+    uint32_t multiclass;
+    std::vector<float> scalars;
+  };
+
+  key compute_key(vw& all, const example& ec);
+
+  size_t _capacity;
+  uint64_t _model_version = 0;
+  std::list<entry> _entries;  // most recently used first
+  std::unordered_map<key, std::list<entry>::iterator, key_hash> _index;
+  std::vector<uint64_t> _scratch;  // the features of the example being hashed
+  key _last_key{0, 0};
+  uint64_t _hits = 0;
+  uint64_t _misses = 0;
+};
+}  // namespace VW
@@ -4,6 +4,7 @@
 #include "gd.h"
 #include <cfloat>
 #include "reductions.h"
+#include "text_format.h"
 
 using namespace VW::config;
 
@@ -14,33 +15,32 @@ struct print
   vw* all;
 };  // regressor, feature loop
 
-void print_feature(vw& /* all */, float value, uint64_t index)
+void print_feature(VW::text_line& line, float value, uint64_t index)
 {
-  cout << index;
-  if (value != 1.) cout << ":" << value;
-  cout << " ";
+  line.add_uint(index);
+  if (value != 1.) line.add(':').add_general(value);
+  line.add(' ');
 }
 
 void learn(print& p, VW::LEARNER::base_learner&, example& ec)
 {
+  auto& line = VW::thread_text_line();
   label_data& ld = ec.l.simple;
   if (ld.label != FLT_MAX)
   {
-    cout << ld.label << " ";
+    line.add_general(ld.label).add(' ');
     if (ec.weight != 1 || ld.initial != 0)
     {
-      cout << ec.weight << " ";
-      if (ld.initial != 0) cout << ld.initial << " ";
+      line.add_general(ec.weight).add(' ');
+      if (ld.initial != 0) line.add_general(ld.initial).add(' ');
     }
   }
-  if (!ec.tag.empty())
-  {
-    cout << '\'';
-    cout.write(ec.tag.begin(), ec.tag.size());
-  }
-  cout << "| ";
-  GD::foreach_feature<vw, uint64_t, print_feature>(*(p.all), ec, *p.all);
-  cout << std::endl;
+  if (!ec.tag.empty()) line.add('\'').add(ec.tag.begin(), ec.tag.size());
+  line.add("| ", 2);
+  GD::foreach_feature<VW::text_line, uint64_t, print_feature>(*(p.all), ec, line);
+  line.add('\n');
+  // The lines are left to the buffer of cout, which is flushed on exit, rather than flushed one by one.
+  cout.write(line.str().data(), line.str().size());
 }
 
 VW::LEARNER::base_learner* print_setup(options_i& options, vw& all)
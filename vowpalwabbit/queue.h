@@ -4,32 +4,335 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <queue>
+#include <vector>
 
-// Mutex and CV cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a managed
-// project.
+// Mutex, CV and thread cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a
+// managed project.
 #ifdef _M_CEE
 #  pragma managed(push, off)
 #  undef _M_CEE
 #  include <mutex>
 #  include <condition_variable>
+#  include <thread>
 #  define _M_CEE 001
 #  pragma managed(pop)
 #else
 #  include <mutex>
 #  include <condition_variable>
+#  include <thread>
 #endif
 
 namespace VW
 {
+enum class queue_type
+{
+  mutex,  // std::queue guarded by a mutex
+  spsc,   // lock-free ring, one producing and one consuming thread
+  mpmc    // lock-free ring, any number of producing and consuming threads
+};
+
+namespace details
+{
+constexpr size_t cache_line_size = 64;
+
+// Waits by spinning, then yielding and finally parking on a condition variable. notify() only takes the lock when a
+// thread is actually parked, so a queue which never runs dry or full never makes a futex call.
+class spin_then_park
+{
+public:
+  // ready must read the state it depends on through atomics.
+  template <typename TPredicate>
+  void wait(TPredicate ready)
+  {
+    for (size_t i = 0; i < SPIN_COUNT; i++)
+    {
+      if (ready()) { return; }
+    }
+    for (size_t i = 0; i < YIELD_COUNT; i++)
+    {
+      if (ready()) { return; }
+      std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(_mut);
+    _parked.fetch_add(1);
+    // Pairs with the fence in notify: either the waker sees this thread parked or this thread sees the new state.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _cv.wait(lock, ready);
+    _parked.fetch_sub(1);
+  }
+
+  void notify()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_parked.load(std::memory_order_relaxed) > 0) { notify_all(); }
+  }
+
+  void notify_all()
+  {
+    std::lock_guard<std::mutex> lock(_mut);
+    _cv.notify_all();
+  }
+
+private:
+  static constexpr size_t SPIN_COUNT = 128;
+  static constexpr size_t YIELD_COUNT = 16;
+
+  std::mutex _mut;
+  std::condition_variable _cv;
+  std::atomic<size_t> _parked{0};
+};
+}  // namespace details
+
+// Bounded ring for exactly one producing and one consuming thread. Each side only writes its own index, so neither
+// push nor pop needs a read-modify-write.
+template <typename T>
+class spsc_ptr_ring
+{
+public:
+  spsc_ptr_ring(size_t max_size) : _capacity(max_size), _slots(max_size, nullptr) {}
+
+  void push(T* item) { push_many(&item, 1); }
+
+  // Publishes items with a single release store per run of free slots.
+  void push_many(T* const* items, size_t count)
+  {
+    while (count > 0)
+    {
+      const size_t tail = _tail.load(std::memory_order_relaxed);
+      size_t free_slots = 0;
+      _not_full.wait([&] {
+        free_slots = _capacity - (tail - _head.load(std::memory_order_acquire));
+        return free_slots > 0;
+      });
+
+      const size_t num = std::min(free_slots, count);
+      for (size_t i = 0; i < num; i++) { _slots[(tail + i) % _capacity] = items[i]; }
+      _tail.store(tail + num, std::memory_order_release);
+      _not_empty.notify();
+
+      items += num;
+      count -= num;
+    }
+  }
+
+  T* pop()
+  {
+    T* item = nullptr;
+    return pop_many(&item, 1) == 1 ? item : nullptr;
+  }
+
+  // Blocks until at least one item is available and takes up to max_count. Returns 0 once done and drained.
+  size_t pop_many(T** items, size_t max_count)
+  {
+    const size_t head = _head.load(std::memory_order_relaxed);
+    size_t available = 0;
+    _not_empty.wait([&] {
+      available = _tail.load(std::memory_order_acquire) - head;
+      return available > 0 || _done.load(std::memory_order_acquire);
+    });
+    if (available == 0)
+    {
+      // An item pushed right before set_done must still be delivered.
+      available = _tail.load(std::memory_order_acquire) - head;
+      if (available == 0) { return 0; }
+    }
+
+    const size_t num = std::min(available, max_count);
+    for (size_t i = 0; i < num; i++) { items[i] = _slots[(head + i) % _capacity]; }
+    _head.store(head + num, std::memory_order_release);
+    _not_full.notify();
+    return num;
+  }
+
+  void set_done()
+  {
+    _done.store(true, std::memory_order_release);
+    _not_empty.notify_all();
+    _not_full.notify_all();
+  }
+
+  size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+
+private:
+  const size_t _capacity;
+  std::vector<T*> _slots;
+
+  // Keep the consumer and producer indices on separate cache lines.
+  std::atomic<size_t> _head{0};
+  char _head_padding[details::cache_line_size - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> _tail{0};
+  char _tail_padding[details::cache_line_size - sizeof(std::atomic<size_t>)];
+
+  std::atomic<bool> _done{false};
+  details::spin_then_park _not_empty;
+  details::spin_then_park _not_full;
+};
+
+// Bounded ring for any number of producing and consuming threads. Every slot carries a sequence number which tells
+// whether it is ready to be written or read for a given position, so threads only contend on a single CAS of the
+// shared position.
+template <typename T>
+class mpmc_ptr_ring
+{
+public:
+  mpmc_ptr_ring(size_t max_size) : _capacity(max_size), _cells(new cell[max_size])
+  {
+    for (size_t i = 0; i < _capacity; i++) { _cells[i].sequence.store(i, std::memory_order_relaxed); }
+  }
+
+  void push(T* item) { push_many(&item, 1); }
+
+  void push_many(T* const* items, size_t count)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      if (!try_push(items[i]))
+      {
+        _not_empty.notify();
+        _not_full.wait([&] { return try_push(items[i]); });
+      }
+    }
+    _not_empty.notify();
+  }
+
+  T* pop()
+  {
+    T* item = nullptr;
+    return pop_many(&item, 1) == 1 ? item : nullptr;
+  }
+
+  // Blocks until at least one item is available and takes up to max_count. Returns 0 once done and drained.
+  size_t pop_many(T** items, size_t max_count)
+  {
+    if (max_count == 0) { return 0; }
+
+    bool got_item = false;
+    _not_empty.wait([&] {
+      got_item = try_pop(items[0]);
+      return got_item || _done.load(std::memory_order_acquire);
+    });
+    // An item pushed right before set_done must still be delivered.
+    if (!got_item && !try_pop(items[0])) { return 0; }
+
+    size_t num = 1;
+    while (num < max_count && try_pop(items[num])) { num++; }
+    _not_full.notify();
+    return num;
+  }
+
+  void set_done()
+  {
+    _done.store(true, std::memory_order_release);
+    _not_empty.notify_all();
+    _not_full.notify_all();
+  }
+
+  size_t size() const
+  {
+    const size_t dequeue_pos = _dequeue_pos.load(std::memory_order_acquire);
+    const size_t enqueue_pos = _enqueue_pos.load(std::memory_order_acquire);
+    return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+  }
+
+private:
+  struct cell
+  {
+    std::atomic<size_t> sequence;
+    T* data;
+  };
+
+  bool try_push(T* item)
+  {
+    size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    while (true)
+    {
+      cell& c = _cells[pos % _capacity];
+      const size_t seq = c.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0)
+      {
+        if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          c.data = item;
+          c.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;  // full
+      }
+      else
+      {
+        pos = _enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(T*& item)
+  {
+    size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    while (true)
+    {
+      cell& c = _cells[pos % _capacity];
+      const size_t seq = c.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0)
+      {
+        if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          item = c.data;
+          c.sequence.store(pos + _capacity, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;  // empty
+      }
+      else
+      {
+        pos = _dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  const size_t _capacity;
+  std::unique_ptr<cell[]> _cells;
+
+  std::atomic<size_t> _enqueue_pos{0};
+  char _enqueue_padding[details::cache_line_size - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> _dequeue_pos{0};
+  char _dequeue_padding[details::cache_line_size - sizeof(std::atomic<size_t>)];
+
+  std::atomic<bool> _done{false};
+  details::spin_then_park _not_empty;
+  details::spin_then_park _not_full;
+};
+
 template <typename T>
 class ptr_queue
 {
 public:
-  ptr_queue(size_t max_size) : max_size(max_size) {}
+  ptr_queue(size_t max_size, queue_type type = queue_type::mutex) : max_size(max_size), type(type)
+  {
+    if (type == queue_type::spsc) { spsc_ring.reset(new spsc_ptr_ring<T>(max_size)); }
+    else if (type == queue_type::mpmc)
+    {
+      mpmc_ring.reset(new mpmc_ptr_ring<T>(max_size));
+    }
+  }
 
   T* pop()
   {
+    if (type == queue_type::spsc) { return spsc_ring->pop(); }
+    if (type == queue_type::mpmc) { return mpmc_ring->pop(); }
+
     std::unique_lock<std::mutex> lock(mut);
     while (object_queue.size() == 0 && !done) { is_not_empty.wait(lock); }
 
@@ -42,8 +345,31 @@ public:
     return item;
   }
 
+  // Blocks until at least one item is available and takes up to max_count. Returns 0 once done and drained.
+  size_t pop_many(T** items, size_t max_count)
+  {
+    if (type == queue_type::spsc) { return spsc_ring->pop_many(items, max_count); }
+    if (type == queue_type::mpmc) { return mpmc_ring->pop_many(items, max_count); }
+
+    std::unique_lock<std::mutex> lock(mut);
+    while (object_queue.size() == 0 && !done) { is_not_empty.wait(lock); }
+
+    size_t num = 0;
+    while (num < max_count && !object_queue.empty())
+    {
+      items[num++] = object_queue.front();
+      object_queue.pop();
+    }
+
+    if (num > 0) { is_not_full.notify_all(); }
+    return num;
+  }
+
   void push(T* item)
   {
+    if (type == queue_type::spsc) { return spsc_ring->push(item); }
+    if (type == queue_type::mpmc) { return mpmc_ring->push(item); }
+
     std::unique_lock<std::mutex> lock(mut);
     while (object_queue.size() == max_size) { is_not_full.wait(lock); }
     object_queue.push(item);
@@ -51,8 +377,31 @@ public:
     is_not_empty.notify_all();
   }
 
+  // Pushes all items, waking consumers once per run of free space rather than once per item.
+  void push_many(T* const* items, size_t count)
+  {
+    if (type == queue_type::spsc) { return spsc_ring->push_many(items, count); }
+    if (type == queue_type::mpmc) { return mpmc_ring->push_many(items, count); }
+
+    while (count > 0)
+    {
+      std::unique_lock<std::mutex> lock(mut);
+      while (object_queue.size() == max_size) { is_not_full.wait(lock); }
+      while (count > 0 && object_queue.size() < max_size)
+      {
+        object_queue.push(*items++);
+        count--;
+      }
+
+      is_not_empty.notify_all();
+    }
+  }
+
   void set_done()
   {
+    if (type == queue_type::spsc) { return spsc_ring->set_done(); }
+    if (type == queue_type::mpmc) { return mpmc_ring->set_done(); }
+
     {
       std::unique_lock<std::mutex> lock(mut);
       done = true;
@@ -63,12 +412,16 @@ public:
 
   size_t size() const
   {
+    if (type == queue_type::spsc) { return spsc_ring->size(); }
+    if (type == queue_type::mpmc) { return mpmc_ring->size(); }
+
     std::unique_lock<std::mutex> lock(mut);
     return object_queue.size();
   }
 
 private:
   size_t max_size;
+  queue_type type;
   std::queue<T*> object_queue;
   mutable std::mutex mut;
 
@@ -76,5 +429,8 @@ private:
 
   std::condition_variable is_not_full;
   std::condition_variable is_not_empty;
+
+  std::unique_ptr<spsc_ptr_ring<T>> spsc_ring;
+  std::unique_ptr<mpmc_ptr_ring<T>> mpmc_ring;
 };
 }  // namespace VW
@@ -7,6 +7,7 @@
 #include <float.h>
 #include <sstream>
 #include <memory>
+#include <unordered_map>
 
 #include "reductions.h"
 #include "rand48.h"
@@ -42,7 +43,8 @@ struct node
   double entropy;
   double passes;
 
-  v_array<node_pred> preds;
+  v_array<node_pred> preds;                              // by decreasing label_count
+  std::unordered_map<uint32_t, uint32_t> pred_positions;  // of the labels in preds
 
   node()
       : parent(0)
@@ -122,12 +124,9 @@ void init_tree(recall_tree& b)
 
 node_pred* find(recall_tree& b, uint32_t cn, example& ec)
 {
-  node_pred* ls;
-
-  for (ls = b.nodes[cn].preds.begin(); ls != b.nodes[cn].preds.end() && ls->label != ec.l.multi.label; ++ls)
-    ;
-
-  return ls;
+  node& n = b.nodes[cn];
+  auto position = n.pred_positions.find(ec.l.multi.label);
+  return position == n.pred_positions.end() ? n.preds.end() : n.preds.begin() + position->second;
 }
 
 node_pred* find_or_create(recall_tree& b, uint32_t cn, example& ec)
@@ -137,6 +136,7 @@ node_pred* find_or_create(recall_tree& b, uint32_t cn, example& ec)
   if (ls == b.nodes[cn].preds.end())
   {
     node_pred newls(ec.l.multi.label);
+    b.nodes[cn].pred_positions[newls.label] = static_cast<uint32_t>(b.nodes[cn].preds.size());
     b.nodes[cn].preds.push_back(newls);
     ls = b.nodes[cn].preds.end() - 1;
   }
@@ -202,6 +202,8 @@ void insert_example_at_node(recall_tree& b, uint32_t cn, example& ec)
   while (ls != b.nodes[cn].preds.begin() && ls[-1].label_count < ls[0].label_count)
   {
     std::swap(ls[-1], ls[0]);
+    b.nodes[cn].pred_positions[ls[0].label]++;
+    b.nodes[cn].pred_positions[ls[-1].label]--;
     --ls;
   }
 
@@ -274,13 +276,8 @@ uint32_t oas_predict(recall_tree& b, single_learner& base, uint32_t cn, example&
 
 bool is_candidate(recall_tree& b, uint32_t cn, example& ec)
 {
-  for (node_pred* ls = b.nodes[cn].preds.begin();
-       ls != b.nodes[cn].preds.end() && ls < b.nodes[cn].preds.begin() + b.max_candidates; ++ls)
-  {
-    if (ls->label == ec.l.multi.label) return true;
-  }
-
-  return false;
+  node_pred* ls = find(b, cn, ec);
+  return ls != b.nodes[cn].preds.end() && ls < b.nodes[cn].preds.begin() + b.max_candidates;
 }
 
 inline uint32_t descend(node& n, float prediction) { return prediction < 0 ? n.left : n.right; }
@@ -455,6 +452,7 @@ void save_load_tree(recall_tree& b, io_buf& model_file, bool read, bool text)
       if (read)
       {
         cn->preds.clear();
+        cn->pred_positions.clear();
 
         for (uint32_t k = 0; k < n_preds; ++k) { cn->preds.push_back(node_pred(0)); }
       }
@@ -465,6 +463,8 @@ void save_load_tree(recall_tree& b, io_buf& model_file, bool read, bool text)
 
         writeit(pred->label, "label");
         writeit(pred->label_count, "label_count");
+
+        if (read) { cn->pred_positions[pred->label] = k; }
       }
 
       if (read) { compute_recall_lbest(b, cn); }
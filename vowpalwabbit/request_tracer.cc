@@ -0,0 +1,250 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "request_tracer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+
+#include "example.h"
+#include "vw_exception.h"
+
+namespace
+{
+using time_point = VW::request_trace::time_point;
+
+int highest_bit(uint64_t value)
+{
+  int bit = 0;
+  while (value >>= 1) bit++;
+  return bit;
+}
+
+uint64_t nanoseconds(time_point from, time_point to)
+{
+  if (to <= from) return 0;
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+// The times a phase starts and ends at.
+std::pair<time_point, time_point> bounds(const VW::request_trace& trace, size_t phase)
+{
+  switch (phase)
+  {
+    case VW::request_tracer::parse:
+      return {trace.received, trace.parsed};
+    case VW::request_tracer::dispatch:
+      return {trace.parsed, trace.queued};
+    case VW::request_tracer::queue:
+      return {trace.queued, trace.started};
+    case VW::request_tracer::compute:
+      return {trace.started, trace.predicted};
+    case VW::request_tracer::respond:
+      return {trace.predicted, trace.written};
+    default:
+      return {trace.received, trace.written};
+  }
+}
+
+void write_json_string(std::ostream& out, const std::string& s)
+{
+  out << '"';
+  for (char c : s)
+  {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+      out << escaped;
+    }
+    else
+      out << c;
+  }
+  out << '"';
+}
+}  // namespace
+
+namespace VW
+{
+constexpr uint64_t hdr_histogram::SUB_BUCKETS;
+constexpr size_t hdr_histogram::NUM_BUCKETS;
+
+void hdr_histogram::record(uint64_t value)
+{
+  size_t bucket;
+  if (value < SUB_BUCKETS)
+    bucket = static_cast<size_t>(value);
+  else
+  {
+    // the 7 highest bits of the value, of which the first is set
+    const int shift = highest_bit(value) - 6;
+    bucket = SUB_BUCKETS + (shift - 1) * SUB_BUCKETS / 2 + ((value >> shift) - SUB_BUCKETS / 2);
+  }
+  _counts[bucket]++;
+  _count++;
+  _max = std::max(_max, value);
+}
+
+uint64_t hdr_histogram::value_at_quantile(double quantile) const
+{
+  if (_count == 0) return 0;
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(_count))));
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++)
+  {
+    seen += _counts[bucket];
+    if (seen < rank) continue;
+    if (bucket < SUB_BUCKETS) return std::min<uint64_t>(bucket, _max);
+    const size_t shift = (bucket - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+    const uint64_t sub_bucket = (bucket - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+    return std::min(((sub_bucket + 1) << shift) - 1, _max);
+  }
+  return _max;
+}
+
+const char* request_tracer::phase_name(size_t p)
+{
+  static const char* const names[NUM_PHASES] = {"parse", "dispatch", "queue", "compute", "respond", "total"};
+  return p < NUM_PHASES ? names[p] : "unknown";
+}
+
+request_tracer::request_tracer(const std::string& file, size_t capacity)
+    : _file(file), _capacity(std::max<size_t>(capacity, 1)), _start(std::chrono::steady_clock::now())
+{
+  if (!_file.is_open()) THROW("--trace_requests cannot write to " << file);
+  _finished.reserve(std::min<size_t>(_capacity, 1 << 16));
+}
+
+void request_tracer::parsed(const v_array<example*>& examples, uint64_t example, time_point received)
+{
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(_lock);
+  for (auto* ec : examples)
+  {
+    _in_flight.emplace_back();
+    auto& trace = _in_flight.back();
+    trace.example = example++;
+    trace.tag.assign(ec->tag.begin(), ec->tag.end());
+    trace.received = received;
+    trace.parsed = now;
+  }
+}
+
+void request_tracer::queued(uint64_t end_example)
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  if (end_example <= _queued_end) return;
+  const auto now = std::chrono::steady_clock::now();
+  // the examples of the batch were parsed after those being learned
+  for (auto it = _in_flight.rbegin(); it != _in_flight.rend() && it->example >= _queued_end; ++it)
+    if (it->example < end_example) it->queued = now;
+  _queued_end = end_example;
+}
+
+void request_tracer::predicted(uint64_t example)
+{
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(_lock);
+  if (_in_flight.empty() || _in_flight.front().example != example) return;
+  auto& trace = _in_flight.front();
+  if (trace.predicted == time_point()) trace.predicted = now;
+}
+
+void request_tracer::written(uint64_t example)
+{
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(_lock);
+  while (!_in_flight.empty() && _in_flight.front().example < example) _in_flight.pop_front();
+  if (_in_flight.empty() || _in_flight.front().example != example) return;
+
+  auto trace = std::move(_in_flight.front());
+  _in_flight.pop_front();
+  // What was not seen happened with the step before, e.g. the last batch is published as the input ends.
+  if (trace.queued == time_point()) trace.queued = trace.parsed;
+  trace.started = std::max(trace.queued, _last_written);
+  if (trace.predicted == time_point()) trace.predicted = now;
+  trace.written = now;
+  _last_written = now;
+
+  for (size_t p = 0; p < NUM_PHASES; p++)
+  {
+    const auto phase = bounds(trace, p);
+    _histograms[p].record(nanoseconds(phase.first, phase.second));
+  }
+  if (_finished.size() < _capacity)
+    _finished.push_back(std::move(trace));
+  else
+    _finished[_next_finished] = std::move(trace);
+  _next_finished = (_next_finished + 1) % _capacity;
+}
+
+std::array<hdr_histogram, request_tracer::NUM_PHASES> request_tracer::histograms()
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  return _histograms;
+}
+
+std::vector<request_trace> request_tracer::traces()
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  std::vector<request_trace> traces;
+  traces.reserve(_finished.size());
+  const size_t oldest = _finished.size() < _capacity ? 0 : _next_finished;
+  for (size_t i = 0; i < _finished.size(); i++) traces.push_back(_finished[(oldest + i) % _finished.size()]);
+  return traces;
+}
+
+void request_tracer::report(std::ostream& out)
+{
+  const auto all = histograms();
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << "request phases of " << all[total].count() << " examples, microseconds" << std::endl;
+  out << std::left << std::setw(10) << "phase" << std::right;
+  for (const char* heading : {"p50", "p90", "p99", "p99.9", "max"}) out << std::setw(12) << heading;
+  out << std::endl << std::fixed << std::setprecision(1);
+  for (size_t p = 0; p < NUM_PHASES; p++)
+  {
+    out << std::left << std::setw(10) << phase_name(p) << std::right;
+    for (double quantile : {0.5, 0.9, 0.99, 0.999}) out << std::setw(12) << all[p].value_at_quantile(quantile) / 1000.;
+    out << std::setw(12) << all[p].max() / 1000. << std::endl;
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void request_tracer::write_trace()
+{
+  auto microseconds = [this](time_point t) {
+    return std::chrono::duration<double, std::micro>(t - _start).count();
+  };
+  auto write_event = [&](const std::string& name, const char* type, uint64_t id, time_point t) {
+    _file << ",\n{\"name\":";
+    write_json_string(_file, name);
+    _file << ",\"cat\":\"request\",\"ph\":\"" << type << "\",\"id\":" << id << ",\"ts\":" << microseconds(t)
+          << ",\"pid\":1,\"tid\":1}";
+  };
+
+  _file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  _file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"vw daemon requests\"}}";
+  for (const auto& trace : traces())
+  {
+    const std::string name = trace.tag.empty() ? "example " + std::to_string(trace.example) : trace.tag;
+    write_event(name, "b", trace.example, trace.received);
+    for (size_t p = 0; p < total; p++)
+    {
+      const auto phase = bounds(trace, p);
+      write_event(phase_name(p), "b", trace.example, phase.first);
+      write_event(phase_name(p), "e", trace.example, phase.second);
+    }
+    write_event(name, "e", trace.example, trace.written);
+  }
+  _file << "\n]}\n";
+  _file.flush();
+}
+}  // namespace VW
@@ -0,0 +1,132 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Mutex cannot be used in managed C++, tell the compiler that this is unmanaged even if included in a managed project.
+#ifdef _M_CEE
+#  pragma managed(push, off)
+#  undef _M_CEE
+#  include <mutex>
+#  define _M_CEE 001
+#  pragma managed(pop)
+#else
+#  include <mutex>
+#endif
+
+#include "v_array.h"
+
+struct example;
+
+namespace VW
+{
+// Counts values in buckets of a fixed relative width, as an HDR histogram does: values below SUB_BUCKETS are counted
+// exactly and each power of two above them is split in SUB_BUCKETS / 2 buckets, so that a quantile is within 1 in 64
+// of the value recorded, over the whole range of uint64_t, in 30KB.
+class hdr_histogram
+{
+public:
+  static constexpr uint64_t SUB_BUCKETS = 128;
+
+  void record(uint64_t value);
+
+  uint64_t count() const { return _count; }
+  uint64_t max() const { return _max; }
+  // The largest value of the bucket the quantile falls in, at most the largest value recorded. 0 if there are none.
+  uint64_t value_at_quantile(double quantile) const;
+
+private:
+  static constexpr size_t NUM_BUCKETS = SUB_BUCKETS + (64 - 7) * SUB_BUCKETS / 2;
+
+  std::array<uint64_t, NUM_BUCKETS> _counts{};
+  uint64_t _count = 0;
+  uint64_t _max = 0;
+};
+
+// When an example of a --daemon_event_loop request went through each step of being served, see --trace_requests.
+struct request_trace
+{
+  using time_point = std::chrono::steady_clock::time_point;
+
+  uint64_t example;  // number of examples parsed before it
+  std::string tag;
+  time_point received;   // the bytes of its request were complete
+  time_point parsed;     // the reader returned it
+  time_point queued;     // it was published to the learner, which may wait for the dispatch batch to fill
+  time_point started;    // the learner was done with the examples before it and it was published
+  time_point predicted;  // its prediction was written, or if it has none it was finished
+  time_point written;    // the learner was done finishing it and the prediction was sent or queued to be
+};
+
+// Traces the examples of the daemon's requests from when they were received to when their predictions were sent,
+// keeping histograms of the time of each phase in between for all of them and the traces of the last ones, which
+// are written to a file in the Chrome trace event format. The examples are traced in the order they are parsed by
+// the parse thread, which must also tell when they are published, and finished in that order by the learner.
+class request_tracer
+{
+public:
+  // The phases of serving an example, each from one time of request_trace to the next, and all of them.
+  enum phase
+  {
+    parse,     // received to parsed
+    dispatch,  // parsed to queued
+    queue,     // queued to started
+    compute,   // started to predicted
+    respond,   // predicted to written
+    total,     // received to written
+    NUM_PHASES
+  };
+  static const char* phase_name(size_t p);
+
+  // Opens the file the trace is written to, keeping the last capacity examples.
+  request_tracer(const std::string& file, size_t capacity);
+
+  request_tracer(const request_tracer&) = delete;
+  request_tracer& operator=(const request_tracer&) = delete;
+
+  // Called by the parse thread.
+  // Starts tracing the examples the reader returned, the first of them being the example-th parsed.
+  void parsed(const v_array<example*>& examples, uint64_t example, request_trace::time_point received);
+  // All examples before end_example were published to the learner by now.
+  void queued(uint64_t end_example);
+
+  // Called by the learner.
+  // The prediction of the example is being written.
+  void predicted(uint64_t example);
+  // The example was finished, which ends its trace.
+  void written(uint64_t example);
+
+  // The histograms of the phases in nanoseconds, of all examples finished so far.
+  std::array<hdr_histogram, NUM_PHASES> histograms();
+  // The last examples finished, the oldest first.
+  std::vector<request_trace> traces();
+
+  // Prints the quantiles of each phase in microseconds.
+  void report(std::ostream& out);
+  // Writes the traces to the file, each example an async event named after its tag with one nested event per phase.
+  void write_trace();
+
+private:
+  std::ofstream _file;
+  const size_t _capacity;
+  const request_trace::time_point _start;
+
+  std::mutex _lock;
+  std::deque<request_trace> _in_flight;  // parsed and not finished yet, in parse order
+  uint64_t _queued_end = 0;              // examples parsed before this one were published
+  request_trace::time_point _last_written;
+  std::array<hdr_histogram, NUM_PHASES> _histograms;
+  std::vector<request_trace> _finished;  // a ring of the last _capacity examples from _next_finished
+  size_t _next_finished = 0;
+};
+}  // namespace VW
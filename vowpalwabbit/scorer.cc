@@ -38,12 +38,39 @@ inline void multipredict(scorer&, VW::LEARNER::single_learner& base, example& ec
   for (size_t c = 0; c < count; c++) pred[c].scalar = link(pred[c].scalar);
 }
 
+// Only with the identity link is the prediction the base finds the sensitivity at that of the scorer.
+float predict_with_sensitivity_id(scorer& s, VW::LEARNER::base_learner& base, example& ec)
+{
+  s.all->set_minmax(s.all->sd, ec.l.simple.label);
+  const float ret = VW::LEARNER::as_singleline(&base)->predict_with_sensitivity(ec);
+  if (ec.weight > 0 && ec.l.simple.label != FLT_MAX)
+    ec.loss = s.all->loss->getLoss(s.all->sd, ec.pred.scalar, ec.l.simple.label) * ec.weight;
+  return ret;
+}
+
+template <float (*link)(float in)>
+void learn_difference(scorer& s, VW::LEARNER::single_learner& base, example& ec, example& subtrahend)
+{
+  // invariant: not a test label, importance weight > 0
+  s.all->set_minmax(s.all->sd, ec.l.simple.label);
+  base.learn_difference(ec, subtrahend);
+  ec.loss = s.all->loss->getLoss(s.all->sd, ec.pred.scalar, ec.l.simple.label) * ec.weight;
+  ec.pred.scalar = link(ec.pred.scalar);
+}
+
 void update(scorer& s, VW::LEARNER::single_learner& base, example& ec)
 {
   s.all->set_minmax(s.all->sd, ec.l.simple.label);
   base.update(ec);
 }
 
+void multiupdate(scorer& s, VW::LEARNER::single_learner& base, example& ec, size_t count, size_t,
+    const uint32_t* models, const float* labels, const polyprediction* pred)
+{
+  for (size_t c = 0; c < count; c++) s.all->set_minmax(s.all->sd, labels[c]);
+  base.multiupdate(ec, count, models, labels, pred);
+}
+
 // y = f(x) -> [0, 1]
 inline float logistic(float in) { return 1.f / (1.f + correctedExp(-in)); }
 
@@ -74,29 +101,38 @@ VW::LEARNER::base_learner* scorer_setup(options_i& options, vw& all)
   VW::LEARNER::learner<scorer, example>* l;
   void (*multipredict_f)(scorer&, VW::LEARNER::single_learner&, example&, size_t, size_t, polyprediction*, bool) =
       multipredict<id>;
+  void (*learn_difference_f)(scorer&, VW::LEARNER::single_learner&, example&, example&) = learn_difference<id>;
 
   if (link == "identity")
+  {
     l = &init_learner(s, base, predict_or_learn<true, id>, predict_or_learn<false, id>);
+    l->set_predict_with_sensitivity(predict_with_sensitivity_id);
+  }
   else if (link == "logistic")
   {
     l = &init_learner(s, base, predict_or_learn<true, logistic>, predict_or_learn<false, logistic>);
     multipredict_f = multipredict<logistic>;
+    learn_difference_f = learn_difference<logistic>;
   }
   else if (link == "glf1")
   {
     l = &init_learner(s, base, predict_or_learn<true, glf1>, predict_or_learn<false, glf1>);
     multipredict_f = multipredict<glf1>;
+    learn_difference_f = learn_difference<glf1>;
   }
   else if (link == "poisson")
   {
     l = &init_learner(s, base, predict_or_learn<true, expf>, predict_or_learn<false, expf>);
     multipredict_f = multipredict<expf>;
+    learn_difference_f = learn_difference<expf>;
   }
   else
     THROW("Unknown link function: " << link);
 
   l->set_multipredict(multipredict_f);
   l->set_update(update);
+  l->set_multiupdate(multiupdate);
+  if (base->learns_difference()) l->set_learn_difference(learn_difference_f);
   all.scorer = VW::LEARNER::as_singleline(l);
 
   return make_base(*all.scorer);
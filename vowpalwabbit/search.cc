@@ -31,7 +31,35 @@ using std::endl;
 
 namespace Search
 {
-using byte_array = std::unique_ptr<uint8_t[]>;
+// The keys of the cache of predictions, in blocks which are reused from one example sequence to the next.
+class cache_key_arena
+{
+public:
+  uint8_t* allocate(size_t bytes)
+  {
+    while (_block < _blocks.size() && _used + bytes > _blocks[_block].size())
+    {
+      ++_block;
+      _used = 0;
+    }
+    if (_block == _blocks.size()) _blocks.emplace_back(std::max(BLOCK_BYTES, bytes));
+    uint8_t* key = _blocks[_block].data() + _used;
+    _used += bytes;
+    return key;
+  }
+
+  void clear()
+  {
+    _block = 0;
+    _used = 0;
+  }
+
+private:
+  static constexpr size_t BLOCK_BYTES = 1 << 16;
+  std::vector<std::vector<uint8_t>> _blocks;
+  size_t _block = 0;
+  size_t _used = 0;
+};
 
 search_task* all_tasks[] = {&SequenceTask::task, &SequenceSpanTask::task, &SequenceTaskCostToGo::task,
     &ArgmaxTask::task, &SequenceTask_DemoLDF::task, &MulticlassTask::task, &DepParserTask::task,
@@ -142,25 +170,26 @@ struct search_private
 private:
   struct cached_item_equivalent
   {
-    bool operator()(const byte_array& A, const byte_array& B) const
+    bool operator()(const uint8_t* A, const uint8_t* B) const
     {
-      size_t sz_A = *A.get();
-      size_t sz_B = *B.get();
+      size_t sz_A = *A;
+      size_t sz_B = *B;
       if (sz_A != sz_B) return false;
-      return memcmp(A.get(), B.get(), sz_A) == 0;
+      return memcmp(A, B, sz_A) == 0;
     }
   };
   struct cached_item_hash
   {
-    size_t operator()(const byte_array& key) const
+    size_t operator()(const uint8_t* key) const
     {
-      size_t sz = *key.get();
-      return uniform_hash(key.get(), sz, SEARCH_HASH_SEED);
+      size_t sz = *key;
+      return uniform_hash(key, sz, SEARCH_HASH_SEED);
     }
   };
 
 public:
-  using cache_map = std::unordered_map<byte_array, scored_action, cached_item_hash, cached_item_equivalent>;
+  // The keys are in cache_keys, or the lookup key of cached_action_store_or_find.
+  using cache_map = std::unordered_map<const uint8_t*, scored_action, cached_item_hash, cached_item_equivalent>;
 
   vw* all;
   std::shared_ptr<rand_state> _random_state;
@@ -261,6 +290,11 @@ public:
   size_t total_cache_hits;
 
   cache_map cache_hash_map;
+  cache_key_arena cache_keys;
+  std::vector<uint8_t> lookup_key;
+
+  // the features of the example being conditioned, which every ngram of add_example_conditioning is crossed with
+  std::vector<feature> conditioned_features;
 
   // for foreach_feature temporary storage for conditioning
   uint64_t dat_new_feature_idx;
@@ -296,6 +330,7 @@ public:
                   // the "real" decision step but this really only matters for caching purposes
   v_array<v_array<action_cache>*>
       memo_foreach_action;  // when foreach_action is on, we need to cache TRAIN trajectory actions for LEARN
+  std::vector<v_array<action_cache>*> spare_action_caches;  // of memo_foreach_action, once it is cleared
 
   ~search_private()
   {
@@ -330,6 +365,11 @@ public:
       ptag_to_action.delete_v();
       clear_memo_foreach_action(*this);
       memo_foreach_action.delete_v();
+      for (v_array<action_cache>* cache : spare_action_caches)
+      {
+        cache->delete_v();
+        delete cache;
+      }
 
       // destroy copied examples if we needed them
       if (!examples_dont_change)
@@ -351,14 +391,25 @@ public:
 void clear_memo_foreach_action(search_private& priv)
 {
   for (size_t i = 0; i < priv.memo_foreach_action.size(); i++)
-    if (priv.memo_foreach_action[i])
-    {
-      priv.memo_foreach_action[i]->delete_v();
-      delete priv.memo_foreach_action[i];
-    }
+    if (priv.memo_foreach_action[i]) priv.spare_action_caches.push_back(priv.memo_foreach_action[i]);
   priv.memo_foreach_action.clear();
 }
 
+// An empty cache of the costs of the actions of a time step, which reuses one of a previous example if there is one.
+v_array<action_cache>* new_action_cache(search_private& priv)
+{
+  if (priv.spare_action_caches.empty())
+  {
+    v_array<action_cache>* cache = new v_array<action_cache>();
+    *cache = v_init<action_cache>();
+    return cache;
+  }
+  v_array<action_cache>* cache = priv.spare_action_caches.back();
+  priv.spare_action_caches.pop_back();
+  cache->clear();
+  return cache;
+}
+
 search::search()
 {
   priv = &calloc_or_throw<search_private>();
@@ -609,6 +660,17 @@ void add_new_feature(search_private& priv, float val, uint64_t idx)
   }
 }
 
+void gather_conditioned_feature(search_private& priv, float val, uint64_t idx)
+{
+  priv.conditioned_features.push_back(feature(val, idx));
+}
+
+void clear_cache(search_private& priv)
+{
+  priv.cache_hash_map.clear();
+  priv.cache_keys.clear();
+}
+
 void del_features_in_top_namespace(search_private& /* priv */, example& ec, size_t ns)
 {
   if ((ec.indices.size() == 0) || (ec.indices.last() != ns))
@@ -777,6 +839,11 @@ void add_example_conditioning(search_private& priv, example& ec, size_t conditio
 
   size_t I = condition_on_cnt;
   size_t N = std::max(priv.acset.max_bias_ngram_length, priv.acset.max_quad_ngram_length);
+
+  // The features of ec are the same for every ngram, as the conditioning features are only added to it at the end.
+  priv.conditioned_features.clear();
+  if (priv.acset.max_quad_ngram_length > 0)
+    GD::foreach_feature<search_private, uint64_t, gather_conditioned_feature>(*priv.all, ec, priv);
   for (size_t i = 0; i < I; i++)  // position in conditioning
   {
     uint64_t fid = 71933 + 8491087 * extra_offset;
@@ -814,7 +881,7 @@ void add_example_conditioning(search_private& priv, example& ec, size_t conditio
         add_new_feature(priv, 1., (uint64_t)4398201 << priv.all->weights.stride_shift());
       // add the quadratic features
       if (n < priv.acset.max_quad_ngram_length)
-        GD::foreach_feature<search_private, uint64_t, add_new_feature>(*priv.all, ec, priv);
+        for (const feature& f : priv.conditioned_features) add_new_feature(priv, f.x, f.weight_index);
     }
   }
 
@@ -1120,8 +1187,7 @@ action choose_oracle_action(search_private& priv, size_t ec_cnt, const action* o
   cdbg << " ], ret=" << a << endl;
   if (need_memo_foreach_action(priv) && (priv.state == INIT_TRAIN))
   {
-    v_array<action_cache>* this_cache = new v_array<action_cache>();
-    *this_cache = v_init<action_cache>();
+    v_array<action_cache>* this_cache = new_action_cache(priv);
     // TODO we don't really need to construct this polylabel
     polylabel l = allowed_actions_to_ld(priv, 1, allowed_actions, allowed_actions_cnt, allowed_actions_cost);
     size_t K = cs_get_costs_size(priv.cb_learner, l);
@@ -1183,8 +1249,7 @@ action single_prediction_notLDF(search_private& priv, example& ec, int policy, c
     v_array<action_cache>* this_cache = nullptr;
     if (need_memo_foreach_action(priv) && (override_action == (action)-1))
     {
-      this_cache = new v_array<action_cache>();
-      *this_cache = v_init<action_cache>();
+      this_cache = new_action_cache(priv);
     }
     for (size_t k = 0; k < K; k++)
     {
@@ -1298,8 +1363,7 @@ action single_prediction_LDF(search_private& priv, example* ecs, size_t ec_cnt,
   v_array<action_cache>* this_cache = nullptr;
   if (need_partial_predictions)
   {
-    this_cache = new v_array<action_cache>();
-    *this_cache = v_init<action_cache>();
+    this_cache = new_action_cache(priv);
   }
 
   for (action a = (uint32_t)start_K; a < ec_cnt; a++)
@@ -1353,10 +1417,7 @@ action single_prediction_LDF(search_private& priv, example* ecs, size_t ec_cnt,
     if (need_memo_foreach_action(priv) && (override_action == (action)-1))
       priv.memo_foreach_action.push_back(this_cache);
     else
-    {
-      this_cache->delete_v();
-      delete this_cache;
-    }
+      priv.spare_action_caches.push_back(this_cache);
   }
 
   // TODO: generate raw predictions if necessary
@@ -1413,8 +1474,16 @@ bool cached_action_store_or_find(search_private& priv, ptag mytag, const ptag* c
       condition_on_cnt * (sizeof(ptag) + sizeof(action) + sizeof(char));
   if (sz % 4 != 0) sz += 4 - (sz % 4);  // make sure sz aligns to 4 so that uniform_hash does the right thing
 
-  byte_array item(new uint8_t[sz]);
-  uint8_t* here = item.get();
+  // Stored keys stay in the arena until the cache is cleared, a lookup only needs a key for the time it takes.
+  uint8_t* item;
+  if (do_store)
+    item = priv.cache_keys.allocate(sz);
+  else
+  {
+    priv.lookup_key.resize(sz);
+    item = priv.lookup_key.data();
+  }
+  uint8_t* here = item;
   // get rid of a valgrind warning about uninitialized memory
   memset(here, 0, sz);
   *here = (unsigned char)sz;
@@ -1438,7 +1507,7 @@ bool cached_action_store_or_find(search_private& priv, ptag mytag, const ptag* c
   }
   if (do_store)
   {
-    priv.cache_hash_map.emplace(std::move(item), scored_action(a, a_cost));
+    priv.cache_hash_map.emplace(item, scored_action(a, a_cost));
     return true;
   }
   else  // its a find
@@ -2112,7 +2181,7 @@ void train_single_example(search& sch, bool is_test_ex, bool is_holdout_ex, mult
   bool ran_test = false;  // we must keep track so that even if we skip test, we still update # of examples seen
 
   // if (! priv.no_caching)
-  priv.cache_hash_map.clear();
+  clear_cache(priv);
 
   cdbg << "is_test_ex=" << is_test_ex << " vw_is_main=" << all.vw_is_main << endl;
   cdbg << "must_run_test = " << must_run_test(all, ec_seq, is_test_ex) << endl;
@@ -2154,7 +2223,7 @@ void train_single_example(search& sch, bool is_test_ex, bool is_holdout_ex, mult
        << priv.read_example_last_pass << ") ========================================" << endl;
   // std::cerr << "training" << endl;
 
-  priv.cache_hash_map.clear();
+  clear_cache(priv);
   reset_search_structure(priv);
   clear_memo_foreach_action(priv);
   priv.state = INIT_TRAIN;
@@ -2211,6 +2280,8 @@ void train_single_example(search& sch, bool is_test_ex, bool is_holdout_ex, mult
     priv.learn_a_idx = 0;
     priv.done_with_all_actions = false;
     // for each action, roll out to get a loss
+    // The rollouts run one after the other: each one conditions the examples of ec_seq, runs the task over its
+    // task_data and predicts with the base learner, which all rollouts of the sequence share.
     while (!priv.done_with_all_actions)
     {
       priv.learn_t = priv.timesteps[tid];
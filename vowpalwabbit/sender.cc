@@ -2,6 +2,13 @@
 // individual contributors. All rights reserved. Released under a BSD (revised)
 // license as described in the file LICENSE.
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 #ifdef _WIN32
 #  define NOMINMAX
@@ -19,38 +26,163 @@
 #  endif
 #else
 #  include <netdb.h>
+#  include <sys/socket.h>
 #endif
 
 #include "io_buf.h"
 #include "cache.h"
+#include "hash.h"
 #include "network.h"
 #include "reductions.h"
 
 using namespace VW::config;
 
+namespace
+{
+// Points of each host on the consistent hashing ring, so that the examples spread evenly and only those of a host
+// move when it is added or removed.
+constexpr size_t ring_points_per_host = 64;
+
+struct pending
+{
+  example* ec;
+  float prediction;
+  bool received;
+};
+
+// A host the examples are sent to. Its receiver thread reads the predictions, which come back in the order the
+// examples were sent in, while the learner sends the next ones.
+struct remote
+{
+  int fd;
+  std::unique_ptr<VW::io::socket> socket;
+  std::unique_ptr<VW::io::reader> reader;
+  io_buf buf;
+  size_t unflushed;              // examples written to buf since it was last flushed
+  std::deque<pending*> in_flight;  // sent and waiting for their prediction, guarded by the sender lock
+  std::thread receiver;
+};
+}  // namespace
+
 struct sender
 {
-  io_buf* buf;
-  std::unique_ptr<VW::io::socket> _socket;
-  std::unique_ptr<VW::io::reader> _socket_reader;
-  vw* all;  // loss ring_size others
-  example** delay_ring;
-  size_t sent_index;
-  size_t received_index;
+  vw* all;
+  std::vector<std::unique_ptr<remote>> remotes;
+  std::vector<std::pair<uint64_t, size_t>> ring;  // consistent hashing points and their remote, sorted
+  size_t max_pending;  // examples sent and not yet finished, below the examples of the pool the parser fills
+  size_t window;       // examples in flight to a host
+  size_t batch;        // examples written to a host at once
+
+  // The examples in the order they were sent in, across the hosts, which is the order they are finished in.
+  std::deque<pending> sent;
+  std::mutex lock;
+  std::condition_variable sent_cv;      // an example is in flight
+  std::condition_variable received_cv;  // its prediction came back
+  bool done = false;
+  std::exception_ptr error;
 
   ~sender()
   {
-    free(delay_ring);
-    delete buf;
+    bool abandoned;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      done = true;
+      abandoned = !sent.empty();
+    }
+    sent_cv.notify_all();
+    for (auto& r : remotes)
+    {
+      if (!r->receiver.joinable()) continue;
+      // Unblocks a receiver waiting for predictions which will not come, after an error.
+      if (abandoned) shutdown(r->fd, SHUT_RDWR);
+      r->receiver.join();
+    }
   }
 };
 
-void open_sockets(sender& s, std::string host)
+namespace
+{
+void receive_results(sender& s, remote& r)
+{
+  try
+  {
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> guard(s.lock);
+        s.sent_cv.wait(guard, [&s, &r] { return s.done || !r.in_flight.empty(); });
+        if (r.in_flight.empty()) return;
+      }
+      float res, weight;
+      get_prediction(r.reader.get(), res, weight);
+      {
+        std::lock_guard<std::mutex> guard(s.lock);
+        pending* p = r.in_flight.front();
+        r.in_flight.pop_front();
+        p->prediction = res;
+        p->received = true;
+      }
+      s.received_cv.notify_all();
+    }
+  }
+  catch (...)
+  {
+    {
+      std::lock_guard<std::mutex> guard(s.lock);
+      if (s.error == nullptr) s.error = std::current_exception();
+    }
+    s.received_cv.notify_all();
+  }
+}
+
+void open_sockets(sender& s, const std::string& hosts)
+{
+  std::stringstream list(hosts);
+  for (std::string host; std::getline(list, host, ',');)
+  {
+    if (host.empty()) continue;
+    std::unique_ptr<remote> r(new remote());
+    r->fd = open_socket(host.c_str());
+    r->socket = VW::io::wrap_socket_descriptor(r->fd);
+    r->reader = r->socket->get_reader();
+    r->buf.add_file(r->socket->get_writer());
+    r->unflushed = 0;
+    for (size_t point = 0; point < ring_points_per_host; point++)
+    {
+      const std::string name = host + "#" + std::to_string(point);
+      s.ring.emplace_back(uniform_hash(name.data(), name.size(), 0), s.remotes.size());
+    }
+    s.remotes.push_back(std::move(r));
+  }
+  if (s.remotes.empty()) THROW("--sendto needs a host");
+  std::sort(s.ring.begin(), s.ring.end());
+}
+
+// The remote of the point following the hash of the tag of ec on the ring, or of its features when it has none.
+remote& remote_of(sender& s, example& ec)
 {
-  s._socket = VW::io::wrap_socket_descriptor(open_socket(host.c_str()));
-  s._socket_reader = s._socket->get_reader();
-  s.buf = new io_buf();
-  s.buf->add_file(s._socket->get_writer());
+  if (s.remotes.size() == 1) return *s.remotes[0];
+  uint64_t h = 0;
+  if (!ec.tag.empty())
+    h = uniform_hash(ec.tag.begin(), ec.tag.size(), 0);
+  else
+  {
+    for (namespace_index ns : ec.indices)
+    {
+      const features& fs = ec.feature_space[ns];
+      h = uniform_hash(fs.indicies.begin(), fs.size() * sizeof(feature_index), h + ns);
+    }
+  }
+  auto point = std::lower_bound(s.ring.begin(), s.ring.end(), std::make_pair(h, static_cast<size_t>(0)));
+  if (point == s.ring.end()) point = s.ring.begin();
+  return *s.remotes[point->second];
+}
+
+void flush(remote& r)
+{
+  if (r.unflushed == 0) return;
+  r.buf.flush();
+  r.unflushed = 0;
 }
 
 void send_features(io_buf* b, example& ec, uint32_t mask)
@@ -63,57 +195,127 @@ void send_features(io_buf* b, example& ec, uint32_t mask)
     if (ns == constant_namespace) continue;
     output_features(*b, ns, ec.feature_space[ns], mask);
   }
-  b->flush();
 }
 
-void receive_result(sender& s)
+// Finishes the first example sent, whose prediction came back. Called with the lock held, which is released while
+// the example is finished.
+void finish_first(sender& s, std::unique_lock<std::mutex>& guard)
 {
-  float res, weight;
-
-  get_prediction(s._socket_reader.get(), res, weight);
-  example& ec = *s.delay_ring[s.received_index++ % s.all->example_parser->ring_size];
-  ec.pred.scalar = res;
+  pending p = s.sent.front();
+  s.sent.pop_front();
+  guard.unlock();
 
+  example& ec = *p.ec;
+  ec.pred.scalar = p.prediction;
   label_data& ld = ec.l.simple;
   ec.loss = s.all->loss->getLoss(s.all->sd, ec.pred.scalar, ld.label) * ec.weight;
-
   return_simple_example(*(s.all), nullptr, ec);
+  guard.lock();
+}
+
+// Finishes the examples whose predictions came back, in order, and waits until r has room for one more example.
+void wait_for_room(sender& s, remote& r)
+{
+  std::unique_lock<std::mutex> guard(s.lock);
+  while (true)
+  {
+    if (s.error != nullptr) std::rethrow_exception(s.error);
+    if (!s.sent.empty() && s.sent.front().received)
+    {
+      finish_first(s, guard);
+      continue;
+    }
+    if (s.sent.size() < s.max_pending && r.in_flight.size() < s.window) return;
+
+    // The predictions waited for may be of examples still buffered.
+    guard.unlock();
+    for (auto& other : s.remotes) flush(*other);
+    guard.lock();
+    s.received_cv.wait(guard, [&s, &r] {
+      return s.error != nullptr || s.sent.front().received ||
+          (s.sent.size() < s.max_pending && r.in_flight.size() < s.window);
+    });
+  }
 }
 
 void learn(sender& s, VW::LEARNER::single_learner&, example& ec)
 {
-  if (s.received_index + s.all->example_parser->ring_size / 2 - 1 == s.sent_index) receive_result(s);
+  remote& r = remote_of(s, ec);
+  wait_for_room(s, r);
 
   s.all->set_minmax(s.all->sd, ec.l.simple.label);
-  s.all->example_parser->lbl_parser.cache_label(&ec.l, *s.buf);  // send label information.
-  cache_tag(*s.buf, ec.tag);
-  send_features(s.buf, ec, (uint32_t)s.all->parse_mask);
-  s.delay_ring[s.sent_index++ % s.all->example_parser->ring_size] = &ec;
+  s.all->example_parser->lbl_parser.cache_label(&ec.l, r.buf);  // send label information.
+  cache_tag(r.buf, ec.tag);
+  send_features(&r.buf, ec, (uint32_t)s.all->parse_mask);
+  {
+    std::lock_guard<std::mutex> guard(s.lock);
+    s.sent.push_back({&ec, 0.f, false});
+    r.in_flight.push_back(&s.sent.back());
+  }
+  s.sent_cv.notify_all();
+  if (++r.unflushed >= s.batch) flush(r);
 }
 
 void finish_example(vw&, sender&, example&) {}
 
 void end_examples(sender& s)
 {
+  for (auto& r : s.remotes) flush(*r);
+  {
+    std::unique_lock<std::mutex> guard(s.lock);
+    while (!s.sent.empty())
+    {
+      s.received_cv.wait(guard, [&s] { return s.error != nullptr || s.sent.front().received; });
+      if (s.error != nullptr) std::rethrow_exception(s.error);
+      finish_first(s, guard);
+    }
+    s.done = true;
+  }
+  s.sent_cv.notify_all();
   // close our outputs to signal finishing.
-  while (s.received_index != s.sent_index) receive_result(s);
-  s.buf->close_files();
+  for (auto& r : s.remotes)
+  {
+    r->receiver.join();
+    r->buf.close_files();
+  }
 }
+}  // namespace
 
 VW::LEARNER::base_learner* sender_setup(options_i& options, vw& all)
 {
-  std::string host;
+  std::string hosts;
+  uint64_t window = 0;
+  uint64_t batch = 0;
 
   option_group_definition sender_options("Network sending");
-  sender_options.add(make_option("sendto", host).keep().necessary().help("send examples to <host>"));
+  sender_options
+      .add(make_option("sendto", hosts)
+               .keep()
+               .necessary()
+               .help("send examples to <host>, or to comma separated hosts chosen by consistent hashing of the tag of "
+                     "the examples, or of their features when they have none"))
+      .add(make_option("send_window", window)
+               .help("Examples sent to a host before its first prediction must come back, half the example pool "
+                     "by default"))
+      .add(make_option("send_batch", batch).default_value(16).help("Examples written to a host at once"));
 
   if (!options.add_parse_and_check_necessary(sender_options)) { return nullptr; }
+  if (batch == 0) THROW("--send_batch must be at least 1");
 
   auto s = scoped_calloc_or_throw<sender>();
-  open_sockets(*s.get(), host);
-
   s->all = &all;
-  s->delay_ring = calloc_or_throw<example*>(all.example_parser->ring_size);
+  open_sockets(*s.get(), hosts);
+  // As many examples at most as before the predictions were received on their own thread, so that the parser always
+  // has examples to fill.
+  s->max_pending = std::max<size_t>(all.example_parser->ring_size / 2, 2) - 1;
+  s->window = window > 0 ? window : s->max_pending;
+  s->batch = batch;
+  for (auto& r : s->remotes)
+  {
+    remote* receiving = r.get();
+    sender* owner = s.get();
+    r->receiver = std::thread([owner, receiving] { receive_results(*owner, *receiving); });
+  }
 
   VW::LEARNER::learner<sender, example>& l = init_learner(s, learn, learn, 1);
   l.set_finish_example(finish_example);
@@ -32,10 +32,12 @@ bool use_reduction(config::options_i& options)
 
 struct sfm_data
 {
+  bool factor_shared_features = false;
+  shared_linear_terms shared_terms;
 };
 
 template <bool is_learn>
-void predict_or_learn(sfm_data&, VW::LEARNER::multi_learner& base, multi_ex& ec_seq)
+void predict_or_learn(sfm_data& data, VW::LEARNER::multi_learner& base, multi_ex& ec_seq)
 {
   if (ec_seq.size() == 0) THROW("cb_adf: At least one action must be provided for an example to be valid.");
 
@@ -48,6 +50,12 @@ void predict_or_learn(sfm_data&, VW::LEARNER::multi_learner& base, multi_ex& ec_
     ec_seq.erase(ec_seq.begin());
     // merge sequences
     for (auto& example : ec_seq) LabelDict::add_example_namespaces_from_example(*example, *shared_example);
+    if (data.factor_shared_features)
+    {
+      data.shared_terms = shared_linear_terms();
+      data.shared_terms.shared = shared_example;
+      for (auto& example : ec_seq) example->shared_terms = &data.shared_terms;
+    }
     std::swap(ec_seq[0]->pred, shared_example->pred);
     std::swap(ec_seq[0]->tag, shared_example->tag);
   }
@@ -56,7 +64,11 @@ void predict_or_learn(sfm_data&, VW::LEARNER::multi_learner& base, multi_ex& ec_
   auto restore_guard = VW::scope_exit([has_example_header, &shared_example, &ec_seq] {
     if (has_example_header)
     {
-      for (auto& example : ec_seq) LabelDict::del_example_namespaces_from_example(*example, *shared_example);
+      for (auto& example : ec_seq)
+      {
+        LabelDict::del_example_namespaces_from_example(*example, *shared_example);
+        example->shared_terms = nullptr;
+      }
       std::swap(shared_example->pred, ec_seq[0]->pred);
       std::swap(shared_example->tag, ec_seq[0]->tag);
       ec_seq.insert(ec_seq.begin(), shared_example);
@@ -72,9 +84,14 @@ void predict_or_learn(sfm_data&, VW::LEARNER::multi_learner& base, multi_ex& ec_
 
 VW::LEARNER::base_learner* shared_feature_merger_setup(config::options_i& options, vw& all)
 {
-  if (!use_reduction(options)) return nullptr;
-
   auto data = scoped_calloc_or_throw<sfm_data>();
+  config::option_group_definition new_options("Shared Feature Merger");
+  new_options.add(config::make_option("factor_shared_features", data->factor_shared_features)
+                      .help("predict the linear terms of the shared features of a multiline example once rather than "
+                            "for every action. Interactions are still predicted for every action"));
+  options.add_and_parse(new_options);
+
+  if (!use_reduction(options)) return nullptr;
 
   auto* base = VW::LEARNER::as_multiline(setup_base(options, all));
   auto& learner = VW::LEARNER::init_learner(data, base, predict_or_learn<true>, predict_or_learn<false>);
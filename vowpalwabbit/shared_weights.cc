@@ -0,0 +1,217 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "shared_weights.h"
+
+#ifdef _WIN32
+#  define NOMINMAX
+#  include <Windows.h>
+#else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "vw_exception.h"
+
+namespace
+{
+constexpr uint32_t SHARED_WEIGHTS_MAGIC = 0x57535756;  // "VWSW"
+constexpr uint32_t SHARED_WEIGHTS_VERSION = 1;
+
+struct shared_weights_header
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t num_weights;
+  std::atomic<uint64_t> generation;  // of the weights published last, 0 if none were
+};
+
+std::string segment_name(const std::string& name, uint64_t generation)
+{
+  return name + "." + std::to_string(generation);
+}
+}  // namespace
+
+namespace VW
+{
+// A mapped named shared memory segment.
+struct shared_memory
+{
+  // Creates the segment, or opens it if it exists, with the given size. Throws on failure.
+  static std::unique_ptr<shared_memory> create(const std::string& name, size_t size)
+  {
+    std::unique_ptr<shared_memory> segment(new shared_memory(name, size));
+#ifdef _WIN32
+    segment->_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), name.c_str());
+    if (segment->_handle == nullptr) THROW("cannot create shared memory " << name << ": error " << GetLastError());
+    segment->data = static_cast<char*>(MapViewOfFile(segment->_handle, FILE_MAP_WRITE, 0, 0, size));
+    if (segment->data == nullptr) THROW("cannot map shared memory " << name << ": error " << GetLastError());
+#else
+    const int fd = shm_open(posix_name(name).c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) THROWERRNO("shm_open " << name);
+    struct stat status;
+    if (fstat(fd, &status) < 0 || (static_cast<size_t>(status.st_size) != size && ftruncate(fd, size) < 0))
+    {
+      close(fd);
+      THROWERRNO("cannot size shared memory " << name);
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) THROWERRNO("mmap " << name);
+    segment->data = static_cast<char*>(data);
+#endif
+    return segment;
+  }
+
+  // Opens an existing segment read only. Returns nullptr if there is none of at least the given size.
+  static std::unique_ptr<shared_memory> open(const std::string& name, size_t size)
+  {
+    std::unique_ptr<shared_memory> segment(new shared_memory(name, size));
+#ifdef _WIN32
+    segment->_handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    if (segment->_handle == nullptr) return nullptr;
+    segment->data = static_cast<char*>(MapViewOfFile(segment->_handle, FILE_MAP_READ, 0, 0, size));
+    if (segment->data == nullptr) return nullptr;
+#else
+    const int fd = shm_open(posix_name(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) return nullptr;
+    struct stat status;
+    if (fstat(fd, &status) < 0 || static_cast<size_t>(status.st_size) < size)
+    {
+      close(fd);
+      return nullptr;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return nullptr;
+    segment->data = static_cast<char*>(data);
+#endif
+    return segment;
+  }
+
+  ~shared_memory()
+  {
+#ifdef _WIN32
+    if (data != nullptr) UnmapViewOfFile(data);
+    if (_handle != nullptr) CloseHandle(_handle);
+#else
+    if (data != nullptr) munmap(data, _size);
+#endif
+  }
+
+  shared_memory(const shared_memory&) = delete;
+  shared_memory& operator=(const shared_memory&) = delete;
+
+  // Removes the name of the segment, processes which have it mapped keep using it. On Windows the segment goes away
+  // with the last handle instead.
+  void remove()
+  {
+#ifndef _WIN32
+    shm_unlink(posix_name(_name).c_str());
+#endif
+  }
+
+  char* data = nullptr;
+
+private:
+  shared_memory(const std::string& name, size_t size) : _name(name), _size(size) {}
+
+#ifndef _WIN32
+  static std::string posix_name(const std::string& name) { return name[0] == '/' ? name : "/" + name; }
+#endif
+
+  std::string _name;
+  size_t _size;
+#ifdef _WIN32
+  HANDLE _handle = nullptr;
+#endif
+};
+
+shared_weights::shared_weights(const std::string& name, uint64_t num_weights, std::unique_ptr<shared_memory> header)
+    : _name(name), _num_weights(num_weights), _header(std::move(header))
+{
+}
+
+shared_weights::~shared_weights() = default;
+
+std::unique_ptr<shared_weights> shared_weights::publisher(const std::string& name, uint64_t num_weights)
+{
+  auto header_segment = shared_memory::create(name, sizeof(shared_weights_header));
+  auto& header = *reinterpret_cast<shared_weights_header*>(header_segment->data);
+  if (header.magic != SHARED_WEIGHTS_MAGIC || header.version != SHARED_WEIGHTS_VERSION ||
+      header.num_weights != num_weights)
+  {
+    // Left by a publisher of other weights, attached readers must not follow it to weights of a different size.
+    header.generation.store(0);
+    header.magic = SHARED_WEIGHTS_MAGIC;
+    header.version = SHARED_WEIGHTS_VERSION;
+    header.num_weights = num_weights;
+  }
+
+  std::unique_ptr<shared_weights> publisher(new shared_weights(name, num_weights, std::move(header_segment)));
+  publisher->_generation = header.generation.load();
+  return publisher;
+}
+
+std::unique_ptr<shared_weights> shared_weights::attach(const std::string& name, dense_parameters& weights)
+{
+  auto header_segment = shared_memory::open(name, sizeof(shared_weights_header));
+  if (header_segment == nullptr) THROW("no weights are published as " << name);
+  const auto& header = *reinterpret_cast<const shared_weights_header*>(header_segment->data);
+  if (header.magic != SHARED_WEIGHTS_MAGIC || header.version != SHARED_WEIGHTS_VERSION)
+    THROW(name << " does not hold published weights");
+  if (header.num_weights != weights.mask() + 1)
+  {
+    THROW("the weights published as " << name << " have " << header.num_weights << " entries, the model has "
+                                      << weights.mask() + 1 << ", use the same -b and reductions");
+  }
+
+  std::unique_ptr<shared_weights> reader(new shared_weights(name, header.num_weights, std::move(header_segment)));
+  if (!reader->follow(weights)) THROW("no weights are published as " << name);
+  return reader;
+}
+
+void shared_weights::publish(const dense_parameters& weights)
+{
+  if (weights.mask() + 1 != _num_weights) THROW("weights of a different size cannot be published as " << _name);
+
+  auto& header = *reinterpret_cast<shared_weights_header*>(_header->data);
+  const uint64_t generation = std::max(header.generation.load(), _generation) + 1;
+  auto segment = shared_memory::create(segment_name(_name, generation), _num_weights * sizeof(weight));
+  memcpy(segment->data, &weights[0], _num_weights * sizeof(weight));
+  header.generation.store(generation, std::memory_order_release);
+
+  // Readers which have not moved on yet may still open the previous generation.
+  if (_previous != nullptr) _previous->remove();
+  _previous = std::move(_weights);
+  _weights = std::move(segment);
+  _generation = generation;
+}
+
+bool shared_weights::follow(dense_parameters& weights)
+{
+  const auto& header = *reinterpret_cast<const shared_weights_header*>(_header->data);
+  // A generation which cannot be opened has been replaced by a newer one in the meantime.
+  for (int attempt = 0; attempt < 3; attempt++)
+  {
+    const uint64_t generation = header.generation.load(std::memory_order_acquire);
+    if (generation == _generation || generation == 0) return false;
+    auto segment = shared_memory::open(segment_name(_name, generation), _num_weights * sizeof(weight));
+    if (segment == nullptr) continue;
+
+    weights.use_external_memory(reinterpret_cast<weight*>(segment->data));
+    _weights = std::move(segment);
+    _generation = generation;
+    return true;
+  }
+  return false;
+}
+}  // namespace VW
@@ -0,0 +1,56 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "array_parameters.h"
+
+namespace VW
+{
+struct shared_memory;
+
+// Dense weights shared through named shared memory, see --publish_weights and --attach_weights. The segment called
+// name only holds the size of the weights and the number of times they were published. Every publish writes the
+// weights to a new segment, name.<generation>, before announcing it, and attached processes move to it between two
+// examples. Weights are therefore never seen partially written, and a segment stays mapped by the processes still
+// using it after the publisher has removed it. Segments are backed by POSIX shared memory, or by the paging file on
+// Windows, where they disappear once no process has them open.
+class shared_weights
+{
+public:
+  ~shared_weights();
+
+  shared_weights(const shared_weights&) = delete;
+  shared_weights& operator=(const shared_weights&) = delete;
+
+  // Prepares publishing weights of the given size under name.
+  static std::unique_ptr<shared_weights> publisher(const std::string& name, uint64_t num_weights);
+
+  // Attaches weights to what was last published under name, read only. Throws if nothing was published or if the
+  // published weights differ in size.
+  static std::unique_ptr<shared_weights> attach(const std::string& name, dense_parameters& weights);
+
+  // Copies weights to a new generation and announces it.
+  void publish(const dense_parameters& weights);
+
+  // Moves weights to the last published generation if it is newer than theirs. Returns true if they moved.
+  bool follow(dense_parameters& weights);
+
+  uint64_t generation() const { return _generation; }
+
+private:
+  shared_weights(const std::string& name, uint64_t num_weights, std::unique_ptr<shared_memory> header);
+
+  std::string _name;
+  uint64_t _num_weights;
+  std::unique_ptr<shared_memory> _header;
+  std::unique_ptr<shared_memory> _weights;  // of the current generation
+  std::unique_ptr<shared_memory> _previous;  // the publisher keeps the generation before, readers may still move to it
+  uint64_t _generation = 0;
+};
+}  // namespace VW
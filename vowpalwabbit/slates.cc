@@ -23,6 +23,24 @@ namespace VW
 {
 namespace slates
 {
+slates_data::~slates_data()
+{
+  for (auto& included_actions : _included_actions) { included_actions.delete_v(); }
+  for (auto& outcome : _outcomes) { outcome.probabilities.delete_v(); }
+  for (auto& action_scores : _spare_action_scores) { action_scores.delete_v(); }
+  label_probs.delete_v();
+}
+
+void slates_data::reuse(VW::decision_scores_t& decision_scores)
+{
+  for (auto& action_scores : decision_scores)
+  {
+    action_scores.clear();
+    _spare_action_scores.push_back(action_scores);
+  }
+  decision_scores.clear();
+}
+
 template <bool is_learn>
 void slates_data::learn_or_predict(VW::LEARNER::multi_learner& base, multi_ex& examples)
 {
@@ -33,11 +51,19 @@ void slates_data::learn_or_predict(VW::LEARNER::multi_learner& base, multi_ex& e
   const size_t num_slots = std::count_if(examples.begin(), examples.end(),
       [](const example* example) { return example->l.slates.type == VW::slates::example_type::slot; });
 
+  // The pools, included actions and outcomes of the slots are kept from call to call, and only cleared.
+  if (_slot_action_pools.size() < num_slots)
+  {
+    _slot_action_pools.resize(num_slots);
+    _included_actions.resize(num_slots, v_init<uint32_t>());
+    _outcomes.resize(num_slots);
+  }
+  for (size_t slot = 0; slot < num_slots; slot++) { _slot_action_pools[slot].clear(); }
+
   float global_cost = 0.f;
   bool global_cost_found = false;
   uint32_t action_index = 0;
   size_t slot_index = 0;
-  std::vector<std::vector<uint32_t>> slot_action_pools(num_slots);
   for (size_t i = 0; i < examples.size(); i++)
   {
     CCB::label ccb_label;
@@ -57,26 +83,28 @@ void slates_data::learn_or_predict(VW::LEARNER::multi_learner& base, multi_ex& e
     {
       if (slates_label.slot_id >= num_slots) { THROW("slot_id cannot be larger than or equal to the number of slots"); }
       ccb_label.type = CCB::example_type::action;
-      slot_action_pools[slates_label.slot_id].push_back(action_index);
+      _slot_action_pools[slates_label.slot_id].push_back(action_index);
       action_index++;
     }
     else if (slates_label.type == slates::example_type::slot)
     {
       ccb_label.type = CCB::example_type::slot;
-      ccb_label.explicit_included_actions = v_init<uint32_t>();
-      for (const auto index : slot_action_pools[slot_index]) { ccb_label.explicit_included_actions.push_back(index); }
+      auto& included_actions = _included_actions[slot_index];
+      included_actions.clear();
+      push_many(included_actions, _slot_action_pools[slot_index].data(), _slot_action_pools[slot_index].size());
+      ccb_label.explicit_included_actions = included_actions;
 
       if (global_cost_found)
       {
-        ccb_label.outcome = new CCB::conditional_contextual_bandit_outcome();
+        ccb_label.outcome = &_outcomes[slot_index];
         ccb_label.outcome->cost = global_cost;
-        ccb_label.outcome->probabilities = v_init<ACTION_SCORE::action_score>();
+        ccb_label.outcome->probabilities.clear();
 
         for (const auto& action_score : slates_label.probabilities)
         {
           // We need to convert from slate space which is zero based for
           // each slot to CCB where all action indices are in the same space.
-          auto ccb_space_index = slot_action_pools[slot_index][action_score.action];
+          auto ccb_space_index = _slot_action_pools[slot_index][action_score.action];
           ccb_label.outcome->probabilities.push_back({ccb_space_index, action_score.score});
         }
       }
@@ -86,6 +114,11 @@ void slates_data::learn_or_predict(VW::LEARNER::multi_learner& base, multi_ex& e
     ccb_label.weight = slates_label.weight;
     examples[i]->l.conditional_contextual_bandit = ccb_label;
   }
+
+  // ccb takes the arrays it finds in the prediction as spares for the predictions of the slots.
+  auto& decision_scores = examples[0]->pred.decision_scores;
+  for (auto& action_scores : _spare_action_scores) { decision_scores.push_back(action_scores); }
+  _spare_action_scores.clear();
   VW::LEARNER::multiline_learn_or_predict<is_learn>(base, examples, examples[0]->ft_offset);
 
   // Need to convert decision scores to the original index space. This can be
@@ -98,11 +131,8 @@ void slates_data::learn_or_predict(VW::LEARNER::multi_learner& base, multi_ex& e
     size_so_far += static_cast<uint32_t>(action_scores.size());
   }
 
-  for (size_t i = 0; i < examples.size(); i++)
-  {
-    CCB::delete_label(examples[i]->l.conditional_contextual_bandit);
-    examples[i]->l.slates = std::move(_stashed_labels[i]);
-  }
+  // The ccb labels point to the storage of the slots, which is kept for the next call.
+  for (size_t i = 0; i < examples.size(); i++) { examples[i]->l.slates = std::move(_stashed_labels[i]); }
   _stashed_labels.clear();
 }
 
@@ -165,14 +195,15 @@ float get_estimate(
   return cost * p_over_ps;
 }
 
-void output_example(vw& all, slates_data& /*c*/, multi_ex& ec_seq)
+void output_example(vw& all, slates_data& data, multi_ex& ec_seq)
 {
   std::vector<example*> slots;
   size_t num_features = 0;
   float loss = 0.;
   bool is_labelled = ec_seq[SHARED_EX_INDEX]->l.slates.labeled;
   float cost = is_labelled ? ec_seq[SHARED_EX_INDEX]->l.slates.cost : 0.f;
-  auto label_probs = v_init<ACTION_SCORE::action_score>();
+  auto& label_probs = data.label_probs;
+  label_probs.clear();
 
   for (auto* ec : ec_seq)
   {
@@ -194,7 +225,6 @@ void output_example(vw& all, slates_data& /*c*/, multi_ex& ec_seq)
   // Calculate the estimate for this example based on the pseudo inverse estimator.
   const auto& predictions = ec_seq[0]->pred.decision_scores;
   if (is_labelled) { loss = get_estimate(label_probs, cost, predictions); }
-  label_probs.delete_v();
 
   bool holdout_example = is_labelled;
   if (holdout_example != false)
@@ -216,8 +246,7 @@ void finish_multiline_example(vw& all, slates_data& data, multi_ex& ec_seq)
   {
     output_example(all, data, ec_seq);
     CB_ADF::global_print_newline(all.final_prediction_sink);
-    for (auto& action_scores : ec_seq[0]->pred.decision_scores) { action_scores.delete_v(); }
-    ec_seq[0]->pred.decision_scores.clear();
+    data.reuse(ec_seq[0]->pred.decision_scores);
   }
 
   VW::finish_example(all, ec_seq);
@@ -6,8 +6,10 @@
 
 #include "reductions_fwd.h"
 
+#include "ccb_label.h"
 #include "slates_label.h"
 #include "learner.h"
+#include "decision_scores.h"
 
 #include <string>
 #include <vector>
@@ -20,6 +22,12 @@ struct slates_data
 {
 private:
   std::vector<label> _stashed_labels;
+  // Of each slot, reused by the ccb labels of every call.
+  std::vector<std::vector<uint32_t>> _slot_action_pools;
+  std::vector<v_array<uint32_t>> _included_actions;
+  std::vector<CCB::conditional_contextual_bandit_outcome> _outcomes;
+  // The arrays of the slots of finished predictions, handed to ccb to predict the next slots into.
+  std::vector<ACTION_SCORE::action_scores> _spare_action_scores;
 
   /*
   The primary job of this reduction is to convert slate labels to a form CCB can process.
@@ -48,8 +56,16 @@ private:
   void learn_or_predict(VW::LEARNER::multi_learner& base, multi_ex& examples);
 
 public:
+  ~slates_data();
+
   void learn(VW::LEARNER::multi_learner& base, multi_ex& examples);
   void predict(VW::LEARNER::multi_learner& base, multi_ex& examples);
+
+  // Takes the arrays of a finished prediction, emptied, to reuse them.
+  void reuse(VW::decision_scores_t& decision_scores);
+
+  // Of the top action of each labeled slot, reused by every output.
+  ACTION_SCORE::action_scores label_probs;
 };
 
 VW::LEARNER::base_learner* slates_setup(VW::config::options_i& options, vw& all);
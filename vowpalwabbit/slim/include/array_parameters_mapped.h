@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace vw_slim
+{
+// The weights of a model read in place from the buffer it was loaded from, which must outlive them. The weight section
+// of a model is a list of index:weight pairs in index order, which is searched for each weight read, so loading
+// neither copies nor allocates whatever the size of the model, at the cost of a binary search per feature.
+// Prediction only: there is no weight& to update.
+class mapped_parameters
+{
+  const char* _pairs;
+  size_t _count;
+  size_t _index_size;     // 4 or 8 bytes, as the model's number of bits asks
+  uint64_t _weight_mask;  // (1 << num_bits) - 1
+  uint32_t _stride_shift;
+
+  uint64_t index(size_t pair) const
+  {
+    // the pairs need not be aligned, e.g. in an mmapped asset on ARM
+    const char* p = _pairs + pair * (_index_size + sizeof(float));
+    if (_index_size == sizeof(uint32_t))
+    {
+      uint32_t idx;
+      memcpy(&idx, p, sizeof(idx));
+      return idx;
+    }
+    uint64_t idx;
+    memcpy(&idx, p, sizeof(idx));
+    return idx;
+  }
+
+  float value(size_t pair) const
+  {
+    float w;
+    memcpy(&w, _pairs + pair * (_index_size + sizeof(float)) + _index_size, sizeof(w));
+    return w;
+  }
+
+public:
+  mapped_parameters(const char* pairs, size_t count, size_t index_size, uint64_t length)
+      : _pairs(pairs), _count(count), _index_size(index_size), _weight_mask(length - 1), _stride_shift(0)
+  {
+  }
+
+  mapped_parameters(const mapped_parameters& other) = delete;
+  mapped_parameters& operator=(const mapped_parameters& other) = delete;
+
+  bool not_null() { return _weight_mask > 0 && _pairs != nullptr; }
+
+  // The indices of the pairs, which must be strictly increasing and below length.
+  bool valid() const
+  {
+    for (size_t i = 0; i < _count; i++)
+      if (index(i) > _weight_mask || (i > 0 && index(i) <= index(i - 1))) return false;
+    return true;
+  }
+
+  inline float operator[](size_t i) const
+  {
+    i &= _weight_mask;
+    size_t first = 0;
+    size_t last = _count;
+    while (first < last)
+    {
+      const size_t middle = first + (last - first) / 2;
+      if (index(middle) < i)
+        first = middle + 1;
+      else
+        last = middle;
+    }
+    return first < _count && index(first) == i ? value(first) : 0.f;
+  }
+
+  uint64_t mask() const { return _weight_mask; }
+
+  uint32_t stride() const { return 1 << _stride_shift; }
+
+  uint32_t stride_shift() const { return _stride_shift; }
+
+  void stride_shift(uint32_t stride_shift) { _stride_shift = stride_shift; }
+};
+}  // namespace vw_slim
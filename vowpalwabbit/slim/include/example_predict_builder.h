@@ -1,23 +1,57 @@
 #pragma once
 
+#include "hashstring.h"
 #include "vw_slim_predict.h"
 
 namespace vw_slim
 {
+// The hash of a namespace and the hashes of its features, computed once to build any number of examples from, which
+// then only push prehashed features. The names are hashed with hasher, which is to be the vw_predict::hasher of the
+// model for models trained with --hash_function.
+class namespace_schema
+{
+  namespace_index _namespace_idx;
+  uint64_t _namespace_hash;
+  uint64_t _feature_index_bit_mask;
+  hash_string_func _hasher;
+
+public:
+  namespace_schema(
+      const char* namespace_name, uint32_t feature_index_num_bits = 18, hash_string_func hasher = hashstring);
+  namespace_schema(
+      namespace_index namespace_idx, uint32_t feature_index_num_bits = 18, hash_string_func hasher = hashstring);
+
+  namespace_index index() const { return _namespace_idx; }
+  uint64_t hash() const { return _namespace_hash; }
+  uint64_t feature_index_bit_mask() const { return _feature_index_bit_mask; }
+  hash_string_func hasher() const { return _hasher; }
+
+  // The hash push_feature_string gives the feature named feature_name.
+  feature_index feature(const char* feature_name) const;
+  // The hash push_feature gives the feature with the index feature_idx.
+  feature_index numeric_feature(feature_index feature_idx) const { return _namespace_hash + feature_idx; }
+};
+
 class example_predict_builder
 {
   example_predict* _ex;
   namespace_index _namespace_idx;
   uint64_t _namespace_hash;
   uint64_t _feature_index_bit_mask;
+  hash_string_func _hasher;
 
   void add_namespace(namespace_index feature_group);
 
 public:
-  example_predict_builder(example_predict* ex, char* namespace_name, uint32_t feature_index_num_bits = 18);
-  example_predict_builder(example_predict* ex, namespace_index namespace_idx, uint32_t feature_index_num_bits = 18);
+  example_predict_builder(example_predict* ex, char* namespace_name, uint32_t feature_index_num_bits = 18,
+      hash_string_func hasher = hashstring);
+  example_predict_builder(example_predict* ex, namespace_index namespace_idx, uint32_t feature_index_num_bits = 18,
+      hash_string_func hasher = hashstring);
+  example_predict_builder(example_predict* ex, const namespace_schema& schema);
 
   void push_feature_string(char* feature_idx, feature_value value);
   void push_feature(feature_index feature_idx, feature_value value);
+  // Pushes a feature hashed by namespace_schema::feature or namespace_schema::numeric_feature.
+  void push_hashed_feature(feature_index feature_hash, feature_value value);
 };
 }  // namespace vw_slim
@@ -6,6 +6,8 @@
 
 #include "vw_slim_return_codes.h"
 #include "hash.h"
+#include "array_parameters_quantized.h"
+#include "array_parameters_mapped.h"
 
 // #define MODEL_PARSER_DEBUG
 
@@ -24,6 +26,28 @@ class model_parser
   const char* _model_end;
   uint32_t _checksum;
 
+  template <typename W>
+  static int store_weight(W& weights, uint64_t idx, float value)
+  {
+    weights[idx] = value;
+    return S_VW_PREDICT_OK;
+  }
+
+  // quantized weights can only be read from quantized models
+  static int store_weight(quantized_parameters&, uint64_t, float) { return E_VW_PREDICT_ERR_NOT_A_QUANTIZED_MODEL; }
+
+  template <typename W>
+  static void store_quantized_weight(W& weights, uint64_t idx, int8_t value, float scale)
+  {
+    weights[idx] = VW::dequantize(value, scale);
+  }
+
+  static void store_quantized_weight(quantized_parameters& weights, uint64_t idx, int8_t value, float scale)
+  {
+    weights.set_scale(idx >> VW::QUANTIZED_BLOCK_SHIFT, scale);
+    weights.set(idx, value);
+  }
+
 public:
   model_parser(const char* model, size_t length);
 
@@ -109,8 +133,10 @@ public:
       RETURN_ON_FAIL((read<T, false>("gd.weight.index", idx)));
       if (idx > weight_length) return E_VW_PREDICT_ERR_WEIGHT_INDEX_OUT_OF_RANGE;
 
-      float& w = (*weights)[idx];
+      // read into a float first, the weights may be stored in a more compact format
+      float w;
       RETURN_ON_FAIL((read<float, false>("gd.weight.value", w)));
+      RETURN_ON_FAIL(store_weight(*weights, idx, w));
 
 #ifdef MODEL_PARSER_DEBUG
       std::cout << "weight. idx: " << idx << ":" << (*weights)[idx] << std::endl;
@@ -136,5 +162,49 @@ public:
 
     return S_VW_PREDICT_OK;
   }
+
+  // the pairs stay where they are, in the buffer of the model
+  int read_weights(std::unique_ptr<mapped_parameters>& weights, uint32_t num_bits, uint32_t stride_shift);
+
+  // gd.cc: write_quantized_regressor, see array_parameters_quantized.h for the format
+  template <typename W>
+  int read_quantized_weights(std::unique_ptr<W>& weights, uint32_t num_bits, uint32_t stride_shift)
+  {
+    uint64_t weight_length = (uint64_t)1 << num_bits;
+
+    weights = std::unique_ptr<W>(new W(weight_length));
+    weights->stride_shift(stride_shift);
+
+    // weights are excluded from checksum calculation
+    uint32_t block_count;
+    RETURN_ON_FAIL((read<uint32_t, false>("gd.quantized.block_count", block_count)));
+    for (uint32_t i = 0; i < block_count; i++)
+    {
+      uint64_t block;
+      float scale;
+      uint16_t count;
+      RETURN_ON_FAIL((read<uint64_t, false>("gd.quantized.block", block)));
+      RETURN_ON_FAIL((read<float, false>("gd.quantized.scale", scale)));
+      RETURN_ON_FAIL((read<uint16_t, false>("gd.quantized.count", count)));
+      if ((block << VW::QUANTIZED_BLOCK_SHIFT) >= weight_length) return E_VW_PREDICT_ERR_WEIGHT_INDEX_OUT_OF_RANGE;
+
+      for (uint16_t j = 0; j < count; j++)
+      {
+        uint8_t offset;
+        int8_t value;
+        RETURN_ON_FAIL((read<uint8_t, false>("gd.quantized.offset", offset)));
+        RETURN_ON_FAIL((read<int8_t, false>("gd.quantized.value", value)));
+        store_quantized_weight(*weights, (block << VW::QUANTIZED_BLOCK_SHIFT) + offset, value, scale);
+      }
+    }
+
+    return _model == _model_end ? S_VW_PREDICT_OK : E_VW_PREDICT_ERR_INVALID_MODEL;
+  }
+
+  // a quantized model has its blocks to dequantize, not index:weight pairs to search
+  int read_quantized_weights(std::unique_ptr<mapped_parameters>&, uint32_t, uint32_t)
+  {
+    return E_VW_PREDICT_ERR_WEIGHTS_NOT_MAPPABLE;
+  }
 };
 }  // namespace vw_slim
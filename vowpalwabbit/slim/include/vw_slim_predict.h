@@ -3,7 +3,9 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <array>
+#include <cstring>
 
 // avoid mmap dependency
 #define DISABLE_SHARED_WEIGHTS
@@ -11,6 +13,7 @@
 #include "example_predict.h"
 #include "explore.h"
 #include "gd_predict.h"
+#include "hashstring.h"
 #include "model_parser.h"
 #include "opts.h"
 
@@ -179,6 +182,15 @@ enum vw_predict_exploration
 
 uint64_t ceil_log_2(uint64_t v);
 
+// True if the version of a model, as in "8.9.0", is the given one or later.
+bool model_version_at_least(const std::string& version, int major, int minor, int rev);
+
+// How feature names are hashed, hashstring or hashstring_xxh3 for the --hash_function of the model.
+typedef uint64_t (*hash_string_func)(const char*, size_t, uint64_t);
+
+// conditional_contextual_bandit.cc: inject_slot_id, the index of the feature of a slot id before it is strided.
+feature_index ccb_slot_id(size_t slot, uint32_t num_bits, hash_string_func hasher);
+
 // this guard assumes that namespaces are added in order
 // the complete feature_space of the added namespace is cleared afterwards
 class namespace_copy_guard
@@ -215,7 +227,47 @@ public:
 };
 
 /**
- * @brief Vowpal Wabbit slim predictor. Supports: regression, multi-class classification and contextual bandits.
+ * @brief Many examples in compressed sparse rows, for vw_predict::predict_batch. The features of example i are
+ * namespaces[j], indices[j] and values[j] for j from row_offsets[i] up to row_offsets[i + 1]. The indices are hashed as
+ * example_predict_builder or namespace_schema hash them.
+ */
+struct example_batch
+{
+  size_t num_examples;
+  const size_t* row_offsets;  // num_examples + 1 of them
+  const namespace_index* namespaces;
+  const feature_index* indices;
+  const feature_value* values;
+};
+
+template <typename W>
+class vw_predict;
+
+/**
+ * @brief The scratch of vw_predict::predict_batch, which keeps its storage from batch to batch. Each thread that scores
+ * batches needs a context of its own, and a context may be used with any model.
+ */
+class batch_context
+{
+  template <typename W>
+  friend class vw_predict;
+
+  example_predict _ex;
+  // The interactions of the model split into those of the shared namespaces only and the others, for the shared
+  // namespaces of the last batch.
+  std::array<bool, NUM_NAMESPACES> _shared_ns;
+  std::vector<std::vector<namespace_index>> _shared_interactions;
+  std::vector<std::vector<namespace_index>> _row_interactions;
+  const void* _model = nullptr;
+  uint64_t _model_load = 0;
+};
+
+/**
+ * @brief Vowpal Wabbit slim predictor. Supports: regression, multi-class classification, contextual bandits,
+ * conditional contextual bandits and slates.
+ *
+ * Once a model is loaded, the predict methods only read it, so any number of threads may predict with one instance
+ * at the same time, each with examples (and a batch_context) of its own. Loading a model must not overlap with them.
  */
 template <typename W>
 class vw_predict
@@ -234,9 +286,15 @@ class vw_predict
   float _lambda;
   int _bag_size;
   uint32_t _num_bits;
+  hash_string_func _hasher = hashstring;
 
   uint32_t _stride_shift;
   bool _model_loaded;
+  // ccb models since 8.9.0 say whether vw saw several slots, or slot features, while training
+  bool _ccb_multi_slot_seen;
+
+  // counts the models read, so that a batch_context knows which one its interactions were split for
+  uint64_t _load_count = 0;
 
 public:
   vw_predict() : _model_loaded(false) {}
@@ -244,6 +302,10 @@ public:
   /**
    * @brief Reads the Vowpal Wabbit model from the supplied buffer (produced using vw -f <modelname>)
    *
+   * Models produced using vw --save_quantized <modelname> are dequantized as they are read, unless W is
+   * quantized_parameters, which keeps them quantized in memory. If W is mapped_parameters the weights are read in place
+   * and the model must outlive this, see array_parameters_mapped.h.
+   *
    * @param model The binary model.
    * @param length The length of the binary model.
    * @return int Returns 0 (S_VW_PREDICT_OK) if succesful, otherwise one of the error codes (see E_VW_PREDICT_ERR_*).
@@ -253,6 +315,7 @@ public:
     if (!model || length == 0) return E_VW_PREDICT_ERR_INVALID_MODEL;
 
     _model_loaded = false;
+    _load_count++;
 
     // required for inline_predict
     _ignore_linear.fill(false);
@@ -291,6 +354,17 @@ public:
     if (find_opt_int(_command_line_arguments, "--hash_seed", hash_seed) && hash_seed)
       return E_VW_PREDICT_ERR_HASH_SEED_NOT_SUPPORTED;
 
+    // parse_args.cc: parse_feature_tweaks, models which do not record a --hash_function hash with murmur3
+    _hasher = hashstring;
+    std::vector<std::string> hash_function = find_opt(_command_line_arguments, "--hash_function");
+    if (!hash_function.empty())
+    {
+      if (hash_function.back() == "xxh3")
+        _hasher = hashstring_xxh3;
+      else if (hash_function.back() != "murmur3")
+        return E_VW_PREDICT_ERR_HASH_FUNCTION_NOT_SUPPORTED;
+    }
+
     _interactions.clear();
     find_opt(_command_line_arguments, "-q", _interactions);
     find_opt(_command_line_arguments, "--quadratic", _interactions);
@@ -351,6 +425,11 @@ public:
 
     if (check_sum_computed != check_sum) return E_VW_PREDICT_ERR_INVALID_MODEL_CHECK_SUM;
 
+    // conditional_contextual_bandit.cc: save_load
+    _ccb_multi_slot_seen = false;
+    if (is_ccb_explore_adf() && model_version_at_least(_version, 8, 9, 0))
+      RETURN_ON_FAIL((mp.read<bool, false>("ccb.has_seen_multi_slot_example", _ccb_multi_slot_seen)));
+
     if (_command_line_arguments.find("--cb_adf") != std::string::npos)
     {
       RETURN_ON_FAIL(mp.skip(sizeof(uint64_t)));  // cb_adf.cc: event_sum
@@ -366,7 +445,13 @@ public:
     uint64_t weight_length = (uint64_t)1 << _num_bits;
     _stride_shift = (uint32_t)ceil_log_2(num_weights);
 
-    RETURN_ON_FAIL(mp.read_weights<W>(_weights, _num_bits, _stride_shift));
+    // models written with --save_quantized
+    if (_command_line_arguments.find("--quantized") != std::string::npos)
+    { RETURN_ON_FAIL(mp.read_quantized_weights(_weights, _num_bits, _stride_shift)); }
+    else
+    {
+      RETURN_ON_FAIL(mp.read_weights(_weights, _num_bits, _stride_shift));
+    }
 
     // TODO: check that permutations is not enabled (or parse it)
 
@@ -381,7 +466,24 @@ public:
    * @return true True if contextual bandit predict method can be used.
    * @return false False if contextual bandit predict method cannot be used.
    */
-  bool is_cb_explore_adf() { return _command_line_arguments.find("--cb_explore_adf") != std::string::npos; }
+  bool is_cb_explore_adf() const { return _command_line_arguments.find("--cb_explore_adf") != std::string::npos; }
+
+  /**
+   * @brief True if the model describes a conditional contextual bandit (ccb), including slates models which are reduced
+   * to ccb.
+   *
+   * @return true True if predict_ccb can be used.
+   * @return false False if predict_ccb cannot be used.
+   */
+  bool is_ccb_explore_adf() const { return _command_line_arguments.find("--ccb_explore_adf") != std::string::npos; }
+
+  /**
+   * @brief True if the model describes slates.
+   *
+   * @return true True if predict_slates can be used.
+   * @return false False if predict_slates cannot be used.
+   */
+  bool is_slates() const { return _command_line_arguments.find("--slates") != std::string::npos; }
 
   /**
    * @brief True if the model describes a cost sensitive one-against-all (csoaa). This is also true for cb_explore_adf
@@ -390,7 +492,7 @@ public:
    * @return true True if csoaa predict method can be used.
    * @return false False if csoaa predict method cannot be used.
    */
-  bool is_csoaa_ldf() { return _command_line_arguments.find("--csoaa_ldf") != std::string::npos; }
+  bool is_csoaa_ldf() const { return _command_line_arguments.find("--csoaa_ldf") != std::string::npos; }
 
   /**
    * @brief Predicts a score (as in regression) for the provided example.
@@ -401,7 +503,7 @@ public:
    * @param score The output score produced by the model.
    * @return int Returns 0 (S_VW_PREDICT_OK) if succesful, otherwise one of the error codes (see E_VW_PREDICT_ERR_*).
    */
-  int predict(example_predict& ex, float& score)
+  int predict(example_predict& ex, float& score) const
   {
     if (!_model_loaded) return E_VW_PREDICT_ERR_NO_MODEL_LOADED;
 
@@ -419,8 +521,92 @@ public:
     return S_VW_PREDICT_OK;
   }
 
+  /**
+   * @brief Predicts the scores (as in regression) of a batch of examples, as predict would one example at a time.
+   *
+   * The features all examples have are given once in shared. Its linear terms, the constant and the interactions among
+   * its namespaces only are scored once for the whole batch, and the examples must not have features in its
+   * namespaces. Once the storage of the context has grown to the largest example nothing is allocated.
+   *
+   * @param context The scratch of the calling thread.
+   * @param batch The examples.
+   * @param scores The output scores, batch.num_examples of them.
+   * @param shared The features of all examples, or nullptr.
+   * @return int Returns 0 (S_VW_PREDICT_OK) if succesful, otherwise one of the error codes (see E_VW_PREDICT_ERR_*).
+   */
+  int predict_batch(
+      batch_context& context, const example_batch& batch, float* scores, example_predict* shared = nullptr) const
+  {
+    if (!_model_loaded) return E_VW_PREDICT_ERR_NO_MODEL_LOADED;
+
+    example_predict& ex = context._ex;
+    for (auto ns : ex.indices) ex.feature_space[ns].clear();
+    ex.indices.clear();
+    ex.ft_offset = shared != nullptr ? shared->ft_offset : 0;
+
+    std::array<bool, NUM_NAMESPACES> shared_ns;
+    shared_ns.fill(false);
+    if (shared != nullptr)
+    {
+      for (auto ns : shared->indices)
+      {
+        if (!shared_ns[ns]) ex.indices.push_back(ns);
+        shared_ns[ns] = true;
+        features& fs = ex.feature_space[ns];
+        for (auto f : shared->feature_space[ns]) fs.push_back(f.value(), f.index());
+      }
+    }
+    if (!_no_constant)
+    {
+      if (!shared_ns[constant_namespace]) ex.indices.push_back(constant_namespace);
+      shared_ns[constant_namespace] = true;
+      ex.feature_space[constant_namespace].push_back(1.f, (constant << _stride_shift) + ex.ft_offset);
+    }
+
+    if (context._model != this || context._model_load != _load_count || shared_ns != context._shared_ns)
+    {
+      context._shared_interactions.clear();
+      context._row_interactions.clear();
+      for (const auto& interaction : _interactions)
+      {
+        const bool shared_only = std::all_of(
+            interaction.begin(), interaction.end(), [&shared_ns](namespace_index ns) { return shared_ns[ns]; });
+        (shared_only ? context._shared_interactions : context._row_interactions).push_back(interaction);
+      }
+      context._shared_ns = shared_ns;
+      context._model = this;
+      context._model_load = _load_count;
+    }
+
+    const float shared_score = GD::inline_predict<W>(
+        *_weights, false, _ignore_linear, context._shared_interactions, /* permutations */ false, ex);
+
+    const size_t num_shared = ex.indices.size();
+    for (size_t i = 0; i < batch.num_examples; i++)
+    {
+      for (size_t j = batch.row_offsets[i]; j < batch.row_offsets[i + 1]; j++)
+      {
+        const namespace_index ns = batch.namespaces[j];
+        if (shared_ns[ns]) return E_VW_PREDICT_ERR_NAMESPACE_IS_SHARED;
+        features& fs = ex.feature_space[ns];
+        if (!fs.nonempty()) ex.indices.push_back(ns);
+        fs.push_back(batch.values[j], batch.indices[j]);
+      }
+
+      // the linear terms of the shared namespaces are in shared_score already
+      scores[i] = GD::inline_predict<W>(
+          *_weights, true, shared_ns, context._row_interactions, /* permutations */ false, ex, shared_score);
+
+      for (size_t k = num_shared; k < ex.indices.size(); k++) ex.feature_space[ex.indices[k]].clear();
+      ex.indices.end() = ex.indices.begin() + num_shared;
+    }
+
+    return S_VW_PREDICT_OK;
+  }
+
   // multiclass classification
-  int predict(example_predict& shared, example_predict* actions, size_t num_actions, std::vector<float>& out_scores)
+  int predict(
+      example_predict& shared, example_predict* actions, size_t num_actions, std::vector<float>& out_scores) const
   {
     if (!_model_loaded) return E_VW_PREDICT_ERR_NO_MODEL_LOADED;
 
@@ -453,12 +639,100 @@ public:
   }
 
   int predict(const char* event_id, example_predict& shared, example_predict* actions, size_t num_actions,
-      std::vector<float>& pdf, std::vector<int>& ranking)
+      std::vector<float>& pdf, std::vector<int>& ranking) const
   {
     if (!_model_loaded) return E_VW_PREDICT_ERR_NO_MODEL_LOADED;
 
     if (!is_cb_explore_adf()) return E_VW_PREDICT_ERR_NOT_A_CB_MODEL;
 
+    const bool bag = _exploration == vw_predict_exploration::bag;
+    example_predict* actions_end = actions + num_actions;
+
+    // apply stride shifts
+    std::vector<std::unique_ptr<stride_shift_guard>> stride_shift_guards;
+    if (bag)
+    {
+      stride_shift_guards.push_back(std::unique_ptr<stride_shift_guard>(new stride_shift_guard(shared, _stride_shift)));
+      for (example_predict* action = actions; action != actions_end; ++action)
+        stride_shift_guards.push_back(
+            std::unique_ptr<stride_shift_guard>(new stride_shift_guard(*action, _stride_shift)));
+    }
+
+    auto score = [&](size_t member, std::vector<float>& scores) {
+      std::vector<std::unique_ptr<feature_offset_guard>> feature_offset_guards;
+      if (bag)
+        for (example_predict* action = actions; action != actions_end; ++action)
+          feature_offset_guards.push_back(
+              std::unique_ptr<feature_offset_guard>(new feature_offset_guard(*action, member)));
+
+      return predict(shared, actions, num_actions, scores);
+    };
+
+    return explore(uniform_hash(event_id, strlen(event_id), 0), num_actions, score, pdf, ranking);
+  }
+
+  /**
+   * @brief Predicts a conditional contextual bandit (ccb) model as vw --ccb_explore_adf does. The slots are predicted
+   * in order, each as a contextual bandit among the actions the slots before it did not choose, with the features of
+   * the slot added to the shared ones.
+   *
+   * The linear terms of the shared features and the interactions among their namespaces only are scored once for all
+   * slots, and those the slot adds once for all its actions, rather than once per action. An action or slot with
+   * features in the namespaces before it is scored whole instead.
+   *
+   * @param event_id The seed of the sampling, from which each slot gets one of its own.
+   * @param shared The features all actions have.
+   * @param actions The actions.
+   * @param num_actions The number of actions, at least num_slots.
+   * @param slots The features of each slot.
+   * @param num_slots The number of slots.
+   * @param pdfs For each slot, the probabilities of its ranking.
+   * @param rankings For each slot, the actions it chose among by score, with the sampled one first.
+   * @return int Returns 0 (S_VW_PREDICT_OK) if succesful, otherwise one of the error codes (see E_VW_PREDICT_ERR_*).
+   */
+  int predict_ccb(const char* event_id, example_predict& shared, example_predict* actions, size_t num_actions,
+      example_predict* slots, size_t num_slots, std::vector<std::vector<float>>& pdfs,
+      std::vector<std::vector<int>>& rankings) const
+  {
+    if (!_model_loaded) return E_VW_PREDICT_ERR_NO_MODEL_LOADED;
+
+    if (!is_ccb_explore_adf()) return E_VW_PREDICT_ERR_NOT_A_CCB_MODEL;
+
+    return predict_slots(event_id, shared, actions, nullptr, num_actions, slots, num_slots, pdfs, rankings);
+  }
+
+  /**
+   * @brief Predicts a slates model as vw --slates does, as predict_ccb would with every slot choosing among actions of
+   * its own.
+   *
+   * @param action_slots The slot of each action.
+   * @param rankings For each slot, its actions by score with the sampled one first, numbered in the order they are
+   * given among the actions of the slot.
+   * @return int Returns 0 (S_VW_PREDICT_OK) if succesful, otherwise one of the error codes (see E_VW_PREDICT_ERR_*).
+   */
+  int predict_slates(const char* event_id, example_predict& shared, example_predict* actions,
+      const size_t* action_slots, size_t num_actions, example_predict* slots, size_t num_slots,
+      std::vector<std::vector<float>>& pdfs, std::vector<std::vector<int>>& rankings) const
+  {
+    if (!_model_loaded) return E_VW_PREDICT_ERR_NO_MODEL_LOADED;
+
+    if (!is_slates()) return E_VW_PREDICT_ERR_NOT_A_SLATES_MODEL;
+
+    for (size_t i = 0; i < num_actions; i++)
+      if (action_slots[i] >= num_slots) return E_VW_PREDICT_ERR_INVALID_SLOT;
+
+    return predict_slots(event_id, shared, actions, action_slots, num_actions, slots, num_slots, pdfs, rankings);
+  }
+
+private:
+  using interaction_list = std::vector<std::vector<namespace_index>>;
+  using namespace_marks = std::vector<std::pair<namespace_index, size_t>>;
+
+  // Scores the actions as the exploration of the model asks, with score(member, scores) where member is the bag
+  // member, or 0, and then sorts pdf and ranking by score and swaps the sampled action to the top.
+  template <typename Score>
+  int explore(uint64_t seed, size_t num_actions, Score& score, std::vector<float>& pdf, std::vector<int>& ranking) const
+  {
     std::vector<float> scores;
 
     // add exploration
@@ -470,7 +744,7 @@ public:
       case vw_predict_exploration::epsilon_greedy:
       {
         // get the prediction
-        RETURN_ON_FAIL(predict(shared, actions, num_actions, scores));
+        RETURN_ON_FAIL(score(0, scores));
 
         // generate exploration distribution
         // model is trained against cost -> minimum is better
@@ -484,7 +758,7 @@ public:
       case vw_predict_exploration::softmax:
       {
         // get the prediction
-        RETURN_ON_FAIL(predict(shared, actions, num_actions, scores));
+        RETURN_ON_FAIL(score(0, scores));
 
         // generate exploration distribution
         RETURN_EXPLORATION_ON_FAIL(exploration::generate_softmax(
@@ -495,23 +769,9 @@ public:
       {
         std::vector<uint32_t> top_actions(num_actions);
 
-        // apply stride shifts
-        std::vector<std::unique_ptr<stride_shift_guard>> stride_shift_guards;
-        stride_shift_guards.push_back(
-            std::unique_ptr<stride_shift_guard>(new stride_shift_guard(shared, _stride_shift)));
-        example_predict* actions_end = actions + num_actions;
-        for (example_predict* action = actions; action != actions_end; ++action)
-          stride_shift_guards.push_back(
-              std::unique_ptr<stride_shift_guard>(new stride_shift_guard(*action, _stride_shift)));
-
         for (size_t i = 0; i < _bag_size; i++)
         {
-          std::vector<std::unique_ptr<feature_offset_guard>> feature_offset_guards;
-          for (example_predict* action = actions; action != actions_end; ++action)
-            feature_offset_guards.push_back(
-                std::unique_ptr<feature_offset_guard>(new feature_offset_guard(*action, i)));
-
-          RETURN_ON_FAIL(predict(shared, actions, num_actions, scores));
+          RETURN_ON_FAIL(score(i, scores));
 
           auto top_action_iterator = std::min_element(std::begin(scores), std::end(scores));
           uint32_t top_action = (uint32_t)(top_action_iterator - std::begin(scores));
@@ -539,7 +799,7 @@ public:
     // Sample from the pdf
     uint32_t chosen_action_idx;
     RETURN_EXPLORATION_ON_FAIL(
-        exploration::sample_after_normalizing(event_id, std::begin(pdf), std::end(pdf), chosen_action_idx));
+        exploration::sample_after_normalizing(seed, std::begin(pdf), std::end(pdf), chosen_action_idx));
 
     // Swap top element with chosen one (unless chosen is the top)
     if (chosen_action_idx != 0)
@@ -551,6 +811,225 @@ public:
     return S_VW_PREDICT_OK;
   }
 
+  // Adds the features of fs to the namespace ns of ex, strided as the weights are, and remembers in marks how many
+  // features ns had before.
+  void append_features(example_predict& ex, namespace_index ns, const features& fs, namespace_marks& marks) const
+  {
+    features& to = ex.feature_space[ns];
+    if (std::find(ex.indices.begin(), ex.indices.end(), ns) == ex.indices.end()) ex.indices.push_back(ns);
+    marks.emplace_back(ns, to.size());
+    for (size_t i = 0; i < fs.size(); i++) to.push_back(fs.values[i], fs.indicies[i] << _stride_shift);
+  }
+
+  // Takes away the features appended since marks, and the namespaces after the first num_indices.
+  static void remove_features(example_predict& ex, namespace_marks& marks, size_t num_indices)
+  {
+    for (auto mark = marks.rbegin(); mark != marks.rend(); ++mark) ex.feature_space[mark->first].truncate_to(mark->second);
+    ex.indices.end() = ex.indices.begin() + num_indices;
+    marks.clear();
+  }
+
+  // Moves the interactions of from whose namespaces are all in ns to inside, and the others to outside.
+  static void split_interactions(const interaction_list& from, const std::array<bool, NUM_NAMESPACES>& ns,
+      interaction_list& inside, interaction_list& outside)
+  {
+    inside.clear();
+    outside.clear();
+    for (const auto& interaction : from)
+    {
+      const bool all_inside =
+          std::all_of(interaction.begin(), interaction.end(), [&ns](namespace_index i) { return ns[i]; });
+      (all_inside ? inside : outside).push_back(interaction);
+    }
+  }
+
+  // conditional_contextual_bandit.cc: calculate_and_insert_interactions, which crosses the namespaces with those of the
+  // slot features and the slot id.
+  static void add_ccb_interactions(
+      const example_predict& shared, const example_predict* actions, size_t num_actions, interaction_list& interactions)
+  {
+    const size_t num_original = interactions.size();
+    interactions.push_back({ccb_slot_namespace, ccb_slot_namespace});
+    namespace_index prev_found = 0;
+    for (size_t i = 0; i < num_original; i++)
+    {
+      if (!interactions[i].empty() && prev_found != interactions[i][0])
+      {
+        prev_found = interactions[i][0];
+        interactions.push_back({interactions[i][0], ccb_slot_namespace});
+      }
+    }
+
+    const size_t num_with_slot = interactions.size();
+    for (size_t i = 0; i < num_with_slot; i++)
+    {
+      auto interaction = interactions[i];
+      interaction.push_back(ccb_id_namespace);
+      interactions.push_back(interaction);
+    }
+
+    std::array<bool, NUM_NAMESPACES> found;
+    found.fill(false);
+    auto cross_with_id = [&interactions, &found](namespace_index ns) {
+      if (ns < ' ' || ns > '~' || found[ns]) return;
+      found[ns] = true;
+      interactions.push_back({ns, ccb_id_namespace});
+    };
+    for (size_t i = 0; i < num_actions; i++)
+      for (auto ns : actions[i].indices) cross_with_id(ns);
+    for (auto ns : shared.indices) cross_with_id(ns);
+  }
+
+  int predict_slots(const char* event_id, example_predict& shared, example_predict* actions,
+      const size_t* action_slots, size_t num_actions, example_predict* slots, size_t num_slots,
+      std::vector<std::vector<float>>& pdfs, std::vector<std::vector<int>>& rankings) const
+  {
+    if (num_slots > num_actions) return E_VW_PREDICT_ERR_TOO_FEW_ACTIONS;
+
+    // vw adds the slot ids and their interactions once it has seen several slots, or features of a slot
+    const bool add_slot_ids = _ccb_multi_slot_seen || num_slots > 1 ||
+        (num_slots == 1 && !slots[0].indices.empty() && slots[0].indices[0] != constant_namespace);
+    interaction_list interactions(_interactions);
+    if (add_slot_ids) add_ccb_interactions(shared, actions, num_actions, interactions);
+
+    // the shared features and the constant, to which the features of a slot and then of an action are added
+    example_predict ex;
+    namespace_marks marks;
+    for (auto ns : shared.indices) append_features(ex, ns, shared.feature_space[ns], marks);
+    if (!_no_constant)
+    {
+      if (!ex.feature_space[constant_namespace].nonempty()) ex.indices.push_back(constant_namespace);
+      ex.feature_space[constant_namespace].push_back(1.f, 0);
+    }
+    marks.clear();
+    const size_t num_shared = ex.indices.size();
+
+    std::array<bool, NUM_NAMESPACES> shared_ns;
+    shared_ns.fill(false);
+    for (auto ns : ex.indices) shared_ns[ns] = true;
+    std::array<bool, NUM_NAMESPACES> outside_shared_ns;
+    for (size_t i = 0; i < NUM_NAMESPACES; i++) outside_shared_ns[i] = !shared_ns[i];
+    interaction_list shared_interactions, other_interactions;
+    split_interactions(interactions, shared_ns, shared_interactions, other_interactions);
+
+    const bool bag = _exploration == vw_predict_exploration::bag;
+    const size_t num_members = bag ? _bag_size : 1;
+    std::vector<float> shared_scores(num_members);
+    std::vector<bool> shared_scored(num_members, false);
+
+    std::vector<bool> chosen(num_actions, false);
+    std::vector<uint32_t> slot_actions;
+    std::array<bool, NUM_NAMESPACES> slot_ns, outside_slot_ns, slot_only_ns;
+    interaction_list slot_interactions, action_interactions;
+    pdfs.resize(num_slots);
+    rankings.resize(num_slots);
+    const size_t event_id_length = strlen(event_id);
+
+    for (size_t s = 0; s < num_slots; s++)
+    {
+      // conditional_contextual_bandit.cc: inject_slot_features and inject_slot_id
+      bool slot_overlaps = false;
+      for (auto ns : slots[s].indices)
+      {
+        if (ns == constant_namespace) continue;
+        const namespace_index to = ns == default_namespace ? ccb_slot_namespace : ns;
+        slot_overlaps = slot_overlaps || shared_ns[to];
+        append_features(ex, to, slots[s].feature_space[ns], marks);
+      }
+      if (add_slot_ids)
+      {
+        slot_overlaps = slot_overlaps || shared_ns[ccb_id_namespace];
+        if (std::find(ex.indices.begin(), ex.indices.end(), ccb_id_namespace) == ex.indices.end())
+          ex.indices.push_back(ccb_id_namespace);
+        features& id = ex.feature_space[ccb_id_namespace];
+        marks.emplace_back(ccb_id_namespace, id.size());
+        id.push_back(1.f, ccb_slot_id(s, _num_bits, _hasher) << _stride_shift);
+      }
+      const size_t num_slot_indices = ex.indices.size();
+
+      slot_ns.fill(false);
+      for (auto ns : ex.indices) slot_ns[ns] = true;
+      for (size_t i = 0; i < NUM_NAMESPACES; i++)
+      {
+        outside_slot_ns[i] = !slot_ns[i];
+        slot_only_ns[i] = shared_ns[i] || !slot_ns[i];
+      }
+      // a slot in the namespaces of the shared features changes their interactions, which are then scored again
+      split_interactions(slot_overlaps ? interactions : other_interactions, slot_ns, slot_interactions,
+          action_interactions);
+
+      slot_actions.clear();
+      for (size_t i = 0; i < num_actions; i++)
+        if (action_slots != nullptr ? action_slots[i] == s : !chosen[i]) slot_actions.push_back((uint32_t)i);
+
+      auto score = [&](size_t member, std::vector<float>& scores) {
+        ex.ft_offset = bag ? member : shared.ft_offset;
+        if (!_no_constant)
+          ex.feature_space[constant_namespace].indicies[0] = (constant << _stride_shift) + ex.ft_offset;
+
+        float slot_score;
+        if (slot_overlaps)
+          slot_score = GD::inline_predict<W>(
+              *_weights, true, outside_slot_ns, slot_interactions, /* permutations */ false, ex);
+        else
+        {
+          if (!shared_scored[member])
+          {
+            shared_scores[member] = GD::inline_predict<W>(
+                *_weights, true, outside_shared_ns, shared_interactions, /* permutations */ false, ex);
+            shared_scored[member] = true;
+          }
+          slot_score = GD::inline_predict<W>(*_weights, true, slot_only_ns, slot_interactions, /* permutations */ false,
+              ex, shared_scores[member]);
+        }
+
+        scores.resize(slot_actions.size());
+        namespace_marks action_marks;
+        for (size_t k = 0; k < slot_actions.size(); k++)
+        {
+          const example_predict& action = actions[slot_actions[k]];
+          bool action_overlaps = false;
+          for (auto ns : action.indices)
+          {
+            action_overlaps = action_overlaps || slot_ns[ns];
+            append_features(ex, ns, action.feature_space[ns], action_marks);
+          }
+
+          // the linear terms of the namespaces of the slot are in slot_score already
+          scores[k] = action_overlaps
+              ? GD::inline_predict<W>(*_weights, false, _ignore_linear, interactions, /* permutations */ false, ex)
+              : GD::inline_predict<W>(
+                    *_weights, true, slot_ns, action_interactions, /* permutations */ false, ex, slot_score);
+
+          remove_features(ex, action_marks, num_slot_indices);
+        }
+        return S_VW_PREDICT_OK;
+      };
+
+      if (!slot_actions.empty())
+      {
+        const uint64_t seed = uniform_hash(event_id, event_id_length, s);
+        RETURN_ON_FAIL(explore(seed, slot_actions.size(), score, pdfs[s], rankings[s]));
+        if (action_slots == nullptr)
+        {
+          for (auto& action : rankings[s]) action = slot_actions[action];
+          chosen[rankings[s][0]] = true;
+        }
+      }
+      else
+      {
+        pdfs[s].clear();
+        rankings[s].clear();
+      }
+
+      remove_features(ex, marks, num_shared);
+    }
+
+    return S_VW_PREDICT_OK;
+  }
+
+public:
+
   template <typename PdfIt, typename InputScoreIt, typename OutputIt>
   static int sort_by_scores(PdfIt pdf_first, PdfIt pdf_last, InputScoreIt scores_first, InputScoreIt scores_last,
       OutputIt ranking_begin, OutputIt ranking_last)
@@ -577,6 +1056,8 @@ public:
     return S_EXPLORATION_OK;
   }
 
-  uint32_t feature_index_num_bits() { return _num_bits; }
+  uint32_t feature_index_num_bits() const { return _num_bits; }
+  // The hash of the feature names of the model, to give example_predict_builder and namespace_schema.
+  hash_string_func hasher() const { return _hasher; }
 };
 }  // namespace vw_slim
@@ -11,6 +11,14 @@
 #define E_VW_PREDICT_ERR_EXPLORATION_FAILED 8
 #define E_VW_PREDICT_ERR_INVALID_MODEL_CHECK_SUM 9
 #define E_VW_PREDICT_ERR_HASH_SEED_NOT_SUPPORTED 10
+#define E_VW_PREDICT_ERR_NOT_A_QUANTIZED_MODEL 11
+#define E_VW_PREDICT_ERR_NAMESPACE_IS_SHARED 12
+#define E_VW_PREDICT_ERR_WEIGHTS_NOT_MAPPABLE 13
+#define E_VW_PREDICT_ERR_NOT_A_CCB_MODEL 14
+#define E_VW_PREDICT_ERR_NOT_A_SLATES_MODEL 15
+#define E_VW_PREDICT_ERR_INVALID_SLOT 16
+#define E_VW_PREDICT_ERR_TOO_FEW_ACTIONS 17
+#define E_VW_PREDICT_ERR_HASH_FUNCTION_NOT_SUPPORTED 18
 #define RETURN_ON_FAIL(stmt)                                    \
   {                                                             \
     int ret##__LINE__ = stmt;                                   \
@@ -4,21 +4,48 @@
 
 namespace vw_slim
 {
+namespace_schema::namespace_schema(
+    const char* namespace_name, uint32_t feature_index_num_bits, hash_string_func hasher)
+    : _namespace_idx(namespace_name[0])
+    , _namespace_hash(hasher(namespace_name, strlen(namespace_name), 0))
+    , _feature_index_bit_mask(((uint64_t)1 << feature_index_num_bits) - 1)
+    , _hasher(hasher)
+{
+}
+
+namespace_schema::namespace_schema(
+    namespace_index namespace_idx, uint32_t feature_index_num_bits, hash_string_func hasher)
+    : _namespace_idx(namespace_idx)
+    , _namespace_hash(namespace_idx)
+    , _feature_index_bit_mask(((uint64_t)1 << feature_index_num_bits) - 1)
+    , _hasher(hasher)
+{
+}
+
+feature_index namespace_schema::feature(const char* feature_name) const
+{
+  return _feature_index_bit_mask & _hasher(feature_name, strlen(feature_name), _namespace_hash);
+}
+
 example_predict_builder::example_predict_builder(
-    example_predict* ex, char* namespace_name, uint32_t feature_index_num_bits)
-    : _ex(ex)
+    example_predict* ex, char* namespace_name, uint32_t feature_index_num_bits, hash_string_func hasher)
+    : example_predict_builder(ex, namespace_schema(namespace_name, feature_index_num_bits, hasher))
 {
-  _feature_index_bit_mask = ((uint64_t)1 << feature_index_num_bits) - 1;
-  add_namespace(namespace_name[0]);
-  _namespace_hash = hashstring(namespace_name, strlen(namespace_name), 0);
 }
 
 example_predict_builder::example_predict_builder(
-    example_predict* ex, namespace_index namespace_idx, uint32_t feature_index_num_bits)
-    : _ex(ex), _namespace_hash(namespace_idx)
+    example_predict* ex, namespace_index namespace_idx, uint32_t feature_index_num_bits, hash_string_func hasher)
+    : example_predict_builder(ex, namespace_schema(namespace_idx, feature_index_num_bits, hasher))
+{
+}
+
+example_predict_builder::example_predict_builder(example_predict* ex, const namespace_schema& schema)
+    : _ex(ex)
+    , _namespace_hash(schema.hash())
+    , _feature_index_bit_mask(schema.feature_index_bit_mask())
+    , _hasher(schema.hasher())
 {
-  _feature_index_bit_mask = ((uint64_t)1 << feature_index_num_bits) - 1;
-  add_namespace(namespace_idx);
+  add_namespace(schema.index());
 }
 
 void example_predict_builder::add_namespace(namespace_index feature_group)
@@ -30,7 +57,7 @@ void example_predict_builder::add_namespace(namespace_index feature_group)
 void example_predict_builder::push_feature_string(char* feature_name, feature_value value)
 {
   feature_index feature_hash =
-      _feature_index_bit_mask & hashstring(feature_name, strlen(feature_name), _namespace_hash);
+      _feature_index_bit_mask & _hasher(feature_name, strlen(feature_name), _namespace_hash);
   _ex->feature_space[_namespace_idx].push_back(value, feature_hash);
 }
 
@@ -38,4 +65,9 @@ void example_predict_builder::push_feature(feature_index feature_idx, feature_va
 {
   _ex->feature_space[_namespace_idx].push_back(value, _namespace_hash + feature_idx);
 }
+
+void example_predict_builder::push_hashed_feature(feature_index feature_hash, feature_value value)
+{
+  _ex->feature_space[_namespace_idx].push_back(value, feature_hash);
+}
 };  // namespace vw_slim
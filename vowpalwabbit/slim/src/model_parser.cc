@@ -44,4 +44,20 @@ int model_parser::skip(size_t bytes)
 
   return S_VW_PREDICT_OK;
 }
+
+int model_parser::read_weights(std::unique_ptr<mapped_parameters>& weights, uint32_t num_bits, uint32_t stride_shift)
+{
+  const size_t index_size = num_bits < 31 ? sizeof(uint32_t) : sizeof(uint64_t);
+  const size_t pair_size = index_size + sizeof(float);
+  const size_t length = _model_end - _model;
+  if (length % pair_size != 0) return E_VW_PREDICT_ERR_INVALID_MODEL;
+
+  weights = std::unique_ptr<mapped_parameters>(
+      new mapped_parameters(_model, length / pair_size, index_size, (uint64_t)1 << num_bits));
+  weights->stride_shift(stride_shift);
+  _model = _model_end;
+
+  // weights are excluded from checksum calculation
+  return weights->valid() ? S_VW_PREDICT_OK : E_VW_PREDICT_ERR_WEIGHTS_NOT_MAPPABLE;
+}
 }  // namespace vw_slim
\ No newline at end of file
@@ -1,7 +1,11 @@
 #include "vw_slim_predict.h"
 
 #include <cctype>
+#include <cstdio>
 #include <algorithm>
+#include <string>
+
+#include "hashstring.h"
 
 namespace vw_slim
 {
@@ -13,6 +17,23 @@ uint64_t ceil_log_2(uint64_t v)
     return 1 + ceil_log_2(v >> 1);
 }
 
+bool model_version_at_least(const std::string& version, int major, int minor, int rev)
+{
+  int v[3] = {0, 0, 0};
+  sscanf(version.c_str(), "%d.%d.%d", &v[0], &v[1], &v[2]);
+  if (v[0] != major) return v[0] > major;
+  if (v[1] != minor) return v[1] > minor;
+  return v[2] >= rev;
+}
+
+feature_index ccb_slot_id(size_t slot, uint32_t num_bits, hash_string_func hasher)
+{
+  // the namespace of the slot ids is "_id", and the id of slot i the feature "index<i>" of it
+  const std::string id = "index" + std::to_string(slot);
+  const uint64_t namespace_hash = hasher("_id", 3, 0);
+  return hasher(id.c_str(), id.size(), namespace_hash) & (((uint64_t)1 << num_bits) - 1);
+}
+
 namespace_copy_guard::namespace_copy_guard(example_predict& ex, unsigned char ns) : _ex(ex), _ns(ns)
 {
   if (std::end(_ex.indices) == std::find(std::begin(_ex.indices), std::end(_ex.indices), ns))
@@ -8,10 +8,17 @@
 #include <stdlib.h>
 #include <streambuf>
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 
 #include <fstream>
+#include <thread>
 #include "example_predict_builder.h"
 #include "array_parameters.h"
+#include "array_parameters_compact.h"
+#include "array_parameters_quantized.h"
+#include "model_parser.h"
 #include "data.h"
 
 using namespace ::testing;
@@ -92,16 +99,103 @@ test_data get_test_data(const char* model_filename)
   return td;
 }
 
+template <typename T>
+void append(std::vector<char>& model, T value)
+{
+  const char* bytes = (const char*)&value;
+  model.insert(model.end(), bytes, bytes + sizeof(T));
+}
+
+// reads the header up to the file options, as vw_predict::load does, and returns where the file options start
+const char* read_header(model_parser& mp, std::string& file_options)
+{
+  std::string s;
+  uint32_t len;
+  mp.read_string<false>("version", s);
+  mp.read_string<true>("model_id", s);
+  mp.skip(sizeof(char));   // "model character"
+  mp.skip(sizeof(float));  // "min_label"
+  mp.skip(sizeof(float));  // "max_label"
+  mp.read("num_bits", len);
+  mp.skip(sizeof(uint32_t));
+  mp.read("ngram_len", len);
+  mp.skip(3 * len);
+  mp.read("skips_len", len);
+  mp.skip(3 * len);
+  const char* options = mp.position();
+  mp.read_string<true>("file_options", file_options);
+  return options;
+}
+
+// rewrites a regression model as vw --save_quantized would have written it
+std::vector<char> quantize_model(const std::vector<char>& model)
+{
+  model_parser mp(model.data(), model.size());
+  std::string file_options;
+  const char* options = read_header(mp, file_options);
+  file_options += " --quantized";
+
+  std::vector<char> quantized(model.data(), options);
+  append(quantized, static_cast<uint32_t>(file_options.size() + 1));
+  quantized.insert(quantized.end(), file_options.c_str(), file_options.c_str() + file_options.size() + 1);
+
+  model_parser quantized_mp(quantized.data(), quantized.size());
+  read_header(quantized_mp, file_options);
+  append(quantized, static_cast<uint32_t>(sizeof(uint32_t)));
+  append(quantized, quantized_mp.checksum());
+
+  mp.skip(2 * sizeof(uint32_t));  // check sum
+  bool resume;
+  mp.read("resume", resume);
+  append(quantized, resume);
+
+  std::vector<std::pair<uint32_t, float>> weights;
+  while (mp.position() < model.data() + model.size())
+  {
+    std::pair<uint32_t, float> weight;
+    mp.read<uint32_t, false>("gd.weight.index", weight.first);
+    mp.read<float, false>("gd.weight.value", weight.second);
+    weights.push_back(weight);
+  }
+  std::sort(weights.begin(), weights.end());
+
+  std::vector<char> blocks;
+  uint32_t block_count = 0;
+  for (size_t first = 0; first < weights.size(); block_count++)
+  {
+    const uint64_t block = weights[first].first >> VW::QUANTIZED_BLOCK_SHIFT;
+    size_t last = first;
+    float max_magnitude = 0.f;
+    for (; last < weights.size() && (weights[last].first >> VW::QUANTIZED_BLOCK_SHIFT) == block; last++)
+      max_magnitude = std::max(max_magnitude, std::fabs(weights[last].second));
+
+    const float scale = VW::quantization_scale(max_magnitude);
+    append(blocks, block);
+    append(blocks, scale);
+    append(blocks, static_cast<uint16_t>(last - first));
+    for (; first < last; first++)
+    {
+      append(blocks, static_cast<uint8_t>(weights[first].first & (VW::QUANTIZED_BLOCK_SIZE - 1)));
+      append(blocks, VW::quantize(weights[first].second, scale));
+    }
+  }
+  append(quantized, block_count);
+  quantized.insert(quantized.end(), blocks.begin(), blocks.end());
+  return quantized;
+}
+
 template <typename W>
-void run_predict_in_memory(
-    const char* model_filename, const char* data_filename, const char* prediction_reference_filename)
+void run_predict_in_memory(const char* model_filename, const char* data_filename,
+    const char* prediction_reference_filename, float tolerance = 1e-5f, bool quantized = false)
 {
   std::vector<float> preds;
 
   vw_predict<W> vw;
   // if files would be available
   test_data td = get_test_data(model_filename);
-  ASSERT_EQ(S_VW_PREDICT_OK, vw.load((const char*)td.model, td.model_len));
+  std::vector<char> model((const char*)td.model, (const char*)td.model + td.model_len);
+  if (quantized) model = quantize_model(model);
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.load(model.data(), model.size()));
   EXPECT_FALSE(vw.is_cb_explore_adf());
 
   float score;
@@ -213,14 +307,17 @@ void run_predict_in_memory(
   // compare output
   std::vector<float> preds_expected = read_floats(td.pred, td.pred_len);
 
-  EXPECT_THAT(preds, Pointwise(FloatNearPointwise(1e-5f), preds_expected));
+  EXPECT_THAT(preds, Pointwise(FloatNearPointwise(tolerance), preds_expected));
 }
 
 enum PredictParamWeightType
 {
   All,
   Sparse,
-  Dense
+  Dense,
+  DenseFp16,
+  DenseBf16,
+  Mapped
 };
 
 struct PredictParam
@@ -234,8 +331,20 @@ struct PredictParam
 // nice rendering in unit tests
 ::std::ostream& operator<<(::std::ostream& os, const PredictParam& param)
 {
-  return os << param.model_filename << " " << param.data_filename << " "
-            << (param.weight_type == PredictParamWeightType::Sparse ? "sparse" : "dense");
+  os << param.model_filename << " " << param.data_filename << " ";
+  switch (param.weight_type)
+  {
+    case PredictParamWeightType::Sparse:
+      return os << "sparse";
+    case PredictParamWeightType::DenseFp16:
+      return os << "dense fp16";
+    case PredictParamWeightType::DenseBf16:
+      return os << "dense bf16";
+    case PredictParamWeightType::Mapped:
+      return os << "mapped";
+    default:
+      return os << "dense";
+  }
 }
 
 class PredictTest : public ::testing::TestWithParam<PredictParam>
@@ -244,9 +353,19 @@ class PredictTest : public ::testing::TestWithParam<PredictParam>
 
 TEST_P(PredictTest, Run)
 {
+  // 16 bit weights keep about 3 (bf16) or 4 (fp16) significant digits
   if (GetParam().weight_type == PredictParamWeightType::Sparse)
     run_predict_in_memory<sparse_parameters>(
         GetParam().model_filename, GetParam().data_filename, GetParam().prediction_reference_filename);
+  else if (GetParam().weight_type == PredictParamWeightType::DenseFp16)
+    run_predict_in_memory<dense_parameters_fp16>(
+        GetParam().model_filename, GetParam().data_filename, GetParam().prediction_reference_filename, 1e-3f);
+  else if (GetParam().weight_type == PredictParamWeightType::DenseBf16)
+    run_predict_in_memory<dense_parameters_bf16>(
+        GetParam().model_filename, GetParam().data_filename, GetParam().prediction_reference_filename, 1e-2f);
+  else if (GetParam().weight_type == PredictParamWeightType::Mapped)
+    run_predict_in_memory<mapped_parameters>(
+        GetParam().model_filename, GetParam().data_filename, GetParam().prediction_reference_filename);
   else
     run_predict_in_memory<dense_parameters>(
         GetParam().model_filename, GetParam().data_filename, GetParam().prediction_reference_filename);
@@ -276,7 +395,7 @@ std::vector<PredictParam> GenerateTestParams()
       fixtures.push_back(p);
     else
     {
-      for (int weight_type = PredictParamWeightType::Sparse; weight_type <= PredictParamWeightType::Dense;
+      for (int weight_type = PredictParamWeightType::Sparse; weight_type <= PredictParamWeightType::Mapped;
            weight_type++)
       {
         p.weight_type = static_cast<PredictParamWeightType>(weight_type);
@@ -344,6 +463,41 @@ InvalidModelParam invalid_model_param[] = {
 
 INSTANTIATE_TEST_SUITE_P(VowpalWabbitSlim, InvalidModelTest, ::testing::ValuesIn(invalid_model_param));
 
+TEST(VowpalWabbitSlim, quantized_model)
+{
+  run_predict_in_memory<dense_parameters>(
+      "regression_data_1", "regression_data_1.txt", "regression_data_1.pred", 1e-2f, true);
+  run_predict_in_memory<quantized_parameters>(
+      "regression_data_1", "regression_data_1.txt", "regression_data_1.pred", 1e-2f, true);
+  run_predict_in_memory<sparse_parameters>(
+      "regression_data_2", "regression_data_2.txt", "regression_data_2.pred", 1e-2f, true);
+  run_predict_in_memory<quantized_parameters>(
+      "regression_data_7", "regression_data_7.txt", "regression_data_7.pred", 1e-2f, true);
+
+  // without a scale per block, full precision weights cannot be kept quantized
+  test_data td = get_test_data("regression_data_1");
+  vw_predict<quantized_parameters> vw;
+  EXPECT_EQ(E_VW_PREDICT_ERR_NOT_A_QUANTIZED_MODEL, vw.load((const char*)td.model, td.model_len));
+}
+
+TEST(VowpalWabbitSlim, mapped_model)
+{
+  test_data td = get_test_data("regression_data_1");
+  std::vector<char> model((const char*)td.model, (const char*)td.model + td.model_len);
+
+  // the pairs are searched, so they must be in index order
+  std::vector<char> swapped(model);
+  std::rotate(swapped.end() - 16, swapped.end() - 8, swapped.end());
+  vw_predict<mapped_parameters> vw;
+  EXPECT_EQ(E_VW_PREDICT_ERR_WEIGHTS_NOT_MAPPABLE, vw.load(swapped.data(), swapped.size()));
+  vw_predict<dense_parameters> dense;
+  EXPECT_EQ(S_VW_PREDICT_OK, dense.load(swapped.data(), swapped.size()));
+
+  // a quantized model has no pairs
+  std::vector<char> quantized = quantize_model(model);
+  EXPECT_EQ(E_VW_PREDICT_ERR_WEIGHTS_NOT_MAPPABLE, vw.load(quantized.data(), quantized.size()));
+}
+
 TEST(VowpalWabbitSlim, multiclass_data_4)
 {
   vw_predict<sparse_parameters> vw;
@@ -640,6 +794,193 @@ CBPredictParam cb_predict_params[] = {
 
 INSTANTIATE_TEST_SUITE_P(VowpalWabbitSlim, CBPredictTest, ::testing::ValuesIn(cb_predict_params));
 
+// rewrites a cb_explore_adf model as vw would have written it with the options added, and with the flag of the ccb
+// models since 8.9.0 if one is given
+std::vector<char> ccb_model(const std::vector<char>& model, const char* options, const bool* multi_slot_seen = nullptr)
+{
+  model_parser mp(model.data(), model.size());
+  std::string file_options;
+  const char* options_begin = read_header(mp, file_options);
+  file_options += options;
+
+  std::vector<char> ccb(model.data(), options_begin);
+  // the version follows its length
+  if (multi_slot_seen != nullptr) memcpy(&ccb[sizeof(uint32_t)], "8.9.0", 5);
+  append(ccb, static_cast<uint32_t>(file_options.size() + 1));
+  ccb.insert(ccb.end(), file_options.c_str(), file_options.c_str() + file_options.size() + 1);
+
+  model_parser ccb_mp(ccb.data(), ccb.size());
+  read_header(ccb_mp, file_options);
+  append(ccb, static_cast<uint32_t>(sizeof(uint32_t)));
+  append(ccb, ccb_mp.checksum());
+  if (multi_slot_seen != nullptr) append(ccb, *multi_slot_seen);
+
+  mp.skip(2 * sizeof(uint32_t));  // check sum
+  ccb.insert(ccb.end(), mp.position(), model.data() + model.size());
+  return ccb;
+}
+
+TEST(VowpalWabbitSlim, ccb_single_slot_predicts_as_cb)
+{
+  for (const char* model_name : {"cb_data_5", "cb_data_6", "cb_data_7", "cb_data_8"})
+  {
+    test_data td = get_test_data(model_name);
+    std::vector<char> model((const char*)td.model, (const char*)td.model + td.model_len);
+    vw_predict<sparse_parameters> cb;
+    ASSERT_EQ(S_VW_PREDICT_OK, cb.load(model.data(), model.size()));
+
+    safe_example_predict shared;
+    safe_example_predict ex[3];
+    safe_example_predict slot;
+    generate_cb_data_5(shared, ex);
+    std::vector<std::vector<float>> pdfs;
+    std::vector<std::vector<int>> rankings;
+    EXPECT_EQ(E_VW_PREDICT_ERR_NOT_A_CCB_MODEL, cb.predict_ccb("seed", shared, ex, 3, &slot, 1, pdfs, rankings));
+
+    // a single slot without features, which vw predicts without slot ids until it sees more
+    std::vector<char> ccb_bytes = ccb_model(model, " --ccb_explore_adf");
+    vw_predict<sparse_parameters> ccb;
+    ASSERT_EQ(S_VW_PREDICT_OK, ccb.load(ccb_bytes.data(), ccb_bytes.size()));
+    EXPECT_TRUE(ccb.is_ccb_explore_adf());
+
+    for (size_t i = 0; i < 20; i++)
+    {
+      std::vector<float> pdf;
+      std::vector<int> ranking;
+      ASSERT_EQ(S_VW_PREDICT_OK, cb.predict(generate_string_seed(i).c_str(), shared, ex, 3, pdf, ranking));
+
+      ASSERT_EQ(S_VW_PREDICT_OK, ccb.predict_ccb(generate_string_seed(i).c_str(), shared, ex, 3, &slot, 1, pdfs, rankings));
+      ASSERT_EQ(1, rankings.size());
+      EXPECT_EQ(ranking, rankings[0]);
+      EXPECT_THAT(pdfs[0], Pointwise(FloatNearPointwise(1e-5f), pdf));
+    }
+  }
+}
+
+TEST(VowpalWabbitSlim, ccb_slots_choose_in_turn)
+{
+  test_data td = get_test_data("cb_data_6");
+  std::vector<char> model((const char*)td.model, (const char*)td.model + td.model_len);
+  const bool multi_slot_seen = true;
+  std::vector<char> ccb_bytes = ccb_model(model, " --ccb_explore_adf", &multi_slot_seen);
+  vw_predict<dense_parameters> vw;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.load(ccb_bytes.data(), ccb_bytes.size()));
+
+  safe_example_predict shared;
+  safe_example_predict ex[3];
+  generate_cb_data_5(shared, ex);
+  safe_example_predict slots[3];
+  example_predict_builder slot_features(&slots[1], (char*)" ");
+  slot_features.push_feature(1, 1.f);
+
+  std::vector<std::vector<float>> pdfs;
+  std::vector<std::vector<int>> rankings;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.predict_ccb("seed", shared, ex, 3, slots, 3, pdfs, rankings));
+  ASSERT_EQ(3, rankings.size());
+  std::set<int> chosen;
+  for (size_t s = 0; s < 3; s++)
+  {
+    // the slots choose among the actions the slots before them left
+    ASSERT_EQ(3 - s, rankings[s].size());
+    for (size_t k = 1; k < rankings[s].size(); k++) EXPECT_EQ(0, chosen.count(rankings[s][k]));
+    EXPECT_TRUE(chosen.insert(rankings[s][0]).second);
+    EXPECT_NEAR(1.f, std::accumulate(pdfs[s].begin(), pdfs[s].end(), 0.f), 1e-5f);
+  }
+
+  std::vector<std::vector<float>> again_pdfs;
+  std::vector<std::vector<int>> again_rankings;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.predict_ccb("seed", shared, ex, 3, slots, 3, again_pdfs, again_rankings));
+  EXPECT_EQ(rankings, again_rankings);
+
+  EXPECT_EQ(E_VW_PREDICT_ERR_TOO_FEW_ACTIONS, vw.predict_ccb("seed", shared, ex, 2, slots, 3, pdfs, rankings));
+}
+
+// The actions and slots with features in the namespaces of the features they are added to are scored whole, as the
+// same features would be if they came from the shared features.
+TEST(VowpalWabbitSlim, ccb_scores_features_wherever_they_come_from)
+{
+  test_data td = get_test_data("cb_data_6");
+  std::vector<char> model((const char*)td.model, (const char*)td.model + td.model_len);
+  const bool multi_slot_seen = true;
+  std::vector<char> ccb_bytes = ccb_model(model, " --ccb_explore_adf", &multi_slot_seen);
+  vw_predict<sparse_parameters> vw;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.load(ccb_bytes.data(), ccb_bytes.size()));
+
+  safe_example_predict shared;
+  example_predict_builder shared_a(&shared, (char*)"a");
+  shared_a.push_feature(0, 1.f);
+  shared_a.push_feature(5, 12.f);
+  safe_example_predict ex[3];
+  for (size_t i = 0; i < 3; i++)
+  {
+    example_predict_builder action_b(&ex[i], (char*)"b");
+    action_b.push_feature(1, 0.5f);
+    action_b.push_feature(0, i + 1.f);
+  }
+  safe_example_predict slots[2];
+  example_predict_builder slot_a(&slots[0], (char*)"a");
+  slot_a.push_feature(3, 2.f);
+  std::vector<std::vector<float>> pdfs;
+  std::vector<std::vector<int>> rankings;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.predict_ccb("seed", shared, ex, 3, slots, 2, pdfs, rankings));
+
+  // the first feature of every action, and the shared features of the first slot, from elsewhere
+  safe_example_predict moved_shared;
+  example_predict_builder moved_a(&moved_shared, (char*)"a");
+  moved_a.push_feature(0, 1.f);
+  moved_a.push_feature(5, 12.f);
+  moved_a.push_feature(3, 2.f);
+  example_predict_builder moved_b(&moved_shared, (char*)"b");
+  moved_b.push_feature(1, 0.5f);
+  safe_example_predict moved_ex[3];
+  for (size_t i = 0; i < 3; i++)
+  {
+    example_predict_builder action_b(&moved_ex[i], (char*)"b");
+    action_b.push_feature(0, i + 1.f);
+  }
+  std::vector<std::vector<float>> moved_pdfs;
+  std::vector<std::vector<int>> moved_rankings;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.predict_ccb("seed", moved_shared, moved_ex, 3, slots + 1, 1, moved_pdfs, moved_rankings));
+
+  EXPECT_EQ(rankings[0], moved_rankings[0]);
+  EXPECT_THAT(moved_pdfs[0], Pointwise(FloatNearPointwise(1e-5f), pdfs[0]));
+}
+
+TEST(VowpalWabbitSlim, slates_slots_choose_among_their_actions)
+{
+  test_data td = get_test_data("cb_data_5");
+  std::vector<char> model((const char*)td.model, (const char*)td.model + td.model_len);
+  const bool multi_slot_seen = true;
+  std::vector<char> ccb_bytes = ccb_model(model, " --ccb_explore_adf", &multi_slot_seen);
+  std::vector<char> slates_bytes = ccb_model(model, " --slates --ccb_explore_adf", &multi_slot_seen);
+
+  safe_example_predict shared;
+  safe_example_predict ex[3];
+  generate_cb_data_5(shared, ex);
+  safe_example_predict slots[2];
+  const size_t action_slots[] = {1, 0, 1};
+  std::vector<std::vector<float>> pdfs;
+  std::vector<std::vector<int>> rankings;
+
+  vw_predict<sparse_parameters> ccb;
+  ASSERT_EQ(S_VW_PREDICT_OK, ccb.load(ccb_bytes.data(), ccb_bytes.size()));
+  EXPECT_EQ(E_VW_PREDICT_ERR_NOT_A_SLATES_MODEL,
+      ccb.predict_slates("seed", shared, ex, action_slots, 3, slots, 2, pdfs, rankings));
+
+  vw_predict<sparse_parameters> vw;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.load(slates_bytes.data(), slates_bytes.size()));
+  EXPECT_TRUE(vw.is_slates());
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.predict_slates("seed", shared, ex, action_slots, 3, slots, 2, pdfs, rankings));
+  ASSERT_EQ(2, rankings.size());
+  EXPECT_EQ(std::vector<int>{0}, rankings[0]);
+  EXPECT_EQ(2, rankings[1].size());
+  EXPECT_EQ(1, rankings[1][0] + rankings[1][1]);
+
+  const size_t invalid_slots[] = {1, 0, 2};
+  EXPECT_EQ(E_VW_PREDICT_ERR_INVALID_SLOT,
+      vw.predict_slates("seed", shared, ex, invalid_slots, 3, slots, 2, pdfs, rankings));
+}
+
 // Test fixture to allow for both sparse and dense parameters
 template <typename W>
 class VwSlimTest : public ::testing::Test
@@ -648,7 +989,8 @@ class VwSlimTest : public ::testing::Test
 
 TYPED_TEST_SUITE_P(VwSlimTest);
 
-typedef ::testing::Types<sparse_parameters, dense_parameters> WeightParameters;
+typedef ::testing::Types<sparse_parameters, dense_parameters, dense_parameters_fp16, dense_parameters_bf16>
+    WeightParameters;
 
 TYPED_TEST_P(VwSlimTest, model_not_loaded)
 {
@@ -746,3 +1088,168 @@ TEST(ColdStartModel, action_set_not_reordered)
   EXPECT_GT(pdfs[0], pdfs[1]);
   EXPECT_THAT(rankings, ElementsAre(0, 1, 2, 3, 4));
 }
+
+TEST(VowpalWabbitSlim, namespace_schema_hashes_as_the_builder_does)
+{
+  // hashed once, up front
+  namespace_schema a("a");
+  namespace_schema five(5);
+  const feature_index x = a.feature("x");
+  const feature_index y = five.feature("y");
+  const feature_index two = a.numeric_feature(2);
+
+  safe_example_predict by_string;
+  example_predict_builder b0a(&by_string, (char*)"a");
+  b0a.push_feature_string((char*)"x", 1.f);
+  b0a.push_feature(2, 3.f);
+  example_predict_builder b05(&by_string, 5);
+  b05.push_feature_string((char*)"y", 4.f);
+
+  safe_example_predict by_schema;
+  example_predict_builder b1a(&by_schema, a);
+  b1a.push_hashed_feature(x, 1.f);
+  b1a.push_hashed_feature(two, 3.f);
+  example_predict_builder b15(&by_schema, five);
+  b15.push_hashed_feature(y, 4.f);
+
+  auto as_vector = [](const v_array<namespace_index>& v) { return std::vector<namespace_index>(v.begin(), v.end()); };
+  EXPECT_EQ(as_vector(by_schema.indices), as_vector(by_string.indices));
+  for (namespace_index ns : {(namespace_index)'a', (namespace_index)5})
+  {
+    const features& expected = by_string.feature_space[ns];
+    const features& actual = by_schema.feature_space[ns];
+    EXPECT_EQ(std::vector<feature_index>(actual.indicies.begin(), actual.indicies.end()),
+        std::vector<feature_index>(expected.indicies.begin(), expected.indicies.end()));
+    EXPECT_EQ(std::vector<feature_value>(actual.values.begin(), actual.values.end()),
+        std::vector<feature_value>(expected.values.begin(), expected.values.end()));
+  }
+}
+
+TEST(VowpalWabbitSlim, hash_function_of_the_model)
+{
+  test_data td = get_test_data("cb_data_5");
+  std::vector<char> model((const char*)td.model, (const char*)td.model + td.model_len);
+  vw_predict<sparse_parameters> murmur3;
+  ASSERT_EQ(S_VW_PREDICT_OK, murmur3.load(model.data(), model.size()));
+  EXPECT_TRUE(murmur3.hasher() == hashstring);
+
+  std::vector<char> xxh3_bytes = ccb_model(model, " --hash_function xxh3");
+  vw_predict<sparse_parameters> xxh3;
+  ASSERT_EQ(S_VW_PREDICT_OK, xxh3.load(xxh3_bytes.data(), xxh3_bytes.size()));
+  EXPECT_TRUE(xxh3.hasher() == hashstring_xxh3);
+
+  std::vector<char> unknown = ccb_model(model, " --hash_function md5");
+  vw_predict<sparse_parameters> vw;
+  EXPECT_EQ(E_VW_PREDICT_ERR_HASH_FUNCTION_NOT_SUPPORTED, vw.load(unknown.data(), unknown.size()));
+
+  // the names are hashed with the hash of the model given
+  namespace_schema a("a", 18, xxh3.hasher());
+  EXPECT_EQ(hashstring_xxh3("a", 1, 0), a.hash());
+  EXPECT_EQ(hashstring_xxh3("x", 1, a.hash()) & a.feature_index_bit_mask(), a.feature("x"));
+  safe_example_predict ex;
+  example_predict_builder builder(&ex, (char*)"a", 18, xxh3.hasher());
+  builder.push_feature_string((char*)"x", 1.f);
+  EXPECT_EQ(a.feature("x"), ex.feature_space['a'].indicies[0]);
+}
+
+TEST(VowpalWabbitSlim, predict_batch_scores_as_predict_does)
+{
+  // -q ab and --interactions abc, the shared namespace a interacts with those of the examples
+  for (const char* model_name : {"regression_data_3", "regression_data_4"})
+  {
+    test_data td = get_test_data(model_name);
+    vw_predict<dense_parameters> vw;
+    ASSERT_EQ(S_VW_PREDICT_OK, vw.load(reinterpret_cast<const char*>(td.model), td.model_len));
+
+    safe_example_predict shared;
+    example_predict_builder shared_a(&shared, (char*)"a");
+    shared_a.push_feature(0, 1.f);
+    shared_a.push_feature(1, 0.5f);
+
+    // three examples of namespaces b and c, the second without features
+    namespace_schema b("b");
+    namespace_schema c("c");
+    const std::vector<size_t> row_offsets = {0, 3, 3, 5};
+    const std::vector<namespace_index> namespaces = {'b', 'b', 'c', 'c', 'b'};
+    const std::vector<feature_index> indices = {
+        b.numeric_feature(2), b.numeric_feature(3), c.numeric_feature(3), c.numeric_feature(3), b.numeric_feature(2)};
+    const std::vector<feature_value> values = {2.f, 1.f, 3.f, 1.f, 4.f};
+    const example_batch batch = {3, row_offsets.data(), namespaces.data(), indices.data(), values.data()};
+
+    batch_context context;
+    std::vector<float> scores(batch.num_examples);
+    ASSERT_EQ(S_VW_PREDICT_OK, vw.predict_batch(context, batch, scores.data(), &shared));
+    // the context keeps its storage, a second batch scores the same
+    std::vector<float> again(batch.num_examples);
+    ASSERT_EQ(S_VW_PREDICT_OK, vw.predict_batch(context, batch, again.data(), &shared));
+
+    for (size_t i = 0; i < batch.num_examples; i++)
+    {
+      safe_example_predict ex;
+      example_predict_builder ex_a(&ex, (char*)"a");
+      ex_a.push_feature(0, 1.f);
+      ex_a.push_feature(1, 0.5f);
+      for (size_t j = row_offsets[i]; j < row_offsets[i + 1]; j++)
+      {
+        example_predict_builder builder(&ex, namespaces[j] == 'b' ? b : c);
+        builder.push_hashed_feature(indices[j], values[j]);
+      }
+      float expected;
+      ASSERT_EQ(S_VW_PREDICT_OK, vw.predict(ex, expected));
+      EXPECT_NEAR(expected, scores[i], 1e-5f);
+      EXPECT_EQ(scores[i], again[i]);
+    }
+
+    const std::vector<namespace_index> in_shared = {'a', 'a', 'c', 'c', 'b'};
+    const example_batch invalid = {3, row_offsets.data(), in_shared.data(), indices.data(), values.data()};
+    EXPECT_EQ(E_VW_PREDICT_ERR_NAMESPACE_IS_SHARED, vw.predict_batch(context, invalid, scores.data(), &shared));
+  }
+}
+
+TEST(VowpalWabbitSlim, predict_from_many_threads)
+{
+  test_data td = get_test_data("regression_data_4");
+  vw_predict<sparse_parameters> vw;
+  ASSERT_EQ(S_VW_PREDICT_OK, vw.load(reinterpret_cast<const char*>(td.model), td.model_len));
+  const vw_predict<sparse_parameters>& model = vw;
+
+  namespace_schema b("b");
+  const size_t num_examples = 200;
+  std::vector<size_t> row_offsets;
+  std::vector<namespace_index> namespaces;
+  std::vector<feature_index> indices;
+  std::vector<feature_value> values;
+  for (size_t i = 0; i < num_examples; i++)
+  {
+    row_offsets.push_back(namespaces.size());
+    for (size_t j = 0; j <= i % 4; j++)
+    {
+      namespaces.push_back('b');
+      indices.push_back(b.numeric_feature((uint32_t)(i + j)));
+      values.push_back(1.f + j);
+    }
+  }
+  row_offsets.push_back(namespaces.size());
+  const example_batch batch = {num_examples, row_offsets.data(), namespaces.data(), indices.data(), values.data()};
+
+  auto score = [&](std::vector<float>& scores) {
+    safe_example_predict shared;
+    example_predict_builder shared_a(&shared, (char*)"a");
+    shared_a.push_feature(0, 1.f);
+    batch_context context;
+    scores.resize(num_examples);
+    for (int pass = 0; pass < 20; pass++)
+      if (model.predict_batch(context, batch, scores.data(), &shared) != S_VW_PREDICT_OK) scores.clear();
+  };
+
+  std::vector<float> expected;
+  score(expected);
+  ASSERT_EQ(num_examples, expected.size());
+
+  // the threads share the model, each has examples and a context of its own
+  std::vector<std::vector<float>> scores(4);
+  std::vector<std::thread> threads;
+  for (auto& s : scores) threads.emplace_back(score, std::ref(s));
+  for (auto& t : threads) t.join();
+  for (const auto& s : scores) EXPECT_EQ(expected, s);
+}
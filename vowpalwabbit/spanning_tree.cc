@@ -74,6 +74,35 @@ void fail_send(const socket_t fd, const void* buf, const int count)
   if (send(fd, (char*)buf, count, 0) == -1) THROWERRNO("send: ");
 }
 
+// A node waiting for the tree sends nothing until it is told its kid count, so a socket with something to read has
+// been closed by a node that failed.
+static bool connection_lost(const socket_t fd)
+{
+  fd_set fds;
+  FD_ZERO(&fds);
+  FD_SET(fd, &fds);
+  timeval now = {0, 0};
+  if (select((int)fd + 1, &fds, nullptr, nullptr, &now) <= 0) return false;
+  char peek;
+  return recv(fd, &peek, 1, MSG_PEEK) <= 0;
+}
+
+// Forgets the nodes of nodeset whose connection was lost, so they can register again once restarted.
+static size_t drop_lost_nodes(partial& nodeset, size_t total, bool quiet)
+{
+  size_t dropped = 0;
+  for (size_t i = 0; i < total; i++)
+  {
+    if (nodeset.nodes[i].client_ip == (uint32_t)-1 || !connection_lost(nodeset.nodes[i].socket)) continue;
+    if (!quiet) std::cerr << "lost node " << i << ", waiting for it to register again" << std::endl;
+    CLOSESOCK(nodeset.nodes[i].socket);
+    nodeset.nodes[i].client_ip = (uint32_t)-1;
+    nodeset.filled--;
+    dropped++;
+  }
+  return dropped;
+}
+
 namespace VW
 {
 SpanningTree::SpanningTree(uint16_t port, bool quiet) : m_stop(false), m_port(port), m_future(nullptr), m_quiet(quiet)
@@ -225,6 +254,7 @@ void SpanningTree::Run()
       partial_nodesets.erase(nonce);
     }
 
+    if (ok && partial_nodeset.nodes[id].client_ip != (uint32_t)-1) drop_lost_nodes(partial_nodeset, total, m_quiet);
     if (ok && partial_nodeset.nodes[id].client_ip != (uint32_t)-1) ok = false;
     fail_send(f, &ok, sizeof(ok));
 
@@ -234,6 +264,8 @@ void SpanningTree::Run()
       partial_nodeset.nodes[id].socket = f;
       partial_nodeset.filled++;
     }
+    // A node that failed while the others registered would leave the tree without it.
+    if (partial_nodeset.filled == total) drop_lost_nodes(partial_nodeset, total, m_quiet);
     if (partial_nodeset.filled != total)  // Need to wait for more connections
     {
       partial_nodesets[nonce] = partial_nodeset;
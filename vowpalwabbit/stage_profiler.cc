@@ -0,0 +1,148 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include <algorithm>
+#include <iomanip>
+
+#include "stage_profiler.h"
+
+namespace VW
+{
+namespace
+{
+// the innermost timer of the thread which is timing, if any
+thread_local stage_timer* current_timer = nullptr;
+
+stage_statistics make_statistics(const std::string& name, const stage_counter& counter, double ticks_per_second)
+{
+  stage_statistics stats;
+  stats.name = name;
+  stats.calls = counter.calls.load(std::memory_order_relaxed);
+  stats.samples = counter.samples.load(std::memory_order_relaxed);
+  stats.seconds = 0.;
+  stats.self_seconds = 0.;
+  if (stats.samples > 0 && ticks_per_second > 0.)
+  {
+    const double scale = static_cast<double>(stats.calls) / static_cast<double>(stats.samples) / ticks_per_second;
+    stats.seconds = scale * static_cast<double>(counter.ticks.load(std::memory_order_relaxed));
+    stats.self_seconds = scale * static_cast<double>(counter.self_ticks.load(std::memory_order_relaxed));
+  }
+  return stats;
+}
+
+void report_line(std::ostream& out, const std::string& name, const stage_statistics& stats, double total_self_seconds)
+{
+  out << std::left << std::setw(36) << name << std::right << std::setw(12) << stats.calls << std::setw(11)
+      << stats.seconds << std::setw(11) << stats.self_seconds << std::setw(8)
+      << (total_self_seconds > 0. ? 100. * stats.self_seconds / total_self_seconds : 0.) << "%" << std::endl;
+}
+
+const char* const REDUCTION_STAGES[] = {"learn", "predict", "multipredict", "update", "finish_example"};
+
+std::vector<const stage_counter*> stages_of(const reduction_counters& counters)
+{
+  return {&counters.learn, &counters.predict, &counters.multipredict, &counters.update, &counters.finish_example};
+}
+}  // namespace
+
+void stage_timer::start(stage_counter* counter)
+{
+  const uint64_t call = counter->calls.fetch_add(1, std::memory_order_relaxed);
+  if (current_timer == nullptr && (call & stage_counter::SAMPLE_MASK) != 0) return;
+
+  _counter = counter;
+  _parent = current_timer;
+  current_timer = this;
+  _start = read_ticks();
+}
+
+void stage_timer::stop()
+{
+  const uint64_t elapsed = read_ticks() - _start;
+  _counter->ticks.fetch_add(elapsed, std::memory_order_relaxed);
+  _counter->self_ticks.fetch_add(elapsed - std::min(elapsed, _child_ticks), std::memory_order_relaxed);
+  _counter->samples.fetch_add(1, std::memory_order_relaxed);
+  if (_parent != nullptr) _parent->_child_ticks += elapsed;
+  current_timer = _parent;
+}
+
+stage_profiler::stage_profiler() : _start_ticks(read_ticks()), _start_time(std::chrono::steady_clock::now()) {}
+
+reduction_counters& stage_profiler::reduction(const std::string& name)
+{
+  for (auto& counters : _reductions)
+    if (counters.name == name) return counters;
+  _reductions.emplace_back(name);
+  return _reductions.back();
+}
+
+double stage_profiler::elapsed_seconds() const
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_time).count();
+}
+
+// The rate of the ticks over the run so far, which calibrates the time stamp counter against the steady clock.
+double stage_profiler::ticks_per_second() const
+{
+  const double elapsed = elapsed_seconds();
+  return elapsed > 0. ? static_cast<double>(read_ticks() - _start_ticks) / elapsed : 0.;
+}
+
+std::vector<stage_statistics> stage_profiler::statistics() const
+{
+  const double rate = ticks_per_second();
+  std::vector<stage_statistics> stats;
+  stats.push_back(make_statistics("io_fill", io_fill, rate));
+  stats.push_back(make_statistics("parse", parse, rate));
+  stats.push_back(make_statistics("setup_example", setup_example, rate));
+  if (!_reductions.empty()) stats.push_back(make_statistics("finish_example", _reductions.back().finish_example, rate));
+  stats.push_back(make_statistics("allreduce", allreduce, rate));
+  for (auto it = _reductions.rbegin(); it != _reductions.rend(); ++it)
+  {
+    const auto stages = stages_of(*it);
+    for (size_t i = 0; i < stages.size(); i++)
+      stats.push_back(make_statistics(std::string(REDUCTION_STAGES[i]) + " " + it->name, *stages[i], rate));
+  }
+  return stats;
+}
+
+void stage_profiler::report(std::ostream& out, uint64_t examples) const
+{
+  const double elapsed = elapsed_seconds();
+  const double rate = ticks_per_second();
+
+  std::vector<stage_statistics> stages = {make_statistics("io_fill", io_fill, rate),
+      make_statistics("parse", parse, rate), make_statistics("setup_example", setup_example, rate),
+      make_statistics("allreduce", allreduce, rate)};
+  std::vector<std::vector<stage_statistics>> reductions;
+  for (auto it = _reductions.rbegin(); it != _reductions.rend(); ++it)
+  {
+    reductions.emplace_back();
+    for (const auto* counter : stages_of(*it)) reductions.back().push_back(make_statistics(it->name, *counter, rate));
+  }
+
+  // the share of each line is of all the time timed, which the self seconds add up to
+  double total_self_seconds = 0.;
+  for (const auto& stats : stages) total_self_seconds += stats.self_seconds;
+  for (const auto& reduction : reductions)
+    for (const auto& stats : reduction) total_self_seconds += stats.self_seconds;
+
+  out << "stage timings, one call in " << stage_counter::SAMPLE_MASK + 1 << " sampled, " << std::setprecision(3)
+      << std::fixed << elapsed << " seconds, " << (elapsed > 0. ? examples / elapsed : 0.) << " examples/sec" << std::endl;
+  out << std::left << std::setw(36) << "stage" << std::right << std::setw(12) << "calls" << std::setw(11) << "seconds"
+      << std::setw(11) << "self" << std::setw(9) << "self %" << std::endl;
+  for (const auto& stats : stages)
+    if (stats.calls > 0) report_line(out, stats.name, stats, total_self_seconds);
+
+  // the reductions from the top of the stack down, each under the one which calls it
+  std::string indent;
+  for (const auto& reduction : reductions)
+  {
+    out << indent << reduction.front().name << std::endl;
+    indent += "  ";
+    for (size_t i = 0; i < reduction.size(); i++)
+      if (reduction[i].calls > 0) report_line(out, indent + REDUCTION_STAGES[i], reduction[i], total_self_seconds);
+  }
+}
+}  // namespace VW
@@ -0,0 +1,129 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#  include <intrin.h>
+#  define VW_STAGE_PROFILER_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#  define VW_STAGE_PROFILER_RDTSC
+#endif
+
+namespace VW
+{
+// The time stamp counter where there is one, which costs a few nanoseconds to read, else the steady clock in
+// nanoseconds. Ticks are converted to seconds with the rate measured over the run, see stage_profiler::statistics.
+inline uint64_t read_ticks()
+{
+#ifdef VW_STAGE_PROFILER_RDTSC
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+#endif
+}
+
+// The calls of a stage of the run and the ticks of those which were sampled, in all and less those of the stages they
+// called. Any thread may add to it.
+struct stage_counter
+{
+  static constexpr uint64_t SAMPLE_MASK = 63;  // one call in 64 is timed
+
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> samples{0};
+  std::atomic<uint64_t> ticks{0};
+  std::atomic<uint64_t> self_ticks{0};
+};
+
+// Times the scope it lives in if it is one of the sampled calls of the counter, or if a timer further up the thread's
+// stack is timing, which makes the stages a sampled call goes through be timed as well so that their ticks can be taken
+// off its own. A nullptr counter, which is what the stages are given when --stage_timing is off, costs a branch and
+// nothing else.
+class stage_timer
+{
+  stage_counter* _counter = nullptr;
+  stage_timer* _parent = nullptr;
+  uint64_t _start = 0;
+  uint64_t _child_ticks = 0;
+
+  void start(stage_counter* counter);
+  void stop();
+
+public:
+  explicit stage_timer(stage_counter* counter)
+  {
+    if (counter != nullptr) start(counter);
+  }
+
+  ~stage_timer()
+  {
+    if (_counter != nullptr) stop();
+  }
+
+  stage_timer(const stage_timer&) = delete;
+  stage_timer& operator=(const stage_timer&) = delete;
+};
+
+// The counters of what the learner of a reduction does, each of which includes the reductions below it.
+struct reduction_counters
+{
+  explicit reduction_counters(const std::string& name_) : name(name_) {}
+  std::string name;
+  stage_counter learn;
+  stage_counter predict;
+  stage_counter multipredict;
+  stage_counter update;
+  stage_counter finish_example;
+};
+
+struct stage_statistics
+{
+  std::string name;
+  uint64_t calls;
+  uint64_t samples;
+  double seconds;       // estimated from the samples, as if every call had been timed
+  double self_seconds;  // the same less the stages it called, e.g. the reductions below
+};
+
+// The stages of a run which --stage_timing times: reading the input, parsing it, setting up examples, allreduce, and
+// what the learner of each reduction does.
+class stage_profiler
+{
+  uint64_t _start_ticks;
+  std::chrono::steady_clock::time_point _start_time;
+  std::deque<reduction_counters> _reductions;  // in the order of the stack, the base learner first
+
+  double ticks_per_second() const;
+
+public:
+  stage_profiler();
+
+  stage_counter io_fill;
+  stage_counter parse;
+  stage_counter setup_example;
+  stage_counter allreduce;
+
+  // The counters of a reduction, which stay where they are for the life of the profiler. The reductions are to be
+  // added from the base learner up, as the stack is set up.
+  reduction_counters& reduction(const std::string& name);
+
+  double elapsed_seconds() const;
+  // The stages, then the top learner's finish_example, then what each reduction does from the top of the stack down,
+  // named after what it is and the reduction, e.g. "learn gd".
+  std::vector<stage_statistics> statistics() const;
+  // The stages and the reductions as a tree, indented as the stack is.
+  void report(std::ostream& out, uint64_t examples) const;
+};
+}  // namespace VW
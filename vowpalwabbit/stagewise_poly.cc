@@ -4,6 +4,7 @@
 
 #include <cfloat>
 #include <cassert>
+#include <vector>
 
 #include "gd.h"
 #include "accumulate.h"
@@ -51,6 +52,7 @@ struct stagewise_poly
 
   example synth_ec;
   // following is bookkeeping in synth_ec creation (dfs)
+  std::vector<feature> atomics;  // features of original_ec, masked and without ft_offset, gathered once per example
   feature synth_rec_f;
   example *original_ec;
   uint32_t cur_depth;
@@ -413,10 +415,14 @@ void synthetic_decycle(stagewise_poly &poly)
   }
 }
 
-void synthetic_create_rec(stagewise_poly &poly, float v, uint64_t findex)
+void synthetic_gather_atomic(stagewise_poly &poly, float v, uint64_t findex)
 {
   // Note: need to un_ft_shift since gd::foreach_feature bakes in the offset.
-  uint64_t wid_atomic = wid_mask(poly, un_ft_offset(poly, findex));
+  poly.atomics.emplace_back(v, wid_mask(poly, un_ft_offset(poly, findex)));
+}
+
+void synthetic_create_rec(stagewise_poly &poly, float v, uint64_t wid_atomic)
+{
   uint64_t wid_cur = child_wid(poly, wid_atomic, poly.synth_rec_f.weight_index);
   assert(wid_atomic % stride_shift(poly, 1) == 0);
 
@@ -461,7 +467,7 @@ void synthetic_create_rec(stagewise_poly &poly, float v, uint64_t findex)
 #ifdef DEBUG
       poly.max_depth = (poly.max_depth > poly.cur_depth) ? poly.max_depth : poly.cur_depth;
 #endif  // DEBUG
-      GD::foreach_feature<stagewise_poly, uint64_t, synthetic_create_rec>(*(poly.all), *(poly.original_ec), poly);
+      for (const feature &atomic : poly.atomics) synthetic_create_rec(poly, atomic.x, atomic.weight_index);
       --poly.cur_depth;
       poly.synth_rec_f = parent_f;
     }
@@ -481,8 +487,13 @@ void synthetic_create(stagewise_poly &poly, example &ec, bool training)
    * Another choice is to mark the constant feature as the single initial
    * parent, and recurse just on that feature (which arguably correctly interprets poly.cur_depth).
    * Problem with this is if there is a collision with the root...
+   *
+   * Every parent expands the same features of the original example, so they
+   * are gathered, interactions included, once before the dfs.
    */
-  GD::foreach_feature<stagewise_poly, uint64_t, synthetic_create_rec>(*poly.all, *poly.original_ec, poly);
+  poly.atomics.clear();
+  GD::foreach_feature<stagewise_poly, uint64_t, synthetic_gather_atomic>(*poly.all, *poly.original_ec, poly);
+  for (const feature &atomic : poly.atomics) synthetic_create_rec(poly, atomic.x, atomic.weight_index);
   synthetic_decycle(poly);
   poly.synth_ec.total_sum_feat_sq = poly.synth_ec.feature_space[tree_atomics].sum_feat_sq;
 
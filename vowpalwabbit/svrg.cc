@@ -3,12 +3,16 @@
 // individual contributors. All rights reserved. Released under a BSD (revised)
 // license as described in the file LICENSE.
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "gd.h"
 #include "vw.h"
 #include "reductions.h"
+#include "thread_affinity.h"
 
 using namespace VW::LEARNER;
 using namespace VW::config;
@@ -29,8 +33,29 @@ struct svrg
 
   // The VW process' global state.
   vw* all;
+
+  // With --svrg_threads, the examples of a pass computing the exact gradient are copied into stable_batch, and
+  // accumulate_stable_batch splits a full batch between the threads. The first thread adds to the stable gradient of
+  // the weights, the others each to a gradient of their own, a float per weight, which are added to it at the end of
+  // the pass.
+  size_t threads;
+  std::vector<example*> stable_batch;
+  size_t stable_batch_size;  // of the examples of stable_batch copied in this batch
+  std::vector<std::vector<float>> thread_gradients;
+
+  ~svrg()
+  {
+    for (example* ec : stable_batch)
+    {
+      VW::dealloc_example(nullptr, *ec);
+      free(ec);
+    }
+  }
 };
 
+// The examples of a batch of --svrg_threads, for each thread.
+constexpr size_t STABLE_BATCH_EXAMPLES_PER_THREAD = 256;
+
 // Mimic GD::inline_predict but with offset for predicting with either
 // stable versus inner weights.
 
@@ -106,11 +131,90 @@ void update_stable(const svrg& s, example& ec)
   GD::foreach_feature<float, update_stable_feature>(*s.all, ec, g);
 }
 
+struct thread_gradient
+{
+  float g_scalar;
+  float* gradient;  // a float per weight
+  uint64_t mask;
+  uint32_t stride_shift;
+};
+
+inline void update_thread_gradient(thread_gradient& t, float x, uint64_t index)
+{
+  t.gradient[(index & t.mask) >> t.stride_shift] += t.g_scalar * x;
+}
+
+// Adds the gradient of the examples of the batch, split between the threads. The stable weights do not change during
+// the pass, so that the examples can be taken in any order.
+void accumulate_stable_batch(svrg& s)
+{
+  vw& all = *s.all;
+  const size_t size = s.stable_batch_size;
+  s.stable_batch_size = 0;
+  if (size == 0) return;
+
+  const size_t threads = std::min(s.threads, size);
+  const uint64_t length = (all.weights.mask() >> all.weights.stride_shift()) + 1;
+  if (s.thread_gradients.size() < threads - 1) s.thread_gradients.resize(threads - 1);
+  for (size_t t = 0; t + 1 < threads; t++) s.thread_gradients[t].resize(length, 0.f);
+
+  auto accumulate_range = [&](size_t t) {
+    for (size_t i = size * t / threads; i < size * (t + 1) / threads; i++)
+    {
+      example& ec = *s.stable_batch[i];
+      if (t == 0)
+      {
+        update_stable(s, ec);
+        continue;
+      }
+      thread_gradient d = {gradient_scalar(s, ec, predict_stable(s, ec)), s.thread_gradients[t - 1].data(),
+          all.weights.mask(), all.weights.stride_shift()};
+      GD::foreach_feature<thread_gradient, uint64_t, update_thread_gradient>(all, ec, d);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++)
+    workers.push_back(VW::start_pinned_thread(VW::thread_role::worker, accumulate_range, t));
+  accumulate_range(0);
+  for (auto& worker : workers) worker.join();
+}
+
+// Ends a pass computing the exact gradient, adding the gradients of the threads to the stable gradient.
+void finish_stable_pass(svrg& s)
+{
+  accumulate_stable_batch(s);
+  for (auto& gradient : s.thread_gradients)
+  {
+    for (uint64_t j = 0; j < gradient.size(); j++)
+    {
+      if (gradient[j] == 0.f) continue;
+      const uint32_t index = (uint32_t)j;
+      VW::set_weight(*s.all, index, W_STABLEGRAD, VW::get_weight(*s.all, index, W_STABLEGRAD) + gradient[j]);
+    }
+    std::fill(gradient.begin(), gradient.end(), 0.f);
+  }
+}
+
+// Copies ec into the batch of --svrg_threads, which is accumulated once it is full.
+void batch_stable(svrg& s, example& ec)
+{
+  if (s.stable_batch_size == s.stable_batch.size())
+  {
+    example* copy = VW::alloc_examples(1);
+    s.stable_batch.push_back(copy);
+  }
+  example& copy = *s.stable_batch[s.stable_batch_size++];
+  VW::copy_example_data(false, &copy, &ec);
+  copy.l.simple = ec.l.simple;
+  if (s.stable_batch_size == s.threads * STABLE_BATCH_EXAMPLES_PER_THREAD) accumulate_stable_batch(s);
+}
+
 void learn(svrg& s, single_learner& base, example& ec)
 {
   predict(s, base, ec);
 
   const int pass = (int)s.all->passes_complete;
+  if (s.prev_pass != pass) finish_stable_pass(s);
 
   if (pass % (s.stage_size + 1) == 0)  // Compute exact gradient
   {
@@ -126,7 +230,10 @@ void learn(svrg& s, single_learner& base, example& ec)
       s.stable_grad_count = 0;
       std::cout << "svrg pass " << pass << ": computing exact gradient" << std::endl;
     }
-    update_stable(s, ec);
+    if (s.threads > 1)
+      batch_stable(s, ec);
+    else
+      update_stable(s, ec);
     s.stable_grad_count++;
   }
   else  // Perform updates
@@ -139,6 +246,8 @@ void learn(svrg& s, single_learner& base, example& ec)
   s.prev_pass = pass;
 }
 
+void end_pass(svrg& s) { finish_stable_pass(s); }
+
 void save_load(svrg& s, io_buf& model_file, bool read, bool text)
 {
   if (read) { initialize_regressor(*s.all); }
@@ -170,17 +279,24 @@ base_learner* svrg_setup(options_i& options, vw& all)
   option_group_definition new_options("Stochastic Variance Reduced Gradient");
   new_options
       .add(make_option("svrg", svrg_option).keep().necessary().help("Streaming Stochastic Variance Reduced Gradient"))
-      .add(make_option("stage_size", s->stage_size).default_value(1).help("Number of passes per SVRG stage"));
+      .add(make_option("stage_size", s->stage_size).default_value(1).help("Number of passes per SVRG stage"))
+      .add(make_option("svrg_threads", s->threads)
+               .default_value(1)
+               .help("Threads computing the exact gradient of a stage, 0 for one per core. Used with dense weights"));
 
   if (!options.add_parse_and_check_necessary(new_options)) { return nullptr; }
 
   s->all = &all;
   s->prev_pass = -1;
   s->stable_grad_count = 0;
+  if (s->threads == 0) s->threads = std::max(1u, std::thread::hardware_concurrency());
+  // Sparse weights are allocated as features are first seen, which threads cannot do concurrently.
+  if (all.weights.sparse) s->threads = 1;
 
   // Request more parameter storage (4 floats per feature)
   all.weights.stride_shift(2);
   learner<svrg, example>& l = init_learner(s, learn, predict, UINT64_ONE << all.weights.stride_shift());
   l.set_save_load(save_load);
+  l.set_end_pass(end_pass);
   return make_base(l);
 }
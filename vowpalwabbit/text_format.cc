@@ -0,0 +1,194 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "text_format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+#include "io/io_adapter.h"
+#include "vw_exception.h"
+
+namespace
+{
+constexpr uint64_t POWERS_OF_10[] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL};
+constexpr int MAX_SCALE = 10;
+constexpr int GENERAL_DIGITS = 6;
+
+// Sets truncated to magnitude * 10^scale rounded down and round_up to whether it is nearer truncated + 1, ties to even,
+// as printf rounds. magnitude is a finite float above 0, so that it is m * 2^e for an m of at most 24 bits, which makes
+// the product exact in 64 bits. Returns false when the result may not fit in 64 bits.
+bool scale_exactly(float magnitude, int scale, uint64_t& truncated, bool& round_up)
+{
+  int exponent;
+  const float fraction = std::frexp(magnitude, &exponent);
+  const uint64_t product = static_cast<uint64_t>(std::ldexp(fraction, 24)) * POWERS_OF_10[scale];
+  exponent -= 24;
+  round_up = false;
+  if (exponent >= 0)
+  {
+    if (exponent > 5) { return false; }
+    truncated = product << exponent;
+    return true;
+  }
+  const int shift = -exponent;
+  if (shift >= 64)
+  {
+    truncated = 0;
+    return true;
+  }
+  truncated = product >> shift;
+  const uint64_t remainder = product & ((1ULL << shift) - 1);
+  const uint64_t half = 1ULL << (shift - 1);
+  round_up = remainder > half || (remainder == half && (truncated & 1) != 0);
+  return true;
+}
+
+// Writes the digits of value, at least min_digits of them with leading zeros.
+char* write_digits(char* out, uint64_t value, int min_digits)
+{
+  char digits[20];
+  int length = 0;
+  do
+  {
+    digits[length++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (length < min_digits) { digits[length++] = '0'; }
+  while (length > 0) { *out++ = digits[--length]; }
+  return out;
+}
+
+char* format_with_printf(char* out, const char* format, int precision, float value)
+{
+  const int length = std::snprintf(out, VW::MAX_FLOAT_CHARS, format, precision, static_cast<double>(value));
+  return out + std::max(0, std::min(length, static_cast<int>(VW::MAX_FLOAT_CHARS) - 1));
+}
+}  // namespace
+
+namespace VW
+{
+char* format_general(char* out, float value)
+{
+  if (!std::isfinite(value)) { return format_with_printf(out, "%.*g", GENERAL_DIGITS, value); }
+  if (std::signbit(value)) { *out++ = '-'; }
+  const float magnitude = std::fabs(value);
+  if (magnitude == 0.f)
+  {
+    *out++ = '0';
+    return out;
+  }
+
+  // The scale takes the magnitude to 6 digits before the point, these are the significant digits once rounded.
+  int scale = GENERAL_DIGITS - 1 - static_cast<int>(std::floor(std::log10(magnitude)));
+  uint64_t digits = 0;
+  bool round_up = false;
+  bool found = false;
+  for (int attempt = 0; attempt < 3 && !found; attempt++)
+  {
+    if (scale < 0 || scale > MAX_SCALE || !scale_exactly(magnitude, scale, digits, round_up)) { break; }
+    if (digits >= POWERS_OF_10[GENERAL_DIGITS]) { scale--; }
+    else if (digits < POWERS_OF_10[GENERAL_DIGITS - 1])
+    {
+      scale++;
+    }
+    else
+    {
+      found = true;
+    }
+  }
+  if (found && round_up && ++digits == POWERS_OF_10[GENERAL_DIGITS])
+  {
+    // Rounding up 999999.5 takes the exponent up as well.
+    digits /= 10;
+    scale--;
+  }
+  // %g writes numbers with a decimal exponent outside of [-4, 6) in scientific notation, streams as well.
+  if (!found || scale < 0 || scale > GENERAL_DIGITS - 1 + 4)
+  { return format_with_printf(out, "%.*g", GENERAL_DIGITS, magnitude); }
+
+  out = write_digits(out, digits / POWERS_OF_10[scale], 1);
+  uint64_t decimals = digits % POWERS_OF_10[scale];
+  int num_decimals = scale;
+  // %g drops trailing zeros, and the point when all decimals are.
+  while (num_decimals > 0 && decimals % 10 == 0)
+  {
+    decimals /= 10;
+    num_decimals--;
+  }
+  if (num_decimals > 0)
+  {
+    *out++ = '.';
+    out = write_digits(out, decimals, num_decimals);
+  }
+  return out;
+}
+
+char* format_fixed(char* out, float value, int precision)
+{
+  uint64_t scaled = 0;
+  bool round_up = false;
+  if (!std::isfinite(value) || precision < 0 || precision > MAX_SCALE - 1 ||
+      (std::fabs(value) != 0.f && !scale_exactly(std::fabs(value), precision, scaled, round_up)))
+  { return format_with_printf(out, "%.*f", precision, value); }
+  if (round_up) { scaled++; }
+
+  if (std::signbit(value)) { *out++ = '-'; }
+  out = write_digits(out, scaled / POWERS_OF_10[precision], 1);
+  if (precision > 0)
+  {
+    *out++ = '.';
+    out = write_digits(out, scaled % POWERS_OF_10[precision], precision);
+  }
+  return out;
+}
+
+char* format_uint(char* out, uint64_t value) { return write_digits(out, value, 1); }
+
+text_line& text_line::add_uint(uint64_t value)
+{
+  char digits[20];
+  return add(digits, format_uint(digits, value) - digits);
+}
+
+text_line& text_line::add_general(float value)
+{
+  char text[MAX_FLOAT_CHARS];
+  return add(text, format_general(text, value) - text);
+}
+
+text_line& text_line::add_fixed(float value, int precision)
+{
+  char text[MAX_FLOAT_CHARS];
+  return add(text, format_fixed(text, value, precision) - text);
+}
+
+text_line& text_line::add_tag(const v_array<char>& tag)
+{
+  if (!tag.empty()) { add(' ').add(tag.begin(), tag.size()); }
+  return *this;
+}
+
+void text_line::write_to(io::writer* f)
+{
+  if (f != nullptr)
+  {
+    const auto length = static_cast<ssize_t>(_text.size());
+    if (f->write(_text.data(), _text.size()) != length)
+    { std::cerr << "write error: " << VW::strerror_to_string(errno) << std::endl; }
+  }
+  _text.clear();
+}
+
+text_line& thread_text_line()
+{
+  static thread_local text_line line;
+  line.clear();
+  return line;
+}
+}  // namespace VW
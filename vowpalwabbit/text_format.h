@@ -0,0 +1,68 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "v_array.h"
+
+namespace VW
+{
+namespace io
+{
+struct writer;
+}
+
+// The most characters format_general and format_fixed write for a float.
+constexpr size_t MAX_FLOAT_CHARS = 64;
+
+/// Writes value to out as std::ostream does by default, that is as printf's %g, and returns the end of the text.
+char* format_general(char* out, float value);
+
+/// Writes value to out as std::ostream does with std::fixed and the given precision, that is as printf's
+/// %.<precision>f, and returns the end of the text.
+char* format_fixed(char* out, float value, int precision);
+
+/// Writes value to out in decimal and returns the end of the text.
+char* format_uint(char* out, uint64_t value);
+
+// A line of predictions built up in a string kept from one line to the next, so that printing them allocates nothing
+// once the string is as long as the longest line. Numbers are written without streams, exactly as streams write them.
+class text_line
+{
+public:
+  text_line& add(char c)
+  {
+    _text.push_back(c);
+    return *this;
+  }
+  text_line& add(const char* text, size_t length)
+  {
+    _text.append(text, length);
+    return *this;
+  }
+  text_line& add(const std::string& text) { return add(text.data(), text.size()); }
+  text_line& add_uint(uint64_t value);
+  text_line& add_general(float value);
+  text_line& add_fixed(float value, int precision);
+  // A space and the tag, if there is one, as print_tag_by_ref writes it.
+  text_line& add_tag(const v_array<char>& tag);
+
+  const std::string& str() const { return _text; }
+  void clear() { _text.clear(); }
+
+  // Writes the line to f, if there is one, complaining on stderr when not all of it was written, and clears it.
+  void write_to(io::writer* f);
+
+private:
+  std::string _text;
+};
+
+/// The text_line of the calling thread, cleared. Printers format their lines in it one at a time, so a line passed on
+/// to another printer, such as print_text_by_ref, must be built in a text_line of its own.
+text_line& thread_text_line();
+}  // namespace VW
@@ -0,0 +1,135 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "thread_affinity.h"
+
+#ifdef __linux__
+#  include <sched.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include "vw_exception.h"
+
+namespace
+{
+uint32_t parse_cpu(const std::string& list, const std::string& item)
+{
+  if (item.empty() || item.find_first_not_of("0123456789") != std::string::npos)
+    THROW("malformed CPU list '" << list << "', expected CPUs or ranges of CPUs such as 0-7,16-23, or nodeN");
+  return static_cast<uint32_t>(std::stoul(item));
+}
+
+void append_cpus(const std::string& list, std::vector<uint32_t>& cpus)
+{
+  std::stringstream items(list);
+  std::string item;
+  while (std::getline(items, item, ','))
+  {
+    if (item.compare(0, 4, "node") == 0)
+    {
+      parse_cpu(list, item.substr(4));
+      const std::string path = "/sys/devices/system/node/" + item + "/cpulist";
+      std::ifstream node(path);
+      std::string node_list;
+      if (!std::getline(node, node_list))
+        THROW("there is no NUMA node " << item.substr(4) << ", " << path << " can't be read");
+      append_cpus(node_list, cpus);
+      continue;
+    }
+    const size_t dash = item.find('-');
+    const uint32_t first = parse_cpu(list, item.substr(0, dash));
+    const uint32_t last = dash == std::string::npos ? first : parse_cpu(list, item.substr(dash + 1));
+    if (last < first) THROW("the CPU range " << item << " of '" << list << "' is empty");
+    for (uint32_t cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+  }
+}
+
+#ifdef __linux__
+constexpr size_t THREAD_ROLES = static_cast<size_t>(VW::thread_role::worker) + 1;
+
+std::mutex cpus_lock;
+std::array<std::vector<uint32_t>, THREAD_ROLES> cpus_of_roles;
+
+// A set of cpus, allocated with CPU_ALLOC as machines may have more CPUs than a cpu_set_t holds. It holds every CPU of
+// the machine, as sched_getaffinity requires.
+struct cpu_set
+{
+  explicit cpu_set(const std::vector<uint32_t>& cpus)
+      : count(std::max<size_t>(*std::max_element(cpus.begin(), cpus.end()) + 1, sysconf(_SC_NPROCESSORS_CONF)))
+      , size(CPU_ALLOC_SIZE(count))
+      , set(CPU_ALLOC(count))
+  {
+    if (set == nullptr) THROW("can't allocate a set of CPUs");
+    CPU_ZERO_S(size, set);
+    for (uint32_t cpu : cpus) CPU_SET_S(cpu, size, set);
+  }
+  ~cpu_set() { CPU_FREE(set); }
+  cpu_set(const cpu_set&) = delete;
+  cpu_set& operator=(const cpu_set&) = delete;
+
+  size_t count;
+  size_t size;
+  cpu_set_t* set;
+};
+
+// Whether the process may run on any of cpus, as the CPUs of cgroups and taskset restrict it to.
+bool any_allowed(const std::vector<uint32_t>& cpus)
+{
+  cpu_set allowed(cpus);
+  if (sched_getaffinity(0, allowed.size, allowed.set) != 0) return true;
+  return std::any_of(
+      cpus.begin(), cpus.end(), [&](uint32_t cpu) { return CPU_ISSET_S(cpu, allowed.size, allowed.set); });
+}
+#endif
+}  // namespace
+
+namespace VW
+{
+std::vector<uint32_t> parse_cpu_list(const std::string& list)
+{
+  std::vector<uint32_t> cpus;
+  append_cpus(list, cpus);
+  if (cpus.empty()) THROW("the CPU list '" << list << "' is empty");
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+#ifdef __linux__
+bool thread_affinity_supported() { return true; }
+
+void set_thread_cpus(thread_role role, const std::vector<uint32_t>& cpus)
+{
+  if (!cpus.empty() && !any_allowed(cpus)) THROW("the process may run on none of the CPUs its threads are pinned to");
+  std::lock_guard<std::mutex> lock(cpus_lock);
+  cpus_of_roles[static_cast<size_t>(role)] = cpus;
+}
+
+void pin_current_thread(thread_role role)
+{
+  std::vector<uint32_t> cpus;
+  {
+    std::lock_guard<std::mutex> lock(cpus_lock);
+    cpus = cpus_of_roles[static_cast<size_t>(role)];
+  }
+  if (cpus.empty()) return;
+  // The CPUs the process may not run on are left out by the kernel, a thread pinned to none of them keeps running
+  // anywhere it may.
+  cpu_set pinned(cpus);
+  sched_setaffinity(0, pinned.size, pinned.set);
+}
+#else
+bool thread_affinity_supported() { return false; }
+
+void set_thread_cpus(thread_role, const std::vector<uint32_t>&) {}
+
+void pin_current_thread(thread_role) {}
+#endif
+}  // namespace VW
@@ -0,0 +1,54 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace VW
+{
+// The threads vw creates, by what they do, see --learner_cpus and the like.
+enum class thread_role
+{
+  learner,  // the thread which initializes vw and drives it, the --threads learners and the --holdout_thread evaluator
+  parser,   // the parse thread and the --parse_threads workers and readers
+  io,       // read ahead, block compression and background cache writing threads
+  output,   // the thread writing the predictions of --output_queue
+  worker    // the threads a learner splits a computation over, such as --bfgs_threads and --save_threads
+};
+
+/// The CPUs of a list such as "0-7,16-23", in which nodeN stands for the CPUs of NUMA node N.
+/// \throw VW::vw_exception if the list is malformed or names a node which does not exist
+std::vector<uint32_t> parse_cpu_list(const std::string& list);
+
+/// Whether threads can be pinned to CPUs here, which only Linux allows.
+bool thread_affinity_supported();
+
+/// Sets the CPUs the threads of role are pinned to as they start, none for them to run anywhere. The CPUs are those of
+/// the process, whichever vw instance set them, as threads only start after their instance is initialized.
+/// \throw VW::vw_exception if none of cpus is one the process may run on
+void set_thread_cpus(thread_role role, const std::vector<uint32_t>& cpus);
+
+/// Pins the calling thread to the CPUs of role, if any were set.
+void pin_current_thread(thread_role role);
+
+/// Starts a thread running f(args...) once it is pinned to the CPUs of role, for threads which run code that the
+/// starting thread runs as well.
+template <typename F, typename... Args>
+std::thread start_pinned_thread(thread_role role, F&& f, Args&&... args)
+{
+  return std::thread(
+      [role](typename std::decay<F>::type run, typename std::decay<Args>::type... run_args) {
+        pin_current_thread(role);
+        std::bind(std::move(run), std::move(run_args)...)();
+      },
+      std::forward<F>(f), std::forward<Args>(args)...);
+}
+}  // namespace VW
@@ -1,18 +1,61 @@
 // Copyright (c) by respective owners including Yahoo!, Microsoft, and
 // individual contributors. All rights reserved. Released under a BSD (revised)
 // license as described in the file LICENSE.
+#include <algorithm>
 #include <cfloat>
+#include <memory>
 #include <sstream>
 #include <queue>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "topk.h"
+#include "dense_batch.h"
+#include "gd.h"
 #include "learner.h"
 #include "parse_args.h"
+#include "thread_affinity.h"
 #include "vw.h"
 
 using namespace VW::config;
 
+namespace
+{
+// The fewest items a thread of --top_threads scores, below which threads cost more than they save.
+constexpr size_t MIN_THREAD_ITEMS = 4096;
+// The items predicted at once, so that their gathered features stay in the cache.
+constexpr size_t BATCH_ITEMS = 256;
+
+struct scored_item
+{
+  float pred;
+  size_t index;  // in the sequence of items
+};
+
+// Whether a ranks above b: by its prediction, and of two alike, the earlier item.
+inline bool ranks_above(const scored_item& a, const scored_item& b)
+{
+  return a.pred > b.pred || (a.pred == b.pred && a.index < b.index);
+}
+
+// Keeps the k items of heap ranked highest, the lowest of which is at its front.
+inline void push_bounded(std::vector<scored_item>& heap, size_t k, const scored_item& item)
+{
+  if (heap.size() < k)
+  {
+    heap.push_back(item);
+    std::push_heap(heap.begin(), heap.end(), ranks_above);
+  }
+  else if (k > 0 && ranks_above(item, heap.front()))
+  {
+    std::pop_heap(heap.begin(), heap.end(), ranks_above);
+    heap.back() = item;
+    std::push_heap(heap.begin(), heap.end(), ranks_above);
+  }
+}
+}  // namespace
+
 namespace VW
 {
 class topk
@@ -21,7 +64,7 @@ class topk
 
 public:
   using const_iterator_t = container_t::const_iterator;
-  topk(uint32_t k_num);
+  topk(uint32_t k_num, vw* all, size_t threads, std::unique_ptr<VW::dense_backend> backend);
 
   void predict(VW::LEARNER::single_learner& base, multi_ex& ec_seq);
   void learn(VW::LEARNER::single_learner& base, multi_ex& ec_seq);
@@ -30,16 +73,42 @@ public:
 
 private:
   void update_priority_queue(float pred, v_array<char>& tag);
+  void predict_batched(multi_ex& ec_seq);
 
   const uint32_t _k_num;
   container_t _pr_queue;
+
+  // When gd predicts right below the identity link of the scorer, unlabeled items are predicted in batches through
+  // _backend rather than one by one through the base, on up to _threads threads. Each thread keeps the best k of its
+  // items in a heap of its own, and the best of those make the top k.
+  vw* _all;
+  size_t _threads;
+  std::unique_ptr<VW::dense_backend> _backend;
+  std::vector<VW::flat_batch> _batches;
+  std::vector<multi_ex> _chunks;
+  std::vector<std::vector<scored_item>> _heaps;
 };
 }  // namespace VW
 
-VW::topk::topk(uint32_t k_num) : _k_num(k_num) {}
+VW::topk::topk(uint32_t k_num, vw* all, size_t threads, std::unique_ptr<VW::dense_backend> backend)
+    : _k_num(k_num)
+    , _all(all)
+    , _threads(threads)
+    , _backend(std::move(backend))
+    , _batches(threads)
+    , _chunks(threads)
+    , _heaps(threads)
+{
+}
 
 void VW::topk::predict(VW::LEARNER::single_learner& base, multi_ex& ec_seq)
 {
+  if (_backend != nullptr &&
+      std::all_of(ec_seq.begin(), ec_seq.end(), [](const example* ec) { return ec->l.simple.label == FLT_MAX; }))
+  {
+    predict_batched(ec_seq);
+    return;
+  }
   for (auto ec : ec_seq)
   {
     base.predict(*ec);
@@ -56,6 +125,36 @@ void VW::topk::learn(VW::LEARNER::single_learner& base, multi_ex& ec_seq)
   }
 }
 
+void VW::topk::predict_batched(multi_ex& ec_seq)
+{
+  const size_t threads = std::max<size_t>(1, std::min(_threads, ec_seq.size() / MIN_THREAD_ITEMS));
+  auto score_range = [&](size_t t) {
+    const size_t end = ec_seq.size() * (t + 1) / threads;
+    multi_ex& chunk = _chunks[t];
+    std::vector<scored_item>& heap = _heaps[t];
+    heap.clear();
+    for (size_t first = ec_seq.size() * t / threads; first < end; first += BATCH_ITEMS)
+    {
+      chunk.assign(ec_seq.begin() + first, ec_seq.begin() + std::min(end, first + BATCH_ITEMS));
+      GD::predict_batch(*_all, chunk, *_backend, _batches[t]);
+      for (size_t i = 0; i < chunk.size(); i++) push_bounded(heap, _k_num, {chunk[i]->pred.scalar, first + i});
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++)
+    workers.push_back(VW::start_pinned_thread(VW::thread_role::worker, score_range, t));
+  score_range(0);
+  for (auto& worker : workers) worker.join();
+
+  std::vector<scored_item> best;
+  for (size_t t = 0; t < threads; t++) best.insert(best.end(), _heaps[t].begin(), _heaps[t].end());
+  std::sort(best.begin(), best.end(), ranks_above);
+  if (best.size() > _k_num) best.resize(_k_num);
+  // Items of the same prediction are listed in the order of the sequence, as update_priority_queue lists them.
+  std::sort(best.begin(), best.end(), [](const scored_item& a, const scored_item& b) { return a.index < b.index; });
+  for (const auto& item : best) _pr_queue.insert({item.pred, ec_seq[item.index]->tag});
+}
+
 void VW::topk::update_priority_queue(float pred, v_array<char>& tag)
 {
   if (_pr_queue.size() < _k_num) { _pr_queue.insert({pred, tag}); }
@@ -122,15 +221,28 @@ void finish_example(vw& all, VW::topk& d, multi_ex& ec_seq)
 VW::LEARNER::base_learner* topk_setup(options_i& options, vw& all)
 {
   uint32_t K;
+  size_t threads;
   option_group_definition new_options("Top K");
-  new_options.add(make_option("top", K).keep().necessary().help("top k recommendation"));
+  new_options.add(make_option("top", K).keep().necessary().help("top k recommendation"))
+      .add(make_option("top_threads", threads)
+               .default_value(1)
+               .help("Threads predicting the items of a query, 0 for one per core. Used for unlabeled items when gd "
+                     "with dense weights predicts them, with the identity link"));
 
   if (!options.add_parse_and_check_necessary(new_options)) return nullptr;
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
 
-  auto data = scoped_calloc_or_throw<VW::topk>(K);
+  auto* base = as_singleline(setup_base(options, all));
+  // The items are predicted in batches only where that predicts what the base would.
+  const bool batched = all.enabled_reductions == std::vector<std::string>{"gd", "scorer"} && !all.weights.sparse &&
+      !all.audit && !all.hash_inv && !options.was_supplied("lazy_regularization") &&
+      options.get_typed_option<std::string>("link").value() == "identity";
+  std::unique_ptr<VW::dense_backend> backend;
+  if (batched) backend = VW::make_dense_backend(all, "cpu");
+  auto data = scoped_calloc_or_throw<VW::topk>(K, &all, threads, std::move(backend));
 
   VW::LEARNER::learner<VW::topk, multi_ex>& l =
-      init_learner(data, as_singleline(setup_base(options, all)), predict_or_learn<true>, predict_or_learn<false>);
+      init_learner(data, base, predict_or_learn<true>, predict_or_learn<false>);
   l.set_finish_example(finish_example);
 
   return make_base(l);
@@ -1,35 +1,66 @@
-// Copyright (c) by respective owners including Yahoo!, Microsoft, and
-// individual contributors. All rights reserved. Released under a BSD (revised)
-// license as described in the file LICENSE.
-#include "example.h"
-#include "unique_sort.h"
-#include <algorithm>
-
-void unique_features(features& fs, int max)
-{
-  if (fs.indicies.empty()) return;
-
-  features::features_value_index_audit_range range = fs.values_indices_audit();
-  features::iterator_all last_index = range.begin();
-  features::iterator_all end = max > 0 ? range.begin() + std::min(fs.size(), (size_t)max) : range.end();
-
-  for (features::iterator_all i = ++range.begin(); i != end; ++i)
-    if (i.index() != last_index.index())
-      if (i != ++last_index)
-      {
-        last_index.value() = i.value();
-        last_index.index() = i.index();
-        if (!fs.space_names.empty()) *last_index.audit() = *i.audit();
-      }
-
-  ++last_index;
-  fs.truncate_to(last_index);
-}
-
-void unique_sort_features(uint64_t parse_mask, example* ae)
-{
-  for (features& fs : *ae)
-    if (fs.sort(parse_mask)) unique_features(fs);
-
-  ae->sorted = true;
-}
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+#include "example.h"
+#include "unique_sort.h"
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+void unique_features(features& fs, int max)
+{
+  if (fs.indicies.empty()) return;
+
+  features::features_value_index_audit_range range = fs.values_indices_audit();
+  features::iterator_all last_index = range.begin();
+  features::iterator_all end = max > 0 ? range.begin() + std::min(fs.size(), (size_t)max) : range.end();
+
+  for (features::iterator_all i = ++range.begin(); i != end; ++i)
+    if (i.index() != last_index.index())
+      if (i != ++last_index)
+      {
+        last_index.value() = i.value();
+        last_index.index() = i.index();
+        if (!fs.space_names.empty()) *last_index.audit() = *i.audit();
+      }
+
+  ++last_index;
+  fs.truncate_to(last_index);
+}
+
+void limit_features(features& fs, uint64_t parse_mask, size_t limit)
+{
+  // The audit strings would have to be selected along, those few examples take the full sort.
+  if (limit == 0 || fs.size() <= limit || !fs.space_names.empty())
+  {
+    if (fs.sort(parse_mask)) unique_features(fs, static_cast<int>(std::min<size_t>(limit, INT_MAX)));
+    return;
+  }
+
+  std::vector<feature> slice;
+  slice.reserve(fs.size());
+  for (size_t i = 0; i < fs.size(); i++) slice.emplace_back(fs.values[i], fs.indicies[i] & parse_mask);
+  auto less = [](const feature& first, const feature& second) {
+    return (first.weight_index < second.weight_index) ||
+        ((first.weight_index == second.weight_index) && (first.x < second.x));
+  };
+  // Only the smallest limit features are sorted, they are the ones unique_features looks at.
+  std::nth_element(slice.begin(), slice.begin() + limit, slice.end(), less);
+  std::sort(slice.begin(), slice.begin() + limit, less);
+
+  for (size_t i = 0; i < limit; i++)
+  {
+    fs.values[i] = slice[i].x;
+    fs.indicies[i] = slice[i].weight_index;
+  }
+  fs.truncate_to(limit);
+  unique_features(fs);
+}
+
+void unique_sort_features(uint64_t parse_mask, example* ae)
+{
+  for (features& fs : *ae)
+    if (fs.sort(parse_mask)) unique_features(fs);
+
+  ae->sorted = true;
+}
@@ -8,3 +8,7 @@
 void unique_sort_features(uint64_t parse_mask, example* ae);
 
 void unique_features(features& fs, int max = -1);
+
+// Keeps the unique features among the limit smallest masked indices, sorted, as sorting fs and then
+// unique_features(fs, limit) do, without sorting the features beyond them.
+void limit_features(features& fs, uint64_t parse_mask, size_t limit);
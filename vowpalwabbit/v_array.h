@@ -78,6 +78,7 @@ public:
       { THROW_OR_RETURN("realloc of " << length << " failed in resize().  out of memory?"); }
       else
         _begin = temp;
+      if (length > 0) { VW_COUNT_ALLOCATION(v_array, sizeof(T) * length); }
       if (old_len < length && _begin + old_len != nullptr) memset(_begin + old_len, 0, (length - old_len) * sizeof(T));
       _end = _begin + old_len;
       end_array = _begin + length;
@@ -32,6 +32,7 @@
 #include "simple_label.h"
 #include "parser.h"
 #include "parse_example.h"
+#include "model_host.h"
 
 #include "options.h"
 
@@ -51,8 +52,17 @@ vw* initialize(std::string s, io_buf* model = nullptr, bool skipModelLoad = fals
     trace_message_t trace_listener = nullptr, void* trace_context = nullptr);
 vw* initialize(int argc, char* argv[], io_buf* model = nullptr, bool skipModelLoad = false,
     trace_message_t trace_listener = nullptr, void* trace_context = nullptr);
+vw* initialize(std::unique_ptr<config::options_i, options_deleter_type> options, io_buf* model, bool skipModelLoad,
+    trace_message_t trace_listener, void* trace_context, std::shared_ptr<std::vector<char>> memory_cache);
+// Initializes an instance which learns from a format 2 cache held in memory in place of its data, such as the
+// --in_memory cache of another instance once its first pass is over. The cache is shared, not copied, so that many
+// instances learn from examples which were parsed once. Its bits must be at least those of the instance.
+vw* initialize_with_memory_cache(const std::string& args, std::shared_ptr<std::vector<char>> memory_cache);
 vw* seed_vw_model(
     vw* vw_model, std::string extra_args, trace_message_t trace_listener = nullptr, void* trace_context = nullptr);
+// Like seed_vw_model, without the sources and outputs of vw_model: the new instance learns from examples parsed and
+// finished by vw_model, see --threads.
+vw* seed_vw_learner(vw& vw_model);
 // Allows the input command line string to have spaces escaped by '\'
 vw* initialize_escaped(std::string const& s, io_buf* model = nullptr, bool skipModelLoad = false,
     trace_message_t trace_listener = nullptr, void* trace_context = nullptr);
@@ -194,12 +204,12 @@ inline uint64_t chain_hash(vw& all, const std::string& name, const std::string&
 
 inline float get_weight(vw& all, uint32_t index, uint32_t offset)
 {
-  return (&all.weights[((uint64_t)index) << all.weights.stride_shift()])[offset];
+  return (&all.weights[((uint64_t)index) << all.weights.stride_shift()])[offset * all.weights.slot_distance()];
 }
 
 inline void set_weight(vw& all, uint32_t index, uint32_t offset, float value)
 {
-  (&all.weights[((uint64_t)index) << all.weights.stride_shift()])[offset] = value;
+  (&all.weights[((uint64_t)index) << all.weights.stride_shift()])[offset * all.weights.slot_distance()] = value;
 }
 
 inline uint32_t num_weights(vw& all) { return (uint32_t)all.length(); }
@@ -10,6 +10,7 @@
 template <class T, void (*f)(T&, const T&)>
 void all_reduce(vw& all, T* buffer, const size_t n)
 {
+  VW::stage_timer timer(all.profiler != nullptr ? &all.profiler->allreduce : nullptr);
   switch (all.all_reduce_type)
   {
     case AllReduceType::Socket:
@@ -19,5 +20,9 @@ void all_reduce(vw& all, T* buffer, const size_t n)
     case AllReduceType::Thread:
       ((AllReduceThreads*)all.all_reduce)->all_reduce<T, f>(buffer, n);
       break;
+
+    case AllReduceType::Hierarchical:
+      ((AllReduceHierarchical*)all.all_reduce)->all_reduce<T, f>(buffer, n);
+      break;
   }
 }
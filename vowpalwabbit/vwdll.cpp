@@ -13,6 +13,7 @@
 #include "parse_args.h"
 #include "vw.h"
 #include "memory.h"
+#include "best_constant.h"
 
 // This interface now provides "wide" functions for compatibility with .NET interop
 // The default functions assume a wide (16 bit char pointer) that is converted to a utf8-string and passed to
@@ -319,6 +320,93 @@ VW_DLL_PUBLIC float VW_CALLING_CONV VW_PredictCostSensitive(VW_HANDLE handle, VW
   return VW::get_cost_sensitive_prediction(ex);
 }
 
+namespace
+{
+struct flat_batch
+{
+  size_t count;
+  const size_t* example_offsets;
+  const unsigned char* namespaces;
+  const size_t* feature_offsets;
+  const size_t* feature_indices;
+  const float* feature_values;
+
+  void check(vw& all) const
+  {
+    if (all.l->is_multiline) THROW("VW_LearnBatch and VW_PredictBatch need a reduction of single line examples");
+    if (all.example_parser->lbl_parser.label_type != label_type_t::simple)
+      THROW("VW_LearnBatch and VW_PredictBatch need a reduction of simple labels");
+    if (count == 0) return;
+    for (size_t i = 0; i < count; i++)
+      if (example_offsets[i] > example_offsets[i + 1]) THROW("example_offsets must not decrease");
+    for (size_t n = example_offsets[0]; n < example_offsets[count]; n++)
+      if (feature_offsets[n] > feature_offsets[n + 1]) THROW("feature_offsets must not decrease");
+  }
+
+  // A pooled example of the features of example i, written in place, with the default label.
+  example& to_example(vw& all, size_t i) const
+  {
+    example& ec = VW::get_unused_example(&all);
+    all.example_parser->lbl_parser.default_label(&ec.l);
+    for (size_t n = example_offsets[i]; n < example_offsets[i + 1]; n++)
+    {
+      const unsigned char index = namespaces[n];
+      features& fs = ec.feature_space[index];
+      if (fs.size() == 0) ec.indices.push_back(index);
+      const size_t begin = feature_offsets[n];
+      const size_t end = feature_offsets[n + 1];
+      fs.values.resize(fs.values.size() + (end - begin));
+      fs.indicies.resize(fs.indicies.size() + (end - begin));
+      for (size_t k = begin; k < end; k++)
+      {
+        fs.values.push_back_unchecked(feature_values[k]);
+        fs.indicies.push_back_unchecked(feature_indices[k]);
+      }
+    }
+    return ec;
+  }
+};
+}  // namespace
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_LearnBatch(VW_HANDLE handle, size_t count, const size_t* example_offsets,
+    const unsigned char* namespaces, const size_t* feature_offsets, const size_t* feature_indices,
+    const float* feature_values, const float* labels, const float* weights, float* predictions)
+{
+  vw* pointer = static_cast<vw*>(handle);
+  const flat_batch batch = {count, example_offsets, namespaces, feature_offsets, feature_indices, feature_values};
+  batch.check(*pointer);
+  for (size_t i = 0; i < count; i++)
+  {
+    example& ec = batch.to_example(*pointer, i);
+    ec.l.simple.label = labels[i];
+    if (weights != nullptr) ec.l.simple.weight = weights[i];
+    count_label(pointer->sd, ec.l.simple.label);
+    VW::setup_example(*pointer, &ec);
+    pointer->example_parser->end_parsed_examples++;
+    pointer->learn(ec);
+    if (predictions != nullptr) predictions[i] = VW::get_prediction(&ec);
+    VW::finish_example(*pointer, ec);
+  }
+}
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_PredictBatch(VW_HANDLE handle, size_t count, const size_t* example_offsets,
+    const unsigned char* namespaces, const size_t* feature_offsets, const size_t* feature_indices,
+    const float* feature_values, float* predictions)
+{
+  vw* pointer = static_cast<vw*>(handle);
+  const flat_batch batch = {count, example_offsets, namespaces, feature_offsets, feature_indices, feature_values};
+  batch.check(*pointer);
+  for (size_t i = 0; i < count; i++)
+  {
+    example& ec = batch.to_example(*pointer, i);
+    VW::setup_example(*pointer, &ec);
+    pointer->example_parser->end_parsed_examples++;
+    VW::LEARNER::as_singleline(pointer->l)->predict(ec);
+    predictions[i] = VW::get_prediction(&ec);
+    VW::finish_example(*pointer, ec);
+  }
+}
+
 VW_DLL_PUBLIC float VW_CALLING_CONV VW_Get_Weight(VW_HANDLE handle, size_t index, size_t offset)
 { vw* pointer = static_cast<vw*>(handle);
   return VW::get_weight(*pointer, (uint32_t) index, (uint32_t) offset);
@@ -391,4 +479,79 @@ VW_DLL_PUBLIC void VW_CALLING_CONV VW_FreeIOBuf(VW_IOBUF bufferHandle)
 {
   delete static_cast<buffer_holder*>(bufferHandle);
 }
+
+VW_DLL_PUBLIC VW_MODEL_HOST VW_CALLING_CONV VW_CreateModelHost(size_t threads)
+{
+  return static_cast<VW_MODEL_HOST>(new VW::model_host(threads));
+}
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_DestroyModelHost(VW_MODEL_HOST host)
+{
+  delete static_cast<VW::model_host*>(host);
+}
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_AddHostedModelA(VW_MODEL_HOST host, const char* key, const char* pstrArgs)
+{
+  static_cast<VW::model_host*>(host)->add_model(key, pstrArgs);
+}
+
+VW_DLL_PUBLIC VW_HANDLE VW_CALLING_CONV VW_GetHostedModelA(VW_MODEL_HOST host, const char* key)
+{
+  return static_cast<VW_HANDLE>(&static_cast<VW::model_host*>(host)->model(key));
+}
+
+VW_DLL_PUBLIC VW_EXAMPLE VW_CALLING_CONV VW_ReadHostedExampleA(VW_MODEL_HOST host, const char* line)
+{
+  return static_cast<VW_EXAMPLE>(static_cast<VW::model_host*>(host)->read_example(line));
+}
+
+VW_DLL_PUBLIC float VW_CALLING_CONV VW_LearnHosted(VW_MODEL_HOST host, const char* key, VW_EXAMPLE e)
+{
+  example* ex = static_cast<example*>(e);
+  static_cast<VW::model_host*>(host)->learn(key, *ex);
+  return VW::get_prediction(ex);
+}
+
+VW_DLL_PUBLIC float VW_CALLING_CONV VW_PredictHosted(VW_MODEL_HOST host, const char* key, VW_EXAMPLE e)
+{
+  example* ex = static_cast<example*>(e);
+  static_cast<VW::model_host*>(host)->predict(key, *ex);
+  return VW::get_prediction(ex);
+}
+
+namespace
+{
+multi_ex to_multi_ex(VW_EXAMPLE* examples, size_t count)
+{
+  multi_ex result;
+  for (size_t i = 0; i < count; i++) result.push_back(static_cast<example*>(examples[i]));
+  return result;
+}
+}  // namespace
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_LearnHostedMultiline(
+    VW_MODEL_HOST host, const char* key, VW_EXAMPLE* examples, size_t count)
+{
+  multi_ex ec_seq = to_multi_ex(examples, count);
+  static_cast<VW::model_host*>(host)->learn(key, ec_seq);
+}
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_PredictHostedMultiline(
+    VW_MODEL_HOST host, const char* key, VW_EXAMPLE* examples, size_t count)
+{
+  multi_ex ec_seq = to_multi_ex(examples, count);
+  static_cast<VW::model_host*>(host)->predict(key, ec_seq);
+}
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_FinishHostedExample(VW_MODEL_HOST host, const char* key, VW_EXAMPLE e)
+{
+  static_cast<VW::model_host*>(host)->finish_example(key, *static_cast<example*>(e));
+}
+
+VW_DLL_PUBLIC void VW_CALLING_CONV VW_FinishHostedMultilineExample(
+    VW_MODEL_HOST host, const char* key, VW_EXAMPLE* examples, size_t count)
+{
+  multi_ex ec_seq = to_multi_ex(examples, count);
+  static_cast<VW::model_host*>(host)->finish_example(key, ec_seq);
+}
 }
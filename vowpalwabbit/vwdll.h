@@ -39,6 +39,7 @@ extern "C"
   typedef void* VW_FEATURE_SPACE;
   typedef void* VW_FEATURE;
   typedef void* VW_IOBUF;
+  typedef void* VW_MODEL_HOST;
 
   const VW_HANDLE INVALID_VW_HANDLE = VW_TYPE_SAFE_NULL;
   const VW_HANDLE INVALID_VW_EXAMPLE = VW_TYPE_SAFE_NULL;
@@ -113,6 +114,19 @@ extern "C"
   VW_DLL_PUBLIC float VW_CALLING_CONV VW_Learn(VW_HANDLE handle, VW_EXAMPLE e);
   VW_DLL_PUBLIC float VW_CALLING_CONV VW_Predict(VW_HANDLE handle, VW_EXAMPLE e);
   VW_DLL_PUBLIC float VW_CALLING_CONV VW_PredictCostSensitive(VW_HANDLE handle, VW_EXAMPLE e);
+
+  // A batch of count single line examples as flat arrays, learned or predicted in one call. Example i has the
+  // namespaces example_offsets[i] to example_offsets[i + 1] of namespaces, and namespace n the features
+  // feature_offsets[n] to feature_offsets[n + 1] of feature_indices and feature_values, hashed as VW_HashFeature
+  // hashes them. labels and weights, which may be null for weights of 1, hold a simple label per example, and
+  // predictions, which may be null when learning, receives the prediction of each. The examples are finished as
+  // VW_FinishExample finishes them.
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_LearnBatch(VW_HANDLE handle, size_t count, const size_t* example_offsets,
+      const unsigned char* namespaces, const size_t* feature_offsets, const size_t* feature_indices,
+      const float* feature_values, const float* labels, const float* weights, float* predictions);
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_PredictBatch(VW_HANDLE handle, size_t count, const size_t* example_offsets,
+      const unsigned char* namespaces, const size_t* feature_offsets, const size_t* feature_indices,
+      const float* feature_values, float* predictions);
   // deprecated. Please use either VW_ReadExample for parsing, or VW_ImportExample for example construction
   VW_DLL_PUBLIC void VW_CALLING_CONV VW_AddLabel(VW_EXAMPLE e, float label, float weight, float base);
   // deprecated. Please use either VW_ReadExample for parsing, or VW_ImportExample for example construction
@@ -128,6 +142,23 @@ extern "C"
       VW_HANDLE handle, VW_IOBUF* bufferHandle, char** outputData, size_t* outputSize);
   VW_DLL_PUBLIC void VW_CALLING_CONV VW_FreeIOBuf(VW_IOBUF bufferHandle);
 
+  // Many models in one process which share the examples the first model parses, see VW::model_host. Examples are
+  // read one line at a time and routed to a model by its key.
+  VW_DLL_PUBLIC VW_MODEL_HOST VW_CALLING_CONV VW_CreateModelHost(size_t threads);
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_DestroyModelHost(VW_MODEL_HOST host);
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_AddHostedModelA(VW_MODEL_HOST host, const char* key, const char* pstrArgs);
+  VW_DLL_PUBLIC VW_HANDLE VW_CALLING_CONV VW_GetHostedModelA(VW_MODEL_HOST host, const char* key);
+  VW_DLL_PUBLIC VW_EXAMPLE VW_CALLING_CONV VW_ReadHostedExampleA(VW_MODEL_HOST host, const char* line);
+  VW_DLL_PUBLIC float VW_CALLING_CONV VW_LearnHosted(VW_MODEL_HOST host, const char* key, VW_EXAMPLE e);
+  VW_DLL_PUBLIC float VW_CALLING_CONV VW_PredictHosted(VW_MODEL_HOST host, const char* key, VW_EXAMPLE e);
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_LearnHostedMultiline(
+      VW_MODEL_HOST host, const char* key, VW_EXAMPLE* examples, size_t count);
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_PredictHostedMultiline(
+      VW_MODEL_HOST host, const char* key, VW_EXAMPLE* examples, size_t count);
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_FinishHostedExample(VW_MODEL_HOST host, const char* key, VW_EXAMPLE e);
+  VW_DLL_PUBLIC void VW_CALLING_CONV VW_FinishHostedMultilineExample(
+      VW_MODEL_HOST host, const char* key, VW_EXAMPLE* examples, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
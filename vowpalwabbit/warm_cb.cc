@@ -596,7 +596,8 @@ base_learner* warm_cb_setup(options_i& options, vw& all)
   if (use_cs && (options.was_supplied("corrupt_type_warm_start") || options.was_supplied("corrupt_prob_warm_start")))
   { THROW("label corruption on cost-sensitive examples not currently supported"); }
 
-  data->app_seed = uniform_hash("vw", 2, 0);
+  // --random_seed gives the simulations of a --sweep_args each their own exploration
+  data->app_seed = uniform_hash("vw", 2, 0) + all.random_seed;
   data->a_s = v_init<action_score>();
   data->all = &all;
   data->_random_state = all.get_random_state();
@@ -0,0 +1,373 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "weight_allocator.h"
+
+#ifdef __linux__
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <fstream>
+#  include <vector>
+#  if defined(__NR_userfaultfd) && defined(__has_include)
+#    if __has_include(<linux/userfaultfd.h>)
+#      define VW_HAVE_USERFAULTFD
+#      include <fcntl.h>
+#      include <linux/userfaultfd.h>
+#      include <poll.h>
+#      include <sys/eventfd.h>
+#      include <sys/ioctl.h>
+#      include <cerrno>
+#      include <map>
+#      include <memory>
+#      include <mutex>
+#      include <thread>
+#    endif
+#  endif
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "memory.h"
+#include "vw_exception.h"
+
+#ifdef __linux__
+#  ifndef MAP_HUGE_SHIFT
+#    define MAP_HUGE_SHIFT 26
+#  endif
+// Policies of mbind, see <numaif.h>, which is only installed with libnuma.
+constexpr int VW_MPOL_INTERLEAVE = 3;
+constexpr int VW_MPOL_LOCAL = 4;
+
+namespace
+{
+// Reads the online nodes, such as "0-1,3", as a mask for mbind.
+std::vector<unsigned long> online_numa_nodes()
+{
+  constexpr size_t bits = 8 * sizeof(unsigned long);
+  std::vector<unsigned long> mask;
+  std::ifstream online("/sys/devices/system/node/online");
+  size_t first;
+  while (online >> first)
+  {
+    size_t last = first;
+    if (online.peek() == '-')
+    {
+      online.get();
+      online >> last;
+    }
+    for (size_t node = first; node <= last; node++)
+    {
+      if (mask.size() <= node / bits) mask.resize(node / bits + 1, 0);
+      mask[node / bits] |= 1UL << (node % bits);
+    }
+    if (online.peek() == ',') online.get();
+  }
+  return mask;
+}
+
+bool bind_numa(void* data, size_t bytes, VW::numa_policy numa)
+{
+  if (numa == VW::numa_policy::local) return syscall(SYS_mbind, data, bytes, VW_MPOL_LOCAL, nullptr, 0, 0) == 0;
+
+  auto nodes = online_numa_nodes();
+  if (nodes.empty()) return false;
+  // maxnode counts one more bit than the mask holds.
+  const unsigned long max_node = 8 * sizeof(unsigned long) * nodes.size() + 1;
+  return syscall(SYS_mbind, data, bytes, VW_MPOL_INTERLEAVE, nodes.data(), max_node, 0) == 0;
+}
+
+size_t round_up(size_t bytes, size_t page) { return (bytes + page - 1) / page * page; }
+
+// Maps reserved huge pages of the given size, nullptr if none are available.
+void* map_huge_pages(size_t bytes, size_t page_shift)
+{
+  void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | static_cast<int>(page_shift << MAP_HUGE_SHIFT), -1, 0);
+  return data == MAP_FAILED ? nullptr : data;
+}
+
+#  ifdef VW_HAVE_USERFAULTFD
+// Fills the pages of weights allocated by allocate_lazy_weights as they are first touched, on a thread of its own which
+// the kernel hands the page faults of the mapping to.
+class lazy_filler
+{
+public:
+  lazy_filler(int uffd, int stop, char* data, size_t initialized_count, uint32_t stride,
+      const std::function<void(float*, uint64_t)>& initializer)
+      : _uffd(uffd)
+      , _stop(stop)
+      , _data(data)
+      , _page_bytes(sysconf(_SC_PAGESIZE))
+      , _initialized_count(initialized_count)
+      , _stride(stride)
+      , _initializer(initializer)
+      , _thread(&lazy_filler::run, this)
+  {
+  }
+
+  ~lazy_filler()
+  {
+    // Left running rather than joined if it cannot be told to stop.
+    const uint64_t one = 1;
+    if (write(_stop, &one, sizeof(one)) == sizeof(one)) { _thread.join(); }
+    else
+    {
+      _thread.detach();
+    }
+    close(_uffd);
+    close(_stop);
+  }
+
+  lazy_filler(const lazy_filler&) = delete;
+  lazy_filler& operator=(const lazy_filler&) = delete;
+
+private:
+  void run()
+  {
+    std::vector<char> page(_page_bytes);
+    pollfd events[2] = {{_uffd, POLLIN, 0}, {_stop, POLLIN, 0}};
+    while (true)
+    {
+      if (poll(events, 2, -1) < 0)
+      {
+        if (errno == EINTR) continue;
+        return;
+      }
+      if (events[1].revents != 0) return;
+      uffd_msg message;
+      if (read(_uffd, &message, sizeof(message)) != sizeof(message)) continue;
+      if (message.event == UFFD_EVENT_PAGEFAULT) fill(message.arg.pagefault.address & ~(_page_bytes - 1), page.data());
+    }
+  }
+
+  void fill(uint64_t address, char* page)
+  {
+    memset(page, 0, _page_bytes);
+    float* values = reinterpret_cast<float*>(page);
+    const uint64_t first = (address - reinterpret_cast<uint64_t>(_data)) / sizeof(float);
+    const uint64_t last = std::min<uint64_t>(first + _page_bytes / sizeof(float), _initialized_count);
+    for (uint64_t i = (first + _stride - 1) / _stride * _stride; i < last; i += _stride)
+      _initializer(values + (i - first), i);
+
+    uffdio_copy copy;
+    copy.dst = address;
+    copy.src = reinterpret_cast<uint64_t>(page);
+    copy.len = _page_bytes;
+    copy.mode = 0;
+    copy.copy = 0;
+    // The page is already there when several threads faulted on it, so only the waiting threads are left to wake.
+    if (ioctl(_uffd, UFFDIO_COPY, &copy) != 0 && errno == EEXIST)
+    {
+      uffdio_range range{address, _page_bytes};
+      ioctl(_uffd, UFFDIO_WAKE, &range);
+    }
+  }
+
+  int _uffd;
+  int _stop;  // an eventfd written to stop the thread
+  char* _data;
+  size_t _page_bytes;
+  size_t _initialized_count;
+  uint32_t _stride;
+  std::function<void(float*, uint64_t)> _initializer;
+  std::thread _thread;
+};
+
+std::mutex& lazy_fillers_lock()
+{
+  static std::mutex lock;
+  return lock;
+}
+
+std::map<const float*, std::unique_ptr<lazy_filler>>& lazy_fillers()
+{
+  static std::map<const float*, std::unique_ptr<lazy_filler>> fillers;
+  return fillers;
+}
+
+// Registers the mapping at data for its missing pages to be reported to uffd.
+bool register_missing_pages(int uffd, void* data, size_t bytes)
+{
+  uffdio_api api;
+  memset(&api, 0, sizeof(api));
+  api.api = UFFD_API;
+  if (ioctl(uffd, UFFDIO_API, &api) != 0) return false;
+  uffdio_register registration;
+  memset(&registration, 0, sizeof(registration));
+  registration.range.start = reinterpret_cast<uint64_t>(data);
+  registration.range.len = bytes;
+  registration.mode = UFFDIO_REGISTER_MODE_MISSING;
+  return ioctl(uffd, UFFDIO_REGISTER, &registration) == 0 &&
+      (registration.ioctls & (uint64_t(1) << _UFFDIO_COPY)) != 0;
+}
+#  endif
+}  // namespace
+#endif
+
+namespace VW
+{
+allocated_weights allocate_weights(size_t count, const weight_allocation& requested)
+{
+  allocated_weights allocated{nullptr, 0, weight_allocation()};
+#ifdef __linux__
+  if (!requested.is_default() && count > 0)
+  {
+    // Anonymous mappings are zeroed and their pages are only placed once touched, as mbind requires.
+    const size_t bytes = count * sizeof(float);
+    void* data = nullptr;
+    if (requested.pages == huge_pages::size_1gb)
+    {
+      allocated.mapped_bytes = round_up(bytes, size_t(1) << 30);
+      data = map_huge_pages(allocated.mapped_bytes, 30);
+      if (data != nullptr) allocated.allocation.pages = huge_pages::size_1gb;
+    }
+    if (data == nullptr && (requested.pages == huge_pages::size_1gb || requested.pages == huge_pages::size_2mb))
+    {
+      allocated.mapped_bytes = round_up(bytes, size_t(1) << 21);
+      data = map_huge_pages(allocated.mapped_bytes, 21);
+      if (data != nullptr) allocated.allocation.pages = huge_pages::size_2mb;
+    }
+    if (data == nullptr)
+    {
+      allocated.mapped_bytes = round_up(bytes, sysconf(_SC_PAGESIZE));
+      data = mmap(nullptr, allocated.mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (data == MAP_FAILED) THROW_OR_RETURN("internal error: memory allocation failed!", allocated);
+#  ifdef MADV_HUGEPAGE
+      if (requested.pages != huge_pages::none && madvise(data, allocated.mapped_bytes, MADV_HUGEPAGE) == 0)
+        allocated.allocation.pages = huge_pages::transparent;
+#  endif
+    }
+
+    if (requested.numa != numa_policy::none && bind_numa(data, allocated.mapped_bytes, requested.numa))
+      allocated.allocation.numa = requested.numa;
+    allocated.data = static_cast<float*>(data);
+    return allocated;
+  }
+#else
+  _UNUSED(requested);
+#endif
+  allocated.data = calloc_mergable_or_throw<float>(count);
+  return allocated;
+}
+
+allocated_weights allocate_lazy_weights(size_t count, size_t initialized_count, uint32_t stride,
+    const std::function<void(float*, uint64_t)>& initializer)
+{
+  allocated_weights allocated{nullptr, 0, weight_allocation()};
+#ifdef VW_HAVE_USERFAULTFD
+  if (count == 0) return allocated;
+  const size_t bytes = round_up(count * sizeof(float), sysconf(_SC_PAGESIZE));
+  const int uffd = static_cast<int>(syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK));
+  if (uffd < 0) return allocated;
+  void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED)
+  {
+    close(uffd);
+    return allocated;
+  }
+  const int stop = register_missing_pages(uffd, data, bytes) ? eventfd(0, EFD_CLOEXEC) : -1;
+  if (stop < 0)
+  {
+    munmap(data, bytes);
+    close(uffd);
+    return allocated;
+  }
+
+  std::unique_ptr<lazy_filler> filler(
+      new lazy_filler(uffd, stop, static_cast<char*>(data), initialized_count, stride, initializer));
+  std::lock_guard<std::mutex> lock(lazy_fillers_lock());
+  allocated.data = static_cast<float*>(data);
+  allocated.mapped_bytes = bytes;
+  lazy_fillers()[allocated.data] = std::move(filler);
+#else
+  _UNUSED(count);
+  _UNUSED(initialized_count);
+  _UNUSED(stride);
+  _UNUSED(initializer);
+#endif
+  return allocated;
+}
+
+bool filled_on_demand(const float* data)
+{
+#ifdef VW_HAVE_USERFAULTFD
+  std::lock_guard<std::mutex> lock(lazy_fillers_lock());
+  return lazy_fillers().count(data) > 0;
+#else
+  _UNUSED(data);
+  return false;
+#endif
+}
+
+void free_weights(float* data, size_t mapped_bytes)
+{
+#ifdef __linux__
+  if (mapped_bytes > 0)
+  {
+#  ifdef VW_HAVE_USERFAULTFD
+    {
+      std::lock_guard<std::mutex> lock(lazy_fillers_lock());
+      lazy_fillers().erase(data);
+    }
+#  endif
+    munmap(data, mapped_bytes);
+    return;
+  }
+#endif
+  free(data);
+}
+
+huge_pages parse_huge_pages(const std::string& name)
+{
+  if (name == "none") { return huge_pages::none; }
+  if (name == "transparent") { return huge_pages::transparent; }
+  if (name == "2mb") { return huge_pages::size_2mb; }
+  if (name == "1gb") { return huge_pages::size_1gb; }
+  THROW_OR_RETURN("unknown huge pages '" << name << "', expected none, transparent, 2mb or 1gb", huge_pages::none);
+}
+
+numa_policy parse_numa_policy(const std::string& name)
+{
+  if (name == "none") { return numa_policy::none; }
+  if (name == "interleave") { return numa_policy::interleave; }
+  if (name == "local") { return numa_policy::local; }
+  THROW_OR_RETURN("unknown NUMA policy '" << name << "', expected none, interleave or local", numa_policy::none);
+}
+
+std::string to_string(const weight_allocation& allocation)
+{
+  std::string description;
+  switch (allocation.pages)
+  {
+    case huge_pages::none:
+      description = "regular pages";
+      break;
+    case huge_pages::transparent:
+      description = "transparent huge pages";
+      break;
+    case huge_pages::size_2mb:
+      description = "2mb huge pages";
+      break;
+    case huge_pages::size_1gb:
+      description = "1gb huge pages";
+      break;
+  }
+  switch (allocation.numa)
+  {
+    case numa_policy::none:
+      description += ", default NUMA placement";
+      break;
+    case numa_policy::interleave:
+      description += ", interleaved over NUMA nodes";
+      break;
+    case numa_policy::local:
+      description += ", local to the learner's NUMA node";
+      break;
+  }
+  return description;
+}
+}  // namespace VW
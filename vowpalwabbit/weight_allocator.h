@@ -0,0 +1,72 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace VW
+{
+enum class huge_pages
+{
+  none,
+  transparent,  // transparent huge pages, requested with madvise
+  size_2mb,     // reserved 2MB pages, see /proc/sys/vm/nr_hugepages
+  size_1gb      // reserved 1GB pages
+};
+
+enum class numa_policy
+{
+  none,
+  interleave,  // pages spread evenly over the online nodes
+  local        // pages on the node of the thread which first touches them, the learner
+};
+
+// How dense weights are allocated, see --huge_pages and --numa. Only Linux honours it, elsewhere weights are always
+// allocated normally.
+struct weight_allocation
+{
+  huge_pages pages = huge_pages::none;
+  numa_policy numa = numa_policy::none;
+
+  bool is_default() const { return pages == huge_pages::none && numa == numa_policy::none; }
+};
+
+struct allocated_weights
+{
+  float* data;
+  size_t mapped_bytes;  // size of the mapping to release with free_weights, 0 if allocated with malloc
+  weight_allocation allocation;  // what took effect, which may fall short of what was asked for
+};
+
+/// Allocates count zeroed weights. Huge pages fall back to smaller pages and NUMA placement to none when they are not
+/// available.
+/// \throw VW::vw_exception if the memory cannot be allocated at all
+allocated_weights allocate_weights(size_t count, const weight_allocation& requested);
+
+/// Reserves count zeroed weights whose pages are only filled once touched, see --lazy_weights: initializer(&w[i], i)
+/// then sets each weight at an index i below initialized_count which is a multiple of stride, as set_default would.
+/// Requires userfaultfd, so Linux.
+/// \returns data nullptr if the weights cannot be filled on demand here, so that they are to be initialized up front
+allocated_weights allocate_lazy_weights(size_t count, size_t initialized_count, uint32_t stride,
+    const std::function<void(float*, uint64_t)>& initializer);
+
+/// Whether the weights at data are filled on demand, see allocate_lazy_weights. Only the process which allocated them
+/// fills them: the pages a forked child touches first read as zeros.
+bool filled_on_demand(const float* data);
+
+/// Releases weights returned by allocate_weights or allocate_lazy_weights.
+void free_weights(float* data, size_t mapped_bytes);
+
+/// \param name one of none, transparent, 2mb or 1gb
+huge_pages parse_huge_pages(const std::string& name);
+/// \param name one of none, interleave or local
+numa_policy parse_numa_policy(const std::string& name);
+
+/// Describes an allocation for the start up messages, such as "2mb huge pages, interleaved over NUMA nodes".
+std::string to_string(const weight_allocation& allocation);
+}  // namespace VW
@@ -0,0 +1,282 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+// XXH3, the 64 bit variant with a seed, by Yann Collet.
+//
+// Original at:
+// https://github.com/Cyan4973/xxHash
+//
+// A scalar port of XXH3_64bits_withSeed of xxHash 0.8, which gives the same hashes. It reads the input as little
+// endian, as xxHash does, so the hashes are the same on every platform.
+
+//-----------------------------------------------------------------------------
+// xxHash is Copyright (C) 2012-2021 Yann Collet, and is released under a BSD 2-Clause license.
+//----
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(_M_CEE)
+#  include <intrin.h>
+#endif
+
+namespace XXH3
+{
+constexpr uint64_t PRIME32_1 = 0x9E3779B1U;
+constexpr uint64_t PRIME32_2 = 0x85EBCA77U;
+constexpr uint64_t PRIME32_3 = 0xC2B2AE3DU;
+constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t PRIME_MX1 = 0x165667919E3779F9ULL;
+constexpr uint64_t PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t SECRET_SIZE = 192;
+constexpr size_t MIDSIZE_MAX = 240;
+constexpr size_t STRIPE_LEN = 64;
+constexpr size_t SECRET_CONSUME_RATE = 8;
+constexpr size_t ACC_NB = STRIPE_LEN / sizeof(uint64_t);
+
+// The default secret, taken from FARSH.
+alignas(64) static const uint8_t SECRET[SECRET_SIZE] = {0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01,
+    0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7,
+    0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52,
+    0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d,
+    0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8, 0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9,
+    0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9,
+    0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63,
+    0xeb, 0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16,
+    0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f, 0x95,
+    0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e};
+
+inline uint32_t read32(const uint8_t* p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+      (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t read64(const uint8_t* p)
+{
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+#else
+  return static_cast<uint64_t>(read32(p)) | (static_cast<uint64_t>(read32(p + 4)) << 32);
+#endif
+}
+
+inline void write64(uint8_t* p, uint64_t v)
+{
+  for (size_t i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint32_t swap32(uint32_t x)
+{
+  return ((x << 24) & 0xff000000) | ((x << 8) & 0x00ff0000) | ((x >> 8) & 0x0000ff00) | ((x >> 24) & 0x000000ff);
+}
+
+inline uint64_t swap64(uint64_t x)
+{
+  return (static_cast<uint64_t>(swap32(static_cast<uint32_t>(x))) << 32) | swap32(static_cast<uint32_t>(x >> 32));
+}
+
+// The 128 bit product of lhs and rhs, its low half xored with its high half.
+inline uint64_t mul128_fold64(uint64_t lhs, uint64_t rhs)
+{
+#if defined(__SIZEOF_INT128__)
+  const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(_M_CEE)
+  uint64_t high;
+  const uint64_t low = _umul128(lhs, rhs, &high);
+  return low ^ high;
+#else
+  const uint64_t lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+  const uint64_t hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+  const uint64_t lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+  const uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+  const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  const uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  const uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return lower ^ upper;
+#endif
+}
+
+inline uint64_t xxh64_avalanche(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+  h ^= h >> 37;
+  h *= PRIME_MX1;
+  h ^= h >> 32;
+  return h;
+}
+
+inline uint64_t rrmxmx(uint64_t h, uint64_t len)
+{
+  h ^= rotl64(h, 49) ^ rotl64(h, 24);
+  h *= PRIME_MX2;
+  h ^= (h >> 35) + len;
+  h *= PRIME_MX2;
+  return h ^ (h >> 28);
+}
+
+inline uint64_t len_0to16(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+  if (len > 8)
+  {
+    const uint64_t bitflip1 = (read64(secret + 24) ^ read64(secret + 32)) + seed;
+    const uint64_t bitflip2 = (read64(secret + 40) ^ read64(secret + 48)) - seed;
+    const uint64_t input_lo = read64(input) ^ bitflip1;
+    const uint64_t input_hi = read64(input + len - 8) ^ bitflip2;
+    return avalanche(len + swap64(input_lo) + input_hi + mul128_fold64(input_lo, input_hi));
+  }
+  if (len >= 4)
+  {
+    seed ^= static_cast<uint64_t>(swap32(static_cast<uint32_t>(seed))) << 32;
+    const uint64_t bitflip = (read64(secret + 8) ^ read64(secret + 16)) - seed;
+    const uint64_t input64 = read32(input + len - 4) + (static_cast<uint64_t>(read32(input)) << 32);
+    return rrmxmx(input64 ^ bitflip, len);
+  }
+  if (len > 0)
+  {
+    const uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) | (static_cast<uint32_t>(input[len >> 1]) << 24) |
+        static_cast<uint32_t>(input[len - 1]) | (static_cast<uint32_t>(len) << 8);
+    const uint64_t bitflip = (read32(secret) ^ read32(secret + 4)) + seed;
+    return xxh64_avalanche(combined ^ bitflip);
+  }
+  return xxh64_avalanche(seed ^ (read64(secret + 56) ^ read64(secret + 64)));
+}
+
+inline uint64_t mix16(const uint8_t* input, const uint8_t* secret, uint64_t seed)
+{
+  return mul128_fold64(read64(input) ^ (read64(secret) + seed), read64(input + 8) ^ (read64(secret + 8) - seed));
+}
+
+inline uint64_t len_17to128(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+  uint64_t acc = len * PRIME64_1;
+  if (len > 32)
+  {
+    if (len > 64)
+    {
+      if (len > 96)
+      {
+        acc += mix16(input + 48, secret + 96, seed);
+        acc += mix16(input + len - 64, secret + 112, seed);
+      }
+      acc += mix16(input + 32, secret + 64, seed);
+      acc += mix16(input + len - 48, secret + 80, seed);
+    }
+    acc += mix16(input + 16, secret + 32, seed);
+    acc += mix16(input + len - 32, secret + 48, seed);
+  }
+  acc += mix16(input, secret, seed);
+  acc += mix16(input + len - 16, secret + 16, seed);
+  return avalanche(acc);
+}
+
+inline uint64_t len_129to240(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+  constexpr size_t START_OFFSET = 3;
+  constexpr size_t LAST_OFFSET = 17;
+  constexpr size_t SECRET_SIZE_MIN = 136;
+  uint64_t acc = len * PRIME64_1;
+  for (size_t i = 0; i < 8; i++) acc += mix16(input + 16 * i, secret + 16 * i, seed);
+  uint64_t acc_end = mix16(input + len - 16, secret + SECRET_SIZE_MIN - LAST_OFFSET, seed);
+  acc = avalanche(acc);
+  const size_t rounds = len / 16;
+  for (size_t i = 8; i < rounds; i++) acc_end += mix16(input + 16 * i, secret + 16 * (i - 8) + START_OFFSET, seed);
+  return avalanche(acc + acc_end);
+}
+
+inline void accumulate_512(uint64_t* acc, const uint8_t* input, const uint8_t* secret)
+{
+  for (size_t lane = 0; lane < ACC_NB; lane++)
+  {
+    const uint64_t data_val = read64(input + lane * 8);
+    const uint64_t data_key = data_val ^ read64(secret + lane * 8);
+    acc[lane ^ 1] += data_val;
+    acc[lane] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+  }
+}
+
+inline void scramble(uint64_t* acc, const uint8_t* secret)
+{
+  for (size_t lane = 0; lane < ACC_NB; lane++)
+  {
+    uint64_t a = acc[lane];
+    a ^= a >> 47;
+    a ^= read64(secret + lane * 8);
+    a *= PRIME32_1;
+    acc[lane] = a;
+  }
+}
+
+inline uint64_t hash_long(const uint8_t* input, size_t len, uint64_t seed)
+{
+  uint8_t custom_secret[SECRET_SIZE];
+  const uint8_t* secret = SECRET;
+  if (seed != 0)
+  {
+    for (size_t i = 0; i < SECRET_SIZE / 16; i++)
+    {
+      write64(custom_secret + 16 * i, read64(SECRET + 16 * i) + seed);
+      write64(custom_secret + 16 * i + 8, read64(SECRET + 16 * i + 8) - seed);
+    }
+    secret = custom_secret;
+  }
+
+  uint64_t acc[ACC_NB] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+  const size_t stripes_per_block = (SECRET_SIZE - STRIPE_LEN) / SECRET_CONSUME_RATE;
+  const size_t block_len = STRIPE_LEN * stripes_per_block;
+  const size_t blocks = (len - 1) / block_len;
+  for (size_t n = 0; n < blocks; n++)
+  {
+    for (size_t s = 0; s < stripes_per_block; s++)
+      accumulate_512(acc, input + n * block_len + s * STRIPE_LEN, secret + s * SECRET_CONSUME_RATE);
+    scramble(acc, secret + SECRET_SIZE - STRIPE_LEN);
+  }
+  // the last partial block, and the last stripe, which may overlap it
+  const size_t stripes = ((len - 1) - block_len * blocks) / STRIPE_LEN;
+  for (size_t s = 0; s < stripes; s++)
+    accumulate_512(acc, input + blocks * block_len + s * STRIPE_LEN, secret + s * SECRET_CONSUME_RATE);
+  constexpr size_t LAST_ACC_START = 7;
+  accumulate_512(acc, input + len - STRIPE_LEN, secret + SECRET_SIZE - STRIPE_LEN - LAST_ACC_START);
+
+  constexpr size_t MERGE_ACCS_START = 11;
+  uint64_t result = len * PRIME64_1;
+  for (size_t i = 0; i < 4; i++)
+  {
+    const uint8_t* s = secret + MERGE_ACCS_START + 16 * i;
+    result += mul128_fold64(acc[2 * i] ^ read64(s), acc[2 * i + 1] ^ read64(s + 8));
+  }
+  return avalanche(result);
+}
+}  // namespace XXH3
+
+inline uint64_t xxh3_hash(const void* key, size_t len, uint64_t seed)
+{
+  const uint8_t* input = static_cast<const uint8_t*>(key);
+  if (len <= 16) return XXH3::len_0to16(input, len, XXH3::SECRET, seed);
+  if (len <= 128) return XXH3::len_17to128(input, len, XXH3::SECRET, seed);
+  if (len <= XXH3::MIDSIZE_MAX) return XXH3::len_129to240(input, len, XXH3::SECRET, seed);
+  return XXH3::hash_long(input, len, seed);
+}